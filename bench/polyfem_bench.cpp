@@ -0,0 +1,311 @@
+////////////////////////////////////////////////////////////////////////////////
+// End-to-end performance benchmarks.
+//
+// Every scenario of the scenario directory is a json with
+//   name, description
+//   input: polyfem input arguments, the paths are relative to the data directory
+//   input_file: or a polyfem input file relative to the data directory
+//   optimization: true if the input is an optimization (run.json with states)
+//   refinements: values of geometry/*/n_refs to run, the mesh of the input is run once if empty
+//   overrides: patch merged into the input
+// For every run the phase timings, the throughput and the memory are written as json.
+// The peak RSS is the one of the process, run one scenario per process (--filter) to compare it.
+////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/State.hpp>
+#include <polyfem/OptState.hpp>
+
+#include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/getRSS.h>
+
+#include <CLI/CLI.hpp>
+
+#include <igl/Timer.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <thread>
+
+using namespace polyfem;
+
+namespace
+{
+	bool load_json(const std::string &json_file, json &out)
+	{
+		std::ifstream file(json_file);
+
+		if (!file.is_open())
+			return false;
+
+		file >> out;
+		return true;
+	}
+
+	std::vector<std::string> list_scenarios(const std::string &dir, const std::string &filter)
+	{
+		std::vector<std::string> files;
+		for (const auto &entry : std::filesystem::directory_iterator(dir))
+		{
+			if (entry.path().extension() != ".json")
+				continue;
+			if (!filter.empty() && entry.path().stem().string().find(filter) == std::string::npos)
+				continue;
+			files.push_back(entry.path().string());
+		}
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	/// polyfem input of a scenario, with the root path set so that the relative paths are resolved
+	json scenario_input(const json &scenario, const std::string &data_dir)
+	{
+		json in_args;
+		if (scenario.contains("input_file"))
+		{
+			const std::string path = (std::filesystem::path(data_dir) / scenario["input_file"].get<std::string>()).string();
+			if (!load_json(path, in_args))
+				log_and_throw_error("Unable to open {}", path);
+			in_args["root_path"] = path;
+
+			// the states of an optimization are loaded without root path
+			if (scenario.value("optimization", false))
+			{
+				const std::filesystem::path root = std::filesystem::path(path).parent_path();
+				for (auto &state : in_args["states"])
+					state["path"] = (root / state["path"].get<std::string>()).string();
+			}
+		}
+		else
+		{
+			in_args = scenario["input"];
+			in_args["root_path"] = (std::filesystem::path(data_dir) / "bench.json").string();
+		}
+
+		if (scenario.contains("overrides"))
+			in_args.merge_patch(scenario["overrides"]);
+		return in_args;
+	}
+
+	json run_forward(json in_args, const int refinement, const int max_threads, const spdlog::level::level_enum log_level)
+	{
+		if (refinement >= 0)
+		{
+			json &geometries = in_args["geometry"];
+			if (!geometries.is_array())
+				geometries = json::array({geometries});
+			for (json &geometry : geometries)
+				if (!geometry.value("is_obstacle", false))
+					geometry["n_refs"] = refinement;
+		}
+		in_args["/output/log/level"_json_pointer] = int(log_level);
+		in_args["/solver/max_threads"_json_pointer] = max_threads;
+
+		State state;
+		state.init(in_args, /*strict_validation=*/true);
+
+		json timings;
+		igl::Timer timer;
+		const auto phase = [&](const std::string &name, const std::function<void()> &f) {
+			timer.start();
+			f();
+			timer.stop();
+			timings[name] = timer.getElapsedTime();
+		};
+
+		phase("load", [&] { state.load_mesh(); });
+		if (state.mesh == nullptr)
+			log_and_throw_error("Unable to load the mesh");
+		state.stats.compute_mesh_stats(*state.mesh);
+
+		Eigen::MatrixXd sol, pressure;
+		phase("basis", [&] { state.build_basis(); });
+		phase("assembly", [&] {
+			state.assemble_rhs();
+			state.assemble_mass_mat();
+		});
+		phase("solve", [&] { state.solve_problem(sol, pressure); });
+
+		double total = 0;
+		for (const json &t : timings)
+			total += t.get<double>();
+		timings["total"] = total;
+
+		json run;
+		run["n_dofs"] = state.ndof();
+		run["n_elements"] = state.mesh->n_elements();
+		run["timings"] = timings;
+		run["memory"] = state.stats.memory;
+		if (state.solve_data.nl_problem)
+			run["form_timings"] = state.solve_data.nl_problem->form_timings();
+		return run;
+	}
+
+	json run_optimization(json opt_args, const int max_threads, const spdlog::level::level_enum log_level)
+	{
+		opt_args["/output/log/level"_json_pointer] = int(log_level);
+		opt_args["/solver/max_threads"_json_pointer] = max_threads;
+
+		OptState opt_state;
+		opt_state.init(opt_args, /*strict_validation=*/true);
+
+		json timings;
+		igl::Timer timer;
+
+		timer.start();
+		opt_state.create_states(solver::CacheLevel::Derivatives, max_threads);
+		opt_state.init_variables();
+		opt_state.create_problem();
+		timer.stop();
+		timings["setup"] = timer.getElapsedTime();
+
+		Eigen::VectorXd x;
+		opt_state.initial_guess(x);
+
+		timer.start();
+		try
+		{
+			opt_state.solve(x);
+		}
+		catch (const std::exception &e)
+		{
+			// reaching the iteration limit is expected, the time is still meaningful
+			logger().warn("Optimization stopped: {}", e.what());
+		}
+		timer.stop();
+		timings["solve"] = timer.getElapsedTime();
+		timings["total"] = timings["setup"].get<double>() + timings["solve"].get<double>();
+
+		int n_dofs = 0, n_elements = 0;
+		for (const auto &state : opt_state.states)
+		{
+			n_dofs += state->ndof();
+			n_elements += state->mesh->n_elements();
+		}
+
+		json run;
+		run["n_dofs"] = n_dofs;
+		run["n_elements"] = n_elements;
+		run["n_variables"] = x.size();
+		run["timings"] = timings;
+		if (!opt_state.states.empty())
+			run["memory"] = opt_state.states.front()->stats.memory;
+		return run;
+	}
+
+	/// keeps the fastest of the repeated runs
+	json run_scenario(const json &scenario, const json &in_args, const int refinement, const int repeat, const int max_threads, const spdlog::level::level_enum log_level)
+	{
+		json best;
+		for (int r = 0; r < repeat; ++r)
+		{
+			json run = scenario.value("optimization", false)
+						   ? run_optimization(in_args, max_threads, log_level)
+						   : run_forward(in_args, refinement, max_threads, log_level);
+			if (best.is_null() || run["timings"]["total"].get<double>() < best["timings"]["total"].get<double>())
+				best = run;
+		}
+
+		const double total = best["timings"]["total"];
+		best["name"] = scenario["name"];
+		best["refinement"] = refinement;
+		best["repeat"] = repeat;
+		best["throughput"] = {
+			{"dofs_per_second", total > 0 ? best["n_dofs"].get<double>() / total : 0},
+			{"elements_per_second", total > 0 ? best["n_elements"].get<double>() / total : 0}};
+		best["peak_memory"] = getPeakRSS() / (1024.0 * 1024.0);
+		return best;
+	}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	CLI::App command_line{"polyfem_bench"};
+
+	command_line.ignore_case();
+	command_line.ignore_underscore();
+
+	std::string scenario_dir = std::string(POLYFEM_BENCH_DIR) + "/scenarios";
+	command_line.add_option("--scenarios", scenario_dir, "Directory of the scenario json files")->check(CLI::ExistingDirectory);
+
+	std::string data_dir = POLYFEM_DATA_DIR;
+	command_line.add_option("--data", data_dir, "Directory of the meshes and inputs of the scenarios")->check(CLI::ExistingDirectory);
+
+	std::string filter = "";
+	command_line.add_option("-f,--filter", filter, "Only runs the scenarios whose file name contains this string");
+
+	std::vector<int> refinements;
+	command_line.add_option("-r,--refinements", refinements, "Overrides the refinements of the scenarios");
+
+	int repeat = 1;
+	command_line.add_option("--repeat", repeat, "Number of runs of each scenario, the fastest is reported")->check(CLI::PositiveNumber);
+
+	int max_threads = std::thread::hardware_concurrency();
+	command_line.add_option("--max_threads", max_threads, "Maximum number of threads");
+
+	std::string output = "";
+	command_line.add_option("-o,--output", output, "Output json file, printed to stdout if empty");
+
+	spdlog::level::level_enum log_level = spdlog::level::warn;
+	command_line.add_option("--log_level", log_level, "Log level of the simulations")
+		->transform(CLI::CheckedTransformer(std::map<std::string, spdlog::level::level_enum>{
+			{"trace", spdlog::level::trace},
+			{"debug", spdlog::level::debug},
+			{"info", spdlog::level::info},
+			{"warning", spdlog::level::warn},
+			{"error", spdlog::level::err},
+			{"off", spdlog::level::off}},
+			CLI::ignore_case));
+
+	CLI11_PARSE(command_line, argc, argv);
+
+	json results;
+	results["threads"] = max_threads;
+	results["runs"] = json::array();
+
+	for (const std::string &file : list_scenarios(scenario_dir, filter))
+	{
+		json scenario;
+		if (!load_json(file, scenario))
+			log_and_throw_error("Unable to open {}", file);
+
+		const json in_args = scenario_input(scenario, data_dir);
+
+		std::vector<int> refs = refinements;
+		if (refs.empty() && scenario.contains("refinements"))
+			refs = scenario["refinements"].get<std::vector<int>>();
+		if (refs.empty() || scenario.value("optimization", false))
+			refs = {-1};
+
+		for (const int refinement : refs)
+		{
+			logger().info("Running {} (refinement {})", scenario["name"], refinement);
+			try
+			{
+				results["runs"].push_back(run_scenario(scenario, in_args, refinement, repeat, max_threads, log_level));
+			}
+			catch (const std::exception &e)
+			{
+				logger().error("Scenario {} failed: {}", scenario["name"], e.what());
+				results["runs"].push_back({{"name", scenario["name"]}, {"refinement", refinement}, {"error", e.what()}});
+			}
+		}
+	}
+
+	if (output.empty())
+	{
+		std::cout << results.dump(4) << std::endl;
+	}
+	else
+	{
+		std::ofstream out(output);
+		if (!out.is_open())
+			log_and_throw_error("Unable to write {}", output);
+		out << results.dump(4) << std::endl;
+	}
+
+	return results["runs"].empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
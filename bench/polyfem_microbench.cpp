@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////
+// Micro-benchmarks of the inner kernels: geometric mapping and basis evaluation,
+// the energy/gradient/hessian assembly of the hyperelastic models, the sparse
+// matrix cache and the quadrature rules.
+//
+// Every kernel is run until --min_time seconds are spent in it, the fastest call
+// is reported with its throughput in items (elements, basis evaluations, ...) per second.
+////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/State.hpp>
+
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/autogen/auto_p_bases.hpp>
+#include <polyfem/autogen/auto_q_bases_3d_val.hpp>
+#include <polyfem/autogen/auto_q_bases_3d_grad.hpp>
+#include <polyfem/quadrature/HexQuadrature.hpp>
+#include <polyfem/quadrature/TetQuadrature.hpp>
+#include <polyfem/quadrature/TriQuadrature.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <CLI/CLI.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+using namespace polyfem;
+
+namespace
+{
+	class MicroBenchmark
+	{
+	public:
+		MicroBenchmark(const double min_time, const std::string &filter)
+			: min_time_(min_time), filter_(filter)
+		{
+		}
+
+		/// times run, setup is called before every run and is not timed
+		/// @param[in] items number of items processed by one run, for the throughput
+		void run(const std::string &name, const double items, const std::function<void()> &run, const std::function<void()> &setup = nullptr)
+		{
+			if (!filter_.empty() && name.find(filter_) == std::string::npos)
+				return;
+
+			double best = std::numeric_limits<double>::max();
+			double total = 0;
+			int calls = 0;
+			// the first call is a warm up
+			for (int i = 0; i < 2 || total < min_time_; ++i)
+			{
+				if (setup)
+					setup();
+				const auto start = std::chrono::steady_clock::now();
+				run();
+				const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				if (i == 0)
+					continue;
+				best = std::min(best, time);
+				total += time;
+				++calls;
+			}
+
+			logger().info("{}: {:.3e}s, {:.3e} items/s", name, best, items / best);
+			results_.push_back({
+				{"name", name},
+				{"items", items},
+				{"calls", calls},
+				{"time", best},
+				{"items_per_second", items / best},
+			});
+		}
+
+		const json &results() const { return results_; }
+
+	private:
+		const double min_time_;
+		const std::string filter_;
+		json results_ = json::array();
+	};
+
+	void bench_quadratures(MicroBenchmark &bench)
+	{
+		for (const int order : {2, 4, 8})
+		{
+			quadrature::Quadrature quad;
+			bench.run(fmt::format("quadrature/tri/{}", order), 1, [&] { quadrature::TriQuadrature().get_quadrature(order, quad); });
+			bench.run(fmt::format("quadrature/tet/{}", order), 1, [&] { quadrature::TetQuadrature().get_quadrature(order, quad); });
+			bench.run(fmt::format("quadrature/hex/{}", order), 1, [&] { quadrature::HexQuadrature().get_quadrature(order, quad); });
+		}
+	}
+
+	void bench_bases(MicroBenchmark &bench)
+	{
+		Eigen::MatrixXd val;
+		for (const int p : {1, 2, 3})
+		{
+			quadrature::Quadrature quad;
+			quadrature::TetQuadrature().get_quadrature(2 * p, quad);
+			const int n_bases = (p + 1) * (p + 2) * (p + 3) / 6;
+			const double items = n_bases * quad.points.rows();
+
+			bench.run(fmt::format("basis/p_basis_value_3d/P{}", p), items, [&] {
+				for (int i = 0; i < n_bases; ++i)
+					autogen::p_basis_value_3d(p, i, quad.points, val);
+			});
+			bench.run(fmt::format("basis/p_grad_basis_value_3d/P{}", p), items, [&] {
+				for (int i = 0; i < n_bases; ++i)
+					autogen::p_grad_basis_value_3d(p, i, quad.points, val);
+			});
+		}
+
+		for (const int q : {1, 2})
+		{
+			quadrature::Quadrature quad;
+			quadrature::HexQuadrature().get_quadrature(2 * q, quad);
+			const int n_bases = (q + 1) * (q + 1) * (q + 1);
+			const double items = n_bases * quad.points.rows();
+
+			bench.run(fmt::format("basis/q_basis_value_3d/Q{}", q), items, [&] {
+				for (int i = 0; i < n_bases; ++i)
+					autogen::q_basis_value_3d(q, i, quad.points, val);
+			});
+			bench.run(fmt::format("basis/q_grad_basis_value_3d/Q{}", q), items, [&] {
+				for (int i = 0; i < n_bases; ++i)
+					autogen::q_grad_basis_value_3d(q, i, quad.points, val);
+			});
+		}
+	}
+
+	std::unique_ptr<State> make_state(const std::string &mesh, const int n_refs, const int order, const json &material)
+	{
+		json in_args = R"({
+			"space": {},
+			"boundary_conditions": {
+				"dirichlet_boundary": [{
+					"id": "all",
+					"value": [0, 0, 0]
+				}]
+			},
+			"output": {
+				"log": {
+					"level": "warning"
+				}
+			}
+		})"_json;
+		in_args["geometry"] = {{{"mesh", mesh}, {"n_refs", n_refs}}};
+		in_args["space"]["discr_order"] = order;
+		in_args["materials"] = material;
+
+		auto state = std::make_unique<State>();
+		state->init(in_args, /*strict_validation=*/true);
+		state->load_mesh();
+		state->build_basis();
+		return state;
+	}
+
+	void bench_element_values(MicroBenchmark &bench, const State &state, const std::string &suffix)
+	{
+		const int n_elements = state.bases.size();
+		const bool is_volume = state.mesh->is_volume();
+		assembler::ElementAssemblyValues vals;
+
+		bench.run("ElementAssemblyValues::compute/" + suffix, n_elements, [&] {
+			for (int e = 0; e < n_elements; ++e)
+				vals.compute(e, is_volume, state.bases[e], state.geom_bases()[e]);
+		});
+	}
+
+	void bench_model(MicroBenchmark &bench, const State &state, const std::string &suffix)
+	{
+		const int n_elements = state.bases.size();
+		const bool is_volume = state.mesh->is_volume();
+		const assembler::Assembler &assembler = *state.assembler;
+
+		const Eigen::MatrixXd u = 1e-3 * Eigen::VectorXd::Random(state.ndof());
+		const std::string name = assembler.name() + "/" + suffix;
+
+		bench.run("compute_energy/" + name, n_elements, [&] {
+			assembler.assemble_energy(is_volume, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 1, u, u);
+		});
+
+		Eigen::MatrixXd grad;
+		bench.run("assemble_gradient/" + name, n_elements, [&] {
+			assembler.assemble_gradient(is_volume, state.n_bases, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 1, u, u, grad);
+		});
+
+		// the first assembly builds the mapping of the cache, the timed ones reuse it
+		utils::SparseMatrixCache mat_cache;
+		StiffnessMatrix hessian;
+		bench.run("assemble_hessian/" + name, n_elements, [&] {
+			assembler.assemble_hessian(is_volume, state.n_bases, false, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 1, u, u, mat_cache, hessian);
+		});
+	}
+
+	void bench_matrix_cache(MicroBenchmark &bench, const State &state, const std::string &suffix)
+	{
+		const int size = state.ndof();
+		const int dim = state.mesh->dimension();
+
+		// every element adds a dense block coupling all its dofs
+		std::vector<std::vector<int>> element_dofs(state.bases.size());
+		double n_values = 0;
+		for (int e = 0; e < state.bases.size(); ++e)
+		{
+			for (const basis::Basis &b : state.bases[e].bases)
+				for (const auto &g : b.global())
+					for (int d = 0; d < dim; ++d)
+						element_dofs[e].push_back(g.index * dim + d);
+			n_values += element_dofs[e].size() * element_dofs[e].size();
+		}
+		const auto add_values = [&](utils::SparseMatrixCache &cache) {
+			for (int e = 0; e < element_dofs.size(); ++e)
+				for (const int i : element_dofs[e])
+					for (const int j : element_dofs[e])
+						cache.add_value(e, i, j, 1);
+		};
+
+		// a fresh cache stores triplets until get_matrix builds the mapping
+		utils::SparseMatrixCache cache;
+		bench.run("SparseMatrixCache::add_value/triplets/" + suffix, n_values, [&] { add_values(cache); }, [&] { cache = utils::SparseMatrixCache(size); });
+		bench.run(
+			"SparseMatrixCache::get_matrix/build_mapping/" + suffix, n_values, [&] { cache.get_matrix(true); },
+			[&] {
+				cache = utils::SparseMatrixCache(size);
+				add_values(cache);
+			});
+
+		// cache now holds the mapping, the values go directly to their slots
+		bench.run("SparseMatrixCache::add_value/mapped/" + suffix, n_values, [&] { add_values(cache); }, [&] { cache.set_zero(); });
+		bench.run("SparseMatrixCache::get_matrix/mapped/" + suffix, n_values, [&] { cache.get_matrix(); }, [&] { add_values(cache); });
+
+		std::unique_ptr<utils::MatrixCache> local;
+		bench.run(
+			"SparseMatrixCache::operator+=/" + suffix, n_values, [&] { cache += *local; },
+			[&] {
+				cache.set_zero();
+				local = cache.copy();
+				local->init(cache);
+				add_values(dynamic_cast<utils::SparseMatrixCache &>(*local));
+			});
+	}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	CLI::App command_line{"polyfem_microbench"};
+
+	command_line.ignore_case();
+	command_line.ignore_underscore();
+
+	std::string mesh = std::string(POLYFEM_DATA_DIR) + "/contact/meshes/3D/simple/cube.msh";
+	command_line.add_option("--mesh", mesh, "Volume mesh used by the assembly kernels")->check(CLI::ExistingFile);
+
+	int n_refs = 2;
+	command_line.add_option("--n_refs", n_refs, "Number of refinements of the mesh");
+
+	double min_time = 0.5;
+	command_line.add_option("--min_time", min_time, "Minimum time spent in every kernel (s)");
+
+	std::string filter = "";
+	command_line.add_option("-f,--filter", filter, "Only runs the kernels whose name contains this string");
+
+	int max_threads = 1;
+	command_line.add_option("--max_threads", max_threads, "Number of threads of the assembly kernels");
+
+	std::string output = "";
+	command_line.add_option("-o,--output", output, "Output json file, printed to stdout if empty");
+
+	CLI11_PARSE(command_line, argc, argv);
+
+	MicroBenchmark bench(min_time, filter);
+
+	bench_quadratures(bench);
+	bench_bases(bench);
+
+	const std::vector<json> materials = {
+		{{"type", "NeoHookean"}, {"E", 1e5}, {"nu", 0.3}},
+		{{"type", "MooneyRivlin"}, {"c1", 1e4}, {"c2", 1e3}, {"k", 1e5}},
+		{{"type", "UnconstrainedOgden"}, {"alphas", {2.0}}, {"mus", {1e4}}, {"Ds", {1e-4}}},
+		{{"type", "SaintVenant"}, {"E", 1e5}, {"nu", 0.3}},
+		{{"type", "FixedCorotational"}, {"E", 1e5}, {"nu", 0.3}},
+	};
+
+	for (const int order : {1, 2})
+	{
+		const std::string suffix = fmt::format("P{}", order);
+		for (int m = 0; m < materials.size(); ++m)
+		{
+			std::unique_ptr<State> state = make_state(mesh, n_refs, order, materials[m]);
+			state->set_max_threads(max_threads);
+
+			// the kernels independent of the material are run once per order
+			if (m == 0)
+			{
+				bench_element_values(bench, *state, suffix);
+				bench_matrix_cache(bench, *state, suffix);
+			}
+			bench_model(bench, *state, suffix);
+		}
+	}
+
+	json results;
+	results["threads"] = max_threads;
+	results["mesh"] = mesh;
+	results["n_refs"] = n_refs;
+	results["benchmarks"] = bench.results();
+
+	if (output.empty())
+	{
+		std::cout << results.dump(4) << std::endl;
+	}
+	else
+	{
+		std::ofstream out(output);
+		if (!out.is_open())
+			log_and_throw_error("Unable to write {}", output);
+		out << results.dump(4) << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
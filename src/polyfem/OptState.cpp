@@ -10,6 +10,7 @@
 
 #include <polysolve/nonlinear/Solver.hpp>
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/ostream_sink.h>
@@ -50,7 +51,8 @@ namespace polyfem
 		const std::string &log_file,
 		const spdlog::level::level_enum log_level,
 		const spdlog::level::level_enum file_log_level,
-		const bool is_quiet)
+		const bool is_quiet,
+		const bool is_async)
 	{
 		std::vector<spdlog::sink_ptr> sinks;
 
@@ -68,7 +70,7 @@ namespace polyfem
 			sinks.push_back(file_sink_);
 		}
 
-		init_logger(sinks, log_level);
+		init_logger(sinks, log_level, is_async);
 		spdlog::flush_every(std::chrono::seconds(3));
 	}
 
@@ -81,9 +83,20 @@ namespace polyfem
 
 	void OptState::init_logger(
 		const std::vector<spdlog::sink_ptr> &sinks,
-		const spdlog::level::level_enum log_level)
+		const spdlog::level::level_enum log_level,
+		const bool is_async)
 	{
-		set_adjoint_logger(std::make_shared<spdlog::logger>("adjoint-polyfem", sinks.begin(), sinks.end()));
+		if (is_async)
+		{
+			if (spdlog::thread_pool() == nullptr)
+				spdlog::init_thread_pool(8192, 1);
+			auto logger = std::make_shared<spdlog::async_logger>(
+				"adjoint-polyfem", sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::block);
+			logger->flush_on(spdlog::level::err);
+			set_adjoint_logger(logger);
+		}
+		else
+			set_adjoint_logger(std::make_shared<spdlog::logger>("adjoint-polyfem", sinks.begin(), sinks.end()));
 
 		// Set the logger at the lowest level, so all messages are passed to the sinks
 		adjoint_logger().set_level(spdlog::level::trace);
@@ -120,7 +133,8 @@ namespace polyfem
 			out_path_log,
 			this->args["output"]["log"]["level"],
 			this->args["output"]["log"]["file_level"],
-			this->args["output"]["log"]["quiet"]);
+			this->args["output"]["log"]["quiet"],
+			this->args["output"]["log"]["async"]);
 
 		adjoint_logger().info("Saving adjoint output to {}", output_dir);
 
@@ -42,11 +42,13 @@ namespace polyfem
 		/// @param[in] log_level 0 all message, 6 no message. 2 is info, 1 is debug
 		/// @param[in] file_log_level 0 all message, 6 no message. 2 is info, 1 is debug
 		/// @param[in] is_quit quiets the log
+		/// @param[in] is_async writes the log from a background thread, the solver does not wait for the sinks
 		void init_logger(
 			const std::string &log_file,
 			const spdlog::level::level_enum log_level,
 			const spdlog::level::level_enum file_log_level,
-			const bool is_quiet);
+			const bool is_quiet,
+			const bool is_async = false);
 
 		/// initializing the logger writes to an output stream
 		/// @param[in] os output stream
@@ -80,7 +82,7 @@ namespace polyfem
 		}
 
 		/// initializing the logger meant for internal usage
-		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level);
+		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level, const bool is_async = false);
 
 		/// logger sink to stdout
 		spdlog::sink_ptr console_sink_ = nullptr;
@@ -7,6 +7,7 @@
 
 #include <polyfem/assembler/Mass.hpp>
 #include <polyfem/assembler/MultiModel.hpp>
+#include <polyfem/assembler/ViscousDamping.hpp>
 
 #include <polyfem/mesh/mesh2D/Mesh2D.hpp>
 #include <polyfem/mesh/mesh2D/CMesh2D.hpp>
@@ -39,6 +40,7 @@
 #include <polyfem/quadrature/TetQuadrature.hpp>
 #include <polyfem/quadrature/TriQuadrature.hpp>
 
+#include <polyfem/utils/GraphReordering.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/Timer.hpp>
 
@@ -53,6 +55,7 @@
 #include <algorithm>
 #include <memory>
 #include <filesystem>
+#include <unordered_set>
 
 #include <polyfem/io/Evaluator.hpp>
 
@@ -160,7 +163,7 @@ namespace polyfem
 
 			logger().trace("Building Mesh edges to IDs...");
 			timer.start();
-			const auto edges_to_ids = mesh.edges_to_ids();
+			const PrimitiveIndex &edges_to_ids = mesh.edge_index();
 			if (in_ordered_edges.rows() != edges_to_ids.size())
 			{
 				logger().warn("Node ordering disabled, in_ordered_edges != edges_to_ids, {} != {}", in_ordered_edges.rows(), edges_to_ids.size());
@@ -173,11 +176,11 @@ namespace polyfem
 			timer.start();
 			for (int in_ei = 0; in_ei < in_ordered_edges.rows(); in_ei++)
 			{
-				const std::pair<int, int> in_edge(
-					in_ordered_edges.row(in_ei).minCoeff(),
-					in_ordered_edges.row(in_ei).maxCoeff());
+				const int e_id = edges_to_ids.find(in_ordered_edges(in_ei, 0), in_ordered_edges(in_ei, 1));
+				if (e_id < 0)
+					log_and_throw_error("Input edge {} is not an edge of the mesh", in_ei);
 				in_primitive_to_primitive[in_offset + in_ei] =
-					offset + edges_to_ids.at(in_edge); // offset edge ids
+					offset + e_id; // offset edge ids
 			}
 			timer.stop();
 			logger().trace("Done (took {}s)", timer.getElapsedTime());
@@ -193,7 +196,7 @@ namespace polyfem
 			{
 				logger().trace("Building Mesh faces to IDs...");
 				timer.start();
-				const auto faces_to_ids = mesh.faces_to_ids();
+				const PrimitiveIndex &faces_to_ids = mesh.face_index();
 				if (in_ordered_faces.rows() != faces_to_ids.size())
 				{
 					logger().warn("Node ordering disabled, in_ordered_faces != faces_to_ids, {} != {}", in_ordered_faces.rows(), faces_to_ids.size());
@@ -209,10 +212,12 @@ namespace polyfem
 					std::vector<int> in_face(in_ordered_faces.cols());
 					for (int i = 0; i < in_face.size(); i++)
 						in_face[i] = in_ordered_faces(in_fi, i);
-					std::sort(in_face.begin(), in_face.end());
 
+					const int f_id = faces_to_ids.find(in_face);
+					if (f_id < 0)
+						log_and_throw_error("Input face {} is not a face of the mesh", in_fi);
 					in_primitive_to_primitive[in_offset + in_fi] =
-						offset + faces_to_ids.at(in_face); // offset face ids
+						offset + f_id; // offset face ids
 				}
 				timer.stop();
 				logger().trace("Done (took {}s)", timer.getElapsedTime());
@@ -223,6 +228,13 @@ namespace polyfem
 
 			return true;
 		}
+
+		void set_cache_policy(const json &advanced, const std::vector<AssemblyValsCache *> &caches)
+		{
+			const AssemblyValsCache::Policy policy = advanced["cache_policy"] == "auto" ? AssemblyValsCache::Policy::Auto : AssemblyValsCache::Policy::All;
+			for (AssemblyValsCache *cache : caches)
+				cache->set_policy(policy, advanced["cache_min_bases"]);
+		}
 	} // namespace
 
 	std::vector<int> State::primitive_to_node() const
@@ -325,6 +337,41 @@ namespace polyfem
 		}
 	}
 
+	void State::reorder_nodes()
+	{
+		if (!mesh_nodes || mesh->has_poly())
+		{
+			logger().warn("Node reordering disabled, not supported for splines and polygonal meshes!");
+			return;
+		}
+
+		if (mesh_nodes->n_nodes() != n_bases)
+		{
+			logger().warn("Node reordering disabled, nodes and bases do not match!");
+			return;
+		}
+
+		std::vector<std::vector<int>> element_nodes(bases.size());
+		for (int e = 0; e < bases.size(); ++e)
+		{
+			for (const auto &b : bases[e].bases)
+				for (const auto &g : b.global())
+					element_nodes[e].push_back(g.index);
+		}
+
+		const std::vector<int> new_ids = utils::reverse_cuthill_mckee(element_nodes, n_bases);
+
+		for (auto &bs : bases)
+		{
+			for (auto &b : bs.bases)
+				for (auto &g : b.global())
+					g.index = new_ids[g.index];
+		}
+
+		// keeps primitive_to_node() and the input node mapping consistent with the new numbering
+		mesh_nodes->permute(new_ids);
+	}
+
 	std::string State::formulation() const
 	{
 		if (args["materials"].is_null())
@@ -485,7 +532,7 @@ namespace polyfem
 		if (mesh->is_rational())
 			return false;
 
-		if (args["space"]["use_p_ref"])
+		if (args["space"]["use_p_ref"] || adaptive_disc_orders.size() > 0)
 			return false;
 
 		if (has_periodic_bc())
@@ -524,6 +571,7 @@ namespace polyfem
 		}
 
 		mesh->prepare_mesh();
+		out_geom.reset_vis_cache();
 
 		bases.clear();
 		pressure_bases.clear();
@@ -540,6 +588,17 @@ namespace polyfem
 		poly_edge_to_data.clear();
 		rhs.resize(0, 0);
 		basis_nodes_to_gbasis_nodes.resize(0, 0);
+		lin_factorization_valid = false;
+
+		// the assembly scratch buffers are sized for the previous mesh
+		if (assembler)
+			assembler->clear_workspace();
+		if (pressure_assembler)
+			pressure_assembler->clear_workspace();
+		if (damping_assembler)
+			damping_assembler->clear_workspace();
+		if (damping_prev_assembler)
+			damping_prev_assembler->clear_workspace();
 
 		if (assembler::MultiModel *mm = dynamic_cast<assembler::MultiModel *>(assembler.get()))
 		{
@@ -630,6 +689,9 @@ namespace polyfem
 		}
 		// TODO: same for pressure!
 
+		if (adaptive_disc_orders.size() == disc_orders.size())
+			disc_orders = adaptive_disc_orders;
+
 		Eigen::MatrixXi geom_disc_orders;
 		if (!iso_parametric())
 		{
@@ -753,6 +815,12 @@ namespace polyfem
 
 		build_polygonal_basis();
 
+		if (args["space"]["advanced"]["reorder_nodes"])
+		{
+			logger().debug("Reordering nodes...");
+			reorder_nodes();
+		}
+
 		if (n_geom_bases == 0)
 			n_geom_bases = n_bases;
 
@@ -843,7 +911,6 @@ namespace polyfem
 		if (args["space"]["advanced"]["count_flipped_els"])
 			stats.count_flipped_elements(*mesh, geom_bases());
 
-		const int prev_bases = n_bases;
 		n_bases += obstacle.n_vertices();
 
 		{
@@ -863,80 +930,107 @@ namespace polyfem
 			build_periodic_collision_mesh();
 		logger().info("Done!");
 
-		const int prev_b_size = local_boundary.size();
-		problem->setup_bc(*mesh, n_bases - obstacle.n_vertices(),
-						  bases, geom_bases(), pressure_bases,
-						  local_boundary,
-						  boundary_nodes,
-						  local_neumann_boundary,
-						  local_pressure_boundary,
-						  local_pressure_cavity,
-						  pressure_boundary_nodes,
-						  dirichlet_nodes, neumann_nodes);
+		setup_boundary_conditions();
 
-		// setp nodal values
+		const auto &curret_bases = geom_bases();
+		const int n_samples = 10;
+		stats.compute_mesh_size(*mesh, curret_bases, n_samples, args["output"]["advanced"]["curved_mesh_size"]);
+		if (starting_min_edge_length < 0)
 		{
-			dirichlet_nodes_position.resize(dirichlet_nodes.size());
-			for (int n = 0; n < dirichlet_nodes.size(); ++n)
-			{
-				const int n_id = dirichlet_nodes[n];
-				bool found = false;
-				for (const auto &bs : bases)
-				{
-					for (const auto &b : bs.bases)
-					{
-						for (const auto &lg : b.global())
-						{
-							if (lg.index == n_id)
-							{
-								dirichlet_nodes_position[n] = lg.node;
-								found = true;
-								break;
-							}
-						}
+			starting_min_edge_length = stats.min_edge_length;
+		}
+		if (starting_max_edge_length < 0)
+		{
+			starting_max_edge_length = stats.mesh_size;
+		}
 
-						if (found)
-							break;
-					}
+		if (is_contact_enabled())
+		{
+			update_min_boundary_edge_length();
 
-					if (found)
-						break;
-				}
+			double dhat = Units::convert(args["contact"]["dhat"], units.length());
+			args["contact"]["epsv"] = Units::convert(args["contact"]["epsv"], units.velocity());
+			args["contact"]["dhat"] = dhat;
 
-				assert(found);
+			if (!has_dhat && dhat > min_boundary_edge_length)
+			{
+				args["contact"]["dhat"] = double(args["contact"]["dhat_percentage"]) * min_boundary_edge_length;
+				logger().info("dhat set to {}", double(args["contact"]["dhat"]));
 			}
-
-			neumann_nodes_position.resize(neumann_nodes.size());
-			for (int n = 0; n < neumann_nodes.size(); ++n)
+			else
 			{
-				const int n_id = neumann_nodes[n];
-				bool found = false;
-				for (const auto &bs : bases)
-				{
-					for (const auto &b : bs.bases)
-					{
-						for (const auto &lg : b.global())
-						{
-							if (lg.index == n_id)
-							{
-								neumann_nodes_position[n] = lg.node;
-								found = true;
-								break;
-							}
-						}
+				if (dhat > min_boundary_edge_length)
+					logger().warn("dhat larger than min boundary edge, {} > {}", dhat, min_boundary_edge_length);
+			}
+		}
 
-						if (found)
-							break;
-					}
+		logger().info("n_bases {}", n_bases);
 
-					if (found)
-						break;
-				}
+		timings.building_basis_time = timer.getElapsedTime();
+		logger().info(" took {}s", timings.building_basis_time);
 
-				assert(found);
-			}
+		logger().info("flipped elements {}", stats.n_flipped);
+		logger().info("h: {}", stats.mesh_size);
+		logger().info("n bases: {}", n_bases);
+		logger().info("n pressure bases: {}", n_pressure_bases);
+
+		ass_vals_cache.clear();
+		mass_ass_vals_cache.clear();
+		if (n_bases <= args["solver"]["advanced"]["cache_size"])
+		{
+			timer.start();
+			logger().info("Building cache...");
+			set_cache_policy(args["solver"]["advanced"], {&ass_vals_cache, &mass_ass_vals_cache, &pressure_ass_vals_cache});
+			ass_vals_cache.init(mesh->is_volume(), bases, curret_bases);
+			mass_ass_vals_cache.init(mesh->is_volume(), bases, curret_bases, true);
+			if (mixed_assembler != nullptr)
+				pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases, curret_bases);
+
+			logger().info(" took {}s, {}/{} elements cached", timer.getElapsedTime(), ass_vals_cache.n_cached_elements(), bases.size());
+		}
+		else
+		{
+			// the colouring is cheap and keeps gradient assembly memory at O(ndof)
+			ass_vals_cache.init_element_colors(bases, curret_bases);
+		}
+
+		out_geom.build_grid(*mesh, curret_bases, args["output"]["advanced"]["sol_on_grid"]);
+
+		if ((!problem->is_time_dependent() || args["time"]["quasistatic"]) && boundary_nodes.empty())
+		{
+			if (has_periodic_bc())
+				logger().warn("(Quasi-)Static problem without Dirichlet nodes, will fix solution at one node to find a unique solution!");
+			else
+				log_and_throw_error("Static problem need to have some Dirichlet nodes!");
 		}
 
+		record_memory("basis");
+	}
+
+	void State::setup_boundary_conditions()
+	{
+		const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
+		// the obstacle nodes are appended after the FE bases
+		const int prev_bases = n_bases - obstacle.n_vertices();
+
+		// setup_bc filters the local boundary, it starts again from the full one
+		local_boundary = total_local_boundary;
+		dirichlet_nodes.clear();
+		neumann_nodes.clear();
+		const int prev_b_size = local_boundary.size();
+
+		problem->setup_bc(*mesh, prev_bases,
+						  bases, geom_bases(), pressure_bases,
+						  local_boundary,
+						  boundary_nodes,
+						  local_neumann_boundary,
+						  local_pressure_boundary,
+						  local_pressure_cavity,
+						  pressure_boundary_nodes,
+						  dirichlet_nodes, neumann_nodes);
+
+		update_nodal_positions();
+
 		const bool has_neumann = local_neumann_boundary.size() > 0 || local_boundary.size() < prev_b_size;
 		use_avg_pressure = !has_neumann;
 
@@ -979,78 +1073,141 @@ namespace polyfem
 			}
 			logger().info("Fix solution at node {} to remove singularity due to periodic BC", i);
 		}
+	}
 
-		const auto &curret_bases = geom_bases();
-		const int n_samples = 10;
-		stats.compute_mesh_size(*mesh, curret_bases, n_samples, args["output"]["advanced"]["curved_mesh_size"]);
-		if (starting_min_edge_length < 0)
+	void State::update_nodal_positions()
+	{
+		// position of every global node, the nodes shared by several elements are written more than once
+		std::vector<RowVectorNd> node_positions(n_bases);
+		for (const auto &bs : bases)
+			for (const auto &b : bs.bases)
+				for (const auto &lg : b.global())
+					node_positions[lg.index] = lg.node;
+
+		dirichlet_nodes_position.resize(dirichlet_nodes.size());
+		for (int n = 0; n < dirichlet_nodes.size(); ++n)
 		{
-			starting_min_edge_length = stats.min_edge_length;
+			assert(node_positions[dirichlet_nodes[n]].size() > 0);
+			dirichlet_nodes_position[n] = node_positions[dirichlet_nodes[n]];
 		}
-		if (starting_max_edge_length < 0)
+
+		neumann_nodes_position.resize(neumann_nodes.size());
+		for (int n = 0; n < neumann_nodes.size(); ++n)
 		{
-			starting_max_edge_length = stats.mesh_size;
+			assert(node_positions[neumann_nodes[n]].size() > 0);
+			neumann_nodes_position[n] = node_positions[neumann_nodes[n]];
 		}
+	}
 
-		if (is_contact_enabled())
+	void State::update_min_boundary_edge_length()
+	{
+		min_boundary_edge_length = std::numeric_limits<double>::max();
+		for (const auto &edge : collision_mesh.edges().rowwise())
 		{
-			min_boundary_edge_length = std::numeric_limits<double>::max();
-			for (const auto &edge : collision_mesh.edges().rowwise())
-			{
-				const VectorNd v0 = collision_mesh.rest_positions().row(edge(0));
-				const VectorNd v1 = collision_mesh.rest_positions().row(edge(1));
-				min_boundary_edge_length = std::min(min_boundary_edge_length, (v1 - v0).norm());
-			}
+			const VectorNd v0 = collision_mesh.rest_positions().row(edge(0));
+			const VectorNd v1 = collision_mesh.rest_positions().row(edge(1));
+			min_boundary_edge_length = std::min(min_boundary_edge_length, (v1 - v0).norm());
+		}
+	}
 
-			double dhat = Units::convert(args["contact"]["dhat"], units.length());
-			args["contact"]["epsv"] = Units::convert(args["contact"]["epsv"], units.velocity());
-			args["contact"]["dhat"] = dhat;
+	bool State::can_update_geometry() const
+	{
+		if (!mesh || bases.size() != mesh->n_elements())
+			return false;
 
-			if (!has_dhat && dhat > min_boundary_edge_length)
-			{
-				args["contact"]["dhat"] = double(args["contact"]["dhat_percentage"]) * min_boundary_edge_length;
-				logger().info("dhat set to {}", double(args["contact"]["dhat"]));
-			}
-			else
-			{
-				if (dhat > min_boundary_edge_length)
-					logger().warn("dhat larger than min boundary edge, {} > {}", dhat, min_boundary_edge_length);
-			}
+		// the polygonal, spline and periodic data depend on the geometry in ways that need a full build
+		if (args["space"]["basis_type"] == "Spline" || mesh->has_poly() || !polys.empty() || !poly_edge_to_data.empty()
+			|| has_periodic_bc() || mixed_assembler != nullptr)
+			return false;
+
+		// the geometric nodes have to be the mesh vertices, the other nodes are placed with the geometric mapping
+		for (const auto &gbs : geom_bases())
+			for (const auto &b : gbs.bases)
+				if (b.order() != 1 || b.global().size() != 1)
+					return false;
+
+		for (const auto &bs : bases)
+			for (const auto &b : bs.bases)
+				if (b.global().size() != 1)
+					return false;
+
+		return true;
+	}
+
+	void State::update_geometry()
+	{
+		if (!can_update_geometry())
+		{
+			build_basis();
+			return;
 		}
 
-		logger().info("n_bases {}", n_bases);
+		igl::Timer timer;
+		timer.start();
+		logger().info("Updating geometry...");
 
-		timings.building_basis_time = timer.getElapsedTime();
-		logger().info(" took {}s", timings.building_basis_time);
+		out_geom.reset_vis_cache();
+		rhs.resize(0, 0);
+		lin_factorization_valid = false;
 
-		logger().info("flipped elements {}", stats.n_flipped);
-		logger().info("h: {}", stats.mesh_size);
-		logger().info("n bases: {}", n_bases);
-		logger().info("n pressure bases: {}", n_pressure_bases);
+		std::vector<basis::ElementBases> &gbases = iso_parametric() ? bases : geom_bases_;
+		const std::vector<int> node_to_vertex = node_to_primitive();
+		for (auto &gbs : gbases)
+			for (auto &b : gbs.bases)
+				b.global()[0].node = mesh->point(node_to_vertex[b.global()[0].index]);
 
-		ass_vals_cache.clear();
-		mass_ass_vals_cache.clear();
-		if (n_bases <= args["solver"]["advanced"]["cache_size"])
+		if (!iso_parametric())
 		{
-			timer.start();
-			logger().info("Building cache...");
-			ass_vals_cache.init(mesh->is_volume(), bases, curret_bases);
-			mass_ass_vals_cache.init(mesh->is_volume(), bases, curret_bases, true);
-			if (mixed_assembler != nullptr)
-				pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases, curret_bases);
+			Eigen::MatrixXd local_pts, mapped;
+			for (int e = 0; e < bases.size(); ++e)
+			{
+				const int order = bases[e].bases.front().order();
+				if (mesh->is_volume())
+				{
+					if (mesh->is_simplex(e))
+						autogen::p_nodes_3d(order, local_pts);
+					else
+						autogen::q_nodes_3d(order, local_pts);
+				}
+				else
+				{
+					if (mesh->is_simplex(e))
+						autogen::p_nodes_2d(order, local_pts);
+					else
+						autogen::q_nodes_2d(order, local_pts);
+				}
+				assert(local_pts.rows() == bases[e].bases.size());
 
-			logger().info(" took {}s", timer.getElapsedTime());
+				gbases[e].eval_geom_mapping(local_pts, mapped);
+				for (int i = 0; i < bases[e].bases.size(); ++i)
+					bases[e].bases[i].global()[0].node = mapped.row(i);
+			}
 		}
 
-		out_geom.build_grid(*mesh, args["output"]["advanced"]["sol_on_grid"]);
+		update_nodal_positions();
 
-		if ((!problem->is_time_dependent() || args["time"]["quasistatic"]) && boundary_nodes.empty())
+		build_collision_mesh();
+		if (is_contact_enabled())
+			update_min_boundary_edge_length();
+
+		if (args["space"]["advanced"]["count_flipped_els"])
+			stats.count_flipped_elements(*mesh, geom_bases());
+		stats.compute_mesh_size(*mesh, geom_bases(), 10, args["output"]["advanced"]["curved_mesh_size"]);
+
+		// the element colouring only depends on the topology and is kept
+		if (n_bases <= args["solver"]["advanced"]["cache_size"])
 		{
-			if (has_periodic_bc())
-				logger().warn("(Quasi-)Static problem without Dirichlet nodes, will fix solution at one node to find a unique solution!");
-			else
-				log_and_throw_error("Static problem need to have some Dirichlet nodes!");
+			ass_vals_cache.clear();
+			mass_ass_vals_cache.clear();
+			set_cache_policy(args["solver"]["advanced"], {&ass_vals_cache, &mass_ass_vals_cache});
+			ass_vals_cache.init(mesh->is_volume(), bases, geom_bases());
+			mass_ass_vals_cache.init(mesh->is_volume(), bases, geom_bases(), true);
 		}
+
+		out_geom.build_grid(*mesh, geom_bases(), args["output"]["advanced"]["sol_on_grid"]);
+
+		timer.stop();
+		logger().info(" took {}s", timer.getElapsedTime());
 	}
 
 	void State::build_polygonal_basis()
@@ -1374,6 +1531,33 @@ namespace polyfem
 		Eigen::MatrixXi collision_edges, collision_triangles;
 		std::vector<Eigen::Triplet<double>> displacement_map_entries;
 
+		// static selection: only the selected boundary surfaces can come into contact, the rest is left out of the collision mesh
+		std::vector<mesh::LocalBoundary> contact_local_boundary;
+		const std::vector<mesh::LocalBoundary> *local_boundary = &total_local_boundary;
+		if (args.contains("/contact/static_surface_selection"_json_pointer)
+			&& !args.at("/contact/static_surface_selection"_json_pointer).empty())
+		{
+			const std::vector<int> ids = args.at("/contact/static_surface_selection"_json_pointer).get<std::vector<int>>();
+			const std::unordered_set<int> selected(ids.begin(), ids.end());
+
+			for (const mesh::LocalBoundary &lb : total_local_boundary)
+			{
+				mesh::LocalBoundary selected_lb(lb.element_id(), lb.type());
+				for (int i = 0; i < lb.size(); ++i)
+				{
+					if (selected.count(mesh.get_boundary_id(lb.global_primitive_id(i))))
+						selected_lb.add_boundary_primitive(lb.global_primitive_id(i), lb[i]);
+				}
+				if (!selected_lb.empty())
+					contact_local_boundary.push_back(selected_lb);
+			}
+
+			logger().debug(
+				"Contact restricted to {} of {} boundary elements",
+				contact_local_boundary.size(), total_local_boundary.size());
+			local_boundary = &contact_local_boundary;
+		}
+
 		if (args.contains("/contact/collision_mesh"_json_pointer)
 			&& args.at("/contact/collision_mesh/enabled"_json_pointer).get<bool>())
 		{
@@ -1399,11 +1583,34 @@ namespace polyfem
 					collision_mesh_args["max_edge_length"].get<double>());
 				igl::Timer timer;
 				timer.start();
-				build_collision_proxy(
-					bases, geom_bases, total_local_boundary, n_bases, mesh.dimension(),
-					collision_mesh_args["max_edge_length"], collision_vertices,
-					collision_triangles, displacement_map_entries,
-					collision_mesh_args["tessellation_type"]);
+
+				// the proxy only depends on the FE discretization and the proxy parameters, reuse it across runs
+				const std::string cache_path = utils::resolve_path(
+					collision_mesh_args.value("cache", ""), utils::json_value<std::string>(args, "root_path", ""));
+				size_t cache_key = 0;
+				bool loaded = false;
+				if (!cache_path.empty())
+				{
+					cache_key = collision_proxy_hash(
+						bases, geom_bases, *local_boundary, n_bases, mesh.dimension(),
+						collision_mesh_args["max_edge_length"], collision_mesh_args["tessellation_type"]);
+					loaded = load_collision_proxy_cache(
+						cache_path, cache_key, collision_vertices, collision_triangles, displacement_map_entries);
+					if (loaded)
+						logger().debug("Loaded collision proxy from {}", cache_path);
+				}
+
+				if (!loaded)
+				{
+					build_collision_proxy(
+						bases, geom_bases, *local_boundary, n_bases, mesh.dimension(),
+						collision_mesh_args["max_edge_length"], collision_vertices,
+						collision_triangles, displacement_map_entries,
+						collision_mesh_args["tessellation_type"]);
+					if (!cache_path.empty())
+						save_collision_proxy_cache(
+							cache_path, cache_key, collision_vertices, collision_triangles, displacement_map_entries);
+				}
 				if (collision_triangles.size())
 					igl::edges(collision_triangles, collision_edges);
 				timer.stop();
@@ -1417,7 +1624,7 @@ namespace polyfem
 		else
 		{
 			io::OutGeometryData::extract_boundary_mesh(
-				mesh, n_bases - obstacle.n_vertices(), bases, total_local_boundary,
+				mesh, n_bases - obstacle.n_vertices(), bases, *local_boundary,
 				collision_vertices, collision_edges, collision_triangles, displacement_map_entries);
 		}
 
@@ -1491,7 +1698,7 @@ namespace polyfem
 			return;
 		}
 
-		if (!problem->is_time_dependent())
+		if (!problem->is_time_dependent() && !args["solver"]["modal"]["analysis"])
 		{
 			avg_mass = 1;
 			timings.assembling_mass_mat_time = 0;
@@ -1558,6 +1765,8 @@ namespace polyfem
 		stats.num_dofs = mass.rows();
 		stats.mat_size = (long long)mass.rows() * (long long)mass.cols();
 		logger().info("sparsity: {}/{}", stats.nn_zero, stats.mat_size);
+
+		record_memory("assembly");
 	}
 
 	std::shared_ptr<RhsAssembler> State::build_rhs_assembler(
@@ -1697,63 +1906,132 @@ namespace polyfem
 
 		init_solve(sol, pressure);
 
-		if (problem->is_time_dependent())
+		try
 		{
-			const double t0 = args["time"]["t0"];
-			const int time_steps = args["time"]["time_steps"];
-			const double dt = args["time"]["dt"];
-
-			// Pre log the output path for easier watching
-			if (args["output"]["advanced"]["save_time_sequence"])
+			if (problem->is_time_dependent())
 			{
-				logger().info("Time sequence of simulation will be written to: \"{}\"",
-							  resolve_output_path(args["output"]["paraview"]["file_name"]));
-			}
+				const double t0 = args["time"]["t0"];
+				const int time_steps = args["time"]["time_steps"];
+				const double dt = args["time"]["dt"];
 
-			if (assembler->name() == "NavierStokes")
-				solve_transient_navier_stokes(time_steps, t0, dt, sol, pressure);
-			else if (assembler->name() == "OperatorSplitting")
-				solve_transient_navier_stokes_split(time_steps, dt, sol, pressure);
-			else if (is_homogenization())
-				solve_homogenization(time_steps, t0, dt, sol);
-			else if (is_problem_linear())
-				solve_transient_linear(time_steps, t0, dt, sol, pressure);
-			else if (!assembler->is_linear() && problem->is_scalar())
-				throw std::runtime_error("Nonlinear scalar problems are not supported yet!");
+				// Pre log the output path for easier watching
+				if (args["output"]["advanced"]["save_time_sequence"])
+				{
+					logger().info("Time sequence of simulation will be written to: \"{}\"",
+								  resolve_output_path(args["output"]["paraview"]["file_name"]));
+				}
+
+				if (assembler->name() == "NavierStokes")
+					solve_transient_navier_stokes(time_steps, t0, dt, sol, pressure);
+				else if (assembler->name() == "OperatorSplitting")
+					solve_transient_navier_stokes_split(time_steps, dt, sol, pressure);
+				else if (is_homogenization())
+					solve_homogenization(time_steps, t0, dt, sol);
+				else if (is_time_integrator_explicit())
+					solve_transient_tensor_explicit(time_steps, t0, dt, sol);
+				else if (is_problem_linear())
+					solve_transient_linear(time_steps, t0, dt, sol, pressure);
+				else if (!assembler->is_linear() && problem->is_scalar())
+					throw std::runtime_error("Nonlinear scalar problems are not supported yet!");
+				else
+					solve_transient_tensor_nonlinear(time_steps, t0, dt, sol);
+			}
 			else
-				solve_transient_tensor_nonlinear(time_steps, t0, dt, sol);
+			{
+				if (assembler->name() == "NavierStokes")
+					solve_navier_stokes(sol, pressure);
+				else if (is_homogenization())
+					solve_homogenization(/* time steps */ 0, /* t0 */ 0, /* dt */ 0, sol);
+				else if (is_problem_linear() && args["solver"]["modal"]["analysis"])
+					solve_modal(sol);
+				else if (is_problem_linear())
+				{
+					init_linear_solve(sol);
+					solve_linear(sol, pressure);
+					if (optimization_enabled != solver::CacheLevel::None)
+						cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
+				}
+				else if (!assembler->is_linear() && problem->is_scalar())
+					throw std::runtime_error("Nonlinear scalar problems are not supported yet!");
+				else
+				{
+					init_nonlinear_tensor_solve(sol);
+					solve_tensor_nonlinear(sol);
+					if (optimization_enabled != solver::CacheLevel::None)
+						cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
+
+					const std::string state_path = resolve_output_path(args["output"]["data"]["state"]);
+					if (!state_path.empty())
+						write_matrix(state_path, "u", sol);
+				}
+			}
 		}
-		else
+		catch (...)
 		{
-			if (assembler->name() == "NavierStokes")
-				solve_navier_stokes(sol, pressure);
-			else if (is_homogenization())
-				solve_homogenization(/* time steps */ 0, /* t0 */ 0, /* dt */ 0, sol);
-			else if (is_problem_linear())
+			// write the frames saved so far before reporting the error
+			try
 			{
-				init_linear_solve(sol);
-				solve_linear(sol, pressure);
-				if (optimization_enabled != solver::CacheLevel::None)
-					cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
+				out_geom.flush_output();
+				checkpoint_writer->flush();
 			}
-			else if (!assembler->is_linear() && problem->is_scalar())
-				throw std::runtime_error("Nonlinear scalar problems are not supported yet!");
-			else
+			catch (const std::exception &e)
 			{
-				init_nonlinear_tensor_solve(sol);
-				solve_tensor_nonlinear(sol);
-				if (optimization_enabled != solver::CacheLevel::None)
-					cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
-
-				const std::string state_path = resolve_output_path(args["output"]["data"]["state"]);
-				if (!state_path.empty())
-					write_matrix(state_path, "u", sol);
+				logger().error("Failed to write output: {}", e.what());
 			}
+			throw;
 		}
+		out_geom.flush_output();
+		checkpoint_writer->flush();
 
 		timer.stop();
 		timings.solving_time = timer.getElapsedTime();
 		logger().info(" took {}s", timings.solving_time);
+
+		record_memory("solve");
+	}
+
+	void State::solve_load_case(const json &load_case, Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
+	{
+		update_load_case(load_case);
+
+		assemble_rhs();
+		if (mass.size() == 0)
+			assemble_mass_mat();
+
+		solve_problem(sol, pressure);
+	}
+
+	void State::solve_load_cases(const std::vector<json> &load_cases, std::vector<Eigen::MatrixXd> &sols)
+	{
+		Eigen::MatrixXd rhs_cases;
+		std::vector<int> first_boundary_nodes;
+		for (int i = 0; i < load_cases.size(); ++i)
+		{
+			if (load_cases[i].contains("materials"))
+				log_and_throw_error("The load cases of a batch share the stiffness, use solve_load_case to change the materials!");
+
+			update_load_case(load_cases[i]);
+			if (i == 0)
+				first_boundary_nodes = boundary_nodes;
+			else if (boundary_nodes != first_boundary_nodes)
+				log_and_throw_error("The load cases of a batch must have the same Dirichlet nodes, case {} differs!", i);
+
+			assemble_rhs();
+			solve_data.rhs_assembler->set_bc(
+				local_boundary, boundary_nodes, n_boundary_samples(),
+				(assembler->name() != "Bilaplacian") ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
+
+			if (i == 0)
+				rhs_cases.resize(rhs.size(), load_cases.size());
+			rhs_cases.col(i) = rhs;
+		}
+
+		Eigen::MatrixXd sols_mat;
+		solve_linear_cases(rhs_cases, sols_mat);
+
+		sols.resize(load_cases.size());
+		for (int i = 0; i < load_cases.size(); ++i)
+			sols[i] = sols_mat.col(i);
 	}
 
 } // namespace polyfem
@@ -3,6 +3,7 @@
 #include <polyfem/Common.hpp>
 
 #include <polyfem/Units.hpp>
+#include <polyfem/StateConfig.hpp>
 
 #include <polyfem/basis/ElementBases.hpp>
 #include <polyfem/basis/InterfaceData.hpp>
@@ -31,6 +32,8 @@
 #include <polyfem/assembler/PeriodicBoundary.hpp>
 
 #include <polyfem/io/OutData.hpp>
+#include <polyfem/io/ReductionCSVWriter.hpp>
+#include <polyfem/io/SolutionFrameStore.hpp>
 
 #include <polysolve/linear/Solver.hpp>
 
@@ -97,6 +100,24 @@ namespace polyfem
 		/// initialize time settings if args contains "time"
 		void init_time();
 
+		/// swaps the load case of a generic problem, keeping the mesh, the bases, the assembly caches and,
+		/// when the stiffness and the Dirichlet nodes do not change, the factorization of the linear solver
+		/// the rhs (and the mass if the materials changed) need to be reassembled before solving, see solve_load_case
+		/// @param[in] load_case json with any of boundary_conditions, initial_conditions and materials, replacing the ones of args
+		void update_load_case(const json &load_case);
+
+		/// update_load_case followed by the rhs and mass assembly and the solve
+		/// @param[in] load_case new boundary_conditions, initial_conditions and/or materials
+		/// @param[out] sol solution
+		/// @param[out] pressure pressure
+		void solve_load_case(const json &load_case, Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
+
+		/// solves a static linear problem for several load cases with a single factorization of the stiffness,
+		/// the args are left with the last case
+		/// @param[in] load_cases boundary_conditions and/or initial_conditions of each case, with the same Dirichlet nodes
+		/// @param[out] sols solution of each case
+		void solve_load_cases(const std::vector<json> &load_cases, std::vector<Eigen::MatrixXd> &sols);
+
 		/// main input arguments containing all defaults
 		json args;
 
@@ -109,11 +130,13 @@ namespace polyfem
 		/// @param[in] log_level 0 all message, 6 no message. 2 is info, 1 is debug
 		/// @param[in] file_log_level 0 all message, 6 no message. 2 is info, 1 is debug
 		/// @param[in] is_quit quiets the log
+		/// @param[in] is_async writes the log from a background thread, the solver does not wait for the sinks
 		void init_logger(
 			const std::string &log_file,
 			const spdlog::level::level_enum log_level,
 			const spdlog::level::level_enum file_log_level,
-			const bool is_quiet);
+			const bool is_quiet,
+			const bool is_async = false);
 
 		/// initializing the logger writes to an output stream
 		/// @param[in] os output stream
@@ -136,7 +159,7 @@ namespace polyfem
 
 	private:
 		/// initializing the logger meant for internal usage
-		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level);
+		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level, const bool is_async = false);
 
 		/// logger sink to stdout
 		spdlog::sink_ptr console_sink_ = nullptr;
@@ -149,6 +172,9 @@ namespace polyfem
 
 		Units units;
 
+		/// typed snapshot of args used in the solve loops, built in init after validation
+		StateConfig config;
+
 		/// assemblers
 
 		/// assembler corresponding to governing physical equations
@@ -188,6 +214,8 @@ namespace polyfem
 
 		/// vector of discretization orders, used when not all elements have the same degree, one per element
 		Eigen::VectorXi disc_orders;
+		/// per element orders set by the adaptive p-refinement, override space/discr_order when not empty
+		Eigen::VectorXi adaptive_disc_orders;
 
 		/// Mapping from input nodes to FE nodes
 		std::shared_ptr<polyfem::mesh::MeshNodes> mesh_nodes, geom_mesh_nodes, pressure_mesh_nodes;
@@ -198,7 +226,7 @@ namespace polyfem
 		/// used to store assembly values for pressure for small problems
 		assembler::AssemblyValsCache pressure_ass_vals_cache;
 
-		/// Mass matrix, it is computed only for time dependent problems
+		/// Mass matrix, it is computed only for time dependent problems and modal analyses
 		StiffnessMatrix mass;
 		/// average system mass, used for contact with IPC
 		double avg_mass;
@@ -230,6 +258,18 @@ namespace polyfem
 		/// dirichlet_nodes, neumann_nodes, local_boundary, total_local_boundary
 		/// local_neumann_boundary, polys, poly_edge_to_data, rhs
 		void build_basis();
+		/// updates the geometry dependent quantities (node positions, assembly caches, collision mesh, mesh stats)
+		/// after moving the mesh vertices, reusing the node numbering, the boundary data and the bases;
+		/// falls back to build_basis if the discretization cannot be updated in place
+		void update_geometry();
+		/// if update_geometry can update the current bases in place
+		bool can_update_geometry() const;
+		/// adaptive p-refinement after a solve, raises the order of the elements with the largest
+		/// Zienkiewicz-Zhu indicators (space/adaptive_p_ref) and rebuilds the bases
+		/// the rhs, mass and solve need to be redone by the caller
+		/// @param[in] sol solution
+		/// @return number of elements whose order changed
+		int p_refine(const Eigen::MatrixXd &sol);
 		/// compute rhs, step 3 of solve
 		/// build rhs vector based on defined basis and given rhs of the problem
 		/// modifies rhs (and maybe more?)
@@ -279,6 +319,16 @@ namespace polyfem
 		void sol_to_pressure(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
 		/// builds bases for polygons, called inside build_basis
 		void build_polygonal_basis();
+		/// recomputes the positions of the dirichlet and neumann nodes from the bases
+		void update_nodal_positions();
+		/// factorizes the stiffness with the current boundary nodes into lin_solver_cached, unless it is still valid
+		void factorize_linear_stiffness();
+		/// splits the boundary of the mesh in dirichlet, neumann and pressure parts from the problem boundary ids
+		void setup_boundary_conditions();
+		/// sets the boundary and initial conditions of a generic problem from args
+		void set_problem_parameters();
+		/// recomputes the minimum edge length of the collision mesh
+		void update_min_boundary_edge_length();
 
 	public:
 		/// set the material and the problem dimension
@@ -316,6 +366,7 @@ namespace polyfem
 
 			solve_export_to_file = false;
 			solution_frames.clear();
+			init_solution_frame_store();
 			solve_problem(sol, pressure);
 			solve_export_to_file = true;
 		}
@@ -352,6 +403,33 @@ namespace polyfem
 		/// @param[in] dt timestep size
 		/// @param[out] sol solution
 		void solve_transient_tensor_nonlinear(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
+		/// replace the initial guess of the next time step with the prediction selected by time/predictor,
+		/// the boundary conditions are left to the solver and the prediction is clamped to stay intersection-free
+		/// @param[in,out] sol solution at the previous time step, initial guess of the next one
+		void predict_solution(Eigen::MatrixXd &sol) const;
+		/// solves transient tensor nonlinear problem with an adaptive time step, the local error is estimated
+		/// from the difference with the explicit prediction and failed steps are retried with a smaller step
+		/// @param[in] t0 initial time
+		/// @param[in] tend final time
+		/// @param[in] dt initial timestep size
+		/// @param[out] sol solution
+		void solve_transient_tensor_nonlinear_adaptive(const double t0, const double tend, const double dt, Eigen::MatrixXd &sol);
+		/// solves transient tensor nonlinear problem with parareal (see time/parareal): the time steps are split in slices,
+		/// a coarse propagator with a few large steps runs sequentially over them and the fine steps of the slices run in
+		/// parallel, each thread on its own copy of the state, until the slice boundaries stop changing
+		/// @param[in] time_steps number of time steps
+		/// @param[in] t0 initial time
+		/// @param[in] dt timestep size of the fine propagator
+		/// @param[out] sol solution
+		void solve_transient_tensor_nonlinear_parareal(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
+		/// solves transient tensor problems with the explicit central difference integrator (no linear solve)
+		/// @param[in] time_steps number of time steps
+		/// @param[in] t0 initial times
+		/// @param[in] dt timestep size, split in substeps below the stable step
+		/// @param[out] sol solution
+		void solve_transient_tensor_explicit(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
+		/// if the time integrator is explicit
+		bool is_time_integrator_explicit() const;
 		/// initialize the nonlinear solver
 		/// @param[out] sol solution
 		/// @param[in] t (optional) initial time
@@ -372,6 +450,25 @@ namespace polyfem
 		/// @param[out] sol solution
 		/// @param[out] pressure pressure
 		void solve_linear(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
+		/// solves a static linear problem for several right-hand sides with a single factorization of the stiffness
+		/// @param[in] rhs_cases one right-hand side per column, with the Dirichlet values in the boundary rows as after set_bc
+		/// @param[out] sols one solution per column
+		void solve_linear_cases(const Eigen::MatrixXd &rhs_cases, Eigen::MatrixXd &sols);
+		/// solves a static Helmholtz problem for several wavenumbers, the stiffness K and the mass M (weighted by k^2) are
+		/// assembled once and the operator K - s^2 M of each scale s is formed on their common pattern, so the symbolic
+		/// factorization is reused. The scales are distributed over the threads, each with its own solver.
+		/// The right-hand side (source, Neumann, and Dirichlet values) does not depend on the wavenumber.
+		/// @param[in] k_scales factors of the wavenumber k of the materials, the wavenumbers themselves if k is 1
+		/// @param[out] sols one solution per scale
+		void solve_frequency_sweep(const std::vector<double> &k_scales, std::vector<Eigen::MatrixXd> &sols);
+		/// modal analysis of a linear problem (see solver/modal), the modes are stored in modal_eigenvalues and modal_shapes,
+		/// written to output/data/modes, and saved as a time sequence
+		/// @param[out] sol first mode
+		void solve_modal(Eigen::MatrixXd &sol);
+		/// eigenvalues of the last modal analysis (or of the modal superposition), increasing
+		Eigen::VectorXd modal_eigenvalues;
+		/// M-orthonormal modes of the last modal analysis, one per column
+		Eigen::MatrixXd modal_shapes;
 		/// solves a navier stokes
 		/// @param[out] sol solution
 		/// @param[out] pressure pressure
@@ -380,6 +477,28 @@ namespace polyfem
 		/// @param[out] sol solution
 		/// @param[in] t (optional) time step id
 		void solve_tensor_nonlinear(Eigen::MatrixXd &sol, const int t = 0, const bool init_lagging = true);
+		/// solves a static nonlinear tensor problem restricted to the span of a reduced basis (Galerkin projection),
+		/// used as a cheap surrogate of solve_problem during the line search of an optimization
+		/// @param[in] basis full-size basis vectors (columns), eg POD modes of previous solutions
+		/// @param[in] max_iterations maximum number of reduced Newton iterations
+		/// @param[in] tolerance relative tolerance on the norm of the projected gradient
+		/// @param[out] sol solution, cached for the adjoint if optimization is enabled
+		/// @return false if the problem cannot be reduced or the reduced Newton did not converge, a full solve is then needed
+		bool solve_reduced_order(const Eigen::MatrixXd &basis, const int max_iterations, const double tolerance, Eigen::MatrixXd &sol);
+		/// builds the reduced-order model of a transient hyperelastic run (see solver/reduced_order): the basis
+		/// (linear modes, modal derivatives, POD of snapshots, or a file) in reduced_order_basis and, if enabled,
+		/// the element sampling of the elastic assembler trained on the snapshots
+		void init_reduced_order_model();
+		/// one time step restricted to the span of reduced_order_basis, the time integrator is not updated
+		/// @param[in,out] sol predicted solution, replaced by the reduced solution
+		/// @return false if the reduced Newton did not converge, a full-order step is then needed
+		bool solve_reduced_order_step(Eigen::MatrixXd &sol);
+		/// one time step with L-BFGS initialized by the hessian factorized at its start (see solver/quasi_newton)
+		/// @param[in,out] sol predicted solution, replaced by the solution if converged
+		/// @return false if the boundary conditions cannot be applied directly or L-BFGS did not converge, a Newton solve is then needed
+		bool solve_quasi_newton_step(Eigen::MatrixXd &sol);
+		/// full-size orthonormal basis of the reduced-order model, one vector per column
+		Eigen::MatrixXd reduced_order_basis;
 
 		/// factory to create the nl solver depending on input
 		/// @return nonlinear solver (eg newton or LBFGS)
@@ -389,7 +508,7 @@ namespace polyfem
 		std::shared_ptr<utils::PeriodicBoundary> periodic_bc;
 		bool has_periodic_bc() const
 		{
-			return args["boundary_conditions"]["periodic_boundary"]["enabled"].get<bool>();
+			return config.periodic_bc();
 		}
 
 		/// @brief Solve the linear problem with the given solver and system.
@@ -457,6 +576,8 @@ namespace polyfem
 	private:
 		/// build the mapping from input nodes to polyfem nodes
 		void build_node_mapping();
+		/// renumber the nodes of bases to reduce the bandwidth of the assembled matrices, called inside build_basis
+		void reorder_nodes();
 
 		//---------------------------------------------------
 		//-----------------Geometry--------------------------
@@ -484,11 +605,12 @@ namespace polyfem
 		/// @param[in] skip_boundary_sideset skip_boundary_sideset = false it uses the lambda boundary_marker to assign the sideset
 		void load_mesh(GEO::Mesh &meshin, const std::function<int(const size_t, const std::vector<int> &, const RowVectorNd &, bool)> &boundary_marker, bool non_conforming = false, bool skip_boundary_sideset = false);
 
-		/// loads the mesh from V and F,
+		/// loads the mesh from V and F, they can be views of buffers owned by the caller (see utils::row_major_view)
+		/// which are read once while building the mesh
 		/// @param[in] V is #vertices x dim
 		/// @param[in] F is #elements x size (size = 3 for triangle mesh, size=4 for a quad mesh if dim is 2)
 		/// @param[in] non_conforming creates a conforming/non conforming mesh
-		void load_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, bool non_conforming = false)
+		void load_mesh(const ConstMatrixXdView &V, const ConstMatrixXiView &F, bool non_conforming = false)
 		{
 			mesh = mesh::Mesh::create(V, F, non_conforming);
 			load_mesh(non_conforming);
@@ -497,6 +619,10 @@ namespace polyfem
 		/// Resets the mesh
 		void reset_mesh();
 
+		/// Resets the mesh quantities after the mesh was replaced by a remeshed one,
+		/// the materials are set for the new elements and the obstacles are kept instead of being read again
+		void reload_remeshed_mesh();
+
 		/// Build the mesh matrices (vertices and elements) from the mesh using the bases node ordering
 		void build_mesh_matrices(Eigen::MatrixXd &V, Eigen::MatrixXi &F);
 
@@ -550,7 +676,7 @@ namespace polyfem
 		/// @return true/false
 		bool is_contact_enabled() const
 		{
-			return args["contact"]["enabled"];
+			return config.contact_enabled();
 		}
 
 		/// @brief does the simulation has pressure
@@ -558,8 +684,7 @@ namespace polyfem
 		/// @return true/false
 		bool is_pressure_enabled() const
 		{
-			return (args["boundary_conditions"]["pressure_boundary"].size() > 0)
-				   || (args["boundary_conditions"]["pressure_cavity"].size() > 0);
+			return config.pressure_enabled();
 		}
 
 		/// stores if input json contains dhat
@@ -577,8 +702,16 @@ namespace polyfem
 		bool solve_export_to_file = true;
 		/// saves the frames in a vector instead of VTU
 		std::vector<io::SolutionFrame> solution_frames;
+		/// compressed frames, used instead of solution_frames if output/advanced/solution_frames/compress
+		std::shared_ptr<io::SolutionFrameStore> solution_frame_store;
 		/// visualization stuff
 		io::OutGeometryData out_geom;
+		/// time of every saved step, written to the pvd (the steps are not uniform with adaptive time stepping)
+		std::vector<double> output_times;
+		/// writes the output/reductions of every time step to reductions.csv
+		std::shared_ptr<io::ReductionCSVWriter> reduction_writer;
+		/// writes the checkpoints (state and restart json), on a background thread if output/data/async_checkpoint
+		std::shared_ptr<io::AsyncWriter> checkpoint_writer = std::make_shared<io::AsyncWriter>();
 		/// runtime statistics
 		io::OutRuntimeData timings;
 		/// Other statistics
@@ -592,6 +725,22 @@ namespace polyfem
 		/// @param[in] pressure pressure
 		void export_data(const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure);
 
+		/// number of rows of the buffers of get_input_node_solution and get_input_node_stress
+		int n_input_nodes() const { return in_node_to_node.size(); }
+
+		/// copies the solution at the nodes of the input mesh, in their input order, into a buffer owned by the caller
+		/// @param[in] sol solution
+		/// @param[out] out n_input_nodes() x (1 or dim), e.g., a utils::row_major_view of an interleaved buffer
+		void get_input_node_solution(const Eigen::MatrixXd &sol, MatrixXdView out) const;
+
+		/// evaluates the stress at the nodes of the input mesh, averaged over the incident elements,
+		/// into buffers owned by the caller
+		/// @param[in] sol solution
+		/// @param[in] t time
+		/// @param[out] stress n_input_nodes() x dim^2, row-major tensors
+		/// @param[out] von_mises n_input_nodes() x 1
+		void get_input_node_stress(const Eigen::MatrixXd &sol, const double t, MatrixXdView stress, MatrixXdView von_mises) const;
+
 		/// saves a timestep
 		/// @param[in] time time in secs
 		/// @param[in] t time index
@@ -608,6 +757,11 @@ namespace polyfem
 		/// @param[in] pressure pressure
 		void save_subsolve(const int i, const int t, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure);
 
+		/// creates the compressed frame store if output/advanced/solution_frames/compress, removes it otherwise
+		void init_solution_frame_store();
+		/// moves the saved solution frames to the compressed frame store, if any
+		void store_solution_frames();
+
 		/// saves the output statistic to a stream
 		/// @param[in] sol solution
 		/// @param[out] out stream to write output
@@ -617,12 +771,24 @@ namespace polyfem
 		/// @param[in] sol solution
 		void save_json(const Eigen::MatrixXd &sol);
 
+		/// stores the current and peak resident memory and the size of the main data structures in stats.memory
+		/// @param[in] phase name of the phase that just ended (load, basis, assembly, solve, output)
+		void record_memory(const std::string &phase);
+
 		/// @brief computes all errors
 		void compute_errors(const Eigen::MatrixXd &sol);
 
 		/// @brief Save a JSON sim file for restarting the simulation at time t
 		/// @param t current time to restart at
-		void save_restart_json(const double t0, const double dt, const int t) const;
+		/// @param dt time step size to restart with
+		/// @param step index of the current time step (used in the output file names)
+		void save_restart_json(const double t, const double dt, const int step) const;
+
+		/// @brief Save the time integrator state and the restart JSON every output/data/checkpoint_interval steps
+		/// @param t current time to restart at
+		/// @param dt time step size to restart with
+		/// @param step index of the current time step (used in the output file names)
+		void save_checkpoint(const double t, const double dt, const int step);
 
 		//-----------PATH management
 		/// Get the root path for the state (e.g., args["root_path"] or ".")
@@ -650,6 +816,18 @@ namespace polyfem
 
 		std::unique_ptr<polysolve::linear::Solver> lin_solver_cached; // matrix factorization of last linear solve
 
+		/// keep the factorization of static linear solves in lin_solver_cached and reuse it while the
+		/// stiffness and the Dirichlet nodes do not change, e.g., when swapping load cases
+		bool keep_linear_factorization = false;
+
+	private:
+		/// stiffness of the factorization in lin_solver_cached, before the Dirichlet conditions are applied
+		StiffnessMatrix lin_stiffness_cached;
+		/// if lin_solver_cached holds the factorization of lin_stiffness_cached with the current boundary nodes
+		bool lin_factorization_valid = false;
+
+	public:
+
 		int ndof() const
 		{
 			const int actual_dim = problem->is_scalar() ? 1 : mesh->dimension();
@@ -708,6 +886,13 @@ namespace polyfem
 		void solve_homogenization_step(Eigen::MatrixXd &sol, const int t = 0, bool adaptive_initial_weight = false); // sol is the extended solution, i.e. [periodic fluctuation, macro strain]
 		void init_homogenization_solve(const double t);
 		void solve_homogenization(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
+		/// solves the same unit cell for many macro strains, reusing the mesh, bases, periodic maps and forms.
+		/// Only the fixed entries (fixed_macro_strain) of each strain are imposed. Linear problems factorize the
+		/// hessian once and every strain is a back-substitution, nonlinear solves are warm-started from the
+		/// closest strain solved so far. The prescribed macro strain is restored at the end.
+		/// @param[in] macro_strains dim x dim macro strains
+		/// @param[out] sols extended solutions [periodic fluctuation, macro strain], one per strain
+		void solve_homogenization_batch(const std::vector<Eigen::MatrixXd> &macro_strains, std::vector<Eigen::MatrixXd> &sols);
 		bool is_homogenization() const
 		{
 			return args["boundary_conditions"]["periodic_boundary"]["linear_displacement_offset"].size() > 0;
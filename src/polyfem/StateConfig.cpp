@@ -0,0 +1,22 @@
+#include "StateConfig.hpp"
+
+namespace polyfem
+{
+	void StateConfig::init(const json &args)
+	{
+		contact_enabled_ = args["contact"]["enabled"];
+		pressure_enabled_ = (args["boundary_conditions"]["pressure_boundary"].size() > 0)
+							|| (args["boundary_conditions"]["pressure_cavity"].size() > 0);
+		periodic_bc_ = args["boundary_conditions"]["periodic_boundary"]["enabled"];
+		remesh_enabled_ = args["space"]["remesh"]["enabled"];
+		static_condensation_ = args["solver"]["advanced"]["static_condensation"];
+
+		friction_convergence_tol_ = args["solver"]["contact"].value("friction_convergence_tol", 1e-2);
+
+		const json &al = args["solver"]["augmented_lagrangian"];
+		al_initial_weight_ = al["initial_weight"];
+		al_scaling_ = al["scaling"];
+		al_max_weight_ = al["max_weight"];
+		al_eta_ = al["eta"];
+	}
+} // namespace polyfem
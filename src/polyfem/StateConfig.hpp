@@ -0,0 +1,42 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+namespace polyfem
+{
+	/// Typed snapshot of the validated input arguments read by the solve paths,
+	/// so that they do not look up the json in every iteration. Built once in State::init.
+	class StateConfig
+	{
+	public:
+		void init(const json &args);
+
+		bool contact_enabled() const { return contact_enabled_; }
+		bool pressure_enabled() const { return pressure_enabled_; }
+		bool periodic_bc() const { return periodic_bc_; }
+		bool remesh_enabled() const { return remesh_enabled_; }
+		bool static_condensation() const { return static_condensation_; }
+
+		/// convergence tolerance of the friction lagging, relative to the characteristic length
+		double friction_convergence_tol() const { return friction_convergence_tol_; }
+
+		double al_initial_weight() const { return al_initial_weight_; }
+		double al_scaling() const { return al_scaling_; }
+		double al_max_weight() const { return al_max_weight_; }
+		double al_eta() const { return al_eta_; }
+
+	private:
+		bool contact_enabled_ = false;
+		bool pressure_enabled_ = false;
+		bool periodic_bc_ = false;
+		bool remesh_enabled_ = false;
+		bool static_condensation_ = false;
+
+		double friction_convergence_tol_ = 1e-2;
+
+		double al_initial_weight_ = 0;
+		double al_scaling_ = 0;
+		double al_max_weight_ = 0;
+		double al_eta_ = 0;
+	};
+} // namespace polyfem
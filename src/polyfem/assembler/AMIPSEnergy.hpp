@@ -56,6 +56,9 @@ namespace polyfem::assembler
 	public:
 		AMIPSEnergyAutodiff();
 
+		// the energy only depends on the deformation gradient
+		static constexpr bool use_def_grad_kernels = true;
+
 		// sets material params
 		void add_multimaterial(const int index, const json &params, const Units &units) override;
 
@@ -1,12 +1,18 @@
 #include "Assembler.hpp"
 
+#include <polyfem/basis/TensorProductHex.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Profiler.hpp>
 
 #include <igl/Timer.h>
 
 #include <ipc/utils/eigen_ext.hpp>
 
+#include <algorithm>
+#include <array>
+#include <memory>
+
 namespace polyfem::assembler
 {
 	using namespace basis;
@@ -73,6 +79,11 @@ namespace polyfem::assembler
 			ElementAssemblyValues vals;
 			QuadratureVector da;
 
+			/// sum factorization of the last tensor-product hex, reused by the elements with the same order and quadrature
+			std::shared_ptr<const TensorProductHex> tensor_hex;
+			Eigen::VectorXd points_1d;
+			Eigen::MatrixXd stiffness;
+
 			LocalThreadVecStorage(const int size)
 			{
 				vec.resize(size, 1);
@@ -92,8 +103,283 @@ namespace polyfem::assembler
 				val = 0;
 			}
 		};
+
+		/// calls f with the dimension and the number of local bases as compile-time constants
+		/// for P1/P2 triangles and tets and Q1/Q2 quads and hexes, returns false for any other element
+		template <typename F>
+		bool dispatch_fixed_size(const int dim, const int n_loc_bases, F &&f)
+		{
+			using std::integral_constant;
+			if (dim == 2)
+			{
+				switch (n_loc_bases)
+				{
+				case 3: f(integral_constant<int, 2>(), integral_constant<int, 3>()); return true;
+				case 4: f(integral_constant<int, 2>(), integral_constant<int, 4>()); return true;
+				case 6: f(integral_constant<int, 2>(), integral_constant<int, 6>()); return true;
+				case 9: f(integral_constant<int, 2>(), integral_constant<int, 9>()); return true;
+				default: return false;
+				}
+			}
+			else if (dim == 3)
+			{
+				switch (n_loc_bases)
+				{
+				case 4: f(integral_constant<int, 3>(), integral_constant<int, 4>()); return true;
+				case 8: f(integral_constant<int, 3>(), integral_constant<int, 8>()); return true;
+				case 10: f(integral_constant<int, 3>(), integral_constant<int, 10>()); return true;
+				case 27: f(integral_constant<int, 3>(), integral_constant<int, 27>()); return true;
+				default: return false;
+				}
+			}
+			return false;
+		}
+
+		/// scatters a local (n_loc_bases * dim)^2 matrix to its global entries by calling write(gi, gj, value),
+		/// the traversal order is the same for every element and is relied on by the slot cache of SparseMatrixCache
+		template <int DIM, int N_LOC_BASES, typename Write>
+		void scatter_local_matrix(const int dim, const int n_loc_bases, const ElementAssemblyValues &vals, const Eigen::MatrixXd &local, Write &&write)
+		{
+			// loop bounds are compile-time constants for the fixed size instances (DIM > 0)
+			const int size = DIM > 0 ? DIM : dim;
+			const int n = N_LOC_BASES > 0 ? N_LOC_BASES : n_loc_bases;
+			assert(size == dim && n == n_loc_bases);
+			assert(local.rows() == n * size && local.cols() == n * size);
+
+			for (int i = 0; i < n; ++i)
+			{
+				const auto &global_i = vals.basis_values[i].global;
+
+				for (int j = 0; j < n; ++j)
+				{
+					const auto &global_j = vals.basis_values[j].global;
+
+					for (int c = 0; c < size; ++c)
+					{
+						for (int r = 0; r < size; ++r)
+						{
+							const double local_value = local(i * size + r, j * size + c);
+
+							for (size_t ii = 0; ii < global_i.size(); ++ii)
+							{
+								const auto gi = global_i[ii].index * size + r;
+								const auto wi = global_i[ii].val;
+
+								for (size_t jj = 0; jj < global_j.size(); ++jj)
+								{
+									const auto gj = global_j[jj].index * size + c;
+									const auto wj = global_j[jj].val;
+
+									write(gi, gj, local_value * wi * wj);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		template <typename Write>
+		void scatter_local_matrix(const int dim, const ElementAssemblyValues &vals, const Eigen::MatrixXd &local, Write &&write)
+		{
+			const int n_loc_bases = int(vals.basis_values.size());
+			if (!dispatch_fixed_size(dim, n_loc_bases, [&](auto d, auto n) {
+					scatter_local_matrix<decltype(d)::value, decltype(n)::value>(dim, n_loc_bases, vals, local, write);
+				}))
+				scatter_local_matrix<-1, -1>(dim, n_loc_bases, vals, local, write);
+		}
+
+		/// calls write(gi, gj, block, weight) with the dim x dim block of the local matrix coupling two local bases for
+		/// every pair (gi, gj) of their global nodes, the traversal order is the same for every element and is relied on
+		/// by the block slots of BlockSparseMatrixCache
+		template <int DIM, int N_LOC_BASES, typename Write>
+		void scatter_local_blocks(const int dim, const int n_loc_bases, const ElementAssemblyValues &vals, const Eigen::MatrixXd &local, Write &&write)
+		{
+			const int size = DIM > 0 ? DIM : dim;
+			const int n = N_LOC_BASES > 0 ? N_LOC_BASES : n_loc_bases;
+			assert(size == dim && n == n_loc_bases);
+			assert(local.rows() == n * size && local.cols() == n * size);
+
+			for (int i = 0; i < n; ++i)
+			{
+				const auto &global_i = vals.basis_values[i].global;
+
+				for (int j = 0; j < n; ++j)
+				{
+					const auto &global_j = vals.basis_values[j].global;
+					const auto block = local.block<DIM, DIM>(i * size, j * size, size, size);
+
+					for (size_t ii = 0; ii < global_i.size(); ++ii)
+						for (size_t jj = 0; jj < global_j.size(); ++jj)
+							write(global_i[ii].index, global_j[jj].index, block, global_i[ii].val * global_j[jj].val);
+				}
+			}
+		}
+
+		template <typename Write>
+		void scatter_local_blocks(const int dim, const ElementAssemblyValues &vals, const Eigen::MatrixXd &local, Write &&write)
+		{
+			const int n_loc_bases = int(vals.basis_values.size());
+			if (!dispatch_fixed_size(dim, n_loc_bases, [&](auto d, auto n) {
+					scatter_local_blocks<decltype(d)::value, decltype(n)::value>(dim, n_loc_bases, vals, local, write);
+				}))
+				scatter_local_blocks<-1, -1>(dim, n_loc_bases, vals, local, write);
+		}
+
+		/// adds a local n_loc_bases * dim vector to its global entries of vec
+		template <int DIM, int N_LOC_BASES>
+		void scatter_local_vector(const int dim, const int n_loc_bases, const ElementAssemblyValues &vals, const Eigen::VectorXd &local, Eigen::MatrixXd &vec)
+		{
+			const int size = DIM > 0 ? DIM : dim;
+			const int n = N_LOC_BASES > 0 ? N_LOC_BASES : n_loc_bases;
+			assert(size == dim && n == n_loc_bases);
+			assert(local.size() == n * size);
+
+			for (int j = 0; j < n; ++j)
+			{
+				const auto &global_j = vals.basis_values[j].global;
+
+				for (int m = 0; m < size; ++m)
+				{
+					const double local_value = local(j * size + m);
+
+					for (size_t jj = 0; jj < global_j.size(); ++jj)
+						vec(global_j[jj].index * size + m) += local_value * global_j[jj].val;
+				}
+			}
+		}
+
+		void scatter_local_vector(const int dim, const ElementAssemblyValues &vals, const Eigen::VectorXd &local, Eigen::MatrixXd &vec)
+		{
+			const int n_loc_bases = int(vals.basis_values.size());
+			if (!dispatch_fixed_size(dim, n_loc_bases, [&](auto d, auto n) {
+					scatter_local_vector<decltype(d)::value, decltype(n)::value>(dim, n_loc_bases, vals, local, vec);
+				}))
+				scatter_local_vector<-1, -1>(dim, n_loc_bases, vals, local, vec);
+		}
+
+		/// product of the hessian of a tensor-product hex with the local coefficients v (n_loc_bases x 3), the gradients
+		/// of v and the integration against the gradients of the bases are sum-factorized, the stiffness tensor
+		/// (n_quadrature_points x 81) is applied point by point
+		Eigen::VectorXd apply_tensor_product_hessian(const TensorProductHex &hex, const ElementAssemblyValues &vals, const QuadratureVector &da, const Eigen::MatrixXd &stiffness, const Eigen::MatrixXd &v)
+		{
+			const int n_points = hex.n_quadrature_points();
+			assert(v.cols() == 3 && stiffness.rows() == n_points && stiffness.cols() == 81);
+
+			std::array<Eigen::MatrixXd, 3> grads;
+			hex.gradients(v, grads);
+
+			std::array<Eigen::MatrixXd, 3> fluxes;
+			for (auto &f : fluxes)
+				f.resize(n_points, 3);
+
+			Eigen::Matrix3d ref_grad, dP;
+			for (int q = 0; q < n_points; ++q)
+			{
+				const Eigen::Matrix3d jac_it = vals.jac_it[q];
+				for (int r = 0; r < 3; ++r)
+					ref_grad.col(r) = grads[r].row(q).transpose();
+				const Eigen::Matrix3d dF = ref_grad * jac_it;
+
+				for (int i = 0, idx = 0; i < 3; ++i)
+					for (int j = 0; j < 3; ++j)
+					{
+						double val = 0;
+						for (int k = 0; k < 3; ++k)
+							for (int l = 0; l < 3; ++l)
+								val += stiffness(q, idx++) * dF(k, l);
+						dP(i, j) = val;
+					}
+
+				const Eigen::Matrix3d flux = da(q) * dP * jac_it.transpose();
+				for (int r = 0; r < 3; ++r)
+					fluxes[r].row(q) = flux.col(r).transpose();
+			}
+
+			Eigen::MatrixXd out;
+			hex.integrate_gradients(fluxes, out);
+
+			Eigen::VectorXd local_out(out.size());
+			for (int j = 0; j < out.rows(); ++j)
+				for (int m = 0; m < 3; ++m)
+					local_out(j * 3 + m) = out(j, m);
+			return local_out;
+		}
 	} // namespace
 
+	struct NLAssembler::Workspace
+	{
+		using MatStorage = decltype(create_thread_storage(std::declval<const LocalThreadMatStorage &>()));
+		using VecStorage = decltype(create_thread_storage(std::declval<const LocalThreadVecStorage &>()));
+		using ScalarStorage = decltype(create_thread_storage(std::declval<const LocalThreadScalarStorage &>()));
+
+		std::unique_ptr<MatStorage> mat;
+		const MatrixCache *mat_cache = nullptr; ///< cache the triplet storages were created for
+
+		std::unique_ptr<VecStorage> vec;
+		int vec_size = -1;
+
+		std::unique_ptr<ScalarStorage> scalar;
+
+		/// thread storages of triplets for mat_cache, the reserved buffers are kept between calls
+		MatStorage &mat_storage(const int buffer_size, const MatrixCache &c)
+		{
+			if (mat == nullptr || mat_cache != &c)
+			{
+				mat = std::make_unique<MatStorage>(create_thread_storage(LocalThreadMatStorage(buffer_size, c)));
+				mat_cache = &c;
+			}
+			else
+			{
+				for (LocalThreadMatStorage &local_storage : *mat)
+					local_storage.init(buffer_size, c);
+			}
+			return *mat;
+		}
+
+		/// frees the triplet storages once the assembly writes directly in the values of the cache
+		void release_mat_storage()
+		{
+			mat.reset();
+			mat_cache = nullptr;
+		}
+
+		/// thread storages of zeroed vectors of the given size
+		VecStorage &vec_storage(const int size)
+		{
+			if (vec == nullptr || vec_size != size)
+			{
+				vec = std::make_unique<VecStorage>(create_thread_storage(LocalThreadVecStorage(size)));
+				vec_size = size;
+			}
+			else
+			{
+				for (LocalThreadVecStorage &local_storage : *vec)
+					local_storage.vec.setZero();
+			}
+			return *vec;
+		}
+
+		ScalarStorage &scalar_storage()
+		{
+			if (scalar == nullptr)
+				scalar = std::make_unique<ScalarStorage>(create_thread_storage(LocalThreadScalarStorage()));
+			else
+			{
+				for (LocalThreadScalarStorage &local_storage : *scalar)
+					local_storage.val = 0;
+			}
+			return *scalar;
+		}
+	};
+
+	NLAssembler::Workspace &NLAssembler::workspace() const
+	{
+		if (workspace_ == nullptr)
+			workspace_ = std::make_shared<Workspace>();
+		return *workspace_;
+	}
+
 	void Assembler::set_materials(const std::vector<int> &body_ids, const json &body_params, const Units &units)
 	{
 		if (!body_params.is_array())
@@ -164,6 +450,7 @@ namespace polyfem::assembler
 		StiffnessMatrix &stiffness,
 		const bool is_mass) const
 	{
+		POLYFEM_PROFILE_ZONE("LinearAssembler::assemble");
 		assert(size() > 0);
 
 		const long int max_triplets_size = long(1e7);
@@ -192,13 +479,12 @@ namespace polyfem::assembler
 
 				for (int e = start; e < end; ++e)
 				{
-					ElementAssemblyValues &vals = local_storage.vals;
 					// igl::Timer timer; timer.start();
 					// vals.compute(e, is_volume, bases[e], gbases[e]);
 
 					// compute geometric mapping
 					// evaluate and store basis functions/their gradients at quadrature points
-					cache.compute(e, is_volume, bases[e], gbases[e], vals);
+					const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
 					const Quadrature &quadrature = vals.quadrature;
 
@@ -387,6 +673,32 @@ namespace polyfem::assembler
 	{
 	}
 
+	void MixedAssembler::assemble_local(
+		const ElementAssemblyValues &psi_vals,
+		const ElementAssemblyValues &phi_vals,
+		const double t,
+		const QuadratureVector &da,
+		Eigen::MatrixXd &local) const
+	{
+		const int n_phi_loc_bases = int(phi_vals.basis_values.size());
+		const int n_psi_loc_bases = int(psi_vals.basis_values.size());
+
+		local.resize(n_phi_loc_bases * rows(), n_psi_loc_bases * cols());
+
+		for (int i = 0; i < n_psi_loc_bases; ++i)
+		{
+			for (int j = 0; j < n_phi_loc_bases; ++j)
+			{
+				const auto stiffness_val = assemble(MixedAssemblerData(psi_vals, phi_vals, t, i, j, da));
+				assert(stiffness_val.size() == rows() * cols());
+
+				for (int n = 0; n < rows(); ++n)
+					for (int m = 0; m < cols(); ++m)
+						local(j * rows() + n, i * cols() + m) = stiffness_val(n * cols() + m);
+			}
+		}
+	}
+
 	void MixedAssembler::assemble(
 		const bool is_volume,
 		const int n_psi_basis,
@@ -399,82 +711,157 @@ namespace polyfem::assembler
 		const double t,
 		StiffnessMatrix &stiffness) const
 	{
+		POLYFEM_PROFILE_ZONE("MixedAssembler::assemble");
 		assert(size() > 0);
 		assert(phi_bases.size() == psi_bases.size());
 
-		const int max_triplets_size = int(1e7);
-		const int buffer_size = std::min(long(max_triplets_size), long(std::max(n_psi_basis, n_phi_basis)) * std::max(rows(), cols()));
-		// logger().debug("buffer_size {}", buffer_size);
-
-		stiffness.resize(n_phi_basis * rows(), n_psi_basis * cols());
-		stiffness.setZero();
-
-		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, stiffness.rows(), stiffness.cols()));
-
 		const int n_bases = int(phi_bases.size());
 		igl::Timer timer;
-		timer.start();
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
-			ElementAssemblyValues psi_vals, phi_vals;
+		// computes the local block of e and passes its weighted entries to write(row, col, value)
+		const auto assemble_element = [&](const int e, ElementAssemblyValues &tmp_psi_vals, ElementAssemblyValues &tmp_phi_vals, QuadratureVector &da, Eigen::MatrixXd &local, const auto &write) {
+			const ElementAssemblyValues &psi_vals = psi_cache.get(e, is_volume, psi_bases[e], gbases[e], tmp_psi_vals);
+			const ElementAssemblyValues &phi_vals = phi_cache.get(e, is_volume, phi_bases[e], gbases[e], tmp_phi_vals);
 
-			for (int e = start; e < end; ++e)
-			{
-				// psi_vals.compute(e, is_volume, psi_bases[e], gbases[e]);
-				// phi_vals.compute(e, is_volume, phi_bases[e], gbases[e]);
-				psi_cache.compute(e, is_volume, psi_bases[e], gbases[e], psi_vals);
-				phi_cache.compute(e, is_volume, phi_bases[e], gbases[e], phi_vals);
+			const Quadrature &quadrature = phi_vals.quadrature;
 
-				const Quadrature &quadrature = phi_vals.quadrature;
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			da = phi_vals.det.array() * quadrature.weights.array();
+			assemble_local(psi_vals, phi_vals, t, da, local);
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = phi_vals.det.array() * quadrature.weights.array();
-				const int n_phi_loc_bases = int(phi_vals.basis_values.size());
-				const int n_psi_loc_bases = int(psi_vals.basis_values.size());
+			const int n_phi_loc_bases = int(phi_vals.basis_values.size());
+			const int n_psi_loc_bases = int(psi_vals.basis_values.size());
+			assert(local.rows() == n_phi_loc_bases * rows() && local.cols() == n_psi_loc_bases * cols());
+
+			for (int i = 0; i < n_psi_loc_bases; ++i)
+			{
+				const auto &global_i = psi_vals.basis_values[i].global;
 
-				for (int i = 0; i < n_psi_loc_bases; ++i)
+				for (int j = 0; j < n_phi_loc_bases; ++j)
 				{
-					const auto &global_i = psi_vals.basis_values[i].global;
+					const auto &global_j = phi_vals.basis_values[j].global;
 
-					for (int j = 0; j < n_phi_loc_bases; ++j)
+					for (int m = 0; m < cols(); ++m)
 					{
-						const auto &global_j = phi_vals.basis_values[j].global;
-
-						const auto stiffness_val = assemble(MixedAssemblerData(psi_vals, phi_vals, t, i, j, local_storage.da));
-						assert(stiffness_val.size() == rows() * cols());
-
-						// igl::Timer t1; t1.start();
 						for (int n = 0; n < rows(); ++n)
 						{
-							for (int m = 0; m < cols(); ++m)
+							const double local_value = local(j * rows() + n, i * cols() + m);
+
+							for (size_t ii = 0; ii < global_i.size(); ++ii)
 							{
-								const double local_value = stiffness_val(n * cols() + m);
+								const auto gi = global_i[ii].index * cols() + m;
+								const auto wi = global_i[ii].val;
 
-								for (size_t ii = 0; ii < global_i.size(); ++ii)
+								for (size_t jj = 0; jj < global_j.size(); ++jj)
 								{
-									const auto gi = global_i[ii].index * cols() + m;
-									const auto wi = global_i[ii].val;
-
-									for (size_t jj = 0; jj < global_j.size(); ++jj)
-									{
-										const auto gj = global_j[jj].index * rows() + n;
-										const auto wj = global_j[jj].val;
-
-										local_storage.cache->add_value(e, gj, gi, local_value * wi * wj);
+									const auto gj = global_j[jj].index * rows() + n;
+									const auto wj = global_j[jj].val;
 
-										if (local_storage.cache->entries_size() >= max_triplets_size)
-										{
-											local_storage.cache->prune();
-											logger().debug("cleaning memory...");
-										}
-									}
+									write(gj, gi, local_value * wi * wj);
 								}
 							}
 						}
 					}
 				}
 			}
+		};
+
+		// Elements of the same colour share no phi node, hence no row of the block, so the pattern is built
+		// from the connectivity and the local blocks are scattered directly in the values
+		if (phi_cache.has_element_colors(n_bases))
+		{
+			timer.start();
+			std::vector<std::vector<int>> psi_to_phi(n_psi_basis);
+			for (int e = 0; e < n_bases; ++e)
+			{
+				std::vector<int> phi_nodes;
+				for (const Basis &b : phi_bases[e].bases)
+					for (const auto &g : b.global())
+						phi_nodes.push_back(g.index);
+
+				for (const Basis &b : psi_bases[e].bases)
+					for (const auto &g : b.global())
+						psi_to_phi[g.index].insert(psi_to_phi[g.index].end(), phi_nodes.begin(), phi_nodes.end());
+			}
+
+			Eigen::VectorXi column_sizes(n_psi_basis * cols());
+			for (int p = 0; p < n_psi_basis; ++p)
+			{
+				std::vector<int> &nodes = psi_to_phi[p];
+				std::sort(nodes.begin(), nodes.end());
+				nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+				for (int m = 0; m < cols(); ++m)
+					column_sizes(p * cols() + m) = int(nodes.size()) * rows();
+			}
+
+			stiffness.resize(n_phi_basis * rows(), n_psi_basis * cols());
+			stiffness.reserve(column_sizes);
+			for (int p = 0; p < n_psi_basis; ++p)
+				for (int m = 0; m < cols(); ++m)
+					for (const int q : psi_to_phi[p])
+						for (int n = 0; n < rows(); ++n)
+							stiffness.insert(q * rows() + n, p * cols() + m) = 0;
+			stiffness.makeCompressed();
+			timer.stop();
+			logger().trace("done mixed pattern {}s...", timer.getElapsedTime());
+
+			timer.start();
+			const StiffnessMatrix::StorageIndex *outer = stiffness.outerIndexPtr();
+			const StiffnessMatrix::StorageIndex *inner = stiffness.innerIndexPtr();
+			double *values = stiffness.valuePtr();
+
+			for (const std::vector<int> &color : phi_cache.element_colors())
+			{
+				maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					ElementAssemblyValues tmp_psi_vals, tmp_phi_vals;
+					QuadratureVector da;
+					Eigen::MatrixXd local;
+
+					for (int k = start; k < end; ++k)
+					{
+						assemble_element(color[k], tmp_psi_vals, tmp_phi_vals, da, local, [&](const int row, const int col, const double value) {
+							const auto *it = std::lower_bound(inner + outer[col], inner + outer[col + 1], row);
+							assert(it != inner + outer[col + 1] && *it == row);
+							values[it - inner] += value;
+						});
+					}
+				});
+			}
+			timer.stop();
+			logger().trace("done direct mixed assembly {}s...", timer.getElapsedTime());
+
+			return;
+		}
+
+		const int max_triplets_size = int(1e7);
+		const int buffer_size = std::min(long(max_triplets_size), long(std::max(n_psi_basis, n_phi_basis)) * std::max(rows(), cols()));
+		// logger().debug("buffer_size {}", buffer_size);
+
+		stiffness.resize(n_phi_basis * rows(), n_psi_basis * cols());
+		stiffness.setZero();
+
+		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, stiffness.rows(), stiffness.cols()));
+
+		timer.start();
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			ElementAssemblyValues tmp_psi_vals, tmp_phi_vals;
+			Eigen::MatrixXd local;
+
+			for (int e = start; e < end; ++e)
+			{
+				assemble_element(e, tmp_psi_vals, tmp_phi_vals, local_storage.da, local, [&](const int row, const int col, const double value) {
+					local_storage.cache->add_value(e, row, col, value);
+
+					if (local_storage.cache->entries_size() >= max_triplets_size)
+					{
+						local_storage.cache->prune();
+						logger().debug("cleaning memory...");
+					}
+				});
+			}
 		});
 
 		timer.stop();
@@ -487,9 +874,6 @@ namespace polyfem::assembler
 		stiffness.makeCompressed();
 		timer.stop();
 		logger().trace("done merge assembly {}s...", timer.getElapsedTime());
-
-		// stiffness.resize(n_basis*size(), n_basis*size());
-		// stiffness.setFromTriplets(entries.begin(), entries.end());
 	}
 
 	double NLAssembler::assemble_energy(
@@ -502,21 +886,22 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement,
 		const Eigen::MatrixXd &displacement_prev) const
 	{
-		auto storage = create_thread_storage(LocalThreadScalarStorage());
+		POLYFEM_PROFILE_ZONE("NLAssembler::assemble_energy");
+		auto &storage = workspace().scalar_storage();
 		const int n_bases = int(bases.size());
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+		maybe_parallel_for(n_loop_elements(n_bases), [&](int start, int end, int thread_id) {
 			LocalThreadScalarStorage &local_storage = get_local_thread_storage(storage, thread_id);
-			ElementAssemblyValues &vals = local_storage.vals;
 
-			for (int e = start; e < end; ++e)
+			for (int i = start; i < end; ++i)
 			{
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				const int e = ordered_element(i);
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
 				const Quadrature &quadrature = vals.quadrature;
 
 				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
+				local_storage.da = vals.det.array() * quadrature.weights.array() * element_weight(e);
 
 				const double val = compute_energy(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
 				local_storage.val += val;
@@ -540,22 +925,23 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement,
 		const Eigen::MatrixXd &displacement_prev) const
 	{
-		auto storage = create_thread_storage(LocalThreadScalarStorage());
+		POLYFEM_PROFILE_ZONE("NLAssembler::assemble_energy_per_element");
+		auto &storage = workspace().scalar_storage();
 		const int n_bases = int(bases.size());
-		Eigen::VectorXd out(bases.size());
+		Eigen::VectorXd out = Eigen::VectorXd::Zero(bases.size());
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+		maybe_parallel_for(n_loop_elements(n_bases), [&](int start, int end, int thread_id) {
 			LocalThreadScalarStorage &local_storage = get_local_thread_storage(storage, thread_id);
-			ElementAssemblyValues &vals = local_storage.vals;
 
-			for (int e = start; e < end; ++e)
+			for (int i = start; i < end; ++i)
 			{
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				const int e = ordered_element(i);
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
 				const Quadrature &quadrature = vals.quadrature;
 
 				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
+				local_storage.da = vals.det.array() * quadrature.weights.array() * element_weight(e);
 
 				const double val = compute_energy(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
 				out[e] = val;
@@ -583,58 +969,48 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement_prev,
 		Eigen::MatrixXd &rhs) const
 	{
+		POLYFEM_PROFILE_ZONE("NLAssembler::assemble_gradient");
 		rhs.resize(n_basis * size(), 1);
 		rhs.setZero();
 
-		auto storage = create_thread_storage(LocalThreadVecStorage(rhs.size()));
-
 		const int n_bases = int(bases.size());
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+		const auto assemble_element = [&](const int e, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+			// vals.compute(e, is_volume, bases[e], gbases[e]);
+			const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
-			for (int e = start; e < end; ++e)
-			{
-				// igl::Timer timer; timer.start();
+			const Quadrature &quadrature = vals.quadrature;
 
-				ElementAssemblyValues &vals = local_storage.vals;
-				// vals.compute(e, is_volume, bases[e], gbases[e]);
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			local_storage.da = vals.det.array() * quadrature.weights.array() * element_weight(e);
 
-				const Quadrature &quadrature = vals.quadrature;
+			const auto val = assemble_gradient(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
+			assert(val.size() == vals.basis_values.size() * size());
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
-
-				const auto val = assemble_gradient(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
-				assert(val.size() == n_loc_bases * size());
+			scatter_local_vector(size(), vals, val, vec);
+		};
 
-				for (int j = 0; j < n_loc_bases; ++j)
-				{
-					const auto &global_j = vals.basis_values[j].global;
+		if (!has_element_sampling() && cache.has_element_colors(n_bases))
+		{
+			// elements of the same colour do not share nodes, scatter directly into rhs
+			// so that memory stays O(ndof) independently of the number of threads
+			auto &storage = workspace().vec_storage(0);
 
-					// igl::Timer t1; t1.start();
-					for (int m = 0; m < size(); ++m)
-					{
-						const double local_value = val(j * size() + m);
+			maybe_parallel_for_colors(cache.element_colors(), [&](int e, int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+				assemble_element(e, local_storage, rhs);
+			});
 
-						for (size_t jj = 0; jj < global_j.size(); ++jj)
-						{
-							const auto gj = global_j[jj].index * size() + m;
-							const auto wj = global_j[jj].val;
+			return;
+		}
 
-							local_storage.vec(gj) += local_value * wj;
-						}
-					}
+		auto &storage = workspace().vec_storage(rhs.size());
 
-					// t1.stop();
-					// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
-				}
+		maybe_parallel_for(n_loop_elements(n_bases), [&](int start, int end, int thread_id) {
+			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				// timer.stop();
-				// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
-			}
+			for (int i = start; i < end; ++i)
+				assemble_element(ordered_element(i), local_storage, local_storage.vec);
 		});
 
 		// Serially merge local storages
@@ -655,6 +1031,91 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement_prev,
 		MatrixCache &mat_cache,
 		StiffnessMatrix &hess) const
+	{
+		POLYFEM_PROFILE_ZONE("NLAssembler::assemble_hessian");
+		assemble_hessian_aux(
+			is_volume, n_basis, project_to_psd, bases, gbases, cache, t, dt, displacement, displacement_prev, mat_cache, hess,
+			[&](const int e, const NonLinearAssemblerData &data) { return assemble_hessian(data); });
+	}
+
+	void NLAssembler::assemble_energy_gradient_hessian(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		MatrixCache &mat_cache,
+		double &energy,
+		Eigen::MatrixXd &grad,
+		StiffnessMatrix &hess) const
+	{
+		POLYFEM_PROFILE_ZONE("NLAssembler::assemble_energy_gradient_hessian");
+		const int n_bases = int(bases.size());
+
+		// element contributions are stored and reduced afterwards, so that the hessian sweep can be reused as is
+		std::vector<double> element_energy(n_bases, 0);
+		std::vector<Eigen::VectorXd> element_grad(n_bases);
+
+		assemble_hessian_aux(
+			is_volume, n_basis, project_to_psd, bases, gbases, cache, t, dt, displacement, displacement_prev, mat_cache, hess,
+			[&](const int e, const NonLinearAssemblerData &data) {
+				Eigen::MatrixXd local_hessian;
+				compute_energy_gradient_hessian(data, element_energy[e], element_grad[e], local_hessian);
+				return local_hessian;
+			});
+
+		energy = 0;
+		for (const double val : element_energy)
+			energy += val;
+
+		grad.resize(n_basis * size(), 1);
+		grad.setZero();
+		for (int e = 0; e < n_bases; ++e)
+		{
+			// not in the sampled elements
+			if (element_grad[e].size() == 0)
+				continue;
+
+			const std::vector<Basis> &bs = bases[e].bases;
+			assert(element_grad[e].size() == bs.size() * size());
+
+			for (size_t j = 0; j < bs.size(); ++j)
+			{
+				for (const auto &g : bs[j].global())
+				{
+					for (int m = 0; m < size(); ++m)
+						grad(g.index * size() + m) += element_grad[e](j * size() + m) * g.val;
+				}
+			}
+		}
+	}
+
+	void NLAssembler::compute_energy_gradient_hessian(const NonLinearAssemblerData &data, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const
+	{
+		energy = compute_energy(data);
+		grad = assemble_gradient(data);
+		hessian = assemble_hessian(data);
+	}
+
+	void NLAssembler::assemble_hessian_aux(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		MatrixCache &mat_cache,
+		StiffnessMatrix &hess,
+		const std::function<Eigen::MatrixXd(const int, const NonLinearAssemblerData &)> &element_hessian) const
 	{
 		const int max_triplets_size = int(1e7);
 		const int buffer_size = std::min(long(max_triplets_size), long(n_basis) * size());
@@ -666,32 +1127,173 @@ namespace polyfem::assembler
 		mat_cache.init(n_basis * size());
 		mat_cache.set_zero();
 
-		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mat_cache));
-
 		const int n_bases = int(bases.size());
 		igl::Timer timer;
 		timer.start();
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+		const auto local_hessian = [&](const int e, const ElementAssemblyValues &vals, QuadratureVector &da) {
+			const Quadrature &quadrature = vals.quadrature;
 
-			for (int e = start; e < end; ++e)
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			da = vals.det.array() * quadrature.weights.array() * element_weight(e);
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			NonLinearAssemblerData data(vals, t, dt, displacement, displacement_prev, da);
+			// the sum of the projected hessians of the quadrature points is psd, without a dense eigen-decomposition
+			data.project_to_psd = project_to_psd && projects_hessian_pointwise();
+
+			Eigen::MatrixXd stiffness_val = element_hessian(e, data);
+			assert(stiffness_val.rows() == n_loc_bases * size());
+			assert(stiffness_val.cols() == n_loc_bases * size());
+
+			if (project_to_psd && !data.project_to_psd)
+				stiffness_val = ipc::project_to_psd(stiffness_val);
+
+			return stiffness_val;
+		};
+
+		// The element hessians are symmetric, a symmetric cache only gets their upper triangle
+		if (mat_cache.is_symmetric() && !is_hessian_symmetric())
+			log_and_throw_error("The hessian of {} is not symmetric, it cannot be assembled in a symmetric matrix", name());
+		const bool upper_only = mat_cache.is_symmetric();
+
+		// A block cache is scattered by dim x dim blocks, one slot per pair of nodes, with its pattern computed
+		// from the element nodes before the first assembly
+		BlockSparseMatrixCache *block_cache = dynamic_cast<BlockSparseMatrixCache *>(&mat_cache);
+		if (block_cache != nullptr && block_cache->block_size() == size())
+		{
+			if (!block_cache->has_element_slots(n_bases))
 			{
-				ElementAssemblyValues &vals = local_storage.vals;
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				// same traversal order as scatter_local_blocks
+				std::vector<std::vector<std::pair<int, int>>> element_blocks(n_bases);
+				maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+					for (int e = start; e < end; ++e)
+					{
+						const std::vector<Basis> &bs = bases[e].bases;
+						for (const Basis &bi : bs)
+							for (const Basis &bj : bs)
+								for (const auto &gi : bi.global())
+									for (const auto &gj : bj.global())
+										if (!upper_only || gi.index <= gj.index)
+											element_blocks[e].emplace_back(gi.index, gj.index);
+					}
+				});
+				block_cache->init_element_slots(element_blocks);
+			}
 
-				const Quadrature &quadrature = vals.quadrature;
+			auto &storage = workspace().vec_storage(0);
+			workspace().release_mat_storage();
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
+			const bool colored = !has_element_sampling() && cache.has_element_colors(n_bases);
+			const auto assemble_element = [&](const int e, const int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+				const auto stiffness_val = local_hessian(e, vals, local_storage.da);
+
+				const std::vector<int> &slots = block_cache->element_slots(e);
+				size_t slot = 0;
+				scatter_local_blocks(size(), vals, stiffness_val, [&](const int gi, const int gj, const auto &local_block, const double weight) {
+					if (upper_only && gi > gj)
+						return;
+					assert(slot < slots.size());
+					double *global_block = block_cache->block(slots[slot++]);
+					for (int r = 0; r < local_block.rows(); ++r)
+					{
+						for (int c = 0; c < local_block.cols(); ++c)
+						{
+							if (colored)
+								global_block[r * local_block.cols() + c] += weight * local_block(r, c);
+							else
+								atomic_add(global_block[r * local_block.cols() + c], weight * local_block(r, c));
+						}
+					}
+				});
+				assert(slot == slots.size());
+			};
 
-				auto stiffness_val = assemble_hessian(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
-				assert(stiffness_val.rows() == n_loc_bases * size());
-				assert(stiffness_val.cols() == n_loc_bases * size());
+			if (colored)
+				maybe_parallel_for_colors(cache.element_colors(), assemble_element);
+			else
+				maybe_parallel_for(n_loop_elements(n_bases), [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; ++i)
+						assemble_element(ordered_element(i), thread_id);
+				});
+
+			timer.stop();
+			logger().trace("done block assembly {}s...", timer.getElapsedTime());
+
+			timer.start();
+			hess = mat_cache.get_matrix();
+			timer.stop();
+			logger().trace("done matrix creation {}s...", timer.getElapsedTime());
+			return;
+		}
+
+		// Once the sparsity pattern and the element slots are known, the elements are scattered directly
+		// in the values of mat_cache: elements of the same colour write to disjoint slots, without a
+		// colouring the shared slots are updated with atomic adds. Either way there is no per-thread
+		// copy of the cache to merge.
+		SparseMatrixCache *sparse_cache = dynamic_cast<SparseMatrixCache *>(&mat_cache);
+		if (sparse_cache != nullptr && sparse_cache->has_element_slots(n_bases))
+		{
+			auto &storage = workspace().vec_storage(0);
+			workspace().release_mat_storage();
+
+			const bool colored = !has_element_sampling() && cache.has_element_colors(n_bases);
+			const auto assemble_element = [&](const int e, const int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+				const auto stiffness_val = local_hessian(e, vals, local_storage.da);
+
+				// same traversal order as the add_value loop below
+				const std::vector<int> &slots = sparse_cache->element_slots(e);
+				size_t slot = 0;
+				scatter_local_matrix(size(), vals, stiffness_val, [&](const int gi, const int gj, const double value) {
+					assert(slot < slots.size());
+					// the lower triangle is copied from the upper one by get_matrix
+					if (upper_only && gi > gj)
+					{
+						++slot;
+						return;
+					}
+					if (colored)
+						sparse_cache->add_to_slot(slots[slot++], value);
+					else
+						sparse_cache->atomic_add_to_slot(slots[slot++], value);
+				});
+				assert(slot == slots.size());
+			};
+
+			if (colored)
+				maybe_parallel_for_colors(cache.element_colors(), assemble_element);
+			else
+				maybe_parallel_for(n_loop_elements(n_bases), [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; ++i)
+						assemble_element(ordered_element(i), thread_id);
+				});
+
+			timer.stop();
+			logger().trace("done direct slot assembly {}s...", timer.getElapsedTime());
+
+			timer.start();
+			hess = mat_cache.get_matrix();
+			timer.stop();
+			logger().trace("done matrix creation {}s...", timer.getElapsedTime());
+			return;
+		}
+
+		auto &storage = workspace().mat_storage(buffer_size, mat_cache);
+
+		maybe_parallel_for(n_loop_elements(n_bases), [&](int start, int end, int thread_id) {
+			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				if (project_to_psd)
-					stiffness_val = ipc::project_to_psd(stiffness_val);
+			for (int i = start; i < end; ++i)
+			{
+				const int e = ordered_element(i);
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+				const auto stiffness_val = local_hessian(e, vals, local_storage.da);
 
 				// bool has_nan = false;
 				// for(int k = 0; k < stiffness_val.size(); ++k)
@@ -709,47 +1311,15 @@ namespace polyfem::assembler
 				// 	break;
 				// }
 
-				for (int i = 0; i < n_loc_bases; ++i)
-				{
-					const auto &global_i = vals.basis_values[i].global;
+				scatter_local_matrix(size(), vals, stiffness_val, [&](const int gi, const int gj, const double value) {
+					local_storage.cache->add_value(e, gi, gj, value);
 
-					for (int j = 0; j < n_loc_bases; ++j)
-					// for(int j = 0; j <= i; ++j)
+					if (local_storage.cache->entries_size() >= max_triplets_size)
 					{
-						const auto &global_j = vals.basis_values[j].global;
-
-						for (int n = 0; n < size(); ++n)
-						{
-							for (int m = 0; m < size(); ++m)
-							{
-								const double local_value = stiffness_val(i * size() + m, j * size() + n);
-
-								for (size_t ii = 0; ii < global_i.size(); ++ii)
-								{
-									const auto gi = global_i[ii].index * size() + m;
-									const auto wi = global_i[ii].val;
-
-									for (size_t jj = 0; jj < global_j.size(); ++jj)
-									{
-										const auto gj = global_j[jj].index * size() + n;
-										const auto wj = global_j[jj].val;
-
-										local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
-										// if (j < i) {
-										// 	local_storage.entries.emplace_back(gj, gi, local_value * wj * wi);
-										// }
-
-										if (local_storage.cache->entries_size() >= max_triplets_size)
-										{
-											local_storage.cache->prune();
-											logger().debug("cleaning memory...");
-										}
-									}
-								}
-							}
-						}
+						local_storage.cache->prune();
+						logger().debug("cleaning memory...");
 					}
-				}
+				});
 			}
 		});
 
@@ -770,4 +1340,174 @@ namespace polyfem::assembler
 		logger().trace("done merge assembly {}s...", timer.getElapsedTime());
 	}
 
+	Eigen::MatrixXd NLAssembler::assemble_reduced_gradient_per_element(
+		const bool is_volume,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		const Eigen::MatrixXd &basis) const
+	{
+		POLYFEM_PROFILE_ZONE("NLAssembler::assemble_reduced_gradient_per_element");
+		auto &storage = workspace().scalar_storage();
+		const int n_bases = int(bases.size());
+		Eigen::MatrixXd out(n_bases, basis.cols());
+
+		// all the elements with unit weights, this is what the sampled ones approximate
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadScalarStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+			for (int e = start; e < end; ++e)
+			{
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+
+				const Quadrature &quadrature = vals.quadrature;
+
+				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+				local_storage.da = vals.det.array() * quadrature.weights.array();
+
+				const Eigen::VectorXd val = assemble_gradient(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
+				assert(val.size() == vals.basis_values.size() * size());
+
+				out.row(e).setZero();
+				for (size_t j = 0; j < vals.basis_values.size(); ++j)
+				{
+					for (const auto &g : vals.basis_values[j].global)
+					{
+						for (int m = 0; m < size(); ++m)
+							out.row(e) += (g.val * val(j * size() + m)) * basis.row(g.index * size() + m);
+					}
+				}
+			}
+		});
+
+		return out;
+	}
+
+	void NLAssembler::set_element_sampling(const std::vector<int> &elements, const std::vector<double> &weights)
+	{
+		assert(elements.size() == weights.size());
+		sampled_elements_ = elements;
+		element_weights_.clear();
+		if (elements.empty())
+			return;
+
+		element_weights_.assign(*std::max_element(elements.begin(), elements.end()) + 1, 0);
+		for (size_t i = 0; i < elements.size(); ++i)
+			element_weights_[elements[i]] = weights[i];
+	}
+
+	void NLAssembler::apply_hessian(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		const Eigen::MatrixXd &v,
+		Eigen::MatrixXd &out) const
+	{
+		POLYFEM_PROFILE_ZONE("NLAssembler::apply_hessian");
+		assert(v.size() == n_basis * size());
+		out.resize(n_basis * size(), 1);
+		out.setZero();
+
+		const int n_bases = int(bases.size());
+		// the pointwise stiffness cannot be projected to psd like the element hessians
+		const bool sum_factorize = is_volume && !project_to_psd && size() == 3 && stiffness_is_energy_hessian();
+
+		const auto apply_element = [&](const int e, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+			const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+
+			const Quadrature &quadrature = vals.quadrature;
+
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			local_storage.da = vals.det.array() * quadrature.weights.array() * element_weight(e);
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			// Q_q and spline hexes on a tensor-product quadrature never build the dense element hessian
+			if (sum_factorize && TensorProductHex::is_tensor_product(bases[e]) && TensorProductHex::tensor_points(quadrature, local_storage.points_1d))
+			{
+				if (const auto &tensor_tables = bases[e].tensor_tables_func())
+				{
+					// the 1D factors depend on the element (e.g., the knots of the splines)
+					std::array<Eigen::MatrixXd, 3> val_1d, grad_1d;
+					tensor_tables(local_storage.points_1d, val_1d, grad_1d);
+					local_storage.tensor_hex = std::make_shared<const TensorProductHex>(val_1d, grad_1d);
+				}
+				else
+				{
+					const int order = bases[e].reference_basis()->order();
+					if (!local_storage.tensor_hex || !local_storage.tensor_hex->matches(order, local_storage.points_1d))
+						local_storage.tensor_hex = std::make_shared<const TensorProductHex>(order, local_storage.points_1d);
+				}
+
+				Eigen::MatrixXd local_v = Eigen::MatrixXd::Zero(n_loc_bases, 3);
+				for (int j = 0; j < n_loc_bases; ++j)
+					for (const auto &g : vals.basis_values[j].global)
+						local_v.row(j) += g.val * v.middleRows(g.index * 3, 3).transpose();
+
+				compute_stiffness_value(t, vals, quadrature.points, displacement, local_storage.stiffness);
+				scatter_local_vector(3, vals, apply_tensor_product_hessian(*local_storage.tensor_hex, vals, local_storage.da, local_storage.stiffness, local_v), vec);
+				return;
+			}
+
+			NonLinearAssemblerData data(vals, t, dt, displacement, displacement_prev, local_storage.da);
+			data.project_to_psd = project_to_psd && projects_hessian_pointwise();
+
+			Eigen::MatrixXd stiffness_val = assemble_hessian(data);
+			assert(stiffness_val.rows() == n_loc_bases * size());
+			assert(stiffness_val.cols() == n_loc_bases * size());
+
+			if (project_to_psd && !data.project_to_psd)
+				stiffness_val = ipc::project_to_psd(stiffness_val);
+
+			// gather the local coefficients of v
+			Eigen::VectorXd local_v = Eigen::VectorXd::Zero(n_loc_bases * size());
+			for (int j = 0; j < n_loc_bases; ++j)
+			{
+				for (const auto &g : vals.basis_values[j].global)
+				{
+					for (int m = 0; m < size(); ++m)
+						local_v(j * size() + m) += g.val * v(g.index * size() + m);
+				}
+			}
+
+			const Eigen::VectorXd local_out = stiffness_val * local_v;
+			scatter_local_vector(size(), vals, local_out, vec);
+		};
+
+		if (!has_element_sampling() && cache.has_element_colors(n_bases))
+		{
+			auto &storage = workspace().vec_storage(0);
+
+			maybe_parallel_for_colors(cache.element_colors(), [&](int e, int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+				apply_element(e, local_storage, out);
+			});
+
+			return;
+		}
+
+		auto &storage = workspace().vec_storage(out.size());
+
+		maybe_parallel_for(n_loop_elements(n_bases), [&](int start, int end, int thread_id) {
+			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+			for (int i = start; i < end; ++i)
+				apply_element(ordered_element(i), local_storage, local_storage.vec);
+		});
+
+		// Serially merge local storages
+		for (const LocalThreadVecStorage &local_storage : storage)
+			out += local_storage.vec;
+	}
+
 } // namespace polyfem::assembler
@@ -47,6 +47,16 @@ namespace polyfem::assembler
 		virtual int cols() const = 0;
 
 		virtual Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> assemble(const MixedAssemblerData &data) const = 0;
+
+		/// computes the whole local block of an element, local(j * rows() + n, i * cols() + m) couples
+		/// component n of the phi basis j with component m of the psi basis i
+		/// the default calls assemble for every (i, j) pair, kernels override it to batch the pairs
+		virtual void assemble_local(
+			const ElementAssemblyValues &psi_vals,
+			const ElementAssemblyValues &phi_vals,
+			const double t,
+			const QuadratureVector &da,
+			Eigen::MatrixXd &local) const;
 	};
 
 	/// abstract class
@@ -124,6 +134,43 @@ namespace polyfem::assembler
 			utils::MatrixCache &mat_cache,
 			StiffnessMatrix &grad) const { log_and_throw_error("Assemble hessian not implemented by {}!", name()); }
 
+		// assemble energy, gradient, and hessian together, by default with three separate assemblies
+		virtual void assemble_energy_gradient_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			utils::MatrixCache &mat_cache,
+			double &energy,
+			Eigen::MatrixXd &grad,
+			StiffnessMatrix &hess) const
+		{
+			energy = assemble_energy(is_volume, bases, gbases, cache, t, dt, displacement, displacement_prev);
+			assemble_gradient(is_volume, n_basis, bases, gbases, cache, t, dt, displacement, displacement_prev, grad);
+			assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, t, dt, displacement, displacement_prev, mat_cache, hess);
+		}
+
+		// matrix-free product of the hessian of energy with v, without assembling the matrix
+		virtual void apply_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &out) const { log_and_throw_error("Hessian-vector product not implemented by {}!", name()); }
+
 		// plotting (eg von mises), assembler is the name of the formulation
 		virtual void compute_scalar_value(
 			const OutputData &data,
@@ -144,6 +191,10 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement,
 			Eigen::MatrixXd &tensor) const { log_and_throw_error("Not implemented!"); }
 
+		// true if compute_stiffness_value is the hessian of the energy density with respect to the deformation gradient,
+		// the hessian products of tensor-product hexes are then sum-factorized
+		virtual bool stiffness_is_energy_hessian() const { return false; }
+
 		virtual void compute_dstress_dmu_dlambda(
 			const OptAssemblerData &data,
 			Eigen::MatrixXd &dstress_dmu,
@@ -194,10 +245,16 @@ namespace polyfem::assembler
 			log_and_throw_error("Not implemented!");
 		}
 
+		/// releases the scratch buffers kept across assemblies, must be called when the mesh or the bases change
+		virtual void clear_workspace() const {}
+
 		virtual bool is_linear() const = 0;
 		virtual bool is_solution_displacement() const { return false; }
 		virtual bool is_fluid() const { return false; }
 		virtual bool is_tensor() const { return false; }
+		/// true if the element hessians are symmetric (e.g., hessians of an energy), only their upper triangle
+		/// is then scattered in a symmetric MatrixCache
+		virtual bool is_hessian_symmetric() const { return false; }
 
 	protected:
 		int size_ = -1;
@@ -290,13 +347,117 @@ namespace polyfem::assembler
 			utils::MatrixCache &mat_cache,
 			StiffnessMatrix &grad) const override;
 
+		// assemble energy, gradient and hessian in a single sweep over the elements
+		void assemble_energy_gradient_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			utils::MatrixCache &mat_cache,
+			double &energy,
+			Eigen::MatrixXd &grad,
+			StiffnessMatrix &hess) const override;
+
+		// product of the hessian of energy with v, element hessians are applied on the fly
+		void apply_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &out) const override;
+
+		/// reduced gradient of every element, Phi^T grad_e for the columns Phi of basis, #elements x #basis columns,
+		/// used to train the element sampling of a reduced-order model
+		Eigen::MatrixXd assemble_reduced_gradient_per_element(
+			const bool is_volume,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			const Eigen::MatrixXd &basis) const;
+
+		/// restrict the element loops to a subset of the elements, their contributions are scaled by the weights
+		/// (cubature of a reduced-order model), an empty subset restores the full loops
+		void set_element_sampling(const std::vector<int> &elements, const std::vector<double> &weights);
+		bool has_element_sampling() const { return !sampled_elements_.empty(); }
+		const std::vector<int> &sampled_elements() const { return sampled_elements_; }
+		// weight of the contribution of element e, 1 without sampling
+		double element_weight(const int e) const
+		{
+			if (sampled_elements_.empty())
+				return 1;
+			return size_t(e) < element_weights_.size() ? element_weights_[e] : 0;
+		}
+
 		virtual bool is_linear() const override { return false; }
 
+		void clear_workspace() const override { workspace_.reset(); }
+
 	protected:
 		// energy, gradient, and hessian used in newton method
 		virtual double compute_energy(const NonLinearAssemblerData &data) const = 0;
 		virtual Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const = 0;
 		virtual Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const = 0;
+		// element energy, gradient, and hessian together, models sharing work between them can override it
+		virtual void compute_energy_gradient_hessian(const NonLinearAssemblerData &data, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const;
+		// true if the element hessian is assembled from the hessians wrt the deformation gradient at the quadrature points,
+		// projecting them to psd (NonLinearAssemblerData::project_to_psd) is then much cheaper than projecting the element hessian
+		virtual bool projects_hessian_pointwise() const { return false; }
+
+		// order in which the element loops visit the elements, empty for the mesh order;
+		// assemblers dispatching to a different kernel per element keep the elements of a kernel contiguous
+		std::vector<int> element_order_;
+		int ordered_element(const int i) const
+		{
+			if (!sampled_elements_.empty())
+				return sampled_elements_[i];
+			return element_order_.empty() ? i : element_order_[i];
+		}
+
+		// number of iterations of the element loops, see set_element_sampling
+		int n_loop_elements(const int n_elements) const { return sampled_elements_.empty() ? n_elements : int(sampled_elements_.size()); }
+
+	private:
+		std::vector<int> sampled_elements_;
+		// weight of every element, 0 if not sampled
+		std::vector<double> element_weights_;
+
+		void assemble_hessian_aux(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			utils::MatrixCache &mat_cache,
+			StiffnessMatrix &hess,
+			const std::function<Eigen::MatrixXd(const int, const NonLinearAssemblerData &)> &element_hessian) const;
+
+		/// thread local storages (triplet buffers, element values, per-thread vectors) reused across
+		/// Newton iterations and time steps, created on first use
+		struct Workspace;
+		mutable std::shared_ptr<Workspace> workspace_;
+		Workspace &workspace() const;
 	};
 
 	class ElasticityAssembler : virtual public Assembler
@@ -358,6 +519,8 @@ namespace polyfem::assembler
 
 		bool is_solution_displacement() const override { return true; }
 		bool is_tensor() const override { return true; }
+		// hessians of the elastic energy
+		bool is_hessian_symmetric() const override { return true; }
 
 	protected:
 		virtual void assign_stress_tensor(const OutputData &data,
@@ -24,6 +24,10 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &x;
 		const Eigen::MatrixXd &x_prev;
 		const QuadratureVector &da;
+
+		/// the hessian wrt the deformation gradient is projected to psd at every quadrature point,
+		/// only set for the assemblers that support it (NLAssembler::projects_hessian_pointwise)
+		bool project_to_psd = false;
 	};
 
 	class LinearAssemblerData
@@ -129,47 +129,65 @@ namespace polyfem
 			assert(pressure_stiffness.size() == 0 || pressure_stiffness.cols() == n_pressure_bases);
 
 			const int avg_offset = add_average ? 1 : 0;
-
-			std::vector<Eigen::Triplet<double>> blocks;
-			blocks.reserve(velocity_stiffness.nonZeros() + 2 * mixed_stiffness.nonZeros() + pressure_stiffness.nonZeros() + 2 * avg_offset * velocity_stiffness.rows());
-
-			for (int k = 0; k < velocity_stiffness.outerSize(); ++k)
+			const int n_velocity = n_bases * problem_dim;
+			const int n = n_velocity + n_pressure_bases + avg_offset;
+			const bool has_mixed = mixed_stiffness.size() > 0;
+			const bool has_pressure = pressure_stiffness.size() > 0;
+
+			// lower left block, column i is row i of the mixed block
+			StiffnessMatrix mixed_stiffness_t;
+			if (has_mixed)
+				mixed_stiffness_t = mixed_stiffness.transpose();
+
+			// the blocks of a column cover disjoint row ranges, the column is filled in order without triplets
+			Eigen::VectorXi column_sizes = Eigen::VectorXi::Zero(n);
+			for (int k = 0; k < n_velocity; ++k)
 			{
 				for (StiffnessMatrix::InnerIterator it(velocity_stiffness, k); it; ++it)
-				{
-					blocks.emplace_back(it.row(), it.col(), it.value());
-				}
+					++column_sizes(k);
+				if (has_mixed)
+					column_sizes(k) += mixed_stiffness_t.col(k).nonZeros();
 			}
+			for (int k = 0; k < n_pressure_bases; ++k)
+			{
+				if (has_mixed)
+					column_sizes(n_velocity + k) += mixed_stiffness.col(k).nonZeros();
+				if (has_pressure)
+					column_sizes(n_velocity + k) += pressure_stiffness.col(k).nonZeros();
+				column_sizes(n_velocity + k) += avg_offset;
+			}
+			if (add_average)
+				column_sizes(n - 1) = n_pressure_bases;
+
+			stiffness.resize(n, n);
+			stiffness.reserve(column_sizes);
 
-			for (int k = 0; k < mixed_stiffness.outerSize(); ++k)
+			for (int k = 0; k < n_velocity; ++k)
 			{
-				for (StiffnessMatrix::InnerIterator it(mixed_stiffness, k); it; ++it)
-				{
-					blocks.emplace_back(it.row(), n_bases * problem_dim + it.col(), it.value());
-					blocks.emplace_back(it.col() + n_bases * problem_dim, it.row(), it.value());
-				}
+				for (StiffnessMatrix::InnerIterator it(velocity_stiffness, k); it; ++it)
+					stiffness.insert(it.row(), k) = it.value();
+				if (has_mixed)
+					for (StiffnessMatrix::InnerIterator it(mixed_stiffness_t, k); it; ++it)
+						stiffness.insert(n_velocity + it.row(), k) = it.value();
 			}
 
-			for (int k = 0; k < pressure_stiffness.outerSize(); ++k)
+			const double val = 1.0 / n_pressure_bases;
+			for (int k = 0; k < n_pressure_bases; ++k)
 			{
-				for (StiffnessMatrix::InnerIterator it(pressure_stiffness, k); it; ++it)
-				{
-					blocks.emplace_back(n_bases * problem_dim + it.row(), n_bases * problem_dim + it.col(), it.value());
-				}
+				if (has_mixed)
+					for (StiffnessMatrix::InnerIterator it(mixed_stiffness, k); it; ++it)
+						stiffness.insert(it.row(), n_velocity + k) = it.value();
+				if (has_pressure)
+					for (StiffnessMatrix::InnerIterator it(pressure_stiffness, k); it; ++it)
+						stiffness.insert(n_velocity + it.row(), n_velocity + k) = it.value();
+				if (add_average)
+					stiffness.insert(n - 1, n_velocity + k) = val;
 			}
 
 			if (add_average)
-			{
-				const double val = 1.0 / n_pressure_bases;
 				for (int i = 0; i < n_pressure_bases; ++i)
-				{
-					blocks.emplace_back(n_bases * problem_dim + i, n_bases * problem_dim + n_pressure_bases, val);
-					blocks.emplace_back(n_bases * problem_dim + n_pressure_bases, n_bases * problem_dim + i, val);
-				}
-			}
+					stiffness.insert(n_velocity + i, n - 1) = val;
 
-			stiffness.resize(n_bases * problem_dim + n_pressure_bases + avg_offset, n_bases * problem_dim + n_pressure_bases + avg_offset);
-			stiffness.setFromTriplets(blocks.begin(), blocks.end());
 			stiffness.makeCompressed();
 
 			// static int c = 0;
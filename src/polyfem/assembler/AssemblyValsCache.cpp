@@ -1,6 +1,12 @@
 #include "AssemblyValsCache.hpp"
 
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/GraphColoring.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
 
 namespace polyfem
 {
@@ -12,40 +18,149 @@ namespace polyfem
 		{
 			is_mass_ = is_mass;
 			const int n_bases = bases.size();
+			cache.clear();
 			cache.resize(n_bases);
 
-			// loop over elements
+			select_cached_elements(is_volume, bases, gbases);
+
+			// loop over elements, the values are allocated by the thread that computes them
+			// which in NUMA mode is the thread that assembles the element later
 			utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 				for (int e = start; e < end; ++e)
 				{
-					if (is_mass_)
-					{
-						auto &quadrature = cache[e].quadrature;
-						bases[e].compute_mass_quadrature(quadrature);
-						cache[e].compute(e, is_volume, quadrature.points, bases[e], gbases[e]);
-					}
-					else
-						cache[e].compute(e, is_volume, bases[e], gbases[e]);
+					if (element_cached_[e])
+						recompute(e, is_volume, bases[e], gbases[e], cache[e]);
 				}
 			});
+
+			init_element_colors(bases, gbases);
 		}
 
-		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		void AssemblyValsCache::select_cached_elements(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases)
 		{
-			if (cache.empty())
+			const int n_elements = bases.size();
+			element_cached_.assign(n_elements, true);
+			if (policy_ == Policy::All && min_bases_ <= 0)
+				return;
+
+			// elements of one type by number of bases and geometric bases
+			std::map<std::pair<int, int>, std::vector<int>> types;
+			for (int e = 0; e < n_elements; ++e)
+				types[{bases[e].bases.size(), gbases[e].bases.size()}].push_back(e);
+
+			for (const auto &[type, elements] : types)
 			{
-				if (is_mass_)
+				bool cached = type.first >= min_bases_;
+
+				if (cached && policy_ == Policy::Auto)
+				{
+					// a few elements spread over the mesh, recomputed and copied several times
+					constexpr int n_samples = 8;
+					constexpr int n_repeats = 4;
+					double recompute_time = 0, copy_time = 0;
+					ElementAssemblyValues vals, copy;
+					for (int i = 0; i < std::min<int>(n_samples, elements.size()); ++i)
+					{
+						const int e = elements[i * elements.size() / std::min<int>(n_samples, elements.size())];
+						for (int r = 0; r < n_repeats; ++r)
+						{
+							auto start = std::chrono::steady_clock::now();
+							recompute(e, is_volume, bases[e], gbases[e], vals);
+							recompute_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+							start = std::chrono::steady_clock::now();
+							copy = vals;
+							copy_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+						}
+					}
+					cached = recompute_time > copy_time;
+
+					logger().debug("Element type with {} bases and {} geometric bases: recompute {:.3e}s, copy {:.3e}s, {}",
+								   type.first, type.second, recompute_time, copy_time, cached ? "cached" : "recomputed");
+				}
+
+				if (!cached)
 				{
-					auto &quadrature = vals.quadrature;
-					basis.compute_mass_quadrature(quadrature);
-					vals.compute(el_index, is_volume, quadrature.points, basis, gbasis);
+					for (const int e : elements)
+						element_cached_[e] = false;
 				}
-				else
-					vals.compute(el_index, is_volume, basis, gbasis);
 			}
+		}
+
+		int AssemblyValsCache::n_cached_elements() const
+		{
+			return std::count(element_cached_.begin(), element_cached_.end(), true);
+		}
+
+		void AssemblyValsCache::init_element_colors(const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases)
+		{
+			assert(bases.size() == gbases.size());
+
+			int n_bases = 0;
+			for (const ElementBases &bs : bases)
+				for (const Basis &b : bs.bases)
+					for (const auto &g : b.global())
+						n_bases = std::max(n_bases, g.index + 1);
+
+			int n_nodes = n_bases;
+			for (const ElementBases &gbs : gbases)
+				for (const Basis &b : gbs.bases)
+					for (const auto &g : b.global())
+						n_nodes = std::max(n_nodes, n_bases + g.index + 1);
+
+			// geometric nodes are numbered after the bases nodes
+			std::vector<std::vector<int>> element_nodes(bases.size());
+			for (int e = 0; e < bases.size(); ++e)
+			{
+				for (const Basis &b : bases[e].bases)
+					for (const auto &g : b.global())
+						element_nodes[e].push_back(g.index);
+
+				for (const Basis &b : gbases[e].bases)
+					for (const auto &g : b.global())
+						element_nodes[e].push_back(n_bases + g.index);
+			}
+
+			element_colors_ = utils::greedy_coloring(element_nodes, n_nodes);
+			n_colored_elements_ = bases.size();
+		}
+
+		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		{
+			if (!is_cached(el_index))
+				recompute(el_index, is_volume, basis, gbasis, vals);
 			else
 				vals = cache[el_index];
 		}
+
+		void AssemblyValsCache::recompute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		{
+			if (is_mass_)
+			{
+				auto &quadrature = vals.quadrature;
+				basis.compute_mass_quadrature(quadrature);
+				vals.compute(el_index, is_volume, quadrature.points, basis, gbasis);
+			}
+			else
+				vals.compute(el_index, is_volume, basis, gbasis);
+		}
+
+		const ElementAssemblyValues &AssemblyValsCache::get(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &tmp) const
+		{
+			if (!is_cached(el_index))
+			{
+				compute(el_index, is_volume, basis, gbasis, tmp);
+				return tmp;
+			}
+
+			assert(el_index < cache.size());
+			return cache[el_index];
+		}
+
+		size_t AssemblyValsCache::memory_bytes() const
+		{
+			return utils::memory_bytes(cache) + utils::memory_bytes(element_cached_) + utils::memory_bytes(element_colors_);
+		}
 	} // namespace assembler
 
 } // namespace polyfem
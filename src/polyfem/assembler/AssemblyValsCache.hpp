@@ -7,9 +7,26 @@ namespace polyfem
 	namespace assembler
 	{
 		/// Caches basis evaluation and geometric mapping at every element
+		/// The elements of a type (same number of bases and geometric bases) are either all cached or all
+		/// recomputed on demand, depending on the policy (see set_policy)
 		class AssemblyValsCache
 		{
 		public:
+			enum class Policy
+			{
+				All, ///< cache every element
+				Auto ///< cache the element types that are slower to recompute than to copy, timed on a few elements at init
+			};
+
+			/// policy of the next init
+			/// @param[in] policy
+			/// @param[in] min_bases element types with fewer local bases are never cached
+			void set_policy(const Policy policy, const int min_bases = 0)
+			{
+				policy_ = policy;
+				min_bases_ = min_bases;
+			}
+
 			/// computes the basis evaluation and geometric mapping
 			/// for each of the given ElementBases in bases
 			/// initializes cache member
@@ -19,16 +36,55 @@ namespace polyfem
 			/// if it doesn't exist, computes and caches it (modifies cache member in the latter case)
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
 
+			/// retrieves cached basis evaluation and geometric for the given element without copying it
+			/// if the cache is not initialized, computes the values in tmp and returns a reference to it
+			/// the returned reference is valid until the cache is cleared or tmp is modified
+			const ElementAssemblyValues &get(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &tmp) const;
+
+			/// true if init has been called and the values are stored
+			inline bool is_initialized() const { return !cache.empty(); }
+			/// true if the values of element el_index are stored, the others are recomputed
+			inline bool is_cached(const int el_index) const { return is_initialized() && element_cached_[el_index]; }
+			/// number of elements whose values are stored
+			int n_cached_elements() const;
+
+			/// computes a colouring of the elements such that two elements of the same colour
+			/// never share a basis or geometric node, this is independent of the cached values
+			/// and is also done by init
+			void init_element_colors(const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases);
+
 			void clear()
 			{
 				cache.clear();
+				element_cached_.clear();
+				element_colors_.clear();
+				n_colored_elements_ = 0;
 			}
 
+			/// elements grouped by colour, empty if init_element_colors has not been called
+			/// elements of one colour can scatter to global vectors concurrently
+			inline const std::vector<std::vector<int>> &element_colors() const { return element_colors_; }
+			/// true if the colouring has been computed for n_elements elements
+			inline bool has_element_colors(const int n_elements) const { return !element_colors_.empty() && n_colored_elements_ == n_elements; }
+
 			inline bool is_mass() const { return is_mass_; }
 
+			/// heap memory of the cached values and of the colouring in bytes
+			size_t memory_bytes() const;
+
 		private:
+			/// computes the values of an element without the cache
+			void recompute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
+			/// decides which element types are cached according to the policy
+			void select_cached_elements(const bool is_volume, const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases);
+
 			std::vector<ElementAssemblyValues> cache; ///< vector of basis values and geometric mapping with one entry per element
-			bool is_mass_;
+			std::vector<bool> element_cached_;        ///< true if the entry of the element in cache is computed
+			Policy policy_ = Policy::All;
+			int min_bases_ = 0;
+			std::vector<std::vector<int>> element_colors_; ///< element ids grouped by colour
+			int n_colored_elements_ = 0;
+			bool is_mass_ = false;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polyfem/basis/Basis.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
 
 #include <Eigen/Dense>
 
@@ -33,6 +34,12 @@ namespace polyfem
 			{
 				grad_t_m.resize(grad.rows(), grad.cols());
 			}
+
+			/// heap memory of the values in bytes
+			size_t memory_bytes() const
+			{
+				return utils::memory_bytes(global) + utils::memory_bytes(val) + utils::memory_bytes(grad) + utils::memory_bytes(grad_t_m);
+			}
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -0,0 +1,181 @@
+#include "BatchedSimplexAssembler.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+
+namespace polyfem
+{
+	using namespace utils;
+
+	namespace assembler
+	{
+		namespace
+		{
+			template <int DIM>
+			using LocalMat = Eigen::Matrix<double, DIM + 1, DIM>;
+
+			template <int DIM>
+			LocalMat<DIM> local_displacement(const Eigen::MatrixXi &elements, const int e, const Eigen::VectorXd &displacement)
+			{
+				LocalMat<DIM> U;
+				for (int a = 0; a <= DIM; ++a)
+					U.row(a) = displacement.segment<DIM>(elements(e, a) * DIM).transpose();
+				return U;
+			}
+		} // namespace
+
+		void BatchedSimplexAssembler::init(const simplex_kernels::Model model, const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &elements, const Eigen::VectorXd &mu, const Eigen::VectorXd &lambda)
+		{
+			dim_ = vertices.cols();
+			if (dim_ != 2 && dim_ != 3)
+				log_and_throw_error("Invalid dimension {} for the batched simplex assembly", dim_);
+			if (elements.cols() != dim_ + 1)
+				log_and_throw_error("Batched simplex assembly only supports P1 simplices, got {} nodes per element", elements.cols());
+			if (mu.size() != elements.rows() || lambda.size() != elements.rows())
+				log_and_throw_error("Batched simplex assembly needs one material per element");
+
+			model_ = model;
+			n_nodes_ = vertices.rows();
+			elements_ = elements;
+			mu_.assign(mu.data(), mu.data() + mu.size());
+			lambda_.assign(lambda.data(), lambda.data() + lambda.size());
+
+			const int n_local = (dim_ + 1) * dim_;
+			gradients_.resize(elements.rows() * n_local);
+			volumes_.resize(elements.rows());
+
+			maybe_parallel_for(elements.rows(), [&](int start, int end, int thread_id) {
+				Eigen::MatrixXd edges(dim_, dim_);
+				for (int e = start; e < end; ++e)
+				{
+					for (int d = 0; d < dim_; ++d)
+						edges.col(d) = (vertices.row(elements(e, d + 1)) - vertices.row(elements(e, 0))).transpose();
+
+					const double det = edges.determinant();
+					volumes_[e] = std::abs(det) / (dim_ == 2 ? 2 : 6);
+
+					// the gradients of the barycentric coordinates 1..dim are the rows of the inverse
+					const Eigen::MatrixXd inv = edges.inverse();
+					Eigen::Map<Eigen::MatrixXd> G(&gradients_[e * n_local], dim_ + 1, dim_);
+					G.bottomRows(dim_) = inv;
+					G.row(0) = -inv.colwise().sum();
+				}
+			});
+
+			// pattern of the hessian, then the slot of every local entry
+			std::vector<Eigen::Triplet<double>> entries;
+			entries.reserve(elements.rows() * n_local * n_local);
+			for (int e = 0; e < elements.rows(); ++e)
+				for (int r = 0; r < n_local; ++r)
+					for (int c = 0; c < n_local; ++c)
+						entries.emplace_back(elements(e, r / dim_) * dim_ + r % dim_, elements(e, c / dim_) * dim_ + c % dim_, 0);
+
+			hessian_.resize(ndof(), ndof());
+			hessian_.setFromTriplets(entries.begin(), entries.end());
+			hessian_.makeCompressed();
+
+			slots_.resize(entries.size());
+			maybe_parallel_for(entries.size(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					const auto *begin = hessian_.innerIndexPtr() + hessian_.outerIndexPtr()[entries[i].col()];
+					const auto *end_col = hessian_.innerIndexPtr() + hessian_.outerIndexPtr()[entries[i].col() + 1];
+					const auto *it = std::lower_bound(begin, end_col, entries[i].row());
+					assert(it != end_col && *it == entries[i].row());
+					slots_[i] = it - hessian_.innerIndexPtr();
+				}
+			});
+		}
+
+		template <int DIM>
+		double BatchedSimplexAssembler::energy_aux(const Eigen::VectorXd &displacement) const
+		{
+			constexpr int n_local = (DIM + 1) * DIM;
+			auto storage = create_thread_storage(0.0);
+
+			maybe_parallel_for(n_elements(), [&](int start, int end, int thread_id) {
+				double &local = get_local_thread_storage(storage, thread_id);
+				for (int e = start; e < end; ++e)
+				{
+					const Eigen::Map<const LocalMat<DIM>> G(&gradients_[e * n_local]);
+					const auto F = simplex_kernels::deformation_gradient<DIM>(G, local_displacement<DIM>(elements_, e, displacement));
+					local += volumes_[e] * simplex_kernels::energy_density<DIM>(model_, F, mu_[e], lambda_[e]);
+				}
+			});
+
+			double energy = 0;
+			for (const double local : storage)
+				energy += local;
+			return energy;
+		}
+
+		template <int DIM>
+		void BatchedSimplexAssembler::gradient_aux(const Eigen::VectorXd &displacement, Eigen::VectorXd &grad) const
+		{
+			constexpr int n_local = (DIM + 1) * DIM;
+			grad.setZero(ndof());
+
+			maybe_parallel_for(n_elements(), [&](int start, int end, int thread_id) {
+				for (int e = start; e < end; ++e)
+				{
+					const Eigen::Map<const LocalMat<DIM>> G(&gradients_[e * n_local]);
+					const auto F = simplex_kernels::deformation_gradient<DIM>(G, local_displacement<DIM>(elements_, e, displacement));
+					const auto P = simplex_kernels::stress<DIM>(model_, F, mu_[e], lambda_[e]);
+					const auto local = simplex_kernels::element_gradient<DIM>(G, volumes_[e], P);
+					for (int i = 0; i < n_local; ++i)
+						atomic_add(grad[elements_(e, i / DIM) * DIM + i % DIM], local(i));
+				}
+			});
+		}
+
+		template <int DIM>
+		void BatchedSimplexAssembler::hessian_aux(const Eigen::VectorXd &displacement)
+		{
+			constexpr int n_local = (DIM + 1) * DIM;
+			double *values = hessian_.valuePtr();
+			std::fill(values, values + hessian_.nonZeros(), 0.0);
+
+			maybe_parallel_for(n_elements(), [&](int start, int end, int thread_id) {
+				for (int e = start; e < end; ++e)
+				{
+					const Eigen::Map<const LocalMat<DIM>> G(&gradients_[e * n_local]);
+					const auto F = simplex_kernels::deformation_gradient<DIM>(G, local_displacement<DIM>(elements_, e, displacement));
+					const auto dP = simplex_kernels::stress_derivative<DIM>(model_, F, mu_[e], lambda_[e]);
+					const auto local = simplex_kernels::element_hessian<DIM>(G, volumes_[e], dP);
+					const int *slots = &slots_[e * n_local * n_local];
+					for (int r = 0; r < n_local; ++r)
+						for (int c = 0; c < n_local; ++c)
+							atomic_add(values[slots[r * n_local + c]], local(r, c));
+				}
+			});
+		}
+
+		double BatchedSimplexAssembler::assemble_energy(const Eigen::VectorXd &displacement) const
+		{
+			assert(displacement.size() == ndof());
+			return dim_ == 2 ? energy_aux<2>(displacement) : energy_aux<3>(displacement);
+		}
+
+		void BatchedSimplexAssembler::assemble_gradient(const Eigen::VectorXd &displacement, Eigen::VectorXd &grad) const
+		{
+			assert(displacement.size() == ndof());
+			if (dim_ == 2)
+				gradient_aux<2>(displacement, grad);
+			else
+				gradient_aux<3>(displacement, grad);
+		}
+
+		void BatchedSimplexAssembler::assemble_hessian(const Eigen::VectorXd &displacement, StiffnessMatrix &hessian)
+		{
+			assert(displacement.size() == ndof());
+			if (dim_ == 2)
+				hessian_aux<2>(displacement);
+			else
+				hessian_aux<3>(displacement);
+			hessian = hessian_;
+		}
+	} // namespace assembler
+} // namespace polyfem
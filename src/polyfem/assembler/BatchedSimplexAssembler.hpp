@@ -0,0 +1,62 @@
+#pragma once
+
+#include <polyfem/assembler/SimplexKernels.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace assembler
+	{
+		/// Batched assembly of the elastic models on P1 simplices, one dof per node and dimension.
+		/// The geometric data (basis gradients, volumes, material parameters) is computed once in flat
+		/// arrays and the hessian is written to a precomputed CSR pattern through per element slots,
+		/// so that every element is processed independently by the kernels of simplex_kernels.
+		class BatchedSimplexAssembler
+		{
+		public:
+			/// computes the per element data and the hessian pattern
+			/// @param[in] vertices rest positions, one row per node
+			/// @param[in] elements simplices, dim + 1 nodes per row
+			/// @param[in] mu per element Lame parameter
+			/// @param[in] lambda per element Lame parameter
+			void init(const simplex_kernels::Model model, const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &elements, const Eigen::VectorXd &mu, const Eigen::VectorXd &lambda);
+
+			double assemble_energy(const Eigen::VectorXd &displacement) const;
+			void assemble_gradient(const Eigen::VectorXd &displacement, Eigen::VectorXd &grad) const;
+			/// the returned matrix has the pattern computed in init
+			void assemble_hessian(const Eigen::VectorXd &displacement, StiffnessMatrix &hessian);
+
+			int dim() const { return dim_; }
+			int n_elements() const { return elements_.rows(); }
+			int ndof() const { return n_nodes_ * dim_; }
+
+		private:
+			template <int DIM>
+			double energy_aux(const Eigen::VectorXd &displacement) const;
+			template <int DIM>
+			void gradient_aux(const Eigen::VectorXd &displacement, Eigen::VectorXd &grad) const;
+			template <int DIM>
+			void hessian_aux(const Eigen::VectorXd &displacement);
+
+			simplex_kernels::Model model_ = simplex_kernels::Model::LinearElasticity;
+			int dim_ = 0;
+			int n_nodes_ = 0;
+			Eigen::MatrixXi elements_;
+
+			/// basis gradients, (dim + 1) x dim column-major per element
+			std::vector<double> gradients_;
+			std::vector<double> volumes_;
+			std::vector<double> mu_;
+			std::vector<double> lambda_;
+
+			/// hessian with the pattern of all elements
+			StiffnessMatrix hessian_;
+			/// slot in the values of hessian_ of every local entry, ((dim + 1) * dim)^2 per element
+			std::vector<int> slots_;
+		};
+	} // namespace assembler
+} // namespace polyfem
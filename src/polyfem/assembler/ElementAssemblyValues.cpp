@@ -1,5 +1,7 @@
 #include "ElementAssemblyValues.hpp"
 
+#include <algorithm>
+
 namespace polyfem
 {
 	using namespace basis;
@@ -60,6 +62,14 @@ namespace polyfem
 			return true;
 		}
 
+		void ElementAssemblyValues::finalize_affine()
+		{
+			det.setConstant(det(0));
+			std::fill(jac_it.begin() + 1, jac_it.end(), jac_it[0]);
+			for (std::size_t j = 0; j < basis_values.size(); ++j)
+				basis_values[j].grad_t_m = basis_values[j].grad * jac_it[0];
+		}
+
 		void ElementAssemblyValues::finalize3d(const ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values)
 		{
 			// if(det.size() != val.rows())
@@ -72,8 +82,11 @@ namespace polyfem
 			Eigen::Matrix3d tmp;
 			jac_it.resize(val.rows());
 
+			// constant Jacobian, evaluated once and applied to all the points
+			const long n_points = gbasis.is_affine ? std::min<long>(val.rows(), 1) : val.rows();
+
 			// loop over points
-			for (long k = 0; k < val.rows(); ++k)
+			for (long k = 0; k < n_points; ++k)
 			{
 				tmp.setZero();
 				for (int j = 0; j < gbasis_values.size(); ++j)
@@ -99,6 +112,9 @@ namespace polyfem
 				for (std::size_t j = 0; j < basis_values.size(); ++j)
 					basis_values[j].grad_t_m.row(k) = basis_values[j].grad.row(k) * jac_it[k];
 			}
+
+			if (n_points < val.rows())
+				finalize_affine();
 		}
 
 		void ElementAssemblyValues::finalize2d(const ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values)
@@ -111,8 +127,11 @@ namespace polyfem
 			Eigen::Matrix2d tmp;
 			jac_it.resize(val.rows());
 
+			// constant Jacobian, evaluated once and applied to all the points
+			const long n_points = gbasis.is_affine ? std::min<long>(val.rows(), 1) : val.rows();
+
 			// loop over points
-			for (long k = 0; k < val.rows(); ++k)
+			for (long k = 0; k < n_points; ++k)
 			{
 				tmp.setZero();
 				for (int j = 0; j < gbasis_values.size(); ++j)
@@ -140,6 +159,9 @@ namespace polyfem
 				for (std::size_t j = 0; j < basis_values.size(); ++j)
 					basis_values[j].grad_t_m.row(k) = basis_values[j].grad.row(k) * jac_it[k];
 			}
+
+			if (n_points < val.rows())
+				finalize_affine();
 		}
 
 		void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis)
@@ -219,6 +241,14 @@ namespace polyfem
 				finalize2d(gbasis, gbasis_values);
 		}
 
+		size_t ElementAssemblyValues::memory_bytes() const
+		{
+			size_t bytes = utils::memory_bytes(basis_values) + utils::memory_bytes(g_basis_values_cache_) + utils::memory_bytes(jac_it);
+			bytes += utils::memory_bytes(quadrature.points) + utils::memory_bytes(quadrature.weights);
+			bytes += utils::memory_bytes(val) + utils::memory_bytes(det);
+			return bytes;
+		}
+
 		bool ElementAssemblyValues::is_geom_mapping_positive(const bool is_volume, const ElementBases &gbasis) const
 		{
 			if (!gbasis.has_parameterization)
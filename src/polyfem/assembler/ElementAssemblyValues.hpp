@@ -44,6 +44,9 @@ namespace polyfem
 			/// check if the element is flipped
 			bool is_geom_mapping_positive(const bool is_volume, const basis::ElementBases &gbasis) const;
 
+			/// heap memory of the values in bytes
+			size_t memory_bytes() const;
+
 		private:
 			std::vector<AssemblyValues> g_basis_values_cache_;
 
@@ -55,6 +58,8 @@ namespace polyfem
 			/// compute Jacobians
 			void finalize2d(const basis::ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values);
 			void finalize3d(const basis::ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values);
+			/// copies the Jacobian of the first point to all the points, for affine geometric mappings
+			void finalize_affine();
 
 			bool is_geom_mapping_positive(const Eigen::MatrixXd &dx, const Eigen::MatrixXd &dy, const Eigen::MatrixXd &dz) const;
 			bool is_geom_mapping_positive(const Eigen::MatrixXd &dx, const Eigen::MatrixXd &dy) const;
@@ -1,6 +1,7 @@
 #include "FixedCorotational.hpp"
 
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
+#include <polyfem/utils/BatchedSVD.hpp>
 #include <polyfem/utils/svd.hpp>
 
 namespace polyfem::assembler
@@ -236,6 +237,19 @@ namespace polyfem::assembler
 													const ElasticityTensorType &type,
 													Eigen::MatrixXd &all,
 													const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const
+	{
+		if (size() == 2)
+			assign_stress_tensor_aux<2>(data, all_size, type, all, fun);
+		else
+			assign_stress_tensor_aux<3>(data, all_size, type, all, fun);
+	}
+
+	template <int dim>
+	void FixedCorotational::assign_stress_tensor_aux(const OutputData &data,
+													 const int all_size,
+													 const ElasticityTensorType &type,
+													 Eigen::MatrixXd &all,
+													 const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const
 	{
 		const auto &displacement = data.fun;
 		const auto &local_pts = data.local_pts;
@@ -252,27 +266,33 @@ namespace polyfem::assembler
 
 		ElementAssemblyValues vals;
 		vals.compute(el_id, size() == 3, local_pts, bs, gbs);
-		const auto I = Eigen::MatrixXd::Identity(size(), size());
 
+		std::vector<Eigen::Matrix<double, dim, dim>> def_grads(local_pts.rows());
 		for (long p = 0; p < local_pts.rows(); ++p)
 		{
 			compute_diplacement_grad(size(), bs, vals, local_pts, p, displacement, displacement_grad);
+			def_grads[p] = Eigen::Matrix<double, dim, dim>::Identity() + displacement_grad;
+		}
 
-			const Eigen::MatrixXd def_grad = I + displacement_grad;
-			if (type == ElasticityTensorType::F)
-			{
-				all.row(p) = fun(def_grad);
-				continue;
-			}
+		if (type == ElasticityTensorType::F)
+		{
+			for (long p = 0; p < local_pts.rows(); ++p)
+				all.row(p) = fun(def_grads[p]);
+			return;
+		}
+
+		std::vector<Eigen::Matrix<double, dim, dim>> U, V;
+		std::vector<Eigen::Vector<double, dim>> sigmas;
+		compute_svds<dim>(def_grads, U, sigmas, V);
+
+		for (long p = 0; p < local_pts.rows(); ++p)
+		{
+			const Eigen::Matrix<double, dim, dim> &def_grad = def_grads[p];
 
 			double lambda, mu;
 			params_.lambda_mu(local_pts.row(p), vals.val.row(p), t, vals.element_id, lambda, mu);
 
-			Eigen::MatrixXd stress_tensor;
-			if (size() == 2)
-				stress_tensor = compute_stress_from_def_grad<2>(def_grad, lambda, mu) * def_grad.transpose() / def_grad.determinant();
-			else
-				stress_tensor = compute_stress_from_def_grad<3>(def_grad, lambda, mu) * def_grad.transpose() / def_grad.determinant();
+			Eigen::MatrixXd stress_tensor = compute_stress_from_svd<dim>(def_grad, U[p], sigmas[p], V[p], lambda, mu) * def_grad.transpose() / def_grad.determinant();
 			if (type == ElasticityTensorType::PK1)
 				stress_tensor = pk1_from_cauchy(stress_tensor, def_grad);
 			else if (type == ElasticityTensorType::PK2)
@@ -339,11 +359,12 @@ namespace polyfem::assembler
 			}
 		}
 
-		Eigen::Matrix<double, dim, dim> def_grad(size(), size());
-
 		Eigen::Matrix<double, n_basis, dim> G(data.vals.basis_values.size(), size());
 		G.setZero();
 
+		// the deformation gradients of all points first, to decompose them in a batch
+		std::vector<Eigen::Matrix<double, n_basis, dim>> delF_delUs(n_pts);
+		std::vector<Eigen::Matrix<double, dim, dim>> def_grads(n_pts);
 		for (long p = 0; p < n_pts; ++p)
 		{
 			Eigen::Matrix<double, n_basis, dim> grad(data.vals.basis_values.size(), size());
@@ -355,15 +376,24 @@ namespace polyfem::assembler
 
 			const Eigen::Matrix<double, dim, dim> jac_it = data.vals.jac_it[p];
 
-			const Eigen::Matrix<double, n_basis, dim> delF_delU = grad * jac_it;
+			delF_delUs[p] = grad * jac_it;
 
 			// Id + grad d
-			def_grad = local_disp.transpose() * delF_delU + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
+			def_grads[p] = local_disp.transpose() * delF_delUs[p] + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
+		}
+
+		std::vector<Eigen::Matrix<double, dim, dim>> U, V;
+		std::vector<Eigen::Vector<double, dim>> sigmas;
+		compute_svds<dim>(def_grads, U, sigmas, V);
+
+		for (long p = 0; p < n_pts; ++p)
+		{
+			const Eigen::Matrix<double, n_basis, dim> &delF_delU = delF_delUs[p];
 
 			double lambda, mu;
 			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
 
-			Eigen::Matrix<double, dim, dim> gradient_temp = compute_stress_from_def_grad(def_grad, lambda, mu);
+			Eigen::Matrix<double, dim, dim> gradient_temp = compute_stress_from_svd<dim>(def_grads[p], U[p], sigmas[p], V[p], lambda, mu);
 
 			Eigen::Matrix<double, n_basis, dim> gradient = delF_delU * gradient_temp.transpose();
 
@@ -399,7 +429,24 @@ namespace polyfem::assembler
 			}
 		}
 
-		Eigen::Matrix<double, dim, dim> def_grad(size(), size());
+		// the deformation gradients of all points first, to decompose them in a batch
+		std::vector<Eigen::Matrix<double, dim, dim>> def_grads(n_pts);
+		for (long p = 0; p < n_pts; ++p)
+		{
+			Eigen::Matrix<double, n_basis, dim> grad(data.vals.basis_values.size(), size());
+
+			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+			{
+				grad.row(i) = data.vals.basis_values[i].grad.row(p);
+			}
+
+			// Id + grad d
+			def_grads[p] = local_disp.transpose() * grad * data.vals.jac_it[p] + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
+		}
+
+		std::vector<Eigen::Matrix<double, dim, dim>> U, V;
+		std::vector<Eigen::Vector<double, dim>> sigmas;
+		compute_svds<dim>(def_grads, U, sigmas, V);
 
 		for (long p = 0; p < n_pts; ++p)
 		{
@@ -412,13 +459,10 @@ namespace polyfem::assembler
 
 			Eigen::Matrix<double, dim, dim> jac_it = data.vals.jac_it[p];
 
-			// Id + grad d
-			def_grad = local_disp.transpose() * grad * jac_it + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
-
 			double lambda, mu;
 			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
 
-			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = compute_stiffness_from_def_grad(def_grad, lambda, mu);
+			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = compute_stiffness_from_svd<dim>(U[p], sigmas[p], V[p], lambda, mu);
 
 			Eigen::Matrix<double, dim * dim, N> delF_delU_tensor(jac_it.size(), grad.size());
 
@@ -677,8 +721,12 @@ namespace polyfem::assembler
 	Eigen::Matrix<double, dim, dim> FixedCorotational::compute_stress_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu)
 	{
 		utils::AutoFlipSVD<Eigen::Matrix<double, dim, dim>> svd(F, Eigen::ComputeFullU | Eigen::ComputeFullV);
-		const Eigen::Vector<double, dim> sigmas = svd.singularValues();
+		return compute_stress_from_svd<dim>(F, svd.matrixU(), svd.singularValues(), svd.matrixV(), lambda, mu);
+	}
 
+	template <int dim>
+	Eigen::Matrix<double, dim, dim> FixedCorotational::compute_stress_from_svd(const Eigen::Matrix<double, dim, dim> &F, const Eigen::Matrix<double, dim, dim> &U, const Eigen::Vector<double, dim> &sigmas, const Eigen::Matrix<double, dim, dim> &V, const double lambda, const double mu)
+	{
 		Eigen::Matrix<double, dim, dim> delJ_delF(dim, dim);
 		delJ_delF.setZero();
 
@@ -700,14 +748,19 @@ namespace polyfem::assembler
 			delJ_delF.col(2) = cross<dim>(u, v);
 		}
 
-		return lambda * (sigmas.prod() - 1) * delJ_delF + mu * 2 * (F - svd.matrixU() * svd.matrixV().transpose());
+		return lambda * (sigmas.prod() - 1) * delJ_delF + mu * 2 * (F - U * V.transpose());
 	}
 
 	template <int dim>
 	Eigen::Matrix<double, dim*dim, dim*dim> FixedCorotational::compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu)
 	{
 		utils::AutoFlipSVD<Eigen::Matrix<double, dim, dim>> svd(F, Eigen::ComputeFullU | Eigen::ComputeFullV);
-		const Eigen::Vector<double, dim> sigmas = svd.singularValues();
+		return compute_stiffness_from_svd<dim>(svd.matrixU(), svd.singularValues(), svd.matrixV(), lambda, mu);
+	}
+
+	template <int dim>
+	Eigen::Matrix<double, dim*dim, dim*dim> FixedCorotational::compute_stiffness_from_svd(const Eigen::Matrix<double, dim, dim> &U, const Eigen::Vector<double, dim> &sigmas, const Eigen::Matrix<double, dim, dim> &V, const double lambda, const double mu)
+	{
 		Eigen::Matrix<double, dim, 1> dE_div_dsigma = compute_stress_from_singular_values(sigmas, lambda, mu);
 		Eigen::Matrix<double, dim, dim> d2E_div_dsigma2 = compute_stiffness_from_singular_values(sigmas, lambda, mu);
 
@@ -780,8 +833,6 @@ namespace polyfem::assembler
 		// compute hessian
 		Eigen::Matrix<double, dim*dim, dim*dim> hessian;
 		hessian.setZero();
-		const Eigen::Matrix<double, dim, dim>& U = svd.matrixU();
-		const Eigen::Matrix<double, dim, dim>& V = svd.matrixV();
 		for (int i = 0; i < dim; i++) {
 			// int _dim_i = i * dim;
 			for (int j = 0; j < dim; j++) {
@@ -811,4 +862,29 @@ namespace polyfem::assembler
 
 		return hessian;
 	}
+
+	template <int dim>
+	void FixedCorotational::compute_svds(const std::vector<Eigen::Matrix<double, dim, dim>> &F,
+										 std::vector<Eigen::Matrix<double, dim, dim>> &U,
+										 std::vector<Eigen::Vector<double, dim>> &sigmas,
+										 std::vector<Eigen::Matrix<double, dim, dim>> &V)
+	{
+		if constexpr (dim == 3)
+		{
+			utils::batched_svd_3x3(F, U, sigmas, V);
+		}
+		else
+		{
+			U.resize(F.size());
+			sigmas.resize(F.size());
+			V.resize(F.size());
+			for (size_t p = 0; p < F.size(); ++p)
+			{
+				utils::AutoFlipSVD<Eigen::Matrix<double, dim, dim>> svd(F[p], Eigen::ComputeFullU | Eigen::ComputeFullV);
+				U[p] = svd.matrixU();
+				sigmas[p] = svd.singularValues();
+				V[p] = svd.matrixV();
+			}
+		}
+	}
 } // namespace polyfem::assembler
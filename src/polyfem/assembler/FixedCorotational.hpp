@@ -80,5 +80,25 @@ namespace polyfem::assembler
 		static Eigen::Matrix<double, dim, dim> compute_stress_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
 		template <int dim>
 		static Eigen::Matrix<double, dim*dim, dim*dim> compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
+
+		// same as above with the SVD F = U diag(sigmas) V^T already computed
+		template <int dim>
+		static Eigen::Matrix<double, dim, dim> compute_stress_from_svd(const Eigen::Matrix<double, dim, dim> &F, const Eigen::Matrix<double, dim, dim> &U, const Eigen::Vector<double, dim> &sigmas, const Eigen::Matrix<double, dim, dim> &V, const double lambda, const double mu);
+		template <int dim>
+		static Eigen::Matrix<double, dim*dim, dim*dim> compute_stiffness_from_svd(const Eigen::Matrix<double, dim, dim> &U, const Eigen::Vector<double, dim> &sigmas, const Eigen::Matrix<double, dim, dim> &V, const double lambda, const double mu);
+
+		// SVDs of the deformation gradients of all quadrature points of an element, batched in 3D
+		template <int dim>
+		static void compute_svds(const std::vector<Eigen::Matrix<double, dim, dim>> &F,
+								 std::vector<Eigen::Matrix<double, dim, dim>> &U,
+								 std::vector<Eigen::Vector<double, dim>> &sigmas,
+								 std::vector<Eigen::Matrix<double, dim, dim>> &V);
+
+		template <int dim>
+		void assign_stress_tensor_aux(const OutputData &data,
+									  const int all_size,
+									  const ElasticityTensorType &type,
+									  Eigen::MatrixXd &all,
+									  const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const;
 	};
 } // namespace polyfem::assembler
@@ -0,0 +1,336 @@
+#include "FlatAssemblyValsCache.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace polyfem
+{
+	using namespace basis;
+
+	namespace assembler
+	{
+		namespace
+		{
+			// keep every element aligned on a cache line
+			constexpr long ALIGNMENT = 64 / sizeof(double);
+
+			class LocalThreadStorage
+			{
+			public:
+				ElementAssemblyValues vals;
+			};
+		} // namespace
+
+		long FlatElementValues::stride(const int n_bases, const int n_quad, const int dim)
+		{
+			const long size = long(n_quad) * (n_bases * (1 + dim) + 1 + dim * dim + dim);
+			return ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+		}
+
+		void FlatAssemblyValsCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const bool is_mass)
+		{
+			clear();
+
+			is_mass_ = is_mass;
+			dim_ = is_volume ? 3 : 2;
+			const int n_elements = bases.size();
+
+			// first pass, figure out the element types
+			std::vector<int> n_quad(n_elements);
+			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+				quadrature::Quadrature quadrature;
+				for (int e = start; e < end; ++e)
+				{
+					if (is_mass_)
+						bases[e].compute_mass_quadrature(quadrature);
+					else
+						bases[e].compute_quadrature(quadrature);
+					n_quad[e] = quadrature.weights.size();
+				}
+			});
+
+			std::map<std::pair<int, int>, int> group_ids;
+			element_group_.resize(n_elements);
+			element_offset_.resize(n_elements);
+			for (int e = 0; e < n_elements; ++e)
+			{
+				const std::pair<int, int> key(bases[e].bases.size(), n_quad[e]);
+				auto it = group_ids.find(key);
+				if (it == group_ids.end())
+				{
+					it = group_ids.emplace(key, groups_.size()).first;
+					Group g;
+					g.n_bases = key.first;
+					g.n_quad = key.second;
+					g.stride = FlatElementValues::stride(g.n_bases, g.n_quad, dim_);
+					g.offset = 0;
+					g.size = 0;
+					groups_.push_back(std::move(g));
+				}
+
+				Group &g = groups_[it->second];
+				element_group_[e] = it->second;
+				element_offset_[e] = g.size;
+				g.size += g.stride;
+			}
+
+			long n_doubles = 0;
+			for (Group &g : groups_)
+			{
+				g.offset = n_doubles;
+				n_doubles += g.size;
+			}
+			allocate(n_doubles);
+
+			// second pass, compute and pack
+			auto local_storages = utils::create_thread_storage(LocalThreadStorage());
+			const auto compute_block = [&](const int block_start, const int block_end) {
+				utils::maybe_parallel_for(block_end - block_start, [&](int start, int end, int thread_id) {
+					LocalThreadStorage &local_storage = utils::get_local_thread_storage(local_storages, thread_id);
+					ElementAssemblyValues &vals = local_storage.vals;
+
+					for (int e = block_start + start; e < block_start + end; ++e)
+					{
+						if (is_mass_)
+						{
+							bases[e].compute_mass_quadrature(vals.quadrature);
+							vals.compute(e, is_volume, vals.quadrature.points, bases[e], gbases[e]);
+						}
+						else
+							vals.compute(e, is_volume, bases[e], gbases[e]);
+
+						Group &g = groups_[element_group_[e]];
+						const int nb = g.n_bases;
+						const int nq = g.n_quad;
+						assert(vals.basis_values.size() == nb);
+						assert(vals.quadrature.weights.size() == nq);
+
+						double *data = storage() + g.offset + element_offset_[e];
+
+						for (int i = 0; i < nb; ++i)
+							Eigen::Map<Eigen::VectorXd>(data + i * nq, nq) = vals.basis_values[i].val;
+						data += nb * nq;
+
+						for (int i = 0; i < nb; ++i)
+							Eigen::Map<Eigen::MatrixXd>(data + i * nq * dim_, nq, dim_) = vals.basis_values[i].grad_t_m;
+						data += nb * nq * dim_;
+
+						Eigen::Map<Eigen::VectorXd>(data, nq) = vals.det.array() * vals.quadrature.weights.array();
+						data += nq;
+
+						for (int q = 0; q < nq; ++q)
+							Eigen::Map<Eigen::MatrixXd>(data + q * dim_ * dim_, dim_, dim_) = vals.jac_it[q];
+						data += nq * dim_ * dim_;
+
+						Eigen::Map<Eigen::MatrixXd>(data, nq, dim_) = vals.val;
+					}
+				});
+			};
+
+			if (!is_streamed())
+			{
+				compute_block(0, n_elements);
+				return;
+			}
+
+			// write the values block by block, the written pages are flushed to keep the budget
+			for (const auto &[start, end] : element_blocks())
+			{
+				compute_block(start, end);
+				advise(start, end, false);
+			}
+		}
+
+		FlatElementValues FlatAssemblyValsCache::element(const int el_index) const
+		{
+			assert(el_index < element_group_.size());
+
+			const Group &g = groups_[element_group_[el_index]];
+			FlatElementValues res;
+			res.element_id = el_index;
+			res.n_bases = g.n_bases;
+			res.n_quad = g.n_quad;
+			res.dim = dim_;
+			res.data_ = storage() + g.offset + element_offset_[el_index];
+
+			return res;
+		}
+
+		std::vector<std::pair<int, int>> FlatAssemblyValsCache::element_blocks() const
+		{
+			std::vector<std::pair<int, int>> blocks;
+			if (n_elements() == 0)
+				return blocks;
+
+			if (!is_streamed())
+			{
+				blocks.emplace_back(0, n_elements());
+				return blocks;
+			}
+
+			// the current and the prefetched block share the budget
+			const size_t block_bytes = std::max<size_t>(memory_budget_ / 2, 1);
+			int start = 0;
+			size_t bytes = 0;
+			for (int e = 0; e < n_elements(); ++e)
+			{
+				const size_t element_bytes = groups_[element_group_[e]].stride * sizeof(double);
+				if (e > start && bytes + element_bytes > block_bytes)
+				{
+					blocks.emplace_back(start, e);
+					start = e;
+					bytes = 0;
+				}
+				bytes += element_bytes;
+			}
+			blocks.emplace_back(start, n_elements());
+
+			return blocks;
+		}
+
+		void FlatAssemblyValsCache::for_each_block(const std::function<void(int, int)> &f) const
+		{
+			const std::vector<std::pair<int, int>> blocks = element_blocks();
+			if (blocks.empty())
+				return;
+
+			if (is_streamed())
+				advise(blocks[0].first, blocks[0].second, true);
+
+			for (int b = 0; b < blocks.size(); ++b)
+			{
+				// the read ahead of the next block runs in the background
+				if (is_streamed() && b + 1 < blocks.size())
+					advise(blocks[b + 1].first, blocks[b + 1].second, true);
+
+				f(blocks[b].first, blocks[b].second);
+
+				if (is_streamed())
+					advise(blocks[b].first, blocks[b].second, false);
+			}
+		}
+
+		void FlatAssemblyValsCache::set_streaming(const std::string &backing_file, const size_t memory_budget)
+		{
+			backing_file_ = backing_file;
+			memory_budget_ = memory_budget;
+		}
+
+		void FlatAssemblyValsCache::allocate(const long n_doubles)
+		{
+			if (backing_file_.empty() || n_doubles == 0)
+			{
+				heap_.resize(n_doubles);
+				return;
+			}
+
+#ifdef _WIN32
+			logger().warn("Streaming of the assembly values is not supported on Windows, the values are stored in memory");
+			heap_.resize(n_doubles);
+#else
+			const size_t bytes = n_doubles * sizeof(double);
+			const int fd = ::open(backing_file_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+			if (fd < 0)
+				log_and_throw_error("Unable to create the assembly values file {}", backing_file_);
+
+			if (::ftruncate(fd, bytes) != 0)
+			{
+				::close(fd);
+				log_and_throw_error("Unable to allocate {} bytes in {}", bytes, backing_file_);
+			}
+
+			void *mapped = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			// the mapping keeps the file open
+			::close(fd);
+			if (mapped == MAP_FAILED)
+				log_and_throw_error("Unable to map {}", backing_file_);
+
+			mapped_ = static_cast<double *>(mapped);
+			mapped_bytes_ = bytes;
+			logger().debug("Streaming {} MB of assembly values from {}", bytes / (1024. * 1024.), backing_file_);
+#endif
+		}
+
+		void FlatAssemblyValsCache::advise(const int start, const int end, const bool will_need) const
+		{
+#ifndef _WIN32
+			assert(is_streamed());
+
+			// range of every arena touched by the elements
+			std::vector<long> first(groups_.size(), std::numeric_limits<long>::max());
+			std::vector<long> last(groups_.size(), -1);
+			for (int e = start; e < end; ++e)
+			{
+				const int g = element_group_[e];
+				first[g] = std::min(first[g], element_offset_[e]);
+				last[g] = std::max(last[g], element_offset_[e] + groups_[g].stride);
+			}
+
+			const size_t page = ::sysconf(_SC_PAGESIZE);
+			char *base = reinterpret_cast<char *>(mapped_);
+			for (int g = 0; g < groups_.size(); ++g)
+			{
+				if (last[g] < 0)
+					continue;
+
+				const size_t begin_byte = ((groups_[g].offset + first[g]) * sizeof(double) / page) * page;
+				const size_t end_byte = std::min(mapped_bytes_, (((groups_[g].offset + last[g]) * sizeof(double) + page - 1) / page) * page);
+
+				if (will_need)
+				{
+					::madvise(base + begin_byte, end_byte - begin_byte, MADV_WILLNEED);
+				}
+				else
+				{
+					// written pages go to the file before they are dropped
+					::msync(base + begin_byte, end_byte - begin_byte, MS_SYNC);
+					::madvise(base + begin_byte, end_byte - begin_byte, MADV_DONTNEED);
+				}
+			}
+#endif
+		}
+
+		FlatAssemblyValsCache::~FlatAssemblyValsCache()
+		{
+			clear();
+		}
+
+		void FlatAssemblyValsCache::clear()
+		{
+			groups_.clear();
+			element_group_.clear();
+			element_offset_.clear();
+			heap_.clear();
+
+#ifndef _WIN32
+			if (mapped_ != nullptr)
+			{
+				::munmap(mapped_, mapped_bytes_);
+				mapped_ = nullptr;
+				mapped_bytes_ = 0;
+
+				std::error_code ec;
+				std::filesystem::remove(backing_file_, ec);
+			}
+#endif
+		}
+
+		size_t FlatAssemblyValsCache::memory_size() const
+		{
+			size_t res = 0;
+			for (const auto &g : groups_)
+				res += g.size * sizeof(double);
+			return res;
+		}
+	} // namespace assembler
+} // namespace polyfem
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+
+#include <Eigen/StdVector>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace polyfem
+{
+	namespace assembler
+	{
+		/// read only view on the flat storage of one element
+		/// all quantities are stored column-major and contiguously, one block per basis
+		class FlatElementValues
+		{
+		public:
+			int element_id = -1;
+			int n_bases = 0; ///< number of local bases
+			int n_quad = 0;  ///< number of quadrature points
+			int dim = 0;     ///< dimension of the element
+
+			/// evaluation of basis i at the quadrature points R^{m}
+			inline Eigen::Map<const Eigen::VectorXd> val(const int i) const
+			{
+				assert(i < n_bases);
+				return Eigen::Map<const Eigen::VectorXd>(data_ + i * n_quad, n_quad);
+			}
+
+			/// all basis evaluations R^{m x n_bases}, column i is basis i
+			inline Eigen::Map<const Eigen::MatrixXd> vals() const
+			{
+				return Eigen::Map<const Eigen::MatrixXd>(data_, n_quad, n_bases);
+			}
+
+			/// gradient of basis i pre-multiplied by J^{-T} R^{m x dim}
+			inline Eigen::Map<const Eigen::MatrixXd> grad_t_m(const int i) const
+			{
+				assert(i < n_bases);
+				return Eigen::Map<const Eigen::MatrixXd>(data_ + n_bases * n_quad + i * n_quad * dim, n_quad, dim);
+			}
+
+			/// det of the geometric mapping times quadrature weight R^{m}
+			inline Eigen::Map<const Eigen::VectorXd> da() const
+			{
+				return Eigen::Map<const Eigen::VectorXd>(data_ + n_bases * n_quad * (1 + dim), n_quad);
+			}
+
+			/// inverse transpose jacobian of geom mapping at quadrature point q R^{dim x dim}
+			inline Eigen::Map<const Eigen::MatrixXd> jac_it(const int q) const
+			{
+				assert(q < n_quad);
+				return Eigen::Map<const Eigen::MatrixXd>(data_ + n_bases * n_quad * (1 + dim) + n_quad + q * dim * dim, dim, dim);
+			}
+
+			/// img of quadrature points through the geom mapping R^{m x dim}
+			inline Eigen::Map<const Eigen::MatrixXd> points() const
+			{
+				return Eigen::Map<const Eigen::MatrixXd>(data_ + n_bases * n_quad * (1 + dim) + n_quad * (1 + dim * dim), n_quad, dim);
+			}
+
+			/// number of doubles used by one element with the given sizes
+			static long stride(const int n_bases, const int n_quad, const int dim);
+
+		private:
+			const double *data_ = nullptr;
+
+			friend class FlatAssemblyValsCache;
+		};
+
+		/// Structure-of-arrays alternative to AssemblyValsCache
+		/// elements sharing the same number of bases and quadrature points are packed in one
+		/// contiguous aligned arena, so kernels can stream through the values without pointer chasing
+		/// Local2Global mappings are not duplicated, use the ElementBases for the global indices
+		///
+		/// With set_streaming the arenas live in a memory-mapped file instead of the heap, for meshes whose
+		/// values do not fit in memory. The elements are then visited by blocks with for_each_block, which
+		/// prefetches the next block and releases the previous one to stay within the memory budget.
+		class FlatAssemblyValsCache
+		{
+		public:
+			FlatAssemblyValsCache() = default;
+			~FlatAssemblyValsCache();
+			// the cache may own a mapping
+			FlatAssemblyValsCache(const FlatAssemblyValsCache &) = delete;
+			FlatAssemblyValsCache &operator=(const FlatAssemblyValsCache &) = delete;
+
+			/// computes the basis evaluation and geometric mapping of every element and packs them
+			void init(const bool is_volume, const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const bool is_mass = false);
+
+			/// stores the values of the next init in backing_file, empty to store them on the heap
+			/// @param[in] backing_file file created by init and removed by clear
+			/// @param[in] memory_budget bytes of values resident at once, split between the current and the prefetched block
+			void set_streaming(const std::string &backing_file, const size_t memory_budget);
+
+			/// view on the values of element el_index, valid until the cache is cleared or re-initialized
+			/// when streaming, the view is valid everywhere but only the current block is resident
+			FlatElementValues element(const int el_index) const;
+
+			/// consecutive ranges [start, end) of elements whose values fit in half of the memory budget,
+			/// a single range if the values are on the heap
+			std::vector<std::pair<int, int>> element_blocks() const;
+
+			/// calls f on every block of element_blocks in order, the next block is read while f runs
+			/// and the values of the visited blocks are released
+			void for_each_block(const std::function<void(int, int)> &f) const;
+
+			void clear();
+
+			inline bool is_initialized() const { return !element_group_.empty(); }
+			inline bool is_mass() const { return is_mass_; }
+			inline bool is_streamed() const { return mapped_ != nullptr; }
+			inline int n_elements() const { return element_group_.size(); }
+			/// number of element types (i.e., different arenas)
+			inline int n_groups() const { return groups_.size(); }
+
+			/// memory used by the arenas in bytes, on disk when streaming
+			size_t memory_size() const;
+
+		private:
+			/// one arena per element type
+			struct Group
+			{
+				int n_bases;
+				int n_quad;
+				long stride;
+				long offset; ///< start of the arena in the storage, in number of doubles
+				long size;   ///< number of doubles of the arena
+			};
+
+			inline double *storage() { return mapped_ != nullptr ? mapped_ : heap_.data(); }
+			inline const double *storage() const { return mapped_ != nullptr ? mapped_ : heap_.data(); }
+
+			/// allocates the storage of n_doubles values, mapped if streaming
+			void allocate(const long n_doubles);
+			/// advises the kernel about the pages of the elements in [start, end)
+			void advise(const int start, const int end, const bool will_need) const;
+
+			std::vector<Group> groups_;
+			std::vector<int> element_group_;   ///< arena index of every element
+			std::vector<long> element_offset_; ///< offset (in number of doubles) of the element in its arena
+			int dim_ = 0;
+			bool is_mass_ = false;
+
+			std::vector<double, Eigen::aligned_allocator<double>> heap_;
+
+			std::string backing_file_;
+			size_t memory_budget_ = 0;
+			double *mapped_ = nullptr;
+			size_t mapped_bytes_ = 0;
+		};
+	} // namespace assembler
+} // namespace polyfem
@@ -8,6 +8,8 @@
 
 #include <polyfem/utils/Logger.hpp>
 
+#include <ipc/utils/eigen_ext.hpp>
+
 namespace polyfem::assembler
 {
 	template <typename Derived>
@@ -92,6 +94,9 @@ namespace polyfem::assembler
 	template <typename Derived>
 	Eigen::VectorXd GenericElastic<Derived>::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
+		if constexpr (Derived::use_def_grad_kernels)
+			return size() == 2 ? assemble_gradient_def_grad<2>(data) : assemble_gradient_def_grad<3>(data);
+
 		const int n_bases = data.vals.basis_values.size();
 		return polyfem::gradient_from_energy(
 			size(), n_bases, data,
@@ -111,6 +116,15 @@ namespace polyfem::assembler
 	template <typename Derived>
 	Eigen::MatrixXd GenericElastic<Derived>::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
+		if constexpr (Derived::use_def_grad_kernels)
+		{
+			double energy;
+			Eigen::VectorXd grad;
+			Eigen::MatrixXd hessian;
+			compute_energy_gradient_hessian(data, energy, grad, hessian);
+			return hessian;
+		}
+
 		const int n_bases = data.vals.basis_values.size();
 		return polyfem::hessian_from_energy(
 			size(), n_bases, data,
@@ -126,6 +140,138 @@ namespace polyfem::assembler
 			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
 	}
 
+	template <typename Derived>
+	template <int dim>
+	void GenericElastic<Derived>::def_grad_and_chain_at_quad(
+		const NonLinearAssemblerData &data,
+		const Eigen::VectorXd &local_disp,
+		const int p,
+		Eigen::Matrix<double, dim, dim> &F,
+		Eigen::Matrix<double, dim * dim, Eigen::Dynamic> &B) const
+	{
+		const int n_bases = data.vals.basis_values.size();
+
+		F.setIdentity();
+		B.setZero(dim * dim, n_bases * dim);
+		for (int i = 0; i < n_bases; ++i)
+		{
+			const Eigen::Matrix<double, 1, dim> grad = data.vals.basis_values[i].grad_t_m.row(p);
+			for (int d = 0; d < dim; ++d)
+			{
+				F.row(d) += local_disp(i * dim + d) * grad;
+				for (int c = 0; c < dim; ++c)
+					B(d * dim + c, i * dim + d) = grad(c);
+			}
+		}
+	}
+
+	template <typename Derived>
+	template <int dim>
+	Eigen::VectorXd GenericElastic<Derived>::assemble_gradient_def_grad(const NonLinearAssemblerData &data) const
+	{
+		typedef DScalar1<double, Eigen::Matrix<double, dim * dim, 1>> Diff;
+
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::VectorXd local_disp;
+		get_local_disp(data, dim, local_disp);
+
+		DiffScalarBase::setVariableCount(dim * dim);
+
+		Eigen::VectorXd grad = Eigen::VectorXd::Zero(n_bases * dim);
+		Eigen::Matrix<double, dim, dim> F;
+		Eigen::Matrix<double, dim * dim, Eigen::Dynamic> B;
+		DefGradMatrix<Diff> def_grad(dim, dim);
+
+		for (long p = 0; p < data.da.size(); ++p)
+		{
+			def_grad_and_chain_at_quad<dim>(data, local_disp, p, F, B);
+
+			if constexpr (Derived::use_closed_form_def_grad)
+			{
+				Eigen::Matrix<double, dim * dim, 1> gradient;
+				derived().template elastic_energy_derivatives<dim>(data.vals.val.row(p), data.t, data.vals.element_id, F, gradient, nullptr);
+				grad.noalias() += data.da(p) * (B.transpose() * gradient);
+				continue;
+			}
+
+			for (int d1 = 0; d1 < dim; ++d1)
+				for (int d2 = 0; d2 < dim; ++d2)
+					def_grad(d1, d2) = Diff(d1 * dim + d2, F(d1, d2));
+
+			const Diff val = derived().elastic_energy(data.vals.val.row(p), data.t, data.vals.element_id, def_grad);
+
+			grad.noalias() += data.da(p) * (B.transpose() * val.getGradient());
+		}
+
+		return grad;
+	}
+
+	template <typename Derived>
+	template <int dim>
+	void GenericElastic<Derived>::energy_gradient_hessian_def_grad(const NonLinearAssemblerData &data, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const
+	{
+		typedef DScalar2<double, Eigen::Matrix<double, dim * dim, 1>, Eigen::Matrix<double, dim * dim, dim * dim>> Diff;
+
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::VectorXd local_disp;
+		get_local_disp(data, dim, local_disp);
+
+		DiffScalarBase::setVariableCount(dim * dim);
+
+		energy = 0;
+		grad.setZero(n_bases * dim);
+		hessian.setZero(n_bases * dim, n_bases * dim);
+		Eigen::Matrix<double, dim, dim> F;
+		Eigen::Matrix<double, dim * dim, Eigen::Dynamic> B;
+		DefGradMatrix<Diff> def_grad(dim, dim);
+
+		for (long p = 0; p < data.da.size(); ++p)
+		{
+			def_grad_and_chain_at_quad<dim>(data, local_disp, p, F, B);
+
+			if constexpr (Derived::use_closed_form_def_grad)
+			{
+				Eigen::Matrix<double, dim * dim, 1> gradient;
+				Eigen::Matrix<double, dim * dim, dim * dim> hess;
+				derived().template elastic_energy_derivatives<dim>(data.vals.val.row(p), data.t, data.vals.element_id, F, gradient, &hess);
+				if (data.project_to_psd)
+					hess = ipc::project_to_psd(hess);
+
+				energy += data.da(p) * derived().elastic_energy(data.vals.val.row(p), data.t, data.vals.element_id, DefGradMatrix<double>(F));
+				grad.noalias() += data.da(p) * (B.transpose() * gradient);
+				const Eigen::Matrix<double, dim * dim, Eigen::Dynamic> CB = hess * B;
+				hessian.noalias() += data.da(p) * (B.transpose() * CB);
+				continue;
+			}
+
+			for (int d1 = 0; d1 < dim; ++d1)
+				for (int d2 = 0; d2 < dim; ++d2)
+					def_grad(d1, d2) = Diff(d1 * dim + d2, F(d1, d2));
+
+			const Diff val = derived().elastic_energy(data.vals.val.row(p), data.t, data.vals.element_id, def_grad);
+
+			energy += data.da(p) * val.getValue();
+			grad.noalias() += data.da(p) * (B.transpose() * val.getGradient());
+			const Eigen::Matrix<double, dim * dim, Eigen::Dynamic> CB = (data.project_to_psd ? Eigen::Matrix<double, dim * dim, dim * dim>(ipc::project_to_psd(val.getHessian())) : val.getHessian()) * B;
+			hessian.noalias() += data.da(p) * (B.transpose() * CB);
+		}
+	}
+
+	template <typename Derived>
+	void GenericElastic<Derived>::compute_energy_gradient_hessian(const NonLinearAssemblerData &data, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const
+	{
+		if constexpr (Derived::use_def_grad_kernels)
+		{
+			// the second order autodiff wrt F also gives the value and the first derivatives
+			if (size() == 2)
+				energy_gradient_hessian_def_grad<2>(data, energy, grad, hessian);
+			else
+				energy_gradient_hessian_def_grad<3>(data, energy, grad, hessian);
+		}
+		else
+			NLAssembler::compute_energy_gradient_hessian(data, energy, grad, hessian);
+	}
+
 	template <typename Derived>
 	void GenericElastic<Derived>::compute_stress_grad_multiply_mat(
 		const OptAssemblerData &data,
@@ -24,6 +24,8 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
+		void compute_energy_gradient_hessian(const NonLinearAssemblerData &data, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const override;
+		bool projects_hessian_pointwise() const override { return Derived::use_def_grad_kernels; }
 
 		void assign_stress_tensor(const OutputData &data,
 								  const int all_size,
@@ -53,7 +55,37 @@ namespace polyfem::assembler
 		// sets material params
 		virtual void add_multimaterial(const int index, const json &params, const Units &units) override = 0;
 
+		/// models whose energy depends on the deformation gradient only can set this to true in the derived class
+		/// to differentiate wrt the dim x dim entries of F with fixed size types and apply the chain rule,
+		/// instead of differentiating wrt all the local dofs at every quadrature point
+		static constexpr bool use_def_grad_kernels = false;
+
+		/// models with closed-form derivatives wrt the deformation gradient (e.g., generated in autogen) can set this
+		/// to true, together with use_def_grad_kernels, and implement
+		///     template <int dim>
+		///     void elastic_energy_derivatives(const RowVectorNd &p, const double t, const int el_id,
+		///                                     const Eigen::Matrix<double, dim, dim> &def_grad,
+		///                                     Eigen::Matrix<double, dim * dim, 1> &gradient,
+		///                                     Eigen::Matrix<double, dim * dim, dim * dim> *hessian) const;
+		/// with the entries ordered as vec(F)(d * dim + c) = F(d, c), hessian is nullptr if only the gradient is needed
+		static constexpr bool use_closed_form_def_grad = false;
+
 	private:
+		// gradient and hessian computed with fixed size autodiff wrt the deformation gradient
+		template <int dim>
+		Eigen::VectorXd assemble_gradient_def_grad(const NonLinearAssemblerData &data) const;
+		template <int dim>
+		void energy_gradient_hessian_def_grad(const NonLinearAssemblerData &data, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const;
+
+		// fills F = Id + grad u at quadrature point p and B such that vec(dF) = B du, with vec(F)(d * dim + c) = F(d, c)
+		template <int dim>
+		void def_grad_and_chain_at_quad(
+			const NonLinearAssemblerData &data,
+			const Eigen::VectorXd &local_disp,
+			const int p,
+			Eigen::Matrix<double, dim, dim> &F,
+			Eigen::Matrix<double, dim * dim, Eigen::Dynamic> &B) const;
+
 		// utility function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
 		template <typename T>
 		T compute_energy_aux(const NonLinearAssemblerData &data) const
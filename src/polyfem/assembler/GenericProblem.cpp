@@ -70,6 +70,22 @@ namespace polyfem
 			return val;
 		}
 
+		void TensorBCValue::eval(const Eigen::MatrixXd &pts, const int dim, const double t, Eigen::VectorXd &val, const int el_id) const
+		{
+			value[dim].evaluate(pts, t, val, el_id);
+
+			if (interpolation.empty())
+			{
+			}
+			else if (interpolation.size() == 1)
+				val *= interpolation[0]->eval(t);
+			else
+			{
+				assert(dim < interpolation.size());
+				val *= interpolation[dim]->eval(t);
+			}
+		}
+
 		double ScalarBCValue::eval(const RowVectorNd &pts, const double t) const
 		{
 			assert(pts.size() == 2 || pts.size() == 3);
@@ -77,6 +93,37 @@ namespace polyfem
 			return value(x, y, z, t) * interpolation->eval(t);
 		}
 
+		void ScalarBCValue::eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &val) const
+		{
+			value.evaluate(pts, t, val);
+			val *= interpolation->eval(t);
+		}
+
+		namespace
+		{
+			/// rows i of the points with boundary id tag, all of them if ids are not used
+			std::vector<int> rows_with_tag(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const int n_pts, const bool all, const std::vector<int> &boundary_ids, const int b)
+			{
+				std::vector<int> rows;
+				rows.reserve(n_pts);
+				for (int i = 0; i < n_pts; ++i)
+				{
+					if (all)
+					{
+						rows.push_back(i);
+						continue;
+					}
+
+					// the first boundary with the id wins
+					const int id = mesh.get_boundary_id(global_ids(i));
+					const auto it = std::find(boundary_ids.begin(), boundary_ids.end(), id);
+					if (it != boundary_ids.end() && it - boundary_ids.begin() == b)
+						rows.push_back(i);
+				}
+				return rows;
+			}
+		} // namespace
+
 		GenericTensorProblem::GenericTensorProblem(const std::string &name)
 			: Problem(name), is_all_(false)
 		{
@@ -182,14 +229,11 @@ namespace polyfem
 				return;
 			}
 
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			for (int j = 0; j < pts.cols(); ++j)
 			{
-				for (int j = 0; j < pts.cols(); ++j)
-				{
-					double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-					val(i, j) = rhs_[j](x, y, z, t);
-				}
+				rhs_[j].evaluate(pts, t, tmp);
+				val.col(j) = tmp;
 			}
 		}
 
@@ -220,32 +264,21 @@ namespace polyfem
 		void GenericTensorProblem::dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
+			if (is_all_)
+				assert(displacements_.size() == 1);
 
-			for (long i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			for (size_t b = 0; b < displacements_.size(); ++b)
 			{
-				if (is_all_)
-				{
-					assert(displacements_.size() == 1);
-					for (int d = 0; d < val.cols(); ++d)
-					{
-						val(i, d) = displacements_[0].eval(pts.row(i), d, t);
-					}
-				}
-				else
-				{
-					const int id = mesh.get_boundary_id(global_ids(i));
-					for (size_t b = 0; b < boundary_ids_.size(); ++b)
-					{
-						if (id == boundary_ids_[b])
-						{
-							for (int d = 0; d < val.cols(); ++d)
-							{
-								val(i, d) = displacements_[b].eval(pts.row(i), d, t);
-							}
+				const std::vector<int> rows = rows_with_tag(mesh, global_ids, pts.rows(), is_all_, boundary_ids_, b);
+				if (rows.empty())
+					continue;
 
-							break;
-						}
-					}
+				const Eigen::MatrixXd b_pts = pts(rows, Eigen::all);
+				for (int d = 0; d < val.cols(); ++d)
+				{
+					displacements_[b].eval(b_pts, d, t, tmp);
+					val(rows, d) = tmp;
 				}
 			}
 		}
@@ -918,37 +951,27 @@ namespace polyfem
 				val.setZero();
 				return;
 			}
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
-			{
-				double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-				val(i) = rhs_(x, y, z, t);
-			}
+
+			Eigen::VectorXd tmp;
+			rhs_.evaluate(pts, t, tmp);
+			val.col(0) = tmp;
 		}
 
 		void GenericScalarProblem::dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), 1);
+			if (is_all_)
+				assert(dirichlet_.size() == 1);
 
-			for (long i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			for (size_t b = 0; b < dirichlet_.size(); ++b)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
-				if (is_all_)
-				{
-					assert(dirichlet_.size() == 1);
-					val(i) = dirichlet_[0].eval(pts.row(i), t);
-				}
-				else
-				{
-					for (size_t b = 0; b < boundary_ids_.size(); ++b)
-					{
-						if (id == boundary_ids_[b])
-						{
-							val(i) = dirichlet_[b].eval(pts.row(i), t);
-							break;
-						}
-					}
-				}
+				const std::vector<int> rows = rows_with_tag(mesh, global_ids, pts.rows(), is_all_, boundary_ids_, b);
+				if (rows.empty())
+					continue;
+
+				dirichlet_[b].eval(pts(rows, Eigen::all), t, tmp);
+				val(rows, 0) = tmp;
 			}
 		}
 
@@ -21,6 +21,8 @@ namespace polyfem
 			}
 
 			double eval(const RowVectorNd &pts, const int dim, const double t, const int el_id = -1) const;
+			/// eval at all the rows of pts
+			void eval(const Eigen::MatrixXd &pts, const int dim, const double t, Eigen::VectorXd &val, const int el_id = -1) const;
 		};
 
 		struct ScalarBCValue
@@ -34,6 +36,8 @@ namespace polyfem
 			}
 
 			double eval(const RowVectorNd &pts, const double t) const;
+			/// eval at all the rows of pts
+			void eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &val) const;
 		};
 
 		class GenericTensorProblem : public Problem
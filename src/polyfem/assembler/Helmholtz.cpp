@@ -15,15 +15,22 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &gradj = data.vals.basis_values[data.j].grad_t_m;
 
 		double res = 0;
-		for (int k = 0; k < gradi.rows(); ++k)
+		if (term_ != Term::Mass)
 		{
-			res += gradi.row(k).dot(gradj.row(k)) * data.da(k);
+			for (int k = 0; k < gradi.rows(); ++k)
+			{
+				res += gradi.row(k).dot(gradj.row(k)) * data.da(k);
+			}
 		}
 
-		for (int k = 0; k < gradi.rows(); ++k)
+		if (term_ != Term::Stiffness)
 		{
-			const double tmp = k_(data.vals.val.row(k), data.t, data.vals.element_id);
-			res -= data.vals.basis_values[data.i].val(k) * data.vals.basis_values[data.j].val(k) * data.da[k] * tmp * tmp;
+			const double sign = term_ == Term::Mass ? 1 : -1;
+			for (int k = 0; k < gradi.rows(); ++k)
+			{
+				const double tmp = k_(data.vals.val.row(k), data.t, data.vals.element_id);
+				res += sign * data.vals.basis_values[data.i].val(k) * data.vals.basis_values[data.j].val(k) * data.da[k] * tmp * tmp;
+			}
 		}
 
 		return Eigen::Matrix<double, 1, 1>::Constant(res);
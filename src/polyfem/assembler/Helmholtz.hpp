@@ -26,10 +26,24 @@ namespace polyfem::assembler
 
 		GenericMatParam k() const { return k_; }
 
+		/// terms of the bilinear form integrated by assemble, the full form is stiffness - mass
+		enum class Term
+		{
+			Full,
+			/// \int grad phi_i . grad phi_j
+			Stiffness,
+			/// \int k^2 phi_i phi_j
+			Mass
+		};
+		/// select the terms assembled, e.g., to assemble the stiffness and mass of a frequency sweep once
+		void set_term(const Term term) { term_ = term; }
+		Term term() const { return term_; }
+
 		std::string name() const override { return "Helmholtz"; }
 		std::map<std::string, ParamFunc> parameters() const override;
 
 	private:
 		GenericMatParam k_;
+		Term term_ = Term::Full;
 	};
 } // namespace polyfem::assembler
@@ -42,6 +42,7 @@ namespace polyfem::assembler
 									 const Eigen::MatrixXd &local_pts,
 									 const Eigen::MatrixXd &displacement,
 									 Eigen::MatrixXd &tensor) const override;
+		bool stiffness_is_energy_hessian() const override { return true; }
 
 		void compute_stress_grad_multiply_mat(const OptAssemblerData &data,
 											  const Eigen::MatrixXd &mat,
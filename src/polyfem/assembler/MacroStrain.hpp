@@ -46,6 +46,20 @@ namespace polyfem
 				}
 			}
 
+			/// replaces the prescribed macro strain by a constant one, only its fixed entries are imposed
+			void set_values(const Eigen::MatrixXd &strain)
+			{
+				assert(strain.rows() == _dim && strain.cols() == _dim);
+				for (int i = 0; i < _dim; i++)
+				{
+					for (int j = 0; j < _dim; j++)
+					{
+						value[i * 3 + j].init(strain(i, j));
+						value[i * 3 + j].set_unit_type("");
+					}
+				}
+			}
+
 			Eigen::MatrixXd eval(const double t) const
 			{
 				Eigen::MatrixXd strain(_dim, _dim);
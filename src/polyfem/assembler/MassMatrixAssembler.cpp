@@ -7,7 +7,7 @@
 #include <polyfem/utils/ClipperUtils.hpp>
 #include <polyfem/utils/Logger.hpp>
 
-#include <SimpleBVH/BVH.hpp>
+#include <polyfem/mesh/ElementLocator.hpp>
 
 namespace polyfem
 {
@@ -98,8 +98,6 @@ namespace polyfem
 			mass.resize(n_to_basis * size, n_from_basis * size);
 			mass.setZero();
 
-			// auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mass.rows()));
-
 			Quadrature quadrature;
 			if (is_volume)
 				TetQuadrature().get_quadrature(2, quadrature);
@@ -107,95 +105,93 @@ namespace polyfem
 				TriQuadrature().get_quadrature(2, quadrature);
 
 			// Use a AABB tree to find all intersecting elements then loop over only those pairs
-			std::vector<std::array<Eigen::Vector3d, 2>> boxes(from_bases.size());
+			const int n_from_nodes = from_bases.empty() ? 0 : from_bases.front().nodes().rows();
+			Eigen::MatrixXd from_V(from_bases.size() * n_from_nodes, size);
+			Eigen::MatrixXi from_F(from_bases.size(), n_from_nodes);
 			for (int i = 0; i < from_bases.size(); i++)
 			{
 				const Eigen::MatrixXd from_nodes = from_bases[i].nodes();
-				boxes[i][0].setZero();
-				boxes[i][0].head(size) = from_nodes.colwise().minCoeff();
-				boxes[i][1].setZero();
-				boxes[i][1].head(size) = from_nodes.colwise().maxCoeff();
+				assert(from_nodes.rows() == n_from_nodes);
+				from_V.middleRows(i * n_from_nodes, n_from_nodes) = from_nodes;
+				for (int j = 0; j < n_from_nodes; j++)
+					from_F(i, j) = i * n_from_nodes + j;
 			}
+			const mesh::ElementLocator locator(from_V, from_F);
 
-			SimpleBVH::BVH bvh;
-			bvh.init(boxes);
-
-			// maybe_parallel_for(n_to_basis, [&](int start, int end, int thread_id) {
-			// LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
-
-			std::vector<Eigen::Triplet<double>> triplets;
-
-			for (const ElementBases &to_element : to_bases)
-			{
-				const Eigen::MatrixXd to_nodes = to_element.nodes();
+			auto storage = create_thread_storage(std::vector<Eigen::Triplet<double>>());
 
+			maybe_parallel_for(to_bases.size(), [&](int start, int end, int thread_id) {
+				std::vector<Eigen::Triplet<double>> &triplets = get_local_thread_storage(storage, thread_id);
 				std::vector<unsigned int> candidates;
-				{
-					Eigen::Vector3d bbox_min = Eigen::Vector3d::Zero();
-					bbox_min.head(size) = to_nodes.colwise().minCoeff();
-					Eigen::Vector3d bbox_max = Eigen::Vector3d::Zero();
-					bbox_max.head(size) = to_nodes.colwise().maxCoeff();
-					bvh.intersect_box(bbox_min, bbox_max, candidates);
-				}
+				std::vector<AssemblyValues> from_phi, to_phi;
 
-				// for (const ElementBases &from_element : from_bases)
-				for (const unsigned int from_element_i : candidates)
+				for (int to_element_i = start; to_element_i < end; ++to_element_i)
 				{
-					const ElementBases &from_element = from_bases[from_element_i];
-					const Eigen::MatrixXd from_nodes = from_element.nodes();
+					const ElementBases &to_element = to_bases[to_element_i];
+					const Eigen::MatrixXd to_nodes = to_element.nodes();
 
-					// Compute the overlap between the two elements as a list of simplices.
-					const std::vector<Eigen::MatrixXd> overlap =
-						is_volume
-							? TetrahedronClipping::clip(to_nodes, from_nodes)
-							: TriangleClipping::clip(to_nodes, from_nodes);
+					locator.intersect_box(
+						to_nodes.colwise().minCoeff().transpose(),
+						to_nodes.colwise().maxCoeff().transpose(),
+						candidates);
 
-					for (const Eigen::MatrixXd &simplex : overlap)
+					for (const unsigned int from_element_i : candidates)
 					{
-						const double volume = abs(is_volume ? tetrahedron_volume(simplex) : triangle_area(simplex));
-						if (abs(volume) == 0.0)
-							continue;
-						assert(volume > 0);
+						const ElementBases &from_element = from_bases[from_element_i];
+						const Eigen::MatrixXd from_nodes = from_element.nodes();
 
-						for (int qi = 0; qi < quadrature.size(); qi++)
+						// Compute the overlap between the two elements as a list of simplices.
+						const std::vector<Eigen::MatrixXd> overlap =
+							is_volume
+								? TetrahedronClipping::clip(to_nodes, from_nodes)
+								: TriangleClipping::clip(to_nodes, from_nodes);
+
+						for (const Eigen::MatrixXd &simplex : overlap)
 						{
-							// NOTE: the 2/6 is neccesary here because the mass matrix assembly use the
-							//       determinant of the Jacobian (i.e., area of the parallelogram/volume of the hexahedron)
-							const double w = (is_volume ? 6 : 2) * volume * quadrature.weights[qi];
-							const VectorNd q = quadrature.points.row(qi);
+							const double volume = abs(is_volume ? tetrahedron_volume(simplex) : triangle_area(simplex));
+							if (abs(volume) == 0.0)
+								continue;
+							assert(volume > 0);
+
+							for (int qi = 0; qi < quadrature.size(); qi++)
+							{
+								// NOTE: the 2/6 is neccesary here because the mass matrix assembly use the
+								//       determinant of the Jacobian (i.e., area of the parallelogram/volume of the hexahedron)
+								const double w = (is_volume ? 6 : 2) * volume * quadrature.weights[qi];
+								const VectorNd q = quadrature.points.row(qi);
 
-							const VectorNd p = is_volume ? P1_3D_gmapping(simplex, q) : P1_2D_gmapping(simplex, q);
+								const VectorNd p = is_volume ? P1_3D_gmapping(simplex, q) : P1_2D_gmapping(simplex, q);
 
-							// NOTE: Row vector because evaluate_bases expects a rows of a matrix.
-							const RowVectorNd from_bc = barycentric_coordinates(p, from_nodes).tail(size).transpose();
-							const RowVectorNd to_bc = barycentric_coordinates(p, to_nodes).tail(size).transpose();
+								// NOTE: Row vector because evaluate_bases expects a rows of a matrix.
+								const RowVectorNd from_bc = barycentric_coordinates(p, from_nodes).tail(size).transpose();
+								const RowVectorNd to_bc = barycentric_coordinates(p, to_nodes).tail(size).transpose();
 
-							std::vector<AssemblyValues> from_phi, to_phi;
-							from_element.evaluate_bases(from_bc, from_phi);
-							to_element.evaluate_bases(to_bc, to_phi);
+								from_element.evaluate_bases(from_bc, from_phi);
+								to_element.evaluate_bases(to_bc, to_phi);
 
 #ifndef NDEBUG
-							Eigen::MatrixXd debug;
-							from_element.eval_geom_mapping(from_bc, debug);
-							assert((debug.transpose() - p).norm() < 1e-12);
-							to_element.eval_geom_mapping(to_bc, debug);
-							assert((debug.transpose() - p).norm() < 1e-12);
+								Eigen::MatrixXd debug;
+								from_element.eval_geom_mapping(from_bc, debug);
+								assert((debug.transpose() - p).norm() < 1e-12);
+								to_element.eval_geom_mapping(to_bc, debug);
+								assert((debug.transpose() - p).norm() < 1e-12);
 #endif
 
-							for (int n = 0; n < size; ++n)
-							{
-								// local matrix is diagonal
-								const int m = n;
+								for (int n = 0; n < size; ++n)
 								{
-									for (int to_local_i = 0; to_local_i < to_phi.size(); ++to_local_i)
+									// local matrix is diagonal
+									const int m = n;
 									{
-										const int to_global_i = to_element.bases[to_local_i].global()[0].index * size + m;
-										for (int from_local_i = 0; from_local_i < from_phi.size(); ++from_local_i)
+										for (int to_local_i = 0; to_local_i < to_phi.size(); ++to_local_i)
 										{
-											const auto from_global_i = from_element.bases[from_local_i].global()[0].index * size + n;
-											triplets.emplace_back(
-												to_global_i, from_global_i,
-												w * from_phi[from_local_i].val(0) * to_phi[to_local_i].val(0));
+											const int to_global_i = to_element.bases[to_local_i].global()[0].index * size + m;
+											for (int from_local_i = 0; from_local_i < from_phi.size(); ++from_local_i)
+											{
+												const auto from_global_i = from_element.bases[from_local_i].global()[0].index * size + n;
+												triplets.emplace_back(
+													to_global_i, from_global_i,
+													w * from_phi[from_local_i].val(0) * to_phi[to_local_i].val(0));
+											}
 										}
 									}
 								}
@@ -203,7 +199,11 @@ namespace polyfem
 						}
 					}
 				}
-			}
+			});
+
+			std::vector<Eigen::Triplet<double>> triplets;
+			for (const auto &local_triplets : storage)
+				triplets.insert(triplets.end(), local_triplets.begin(), local_triplets.end());
 
 			mass.setFromTriplets(triplets.begin(), triplets.end());
 			mass.makeCompressed();
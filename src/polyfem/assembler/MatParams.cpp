@@ -2,6 +2,8 @@
 
 #include <polyfem/utils/JSONUtils.hpp>
 
+#include <cmath>
+
 namespace polyfem::assembler
 {
 	namespace
@@ -327,11 +329,21 @@ namespace polyfem::assembler
 		assert(mu_or_nu_.size() == 1 || el_id < mu_or_nu_.size());
 		assert(size_ == 2 || size_ == 3);
 
-		const auto &tmp1 = lambda_or_E_.size() == 1 ? lambda_or_E_[0] : lambda_or_E_[el_id];
-		const auto &tmp2 = mu_or_nu_.size() == 1 ? mu_or_nu_[0] : mu_or_nu_[el_id];
+		const int index = lambda_or_E_.size() == 1 ? 0 : el_id;
+		double llambda, mmu;
+		if (index < constant_values_.size() && !std::isnan(constant_values_[index][0]))
+		{
+			llambda = constant_values_[index][0];
+			mmu = constant_values_[index][1];
+		}
+		else
+		{
+			const auto &tmp1 = lambda_or_E_.size() == 1 ? lambda_or_E_[0] : lambda_or_E_[el_id];
+			const auto &tmp2 = mu_or_nu_.size() == 1 ? mu_or_nu_[0] : mu_or_nu_[el_id];
 
-		double llambda = tmp1(x, y, z, t, el_id);
-		double mmu = tmp2(x, y, z, t, el_id);
+			llambda = tmp1(x, y, z, t, el_id);
+			mmu = tmp2(x, y, z, t, el_id);
+		}
 
 		if (!is_lambda_mu_)
 		{
@@ -384,9 +396,21 @@ namespace polyfem::assembler
 			lambda_or_E_[index].set_unit_type(stress_unit);
 			mu_or_nu_[index].set_unit_type(stress_unit);
 			is_lambda_mu_ = true;
+			cache_constant(index);
 		}
 	}
 
+	void LameParameters::cache_constant(const int index)
+	{
+		constant_values_.resize(lambda_or_E_.size(), {{std::nan(""), std::nan("")}});
+
+		// raw values, the conversion to lambda and mu depends on is_lambda_mu_ which is final only once all the elements are added
+		if (lambda_or_E_[index].is_constant() && mu_or_nu_[index].is_constant())
+			constant_values_[index] = {{lambda_or_E_[index](0, 0, 0, 0, index), mu_or_nu_[index](0, 0, 0, 0, index)}};
+		else
+			constant_values_[index] = {{std::nan(""), std::nan("")}};
+	}
+
 	void LameParameters::set_e_nu(const int index, const json &E, const json &nu, const std::string &stress_unit)
 	{
 		// TODO: conversion is always called
@@ -397,6 +421,7 @@ namespace polyfem::assembler
 		lambda_or_E_[index].set_unit_type(stress_unit);
 		// nu has no unit
 		mu_or_nu_[index].set_unit_type("");
+		cache_constant(index);
 	}
 
 	Density::Density()
@@ -409,7 +434,11 @@ namespace polyfem::assembler
 	{
 		assert(rho_.size() == 1 || el_id < rho_.size());
 
-		const auto &tmp = rho_.size() == 1 ? rho_[0] : rho_[el_id];
+		const int index = rho_.size() == 1 ? 0 : el_id;
+		if (index < constant_rho_.size() && !std::isnan(constant_rho_[index]))
+			return constant_rho_[index];
+
+		const auto &tmp = rho_[index];
 		const double res = tmp(x, y, z, t, el_id);
 		assert(!std::isnan(res));
 		assert(!std::isinf(res));
@@ -433,6 +462,9 @@ namespace polyfem::assembler
 		}
 
 		rho_[index].set_unit_type(density_unit);
+
+		constant_rho_.resize(rho_.size(), std::nan(""));
+		constant_rho_[index] = rho_[index].is_constant() ? rho_[index](0, 0, 0, 0, index) : std::nan("");
 	}
 
 	// template instantiation
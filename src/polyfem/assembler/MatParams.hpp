@@ -4,6 +4,8 @@
 #include <polyfem/utils/Types.hpp>
 #include <polyfem/utils/ExpressionValue.hpp>
 
+#include <array>
+
 namespace polyfem::assembler
 {
 	class GenericMatParam
@@ -87,10 +89,15 @@ namespace polyfem::assembler
 
 	private:
 		void set_e_nu(const int index, const json &E, const json &nu, const std::string &stress_unit);
+		/// evaluates the parameters of index once if they are constant
+		void cache_constant(const int index);
 
 		int size_;
 		std::vector<utils::ExpressionValue> lambda_or_E_, mu_or_nu_;
 		bool is_lambda_mu_;
+
+		/// lambda_or_E_ and mu_or_nu_ of every index, in the stress unit, NaN if they depend on the position or the time
+		std::vector<std::array<double, 2>> constant_values_;
 	};
 
 	class Density
@@ -115,6 +122,8 @@ namespace polyfem::assembler
 		void set_rho(const json &rho);
 
 		std::vector<utils::ExpressionValue> rho_;
+		/// rho_ of every index, in the density unit, NaN if it depends on the position or the time
+		std::vector<double> constant_rho_;
 	};
 
 	class NoDensity : public Density
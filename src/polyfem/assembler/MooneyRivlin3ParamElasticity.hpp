@@ -11,6 +11,9 @@ namespace polyfem::assembler
 	public:
 		MooneyRivlin3ParamElasticity();
 
+		// the energy only depends on the deformation gradient
+		static constexpr bool use_def_grad_kernels = true;
+
 		// sets material params
 		void add_multimaterial(const int index, const json &params, const Units &units) override;
 
@@ -1,6 +1,7 @@
 #include "MooneyRivlin3ParamSymbolic.hpp"
 
 #include <polyfem/autogen/auto_mooney_rivlin_gradient_hessian.hpp>
+#include <ipc/utils/eigen_ext.hpp>
 
 namespace polyfem::assembler
 {
@@ -509,6 +510,8 @@ namespace polyfem::assembler
 
 			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp;
 			autogen::generate_hessian_templated<dim>(c1, c2, c3, d1, def_grad, hessian_temp);
+			if (data.project_to_psd)
+				hessian_temp = ipc::project_to_psd(hessian_temp);
 
 			// Check by FD
 			/*
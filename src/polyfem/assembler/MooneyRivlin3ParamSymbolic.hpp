@@ -31,6 +31,7 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		bool projects_hessian_pointwise() const override { return true; }
 
 		// sets material params
 		void add_multimaterial(const int index, const json &params, const Units &units) override;
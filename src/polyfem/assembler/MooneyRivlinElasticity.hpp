@@ -2,6 +2,7 @@
 
 #include <polyfem/assembler/GenericElastic.hpp>
 #include <polyfem/assembler/MatParams.hpp>
+#include <polyfem/autogen/auto_mooney_rivlin_gradient_hessian.hpp>
 
 // non linear MooneyRivlin material model
 namespace polyfem::assembler
@@ -21,6 +22,10 @@ namespace polyfem::assembler
 		std::string name() const override { return "MooneyRivlin"; }
 		std::map<std::string, ParamFunc> parameters() const override;
 
+		// the derivatives wrt the deformation gradient are the generated ones of the three parameters model
+		static constexpr bool use_def_grad_kernels = true;
+		static constexpr bool use_closed_form_def_grad = true;
+
 		template <typename T>
 		T elastic_energy(
 			const RowVectorNd &p,
@@ -45,6 +50,39 @@ namespace polyfem::assembler
 			return val;
 		}
 
+		/// closed-form derivatives of elastic_energy, the one of MooneyRivlin3ParamSymbolic with c3 = 0 and d1 = k / 2
+		template <int dim>
+		void elastic_energy_derivatives(
+			const RowVectorNd &p,
+			const double t,
+			const int el_id,
+			const Eigen::Matrix<double, dim, dim> &def_grad,
+			Eigen::Matrix<double, dim * dim, 1> &gradient,
+			Eigen::Matrix<double, dim * dim, dim * dim> *hessian) const
+		{
+			const double c1 = c1_(p, t, el_id);
+			const double c2 = c2_(p, t, el_id);
+			const double k = k_(p, t, el_id);
+
+			// the generated gradient takes the transpose of F, as in MooneyRivlin3ParamSymbolic
+			const Eigen::Matrix<double, dim, dim> def_grad_T = def_grad.transpose();
+			Eigen::Matrix<double, dim, dim> stress;
+			autogen::generate_gradient_templated<dim>(c1, c2, 0, k / 2, def_grad_T, stress);
+			for (int d = 0; d < dim; ++d)
+				for (int c = 0; c < dim; ++c)
+					gradient(d * dim + c) = stress(d, c);
+
+			if (hessian == nullptr)
+				return;
+
+			// the generated hessian orders the entries of F column by column
+			Eigen::Matrix<double, dim * dim, dim * dim> hessian_cm;
+			autogen::generate_hessian_templated<dim>(c1, c2, 0, k / 2, def_grad, hessian_cm);
+			for (int a = 0; a < dim * dim; ++a)
+				for (int b = 0; b < dim * dim; ++b)
+					(*hessian)(a, b) = hessian_cm((a % dim) * dim + a / dim, (b % dim) * dim + b / dim);
+		}
+
 	private:
 		GenericMatParam c1_;
 		GenericMatParam c2_;
@@ -1,5 +1,11 @@
 #include "MultiModel.hpp"
 
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+
 // #include <polyfem/basis/Basis.hpp>
 // #include <polyfem/autogen/auto_elasticity_rhs.hpp>
 
@@ -47,96 +53,83 @@ namespace polyfem::assembler
 		return res;
 	}
 
-	Eigen::VectorXd
-	MultiModel::assemble_gradient(const NonLinearAssemblerData &data) const
+	void MultiModel::init_multimodels(const std::vector<std::string> &mats)
 	{
-		const int el_id = data.vals.element_id;
-		const std::string model = multi_material_models_[el_id];
-
-		if (model == "SaintVenant")
-			return saint_venant_.assemble_gradient(data);
-		else if (model == "NeoHookean")
-			return neo_hookean_.assemble_gradient(data);
-		else if (model == "LinearElasticity")
-			return linear_elasticity_.assemble_gradient(data);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.assemble_gradient(data);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.assemble_gradient(data);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.assemble_gradient(data);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.assemble_gradient(data);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.assemble_gradient(data);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.assemble_gradient(data);
-		else
+		static const std::map<std::string, Model> models = {
+			{"SaintVenant", Model::SaintVenant},
+			{"NeoHookean", Model::NeoHookean},
+			{"LinearElasticity", Model::LinearElasticity},
+			{"HookeLinearElasticity", Model::HookeLinearElasticity},
+			{"MooneyRivlin", Model::MooneyRivlin},
+			{"MooneyRivlin3Param", Model::MooneyRivlin3Param},
+			{"UnconstrainedOgden", Model::UnconstrainedOgden},
+			{"IncompressibleOgden", Model::IncompressibleOgden},
+			{"FixedCorotational", Model::FixedCorotational}};
+
+		multi_material_models_ = mats;
+
+		element_models_.resize(mats.size());
+		for (size_t e = 0; e < mats.size(); ++e)
 		{
-			assert(false);
-			return Eigen::VectorXd(0, 0);
+			const auto it = models.find(mats[e]);
+			if (it == models.end())
+				log_and_throw_error("Unknown material model {} in MultiModels", mats[e]);
+			element_models_[e] = it->second;
 		}
+
+		// consecutive elements use the same kernel, the mesh order is kept within a model
+		element_order_.resize(mats.size());
+		std::iota(element_order_.begin(), element_order_.end(), 0);
+		std::stable_sort(element_order_.begin(), element_order_.end(), [&](const int a, const int b) {
+			return element_models_[a] < element_models_[b];
+		});
 	}
 
-	Eigen::MatrixXd
-	MultiModel::assemble_hessian(const NonLinearAssemblerData &data) const
+	template <typename Fun>
+	decltype(auto) MultiModel::dispatch(const int el_id, Fun &&f) const
 	{
-		const int el_id = data.vals.element_id;
-		const std::string model = multi_material_models_[el_id];
-
-		if (model == "SaintVenant")
-			return saint_venant_.assemble_hessian(data);
-		else if (model == "NeoHookean")
-			return neo_hookean_.assemble_hessian(data);
-		else if (model == "LinearElasticity")
-			return linear_elasticity_.assemble_hessian(data);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.assemble_hessian(data);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.assemble_hessian(data);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.assemble_hessian(data);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.assemble_hessian(data);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.assemble_hessian(data);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.assemble_hessian(data);
-		else
+		assert(el_id < element_models_.size());
+
+		switch (element_models_[el_id])
 		{
-			assert(false);
-			return Eigen::MatrixXd(0, 0);
+		case Model::SaintVenant:
+			return f(saint_venant_);
+		case Model::NeoHookean:
+			return f(neo_hookean_);
+		case Model::LinearElasticity:
+			return f(linear_elasticity_);
+		case Model::HookeLinearElasticity:
+			return f(hooke_);
+		case Model::MooneyRivlin:
+			return f(mooney_rivlin_elasticity_);
+		case Model::MooneyRivlin3Param:
+			return f(mooney_rivlin_3_param_elasticity_);
+		case Model::UnconstrainedOgden:
+			return f(unconstrained_ogden_elasticity_);
+		case Model::IncompressibleOgden:
+			return f(incompressible_ogden_elasticity_);
+		case Model::FixedCorotational:
+			return f(fixed_corotational_);
 		}
+
+		log_and_throw_error("Invalid material model of element {}", el_id);
+	}
+
+	Eigen::VectorXd
+	MultiModel::assemble_gradient(const NonLinearAssemblerData &data) const
+	{
+		return dispatch(data.vals.element_id, [&](const auto &model) -> Eigen::VectorXd { return model.assemble_gradient(data); });
+	}
+
+	Eigen::MatrixXd
+	MultiModel::assemble_hessian(const NonLinearAssemblerData &data) const
+	{
+		return dispatch(data.vals.element_id, [&](const auto &model) -> Eigen::MatrixXd { return model.assemble_hessian(data); });
 	}
 
 	double MultiModel::compute_energy(const NonLinearAssemblerData &data) const
 	{
-		const int el_id = data.vals.element_id;
-		const std::string model = multi_material_models_[el_id];
-
-		if (model == "SaintVenant")
-			return saint_venant_.compute_energy(data);
-		else if (model == "NeoHookean")
-			return neo_hookean_.compute_energy(data);
-		else if (model == "LinearElasticity")
-			return linear_elasticity_.compute_energy(data);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.compute_energy(data);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.compute_energy(data);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.compute_energy(data);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.compute_energy(data);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.compute_energy(data);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.compute_energy(data);
-		else
-		{
-			assert(false);
-			return 0;
-		}
+		return dispatch(data.vals.element_id, [&](const auto &model) -> double { return model.compute_energy(data); });
 	}
 
 	void MultiModel::assign_stress_tensor(
@@ -146,30 +139,7 @@ namespace polyfem::assembler
 		Eigen::MatrixXd &all,
 		const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const
 	{
-		const std::string model = multi_material_models_[data.el_id];
-
-		if (model == "SaintVenant")
-			saint_venant_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "NeoHookean")
-			neo_hookean_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "LinearElasticity")
-			linear_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.assign_stress_tensor(data, all_size, type, all, fun);
-		else
-		{
-			assert(false);
-		}
+		dispatch(data.el_id, [&](const auto &model) { model.assign_stress_tensor(data, all_size, type, all, fun); });
 	}
 
 	std::map<std::string, Assembler::ParamFunc> MultiModel::parameters() const
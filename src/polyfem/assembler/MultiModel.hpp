@@ -35,8 +35,8 @@ namespace polyfem::assembler
 		// inialize material parameter
 		void add_multimaterial(const int index, const json &params, const Units &units) override;
 
-		// initialized multi models
-		inline void init_multimodels(const std::vector<std::string> &mats) { multi_material_models_ = mats; }
+		// initialized multi models, the element loops visit the elements grouped by model
+		void init_multimodels(const std::vector<std::string> &mats);
 
 		std::string name() const override { return "MultiModels"; }
 		std::map<std::string, ParamFunc> parameters() const override;
@@ -49,7 +49,26 @@ namespace polyfem::assembler
 								  const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const override;
 
 	private:
+		enum class Model : uint8_t
+		{
+			SaintVenant,
+			NeoHookean,
+			LinearElasticity,
+			HookeLinearElasticity,
+			MooneyRivlin,
+			MooneyRivlin3Param,
+			UnconstrainedOgden,
+			IncompressibleOgden,
+			FixedCorotational
+		};
+
+		// calls f with the sub-assembler of the element
+		template <typename Fun>
+		decltype(auto) dispatch(const int el_id, Fun &&f) const;
+
 		std::vector<std::string> multi_material_models_;
+		// model of every element, resolved once from multi_material_models_
+		std::vector<Model> element_models_;
 
 		SaintVenantElasticity saint_venant_;
 		NeoHookeanElasticity neo_hookean_;
@@ -34,183 +34,206 @@ namespace polyfem::assembler
 		return res;
 	}
 
-	Eigen::VectorXd
-	NavierStokesVelocity::assemble_gradient(const NonLinearAssemblerData &data) const
-	{
-		assert(false);
-		return Eigen::VectorXd(data.vals.basis_values.size() * size());
-	}
-
-	Eigen::MatrixXd
-	NavierStokesVelocity::assemble_hessian(const NonLinearAssemblerData &data) const
-	{
-		Eigen::MatrixXd H;
-		if (full_gradient_)
-			H = compute_N(data) + compute_W(data);
-		else
-			H = compute_N(data);
-
-		return H.transpose();
-	}
-
-	// Compute N = int v \cdot \nabla phi_i \cdot \phi_j
-
-	Eigen::MatrixXd NavierStokesVelocity::compute_N(const NonLinearAssemblerData &data) const
+	namespace
 	{
-		typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> GradMat;
-
-		assert(data.x.cols() == 1);
+		/// velocity and its gradient at the quadrature points, vel is n_pts x DIM and grad(p, d * DIM + c) = d vel_d / d x_c
+		template <int DIM>
+		void interpolate_velocity(const NonLinearAssemblerData &data, Eigen::MatrixXd &vel, Eigen::MatrixXd &grad)
+		{
+			assert(data.x.cols() == 1);
 
-		const int n_pts = data.da.size();
-		const int n_bases = data.vals.basis_values.size();
+			const int n_pts = data.da.size();
+			const int n_bases = data.vals.basis_values.size();
 
-		Eigen::Matrix<double, Eigen::Dynamic, 1> local_vel(n_bases * size(), 1);
-		local_vel.setZero();
-		for (size_t i = 0; i < n_bases; ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
+			Eigen::Matrix<double, Eigen::Dynamic, DIM> local_vel(n_bases, DIM);
+			local_vel.setZero();
+			for (int i = 0; i < n_bases; ++i)
 			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_vel(i * size() + d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-				}
+				const auto &bs = data.vals.basis_values[i];
+				for (size_t ii = 0; ii < bs.global.size(); ++ii)
+					local_vel.row(i) += bs.global[ii].val * data.x.block<DIM, 1>(bs.global[ii].index * DIM, 0).transpose();
 			}
-		}
-
-		Eigen::MatrixXd N(size() * n_bases, size() * n_bases);
-		N.setZero();
 
-		GradMat grad_i(size(), size());
-		GradMat jac_it(size(), size());
+			vel.setZero(n_pts, DIM);
+			grad.setZero(n_pts, DIM * DIM);
+			for (int i = 0; i < n_bases; ++i)
+			{
+				const auto &bs = data.vals.basis_values[i];
+				assert(bs.grad_t_m.rows() == n_pts && bs.grad_t_m.cols() == DIM);
 
-		Eigen::VectorXd vel(size(), 1);
-		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> phi_j(size(), 1);
+				vel += bs.val.col(0) * local_vel.row(i);
+				for (int d = 0; d < DIM; ++d)
+					grad.middleCols<DIM>(d * DIM) += local_vel(i, d) * bs.grad_t_m;
+			}
+		}
 
-		for (long p = 0; p < n_pts; ++p)
+		/// local Picard (convection) matrix, and the Newton one if full_gradient, in one pass
+		/// H(j * DIM + n, i * DIM + m) = int phi_j (delta_nm v . grad phi_i + phi_i d v_n / d x_m)
+		template <int DIM>
+		void convection_hessian(const NonLinearAssemblerData &data, const Eigen::MatrixXd &vel, const Eigen::MatrixXd &grad, const bool full_gradient, Eigen::MatrixXd &H)
 		{
-			vel.setZero();
+			const int n_pts = data.da.size();
+			const int n_bases = data.vals.basis_values.size();
 
-			for (size_t i = 0; i < n_bases; ++i)
+			// basis values (weighted by da) and their derivative along the velocity
+			Eigen::MatrixXd phi(n_pts, n_bases), weighted_phi(n_pts, n_bases), advection(n_pts, n_bases);
+			for (int i = 0; i < n_bases; ++i)
 			{
 				const auto &bs = data.vals.basis_values[i];
-				const double val = bs.val(p);
-
-				for (int d = 0; d < size(); ++d)
-				{
-					vel(d) += val * local_vel(i * size() + d);
-				}
+				phi.col(i) = bs.val.col(0);
+				weighted_phi.col(i) = bs.val.col(0).cwiseProduct(data.da);
+				advection.col(i) = bs.grad_t_m.cwiseProduct(vel).rowwise().sum();
 			}
 
-			for (long k = 0; k < jac_it.size(); ++k)
-				jac_it(k) = data.vals.jac_it[p](k);
+			H.setZero(n_bases * DIM, n_bases * DIM);
 
-			for (int i = 0; i < n_bases; ++i)
+			const Eigen::MatrixXd N = weighted_phi.transpose() * advection;
+			for (int j = 0; j < n_bases; ++j)
+				for (int i = 0; i < n_bases; ++i)
+					for (int n = 0; n < DIM; ++n)
+						H(j * DIM + n, i * DIM + n) = N(j, i);
+
+			if (!full_gradient)
+				return;
+
+			Eigen::MatrixXd W;
+			for (int n = 0; n < DIM; ++n)
 			{
-				const auto &bi = data.vals.basis_values[i];
-				for (int m = 0; m < size(); ++m)
+				for (int m = 0; m < DIM; ++m)
 				{
-					grad_i.setZero();
-					grad_i.row(m) = bi.grad.row(p);
-					grad_i = grad_i * jac_it;
-
+					W.noalias() = weighted_phi.transpose() * (grad.col(n * DIM + m).asDiagonal() * phi);
 					for (int j = 0; j < n_bases; ++j)
-					{
-						const auto &bj = data.vals.basis_values[j];
-						for (int n = 0; n < size(); ++n)
-						{
-							phi_j.setZero();
-							phi_j(n) = bj.val(p);
-							N(i * size() + m, j * size() + n) += (grad_i * vel).dot(phi_j) * data.da(p);
-						}
-					}
+						for (int i = 0; i < n_bases; ++i)
+							H(j * DIM + n, i * DIM + m) += W(j, i);
 				}
 			}
 		}
 
-		return N;
-	}
+		/// int phi_j (v . grad) v_n
+		template <int DIM>
+		void convection_gradient(const NonLinearAssemblerData &data, const Eigen::MatrixXd &vel, const Eigen::MatrixXd &grad, Eigen::VectorXd &res)
+		{
+			const int n_pts = data.da.size();
+			const int n_bases = data.vals.basis_values.size();
 
-	// Compute N = int phi_j \cdot \nabla v \cdot \phi_j
+			Eigen::Matrix<double, Eigen::Dynamic, DIM> conv(n_pts, DIM);
+			for (int n = 0; n < DIM; ++n)
+				conv.col(n) = grad.middleCols<DIM>(n * DIM).cwiseProduct(vel).rowwise().sum().cwiseProduct(data.da);
 
-	Eigen::MatrixXd NavierStokesVelocity::compute_W(const NonLinearAssemblerData &data) const
+			res.resize(n_bases * DIM);
+			for (int j = 0; j < n_bases; ++j)
+				res.segment<DIM>(j * DIM) = conv.transpose() * data.vals.basis_values[j].val.col(0);
+		}
+	} // namespace
+
+	const NavierStokesVelocity::QuadratureVelocity &NavierStokesVelocity::quadrature_velocity(const NonLinearAssemblerData &data, QuadratureVelocity &tmp) const
 	{
-		typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> GradMat;
+		const int n_pts = data.da.size();
+		QuadratureVelocity &qv = velocity_cache_enabled_ ? velocity_cache_[data.vals.element_id] : tmp;
+		if (qv.valid && qv.vel.rows() == n_pts)
+			return qv;
 
-		assert(data.x.cols() == 1);
+		if (size() == 2)
+			interpolate_velocity<2>(data, qv.vel, qv.grad);
+		else
+			interpolate_velocity<3>(data, qv.vel, qv.grad);
+		qv.valid = velocity_cache_enabled_;
 
-		const int n_pts = data.da.size();
-		const int n_bases = data.vals.basis_values.size();
+		return qv;
+	}
 
-		Eigen::Matrix<double, Eigen::Dynamic, 1> local_vel(n_bases * size(), 1);
-		local_vel.setZero();
-		for (size_t i = 0; i < n_bases; ++i)
+	void NavierStokesVelocity::enable_velocity_cache(const int n_elements, const Eigen::MatrixXd &x) const
+	{
+		if (int(velocity_cache_.size()) != n_elements || velocity_cache_x_.size() != x.size() || velocity_cache_x_ != x)
 		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_vel(i * size() + d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-				}
-			}
+			velocity_cache_.resize(n_elements);
+			for (QuadratureVelocity &qv : velocity_cache_)
+				qv.valid = false;
+			velocity_cache_x_ = x;
 		}
+		velocity_cache_enabled_ = true;
+	}
 
-		Eigen::MatrixXd W(size() * n_bases, size() * n_bases);
-		W.setZero();
-
-		GradMat grad_v(size(), size());
-		GradMat jac_it(size(), size());
-
-		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> phi_i(size(), 1);
-		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> phi_j(size(), 1);
+	void NavierStokesVelocity::assemble_gradient(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		Eigen::MatrixXd &rhs) const
+	{
+		enable_velocity_cache(int(bases.size()), displacement);
+		try
+		{
+			NLAssembler::assemble_gradient(is_volume, n_basis, bases, gbases, cache, t, dt, displacement, displacement_prev, rhs);
+		}
+		catch (...)
+		{
+			velocity_cache_enabled_ = false;
+			throw;
+		}
+		velocity_cache_enabled_ = false;
+	}
 
-		for (long p = 0; p < n_pts; ++p)
+	void NavierStokesVelocity::assemble_hessian(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		utils::MatrixCache &mat_cache,
+		StiffnessMatrix &grad) const
+	{
+		enable_velocity_cache(int(bases.size()), displacement);
+		try
 		{
-			grad_v.setZero();
+			NLAssembler::assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, t, dt, displacement, displacement_prev, mat_cache, grad);
+		}
+		catch (...)
+		{
+			velocity_cache_enabled_ = false;
+			throw;
+		}
+		velocity_cache_enabled_ = false;
+	}
 
-			for (size_t i = 0; i < n_bases; ++i)
-			{
-				const auto &bs = data.vals.basis_values[i];
-				const Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> grad = bs.grad.row(p);
-				assert(grad.size() == size());
+	Eigen::VectorXd
+	NavierStokesVelocity::assemble_gradient(const NonLinearAssemblerData &data) const
+	{
+		QuadratureVelocity tmp;
+		const QuadratureVelocity &qv = quadrature_velocity(data, tmp);
 
-				for (int d = 0; d < size(); ++d)
-				{
-					for (int c = 0; c < size(); ++c)
-					{
-						grad_v(d, c) += grad(c) * local_vel(i * size() + d);
-					}
-				}
-			}
+		Eigen::VectorXd res;
+		if (size() == 2)
+			convection_gradient<2>(data, qv.vel, qv.grad, res);
+		else
+			convection_gradient<3>(data, qv.vel, qv.grad, res);
 
-			for (long k = 0; k < jac_it.size(); ++k)
-				jac_it(k) = data.vals.jac_it[p](k);
-			grad_v = (grad_v * jac_it).eval();
+		return res;
+	}
 
-			for (int i = 0; i < n_bases; ++i)
-			{
-				const auto &bi = data.vals.basis_values[i];
-				for (int m = 0; m < size(); ++m)
-				{
-					phi_i.setZero();
-					phi_i(m) = bi.val(p);
+	Eigen::MatrixXd
+	NavierStokesVelocity::assemble_hessian(const NonLinearAssemblerData &data) const
+	{
+		QuadratureVelocity tmp;
+		const QuadratureVelocity &qv = quadrature_velocity(data, tmp);
 
-					for (int j = 0; j < n_bases; ++j)
-					{
-						const auto &bj = data.vals.basis_values[j];
-						for (int n = 0; n < size(); ++n)
-						{
-							phi_j.setZero();
-							phi_j(n) = bj.val(p);
-							W(i * size() + m, j * size() + n) += (grad_v * phi_i).dot(phi_j) * data.da(p);
-						}
-					}
-				}
-			}
-		}
+		Eigen::MatrixXd H;
+		if (size() == 2)
+			convection_hessian<2>(data, qv.vel, qv.grad, full_gradient_, H);
+		else
+			convection_hessian<3>(data, qv.vel, qv.grad, full_gradient_, H);
 
-		return W;
+		return H;
 	}
 
 	std::map<std::string, Assembler::ParamFunc> NavierStokesVelocity::parameters() const
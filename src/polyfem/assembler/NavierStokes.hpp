@@ -5,6 +5,8 @@
 
 #include <polyfem/utils/AutodiffTypes.hpp>
 
+#include <vector>
+
 // Navier-Stokes local assembler
 namespace polyfem::assembler
 {
@@ -28,8 +30,36 @@ namespace polyfem::assembler
 			return 0;
 		}
 
-		// res is R^{dim²}
-		// pde
+		// the global assemblies share the velocity at the quadrature points while x does not change
+		// (eg the Picard and Newton matrices and the residual of the same iterate)
+		void assemble_gradient(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			Eigen::MatrixXd &rhs) const override;
+
+		void assemble_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			utils::MatrixCache &mat_cache,
+			StiffnessMatrix &grad) const override;
+
+		// convective term of the pde (the Picard matrix times x)
+		// used for the residual of lagged convection
 		Eigen::VectorXd
 		assemble_gradient(const NonLinearAssemblerData &data) const override;
 
@@ -54,8 +84,22 @@ namespace polyfem::assembler
 		// not full graidnet used for Picard iteration
 		bool full_gradient_ = true;
 
-		Eigen::MatrixXd compute_N(const NonLinearAssemblerData &data) const;
-		Eigen::MatrixXd compute_W(const NonLinearAssemblerData &data) const;
+		/// velocity and its gradient at the quadrature points of an element
+		struct QuadratureVelocity
+		{
+			Eigen::MatrixXd vel;  ///< n_pts x dim
+			Eigen::MatrixXd grad; ///< n_pts x dim^2, grad(p, d * dim + c) = d vel_d / d x_c
+			bool valid = false;
+		};
+
+		/// cached velocity of data.vals.element_id during a global assembly, computed in tmp otherwise
+		const QuadratureVelocity &quadrature_velocity(const NonLinearAssemblerData &data, QuadratureVelocity &tmp) const;
+		/// enables the cache for the next global assembly, the cached values are dropped if x changed
+		void enable_velocity_cache(const int n_elements, const Eigen::MatrixXd &x) const;
+
+		mutable std::vector<QuadratureVelocity> velocity_cache_;
+		mutable Eigen::MatrixXd velocity_cache_x_;
+		mutable bool velocity_cache_enabled_ = false;
 	};
 
 } // namespace polyfem::assembler
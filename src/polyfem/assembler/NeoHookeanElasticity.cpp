@@ -1,6 +1,7 @@
 #include "NeoHookeanElasticity.hpp"
 
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
+#include <ipc/utils/eigen_ext.hpp>
 
 namespace polyfem::assembler
 {
@@ -546,6 +547,8 @@ namespace polyfem::assembler
 			Eigen::Matrix<double, dim * dim, 1> g_j = Eigen::Map<const Eigen::Matrix<double, dim * dim, 1>>(delJ_delF.data(), delJ_delF.size());
 
 			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = (mu * id) + (((mu + lambda * (1 - log_det_j)) / (J * J)) * (g_j * g_j.transpose())) + (((lambda * log_det_j - mu) / (J)) * del2J_delF2);
+			if (data.project_to_psd)
+				hessian_temp = ipc::project_to_psd(hessian_temp);
 
 			Eigen::Matrix<double, dim * dim, N> delF_delU_tensor(jac_it.size(), grad.size());
 
@@ -21,6 +21,7 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		bool projects_hessian_pointwise() const override { return true; }
 
 		// rhs for fabbricated solution, compute with automatic sympy code
 		VectorNd compute_rhs(const AutodiffHessianPt &pt) const override;
@@ -30,6 +31,7 @@ namespace polyfem::assembler
 									 const Eigen::MatrixXd &local_pts,
 									 const Eigen::MatrixXd &displacement,
 									 Eigen::MatrixXd &tensor) const override;
+		bool stiffness_is_energy_hessian() const override { return true; }
 
 		void compute_stress_grad_multiply_mat(const OptAssemblerData &data,
 											  const Eigen::MatrixXd &mat,
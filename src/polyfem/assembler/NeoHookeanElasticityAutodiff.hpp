@@ -15,6 +15,9 @@ namespace polyfem::assembler
 
 		NeoHookeanAutodiff();
 
+		// the energy only depends on the deformation gradient
+		static constexpr bool use_def_grad_kernels = true;
+
 		// sets material params
 		void add_multimaterial(const int index, const json &params, const Units &units) override;
 
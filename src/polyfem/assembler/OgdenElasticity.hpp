@@ -20,6 +20,9 @@ namespace polyfem::assembler
 		std::string name() const override { return "UnconstrainedOgden"; }
 		std::map<std::string, ParamFunc> parameters() const override;
 
+		// the energy only depends on the deformation gradient
+		static constexpr bool use_def_grad_kernels = true;
+
 		template <typename T>
 		T elastic_energy(
 			const RowVectorNd &p,
@@ -54,6 +57,9 @@ namespace polyfem::assembler
 		std::string name() const override { return "IncompressibleOgden"; }
 		std::map<std::string, ParamFunc> parameters() const override;
 
+		// the energy only depends on the deformation gradient
+		static constexpr bool use_def_grad_kernels = true;
+
 		template <typename T>
 		T elastic_energy(
 			const RowVectorNd &p,
@@ -4,6 +4,8 @@
 #include <polyfem/mesh/LocalBoundary.hpp>
 #include <polyfem/utils/Logger.hpp>
 
+#include <algorithm>
+
 namespace
 {
 	Eigen::MatrixXd extract_vertices(const std::shared_ptr<polyfem::mesh::MeshNodes> &mesh_nodes)
@@ -121,31 +123,67 @@ namespace polyfem::utils
     int PeriodicBoundary::full_to_periodic(StiffnessMatrix &A) const
 	{
 		const int independent_dof = full_to_periodic_map_.maxCoeff() + 1;
-		
-		// account for potential pressure block
-		auto index_map = [&](int id){
-			if (id < full_to_periodic_map_.size())
-				return full_to_periodic_map_(id);
-			else
-				return (int)(id + independent_dof - full_to_periodic_map_.size());
-		};
 
-		StiffnessMatrix A_periodic(index_map(A.rows()), index_map(A.cols()));
+		A.makeCompressed();
+
+		const bool same_pattern =
+			matrix_periodic_.rows() == full_to_periodic_index(A.rows())
+			&& matrix_periodic_.cols() == full_to_periodic_index(A.cols())
+			&& matrix_full_outer_.size() == A.outerSize() + 1 && matrix_full_inner_.size() == A.nonZeros()
+			&& std::equal(matrix_full_outer_.begin(), matrix_full_outer_.end(), A.outerIndexPtr())
+			&& std::equal(matrix_full_inner_.begin(), matrix_full_inner_.end(), A.innerIndexPtr());
+
+		if (!same_pattern)
+			build_matrix_reduction(A);
+
+		// several full entries are merged in the same periodic one
+		StiffnessMatrix A_periodic = matrix_periodic_;
+		A_periodic.coeffs().setZero();
+		double *values = A_periodic.valuePtr();
+		const double *full_values = A.valuePtr();
+		for (int i = 0; i < matrix_periodic_slot_.size(); ++i)
+			values[matrix_periodic_slot_[i]] += full_values[i];
+
+		std::swap(A_periodic, A);
+
+		return independent_dof;
+	}
+
+	void PeriodicBoundary::build_matrix_reduction(const StiffnessMatrix &A) const
+	{
+		matrix_full_outer_.assign(A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1);
+		matrix_full_inner_.assign(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros());
+
+		// account for potential pressure block
 		std::vector<Eigen::Triplet<double>> entries;
 		entries.reserve(A.nonZeros());
 		for (int k = 0; k < A.outerSize(); k++)
 		{
-			for (StiffnessMatrix::InnerIterator it(A,k); it; ++it)
+			for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
 			{
-				entries.emplace_back(index_map(it.row()), index_map(it.col()), it.value());
+				entries.emplace_back(full_to_periodic_index(it.row()), full_to_periodic_index(it.col()), 0);
 			}
 		}
-		A_periodic.setFromTriplets(entries.begin(),entries.end());
-
-		std::swap(A_periodic, A);
+		matrix_periodic_.resize(full_to_periodic_index(A.rows()), full_to_periodic_index(A.cols()));
+		matrix_periodic_.setFromTriplets(entries.begin(), entries.end());
+		matrix_periodic_.makeCompressed();
 
-		return independent_dof;
+		// position of every full entry in the value array of the periodic matrix
+		matrix_periodic_slot_.resize(A.nonZeros());
+		for (int k = 0; k < A.outerSize(); k++)
+		{
+			const int outer = full_to_periodic_index(k);
+			const int *begin = matrix_periodic_.innerIndexPtr() + matrix_periodic_.outerIndexPtr()[outer];
+			const int *end = matrix_periodic_.innerIndexPtr() + matrix_periodic_.outerIndexPtr()[outer + 1];
+			for (int i = A.outerIndexPtr()[k]; i < A.outerIndexPtr()[k + 1]; ++i)
+			{
+				const int *slot = std::lower_bound(begin, end, full_to_periodic_index(A.innerIndexPtr()[i]));
+				assert(slot != end);
+				matrix_periodic_slot_[i] = slot - matrix_periodic_.innerIndexPtr();
+			}
+		}
 	}
+
     Eigen::MatrixXd PeriodicBoundary::full_to_periodic(const Eigen::MatrixXd &b, bool accumulate) const
     {
 		const int independent_dof = full_to_periodic_map_.maxCoeff() + 1;
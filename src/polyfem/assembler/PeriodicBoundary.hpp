@@ -33,11 +33,20 @@ namespace polyfem::utils
             const Eigen::MatrixXd &affine_matrix,
             const double tol);
 
+        /// folds A onto the periodic dofs, the reduced pattern and the entry slots are cached
+        /// so that repeated calls with the same pattern only accumulate values (not thread safe)
         int full_to_periodic(StiffnessMatrix &A) const;
 		Eigen::MatrixXd full_to_periodic(const Eigen::MatrixXd &b, bool accumulate) const;
 		std::vector<int> full_to_periodic(const std::vector<int> &boundary_nodes) const;
 
         inline int n_periodic_dof() const { return full_to_periodic_map_.maxCoeff() + 1; }
+        /// periodic dof of a full dof, the dofs after the periodic ones (e.g., pressure) are shifted
+        inline int full_to_periodic_index(const int id) const
+        {
+            if (id < full_to_periodic_map_.size())
+                return full_to_periodic_map_(id);
+            return id + n_periodic_dof() - full_to_periodic_map_.size();
+        }
         inline bool is_periodic_dof(const int idx) const { return periodic_mask_[idx]; }
 
 		Eigen::MatrixXd periodic_to_full(const int ndofs, const Eigen::MatrixXd &x_periodic) const;
@@ -48,10 +57,17 @@ namespace polyfem::utils
         Eigen::MatrixXd get_affine_matrix() const { return affine_matrix_; }
 
     private:
+        void build_matrix_reduction(const StiffnessMatrix &A) const;
+
         int problem_dim_;
         Eigen::VectorXi full_to_periodic_map_;
         Eigen::VectorXi periodic_mask_;
 
         Eigen::MatrixXd affine_matrix_; // each column is one periodic direction
+
+        // cached pattern of the last folded matrix, slot of each of its entries in the periodic matrix
+        mutable std::vector<int> matrix_full_outer_, matrix_full_inner_;
+        mutable std::vector<int> matrix_periodic_slot_;
+        mutable StiffnessMatrix matrix_periodic_;
     };
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <polyfem/utils/BoundarySampler.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/GraphColoring.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 #include <ipc/utils/eigen_ext.hpp>
 #include <polysolve/linear/Solver.hpp>
 
@@ -34,17 +36,19 @@ namespace polyfem
 				}
 			};
 
-			class LocalThreadVecStorage
+			/// groups the local boundaries such that two of them in the same group never touch the same basis
+			std::vector<std::vector<int>> color_local_boundary(const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<basis::ElementBases> &bases, const int n_basis)
 			{
-			public:
-				Eigen::MatrixXd vec;
-
-				LocalThreadVecStorage(const int size)
+				std::vector<std::vector<int>> lb_nodes(local_boundary.size());
+				for (int lb_id = 0; lb_id < local_boundary.size(); ++lb_id)
 				{
-					vec.resize(size, 1);
-					vec.setZero();
+					for (const auto &b : bases[local_boundary[lb_id].element_id()].bases)
+						for (const auto &g : b.global())
+							lb_nodes[lb_id].push_back(g.index);
 				}
-			};
+
+				return utils::greedy_coloring(lb_nodes, n_basis);
+			}
 
 			class LocalThreadPrimitiveStorage
 			{
@@ -54,12 +58,6 @@ namespace polyfem
 				LocalThreadPrimitiveStorage() {}
 			};
 
-			class LocalThreadMatStorage
-			{
-			public:
-				std::vector<Eigen::Triplet<double>> entries;
-			};
-
 			Eigen::Matrix3d wedge_product(const Eigen::Vector3d &a, const Eigen::Vector3d &b)
 			{
 				return a * b.transpose() - b * a.transpose();
@@ -87,6 +85,101 @@ namespace polyfem
 			}
 		} // namespace
 
+		const PressureAssembler::BoundaryCache &PressureAssembler::boundary_cache(const std::vector<mesh::LocalBoundary> &local_boundary, const int resolution) const
+		{
+			std::lock_guard<std::mutex> lock(boundary_caches_mutex_);
+			std::unique_ptr<BoundaryCache> &cache = boundary_caches_[{&local_boundary, resolution}];
+			if (cache != nullptr && cache->facets.size() == local_boundary.size())
+				return *cache;
+
+			cache = std::make_unique<BoundaryCache>();
+			cache->facets.resize(local_boundary.size());
+			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
+				for (int lb_id = start; lb_id < end; ++lb_id)
+				{
+					const auto &lb = local_boundary[lb_id];
+					const int e = lb.element_id();
+					const basis::ElementBases &gbs = gbases_[e];
+					const basis::ElementBases &bs = bases_[e];
+
+					for (int i = 0; i < lb.size(); ++i)
+					{
+						FacetSamples f;
+						f.local_id = lb[i];
+						f.primitive_id = lb.global_primitive_id(i);
+						f.nodes = bs.local_nodes_for_primitive(f.primitive_id, mesh_);
+
+						const bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, f.uv, f.points, f.normals, f.weights);
+						if (!has_samples)
+							continue;
+
+						if (mesh_.is_volume())
+							f.weights /= 2 * mesh_.tri_area(f.primitive_id);
+						else
+							f.weights /= mesh_.edge_length(f.primitive_id);
+
+						f.global_primitive_ids.setConstant(f.weights.size(), f.primitive_id);
+						f.vals.compute(e, mesh_.is_volume(), f.points, bs, gbs);
+
+						cache->facets[lb_id].push_back(std::move(f));
+					}
+				}
+			});
+
+			cache->colors = color_local_boundary(local_boundary, bases_, n_basis_);
+
+			// all the pairs of dofs of a facet, the dirichlet ones stay zero
+			std::vector<Eigen::Triplet<double>> entries;
+			for (const auto &facets : cache->facets)
+			{
+				for (const FacetSamples &f : facets)
+				{
+					for (long ni = 0; ni < f.nodes.size(); ++ni)
+						for (int di = 0; di < size_; ++di)
+							for (long nj = 0; nj < f.nodes.size(); ++nj)
+								for (int dj = 0; dj < size_; ++dj)
+									entries.emplace_back(
+										f.vals.basis_values[f.nodes(ni)].global[0].index * size_ + di,
+										f.vals.basis_values[f.nodes(nj)].global[0].index * size_ + dj,
+										0.);
+				}
+			}
+			cache->hessian_pattern.resize(n_basis_ * size_, n_basis_ * size_);
+			cache->hessian_pattern.setFromTriplets(entries.begin(), entries.end());
+			cache->hessian_pattern.makeCompressed();
+
+			for (auto &facets : cache->facets)
+			{
+				for (FacetSamples &f : facets)
+				{
+					f.hessian_entries.clear();
+					for (long ni = 0; ni < f.nodes.size(); ++ni)
+						for (int di = 0; di < size_; ++di)
+							for (long nj = 0; nj < f.nodes.size(); ++nj)
+								for (int dj = 0; dj < size_; ++dj)
+								{
+									const double *entry = utils::find_in_pattern(
+										cache->hessian_pattern,
+										f.vals.basis_values[f.nodes(ni)].global[0].index * size_ + di,
+										f.vals.basis_values[f.nodes(nj)].global[0].index * size_ + dj);
+									assert(entry != nullptr);
+									f.hessian_entries.push_back(entry - cache->hessian_pattern.valuePtr());
+								}
+				}
+			}
+
+			return *cache;
+		}
+
+		std::vector<bool> PressureAssembler::dirichlet_mask(const std::vector<int> &dirichlet_nodes) const
+		{
+			std::vector<bool> is_dirichlet(n_basis_ * size_, false);
+			for (const int d : dirichlet_nodes)
+				if (d >= 0 && d < int(is_dirichlet.size()))
+					is_dirichlet[d] = true;
+			return is_dirichlet;
+		}
+
 		double PressureAssembler::compute_volume(
 			const Eigen::MatrixXd &displacement,
 			const std::vector<mesh::LocalBoundary> &local_boundary,
@@ -96,42 +189,26 @@ namespace polyfem
 		{
 			double res = 0;
 
+			const BoundaryCache &cache = boundary_cache(local_boundary, resolution);
 			auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
 
 			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
 				LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				Eigen::MatrixXd pressure_vals, g_3;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
+				Eigen::MatrixXd normals, deform_mat, trafo;
+				Eigen::MatrixXd u, grad_u;
 				for (int lb_id = start; lb_id < end; ++lb_id)
 				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
+					const int e = local_boundary[lb_id].element_id();
 
-					for (int i = 0; i < lb.size(); ++i)
+					for (const FacetSamples &f : cache.facets[lb_id])
 					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						if (mesh_.is_volume())
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
+						const ElementAssemblyValues &vals = f.vals;
+						const Eigen::VectorXd &weights = f.weights;
+						normals = f.normals;
 						g_3.setZero(normals.rows(), normals.cols());
 
-						if (!has_samples)
-							continue;
-
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-
 						for (int n = 0; n < vals.jac_it.size(); ++n)
 						{
 							trafo = vals.jac_it[n].inverse();
@@ -161,10 +238,10 @@ namespace polyfem
 							if (mesh_.is_volume())
 							{
 								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
+								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(f.local_id);
 								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
 								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
+								if (f.local_id == 0)
 									g1 *= -1;
 								g3 = g1.cross(g2);
 								g_3.row(n) = g3.transpose();
@@ -172,7 +249,7 @@ namespace polyfem
 							else
 							{
 								Eigen::Vector2d g1, g3;
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
+								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(f.local_id);
 								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
 								g3(0) = -g1(1);
 								g3(1) = g1(0);
@@ -181,13 +258,12 @@ namespace polyfem
 						}
 
 						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
+							problem_.pressure_bc(mesh_, f.global_primitive_ids, f.uv, vals.val, normals, t, pressure_vals);
 						else
 							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
 
-						Eigen::MatrixXd u, grad_u;
 						if (displacement.size() > 0)
-							io::Evaluator::interpolate_at_local_vals(mesh_, problem_.is_scalar(), bases_, gbases_, e, points, displacement, u, grad_u);
+							io::Evaluator::interpolate_at_local_vals(e, mesh_.dimension(), problem_.is_scalar() ? 1 : mesh_.dimension(), vals, displacement, u, grad_u);
 						else
 							u.setZero(weights.size(), size_);
 						u += vals.val;
@@ -218,118 +294,101 @@ namespace polyfem
 		{
 			grad.setZero(n_basis_ * size_);
 
-			auto storage = utils::create_thread_storage(LocalThreadVecStorage(grad.size()));
+			const BoundaryCache &cache = boundary_cache(local_boundary, resolution);
+			const std::vector<bool> is_dirichlet = dirichlet_mask(dirichlet_nodes);
 
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-				Eigen::MatrixXd pressure_vals, g_3;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
-				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
+			// local boundaries of the same colour do not share nodes, scatter directly into grad
+			// so that memory stays O(ndof) independently of the number of threads
+			for (const std::vector<int> &color : cache.colors)
+			{
+				utils::maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					Eigen::MatrixXd pressure_vals, g_3;
+					Eigen::MatrixXd normals, deform_mat, trafo;
+					for (int k = start; k < end; ++k)
 					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						if (mesh_.is_volume())
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
-						g_3.setZero(normals.rows(), normals.cols());
-
-						if (!has_samples)
-							continue;
-
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						for (int n = 0; n < vals.jac_it.size(); ++n)
+						for (const FacetSamples &f : cache.facets[color[k]])
 						{
-							trafo = vals.jac_it[n].inverse();
+							const ElementAssemblyValues &vals = f.vals;
+							const Eigen::VectorXi &nodes = f.nodes;
+							const Eigen::VectorXd &weights = f.weights;
+							normals = f.normals;
+							g_3.setZero(normals.rows(), normals.cols());
 
-							if (displacement.size() > 0)
+							for (int n = 0; n < vals.jac_it.size(); ++n)
 							{
-								assert(size_ == 2 || size_ == 3);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
+								trafo = vals.jac_it[n].inverse();
+
+								if (displacement.size() > 0)
 								{
-									for (const auto &g : b.global)
+									assert(size_ == 2 || size_ == 3);
+									deform_mat.resize(size_, size_);
+									deform_mat.setZero();
+									for (const auto &b : vals.basis_values)
 									{
-										for (int d = 0; d < size_; ++d)
+										for (const auto &g : b.global)
 										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											for (int d = 0; d < size_; ++d)
+											{
+												deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											}
 										}
 									}
-								}
 
-								trafo += deform_mat;
-							}
+									trafo += deform_mat;
+								}
 
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
+								normals.row(n) = normals.row(n) * trafo.inverse();
+								normals.row(n).normalize();
 
-							if (mesh_.is_volume())
-							{
-								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
-									g1 *= -1;
-								g3 = g1.cross(g2);
-								g_3.row(n) = g3.transpose();
-							}
-							else
-							{
-								Eigen::Vector2d g1, g3;
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g3(0) = -g1(1);
-								g3(1) = g1(0);
-								g_3.row(n) = g3.transpose();
+								if (mesh_.is_volume())
+								{
+									Eigen::Vector3d g1, g2, g3;
+									auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(f.local_id);
+									g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
+									g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
+									if (f.local_id == 0)
+										g1 *= -1;
+									g3 = g1.cross(g2);
+									g_3.row(n) = g3.transpose();
+								}
+								else
+								{
+									Eigen::Vector2d g1, g3;
+									auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(f.local_id);
+									g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
+									g3(0) = -g1(1);
+									g3(1) = g1(0);
+									g_3.row(n) = g3.transpose();
+								}
 							}
-						}
 
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
+							if (multiply_pressure)
+								problem_.pressure_bc(mesh_, f.global_primitive_ids, f.uv, vals.val, normals, t, pressure_vals);
+							else
+								pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
 
-						for (long n = 0; n < nodes.size(); ++n)
-						{
-							const AssemblyValues &v = vals.basis_values[nodes(n)];
-							for (int d = 0; d < size_; ++d)
+							for (long n = 0; n < nodes.size(); ++n)
 							{
-								for (size_t g = 0; g < v.global.size(); ++g)
+								const AssemblyValues &v = vals.basis_values[nodes(n)];
+								for (int d = 0; d < size_; ++d)
 								{
-									const int g_index = v.global[g].index * size_ + d;
-									const bool is_dof_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), g_index) != dirichlet_nodes.end();
-									if (is_dof_dirichlet)
-										continue;
-
-									for (long p = 0; p < weights.size(); ++p)
+									for (size_t g = 0; g < v.global.size(); ++g)
 									{
-										local_storage.vec(g_index) += pressure_vals(p) * g_3(p, d) * v.val(p) * weights(p);
+										const int g_index = v.global[g].index * size_ + d;
+										if (is_dirichlet[g_index])
+											continue;
+
+										for (long p = 0; p < weights.size(); ++p)
+										{
+											grad(g_index) += pressure_vals(p) * g_3(p, d) * v.val(p) * weights(p);
+										}
 									}
 								}
 							}
 						}
 					}
-				}
-			});
-			for (const LocalThreadVecStorage &local_storage : storage)
-				grad += local_storage.vec;
+				});
+			}
 		}
 
 		void PressureAssembler::compute_grad_volume_id(
@@ -344,122 +403,122 @@ namespace polyfem
 		{
 			grad.setZero(n_basis_ * size_);
 
-			auto storage = utils::create_thread_storage(LocalThreadVecStorage(grad.size()));
-
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-				Eigen::MatrixXd pressure_vals, g_3;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
-				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
+			// local boundaries of the same colour do not share nodes, scatter directly into grad
+			// so that memory stays O(ndof) independently of the number of threads
+			const BoundaryCache &cache = boundary_cache(local_boundary, resolution);
+			for (const std::vector<int> &color : cache.colors)
+			{
+				utils::maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					Eigen::MatrixXd pressure_vals, g_3;
+					ElementAssemblyValues vals;
+					Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
+					Eigen::VectorXd weights;
+					Eigen::VectorXi global_primitive_ids;
+					for (int k = start; k < end; ++k)
 					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-						const int curr_boundary_id = mesh_.get_boundary_id(primitive_global_id);
+						const auto &lb = local_boundary[color[k]];
+						const int e = lb.element_id();
+						const basis::ElementBases &gbs = gbases_[e];
+						const basis::ElementBases &bs = bases_[e];
 
-						if (curr_boundary_id != boundary_id)
-							continue;
+						for (int i = 0; i < lb.size(); ++i)
+						{
+							const int primitive_global_id = lb.global_primitive_id(i);
+							const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
+							const int curr_boundary_id = mesh_.get_boundary_id(primitive_global_id);
 
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						if (mesh_.is_volume())
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
-						g_3.setZero(normals.rows(), normals.cols());
+							if (curr_boundary_id != boundary_id)
+								continue;
 
-						if (!has_samples)
-							continue;
+							bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
+							if (mesh_.is_volume())
+								weights /= 2 * mesh_.tri_area(primitive_global_id);
+							else
+								weights /= mesh_.edge_length(primitive_global_id);
+							g_3.setZero(normals.rows(), normals.cols());
 
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
+							if (!has_samples)
+								continue;
 
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						for (int n = 0; n < vals.jac_it.size(); ++n)
-						{
-							trafo = vals.jac_it[n].inverse();
+							global_primitive_ids.setConstant(weights.size(), primitive_global_id);
 
-							if (displacement.size() > 0)
+							vals.compute(e, mesh_.is_volume(), points, bs, gbs);
+							for (int n = 0; n < vals.jac_it.size(); ++n)
 							{
-								assert(size_ == 2 || size_ == 3);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
+								trafo = vals.jac_it[n].inverse();
+
+								if (displacement.size() > 0)
 								{
-									for (const auto &g : b.global)
+									assert(size_ == 2 || size_ == 3);
+									deform_mat.resize(size_, size_);
+									deform_mat.setZero();
+									for (const auto &b : vals.basis_values)
 									{
-										for (int d = 0; d < size_; ++d)
+										for (const auto &g : b.global)
 										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											for (int d = 0; d < size_; ++d)
+											{
+												deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											}
 										}
 									}
+
+									trafo += deform_mat;
 								}
 
-								trafo += deform_mat;
-							}
+								normals.row(n) = normals.row(n) * trafo.inverse();
+								normals.row(n).normalize();
 
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
-
-							if (mesh_.is_volume())
-							{
-								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
-									g1 *= -1;
-								g3 = g1.cross(g2);
-								g_3.row(n) = g3.transpose();
-							}
-							else
-							{
-								Eigen::Vector2d g1, g3;
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g3(0) = -g1(1);
-								g3(1) = g1(0);
-								g_3.row(n) = g3.transpose();
+								if (mesh_.is_volume())
+								{
+									Eigen::Vector3d g1, g2, g3;
+									auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
+									g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
+									g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
+									if (lb[i] == 0)
+										g1 *= -1;
+									g3 = g1.cross(g2);
+									g_3.row(n) = g3.transpose();
+								}
+								else
+								{
+									Eigen::Vector2d g1, g3;
+									auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
+									g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
+									g3(0) = -g1(1);
+									g3(1) = g1(0);
+									g_3.row(n) = g3.transpose();
+								}
 							}
-						}
 
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
+							if (multiply_pressure)
+								problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
+							else
+								pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
 
-						for (long n = 0; n < nodes.size(); ++n)
-						{
-							const AssemblyValues &v = vals.basis_values[nodes(n)];
-							for (int d = 0; d < size_; ++d)
+							for (long n = 0; n < nodes.size(); ++n)
 							{
-								for (size_t g = 0; g < v.global.size(); ++g)
+								const AssemblyValues &v = vals.basis_values[nodes(n)];
+								for (int d = 0; d < size_; ++d)
 								{
-									const int g_index = v.global[g].index * size_ + d;
-									const bool is_dof_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), g_index) != dirichlet_nodes.end();
-									if (is_dof_dirichlet)
-										continue;
-
-									for (long p = 0; p < weights.size(); ++p)
+									for (size_t g = 0; g < v.global.size(); ++g)
 									{
-										local_storage.vec(g_index) += pressure_vals(p) * g_3(p, d) * v.val(p) * weights(p);
+										const int g_index = v.global[g].index * size_ + d;
+										const bool is_dof_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), g_index) != dirichlet_nodes.end();
+										if (is_dof_dirichlet)
+											continue;
+
+										for (long p = 0; p < weights.size(); ++p)
+										{
+											grad(g_index) += pressure_vals(p) * g_3(p, d) * v.val(p) * weights(p);
+										}
 									}
 								}
 							}
 						}
 					}
-				}
-			});
-			for (const LocalThreadVecStorage &local_storage : storage)
-				grad += local_storage.vec;
+				});
+			}
 		}
 
 		void PressureAssembler::compute_hess_volume_3d(
@@ -471,86 +530,68 @@ namespace polyfem
 			const double t,
 			const bool multiply_pressure) const
 		{
-			hess.resize(n_basis_ * size_, n_basis_ * size_);
+			assert(mesh_.is_volume());
 
-			auto storage = create_thread_storage(LocalThreadMatStorage());
+			const BoundaryCache &cache = boundary_cache(local_boundary, resolution);
+			const std::vector<bool> is_dirichlet = dirichlet_mask(dirichlet_nodes);
 
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadMatStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			// the pattern is computed once, local boundaries of the same colour write to different entries
+			hess = cache.hessian_pattern;
+			double *const hess_values = hess.valuePtr();
 
-				Eigen::MatrixXd pressure_vals, g_1, g_2, g_3, local_hessian;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
-				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
+			for (const std::vector<int> &color : cache.colors)
+			{
+				utils::maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					Eigen::MatrixXd pressure_vals, g_1, g_2, g_3, local_hessian;
+					Eigen::MatrixXd normals, deform_mat, trafo;
+					for (int k = start; k < end; ++k)
 					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						std::vector<Eigen::VectorXd> param_chain_rule;
-						if (mesh_.is_volume())
+						for (const FacetSamples &f : cache.facets[color[k]])
 						{
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
+							const ElementAssemblyValues &vals = f.vals;
+							const Eigen::VectorXi &nodes = f.nodes;
+							const Eigen::VectorXd &weights = f.weights;
+							normals = f.normals;
+
 							g_1.setZero(normals.rows(), normals.cols());
 							g_2.setZero(normals.rows(), normals.cols());
 							g_3.setZero(normals.rows(), normals.cols());
 
-							auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-							param_chain_rule = {(endpoints.row(0) - endpoints.row(1)).transpose(), (endpoints.row(0) - endpoints.row(2)).transpose()};
-							if (lb[i] == 0)
+							const auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(f.local_id);
+							std::vector<Eigen::VectorXd> param_chain_rule = {(endpoints.row(0) - endpoints.row(1)).transpose(), (endpoints.row(0) - endpoints.row(2)).transpose()};
+							if (f.local_id == 0)
 								param_chain_rule[0] *= -1;
-						}
-						else
-							assert(false);
-
-						if (!has_samples)
-							continue;
-
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						for (int n = 0; n < vals.jac_it.size(); ++n)
-						{
-							trafo = vals.jac_it[n].inverse();
 
-							if (displacement.size() > 0)
+							for (int n = 0; n < vals.jac_it.size(); ++n)
 							{
-								assert(size_ == 3);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
+								trafo = vals.jac_it[n].inverse();
+
+								if (displacement.size() > 0)
 								{
-									for (const auto &g : b.global)
+									assert(size_ == 3);
+									deform_mat.resize(size_, size_);
+									deform_mat.setZero();
+									for (const auto &b : vals.basis_values)
 									{
-										for (int d = 0; d < size_; ++d)
+										for (const auto &g : b.global)
 										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											for (int d = 0; d < size_; ++d)
+											{
+												deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											}
 										}
 									}
-								}
 
-								trafo += deform_mat;
-							}
+									trafo += deform_mat;
+								}
 
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
+								normals.row(n) = normals.row(n) * trafo.inverse();
+								normals.row(n).normalize();
 
-							if (mesh_.is_volume())
-							{
 								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
 								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
 								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
+								if (f.local_id == 0)
 									g1 *= -1;
 								g3 = g1.cross(g2);
 
@@ -558,95 +599,65 @@ namespace polyfem
 								g_2.row(n) = g2.transpose();
 								g_3.row(n) = g3.transpose();
 							}
-							else
-								assert(false);
-						}
-
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
 
-						local_hessian.setZero(vals.basis_values.size() * size_, vals.basis_values.size() * size_);
+							if (multiply_pressure)
+								problem_.pressure_bc(mesh_, f.global_primitive_ids, f.uv, vals.val, normals, t, pressure_vals);
+							else
+								pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
 
-						for (long p = 0; p < weights.size(); ++p)
-						{
-							Eigen::Vector3d g_up_1, g_up_2;
-							g_dual(g_1.row(p).transpose(), g_2.row(p).transpose(), g_up_1, g_up_2);
-							std::vector<Eigen::MatrixXd> g_3_wedge_g_up = {wedge_product(g_3.row(p), g_up_1), wedge_product(g_3.row(p), g_up_2)};
+							local_hessian.setZero(vals.basis_values.size() * size_, vals.basis_values.size() * size_);
 
-							for (long ni = 0; ni < nodes.size(); ++ni)
+							for (long p = 0; p < weights.size(); ++p)
 							{
-								const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-								for (int di = 0; di < size_; ++di)
-								{
-									const int gi_index = vi.global[0].index * size_ + di;
-									const bool is_dof_i_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gi_index) != dirichlet_nodes.end();
-									if (is_dof_i_dirichlet)
-										continue;
-
-									Eigen::MatrixXd grad_phi_i;
-									grad_phi_i.setZero(3, 3);
-									grad_phi_i.row(di) = vi.grad.row(p);
+								Eigen::Vector3d g_up_1, g_up_2;
+								g_dual(g_1.row(p).transpose(), g_2.row(p).transpose(), g_up_1, g_up_2);
+								std::vector<Eigen::MatrixXd> g_3_wedge_g_up = {wedge_product(g_3.row(p), g_up_1), wedge_product(g_3.row(p), g_up_2)};
 
-									for (long nj = 0; nj < nodes.size(); ++nj)
+								for (long ni = 0; ni < nodes.size(); ++ni)
+								{
+									const AssemblyValues &vi = vals.basis_values[nodes(ni)];
+									for (int di = 0; di < size_; ++di)
 									{
-										const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-										for (int dj = 0; dj < size_; ++dj)
-										{
-											const int gj_index = vj.global[0].index * size_ + dj;
-											const bool is_dof_j_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gj_index) != dirichlet_nodes.end();
-											if (is_dof_j_dirichlet)
-												continue;
+										const int gi_index = vi.global[0].index * size_ + di;
+										if (is_dirichlet[gi_index])
+											continue;
 
-											Eigen::MatrixXd grad_phi_j;
-											grad_phi_j.setZero(3, 3);
-											grad_phi_j.row(dj) = vj.grad.row(p);
+										Eigen::MatrixXd grad_phi_i;
+										grad_phi_i.setZero(3, 3);
+										grad_phi_i.row(di) = vi.grad.row(p);
 
-											double value = 0;
-											for (int alpha = 0; alpha < size_ - 1; ++alpha)
+										for (long nj = 0; nj < nodes.size(); ++nj)
+										{
+											const AssemblyValues &vj = vals.basis_values[nodes(nj)];
+											for (int dj = 0; dj < size_; ++dj)
 											{
-												auto a = vj.val(p) * g_3_wedge_g_up[alpha].row(di) * (grad_phi_i * param_chain_rule[alpha]);
-												auto b = (g_3_wedge_g_up[alpha] * (grad_phi_j * param_chain_rule[alpha])).row(di) * vi.val(p);
-												value += pressure_vals(p) * (a(0) + b(0)) * weights(p);
+												const int gj_index = vj.global[0].index * size_ + dj;
+												if (is_dirichlet[gj_index])
+													continue;
+
+												Eigen::MatrixXd grad_phi_j;
+												grad_phi_j.setZero(3, 3);
+												grad_phi_j.row(dj) = vj.grad.row(p);
+
+												double value = 0;
+												for (int alpha = 0; alpha < size_ - 1; ++alpha)
+												{
+													auto a = vj.val(p) * g_3_wedge_g_up[alpha].row(di) * (grad_phi_i * param_chain_rule[alpha]);
+													auto b = (g_3_wedge_g_up[alpha] * (grad_phi_j * param_chain_rule[alpha])).row(di) * vi.val(p);
+													value += pressure_vals(p) * (a(0) + b(0)) * weights(p);
+												}
+												local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj) += value;
 											}
-											local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj) += value;
 										}
 									}
 								}
 							}
-						}
 
-						for (long ni = 0; ni < nodes.size(); ++ni)
-						{
-							const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-							for (int di = 0; di < size_; ++di)
-							{
-								const int gi_index = vi.global[0].index * size_ + di;
-								for (long nj = 0; nj < nodes.size(); ++nj)
-								{
-									const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-									for (int dj = 0; dj < size_; ++dj)
-									{
-										const int gj_index = vj.global[0].index * size_ + dj;
-
-										local_storage.entries.push_back(Eigen::Triplet<double>(gi_index, gj_index, local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj)));
-									}
-								}
-							}
+							scatter_local_hessian(f, local_hessian, hess_values);
 						}
 					}
-				}
-			});
-
-			std::vector<Eigen::Triplet<double>> all_entries;
-			// Serially merge local storages
-			for (LocalThreadMatStorage &local_storage : storage)
-			{
-				all_entries.insert(all_entries.end(), local_storage.entries.begin(), local_storage.entries.end());
+				});
 			}
-
-			hess.setFromTriplets(all_entries.begin(), all_entries.end());
 		}
 
 		void PressureAssembler::compute_hess_volume_2d(
@@ -658,80 +669,61 @@ namespace polyfem
 			const double t,
 			const bool multiply_pressure) const
 		{
-			hess.resize(n_basis_ * size_, n_basis_ * size_);
+			assert(!mesh_.is_volume());
 
-			auto storage = create_thread_storage(LocalThreadMatStorage());
+			const BoundaryCache &cache = boundary_cache(local_boundary, resolution);
+			const std::vector<bool> is_dirichlet = dirichlet_mask(dirichlet_nodes);
 
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadMatStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			// the pattern is computed once, local boundaries of the same colour write to different entries
+			hess = cache.hessian_pattern;
+			double *const hess_values = hess.valuePtr();
 
-				Eigen::MatrixXd pressure_vals, g_3_grad, local_hessian;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
-				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
+			for (const std::vector<int> &color : cache.colors)
+			{
+				utils::maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					Eigen::MatrixXd pressure_vals, g_3_grad, g_3_grad_local, local_hessian;
+					Eigen::MatrixXd normals, deform_mat, trafo;
+					for (int c = start; c < end; ++c)
 					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						std::vector<Eigen::VectorXd> param_chain_rule;
-
-						if (!has_samples)
-							continue;
-
-						if (mesh_.is_volume())
-							assert(false);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
+						for (const FacetSamples &f : cache.facets[color[c]])
+						{
+							const ElementAssemblyValues &vals = f.vals;
+							const Eigen::VectorXi &nodes = f.nodes;
+							const Eigen::VectorXd &weights = f.weights;
+							normals = f.normals;
 
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
+							g_3_grad.setZero(normals.rows(), size_ * vals.basis_values.size() * size_);
 
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						g_3_grad.setZero(normals.rows(), size_ * vals.basis_values.size() * size_);
+							const auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(f.local_id);
+							const Eigen::VectorXd reference_normal = (endpoints.row(0) - endpoints.row(1)).transpose();
 
-						for (int n = 0; n < vals.jac_it.size(); ++n)
-						{
-							trafo = vals.jac_it[n].inverse();
-
-							if (displacement.size() > 0)
+							for (int n = 0; n < vals.jac_it.size(); ++n)
 							{
-								assert(size_ == 2);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
+								trafo = vals.jac_it[n].inverse();
+
+								if (displacement.size() > 0)
 								{
-									for (const auto &g : b.global)
+									assert(size_ == 2);
+									deform_mat.resize(size_, size_);
+									deform_mat.setZero();
+									for (const auto &b : vals.basis_values)
 									{
-										for (int d = 0; d < size_; ++d)
+										for (const auto &g : b.global)
 										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											for (int d = 0; d < size_; ++d)
+											{
+												deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
+											}
 										}
 									}
-								}
 
-								trafo += deform_mat;
-							}
+									trafo += deform_mat;
+								}
 
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
+								normals.row(n) = normals.row(n) * trafo.inverse();
+								normals.row(n).normalize();
 
-							if (mesh_.is_volume())
-								assert(false);
-							else
-							{
-								Eigen::MatrixXd g_3_grad_local(size_, vals.basis_values.size() * size_);
-								g_3_grad_local.setZero();
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
-								Eigen::VectorXd reference_normal = (endpoints.row(0) - endpoints.row(1)).transpose();
+								g_3_grad_local.setZero(size_, vals.basis_values.size() * size_);
 								int b_count = 0;
 								for (const auto &b : vals.basis_values)
 								{
@@ -747,75 +739,57 @@ namespace polyfem
 									for (int l = 0; l < vals.basis_values.size() * size_; ++l)
 										g_3_grad(n, k * (vals.basis_values.size() * size_) + l) = g_3_grad_local(k, l);
 							}
-						}
 
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
+							if (multiply_pressure)
+								problem_.pressure_bc(mesh_, f.global_primitive_ids, f.uv, vals.val, normals, t, pressure_vals);
+							else
+								pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
 
-						local_hessian.setZero(vals.basis_values.size() * size_, vals.basis_values.size() * size_);
+							local_hessian.setZero(vals.basis_values.size() * size_, vals.basis_values.size() * size_);
 
-						for (long p = 0; p < weights.size(); ++p)
-						{
-							for (long ni = 0; ni < nodes.size(); ++ni)
+							for (long p = 0; p < weights.size(); ++p)
 							{
-								const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-								for (int di = 0; di < size_; ++di)
+								for (long ni = 0; ni < nodes.size(); ++ni)
 								{
-									const int gi_index = vi.global[0].index * size_ + di;
-									const bool is_dof_i_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gi_index) != dirichlet_nodes.end();
-									if (is_dof_i_dirichlet)
-										continue;
-
-									for (long nj = 0; nj < nodes.size(); ++nj)
+									const AssemblyValues &vi = vals.basis_values[nodes(ni)];
+									for (int di = 0; di < size_; ++di)
 									{
-										const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-										for (int dj = 0; dj < size_; ++dj)
+										const int gi_index = vi.global[0].index * size_ + di;
+										if (is_dirichlet[gi_index])
+											continue;
+
+										for (long nj = 0; nj < nodes.size(); ++nj)
 										{
-											const int gj_index = vj.global[0].index * size_ + dj;
-											const bool is_dof_j_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gj_index) != dirichlet_nodes.end();
-											if (is_dof_j_dirichlet)
-												continue;
+											const AssemblyValues &vj = vals.basis_values[nodes(nj)];
+											for (int dj = 0; dj < size_; ++dj)
+											{
+												const int gj_index = vj.global[0].index * size_ + dj;
+												if (is_dirichlet[gj_index])
+													continue;
 
-											double value = pressure_vals(p) * g_3_grad(p, (di * vals.basis_values.size() * size_) + nodes(nj) * size_ + dj) * vi.val(p) * weights(p);
-											local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj) += value;
+												double value = pressure_vals(p) * g_3_grad(p, (di * vals.basis_values.size() * size_) + nodes(nj) * size_ + dj) * vi.val(p) * weights(p);
+												local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj) += value;
+											}
 										}
 									}
 								}
 							}
-						}
-
-						for (long ni = 0; ni < nodes.size(); ++ni)
-						{
-							const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-							for (int di = 0; di < size_; ++di)
-							{
-								const int gi_index = vi.global[0].index * size_ + di;
-								for (long nj = 0; nj < nodes.size(); ++nj)
-								{
-									const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-									for (int dj = 0; dj < size_; ++dj)
-									{
-										const int gj_index = vj.global[0].index * size_ + dj;
 
-										local_storage.entries.push_back(Eigen::Triplet<double>(gi_index, gj_index, local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj)));
-									}
-								}
-							}
+							scatter_local_hessian(f, local_hessian, hess_values);
 						}
 					}
-				}
-			});
-
-			std::vector<Eigen::Triplet<double>> all_entries;
-			// Serially merge local storages
-			for (LocalThreadMatStorage &local_storage : storage)
-			{
-				all_entries.insert(all_entries.end(), local_storage.entries.begin(), local_storage.entries.end());
+				});
 			}
+		}
 
-			hess.setFromTriplets(all_entries.begin(), all_entries.end());
+		void PressureAssembler::scatter_local_hessian(const FacetSamples &f, const Eigen::MatrixXd &local_hessian, double *hess_values) const
+		{
+			int entry = 0;
+			for (long ni = 0; ni < f.nodes.size(); ++ni)
+				for (int di = 0; di < size_; ++di)
+					for (long nj = 0; nj < f.nodes.size(); ++nj)
+						for (int dj = 0; dj < size_; ++dj)
+							hess_values[f.hessian_entries[entry++]] += local_hessian(f.nodes(ni) * size_ + di, f.nodes(nj) * size_ + dj);
 		}
 
 		bool PressureAssembler::is_closed_or_boundary_fixed(
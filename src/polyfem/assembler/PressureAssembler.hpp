@@ -7,6 +7,10 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/mesh/LocalBoundary.hpp>
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace polyfem
 {
 	namespace assembler
@@ -186,6 +190,35 @@ namespace polyfem
 				const std::vector<mesh::LocalBoundary> &local_boundary,
 				const std::vector<int> &dirichlet_nodes) const;
 
+			/// quadrature of a boundary facet, it does not depend on the displacement
+			struct FacetSamples
+			{
+				int local_id;     ///< local index of the facet in its element
+				int primitive_id; ///< global id of the facet
+				Eigen::VectorXi nodes;
+				Eigen::MatrixXd uv, points, normals;
+				Eigen::VectorXd weights; ///< divided by the measure of the facet
+				Eigen::VectorXi global_primitive_ids;
+				ElementAssemblyValues vals;
+				/// positions in the values of the hessian pattern of the local entries (ni, di, nj, dj)
+				std::vector<int> hessian_entries;
+			};
+
+			/// samples and hessian pattern of a boundary, computed once per resolution
+			struct BoundaryCache
+			{
+				std::vector<std::vector<FacetSamples>> facets; ///< per local boundary
+				std::vector<std::vector<int>> colors;          ///< local boundaries of the same colour do not share nodes
+				StiffnessMatrix hessian_pattern;               ///< with zero values
+			};
+
+			/// cache of local_boundary, which has to live as long as the assembler (e.g., the boundaries of the state)
+			const BoundaryCache &boundary_cache(const std::vector<mesh::LocalBoundary> &local_boundary, const int resolution) const;
+			/// add the local hessian of a facet to the values of its boundary hessian pattern
+			void scatter_local_hessian(const FacetSamples &f, const Eigen::MatrixXd &local_hessian, double *hess_values) const;
+			/// mask of the dirichlet dofs
+			std::vector<bool> dirichlet_mask(const std::vector<int> &dirichlet_nodes) const;
+
 		private:
 			const Assembler &assembler_;
 			const mesh::Mesh &mesh_;
@@ -202,6 +235,9 @@ namespace polyfem
 			const std::vector<int> primitive_to_nodes_;
 			const std::vector<int> node_to_primitives_;
 			std::set<int> relevant_pressure_nodes_;
+
+			mutable std::mutex boundary_caches_mutex_;
+			mutable std::map<std::pair<const std::vector<mesh::LocalBoundary> *, int>, std::unique_ptr<BoundaryCache>> boundary_caches_;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -29,6 +29,21 @@ namespace polyfem
 					val = 0;
 				}
 			};
+
+			class LocalThreadVecStorage
+			{
+			public:
+				Eigen::MatrixXd vec;
+				ElementAssemblyValues vals;
+				Eigen::MatrixXd rhs_fun;
+				Eigen::MatrixXi ids;
+
+				LocalThreadVecStorage(const int size)
+				{
+					vec.resize(size, 1);
+					vec.setZero();
+				}
+			};
 		} // namespace
 
 		RhsAssembler::RhsAssembler(const Assembler &assembler, const Mesh &mesh, const Obstacle &obstacle,
@@ -64,50 +79,57 @@ namespace polyfem
 			rhs = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
 			if (!problem_.is_rhs_zero())
 			{
-				Eigen::MatrixXd rhs_fun;
-
 				const int n_elements = int(bases_.size());
-				ElementAssemblyValues vals;
-				for (int e = 0; e < n_elements; ++e)
-				{
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+				auto storage = create_thread_storage(LocalThreadVecStorage(rhs.size()));
 
-					// compute geometric mapping
-					// evaluate and store basis functions/their gradients at quadrature points
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+				maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+					LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+					Eigen::MatrixXd &rhs_fun = local_storage.rhs_fun;
 
-					const Quadrature &quadrature = vals.quadrature;
+					for (int e = start; e < end; ++e)
+					{
+						// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
 
-					// compute rhs values in physical space
-					problem_.rhs(assembler_, vals.val, t, rhs_fun);
+						// compute geometric mapping
+						// evaluate and store basis functions/their gradients at quadrature points
+						const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], local_storage.vals);
 
-					for (int d = 0; d < size_; ++d)
-					{
-						// rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
-						for (int q = 0; q < quadrature.weights.size(); ++q)
-						{
-							// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) : 1;
-							const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), t, vals.element_id);
-							// prepare for integration by weighing rhs by determinant and quadrature weights
-							rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
-						}
-					}
+						const Quadrature &quadrature = vals.quadrature;
 
-					const int n_loc_bases_ = int(vals.basis_values.size());
-					for (int i = 0; i < n_loc_bases_; ++i)
-					{
-						const AssemblyValues &v = vals.basis_values[i];
+						// compute rhs values in physical space
+						problem_.rhs(assembler_, vals.val, t, rhs_fun);
 
 						for (int d = 0; d < size_; ++d)
 						{
-							// integrate rhs function times the given local basis
-							const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
-							for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-								// add local contribution to the global rhs vector (with some weight for non-conforming bases)
-								rhs(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
+							// rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
+							for (int q = 0; q < quadrature.weights.size(); ++q)
+							{
+								// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) : 1;
+								const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), t, vals.element_id);
+								// prepare for integration by weighing rhs by determinant and quadrature weights
+								rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
+							}
+						}
+
+						const int n_loc_bases_ = int(vals.basis_values.size());
+						for (int i = 0; i < n_loc_bases_; ++i)
+						{
+							const AssemblyValues &v = vals.basis_values[i];
+
+							for (int d = 0; d < size_; ++d)
+							{
+								// integrate rhs function times the given local basis
+								const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
+								for (std::size_t ii = 0; ii < v.global.size(); ++ii)
+									// add local contribution to the global rhs vector (with some weight for non-conforming bases)
+									local_storage.vec(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
+							}
 						}
 					}
-				}
+				});
+
+				for (const LocalThreadVecStorage &local_storage : storage)
+					rhs += local_storage.vec;
 			}
 		}
 
@@ -138,19 +160,17 @@ namespace polyfem
 		void RhsAssembler::time_bc(const std::function<void(const Mesh &, const Eigen::MatrixXi &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun, Eigen::MatrixXd &sol) const
 		{
 			sol = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
-			Eigen::MatrixXd loc_sol;
 
 			const int n_elements = int(bases_.size());
-			ElementAssemblyValues vals;
-			Eigen::MatrixXi ids;
 
 			if (bc_method_ == "sample")
 			{
+				Eigen::MatrixXd loc_sol;
+				Eigen::MatrixXi ids;
+
 				for (int e = 0; e < n_elements; ++e)
 				{
 					const basis::ElementBases &bs = bases_[e];
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
 					ids.resize(1, 1);
 					ids.setConstant(e);
 
@@ -173,34 +193,44 @@ namespace polyfem
 			}
 			else
 			{
+				auto storage = create_thread_storage(LocalThreadVecStorage(sol.size()));
 
-				for (int e = 0; e < n_elements; ++e)
-				{
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
-					ids.resize(vals.val.rows(), 1);
-					ids.setConstant(e);
-
-					const Quadrature &quadrature = vals.quadrature;
-					// problem_.initial_solution(vals.val, loc_sol);
-					fun(mesh_, ids, vals.val, loc_sol);
-
-					for (int d = 0; d < size_; ++d)
-						loc_sol.col(d) = loc_sol.col(d).array() * vals.det.array() * quadrature.weights.array();
+				maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+					LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+					Eigen::MatrixXd &loc_sol = local_storage.rhs_fun;
+					Eigen::MatrixXi &ids = local_storage.ids;
 
-					const int n_loc_bases_ = int(vals.basis_values.size());
-					for (int i = 0; i < n_loc_bases_; ++i)
+					for (int e = start; e < end; ++e)
 					{
-						const AssemblyValues &v = vals.basis_values[i];
+						// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+						const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], local_storage.vals);
+						ids.resize(vals.val.rows(), 1);
+						ids.setConstant(e);
+
+						const Quadrature &quadrature = vals.quadrature;
+						// problem_.initial_solution(vals.val, loc_sol);
+						fun(mesh_, ids, vals.val, loc_sol);
 
 						for (int d = 0; d < size_; ++d)
+							loc_sol.col(d) = loc_sol.col(d).array() * vals.det.array() * quadrature.weights.array();
+
+						const int n_loc_bases_ = int(vals.basis_values.size());
+						for (int i = 0; i < n_loc_bases_; ++i)
 						{
-							const double sol_value = (loc_sol.col(d).array() * v.val.array()).sum();
-							for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-								sol(v.global[ii].index * size_ + d) += sol_value * v.global[ii].val;
+							const AssemblyValues &v = vals.basis_values[i];
+
+							for (int d = 0; d < size_; ++d)
+							{
+								const double sol_value = (loc_sol.col(d).array() * v.val.array()).sum();
+								for (std::size_t ii = 0; ii < v.global.size(); ++ii)
+									local_storage.vec(v.global[ii].index * size_ + d) += sol_value * v.global[ii].val;
+							}
 						}
 					}
-				}
+				});
+
+				for (const LocalThreadVecStorage &local_storage : storage)
+					sol += local_storage.vec;
 
 				Eigen::MatrixXd b = sol;
 				sol.setZero();
@@ -232,14 +262,80 @@ namespace polyfem
 			}
 		}
 
-		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
-								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		struct RhsAssembler::LsqCache
 		{
-			const int n_el = int(bases_.size());
+			/// resolution, boundary nodes and primitives of the boundary set
+			std::vector<int> key;
 
-			Eigen::MatrixXd uv, samples, gtmp, rhs_fun;
-			Eigen::VectorXi global_primitive_ids;
+			/// boundary samples of one element
+			struct ElementSamples
+			{
+				int element;
+				Eigen::MatrixXd uv, samples, mapped;
+				Eigen::VectorXi global_primitive_ids;
+			};
+			std::vector<ElementSamples> elements;
+
+			/// least-squares system of one dimension, the rows are the samples which are Dirichlet in that dimension
+			struct Dimension
+			{
+				std::vector<int> indices;
+				std::vector<int> tags;
+				/// (element, sample) of every row
+				std::vector<std::pair<int, int>> rows;
+				StiffnessMatrix mat_t;
+				StiffnessMatrix A;
+				/// factorized on the first non-zero boundary condition
+				std::unique_ptr<linear::Solver> solver;
+			};
+			std::vector<Dimension> dimensions;
+		};
+
+		RhsAssembler::LsqCache &RhsAssembler::lsq_cache(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution,
+													   std::vector<Eigen::MatrixXd> &mapped) const
+		{
+			std::vector<int> key;
+			key.push_back(resolution);
+			key.push_back(bounday_nodes.size());
+			key.insert(key.end(), bounday_nodes.begin(), bounday_nodes.end());
+			for (const auto &lb : local_boundary)
+			{
+				key.push_back(lb.element_id());
+				key.push_back(lb.size());
+				for (int i = 0; i < lb.size(); ++i)
+					key.push_back(lb.global_primitive_id(i));
+			}
+
+			for (auto it = lsq_caches_.begin(); it != lsq_caches_.end(); ++it)
+			{
+				LsqCache &cache = **it;
+				if (cache.key != key)
+					continue;
+
+				// the samples are reused as long as the geometry did not move
+				bool same_geometry = true;
+				mapped.resize(cache.elements.size());
+				for (size_t i = 0; i < cache.elements.size() && same_geometry; ++i)
+				{
+					const auto &es = cache.elements[i];
+					gbases_[es.element].eval_geom_mapping(es.samples, mapped[i]);
+					same_geometry = mapped[i] == es.mapped;
+				}
 
+				if (same_geometry)
+					return cache;
+
+				lsq_caches_.erase(it);
+				break;
+			}
+
+			if (lsq_caches_.size() >= max_lsq_caches)
+				lsq_caches_.erase(lsq_caches_.begin());
+			lsq_caches_.push_back(std::make_shared<LsqCache>());
+			LsqCache &cache = *lsq_caches_.back();
+			cache.key = std::move(key);
+
+			const int n_el = int(bases_.size());
 			const int actual_dim = problem_.is_scalar() ? 1 : mesh_.dimension();
 
 			Eigen::Matrix<bool, Eigen::Dynamic, 1> is_boundary(n_basis_);
@@ -256,46 +352,54 @@ namespace polyfem
 			}
 			assert(skipped_count <= 1);
 
+			std::vector<std::vector<AssemblyValues>> vals;
+			for (const auto &lb : local_boundary)
+			{
+				LsqCache::ElementSamples es;
+				es.element = lb.element_id();
+				if (!utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, false, es.uv, es.samples, es.global_primitive_ids))
+					continue;
+				assert(es.global_primitive_ids.size() == es.samples.rows());
+
+				gbases_[es.element].eval_geom_mapping(es.samples, es.mapped);
+				vals.emplace_back();
+				bases_[es.element].evaluate_bases(es.samples, vals.back());
+				cache.elements.push_back(std::move(es));
+			}
+
+			mapped.resize(cache.elements.size());
+			for (size_t i = 0; i < cache.elements.size(); ++i)
+				mapped[i] = cache.elements[i].mapped;
+
+			cache.dimensions.resize(size_);
 			for (int d = 0; d < size_; ++d)
 			{
+				LsqCache::Dimension &dim = cache.dimensions[d];
 				int index = 0;
-				std::vector<int> indices;
-				indices.reserve(n_el * 10);
-				std::vector<int> tags;
-				tags.reserve(n_el * 10);
-
-				long total_size = 0;
+				dim.indices.reserve(n_el * 10);
+				dim.tags.reserve(n_el * 10);
 
 				Eigen::VectorXi global_index_to_col(n_basis_);
 				global_index_to_col.setConstant(-1);
 
-				std::vector<AssemblyValues> tmp_val;
-
-				for (const auto &lb : local_boundary)
+				for (size_t i = 0; i < cache.elements.size(); ++i)
 				{
-					const int e = lb.element_id();
-					bool has_samples = utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, true, uv, samples, global_primitive_ids);
-
-					if (!has_samples)
-						continue;
-
-					const basis::ElementBases &bs = bases_[e];
-					bs.evaluate_bases(samples, tmp_val);
+					const auto &es = cache.elements[i];
+					const basis::ElementBases &bs = bases_[es.element];
 					const int n_local_bases = int(bs.bases.size());
-					assert(global_primitive_ids.size() == samples.rows());
 
-					for (int s = 0; s < samples.rows(); ++s)
+					for (int s = 0; s < es.samples.rows(); ++s)
 					{
-						const int tag = mesh_.get_boundary_id(global_primitive_ids(s));
+						const int tag = mesh_.get_boundary_id(es.global_primitive_ids(s));
 						if (!problem_.all_dimensions_dirichlet() && !problem_.is_dimension_dirichet(tag, d))
 							continue;
 
-						total_size++;
+						dim.rows.emplace_back(i, s);
 
 						for (int j = 0; j < n_local_bases; ++j)
 						{
 							const basis::Basis &b = bs.bases[j];
-							const double tmp = tmp_val[j].val(s);
+							const double tmp = vals[i][j].val(s);
 
 							if (fabs(tmp) < 1e-10)
 								continue;
@@ -308,9 +412,9 @@ namespace polyfem
 									if (global_index_to_col(b.global()[ii].index) == -1)
 									{
 										global_index_to_col(b.global()[ii].index) = index++;
-										indices.push_back(b.global()[ii].index);
-										tags.push_back(tag);
-										assert(indices.size() == size_t(index));
+										dim.indices.push_back(b.global()[ii].index);
+										dim.tags.push_back(tag);
+										assert(dim.indices.size() == size_t(index));
 									}
 								}
 							}
@@ -318,103 +422,107 @@ namespace polyfem
 					}
 				}
 
-				Eigen::MatrixXd global_rhs = Eigen::MatrixXd::Zero(total_size, 1);
+				const int total_size = dim.rows.size();
+				if (total_size == 0)
+					continue;
 
-				const long buffer_size = total_size * long(indices.size());
 				std::vector<Eigen::Triplet<double>> entries, entries_t;
-
-				index = 0;
-
-				int global_counter = 0;
-				Eigen::MatrixXd mapped;
-
-				for (const auto &lb : local_boundary)
+				for (int r = 0; r < total_size; ++r)
 				{
-					const int e = lb.element_id();
-					bool has_samples = utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, false, uv, samples, global_primitive_ids);
-
-					if (!has_samples)
-						continue;
-
-					const basis::ElementBases &bs = bases_[e];
-					const basis::ElementBases &gbs = gbases_[e];
+					const auto [i, s] = dim.rows[r];
+					const basis::ElementBases &bs = bases_[cache.elements[i].element];
 					const int n_local_bases = int(bs.bases.size());
 
-					gbs.eval_geom_mapping(samples, mapped);
-
-					bs.evaluate_bases(samples, tmp_val);
-					df(global_primitive_ids, uv, mapped, rhs_fun);
-
-					for (int s = 0; s < samples.rows(); ++s)
+					for (int j = 0; j < n_local_bases; ++j)
 					{
-						const int tag = mesh_.get_boundary_id(global_primitive_ids(s));
-						if (!problem_.all_dimensions_dirichlet() && !problem_.is_dimension_dirichet(tag, d))
-							continue;
+						const basis::Basis &b = bs.bases[j];
+						const double tmp = vals[i][j].val(s);
 
-						for (int j = 0; j < n_local_bases; ++j)
+						for (std::size_t ii = 0; ii < b.global().size(); ++ii)
 						{
-							const basis::Basis &b = bs.bases[j];
-							const double tmp = tmp_val[j].val(s);
-
-							for (std::size_t ii = 0; ii < b.global().size(); ++ii)
+							auto item = global_index_to_col(b.global()[ii].index);
+							if (item != -1)
 							{
-								auto item = global_index_to_col(b.global()[ii].index);
-								if (item != -1)
-								{
-									entries.push_back(Eigen::Triplet<double>(global_counter, item, tmp * b.global()[ii].val));
-									entries_t.push_back(Eigen::Triplet<double>(item, global_counter, tmp * b.global()[ii].val));
-								}
+								entries.push_back(Eigen::Triplet<double>(r, item, tmp * b.global()[ii].val));
+								entries_t.push_back(Eigen::Triplet<double>(item, r, tmp * b.global()[ii].val));
 							}
 						}
-
-						global_rhs(global_counter) = rhs_fun(s, d);
-						global_counter++;
 					}
 				}
 
-				assert(global_counter == total_size);
+				StiffnessMatrix mat(total_size, int(dim.indices.size()));
+				mat.setFromTriplets(entries.begin(), entries.end());
 
-				if (total_size > 0)
-				{
-					const double mmin = global_rhs.minCoeff();
-					const double mmax = global_rhs.maxCoeff();
+				dim.mat_t.resize(int(dim.indices.size()), total_size);
+				dim.mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
+
+				dim.A = dim.mat_t * mat;
+			}
+
+			return cache;
+		}
+
+		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
+								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		{
+			std::lock_guard<std::mutex> lock(lsq_caches_mutex_);
+
+			// only the boundary condition is evaluated, the samples and the factorization are reused while the boundary does not change
+			std::vector<Eigen::MatrixXd> mapped;
+			LsqCache &cache = lsq_cache(local_boundary, bounday_nodes, resolution, mapped);
+
+			std::vector<Eigen::MatrixXd> rhs_fun(cache.elements.size());
+			for (size_t i = 0; i < cache.elements.size(); ++i)
+			{
+				const auto &es = cache.elements[i];
+				df(es.global_primitive_ids, es.uv, mapped[i], rhs_fun[i]);
+			}
+
+			for (int d = 0; d < size_; ++d)
+			{
+				LsqCache::Dimension &dim = cache.dimensions[d];
+				const int total_size = dim.rows.size();
+				if (total_size <= 0)
+					continue;
+
+				Eigen::VectorXd global_rhs(total_size);
+				for (int r = 0; r < total_size; ++r)
+					global_rhs(r) = rhs_fun[dim.rows[r].first](dim.rows[r].second, d);
 
-					if (fabs(mmin) < 1e-8 && fabs(mmax) < 1e-8)
+				const double mmin = global_rhs.minCoeff();
+				const double mmax = global_rhs.maxCoeff();
+
+				if (fabs(mmin) < 1e-8 && fabs(mmax) < 1e-8)
+				{
+					for (size_t i = 0; i < dim.indices.size(); ++i)
 					{
-						for (size_t i = 0; i < indices.size(); ++i)
-						{
-							const int tag = tags[i];
-							if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
-								rhs(indices[i] * size_ + d) = 0;
-						}
+						const int tag = dim.tags[i];
+						if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
+							rhs(dim.indices[i] * size_ + d) = 0;
 					}
-					else
+				}
+				else
+				{
+					if (!dim.solver)
 					{
-						StiffnessMatrix mat(int(total_size), int(indices.size()));
-						mat.setFromTriplets(entries.begin(), entries.end());
-
-						StiffnessMatrix mat_t(int(indices.size()), int(total_size));
-						mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
-
-						StiffnessMatrix A = mat_t * mat;
-						Eigen::VectorXd b = mat_t * global_rhs;
+						dim.solver = linear::Solver::create(solver_params_, logger());
+						logger().info("Solve RHS using {} linear solver", dim.solver->name());
+						dim.solver->analyze_pattern(dim.A, dim.A.rows());
+						dim.solver->factorize(dim.A);
+					}
 
-						Eigen::VectorXd coeffs(b.rows(), 1);
-						auto solver = linear::Solver::create(solver_params_, logger());
-						logger().info("Solve RHS using {} linear solver", solver->name());
-						solver->analyze_pattern(A, A.rows());
-						solver->factorize(A);
-						coeffs.setZero();
-						solver->solve(b, coeffs);
+					const Eigen::VectorXd b = dim.mat_t * global_rhs;
+					Eigen::VectorXd coeffs(b.rows(), 1);
+					coeffs.setZero();
+					dim.solver->solve(b, coeffs);
 
-						logger().trace("RHS solve error {}", (A * coeffs - b).norm());
+					logger().trace("RHS solve error {}", (dim.A * coeffs - b).norm());
 
-						for (long i = 0; i < coeffs.rows(); ++i)
-						{
-							const int tag = tags[i];
-							if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
-								rhs(indices[i] * size_ + d) = coeffs(i);
-						}
+					for (long i = 0; i < coeffs.rows(); ++i)
+					{
+						const int tag = dim.tags[i];
+						if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
+							rhs(dim.indices[i] * size_ + d) = coeffs(i);
 					}
 				}
 			}
@@ -653,24 +761,39 @@ namespace polyfem
 											const int resolution,
 											const double t) const
 		{
+			Eigen::VectorXd load;
+			compute_energy_load(displacement_prev, local_neumann_boundary, density, resolution, t, load);
+			return energy_from_load(load, displacement);
+		}
 
-			double res = 0;
+		double RhsAssembler::energy_from_load(const Eigen::VectorXd &load, const Eigen::MatrixXd &displacement)
+		{
+			assert(displacement.size() >= load.size());
+			// mixed formulations have the pressure after the displacement
+			return load.dot(Eigen::Map<const Eigen::VectorXd>(displacement.data(), load.size()));
+		}
+
+		void RhsAssembler::compute_energy_load(const Eigen::MatrixXd &displacement_prev,
+											   const std::vector<LocalBoundary> &local_neumann_boundary,
+											   const Density &density,
+											   const int resolution,
+											   const double t,
+											   Eigen::VectorXd &load) const
+		{
+			load.setZero(n_basis_ * size_);
 
 			if (!problem_.is_rhs_zero())
 			{
-				auto storage = create_thread_storage(LocalThreadScalarStorage());
+				auto storage = create_thread_storage(LocalThreadVecStorage(load.size()));
 				const int n_bases = int(bases_.size());
 
 				maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-					LocalThreadScalarStorage &local_storage = get_local_thread_storage(storage, thread_id);
-					VectorNd local_displacement(size_);
-					Eigen::MatrixXd forces;
+					LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+					Eigen::MatrixXd &forces = local_storage.rhs_fun;
 
 					for (int e = start; e < end; ++e)
 					{
-						ElementAssemblyValues &vals = local_storage.vals;
-						// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-						ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+						const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], local_storage.vals);
 
 						const Quadrature &quadrature = vals.quadrature;
 						const Eigen::VectorXd da = vals.det.array() * quadrature.weights.array();
@@ -681,40 +804,27 @@ namespace polyfem
 
 						for (long p = 0; p < da.size(); ++p)
 						{
-							local_displacement.setZero();
+							const double rho = density(vals.quadrature.points.row(p), vals.val.row(p), t, vals.element_id);
 
 							for (size_t i = 0; i < vals.basis_values.size(); ++i)
 							{
 								const auto &bs = vals.basis_values[i];
 								assert(bs.val.size() == da.size());
-								const double b_val = bs.val(p);
-
-								for (int d = 0; d < size_; ++d)
-								{
-									for (std::size_t ii = 0; ii < bs.global.size(); ++ii)
-									{
-										local_displacement(d) += (bs.global[ii].val * b_val) * displacement(bs.global[ii].index * size_ + d);
-									}
-								}
-							}
-							// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(p), vals.val.row(p), vals.element_id) : 1;
-							const double rho = density(vals.quadrature.points.row(p), vals.val.row(p), t, vals.element_id);
+								const double b_val = bs.val(p) * da(p) * rho;
 
-							for (int d = 0; d < size_; ++d)
-							{
-								local_storage.val += forces(p, d) * local_displacement(d) * da(p) * rho;
-								// res += forces(p, d) * local_displacement(d) * da(p);
+								for (std::size_t ii = 0; ii < bs.global.size(); ++ii)
+									for (int d = 0; d < size_; ++d)
+										local_storage.vec(bs.global[ii].index * size_ + d) += forces(p, d) * bs.global[ii].val * b_val;
 							}
 						}
 					}
 				});
 
 				// Serially merge local storages
-				for (const LocalThreadScalarStorage &local_storage : storage)
-					res += local_storage.val;
+				for (const LocalThreadVecStorage &local_storage : storage)
+					load += local_storage.vec;
 			}
 
-			VectorNd local_displacement(size_);
 			Eigen::MatrixXd forces;
 
 			ElementAssemblyValues vals;
@@ -725,8 +835,6 @@ namespace polyfem
 			for (const auto &lb : local_neumann_boundary)
 			{
 				const int e = lb.element_id();
-				const basis::ElementBases &gbs = gbases_[e];
-				const basis::ElementBases &bs = bases_[e];
 
 				for (int i = 0; i < lb.size(); ++i)
 				{
@@ -771,34 +879,21 @@ namespace polyfem
 					}
 					problem_.neumann_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, forces);
 
-					// UIState::ui_state().debug_data().add_points(vals.val, Eigen::RowVector3d(1,0,0));
-
 					for (long p = 0; p < weights.size(); ++p)
 					{
-						local_displacement.setZero();
-
 						for (size_t i = 0; i < vals.basis_values.size(); ++i)
 						{
 							const auto &vv = vals.basis_values[i];
 							assert(vv.val.size() == weights.size());
-							const double b_val = vv.val(p);
+							const double b_val = vv.val(p) * weights(p);
 
-							for (int d = 0; d < size_; ++d)
-							{
-								for (std::size_t ii = 0; ii < vv.global.size(); ++ii)
-								{
-									local_displacement(d) += (vv.global[ii].val * b_val) * displacement(vv.global[ii].index * size_ + d);
-								}
-							}
+							for (std::size_t ii = 0; ii < vv.global.size(); ++ii)
+								for (int d = 0; d < size_; ++d)
+									load(vv.global[ii].index * size_ + d) -= forces(p, d) * vv.global[ii].val * b_val;
 						}
-
-						for (int d = 0; d < size_; ++d)
-							res -= forces(p, d) * local_displacement(d) * weights(p);
 					}
 				}
 			}
-
-			return res;
 		}
 
 		void RhsAssembler::compute_energy_hess(
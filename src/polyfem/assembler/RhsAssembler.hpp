@@ -7,6 +7,9 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/mesh/LocalBoundary.hpp>
 
+#include <memory>
+#include <mutex>
+
 namespace polyfem
 {
 	namespace assembler
@@ -66,6 +69,17 @@ namespace polyfem
 				const Density &density,
 				const int resolution,
 				const double t) const;
+			// compute the vector l such that the body energy at displacement u is l^T u,
+			// the energy is linear in u for a fixed time and previous displacement
+			void compute_energy_load(
+				const Eigen::MatrixXd &displacement_prev,
+				const std::vector<mesh::LocalBoundary> &local_neumann_boundary,
+				const Density &density,
+				const int resolution,
+				const double t,
+				Eigen::VectorXd &load) const;
+			// body energy at displacement from its load computed with compute_energy_load
+			static double energy_from_load(const Eigen::VectorXd &load, const Eigen::MatrixXd &displacement);
 			// compute body energy gradient, hessian is zero, rhs is a linear function
 			void compute_energy_grad(
 				const std::vector<mesh::LocalBoundary> &local_boundary,
@@ -92,6 +106,12 @@ namespace polyfem
 			void lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
 						const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const;
 
+			// boundary samples and factorized least-squares operator of lsq_bc for one boundary set
+			struct LsqCache;
+			// cached least-squares data for the boundary set, (re)built if the boundary or its geometry changed
+			LsqCache &lsq_cache(const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution,
+									  std::vector<Eigen::MatrixXd> &mapped) const;
+
 			// sample bc at nodes
 			void sample_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
 						   const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, Eigen::MatrixXd &rhs) const;
@@ -125,6 +145,11 @@ namespace polyfem
 			const std::vector<RowVectorNd> &dirichlet_nodes_position_;
 			const std::vector<int> &neumann_nodes_;
 			const std::vector<RowVectorNd> &neumann_nodes_position_;
+
+			/// a few boundary sets (e.g., the Dirichlet nodes with and without the nodal conditions) are projected alternately
+			static constexpr int max_lsq_caches = 4;
+			mutable std::vector<std::shared_ptr<LsqCache>> lsq_caches_;
+			mutable std::mutex lsq_caches_mutex_;
 		};
 	} // namespace assembler
 } // namespace polyfem
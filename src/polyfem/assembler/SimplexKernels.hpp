@@ -0,0 +1,165 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <limits>
+
+// the kernels only use fixed size Eigen types and can be compiled for a device
+#define POLYFEM_HOST_DEVICE EIGEN_DEVICE_FUNC
+
+namespace polyfem
+{
+	namespace assembler
+	{
+		/// Element kernels of the elastic models on linear simplices.
+		/// The basis gradients of a P1 simplex are constant, one evaluation per element is exact.
+		/// The stress derivative is indexed with (k, l) -> k * DIM + l.
+		namespace simplex_kernels
+		{
+			enum class Model
+			{
+				LinearElasticity,
+				NeoHookean,
+				SaintVenant
+			};
+
+			template <int DIM>
+			using MatF = Eigen::Matrix<double, DIM, DIM>;
+			template <int DIM>
+			using MatDF = Eigen::Matrix<double, DIM * DIM, DIM * DIM>;
+
+			POLYFEM_HOST_DEVICE inline double kronecker(const int i, const int j) { return i == j ? 1. : 0.; }
+
+			/// energy density of the deformation gradient F
+			template <int DIM>
+			POLYFEM_HOST_DEVICE inline double energy_density(const Model model, const MatF<DIM> &F, const double mu, const double lambda)
+			{
+				switch (model)
+				{
+				case Model::LinearElasticity:
+				{
+					const MatF<DIM> eps = 0.5 * (F + F.transpose()) - MatF<DIM>::Identity();
+					return mu * (eps.transpose() * eps).trace() + lambda / 2 * eps.trace() * eps.trace();
+				}
+				case Model::NeoHookean:
+				{
+					const double J = F.determinant();
+					if (J <= 0)
+						return std::numeric_limits<double>::infinity();
+					const double log_J = std::log(J);
+					return mu / 2 * ((F.transpose() * F).trace() - DIM) - mu * log_J + lambda / 2 * log_J * log_J;
+				}
+				case Model::SaintVenant:
+				{
+					const MatF<DIM> E = 0.5 * (F.transpose() * F - MatF<DIM>::Identity());
+					return mu * (E.transpose() * E).trace() + lambda / 2 * E.trace() * E.trace();
+				}
+				}
+				return 0;
+			}
+
+			/// first Piola-Kirchhoff stress
+			template <int DIM>
+			POLYFEM_HOST_DEVICE inline MatF<DIM> stress(const Model model, const MatF<DIM> &F, const double mu, const double lambda)
+			{
+				switch (model)
+				{
+				case Model::LinearElasticity:
+				{
+					const MatF<DIM> eps = 0.5 * (F + F.transpose()) - MatF<DIM>::Identity();
+					return 2 * mu * eps + lambda * eps.trace() * MatF<DIM>::Identity();
+				}
+				case Model::NeoHookean:
+				{
+					const MatF<DIM> FinvT = F.inverse().transpose();
+					return mu * (F - FinvT) + lambda * std::log(F.determinant()) * FinvT;
+				}
+				case Model::SaintVenant:
+				{
+					const MatF<DIM> E = 0.5 * (F.transpose() * F - MatF<DIM>::Identity());
+					return F * (2 * mu * E + lambda * E.trace() * MatF<DIM>::Identity());
+				}
+				}
+				return MatF<DIM>::Zero();
+			}
+
+			/// derivative of the stress P_kl with respect to F_ij
+			template <int DIM>
+			POLYFEM_HOST_DEVICE inline MatDF<DIM> stress_derivative(const Model model, const MatF<DIM> &F, const double mu, const double lambda)
+			{
+				MatDF<DIM> dP;
+				switch (model)
+				{
+				case Model::LinearElasticity:
+				{
+					for (int k = 0; k < DIM; ++k)
+						for (int l = 0; l < DIM; ++l)
+							for (int i = 0; i < DIM; ++i)
+								for (int j = 0; j < DIM; ++j)
+									dP(k * DIM + l, i * DIM + j) = mu * (kronecker(k, i) * kronecker(l, j) + kronecker(k, j) * kronecker(l, i)) + lambda * kronecker(k, l) * kronecker(i, j);
+					break;
+				}
+				case Model::NeoHookean:
+				{
+					const MatF<DIM> FinvT = F.inverse().transpose();
+					const double c = mu - lambda * std::log(F.determinant());
+					for (int k = 0; k < DIM; ++k)
+						for (int l = 0; l < DIM; ++l)
+							for (int i = 0; i < DIM; ++i)
+								for (int j = 0; j < DIM; ++j)
+									dP(k * DIM + l, i * DIM + j) = mu * kronecker(k, i) * kronecker(l, j) + c * FinvT(k, j) * FinvT(i, l) + lambda * FinvT(k, l) * FinvT(i, j);
+					break;
+				}
+				case Model::SaintVenant:
+				{
+					const MatF<DIM> E = 0.5 * (F.transpose() * F - MatF<DIM>::Identity());
+					const MatF<DIM> S = 2 * mu * E + lambda * E.trace() * MatF<DIM>::Identity();
+					const MatF<DIM> FFt = F * F.transpose();
+					for (int k = 0; k < DIM; ++k)
+						for (int l = 0; l < DIM; ++l)
+							for (int i = 0; i < DIM; ++i)
+								for (int j = 0; j < DIM; ++j)
+									dP(k * DIM + l, i * DIM + j) = kronecker(k, i) * S(j, l) + mu * (F(k, j) * F(i, l) + FFt(k, i) * kronecker(l, j)) + lambda * F(k, l) * F(i, j);
+					break;
+				}
+				}
+				return dP;
+			}
+
+			/// deformation gradient of a P1 simplex
+			/// @param[in] G basis gradients, one row per node
+			/// @param[in] U nodal displacements, one row per node
+			template <int DIM>
+			POLYFEM_HOST_DEVICE inline MatF<DIM> deformation_gradient(const Eigen::Matrix<double, DIM + 1, DIM> &G, const Eigen::Matrix<double, DIM + 1, DIM> &U)
+			{
+				return MatF<DIM>::Identity() + U.transpose() * G;
+			}
+
+			/// element gradient with respect to the nodal displacements, dof (a, k) -> a * DIM + k
+			template <int DIM>
+			POLYFEM_HOST_DEVICE inline Eigen::Matrix<double, (DIM + 1) * DIM, 1> element_gradient(const Eigen::Matrix<double, DIM + 1, DIM> &G, const double volume, const MatF<DIM> &P)
+			{
+				Eigen::Matrix<double, (DIM + 1) * DIM, 1> grad;
+				const Eigen::Matrix<double, DIM + 1, DIM> GP = G * P.transpose();
+				for (int a = 0; a <= DIM; ++a)
+					for (int k = 0; k < DIM; ++k)
+						grad(a * DIM + k) = volume * GP(a, k);
+				return grad;
+			}
+
+			/// element hessian with respect to the nodal displacements, dof (a, k) -> a * DIM + k
+			template <int DIM>
+			POLYFEM_HOST_DEVICE inline Eigen::Matrix<double, (DIM + 1) * DIM, (DIM + 1) * DIM> element_hessian(const Eigen::Matrix<double, DIM + 1, DIM> &G, const double volume, const MatDF<DIM> &dP)
+			{
+				// dF_kl / du_ak = G_al
+				Eigen::Matrix<double, DIM * DIM, (DIM + 1) * DIM> dF = Eigen::Matrix<double, DIM * DIM, (DIM + 1) * DIM>::Zero();
+				for (int a = 0; a <= DIM; ++a)
+					for (int k = 0; k < DIM; ++k)
+						for (int l = 0; l < DIM; ++l)
+							dF(k * DIM + l, a * DIM + k) = G(a, l);
+				return volume * dF.transpose() * dP * dF;
+			}
+		} // namespace simplex_kernels
+	} // namespace assembler
+} // namespace polyfem
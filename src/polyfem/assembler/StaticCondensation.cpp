@@ -0,0 +1,266 @@
+#include "StaticCondensation.hpp"
+
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+
+namespace polyfem::assembler
+{
+	namespace
+	{
+		class LocalThreadStorage
+		{
+		public:
+			std::vector<Eigen::Triplet<double>> triplets;
+			Eigen::VectorXd rhs;
+			bool singular = false;
+
+			LocalThreadStorage(const int size)
+			{
+				rhs.setZero(size);
+			}
+		};
+
+		/// element using each node, -2 if the node is shared (or not conforming)
+		std::vector<int> node_owners(const std::vector<basis::ElementBases> &bases, const int n_bases)
+		{
+			std::vector<int> owner(n_bases, -1);
+			for (int e = 0; e < bases.size(); ++e)
+			{
+				for (const basis::Basis &b : bases[e].bases)
+				{
+					const bool conforming = b.global().size() == 1;
+					for (const basis::Local2Global &g : b.global())
+					{
+						int &o = owner[g.index];
+						o = (conforming && (o == -1 || o == e)) ? e : -2;
+					}
+				}
+			}
+			return owner;
+		}
+
+		int local_index(const std::vector<int> &sorted, const int i)
+		{
+			const auto it = std::lower_bound(sorted.begin(), sorted.end(), i);
+			return (it != sorted.end() && *it == i) ? int(it - sorted.begin()) : -1;
+		}
+	} // namespace
+
+	StaticCondensation::StaticCondensation(const std::vector<basis::ElementBases> &bases, const int n_bases, const int dim, const std::vector<int> &boundary_nodes)
+	{
+		const std::vector<int> owner = node_owners(bases, n_bases);
+
+		std::vector<int> dof_owner(n_bases * dim);
+		for (int n = 0; n < n_bases; ++n)
+			for (int d = 0; d < dim; ++d)
+				dof_owner[n * dim + d] = owner[n];
+
+		build(dof_owner, bases.size(), boundary_nodes);
+	}
+
+	StaticCondensation::StaticCondensation(const std::vector<basis::ElementBases> &bases, const int n_bases, const int dim,
+										   const std::vector<basis::ElementBases> &pressure_bases, const int n_pressure_bases,
+										   const int ndof, const std::vector<int> &boundary_nodes)
+	{
+		assert(ndof >= n_bases * dim + n_pressure_bases);
+		assert(pressure_bases.size() == bases.size());
+
+		const std::vector<int> owner = node_owners(bases, n_bases);
+		const std::vector<int> pressure_owner = node_owners(pressure_bases, n_pressure_bases);
+
+		std::vector<int> dof_owner(ndof, -2);
+		for (int n = 0; n < n_bases; ++n)
+			for (int d = 0; d < dim; ++d)
+				dof_owner[n * dim + d] = owner[n];
+		for (int n = 0; n < n_pressure_bases; ++n)
+			dof_owner[n_bases * dim + n] = pressure_owner[n];
+
+		build(dof_owner, bases.size(), boundary_nodes);
+	}
+
+	void StaticCondensation::build(const std::vector<int> &dof_owner, const int n_elements, const std::vector<int> &boundary_nodes)
+	{
+		const int ndof = dof_owner.size();
+
+		is_boundary_.assign(ndof, false);
+		for (const int i : boundary_nodes)
+			is_boundary_[i] = true;
+
+		std::vector<std::vector<int>> interior(n_elements);
+		full_to_skeleton_.assign(ndof, -1);
+		for (int i = 0; i < ndof; ++i)
+		{
+			if (dof_owner[i] >= 0 && !is_boundary_[i])
+				interior[dof_owner[i]].push_back(i);
+			else
+			{
+				full_to_skeleton_[i] = skeleton_to_full_.size();
+				skeleton_to_full_.push_back(i);
+			}
+		}
+		skeleton_size_ = skeleton_to_full_.size();
+
+		for (std::vector<int> &dofs : interior)
+		{
+			if (dofs.empty())
+				continue;
+			blocks_.emplace_back();
+			blocks_.back().interior = std::move(dofs);
+		}
+
+		logger().debug("Static condensation: {} interior dofs in {} elements, {} skeleton dofs", ndof - skeleton_size_, blocks_.size(), skeleton_size_);
+	}
+
+	void StaticCondensation::condense(const StiffnessMatrix &A, const Eigen::VectorXd &b, StiffnessMatrix &S, Eigen::VectorXd &bs)
+	{
+		assert(A.rows() == full_size() && A.cols() == full_size());
+		assert(b.size() == full_size());
+
+		// rows of the interior dofs give the interior and interior-skeleton blocks, columns the skeleton-interior one
+		const Eigen::SparseMatrix<double, Eigen::RowMajor> A_rows = A;
+
+		auto storage = utils::create_thread_storage(LocalThreadStorage(skeleton_size_));
+
+		utils::maybe_parallel_for(blocks_.size(), [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+
+			for (int k = start; k < end; ++k)
+			{
+				ElementBlock &block = blocks_[k];
+				const std::vector<int> &interior = block.interior;
+				const int ni = interior.size();
+
+				std::vector<int> &skeleton = block.skeleton;
+				skeleton.clear();
+				for (const int i : interior)
+					for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(A_rows, i); it; ++it)
+						if (full_to_skeleton_[it.col()] >= 0)
+							skeleton.push_back(full_to_skeleton_[it.col()]);
+				std::sort(skeleton.begin(), skeleton.end());
+				skeleton.erase(std::unique(skeleton.begin(), skeleton.end()), skeleton.end());
+				const int ns = skeleton.size();
+
+				Eigen::MatrixXd A_ii = Eigen::MatrixXd::Zero(ni, ni);
+				block.A_is.setZero(ni, ns);
+				Eigen::MatrixXd A_si = Eigen::MatrixXd::Zero(ns, ni);
+				block.b_i.resize(ni);
+
+				for (int li = 0; li < ni; ++li)
+				{
+					const int i = interior[li];
+					block.b_i[li] = b[i];
+
+					for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(A_rows, i); it; ++it)
+					{
+						const int s = full_to_skeleton_[it.col()];
+						if (s >= 0)
+							block.A_is(li, local_index(skeleton, s)) = it.value();
+						else
+						{
+							const int lj = local_index(interior, it.col());
+							assert(lj >= 0); // interior dofs only couple within their element
+							A_ii(li, lj) = it.value();
+						}
+					}
+
+					for (StiffnessMatrix::InnerIterator it(A, i); it; ++it)
+					{
+						const int s = full_to_skeleton_[it.row()];
+						if (s < 0)
+							continue;
+						const int ls = local_index(skeleton, s);
+						assert(ls >= 0); // the pattern must be symmetric
+						if (ls >= 0)
+							A_si(ls, li) = it.value();
+					}
+				}
+
+				block.lu.compute(A_ii);
+				// e.g., a pressure bubble without velocity bubble in a Stokes element
+				if (block.lu.rcond() < 1e-14)
+					local_storage.singular = true;
+
+				const Eigen::MatrixXd schur = A_si * block.lu.solve(block.A_is);
+				const Eigen::VectorXd rhs = A_si * block.lu.solve(block.b_i);
+				for (int a = 0; a < ns; ++a)
+				{
+					local_storage.rhs[skeleton[a]] += rhs[a];
+					for (int c = 0; c < ns; ++c)
+						local_storage.triplets.emplace_back(skeleton[a], skeleton[c], -schur(a, c));
+				}
+			}
+		});
+
+		for (const LocalThreadStorage &local_storage : storage)
+			if (local_storage.singular)
+				log_and_throw_error("Static condensation failed, the interior block of an element is singular!");
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (int k = 0; k < A.outerSize(); ++k)
+		{
+			if (full_to_skeleton_[k] < 0)
+				continue;
+			for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+				if (full_to_skeleton_[it.row()] >= 0)
+					triplets.emplace_back(full_to_skeleton_[it.row()], full_to_skeleton_[k], it.value());
+		}
+
+		bs.resize(skeleton_size_);
+		for (int s = 0; s < skeleton_size_; ++s)
+			bs[s] = b[skeleton_to_full_[s]];
+
+		for (const LocalThreadStorage &local_storage : storage)
+		{
+			triplets.insert(triplets.end(), local_storage.triplets.begin(), local_storage.triplets.end());
+			for (int s = 0; s < skeleton_size_; ++s)
+			{
+				// the Dirichlet entries hold the boundary values
+				if (!is_boundary_[skeleton_to_full_[s]])
+					bs[s] -= local_storage.rhs[s];
+			}
+		}
+
+		S.resize(skeleton_size_, skeleton_size_);
+		S.setFromTriplets(triplets.begin(), triplets.end());
+		S.makeCompressed();
+	}
+
+	void StaticCondensation::expand(const Eigen::VectorXd &xs, Eigen::VectorXd &x) const
+	{
+		assert(xs.size() == skeleton_size_);
+
+		x.resize(full_size());
+		for (int s = 0; s < skeleton_size_; ++s)
+			x[skeleton_to_full_[s]] = xs[s];
+
+		utils::maybe_parallel_for(blocks_.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
+			{
+				const ElementBlock &block = blocks_[k];
+				assert(block.b_i.size() == block.interior.size()); // condense must be called first
+
+				Eigen::VectorXd xs_local(block.skeleton.size());
+				for (int a = 0; a < block.skeleton.size(); ++a)
+					xs_local[a] = xs[block.skeleton[a]];
+
+				const Eigen::VectorXd x_i = block.lu.solve(block.b_i - block.A_is * xs_local);
+				for (int li = 0; li < block.interior.size(); ++li)
+					x[block.interior[li]] = x_i[li];
+			}
+		});
+	}
+
+	std::vector<int> StaticCondensation::to_skeleton(const std::vector<int> &full_dofs) const
+	{
+		std::vector<int> skeleton_dofs;
+		skeleton_dofs.reserve(full_dofs.size());
+		for (const int i : full_dofs)
+		{
+			assert(full_to_skeleton_[i] >= 0);
+			skeleton_dofs.push_back(full_to_skeleton_[i]);
+		}
+		return skeleton_dofs;
+	}
+} // namespace polyfem::assembler
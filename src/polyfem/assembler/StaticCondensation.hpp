@@ -0,0 +1,85 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem::assembler
+{
+	/// Static condensation of the element-interior dofs of a linear system.
+	/// A node used by a single element (e.g., the bubbles of P3+ and Q2+ bases) only couples with the dofs of that element,
+	/// so the interior block of the matrix is block diagonal and can be eliminated element by element.
+	/// The global solve is then done on the smaller skeleton (Schur complement) system.
+	class StaticCondensation
+	{
+	public:
+		/// @brief Find the interior dofs of each element.
+		/// @param[in] bases Bases of the discretization
+		/// @param[in] n_bases Number of nodes
+		/// @param[in] dim Number of components per node
+		/// @param[in] boundary_nodes Dirichlet dofs, they are always kept in the skeleton
+		StaticCondensation(const std::vector<basis::ElementBases> &bases, const int n_bases, const int dim, const std::vector<int> &boundary_nodes);
+
+		/// @brief Find the interior dofs of each element of a mixed system ordered as in AssemblerUtils::merge_mixed_matrices.
+		/// The pressure nodes used by a single element (bubbles or discontinuous pressures) are condensed together with the
+		/// interior velocity nodes of the element, the dofs after the pressure ones (average pressure) stay in the skeleton.
+		/// @param[in] bases Bases of the velocity/displacement
+		/// @param[in] n_bases Number of velocity nodes
+		/// @param[in] dim Number of components per velocity node
+		/// @param[in] pressure_bases Bases of the pressure
+		/// @param[in] n_pressure_bases Number of pressure nodes
+		/// @param[in] ndof Size of the mixed system
+		/// @param[in] boundary_nodes Dirichlet dofs, they are always kept in the skeleton
+		StaticCondensation(const std::vector<basis::ElementBases> &bases, const int n_bases, const int dim,
+						   const std::vector<basis::ElementBases> &pressure_bases, const int n_pressure_bases,
+						   const int ndof, const std::vector<int> &boundary_nodes);
+
+		/// @brief Number of dofs of the full system
+		int full_size() const { return full_to_skeleton_.size(); }
+		/// @brief Number of dofs of the skeleton system
+		int skeleton_size() const { return skeleton_size_; }
+		/// @brief If there is nothing to condense
+		bool empty() const { return skeleton_size_ == full_size(); }
+
+		/// @brief Eliminate the interior dofs from A x = b.
+		/// @param[in] A Full (symmetric pattern) system matrix
+		/// @param[in] b Full right-hand side, the Dirichlet entries hold the boundary values and are kept as they are
+		/// @param[out] S Skeleton system matrix
+		/// @param[out] bs Skeleton right-hand side
+		void condense(const StiffnessMatrix &A, const Eigen::VectorXd &b, StiffnessMatrix &S, Eigen::VectorXd &bs);
+
+		/// @brief Recover the full solution by back-substitution of the interior dofs.
+		/// @param[in] xs Solution of the skeleton system
+		/// @param[out] x Full solution
+		void expand(const Eigen::VectorXd &xs, Eigen::VectorXd &x) const;
+
+		/// @brief Map full dofs to the skeleton numbering (e.g., the Dirichlet dofs)
+		std::vector<int> to_skeleton(const std::vector<int> &full_dofs) const;
+
+	private:
+		/// @brief Split the dofs in interior and skeleton ones
+		/// @param[in] dof_owner Element using each dof, negative if it is shared
+		/// @param[in] n_elements Number of elements
+		/// @param[in] boundary_nodes Dirichlet dofs
+		void build(const std::vector<int> &dof_owner, const int n_elements, const std::vector<int> &boundary_nodes);
+
+		struct ElementBlock
+		{
+			std::vector<int> interior;          ///< full interior dofs
+			std::vector<int> skeleton;          ///< skeleton indices of the coupled dofs
+			Eigen::PartialPivLU<Eigen::MatrixXd> lu; ///< factorization of the interior block
+			Eigen::MatrixXd A_is;               ///< interior-skeleton coupling
+			Eigen::VectorXd b_i;                ///< interior right-hand side
+		};
+
+		std::vector<int> full_to_skeleton_; ///< skeleton index of each dof, -1 for the interior ones
+		std::vector<int> skeleton_to_full_;
+		std::vector<bool> is_boundary_;
+		int skeleton_size_ = 0;
+
+		std::vector<ElementBlock> blocks_;
+	};
+} // namespace polyfem::assembler
@@ -84,4 +84,33 @@ namespace polyfem::assembler
 
 		return res;
 	}
+
+	void StokesMixed::assemble_local(
+		const ElementAssemblyValues &psi_vals,
+		const ElementAssemblyValues &phi_vals,
+		const double t,
+		const QuadratureVector &da,
+		Eigen::MatrixXd &local) const
+	{
+		// all the (i, j) pairs at once, local = -gradphi^T * diag(da) * psi
+		const int n_pts = da.size();
+		const int n_phi_loc_bases = int(phi_vals.basis_values.size());
+		const int n_psi_loc_bases = int(psi_vals.basis_values.size());
+
+		Eigen::MatrixXd gradphi(n_pts, n_phi_loc_bases * rows());
+		for (int j = 0; j < n_phi_loc_bases; ++j)
+		{
+			assert(phi_vals.basis_values[j].grad_t_m.rows() == n_pts && phi_vals.basis_values[j].grad_t_m.cols() == rows());
+			gradphi.middleCols(j * rows(), rows()) = phi_vals.basis_values[j].grad_t_m;
+		}
+
+		Eigen::MatrixXd psi(n_pts, n_psi_loc_bases);
+		for (int i = 0; i < n_psi_loc_bases; ++i)
+		{
+			assert(psi_vals.basis_values[i].val.size() == n_pts);
+			psi.col(i) = psi_vals.basis_values[i].val.col(0).cwiseProduct(da);
+		}
+
+		local.noalias() = -gradphi.transpose() * psi;
+	}
 } // namespace polyfem::assembler
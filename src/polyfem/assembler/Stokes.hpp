@@ -44,6 +44,14 @@ namespace polyfem::assembler
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
 		assemble(const MixedAssemblerData &data) const override;
 
+		// whole local block with one product instead of a call per basis pair
+		void assemble_local(
+			const ElementAssemblyValues &psi_vals,
+			const ElementAssemblyValues &phi_vals,
+			const double t,
+			const QuadratureVector &da,
+			Eigen::MatrixXd &local) const override;
+
 		inline int rows() const override { return size(); }
 		inline int cols() const override { return 1; }
 	};
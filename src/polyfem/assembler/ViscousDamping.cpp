@@ -69,15 +69,10 @@ namespace polyfem::assembler
 			damping_params_[1] = params["phi"];
 	}
 
-	// E := 0.5(F^T F - I), Compute \int F * (2\psi dE/dt + \phi Tr(dE/dt) I) : gradv du
-	Eigen::VectorXd
-	ViscousDampingPrev::assemble_gradient(const NonLinearAssemblerData &data) const
+	void ViscousDamping::local_displacement_velocity(const NonLinearAssemblerData &data, Eigen::MatrixXd &local_disp, Eigen::MatrixXd &local_vel) const
 	{
-		if (data.x_prev.size() != data.x.size())
-			return Eigen::VectorXd::Zero(data.vals.basis_values.size() * size());
-		Eigen::MatrixXd local_disp;
 		local_disp.setZero(data.vals.basis_values.size(), size());
-		Eigen::MatrixXd local_prev_disp = local_disp;
+		local_vel.setZero(data.vals.basis_values.size(), size());
 		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
 		{
 			const auto &bs = data.vals.basis_values[i];
@@ -85,39 +80,59 @@ namespace polyfem::assembler
 			{
 				for (int d = 0; d < size(); ++d)
 				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
+					const int index = bs.global[ii].index * size() + d;
+					local_disp(i, d) += bs.global[ii].val * data.x(index);
+					local_vel(i, d) += bs.global[ii].val * (data.x(index) - data.x_prev(index));
 				}
 			}
 		}
+		local_vel /= data.dt;
+	}
+
+	void ViscousDamping::def_grad_and_rate(const NonLinearAssemblerData &data, const Eigen::MatrixXd &local_disp, const Eigen::MatrixXd &local_vel, const long p, Eigen::MatrixXd &delF_delU, Eigen::MatrixXd &def_grad, Eigen::MatrixXd &dFdt) const
+	{
+		delF_delU.resize(data.vals.basis_values.size(), size());
+		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+			delF_delU.row(i) = data.vals.basis_values[i].grad.row(p);
+		delF_delU = delF_delU * data.vals.jac_it[p];
+
+		def_grad = local_disp.transpose() * delF_delU + Eigen::MatrixXd::Identity(size(), size());
+		// F - F_prev is linear in the displacement, the previous deformation gradient is never formed
+		dFdt = local_vel.transpose() * delF_delU;
+	}
+
+	Eigen::MatrixXd ViscousDamping::delF_delU_tensor(const Eigen::MatrixXd &delF_delU) const
+	{
+		// column i * size + j is vec(e_j delF_delU.row(i)), vec being column major
+		Eigen::MatrixXd tensor = Eigen::MatrixXd::Zero(size() * size(), delF_delU.size());
+		for (long i = 0; i < delF_delU.rows(); ++i)
+			for (int j = 0; j < size(); ++j)
+				for (int c = 0; c < size(); ++c)
+					tensor(j + c * size(), i * size() + j) = delF_delU(i, c);
+		return tensor;
+	}
+
+	// E := 0.5(F^T F - I), Compute \int F * (2\psi dE/dt + \phi Tr(dE/dt) I) : gradv du
+	Eigen::VectorXd
+	ViscousDampingPrev::assemble_gradient(const NonLinearAssemblerData &data) const
+	{
+		if (data.x_prev.size() != data.x.size())
+			return Eigen::VectorXd::Zero(data.vals.basis_values.size() * size());
+		Eigen::MatrixXd local_disp, local_vel;
+		local_displacement_velocity(data, local_disp, local_vel);
 
 		Eigen::MatrixXd G;
 		G.setZero(data.vals.basis_values.size(), size());
 
 		const int n_pts = data.da.size();
 
-		Eigen::MatrixXd def_grad(size(), size()), prev_def_grad(size(), size());
+		Eigen::MatrixXd delF_delU, def_grad, dFdt;
 		for (long p = 0; p < n_pts; ++p)
 		{
-			def_grad.setZero();
-			prev_def_grad.setZero();
-
-			Eigen::MatrixXd grad(data.vals.basis_values.size(), size());
-
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
-
-			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
-
-			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-
-			Eigen::MatrixXd delF_delU = grad * jac_it;
+			def_grad_and_rate(data, local_disp, local_vel, p, delF_delU, def_grad, dFdt);
 
 			Eigen::MatrixXd dRdF, dRdFdot;
-			compute_stress_aux(def_grad, (def_grad - prev_def_grad) / data.dt, dRdF, dRdFdot);
+			compute_stress_aux(def_grad, dFdt, dRdF, dRdFdot);
 
 			G += delF_delU * (dRdFdot / (-data.dt)) * data.da(p);
 		}
@@ -135,49 +150,19 @@ namespace polyfem::assembler
 	{
 		if (data.x_prev.size() != data.x.size())
 			return Eigen::VectorXd::Zero(data.vals.basis_values.size() * size());
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, local_vel;
+		local_displacement_velocity(data, local_disp, local_vel);
 
 		Eigen::MatrixXd G;
 		G.setZero(data.vals.basis_values.size(), size());
 
 		const int n_pts = data.da.size();
 
-		Eigen::MatrixXd def_grad(size(), size()), prev_def_grad(size(), size());
+		Eigen::MatrixXd delF_delU, def_grad, dFdt;
 		for (long p = 0; p < n_pts; ++p)
 		{
-			def_grad.setZero();
-			prev_def_grad.setZero();
-
-			Eigen::MatrixXd grad(data.vals.basis_values.size(), size());
-
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
-
-			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
+			def_grad_and_rate(data, local_disp, local_vel, p, delF_delU, def_grad, dFdt);
 
-			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-
-			Eigen::MatrixXd delF_delU = grad * jac_it;
-			auto dFdt = (def_grad - prev_def_grad) / data.dt;
-
-			Eigen::MatrixXd dRdF, dRdFdot;
 			Eigen::MatrixXd dEdt = 0.5 * (dFdt.transpose() * def_grad + def_grad.transpose() * dFdt);
 			Eigen::MatrixXd tmp = 2 * damping_params_[0] * dEdt + damping_params_[1] * dEdt.trace() * Eigen::MatrixXd::Identity(size(), size());
 
@@ -199,42 +184,17 @@ namespace polyfem::assembler
 		hessian.setZero(data.vals.basis_values.size() * size(), data.vals.basis_values.size() * size());
 		if (data.x_prev.size() != data.x.size())
 			return hessian;
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, local_vel;
+		local_displacement_velocity(data, local_disp, local_vel);
 
 		const int n_pts = data.da.size();
 
-		Eigen::MatrixXd def_grad(size(), size()), prev_def_grad(size(), size());
+		Eigen::MatrixXd delF_delU, def_grad, dFdt;
 		Eigen::MatrixXd d2RdF2, d2RdFdFdot, d2RdFdot2;
 		Eigen::MatrixXd hessian_temp, hessian_temp2;
 		for (long p = 0; p < n_pts; ++p)
 		{
-			Eigen::MatrixXd grad(data.vals.basis_values.size(), size());
-
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
-
-			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
-
-			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-
-			Eigen::MatrixXd dFdt = (def_grad - prev_def_grad) / data.dt;
+			def_grad_and_rate(data, local_disp, local_vel, p, delF_delU, def_grad, dFdt);
 			compute_stress_grad_aux(def_grad, dFdt, d2RdF2, d2RdFdFdot, d2RdFdot2);
 
 			hessian_temp = d2RdF2 + (1. / data.dt) * (d2RdFdFdot + d2RdFdFdot.transpose()) + (1. / data.dt / data.dt) * d2RdFdot2;
@@ -245,22 +205,8 @@ namespace polyfem::assembler
 						for (int l = 0; l < size(); l++)
 							hessian_temp(i + j * size(), k + l * size()) = hessian_temp2(i * size() + j, k * size() + l);
 
-			Eigen::MatrixXd delF_delU_tensor(jac_it.size(), grad.size());
-
-			for (size_t i = 0; i < local_disp.rows(); ++i)
-			{
-				for (size_t j = 0; j < local_disp.cols(); ++j)
-				{
-					Eigen::MatrixXd temp;
-					temp.setZero(size(), size());
-					temp.row(j) = grad.row(i);
-					temp = temp * jac_it;
-					Eigen::VectorXd temp_flattened(Eigen::Map<Eigen::VectorXd>(temp.data(), temp.size()));
-					delF_delU_tensor.col(i * size() + j) = temp_flattened;
-				}
-			}
-
-			hessian += delF_delU_tensor.transpose() * hessian_temp * delF_delU_tensor * data.da(p);
+			const Eigen::MatrixXd dF_dU = delF_delU_tensor(delF_delU);
+			hessian += dF_dU.transpose() * hessian_temp * dF_dU * data.da(p);
 		}
 
 		return hessian;
@@ -274,44 +220,16 @@ namespace polyfem::assembler
 		stress_grad_Ut.setZero(data.vals.basis_values.size() * size(), data.vals.basis_values.size() * size());
 		if (data.x_prev.size() != data.x.size())
 			return stress_grad_Ut;
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, local_vel;
+		local_displacement_velocity(data, local_disp, local_vel);
 
 		const int n_pts = data.da.size();
 
-		Eigen::MatrixXd def_grad(size(), size()), prev_def_grad(size(), size());
+		Eigen::MatrixXd delF_delU, def_grad, dFdt;
+		Eigen::MatrixXd d2RdF2, d2RdFdFdot, d2RdFdot2;
 		for (long p = 0; p < n_pts; ++p)
 		{
-			def_grad.setZero();
-			prev_def_grad.setZero();
-
-			Eigen::MatrixXd grad(data.vals.basis_values.size(), size());
-
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
-
-			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
-
-			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-
-			Eigen::MatrixXd d2RdF2, d2RdFdFdot, d2RdFdot2;
-			Eigen::MatrixXd dFdt = (def_grad - prev_def_grad) / data.dt;
+			def_grad_and_rate(data, local_disp, local_vel, p, delF_delU, def_grad, dFdt);
 			compute_stress_grad_aux(def_grad, dFdt, d2RdF2, d2RdFdFdot, d2RdFdot2);
 
 			Eigen::MatrixXd stress_grad_Ut_temp = -(1. / data.dt) * d2RdFdFdot - (1. / data.dt / data.dt) * d2RdFdot2;
@@ -322,22 +240,8 @@ namespace polyfem::assembler
 						for (int l = 0; l < size(); l++)
 							stress_grad_Ut_temp(i + j * size(), k + l * size()) = stress_grad_Ut_temp2(i * size() + j, k * size() + l);
 
-			Eigen::MatrixXd delF_delU_tensor(jac_it.size(), grad.size());
-
-			for (size_t i = 0; i < local_disp.rows(); ++i)
-			{
-				for (size_t j = 0; j < local_disp.cols(); ++j)
-				{
-					Eigen::MatrixXd temp;
-					temp.setZero(size(), size());
-					temp.row(j) = grad.row(i);
-					temp = temp * jac_it;
-					Eigen::VectorXd temp_flattened(Eigen::Map<Eigen::VectorXd>(temp.data(), temp.size()));
-					delF_delU_tensor.col(i * size() + j) = temp_flattened;
-				}
-			}
-
-			stress_grad_Ut += delF_delU_tensor.transpose() * stress_grad_Ut_temp * delF_delU_tensor * data.da(p);
+			const Eigen::MatrixXd dF_dU = delF_delU_tensor(delF_delU);
+			stress_grad_Ut += dF_dU.transpose() * stress_grad_Ut_temp * dF_dU * data.da(p);
 		}
 
 		return stress_grad_Ut;
@@ -346,55 +250,19 @@ namespace polyfem::assembler
 	// E := 0.5(F^T F - I), Compute Energy = \int \psi \| \frac{\partial E}{\partial t} \|^2 + 0.5 \phi (Tr(\frac{\partial E}{\partial t}))^2 du
 	double ViscousDamping::compute_energy(const NonLinearAssemblerData &data) const
 	{
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
 		if (data.x_prev.size() != data.x.size())
 			return 0;
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, local_vel;
+		local_displacement_velocity(data, local_disp, local_vel);
 
 		double energy = 0;
 		const int n_pts = data.da.size();
 
-		Eigen::MatrixXd def_grad(size(), size()), prev_def_grad(size(), size());
+		Eigen::MatrixXd delF_delU, def_grad, dFdt;
 		for (long p = 0; p < n_pts; ++p)
 		{
-			def_grad.setZero();
-			prev_def_grad.setZero();
-
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				const auto &bs = data.vals.basis_values[i];
-
-				for (int d = 0; d < size(); ++d)
-				{
-					for (int c = 0; c < size(); ++c)
-					{
-						def_grad(d, c) += bs.grad(p, c) * local_disp(i, d);
-						prev_def_grad(d, c) += bs.grad(p, c) * local_prev_disp(i, d);
-					}
-				}
-			}
-
-			Eigen::MatrixXd jac_it(size(), size());
-			for (long k = 0; k < jac_it.size(); ++k)
-				jac_it(k) = data.vals.jac_it[p](k);
-
-			def_grad = def_grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = prev_def_grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
+			def_grad_and_rate(data, local_disp, local_vel, p, delF_delU, def_grad, dFdt);
 
-			Eigen::MatrixXd dFdt = (def_grad - prev_def_grad) / data.dt;
 			Eigen::MatrixXd dEdt = 0.5 * (dFdt.transpose() * def_grad + def_grad.transpose() * dFdt);
 
 			double val = damping_params_[0] * dEdt.squaredNorm() + 0.5 * damping_params_[1] * pow(dEdt.trace(), 2);
@@ -61,6 +61,13 @@ namespace polyfem
 
 			void compute_stress_aux(const Eigen::MatrixXd &F, const Eigen::MatrixXd &dFdt, Eigen::MatrixXd &dRdF, Eigen::MatrixXd &dRdFdot) const;
 			void compute_stress_grad_aux(const Eigen::MatrixXd &F, const Eigen::MatrixXd &dFdt, Eigen::MatrixXd &d2RdF2, Eigen::MatrixXd &d2RdFdFdot, Eigen::MatrixXd &d2RdFdot2) const;
+
+			// local displacement and velocity (x - x_prev) / dt of the element nodes, gathered together
+			void local_displacement_velocity(const NonLinearAssemblerData &data, Eigen::MatrixXd &local_disp, Eigen::MatrixXd &local_vel) const;
+			// gradient of the bases at the quadrature point p, deformation gradient, and its rate
+			void def_grad_and_rate(const NonLinearAssemblerData &data, const Eigen::MatrixXd &local_disp, const Eigen::MatrixXd &local_vel, const long p, Eigen::MatrixXd &delF_delU, Eigen::MatrixXd &def_grad, Eigen::MatrixXd &dFdt) const;
+			// derivative of vec(F) wrt the local dofs
+			Eigen::MatrixXd delF_delU_tensor(const Eigen::MatrixXd &delF_delU) const;
 		};
 
 		class ViscousDampingPrev : public ViscousDamping
@@ -0,0 +1,813 @@
+#include "auto_p_bases_batched.hpp"
+
+
+namespace polyfem {
+namespace autogen {
+namespace {
+void p_0_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 1);
+{val.col(0).array().setOnes();}
+}
+void p_0_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 2);
+{val.col(0).array().setZero();}
+{val.col(1).array().setZero();}
+}
+
+
+void p_1_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 3);
+{val.col(0).array() = -x - y + 1;}
+{val.col(1).array() = x;}
+{val.col(2).array() = y;}
+}
+void p_1_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 6);
+{val.col(0).array().setConstant(-1);}
+{val.col(1).array().setConstant(-1);}
+{val.col(2).array().setOnes();}
+{val.col(3).array().setZero();}
+{val.col(4).array().setZero();}
+{val.col(5).array().setOnes();}
+}
+
+
+void p_2_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 6);
+{val.col(0).array() = (x + y - 1) * (2 * x + 2 * y - 1);}
+{val.col(1).array() = x * (2 * x - 1);}
+{val.col(2).array() = y * (2 * y - 1);}
+{val.col(3).array() = -4 * x * (x + y - 1);}
+{val.col(4).array() = 4 * x * y;}
+{val.col(5).array() = -4 * y * (x + y - 1);}
+}
+void p_2_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 12);
+{val.col(0).array() = 4 * x + 4 * y - 3;}
+{val.col(1).array() = 4 * x + 4 * y - 3;}
+{val.col(2).array() = 4 * x - 1;}
+{val.col(3).array().setZero();}
+{val.col(4).array().setZero();}
+{val.col(5).array() = 4 * y - 1;}
+{val.col(6).array() = 4 * (-2 * x - y + 1);}
+{val.col(7).array() = -4 * x;}
+{val.col(8).array() = 4 * y;}
+{val.col(9).array() = 4 * x;}
+{val.col(10).array() = -4 * y;}
+{val.col(11).array() = 4 * (-x - 2 * y + 1);}
+}
+
+
+void p_3_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 10);
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(0).array() = -27.0 / 2.0 * helper_0 * y + 9 * helper_0 - 27.0 / 2.0 * helper_1 * x + 9 * helper_1 - 9.0 / 2.0 * pow(x, 3) + 18 * x * y - 11.0 / 2.0 * x - 9.0 / 2.0 * pow(y, 3) - 11.0 / 2.0 * y + 1;}
+{val.col(1).array() = (1.0 / 2.0) * x * (9 * pow(x, 2) - 9 * x + 2);}
+{val.col(2).array() = (1.0 / 2.0) * y * (9 * pow(y, 2) - 9 * y + 2);}
+{val.col(3).array() = (9.0 / 2.0) * x * (x + y - 1) * (3 * x + 3 * y - 2);}
+{val.col(4).array() = -9.0 / 2.0 * x * (3 * pow(x, 2) + 3 * x * y - 4 * x - y + 1);}
+{val.col(5).array() = (9.0 / 2.0) * x * y * (3 * x - 1);}
+{val.col(6).array() = (9.0 / 2.0) * x * y * (3 * y - 1);}
+{val.col(7).array() = -9.0 / 2.0 * y * (3 * x * y - x + 3 * pow(y, 2) - 4 * y + 1);}
+{val.col(8).array() = (9.0 / 2.0) * y * (x + y - 1) * (3 * x + 3 * y - 2);}
+{val.col(9).array() = -27 * x * y * (x + y - 1);}
+}
+void p_3_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 20);
+{val.col(0).array() = -27.0 / 2.0 * pow(x, 2) - 27 * x * y + 18 * x - 27.0 / 2.0 * pow(y, 2) + 18 * y - 11.0 / 2.0;}
+{val.col(1).array() = -27.0 / 2.0 * pow(x, 2) - 27 * x * y + 18 * x - 27.0 / 2.0 * pow(y, 2) + 18 * y - 11.0 / 2.0;}
+{val.col(2).array() = (27.0 / 2.0) * pow(x, 2) - 9 * x + 1;}
+{val.col(3).array().setZero();}
+{val.col(4).array().setZero();}
+{val.col(5).array() = (27.0 / 2.0) * pow(y, 2) - 9 * y + 1;}
+{val.col(6).array() = 9 * ((9.0 / 2.0) * pow(x, 2) + 6 * x * y - 5 * x + (3.0 / 2.0) * pow(y, 2) - 5.0 / 2.0 * y + 1);}
+{val.col(7).array() = (9.0 / 2.0) * x * (6 * x + 6 * y - 5);}
+{val.col(8).array() = 9 * (-9.0 / 2.0 * pow(x, 2) - 3 * x * y + 4 * x + (1.0 / 2.0) * y - 1.0 / 2.0);}
+{val.col(9).array() = -9.0 / 2.0 * x * (3 * x - 1);}
+{val.col(10).array() = (9.0 / 2.0) * y * (6 * x - 1);}
+{val.col(11).array() = (9.0 / 2.0) * x * (3 * x - 1);}
+{val.col(12).array() = (9.0 / 2.0) * y * (3 * y - 1);}
+{val.col(13).array() = (9.0 / 2.0) * x * (6 * y - 1);}
+{val.col(14).array() = -9.0 / 2.0 * y * (3 * y - 1);}
+{val.col(15).array() = 9 * (-3 * x * y + (1.0 / 2.0) * x - 9.0 / 2.0 * pow(y, 2) + 4 * y - 1.0 / 2.0);}
+{val.col(16).array() = (9.0 / 2.0) * y * (6 * x + 6 * y - 5);}
+{val.col(17).array() = 9 * ((3.0 / 2.0) * pow(x, 2) + 6 * x * y - 5.0 / 2.0 * x + (9.0 / 2.0) * pow(y, 2) - 5 * y + 1);}
+{val.col(18).array() = -27 * y * (2 * x + y - 1);}
+{val.col(19).array() = -27 * x * (x + 2 * y - 1);}
+}
+
+
+void p_4_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 15);
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(x, 3);
+const auto helper_2 = pow(y, 2);
+const auto helper_3 = pow(y, 3);
+val.col(0).array() = 64 * helper_0 * helper_2 - 80 * helper_0 * y + (70.0 / 3.0) * helper_0 + (128.0 / 3.0) * helper_1 * y - 80.0 / 3.0 * helper_1 - 80 * helper_2 * x + (70.0 / 3.0) * helper_2 + (128.0 / 3.0) * helper_3 * x - 80.0 / 3.0 * helper_3 + (32.0 / 3.0) * pow(x, 4) + (140.0 / 3.0) * x * y - 25.0 / 3.0 * x + (32.0 / 3.0) * pow(y, 4) - 25.0 / 3.0 * y + 1;}
+{val.col(1).array() = (1.0 / 3.0) * x * (32 * pow(x, 3) - 48 * pow(x, 2) + 22 * x - 3);}
+{val.col(2).array() = (1.0 / 3.0) * y * (32 * pow(y, 3) - 48 * pow(y, 2) + 22 * y - 3);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(3).array() = -16.0 / 3.0 * x * (24 * helper_0 * y - 18 * helper_0 + 24 * helper_1 * x - 18 * helper_1 + 8 * pow(x, 3) - 36 * x * y + 13 * x + 8 * pow(y, 3) + 13 * y - 3);}
+{const auto helper_0 = 32 * pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(4).array() = 4 * x * (helper_0 * y - helper_0 + 16 * helper_1 * x - 4 * helper_1 + 16 * pow(x, 3) - 36 * x * y + 19 * x + 7 * y - 3);}
+{const auto helper_0 = pow(x, 2);
+val.col(5).array() = -16.0 / 3.0 * x * (8 * helper_0 * y - 14 * helper_0 + 8 * pow(x, 3) - 6 * x * y + 7 * x + y - 1);}
+{val.col(6).array() = (16.0 / 3.0) * x * y * (8 * pow(x, 2) - 6 * x + 1);}
+{const auto helper_0 = 4 * x;
+val.col(7).array() = helper_0 * y * (-helper_0 + 16 * x * y - 4 * y + 1);}
+{val.col(8).array() = (16.0 / 3.0) * x * y * (8 * pow(y, 2) - 6 * y + 1);}
+{const auto helper_0 = pow(y, 2);
+val.col(9).array() = -16.0 / 3.0 * y * (8 * helper_0 * x - 14 * helper_0 - 6 * x * y + x + 8 * pow(y, 3) + 7 * y - 1);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = 32 * pow(y, 2);
+val.col(10).array() = 4 * y * (16 * helper_0 * y - 4 * helper_0 + helper_1 * x - helper_1 - 36 * x * y + 7 * x + 16 * pow(y, 3) + 19 * y - 3);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(11).array() = -16.0 / 3.0 * y * (24 * helper_0 * y - 18 * helper_0 + 24 * helper_1 * x - 18 * helper_1 + 8 * pow(x, 3) - 36 * x * y + 13 * x + 8 * pow(y, 3) + 13 * y - 3);}
+{val.col(12).array() = 32 * x * y * (x + y - 1) * (4 * x + 4 * y - 3);}
+{val.col(13).array() = -32 * x * y * (4 * y - 1) * (x + y - 1);}
+{val.col(14).array() = -32 * x * y * (4 * x - 1) * (x + y - 1);}
+}
+void p_4_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 30);
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(0).array() = 128 * helper_0 * y - 80 * helper_0 + 128 * helper_1 * x - 80 * helper_1 + (128.0 / 3.0) * pow(x, 3) - 160 * x * y + (140.0 / 3.0) * x + (128.0 / 3.0) * pow(y, 3) + (140.0 / 3.0) * y - 25.0 / 3.0;}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(1).array() = 128 * helper_0 * y - 80 * helper_0 + 128 * helper_1 * x - 80 * helper_1 + (128.0 / 3.0) * pow(x, 3) - 160 * x * y + (140.0 / 3.0) * x + (128.0 / 3.0) * pow(y, 3) + (140.0 / 3.0) * y - 25.0 / 3.0;}
+{val.col(2).array() = (128.0 / 3.0) * pow(x, 3) - 48 * pow(x, 2) + (44.0 / 3.0) * x - 1;}
+{val.col(3).array().setZero();}
+{val.col(4).array().setZero();}
+{val.col(5).array() = (128.0 / 3.0) * pow(y, 3) - 48 * pow(y, 2) + (44.0 / 3.0) * y - 1;}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(6).array() = -384 * helper_0 * y + 288 * helper_0 - 256 * helper_1 * x + 96 * helper_1 - 512.0 / 3.0 * pow(x, 3) + 384 * x * y - 416.0 / 3.0 * x - 128.0 / 3.0 * pow(y, 3) - 208.0 / 3.0 * y + 16;}
+{val.col(7).array() = -16.0 / 3.0 * x * (24 * pow(x, 2) + 48 * x * y - 36 * x + 24 * pow(y, 2) - 36 * y + 13);}
+{const auto helper_0 = 96 * pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(8).array() = 4 * helper_0 * y - 4 * helper_0 + 128 * helper_1 * x - 16 * helper_1 + 256 * pow(x, 3) - 288 * x * y + 152 * x + 28 * y - 12;}
+{val.col(9).array() = 4 * x * (32 * pow(x, 2) + 32 * x * y - 36 * x - 8 * y + 7);}
+{const auto helper_0 = pow(x, 2);
+val.col(10).array() = -128 * helper_0 * y + 224 * helper_0 - 512.0 / 3.0 * pow(x, 3) + 64 * x * y - 224.0 / 3.0 * x - 16.0 / 3.0 * y + 16.0 / 3.0;}
+{val.col(11).array() = -16.0 / 3.0 * x * (8 * pow(x, 2) - 6 * x + 1);}
+{val.col(12).array() = (16.0 / 3.0) * y * (24 * pow(x, 2) - 12 * x + 1);}
+{val.col(13).array() = (16.0 / 3.0) * x * (8 * pow(x, 2) - 6 * x + 1);}
+{const auto helper_0 = 4 * y;
+val.col(14).array() = helper_0 * (-helper_0 + 32 * x * y - 8 * x + 1);}
+{const auto helper_0 = 4 * x;
+val.col(15).array() = helper_0 * (-helper_0 + 32 * x * y - 8 * y + 1);}
+{val.col(16).array() = (16.0 / 3.0) * y * (8 * pow(y, 2) - 6 * y + 1);}
+{val.col(17).array() = (16.0 / 3.0) * x * (24 * pow(y, 2) - 12 * y + 1);}
+{val.col(18).array() = -16.0 / 3.0 * y * (8 * pow(y, 2) - 6 * y + 1);}
+{const auto helper_0 = pow(y, 2);
+val.col(19).array() = -128 * helper_0 * x + 224 * helper_0 + 64 * x * y - 16.0 / 3.0 * x - 512.0 / 3.0 * pow(y, 3) - 224.0 / 3.0 * y + 16.0 / 3.0;}
+{val.col(20).array() = 4 * y * (32 * x * y - 8 * x + 32 * pow(y, 2) - 36 * y + 7);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = 96 * pow(y, 2);
+val.col(21).array() = 128 * helper_0 * y - 16 * helper_0 + 4 * helper_1 * x - 4 * helper_1 - 288 * x * y + 28 * x + 256 * pow(y, 3) + 152 * y - 12;}
+{val.col(22).array() = -16.0 / 3.0 * y * (24 * pow(x, 2) + 48 * x * y - 36 * x + 24 * pow(y, 2) - 36 * y + 13);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+val.col(23).array() = -256 * helper_0 * y + 96 * helper_0 - 384 * helper_1 * x + 288 * helper_1 - 128.0 / 3.0 * pow(x, 3) + 384 * x * y - 208.0 / 3.0 * x - 512.0 / 3.0 * pow(y, 3) - 416.0 / 3.0 * y + 16;}
+{val.col(24).array() = 32 * y * (12 * pow(x, 2) + 16 * x * y - 14 * x + 4 * pow(y, 2) - 7 * y + 3);}
+{val.col(25).array() = 32 * x * (4 * pow(x, 2) + 16 * x * y - 7 * x + 12 * pow(y, 2) - 14 * y + 3);}
+{val.col(26).array() = -32 * y * (8 * x * y - 2 * x + 4 * pow(y, 2) - 5 * y + 1);}
+{val.col(27).array() = -32 * x * (8 * x * y - x + 12 * pow(y, 2) - 10 * y + 1);}
+{val.col(28).array() = -32 * y * (12 * pow(x, 2) + 8 * x * y - 10 * x - y + 1);}
+{val.col(29).array() = -32 * x * (4 * pow(x, 2) + 8 * x * y - 5 * x - 2 * y + 1);}
+}
+
+
+}
+
+void p_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(p){
+	case 0: p_0_basis_values_2d(uv, val); break;
+	case 1: p_1_basis_values_2d(uv, val); break;
+	case 2: p_2_basis_values_2d(uv, val); break;
+	case 3: p_3_basis_values_2d(uv, val); break;
+	case 4: p_4_basis_values_2d(uv, val); break;
+	default: p_n_basis_values_2d(p, uv, val);
+}}
+
+void p_grad_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(p){
+	case 0: p_0_basis_grad_values_2d(uv, val); break;
+	case 1: p_1_basis_grad_values_2d(uv, val); break;
+	case 2: p_2_basis_grad_values_2d(uv, val); break;
+	case 3: p_3_basis_grad_values_2d(uv, val); break;
+	case 4: p_4_basis_grad_values_2d(uv, val); break;
+	default: p_n_basis_grad_values_2d(p, uv, val);
+}}
+
+namespace {
+void p_0_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 1);
+{val.col(0).array().setOnes();}
+}
+void p_0_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 3);
+{val.col(0).array().setZero();}
+{val.col(1).array().setZero();}
+{val.col(2).array().setZero();}
+}
+
+
+void p_1_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 4);
+{val.col(0).array() = -x - y - z + 1;}
+{val.col(1).array() = x;}
+{val.col(2).array() = y;}
+{val.col(3).array() = z;}
+}
+void p_1_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 12);
+{val.col(0).array().setConstant(-1);}
+{val.col(1).array().setConstant(-1);}
+{val.col(2).array().setConstant(-1);}
+{val.col(3).array().setOnes();}
+{val.col(4).array().setZero();}
+{val.col(5).array().setZero();}
+{val.col(6).array().setZero();}
+{val.col(7).array().setOnes();}
+{val.col(8).array().setZero();}
+{val.col(9).array().setZero();}
+{val.col(10).array().setZero();}
+{val.col(11).array().setOnes();}
+}
+
+
+void p_2_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 10);
+{val.col(0).array() = (x + y + z - 1) * (2 * x + 2 * y + 2 * z - 1);}
+{val.col(1).array() = x * (2 * x - 1);}
+{val.col(2).array() = y * (2 * y - 1);}
+{val.col(3).array() = z * (2 * z - 1);}
+{val.col(4).array() = -4 * x * (x + y + z - 1);}
+{val.col(5).array() = 4 * x * y;}
+{val.col(6).array() = -4 * y * (x + y + z - 1);}
+{val.col(7).array() = -4 * z * (x + y + z - 1);}
+{val.col(8).array() = 4 * x * z;}
+{val.col(9).array() = 4 * y * z;}
+}
+void p_2_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 30);
+{val.col(0).array() = 4 * x + 4 * y + 4 * z - 3;}
+{val.col(1).array() = 4 * x + 4 * y + 4 * z - 3;}
+{val.col(2).array() = 4 * x + 4 * y + 4 * z - 3;}
+{val.col(3).array() = 4 * x - 1;}
+{val.col(4).array().setZero();}
+{val.col(5).array().setZero();}
+{val.col(6).array().setZero();}
+{val.col(7).array() = 4 * y - 1;}
+{val.col(8).array().setZero();}
+{val.col(9).array().setZero();}
+{val.col(10).array().setZero();}
+{val.col(11).array() = 4 * z - 1;}
+{val.col(12).array() = 4 * (-2 * x - y - z + 1);}
+{val.col(13).array() = -4 * x;}
+{val.col(14).array() = -4 * x;}
+{val.col(15).array() = 4 * y;}
+{val.col(16).array() = 4 * x;}
+{val.col(17).array().setZero();}
+{val.col(18).array() = -4 * y;}
+{val.col(19).array() = 4 * (-x - 2 * y - z + 1);}
+{val.col(20).array() = -4 * y;}
+{val.col(21).array() = -4 * z;}
+{val.col(22).array() = -4 * z;}
+{val.col(23).array() = 4 * (-x - y - 2 * z + 1);}
+{val.col(24).array() = 4 * z;}
+{val.col(25).array().setZero();}
+{val.col(26).array() = 4 * x;}
+{val.col(27).array().setZero();}
+{val.col(28).array() = 4 * z;}
+{val.col(29).array() = 4 * y;}
+}
+
+
+void p_3_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 20);
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+const auto helper_2 = pow(z, 2);
+const auto helper_3 = (27.0 / 2.0) * x;
+const auto helper_4 = (27.0 / 2.0) * y;
+const auto helper_5 = (27.0 / 2.0) * z;
+val.col(0).array() = -helper_0 * helper_4 - helper_0 * helper_5 + 9 * helper_0 - helper_1 * helper_3 - helper_1 * helper_5 + 9 * helper_1 - helper_2 * helper_3 - helper_2 * helper_4 + 9 * helper_2 - 9.0 / 2.0 * pow(x, 3) - 27 * x * y * z + 18 * x * y + 18 * x * z - 11.0 / 2.0 * x - 9.0 / 2.0 * pow(y, 3) + 18 * y * z - 11.0 / 2.0 * y - 9.0 / 2.0 * pow(z, 3) - 11.0 / 2.0 * z + 1;}
+{val.col(1).array() = (1.0 / 2.0) * x * (9 * pow(x, 2) - 9 * x + 2);}
+{val.col(2).array() = (1.0 / 2.0) * y * (9 * pow(y, 2) - 9 * y + 2);}
+{val.col(3).array() = (1.0 / 2.0) * z * (9 * pow(z, 2) - 9 * z + 2);}
+{val.col(4).array() = (9.0 / 2.0) * x * (x + y + z - 1) * (3 * x + 3 * y + 3 * z - 2);}
+{const auto helper_0 = 3 * x;
+val.col(5).array() = -9.0 / 2.0 * x * (helper_0 * y + helper_0 * z + 3 * pow(x, 2) - 4 * x - y - z + 1);}
+{val.col(6).array() = (9.0 / 2.0) * x * y * (3 * x - 1);}
+{val.col(7).array() = (9.0 / 2.0) * x * y * (3 * y - 1);}
+{const auto helper_0 = 3 * y;
+val.col(8).array() = -9.0 / 2.0 * y * (helper_0 * x + helper_0 * z - x + 3 * pow(y, 2) - 4 * y - z + 1);}
+{val.col(9).array() = (9.0 / 2.0) * y * (x + y + z - 1) * (3 * x + 3 * y + 3 * z - 2);}
+{val.col(10).array() = (9.0 / 2.0) * z * (x + y + z - 1) * (3 * x + 3 * y + 3 * z - 2);}
+{const auto helper_0 = 3 * z;
+val.col(11).array() = -9.0 / 2.0 * z * (helper_0 * x + helper_0 * y - x - y + 3 * pow(z, 2) - 4 * z + 1);}
+{val.col(12).array() = (9.0 / 2.0) * x * z * (3 * x - 1);}
+{val.col(13).array() = (9.0 / 2.0) * x * z * (3 * z - 1);}
+{val.col(14).array() = (9.0 / 2.0) * y * z * (3 * y - 1);}
+{val.col(15).array() = (9.0 / 2.0) * y * z * (3 * z - 1);}
+{val.col(16).array() = -27 * x * y * (x + y + z - 1);}
+{val.col(17).array() = -27 * x * z * (x + y + z - 1);}
+{val.col(18).array() = 27 * x * y * z;}
+{val.col(19).array() = -27 * y * z * (x + y + z - 1);}
+}
+void p_3_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 60);
+{const auto helper_0 = 27 * x;
+val.col(0).array() = -helper_0 * y - helper_0 * z - 27.0 / 2.0 * pow(x, 2) + 18 * x - 27.0 / 2.0 * pow(y, 2) - 27 * y * z + 18 * y - 27.0 / 2.0 * pow(z, 2) + 18 * z - 11.0 / 2.0;}
+{const auto helper_0 = 27 * x;
+val.col(1).array() = -helper_0 * y - helper_0 * z - 27.0 / 2.0 * pow(x, 2) + 18 * x - 27.0 / 2.0 * pow(y, 2) - 27 * y * z + 18 * y - 27.0 / 2.0 * pow(z, 2) + 18 * z - 11.0 / 2.0;}
+{const auto helper_0 = 27 * x;
+val.col(2).array() = -helper_0 * y - helper_0 * z - 27.0 / 2.0 * pow(x, 2) + 18 * x - 27.0 / 2.0 * pow(y, 2) - 27 * y * z + 18 * y - 27.0 / 2.0 * pow(z, 2) + 18 * z - 11.0 / 2.0;}
+{val.col(3).array() = (27.0 / 2.0) * pow(x, 2) - 9 * x + 1;}
+{val.col(4).array().setZero();}
+{val.col(5).array().setZero();}
+{val.col(6).array().setZero();}
+{val.col(7).array() = (27.0 / 2.0) * pow(y, 2) - 9 * y + 1;}
+{val.col(8).array().setZero();}
+{val.col(9).array().setZero();}
+{val.col(10).array().setZero();}
+{val.col(11).array() = (27.0 / 2.0) * pow(z, 2) - 9 * z + 1;}
+{const auto helper_0 = 6 * x;
+val.col(12).array() = 9 * helper_0 * y + 9 * helper_0 * z + (81.0 / 2.0) * pow(x, 2) - 45 * x + (27.0 / 2.0) * pow(y, 2) + 27 * y * z - 45.0 / 2.0 * y + (27.0 / 2.0) * pow(z, 2) - 45.0 / 2.0 * z + 9;}
+{val.col(13).array() = (9.0 / 2.0) * x * (6 * x + 6 * y + 6 * z - 5);}
+{val.col(14).array() = (9.0 / 2.0) * x * (6 * x + 6 * y + 6 * z - 5);}
+{const auto helper_0 = 3 * x;
+val.col(15).array() = -9 * helper_0 * y - 9 * helper_0 * z - 81.0 / 2.0 * pow(x, 2) + 36 * x + (9.0 / 2.0) * y + (9.0 / 2.0) * z - 9.0 / 2.0;}
+{val.col(16).array() = -9.0 / 2.0 * x * (3 * x - 1);}
+{val.col(17).array() = -9.0 / 2.0 * x * (3 * x - 1);}
+{val.col(18).array() = (9.0 / 2.0) * y * (6 * x - 1);}
+{val.col(19).array() = (9.0 / 2.0) * x * (3 * x - 1);}
+{val.col(20).array().setZero();}
+{val.col(21).array() = (9.0 / 2.0) * y * (3 * y - 1);}
+{val.col(22).array() = (9.0 / 2.0) * x * (6 * y - 1);}
+{val.col(23).array().setZero();}
+{val.col(24).array() = -9.0 / 2.0 * y * (3 * y - 1);}
+{const auto helper_0 = 3 * y;
+val.col(25).array() = -9 * helper_0 * x - 9 * helper_0 * z + (9.0 / 2.0) * x - 81.0 / 2.0 * pow(y, 2) + 36 * y + (9.0 / 2.0) * z - 9.0 / 2.0;}
+{val.col(26).array() = -9.0 / 2.0 * y * (3 * y - 1);}
+{val.col(27).array() = (9.0 / 2.0) * y * (6 * x + 6 * y + 6 * z - 5);}
+{const auto helper_0 = 6 * y;
+val.col(28).array() = 9 * helper_0 * x + 9 * helper_0 * z + (27.0 / 2.0) * pow(x, 2) + 27 * x * z - 45.0 / 2.0 * x + (81.0 / 2.0) * pow(y, 2) - 45 * y + (27.0 / 2.0) * pow(z, 2) - 45.0 / 2.0 * z + 9;}
+{val.col(29).array() = (9.0 / 2.0) * y * (6 * x + 6 * y + 6 * z - 5);}
+{val.col(30).array() = (9.0 / 2.0) * z * (6 * x + 6 * y + 6 * z - 5);}
+{val.col(31).array() = (9.0 / 2.0) * z * (6 * x + 6 * y + 6 * z - 5);}
+{const auto helper_0 = 6 * z;
+val.col(32).array() = 9 * helper_0 * x + 9 * helper_0 * y + (27.0 / 2.0) * pow(x, 2) + 27 * x * y - 45.0 / 2.0 * x + (27.0 / 2.0) * pow(y, 2) - 45.0 / 2.0 * y + (81.0 / 2.0) * pow(z, 2) - 45 * z + 9;}
+{val.col(33).array() = -9.0 / 2.0 * z * (3 * z - 1);}
+{val.col(34).array() = -9.0 / 2.0 * z * (3 * z - 1);}
+{const auto helper_0 = 3 * z;
+val.col(35).array() = -9 * helper_0 * x - 9 * helper_0 * y + (9.0 / 2.0) * x + (9.0 / 2.0) * y - 81.0 / 2.0 * pow(z, 2) + 36 * z - 9.0 / 2.0;}
+{val.col(36).array() = (9.0 / 2.0) * z * (6 * x - 1);}
+{val.col(37).array().setZero();}
+{val.col(38).array() = (9.0 / 2.0) * x * (3 * x - 1);}
+{val.col(39).array() = (9.0 / 2.0) * z * (3 * z - 1);}
+{val.col(40).array().setZero();}
+{val.col(41).array() = (9.0 / 2.0) * x * (6 * z - 1);}
+{val.col(42).array().setZero();}
+{val.col(43).array() = (9.0 / 2.0) * z * (6 * y - 1);}
+{val.col(44).array() = (9.0 / 2.0) * y * (3 * y - 1);}
+{val.col(45).array().setZero();}
+{val.col(46).array() = (9.0 / 2.0) * z * (3 * z - 1);}
+{val.col(47).array() = (9.0 / 2.0) * y * (6 * z - 1);}
+{val.col(48).array() = -27 * y * (2 * x + y + z - 1);}
+{val.col(49).array() = -27 * x * (x + 2 * y + z - 1);}
+{val.col(50).array() = -27 * x * y;}
+{val.col(51).array() = -27 * z * (2 * x + y + z - 1);}
+{val.col(52).array() = -27 * x * z;}
+{val.col(53).array() = -27 * x * (x + y + 2 * z - 1);}
+{val.col(54).array() = 27 * y * z;}
+{val.col(55).array() = 27 * x * z;}
+{val.col(56).array() = 27 * x * y;}
+{val.col(57).array() = -27 * y * z;}
+{val.col(58).array() = -27 * z * (x + 2 * y + z - 1);}
+{val.col(59).array() = -27 * y * (x + y + 2 * z - 1);}
+}
+
+
+void p_4_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 35);
+{const auto helper_0 = x + y + z - 1;
+const auto helper_1 = x * y;
+const auto helper_2 = pow(y, 2);
+const auto helper_3 = 9 * x;
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = pow(x, 2);
+const auto helper_6 = 9 * y;
+const auto helper_7 = 9 * z;
+const auto helper_8 = 26 * helper_0;
+const auto helper_9 = helper_8 * z;
+const auto helper_10 = 13 * pow(helper_0, 2);
+const auto helper_11 = 13 * helper_0;
+val.col(0).array() = (1.0 / 3.0) * helper_0 * (3 * pow(helper_0, 3) + helper_1 * helper_8 + 18 * helper_1 * z + helper_10 * x + helper_10 * y + helper_10 * z + helper_11 * helper_2 + helper_11 * helper_4 + helper_11 * helper_5 + helper_2 * helper_3 + helper_2 * helper_7 + helper_3 * helper_4 + helper_4 * helper_6 + helper_5 * helper_6 + helper_5 * helper_7 + helper_9 * x + helper_9 * y + 3 * pow(x, 3) + 3 * pow(y, 3) + 3 * pow(z, 3));}
+{val.col(1).array() = (1.0 / 3.0) * x * (32 * pow(x, 3) - 48 * pow(x, 2) + 22 * x - 3);}
+{val.col(2).array() = (1.0 / 3.0) * y * (32 * pow(y, 3) - 48 * pow(y, 2) + 22 * y - 3);}
+{val.col(3).array() = (1.0 / 3.0) * z * (32 * pow(z, 3) - 48 * pow(z, 2) + 22 * z - 3);}
+{const auto helper_0 = 36 * x;
+const auto helper_1 = y * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 24 * x;
+const auto helper_6 = 24 * y;
+const auto helper_7 = 24 * z;
+val.col(4).array() = -16.0 / 3.0 * x * (-helper_0 * y - helper_0 * z + 48 * helper_1 * x - 36 * helper_1 + helper_2 * helper_6 + helper_2 * helper_7 - 18 * helper_2 + helper_3 * helper_5 + helper_3 * helper_7 - 18 * helper_3 + helper_4 * helper_5 + helper_4 * helper_6 - 18 * helper_4 + 8 * pow(x, 3) + 13 * x + 8 * pow(y, 3) + 13 * y + 8 * pow(z, 3) + 13 * z - 3);}
+{const auto helper_0 = 2 * y;
+const auto helper_1 = 2 * z;
+const auto helper_2 = x + y + z - 1;
+const auto helper_3 = helper_2 * x;
+val.col(5).array() = 4 * helper_3 * (-helper_0 * helper_2 + helper_0 * x - helper_0 * z - helper_1 * helper_2 + helper_1 * x + 3 * pow(helper_2, 2) + 10 * helper_3 + 3 * pow(x, 2) - pow(y, 2) - pow(z, 2));}
+{const auto helper_0 = 6 * x;
+const auto helper_1 = pow(x, 2);
+const auto helper_2 = 8 * helper_1;
+val.col(6).array() = -16.0 / 3.0 * x * (-helper_0 * y - helper_0 * z - 14 * helper_1 + helper_2 * y + helper_2 * z + 8 * pow(x, 3) + 7 * x + y + z - 1);}
+{val.col(7).array() = (16.0 / 3.0) * x * y * (8 * pow(x, 2) - 6 * x + 1);}
+{const auto helper_0 = 4 * x;
+val.col(8).array() = helper_0 * y * (-helper_0 + 16 * x * y - 4 * y + 1);}
+{val.col(9).array() = (16.0 / 3.0) * x * y * (8 * pow(y, 2) - 6 * y + 1);}
+{const auto helper_0 = 6 * y;
+const auto helper_1 = pow(y, 2);
+const auto helper_2 = 8 * helper_1;
+val.col(10).array() = -16.0 / 3.0 * y * (-helper_0 * x - helper_0 * z - 14 * helper_1 + helper_2 * x + helper_2 * z + x + 8 * pow(y, 3) + 7 * y + z - 1);}
+{const auto helper_0 = 2 * y;
+const auto helper_1 = 2 * x;
+const auto helper_2 = x + y + z - 1;
+const auto helper_3 = helper_2 * y;
+val.col(11).array() = -4 * helper_3 * (-helper_0 * x - helper_0 * z + helper_1 * helper_2 + helper_1 * z - 3 * pow(helper_2, 2) + 2 * helper_2 * z - 10 * helper_3 + pow(x, 2) - 3 * pow(y, 2) + pow(z, 2));}
+{const auto helper_0 = 36 * x;
+const auto helper_1 = y * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 24 * x;
+const auto helper_6 = 24 * y;
+const auto helper_7 = 24 * z;
+val.col(12).array() = -16.0 / 3.0 * y * (-helper_0 * y - helper_0 * z + 48 * helper_1 * x - 36 * helper_1 + helper_2 * helper_6 + helper_2 * helper_7 - 18 * helper_2 + helper_3 * helper_5 + helper_3 * helper_7 - 18 * helper_3 + helper_4 * helper_5 + helper_4 * helper_6 - 18 * helper_4 + 8 * pow(x, 3) + 13 * x + 8 * pow(y, 3) + 13 * y + 8 * pow(z, 3) + 13 * z - 3);}
+{const auto helper_0 = 36 * x;
+const auto helper_1 = y * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 24 * x;
+const auto helper_6 = 24 * y;
+const auto helper_7 = 24 * z;
+val.col(13).array() = -16.0 / 3.0 * z * (-helper_0 * y - helper_0 * z + 48 * helper_1 * x - 36 * helper_1 + helper_2 * helper_6 + helper_2 * helper_7 - 18 * helper_2 + helper_3 * helper_5 + helper_3 * helper_7 - 18 * helper_3 + helper_4 * helper_5 + helper_4 * helper_6 - 18 * helper_4 + 8 * pow(x, 3) + 13 * x + 8 * pow(y, 3) + 13 * y + 8 * pow(z, 3) + 13 * z - 3);}
+{const auto helper_0 = 2 * x;
+const auto helper_1 = 2 * z;
+const auto helper_2 = x + y + z - 1;
+const auto helper_3 = helper_2 * z;
+val.col(14).array() = -4 * helper_3 * (helper_0 * helper_2 + helper_0 * y - helper_1 * x - helper_1 * y - 3 * pow(helper_2, 2) + 2 * helper_2 * y - 10 * helper_3 + pow(x, 2) + pow(y, 2) - 3 * pow(z, 2));}
+{const auto helper_0 = 6 * z;
+const auto helper_1 = pow(z, 2);
+const auto helper_2 = 8 * helper_1;
+val.col(15).array() = -16.0 / 3.0 * z * (-helper_0 * x - helper_0 * y - 14 * helper_1 + helper_2 * x + helper_2 * y + x + y + 8 * pow(z, 3) + 7 * z - 1);}
+{val.col(16).array() = (16.0 / 3.0) * x * z * (8 * pow(x, 2) - 6 * x + 1);}
+{const auto helper_0 = 4 * x;
+val.col(17).array() = helper_0 * z * (-helper_0 + 16 * x * z - 4 * z + 1);}
+{val.col(18).array() = (16.0 / 3.0) * x * z * (8 * pow(z, 2) - 6 * z + 1);}
+{val.col(19).array() = (16.0 / 3.0) * y * z * (8 * pow(y, 2) - 6 * y + 1);}
+{const auto helper_0 = 4 * y;
+val.col(20).array() = helper_0 * z * (-helper_0 + 16 * y * z - 4 * z + 1);}
+{val.col(21).array() = (16.0 / 3.0) * y * z * (8 * pow(z, 2) - 6 * z + 1);}
+{val.col(22).array() = 32 * x * y * (x + y + z - 1) * (4 * x + 4 * y + 4 * z - 3);}
+{val.col(23).array() = -32 * x * y * (4 * y - 1) * (x + y + z - 1);}
+{val.col(24).array() = -32 * x * y * (4 * x - 1) * (x + y + z - 1);}
+{val.col(25).array() = 32 * x * z * (x + y + z - 1) * (4 * x + 4 * y + 4 * z - 3);}
+{val.col(26).array() = -32 * x * z * (4 * z - 1) * (x + y + z - 1);}
+{val.col(27).array() = -32 * x * z * (4 * x - 1) * (x + y + z - 1);}
+{val.col(28).array() = 32 * x * y * z * (4 * x - 1);}
+{val.col(29).array() = 32 * x * y * z * (4 * z - 1);}
+{val.col(30).array() = 32 * x * y * z * (4 * y - 1);}
+{val.col(31).array() = -32 * y * z * (4 * y - 1) * (x + y + z - 1);}
+{val.col(32).array() = -32 * y * z * (4 * z - 1) * (x + y + z - 1);}
+{val.col(33).array() = 32 * y * z * (x + y + z - 1) * (4 * x + 4 * y + 4 * z - 3);}
+{val.col(34).array() = -256 * x * y * z * (x + y + z - 1);}
+}
+void p_4_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 105);
+{const auto helper_0 = 160 * x;
+const auto helper_1 = y * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 128 * x;
+const auto helper_6 = 128 * y;
+const auto helper_7 = 128 * z;
+val.col(0).array() = -helper_0 * y - helper_0 * z + 256 * helper_1 * x - 160 * helper_1 + helper_2 * helper_6 + helper_2 * helper_7 - 80 * helper_2 + helper_3 * helper_5 + helper_3 * helper_7 - 80 * helper_3 + helper_4 * helper_5 + helper_4 * helper_6 - 80 * helper_4 + (128.0 / 3.0) * pow(x, 3) + (140.0 / 3.0) * x + (128.0 / 3.0) * pow(y, 3) + (140.0 / 3.0) * y + (128.0 / 3.0) * pow(z, 3) + (140.0 / 3.0) * z - 25.0 / 3.0;}
+{const auto helper_0 = 160 * x;
+const auto helper_1 = y * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 128 * x;
+const auto helper_6 = 128 * y;
+const auto helper_7 = 128 * z;
+val.col(1).array() = -helper_0 * y - helper_0 * z + 256 * helper_1 * x - 160 * helper_1 + helper_2 * helper_6 + helper_2 * helper_7 - 80 * helper_2 + helper_3 * helper_5 + helper_3 * helper_7 - 80 * helper_3 + helper_4 * helper_5 + helper_4 * helper_6 - 80 * helper_4 + (128.0 / 3.0) * pow(x, 3) + (140.0 / 3.0) * x + (128.0 / 3.0) * pow(y, 3) + (140.0 / 3.0) * y + (128.0 / 3.0) * pow(z, 3) + (140.0 / 3.0) * z - 25.0 / 3.0;}
+{const auto helper_0 = 160 * x;
+const auto helper_1 = y * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 128 * x;
+const auto helper_6 = 128 * y;
+const auto helper_7 = 128 * z;
+val.col(2).array() = -helper_0 * y - helper_0 * z + 256 * helper_1 * x - 160 * helper_1 + helper_2 * helper_6 + helper_2 * helper_7 - 80 * helper_2 + helper_3 * helper_5 + helper_3 * helper_7 - 80 * helper_3 + helper_4 * helper_5 + helper_4 * helper_6 - 80 * helper_4 + (128.0 / 3.0) * pow(x, 3) + (140.0 / 3.0) * x + (128.0 / 3.0) * pow(y, 3) + (140.0 / 3.0) * y + (128.0 / 3.0) * pow(z, 3) + (140.0 / 3.0) * z - 25.0 / 3.0;}
+{val.col(3).array() = (128.0 / 3.0) * pow(x, 3) - 48 * pow(x, 2) + (44.0 / 3.0) * x - 1;}
+{val.col(4).array().setZero();}
+{val.col(5).array().setZero();}
+{val.col(6).array().setZero();}
+{val.col(7).array() = (128.0 / 3.0) * pow(y, 3) - 48 * pow(y, 2) + (44.0 / 3.0) * y - 1;}
+{val.col(8).array().setZero();}
+{val.col(9).array().setZero();}
+{val.col(10).array().setZero();}
+{val.col(11).array() = (128.0 / 3.0) * pow(z, 3) - 48 * pow(z, 2) + (44.0 / 3.0) * z - 1;}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+const auto helper_2 = pow(z, 2);
+const auto helper_3 = 16 * x;
+const auto helper_4 = 24 * helper_0;
+val.col(12).array() = 288 * helper_0 - 16 * helper_1 * helper_3 - 128 * helper_1 * z + 96 * helper_1 - 16 * helper_2 * helper_3 - 128 * helper_2 * y + 96 * helper_2 - 16 * helper_4 * y - 16 * helper_4 * z - 512.0 / 3.0 * pow(x, 3) - 512 * x * y * z + 384 * x * y + 384 * x * z - 416.0 / 3.0 * x - 128.0 / 3.0 * pow(y, 3) + 192 * y * z - 208.0 / 3.0 * y - 128.0 / 3.0 * pow(z, 3) - 208.0 / 3.0 * z + 16;}
+{const auto helper_0 = 48 * x;
+val.col(13).array() = -16.0 / 3.0 * x * (helper_0 * y + helper_0 * z + 24 * pow(x, 2) - 36 * x + 24 * pow(y, 2) + 48 * y * z - 36 * y + 24 * pow(z, 2) - 36 * z + 13);}
+{const auto helper_0 = 48 * x;
+val.col(14).array() = -16.0 / 3.0 * x * (helper_0 * y + helper_0 * z + 24 * pow(x, 2) - 36 * x + 24 * pow(y, 2) + 48 * y * z - 36 * y + 24 * pow(z, 2) - 36 * z + 13);}
+{const auto helper_0 = 72 * x;
+const auto helper_1 = y * z;
+const auto helper_2 = 96 * pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 32 * x;
+val.col(15).array() = -4 * helper_0 * y - 4 * helper_0 * z + 256 * helper_1 * x - 32 * helper_1 + 4 * helper_2 * y + 4 * helper_2 * z - 4 * helper_2 + 4 * helper_3 * helper_5 - 16 * helper_3 + 4 * helper_4 * helper_5 - 16 * helper_4 + 256 * pow(x, 3) + 152 * x + 28 * y + 28 * z - 12;}
+{const auto helper_0 = 32 * x;
+val.col(16).array() = 4 * x * (helper_0 * y + helper_0 * z + 32 * pow(x, 2) - 36 * x - 8 * y - 8 * z + 7);}
+{const auto helper_0 = 32 * x;
+val.col(17).array() = 4 * x * (helper_0 * y + helper_0 * z + 32 * pow(x, 2) - 36 * x - 8 * y - 8 * z + 7);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = 8 * helper_0;
+val.col(18).array() = 224 * helper_0 - 16 * helper_1 * y - 16 * helper_1 * z - 512.0 / 3.0 * pow(x, 3) + 64 * x * y + 64 * x * z - 224.0 / 3.0 * x - 16.0 / 3.0 * y - 16.0 / 3.0 * z + 16.0 / 3.0;}
+{val.col(19).array() = -16.0 / 3.0 * x * (8 * pow(x, 2) - 6 * x + 1);}
+{val.col(20).array() = -16.0 / 3.0 * x * (8 * pow(x, 2) - 6 * x + 1);}
+{val.col(21).array() = (16.0 / 3.0) * y * (24 * pow(x, 2) - 12 * x + 1);}
+{val.col(22).array() = (16.0 / 3.0) * x * (8 * pow(x, 2) - 6 * x + 1);}
+{val.col(23).array().setZero();}
+{const auto helper_0 = 4 * y;
+val.col(24).array() = helper_0 * (-helper_0 + 32 * x * y - 8 * x + 1);}
+{const auto helper_0 = 4 * x;
+val.col(25).array() = helper_0 * (-helper_0 + 32 * x * y - 8 * y + 1);}
+{val.col(26).array().setZero();}
+{val.col(27).array() = (16.0 / 3.0) * y * (8 * pow(y, 2) - 6 * y + 1);}
+{val.col(28).array() = (16.0 / 3.0) * x * (24 * pow(y, 2) - 12 * y + 1);}
+{val.col(29).array().setZero();}
+{val.col(30).array() = -16.0 / 3.0 * y * (8 * pow(y, 2) - 6 * y + 1);}
+{const auto helper_0 = pow(y, 2);
+const auto helper_1 = 8 * helper_0;
+val.col(31).array() = 224 * helper_0 - 16 * helper_1 * x - 16 * helper_1 * z + 64 * x * y - 16.0 / 3.0 * x - 512.0 / 3.0 * pow(y, 3) + 64 * y * z - 224.0 / 3.0 * y - 16.0 / 3.0 * z + 16.0 / 3.0;}
+{val.col(32).array() = -16.0 / 3.0 * y * (8 * pow(y, 2) - 6 * y + 1);}
+{const auto helper_0 = 32 * y;
+val.col(33).array() = 4 * y * (helper_0 * x + helper_0 * z - 8 * x + 32 * pow(y, 2) - 36 * y - 8 * z + 7);}
+{const auto helper_0 = 72 * y;
+const auto helper_1 = x * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = 96 * pow(y, 2);
+const auto helper_4 = pow(z, 2);
+const auto helper_5 = 32 * y;
+val.col(34).array() = -4 * helper_0 * x - 4 * helper_0 * z + 256 * helper_1 * y - 32 * helper_1 + 4 * helper_2 * helper_5 - 16 * helper_2 + 4 * helper_3 * x + 4 * helper_3 * z - 4 * helper_3 + 4 * helper_4 * helper_5 - 16 * helper_4 + 28 * x + 256 * pow(y, 3) + 152 * y + 28 * z - 12;}
+{const auto helper_0 = 32 * y;
+val.col(35).array() = 4 * y * (helper_0 * x + helper_0 * z - 8 * x + 32 * pow(y, 2) - 36 * y - 8 * z + 7);}
+{const auto helper_0 = 48 * x;
+val.col(36).array() = -16.0 / 3.0 * y * (helper_0 * y + helper_0 * z + 24 * pow(x, 2) - 36 * x + 24 * pow(y, 2) + 48 * y * z - 36 * y + 24 * pow(z, 2) - 36 * z + 13);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+const auto helper_2 = pow(z, 2);
+const auto helper_3 = 24 * helper_1;
+const auto helper_4 = 16 * y;
+val.col(37).array() = -16 * helper_0 * helper_4 - 128 * helper_0 * z + 96 * helper_0 + 288 * helper_1 - 16 * helper_2 * helper_4 - 128 * helper_2 * x + 96 * helper_2 - 16 * helper_3 * x - 16 * helper_3 * z - 128.0 / 3.0 * pow(x, 3) - 512 * x * y * z + 384 * x * y + 192 * x * z - 208.0 / 3.0 * x - 512.0 / 3.0 * pow(y, 3) + 384 * y * z - 416.0 / 3.0 * y - 128.0 / 3.0 * pow(z, 3) - 208.0 / 3.0 * z + 16;}
+{const auto helper_0 = 48 * x;
+val.col(38).array() = -16.0 / 3.0 * y * (helper_0 * y + helper_0 * z + 24 * pow(x, 2) - 36 * x + 24 * pow(y, 2) + 48 * y * z - 36 * y + 24 * pow(z, 2) - 36 * z + 13);}
+{const auto helper_0 = 48 * x;
+val.col(39).array() = -16.0 / 3.0 * z * (helper_0 * y + helper_0 * z + 24 * pow(x, 2) - 36 * x + 24 * pow(y, 2) + 48 * y * z - 36 * y + 24 * pow(z, 2) - 36 * z + 13);}
+{const auto helper_0 = 48 * x;
+val.col(40).array() = -16.0 / 3.0 * z * (helper_0 * y + helper_0 * z + 24 * pow(x, 2) - 36 * x + 24 * pow(y, 2) + 48 * y * z - 36 * y + 24 * pow(z, 2) - 36 * z + 13);}
+{const auto helper_0 = pow(x, 2);
+const auto helper_1 = pow(y, 2);
+const auto helper_2 = pow(z, 2);
+const auto helper_3 = 24 * helper_2;
+const auto helper_4 = 16 * z;
+val.col(41).array() = -16 * helper_0 * helper_4 - 128 * helper_0 * y + 96 * helper_0 - 16 * helper_1 * helper_4 - 128 * helper_1 * x + 96 * helper_1 + 288 * helper_2 - 16 * helper_3 * x - 16 * helper_3 * y - 128.0 / 3.0 * pow(x, 3) - 512 * x * y * z + 192 * x * y + 384 * x * z - 208.0 / 3.0 * x - 128.0 / 3.0 * pow(y, 3) + 384 * y * z - 208.0 / 3.0 * y - 512.0 / 3.0 * pow(z, 3) - 416.0 / 3.0 * z + 16;}
+{const auto helper_0 = 32 * z;
+val.col(42).array() = 4 * z * (helper_0 * x + helper_0 * y - 8 * x - 8 * y + 32 * pow(z, 2) - 36 * z + 7);}
+{const auto helper_0 = 32 * z;
+val.col(43).array() = 4 * z * (helper_0 * x + helper_0 * y - 8 * x - 8 * y + 32 * pow(z, 2) - 36 * z + 7);}
+{const auto helper_0 = x * y;
+const auto helper_1 = 72 * z;
+const auto helper_2 = pow(x, 2);
+const auto helper_3 = pow(y, 2);
+const auto helper_4 = 96 * pow(z, 2);
+const auto helper_5 = 32 * z;
+val.col(44).array() = 256 * helper_0 * z - 32 * helper_0 - 4 * helper_1 * x - 4 * helper_1 * y + 4 * helper_2 * helper_5 - 16 * helper_2 + 4 * helper_3 * helper_5 - 16 * helper_3 + 4 * helper_4 * x + 4 * helper_4 * y - 4 * helper_4 + 28 * x + 28 * y + 256 * pow(z, 3) + 152 * z - 12;}
+{val.col(45).array() = -16.0 / 3.0 * z * (8 * pow(z, 2) - 6 * z + 1);}
+{val.col(46).array() = -16.0 / 3.0 * z * (8 * pow(z, 2) - 6 * z + 1);}
+{const auto helper_0 = pow(z, 2);
+const auto helper_1 = 8 * helper_0;
+val.col(47).array() = 224 * helper_0 - 16 * helper_1 * x - 16 * helper_1 * y + 64 * x * z - 16.0 / 3.0 * x + 64 * y * z - 16.0 / 3.0 * y - 512.0 / 3.0 * pow(z, 3) - 224.0 / 3.0 * z + 16.0 / 3.0;}
+{val.col(48).array() = (16.0 / 3.0) * z * (24 * pow(x, 2) - 12 * x + 1);}
+{val.col(49).array().setZero();}
+{val.col(50).array() = (16.0 / 3.0) * x * (8 * pow(x, 2) - 6 * x + 1);}
+{const auto helper_0 = 4 * z;
+val.col(51).array() = helper_0 * (-helper_0 + 32 * x * z - 8 * x + 1);}
+{val.col(52).array().setZero();}
+{const auto helper_0 = 4 * x;
+val.col(53).array() = helper_0 * (-helper_0 + 32 * x * z - 8 * z + 1);}
+{val.col(54).array() = (16.0 / 3.0) * z * (8 * pow(z, 2) - 6 * z + 1);}
+{val.col(55).array().setZero();}
+{val.col(56).array() = (16.0 / 3.0) * x * (24 * pow(z, 2) - 12 * z + 1);}
+{val.col(57).array().setZero();}
+{val.col(58).array() = (16.0 / 3.0) * z * (24 * pow(y, 2) - 12 * y + 1);}
+{val.col(59).array() = (16.0 / 3.0) * y * (8 * pow(y, 2) - 6 * y + 1);}
+{val.col(60).array().setZero();}
+{const auto helper_0 = 4 * z;
+val.col(61).array() = helper_0 * (-helper_0 + 32 * y * z - 8 * y + 1);}
+{const auto helper_0 = 4 * y;
+val.col(62).array() = helper_0 * (-helper_0 + 32 * y * z - 8 * z + 1);}
+{val.col(63).array().setZero();}
+{val.col(64).array() = (16.0 / 3.0) * z * (8 * pow(z, 2) - 6 * z + 1);}
+{val.col(65).array() = (16.0 / 3.0) * y * (24 * pow(z, 2) - 12 * z + 1);}
+{const auto helper_0 = 16 * x;
+val.col(66).array() = 32 * y * (helper_0 * y + helper_0 * z + 12 * pow(x, 2) - 14 * x + 4 * pow(y, 2) + 8 * y * z - 7 * y + 4 * pow(z, 2) - 7 * z + 3);}
+{const auto helper_0 = 16 * y;
+val.col(67).array() = 32 * x * (helper_0 * x + helper_0 * z + 4 * pow(x, 2) + 8 * x * z - 7 * x + 12 * pow(y, 2) - 14 * y + 4 * pow(z, 2) - 7 * z + 3);}
+{val.col(68).array() = 32 * x * y * (8 * x + 8 * y + 8 * z - 7);}
+{val.col(69).array() = -32 * y * (8 * x * y - 2 * x + 4 * pow(y, 2) + 4 * y * z - 5 * y - z + 1);}
+{const auto helper_0 = 8 * y;
+val.col(70).array() = -32 * x * (helper_0 * x + helper_0 * z - x + 12 * pow(y, 2) - 10 * y - z + 1);}
+{val.col(71).array() = -32 * x * y * (4 * y - 1);}
+{const auto helper_0 = 8 * x;
+val.col(72).array() = -32 * y * (helper_0 * y + helper_0 * z + 12 * pow(x, 2) - 10 * x - y - z + 1);}
+{val.col(73).array() = -32 * x * (4 * pow(x, 2) + 8 * x * y + 4 * x * z - 5 * x - 2 * y - z + 1);}
+{val.col(74).array() = -32 * x * y * (4 * x - 1);}
+{const auto helper_0 = 16 * x;
+val.col(75).array() = 32 * z * (helper_0 * y + helper_0 * z + 12 * pow(x, 2) - 14 * x + 4 * pow(y, 2) + 8 * y * z - 7 * y + 4 * pow(z, 2) - 7 * z + 3);}
+{val.col(76).array() = 32 * x * z * (8 * x + 8 * y + 8 * z - 7);}
+{const auto helper_0 = 16 * z;
+val.col(77).array() = 32 * x * (helper_0 * x + helper_0 * y + 4 * pow(x, 2) + 8 * x * y - 7 * x + 4 * pow(y, 2) - 7 * y + 12 * pow(z, 2) - 14 * z + 3);}
+{val.col(78).array() = -32 * z * (8 * x * z - 2 * x + 4 * y * z - y + 4 * pow(z, 2) - 5 * z + 1);}
+{val.col(79).array() = -32 * x * z * (4 * z - 1);}
+{const auto helper_0 = 8 * z;
+val.col(80).array() = -32 * x * (helper_0 * x + helper_0 * y - x - y + 12 * pow(z, 2) - 10 * z + 1);}
+{const auto helper_0 = 8 * x;
+val.col(81).array() = -32 * z * (helper_0 * y + helper_0 * z + 12 * pow(x, 2) - 10 * x - y - z + 1);}
+{val.col(82).array() = -32 * x * z * (4 * x - 1);}
+{val.col(83).array() = -32 * x * (4 * pow(x, 2) + 4 * x * y + 8 * x * z - 5 * x - y - 2 * z + 1);}
+{val.col(84).array() = 32 * y * z * (8 * x - 1);}
+{val.col(85).array() = 32 * x * z * (4 * x - 1);}
+{val.col(86).array() = 32 * x * y * (4 * x - 1);}
+{val.col(87).array() = 32 * y * z * (4 * z - 1);}
+{val.col(88).array() = 32 * x * z * (4 * z - 1);}
+{val.col(89).array() = 32 * x * y * (8 * z - 1);}
+{val.col(90).array() = 32 * y * z * (4 * y - 1);}
+{val.col(91).array() = 32 * x * z * (8 * y - 1);}
+{val.col(92).array() = 32 * x * y * (4 * y - 1);}
+{val.col(93).array() = -32 * y * z * (4 * y - 1);}
+{const auto helper_0 = 8 * y;
+val.col(94).array() = -32 * z * (helper_0 * x + helper_0 * z - x + 12 * pow(y, 2) - 10 * y - z + 1);}
+{val.col(95).array() = -32 * y * (4 * x * y - x + 4 * pow(y, 2) + 8 * y * z - 5 * y - 2 * z + 1);}
+{val.col(96).array() = -32 * y * z * (4 * z - 1);}
+{val.col(97).array() = -32 * z * (4 * x * z - x + 8 * y * z - 2 * y + 4 * pow(z, 2) - 5 * z + 1);}
+{const auto helper_0 = 8 * z;
+val.col(98).array() = -32 * y * (helper_0 * x + helper_0 * y - x - y + 12 * pow(z, 2) - 10 * z + 1);}
+{val.col(99).array() = 32 * y * z * (8 * x + 8 * y + 8 * z - 7);}
+{const auto helper_0 = 16 * y;
+val.col(100).array() = 32 * z * (helper_0 * x + helper_0 * z + 4 * pow(x, 2) + 8 * x * z - 7 * x + 12 * pow(y, 2) - 14 * y + 4 * pow(z, 2) - 7 * z + 3);}
+{const auto helper_0 = 16 * z;
+val.col(101).array() = 32 * y * (helper_0 * x + helper_0 * y + 4 * pow(x, 2) + 8 * x * y - 7 * x + 4 * pow(y, 2) - 7 * y + 12 * pow(z, 2) - 14 * z + 3);}
+{val.col(102).array() = -256 * y * z * (2 * x + y + z - 1);}
+{val.col(103).array() = -256 * x * z * (x + 2 * y + z - 1);}
+{val.col(104).array() = -256 * x * y * (x + y + 2 * z - 1);}
+}
+
+
+}
+
+void p_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(p){
+	case 0: p_0_basis_values_3d(uv, val); break;
+	case 1: p_1_basis_values_3d(uv, val); break;
+	case 2: p_2_basis_values_3d(uv, val); break;
+	case 3: p_3_basis_values_3d(uv, val); break;
+	case 4: p_4_basis_values_3d(uv, val); break;
+	default: p_n_basis_values_3d(p, uv, val);
+}}
+
+void p_grad_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(p){
+	case 0: p_0_basis_grad_values_3d(uv, val); break;
+	case 1: p_1_basis_grad_values_3d(uv, val); break;
+	case 2: p_2_basis_grad_values_3d(uv, val); break;
+	case 3: p_3_basis_grad_values_3d(uv, val); break;
+	case 4: p_4_basis_grad_values_3d(uv, val); break;
+	default: p_n_basis_grad_values_3d(p, uv, val);
+}}
+
+namespace {
+
+}}}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include "p_n_bases.hpp"
+#include <cassert>
+
+namespace polyfem {
+namespace autogen {
+void p_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+void p_grad_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+
+void p_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+void p_grad_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+
+
+}}
@@ -6,9 +6,11 @@
 #include "auto_q_bases_2d_val.hpp"
 #include "auto_q_bases_2d_nodes.hpp"
 #include "auto_q_bases_2d_grad.hpp"
+#include "auto_q_bases_2d_batched.hpp"
 #include "auto_q_bases_3d_val.hpp"
 #include "auto_q_bases_3d_nodes.hpp"
 #include "auto_q_bases_3d_grad.hpp"
+#include "auto_q_bases_3d_batched.hpp"
 
 
 namespace polyfem {
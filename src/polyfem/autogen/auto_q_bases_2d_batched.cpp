@@ -0,0 +1,297 @@
+#include "auto_q_bases_2d_batched.hpp"
+
+
+namespace polyfem {
+namespace autogen {
+namespace {
+void q_0_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 1);
+{val.col(0).array().setOnes();}
+}
+void q_0_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 2);
+{val.col(0).array().setZero();}
+{val.col(1).array().setZero();}
+}
+
+void q_1_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 4);
+{val.col(0).array() = 1.0*(x - 1)*(y - 1);}
+{val.col(1).array() = -1.0*x*(y - 1);}
+{val.col(2).array() = 1.0*x*y;}
+{val.col(3).array() = -1.0*y*(x - 1);}
+}
+void q_1_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 8);
+{val.col(0).array() = 1.0*(y - 1);}
+{val.col(1).array() = 1.0*(x - 1);}
+{val.col(2).array() = 1.0*(1 - y);}
+{val.col(3).array() = -1.0*x;}
+{val.col(4).array() = 1.0*y;}
+{val.col(5).array() = 1.0*x;}
+{val.col(6).array() = -1.0*y;}
+{val.col(7).array() = 1.0*(1 - x);}
+}
+
+void q_2_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 9);
+{val.col(0).array() = 1.0*(x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0);}
+{val.col(1).array() = 1.0*x*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0);}
+{val.col(2).array() = 1.0*x*y*(2.0*x - 1.0)*(2.0*y - 1.0);}
+{val.col(3).array() = 1.0*y*(x - 1)*(2.0*x - 1.0)*(2.0*y - 1.0);}
+{val.col(4).array() = -4.0*x*(x - 1)*(y - 1)*(2.0*y - 1.0);}
+{val.col(5).array() = -4.0*x*y*(2.0*x - 1.0)*(y - 1);}
+{val.col(6).array() = -4.0*x*y*(x - 1)*(2.0*y - 1.0);}
+{val.col(7).array() = -4.0*y*(x - 1)*(2.0*x - 1.0)*(y - 1);}
+{val.col(8).array() = 16.0*x*y*(x - 1)*(y - 1);}
+}
+void q_2_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 18);
+{val.col(0).array() = (4.0*x - 3.0)*(y - 1)*(2.0*y - 1.0);}
+{val.col(1).array() = (x - 1)*(2.0*x - 1.0)*(4.0*y - 3.0);}
+{val.col(2).array() = (4.0*x - 1.0)*(y - 1)*(2.0*y - 1.0);}
+{val.col(3).array() = x*(2.0*x - 1.0)*(4.0*y - 3.0);}
+{val.col(4).array() = y*(4.0*x - 1.0)*(2.0*y - 1.0);}
+{val.col(5).array() = x*(2.0*x - 1.0)*(4.0*y - 1.0);}
+{val.col(6).array() = y*(4.0*x - 3.0)*(2.0*y - 1.0);}
+{val.col(7).array() = (x - 1)*(2.0*x - 1.0)*(4.0*y - 1.0);}
+{val.col(8).array() = -4.0*(2*x - 1)*(y - 1)*(2.0*y - 1.0);}
+{val.col(9).array() = -x*(x - 1)*(16.0*y - 12.0);}
+{val.col(10).array() = -y*(16.0*x - 4.0)*(y - 1);}
+{val.col(11).array() = -4.0*x*(2.0*x - 1.0)*(2*y - 1);}
+{val.col(12).array() = -4.0*y*(2*x - 1)*(2.0*y - 1.0);}
+{val.col(13).array() = -x*(x - 1)*(16.0*y - 4.0);}
+{val.col(14).array() = -y*(16.0*x - 12.0)*(y - 1);}
+{val.col(15).array() = -4.0*(x - 1)*(2.0*x - 1.0)*(2*y - 1);}
+{val.col(16).array() = 16.0*y*(2*x - 1)*(y - 1);}
+{val.col(17).array() = 16.0*x*(x - 1)*(2*y - 1);}
+}
+
+void q_3_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 16);
+{val.col(0).array() = 1.0*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0);}
+{val.col(1).array() = -1.0*x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0);}
+{val.col(2).array() = 1.0*x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996);}
+{val.col(3).array() = -1.0*y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996);}
+{val.col(4).array() = -4.4999999999999991*x*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0);}
+{val.col(5).array() = 4.4999999999999991*x*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0);}
+{val.col(6).array() = 4.4999999999999991*x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0);}
+{val.col(7).array() = -4.4999999999999991*x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0);}
+{val.col(8).array() = -4.4999999999999991*x*y*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996);}
+{val.col(9).array() = 4.4999999999999991*x*y*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996);}
+{val.col(10).array() = 4.4999999999999991*y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0);}
+{val.col(11).array() = -4.4999999999999991*y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0);}
+{val.col(12).array() = 20.249999999999993*x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0);}
+{val.col(13).array() = -20.249999999999993*x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0);}
+{val.col(14).array() = -20.249999999999993*x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0);}
+{val.col(15).array() = 20.249999999999993*x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0);}
+}
+void q_3_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 32);
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(0).array() = (y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(1).array() = (x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*x;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*x;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(2).array() = -(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(3).array() = -x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*x;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*x;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(4).array() = y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = 1.4999999999999998*y;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*y;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(5).array() = x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(6).array() = -y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*y;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*y;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(7).array() = -(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 8.9999999999999982;
+val.col(8).array() = -(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(9).array() = -x*(x - 1)*(3.0*x - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 4.4999999999999991;
+val.col(10).array() = (y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(11).array() = x*(x - 1)*(3.0*x - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(12).array() = y*(y - 1)*(3.0*y - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 8.9999999999999982;
+val.col(13).array() = x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(14).array() = -y*(y - 1)*(3.0*y - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 4.4999999999999991;
+val.col(15).array() = -x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 4.4999999999999991;
+val.col(16).array() = -y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(17).array() = -x*(x - 1)*(3.0*x - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 8.9999999999999982;
+val.col(18).array() = y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(19).array() = x*(x - 1)*(3.0*x - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(20).array() = y*(y - 1)*(3.0*y - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 4.4999999999999991;
+val.col(21).array() = (x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(22).array() = -y*(y - 1)*(3.0*y - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 8.9999999999999982;
+val.col(23).array() = -(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(24).array() = y*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(25).array() = x*(x - 1)*(3.0*x - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(26).array() = -y*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(27).array() = -x*(x - 1)*(3.0*x - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(28).array() = -y*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(29).array() = -x*(x - 1)*(3.0*x - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(30).array() = y*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(31).array() = x*(x - 1)*(3.0*x - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+}
+
+void q_m2_basis_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 8);
+{val.col(0).array() = -1.0*(x - 1)*(y - 1)*(2*x + 2*y - 1);}
+{val.col(1).array() = 1.0*x*(y - 1)*(-2*x + 2*y + 1);}
+{val.col(2).array() = x*y*(2.0*x + 2.0*y - 3.0);}
+{val.col(3).array() = 1.0*y*(x - 1)*(2*x - 2*y + 1);}
+{val.col(4).array() = 4*x*(x - 1)*(y - 1);}
+{val.col(5).array() = -4*x*y*(y - 1);}
+{val.col(6).array() = -4*x*y*(x - 1);}
+{val.col(7).array() = 4*y*(x - 1)*(y - 1);}
+}
+void q_m2_basis_grad_values_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 16);
+{val.col(0).array() = -(y - 1)*(4.0*x + 2.0*y - 3.0);}
+{val.col(1).array() = -(x - 1)*(2.0*x + 4.0*y - 3.0);}
+{val.col(2).array() = (y - 1)*(-4.0*x + 2*y + 1);}
+{val.col(3).array() = -x*(2.0*x - 4.0*y + 1.0);}
+{val.col(4).array() = y*(4.0*x + 2.0*y - 3.0);}
+{val.col(5).array() = x*(2.0*x + 4.0*y - 3.0);}
+{val.col(6).array() = -y*(-4.0*x + 2.0*y + 1.0);}
+{val.col(7).array() = (x - 1)*(2.0*x - 4.0*y + 1.0);}
+{val.col(8).array() = 4*(2*x - 1)*(y - 1);}
+{val.col(9).array() = 4*x*(x - 1);}
+{val.col(10).array() = -4*y*(y - 1);}
+{val.col(11).array() = -4*x*(2*y - 1);}
+{val.col(12).array() = -4*y*(2*x - 1);}
+{val.col(13).array() = -4*x*(x - 1);}
+{val.col(14).array() = 4*y*(y - 1);}
+{val.col(15).array() = 4*(x - 1)*(2*y - 1);}
+}
+
+}
+
+void q_basis_values_2d(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(q){
+	case 0: q_0_basis_values_2d(uv, val); break;
+	case 1: q_1_basis_values_2d(uv, val); break;
+	case 2: q_2_basis_values_2d(uv, val); break;
+	case 3: q_3_basis_values_2d(uv, val); break;
+	case -2: q_m2_basis_values_2d(uv, val); break;
+	default: assert(false);
+}}
+
+void q_grad_basis_values_2d(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(q){
+	case 0: q_0_basis_grad_values_2d(uv, val); break;
+	case 1: q_1_basis_grad_values_2d(uv, val); break;
+	case 2: q_2_basis_grad_values_2d(uv, val); break;
+	case 3: q_3_basis_grad_values_2d(uv, val); break;
+	case -2: q_m2_basis_grad_values_2d(uv, val); break;
+	default: assert(false);
+}}
+}}
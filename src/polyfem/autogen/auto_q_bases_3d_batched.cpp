@@ -0,0 +1,1049 @@
+#include "auto_q_bases_3d_batched.hpp"
+
+
+namespace polyfem {
+namespace autogen {
+namespace {
+void q_0_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 1);
+{val.col(0).array().setOnes();}
+}
+void q_0_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 3);
+{val.col(0).array().setZero();}
+{val.col(1).array().setZero();}
+{val.col(2).array().setZero();}
+}
+
+void q_1_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 8);
+{val.col(0).array() = -1.0*(x - 1)*(y - 1)*(z - 1);}
+{val.col(1).array() = 1.0*x*(y - 1)*(z - 1);}
+{val.col(2).array() = -1.0*x*y*(z - 1);}
+{val.col(3).array() = 1.0*y*(x - 1)*(z - 1);}
+{val.col(4).array() = 1.0*z*(x - 1)*(y - 1);}
+{val.col(5).array() = -1.0*x*z*(y - 1);}
+{val.col(6).array() = 1.0*x*y*z;}
+{val.col(7).array() = -1.0*y*z*(x - 1);}
+}
+void q_1_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 24);
+{val.col(0).array() = -1.0*(y - 1)*(z - 1);}
+{val.col(1).array() = -1.0*(x - 1)*(z - 1);}
+{val.col(2).array() = -1.0*(x - 1)*(y - 1);}
+{val.col(3).array() = 1.0*(y - 1)*(z - 1);}
+{val.col(4).array() = 1.0*x*(z - 1);}
+{val.col(5).array() = 1.0*x*(y - 1);}
+{val.col(6).array() = -1.0*y*(z - 1);}
+{val.col(7).array() = -1.0*x*(z - 1);}
+{val.col(8).array() = -1.0*x*y;}
+{val.col(9).array() = 1.0*y*(z - 1);}
+{val.col(10).array() = 1.0*(x - 1)*(z - 1);}
+{val.col(11).array() = 1.0*y*(x - 1);}
+{val.col(12).array() = 1.0*z*(y - 1);}
+{val.col(13).array() = 1.0*z*(x - 1);}
+{val.col(14).array() = 1.0*(x - 1)*(y - 1);}
+{val.col(15).array() = -1.0*z*(y - 1);}
+{val.col(16).array() = -1.0*x*z;}
+{val.col(17).array() = -1.0*x*(y - 1);}
+{val.col(18).array() = 1.0*y*z;}
+{val.col(19).array() = 1.0*x*z;}
+{val.col(20).array() = 1.0*x*y;}
+{val.col(21).array() = -1.0*y*z;}
+{val.col(22).array() = -1.0*z*(x - 1);}
+{val.col(23).array() = -1.0*y*(x - 1);}
+}
+
+void q_2_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 27);
+{val.col(0).array() = 1.0*(x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(1).array() = 1.0*x*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(2).array() = 1.0*x*y*(2.0*x - 1.0)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(3).array() = 1.0*y*(x - 1)*(2.0*x - 1.0)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(4).array() = 1.0*z*(x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(5).array() = 1.0*x*z*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(6).array() = 1.0*x*y*z*(2.0*x - 1.0)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(7).array() = 1.0*y*z*(x - 1)*(2.0*x - 1.0)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(8).array() = -4.0*x*(x - 1)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(9).array() = -4.0*x*y*(2.0*x - 1.0)*(y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(10).array() = -4.0*x*y*(x - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(11).array() = -4.0*y*(x - 1)*(2.0*x - 1.0)*(y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(12).array() = -4.0*z*(x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(13).array() = -4.0*x*z*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(14).array() = -4.0*x*y*z*(2.0*x - 1.0)*(2.0*y - 1.0)*(z - 1);}
+{val.col(15).array() = -4.0*y*z*(x - 1)*(2.0*x - 1.0)*(2.0*y - 1.0)*(z - 1);}
+{val.col(16).array() = -4.0*x*z*(x - 1)*(y - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(17).array() = -4.0*x*y*z*(2.0*x - 1.0)*(y - 1)*(2.0*z - 1.0);}
+{val.col(18).array() = -4.0*x*y*z*(x - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(19).array() = -4.0*y*z*(x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*z - 1.0);}
+{val.col(20).array() = 16.0*y*z*(x - 1)*(2.0*x - 1.0)*(y - 1)*(z - 1);}
+{val.col(21).array() = 16.0*x*y*z*(2.0*x - 1.0)*(y - 1)*(z - 1);}
+{val.col(22).array() = 16.0*x*z*(x - 1)*(y - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(23).array() = 16.0*x*y*z*(x - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(24).array() = 16.0*x*y*(x - 1)*(y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(25).array() = 16.0*x*y*z*(x - 1)*(y - 1)*(2.0*z - 1.0);}
+{val.col(26).array() = -64.0*x*y*z*(x - 1)*(y - 1)*(z - 1);}
+}
+void q_2_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 81);
+{val.col(0).array() = (4.0*x - 3.0)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(1).array() = (x - 1)*(2.0*x - 1.0)*(4.0*y - 3.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(2).array() = (x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(4.0*z - 3.0);}
+{val.col(3).array() = (4.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(4).array() = x*(2.0*x - 1.0)*(4.0*y - 3.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(5).array() = x*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(4.0*z - 3.0);}
+{val.col(6).array() = y*(4.0*x - 1.0)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(7).array() = x*(2.0*x - 1.0)*(4.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(8).array() = x*y*(2.0*x - 1.0)*(2.0*y - 1.0)*(4.0*z - 3.0);}
+{val.col(9).array() = y*(4.0*x - 3.0)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(10).array() = (x - 1)*(2.0*x - 1.0)*(4.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(11).array() = y*(x - 1)*(2.0*x - 1.0)*(2.0*y - 1.0)*(4.0*z - 3.0);}
+{val.col(12).array() = z*(4.0*x - 3.0)*(y - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(13).array() = z*(x - 1)*(2.0*x - 1.0)*(4.0*y - 3.0)*(2.0*z - 1.0);}
+{val.col(14).array() = (x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(4.0*z - 1.0);}
+{val.col(15).array() = z*(4.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(16).array() = x*z*(2.0*x - 1.0)*(4.0*y - 3.0)*(2.0*z - 1.0);}
+{val.col(17).array() = x*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(4.0*z - 1.0);}
+{val.col(18).array() = y*z*(4.0*x - 1.0)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(19).array() = x*z*(2.0*x - 1.0)*(4.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(20).array() = x*y*(2.0*x - 1.0)*(2.0*y - 1.0)*(4.0*z - 1.0);}
+{val.col(21).array() = y*z*(4.0*x - 3.0)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(22).array() = z*(x - 1)*(2.0*x - 1.0)*(4.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(23).array() = y*(x - 1)*(2.0*x - 1.0)*(2.0*y - 1.0)*(4.0*z - 1.0);}
+{val.col(24).array() = -4.0*(2*x - 1)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(25).array() = -x*(x - 1)*(16.0*y - 12.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(26).array() = -x*(x - 1)*(y - 1)*(2.0*y - 1.0)*(16.0*z - 12.0);}
+{val.col(27).array() = -y*(16.0*x - 4.0)*(y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(28).array() = -4.0*x*(2.0*x - 1.0)*(2*y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(29).array() = -x*y*(2.0*x - 1.0)*(y - 1)*(16.0*z - 12.0);}
+{val.col(30).array() = -4.0*y*(2*x - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(31).array() = -x*(x - 1)*(16.0*y - 4.0)*(z - 1)*(2.0*z - 1.0);}
+{val.col(32).array() = -x*y*(x - 1)*(2.0*y - 1.0)*(16.0*z - 12.0);}
+{val.col(33).array() = -y*(16.0*x - 12.0)*(y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(34).array() = -4.0*(x - 1)*(2.0*x - 1.0)*(2*y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(35).array() = -y*(x - 1)*(2.0*x - 1.0)*(y - 1)*(16.0*z - 12.0);}
+{val.col(36).array() = -z*(16.0*x - 12.0)*(y - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(37).array() = -z*(x - 1)*(2.0*x - 1.0)*(16.0*y - 12.0)*(z - 1);}
+{val.col(38).array() = -4.0*(x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(2*z - 1);}
+{val.col(39).array() = -z*(16.0*x - 4.0)*(y - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(40).array() = -x*z*(2.0*x - 1.0)*(16.0*y - 12.0)*(z - 1);}
+{val.col(41).array() = -4.0*x*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(2*z - 1);}
+{val.col(42).array() = -y*z*(16.0*x - 4.0)*(2.0*y - 1.0)*(z - 1);}
+{val.col(43).array() = -x*z*(2.0*x - 1.0)*(16.0*y - 4.0)*(z - 1);}
+{val.col(44).array() = -4.0*x*y*(2.0*x - 1.0)*(2.0*y - 1.0)*(2*z - 1);}
+{val.col(45).array() = -y*z*(16.0*x - 12.0)*(2.0*y - 1.0)*(z - 1);}
+{val.col(46).array() = -z*(x - 1)*(2.0*x - 1.0)*(16.0*y - 4.0)*(z - 1);}
+{val.col(47).array() = -4.0*y*(x - 1)*(2.0*x - 1.0)*(2.0*y - 1.0)*(2*z - 1);}
+{val.col(48).array() = -4.0*z*(2*x - 1)*(y - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(49).array() = -x*z*(x - 1)*(16.0*y - 12.0)*(2.0*z - 1.0);}
+{val.col(50).array() = -x*(x - 1)*(y - 1)*(2.0*y - 1.0)*(16.0*z - 4.0);}
+{val.col(51).array() = -y*z*(16.0*x - 4.0)*(y - 1)*(2.0*z - 1.0);}
+{val.col(52).array() = -4.0*x*z*(2.0*x - 1.0)*(2*y - 1)*(2.0*z - 1.0);}
+{val.col(53).array() = -x*y*(2.0*x - 1.0)*(y - 1)*(16.0*z - 4.0);}
+{val.col(54).array() = -4.0*y*z*(2*x - 1)*(2.0*y - 1.0)*(2.0*z - 1.0);}
+{val.col(55).array() = -x*z*(x - 1)*(16.0*y - 4.0)*(2.0*z - 1.0);}
+{val.col(56).array() = -x*y*(x - 1)*(2.0*y - 1.0)*(16.0*z - 4.0);}
+{val.col(57).array() = -y*z*(16.0*x - 12.0)*(y - 1)*(2.0*z - 1.0);}
+{val.col(58).array() = -4.0*z*(x - 1)*(2.0*x - 1.0)*(2*y - 1)*(2.0*z - 1.0);}
+{val.col(59).array() = -y*(x - 1)*(2.0*x - 1.0)*(y - 1)*(16.0*z - 4.0);}
+{val.col(60).array() = y*z*(64.0*x - 48.0)*(y - 1)*(z - 1);}
+{val.col(61).array() = 16.0*z*(x - 1)*(2.0*x - 1.0)*(2*y - 1)*(z - 1);}
+{val.col(62).array() = 16.0*y*(x - 1)*(2.0*x - 1.0)*(y - 1)*(2*z - 1);}
+{val.col(63).array() = y*z*(64.0*x - 16.0)*(y - 1)*(z - 1);}
+{val.col(64).array() = 16.0*x*z*(2.0*x - 1.0)*(2*y - 1)*(z - 1);}
+{val.col(65).array() = 16.0*x*y*(2.0*x - 1.0)*(y - 1)*(2*z - 1);}
+{val.col(66).array() = 16.0*z*(2*x - 1)*(y - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(67).array() = x*z*(x - 1)*(64.0*y - 48.0)*(z - 1);}
+{val.col(68).array() = 16.0*x*(x - 1)*(y - 1)*(2.0*y - 1.0)*(2*z - 1);}
+{val.col(69).array() = 16.0*y*z*(2*x - 1)*(2.0*y - 1.0)*(z - 1);}
+{val.col(70).array() = x*z*(x - 1)*(64.0*y - 16.0)*(z - 1);}
+{val.col(71).array() = 16.0*x*y*(x - 1)*(2.0*y - 1.0)*(2*z - 1);}
+{val.col(72).array() = 16.0*y*(2*x - 1)*(y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(73).array() = 16.0*x*(x - 1)*(2*y - 1)*(z - 1)*(2.0*z - 1.0);}
+{val.col(74).array() = x*y*(x - 1)*(y - 1)*(64.0*z - 48.0);}
+{val.col(75).array() = 16.0*y*z*(2*x - 1)*(y - 1)*(2.0*z - 1.0);}
+{val.col(76).array() = 16.0*x*z*(x - 1)*(2*y - 1)*(2.0*z - 1.0);}
+{val.col(77).array() = x*y*(x - 1)*(y - 1)*(64.0*z - 16.0);}
+{val.col(78).array() = -64.0*y*z*(2*x - 1)*(y - 1)*(z - 1);}
+{val.col(79).array() = -64.0*x*z*(x - 1)*(2*y - 1)*(z - 1);}
+{val.col(80).array() = -64.0*x*y*(x - 1)*(y - 1)*(2*z - 1);}
+}
+
+void q_3_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 64);
+{val.col(0).array() = -1.0*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(1).array() = 1.0*x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(2).array() = -1.0*x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(3).array() = 1.0*y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(4).array() = 1.0*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(5).array() = -1.0*x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(6).array() = 1.0*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(7).array() = -1.0*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(8).array() = 4.4999999999999991*x*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(9).array() = -4.4999999999999991*x*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(10).array() = -4.4999999999999991*x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(11).array() = 4.4999999999999991*x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(12).array() = 4.4999999999999991*x*y*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(13).array() = -4.4999999999999991*x*y*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(14).array() = -4.4999999999999991*y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(15).array() = 4.4999999999999991*y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(16).array() = 4.4999999999999991*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(17).array() = -4.4999999999999991*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(18).array() = 4.4999999999999991*x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(19).array() = -4.4999999999999991*x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(20).array() = -4.4999999999999991*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0);}
+{val.col(21).array() = 4.4999999999999991*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0);}
+{val.col(22).array() = 4.4999999999999991*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0);}
+{val.col(23).array() = -4.4999999999999991*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0);}
+{val.col(24).array() = -4.4999999999999991*x*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(25).array() = 4.4999999999999991*x*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(26).array() = 4.4999999999999991*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(27).array() = -4.4999999999999991*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(28).array() = -4.4999999999999991*x*y*z*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(29).array() = 4.4999999999999991*x*y*z*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(30).array() = 4.4999999999999991*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(31).array() = -4.4999999999999991*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(32).array() = -20.249999999999993*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(33).array() = 20.249999999999993*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(34).array() = 20.249999999999993*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(35).array() = -20.249999999999993*y*z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(36).array() = 20.249999999999993*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(37).array() = -20.249999999999993*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(38).array() = -20.249999999999993*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(39).array() = 20.249999999999993*x*y*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(40).array() = -20.249999999999993*x*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(41).array() = 20.249999999999993*x*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(42).array() = 20.249999999999993*x*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(43).array() = -20.249999999999993*x*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(44).array() = 20.249999999999993*x*y*z*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0);}
+{val.col(45).array() = -20.249999999999993*x*y*z*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0);}
+{val.col(46).array() = -20.249999999999993*x*y*z*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0);}
+{val.col(47).array() = 20.249999999999993*x*y*z*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0);}
+{val.col(48).array() = -20.249999999999993*x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(49).array() = 20.249999999999993*x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(50).array() = 20.249999999999993*x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(51).array() = -20.249999999999993*x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0);}
+{val.col(52).array() = 20.249999999999993*x*y*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(53).array() = -20.249999999999993*x*y*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(54).array() = -20.249999999999993*x*y*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(55).array() = 20.249999999999993*x*y*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996);}
+{val.col(56).array() = 91.124999999999957*x*y*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(57).array() = -91.124999999999957*x*y*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(58).array() = -91.124999999999957*x*y*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(59).array() = 91.124999999999957*x*y*z*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(60).array() = -91.124999999999957*x*y*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(61).array() = 91.124999999999957*x*y*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0);}
+{val.col(62).array() = 91.124999999999957*x*y*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0);}
+{val.col(63).array() = -91.124999999999957*x*y*z*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0);}
+}
+void q_3_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 192);
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(0).array() = -(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(1).array() = -(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(2).array() = -(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*x;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*x;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(3).array() = (y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(4).array() = x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(5).array() = x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*x;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*x;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(6).array() = -y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = 1.4999999999999998*y;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*y;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(7).array() = -x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(8).array() = -x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(9).array() = y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*y;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*y;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(10).array() = (x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(11).array() = y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(12).array() = z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(13).array() = z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*z;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*z;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(14).array() = (x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = 1.4999999999999998*x;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*x;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(15).array() = -z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(16).array() = -x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*z;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*z;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(17).array() = -x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = 1.4999999999999998*x;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*x;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(18).array() = y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = 1.4999999999999998*y;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*y;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(19).array() = x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = 1.4999999999999998*z;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*z;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(20).array() = x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(21).array() = -y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(3.0*helper_0*helper_1 + 1.5*helper_0*helper_2 + 1.0*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*y;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*y;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(22).array() = -z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = 1.4999999999999998*z;
+const auto helper_1 = helper_0 - 0.49999999999999989;
+const auto helper_2 = 2.9999999999999996*z;
+const auto helper_3 = helper_2 - 1.9999999999999996;
+val.col(23).array() = -y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_3 + helper_1*helper_2 + 1.0*helper_1*helper_3);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 8.9999999999999982;
+val.col(24).array() = (y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(25).array() = x*(x - 1)*(3.0*x - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(26).array() = x*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 4.4999999999999991;
+val.col(27).array() = -(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(28).array() = -x*(x - 1)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(29).array() = -x*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(30).array() = -y*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 8.9999999999999982;
+val.col(31).array() = -x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(32).array() = -x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(33).array() = y*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 4.4999999999999991;
+val.col(34).array() = x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(35).array() = x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 4.4999999999999991;
+val.col(36).array() = y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(37).array() = x*(x - 1)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(38).array() = x*y*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 8.9999999999999982;
+val.col(39).array() = -y*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(40).array() = -x*(x - 1)*(3.0*x - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(41).array() = -x*y*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(42).array() = -y*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 4.4999999999999991;
+val.col(43).array() = -(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(44).array() = -y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(45).array() = y*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 8.9999999999999982;
+val.col(46).array() = (x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(47).array() = y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(48).array() = z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(49).array() = z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 8.9999999999999982;
+val.col(50).array() = (x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(51).array() = -z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(52).array() = -z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 4.4999999999999991;
+val.col(53).array() = -(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(54).array() = z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(55).array() = x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 4.4999999999999991;
+val.col(56).array() = x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(57).array() = -z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(58).array() = -x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 8.9999999999999982;
+val.col(59).array() = -x*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(60).array() = -y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(61).array() = -x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 4.4999999999999991;
+val.col(62).array() = -x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(63).array() = y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(64).array() = x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 8.9999999999999982;
+val.col(65).array() = x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(66).array() = y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(67).array() = z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 4.4999999999999991;
+val.col(68).array() = y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(69).array() = -y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(70).array() = -z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 13.499999999999996*z - 8.9999999999999982;
+val.col(71).array() = -y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 8.9999999999999982;
+val.col(72).array() = -z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(73).array() = -x*z*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(74).array() = -x*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 4.4999999999999991;
+val.col(75).array() = z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(76).array() = x*z*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(77).array() = x*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(78).array() = y*z*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 8.9999999999999982;
+val.col(79).array() = x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(80).array() = x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(81).array() = -y*z*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*x + 6.7499999999999973*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 4.4999999999999991;
+val.col(82).array() = -x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(83).array() = -x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 4.4999999999999991;
+val.col(84).array() = -y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(85).array() = -x*z*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(86).array() = -x*y*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 13.499999999999996*x - 8.9999999999999982;
+val.col(87).array() = y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(88).array() = x*z*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*y + 6.7499999999999973*helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(89).array() = x*y*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(90).array() = y*z*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 4.4999999999999991;
+val.col(91).array() = z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(92).array() = y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(93).array() = -y*z*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(13.499999999999998*helper_0*helper_1 + 6.7499999999999991*helper_0*helper_2 + 4.4999999999999991*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 13.499999999999996*y - 8.9999999999999982;
+val.col(94).array() = -z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 13.499999999999998*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(95).array() = -y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(4.4999999999999991*helper_0*helper_1 + 13.499999999999995*helper_0*z + 6.7499999999999973*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(96).array() = -y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(97).array() = -z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(98).array() = -y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(99).array() = y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(100).array() = z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(101).array() = y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(102).array() = y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(103).array() = z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(104).array() = y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 1.5*x - 1.0;
+const auto helper_2 = 3.0*x - 1.0;
+val.col(105).array() = -y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(106).array() = -z*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(107).array() = -y*(x - 1)*(1.5*x - 1.0)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(108).array() = y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*x + 30.374999999999986*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(109).array() = x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(110).array() = x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(111).array() = -y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*x + 30.374999999999986*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(112).array() = -x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(113).array() = -x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(114).array() = -y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*x + 30.374999999999986*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(115).array() = -x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(116).array() = -x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = 1.4999999999999998*x - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*x - 1.9999999999999996;
+val.col(117).array() = y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*x + 30.374999999999986*helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(118).array() = x*z*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(119).array() = x*y*(1.4999999999999998*x - 0.49999999999999989)*(2.9999999999999996*x - 1.9999999999999996)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(120).array() = -z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(121).array() = -x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 2.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(122).array() = -x*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(123).array() = z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(124).array() = x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 1.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(125).array() = x*(x - 1)*(3.0*x - 2.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(126).array() = z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(127).array() = x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(128).array() = x*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(129).array() = -z*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 1.5*y - 1.0;
+const auto helper_2 = 3.0*y - 1.0;
+val.col(130).array() = -x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(131).array() = -x*(x - 1)*(3.0*x - 1.0)*(y - 1)*(1.5*y - 1.0)*(3.0*y - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(132).array() = y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(133).array() = x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 2.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*y + 30.374999999999986*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(134).array() = x*y*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(135).array() = -y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(136).array() = -x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 1.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*y + 30.374999999999986*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(137).array() = -x*y*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(138).array() = -y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(139).array() = -x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*y + 30.374999999999986*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 40.499999999999986;
+val.col(140).array() = -x*y*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(141).array() = y*z*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = 1.4999999999999998*y - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*y - 1.9999999999999996;
+val.col(142).array() = x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*y + 30.374999999999986*helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 60.749999999999979*z - 20.249999999999993;
+val.col(143).array() = x*y*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*y - 0.49999999999999989)*(2.9999999999999996*y - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(144).array() = -y*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(145).array() = -x*(x - 1)*(3.0*x - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(146).array() = -x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(147).array() = y*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(148).array() = x*(x - 1)*(3.0*x - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(149).array() = x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(150).array() = y*(y - 1)*(3.0*y - 2.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(151).array() = x*(x - 1)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(152).array() = x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(153).array() = -y*(y - 1)*(3.0*y - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(154).array() = -x*(x - 1)*(3.0*x - 1.0)*(z - 1)*(1.5*z - 1.0)*(3.0*z - 1.0)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 1.5*z - 1.0;
+const auto helper_2 = 3.0*z - 1.0;
+val.col(155).array() = -x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(60.749999999999979*helper_0*helper_1 + 30.374999999999989*helper_0*helper_2 + 20.249999999999993*helper_1*helper_2);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(156).array() = y*z*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(157).array() = x*z*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(158).array() = x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*z + 30.374999999999986*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 40.499999999999986;
+val.col(159).array() = -y*z*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(160).array() = -x*z*(x - 1)*(3.0*x - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(161).array() = -x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*z + 30.374999999999986*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(162).array() = -y*z*(y - 1)*(3.0*y - 2.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 40.499999999999986;
+val.col(163).array() = -x*z*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(164).array() = -x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*z + 30.374999999999986*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 60.749999999999979*x - 20.249999999999993;
+val.col(165).array() = y*z*(y - 1)*(3.0*y - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 60.749999999999979*y - 20.249999999999993;
+val.col(166).array() = x*z*(x - 1)*(3.0*x - 1.0)*(1.4999999999999998*z - 0.49999999999999989)*(2.9999999999999996*z - 1.9999999999999996)*(helper_0*helper_1 + 60.749999999999979*helper_0*y + helper_1*y);}
+{const auto helper_0 = 1.4999999999999998*z - 0.49999999999999989;
+const auto helper_1 = 2.9999999999999996*z - 1.9999999999999996;
+val.col(167).array() = x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(20.249999999999993*helper_0*helper_1 + 60.749999999999972*helper_0*z + 30.374999999999986*helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 182.24999999999991;
+val.col(168).array() = y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 182.24999999999991;
+val.col(169).array() = x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 182.24999999999991;
+val.col(170).array() = x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 182.24999999999991;
+val.col(171).array() = -y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 182.24999999999991;
+val.col(172).array() = -x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 91.124999999999957;
+val.col(173).array() = -x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 182.24999999999991;
+val.col(174).array() = -y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 91.124999999999957;
+val.col(175).array() = -x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 182.24999999999991;
+val.col(176).array() = -x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 182.24999999999991;
+val.col(177).array() = y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 91.124999999999957;
+val.col(178).array() = x*z*(x - 1)*(3.0*x - 2.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 91.124999999999957;
+val.col(179).array() = x*y*(x - 1)*(3.0*x - 2.0)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 91.124999999999957;
+val.col(180).array() = -y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 182.24999999999991;
+val.col(181).array() = -x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 182.24999999999991;
+val.col(182).array() = -x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 91.124999999999957;
+val.col(183).array() = y*z*(y - 1)*(3.0*y - 2.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 182.24999999999991;
+val.col(184).array() = x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 91.124999999999957;
+val.col(185).array() = x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 91.124999999999957;
+val.col(186).array() = y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 91.124999999999957;
+val.col(187).array() = x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 2.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 182.24999999999991;
+val.col(188).array() = x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+{const auto helper_0 = x - 1;
+const auto helper_1 = 273.37499999999989*x - 91.124999999999957;
+val.col(189).array() = -y*z*(y - 1)*(3.0*y - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*x + helper_1*x);}
+{const auto helper_0 = y - 1;
+const auto helper_1 = 273.37499999999989*y - 91.124999999999957;
+val.col(190).array() = -x*z*(x - 1)*(3.0*x - 1.0)*(z - 1)*(3.0*z - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*y + helper_1*y);}
+{const auto helper_0 = z - 1;
+const auto helper_1 = 273.37499999999989*z - 91.124999999999957;
+val.col(191).array() = -x*y*(x - 1)*(3.0*x - 1.0)*(y - 1)*(3.0*y - 1.0)*(helper_0*helper_1 + 273.37499999999989*helper_0*z + helper_1*z);}
+}
+
+void q_m2_basis_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 20);
+{val.col(0).array() = 1.0*(x - 1)*(y - 1)*(z - 1)*(2*x + 2*y + 2*z - 1);}
+{val.col(1).array() = -1.0*x*(y - 1)*(z - 1)*(-2*x + 2*y + 2*z + 1);}
+{val.col(2).array() = -1.0*x*y*(z - 1)*(2*x + 2*y - 2*z - 3);}
+{val.col(3).array() = -1.0*y*(x - 1)*(z - 1)*(2*x - 2*y + 2*z + 1);}
+{val.col(4).array() = -1.0*z*(x - 1)*(y - 1)*(2*x + 2*y - 2*z + 1);}
+{val.col(5).array() = -1.0*x*z*(y - 1)*(2*x - 2*y + 2*z - 3);}
+{val.col(6).array() = x*y*z*(2.0*x + 2.0*y + 2.0*z - 5.0);}
+{val.col(7).array() = 1.0*y*z*(x - 1)*(2*x - 2*y - 2*z + 3);}
+{val.col(8).array() = -4*x*(x - 1)*(y - 1)*(z - 1);}
+{val.col(9).array() = 4*x*y*(y - 1)*(z - 1);}
+{val.col(10).array() = 4*x*y*(x - 1)*(z - 1);}
+{val.col(11).array() = -4*y*(x - 1)*(y - 1)*(z - 1);}
+{val.col(12).array() = -4*z*(x - 1)*(y - 1)*(z - 1);}
+{val.col(13).array() = 4*x*z*(y - 1)*(z - 1);}
+{val.col(14).array() = -4*x*y*z*(z - 1);}
+{val.col(15).array() = 4*y*z*(x - 1)*(z - 1);}
+{val.col(16).array() = 4*x*z*(x - 1)*(y - 1);}
+{val.col(17).array() = -4*x*y*z*(y - 1);}
+{val.col(18).array() = -4*x*y*z*(x - 1);}
+{val.col(19).array() = 4*y*z*(x - 1)*(y - 1);}
+}
+void q_m2_basis_grad_values_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 60);
+{val.col(0).array() = (y - 1)*(z - 1)*(4.0*x + 2*y + 2*z - 3.0);}
+{val.col(1).array() = (x - 1)*(z - 1)*(2.0*x + 4.0*y + 2.0*z - 3.0);}
+{val.col(2).array() = (x - 1)*(y - 1)*(2.0*x + 2.0*y + 4.0*z - 3.0);}
+{val.col(3).array() = -(y - 1)*(z - 1)*(-4.0*x + 2.0*y + 2.0*z + 1.0);}
+{val.col(4).array() = x*(z - 1)*(2.0*x - 4.0*y - 2.0*z + 1.0);}
+{val.col(5).array() = x*(y - 1)*(2.0*x - 2.0*y - 4.0*z + 1.0);}
+{val.col(6).array() = -y*(z - 1)*(4.0*x + 2.0*y - 2.0*z - 3.0);}
+{val.col(7).array() = -x*(z - 1)*(2.0*x + 4.0*y - 2.0*z - 3.0);}
+{val.col(8).array() = -x*y*(2.0*x + 2.0*y - 4.0*z - 1.0);}
+{val.col(9).array() = -y*(z - 1)*(4.0*x - 2.0*y + 2.0*z - 1.0);}
+{val.col(10).array() = -(x - 1)*(z - 1)*(2.0*x - 4.0*y + 2.0*z + 1.0);}
+{val.col(11).array() = -y*(x - 1)*(2.0*x - 2.0*y + 4.0*z - 1.0);}
+{val.col(12).array() = -z*(y - 1)*(4.0*x + 2.0*y - 2.0*z - 1.0);}
+{val.col(13).array() = -z*(x - 1)*(2.0*x + 4.0*y - 2.0*z - 1.0);}
+{val.col(14).array() = -(x - 1)*(y - 1)*(2.0*x + 2.0*y - 4.0*z + 1.0);}
+{val.col(15).array() = -z*(y - 1)*(4.0*x - 2.0*y + 2.0*z - 3.0);}
+{val.col(16).array() = -x*z*(2.0*x - 4.0*y + 2.0*z - 1.0);}
+{val.col(17).array() = -x*(y - 1)*(2.0*x - 2.0*y + 4.0*z - 3.0);}
+{val.col(18).array() = y*z*(4.0*x + 2.0*y + 2.0*z - 5.0);}
+{val.col(19).array() = x*z*(2.0*x + 4.0*y + 2.0*z - 5.0);}
+{val.col(20).array() = x*y*(2.0*x + 2.0*y + 4.0*z - 5.0);}
+{val.col(21).array() = y*z*(4.0*x - 2.0*y - 2.0*z + 1.0);}
+{val.col(22).array() = z*(x - 1)*(2.0*x - 4.0*y - 2.0*z + 3.0);}
+{val.col(23).array() = y*(x - 1)*(2.0*x - 2.0*y - 4.0*z + 3.0);}
+{val.col(24).array() = -4*(2*x - 1)*(y - 1)*(z - 1);}
+{val.col(25).array() = -4*x*(x - 1)*(z - 1);}
+{val.col(26).array() = -4*x*(x - 1)*(y - 1);}
+{val.col(27).array() = 4*y*(y - 1)*(z - 1);}
+{val.col(28).array() = 4*x*(2*y - 1)*(z - 1);}
+{val.col(29).array() = 4*x*y*(y - 1);}
+{val.col(30).array() = 4*y*(2*x - 1)*(z - 1);}
+{val.col(31).array() = 4*x*(x - 1)*(z - 1);}
+{val.col(32).array() = 4*x*y*(x - 1);}
+{val.col(33).array() = -4*y*(y - 1)*(z - 1);}
+{val.col(34).array() = -4*(x - 1)*(2*y - 1)*(z - 1);}
+{val.col(35).array() = -4*y*(x - 1)*(y - 1);}
+{val.col(36).array() = -4*z*(y - 1)*(z - 1);}
+{val.col(37).array() = -4*z*(x - 1)*(z - 1);}
+{val.col(38).array() = -4*(x - 1)*(y - 1)*(2*z - 1);}
+{val.col(39).array() = 4*z*(y - 1)*(z - 1);}
+{val.col(40).array() = 4*x*z*(z - 1);}
+{val.col(41).array() = 4*x*(y - 1)*(2*z - 1);}
+{val.col(42).array() = -4*y*z*(z - 1);}
+{val.col(43).array() = -4*x*z*(z - 1);}
+{val.col(44).array() = -4*x*y*(2*z - 1);}
+{val.col(45).array() = 4*y*z*(z - 1);}
+{val.col(46).array() = 4*z*(x - 1)*(z - 1);}
+{val.col(47).array() = 4*y*(x - 1)*(2*z - 1);}
+{val.col(48).array() = 4*z*(2*x - 1)*(y - 1);}
+{val.col(49).array() = 4*x*z*(x - 1);}
+{val.col(50).array() = 4*x*(x - 1)*(y - 1);}
+{val.col(51).array() = -4*y*z*(y - 1);}
+{val.col(52).array() = -4*x*z*(2*y - 1);}
+{val.col(53).array() = -4*x*y*(y - 1);}
+{val.col(54).array() = -4*y*z*(2*x - 1);}
+{val.col(55).array() = -4*x*z*(x - 1);}
+{val.col(56).array() = -4*x*y*(x - 1);}
+{val.col(57).array() = 4*y*z*(y - 1);}
+{val.col(58).array() = 4*z*(x - 1)*(2*y - 1);}
+{val.col(59).array() = 4*y*(x - 1)*(y - 1);}
+}
+
+}
+
+void q_basis_values_3d(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(q){
+	case 0: q_0_basis_values_3d(uv, val); break;
+	case 1: q_1_basis_values_3d(uv, val); break;
+	case 2: q_2_basis_values_3d(uv, val); break;
+	case 3: q_3_basis_values_3d(uv, val); break;
+	case -2: q_m2_basis_values_3d(uv, val); break;
+	default: assert(false);
+}}
+
+void q_grad_basis_values_3d(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+switch(q){
+	case 0: q_0_basis_grad_values_3d(uv, val); break;
+	case 1: q_1_basis_grad_values_3d(uv, val); break;
+	case 2: q_2_basis_grad_values_3d(uv, val); break;
+	case 3: q_3_basis_grad_values_3d(uv, val); break;
+	case -2: q_m2_basis_grad_values_3d(uv, val); break;
+	default: assert(false);
+}}
+}}
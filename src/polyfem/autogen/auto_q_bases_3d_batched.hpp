@@ -0,0 +1,13 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <cassert>
+
+namespace polyfem {
+namespace autogen {
+void q_basis_values_3d(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+void q_grad_basis_values_3d(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+
+}}
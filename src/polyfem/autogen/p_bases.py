@@ -185,6 +185,14 @@ if __name__ == "__main__":
     hpp = "#pragma once\n\n#include <Eigen/Dense>\n#include \"p_n_bases.hpp\"\n#include <cassert>\n\n"
     hpp = hpp + "namespace polyfem {\nnamespace autogen " + "{\n"
 
+    # all the bases of an element at once
+    bcpp = "#include \"auto_p_bases_batched.hpp\"\n\n\n"
+    bcpp = bcpp + \
+        "namespace polyfem {\nnamespace autogen " + "{\nnamespace " + "{\n"
+
+    bhpp = "#pragma once\n\n#include <Eigen/Dense>\n#include \"p_n_bases.hpp\"\n#include <cassert>\n\n"
+    bhpp = bhpp + "namespace polyfem {\nnamespace autogen " + "{\n"
+
     for dim in dims:
         print(str(dim) + "D")
         suffix = "_2d" if dim == 2 else "_3d"
@@ -202,6 +210,18 @@ if __name__ == "__main__":
         hpp = hpp + unique_fun + ";\n\n"
         hpp = hpp + dunique_fun + ";\n\n"
 
+        # val.col(i) is the basis i, val.middleCols(dim * i, dim) its gradient
+        batched_fun = "void p_basis_values" + suffix + \
+            "(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+        dbatched_fun = "void p_grad_basis_values" + suffix + \
+            "(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+
+        bhpp = bhpp + batched_fun + ";\n\n"
+        bhpp = bhpp + dbatched_fun + ";\n\n"
+
+        batched_fun = batched_fun + "{\nswitch(p)" + "{\n"
+        dbatched_fun = dbatched_fun + "{\nswitch(p)" + "{\n"
+
         unique_nodes = unique_nodes + "{\nswitch(p)" + "{\n"
 
         unique_fun = unique_fun + "{\nswitch(p)" + "{\n"
@@ -395,9 +415,21 @@ if __name__ == "__main__":
             # hpp = hpp + func + ";\n"
             # hpp = hpp + dfunc + ";\n"
 
+            bfunc = "void p_" + str(order) + "_basis_values" + suffix + \
+                "(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+            dbfunc = "void p_" + str(order) + "_basis_grad_values" + suffix + \
+                "(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+
+            batched_fun = batched_fun + "\tcase " + str(order) + ": " + "p_" + str(
+                order) + "_basis_values" + suffix + "(uv, val); break;\n"
+            dbatched_fun = dbatched_fun + "\tcase " + str(order) + ": " + "p_" + str(
+                order) + "_basis_grad_values" + suffix + "(uv, val); break;\n"
+
             default_base = "p_n_basis_value_3d(p, local_index, uv, val);" if dim == 3 else "p_n_basis_value_2d(p, local_index, uv, val);"
             default_dbase = "p_n_basis_grad_value_3d(p, local_index, uv, val);" if dim == 3 else "p_n_basis_grad_value_2d(p, local_index, uv, val);"
             default_nodes = "p_n_nodes_3d(p, val);" if dim == 3 else "p_n_nodes_2d(p, val);"
+            default_bbase = "p_n_basis_values" + suffix + "(p, uv, val);"
+            default_dbbase = "p_n_basis_grad_values" + suffix + "(p, uv, val);"
 
             base = "auto x=uv.col(0).array();\nauto y=uv.col(1).array();"
             if dim == 3:
@@ -405,6 +437,11 @@ if __name__ == "__main__":
             base = base + "\n\n"
             dbase = base
 
+            # every basis is a single Eigen expression over all the points, written in place in its column
+            bbase = base + "val.resize(uv.rows(), " + str(fe.nbf()) + ");\n"
+            dbbase = base + "val.resize(uv.rows(), " + \
+                str(dim * fe.nbf()) + ");\n"
+
             if order == 0:
                 base = base + "result_0.resize(x.size(),1);\n"
 
@@ -430,6 +467,13 @@ if __name__ == "__main__":
 
                 dbase = dbase + "} break;\n"
 
+                bbase = bbase + "{" + \
+                    pretty_print.C99_print_column(
+                        simplify(fe.N[real_index]), i) + "}\n"
+                for d, v in enumerate([x, y, z][:dim]):
+                    dbbase = dbbase + "{" + pretty_print.C99_print_column(
+                        simplify(diff(fe.N[real_index], v)), dim * i + d) + "}\n"
+
             base = base + "\tdefault: assert(false);\n}"
             dbase = dbase + "\tdefault: assert(false);\n}"
 
@@ -439,6 +483,12 @@ if __name__ == "__main__":
             cpp = cpp + dfunc + "{\n\n"
             cpp = cpp + dbase + "}\n\n\n" + nodes + "\n\n\n"
 
+            bcpp = bcpp + bfunc + "{\n\n"
+            bcpp = bcpp + bbase + "}\n"
+
+            bcpp = bcpp + dbfunc + "{\n\n"
+            bcpp = bcpp + dbbase + "}\n\n\n"
+
         unique_nodes = unique_nodes + "\tdefault: "+default_nodes+"\n}}"
 
         unique_fun = unique_fun + "\tdefault: "+default_base+"\n}}"
@@ -448,11 +498,21 @@ if __name__ == "__main__":
             "\n\n" + dunique_fun + "\n" + "\nnamespace " + "{\n"
         hpp = hpp + "\n"
 
+        batched_fun = batched_fun + "\tdefault: "+default_bbase+"\n}}"
+        dbatched_fun = dbatched_fun + "\tdefault: "+default_dbbase+"\n}}"
+
+        bcpp = bcpp + "}\n\n" + batched_fun + \
+            "\n\n" + dbatched_fun + "\n" + "\nnamespace " + "{\n"
+        bhpp = bhpp + "\n"
+
     hpp = hpp + "\nstatic const int MAX_P_BASES = " + str(max(orders)) + ";\n"
 
     cpp = cpp + "\n}}}\n"
     hpp = hpp + "\n}}\n"
 
+    bcpp = bcpp + "\n}}}\n"
+    bhpp = bhpp + "\n}}\n"
+
     path = os.path.abspath(args.output)
 
     print("saving...")
@@ -462,4 +522,10 @@ if __name__ == "__main__":
     with open(os.path.join(path, "auto_p_bases.hpp"), "w") as file:
         file.write(hpp)
 
+    with open(os.path.join(path, "auto_p_bases_batched.cpp"), "w") as file:
+        file.write(bcpp)
+
+    with open(os.path.join(path, "auto_p_bases_batched.hpp"), "w") as file:
+        file.write(bhpp)
+
     print("done!")
@@ -200,5 +200,53 @@ namespace polyfem
 			val.col(0) = P(ijk(1), p, y) * (P_prime(ijk(0), p, x) * P(ijk(2), p, 1 - x - y) - P(ijk(0), p, x) * P_prime(ijk(2), p, 1 - x - y));
 			val.col(1) = P(ijk(0), p, x) * (P_prime(ijk(1), p, y) * P(ijk(2), p, 1 - x - y) - P(ijk(1), p, y) * P_prime(ijk(2), p, 1 - x - y));
 		}
+
+		void p_n_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			const int n_bases = (p + 1) * (p + 2) / 2;
+			Eigen::MatrixXd tmp;
+			val.resize(uv.rows(), n_bases);
+			for (int i = 0; i < n_bases; ++i)
+			{
+				p_n_basis_value_2d(p, i, uv, tmp);
+				val.col(i) = tmp;
+			}
+		}
+
+		void p_n_basis_grad_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			const int n_bases = (p + 1) * (p + 2) / 2;
+			Eigen::MatrixXd tmp;
+			val.resize(uv.rows(), 2 * n_bases);
+			for (int i = 0; i < n_bases; ++i)
+			{
+				p_n_basis_grad_value_2d(p, i, uv, tmp);
+				val.middleCols(2 * i, 2) = tmp;
+			}
+		}
+
+		void p_n_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			const int n_bases = ((p + 3) * (p + 2) * (p + 1)) / 6;
+			Eigen::MatrixXd tmp;
+			val.resize(uv.rows(), n_bases);
+			for (int i = 0; i < n_bases; ++i)
+			{
+				p_n_basis_value_3d(p, i, uv, tmp);
+				val.col(i) = tmp;
+			}
+		}
+
+		void p_n_basis_grad_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			const int n_bases = ((p + 3) * (p + 2) * (p + 1)) / 6;
+			Eigen::MatrixXd tmp;
+			val.resize(uv.rows(), 3 * n_bases);
+			for (int i = 0; i < n_bases; ++i)
+			{
+				p_n_basis_grad_value_3d(p, i, uv, tmp);
+				val.middleCols(3 * i, 3) = tmp;
+			}
+		}
 	} // namespace autogen
 } // namespace polyfem
@@ -16,5 +16,10 @@ namespace polyfem
 		void p_n_nodes_3d(const int p, Eigen::MatrixXd &val);
 		void p_n_basis_value_3d(const int p, const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
 		void p_n_basis_grad_value_3d(const int p, const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+		// all the bases at once, same layout as p_basis_values_2d and p_grad_basis_values_2d
+		void p_n_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+		void p_n_basis_grad_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+		void p_n_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+		void p_n_basis_grad_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
 	} // namespace autogen
 } // namespace polyfem
\ No newline at end of file
@@ -48,3 +48,9 @@ def C99_print_tensor(expr, result_name="result"):
                         lines.append(f"{s}")
 
     return "\n".join(lines)
+
+# Pretty print expr as column col of val, used by the batched evaluation of all the bases of an element.
+def C99_print_column(expr, col):
+    code = C99_print(expr).replace(" = 0;", ".setZero();").replace(
+        " = 1;", ".setOnes();").replace(" = -1;", ".setConstant(-1);")
+    return code.replace("result_0", "val.col(" + str(col) + ").array()")
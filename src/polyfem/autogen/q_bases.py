@@ -144,6 +144,7 @@ if __name__ == "__main__":
         namev = f"auto_q_bases_{dim}d_val"
         namen = f"auto_q_bases_{dim}d_nodes"
         nameg = f"auto_q_bases_{dim}d_grad"
+        nameb = f"auto_q_bases_{dim}d_batched"
 
         cppv = f"#include \"{namev}.hpp\"\n\n\n"
         cppv = cppv + \
@@ -159,6 +160,11 @@ if __name__ == "__main__":
         if dim == 3:
             cppg = "#include <Eigen/Dense>\n#include <cassert>\n namespace polyfem {\nnamespace autogen {"
 
+        # all the bases of an element at once
+        cppb = f"#include \"{nameb}.hpp\"\n\n\n"
+        cppb = cppb + \
+            "namespace polyfem {\nnamespace autogen " + "{\nnamespace " + "{\n"
+
         eextern = ""
 
         hppv = "#pragma once\n\n#include <Eigen/Dense>\n#include <cassert>\n\n"
@@ -170,6 +176,9 @@ if __name__ == "__main__":
         hppg = "#pragma once\n\n#include <Eigen/Dense>\n#include <cassert>\n\n"
         hppg = hppg + "namespace polyfem {\nnamespace autogen " + "{\n"
 
+        hppb = "#pragma once\n\n#include <Eigen/Dense>\n#include <cassert>\n\n"
+        hppb = hppb + "namespace polyfem {\nnamespace autogen " + "{\n"
+
         print(str(dim) + "D")
         suffix = "_2d" if dim == 2 else "_3d"
 
@@ -186,6 +195,18 @@ if __name__ == "__main__":
         hppv = hppv + unique_fun + ";\n\n"
         hppg = hppg + dunique_fun + ";\n\n"
 
+        # val.col(i) is the basis i, val.middleCols(dim * i, dim) its gradient
+        batched_fun = "void q_basis_values" + suffix + \
+            "(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+        dbatched_fun = "void q_grad_basis_values" + suffix + \
+            "(const int q, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+
+        hppb = hppb + batched_fun + ";\n\n"
+        hppb = hppb + dbatched_fun + ";\n\n"
+
+        batched_fun = batched_fun + "{\nswitch(q)" + "{\n"
+        dbatched_fun = dbatched_fun + "{\nswitch(q)" + "{\n"
+
         unique_nodes = unique_nodes + "{\nswitch(q)" + "{\n"
 
         unique_fun = unique_fun + "{\nswitch(q)" + "{\n"
@@ -533,6 +554,18 @@ if __name__ == "__main__":
                 str(order) + ": " + "q_" + orderN + "_basis_grad_value" + \
                 suffix + "(local_index, uv, val); break;\n"
 
+            bfunc = "void q_" + orderN + "_basis_values" + suffix + \
+                "(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+            dbfunc = "void q_" + orderN + "_basis_grad_values" + suffix + \
+                "(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+
+            batched_fun = batched_fun + "\tcase " + \
+                str(order) + ": " + "q_" + orderN + "_basis_values" + \
+                suffix + "(uv, val); break;\n"
+            dbatched_fun = dbatched_fun + "\tcase " + \
+                str(order) + ": " + "q_" + orderN + "_basis_grad_values" + \
+                suffix + "(uv, val); break;\n"
+
             # hpp = hpp + func + ";\n"
             # hpp = hpp + dfunc + ";\n"
 
@@ -542,6 +575,11 @@ if __name__ == "__main__":
             base = base + "\n\n"
             dbase = base
 
+            # every basis is a single Eigen expression over all the points, written in place in its column
+            bbase = base + "val.resize(uv.rows(), " + str(fe.nbf()) + ");\n"
+            dbbase = base + "val.resize(uv.rows(), " + \
+                str(dim * fe.nbf()) + ");\n"
+
             if order == 0:
                 base = base + "result_0.resize(x.size(),1);\n"
 
@@ -573,6 +611,13 @@ if __name__ == "__main__":
 
                 dbase = dbase + "} break;\n"
 
+                bbase = bbase + "{" + \
+                    pretty_print.C99_print_column(
+                        simplify(fe.N[real_index]), i) + "}\n"
+                for d, v in enumerate([x, y, z][:dim]):
+                    dbbase = dbbase + "{" + pretty_print.C99_print_column(
+                        simplify(diff(fe.N[real_index], v)), dim * i + d) + "}\n"
+
             base = base + "\tdefault: assert(false);\n}"
             dbase = dbase + "\tdefault: assert(false);\n}"
 
@@ -583,6 +628,12 @@ if __name__ == "__main__":
             cppg = cppg + dbase + "}\n\n"
             cppn = cppn + nodes + "\n\n"
 
+            cppb = cppb + bfunc + "{\n\n"
+            cppb = cppb + bbase + "}\n"
+
+            cppb = cppb + dbfunc + "{\n\n"
+            cppb = cppb + dbbase + "}\n\n"
+
             if dim == 3:
                 with open(os.path.join(path, f"{nameg}_{order}.cpp"), "w") as file:
                     file.write(cppg+"}}")
@@ -595,7 +646,11 @@ if __name__ == "__main__":
         unique_fun = unique_fun + "\tdefault: assert(false);\n}}"
         dunique_fun = dunique_fun + "\tdefault: assert(false);\n}}"
 
+        batched_fun = batched_fun + "\tdefault: assert(false);\n}}"
+        dbatched_fun = dbatched_fun + "\tdefault: assert(false);\n}}"
+
         cppv = cppv + "}\n\n"
+        cppb = cppb + "}\n\n"
         cppn = cppn + "}\n\n"
         if dim != 3:
             cppg = cppg + "}\n\n"
@@ -606,6 +661,8 @@ if __name__ == "__main__":
         hppv = hppv + "\n}}\n"
         hppn = hppn + "\n}}\n"
         hppg = hppg + "\n}}\n"
+        cppb = cppb + batched_fun + "\n\n" + dbatched_fun + "\n}}\n"
+        hppb = hppb + "\n}}\n"
 
         if dim == 3:
             tcppg = f"#include \"{nameg}.hpp\"\n\n\n"
@@ -628,11 +685,17 @@ if __name__ == "__main__":
         with open(os.path.join(path, f"{nameg}.hpp"), "w") as file:
             file.write(hppg)
 
+        with open(os.path.join(path, f"{nameb}.cpp"), "w") as file:
+            file.write(cppb)
+        with open(os.path.join(path, f"{nameb}.hpp"), "w") as file:
+            file.write(hppb)
+
     hpp = "#pragma once\n\n#include <Eigen/Dense>\n#include <cassert>\n\n"
     for dim in dims:
         hpp = hpp + f"#include \"auto_q_bases_{dim}d_val.hpp\"\n"
         hpp = hpp + f"#include \"auto_q_bases_{dim}d_nodes.hpp\"\n"
         hpp = hpp + f"#include \"auto_q_bases_{dim}d_grad.hpp\"\n"
+        hpp = hpp + f"#include \"auto_q_bases_{dim}d_batched.hpp\"\n"
     hpp = hpp + "\n\nnamespace polyfem {\nnamespace autogen " + "{\n"
     hpp = hpp + "\nstatic const int MAX_Q_BASES = " + str(max(orders)) + ";\n"
     hpp = hpp + "\n}}\n"
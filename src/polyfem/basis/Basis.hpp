@@ -2,6 +2,7 @@
 
 #include <polyfem/quadrature/Quadrature.hpp>
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
 
 #include <Eigen/Dense>
 #include <functional>
@@ -45,6 +46,7 @@ namespace polyfem
 
 		public:
 			typedef std::function<void(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)> Fun;
+			typedef void (*RefFun)(const int order, const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
 
 			Basis();
 
@@ -71,6 +73,8 @@ namespace polyfem
 			///
 			void eval_basis(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) const
 			{
+				if (ref_basis_)
+					return ref_basis_(ref_order_, ref_index_, uv, val);
 				assert(basis_);
 				basis_(uv, val);
 			}
@@ -96,6 +100,8 @@ namespace polyfem
 			///
 			void eval_grad(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) const
 			{
+				if (ref_grad_)
+					return ref_grad_(ref_order_, ref_index_, uv, val);
 				assert(grad_);
 				grad_(uv, val);
 			}
@@ -104,11 +110,41 @@ namespace polyfem
 			inline const std::vector<Local2Global> &global() const { return global_; }
 			inline std::vector<Local2Global> &global() { return global_; }
 
+			/// heap memory of the local to global mapping in bytes, the shared basis functions are not counted
+			inline size_t memory_bytes() const { return utils::memory_bytes(global_); }
+
 			// setting the basis lambda and its gradient
-			inline void set_basis(const Fun &fun) { basis_ = fun; }
-			inline void set_grad(const Fun &fun) { grad_ = fun; }
+			inline void set_basis(const Fun &fun)
+			{
+				basis_ = fun;
+				ref_basis_ = nullptr;
+			}
+			inline void set_grad(const Fun &fun)
+			{
+				grad_ = fun;
+				ref_grad_ = nullptr;
+			}
+
+			///
+			/// @brief      Use the tabulated basis of a reference element (e.g., autogen::p_basis_value_3d)
+			///             instead of closures, evaluated as basis(order, index, uv, val).
+			///
+			/// @param[in]  basis  reference basis values
+			/// @param[in]  grad   reference basis gradients
+			/// @param[in]  order  order passed to the reference functions
+			/// @param[in]  index  index of the basis in the reference element
+			///
+			inline void set_reference(const RefFun basis, const RefFun grad, const int order, const int index)
+			{
+				ref_basis_ = basis;
+				ref_grad_ = grad;
+				ref_order_ = order;
+				ref_index_ = index;
+				basis_ = nullptr;
+				grad_ = nullptr;
+			}
 
-			inline bool is_defined() const { return (basis_ ? true : false); }
+			inline bool is_defined() const { return (basis_ || ref_basis_) ? true : false; }
 			inline int order() const { return order_; }
 
 			// output
@@ -128,6 +164,12 @@ namespace polyfem
 
 			Fun basis_; ///< basis and gadient
 			Fun grad_;
+
+			/// reference basis of the element type, used instead of basis_ and grad_ when set
+			RefFun ref_basis_ = nullptr;
+			RefFun ref_grad_ = nullptr;
+			int ref_order_ = 0;
+			int ref_index_ = 0;
 		};
 	} // namespace basis
 } // namespace polyfem
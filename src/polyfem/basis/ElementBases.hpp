@@ -1,11 +1,13 @@
 #pragma once
 
 #include <polyfem/basis/Basis.hpp>
+#include <polyfem/basis/ReferenceBasis.hpp>
 #include <polyfem/quadrature/Quadrature.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 
 #include <polyfem/assembler/AssemblyValues.hpp>
 
+#include <array>
 #include <vector>
 
 namespace polyfem
@@ -24,6 +26,10 @@ namespace polyfem
 			// function type that computes quadrature points and saves them in quadrature
 			typedef std::function<void(quadrature::Quadrature &quadrature)> QuadratureFunction;
 
+			// function type that evaluates the 1D factors of tensor-product hex bases at points_1d, local basis
+			// (z * n + y) * n + x is the product of val[0].col(x), val[1].col(y) and val[2].col(z)
+			typedef std::function<void(const Eigen::VectorXd &points_1d, std::array<Eigen::MatrixXd, 3> &val, std::array<Eigen::MatrixXd, 3> &grad)> TensorTablesFunc;
+
 			std::vector<Basis> bases; ///< one basis function per node in the element
 
 			/// Assemble the global nodal positions of the bases.
@@ -38,6 +44,9 @@ namespace polyfem
 			// or directly in the object domain (harmonic bases)
 			bool has_parameterization = true;
 
+			/// true if the geometric mapping is affine (linear simplices), its Jacobian is then constant over the element
+			bool is_affine = false;
+
 			/// @brief Map the sample positions in the parametric domain to the object domain (if the element has no parameterization, e.g. harmonic bases, then the parametric domain = object domain,
 			/// and the mapping is identity)
 			///
@@ -74,6 +83,10 @@ namespace polyfem
 				{
 					eval_bases_func_(uv, basis_values);
 				}
+				else if (reference_)
+				{
+					reference_->evaluate_bases(uv, basis_values);
+				}
 				else
 				{
 					evaluate_bases_default(uv, basis_values);
@@ -87,6 +100,10 @@ namespace polyfem
 				{
 					eval_grads_func_(uv, basis_values);
 				}
+				else if (reference_)
+				{
+					reference_->evaluate_grads(uv, basis_values);
+				}
 				else
 				{
 					evaluate_grads_default(uv, basis_values);
@@ -96,9 +113,24 @@ namespace polyfem
 			void set_bases_func(EvalBasesFunc fun) { eval_bases_func_ = fun; }
 			void set_grads_func(EvalBasesFunc fun) { eval_grads_func_ = fun; }
 
+			/// all the bases are the ones of a shared reference element, evaluate_bases and evaluate_grads use its tables
+			void set_reference_basis(const std::shared_ptr<const ReferenceBasis> &reference)
+			{
+				assert(!reference || reference->n_bases() == bases.size());
+				reference_ = reference;
+			}
+			const std::shared_ptr<const ReferenceBasis> &reference_basis() const { return reference_; }
+
+			/// the bases are products of 1D factors, used by the sum-factorized kernels
+			void set_tensor_tables_func(const TensorTablesFunc &fun) { tensor_tables_func_ = fun; }
+			const TensorTablesFunc &tensor_tables_func() const { return tensor_tables_func_; }
+
 			/// sets mapping from local nodes to global nodes
 			void set_local_node_from_primitive_func(LocalNodeFromPrimitiveFunc fun) { local_node_from_primitive_ = fun; }
 
+			/// heap memory of the bases in bytes
+			size_t memory_bytes() const { return utils::memory_bytes(bases); }
+
 		private:
 			/// default to simply calling the Basis evaluation functions
 			void evaluate_bases_default(const Eigen::MatrixXd &uv, std::vector<assembler::AssemblyValues> &basis_values) const;
@@ -107,6 +139,8 @@ namespace polyfem
 		private:
 			EvalBasesFunc eval_bases_func_;
 			EvalBasesFunc eval_grads_func_;
+			std::shared_ptr<const ReferenceBasis> reference_;
+			TensorTablesFunc tensor_tables_func_;
 			QuadratureFunction quadrature_builder_;
 			QuadratureFunction mass_quadrature_builder_;
 
@@ -1,8 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "LagrangeBasis2d.hpp"
 
-#include <polyfem/quadrature/TriQuadrature.hpp>
-#include <polyfem/quadrature/QuadQuadrature.hpp>
+#include <polyfem/quadrature/QuadratureRegistry.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
@@ -760,14 +759,8 @@ int LagrangeBasis2d::build_bases(
 		{
 			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
 			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
-			b.set_quadrature([real_order](Quadrature &quad) {
-				QuadQuadrature quad_quadrature;
-				quad_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				QuadQuadrature quad_quadrature;
-				quad_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Quad, real_order));
+			b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Quad, real_mass_order));
 			// quad_quadrature.get_quadrature(real_order, b.quadrature);
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
@@ -784,6 +777,7 @@ int LagrangeBasis2d::build_bases(
 				return quad_edge_local_nodes(discr_order, mesh2d, index);
 			});
 
+			const auto reference = ReferenceBasis::get(ReferenceBasis::ElementType::QUAD, serendipity ? -2 : discr_order);
 			for (int j = 0; j < n_el_bases; ++j)
 			{
 				const int global_index = element_nodes_id[e][j];
@@ -791,24 +785,19 @@ int LagrangeBasis2d::build_bases(
 				// if(!skip_interface_element)
 				b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
 
-				const int dtmp = serendipity ? -2 : discr_order;
-
-				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_2d(dtmp, j, uv, val); });
-				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_2d(dtmp, j, uv, val); });
+				b.bases[j].set_reference(reference->basis_function(), reference->grad_function(), reference->order(), j);
 			}
+
+			if (reference->n_bases() == n_el_bases)
+				b.set_reference_basis(reference);
 		}
 		else if (mesh.is_simplex(e))
 		{
 			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 2);
 			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 2);
-			b.set_quadrature([real_order](Quadrature &quad) {
-				TriQuadrature tri_quadrature;
-				tri_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				TriQuadrature tri_quadrature;
-				tri_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Triangle, real_order));
+			b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Triangle, real_mass_order));
+			b.is_affine = discr_order == 1;
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
 				const auto &mesh2d = dynamic_cast<const Mesh2D &>(mesh);
@@ -826,6 +815,7 @@ int LagrangeBasis2d::build_bases(
 
 			const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
 
+			const auto reference = ReferenceBasis::get(ReferenceBasis::ElementType::TRI, discr_order);
 			for (int j = 0; j < n_el_bases; ++j)
 			{
 				const int global_index = element_nodes_id[e][j];
@@ -882,10 +872,12 @@ int LagrangeBasis2d::build_bases(
 				else
 				{
 					// pick out basis functions using autogenerated code
-					b.bases[j].set_basis([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_2d(discr_order, j, uv, val); });
-					b.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_2d(discr_order, j, uv, val); });
+					b.bases[j].set_reference(reference->basis_function(), reference->grad_function(), reference->order(), j);
 				}
 			}
+
+			if (!rational && reference->n_bases() == n_el_bases)
+				b.set_reference_basis(reference);
 		}
 		else
 		{
@@ -3,8 +3,7 @@
 #include "LagrangeBasis3d.hpp"
 
 #include <polyfem/mesh/MeshNodes.hpp>
-#include <polyfem/quadrature/TetQuadrature.hpp>
-#include <polyfem/quadrature/HexQuadrature.hpp>
+#include <polyfem/quadrature/QuadratureRegistry.hpp>
 
 #include <polyfem/assembler/AssemblerUtils.hpp>
 
@@ -13,6 +12,7 @@
 
 #include <polyfem/utils/MaybeParallelFor.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <array>
 ////////////////////////////////////////////////////////////////////////////////
@@ -874,6 +874,27 @@ namespace
 			}
 		}
 	}
+
+	/// Sums the weights of the repeated nodes of a constrained basis (in order of appearance) and drops the vanishing ones, sorted by node index
+	void merge_global(std::vector<Local2Global> &global)
+	{
+		std::stable_sort(global.begin(), global.end(), [](const Local2Global &a, const Local2Global &b) { return a.index < b.index; });
+
+		size_t n = 0;
+		for (size_t i = 0; i < global.size();)
+		{
+			Local2Global merged = global[i];
+			for (++i; i < global.size() && global[i].index == merged.index; ++i)
+			{
+				assert((merged.node - global[i].node).norm() < 1e-12);
+				merged.val += global[i].val;
+			}
+
+			if (std::abs(merged.val) > 1e-12)
+				global[n++] = merged;
+		}
+		global.resize(n);
+	}
 } // anonymous namespace
 
 Eigen::VectorXi LagrangeBasis3d::tet_face_local_nodes(const int p, const Mesh3D &mesh, Navigation3D::Index index)
@@ -1438,122 +1459,131 @@ int LagrangeBasis3d::build_bases(
 	// std::cout<<"switch_face_time " << Navigation3D::switch_face_time <<std::endl;
 	// std::cout<<"switch_element_time " << Navigation3D::switch_element_time <<std::endl;
 
+	// the nodes are numbered, the element tables are independent
 	bases.resize(mesh.n_cells());
-	std::vector<int> interface_elements;
-	interface_elements.reserve(mesh.n_faces());
+	std::vector<char> is_interface_element(mesh.n_cells(), 0);
 
+	// shared reference bases of the orders in use
+	std::vector<std::shared_ptr<const ReferenceBasis>> hex_references(max_p + 1), tet_references(max_p + 1);
 	for (int e = 0; e < mesh.n_cells(); ++e)
 	{
-		ElementBases &b = bases[e];
 		const int discr_order = discr_orders(e);
-		const int n_el_bases = (int)element_nodes_id[e].size();
-		b.bases.resize(n_el_bases);
-
-		bool skip_interface_element = false;
+		if (mesh.is_cube(e) && !hex_references[discr_order])
+			hex_references[discr_order] = ReferenceBasis::get(ReferenceBasis::ElementType::HEX, serendipity ? -2 : discr_order);
+		else if (mesh.is_simplex(e) && !tet_references[discr_order])
+			tet_references[discr_order] = ReferenceBasis::get(ReferenceBasis::ElementType::TET, discr_order);
+	}
 
-		for (int j = 0; j < n_el_bases; ++j)
+	polyfem::utils::maybe_parallel_for(mesh.n_cells(), [&](int start, int end, int thread_id) {
+		for (int e = start; e < end; ++e)
 		{
-			const int global_index = element_nodes_id[e][j];
-			if (global_index < 0)
-			{
-				skip_interface_element = true;
-				break;
-			}
-		}
+			ElementBases &b = bases[e];
+			const int discr_order = discr_orders(e);
+			const int n_el_bases = (int)element_nodes_id[e].size();
+			b.bases.resize(n_el_bases);
 
-		if (skip_interface_element)
-		{
-			interface_elements.push_back(e);
-		}
+			bool skip_interface_element = false;
 
-		if (mesh.is_cube(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
-			b.set_quadrature([real_order](Quadrature &quad) {
-				HexQuadrature hex_quadrature;
-				hex_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				HexQuadrature hex_quadrature;
-				hex_quadrature.get_quadrature(real_mass_order, quad);
-			});
-
-			b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
-				Navigation3D::Index index;
-
-				for (int lf = 0; lf < 6; ++lf)
+			for (int j = 0; j < n_el_bases; ++j)
+			{
+				const int global_index = element_nodes_id[e][j];
+				if (global_index < 0)
 				{
-					index = mesh3d.get_index_from_element(e, lf, 0);
-					if (index.face == primitive_id)
-						break;
+					skip_interface_element = true;
+					break;
 				}
-				assert(index.face == primitive_id);
-				return hex_face_local_nodes(serendipity, discr_order, mesh3d, index);
-			});
+			}
 
-			for (int j = 0; j < n_el_bases; ++j)
+			if (skip_interface_element)
 			{
-				const int global_index = element_nodes_id[e][j];
+				is_interface_element[e] = 1;
+			}
+
+			if (mesh.is_cube(e))
+			{
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+				b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Hexahedron, real_order));
+				b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Hexahedron, real_mass_order));
 
-				b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+				b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
+					Navigation3D::Index index;
 
-				const int dtmp = serendipity ? -2 : discr_order;
+					for (int lf = 0; lf < 6; ++lf)
+					{
+						index = mesh3d.get_index_from_element(e, lf, 0);
+						if (index.face == primitive_id)
+							break;
+					}
+					assert(index.face == primitive_id);
+					return hex_face_local_nodes(serendipity, discr_order, mesh3d, index);
+				});
 
-				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(dtmp, j, uv, val); });
-				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(dtmp, j, uv, val); });
-			}
-		}
-		else if (mesh.is_simplex(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
-
-			b.set_quadrature([real_order](Quadrature &quad) {
-				TetQuadrature tet_quadrature;
-				tet_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				TetQuadrature tet_quadrature;
-				tet_quadrature.get_quadrature(real_mass_order, quad);
-			});
-
-			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
-				Navigation3D::Index index;
-
-				for (int lf = 0; lf < mesh3d.n_cell_faces(e); ++lf)
+				for (int j = 0; j < n_el_bases; ++j)
 				{
-					index = mesh3d.get_index_from_element(e, lf, 0);
-					if (index.face == primitive_id)
-						break;
-				}
-				assert(index.face == primitive_id);
-				return tet_face_local_nodes(discr_order, mesh3d, index);
-			});
+					const int global_index = element_nodes_id[e][j];
+
+					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
 
-			const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
-			assert(!rational);
+					b.bases[j].set_reference(hex_references[discr_order]->basis_function(), hex_references[discr_order]->grad_function(), hex_references[discr_order]->order(), j);
+				}
 
-			for (int j = 0; j < n_el_bases; ++j)
+				if (hex_references[discr_order]->n_bases() == n_el_bases)
+					b.set_reference_basis(hex_references[discr_order]);
+			}
+			else if (mesh.is_simplex(e))
 			{
-				const int global_index = element_nodes_id[e][j];
-				if (!skip_interface_element)
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
+
+				b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Tetrahedron, real_order));
+				b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Tetrahedron, real_mass_order));
+				b.is_affine = discr_order == 1;
+
+				b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
+					Navigation3D::Index index;
+
+					for (int lf = 0; lf < mesh3d.n_cell_faces(e); ++lf)
+					{
+						index = mesh3d.get_index_from_element(e, lf, 0);
+						if (index.face == primitive_id)
+							break;
+					}
+					assert(index.face == primitive_id);
+					return tet_face_local_nodes(discr_order, mesh3d, index);
+				});
+
+				const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
+				assert(!rational);
+
+				for (int j = 0; j < n_el_bases; ++j)
 				{
-					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					const int global_index = element_nodes_id[e][j];
+					if (!skip_interface_element)
+					{
+						b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					}
+
+					b.bases[j].set_reference(tet_references[discr_order]->basis_function(), tet_references[discr_order]->grad_function(), tet_references[discr_order]->order(), j);
 				}
 
-				b.bases[j].set_basis([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_3d(discr_order, j, uv, val); });
-				b.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_3d(discr_order, j, uv, val); });
+				if (tet_references[discr_order]->n_bases() == n_el_bases)
+					b.set_reference_basis(tet_references[discr_order]);
+			}
+			else
+			{
+				// Polyhedra bases are built later on
+				// assert(false);
 			}
 		}
-		else
-		{
-			// Polyhedra bases are built later on
-			// assert(false);
-		}
-	}
+	});
+
+	std::vector<int> interface_elements;
+	for (int e = 0; e < mesh.n_cells(); ++e)
+		if (is_interface_element[e])
+			interface_elements.push_back(e);
 
 	if (!is_geom_bases)
 	{
@@ -2006,25 +2036,7 @@ int LagrangeBasis3d::build_bases(
 								if (global_.size() <= 1)
 									continue;
 
-								std::map<int, Local2Global> list;
-								for (size_t ii = 0; ii < global_.size(); ii++)
-								{
-									auto pair = list.insert({global_[ii].index, global_[ii]});
-									if (!pair.second && pair.first != list.end())
-									{
-										assert((pair.first->second.node - global_[ii].node).norm() < 1e-12);
-										pair.first->second.val += global_[ii].val;
-									}
-								}
-
-								global_.clear();
-								for (auto it = list.begin(); it != list.end(); ++it)
-								{
-									if (std::abs(it->second.val) > 1e-12)
-									{
-										global_.push_back(it->second);
-									}
-								}
+								merge_global(global_);
 							}
 						}
 					}
@@ -8,12 +8,14 @@
 #include "function/RBFWithQuadratic.hpp"
 #include "function/RBFWithQuadraticLagrange.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/assembler/AssemblerUtils.hpp>
 
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <random>
 #include <memory>
+#include <numeric>
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polyfem
@@ -30,6 +32,49 @@ namespace polyfem
 
 			// -----------------------------------------------------------------------------
 
+			/// inputs of the harmonic kernel solve of one polygon
+			struct PolytopeSamples
+			{
+				std::vector<int> local_to_global; // map local basis id (the ones that are nonzero on the polygon boundary) to global basis id
+				Eigen::MatrixXd collocation_points, kernel_centers;
+				Eigen::MatrixXd rhs; // 1 row per collocation point, 1 column per basis that is nonzero on the polygon boundary
+				Eigen::MatrixXd local_basis_integrals;
+				Quadrature quadrature;
+				/// triangulation of the polygon, the quadratures of the element are expanded from it on demand
+				std::shared_ptr<const SimplexDecomposition> decomposition;
+
+				/// the bases with linear reproduction are solved relative to this point
+				Eigen::RowVector2d origin() const { return collocation_points.row(0); }
+			};
+
+			/// For every polygon, the first polygon which is a translated copy of it (itself if none)
+			std::vector<int> translated_groups(const std::vector<PolytopeSamples> &samples, const bool share)
+			{
+				const int n_polytopes = samples.size();
+				std::vector<int> representative(n_polytopes);
+				std::iota(representative.begin(), representative.end(), 0);
+				if (!share)
+					return representative;
+
+				std::vector<std::vector<int64_t>> signatures(n_polytopes);
+				utils::maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+					for (int p = start; p < end; ++p)
+					{
+						const PolytopeSamples &s = samples[p];
+						signatures[p] = RBFWithLinear::translation_signature(s.kernel_centers, s.collocation_points, s.local_basis_integrals, s.quadrature, s.rhs);
+					}
+				});
+
+				std::map<std::vector<int64_t>, int> first;
+				for (int p = 0; p < n_polytopes; ++p)
+					representative[p] = first.emplace(std::move(signatures[p]), p).first->second;
+
+				logger().debug("Harmonic kernels of {} polygons solved for {} distinct shapes", n_polytopes, first.size());
+				return representative;
+			}
+
+			// -----------------------------------------------------------------------------
+
 			std::vector<int> compute_nonzero_bases_ids(const Mesh2D &mesh, const int element_index, const std::vector<ElementBases> &bases, const std::map<int, InterfaceData> &poly_edge_to_data)
 			{
 				std::vector<int> local_to_global;
@@ -361,123 +406,152 @@ namespace polyfem
 			Eigen::MatrixXd basis_integrals;
 			compute_integral_constraints(assembler, mesh, n_bases, bases, gbases, basis_integrals);
 
-			// Step 2: Compute the rest =)
-			PolygonQuadrature poly_quadr;
-			for (int e = 0; e < mesh.n_elements(); ++e)
+			if (integral_constraints < 0 || integral_constraints > 2)
 			{
-				if (!mesh.is_polytope(e))
-				{
-					continue;
-				}
-				// No boundary polytope
-				// assert(element_type[e] != ElementType::BOUNDARY_POLYTOPE);
-
-				// Kernel distance to polygon boundary
-				const double eps = compute_epsilon(mesh, e);
-
-				std::vector<int> local_to_global; // map local basis id (the ones that are nonzero on the polygon boundary) to global basis id
-				Eigen::MatrixXd collocation_points, kernel_centers;
-				Eigen::MatrixXd rhs; // 1 row per collocation point, 1 column per basis that is nonzero on the polygon boundary
-
-				sample_polygon(e, n_samples_per_edge, mesh, poly_edge_to_data, bases, gbases, eps, local_to_global, collocation_points, kernel_centers, rhs);
+				throw std::runtime_error(fmt::format("Unsupported constraint order: {:d}", integral_constraints));
+			}
 
-				// igl::opengl::glfw::Viewer viewer;
-				// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
+			std::vector<int> polytopes;
+			for (int e = 0; e < mesh.n_elements(); ++e)
+			{
+				if (mesh.is_polytope(e))
+					polytopes.push_back(e);
+			}
+			const int n_polytopes = polytopes.size();
 
-				// Eigen::MatrixXd asd(collocation_points.rows(), 3);
-				// asd.col(0)=collocation_points.col(0);
-				// asd.col(1)=collocation_points.col(1);
-				// asd.col(2)=rhs.col(0);
-				// viewer.data().add_points(asd, Eigen::Vector3d(1,0,1).transpose());
+			const int poly_quadrature_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler.name(), 2, AssemblerUtils::BasisType::POLY, 2);
+			const int poly_mass_quadrature_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::POLY, 2);
 
-				// for(int asd = 0; asd < collocation_points.rows(); ++asd) {
-				//     viewer.data().add_label(collocation_points.row(asd), std::to_string(asd));
-				// }
+			// Step 2: Sample the polygons
+			std::vector<PolytopeSamples> samples(n_polytopes);
+			utils::maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
+				{
+					const int e = polytopes[p];
+					PolytopeSamples &s = samples[p];
 
-				// viewer.launch();
+					// No boundary polytope
+					// assert(element_type[e] != ElementType::BOUNDARY_POLYTOPE);
 
-				// igl::opengl::glfw::Viewer & viewer = UIState::ui_state().viewer;
-				// viewer.data().clear();
-				// viewer.data().set_mesh(triangulated_vertices, triangulated_faces);
-				// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
-				// add_spheres(viewer, kernel_centers, 0.01);
+					// Kernel distance to polygon boundary
+					const double eps = compute_epsilon(mesh, e);
 
-				ElementBases &b = bases[e];
-				b.has_parameterization = false;
+					sample_polygon(e, n_samples_per_edge, mesh, poly_edge_to_data, bases, gbases, eps, s.local_to_global, s.collocation_points, s.kernel_centers, s.rhs);
 
-				// Compute quadrature points for the polygon
-				Quadrature tmp_quadrature;
-				poly_quadr.get_quadrature(collocation_points, quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler.name(), 2, AssemblerUtils::BasisType::POLY, 2), tmp_quadrature);
+					// igl::opengl::glfw::Viewer viewer;
+					// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
 
-				Quadrature tmp_mass_quadrature;
-				poly_quadr.get_quadrature(collocation_points, mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::POLY, 2), tmp_mass_quadrature);
+					// Eigen::MatrixXd asd(collocation_points.rows(), 3);
+					// asd.col(0)=collocation_points.col(0);
+					// asd.col(1)=collocation_points.col(1);
+					// asd.col(2)=rhs.col(0);
+					// viewer.data().add_points(asd, Eigen::Vector3d(1,0,1).transpose());
 
-				b.set_quadrature([tmp_quadrature](Quadrature &quad) { quad = tmp_quadrature; });
-				b.set_mass_quadrature([tmp_mass_quadrature](Quadrature &quad) { quad = tmp_mass_quadrature; });
+					// for(int asd = 0; asd < collocation_points.rows(); ++asd) {
+					//     viewer.data().add_label(collocation_points.row(asd), std::to_string(asd));
+					// }
 
-				// Compute the weights of the harmonic kernels
-				Eigen::MatrixXd local_basis_integrals(rhs.cols(), basis_integrals.cols());
-				for (long k = 0; k < rhs.cols(); ++k)
-				{
-					local_basis_integrals.row(k) = -basis_integrals.row(local_to_global[k]);
-				}
-				auto set_rbf = [&b](auto rbf) {
-					b.set_bases_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
-						Eigen::MatrixXd tmp;
-						rbf->bases_values(uv, tmp);
-						val.resize(tmp.cols());
-						assert(tmp.rows() == uv.rows());
-
-						for (size_t i = 0; i < tmp.cols(); ++i)
-						{
-							val[i].val = tmp.col(i);
-						}
-					});
-					b.set_grads_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
-						Eigen::MatrixXd tmpx, tmpy;
+					// viewer.launch();
 
-						rbf->bases_grads(0, uv, tmpx);
-						rbf->bases_grads(1, uv, tmpy);
+					// Compute quadrature points for the polygon
+					s.decomposition = PolygonQuadrature::decompose(s.collocation_points);
+					PolygonQuadrature::get_quadrature(*s.decomposition, poly_quadrature_order, s.quadrature);
 
-						val.resize(tmpx.cols());
-						assert(tmpx.cols() == tmpy.cols());
-						assert(tmpx.rows() == uv.rows());
-						for (size_t i = 0; i < tmpx.cols(); ++i)
-						{
-							val[i].grad.resize(uv.rows(), uv.cols());
-							val[i].grad.col(0) = tmpx.col(i);
-							val[i].grad.col(1) = tmpy.col(i);
-						}
-					});
-				};
-				if (integral_constraints == 0)
-				{
-					set_rbf(std::make_shared<RBFWithLinear>(kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs, false));
-				}
-				else if (integral_constraints == 1)
-				{
-					set_rbf(std::make_shared<RBFWithLinear>(kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
-				}
-				else if (integral_constraints == 2)
-				{
-					set_rbf(std::make_shared<RBFWithQuadraticLagrange>(assembler, kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
+					s.local_basis_integrals.resize(s.rhs.cols(), basis_integrals.cols());
+					for (long k = 0; k < s.rhs.cols(); ++k)
+					{
+						s.local_basis_integrals.row(k) = -basis_integrals.row(s.local_to_global[k]);
+					}
 				}
-				else
+			});
+
+			// Step 3: Compute the weights of the harmonic kernels, once per group of translated polygons
+			const std::vector<int> representative = translated_groups(samples, integral_constraints <= 1);
+			std::vector<std::shared_ptr<const RBFWithLinear>> linear_rbfs(n_polytopes);
+			std::vector<std::shared_ptr<const RBFWithQuadraticLagrange>> quadratic_rbfs(n_polytopes);
+			utils::maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
 				{
-					throw std::runtime_error(fmt::format("Unsupported constraint order: {:d}", integral_constraints));
+					if (representative[p] != p)
+						continue;
+
+					PolytopeSamples &s = samples[p];
+					if (integral_constraints == 2)
+					{
+						quadratic_rbfs[p] = std::make_shared<RBFWithQuadraticLagrange>(assembler, s.kernel_centers, s.collocation_points, s.local_basis_integrals, s.quadrature, s.rhs);
+					}
+					else
+					{
+						Quadrature quadrature = s.quadrature;
+						quadrature.points.rowwise() -= s.origin();
+						linear_rbfs[p] = std::make_shared<RBFWithLinear>(
+							s.kernel_centers.rowwise() - s.origin(), s.collocation_points.rowwise() - s.origin(),
+							s.local_basis_integrals, quadrature, s.rhs, integral_constraints == 1);
+					}
 				}
+			});
 
-				// Set the bases which are nonzero inside the polygon
-				const int n_poly_bases = int(local_to_global.size());
-				b.bases.resize(n_poly_bases);
-				for (int i = 0; i < n_poly_bases; ++i)
+			// Step 4: Set the bases
+			utils::maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
 				{
-					b.bases[i].init(-2, local_to_global[i], i, Eigen::MatrixXd::Constant(1, 2, std::nan("")));
+					const PolytopeSamples &s = samples[p];
+					ElementBases &b = bases[polytopes[p]];
+					b.has_parameterization = false;
+
+					// only the triangulation is stored, the points are expanded when the element values are computed
+					const std::shared_ptr<const SimplexDecomposition> decomposition = s.decomposition;
+					b.set_quadrature([decomposition, poly_quadrature_order](Quadrature &quad) { PolygonQuadrature::get_quadrature(*decomposition, poly_quadrature_order, quad); });
+					b.set_mass_quadrature([decomposition, poly_mass_quadrature_order](Quadrature &quad) { PolygonQuadrature::get_quadrature(*decomposition, poly_mass_quadrature_order, quad); });
+
+					auto set_rbf = [&b](auto rbf, const Eigen::RowVector2d &origin) {
+						b.set_bases_func([rbf, origin](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+							Eigen::MatrixXd tmp;
+							rbf->bases_values(uv.rowwise() - origin, tmp);
+							val.resize(tmp.cols());
+							assert(tmp.rows() == uv.rows());
+
+							for (size_t i = 0; i < tmp.cols(); ++i)
+							{
+								val[i].val = tmp.col(i);
+							}
+						});
+						b.set_grads_func([rbf, origin](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+							const Eigen::MatrixXd local_uv = uv.rowwise() - origin;
+							Eigen::MatrixXd tmpx, tmpy;
+
+							rbf->bases_grads(0, local_uv, tmpx);
+							rbf->bases_grads(1, local_uv, tmpy);
+
+							val.resize(tmpx.cols());
+							assert(tmpx.cols() == tmpy.cols());
+							assert(tmpx.rows() == uv.rows());
+							for (size_t i = 0; i < tmpx.cols(); ++i)
+							{
+								val[i].grad.resize(uv.rows(), uv.cols());
+								val[i].grad.col(0) = tmpx.col(i);
+								val[i].grad.col(1) = tmpy.col(i);
+							}
+						});
+					};
+					if (integral_constraints == 2)
+						set_rbf(quadratic_rbfs[p], Eigen::RowVector2d::Zero());
+					else
+						set_rbf(linear_rbfs[representative[p]], s.origin());
+
+					// Set the bases which are nonzero inside the polygon
+					const int n_poly_bases = int(s.local_to_global.size());
+					b.bases.resize(n_poly_bases);
+					for (int i = 0; i < n_poly_bases; ++i)
+					{
+						b.bases[i].init(-2, s.local_to_global[i], i, Eigen::MatrixXd::Constant(1, 2, std::nan("")));
+					}
 				}
+			});
 
-				// Polygon boundary after geometric mapping from neighboring elements
-				mapped_boundary[e] = collocation_points;
-			}
+			// Polygon boundary after geometric mapping from neighboring elements
+			for (int p = 0; p < n_polytopes; ++p)
+				mapped_boundary[polytopes[p]] = samples[p].collocation_points;
 
 			return 0;
 		}
@@ -12,12 +12,14 @@
 #include "function/RBFWithQuadratic.hpp"
 #include "function/RBFWithQuadraticLagrange.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <igl/per_vertex_normals.h>
 #include <random>
 #include <memory>
+#include <numeric>
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polyfem
@@ -36,6 +38,50 @@ namespace polyfem
 
 			// -----------------------------------------------------------------------------
 
+			/// inputs of the harmonic kernel solve of one polyhedron
+			struct PolytopeSamples
+			{
+				std::vector<int> local_to_global; // map local basis id (the ones that are nonzero on the polygon boundary) to global basis id
+				Eigen::MatrixXd collocation_points, kernel_centers, triangulated_vertices;
+				Eigen::MatrixXi triangulated_faces;
+				Eigen::MatrixXd rhs; // 1 row per collocation point, 1 column per basis that is nonzero on the polygon boundary
+				Eigen::MatrixXd local_basis_integrals;
+				Quadrature quadrature;
+				/// tetrahedralization of the polyhedron, the quadratures of the element are expanded from it on demand
+				std::shared_ptr<const SimplexDecomposition> decomposition;
+
+				/// the bases with linear reproduction are solved relative to this point
+				Eigen::RowVector3d origin() const { return collocation_points.row(0); }
+			};
+
+			/// For every polyhedron, the first polyhedron which is a translated copy of it (itself if none)
+			std::vector<int> translated_groups(const std::vector<PolytopeSamples> &samples, const bool share)
+			{
+				const int n_polytopes = samples.size();
+				std::vector<int> representative(n_polytopes);
+				std::iota(representative.begin(), representative.end(), 0);
+				if (!share)
+					return representative;
+
+				std::vector<std::vector<int64_t>> signatures(n_polytopes);
+				maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+					for (int p = start; p < end; ++p)
+					{
+						const PolytopeSamples &s = samples[p];
+						signatures[p] = RBFWithLinear::translation_signature(s.kernel_centers, s.collocation_points, s.local_basis_integrals, s.quadrature, s.rhs);
+					}
+				});
+
+				std::map<std::vector<int64_t>, int> first;
+				for (int p = 0; p < n_polytopes; ++p)
+					representative[p] = first.emplace(std::move(signatures[p]), p).first->second;
+
+				logger().debug("Harmonic kernels of {} polyhedra solved for {} distinct shapes", n_polytopes, first.size());
+				return representative;
+			}
+
+			// -----------------------------------------------------------------------------
+
 			std::vector<int> compute_nonzero_bases_ids(const Mesh3D &mesh, const int c,
 													   const std::vector<ElementBases> &bases,
 													   const std::map<int, InterfaceData> &poly_face_to_data)
@@ -232,7 +278,6 @@ namespace polyfem
 				const int n_kernels_per_edge,
 				int n_samples_per_edge,
 				const int quadrature_order,
-				const int mass_quadrature_order,
 				const Mesh3D &mesh,
 				const std::map<int, InterfaceData> &poly_face_to_data,
 				const std::vector<ElementBases> &bases,
@@ -245,7 +290,7 @@ namespace polyfem
 				Eigen::MatrixXd &triangulated_vertices,
 				Eigen::MatrixXi &triangulated_faces,
 				Quadrature &quadrature,
-				Quadrature &mass_quadrature,
+				std::shared_ptr<const SimplexDecomposition> &decomposition,
 				double &scaling,
 				Eigen::RowVector3d &translation)
 			{
@@ -377,10 +422,8 @@ namespace polyfem
 				scaling = 1.0;
 				translation.setZero();
 				// NV = (NV.rowwise() - translation) / scaling;
-				PolyhedronQuadrature::get_quadrature(NV, triangulated_faces, mesh.kernel(element_index),
-													 quadrature_order, quadrature);
-				PolyhedronQuadrature::get_quadrature(NV, triangulated_faces, mesh.kernel(element_index),
-													 mass_quadrature_order, mass_quadrature);
+				decomposition = PolyhedronQuadrature::decompose(NV, triangulated_faces, mesh.kernel(element_index));
+				PolyhedronQuadrature::get_quadrature(*decomposition, quadrature_order, quadrature);
 
 				// Normalization
 				// collocation_points = (collocation_points.rowwise() - translation) / scaling;
@@ -597,144 +640,180 @@ namespace polyfem
 			Eigen::MatrixXd basis_integrals;
 			compute_integral_constraints(assembler, mesh, n_bases, bases, gbases, basis_integrals);
 
-			// Step 2: Compute the rest =)
-			for (int e = 0; e < mesh.n_elements(); ++e)
+			if (integral_constraints < 0 || integral_constraints > 2)
 			{
-				if (!mesh.is_polytope(e))
-				{
-					continue;
-				}
-				// No boundary polytope
-				// assert(element_type[e] != ElementType::BOUNDARY_POLYTOPE);
-
-				// Kernel distance to polygon boundary
-				const double eps = compute_epsilon(mesh, e);
-
-				std::vector<int> local_to_global; // map local basis id (the ones that are nonzero on the polygon boundary) to global basis id
-				Eigen::MatrixXd collocation_points, kernel_centers, triangulated_vertices;
-				Eigen::MatrixXi triangulated_faces;
-				Eigen::MatrixXd rhs; // 1 row per collocation point, 1 column per basis that is nonzero on the polygon boundary
-
-				ElementBases &b = bases[e];
-				b.has_parameterization = false;
-
-				Quadrature tmp_quadrature, tmp_mass_quadrature;
-				double scaling;
-				Eigen::RowVector3d translation;
-				sample_polyhedra(e, 2, n_kernels_per_edge, n_samples_per_edge,
-								 quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler.name(), 2, AssemblerUtils::BasisType::POLY, 3),
-								 mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::POLY, 3),
-								 mesh, poly_face_to_data, bases, gbases, eps, local_to_global,
-								 collocation_points, kernel_centers, rhs, triangulated_vertices,
-								 triangulated_faces, tmp_quadrature, tmp_mass_quadrature, scaling, translation);
-
-				b.set_quadrature([tmp_quadrature](Quadrature &quad) { quad = tmp_quadrature; });
-				b.set_mass_quadrature([tmp_mass_quadrature](Quadrature &quad) { quad = tmp_mass_quadrature; });
-				// b.scaling_ = scaling;
-				// b.translation_ = translation;
-
-				// igl::opengl::glfw::Viewer & viewer = UIState::ui_state().viewer;
-				// viewer.data().clear();
-				// viewer.data().set_mesh(triangulated_vertices, triangulated_faces);
-				// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
-				// add_spheres(viewer, kernel_centers, 0.005);
-
-				// Eigen::MatrixXd pts = triangulated_vertices, normals;
-				// Eigen::MatrixXi tris = triangulated_faces;
-				// igl::per_corner_normals(pts, tris, 20, normals);
-				// viewer.data().set_normals(normals);
-				// viewer.data().set_face_based(false);
-				// viewer.launch();
+				throw std::runtime_error(fmt::format("Unsupported constraint order: {:d}", integral_constraints));
+			}
 
-				// for(int a = 0; rhs.cols();++a)
-				// 	{
-				// 	igl::opengl::glfw::Viewer viewer;
-				// 	Eigen::MatrixXd asd(collocation_points.rows(), 3);
-				// 	asd.col(0)=collocation_points.col(0);
-				// 	asd.col(1)=collocation_points.col(1);
-				// 	asd.col(2)=collocation_points.col(2);
-				// 	Eigen::VectorXd S = rhs.col(a);
-				// 	Eigen::MatrixXd C;
-				// 	igl::colormap(igl::COLOR_MAP_TYPE_VIRIDIS, S, true, C);
-				// 	viewer.data().add_points(asd, C);
-				// 	viewer.launch();
-				// }
+			std::vector<int> polytopes;
+			for (int e = 0; e < mesh.n_elements(); ++e)
+			{
+				if (mesh.is_polytope(e))
+					polytopes.push_back(e);
+			}
+			const int n_polytopes = polytopes.size();
 
-				// for(int asd = 0; asd < collocation_points.rows(); ++asd) {
-				//     viewer.data().add_label(collocation_points.row(asd), std::to_string(asd));
-				// }
+			const int poly_quadrature_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler.name(), 2, AssemblerUtils::BasisType::POLY, 3);
+			const int poly_mass_quadrature_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::POLY, 3);
 
-				// Compute the weights of the RBF kernels
-				Eigen::MatrixXd local_basis_integrals(rhs.cols(), basis_integrals.cols());
-				for (long k = 0; k < rhs.cols(); ++k)
-				{
-					local_basis_integrals.row(k) = -basis_integrals.row(local_to_global[k]);
-				}
-				auto set_rbf = [&b](auto rbf) {
-					b.set_bases_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
-						Eigen::MatrixXd tmp;
-						rbf->bases_values(uv, tmp);
-						val.resize(tmp.cols());
-						assert(tmp.rows() == uv.rows());
-
-						for (size_t i = 0; i < tmp.cols(); ++i)
-						{
-							val[i].val = tmp.col(i);
-						}
-					});
-					b.set_grads_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
-						Eigen::MatrixXd tmpx, tmpy, tmpz;
-
-						rbf->bases_grads(0, uv, tmpx);
-						rbf->bases_grads(1, uv, tmpy);
-						rbf->bases_grads(2, uv, tmpz);
-
-						val.resize(tmpx.cols());
-						assert(tmpx.cols() == tmpy.cols());
-						assert(tmpx.cols() == tmpz.cols());
-						assert(tmpx.rows() == uv.rows());
-						for (size_t i = 0; i < tmpx.cols(); ++i)
-						{
-							val[i].grad.resize(uv.rows(), uv.cols());
-							val[i].grad.col(0) = tmpx.col(i);
-							val[i].grad.col(1) = tmpy.col(i);
-							val[i].grad.col(2) = tmpz.col(i);
-						}
-					});
-				};
-				if (integral_constraints == 0)
-				{
-					set_rbf(std::make_shared<RBFWithLinear>(
-						kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs, false));
-				}
-				else if (integral_constraints == 1)
-				{
-					set_rbf(std::make_shared<RBFWithLinear>(
-						kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
-				}
-				else if (integral_constraints == 2)
+			// Step 2: Sample the polyhedra
+			std::vector<PolytopeSamples> samples(n_polytopes);
+			maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
 				{
-					set_rbf(std::make_shared<RBFWithQuadratic>(
-						// set_rbf(std::make_shared<RBFWithQuadraticLagrange>(
-						assembler, kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
+					const int e = polytopes[p];
+					PolytopeSamples &s = samples[p];
+
+					// No boundary polytope
+					// assert(element_type[e] != ElementType::BOUNDARY_POLYTOPE);
+
+					// Kernel distance to polygon boundary
+					const double eps = compute_epsilon(mesh, e);
+
+					double scaling;
+					Eigen::RowVector3d translation;
+					sample_polyhedra(e, 2, n_kernels_per_edge, n_samples_per_edge, poly_quadrature_order,
+									 mesh, poly_face_to_data, bases, gbases, eps, s.local_to_global,
+									 s.collocation_points, s.kernel_centers, s.rhs, s.triangulated_vertices,
+									 s.triangulated_faces, s.quadrature, s.decomposition, scaling, translation);
+					// b.scaling_ = scaling;
+					// b.translation_ = translation;
+
+					// igl::opengl::glfw::Viewer & viewer = UIState::ui_state().viewer;
+					// viewer.data().clear();
+					// viewer.data().set_mesh(triangulated_vertices, triangulated_faces);
+					// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
+					// add_spheres(viewer, kernel_centers, 0.005);
+
+					// Eigen::MatrixXd pts = triangulated_vertices, normals;
+					// Eigen::MatrixXi tris = triangulated_faces;
+					// igl::per_corner_normals(pts, tris, 20, normals);
+					// viewer.data().set_normals(normals);
+					// viewer.data().set_face_based(false);
+					// viewer.launch();
+
+					// for(int a = 0; rhs.cols();++a)
+					// 	{
+					// 	igl::opengl::glfw::Viewer viewer;
+					// 	Eigen::MatrixXd asd(collocation_points.rows(), 3);
+					// 	asd.col(0)=collocation_points.col(0);
+					// 	asd.col(1)=collocation_points.col(1);
+					// 	asd.col(2)=collocation_points.col(2);
+					// 	Eigen::VectorXd S = rhs.col(a);
+					// 	Eigen::MatrixXd C;
+					// 	igl::colormap(igl::COLOR_MAP_TYPE_VIRIDIS, S, true, C);
+					// 	viewer.data().add_points(asd, C);
+					// 	viewer.launch();
+					// }
+
+					// for(int asd = 0; asd < collocation_points.rows(); ++asd) {
+					//     viewer.data().add_label(collocation_points.row(asd), std::to_string(asd));
+					// }
+
+					s.local_basis_integrals.resize(s.rhs.cols(), basis_integrals.cols());
+					for (long k = 0; k < s.rhs.cols(); ++k)
+					{
+						s.local_basis_integrals.row(k) = -basis_integrals.row(s.local_to_global[k]);
+					}
+
+					// Polygon boundary after geometric mapping from neighboring elements
+					orient_closed_surface(s.triangulated_vertices, s.triangulated_faces, false); // stupid viewer is flipping all the faces
 				}
-				else
+			});
+
+			// Step 3: Compute the weights of the RBF kernels, once per group of translated polyhedra
+			const std::vector<int> representative = translated_groups(samples, integral_constraints <= 1);
+			std::vector<std::shared_ptr<const RBFWithLinear>> linear_rbfs(n_polytopes);
+			std::vector<std::shared_ptr<const RBFWithQuadratic>> quadratic_rbfs(n_polytopes);
+			maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
 				{
-					throw std::runtime_error(fmt::format("Unsupported constraint order: {:d}", integral_constraints));
+					if (representative[p] != p)
+						continue;
+
+					PolytopeSamples &s = samples[p];
+					if (integral_constraints == 2)
+					{
+						quadratic_rbfs[p] = std::make_shared<RBFWithQuadratic>(
+							// quadratic_rbfs[p] = std::make_shared<RBFWithQuadraticLagrange>(
+							assembler, s.kernel_centers, s.collocation_points, s.local_basis_integrals, s.quadrature, s.rhs);
+					}
+					else
+					{
+						Quadrature quadrature = s.quadrature;
+						quadrature.points.rowwise() -= s.origin();
+						linear_rbfs[p] = std::make_shared<RBFWithLinear>(
+							s.kernel_centers.rowwise() - s.origin(), s.collocation_points.rowwise() - s.origin(),
+							s.local_basis_integrals, quadrature, s.rhs, integral_constraints == 1);
+					}
 				}
+			});
 
-				// Set the bases which are nonzero inside the polygon
-				const int n_poly_bases = int(local_to_global.size());
-				b.bases.resize(n_poly_bases);
-				for (int i = 0; i < n_poly_bases; ++i)
+			// Step 4: Set the bases
+			maybe_parallel_for(n_polytopes, [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
 				{
-					b.bases[i].init(-2, local_to_global[i], i, Eigen::MatrixXd::Constant(1, 3, std::nan("")));
+					const PolytopeSamples &s = samples[p];
+					ElementBases &b = bases[polytopes[p]];
+					b.has_parameterization = false;
+
+					// only the tetrahedralization is stored, the points are expanded when the element values are computed
+					const std::shared_ptr<const SimplexDecomposition> decomposition = s.decomposition;
+					b.set_quadrature([decomposition, poly_quadrature_order](Quadrature &quad) { PolyhedronQuadrature::get_quadrature(*decomposition, poly_quadrature_order, quad); });
+					b.set_mass_quadrature([decomposition, poly_mass_quadrature_order](Quadrature &quad) { PolyhedronQuadrature::get_quadrature(*decomposition, poly_mass_quadrature_order, quad); });
+
+					auto set_rbf = [&b](auto rbf, const Eigen::RowVector3d &origin) {
+						b.set_bases_func([rbf, origin](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+							Eigen::MatrixXd tmp;
+							rbf->bases_values(uv.rowwise() - origin, tmp);
+							val.resize(tmp.cols());
+							assert(tmp.rows() == uv.rows());
+
+							for (size_t i = 0; i < tmp.cols(); ++i)
+							{
+								val[i].val = tmp.col(i);
+							}
+						});
+						b.set_grads_func([rbf, origin](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+							const Eigen::MatrixXd local_uv = uv.rowwise() - origin;
+							Eigen::MatrixXd tmpx, tmpy, tmpz;
+
+							rbf->bases_grads(0, local_uv, tmpx);
+							rbf->bases_grads(1, local_uv, tmpy);
+							rbf->bases_grads(2, local_uv, tmpz);
+
+							val.resize(tmpx.cols());
+							assert(tmpx.cols() == tmpy.cols());
+							assert(tmpx.cols() == tmpz.cols());
+							assert(tmpx.rows() == uv.rows());
+							for (size_t i = 0; i < tmpx.cols(); ++i)
+							{
+								val[i].grad.resize(uv.rows(), uv.cols());
+								val[i].grad.col(0) = tmpx.col(i);
+								val[i].grad.col(1) = tmpy.col(i);
+								val[i].grad.col(2) = tmpz.col(i);
+							}
+						});
+					};
+					if (integral_constraints == 2)
+						set_rbf(quadratic_rbfs[p], Eigen::RowVector3d::Zero());
+					else
+						set_rbf(linear_rbfs[representative[p]], s.origin());
+
+					// Set the bases which are nonzero inside the polygon
+					const int n_poly_bases = int(s.local_to_global.size());
+					b.bases.resize(n_poly_bases);
+					for (int i = 0; i < n_poly_bases; ++i)
+					{
+						b.bases[i].init(-2, s.local_to_global[i], i, Eigen::MatrixXd::Constant(1, 3, std::nan("")));
+					}
 				}
+			});
 
-				// Polygon boundary after geometric mapping from neighboring elements
-				orient_closed_surface(triangulated_vertices, triangulated_faces, false); // stupid viewer is flipping all the faces
-				mapped_boundary[e].first = triangulated_vertices;
-				mapped_boundary[e].second = triangulated_faces;
+			for (int p = 0; p < n_polytopes; ++p)
+			{
+				mapped_boundary[polytopes[p]].first = samples[p].triangulated_vertices;
+				mapped_boundary[polytopes[p]].second = samples[p].triangulated_faces;
 			}
 
 			return 0;
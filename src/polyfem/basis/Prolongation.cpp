@@ -0,0 +1,76 @@
+#include "Prolongation.hpp"
+
+#include <polyfem/assembler/AssemblyValues.hpp>
+#include <polyfem/quadrature/Quadrature.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <Eigen/Dense>
+
+namespace polyfem::basis
+{
+	void p_prolongation(
+		const std::vector<ElementBases> &fine_bases,
+		const std::vector<ElementBases> &coarse_bases,
+		const int n_fine_bases,
+		const int n_coarse_bases,
+		const int dim,
+		StiffnessMatrix &P)
+	{
+		if (fine_bases.size() != coarse_bases.size())
+			log_and_throw_error("p_prolongation(): the two discretizations must have the same elements!");
+
+		// every fine node gets its row once, from the first element containing it
+		std::vector<bool> visited(n_fine_bases, false);
+		std::vector<Eigen::Triplet<double>> entries;
+
+		for (int e = 0; e < fine_bases.size(); ++e)
+		{
+			const ElementBases &fine = fine_bases[e];
+			const ElementBases &coarse = coarse_bases[e];
+
+			// local L2 projection of the coarse bases onto the fine ones, exact since the spaces are nested
+			quadrature::Quadrature quadrature;
+			fine.compute_mass_quadrature(quadrature);
+
+			std::vector<assembler::AssemblyValues> fine_vals, coarse_vals;
+			fine.evaluate_bases(quadrature.points, fine_vals);
+			coarse.evaluate_bases(quadrature.points, coarse_vals);
+
+			Eigen::MatrixXd Nf(quadrature.size(), fine_vals.size());
+			for (int j = 0; j < fine_vals.size(); ++j)
+				Nf.col(j) = fine_vals[j].val;
+			Eigen::MatrixXd Nc(quadrature.size(), coarse_vals.size());
+			for (int k = 0; k < coarse_vals.size(); ++k)
+				Nc.col(k) = coarse_vals[k].val;
+
+			const Eigen::MatrixXd M_ff = Nf.transpose() * quadrature.weights.asDiagonal() * Nf;
+			const Eigen::MatrixXd M_fc = Nf.transpose() * quadrature.weights.asDiagonal() * Nc;
+			const Eigen::MatrixXd local_P = M_ff.ldlt().solve(M_fc);
+
+			for (int j = 0; j < fine.bases.size(); ++j)
+			{
+				const auto &fine_global = fine.bases[j].global();
+				if (fine_global.size() != 1)
+					log_and_throw_error("p_prolongation(): only conforming fine discretizations are supported!");
+
+				const int row = fine_global[0].index;
+				if (visited[row])
+					continue;
+				visited[row] = true;
+
+				for (int k = 0; k < coarse.bases.size(); ++k)
+				{
+					if (std::abs(local_P(j, k)) < 1e-12)
+						continue;
+					for (const Local2Global &g : coarse.bases[k].global())
+						for (int d = 0; d < dim; ++d)
+							entries.emplace_back(row * dim + d, g.index * dim + d, local_P(j, k) * g.val);
+				}
+			}
+		}
+
+		P.resize(n_fine_bases * dim, n_coarse_bases * dim);
+		P.setFromTriplets(entries.begin(), entries.end());
+		P.makeCompressed();
+	}
+} // namespace polyfem::basis
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <vector>
+
+namespace polyfem::basis
+{
+	/// @brief Build the prolongation from a coarse to a fine discretization of the same mesh (e.g., P1 to P2),
+	/// the operator used by geometric and p-multigrid methods. The coarse space must be contained in the fine one.
+	/// @param[in] fine_bases Bases of the fine discretization
+	/// @param[in] coarse_bases Bases of the coarse discretization, on the same elements
+	/// @param[in] n_fine_bases Number of fine nodes
+	/// @param[in] n_coarse_bases Number of coarse nodes
+	/// @param[in] dim Number of components per node, the scalar operator is repeated for each component
+	/// @param[out] P Prolongation matrix of size (n_fine_bases * dim) x (n_coarse_bases * dim)
+	void p_prolongation(
+		const std::vector<ElementBases> &fine_bases,
+		const std::vector<ElementBases> &coarse_bases,
+		const int n_fine_bases,
+		const int n_coarse_bases,
+		const int dim,
+		StiffnessMatrix &P);
+} // namespace polyfem::basis
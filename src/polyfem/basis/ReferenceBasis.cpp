@@ -0,0 +1,163 @@
+#include "ReferenceBasis.hpp"
+
+#include <polyfem/autogen/auto_p_bases.hpp>
+#include <polyfem/autogen/auto_p_bases_batched.hpp>
+#include <polyfem/autogen/auto_q_bases.hpp>
+
+#include <cstring>
+#include <map>
+#include <string_view>
+
+namespace polyfem
+{
+	using namespace assembler;
+
+	namespace basis
+	{
+		namespace
+		{
+			bool same_points(const Eigen::MatrixXd &a, const Eigen::MatrixXd &b)
+			{
+				return a.rows() == b.rows() && a.cols() == b.cols()
+					   && (a.size() == 0 || std::memcmp(a.data(), b.data(), sizeof(double) * a.size()) == 0);
+			}
+
+			size_t hash_points(const Eigen::MatrixXd &uv)
+			{
+				const std::string_view data(reinterpret_cast<const char *>(uv.data()), sizeof(double) * uv.size());
+				return std::hash<std::string_view>()(data) ^ (size_t(uv.rows()) << 1) ^ (size_t(uv.cols()) << 33);
+			}
+		} // namespace
+
+		std::shared_ptr<const ReferenceBasis> ReferenceBasis::get(const ElementType type, const int order)
+		{
+			static std::mutex mutex;
+			static std::map<std::pair<ElementType, int>, std::shared_ptr<const ReferenceBasis>> registry;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			auto &ref = registry[{type, order}];
+			if (!ref)
+				ref = std::make_shared<const ReferenceBasis>(type, order);
+			return ref;
+		}
+
+		ReferenceBasis::ReferenceBasis(const ElementType type, const int order)
+			: type_(type), order_(order)
+		{
+			Eigen::MatrixXd nodes;
+			switch (type)
+			{
+			case ElementType::TRI:
+				autogen::p_nodes_2d(order, nodes);
+				basis_ = &autogen::p_basis_value_2d;
+				grad_ = &autogen::p_grad_basis_value_2d;
+				basis_values_ = &autogen::p_basis_values_2d;
+				grad_values_ = &autogen::p_grad_basis_values_2d;
+				break;
+			case ElementType::QUAD:
+				autogen::q_nodes_2d(order, nodes);
+				basis_ = &autogen::q_basis_value_2d;
+				grad_ = &autogen::q_grad_basis_value_2d;
+				basis_values_ = &autogen::q_basis_values_2d;
+				grad_values_ = &autogen::q_grad_basis_values_2d;
+				break;
+			case ElementType::TET:
+				autogen::p_nodes_3d(order, nodes);
+				basis_ = &autogen::p_basis_value_3d;
+				grad_ = &autogen::p_grad_basis_value_3d;
+				basis_values_ = &autogen::p_basis_values_3d;
+				grad_values_ = &autogen::p_grad_basis_values_3d;
+				break;
+			case ElementType::HEX:
+				autogen::q_nodes_3d(order, nodes);
+				basis_ = &autogen::q_basis_value_3d;
+				grad_ = &autogen::q_grad_basis_value_3d;
+				basis_values_ = &autogen::q_basis_values_3d;
+				grad_values_ = &autogen::q_grad_basis_values_3d;
+				break;
+			}
+			n_bases_ = nodes.rows();
+		}
+
+		const ReferenceBasis::Table *ReferenceBasis::table(const Eigen::MatrixXd &uv) const
+		{
+			const int n = n_tables_.load(std::memory_order_acquire);
+			for (int i = 0; i < n; ++i)
+				if (same_points(tables_[i]->uv, uv))
+					return tables_[i];
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			const int m = n_tables_.load(std::memory_order_relaxed);
+			for (int i = n; i < m; ++i)
+				if (same_points(tables_[i]->uv, uv))
+					return tables_[i];
+
+			if (m >= max_tables)
+				return nullptr;
+
+			// one-off points (e.g., the nodes of a constrained basis) are not worth a table,
+			// a set of points is tabulated the second time it is requested
+			const size_t key = hash_points(uv);
+			if (seen_.size() > 1024)
+				seen_.clear();
+			if (seen_.insert(key).second)
+				return nullptr;
+
+			auto table = std::make_unique<Table>();
+			table->uv = uv;
+			table->val.resize(n_bases_);
+			table->grad.resize(n_bases_);
+
+			Eigen::MatrixXd val, grad;
+			basis_values_(order_, uv, val);
+			grad_values_(order_, uv, grad);
+			assert(val.cols() == n_bases_ && grad.cols() == n_bases_ * uv.cols());
+			for (int i = 0; i < n_bases_; ++i)
+			{
+				table->val[i] = val.col(i);
+				table->grad[i] = grad.middleCols(i * uv.cols(), uv.cols());
+			}
+
+			tables_[m] = table.get();
+			owned_tables_.push_back(std::move(table));
+			n_tables_.store(m + 1, std::memory_order_release);
+			return tables_[m];
+		}
+
+		void ReferenceBasis::evaluate_bases(const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) const
+		{
+			basis_values.resize(n_bases_);
+
+			if (const Table *t = table(uv))
+			{
+				for (int i = 0; i < n_bases_; ++i)
+					basis_values[i].val = t->val[i];
+				return;
+			}
+
+			Eigen::MatrixXd val;
+			basis_values_(order_, uv, val);
+			assert(val.rows() == uv.rows() && val.cols() == n_bases_);
+			for (int i = 0; i < n_bases_; ++i)
+				basis_values[i].val = val.col(i);
+		}
+
+		void ReferenceBasis::evaluate_grads(const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) const
+		{
+			basis_values.resize(n_bases_);
+
+			if (const Table *t = table(uv))
+			{
+				for (int i = 0; i < n_bases_; ++i)
+					basis_values[i].grad = t->grad[i];
+				return;
+			}
+
+			Eigen::MatrixXd grad;
+			grad_values_(order_, uv, grad);
+			assert(grad.rows() == uv.rows() && grad.cols() == n_bases_ * uv.cols());
+			for (int i = 0; i < n_bases_; ++i)
+				basis_values[i].grad = grad.middleCols(i * uv.cols(), uv.cols());
+		}
+	} // namespace basis
+} // namespace polyfem
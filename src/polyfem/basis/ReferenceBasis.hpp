@@ -0,0 +1,92 @@
+#pragma once
+
+#include <polyfem/basis/Basis.hpp>
+#include <polyfem/assembler/AssemblyValues.hpp>
+
+#include <Eigen/Dense>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		///
+		/// @brief      Lagrange bases of a reference element, shared by all the elements with the same type and order.
+		///             The evaluations at a set of points requested more than once (typically a quadrature rule)
+		///             are tabulated and copied afterwards.
+		///
+		class ReferenceBasis
+		{
+		public:
+			enum class ElementType
+			{
+				TRI,
+				QUAD,
+				TET,
+				HEX
+			};
+
+			///
+			/// @brief      Shared reference basis of an element type
+			///
+			/// @param[in]  type   reference element
+			/// @param[in]  order  order of the bases, -2 for the serendipity quads and hexes
+			///
+			static std::shared_ptr<const ReferenceBasis> get(const ElementType type, const int order);
+
+			ReferenceBasis(const ElementType type, const int order);
+
+			ElementType type() const { return type_; }
+			int order() const { return order_; }
+			int n_bases() const { return n_bases_; }
+
+			/// value and gradient functions of the basis, see Basis::set_reference
+			Basis::RefFun basis_function() const { return basis_; }
+			Basis::RefFun grad_function() const { return grad_; }
+
+			/// evaluate the bases at uv, same layout as ElementBases::evaluate_bases
+			void evaluate_bases(const Eigen::MatrixXd &uv, std::vector<assembler::AssemblyValues> &basis_values) const;
+			/// evaluate the gradients of the bases at uv, same layout as ElementBases::evaluate_grads
+			void evaluate_grads(const Eigen::MatrixXd &uv, std::vector<assembler::AssemblyValues> &basis_values) const;
+
+		private:
+			/// all the bases at once, val.col(i) is the basis i and val.middleCols(dim * i, dim) its gradient
+			typedef void (*BatchedFun)(const int order, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+			struct Table
+			{
+				Eigen::MatrixXd uv;
+				std::vector<Eigen::MatrixXd> val;
+				std::vector<Eigen::MatrixXd> grad;
+			};
+
+			/// tabulated evaluation at uv, nullptr if uv is not tabulated and there is no room left
+			const Table *table(const Eigen::MatrixXd &uv) const;
+
+			/// enough for the quadrature rules of a run, the other points are evaluated directly
+			static constexpr int max_tables = 32;
+
+			ElementType type_;
+			int order_;
+			int n_bases_;
+			Basis::RefFun basis_;
+			Basis::RefFun grad_;
+			BatchedFun basis_values_;
+			BatchedFun grad_values_;
+
+			/// tables_[0, n_tables_) are read without locking, the mutex guards the insertion
+			mutable std::mutex mutex_;
+			mutable std::vector<std::unique_ptr<Table>> owned_tables_;
+			mutable std::array<const Table *, max_tables> tables_;
+			mutable std::atomic<int> n_tables_ = 0;
+			/// hashes of the points requested once
+			mutable std::unordered_set<size_t> seen_;
+		};
+	} // namespace basis
+} // namespace polyfem
@@ -2,8 +2,9 @@
 
 #include "LagrangeBasis2d.hpp"
 #include "function/QuadraticBSpline2d.hpp"
+#include "function/QuadraticTensorBSpline.hpp"
 
-#include <polyfem/quadrature/QuadQuadrature.hpp>
+#include <polyfem/quadrature/QuadratureRegistry.hpp>
 #include <polyfem/mesh/MeshNodes.hpp>
 
 #include <polyfem/assembler/AssemblerUtils.hpp>
@@ -709,14 +710,8 @@ namespace polyfem
 				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, 2, AssemblerUtils::BasisType::SPLINE, 2);
 				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::SPLINE, 2);
 
-				b.set_quadrature([real_order](Quadrature &quad) {
-					QuadQuadrature quad_quadrature;
-					quad_quadrature.get_quadrature(real_order, quad);
-				});
-				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-					QuadQuadrature quad_quadrature;
-					quad_quadrature.get_quadrature(real_mass_order, quad);
-				});
+				b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Quad, real_order));
+				b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Quad, real_mass_order));
 				b.bases.resize(9);
 
 				b.set_local_node_from_primitive_func([e](const int primitive_id, const Mesh &mesh) {
@@ -762,6 +757,11 @@ namespace polyfem
 
 				basis_for_regular_quad(space, loc_nodes, h_knots, v_knots, b);
 				basis_for_irregulard_quad(e, mesh, mesh_nodes, space, loc_nodes, h_knots, v_knots, b);
+
+				// all the 9 bases are products of the 1D splines of the knots
+				const auto tensor = std::make_shared<const QuadraticTensorBSpline>(std::vector<std::array<std::array<double, 4>, 3>>{h_knots, v_knots});
+				b.set_bases_func([tensor](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) { tensor->evaluate_bases(uv, basis_values); });
+				b.set_grads_func([tensor](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) { tensor->evaluate_grads(uv, basis_values); });
 			}
 
 			std::set<int> edge_id;
@@ -779,14 +779,8 @@ namespace polyfem
 				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, 2, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
 				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
 
-				b.set_quadrature([real_order](Quadrature &quad) {
-					QuadQuadrature quad_quadrature;
-					quad_quadrature.get_quadrature(real_order, quad);
-				});
-				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-					QuadQuadrature quad_quadrature;
-					quad_quadrature.get_quadrature(real_mass_order, quad);
-				});
+				b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Quad, real_order));
+				b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Quad, real_mass_order));
 
 				b.set_local_node_from_primitive_func([e](const int primitive_id, const Mesh &mesh) {
 					const auto &mesh2d = dynamic_cast<const Mesh2D &>(mesh);
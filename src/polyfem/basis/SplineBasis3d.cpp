@@ -2,7 +2,8 @@
 
 #include "LagrangeBasis3d.hpp"
 #include "function/QuadraticBSpline3d.hpp"
-#include <polyfem/quadrature/HexQuadrature.hpp>
+#include "function/QuadraticTensorBSpline.hpp"
+#include <polyfem/quadrature/QuadratureRegistry.hpp>
 
 #include <polyfem/assembler/AssemblerUtils.hpp>
 
@@ -1057,14 +1058,8 @@ namespace polyfem
 				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, 2, AssemblerUtils::BasisType::SPLINE, 3);
 				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::SPLINE, 3);
 
-				b.set_quadrature([real_order](Quadrature &quad) {
-					HexQuadrature hex_quadrature;
-					hex_quadrature.get_quadrature(real_order, quad);
-				});
-				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-					HexQuadrature hex_quadrature;
-					hex_quadrature.get_quadrature(real_mass_order, quad);
-				});
+				b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Hexahedron, real_order));
+				b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Hexahedron, real_mass_order));
 				// hex_quadrature.get_quadrature(quadrature_order, b.quadrature);
 				b.bases.resize(27);
 
@@ -1110,6 +1105,15 @@ namespace polyfem
 
 				basis_for_regular_hex(mesh_nodes, space, h_knots, v_knots, w_knots, b);
 				basis_for_irregulard_hex(e, mesh, mesh_nodes, space, h_knots, v_knots, w_knots, b, poly_face_to_data);
+
+				// all the 27 bases are products of the 1D splines of the knots
+				const auto tensor = std::make_shared<const QuadraticTensorBSpline>(std::vector<std::array<std::array<double, 4>, 3>>{h_knots, v_knots, w_knots});
+				b.set_bases_func([tensor](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) { tensor->evaluate_bases(uv, basis_values); });
+				b.set_grads_func([tensor](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) { tensor->evaluate_grads(uv, basis_values); });
+				b.set_tensor_tables_func([tensor](const Eigen::VectorXd &points_1d, std::array<Eigen::MatrixXd, 3> &val, std::array<Eigen::MatrixXd, 3> &grad) {
+					for (int d = 0; d < 3; ++d)
+						tensor->tables_1d(d, points_1d, val[d], grad[d]);
+				});
 			}
 
 			int n_bases = mesh_nodes.n_nodes();
@@ -1129,14 +1133,8 @@ namespace polyfem
 				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
 
 				// hex_quadrature.get_quadrature(quadrature_order, b.quadrature);
-				b.set_quadrature([real_order](Quadrature &quad) {
-					HexQuadrature hex_quadrature;
-					hex_quadrature.get_quadrature(real_order, quad);
-				});
-				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-					HexQuadrature hex_quadrature;
-					hex_quadrature.get_quadrature(real_mass_order, quad);
-				});
+				b.set_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Hexahedron, real_order));
+				b.set_mass_quadrature(QuadratureRegistry::builder(QuadratureRegistry::ElementType::Hexahedron, real_mass_order));
 
 				b.set_local_node_from_primitive_func([e](const int primitive_id, const Mesh &mesh) {
 					const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
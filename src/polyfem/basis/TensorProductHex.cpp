@@ -0,0 +1,177 @@
+#include "TensorProductHex.hpp"
+
+#include <polyfem/autogen/auto_q_bases.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <cmath>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		TensorProductHex::TensorProductHex(const int order, const Eigen::VectorXd &points_1d)
+			: order_(order), n_nodes_1d_(order + 1), n_points_1d_(points_1d.size()), points_1d_(points_1d)
+		{
+			if (order < 1)
+				log_and_throw_error("Sum factorization needs Q_q bases with q >= 1, got q={}", order);
+
+			// 1D Lagrange polynomials on the equispaced nodes i / q
+			Eigen::MatrixXd val_1d(n_points_1d_, n_nodes_1d_);
+			Eigen::MatrixXd grad_1d(n_points_1d_, n_nodes_1d_);
+			for (int p = 0; p < n_points_1d_; ++p)
+			{
+				const double x = points_1d(p);
+				for (int i = 0; i < n_nodes_1d_; ++i)
+				{
+					const double xi = double(i) / order;
+					double val = 1;
+					double grad = 0;
+					for (int k = 0; k < n_nodes_1d_; ++k)
+					{
+						if (k == i)
+							continue;
+						const double xk = double(k) / order;
+						grad = grad * (x - xk) / (xi - xk) + val / (xi - xk);
+						val *= (x - xk) / (xi - xk);
+					}
+					val_1d(p, i) = val;
+					grad_1d(p, i) = grad;
+				}
+			}
+			val_1d_.fill(val_1d);
+			grad_1d_.fill(grad_1d);
+
+			// the 3D bases are the products of the 1D ones of their node coordinates
+			Eigen::MatrixXd nodes;
+			autogen::q_nodes_3d(order, nodes);
+			assert(nodes.rows() == n_bases());
+			lexicographic_.resize(nodes.rows());
+			for (int j = 0; j < nodes.rows(); ++j)
+			{
+				const int x = int(std::lround(nodes(j, 0) * order));
+				const int y = int(std::lround(nodes(j, 1) * order));
+				const int z = int(std::lround(nodes(j, 2) * order));
+				lexicographic_[j] = (z * n_nodes_1d_ + y) * n_nodes_1d_ + x;
+			}
+		}
+
+		TensorProductHex::TensorProductHex(const std::array<Eigen::MatrixXd, 3> &val_1d, const std::array<Eigen::MatrixXd, 3> &grad_1d, const std::vector<int> &lexicographic)
+			: order_(-1), n_nodes_1d_(val_1d[0].cols()), n_points_1d_(val_1d[0].rows()), val_1d_(val_1d), grad_1d_(grad_1d), lexicographic_(lexicographic)
+		{
+			for (int d = 0; d < 3; ++d)
+			{
+				if (val_1d[d].rows() != n_points_1d_ || val_1d[d].cols() != n_nodes_1d_ || grad_1d[d].rows() != n_points_1d_ || grad_1d[d].cols() != n_nodes_1d_)
+					log_and_throw_error("Inconsistent 1D tables of a tensor-product hex");
+			}
+
+			if (lexicographic_.empty())
+			{
+				lexicographic_.resize(n_bases());
+				for (int j = 0; j < n_bases(); ++j)
+					lexicographic_[j] = j;
+			}
+			assert(lexicographic_.size() == n_bases());
+		}
+
+		bool TensorProductHex::tensor_points(const quadrature::Quadrature &quad, Eigen::VectorXd &points_1d)
+		{
+			if (quad.points.cols() != 3)
+				return false;
+
+			const int n_points = quad.points.rows();
+			const int n = int(std::lround(std::cbrt(double(n_points))));
+			if (n <= 0 || n * n * n != n_points)
+				return false;
+
+			points_1d = quad.points.col(0).head(n);
+			for (int i = 0; i < n; ++i)
+				for (int j = 0; j < n; ++j)
+					for (int k = 0; k < n; ++k)
+					{
+						const int index = (i * n + j) * n + k;
+						if (quad.points(index, 0) != points_1d(k) || quad.points(index, 1) != points_1d(j) || quad.points(index, 2) != points_1d(i))
+							return false;
+					}
+
+			return true;
+		}
+
+		bool TensorProductHex::is_tensor_product(const ElementBases &bases)
+		{
+			if (bases.tensor_tables_func())
+				return true;
+
+			const auto &reference = bases.reference_basis();
+			return reference && reference->type() == ReferenceBasis::ElementType::HEX && reference->order() >= 1;
+		}
+
+		void TensorProductHex::interpolate(const double *in, const Eigen::MatrixXd &x, const Eigen::MatrixXd &y, const Eigen::MatrixXd &z, double *out) const
+		{
+			const int nn = n_nodes_1d_;
+			const int np = n_points_1d_;
+
+			// contract x, the columns are (y, z)
+			const Eigen::MatrixXd tx = x * Eigen::Map<const Eigen::MatrixXd>(in, nn, nn * nn);
+
+			// contract y slice by slice, the rows are (x, y) and the columns z
+			Eigen::MatrixXd txy(np * np, nn);
+			for (int k = 0; k < nn; ++k)
+				Eigen::Map<Eigen::MatrixXd>(txy.col(k).data(), np, np).noalias() = tx.middleCols(k * nn, nn) * y.transpose();
+
+			Eigen::Map<Eigen::MatrixXd>(out, np * np, np).noalias() = txy * z.transpose();
+		}
+
+		void TensorProductHex::interpolate_transpose(const double *in, const Eigen::MatrixXd &x, const Eigen::MatrixXd &y, const Eigen::MatrixXd &z, double *out) const
+		{
+			const int nn = n_nodes_1d_;
+			const int np = n_points_1d_;
+
+			const Eigen::MatrixXd tz = Eigen::Map<const Eigen::MatrixXd>(in, np * np, np) * z;
+
+			Eigen::MatrixXd tyz(np, nn * nn);
+			for (int k = 0; k < nn; ++k)
+				tyz.middleCols(k * nn, nn).noalias() = Eigen::Map<const Eigen::MatrixXd>(tz.col(k).data(), np, np) * y;
+
+			Eigen::Map<Eigen::MatrixXd>(out, nn, nn * nn).noalias() += x.transpose() * tyz;
+		}
+
+		void TensorProductHex::gradients(const Eigen::MatrixXd &coeffs, std::array<Eigen::MatrixXd, 3> &grads) const
+		{
+			assert(coeffs.rows() == n_bases());
+
+			for (auto &g : grads)
+				g.resize(n_quadrature_points(), coeffs.cols());
+
+			Eigen::VectorXd lex(n_bases());
+			for (int c = 0; c < coeffs.cols(); ++c)
+			{
+				for (int j = 0; j < n_bases(); ++j)
+					lex(lexicographic_[j]) = coeffs(j, c);
+
+				interpolate(lex.data(), grad_1d_[0], val_1d_[1], val_1d_[2], grads[0].col(c).data());
+				interpolate(lex.data(), val_1d_[0], grad_1d_[1], val_1d_[2], grads[1].col(c).data());
+				interpolate(lex.data(), val_1d_[0], val_1d_[1], grad_1d_[2], grads[2].col(c).data());
+			}
+		}
+
+		void TensorProductHex::integrate_gradients(const std::array<Eigen::MatrixXd, 3> &fluxes, Eigen::MatrixXd &out) const
+		{
+			const int m = fluxes[0].cols();
+			assert(fluxes[0].rows() == n_quadrature_points());
+
+			out.resize(n_bases(), m);
+
+			Eigen::VectorXd lex(n_bases());
+			for (int c = 0; c < m; ++c)
+			{
+				lex.setZero();
+				interpolate_transpose(fluxes[0].col(c).data(), grad_1d_[0], val_1d_[1], val_1d_[2], lex.data());
+				interpolate_transpose(fluxes[1].col(c).data(), val_1d_[0], grad_1d_[1], val_1d_[2], lex.data());
+				interpolate_transpose(fluxes[2].col(c).data(), val_1d_[0], val_1d_[1], grad_1d_[2], lex.data());
+
+				for (int j = 0; j < n_bases(); ++j)
+					out(j, c) = lex(lexicographic_[j]);
+			}
+		}
+	} // namespace basis
+} // namespace polyfem
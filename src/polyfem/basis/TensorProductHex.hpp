@@ -0,0 +1,88 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/quadrature/Quadrature.hpp>
+
+#include <Eigen/Dense>
+
+#include <array>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		///
+		/// @brief      Sum-factorized evaluation of the Q_q Lagrange bases of a hex on a tensor-product quadrature.
+		///             The 3D bases are products of 1D Lagrange polynomials on equispaced nodes, the gradients at
+		///             the quadrature points are computed one direction at a time in O(q^4) instead of O(q^6).
+		///
+		class TensorProductHex
+		{
+		public:
+			///
+			/// @param[in]  order      order q >= 1 of the bases
+			/// @param[in]  points_1d  1D quadrature points, the 3D points are their tensor product with x fastest
+			///
+			TensorProductHex(const int order, const Eigen::VectorXd &points_1d);
+
+			///
+			/// @param[in]  val_1d         n_points_1d x n_nodes_1d values of the 1D bases of every direction
+			/// @param[in]  grad_1d        their derivatives
+			/// @param[in]  lexicographic  lexicographic index of the local bases, identity if empty
+			///
+			TensorProductHex(const std::array<Eigen::MatrixXd, 3> &val_1d, const std::array<Eigen::MatrixXd, 3> &grad_1d, const std::vector<int> &lexicographic = {});
+
+			///
+			/// @brief      1D points of a tensor-product quadrature in the layout of HexQuadrature
+			///
+			/// @return     false if quad is not a tensor-product rule
+			///
+			static bool tensor_points(const quadrature::Quadrature &quad, Eigen::VectorXd &points_1d);
+
+			/// true if the bases of the element are the Q_q Lagrange bases of a hex with q >= 1 or have tensor tables
+			static bool is_tensor_product(const ElementBases &bases);
+
+			/// order of the Lagrange bases, -1 if built from tables
+			int order() const { return order_; }
+
+			int n_bases() const { return n_nodes_1d_ * n_nodes_1d_ * n_nodes_1d_; }
+			int n_quadrature_points() const { return n_points_1d_ * n_points_1d_ * n_points_1d_; }
+			bool matches(const int order, const Eigen::VectorXd &points_1d) const { return order == order_ && points_1d.size() == points_1d_.size() && points_1d == points_1d_; }
+
+			///
+			/// @brief      reference gradients of the interpolated fields at the quadrature points
+			///
+			/// @param[in]  coeffs  n_bases x m coefficients, in the local order of the element bases
+			/// @param[out] grads   grads[r] is n_quadrature_points x m, derivative along the reference direction r
+			///
+			void gradients(const Eigen::MatrixXd &coeffs, std::array<Eigen::MatrixXd, 3> &grads) const;
+
+			///
+			/// @brief      transpose of gradients, out(j, c) = sum_q sum_r fluxes[r](q, c) d phi_j / d xi_r (q)
+			///
+			/// @param[in]  fluxes  fluxes[r] is n_quadrature_points x m, already scaled by the quadrature weights
+			/// @param[out] out     n_bases x m, in the local order of the element bases
+			///
+			void integrate_gradients(const std::array<Eigen::MatrixXd, 3> &fluxes, Eigen::MatrixXd &out) const;
+
+		private:
+			/// out = (z (x) y (x) x) in, in is n_nodes_1d^3 and out n_points_1d^3, x fastest
+			void interpolate(const double *in, const Eigen::MatrixXd &x, const Eigen::MatrixXd &y, const Eigen::MatrixXd &z, double *out) const;
+			/// out += transpose of interpolate
+			void interpolate_transpose(const double *in, const Eigen::MatrixXd &x, const Eigen::MatrixXd &y, const Eigen::MatrixXd &z, double *out) const;
+
+			int order_;
+			int n_nodes_1d_;
+			int n_points_1d_;
+			Eigen::VectorXd points_1d_;
+
+			/// n_points_1d x n_nodes_1d values and derivatives of the 1D bases of every direction
+			std::array<Eigen::MatrixXd, 3> val_1d_;
+			std::array<Eigen::MatrixXd, 3> grad_1d_;
+
+			/// lexicographic index of the local bases
+			std::vector<int> lexicographic_;
+		};
+	} // namespace basis
+} // namespace polyfem
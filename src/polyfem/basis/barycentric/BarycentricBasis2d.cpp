@@ -134,7 +134,9 @@ namespace polyfem
 
 			std::map<int, int> new_nodes;
 
-			PolygonQuadrature poly_quadr;
+			const int poly_quadrature_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler_name, 1, AssemblerUtils::BasisType::POLY, 2);
+			const int poly_mass_quadrature_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 1, AssemblerUtils::BasisType::POLY, 2);
+
 			for (int e = 0; e < mesh.n_elements(); ++e)
 			{
 				if (!mesh.is_polytope(e))
@@ -172,15 +174,10 @@ namespace polyfem
 				ElementBases &b = bases[e];
 				b.has_parameterization = false;
 
-				// Compute quadrature points for the polygon
-				Quadrature tmp_quadrature;
-				poly_quadr.get_quadrature(polygon, quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler_name, 1, AssemblerUtils::BasisType::POLY, 2), tmp_quadrature);
-
-				Quadrature tmp_mass_quadrature;
-				poly_quadr.get_quadrature(polygon, mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 1, AssemblerUtils::BasisType::POLY, 2), tmp_mass_quadrature);
-
-				b.set_quadrature([tmp_quadrature](Quadrature &quad) { quad = tmp_quadrature; });
-				b.set_mass_quadrature([tmp_mass_quadrature](Quadrature &quad) { quad = tmp_mass_quadrature; });
+				// Triangulate the polygon once, the quadrature points are expanded on demand
+				const std::shared_ptr<const SimplexDecomposition> decomposition = PolygonQuadrature::decompose(polygon);
+				b.set_quadrature([decomposition, poly_quadrature_order](Quadrature &quad) { PolygonQuadrature::get_quadrature(*decomposition, poly_quadrature_order, quad); });
+				b.set_mass_quadrature([decomposition, poly_mass_quadrature_order](Quadrature &quad) { PolygonQuadrature::get_quadrature(*decomposition, poly_mass_quadrature_order, quad); });
 
 				const double tol = 1e-10;
 				b.set_bases_func([polygon, tol, bc](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
@@ -0,0 +1,78 @@
+#include "QuadraticTensorBSpline.hpp"
+
+#include <cassert>
+
+namespace polyfem
+{
+	using namespace assembler;
+
+	namespace basis
+	{
+		QuadraticTensorBSpline::QuadraticTensorBSpline(const std::vector<std::array<std::array<double, 4>, 3>> &knots)
+		{
+			assert(knots.size() == 2 || knots.size() == 3);
+
+			splines_.resize(knots.size());
+			for (size_t d = 0; d < knots.size(); ++d)
+				for (int i = 0; i < 3; ++i)
+					splines_[d][i].init(knots[d][i]);
+		}
+
+		void QuadraticTensorBSpline::tables_1d(const int d, const Eigen::VectorXd &ts, Eigen::MatrixXd &val, Eigen::MatrixXd &grad) const
+		{
+			val.resize(ts.size(), 3);
+			grad.resize(ts.size(), 3);
+
+			for (long p = 0; p < ts.size(); ++p)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					val(p, i) = splines_[d][i].interpolate(ts(p));
+					grad(p, i) = splines_[d][i].derivative(ts(p));
+				}
+			}
+		}
+
+		void QuadraticTensorBSpline::evaluate_bases(const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) const
+		{
+			assert(uv.cols() == dim());
+			basis_values.resize(n_bases());
+
+			std::array<Eigen::MatrixXd, 3> val, grad;
+			for (int d = 0; d < dim(); ++d)
+				tables_1d(d, uv.col(d), val[d], grad[d]);
+
+			for (int j = 0; j < n_bases(); ++j)
+			{
+				Eigen::MatrixXd &res = basis_values[j].val;
+				res = val[0].col(j % 3).cwiseProduct(val[1].col((j / 3) % 3));
+				if (dim() == 3)
+					res.array() *= val[2].col(j / 9).array();
+			}
+		}
+
+		void QuadraticTensorBSpline::evaluate_grads(const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) const
+		{
+			assert(uv.cols() == dim());
+			basis_values.resize(n_bases());
+
+			std::array<Eigen::MatrixXd, 3> val, grad;
+			for (int d = 0; d < dim(); ++d)
+				tables_1d(d, uv.col(d), val[d], grad[d]);
+
+			for (int j = 0; j < n_bases(); ++j)
+			{
+				const std::array<int, 3> index = {{j % 3, (j / 3) % 3, j / 9}};
+
+				Eigen::MatrixXd &res = basis_values[j].grad;
+				res.resize(uv.rows(), dim());
+				for (int r = 0; r < dim(); ++r)
+				{
+					res.col(r).setOnes();
+					for (int d = 0; d < dim(); ++d)
+						res.col(r).array() *= (d == r ? grad[d] : val[d]).col(index[d]).array();
+				}
+			}
+		}
+	} // namespace basis
+} // namespace polyfem
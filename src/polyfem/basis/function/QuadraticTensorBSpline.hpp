@@ -0,0 +1,40 @@
+#pragma once
+
+#include "QuadraticBSpline.hpp"
+
+#include <polyfem/assembler/AssemblyValues.hpp>
+
+#include <array>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		/// The 3^dim tensor-product quadratic B-splines of a spline element, the local basis (z * 3 + y) * 3 + x is the
+		/// product of the x-th, y-th and z-th splines of the directions. The 1D splines are evaluated once per direction
+		/// and point instead of once per basis.
+		class QuadraticTensorBSpline
+		{
+		public:
+			/// @param[in]  knots  the knots of the 3 splines of every direction
+			QuadraticTensorBSpline(const std::vector<std::array<std::array<double, 4>, 3>> &knots);
+
+			int dim() const { return int(splines_.size()); }
+			int n_bases() const { return dim() == 3 ? 27 : 9; }
+
+			/// same layout as ElementBases::evaluate_bases
+			void evaluate_bases(const Eigen::MatrixXd &uv, std::vector<assembler::AssemblyValues> &basis_values) const;
+			/// same layout as ElementBases::evaluate_grads
+			void evaluate_grads(const Eigen::MatrixXd &uv, std::vector<assembler::AssemblyValues> &basis_values) const;
+
+			/// ts.size() x 3 values and derivatives of the 1D splines of direction d
+			void tables_1d(const int d, const Eigen::VectorXd &ts, Eigen::MatrixXd &val, Eigen::MatrixXd &grad) const;
+
+		private:
+			std::vector<std::array<QuadraticBSpline, 3>> splines_;
+		};
+	} // namespace basis
+} // namespace polyfem
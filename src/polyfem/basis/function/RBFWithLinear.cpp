@@ -11,6 +11,7 @@
 #include <iostream>
 #include <fstream>
 #include <array>
+#include <cmath>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -55,6 +56,23 @@ namespace
 		}
 	}
 
+	// Appends m to the key, rounded to 34 bits relative to its largest entry
+	void append_quantized(const Eigen::MatrixXd &m, std::vector<int64_t> &key)
+	{
+		key.push_back(m.rows());
+		key.push_back(m.cols());
+
+		int exponent = 0;
+		const double max_abs = m.size() > 0 ? m.cwiseAbs().maxCoeff() : 0;
+		if (max_abs > 0)
+			std::frexp(max_abs, &exponent);
+		key.push_back(exponent);
+
+		for (int j = 0; j < m.cols(); ++j)
+			for (int i = 0; i < m.rows(); ++i)
+				key.push_back(std::llround(std::ldexp(m(i, j), 34 - exponent)));
+	}
+
 } // anonymous namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -73,6 +91,30 @@ RBFWithLinear::RBFWithLinear(
 
 // -----------------------------------------------------------------------------
 
+std::vector<int64_t> RBFWithLinear::translation_signature(
+	const Eigen::MatrixXd &centers,
+	const Eigen::MatrixXd &samples,
+	const Eigen::MatrixXd &local_basis_integral,
+	const Quadrature &quadr,
+	const Eigen::MatrixXd &rhs)
+{
+	const Eigen::RowVectorXd origin = samples.row(0);
+	// only the linear part of the integrals enters the constraints, see compute_constraints_matrix
+	const int dim = centers.cols();
+
+	std::vector<int64_t> key;
+	append_quantized(centers.rowwise() - origin, key);
+	append_quantized(samples.rowwise() - origin, key);
+	append_quantized(quadr.points.rowwise() - origin, key);
+	append_quantized(quadr.weights, key);
+	append_quantized(local_basis_integral.leftCols(std::min<int>(dim, local_basis_integral.cols())), key);
+	append_quantized(rhs, key);
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+
 void RBFWithLinear::basis(const int local_index, const Eigen::MatrixXd &samples, Eigen::MatrixXd &val) const
 {
 	Eigen::MatrixXd tmp;
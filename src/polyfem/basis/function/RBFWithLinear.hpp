@@ -3,6 +3,9 @@
 #include <polyfem/quadrature/Quadrature.hpp>
 #include <Eigen/Dense>
 
+#include <cstdint>
+#include <vector>
+
 namespace polyfem
 {
 	namespace basis
@@ -59,6 +62,18 @@ namespace polyfem
 			///
 			void bases_grads(const int axis, const Eigen::MatrixXd &samples, Eigen::MatrixXd &val) const;
 
+			///
+			/// @brief      Quantized inputs of the solve relative to the first collocation point. Two polytopes
+			///             with the same signature have the same bases up to a translation (up to ~1e-10 relative error)
+			///
+			/// @param[in]  centers, collocation_points, local_basis_integral, quadr, rhs  same as the constructor
+			///
+			/// @return     signature of the polytope
+			///
+			static std::vector<int64_t> translation_signature(const Eigen::MatrixXd &centers, const Eigen::MatrixXd &collocation_points,
+															  const Eigen::MatrixXd &local_basis_integral, const quadrature::Quadrature &quadr,
+															  const Eigen::MatrixXd &rhs);
+
 		private:
 			bool is_volume() const { return centers_.cols() == 3; }
 
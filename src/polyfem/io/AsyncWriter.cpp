@@ -0,0 +1,128 @@
+#include "AsyncWriter.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+namespace polyfem::io
+{
+	AsyncWriter::~AsyncWriter()
+	{
+		try
+		{
+			stop();
+		}
+		catch (const std::exception &e)
+		{
+			logger().error("Failed to write output: {}", e.what());
+		}
+	}
+
+	void AsyncWriter::start(const int max_jobs, const size_t max_bytes)
+	{
+		stop();
+
+		if (max_jobs <= 0)
+			return;
+
+		max_jobs_ = max_jobs;
+		max_bytes_ = max_bytes;
+		stop_ = false;
+		worker_ = std::thread(&AsyncWriter::run, this);
+	}
+
+	void AsyncWriter::push(std::function<void()> job, const size_t bytes)
+	{
+		if (!is_async())
+		{
+			job();
+			return;
+		}
+
+		rethrow_error();
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cv_.wait(lock, [&]() {
+				const int n_jobs = jobs_.size() + (running_ ? 1 : 0);
+				return n_jobs == 0 || (n_jobs < max_jobs_ && queued_bytes_ + bytes <= max_bytes_);
+			});
+
+			jobs_.emplace_back(std::move(job), bytes);
+			queued_bytes_ += bytes;
+		}
+		cv_.notify_all();
+	}
+
+	void AsyncWriter::flush()
+	{
+		if (is_async())
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cv_.wait(lock, [&]() { return jobs_.empty() && !running_; });
+		}
+
+		rethrow_error();
+	}
+
+	void AsyncWriter::run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true)
+		{
+			cv_.wait(lock, [&]() { return stop_ || !jobs_.empty(); });
+			// the remaining jobs are run before stopping
+			if (jobs_.empty())
+				return;
+
+			std::function<void()> job = std::move(jobs_.front().first);
+			const size_t bytes = jobs_.front().second;
+			jobs_.pop_front();
+			running_ = true;
+			lock.unlock();
+
+			std::exception_ptr error;
+			try
+			{
+				job();
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+			job = nullptr; // release the data before updating the budget
+
+			lock.lock();
+			if (error && !error_)
+				error_ = error;
+			queued_bytes_ -= bytes;
+			running_ = false;
+			cv_.notify_all();
+		}
+	}
+
+	void AsyncWriter::stop()
+	{
+		if (worker_.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stop_ = true;
+			}
+			cv_.notify_all();
+			worker_.join();
+		}
+
+		rethrow_error();
+	}
+
+	void AsyncWriter::rethrow_error()
+	{
+		std::exception_ptr error;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::swap(error, error_);
+		}
+
+		if (error)
+			std::rethrow_exception(error);
+	}
+} // namespace polyfem::io
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace polyfem::io
+{
+	/// Runs output jobs (e.g., writing the files of a time step) on a background thread, in submission order.
+	/// The queue is bounded by a number of jobs and by the memory they hold, push() blocks until there is room.
+	/// Without the background thread (the default) the jobs run immediately in push().
+	class AsyncWriter
+	{
+	public:
+		AsyncWriter() {}
+		/// waits for the queued jobs, errors are logged
+		~AsyncWriter();
+
+		AsyncWriter(const AsyncWriter &) = delete;
+		AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+		/// @brief Start the background thread, the pending jobs are flushed first.
+		/// @param max_jobs maximum number of jobs held by the writer, including the one being run. If <= 0 the jobs run synchronously.
+		/// @param max_bytes memory budget of the queued jobs, a job larger than the budget waits for the queue to be empty
+		void start(const int max_jobs, const size_t max_bytes);
+
+		/// @brief If the jobs are run on the background thread
+		bool is_async() const { return worker_.joinable(); }
+
+		/// @brief Queue a job, blocks while the queue is full. Rethrows the error of a previous job, if any.
+		/// @param job job to run, it must own all the data it uses
+		/// @param bytes memory held by the job, released once it is done
+		void push(std::function<void()> job, const size_t bytes = 0);
+
+		/// @brief Wait for all the queued jobs, rethrows the first error of a job.
+		void flush();
+
+	private:
+		void run();
+		void stop();
+		void rethrow_error();
+
+		std::thread worker_;
+		std::mutex mutex_;
+		std::condition_variable cv_;
+
+		std::deque<std::pair<std::function<void()>, size_t>> jobs_;
+		size_t queued_bytes_ = 0;
+		bool running_ = false; ///< a job is being run
+		bool stop_ = false;
+		std::exception_ptr error_;
+
+		int max_jobs_ = 0;
+		size_t max_bytes_ = 0;
+	};
+} // namespace polyfem::io
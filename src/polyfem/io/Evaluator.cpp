@@ -14,6 +14,7 @@
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/AABB.h>
 #include <igl/per_face_normals.h>
@@ -26,6 +27,135 @@ namespace polyfem::io
 
 	namespace
 	{
+		/// local points where interpolate_function samples the element i, false if the element is skipped
+		bool interpolation_points(
+			const mesh::Mesh &mesh,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const int i,
+			const bool use_sampler,
+			const bool boundary_only,
+			Eigen::MatrixXd &local_pts)
+		{
+			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
+				return false;
+
+			if (use_sampler)
+			{
+				Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
+				if (mesh.is_simplex(i))
+					local_pts = sampler.simplex_points();
+				else if (mesh.is_cube(i))
+					local_pts = sampler.cube_points();
+				else
+				{
+					if (mesh.is_volume())
+						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
+					else
+						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
+				}
+			}
+			else
+			{
+				if (mesh.is_volume())
+				{
+					if (mesh.is_simplex(i))
+						autogen::p_nodes_3d(disc_orders(i), local_pts);
+					else if (mesh.is_cube(i))
+						autogen::q_nodes_3d(disc_orders(i), local_pts);
+					else
+						return false;
+				}
+				else
+				{
+					if (mesh.is_simplex(i))
+						autogen::p_nodes_2d(disc_orders(i), local_pts);
+					else if (mesh.is_cube(i))
+						autogen::q_nodes_2d(disc_orders(i), local_pts);
+					else
+						return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// sampling points of all the elements and their offsets in the output, so that elements can be evaluated in parallel
+		class ElementPoints
+		{
+		public:
+			ElementPoints(
+				const mesh::Mesh &mesh,
+				const Eigen::VectorXi &disc_orders,
+				const std::map<int, Eigen::MatrixXd> &polys,
+				const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+				const utils::RefElementSampler &sampler,
+				const int n_elements,
+				const bool use_sampler,
+				const bool boundary_only)
+				: mesh_(mesh), disc_orders_(disc_orders), polys_(polys), polys_3d_(polys_3d), sampler_(sampler),
+				  use_sampler_(use_sampler), boundary_only_(boundary_only)
+			{
+				offsets_.resize(n_elements);
+
+				Eigen::MatrixXd local_pts;
+				for (int i = 0; i < n_elements; ++i)
+				{
+					if (!interpolation_points(mesh, disc_orders, polys, polys_3d, sampler, i, use_sampler, boundary_only, local_pts))
+					{
+						offsets_[i] = -1;
+						continue;
+					}
+
+					offsets_[i] = n_points_;
+					n_points_ += local_pts.rows();
+
+					// the polygon sampling is not thread safe (triangle), it is done here once
+					if (use_sampler && !mesh.is_simplex(i) && !mesh.is_cube(i))
+						poly_points_[i] = local_pts;
+				}
+			}
+
+			/// total number of points
+			int n_points() const { return n_points_; }
+			/// first output row of element i, -1 if the element is skipped
+			int offset(const int i) const { return offsets_[i]; }
+			/// first valid element, -1 if none
+			int first() const
+			{
+				for (int i = 0; i < offsets_.size(); ++i)
+					if (offsets_[i] >= 0)
+						return i;
+				return -1;
+			}
+
+			/// points of a valid element i
+			void local_points(const int i, Eigen::MatrixXd &local_pts) const
+			{
+				assert(offsets_[i] >= 0);
+				const auto it = poly_points_.find(i);
+				if (it != poly_points_.end())
+					local_pts = it->second;
+				else
+					interpolation_points(mesh_, disc_orders_, polys_, polys_3d_, sampler_, i, use_sampler_, boundary_only_, local_pts);
+			}
+
+		private:
+			const mesh::Mesh &mesh_;
+			const Eigen::VectorXi &disc_orders_;
+			const std::map<int, Eigen::MatrixXd> &polys_;
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d_;
+			const utils::RefElementSampler &sampler_;
+			const bool use_sampler_;
+			const bool boundary_only_;
+
+			std::vector<int> offsets_;
+			int n_points_ = 0;
+			std::map<int, Eigen::MatrixXd> poly_points_;
+		};
+
 		void flattened_tensor_coeffs(const Eigen::MatrixXd &S, Eigen::MatrixXd &X)
 		{
 			if (S.cols() == 4)
@@ -185,73 +315,56 @@ namespace polyfem::io
 		assert(!is_problem_scalar);
 		const int actual_dim = mesh.dimension();
 
-		std::vector<Eigen::MatrixXd> avg_scalar;
-
-		Eigen::MatrixXd areas(n_bases, 1);
-		areas.setZero();
-
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
-		Eigen::MatrixXd local_val;
-
-		ElementAssemblyValues vals;
-		for (int i = 0; i < int(bases.size()); ++i)
+		struct LocalThreadStorage
 		{
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
-			Eigen::MatrixXd local_pts;
+			std::vector<std::string> names;
+			std::vector<Eigen::VectorXd> avg_scalar;
+			Eigen::VectorXd areas;
 
-			if (mesh.is_simplex(i))
-			{
-				if (mesh.dimension() == 3)
-					autogen::p_nodes_3d(disc_orders(i), local_pts);
-				else
-					autogen::p_nodes_2d(disc_orders(i), local_pts);
-			}
-			else if (mesh.is_cube(i))
-			{
-				if (mesh.dimension() == 3)
-					autogen::q_nodes_3d(disc_orders(i), local_pts);
-				else
-					autogen::q_nodes_2d(disc_orders(i), local_pts);
-			}
-			else
-			{
-				// not supported for polys
-				continue;
-			}
-
-			vals.compute(i, actual_dim == 3, bases[i], gbases[i]);
-			const quadrature::Quadrature &quadrature = vals.quadrature;
-			const double area = (vals.det.array() * quadrature.weights.array()).sum();
+			LocalThreadStorage(const int n_bases) { areas.setZero(n_bases); }
+		};
 
-			assembler.compute_scalar_value(OutputData(t, i, bs, gbs, local_pts, fun), tmp_s);
+		auto storage = utils::create_thread_storage(LocalThreadStorage(n_bases));
 
-			// assembler.compute_tensor_value(i, bs, gbs, local_pts, fun, local_val);
-			// MatrixXd avg_tensor(n_points * actual_dim*actual_dim, 1);
+		utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
+			ElementAssemblyValues vals;
 
-			for (size_t j = 0; j < bs.bases.size(); ++j)
+			for (int i = start; i < end; ++i)
 			{
-				const Basis &b = bs.bases[j];
-				if (b.global().size() > 1)
-					continue;
-
-				auto &global = b.global().front();
-				areas(global.index) += area;
-			}
+				const ElementBases &bs = bases[i];
+				const ElementBases &gbs = gbases[i];
+				Eigen::MatrixXd local_pts;
 
-			if (avg_scalar.empty())
-			{
-				avg_scalar.resize(tmp_s.size());
-				for (auto &m : avg_scalar)
+				if (mesh.is_simplex(i))
 				{
-					m.resize(n_bases, 1);
-					m.setZero();
+					if (mesh.dimension() == 3)
+						autogen::p_nodes_3d(disc_orders(i), local_pts);
+					else
+						autogen::p_nodes_2d(disc_orders(i), local_pts);
+				}
+				else if (mesh.is_cube(i))
+				{
+					if (mesh.dimension() == 3)
+						autogen::q_nodes_3d(disc_orders(i), local_pts);
+					else
+						autogen::q_nodes_2d(disc_orders(i), local_pts);
+				}
+				else
+				{
+					// not supported for polys
+					continue;
 				}
-			}
 
-			for (int k = 0; k < tmp_s.size(); ++k)
-			{
-				local_val = tmp_s[k].second;
+				vals.compute(i, actual_dim == 3, bases[i], gbases[i]);
+				const quadrature::Quadrature &quadrature = vals.quadrature;
+				const double area = (vals.det.array() * quadrature.weights.array()).sum();
+
+				assembler.compute_scalar_value(OutputData(t, i, bs, gbs, local_pts, fun), tmp_s);
+
+				// assembler.compute_tensor_value(i, bs, gbs, local_pts, fun, local_val);
+				// MatrixXd avg_tensor(n_points * actual_dim*actual_dim, 1);
 
 				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
@@ -260,9 +373,53 @@ namespace polyfem::io
 						continue;
 
 					auto &global = b.global().front();
-					avg_scalar[k](global.index) += local_val(j) * area;
+					local_storage.areas(global.index) += area;
+				}
+
+				if (local_storage.avg_scalar.empty())
+				{
+					local_storage.avg_scalar.resize(tmp_s.size());
+					for (int k = 0; k < tmp_s.size(); ++k)
+					{
+						local_storage.names.push_back(tmp_s[k].first);
+						local_storage.avg_scalar[k].setZero(n_bases);
+					}
+				}
+
+				for (int k = 0; k < tmp_s.size(); ++k)
+				{
+					const Eigen::MatrixXd &local_val = tmp_s[k].second;
+
+					for (size_t j = 0; j < bs.bases.size(); ++j)
+					{
+						const Basis &b = bs.bases[j];
+						if (b.global().size() > 1)
+							continue;
+
+						auto &global = b.global().front();
+						local_storage.avg_scalar[k](global.index) += local_val(j) * area;
+					}
 				}
 			}
+		});
+
+		// reduction of the thread contributions
+		std::vector<std::string> names;
+		std::vector<Eigen::MatrixXd> avg_scalar;
+		Eigen::VectorXd areas = Eigen::VectorXd::Zero(n_bases);
+		for (const LocalThreadStorage &local_storage : storage)
+		{
+			areas += local_storage.areas;
+			if (local_storage.avg_scalar.empty())
+				continue;
+
+			if (avg_scalar.empty())
+			{
+				names = local_storage.names;
+				avg_scalar.assign(local_storage.avg_scalar.size(), Eigen::MatrixXd::Zero(n_bases, 1));
+			}
+			for (int k = 0; k < avg_scalar.size(); ++k)
+				avg_scalar[k] += local_storage.avg_scalar[k];
 		}
 
 		for (auto &m : avg_scalar)
@@ -270,10 +427,10 @@ namespace polyfem::io
 			m.array() /= areas.array();
 		}
 
-		result_scalar.resize(tmp_s.size());
-		for (int k = 0; k < tmp_s.size(); ++k)
+		result_scalar.resize(names.size());
+		for (int k = 0; k < names.size(); ++k)
 		{
-			result_scalar[k].first = tmp_s[k].first;
+			result_scalar[k].first = names[k];
 			interpolate_function(mesh, 1, bases, disc_orders, polys, polys_3d, sampler, n_points,
 								 avg_scalar[k], result_scalar[k].second, use_sampler, boundary_only);
 		}
@@ -419,74 +576,92 @@ namespace polyfem::io
 			return;
 		}
 
-		std::vector<AssemblyValues> tmp;
+		const ElementPoints points(mesh, disc_orders, polys, polys_3d, sampler, basis.size(), use_sampler, boundary_only);
+		assert(points.n_points() <= n_points);
 
 		result.resize(n_points, actual_dim);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
-
-		for (int i = 0; i < int(basis.size()); ++i)
-		{
-			const ElementBases &bs = basis[i];
+		utils::maybe_parallel_for(basis.size(), [&](int start, int end, int thread_id) {
+			std::vector<AssemblyValues> tmp;
 			Eigen::MatrixXd local_pts;
 
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
-
-			if (use_sampler)
+			for (int i = start; i < end; ++i)
 			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
-			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
+				if (points.offset(i) < 0)
+					continue;
+
+				const ElementBases &bs = basis[i];
+				points.local_points(i, local_pts);
+
+				Eigen::MatrixXd local_res = Eigen::MatrixXd::Zero(local_pts.rows(), actual_dim);
+				bs.evaluate_bases(local_pts, tmp);
+				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
+					const Basis &b = bs.bases[j];
+
+					for (int d = 0; d < actual_dim; ++d)
+					{
+						for (size_t ii = 0; ii < b.global().size(); ++ii)
+							local_res.col(d) += b.global()[ii].val * tmp[j].val * fun(b.global()[ii].index * actual_dim + d);
+					}
 				}
+
+				result.block(points.offset(i), 0, local_res.rows(), actual_dim) = local_res;
 			}
+		});
+	}
 
-			Eigen::MatrixXd local_res = Eigen::MatrixXd::Zero(local_pts.rows(), actual_dim);
-			bs.evaluate_bases(local_pts, tmp);
-			for (size_t j = 0; j < bs.bases.size(); ++j)
+	void Evaluator::interpolation_operator(
+		const mesh::Mesh &mesh,
+		const std::vector<basis::ElementBases> &bases,
+		const Eigen::VectorXi &disc_orders,
+		const std::map<int, Eigen::MatrixXd> &polys,
+		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+		const utils::RefElementSampler &sampler,
+		const int n_points,
+		const int n_bases,
+		const bool use_sampler,
+		const bool boundary_only,
+		StiffnessMatrix &interpolation)
+	{
+		const ElementPoints points(mesh, disc_orders, polys, polys_3d, sampler, bases.size(), use_sampler, boundary_only);
+		assert(points.n_points() == n_points);
+
+		auto storage = utils::create_thread_storage(std::vector<Eigen::Triplet<double>>());
+
+		utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+			std::vector<Eigen::Triplet<double>> &entries = utils::get_local_thread_storage(storage, thread_id);
+			std::vector<AssemblyValues> tmp;
+			Eigen::MatrixXd local_pts;
+
+			for (int i = start; i < end; ++i)
 			{
-				const Basis &b = bs.bases[j];
+				const int index = points.offset(i);
+				if (index < 0)
+					continue;
 
-				for (int d = 0; d < actual_dim; ++d)
+				const ElementBases &bs = bases[i];
+				points.local_points(i, local_pts);
+
+				bs.evaluate_bases(local_pts, tmp);
+				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
-					for (size_t ii = 0; ii < b.global().size(); ++ii)
-						local_res.col(d) += b.global()[ii].val * tmp[j].val * fun(b.global()[ii].index * actual_dim + d);
+					for (const Local2Global &g : bs.bases[j].global())
+					{
+						for (int p = 0; p < local_pts.rows(); ++p)
+							entries.emplace_back(index + p, g.index, g.val * tmp[j].val(p));
+					}
 				}
 			}
+		});
 
-			result.block(index, 0, local_res.rows(), actual_dim) = local_res;
-			index += local_res.rows();
-		}
+		std::vector<Eigen::Triplet<double>> entries;
+		for (const auto &local_entries : storage)
+			entries.insert(entries.end(), local_entries.begin(), local_entries.end());
+
+		interpolation.resize(n_points, n_bases);
+		interpolation.setFromTriplets(entries.begin(), entries.end());
+		interpolation.makeCompressed();
 	}
 
 	void Evaluator::interpolate_at_local_vals(
@@ -698,75 +873,48 @@ namespace polyfem::io
 
 		assert(!is_problem_scalar);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
+		const ElementPoints points(mesh, disc_orders, polys, polys_3d, sampler, bases.size(), use_sampler, boundary_only);
+		assert(points.n_points() <= n_points);
+		const int first = points.first();
+		if (first < 0)
+			return;
 
-		for (int i = 0; i < int(bases.size()); ++i)
 		{
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
-
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
+			// the names of the values, all elements have the same
 			Eigen::MatrixXd local_pts;
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
+			points.local_points(first, local_pts);
+			assembler.compute_scalar_value(OutputData(t, first, bases[first], gbases[first], local_pts, fun), tmp_s);
 
-			if (use_sampler)
+			result.resize(tmp_s.size());
+			for (int k = 0; k < tmp_s.size(); ++k)
 			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
-			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
+				result[k].first = tmp_s[k].first;
+				result[k].second.resize(n_points, 1);
 			}
+		}
 
-			assembler.compute_scalar_value(OutputData(t, i, bs, gbs, local_pts, fun), tmp_s);
+		// every element writes its own rows
+		utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd local_pts;
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
 
-			if (result.empty())
+			for (int i = start; i < end; ++i)
 			{
-				result.resize(tmp_s.size());
+				if (points.offset(i) < 0)
+					continue;
+
+				points.local_points(i, local_pts);
+				assembler.compute_scalar_value(OutputData(t, i, bases[i], gbases[i], local_pts, fun), tmp_s);
+
+				assert(tmp_s.size() == result.size());
 				for (int k = 0; k < tmp_s.size(); ++k)
 				{
-					result[k].first = tmp_s[k].first;
-					result[k].second.resize(n_points, 1);
+					assert(local_pts.rows() == tmp_s[k].second.rows());
+					result[k].second.block(points.offset(i), 0, tmp_s[k].second.rows(), 1) = tmp_s[k].second;
 				}
 			}
-
-			for (int k = 0; k < tmp_s.size(); ++k)
-			{
-				assert(local_pts.rows() == tmp_s[k].second.rows());
-				result[k].second.block(index, 0, tmp_s[k].second.rows(), 1) = tmp_s[k].second;
-			}
-			index += local_pts.rows();
-		}
+		});
 	}
 
 	void Evaluator::compute_tensor_value(
@@ -797,75 +945,48 @@ namespace polyfem::io
 		const int actual_dim = mesh.dimension();
 		assert(!is_problem_scalar);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_t;
+		const ElementPoints points(mesh, disc_orders, polys, polys_3d, sampler, bases.size(), use_sampler, boundary_only);
+		assert(points.n_points() <= n_points);
+		const int first = points.first();
+		if (first < 0)
+			return;
 
-		for (int i = 0; i < int(bases.size()); ++i)
 		{
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
-
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
+			// the names of the values, all elements have the same
 			Eigen::MatrixXd local_pts;
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_t;
+			points.local_points(first, local_pts);
+			assembler.compute_tensor_value(OutputData(t, first, bases[first], gbases[first], local_pts, fun), tmp_t);
 
-			if (use_sampler)
-			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
+			result.resize(tmp_t.size());
+			for (int k = 0; k < tmp_t.size(); ++k)
 			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
+				result[k].first = tmp_t[k].first;
+				result[k].second.resize(n_points, actual_dim * actual_dim);
 			}
+		}
 
-			assembler.compute_tensor_value(OutputData(t, i, bs, gbs, local_pts, fun), tmp_t);
+		// every element writes its own rows
+		utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd local_pts;
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_t;
 
-			if (result.empty())
+			for (int i = start; i < end; ++i)
 			{
-				result.resize(tmp_t.size());
+				if (points.offset(i) < 0)
+					continue;
+
+				points.local_points(i, local_pts);
+				assembler.compute_tensor_value(OutputData(t, i, bases[i], gbases[i], local_pts, fun), tmp_t);
+
+				assert(tmp_t.size() == result.size());
 				for (int k = 0; k < tmp_t.size(); ++k)
 				{
-					result[k].first = tmp_t[k].first;
-					result[k].second.resize(n_points, actual_dim * actual_dim);
+					assert(local_pts.rows() == tmp_t[k].second.rows());
+					result[k].second.block(points.offset(i), 0, tmp_t[k].second.rows(), tmp_t[k].second.cols()) = tmp_t[k].second;
 				}
 			}
-
-			for (int k = 0; k < tmp_t.size(); ++k)
-			{
-				assert(local_pts.rows() == tmp_t[k].second.rows());
-				result[k].second.block(index, 0, tmp_t[k].second.rows(), tmp_t[k].second.cols()) = tmp_t[k].second;
-			}
-			index += local_pts.rows();
-		}
+		});
 	}
 
 	Eigen::MatrixXd Evaluator::get_bases_position(
@@ -892,16 +1013,17 @@ namespace polyfem::io
 	Eigen::VectorXd Evaluator::integrate_function(
 		const std::vector<basis::ElementBases> &bases,
 		const std::vector<basis::ElementBases> &gbases,
+		const assembler::AssemblyValsCache &cache,
 		const Eigen::MatrixXd &fun,
 		const int dim,
 		const int actual_dim)
 	{
 		Eigen::VectorXd result;
 		result.setZero(actual_dim);
+		ElementAssemblyValues tmp_vals;
 		for (int e = 0; e < bases.size(); ++e)
 		{
-			ElementAssemblyValues vals;
-			vals.compute(e, dim == 3, bases[e], gbases[e]);
+			const ElementAssemblyValues &vals = cache.get(e, dim == 3, bases[e], gbases[e], tmp_vals);
 
 			Eigen::MatrixXd u, grad_u;
 			io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, fun, u, grad_u);
@@ -93,6 +93,32 @@ namespace polyfem::io
 			const bool use_sampler,
 			const bool boundary_only);
 
+		/// builds the sparse operator applied by interpolate_function, result = interpolation * unflatten(fun, actual_dim)
+		/// the sample points only depend on the discretization so the operator can be reused for every function
+		/// @param[in] mesh mesh
+		/// @param[in] bases bases
+		/// @param[in] disc_orders discretization orders
+		/// @param[in] polys polygons
+		/// @param[in] polys_3d polyhedra
+		/// @param[in] sampler sampler for the local element
+		/// @param[in] n_points number of sample points (rows)
+		/// @param[in] n_bases number of nodes (columns)
+		/// @param[in] use_sampler uses the sampler or not
+		/// @param[in] boundary_only interpolates only at boundary elements
+		/// @param[out] interpolation interpolation operator
+		static void interpolation_operator(
+			const mesh::Mesh &mesh,
+			const std::vector<basis::ElementBases> &bases,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const int n_points,
+			const int n_bases,
+			const bool use_sampler,
+			const bool boundary_only,
+			StiffnessMatrix &interpolation);
+
 		/// interpolate solution and gradient at element (calls interpolate_at_local_vals with sol)
 		/// @param[in] mesh mesh
 		/// @param[in] is_problem_scalar if problem is scalar
@@ -305,9 +331,12 @@ namespace polyfem::io
 			const int n_bases,
 			const std::shared_ptr<mesh::MeshNodes> mesh_nodes);
 
+		/// integrates fun over the domain, cache is used for the basis evaluation
+		/// and geometric mapping (computed per element if not initialized)
 		static Eigen::VectorXd integrate_function(
 			const std::vector<basis::ElementBases> &bases,
 			const std::vector<basis::ElementBases> &gbases,
+			const assembler::AssemblyValsCache &cache,
 			const Eigen::MatrixXd &fun,
 			const int dim,
 			const int actual_dim);
@@ -0,0 +1,215 @@
+#include "HDF5TimeSeriesWriter.hpp"
+
+#include <polyfem/io/MatrixIO.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <h5pp/h5pp.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace polyfem::io
+{
+	namespace
+	{
+		const std::string xdmf_footer = "    </Grid>\n  </Domain>\n</Xdmf>\n";
+
+		std::string attribute_type(const int n_components)
+		{
+			switch (n_components)
+			{
+			case 1:
+				return "Scalar";
+			case 3:
+				return "Vector";
+			case 6:
+				return "Tensor6";
+			case 9:
+				return "Tensor";
+			default:
+				return "Matrix";
+			}
+		}
+
+		std::string dataset_name(std::string name)
+		{
+			std::replace(name.begin(), name.end(), '/', '_');
+			return name;
+		}
+	} // namespace
+
+	HDF5TimeSeriesWriter::HDF5TimeSeriesWriter(const std::string &path, const int compression_level, const std::map<std::string, FieldFormat> &formats)
+		: path_(path), compression_level_(compression_level), formats_(formats)
+	{
+		xdmf_path_ = std::filesystem::path(path).replace_extension(".xdmf").string();
+	}
+
+	HDF5TimeSeriesWriter::Precision HDF5TimeSeriesWriter::precision_from_string(const std::string &name)
+	{
+		if (name == "f64")
+			return Precision::F64;
+		if (name == "f32")
+			return Precision::F32;
+		if (name == "u16")
+			return Precision::QUANTIZED;
+		log_and_throw_error("Unknown output precision {}", name);
+	}
+
+	std::string HDF5TimeSeriesWriter::topology_type(const int dim, const int cell_size)
+	{
+		if (dim == 2 && cell_size == 3)
+			return "Triangle";
+		if (dim == 2 && cell_size == 4)
+			return "Quadrilateral";
+		if (dim == 3 && cell_size == 4)
+			return "Tetrahedron";
+		if (dim == 3 && cell_size == 8)
+			return "Hexahedron";
+		return "";
+	}
+
+	void HDF5TimeSeriesWriter::write_step(
+		const double t,
+		const Eigen::MatrixXd &points,
+		const Eigen::MatrixXi &cells,
+		const std::vector<std::pair<std::string, Eigen::MatrixXd>> &fields)
+	{
+		if (topology_type(points.cols(), cells.cols()).empty())
+			log_and_throw_error("Time series output does not support {}D cells with {} vertices", points.cols(), cells.cols());
+
+		std::lock_guard<std::mutex> lock(hdf5_mutex());
+		h5pp::File file(path_, n_steps_ == 0 ? h5pp::FileAccess::REPLACE : h5pp::FileAccess::READWRITE);
+		file.setCompressionLevel(compression_level_);
+
+		const bool new_mesh = n_meshes_ == 0
+							  || points.rows() != mesh_points_.rows() || points.cols() != mesh_points_.cols() || points != mesh_points_
+							  || cells.rows() != mesh_cells_.rows() || cells.cols() != mesh_cells_.cols() || cells != mesh_cells_;
+		if (new_mesh)
+		{
+			file.writeDataset(points, fmt::format("mesh_{:d}/points", n_meshes_), H5D_CHUNKED);
+			file.writeDataset(cells, fmt::format("mesh_{:d}/cells", n_meshes_), H5D_CHUNKED);
+			mesh_points_ = points;
+			mesh_cells_ = cells;
+			++n_meshes_;
+		}
+
+		std::vector<FieldDataset> datasets;
+		for (const auto &[name, data] : fields)
+		{
+			assert(data.rows() == points.rows());
+			datasets.push_back(write_field(file, name, data));
+		}
+
+		append_xdmf(t, points, cells, datasets);
+		++n_steps_;
+	}
+
+	HDF5TimeSeriesWriter::FieldDataset HDF5TimeSeriesWriter::write_field(h5pp::File &file, const std::string &name, const Eigen::MatrixXd &data) const
+	{
+		const auto it = formats_.find(name);
+		const FieldFormat format = it == formats_.end() ? FieldFormat() : it->second;
+
+		FieldDataset dataset;
+		dataset.name = name;
+		dataset.rows = data.rows();
+		dataset.cols = data.cols();
+		dataset.precision = format.precision;
+
+		const std::string path = fmt::format("step_{:d}/{}", n_steps_, dataset_name(name));
+		switch (format.precision)
+		{
+		case Precision::F64:
+			file.writeDataset(data, path, H5D_CHUNKED);
+			break;
+		case Precision::F32:
+			file.writeDataset(Eigen::MatrixXf(data.cast<float>()), path, H5D_CHUNKED);
+			break;
+		case Precision::QUANTIZED:
+		{
+			constexpr double levels = std::numeric_limits<uint16_t>::max();
+			double min = format.min, max = format.max;
+			if (min >= max && data.size() > 0)
+			{
+				min = data.minCoeff();
+				max = data.maxCoeff();
+			}
+			dataset.offset = min;
+			dataset.scale = max > min ? (max - min) / levels : 0;
+
+			Eigen::Matrix<uint16_t, Eigen::Dynamic, Eigen::Dynamic> quantized = Eigen::Matrix<uint16_t, Eigen::Dynamic, Eigen::Dynamic>::Zero(data.rows(), data.cols());
+			if (dataset.scale > 0)
+				quantized = ((data.array() - min) / dataset.scale).round().max(0).min(levels).cast<uint16_t>().matrix();
+			file.writeDataset(quantized, path, H5D_CHUNKED);
+			// for the readers not using the xdmf
+			file.writeDataset(Eigen::Vector2d(dataset.scale, dataset.offset), path + "_scale_offset");
+			break;
+		}
+		}
+
+		return dataset;
+	}
+
+	void HDF5TimeSeriesWriter::append_xdmf(
+		const double t,
+		const Eigen::MatrixXd &points,
+		const Eigen::MatrixXi &cells,
+		const std::vector<FieldDataset> &fields)
+	{
+		const std::string h5_name = std::filesystem::path(path_).filename().string();
+		const int mesh_id = n_meshes_ - 1;
+
+		std::fstream xdmf;
+		if (n_steps_ == 0)
+		{
+			xdmf.open(xdmf_path_, std::ios::out | std::ios::trunc);
+			xdmf << "<?xml version=\"1.0\" ?>\n"
+				 << "<Xdmf Version=\"3.0\">\n"
+				 << "  <Domain>\n"
+				 << "    <Grid Name=\"TimeSeries\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+		}
+		else
+		{
+			// overwrite the closing tags
+			xdmf.open(xdmf_path_, std::ios::in | std::ios::out);
+			xdmf.seekp(xdmf_end_);
+		}
+
+		if (!xdmf.is_open())
+			log_and_throw_error("Unable to open {}", xdmf_path_);
+
+		xdmf << fmt::format("      <Grid Name=\"step_{:d}\" GridType=\"Uniform\">\n", n_steps_)
+			 << fmt::format("        <Time Value=\"{:.17g}\" />\n", t)
+			 << fmt::format("        <Topology TopologyType=\"{}\" NumberOfElements=\"{:d}\">\n", topology_type(points.cols(), cells.cols()), cells.rows())
+			 << fmt::format("          <DataItem Dimensions=\"{:d} {:d}\" NumberType=\"Int\" Precision=\"4\" Format=\"HDF\">{}:/mesh_{:d}/cells</DataItem>\n", cells.rows(), cells.cols(), h5_name, mesh_id)
+			 << "        </Topology>\n"
+			 << fmt::format("        <Geometry GeometryType=\"{}\">\n", points.cols() == 3 ? "XYZ" : "XY")
+			 << fmt::format("          <DataItem Dimensions=\"{:d} {:d}\" NumberType=\"Float\" Precision=\"8\" Format=\"HDF\">{}:/mesh_{:d}/points</DataItem>\n", points.rows(), points.cols(), h5_name, mesh_id)
+			 << "        </Geometry>\n";
+
+		for (const FieldDataset &field : fields)
+		{
+			const std::string location = fmt::format("{}:/step_{:d}/{}", h5_name, n_steps_, dataset_name(field.name));
+			xdmf << fmt::format("        <Attribute Name=\"{}\" AttributeType=\"{}\" Center=\"Node\">\n", field.name, attribute_type(field.cols));
+			switch (field.precision)
+			{
+			case Precision::F64:
+			case Precision::F32:
+				xdmf << fmt::format("          <DataItem Dimensions=\"{:d} {:d}\" NumberType=\"Float\" Precision=\"{:d}\" Format=\"HDF\">{}</DataItem>\n", field.rows, field.cols, field.precision == Precision::F64 ? 8 : 4, location);
+				break;
+			case Precision::QUANTIZED:
+				xdmf << fmt::format("          <DataItem ItemType=\"Function\" Function=\"$0 * {:.17g} + {:.17g}\" Dimensions=\"{:d} {:d}\">\n", field.scale, field.offset, field.rows, field.cols)
+					 << fmt::format("            <DataItem Dimensions=\"{:d} {:d}\" NumberType=\"UInt\" Precision=\"2\" Format=\"HDF\">{}</DataItem>\n", field.rows, field.cols, location)
+					 << "          </DataItem>\n";
+				break;
+			}
+			xdmf << "        </Attribute>\n";
+		}
+		xdmf << "      </Grid>\n";
+
+		xdmf_end_ = xdmf.tellp();
+		xdmf << xdmf_footer;
+	}
+} // namespace polyfem::io
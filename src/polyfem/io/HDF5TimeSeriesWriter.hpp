@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace h5pp
+{
+	class File;
+}
+
+namespace polyfem::io
+{
+	/// Writes the frames of a time dependent simulation in a single HDF5 file with an XDMF index (readable by paraview).
+	/// The mesh is only written when it changes, every step appends its fields as chunked and compressed datasets.
+	class HDF5TimeSeriesWriter
+	{
+	public:
+		/// storage of a field in the file
+		enum class Precision
+		{
+			F64,      ///< double
+			F32,      ///< float
+			QUANTIZED ///< 16 bits unsigned integers mapping the range linearly
+		};
+
+		struct FieldFormat
+		{
+			Precision precision = Precision::F64;
+			/// quantization range, the range of the data of every step if min >= max
+			double min = 0;
+			double max = 0;
+		};
+
+		/// @param[in] path HDF5 file, the XDMF file has the same name with the .xdmf extension
+		/// @param[in] compression_level gzip compression level of the datasets (0-9)
+		/// @param[in] formats storage of the fields, by name, the others are written as doubles
+		HDF5TimeSeriesWriter(const std::string &path, const int compression_level = 4, const std::map<std::string, FieldFormat> &formats = {});
+
+		/// @brief Parse the precision name (f64, f32, or u16)
+		static Precision precision_from_string(const std::string &name);
+
+		/// @brief Append a step.
+		/// @param[in] t time of the step
+		/// @param[in] points mesh points
+		/// @param[in] cells mesh cells (triangles, quads, tets, or hexes)
+		/// @param[in] fields point data
+		void write_step(
+			const double t,
+			const Eigen::MatrixXd &points,
+			const Eigen::MatrixXi &cells,
+			const std::vector<std::pair<std::string, Eigen::MatrixXd>> &fields);
+
+		/// @brief XDMF topology type of the cells, empty if not supported
+		static std::string topology_type(const int dim, const int cell_size);
+
+		const std::string &path() const { return path_; }
+		const std::string &xdmf_path() const { return xdmf_path_; }
+		int n_steps() const { return n_steps_; }
+
+	private:
+		/// written dataset of a field, values = scale * stored + offset
+		struct FieldDataset
+		{
+			std::string name;
+			int rows, cols;
+			Precision precision;
+			double scale = 1;
+			double offset = 0;
+		};
+
+		/// writes the field in the precision of its format
+		FieldDataset write_field(h5pp::File &file, const std::string &name, const Eigen::MatrixXd &data) const;
+
+		void append_xdmf(
+			const double t,
+			const Eigen::MatrixXd &points,
+			const Eigen::MatrixXi &cells,
+			const std::vector<FieldDataset> &fields);
+
+		std::string path_;
+		std::string xdmf_path_;
+		int compression_level_;
+		std::map<std::string, FieldFormat> formats_;
+
+		int n_steps_ = 0;
+		int n_meshes_ = 0;
+		/// last written mesh, reused while it does not change
+		Eigen::MatrixXd mesh_points_;
+		Eigen::MatrixXi mesh_cells_;
+
+		/// position of the closing tags in the XDMF file, the next step is written there
+		long xdmf_end_ = 0;
+	};
+} // namespace polyfem::io
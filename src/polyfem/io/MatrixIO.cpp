@@ -1,17 +1,32 @@
 #include "MatrixIO.hpp"
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/list_to_matrix.h>
+#include <unsupported/Eigen/SparseExtra>
 
 #include <iostream>
 #include <h5pp/h5pp.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <iomanip> // setprecision
+#include <numeric>
 #include <vector>
 #include <filesystem>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace polyfem::io
 {
 	template <typename T>
@@ -60,9 +75,16 @@ namespace polyfem::io
 		}
 	}
 
+	std::mutex &hdf5_mutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
 	template <typename Mat>
 	bool write_matrix(const std::string &path, const std::string &key, const Mat &mat, const bool replace)
 	{
+		std::lock_guard<std::mutex> lock(hdf5_mutex());
 		h5pp::File hdf5_file(path, replace ? h5pp::FileAccess::REPLACE : h5pp::FileAccess::READWRITE);
 		hdf5_file.writeDataset(mat, key);
 
@@ -72,6 +94,7 @@ namespace polyfem::io
 	template <typename Mat>
 	bool read_matrix(const std::string &path, const std::string &key, Mat &mat)
 	{
+		std::lock_guard<std::mutex> lock(hdf5_mutex());
 		h5pp::File hdf5_file(path, h5pp::FileAccess::READONLY);
 		if (!hdf5_file.linkExists(key))
 			return false;
@@ -79,6 +102,137 @@ namespace polyfem::io
 		return true;
 	}
 
+	namespace
+	{
+		/// rows [start, start + count) of a dataset, copied to the rows [dest, dest + count)
+		struct RowRange
+		{
+			int64_t start, count, dest;
+		};
+
+		template <typename FileScalar, typename T>
+		bool read_row_ranges(
+			const std::string &path,
+			const std::string &key,
+			std::vector<RowRange> ranges,
+			int64_t n_rows,
+			int64_t chunk_rows,
+			Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat)
+		{
+			using Block = Eigen::Matrix<FileScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+			std::lock_guard<std::mutex> lock(hdf5_mutex());
+			h5pp::File hdf5_file(path, h5pp::FileAccess::READONLY);
+			if (!hdf5_file.linkExists(key))
+				return false;
+
+			const std::vector<hsize_t> dims = hdf5_file.getDatasetDimensions(key);
+			if (dims.empty() || dims.size() > 2)
+			{
+				logger().error("Dataset {} of {} is not a matrix ({} dimensions)", key, path, dims.size());
+				return false;
+			}
+			const int64_t file_rows = dims[0];
+			const int64_t cols = dims.size() == 2 ? dims[1] : 1;
+			if (n_rows < 0)
+			{
+				n_rows = file_rows;
+				ranges = {{0, file_rows, 0}};
+			}
+			for (const RowRange &r : ranges)
+			{
+				if (r.start < 0 || r.start + r.count > file_rows)
+				{
+					logger().error("Rows [{}, {}) out of the {} rows of dataset {} of {}", r.start, r.start + r.count, file_rows, key, path);
+					return false;
+				}
+			}
+
+			if (chunk_rows <= 0)
+				chunk_rows = std::max<int64_t>(1, (int64_t(64) << 20) / (cols * sizeof(FileScalar)));
+
+			mat.resize(n_rows, cols);
+
+			// the file is row-major, the blocks are read as is and transposed to mat by the threads
+			std::vector<FileScalar> buffers[2];
+			std::future<void> copy;
+			int current = 0;
+			for (const RowRange &range : ranges)
+			{
+				for (int64_t offset = 0; offset < range.count; offset += chunk_rows)
+				{
+					const int64_t count = std::min(chunk_rows, range.count - offset);
+					const int64_t dest = range.dest + offset;
+
+					std::vector<FileScalar> &buffer = buffers[current];
+					current = 1 - current;
+					if (dims.size() == 2)
+						hdf5_file.readHyperslab(buffer, key, h5pp::Hyperslab({hsize_t(range.start + offset), 0}, {hsize_t(count), hsize_t(cols)}));
+					else
+						hdf5_file.readHyperslab(buffer, key, h5pp::Hyperslab({hsize_t(range.start + offset)}, {hsize_t(count)}));
+
+					// the other buffer is free once its copy is done
+					if (copy.valid())
+						copy.get();
+					copy = std::async(std::launch::async, [&mat, &buffer, count, cols, dest]() {
+						const Eigen::Map<const Block> block(buffer.data(), count, cols);
+						utils::maybe_parallel_for(count, [&](int start, int end, int thread_id) {
+							mat.middleRows(dest + start, end - start) = block.middleRows(start, end - start).template cast<T>();
+						});
+					});
+				}
+			}
+			if (copy.valid())
+				copy.get();
+
+			return true;
+		}
+	} // namespace
+
+	template <typename FileScalar, typename T>
+	bool read_matrix_chunked(const std::string &path, const std::string &key, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat, const int64_t chunk_rows)
+	{
+		return read_row_ranges<FileScalar>(path, key, {}, /*n_rows=*/-1, chunk_rows, mat);
+	}
+
+	template <typename FileScalar, typename T>
+	bool read_matrix_rows(const std::string &path, const std::string &key, const std::vector<int64_t> &rows, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat, const int64_t chunk_rows)
+	{
+		std::vector<int64_t> order(rows.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](const int64_t a, const int64_t b) { return rows[a] < rows[b]; });
+
+		// runs of rows consecutive both in the file and in mat
+		std::vector<RowRange> ranges;
+		std::vector<std::pair<int64_t, int64_t>> duplicates;
+		for (const int64_t i : order)
+		{
+			if (!ranges.empty())
+			{
+				RowRange &last = ranges.back();
+				if (rows[i] == last.start + last.count - 1)
+				{
+					duplicates.emplace_back(i, last.dest + last.count - 1);
+					continue;
+				}
+				if (rows[i] == last.start + last.count && i == last.dest + last.count)
+				{
+					++last.count;
+					continue;
+				}
+			}
+			ranges.push_back({rows[i], 1, i});
+		}
+
+		if (!read_row_ranges<FileScalar>(path, key, ranges, rows.size(), chunk_rows, mat))
+			return false;
+
+		for (const auto &[i, j] : duplicates)
+			mat.row(i) = mat.row(j);
+
+		return true;
+	}
+
 	template <typename T>
 	bool read_matrix_ascii(const std::string &path, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat)
 	{
@@ -243,6 +397,285 @@ namespace polyfem::io
 		return success;
 	}
 
+	bool write_sparse_matrix(const std::string &path, const std::string &key, const StiffnessMatrix &mat, const bool replace, const int compression_level)
+	{
+		using Index = StiffnessMatrix::StorageIndex;
+		StiffnessMatrix compressed = mat;
+		compressed.makeCompressed();
+
+		const Eigen::Matrix<Index, Eigen::Dynamic, 1> outer = Eigen::Map<const Eigen::Matrix<Index, Eigen::Dynamic, 1>>(compressed.outerIndexPtr(), compressed.outerSize() + 1);
+		const Eigen::Matrix<Index, Eigen::Dynamic, 1> inner = Eigen::Map<const Eigen::Matrix<Index, Eigen::Dynamic, 1>>(compressed.innerIndexPtr(), compressed.nonZeros());
+		const Eigen::VectorXd values = Eigen::Map<const Eigen::VectorXd>(compressed.valuePtr(), compressed.nonZeros());
+		const Eigen::Matrix<Index, 2, 1> size(compressed.rows(), compressed.cols());
+
+		std::lock_guard<std::mutex> lock(hdf5_mutex());
+		h5pp::File hdf5_file(path, replace ? h5pp::FileAccess::REPLACE : h5pp::FileAccess::READWRITE);
+		hdf5_file.writeDataset(size, key + "/size");
+		if (compression_level > 0)
+		{
+			hdf5_file.setCompressionLevel(compression_level);
+			hdf5_file.writeDataset(outer, key + "/outer", H5D_CHUNKED);
+			hdf5_file.writeDataset(inner, key + "/inner", H5D_CHUNKED);
+			hdf5_file.writeDataset(values, key + "/values", H5D_CHUNKED);
+		}
+		else
+		{
+			hdf5_file.writeDataset(outer, key + "/outer");
+			hdf5_file.writeDataset(inner, key + "/inner");
+			hdf5_file.writeDataset(values, key + "/values");
+		}
+
+		return true;
+	}
+
+	bool read_sparse_matrix(const std::string &path, const std::string &key, StiffnessMatrix &mat)
+	{
+		using Index = StiffnessMatrix::StorageIndex;
+		using IndexVector = Eigen::Matrix<Index, Eigen::Dynamic, 1>;
+
+		std::lock_guard<std::mutex> lock(hdf5_mutex());
+		h5pp::File hdf5_file(path, h5pp::FileAccess::READONLY);
+		if (!hdf5_file.linkExists(key + "/values"))
+			return false;
+
+		const IndexVector size = hdf5_file.readDataset<IndexVector>(key + "/size");
+		const IndexVector outer = hdf5_file.readDataset<IndexVector>(key + "/outer");
+		const IndexVector inner = hdf5_file.readDataset<IndexVector>(key + "/inner");
+		const Eigen::VectorXd values = hdf5_file.readDataset<Eigen::VectorXd>(key + "/values");
+
+		mat = Eigen::Map<const StiffnessMatrix>(size(0), size(1), values.size(), outer.data(), inner.data(), values.data());
+		return true;
+	}
+
+	namespace
+	{
+		constexpr char sparse_magic[8] = {'P', 'F', 'S', 'P', 'A', 'R', 'S', 'E'};
+
+		struct SparseHeader
+		{
+			char magic[8];
+			int64_t rows, cols, non_zeros;
+			int32_t index_size, row_major;
+		};
+
+		/// byte offsets of the arrays of a binary sparse matrix, each array is 64-byte aligned
+		struct SparseLayout
+		{
+			size_t outer, inner, values, bytes;
+
+			explicit SparseLayout(const SparseHeader &header)
+			{
+				const auto align = [](const size_t offset) { return (offset + 63) / 64 * 64; };
+				const int64_t outer_size = (header.row_major ? header.rows : header.cols) + 1;
+				outer = align(sizeof(SparseHeader));
+				inner = align(outer + outer_size * header.index_size);
+				values = align(inner + header.non_zeros * header.index_size);
+				bytes = values + header.non_zeros * sizeof(double);
+			}
+		};
+
+		bool is_valid(const SparseHeader &header, const size_t bytes)
+		{
+			return std::memcmp(header.magic, sparse_magic, sizeof(sparse_magic)) == 0
+				   && header.index_size == sizeof(StiffnessMatrix::StorageIndex)
+				   && header.row_major == int(StiffnessMatrix::IsRowMajor)
+				   && header.rows >= 0 && header.cols >= 0 && header.non_zeros >= 0
+				   && SparseLayout(header).bytes <= bytes;
+		}
+	} // namespace
+
+	bool write_sparse_matrix_binary(const std::string &path, const StiffnessMatrix &mat)
+	{
+		StiffnessMatrix copy;
+		if (!mat.isCompressed())
+		{
+			copy = mat;
+			copy.makeCompressed();
+		}
+		const StiffnessMatrix &compressed = mat.isCompressed() ? mat : copy;
+
+		SparseHeader header;
+		std::memcpy(header.magic, sparse_magic, sizeof(sparse_magic));
+		header.rows = compressed.rows();
+		header.cols = compressed.cols();
+		header.non_zeros = compressed.nonZeros();
+		header.index_size = sizeof(StiffnessMatrix::StorageIndex);
+		header.row_major = StiffnessMatrix::IsRowMajor;
+		const SparseLayout layout(header);
+
+		{
+			std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out.good())
+			{
+				logger().error("Failed to write to file: {}", path);
+				return false;
+			}
+			out.write((const char *)(&header), sizeof(SparseHeader));
+		}
+		std::error_code ec;
+		std::filesystem::resize_file(path, layout.bytes, ec);
+		if (ec)
+		{
+			logger().error("Failed to allocate {} bytes in {}: {}", layout.bytes, path, ec.message());
+			return false;
+		}
+
+		// the arrays are split in chunks written at their offsets, every thread with its own stream
+		constexpr size_t chunk_size = 64 * 1024 * 1024;
+		struct Chunk
+		{
+			const char *data;
+			size_t size, offset;
+		};
+		std::vector<Chunk> chunks;
+		const auto add_array = [&](const void *data, const size_t size, const size_t offset) {
+			for (size_t start = 0; start < size; start += chunk_size)
+				chunks.push_back({(const char *)data + start, std::min(chunk_size, size - start), offset + start});
+		};
+		add_array(compressed.outerIndexPtr(), (compressed.outerSize() + 1) * header.index_size, layout.outer);
+		add_array(compressed.innerIndexPtr(), compressed.nonZeros() * header.index_size, layout.inner);
+		add_array(compressed.valuePtr(), compressed.nonZeros() * sizeof(double), layout.values);
+
+		std::atomic<bool> success = true;
+		utils::maybe_parallel_for(chunks.size(), [&](int start, int end, int thread_id) {
+			std::ofstream out(path, std::ios::in | std::ios::out | std::ios::binary);
+			for (int i = start; i < end && out.good(); ++i)
+			{
+				out.seekp(chunks[i].offset);
+				out.write(chunks[i].data, chunks[i].size);
+			}
+			if (!out.good())
+				success = false;
+		});
+
+		if (!success)
+			logger().error("Failed to write to file: {}", path);
+		return success;
+	}
+
+	bool read_sparse_matrix_binary(const std::string &path, StiffnessMatrix &mat)
+	{
+		MappedSparseMatrix mapped;
+		if (!mapped.open(path))
+			return false;
+		mat = mapped.matrix();
+		return true;
+	}
+
+	MappedSparseMatrix::~MappedSparseMatrix()
+	{
+		close();
+	}
+
+	bool MappedSparseMatrix::open(const std::string &path)
+	{
+		close();
+
+#ifdef _WIN32
+		std::ifstream in(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!in.good())
+		{
+			logger().error("Failed to open file: {}", path);
+			return false;
+		}
+		buffer_.resize(size_t(in.tellg()));
+		in.seekg(0);
+		in.read(buffer_.data(), buffer_.size());
+		data_ = buffer_.data();
+		bytes_ = buffer_.size();
+#else
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd < 0 || ::fstat(fd, &st) != 0)
+		{
+			if (fd >= 0)
+				::close(fd);
+			logger().error("Failed to open file: {}", path);
+			return false;
+		}
+
+		bytes_ = st.st_size;
+		void *mapped = bytes_ > 0 ? ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+		// the mapping keeps the file open
+		::close(fd);
+		if (mapped == MAP_FAILED)
+		{
+			bytes_ = 0;
+			logger().error("Failed to map file: {}", path);
+			return false;
+		}
+		data_ = static_cast<const char *>(mapped);
+		mapped_ = true;
+#endif
+
+		if (bytes_ < sizeof(SparseHeader) || !is_valid(*reinterpret_cast<const SparseHeader *>(data_), bytes_))
+		{
+			logger().error("{} is not a binary sparse matrix", path);
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MappedSparseMatrix::close()
+	{
+#ifndef _WIN32
+		if (mapped_)
+			::munmap(const_cast<char *>(data_), bytes_);
+#endif
+		mapped_ = false;
+		data_ = nullptr;
+		bytes_ = 0;
+		buffer_.clear();
+		buffer_.shrink_to_fit();
+	}
+
+	Eigen::Map<const StiffnessMatrix> MappedSparseMatrix::matrix() const
+	{
+		assert(is_open());
+		using Index = StiffnessMatrix::StorageIndex;
+		const SparseHeader &header = *reinterpret_cast<const SparseHeader *>(data_);
+		const SparseLayout layout(header);
+
+		return Eigen::Map<const StiffnessMatrix>(
+			header.rows, header.cols, header.non_zeros,
+			reinterpret_cast<const Index *>(data_ + layout.outer),
+			reinterpret_cast<const Index *>(data_ + layout.inner),
+			reinterpret_cast<const double *>(data_ + layout.values));
+	}
+
+	bool write_sparse_matrix(const std::string &path, const StiffnessMatrix &mat)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(),
+					   [](unsigned char c) { return std::tolower(c); });
+
+		if (extension == ".bin")
+			return write_sparse_matrix_binary(path, mat);
+		else if (extension == ".h5" || extension == ".hdf5")
+			return write_sparse_matrix(path, "matrix", mat, /*replace=*/true, /*compression_level=*/6);
+		else if (extension == ".csv")
+			return write_sparse_matrix_csv(path, mat);
+		else
+			return Eigen::saveMarket(mat, path);
+	}
+
+	bool read_sparse_matrix(const std::string &path, StiffnessMatrix &mat)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(),
+					   [](unsigned char c) { return std::tolower(c); });
+
+		if (extension == ".bin")
+			return read_sparse_matrix_binary(path, mat);
+		else if (extension == ".h5" || extension == ".hdf5")
+			return read_sparse_matrix(path, "matrix", mat);
+
+		logger().error("Unsupported sparse matrix format (\"{}\")", extension);
+		return false;
+	}
+
 	// template instantiation
 	template bool read_matrix<int>(const std::string &, Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> &);
 	template bool read_matrix<double>(const std::string &, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> &);
@@ -250,12 +683,21 @@ namespace polyfem::io
 	template bool read_matrix<Eigen::MatrixXi>(const std::string &, const std::string &, Eigen::MatrixXi &);
 	template bool read_matrix<Eigen::MatrixXd>(const std::string &, const std::string &, Eigen::MatrixXd &);
 
+	template bool read_matrix_chunked<double>(const std::string &, const std::string &, Eigen::MatrixXd &, const int64_t);
+	template bool read_matrix_chunked<int>(const std::string &, const std::string &, Eigen::MatrixXi &, const int64_t);
+	template bool read_matrix_chunked<int64_t>(const std::string &, const std::string &, Eigen::MatrixXi &, const int64_t);
+
+	template bool read_matrix_rows<double>(const std::string &, const std::string &, const std::vector<int64_t> &, Eigen::MatrixXd &, const int64_t);
+	template bool read_matrix_rows<int>(const std::string &, const std::string &, const std::vector<int64_t> &, Eigen::MatrixXi &, const int64_t);
+	template bool read_matrix_rows<int64_t>(const std::string &, const std::string &, const std::vector<int64_t> &, Eigen::MatrixXi &, const int64_t);
+
 	template bool write_matrix<Eigen::MatrixXd>(const std::string &, const Eigen::MatrixXd &);
 	template bool write_matrix<Eigen::MatrixXf>(const std::string &, const Eigen::MatrixXf &);
 	template bool write_matrix<Eigen::VectorXd>(const std::string &, const Eigen::VectorXd &);
 	template bool write_matrix<Eigen::VectorXf>(const std::string &, const Eigen::VectorXf &);
 
 	template bool write_matrix<Eigen::MatrixXd>(const std::string &, const std::string &, const Eigen::MatrixXd &, const bool);
+	template bool write_matrix<Eigen::MatrixXi>(const std::string &, const std::string &, const Eigen::MatrixXi &, const bool);
 	template bool write_matrix<Eigen::MatrixXf>(const std::string &, const std::string &, const Eigen::MatrixXf &, const bool);
 	template bool write_matrix<Eigen::VectorXd>(const std::string &, const std::string &, const Eigen::VectorXd &, const bool);
 	template bool write_matrix<Eigen::VectorXf>(const std::string &, const std::string &, const Eigen::VectorXf &, const bool);
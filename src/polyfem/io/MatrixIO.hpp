@@ -6,6 +6,9 @@
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include <mutex>
+#include <vector>
+
 namespace polyfem::io
 {
 	/// Reads a matrix from a file. Determines the file format based on the path's extension.
@@ -16,6 +19,9 @@ namespace polyfem::io
 	template <typename Mat>
 	bool write_matrix(const std::string &path, const Mat &mat);
 
+	/// HDF5 is not thread safe, every access to a hdf5 file must hold this lock (the keyed read/write_matrix do).
+	std::mutex &hdf5_mutex();
+
 	/// Writes a matrix to a hdf5 file using key as name.
 	template <typename Mat>
 	bool write_matrix(const std::string &path, const std::string &key, const Mat &mat, const bool replace = true);
@@ -24,6 +30,18 @@ namespace polyfem::io
 	template <typename Mat>
 	bool read_matrix(const std::string &path, const std::string &key, Mat &mat);
 
+	/// Reads the dataset key (1D or 2D) of a hdf5 file by blocks of rows, without a full-size temporary:
+	/// a block is read (the hdf5 accesses are serialized) while the threads convert and copy the previous one into mat.
+	/// @tparam FileScalar scalar type stored in the file (e.g., int64_t for the cells), converted to T by the threads
+	/// @param[in] chunk_rows number of rows per block, 0 for blocks of 64MB
+	template <typename FileScalar, typename T>
+	bool read_matrix_chunked(const std::string &path, const std::string &key, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat, const int64_t chunk_rows = 0);
+
+	/// Reads only some rows of the dataset key (e.g., the entities of a selection or a subset of a restart), mat.row(i) is row rows[i]
+	/// of the dataset. The runs of consecutive rows are read as one hyperslab, in blocks as in read_matrix_chunked.
+	template <typename FileScalar, typename T>
+	bool read_matrix_rows(const std::string &path, const std::string &key, const std::vector<int64_t> &rows, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat, const int64_t chunk_rows = 0);
+
 	template <typename T>
 	bool read_matrix_ascii(const std::string &path, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat);
 
@@ -36,6 +54,57 @@ namespace polyfem::io
 	template <typename Mat>
 	bool write_matrix_binary(const std::string &path, const Mat &mat);
 
+	/// Writes a sparse matrix to a hdf5 file as its compressed storage arrays under the group key.
+	/// A positive compression_level (1 to 9) stores the arrays in compressed chunks.
+	bool write_sparse_matrix(const std::string &path, const std::string &key, const StiffnessMatrix &mat, const bool replace = true, const int compression_level = 0);
+
+	/// Reads a sparse matrix written by write_sparse_matrix.
+	bool read_sparse_matrix(const std::string &path, const std::string &key, StiffnessMatrix &mat);
+
+	/// Writes a sparse matrix to a file. Determines the file format based on the path's extension:
+	/// .bin for the raw binary format of write_sparse_matrix_binary, .h5/.hdf5 for compressed hdf5 (key "matrix"),
+	/// .csv for write_sparse_matrix_csv, and Matrix Market otherwise.
+	bool write_sparse_matrix(const std::string &path, const StiffnessMatrix &mat);
+
+	/// Reads a sparse matrix written by write_sparse_matrix(path, mat) in the binary or hdf5 format.
+	bool read_sparse_matrix(const std::string &path, StiffnessMatrix &mat);
+
+	/// Writes a sparse matrix in a raw binary format that can be mapped without copy (see MappedSparseMatrix):
+	/// a header (magic, rows, cols, nonzeros) followed by the outer indices, inner indices, and values of the
+	/// compressed storage, each 64-byte aligned. The arrays are written by the threads in parallel chunks.
+	bool write_sparse_matrix_binary(const std::string &path, const StiffnessMatrix &mat);
+
+	/// Reads (copies) a sparse matrix written by write_sparse_matrix_binary.
+	bool read_sparse_matrix_binary(const std::string &path, StiffnessMatrix &mat);
+
+	/// Sparse matrix written by write_sparse_matrix_binary and mapped in memory, the pages are read on demand
+	/// and the matrix is a view of the file (read into memory on Windows).
+	class MappedSparseMatrix
+	{
+	public:
+		MappedSparseMatrix() = default;
+		~MappedSparseMatrix();
+		MappedSparseMatrix(const MappedSparseMatrix &) = delete;
+		MappedSparseMatrix &operator=(const MappedSparseMatrix &) = delete;
+
+		/// maps the file, the previous mapping is released
+		/// @return false if the file cannot be read or is not a binary sparse matrix
+		bool open(const std::string &path);
+		/// releases the mapping, the views of the matrix become invalid
+		void close();
+		bool is_open() const { return data_ != nullptr; }
+
+		/// view of the mapped matrix, valid until close
+		Eigen::Map<const StiffnessMatrix> matrix() const;
+
+	private:
+		const char *data_ = nullptr;
+		size_t bytes_ = 0;
+		bool mapped_ = false;
+		// contents of the file if it is not mapped
+		std::vector<char> buffer_;
+	};
+
 	bool write_sparse_matrix_csv(const std::string &path, const Eigen::SparseMatrix<double> &mat);
 
 	template <typename T>
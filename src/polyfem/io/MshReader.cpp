@@ -2,18 +2,405 @@
 
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <mshio/mshio.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <string>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 #include <filesystem> // filesystem
 
 namespace polyfem::io
 {
+	namespace
+	{
+		bool is_supported_element(const int type)
+		{
+			return type == 2 || type == 9 || type == 21 || type == 23 || type == 25 // tri
+				   || type == 3 || type == 10                                        // quad
+				   || type == 4 || type == 11 || type == 29 || type == 30 || type == 31 // tet
+				   || type == 5 || type == 12;                                       // hex
+		}
+
+		int cell_size(const int type)
+		{
+			if (type == 2 || type == 9 || type == 21 || type == 23 || type == 25)
+				return 3;
+			if (type == 5 || type == 12)
+				return 8;
+			return 4;
+		}
+
+		/// Reader of MSH 4.1 files (ascii or binary) that parses the nodes and the elements
+		/// directly into the output buffers, in chunks and in parallel, instead of building a full mshio::MshSpec first.
+		/// Only the $Entities, $Nodes, and $Elements sections are used, the others are skipped.
+		class MshStreamReader
+		{
+		public:
+			MshStreamReader(std::istream &in) : in_(in) {}
+
+			/// @brief Read the $MeshFormat section.
+			/// @return false if the file is not a MSH 4.1 file with 8 byte sizes
+			bool read_header()
+			{
+				std::string line;
+				if (!std::getline(in_, line) || utils::StringUtils::trim(line) != "$MeshFormat")
+					return false;
+
+				std::string version;
+				int file_type, data_size;
+				if (!(in_ >> version >> file_type >> data_size) || version != "4.1" || data_size != 8)
+					return false;
+				binary_ = file_type == 1;
+
+				if (binary_)
+				{
+					in_.get(); // end of line
+					int one;
+					in_.read(reinterpret_cast<char *>(&one), sizeof(int));
+					if (!in_ || one != 1)
+						return false; // different endianness
+				}
+
+				return read_end("MeshFormat");
+			}
+
+			/// @brief Read the mesh, same outputs as MshReader::load
+			/// @return false if the file uses features not supported here (e.g., partitioned entities)
+			bool read(Eigen::MatrixXd &vertices, Eigen::MatrixXi &cells, std::vector<std::vector<int>> &elements, std::vector<std::vector<double>> &weights, std::vector<int> &body_ids)
+			{
+				std::string line;
+				while (std::getline(in_, line))
+				{
+					line = utils::StringUtils::trim(line);
+					if (line.empty())
+						continue;
+					if (line[0] != '$')
+						throw std::runtime_error(fmt::format("Invalid MSH file, unexpected line \"{}\"", line));
+
+					const std::string section = line.substr(1);
+					if (section == "PartitionedEntities" || section == "GhostElements" || section == "Periodic")
+						return false;
+					else if (section == "Entities")
+						read_entities();
+					else if (section == "Nodes")
+						read_nodes(vertices);
+					else if (section == "Elements")
+						read_elements();
+					else if (!read_end(section))
+						throw std::runtime_error(fmt::format("Invalid MSH file, missing $End{}", section));
+				}
+
+				if (dim_ != 2 && dim_ != 3)
+					throw std::runtime_error("Invalid MSH file, no 2D or 3D elements");
+
+				// z is dropped for 2D meshes, shrinking the columns of a column-major matrix does not copy
+				vertices.conservativeResize(vertices.rows(), dim_);
+
+				assemble(cells, elements, weights, body_ids);
+				return true;
+			}
+
+		private:
+			/// element block of the highest dimension
+			struct Block
+			{
+				int type;
+				int n_nodes;
+				int body_id;
+				std::vector<int> nodes; ///< vertex indices, n_nodes per element
+			};
+
+			static constexpr size_t chunk_size = 1 << 16;
+
+			template <typename T>
+			T read_value()
+			{
+				T v;
+				if (binary_)
+					in_.read(reinterpret_cast<char *>(&v), sizeof(T));
+				else
+					in_ >> v;
+				if (!in_)
+					throw std::runtime_error("Unexpected end of MSH file");
+				return v;
+			}
+
+			bool read_end(const std::string &section)
+			{
+				std::string line;
+				while (std::getline(in_, line))
+				{
+					if (utils::StringUtils::trim(line) == "$End" + section)
+						return true;
+				}
+				return false;
+			}
+
+			/// reads n_items items of n_values values of type T and calls process(values, first item, number of items) chunk by chunk
+			/// in ascii, every item is a line, the lines of a chunk are parsed in parallel
+			template <typename T>
+			void read_items(const size_t n_items, const size_t n_values, const std::function<void(const std::vector<T> &, size_t, size_t)> &process)
+			{
+				std::vector<T> values;
+				std::vector<std::string> lines;
+				if (!binary_)
+					in_ >> std::ws;
+
+				for (size_t start = 0; start < n_items; start += chunk_size)
+				{
+					const size_t n = std::min(chunk_size, n_items - start);
+					values.resize(n * n_values);
+
+					if (binary_)
+					{
+						in_.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(T));
+						if (!in_)
+							throw std::runtime_error("Unexpected end of MSH file");
+					}
+					else
+					{
+						lines.resize(n);
+						for (size_t i = 0; i < n; ++i)
+						{
+							if (!std::getline(in_, lines[i]))
+								throw std::runtime_error("Unexpected end of MSH file");
+						}
+
+						std::atomic<bool> valid = true;
+						utils::maybe_parallel_for(n, [&](int begin, int end, int thread_id) {
+							for (int i = begin; i < end; ++i)
+							{
+								const char *ptr = lines[i].c_str();
+								for (size_t j = 0; j < n_values; ++j)
+								{
+									char *next;
+									if constexpr (std::is_floating_point_v<T>)
+										values[i * n_values + j] = std::strtod(ptr, &next);
+									else
+										values[i * n_values + j] = std::strtoull(ptr, &next, 10);
+									if (next == ptr)
+										valid = false;
+									ptr = next;
+								}
+							}
+						});
+						if (!valid)
+							throw std::runtime_error("Invalid MSH file, unable to parse a line");
+					}
+
+					process(values, start, n);
+				}
+			}
+
+			void read_entities()
+			{
+				const uint64_t n_points = read_value<uint64_t>();
+				const uint64_t n_curves = read_value<uint64_t>();
+				const uint64_t n_surfaces = read_value<uint64_t>();
+				const uint64_t n_volumes = read_value<uint64_t>();
+
+				const std::array<uint64_t, 4> n_entities = {{n_points, n_curves, n_surfaces, n_volumes}};
+				for (int d = 0; d < 4; ++d)
+				{
+					for (uint64_t i = 0; i < n_entities[d]; ++i)
+					{
+						const int tag = read_value<int>();
+						for (int k = 0; k < (d == 0 ? 3 : 6); ++k)
+							read_value<double>(); // bounding box
+
+						const uint64_t n_physical_tags = read_value<uint64_t>();
+						int physical_tag = 0;
+						for (uint64_t k = 0; k < n_physical_tags; ++k)
+						{
+							const int t = read_value<int>();
+							if (k == 0)
+								physical_tag = t;
+						}
+						physical_tags_[d][tag] = physical_tag;
+
+						if (d > 0)
+						{
+							const uint64_t n_bounding = read_value<uint64_t>();
+							for (uint64_t k = 0; k < n_bounding; ++k)
+								read_value<int>();
+						}
+					}
+				}
+
+				if (!read_end("Entities"))
+					throw std::runtime_error("Invalid MSH file, missing $EndEntities");
+			}
+
+			void read_nodes(Eigen::MatrixXd &vertices)
+			{
+				const uint64_t n_blocks = read_value<uint64_t>();
+				const uint64_t n_vertices = read_value<uint64_t>();
+				read_value<uint64_t>(); // min tag
+				const uint64_t max_tag = read_value<uint64_t>();
+
+				vertices.resize(n_vertices, 3);
+				tag_to_index_.assign(max_tag + 1, -1);
+				const bool condense = n_vertices != max_tag;
+				if (condense)
+					logger().warn("MSH file contains more node tags than nodes, condensing nodes which will break input node ordering.");
+
+				int index = 0;
+				std::vector<int> ids;
+				for (uint64_t b = 0; b < n_blocks; ++b)
+				{
+					const int entity_dim = read_value<int>();
+					read_value<int>(); // entity tag
+					const int parametric = read_value<int>();
+					const uint64_t n = read_value<uint64_t>();
+
+					ids.resize(n);
+					read_items<uint64_t>(n, 1, [&](const std::vector<uint64_t> &tags, size_t start, size_t n_chunk) {
+						for (size_t i = 0; i < n_chunk; ++i)
+						{
+							const uint64_t tag = tags[i];
+							const int node_id = condense ? (index++) : int(tag - 1);
+							if (tag > max_tag || node_id < 0 || node_id >= int(n_vertices))
+								throw std::runtime_error(fmt::format("Invalid MSH file, node tag {} out of range", tag));
+							tag_to_index_[tag] = node_id;
+							ids[start + i] = node_id;
+						}
+					});
+
+					const int n_values = 3 + (parametric ? entity_dim : 0);
+					read_items<double>(n, n_values, [&](const std::vector<double> &coords, size_t start, size_t n_chunk) {
+						utils::maybe_parallel_for(n_chunk, [&](int begin, int end, int thread_id) {
+							for (int i = begin; i < end; ++i)
+								vertices.row(ids[start + i]) << coords[i * n_values], coords[i * n_values + 1], coords[i * n_values + 2];
+						});
+					});
+				}
+
+				if (!read_end("Nodes"))
+					throw std::runtime_error("Invalid MSH file, missing $EndNodes");
+			}
+
+			void read_elements()
+			{
+				const uint64_t n_blocks = read_value<uint64_t>();
+				read_value<uint64_t>(); // number of elements
+				read_value<uint64_t>(); // min tag
+				read_value<uint64_t>(); // max tag
+
+				for (uint64_t b = 0; b < n_blocks; ++b)
+				{
+					const int entity_dim = read_value<int>();
+					const int entity_tag = read_value<int>();
+					const int type = read_value<int>();
+					const uint64_t n = read_value<uint64_t>();
+					const int n_nodes = mshio::nodes_per_element(type);
+
+					if (entity_dim > dim_)
+					{
+						// only the elements of the highest dimension are kept
+						dim_ = entity_dim;
+						blocks_.clear();
+					}
+
+					if (entity_dim < dim_ || !is_supported_element(type))
+					{
+						read_items<uint64_t>(n, 1 + n_nodes, [](const std::vector<uint64_t> &, size_t, size_t) {});
+						continue;
+					}
+
+					Block &block = blocks_.emplace_back();
+					block.type = type;
+					block.n_nodes = n_nodes;
+					const auto it = physical_tags_[entity_dim].find(entity_tag);
+					block.body_id = it != physical_tags_[entity_dim].end() ? it->second : 0;
+					block.nodes.resize(n * n_nodes);
+
+					read_items<uint64_t>(n, 1 + n_nodes, [&](const std::vector<uint64_t> &data, size_t start, size_t n_chunk) {
+						std::atomic<bool> valid = true;
+						utils::maybe_parallel_for(n_chunk, [&](int begin, int end, int thread_id) {
+							for (int i = begin; i < end; ++i)
+							{
+								for (int j = 0; j < n_nodes; ++j)
+								{
+									const uint64_t tag = data[i * (1 + n_nodes) + 1 + j];
+									const int v_index = tag < tag_to_index_.size() ? tag_to_index_[tag] : -1;
+									if (v_index < 0)
+										valid = false;
+									block.nodes[(start + i) * n_nodes + j] = v_index;
+								}
+							}
+						});
+						if (!valid)
+							throw std::runtime_error("Invalid MSH file, element with an unknown node");
+					});
+				}
+
+				if (!read_end("Elements"))
+					throw std::runtime_error("Invalid MSH file, missing $EndElements");
+			}
+
+			void assemble(Eigen::MatrixXi &cells, std::vector<std::vector<int>> &elements, std::vector<std::vector<double>> &weights, std::vector<int> &body_ids)
+			{
+				int cells_cols = -1;
+				int num_els = 0;
+				for (const Block &block : blocks_)
+				{
+					assert(cells_cols == -1 || cells_cols == cell_size(block.type));
+					cells_cols = cell_size(block.type);
+					num_els += block.nodes.size() / block.n_nodes;
+				}
+				if (cells_cols <= 0)
+					throw std::runtime_error("Invalid MSH file, no supported elements");
+
+				cells.resize(num_els, cells_cols);
+				body_ids.resize(num_els);
+				elements.clear();
+				elements.resize(num_els);
+				weights.clear();
+				weights.resize(num_els);
+
+				int offset = 0;
+				for (Block &block : blocks_)
+				{
+					const int n = block.nodes.size() / block.n_nodes;
+					utils::maybe_parallel_for(n, [&](int begin, int end, int thread_id) {
+						for (int i = begin; i < end; ++i)
+						{
+							const int *nodes = block.nodes.data() + size_t(i) * block.n_nodes;
+							for (int j = 0; j < cells_cols; ++j)
+								cells(offset + i, j) = nodes[j];
+							elements[offset + i].assign(nodes, nodes + block.n_nodes);
+							body_ids[offset + i] = block.body_id;
+						}
+					});
+					offset += n;
+
+					// release the block before the next one
+					std::vector<int>().swap(block.nodes);
+				}
+				blocks_.clear();
+			}
+
+			std::istream &in_;
+			bool binary_ = false;
+
+			std::array<std::unordered_map<int, int>, 4> physical_tags_;
+			std::vector<int> tag_to_index_;
+
+			int dim_ = -1;
+			std::vector<Block> blocks_;
+		};
+	} // namespace
+
 	template <typename Entity>
 	void map_entity_tag_to_physical_tag(const std::vector<Entity> &entities, std::unordered_map<int, int> &entity_tag_to_physical_tag)
 	{
@@ -28,6 +415,28 @@ namespace polyfem::io
 
 	bool MshReader::load(const std::string &path, Eigen::MatrixXd &vertices, Eigen::MatrixXi &cells, std::vector<std::vector<int>> &elements, std::vector<std::vector<double>> &weights, std::vector<int> &body_ids)
 	{
+		if (!std::filesystem::exists(path))
+		{
+			logger().error("Msh file does not exist: {}", path);
+			return false;
+		}
+
+		// MSH 4.1 is read directly into the outputs, the other versions go through mshio
+		{
+			std::ifstream in(path, std::ios::binary);
+			MshStreamReader reader(in);
+			try
+			{
+				if (reader.read_header() && reader.read(vertices, cells, elements, weights, body_ids))
+					return true;
+			}
+			catch (const std::exception &err)
+			{
+				logger().error("{}", err.what());
+				return false;
+			}
+		}
+
 		std::vector<std::string> node_data_name;
 		std::vector<std::vector<double>> node_data;
 
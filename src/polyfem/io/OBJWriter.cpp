@@ -10,40 +10,80 @@
 #include "OBJWriter.hpp"
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
+#include <vector>
 
 namespace polyfem::io
 {
+	namespace
+	{
+		/// rows formatted by one task
+		constexpr int chunk_size = 1 << 14;
+
+		/// @brief Format the rows in parallel, one buffer per chunk of rows, and append them to out in order
+		/// @param[in] n_rows number of rows
+		/// @param[in] row_bytes estimated size of a formatted row, used to preallocate the buffers
+		/// @param[in] format_row appends the row to the buffer
+		template <typename FormatRow>
+		void format_rows(const int n_rows, const size_t row_bytes, const FormatRow &format_row, std::string &out)
+		{
+			if (n_rows <= 0)
+				return;
+
+			const int n_chunks = (n_rows + chunk_size - 1) / chunk_size;
+			std::vector<std::string> buffers(n_chunks);
+			utils::maybe_parallel_for(n_chunks, [&](int start, int end, int thread_id) {
+				for (int c = start; c < end; ++c)
+				{
+					std::string &buffer = buffers[c];
+					const int row_end = std::min(n_rows, (c + 1) * chunk_size);
+					buffer.reserve((row_end - c * chunk_size) * row_bytes);
+					for (int i = c * chunk_size; i < row_end; ++i)
+						format_row(i, buffer);
+				}
+			});
+
+			size_t size = out.size();
+			for (const std::string &buffer : buffers)
+				size += buffer.size();
+			out.reserve(size);
+			for (const std::string &buffer : buffers)
+				out += buffer;
+		}
+	} // namespace
+
 	bool OBJWriter::write(const std::string &path, const Eigen::MatrixXd &v, const Eigen::MatrixXi &e, const Eigen::MatrixXi &f)
 	{
-		const Eigen::IOFormat OBJ_VERTEX_FORMAT(
-			/*precision=*/Eigen::FullPrecision,
-			/*flags=*/Eigen::DontAlignCols,
-			/*coeffSeparator=*/" ",
-			/*rowSeparator=*/"",
-			/*rowPrefix=*/"v ",
-			/*rowSuffix=*/v.cols() == 2 ? " 0\n" : "\n",
-			/*matPrefix=*/"",
-			/*fill=*/"");
-
-		std::ofstream obj(path, std::ios::out);
+		std::ofstream obj(path, std::ios::out | std::ios::binary);
 		if (!obj.is_open())
 			return false;
 
-		obj << fmt::format(
+		std::string out = fmt::format(
 			"# Vertices: {:d}\n# Edges: {:d}\n# Faces: {:d}\n",
 			v.rows(), e.rows(), f.rows());
 
-		for (int i = 0; i < v.rows(); ++i)
-			obj << v.row(i).format(OBJ_VERTEX_FORMAT);
+		// shortest representation that reads back to the same double
+		format_rows(v.rows(), 3 * 25, [&](const int i, std::string &buffer) {
+			auto it = std::back_inserter(buffer);
+			if (v.cols() == 2)
+				fmt::format_to(it, "v {} {} 0\n", v(i, 0), v(i, 1));
+			else
+				fmt::format_to(it, "v {} {} {}\n", v(i, 0), v(i, 1), v(i, 2));
+		}, out);
 
-		for (int i = 0; i < e.rows(); ++i)
-			obj << fmt::format("l {} {}\n", e(i, 0) + 1, e(i, 1) + 1);
+		format_rows(e.rows(), 2 * 11, [&](const int i, std::string &buffer) {
+			fmt::format_to(std::back_inserter(buffer), "l {} {}\n", e(i, 0) + 1, e(i, 1) + 1);
+		}, out);
 
-		for (int i = 0; i < f.rows(); ++i)
-			obj << fmt::format("f {} {} {}\n", f(i, 0) + 1, f(i, 1) + 1, f(i, 2) + 1);
+		format_rows(f.rows(), 3 * 11, [&](const int i, std::string &buffer) {
+			fmt::format_to(std::back_inserter(buffer), "f {} {} {}\n", f(i, 0) + 1, f(i, 1) + 1, f(i, 2) + 1);
+		}, out);
 
-		return true;
+		obj.write(out.data(), out.size());
+		return bool(obj);
 	}
 } // namespace polyfem::io
@@ -1,6 +1,7 @@
 #include "OutData.hpp"
 
 #include "Evaluator.hpp"
+#include "PointProbe.hpp"
 
 #include <polyfem/State.hpp>
 
@@ -34,10 +35,12 @@
 #include <polyfem/utils/EdgeSampler.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/par_for.hpp>
+#include <polyfem/utils/Profiler.hpp>
 #include <polyfem/utils/BoundarySampler.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/getRSS.h>
+#include <polyfem/utils/raster.hpp>
 
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
@@ -45,16 +48,17 @@
 #include <paraviewo/VTMWriter.hpp>
 #include <paraviewo/PVDWriter.hpp>
 
-#include <SimpleBVH/BVH.hpp>
-
 #include <igl/write_triangle_mesh.h>
 #include <igl/edges.h>
 #include <igl/facet_adjacency_matrix.h>
 #include <igl/connected_components.h>
+#include <igl/colormap.h>
 
 #include <ipc/ipc.hpp>
 
+#include <atomic>
 #include <filesystem>
+#include <fstream>
 
 namespace polyfem::io
 {
@@ -1079,6 +1083,49 @@ namespace polyfem::io
 		}
 	}
 
+	AsyncParaviewWriter::AsyncParaviewWriter(const bool use_hdf5, AsyncWriter &async_writer)
+		: async_writer_(async_writer), use_hdf5_(use_hdf5)
+	{
+		if (use_hdf5)
+			writer_ = std::make_shared<paraviewo::HDF5VTUWriter>();
+	}
+
+	AsyncParaviewWriter::AsyncParaviewWriter(const std::shared_ptr<HDF5TimeSeriesWriter> &time_series, const double t, AsyncWriter &async_writer)
+		: async_writer_(async_writer), use_hdf5_(true), time_series_(time_series), t_(t)
+	{
+		assert(time_series_ != nullptr);
+	}
+
+	void AsyncParaviewWriter::add_field(const std::string &name, const Eigen::MatrixXd &data)
+	{
+		if (use_hdf5_ && !time_series_)
+			writer_->add_field(name, data);
+		else
+			fields_.emplace_back(name, data);
+		bytes_ += data.size() * sizeof(double);
+	}
+
+	Eigen::MatrixXi AsyncParaviewWriter::to_matrix(const std::vector<std::vector<int>> &cells)
+	{
+		Eigen::MatrixXi res(cells.size(), cells.empty() ? 0 : cells.front().size());
+		for (int i = 0; i < cells.size(); ++i)
+		{
+			if (cells[i].size() != res.cols())
+				log_and_throw_error("Time series output only supports meshes with one cell type, disable the obstacles or the high order output");
+			for (int j = 0; j < res.cols(); ++j)
+				res(i, j) = cells[i][j];
+		}
+		return res;
+	}
+
+	size_t AsyncParaviewWriter::size_in_bytes(const std::vector<std::vector<int>> &cells)
+	{
+		size_t bytes = 0;
+		for (const auto &c : cells)
+			bytes += c.size() * sizeof(int);
+		return bytes;
+	}
+
 	OutGeometryData::ExportOptions::ExportOptions(const json &args, const bool is_mesh_linear, const bool is_problem_scalar, const bool solve_export_to_file)
 	{
 		volume = args["output"]["paraview"]["volume"];
@@ -1096,6 +1143,7 @@ namespace polyfem::io
 		velocity = args["output"]["paraview"]["options"]["velocity"];
 		acceleration = args["output"]["paraview"]["options"]["acceleration"];
 		forces = args["output"]["paraview"]["options"]["forces"] && !is_problem_scalar;
+		elastic_energy = args["output"]["paraview"]["options"]["elastic_energy"];
 
 		scalar_values = args["output"]["paraview"]["options"]["scalar_values"];
 		tensor_values = args["output"]["paraview"]["options"]["tensor_values"] && !is_problem_scalar;
@@ -1107,6 +1155,18 @@ namespace polyfem::io
 		reorder_output = args["output"]["data"]["advanced"]["reorder_nodes"];
 
 		use_hdf5 = args["output"]["paraview"]["options"]["use_hdf5"];
+		time_series = args["output"]["paraview"]["options"]["time_series"] && solve_export_to_file;
+		for (const json &field : args["output"]["paraview"]["options"]["field_precision"])
+		{
+			HDF5TimeSeriesWriter::FieldFormat format;
+			format.precision = HDF5TimeSeriesWriter::precision_from_string(field["precision"]);
+			if (field["range"].size() == 2)
+			{
+				format.min = field["range"][0];
+				format.max = field["range"][1];
+			}
+			field_formats[field["name"]] = format;
+		}
 
 		this->solve_export_to_file = solve_export_to_file;
 	}
@@ -1191,7 +1251,7 @@ namespace polyfem::io
 			vtm.add_dataset("Wireframe", "data", path_stem + "_wire" + opts.file_extension());
 		if (opts.points)
 			vtm.add_dataset("Points", "data", path_stem + "_points" + opts.file_extension());
-		vtm.save(base_path + ".vtm");
+		async_writer_->push([vtm, path = base_path + ".vtm"]() mutable { vtm.save(path); });
 	}
 
 	void OutGeometryData::save_volume(
@@ -1217,63 +1277,26 @@ namespace polyfem::io
 		const mesh::Obstacle &obstacle = state.obstacle;
 		const assembler::Problem &problem = *state.problem;
 
-		Eigen::MatrixXd points;
-		Eigen::MatrixXi tets;
-		Eigen::MatrixXi el_id;
-		Eigen::MatrixXd discr;
-		std::vector<std::vector<int>> elements;
-
-		if (opts.use_sampler)
-			build_vis_mesh(mesh, disc_orders, gbases,
-						   state.polys, state.polys_3d, opts.boundary_only,
-						   points, tets, el_id, discr);
-		else
-			build_high_order_vis_mesh(mesh, disc_orders, bases,
-									  points, elements, el_id, discr);
+		const VisCache &cache = vis_cache(state, opts);
+		// copies, the obstacle is appended to them
+		Eigen::MatrixXd points = cache.points;
+		Eigen::MatrixXi tets = cache.tets;
+		const Eigen::MatrixXi &el_id = cache.el_id;
+		Eigen::MatrixXd discr = cache.discr;
+		std::vector<std::vector<int>> elements = cache.elements;
 
 		Eigen::MatrixXd fun, exact_fun, err, node_fun;
 
 		if (opts.sol_on_grid)
 		{
 			const int problem_dim = problem.is_scalar() ? 1 : mesh.dimension();
-			Eigen::MatrixXd tmp, tmp_grad;
-			Eigen::MatrixXd tmp_p, tmp_grad_p;
-			Eigen::MatrixXd res(grid_points_to_elements.size(), problem_dim);
-			res.setConstant(std::numeric_limits<double>::quiet_NaN());
-			Eigen::MatrixXd res_grad(grid_points_to_elements.size(), problem_dim * problem_dim);
-			res_grad.setConstant(std::numeric_limits<double>::quiet_NaN());
-
-			Eigen::MatrixXd res_p(grid_points_to_elements.size(), 1);
-			res_p.setConstant(std::numeric_limits<double>::quiet_NaN());
-			Eigen::MatrixXd res_grad_p(grid_points_to_elements.size(), problem_dim);
-			res_grad_p.setConstant(std::numeric_limits<double>::quiet_NaN());
-
-			for (int i = 0; i < grid_points_to_elements.size(); ++i)
-			{
-				const int el_id = grid_points_to_elements(i);
-				if (el_id < 0)
-					continue;
-				assert(mesh.is_simplex(el_id));
-				const Eigen::MatrixXd bc = grid_points_bc.row(i);
-				Eigen::MatrixXd pt(1, bc.cols() - 1);
-				for (int d = 1; d < bc.cols(); ++d)
-					pt(d - 1) = bc(d);
-				Evaluator::interpolate_at_local_vals(
-					mesh, problem.is_scalar(), bases, gbases,
-					el_id, pt, sol, tmp, tmp_grad);
-
-				res.row(i) = tmp;
-				res_grad.row(i) = tmp_grad;
+			Eigen::MatrixXd res, res_grad, res_p, res_grad_p;
 
-				if (state.mixed_assembler != nullptr)
-				{
-					Evaluator::interpolate_at_local_vals(
-						mesh, 1, pressure_bases, gbases,
-						el_id, pt, pressure, tmp_p, tmp_grad_p);
-					res_p.row(i) = tmp_p;
-					res_grad_p.row(i) = tmp_grad_p;
-				}
-			}
+			// the points are located once in build_grid
+			assert(grid_probe != nullptr);
+			grid_probe->sample(bases, problem_dim, grid_points_to_elements, grid_points_local, sol, res, res_grad);
+			if (state.mixed_assembler != nullptr)
+				grid_probe->sample(pressure_bases, 1, grid_points_to_elements, grid_points_local, pressure, res_p, res_grad_p);
 
 			std::ofstream os(path + "_sol.txt");
 			os << res;
@@ -1294,18 +1317,11 @@ namespace polyfem::io
 			}
 		}
 
-		Evaluator::interpolate_function(
-			mesh, problem.is_scalar(), bases, state.disc_orders,
-			state.polys, state.polys_3d, ref_element_sampler,
-			points.rows(), sol, fun, opts.use_sampler, opts.boundary_only);
+		interpolate(state, opts, sol, fun);
 
 		{
 			Eigen::MatrixXd tmp = Eigen::VectorXd::LinSpaced(sol.size(), 0, sol.size() - 1);
-
-			Evaluator::interpolate_function(
-				mesh, problem.is_scalar(), bases, state.disc_orders,
-				state.polys, state.polys_3d, ref_element_sampler,
-				points.rows(), tmp, node_fun, opts.use_sampler, opts.boundary_only);
+			interpolate(state, opts, tmp, node_fun);
 		}
 
 		if (obstacle.n_vertices() > 0)
@@ -1334,12 +1350,11 @@ namespace polyfem::io
 			}
 		}
 
-		std::shared_ptr<paraviewo::ParaviewWriter> tmpw;
-		if (opts.use_hdf5)
-			tmpw = std::make_shared<paraviewo::HDF5VTUWriter>();
-		else
-			tmpw = std::make_shared<paraviewo::VTUWriter>();
-		paraviewo::ParaviewWriter &writer = *tmpw;
+		if (opts.time_series && (time_series_ == nullptr || time_series_->path() != path))
+			time_series_ = std::make_shared<HDF5TimeSeriesWriter>(path, 4, opts.field_formats);
+		AsyncParaviewWriter writer = opts.time_series
+										 ? AsyncParaviewWriter(time_series_, t, *async_writer_)
+										 : AsyncParaviewWriter(opts.use_hdf5, *async_writer_);
 
 		if (opts.solve_export_to_file && opts.nodes)
 			writer.add_field("nodes", node_fun);
@@ -1633,6 +1648,24 @@ namespace polyfem::io
 			writer.add_field("body_ids", ids);
 		}
 
+		if (opts.elastic_energy && state.solve_data.elastic_form != nullptr)
+		{
+			// per element, reused from the last evaluation of the solver if it was at sol
+			const Eigen::VectorXd element_energies = state.solve_data.elastic_form->value_per_element(sol);
+
+			Eigen::MatrixXd energies(points.rows(), 1);
+			for (int i = 0; i < points.rows(); ++i)
+				energies(i) = element_energies(el_id(i));
+
+			if (obstacle.n_vertices() > 0)
+			{
+				energies.conservativeResize(energies.size() + obstacle.n_vertices(), 1);
+				energies.bottomRows(obstacle.n_vertices()).setZero();
+			}
+
+			writer.add_field("elastic_energy", energies);
+		}
+
 		// interpolate_function(pts_index, rhs, fun, opts.boundary_only);
 		// writer.add_field("rhs", fun);
 
@@ -1641,10 +1674,7 @@ namespace polyfem::io
 			Eigen::MatrixXd traction_forces, traction_forces_fun;
 			compute_traction_forces(state, sol, t, traction_forces, false);
 
-			Evaluator::interpolate_function(
-				mesh, problem.is_scalar(), bases, state.disc_orders,
-				state.polys, state.polys_3d, ref_element_sampler,
-				points.rows(), traction_forces, traction_forces_fun, opts.use_sampler, opts.boundary_only);
+			interpolate(state, opts, traction_forces, traction_forces_fun);
 
 			if (obstacle.n_vertices() > 0)
 			{
@@ -1662,10 +1692,7 @@ namespace polyfem::io
 				Eigen::MatrixXd potential_grad, potential_grad_fun;
 				state.assembler->assemble_gradient(mesh.is_volume(), state.n_bases, bases, gbases, state.ass_vals_cache, t, dt, sol, sol, potential_grad);
 
-				Evaluator::interpolate_function(
-					mesh, problem.is_scalar(), bases, state.disc_orders,
-					state.polys, state.polys_3d, ref_element_sampler,
-					points.rows(), potential_grad, potential_grad_fun, opts.use_sampler, opts.boundary_only);
+				interpolate(state, opts, potential_grad, potential_grad_fun);
 
 				if (obstacle.n_vertices() > 0)
 				{
@@ -1738,19 +1765,192 @@ namespace polyfem::io
 		}
 	}
 
+	const OutGeometryData::VisCache &OutGeometryData::vis_cache(const State &state, const ExportOptions &opts) const
+	{
+		if (vis_cache_ != nullptr && vis_cache_->use_sampler == opts.use_sampler && vis_cache_->boundary_only == opts.boundary_only)
+			return *vis_cache_;
+
+		POLYFEM_SCOPED_TIMER("Build visualization mesh");
+
+		auto cache = std::make_shared<VisCache>();
+		cache->use_sampler = opts.use_sampler;
+		cache->boundary_only = opts.boundary_only;
+
+		const mesh::Mesh &mesh = *state.mesh;
+		if (opts.use_sampler)
+			build_vis_mesh(mesh, state.disc_orders, state.geom_bases(),
+						   state.polys, state.polys_3d, opts.boundary_only,
+						   cache->points, cache->tets, cache->el_id, cache->discr);
+		else
+			build_high_order_vis_mesh(mesh, state.disc_orders, state.bases,
+									  cache->points, cache->elements, cache->el_id, cache->discr);
+
+		Evaluator::interpolation_operator(
+			mesh, state.bases, state.disc_orders, state.polys, state.polys_3d, ref_element_sampler,
+			cache->points.rows(), state.n_bases, opts.use_sampler, opts.boundary_only, cache->interpolation);
+
+		vis_cache_ = cache;
+		return *vis_cache_;
+	}
+
+	const OutGeometryData::BoundaryVisCache &OutGeometryData::boundary_vis_cache(const State &state) const
+	{
+		if (boundary_vis_cache_ != nullptr)
+			return *boundary_vis_cache_;
+
+		POLYFEM_SCOPED_TIMER("Build boundary visualization mesh");
+
+		auto cache = std::make_shared<BoundaryVisCache>();
+
+		Eigen::MatrixXd local_vertices, normals, displaced_normals;
+		Eigen::MatrixXi el_ids, primitive_ids;
+		const int problem_dim = state.problem->is_scalar() ? 1 : state.mesh->dimension();
+		build_vis_boundary_mesh(*state.mesh, state.bases, state.geom_bases(), state.total_local_boundary, Eigen::MatrixXd(), problem_dim,
+								cache->vertices, local_vertices, cache->faces, el_ids, primitive_ids, normals, displaced_normals);
+
+		// the vertices of a boundary primitive are contiguous, their bases are evaluated together
+		std::vector<int> runs = {0};
+		for (int i = 1; i <= el_ids.size(); ++i)
+		{
+			if (i == el_ids.size() || el_ids(i) != el_ids(i - 1))
+				runs.push_back(i);
+		}
+
+		auto storage = utils::create_thread_storage(std::vector<Eigen::Triplet<double>>());
+		utils::maybe_parallel_for(runs.size() - 1, [&](int start, int end, int thread_id) {
+			std::vector<Eigen::Triplet<double>> &entries = utils::get_local_thread_storage(storage, thread_id);
+			std::vector<assembler::AssemblyValues> tmp;
+			Eigen::MatrixXd local_pts;
+
+			for (int r = start; r < end; ++r)
+			{
+				const basis::ElementBases &bs = state.bases[el_ids(runs[r])];
+				local_pts = local_vertices.middleRows(runs[r], runs[r + 1] - runs[r]);
+
+				bs.evaluate_bases(local_pts, tmp);
+				for (size_t j = 0; j < bs.bases.size(); ++j)
+				{
+					for (const basis::Local2Global &g : bs.bases[j].global())
+					{
+						for (int p = 0; p < local_pts.rows(); ++p)
+							entries.emplace_back(runs[r] + p, g.index, g.val * tmp[j].val(p));
+					}
+				}
+			}
+		});
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (const auto &local_entries : storage)
+			entries.insert(entries.end(), local_entries.begin(), local_entries.end());
+
+		cache->interpolation.resize(cache->vertices.rows(), state.n_bases);
+		cache->interpolation.setFromTriplets(entries.begin(), entries.end());
+		cache->interpolation.makeCompressed();
+
+		boundary_vis_cache_ = cache;
+		return *boundary_vis_cache_;
+	}
+
+	void OutGeometryData::save_render(
+		const std::string &path,
+		const State &state,
+		const Eigen::MatrixXd &sol,
+		const json &render_args) const
+	{
+		if (!state.mesh->is_volume())
+		{
+			logger().warn("Rendering is only supported for volumetric meshes, skipping {}", path);
+			return;
+		}
+		if (sol.size() <= 0)
+		{
+			logger().error("Solve the problem first!");
+			return;
+		}
+
+		const BoundaryVisCache &cache = boundary_vis_cache(state);
+		const bool is_scalar = state.problem->is_scalar();
+		const int actual_dim = is_scalar ? 1 : 3;
+
+		const Eigen::MatrixXd values = cache.interpolation * utils::unflatten(sol.col(0).head(cache.interpolation.cols() * actual_dim), actual_dim);
+
+		// the scalar solutions are drawn on the rest shape
+		Eigen::MatrixXd vertices = cache.vertices;
+		if (!is_scalar)
+			vertices += values;
+
+		Eigen::MatrixXd colors;
+		if (render_args["field"] == "solution")
+		{
+			const Eigen::VectorXd field = is_scalar ? Eigen::VectorXd(values.col(0)) : Eigen::VectorXd(values.rowwise().norm());
+			const std::vector<double> range = render_args["range"];
+			const double min = range.size() == 2 ? range[0] : field.minCoeff();
+			const double max = range.size() == 2 ? range[1] : field.maxCoeff();
+			igl::colormap(igl::COLOR_MAP_TYPE_VIRIDIS, field, min, max > min ? max : min + 1, colors);
+		}
+
+		// the camera is framing the rest shape unless specified
+		const Eigen::Vector3d bbox_min = cache.vertices.colwise().minCoeff();
+		const Eigen::Vector3d bbox_max = cache.vertices.colwise().maxCoeff();
+		const json &camera = render_args["camera"];
+		const double fov = camera["fov"];
+		const auto to_vector = [](const json &v) { return Eigen::Vector3d(v[0].get<double>(), v[1].get<double>(), v[2].get<double>()); };
+
+		Eigen::Vector3d lookat = (bbox_min + bbox_max) / 2;
+		if (camera["lookat"].size() == 3)
+			lookat = to_vector(camera["lookat"]);
+
+		Eigen::Vector3d position = lookat + Eigen::Vector3d(0, 0, 1.2 * (bbox_max - bbox_min).norm() / (2 * std::tan(fov / 2)));
+		if (camera["position"].size() == 3)
+			position = to_vector(camera["position"]);
+
+		const Eigen::Vector3d up = to_vector(camera["up"]);
+
+		// a light at the camera, the shading divides by the squared distance
+		std::vector<std::pair<Eigen::MatrixXd, Eigen::MatrixXd>> lights;
+		lights.emplace_back(position, Eigen::Vector3d::Constant(0.8 * (position - lookat).squaredNorm()));
+
+		std::vector<renderer::Material> materials(1);
+		materials[0].diffuse_color << 0.8, 0.8, 0.8;
+		materials[0].specular_color << 0.1, 0.1, 0.1;
+		materials[0].specular_exponent = 20;
+
+		const double distance = (position - lookat).norm();
+		const int width = render_args["width"];
+		const int height = render_args["height"];
+		const std::vector<uint8_t> image = renderer::render(
+			vertices, cache.faces, Eigen::MatrixXi(), width, height,
+			position, fov, 1e-3 * distance, 1e3 * distance, camera["perspective"], lookat, up,
+			Eigen::Vector3d::Constant(0.2), lights, materials, colors);
+
+		renderer::write_png(path, image, width, height);
+	}
+
+	void OutGeometryData::interpolate(const State &state, const ExportOptions &opts, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result) const
+	{
+		if (fun.size() <= 0)
+		{
+			logger().error("Solve the problem first!");
+			return;
+		}
+
+		const int actual_dim = state.problem->is_scalar() ? 1 : state.mesh->dimension();
+		const StiffnessMatrix &interpolation = vis_cache(state, opts).interpolation;
+		assert(fun.size() >= interpolation.cols() * actual_dim);
+
+		result = interpolation * utils::unflatten(fun.col(0).head(interpolation.cols() * actual_dim), actual_dim);
+	}
+
 	void OutGeometryData::save_volume_vector_field(
 		const State &state,
 		const Eigen::MatrixXd &points,
 		const ExportOptions &opts,
 		const std::string &name,
 		const Eigen::VectorXd &field,
-		paraviewo::ParaviewWriter &writer) const
+		AsyncParaviewWriter &writer) const
 	{
 		Eigen::MatrixXd inerpolated_field;
-		Evaluator::interpolate_function(
-			*state.mesh, state.problem->is_scalar(), state.bases, state.disc_orders,
-			state.polys, state.polys_3d, ref_element_sampler,
-			points.rows(), field, inerpolated_field, opts.use_sampler, opts.boundary_only);
+		interpolate(state, opts, field, inerpolated_field);
 
 		if (state.obstacle.n_vertices() > 0)
 		{
@@ -1883,12 +2083,7 @@ namespace polyfem::io
 			}
 		}
 
-		std::shared_ptr<paraviewo::ParaviewWriter> tmpw;
-		if (opts.use_hdf5)
-			tmpw = std::make_shared<paraviewo::HDF5VTUWriter>();
-		else
-			tmpw = std::make_shared<paraviewo::VTUWriter>();
-		paraviewo::ParaviewWriter &writer = *tmpw;
+		AsyncParaviewWriter writer(opts.use_hdf5, *async_writer_);
 
 		if (opts.solve_export_to_file)
 		{
@@ -1987,12 +2182,7 @@ namespace polyfem::io
 
 		if (opts.solve_export_to_file)
 		{
-			std::shared_ptr<paraviewo::ParaviewWriter> tmpw;
-			if (opts.use_hdf5)
-				tmpw = std::make_shared<paraviewo::HDF5VTUWriter>();
-			else
-				tmpw = std::make_shared<paraviewo::VTUWriter>();
-			paraviewo::ParaviewWriter &writer = *tmpw;
+			AsyncParaviewWriter writer(opts.use_hdf5, *async_writer_);
 
 			const int problem_dim = mesh.dimension();
 			const Eigen::MatrixXd full_displacements = utils::unflatten(sol, problem_dim);
@@ -2218,12 +2408,7 @@ namespace polyfem::io
 			err = (fun - exact_fun).eval().rowwise().norm();
 		}
 
-		std::shared_ptr<paraviewo::ParaviewWriter> tmpw;
-		if (opts.use_hdf5)
-			tmpw = std::make_shared<paraviewo::HDF5VTUWriter>();
-		else
-			tmpw = std::make_shared<paraviewo::VTUWriter>();
-		paraviewo::ParaviewWriter &writer = *tmpw;
+		AsyncParaviewWriter writer(opts.use_hdf5, *async_writer_);
 
 		if (problem.has_exact_sol())
 		{
@@ -2288,12 +2473,7 @@ namespace polyfem::io
 			cells[i].push_back(i);
 		}
 
-		std::shared_ptr<paraviewo::ParaviewWriter> tmpw;
-		if (opts.use_hdf5)
-			tmpw = std::make_shared<paraviewo::HDF5VTUWriter>();
-		else
-			tmpw = std::make_shared<paraviewo::VTUWriter>();
-		paraviewo::ParaviewWriter &writer = *tmpw;
+		AsyncParaviewWriter writer(opts.use_hdf5, *async_writer_);
 
 		if (opts.solve_export_to_file)
 		{
@@ -2309,7 +2489,30 @@ namespace polyfem::io
 		const std::function<std::string(int)> &vtu_names,
 		int time_steps, double t0, double dt, int skip_frame) const
 	{
-		paraviewo::PVDWriter::save_pvd(name, vtu_names, time_steps, t0, dt, skip_frame);
+		async_writer_->push([=]() { paraviewo::PVDWriter::save_pvd(name, vtu_names, time_steps, t0, dt, skip_frame); });
+	}
+
+	void OutGeometryData::save_pvd(
+		const std::string &name,
+		const std::function<std::string(int)> &vtu_names,
+		const std::vector<double> &times, int skip_frame) const
+	{
+		// same layout as paraviewo::PVDWriter, with the given times instead of t0 + i * dt
+		async_writer_->push([=]() {
+			std::ofstream os(name);
+			if (!os.is_open())
+			{
+				logger().error("Unable to write {}", name);
+				return;
+			}
+			os << "<?xml version=\"1.0\"?>\n";
+			os << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\" compressor=\"vtkZLibDataCompressor\">\n";
+			os << "<Collection>\n";
+			for (int i = 0; i < times.size(); i += skip_frame)
+				os << fmt::format("<DataSet timestep=\"{}\" group=\"\" part=\"0\" file=\"{}\"/>\n", times[i], vtu_names(i));
+			os << "</Collection>\n";
+			os << "</VTKFile>";
+		});
 	}
 
 	void OutGeometryData::init_sampler(const polyfem::mesh::Mesh &mesh, const double vismesh_rel_area)
@@ -2317,8 +2520,9 @@ namespace polyfem::io
 		ref_element_sampler.init(mesh.is_volume(), mesh.n_elements(), vismesh_rel_area);
 	}
 
-	void OutGeometryData::build_grid(const polyfem::mesh::Mesh &mesh, const double spacing)
+	void OutGeometryData::build_grid(const polyfem::mesh::Mesh &mesh, const std::vector<basis::ElementBases> &gbases, const double spacing)
 	{
+		grid_probe = nullptr;
 		if (spacing <= 0)
 			return;
 
@@ -2357,72 +2561,32 @@ namespace polyfem::io
 
 		assert(index == n);
 
-		std::vector<std::array<Eigen::Vector3d, 2>> boxes;
-		mesh.elements_boxes(boxes);
-
-		SimpleBVH::BVH bvh;
-		bvh.init(boxes);
-
-		const double eps = 1e-6;
-
-		grid_points_to_elements.resize(grid_points.rows(), 1);
-		grid_points_to_elements.setConstant(-1);
-
-		grid_points_bc.resize(grid_points.rows(), mesh.is_volume() ? 4 : 3);
-
-		for (int i = 0; i < grid_points.rows(); ++i)
-		{
-			const Eigen::Vector3d min(
-				grid_points(i, 0) - eps,
-				grid_points(i, 1) - eps,
-				(mesh.is_volume() ? grid_points(i, 2) : 0) - eps);
-
-			const Eigen::Vector3d max(
-				grid_points(i, 0) + eps,
-				grid_points(i, 1) + eps,
-				(mesh.is_volume() ? grid_points(i, 2) : 0) + eps);
-
-			std::vector<unsigned int> candidates;
-
-			bvh.intersect_box(min, max, candidates);
-
-			for (const auto cand : candidates)
-			{
-				if (!mesh.is_simplex(cand))
-				{
-					logger().warn("Element {} is not simplex, skipping", cand);
-					continue;
-				}
-
-				Eigen::MatrixXd coords;
-				mesh.barycentric_coords(grid_points.row(i), cand, coords);
-
-				for (int d = 0; d < coords.size(); ++d)
-				{
-					if (fabs(coords(d)) < 1e-8)
-						coords(d) = 0;
-					else if (fabs(coords(d) - 1) < 1e-8)
-						coords(d) = 1;
-				}
-
-				if (coords.array().minCoeff() >= 0 && coords.array().maxCoeff() <= 1)
-				{
-					grid_points_to_elements(i) = cand;
-					grid_points_bc.row(i) = coords;
-					break;
-				}
-			}
-		}
+		grid_probe = std::make_shared<PointProbe>();
+		grid_probe->init(mesh, gbases);
+		grid_probe->locate(grid_points, grid_points_to_elements, grid_points_local);
 	}
 
 	void OutStatsData::compute_mesh_size(const polyfem::mesh::Mesh &mesh_in, const std::vector<polyfem::basis::ElementBases> &bases_in, const int n_samples, const bool use_curved_mesh_size)
 	{
-		Eigen::MatrixXd samples_simplex, samples_cube, mapped, p0, p1, p;
+		Eigen::MatrixXd samples_simplex, samples_cube, p0, p1, p;
 
 		mesh_size = 0;
 		average_edge_length = 0;
 		min_edge_length = std::numeric_limits<double>::max();
 
+		element_sizes.resize(mesh_in.n_elements());
+		utils::maybe_parallel_for(mesh_in.n_elements(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+			{
+				const std::vector<int> vids = mesh_in.element_vertices(e);
+				double h = std::numeric_limits<double>::max();
+				for (size_t i = 0; i < vids.size(); ++i)
+					for (size_t j = i + 1; j < vids.size(); ++j)
+						h = std::min(h, (mesh_in.point(vids[i]) - mesh_in.point(vids[j])).norm());
+				element_sizes(e) = h;
+			}
+		});
+
 		if (!use_curved_mesh_size)
 		{
 			mesh_in.get_edges(p0, p1);
@@ -2449,41 +2613,56 @@ namespace polyfem::io
 			utils::EdgeSampler::sample_2d_cube(n_samples, samples_cube);
 		}
 
-		int n = 0;
-		for (size_t i = 0; i < bases_in.size(); ++i)
+		struct LocalEdgeStats
 		{
-			if (mesh_in.is_polytope(i))
-				continue;
-			int n_edges;
+			double max = 0;
+			double min = std::numeric_limits<double>::max();
+			double sum = 0;
+			int n = 0;
+		};
+		auto storage = utils::create_thread_storage(LocalEdgeStats());
+		utils::maybe_parallel_for(bases_in.size(), [&](int start, int end, int thread_id) {
+			LocalEdgeStats &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			Eigen::MatrixXd mapped;
 
-			if (mesh_in.is_simplex(i))
-			{
-				n_edges = mesh_in.is_volume() ? 6 : 3;
-				bases_in[i].eval_geom_mapping(samples_simplex, mapped);
-			}
-			else
+			for (int i = start; i < end; ++i)
 			{
-				n_edges = mesh_in.is_volume() ? 12 : 4;
-				bases_in[i].eval_geom_mapping(samples_cube, mapped);
-			}
+				if (mesh_in.is_polytope(i))
+					continue;
+				int n_edges;
 
-			for (int j = 0; j < n_edges; ++j)
-			{
-				double current_edge = 0;
-				for (int k = 0; k < n_samples - 1; ++k)
+				if (mesh_in.is_simplex(i))
 				{
-					p0 = mapped.row(j * n_samples + k);
-					p1 = mapped.row(j * n_samples + k + 1);
-					p = p0 - p1;
-
-					current_edge += p.norm();
+					n_edges = mesh_in.is_volume() ? 6 : 3;
+					bases_in[i].eval_geom_mapping(samples_simplex, mapped);
+				}
+				else
+				{
+					n_edges = mesh_in.is_volume() ? 12 : 4;
+					bases_in[i].eval_geom_mapping(samples_cube, mapped);
 				}
 
-				mesh_size = std::max(current_edge, mesh_size);
-				min_edge_length = std::min(current_edge, min_edge_length);
-				average_edge_length += current_edge;
-				++n;
+				for (int j = 0; j < n_edges; ++j)
+				{
+					double current_edge = 0;
+					for (int k = 0; k < n_samples - 1; ++k)
+						current_edge += (mapped.row(j * n_samples + k) - mapped.row(j * n_samples + k + 1)).norm();
+
+					local_storage.max = std::max(current_edge, local_storage.max);
+					local_storage.min = std::min(current_edge, local_storage.min);
+					local_storage.sum += current_edge;
+					++local_storage.n;
+				}
 			}
+		});
+
+		int n = 0;
+		for (const LocalEdgeStats &local_storage : storage)
+		{
+			mesh_size = std::max(mesh_size, local_storage.max);
+			min_edge_length = std::min(min_edge_length, local_storage.min);
+			average_edge_length += local_storage.sum;
+			n += local_storage.n;
 		}
 
 		average_edge_length /= n;
@@ -2502,6 +2681,65 @@ namespace polyfem::io
 		n_flipped = 0;
 	}
 
+	void OutStatsData::add_solver_info(const json &entry)
+	{
+		const std::string type = entry.contains("type") ? entry["type"].get<std::string>() : "unknown";
+		json &summary = solver_info_summary[type];
+		if (!summary.is_object())
+			summary = json::object();
+		summary["count"] = summary.value("count", 0) + 1;
+
+		json compact = json::object();
+		for (const auto &[key, value] : entry.items())
+			if (!value.is_structured())
+				compact[key] = value;
+		if (entry.contains("info") && entry["info"].is_object())
+		{
+			for (const auto &[key, value] : entry["info"].items())
+			{
+				if (value.is_structured())
+					continue;
+				compact[key] = value;
+				// the iterations and times add up over the subsolves
+				if (!value.is_number() || (key != "iterations" && key.find("time") == std::string::npos))
+					continue;
+				if (value.is_number_integer())
+					summary[key] = summary.value(key, 0LL) + value.get<long long>();
+				else
+					summary[key] = summary.value(key, 0.0) + value.get<double>();
+			}
+		}
+
+		// flushed so that the records of a run that does not finish are kept
+		if (solver_info_file_)
+			*solver_info_file_ << compact.dump() << std::endl;
+
+		if (!solver_info.is_array())
+			solver_info = json::array();
+		solver_info.push_back(entry);
+		if (max_solver_info_entries_ > 0 && solver_info.size() > size_t(max_solver_info_entries_))
+			solver_info.erase(solver_info.begin(), solver_info.begin() + (solver_info.size() - max_solver_info_entries_));
+	}
+
+	void OutStatsData::set_solver_info_stream(const std::string &path, const int max_entries)
+	{
+		max_solver_info_entries_ = max_entries;
+		if (path == solver_info_path_)
+			return;
+
+		solver_info_path_ = path;
+		solver_info_file_ = nullptr;
+		if (path.empty())
+			return;
+
+		solver_info_file_ = std::make_shared<std::ofstream>(path);
+		if (!solver_info_file_->good())
+		{
+			logger().error("Unable to open the solver info stream {}", path);
+			solver_info_file_ = nullptr;
+		}
+	}
+
 	void OutStatsData::count_flipped_elements(const polyfem::mesh::Mesh &mesh, const std::vector<polyfem::basis::ElementBases> &gbases)
 	{
 		using namespace mesh;
@@ -2509,33 +2747,45 @@ namespace polyfem::io
 		logger().info("Counting flipped elements...");
 		const auto &els_tag = mesh.elements_tag();
 
-		// flipped_elements.clear();
-		for (size_t i = 0; i < gbases.size(); ++i)
-		{
-			if (mesh.is_polytope(i))
-				continue;
-
+		// the first flipped element is reported, whatever the thread that found it
+		std::atomic<int> first_flipped(std::numeric_limits<int>::max());
+		std::atomic<int> n_new_flipped(0);
+		utils::maybe_parallel_for(gbases.size(), [&](int start, int end, int thread_id) {
 			polyfem::assembler::ElementAssemblyValues vals;
-			if (!vals.is_geom_mapping_positive(mesh.is_volume(), gbases[i]))
+			for (int i = start; i < end; ++i)
 			{
-				++n_flipped;
-
-				static const std::vector<std::string> element_type_names{{
-					"Simplex",
-					"RegularInteriorCube",
-					"RegularBoundaryCube",
-					"SimpleSingularInteriorCube",
-					"MultiSingularInteriorCube",
-					"SimpleSingularBoundaryCube",
-					"InterfaceCube",
-					"MultiSingularBoundaryCube",
-					"BoundaryPolytope",
-					"InteriorPolytope",
-					"Undefined",
-				}};
+				if (mesh.is_polytope(i))
+					continue;
 
-				log_and_throw_error("element {} is flipped, type {}", i, element_type_names[static_cast<int>(els_tag[i])]);
+				if (!vals.is_geom_mapping_positive(mesh.is_volume(), gbases[i]))
+				{
+					++n_new_flipped;
+					int prev = first_flipped.load();
+					while (i < prev && !first_flipped.compare_exchange_weak(prev, i))
+						;
+				}
 			}
+		});
+		n_flipped += n_new_flipped;
+
+		if (n_new_flipped > 0)
+		{
+			static const std::vector<std::string> element_type_names{{
+				"Simplex",
+				"RegularInteriorCube",
+				"RegularBoundaryCube",
+				"SimpleSingularInteriorCube",
+				"MultiSingularInteriorCube",
+				"SimpleSingularBoundaryCube",
+				"InterfaceCube",
+				"MultiSingularBoundaryCube",
+				"BoundaryPolytope",
+				"InteriorPolytope",
+				"Undefined",
+			}};
+
+			const int i = first_flipped;
+			log_and_throw_error("element {} is flipped, type {} ({} flipped elements)", i, element_type_names[static_cast<int>(els_tag[i])], int(n_new_flipped));
 		}
 
 		logger().info(" done");
@@ -2554,7 +2804,8 @@ namespace polyfem::io
 		const polyfem::mesh::Mesh &mesh,
 		const assembler::Problem &problem,
 		const double tend,
-		const Eigen::MatrixXd &sol)
+		const Eigen::MatrixXd &sol,
+		const assembler::AssemblyValsCache *ass_vals_cache)
 	{
 		if (n_bases <= 0)
 		{
@@ -2578,106 +2829,88 @@ namespace polyfem::io
 
 		const int n_el = int(bases.size());
 
-		Eigen::MatrixXd v_exact, v_approx;
-		Eigen::MatrixXd v_exact_grad(0, 0), v_approx_grad;
-
 		l2_err = 0;
 		h1_err = 0;
 		grad_max_err = 0;
 		h1_semi_err = 0;
 		linf_err = 0;
 		lp_err = 0;
-		// double pred_norm = 0;
 
 		static const int p = 8;
 
-		// Eigen::MatrixXd err_per_el(n_el, 5);
-		polyfem::assembler::ElementAssemblyValues vals;
-
-		for (int e = 0; e < n_el; ++e)
+		struct LocalErrors
 		{
-			vals.compute(e, mesh.is_volume(), bases[e], gbases[e]);
-
-			if (problem.has_exact_sol())
-			{
-				problem.exact(vals.val, tend, v_exact);
-				problem.exact_grad(vals.val, tend, v_exact_grad);
-			}
-
-			v_approx.resize(vals.val.rows(), actual_dim);
-			v_approx.setZero();
+			polyfem::assembler::ElementAssemblyValues vals;
+			double l2 = 0;
+			double h1 = 0;
+			double lp = 0;
+			double linf = 0;
+			double grad_max = 0;
+		};
+		auto storage = utils::create_thread_storage(LocalErrors());
+		// the cache of the stiffness uses the same quadrature as ElementAssemblyValues::compute
+		const bool use_cache = ass_vals_cache != nullptr && ass_vals_cache->is_initialized() && !ass_vals_cache->is_mass();
 
-			v_approx_grad.resize(vals.val.rows(), mesh.dimension() * actual_dim);
-			v_approx_grad.setZero();
+		utils::maybe_parallel_for(n_el, [&](int start, int end, int thread_id) {
+			LocalErrors &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
-			const int n_loc_bases = int(vals.basis_values.size());
+			Eigen::MatrixXd v_exact, v_approx;
+			Eigen::MatrixXd v_exact_grad(0, 0), v_approx_grad;
 
-			for (int i = 0; i < n_loc_bases; ++i)
+			for (int e = start; e < end; ++e)
 			{
-				const auto &val = vals.basis_values[i];
+				if (!use_cache)
+					local_storage.vals.compute(e, mesh.is_volume(), bases[e], gbases[e]);
+				const polyfem::assembler::ElementAssemblyValues &vals = use_cache ? ass_vals_cache->get(e, mesh.is_volume(), bases[e], gbases[e], local_storage.vals) : local_storage.vals;
 
-				for (size_t ii = 0; ii < val.global.size(); ++ii)
+				if (problem.has_exact_sol())
 				{
-					for (int d = 0; d < actual_dim; ++d)
-					{
-						v_approx.col(d) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.val;
-						v_approx_grad.block(0, d * val.grad_t_m.cols(), v_approx_grad.rows(), val.grad_t_m.cols()) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.grad_t_m;
-					}
+					problem.exact(vals.val, tend, v_exact);
+					problem.exact_grad(vals.val, tend, v_exact_grad);
 				}
-			}
-
-			const auto err = problem.has_exact_sol() ? (v_exact - v_approx).eval().rowwise().norm().eval() : (v_approx).eval().rowwise().norm().eval();
-			const auto err_grad = problem.has_exact_sol() ? (v_exact_grad - v_approx_grad).eval().rowwise().norm().eval() : (v_approx_grad).eval().rowwise().norm().eval();
 
-			// for(long i = 0; i < err.size(); ++i)
-			// errors.push_back(err(i));
+				v_approx.resize(vals.val.rows(), actual_dim);
+				v_approx.setZero();
 
-			linf_err = std::max(linf_err, err.maxCoeff());
-			grad_max_err = std::max(linf_err, err_grad.maxCoeff());
+				v_approx_grad.resize(vals.val.rows(), mesh.dimension() * actual_dim);
+				v_approx_grad.setZero();
 
-			// {
-			// 	const auto &mesh3d = *dynamic_cast<Mesh3D *>(mesh.get());
-			// 	const auto v0 = mesh3d.point(mesh3d.cell_vertex(e, 0));
-			// 	const auto v1 = mesh3d.point(mesh3d.cell_vertex(e, 1));
-			// 	const auto v2 = mesh3d.point(mesh3d.cell_vertex(e, 2));
-			// 	const auto v3 = mesh3d.point(mesh3d.cell_vertex(e, 3));
+				const int n_loc_bases = int(vals.basis_values.size());
 
-			// 	Eigen::Matrix<double, 6, 3> ee;
-			// 	ee.row(0) = v0 - v1;
-			// 	ee.row(1) = v1 - v2;
-			// 	ee.row(2) = v2 - v0;
-
-			// 	ee.row(3) = v0 - v3;
-			// 	ee.row(4) = v1 - v3;
-			// 	ee.row(5) = v2 - v3;
-
-			// 	Eigen::Matrix<double, 6, 1> en = ee.rowwise().norm();
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					const auto &val = vals.basis_values[i];
 
-			// 	// Eigen::Matrix<double, 3*4, 1> alpha;
-			// 	// alpha(0) = angle3(e.row(0), -e.row(1));	 	alpha(1) = angle3(e.row(1), -e.row(2));	 	alpha(2) = angle3(e.row(2), -e.row(0));
-			// 	// alpha(3) = angle3(e.row(0), -e.row(4));	 	alpha(4) = angle3(e.row(4), e.row(3));	 	alpha(5) = angle3(-e.row(3), -e.row(0));
-			// 	// alpha(6) = angle3(-e.row(4), -e.row(1));	alpha(7) = angle3(e.row(1), -e.row(5));	 	alpha(8) = angle3(e.row(5), e.row(4));
-			// 	// alpha(9) = angle3(-e.row(2), -e.row(5));	alpha(10) = angle3(e.row(5), e.row(3));		alpha(11) = angle3(-e.row(3), e.row(2));
+					for (size_t ii = 0; ii < val.global.size(); ++ii)
+					{
+						for (int d = 0; d < actual_dim; ++d)
+						{
+							v_approx.col(d) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.val;
+							v_approx_grad.block(0, d * val.grad_t_m.cols(), v_approx_grad.rows(), val.grad_t_m.cols()) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.grad_t_m;
+						}
+					}
+				}
 
-			// 	const double S = (ee.row(0).cross(ee.row(1)).norm() + ee.row(0).cross(ee.row(4)).norm() + ee.row(4).cross(ee.row(1)).norm() + ee.row(2).cross(ee.row(5)).norm()) / 2;
-			// 	const double V = std::abs(ee.row(3).dot(ee.row(2).cross(-ee.row(0))))/6;
-			// 	const double rho = 3 * V / S;
-			// 	const double hp = en.maxCoeff();
-			// 	const int pp = disc_orders(e);
-			// 	const int p_ref = args["space"]["discr_order"];
+				const auto err = problem.has_exact_sol() ? (v_exact - v_approx).eval().rowwise().norm().eval() : (v_approx).eval().rowwise().norm().eval();
+				const auto err_grad = problem.has_exact_sol() ? (v_exact_grad - v_approx_grad).eval().rowwise().norm().eval() : (v_approx_grad).eval().rowwise().norm().eval();
 
-			// 	err_per_el(e, 0) = err.mean();
-			// 	err_per_el(e, 1) = err.maxCoeff();
-			// 	err_per_el(e, 2) = std::pow(hp, pp+1)/(rho/hp); // /std::pow(average_edge_length, p_ref+1) * (sqrt(6)/12);
-			// 	err_per_el(e, 3) = rho/hp;
-			// 	err_per_el(e, 4) = (vals.det.array() * vals.quadrature.weights.array()).sum();
+				local_storage.linf = std::max(local_storage.linf, err.maxCoeff());
+				local_storage.grad_max = std::max(local_storage.grad_max, err_grad.maxCoeff());
 
-			// 	// pred_norm += (pow(std::pow(hp, pp+1)/(rho/hp),p) * vals.det.array() * vals.quadrature.weights.array()).sum();
-			// }
+				const Eigen::ArrayXd da = vals.det.array() * vals.quadrature.weights.array();
+				local_storage.l2 += (err.array() * err.array() * da).sum();
+				local_storage.h1 += (err_grad.array() * err_grad.array() * da).sum();
+				local_storage.lp += (err.array().pow(p) * da).sum();
+			}
+		});
 
-			l2_err += (err.array() * err.array() * vals.det.array() * vals.quadrature.weights.array()).sum();
-			h1_err += (err_grad.array() * err_grad.array() * vals.det.array() * vals.quadrature.weights.array()).sum();
-			lp_err += (err.array().pow(p) * vals.det.array() * vals.quadrature.weights.array()).sum();
+		for (const LocalErrors &local_storage : storage)
+		{
+			l2_err += local_storage.l2;
+			h1_err += local_storage.h1;
+			lp_err += local_storage.lp;
+			linf_err = std::max(linf_err, local_storage.linf);
+			grad_max_err = std::max(grad_max_err, local_storage.grad_max);
 		}
 
 		h1_semi_err = sqrt(fabs(h1_err));
@@ -2849,6 +3082,7 @@ namespace polyfem::io
 		// j["time_computing_errors"] = runtime.computing_errors_time;
 
 		j["solver_info"] = solver_info;
+		j["solver_info_summary"] = solver_info_summary;
 
 		j["count_simplex"] = simplex_count;
 		j["count_regular"] = regular_count;
@@ -2864,6 +3098,10 @@ namespace polyfem::io
 		j["is_simplicial"] = mesh.n_elements() == simplex_count;
 
 		j["peak_memory"] = getPeakRSS() / (1024 * 1024);
+		j["memory"] = memory;
+
+		if (utils::Profiler::get().enabled())
+			j["profile"] = utils::Profiler::get().summary();
 
 		const int actual_dim = problem.is_scalar() ? 1 : mesh.dimension();
 
@@ -2922,7 +3160,13 @@ namespace polyfem::io
 		{
 			file << name << ",";
 		}
-		file << "total_energy" << std::endl;
+		file << "total_energy";
+		// time spent in the forms by the nonlinear problem up to this step
+		for (const auto &[name, _] : solve_data.named_forms())
+		{
+			file << "," << name << "_value_time," << name << "_gradient_time," << name << "_hessian_time";
+		}
+		file << std::endl;
 	}
 
 	EnergyCSVWriter::~EnergyCSVWriter()
@@ -2935,13 +3179,24 @@ namespace polyfem::io
 		const double s = solve_data.time_integrator
 							 ? solve_data.time_integrator->acceleration_scaling()
 							 : 1;
+		const solver::FullNLProblem &nl_problem = *solve_data.nl_problem;
+		const Eigen::VectorXd x = sol;
+
 		file << i << ",";
 		for (const auto &[_, form] : solve_data.named_forms())
 		{
+			// the values computed by the solver at the last iterate are reused, and evaluated only if not kept
 			// Divide by acceleration scaling to get the energy (units of J)
-			file << ((form && form->enabled()) ? form->value(sol) : 0) / s << ",";
+			file << ((form && form->enabled()) ? nl_problem.form_value(*form, x) : 0) / s << ",";
+		}
+		file << nl_problem.kept_value(x) / s;
+		for (const auto &[_, form] : solve_data.named_forms())
+		{
+			const solver::FullNLProblem::FormTimings timings = form ? nl_problem.form_timings(*form) : solver::FullNLProblem::FormTimings();
+			// the combined evaluations are counted as hessian
+			file << "," << timings.value.time << "," << timings.gradient.time << "," << timings.hessian.time + timings.value_gradient_hessian.time;
 		}
-		file << solve_data.nl_problem->value(sol) / s << "\n";
+		file << "\n";
 		file.flush();
 	}
 
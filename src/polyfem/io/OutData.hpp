@@ -2,6 +2,7 @@
 
 #include <polyfem/Common.hpp>
 
+#include <polyfem/assembler/AssemblyValsCache.hpp>
 #include <polyfem/assembler/Problem.hpp>
 
 #include <polyfem/basis/ElementBases.hpp>
@@ -15,9 +16,19 @@
 #include <paraviewo/HDF5VTUWriter.hpp>
 
 #include <polyfem/utils/RefElementSampler.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <polyfem/io/AsyncWriter.hpp>
+#include <polyfem/io/HDF5TimeSeriesWriter.hpp>
+#include <polyfem/io/MatrixIO.hpp>
+#include <polyfem/io/PointProbe.hpp>
+#include <polyfem/io/VTUAppendedWriter.hpp>
 
 #include <Eigen/Dense>
 
+#include <fstream>
+#include <memory>
+
 namespace polyfem
 {
 	class State;
@@ -40,6 +51,86 @@ namespace polyfem::io
 		Eigen::MatrixXd scalar_value_avg;
 	};
 
+	/// paraview writer of a single dataset, the file itself is written by an AsyncWriter
+	class AsyncParaviewWriter
+	{
+	public:
+		/// @param[in] use_hdf5 writes hdf instead of vtu, hdf5 is not thread safe so these files are written synchronously.
+		/// The vtu files use the binary appended encoding when the cells are linear.
+		/// @param[in] async_writer writer running the file output
+		AsyncParaviewWriter(const bool use_hdf5, AsyncWriter &async_writer);
+
+		/// writes a step of a time series instead of a file, written synchronously as well
+		/// @param[in] time_series time series receiving the mesh and the fields
+		/// @param[in] t time of the step
+		/// @param[in] async_writer writer running the file output
+		AsyncParaviewWriter(const std::shared_ptr<HDF5TimeSeriesWriter> &time_series, const double t, AsyncWriter &async_writer);
+
+		/// adds a field, the data is copied
+		void add_field(const std::string &name, const Eigen::MatrixXd &data);
+
+		/// queues the output of the mesh and of the fields added so far, the arguments are the ones of paraviewo::ParaviewWriter::write_mesh
+		template <typename Cells, typename... Args>
+		void write_mesh(const std::string &path, const Eigen::MatrixXd &points, const Cells &cells, const Args... args)
+		{
+			if (time_series_)
+			{
+				time_series_->write_step(t_, points, to_matrix(cells), fields_);
+				return;
+			}
+
+			if (use_hdf5_)
+			{
+				std::lock_guard<std::mutex> lock(hdf5_mutex());
+				if (!writer_->write_mesh(path, points, cells, args...))
+					logger().error("Unable to write {}", path);
+				return;
+			}
+
+			const size_t bytes = bytes_ + points.size() * sizeof(double) + size_in_bytes(cells);
+			const auto job = [fields = std::move(fields_), path, points, cells, args...]() {
+				bool ok;
+				// binary appended vtu, paraviewo for the high order and polyhedral cells
+				if (VTUAppendedWriter::supports(points, cells, args...))
+				{
+					VTUAppendedWriter writer;
+					for (const auto &[name, data] : fields)
+						writer.add_field(name, data);
+					ok = writer.write_mesh(path, points, cells, args...);
+				}
+				else
+				{
+					paraviewo::VTUWriter writer;
+					for (const auto &[name, data] : fields)
+						writer.add_field(name, data);
+					ok = writer.write_mesh(path, points, cells, args...);
+				}
+				if (!ok)
+					logger().error("Unable to write {}", path);
+			};
+			async_writer_.push(job, bytes);
+		}
+
+	private:
+		static size_t size_in_bytes(const Eigen::MatrixXi &cells) { return cells.size() * sizeof(int); }
+		static size_t size_in_bytes(const std::vector<std::vector<int>> &cells);
+
+		static const Eigen::MatrixXi &to_matrix(const Eigen::MatrixXi &cells) { return cells; }
+		/// the cells of a time series must all have the same number of vertices
+		static Eigen::MatrixXi to_matrix(const std::vector<std::vector<int>> &cells);
+
+		/// hdf5 writer, the fields of the vtu and time series outputs are kept in fields_
+		std::shared_ptr<paraviewo::ParaviewWriter> writer_;
+		AsyncWriter &async_writer_;
+		const bool use_hdf5_;
+		/// memory held by the fields
+		size_t bytes_ = 0;
+
+		std::shared_ptr<HDF5TimeSeriesWriter> time_series_;
+		double t_ = 0;
+		std::vector<std::pair<std::string, Eigen::MatrixXd>> fields_;
+	};
+
 	/// Utilies related to export of geometry
 	class OutGeometryData
 	{
@@ -54,6 +145,7 @@ namespace polyfem::io
 			bool contact_forces;
 			bool friction_forces;
 			bool forces;
+			bool elastic_energy;
 
 			bool use_sampler;
 			bool boundary_only;
@@ -73,6 +165,10 @@ namespace polyfem::io
 			bool solve_export_to_file;
 
 			bool use_hdf5;
+			/// save the volume of all time steps in a single hdf5 file, see HDF5TimeSeriesWriter
+			bool time_series;
+			/// storage precision of the fields of the time series, by name
+			std::map<std::string, HDF5TimeSeriesWriter::FieldFormat> field_formats;
 
 			/// @brief initialize the flags based on the input args
 			/// @param[in] args input arguments used to set most of the flags
@@ -115,8 +211,9 @@ namespace polyfem::io
 
 		/// @brief builds the grid to export the solution
 		/// @param[in] mesh mesh
+		/// @param[in] gbases geometric bases, used to locate the grid points
 		/// @param[in] spacing grid spacing, <=0 mean no grid
-		void build_grid(const polyfem::mesh::Mesh &mesh, const double spacing);
+		void build_grid(const polyfem::mesh::Mesh &mesh, const std::vector<basis::ElementBases> &gbases, const double spacing);
 
 		/// @brief exports everytihng, txt, vtu, etc
 		/// @param[in] state state to get the data
@@ -255,6 +352,16 @@ namespace polyfem::io
 			const ExportOptions &opts,
 			std::vector<SolutionFrame> &solution_frames) const;
 
+		/// renders the deformed boundary surface (3D) colored by the solution to a PNG image, without writing the mesh
+		/// @param[in] path png filename
+		/// @param[in] state state to get the data
+		/// @param[in] sol solution
+		/// @param[in] render_args render settings (output/render)
+		void save_render(const std::string &path,
+						 const State &state,
+						 const Eigen::MatrixXd &sol,
+						 const json &render_args) const;
+
 		/// save a PVD of a time dependent simulation
 		/// @param[in] name filename
 		/// @param[in] vtu_names names of the vtu files
@@ -265,16 +372,82 @@ namespace polyfem::io
 		void save_pvd(const std::string &name, const std::function<std::string(int)> &vtu_names,
 					  int time_steps, double t0, double dt, int skip_frame = 1) const;
 
+		/// save a PVD of a time dependent simulation with non uniform steps (e.g., adaptive time stepping)
+		/// @param[in] name filename
+		/// @param[in] vtu_names names of the vtu files
+		/// @param[in] times time of every saved step, indexed by the step
+		/// @param[in] skip_frame every which frame to skip
+		void save_pvd(const std::string &name, const std::function<std::string(int)> &vtu_names,
+					  const std::vector<double> &times, int skip_frame = 1) const;
+
+		/// @brief write the paraview files on a background thread, see AsyncWriter
+		/// @param[in] max_files maximum number of files waiting to be written, <= 0 writes synchronously
+		/// @param[in] memory_budget memory held by the files waiting to be written in bytes
+		void init_async_writer(const int max_files, const size_t memory_budget) { async_writer_->start(max_files, memory_budget); }
+		/// @brief wait for all the queued files to be written
+		void flush_output() const { async_writer_->flush(); }
+
+		/// @brief start a new time series, the next save_volume with time_series replaces the file
+		void reset_time_series() { time_series_ = nullptr; }
+
+		/// forget the cached visualization mesh, needs to be called when the bases change
+		void reset_vis_cache()
+		{
+			vis_cache_ = nullptr;
+			boundary_vis_cache_ = nullptr;
+		}
+
 	private:
 		/// used to sample the solution
 		utils::RefElementSampler ref_element_sampler;
 
+		/// visualization mesh and interpolation of the nodal values, they only depend on the discretization
+		struct VisCache
+		{
+			bool use_sampler;
+			bool boundary_only;
+
+			Eigen::MatrixXd points;
+			Eigen::MatrixXi tets;
+			std::vector<std::vector<int>> elements;
+			Eigen::MatrixXi el_id;
+			Eigen::MatrixXd discr;
+
+			/// from the nodal values to the values at the points
+			StiffnessMatrix interpolation;
+		};
+		mutable std::shared_ptr<VisCache> vis_cache_;
+
+		/// boundary visualization mesh of the renders and interpolation of the nodal values at its vertices
+		struct BoundaryVisCache
+		{
+			Eigen::MatrixXd vertices;
+			Eigen::MatrixXi faces;
+			StiffnessMatrix interpolation;
+		};
+		mutable std::shared_ptr<BoundaryVisCache> boundary_vis_cache_;
+
+		/// the cached boundary visualization mesh, built on the first render
+		const BoundaryVisCache &boundary_vis_cache(const State &state) const;
+
+		/// writes the paraview files
+		std::shared_ptr<AsyncWriter> async_writer_ = std::make_shared<AsyncWriter>();
+		/// time series of the volume, created on the first step
+		mutable std::shared_ptr<HDF5TimeSeriesWriter> time_series_;
+
+		/// the cached visualization mesh for the export options, built if needed
+		const VisCache &vis_cache(const State &state, const ExportOptions &opts) const;
+		/// interpolate_function for the solution bases using the cached interpolation
+		void interpolate(const State &state, const ExportOptions &opts, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result) const;
+
 		/// grid mesh points to export solution sampled on a grid
 		Eigen::MatrixXd grid_points;
-		/// grid mesh mapping to fe elements
-		Eigen::MatrixXi grid_points_to_elements;
-		/// grid mesh boundaries
-		Eigen::MatrixXd grid_points_bc;
+		/// grid mesh mapping to fe elements, -1 outside of the mesh
+		Eigen::VectorXi grid_points_to_elements;
+		/// coordinates of the grid points in the reference element of their fe element
+		Eigen::MatrixXd grid_points_local;
+		/// probe that located the grid points, reused to sample every exported solution
+		std::shared_ptr<PointProbe> grid_probe;
 
 		/// @brief builds the boundary mesh for visualization
 		/// @param[in] mesh mesh
@@ -356,7 +529,7 @@ namespace polyfem::io
 			const ExportOptions &opts,
 			const std::string &name,
 			const Eigen::VectorXd &field,
-			paraviewo::ParaviewWriter &writer) const;
+			AsyncParaviewWriter &writer) const;
 	};
 
 	/// @brief stores all runtime data
@@ -396,6 +569,8 @@ namespace polyfem::io
 		/// information of the solver, eg num iteration, time, errors, etc
 		/// the informations varies depending on the solver
 		json solver_info;
+		/// number of subsolves, iterations, and times of all the entries added to solver_info, by type of subsolve
+		json solver_info_summary = json::object();
 
 		/// max edge lenght
 		double mesh_size;
@@ -403,6 +578,11 @@ namespace polyfem::io
 		double min_edge_length;
 		/// avg edge lenght
 		double average_edge_length;
+		/// min distance between the vertices of each element, used by the CFL time step of transient Navier-Stokes
+		Eigen::VectorXd element_sizes;
+
+		/// per phase current and peak resident memory and size of the main data structures (MB), see State::record_memory
+		json memory = json::object();
 
 		/// errors, lp_err is in fact an L8 error
 		double l2_err, linf_err, lp_err, h1_err, h1_semi_err, grad_max_err;
@@ -448,13 +628,15 @@ namespace polyfem::io
 		/// @param[in] problem problem
 		/// @param[in] tend end time step
 		/// @param[in] sol solution
+		/// @param[in] ass_vals_cache cached element values of the bases, recomputed if null
 		void compute_errors(const int n_bases,
 							const std::vector<polyfem::basis::ElementBases> &bases,
 							const std::vector<polyfem::basis::ElementBases> &gbases,
 							const polyfem::mesh::Mesh &mesh,
 							const assembler::Problem &problem,
 							const double tend,
-							const Eigen::MatrixXd &sol);
+							const Eigen::MatrixXd &sol,
+							const assembler::AssemblyValsCache *ass_vals_cache = nullptr);
 
 		/// @brief compute stats (counts els type, mesh lenght, etc), step 1 of solve
 		/// @param mesh mesh
@@ -472,6 +654,16 @@ namespace polyfem::io
 		/// @brief clears all stats
 		void reset();
 
+		/// @brief add the information of a subsolve (e.g., {type, t, info}), the summary is always updated, the entry is
+		/// appended to the solver info stream if any and only the last entries are kept in solver_info if limited
+		/// @param[in] entry information of the subsolve
+		void add_solver_info(const json &entry);
+
+		/// @brief stream the entries of solver_info to a file instead of keeping all of them in memory
+		/// @param[in] path file the entries are appended to as compact json lines (without the nested objects), none if empty
+		/// @param[in] max_entries number of last entries kept in solver_info with all their information, 0 to keep them all
+		void set_solver_info_stream(const std::string &path, const int max_entries);
+
 		/// @brief counts the number of flipped elements
 		/// @param[in] mesh mesh
 		/// @param[in] gbases geometric bases
@@ -504,6 +696,12 @@ namespace polyfem::io
 					   const bool isoparametric,
 					   const int sol_at_node_id,
 					   nlohmann::json &j);
+
+	private:
+		std::string solver_info_path_;
+		/// shared so that the stats stay copyable
+		std::shared_ptr<std::ofstream> solver_info_file_;
+		int max_solver_info_entries_ = 0;
 	};
 
 	class EnergyCSVWriter
@@ -0,0 +1,270 @@
+#include "PointProbe.hpp"
+
+#include <polyfem/io/Evaluator.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace polyfem::io
+{
+	namespace
+	{
+		/// regular lattice of the reference simplex or cube with n intervals per edge
+		Eigen::MatrixXd reference_lattice(const bool simplex, const int dim, const int n)
+		{
+			std::vector<Eigen::RowVector3d> points;
+			for (int i = 0; i <= n; ++i)
+				for (int j = 0; j <= n; ++j)
+					for (int k = 0; k <= (dim == 3 ? n : 0); ++k)
+						if (!simplex || i + j + k <= n)
+							points.emplace_back(i / double(n), j / double(n), k / double(n));
+
+			Eigen::MatrixXd lattice(points.size(), dim);
+			for (size_t i = 0; i < points.size(); ++i)
+				lattice.row(i) = points[i].head(dim);
+			return lattice;
+		}
+
+		/// distance of xi to the boundary of the reference element, negative outside
+		double reference_depth(const bool simplex, const Eigen::RowVectorXd &xi)
+		{
+			if (simplex)
+				return std::min(xi.minCoeff(), 1 - xi.sum());
+			return std::min(xi.minCoeff(), (1 - xi.array()).minCoeff());
+		}
+	} // namespace
+
+	void PointProbe::init(const mesh::Mesh &mesh, const std::vector<basis::ElementBases> &gbases, const double tol)
+	{
+		assert(int(gbases.size()) == mesh.n_elements());
+		mesh_ = &mesh;
+		gbases_ = &gbases;
+		bases_ = nullptr;
+		displacement_.resize(0, 0);
+		tol_ = tol;
+		build_tree();
+	}
+
+	void PointProbe::set_displacement(const std::vector<basis::ElementBases> &bases, const Eigen::MatrixXd &displacement)
+	{
+		assert(is_initialized());
+		bases_ = displacement.size() > 0 ? &bases : nullptr;
+		displacement_ = displacement;
+		build_tree();
+	}
+
+	void PointProbe::build_tree()
+	{
+		const int dim = mesh_->dimension();
+		// the boxes of the curved elements are sampled, then enlarged for the parts between the samples
+		const int n_intervals = 4;
+		const Eigen::MatrixXd simplex_lattice = reference_lattice(true, dim, n_intervals);
+		const Eigen::MatrixXd cube_lattice = reference_lattice(false, dim, n_intervals);
+
+		std::vector<std::array<Eigen::Vector3d, 2>> boxes(mesh_->n_elements());
+		utils::maybe_parallel_for(boxes.size(), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd x, jac;
+			Eigen::RowVectorXd xk;
+			for (int e = start; e < end; ++e)
+			{
+				if (mesh_->is_polytope(e))
+				{
+					const std::vector<int> vids = mesh_->element_vertices(e);
+					x.resize(vids.size(), dim);
+					for (size_t i = 0; i < vids.size(); ++i)
+						x.row(i) = mesh_->point(vids[i]);
+				}
+				else
+				{
+					const Eigen::MatrixXd &lattice = mesh_->is_simplex(e) ? simplex_lattice : cube_lattice;
+					x.resize(lattice.rows(), dim);
+					for (int k = 0; k < lattice.rows(); ++k)
+					{
+						map(e, lattice.row(k), xk, jac);
+						x.row(k) = xk;
+					}
+				}
+
+				const Eigen::RowVectorXd min = x.colwise().minCoeff();
+				const Eigen::RowVectorXd max = x.colwise().maxCoeff();
+				const Eigen::RowVectorXd margin = (gbases_->at(e).is_affine && bases_ == nullptr ? tol_ : 0.05) * (max - min).norm() * Eigen::RowVectorXd::Ones(dim);
+
+				boxes[e][0].setZero();
+				boxes[e][0].head(dim) = min - margin;
+				boxes[e][1].setZero();
+				boxes[e][1].head(dim) = max + margin;
+			}
+		});
+
+		if (!boxes.empty())
+			bvh_.init(boxes);
+	}
+
+	void PointProbe::map(const int e, const Eigen::MatrixXd &xi, Eigen::RowVectorXd &x, Eigen::MatrixXd &jac) const
+	{
+		assert(xi.rows() == 1);
+		const basis::ElementBases &gbs = gbases_->at(e);
+
+		Eigen::MatrixXd mapped;
+		gbs.eval_geom_mapping(xi, mapped);
+		x = mapped.row(0);
+
+		std::vector<Eigen::MatrixXd> grads;
+		gbs.eval_geom_mapping_grads(xi, grads);
+		// grads has the derivatives of x by rows
+		jac = grads[0].transpose();
+
+		if (bases_ == nullptr)
+			return;
+
+		const int dim = xi.cols();
+		const basis::ElementBases &bs = bases_->at(e);
+		std::vector<assembler::AssemblyValues> vals;
+		bs.evaluate_bases(xi, vals);
+		bs.evaluate_grads(xi, vals);
+		for (size_t j = 0; j < bs.bases.size(); ++j)
+		{
+			for (const auto &g : bs.bases[j].global())
+			{
+				const Eigen::RowVectorXd u = g.val * displacement_.block(g.index * dim, 0, dim, 1).transpose();
+				x += vals[j].val(0) * u;
+				jac += u.transpose() * vals[j].grad.row(0);
+			}
+		}
+	}
+
+	double PointProbe::invert(const int e, const Eigen::RowVectorXd &p, Eigen::MatrixXd &xi) const
+	{
+		const int dim = p.size();
+		const bool simplex = mesh_->is_simplex(e);
+
+		xi.setConstant(1, dim, simplex ? 1. / (dim + 1) : 0.5);
+		Eigen::RowVectorXd x;
+		Eigen::MatrixXd jac;
+		for (int it = 0; it < 20; ++it)
+		{
+			map(e, xi, x, jac);
+			const Eigen::RowVectorXd step = jac.partialPivLu().solve((p - x).transpose()).transpose();
+			xi += step;
+
+			// diverged, the point is far from the element
+			if (!std::isfinite(step.norm()) || xi.cwiseAbs().maxCoeff() > 10)
+				return -std::numeric_limits<double>::infinity();
+			if (step.norm() < 1e-12)
+				return reference_depth(simplex, xi.row(0));
+		}
+
+		return -std::numeric_limits<double>::infinity();
+	}
+
+	int PointProbe::locate(const Eigen::RowVectorXd &p, Eigen::MatrixXd &xi) const
+	{
+		Eigen::Vector3d q = Eigen::Vector3d::Zero();
+		q.head(p.size()) = p.transpose();
+		std::vector<unsigned int> candidates;
+		bvh_.intersect_box(q, q, candidates);
+
+		// on a shared facet, keep the element the point is the deepest in
+		int best = -1;
+		double best_depth = -tol_;
+		Eigen::MatrixXd tmp;
+		for (const unsigned int e : candidates)
+		{
+			if (mesh_->is_polytope(e))
+				continue;
+
+			const double depth = invert(e, p, tmp);
+			if (depth >= best_depth)
+			{
+				best = e;
+				best_depth = depth;
+				xi = tmp;
+			}
+		}
+
+		return best;
+	}
+
+	void PointProbe::locate(const Eigen::MatrixXd &points, Eigen::VectorXi &elements, Eigen::MatrixXd &local_points) const
+	{
+		assert(is_initialized());
+		assert(points.cols() == mesh_->dimension());
+
+		elements.resize(points.rows());
+		local_points.setConstant(points.rows(), points.cols(), std::numeric_limits<double>::quiet_NaN());
+		if (mesh_->n_elements() == 0)
+		{
+			elements.setConstant(-1);
+			return;
+		}
+
+		utils::maybe_parallel_for(points.rows(), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd xi;
+			for (int i = start; i < end; ++i)
+			{
+				elements[i] = locate(points.row(i), xi);
+				if (elements[i] >= 0)
+					local_points.row(i) = xi;
+			}
+		});
+	}
+
+	void PointProbe::sample(const std::vector<basis::ElementBases> &bases, const int actual_dim,
+							const Eigen::VectorXi &elements, const Eigen::MatrixXd &local_points, const Eigen::MatrixXd &fun,
+							Eigen::MatrixXd &values, Eigen::MatrixXd &grads) const
+	{
+		assert(is_initialized());
+		assert(elements.size() == local_points.rows());
+		const int dim = mesh_->dimension();
+
+		values.setConstant(elements.size(), actual_dim, std::numeric_limits<double>::quiet_NaN());
+		grads.setConstant(elements.size(), dim * actual_dim, std::numeric_limits<double>::quiet_NaN());
+
+		// the points of an element are evaluated together
+		std::vector<int> order;
+		order.reserve(elements.size());
+		for (int i = 0; i < elements.size(); ++i)
+			if (elements[i] >= 0)
+				order.push_back(i);
+		std::stable_sort(order.begin(), order.end(), [&](const int a, const int b) { return elements[a] < elements[b]; });
+
+		std::vector<int> groups;
+		for (size_t k = 0; k < order.size(); ++k)
+			if (k == 0 || elements[order[k]] != elements[order[k - 1]])
+				groups.push_back(k);
+		groups.push_back(order.size());
+
+		utils::maybe_parallel_for(int(groups.size()) - 1, [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd pts, val, grad;
+			for (int g = start; g < end; ++g)
+			{
+				const int e = elements[order[groups[g]]];
+				pts.resize(groups[g + 1] - groups[g], dim);
+				for (int k = groups[g]; k < groups[g + 1]; ++k)
+					pts.row(k - groups[g]) = local_points.row(order[k]);
+
+				Evaluator::interpolate_at_local_vals(*mesh_, actual_dim, bases, *gbases_, e, pts, fun, val, grad);
+
+				for (int k = groups[g]; k < groups[g + 1]; ++k)
+				{
+					values.row(order[k]) = val.row(k - groups[g]);
+					grads.row(order[k]) = grad.row(k - groups[g]);
+				}
+			}
+		});
+	}
+
+	void PointProbe::sample(const std::vector<basis::ElementBases> &bases, const int actual_dim,
+							const Eigen::MatrixXd &points, const Eigen::MatrixXd &fun,
+							Eigen::MatrixXd &values, Eigen::MatrixXd &grads) const
+	{
+		Eigen::VectorXi elements;
+		Eigen::MatrixXd local_points;
+		locate(points, elements, local_points);
+		sample(bases, actual_dim, elements, local_points, fun, values, grads);
+	}
+} // namespace polyfem::io
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/mesh/Mesh.hpp>
+
+#include <SimpleBVH/BVH.hpp>
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem::io
+{
+	/// Locates points in the elements of a mesh and samples functions at them, e.g., for sensor probes, the solution on
+	/// a grid, or the coupling with other codes.
+	/// The AABB tree of the elements is built once, in the rest or in a displaced geometry. The points are located by
+	/// inverting the geometric mapping of the candidate elements with Newton's method, so curved and high-order
+	/// elements are supported. The polytopes are skipped. The queries are const and run in parallel.
+	class PointProbe
+	{
+	public:
+		PointProbe() = default;
+
+		/// @brief Build the tree in the rest geometry
+		/// @param[in] mesh mesh
+		/// @param[in] gbases geometric bases
+		/// @param[in] tol tolerance on the local coordinates for a point to be inside an element
+		void init(const mesh::Mesh &mesh, const std::vector<basis::ElementBases> &gbases, const double tol = 1e-8);
+
+		/// @brief Locate the points in the geometry displaced by displacement, the tree is built again
+		/// @param[in] bases bases of the displacement
+		/// @param[in] displacement nodal displacement, #bases * dim, empty for the rest geometry
+		void set_displacement(const std::vector<basis::ElementBases> &bases, const Eigen::MatrixXd &displacement);
+
+		bool is_initialized() const { return mesh_ != nullptr; }
+
+		/// @brief Locate the rows of points in parallel
+		/// @param[in] points query points, #P x dim
+		/// @param[out] elements element containing each point, -1 if outside the mesh
+		/// @param[out] local_points coordinates of each point in the reference element, #P x dim, NaN outside the mesh
+		void locate(const Eigen::MatrixXd &points, Eigen::VectorXi &elements, Eigen::MatrixXd &local_points) const;
+
+		/// @brief Value and gradient of fun at located points, in parallel
+		/// @param[in] bases bases of fun
+		/// @param[in] actual_dim number of components of fun (e.g., 1 for Laplace, dim for elasticity)
+		/// @param[in] elements elements of the points, see locate
+		/// @param[in] local_points local coordinates of the points, see locate
+		/// @param[in] fun nodal values of the function
+		/// @param[out] values #P x actual_dim, NaN outside the mesh
+		/// @param[out] grads #P x (dim * actual_dim), NaN outside the mesh
+		void sample(const std::vector<basis::ElementBases> &bases, const int actual_dim,
+					const Eigen::VectorXi &elements, const Eigen::MatrixXd &local_points, const Eigen::MatrixXd &fun,
+					Eigen::MatrixXd &values, Eigen::MatrixXd &grads) const;
+
+		/// @brief Locate the rows of points and sample fun at them
+		void sample(const std::vector<basis::ElementBases> &bases, const int actual_dim,
+					const Eigen::MatrixXd &points, const Eigen::MatrixXd &fun,
+					Eigen::MatrixXd &values, Eigen::MatrixXd &grads) const;
+
+	private:
+		const mesh::Mesh *mesh_ = nullptr;
+		const std::vector<basis::ElementBases> *gbases_ = nullptr;
+		const std::vector<basis::ElementBases> *bases_ = nullptr;
+		Eigen::MatrixXd displacement_;
+		double tol_ = 1e-8;
+
+		SimpleBVH::BVH bvh_;
+
+		void build_tree();
+
+		/// position and jacobian (dx_i / dxi_j) of the (displaced) geometric mapping of element e at the local point xi
+		void map(const int e, const Eigen::MatrixXd &xi, Eigen::RowVectorXd &x, Eigen::MatrixXd &jac) const;
+		/// invert the mapping of element e at p with Newton's method
+		/// @return distance of the local point to the boundary of the reference element, negative outside
+		double invert(const int e, const Eigen::RowVectorXd &p, Eigen::MatrixXd &xi) const;
+		/// element containing p, -1 if outside
+		int locate(const Eigen::RowVectorXd &p, Eigen::MatrixXd &xi) const;
+	};
+} // namespace polyfem::io
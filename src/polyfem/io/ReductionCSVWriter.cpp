@@ -0,0 +1,280 @@
+#include "ReductionCSVWriter.hpp"
+
+#include <polyfem/State.hpp>
+#include <polyfem/io/Evaluator.hpp>
+#include <polyfem/solver/forms/ElasticForm.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace polyfem::io
+{
+	using namespace assembler;
+
+	ReductionCSVWriter::ReductionCSVWriter(const std::string &path, const json &in_reductions)
+		: file(path)
+	{
+		for (const json &r : in_reductions)
+		{
+			Reduction reduction;
+			reduction.name = r["name"];
+			reduction.quantity = r["quantity"];
+
+			const std::string type = r["type"];
+			if (type == "integral")
+				reduction.type = Type::INTEGRAL;
+			else if (type == "average")
+				reduction.type = Type::AVERAGE;
+			else if (type == "max")
+				reduction.type = Type::MAX;
+			else if (type == "min")
+				reduction.type = Type::MIN;
+			else if (type == "histogram")
+				reduction.type = Type::HISTOGRAM;
+			else if (type == "reaction_force")
+				reduction.type = Type::REACTION_FORCE;
+			else
+				log_and_throw_error("Unknown reduction type {}", type);
+
+			reduction.body_ids = r["body_ids"].get<std::vector<int>>();
+			reduction.boundary_id = r["boundary_id"];
+			reduction.n_bins = r["bins"];
+			if (reduction.type == Type::HISTOGRAM)
+			{
+				if (r["range"].size() != 2 || r["range"][0] >= r["range"][1] || reduction.n_bins <= 0)
+					log_and_throw_error("Histogram reduction {} needs a range [min, max] and a positive number of bins", reduction.name);
+				reduction.min = r["range"][0];
+				reduction.max = r["range"][1];
+			}
+			if (reduction.type == Type::REACTION_FORCE && reduction.boundary_id < 0)
+				log_and_throw_error("Reaction force reduction {} needs a boundary_id", reduction.name);
+
+			reductions.push_back(reduction);
+		}
+	}
+
+	ReductionCSVWriter::~ReductionCSVWriter()
+	{
+		file.close();
+	}
+
+	void ReductionCSVWriter::write(const double t, const State &state, const Eigen::MatrixXd &sol)
+	{
+		static const std::array<std::string, 3> components = {{"x", "y", "z"}};
+
+		std::vector<Eigen::VectorXd> values;
+		std::vector<std::string> names;
+		for (Reduction &reduction : reductions)
+		{
+			Eigen::VectorXd value;
+			if (reduction.type == Type::REACTION_FORCE)
+				value = reaction_force(state, sol, reduction);
+			else
+			{
+				Eigen::VectorXd integral, histogram;
+				double measure, min, max;
+				reduce_elements(state, sol, t, reduction, integral, measure, min, max, histogram);
+
+				switch (reduction.type)
+				{
+				case Type::INTEGRAL:
+					value = integral;
+					break;
+				case Type::AVERAGE:
+					value = measure > 0 ? Eigen::VectorXd(integral / measure) : Eigen::VectorXd::Zero(integral.size());
+					break;
+				case Type::MAX:
+					value = Eigen::VectorXd::Constant(1, max);
+					break;
+				case Type::MIN:
+					value = Eigen::VectorXd::Constant(1, min);
+					break;
+				case Type::HISTOGRAM:
+					value = histogram;
+					break;
+				default:
+					assert(false);
+				}
+			}
+
+			if (!header_written)
+			{
+				for (int i = 0; i < value.size(); ++i)
+				{
+					if (value.size() == 1)
+						names.push_back(reduction.name);
+					else if (reduction.type == Type::HISTOGRAM || value.size() > 3)
+						names.push_back(fmt::format("{}_{}", reduction.name, i));
+					else
+						names.push_back(fmt::format("{}_{}", reduction.name, components[i]));
+				}
+			}
+			values.push_back(value);
+		}
+
+		if (!header_written)
+		{
+			file << "t";
+			for (const std::string &name : names)
+				file << "," << name;
+			file << "\n";
+			header_written = true;
+		}
+
+		file << fmt::format("{:.17g}", t);
+		for (const Eigen::VectorXd &value : values)
+			for (int i = 0; i < value.size(); ++i)
+				file << fmt::format(",{:.17g}", value(i));
+		file << "\n";
+		file.flush();
+	}
+
+	void ReductionCSVWriter::reduce_elements(
+		const State &state, const Eigen::MatrixXd &sol, const double t, const Reduction &reduction,
+		Eigen::VectorXd &integral, double &measure, double &min, double &max, Eigen::VectorXd &histogram)
+	{
+		const mesh::Mesh &mesh = *state.mesh;
+		const std::vector<basis::ElementBases> &bases = state.bases;
+		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
+		const int dim = mesh.dimension();
+		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
+		const bool is_solution = reduction.quantity == "solution";
+		const int n_bins = reduction.type == Type::HISTOGRAM ? reduction.n_bins : 0;
+
+		struct LocalStorage
+		{
+			Eigen::VectorXd integral;
+			Eigen::VectorXd histogram;
+			double measure = 0;
+			double min = std::numeric_limits<double>::infinity();
+			double max = -std::numeric_limits<double>::infinity();
+			ElementAssemblyValues vals;
+
+			LocalStorage(const int n_cols, const int n_bins)
+			{
+				integral.setZero(n_cols);
+				histogram.setZero(n_bins);
+			}
+		};
+
+		auto storage = utils::create_thread_storage(LocalStorage(is_solution ? actual_dim : 1, n_bins));
+		std::atomic<bool> unknown_quantity = false;
+
+		utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+			LocalStorage &local = utils::get_local_thread_storage(storage, thread_id);
+
+			for (int e = start; e < end; ++e)
+			{
+				if (!reduction.body_ids.empty() && std::find(reduction.body_ids.begin(), reduction.body_ids.end(), mesh.get_body_id(e)) == reduction.body_ids.end())
+					continue;
+
+				const ElementAssemblyValues &vals = state.ass_vals_cache.get(e, mesh.is_volume(), bases[e], gbases[e], local.vals);
+
+				Eigen::MatrixXd values;
+				if (is_solution)
+				{
+					Eigen::MatrixXd grad;
+					Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, sol, values, grad);
+				}
+				else
+				{
+					std::vector<Assembler::NamedMatrix> scalars;
+					state.assembler->compute_scalar_value(OutputData(t, e, bases[e], gbases[e], vals.quadrature.points, sol), scalars);
+					const auto it = std::find_if(scalars.begin(), scalars.end(), [&](const auto &s) { return s.first == reduction.quantity; });
+					if (it == scalars.end())
+					{
+						unknown_quantity = true;
+						return;
+					}
+					values = it->second;
+				}
+
+				const Eigen::VectorXd da = vals.det.array() * vals.quadrature.weights.array();
+				local.integral += values.transpose() * da;
+				local.measure += da.sum();
+
+				// vector quantities are compared by magnitude
+				const Eigen::VectorXd magnitude = values.rowwise().norm();
+				local.min = std::min(local.min, magnitude.minCoeff());
+				local.max = std::max(local.max, magnitude.maxCoeff());
+
+				if (n_bins > 0)
+				{
+					for (int q = 0; q < magnitude.size(); ++q)
+					{
+						const int bin = std::clamp(int(std::floor((magnitude(q) - reduction.min) / (reduction.max - reduction.min) * n_bins)), 0, n_bins - 1);
+						local.histogram(bin) += da(q);
+					}
+				}
+			}
+		});
+
+		if (unknown_quantity)
+			log_and_throw_error("Unknown quantity {} of reduction {}", reduction.quantity, reduction.name);
+
+		integral.setZero(is_solution ? actual_dim : 1);
+		histogram.setZero(n_bins);
+		measure = 0;
+		min = std::numeric_limits<double>::infinity();
+		max = -std::numeric_limits<double>::infinity();
+		for (const LocalStorage &local : storage)
+		{
+			integral += local.integral;
+			histogram += local.histogram;
+			measure += local.measure;
+			min = std::min(min, local.min);
+			max = std::max(max, local.max);
+		}
+	}
+
+	Eigen::VectorXd ReductionCSVWriter::reaction_force(const State &state, const Eigen::MatrixXd &sol, Reduction &reduction)
+	{
+		const mesh::Mesh &mesh = *state.mesh;
+		const int actual_dim = state.problem->is_scalar() ? 1 : mesh.dimension();
+
+		if (!reduction.nodes_computed)
+		{
+			std::set<int> nodes;
+			for (const mesh::LocalBoundary &lb : state.total_local_boundary)
+			{
+				const int e = lb.element_id();
+				for (int i = 0; i < lb.size(); ++i)
+				{
+					if (mesh.get_boundary_id(lb.global_primitive_id(i)) != reduction.boundary_id)
+						continue;
+					for (const int n : state.bases[e].local_nodes_for_primitive(lb.global_primitive_id(i), mesh))
+						nodes.insert(state.bases[e].bases[n].global()[0].index);
+				}
+			}
+			reduction.nodes.assign(nodes.begin(), nodes.end());
+			reduction.nodes_computed = true;
+
+			if (reduction.nodes.empty())
+				logger().warn("Reaction force reduction {}: no node with boundary id {}", reduction.name, reduction.boundary_id);
+		}
+
+		if (state.solve_data.elastic_form == nullptr)
+		{
+			logger().warn("Reaction force reduction {} is only available for nonlinear solves", reduction.name);
+			return Eigen::VectorXd::Constant(actual_dim, std::nan(""));
+		}
+
+		// the weight of the elastic form is the scaling of the time integrator (e.g., dt^2) in transient runs
+		const double weight = state.solve_data.elastic_form->weight();
+		if (weight == 0)
+			return Eigen::VectorXd::Constant(actual_dim, std::nan(""));
+		Eigen::VectorXd grad;
+		state.solve_data.elastic_form->first_derivative(sol, grad);
+		grad /= weight;
+
+		Eigen::VectorXd force = Eigen::VectorXd::Zero(actual_dim);
+		for (const int n : reduction.nodes)
+			force += grad.segment(n * actual_dim, actual_dim);
+		return force;
+	}
+} // namespace polyfem::io
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <Eigen/Dense>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	class State;
+}
+
+namespace polyfem::io
+{
+	/// Writes one row of reduced quantities per time step (e.g., the max von Mises stress of a body or the
+	/// reaction force on a sideset) to a CSV file, without writing the full fields.
+	/// The reductions are given by the output/reductions list of the input json.
+	class ReductionCSVWriter
+	{
+	public:
+		/// @param[in] path csv file
+		/// @param[in] reductions list of reductions, see output/reductions in the input spec
+		ReductionCSVWriter(const std::string &path, const json &reductions);
+		~ReductionCSVWriter();
+
+		/// @brief Evaluate the reductions and append a row
+		/// @param[in] t current time
+		/// @param[in] state state with the bases and the assembler
+		/// @param[in] sol current solution
+		void write(const double t, const State &state, const Eigen::MatrixXd &sol);
+
+	private:
+		enum class Type
+		{
+			INTEGRAL,
+			AVERAGE,
+			MAX,
+			MIN,
+			HISTOGRAM,
+			REACTION_FORCE
+		};
+
+		struct Reduction
+		{
+			std::string name;
+			Type type;
+			/// solution or the name of a scalar value of the assembler (e.g., von_mises)
+			std::string quantity;
+			/// elements with these body ids, all if empty
+			std::vector<int> body_ids;
+			/// sideset of the reaction force
+			int boundary_id = -1;
+			int n_bins = 10;
+			double min = 0, max = 1;
+
+			/// nodes of the sideset, computed at the first evaluation
+			std::vector<int> nodes;
+			bool nodes_computed = false;
+		};
+
+		/// @brief Integral, measure, min, max and measure-weighted histogram of the quantity over the selected elements
+		static void reduce_elements(const State &state, const Eigen::MatrixXd &sol, const double t, const Reduction &reduction,
+									Eigen::VectorXd &integral, double &measure, double &min, double &max, Eigen::VectorXd &histogram);
+
+		/// @brief Sum of the elastic forces on the nodes of the sideset
+		static Eigen::VectorXd reaction_force(const State &state, const Eigen::MatrixXd &sol, Reduction &reduction);
+
+		std::ofstream file;
+		std::vector<Reduction> reductions;
+		bool header_written = false;
+	};
+} // namespace polyfem::io
@@ -0,0 +1,303 @@
+#include "SolutionFrameStore.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace polyfem::io
+{
+	namespace
+	{
+		Eigen::MatrixXd &field(SolutionFrame &frame, const int k)
+		{
+			switch (k)
+			{
+			case 0:
+				return frame.solution;
+			case 1:
+				return frame.pressure;
+			case 2:
+				return frame.exact;
+			case 3:
+				return frame.error;
+			case 4:
+				return frame.scalar_value;
+			default:
+				return frame.scalar_value_avg;
+			}
+		}
+
+		const Eigen::MatrixXd &field(const SolutionFrame &frame, const int k)
+		{
+			return field(const_cast<SolutionFrame &>(frame), k);
+		}
+
+		uint64_t zigzag(const int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+		int64_t unzigzag(const uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+		/// difference of the words w and base, small if they are close
+		uint64_t residual(const uint64_t w, const uint64_t base, const bool quantized)
+		{
+			return quantized ? zigzag(int64_t(w) - int64_t(base)) : w ^ base;
+		}
+
+		uint64_t from_residual(const uint64_t r, const uint64_t base, const bool quantized)
+		{
+			return quantized ? uint64_t(unzigzag(r) + int64_t(base)) : r ^ base;
+		}
+
+		int significant_bytes(uint64_t r)
+		{
+			int n = 0;
+			for (; r != 0; r >>= 8)
+				++n;
+			return n;
+		}
+
+		/// one header byte with the number of significant bytes of two residuals, then their low bytes
+		void encode(const std::vector<uint64_t> &residuals, std::vector<uint8_t> &out)
+		{
+			for (size_t i = 0; i < residuals.size(); i += 2)
+			{
+				const int n0 = significant_bytes(residuals[i]);
+				const int n1 = i + 1 < residuals.size() ? significant_bytes(residuals[i + 1]) : 0;
+				out.push_back(uint8_t(n0 | (n1 << 4)));
+				for (int b = 0; b < n0; ++b)
+					out.push_back(uint8_t(residuals[i] >> (8 * b)));
+				for (int b = 0; b < n1; ++b)
+					out.push_back(uint8_t(residuals[i + 1] >> (8 * b)));
+			}
+		}
+
+		void decode(const uint8_t *data, const size_t n_values, std::vector<uint64_t> &residuals)
+		{
+			residuals.assign(n_values, 0);
+			for (size_t i = 0; i < n_values; i += 2)
+			{
+				const uint8_t header = *data++;
+				for (size_t j = i; j < std::min(i + 2, n_values); ++j)
+				{
+					const int n = j == i ? (header & 0xF) : (header >> 4);
+					for (int b = 0; b < n; ++b)
+						residuals[j] |= uint64_t(*data++) << (8 * b);
+				}
+			}
+		}
+	} // namespace
+
+	SolutionFrameStore::SolutionFrameStore(const double tolerance, const size_t memory_limit, const std::string &spill_directory, const int keyframe_interval)
+		: keyframe_interval_(keyframe_interval)
+	{
+		std::random_device rd;
+		id_ = (uint64_t(rd()) << 32) | rd();
+		reset(tolerance, memory_limit, spill_directory);
+	}
+
+	SolutionFrameStore::~SolutionFrameStore()
+	{
+		clear();
+	}
+
+	void SolutionFrameStore::reset(const double tolerance, const size_t memory_limit, const std::string &spill_directory)
+	{
+		if (tolerance < 0)
+			log_and_throw_error("Invalid solution frame tolerance {}", tolerance);
+
+		clear();
+		tolerance_ = tolerance;
+		memory_limit_ = memory_limit;
+		spill_directory_ = spill_directory.empty() ? std::filesystem::temp_directory_path().string() : spill_directory;
+	}
+
+	void SolutionFrameStore::clear()
+	{
+		for (size_t i = 0; i < next_spill_; ++i)
+		{
+			std::error_code ec;
+			std::filesystem::remove(spill_path(i), ec);
+		}
+
+		frames_.clear();
+		last_.clear();
+		next_spill_ = 0;
+		topology_bytes_ = 0;
+	}
+
+	void SolutionFrameStore::push_back(const SolutionFrame &frame)
+	{
+		Frame f;
+		f.name = frame.name;
+
+		auto last = last_.find(frame.name);
+		const bool has_last = last != last_.end();
+		const Frame *prev = has_last ? &frames_[last->second.index] : nullptr;
+
+		if (prev && prev->points->rows() == frame.points.rows() && prev->points->cols() == frame.points.cols() && *prev->points == frame.points)
+			f.points = prev->points;
+		else
+		{
+			f.points = std::make_shared<const Eigen::MatrixXd>(frame.points);
+			topology_bytes_ += utils::memory_bytes(*f.points);
+		}
+		if (prev && prev->connectivity->rows() == frame.connectivity.rows() && prev->connectivity->cols() == frame.connectivity.cols() && *prev->connectivity == frame.connectivity)
+			f.connectivity = prev->connectivity;
+		else
+		{
+			f.connectivity = std::make_shared<const Eigen::MatrixXi>(frame.connectivity);
+			topology_bytes_ += utils::memory_bytes(*f.connectivity);
+		}
+
+		if (prev && prev->depth + 1 < keyframe_interval_)
+		{
+			f.base = last->second.index;
+			f.depth = prev->depth + 1;
+		}
+
+		const double step = 2 * tolerance_;
+		std::array<std::vector<uint64_t>, N_FIELDS> words;
+		std::vector<uint64_t> residuals;
+		for (int k = 0; k < N_FIELDS; ++k)
+		{
+			const Eigen::MatrixXd &values = field(frame, k);
+			Field &fd = f.fields[k];
+			fd.rows = values.rows();
+			fd.cols = values.cols();
+
+			// the values that cannot be quantized (e.g., infinite or too large) are kept lossless
+			fd.quantized = step > 0 && values.array().isFinite().all() && (values.size() == 0 || values.cwiseAbs().maxCoeff() / step < 1e18);
+
+			std::vector<uint64_t> &w = words[k];
+			w.resize(values.size());
+			for (Eigen::Index i = 0; i < values.size(); ++i)
+			{
+				if (fd.quantized)
+					w[i] = uint64_t(std::llround(values(i) / step));
+				else
+					std::memcpy(&w[i], &values(i), sizeof(double));
+			}
+
+			fd.relative = f.base >= 0 && prev->fields[k].rows == fd.rows && prev->fields[k].cols == fd.cols && prev->fields[k].quantized == fd.quantized;
+
+			residuals.resize(w.size());
+			for (size_t i = 0; i < w.size(); ++i)
+				residuals[i] = residual(w[i], fd.relative ? last->second.words[k][i] : 0, fd.quantized);
+
+			fd.offset = f.data.size();
+			encode(residuals, f.data);
+			fd.size = f.data.size() - fd.offset;
+		}
+		f.data.shrink_to_fit();
+
+		frames_.push_back(std::move(f));
+		last_[frame.name] = {frames_.size() - 1, std::move(words)};
+
+		spill();
+	}
+
+	SolutionFrame SolutionFrameStore::frame(const size_t i) const
+	{
+		assert(i < frames_.size());
+		const Frame &f = frames_[i];
+
+		SolutionFrame frame;
+		frame.name = f.name;
+		frame.points = *f.points;
+		frame.connectivity = *f.connectivity;
+
+		std::vector<uint64_t> words;
+		for (int k = 0; k < N_FIELDS; ++k)
+		{
+			const Field &fd = f.fields[k];
+			field_words(i, k, words);
+
+			Eigen::MatrixXd &values = field(frame, k);
+			values.resize(fd.rows, fd.cols);
+			for (Eigen::Index j = 0; j < values.size(); ++j)
+			{
+				if (fd.quantized)
+					values(j) = double(int64_t(words[j])) * 2 * tolerance_;
+				else
+					std::memcpy(&values(j), &words[j], sizeof(double));
+			}
+		}
+
+		return frame;
+	}
+
+	void SolutionFrameStore::field_words(const size_t i, const int k, std::vector<uint64_t> &words) const
+	{
+		const Frame &f = frames_[i];
+		const Field &fd = f.fields[k];
+		const size_t n = size_t(fd.rows) * fd.cols;
+
+		if (fd.relative)
+			field_words(f.base, k, words);
+		else
+			words.assign(n, 0);
+		assert(words.size() == n);
+
+		std::vector<uint8_t> buffer;
+		const std::vector<uint8_t> &data = frame_data(i, buffer);
+		std::vector<uint64_t> residuals;
+		decode(data.data() + fd.offset, n, residuals);
+		for (size_t j = 0; j < n; ++j)
+			words[j] = from_residual(residuals[j], words[j], fd.quantized);
+	}
+
+	const std::vector<uint8_t> &SolutionFrameStore::frame_data(const size_t i, std::vector<uint8_t> &buffer) const
+	{
+		if (i >= next_spill_)
+			return frames_[i].data;
+
+		const std::string path = spill_path(i);
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.good())
+			log_and_throw_error("Unable to read the spilled solution frame {}", path);
+		buffer.resize(file.tellg());
+		file.seekg(0);
+		file.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+		return buffer;
+	}
+
+	std::string SolutionFrameStore::spill_path(const size_t i) const
+	{
+		return (std::filesystem::path(spill_directory_) / fmt::format("polyfem_frames_{:016x}_{}.bin", id_, i)).string();
+	}
+
+	void SolutionFrameStore::spill()
+	{
+		if (memory_limit_ == 0)
+			return;
+
+		size_t bytes = memory_bytes();
+		for (; bytes > memory_limit_ && next_spill_ < frames_.size(); ++next_spill_)
+		{
+			Frame &f = frames_[next_spill_];
+			const std::string path = spill_path(next_spill_);
+			std::ofstream file(path, std::ios::binary);
+			file.write(reinterpret_cast<const char *>(f.data.data()), f.data.size());
+			if (!file.good())
+				log_and_throw_error("Unable to spill the solution frame to {}", path);
+
+			bytes -= f.data.capacity();
+			f.data = std::vector<uint8_t>();
+		}
+	}
+
+	size_t SolutionFrameStore::memory_bytes() const
+	{
+		size_t bytes = topology_bytes_ + frames_.capacity() * sizeof(Frame);
+		for (const Frame &f : frames_)
+			bytes += utils::memory_bytes(f.data);
+		for (const auto &[name, last] : last_)
+			for (const auto &w : last.words)
+				bytes += utils::memory_bytes(w);
+		return bytes;
+	}
+} // namespace polyfem::io
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <polyfem/io/OutData.hpp>
+
+#include <Eigen/Dense>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace polyfem::io
+{
+	/// Compressed in-memory storage of the solution frames of a time dependent simulation (see State::solution_frames).
+	/// The points and connectivity equal to the ones of the previous frame of the same dataset (i.e., name) are shared.
+	/// The fields are stored relative to the previous frame of the same dataset, as the xor of their bits (lossless,
+	/// slowly changing values have many leading zero bits) or quantized with a tolerance, and only the significant bytes
+	/// are kept. Every keyframe_interval frames of a dataset are stored independently of the previous ones.
+	/// Past a memory limit the oldest frames are spilled to disk and read back when accessed.
+	class SolutionFrameStore
+	{
+	public:
+		/// @param[in] tolerance maximum absolute error of the field values, 0 for lossless storage
+		/// @param[in] memory_limit bytes kept in memory before spilling the oldest frames to disk, 0 for no limit
+		/// @param[in] spill_directory directory of the spilled frames, the temporary directory if empty
+		/// @param[in] keyframe_interval number of frames of a dataset between two frames stored independently
+		SolutionFrameStore(const double tolerance = 0, const size_t memory_limit = 0, const std::string &spill_directory = "", const int keyframe_interval = 32);
+		~SolutionFrameStore();
+
+		SolutionFrameStore(const SolutionFrameStore &) = delete;
+		SolutionFrameStore &operator=(const SolutionFrameStore &) = delete;
+
+		/// remove the frames and set the options of the next ones, see the constructor
+		void reset(const double tolerance, const size_t memory_limit, const std::string &spill_directory);
+		/// remove the frames (and their spilled files), the options are kept
+		void clear();
+
+		/// append a compressed copy of frame
+		void push_back(const SolutionFrame &frame);
+		/// decompressed copy of the i-th frame
+		SolutionFrame frame(const size_t i) const;
+
+		size_t size() const { return frames_.size(); }
+		bool empty() const { return frames_.empty(); }
+		/// number of frames whose fields are on disk
+		size_t spilled_frames() const { return next_spill_; }
+
+		/// heap memory in bytes, without the spilled frames
+		size_t memory_bytes() const;
+
+	private:
+		/// solution, pressure, exact, error, scalar_value, and scalar_value_avg
+		static constexpr int N_FIELDS = 6;
+
+		struct Field
+		{
+			int rows = 0;
+			int cols = 0;
+			/// quantized with the tolerance, false if stored lossless
+			bool quantized = false;
+			/// relative to the field of the base frame
+			bool relative = false;
+			/// encoded bytes in the data of the frame
+			size_t offset = 0;
+			size_t size = 0;
+		};
+
+		struct Frame
+		{
+			std::string name;
+			std::shared_ptr<const Eigen::MatrixXd> points;
+			std::shared_ptr<const Eigen::MatrixXi> connectivity;
+			/// previous frame of the same dataset the relative fields are stored from, -1 for a keyframe
+			int base = -1;
+			/// number of frames since the last keyframe of the dataset
+			int depth = 0;
+			std::array<Field, N_FIELDS> fields;
+			/// encoded fields, empty if spilled
+			std::vector<uint8_t> data;
+		};
+
+		/// last frame of a dataset, with its decoded field words to store the next frame from
+		struct Last
+		{
+			size_t index;
+			std::array<std::vector<uint64_t>, N_FIELDS> words;
+		};
+
+		double tolerance_;
+		size_t memory_limit_;
+		std::string spill_directory_;
+		const int keyframe_interval_;
+		/// random identifier of the spilled files of this store
+		uint64_t id_;
+
+		std::vector<Frame> frames_;
+		std::map<std::string, Last> last_;
+		/// the frames before it are spilled
+		size_t next_spill_ = 0;
+		/// memory of the distinct points and connectivity
+		size_t topology_bytes_ = 0;
+
+		/// words (bits or quantized value) of the k-th field of the i-th frame
+		void field_words(const size_t i, const int k, std::vector<uint64_t> &words) const;
+		/// encoded fields of the i-th frame, read in buffer if spilled
+		const std::vector<uint8_t> &frame_data(const size_t i, std::vector<uint8_t> &buffer) const;
+
+		std::string spill_path(const size_t i) const;
+		void spill();
+	};
+} // namespace polyfem::io
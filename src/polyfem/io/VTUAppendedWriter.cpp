@@ -0,0 +1,209 @@
+#include "VTUAppendedWriter.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <cstring>
+#include <fstream>
+
+namespace polyfem::io
+{
+	namespace
+	{
+		bool is_little_endian()
+		{
+			const uint16_t one = 1;
+			uint8_t first;
+			std::memcpy(&first, &one, 1);
+			return first == 1;
+		}
+
+		/// appended array of a column major matrix, written row by row (vtk tuples) and padded with zeros to n_components
+		struct Array
+		{
+			std::string name;
+			const Eigen::MatrixXd *data;
+			int n_components;
+			size_t offset;
+		};
+	} // namespace
+
+	void VTUAppendedWriter::add_field(const std::string &name, const Eigen::MatrixXd &data)
+	{
+		fields_.emplace_back(name, data);
+	}
+
+	int VTUAppendedWriter::cell_type(const int dim, const int n_vertices, const bool is_simplicial)
+	{
+		switch (n_vertices)
+		{
+		case 1:
+			return 1; // VTK_VERTEX
+		case 2:
+			return 3; // VTK_LINE
+		case 3:
+			return 5; // VTK_TRIANGLE
+		case 4:
+			if (dim == 2)
+				return 9; // VTK_QUAD
+			return is_simplicial ? 10 : -1; // VTK_TETRA
+		case 8:
+			return dim == 3 ? 12 : -1; // VTK_HEXAHEDRON
+		default:
+			return -1;
+		}
+	}
+
+	bool VTUAppendedWriter::supports(const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells)
+	{
+		return cell_type(points.cols(), cells.cols(), true) >= 0;
+	}
+
+	bool VTUAppendedWriter::supports(const Eigen::MatrixXd &points, const std::vector<std::vector<int>> &cells, const bool is_simplicial, const bool has_poly)
+	{
+		for (const auto &c : cells)
+		{
+			// linear polygons
+			if (has_poly && points.cols() == 2 && c.size() > 4)
+				continue;
+			if (cell_type(points.cols(), c.size(), is_simplicial) < 0)
+				return false;
+		}
+		return true;
+	}
+
+	bool VTUAppendedWriter::write_mesh(const std::string &path, const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells)
+	{
+		assert(supports(points, cells));
+
+		std::vector<int64_t> connectivity(cells.size());
+		std::vector<int64_t> offsets(cells.rows());
+		const std::vector<uint8_t> types(cells.rows(), cell_type(points.cols(), cells.cols(), true));
+		for (int i = 0; i < cells.rows(); ++i)
+		{
+			for (int j = 0; j < cells.cols(); ++j)
+				connectivity[i * cells.cols() + j] = cells(i, j);
+			offsets[i] = (i + 1) * cells.cols();
+		}
+
+		return write(path, points, connectivity, offsets, types);
+	}
+
+	bool VTUAppendedWriter::write_mesh(const std::string &path, const Eigen::MatrixXd &points, const std::vector<std::vector<int>> &cells, const bool is_simplicial, const bool has_poly)
+	{
+		assert(supports(points, cells, is_simplicial, has_poly));
+
+		std::vector<int64_t> connectivity;
+		std::vector<int64_t> offsets(cells.size());
+		std::vector<uint8_t> types(cells.size());
+		for (int i = 0; i < cells.size(); ++i)
+		{
+			connectivity.insert(connectivity.end(), cells[i].begin(), cells[i].end());
+			offsets[i] = connectivity.size();
+			const int type = cell_type(points.cols(), cells[i].size(), is_simplicial);
+			types[i] = type < 0 ? 7 : type; // VTK_POLYGON
+		}
+
+		return write(path, points, connectivity, offsets, types);
+	}
+
+	bool VTUAppendedWriter::write(const std::string &path, const Eigen::MatrixXd &points, const std::vector<int64_t> &connectivity, const std::vector<int64_t> &offsets, const std::vector<uint8_t> &types)
+	{
+		const int n_points = points.rows();
+
+		// layout of the appended section, every array is preceded by its size in bytes
+		size_t size = 0;
+		std::vector<Array> arrays;
+		const auto add_array = [&](const std::string &name, const Eigen::MatrixXd &data, const int n_components) {
+			arrays.push_back({name, &data, n_components, size});
+			size += sizeof(uint64_t) + size_t(n_points) * n_components * sizeof(double);
+		};
+		for (const auto &[name, data] : fields_)
+		{
+			if (data.rows() != n_points)
+			{
+				logger().warn("Skipping field {} of {}, it has {} values for {} points", name, path, data.rows(), n_points);
+				continue;
+			}
+			add_array(name, data, data.cols() == 2 ? 3 : data.cols());
+		}
+		add_array("Points", points, 3);
+
+		const size_t connectivity_offset = size;
+		size += sizeof(uint64_t) + connectivity.size() * sizeof(int64_t);
+		const size_t offsets_offset = size;
+		size += sizeof(uint64_t) + offsets.size() * sizeof(int64_t);
+		const size_t types_offset = size;
+		size += sizeof(uint64_t) + types.size() * sizeof(uint8_t);
+
+		std::string header = fmt::format(
+			"<?xml version=\"1.0\"?>\n"
+			"<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"{}\" header_type=\"UInt64\">\n"
+			"  <UnstructuredGrid>\n"
+			"    <Piece NumberOfPoints=\"{:d}\" NumberOfCells=\"{:d}\">\n"
+			"      <PointData>\n",
+			is_little_endian() ? "LittleEndian" : "BigEndian", n_points, types.size());
+		for (int i = 0; i < arrays.size() - 1; ++i)
+			header += fmt::format(
+				"        <DataArray type=\"Float64\" Name=\"{}\" NumberOfComponents=\"{:d}\" format=\"appended\" offset=\"{:d}\"/>\n",
+				arrays[i].name, arrays[i].n_components, arrays[i].offset);
+		header += fmt::format(
+			"      </PointData>\n"
+			"      <Points>\n"
+			"        <DataArray type=\"Float64\" Name=\"Points\" NumberOfComponents=\"3\" format=\"appended\" offset=\"{:d}\"/>\n"
+			"      </Points>\n"
+			"      <Cells>\n"
+			"        <DataArray type=\"Int64\" Name=\"connectivity\" format=\"appended\" offset=\"{:d}\"/>\n"
+			"        <DataArray type=\"Int64\" Name=\"offsets\" format=\"appended\" offset=\"{:d}\"/>\n"
+			"        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"{:d}\"/>\n"
+			"      </Cells>\n"
+			"    </Piece>\n"
+			"  </UnstructuredGrid>\n"
+			"  <AppendedData encoding=\"raw\">\n"
+			"   _",
+			arrays.back().offset, connectivity_offset, offsets_offset, types_offset);
+		const std::string footer = "\n  </AppendedData>\n</VTKFile>\n";
+
+		std::string out;
+		out.resize(header.size() + size + footer.size());
+		std::memcpy(out.data(), header.data(), header.size());
+		char *const appended = out.data() + header.size();
+
+		const auto write_block = [&](const size_t offset, const void *data, const uint64_t bytes) {
+			std::memcpy(appended + offset, &bytes, sizeof(uint64_t));
+			if (bytes > 0)
+				std::memcpy(appended + offset + sizeof(uint64_t), data, bytes);
+		};
+
+		for (const Array &array : arrays)
+		{
+			const Eigen::MatrixXd &data = *array.data;
+			const uint64_t bytes = size_t(n_points) * array.n_components * sizeof(double);
+			std::memcpy(appended + array.offset, &bytes, sizeof(uint64_t));
+			char *const values = appended + array.offset + sizeof(uint64_t);
+
+			// the matrices are column major, vtk tuples are interleaved
+			utils::maybe_parallel_for(n_points, [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					for (int j = 0; j < array.n_components; ++j)
+					{
+						const double value = j < data.cols() ? data(i, j) : 0.;
+						std::memcpy(values + (size_t(i) * array.n_components + j) * sizeof(double), &value, sizeof(double));
+					}
+				}
+			});
+		}
+		write_block(connectivity_offset, connectivity.data(), connectivity.size() * sizeof(int64_t));
+		write_block(offsets_offset, offsets.data(), offsets.size() * sizeof(int64_t));
+		write_block(types_offset, types.data(), types.size() * sizeof(uint8_t));
+
+		std::memcpy(out.data() + header.size() + size, footer.data(), footer.size());
+
+		std::ofstream file(path, std::ios::out | std::ios::binary);
+		if (!file.is_open())
+			return false;
+		file.write(out.data(), out.size());
+		return bool(file);
+	}
+} // namespace polyfem::io
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace polyfem::io
+{
+	/// Writes vtu files with the raw binary appended encoding: the xml header is followed by the arrays as they are in memory,
+	/// assembled in one buffer and written with a single call. Only supports linear cells (points, lines, triangles, quads, tets, and hexes),
+	/// paraviewo::VTUWriter handles the others.
+	class VTUAppendedWriter
+	{
+	public:
+		/// @brief Add point data, 2D vectors are padded to 3D
+		void add_field(const std::string &name, const Eigen::MatrixXd &data);
+
+		/// @brief True if the cells have a linear vtk type, see write_mesh
+		static bool supports(const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells);
+		static bool supports(const Eigen::MatrixXd &points, const std::vector<std::vector<int>> &cells, const bool is_simplicial = true, const bool has_poly = false);
+
+		/// @brief Write the mesh with the fields added so far
+		/// @param[in] path vtu file
+		/// @param[in] points mesh points, 2D points are padded with 0
+		/// @param[in] cells cells, the vertex count and the dimension define the cell type
+		/// @return false if the file cannot be written
+		bool write_mesh(const std::string &path, const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells);
+		bool write_mesh(const std::string &path, const Eigen::MatrixXd &points, const std::vector<std::vector<int>> &cells, const bool is_simplicial = true, const bool has_poly = false);
+
+	private:
+		/// @brief vtk type of a linear cell, -1 if not supported
+		static int cell_type(const int dim, const int n_vertices, const bool is_simplicial);
+
+		bool write(const std::string &path, const Eigen::MatrixXd &points, const std::vector<int64_t> &connectivity, const std::vector<int64_t> &offsets, const std::vector<uint8_t> &types);
+
+		std::vector<std::pair<std::string, Eigen::MatrixXd>> fields_;
+	};
+} // namespace polyfem::io
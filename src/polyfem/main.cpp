@@ -1,14 +1,24 @@
+#include <algorithm>
+#include <array>
 #include <filesystem>
+#include <fstream>
+#include <list>
+#include <thread>
 
 #include <CLI/CLI.hpp>
 
+#include <igl/Timer.h>
+
 #include <h5pp/h5pp.h>
 
 #include <polyfem/State.hpp>
 #include <polyfem/OptState.hpp>
 
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/JSONSpec.hpp>
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/Profiler.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/io/YamlToJson.hpp>
 
 using namespace polyfem;
@@ -60,7 +70,18 @@ int forward_simulation(const CLI::App &command_line,
 					   const bool is_strict,
 					   const bool fallback_solver,
 					   const spdlog::level::level_enum &log_level,
-					   json &in_args);
+					   json &in_args,
+					   const json &args_patch = json::object());
+
+int thread_scaling(const CLI::App &command_line,
+				   const std::string &hdf5_file,
+				   const std::string output_dir,
+				   const unsigned max_threads,
+				   const bool is_strict,
+				   const bool fallback_solver,
+				   const spdlog::level::level_enum &log_level,
+				   const json &in_args,
+				   const std::string &report_path);
 
 int optimization_simulation(const CLI::App &command_line,
 							const unsigned max_threads,
@@ -68,6 +89,16 @@ int optimization_simulation(const CLI::App &command_line,
 							const spdlog::level::level_enum &log_level,
 							json &opt_args);
 
+int server(const CLI::App &command_line,
+		   const std::string &requests_path,
+		   const std::string &responses_path,
+		   const int max_states,
+		   const std::string output_dir,
+		   const unsigned max_threads,
+		   const bool is_strict,
+		   const bool fallback_solver,
+		   const spdlog::level::level_enum &log_level);
+
 int main(int argc, char **argv)
 {
 	using namespace polyfem;
@@ -81,6 +112,9 @@ int main(int argc, char **argv)
 	unsigned max_threads = std::numeric_limits<unsigned>::max();
 	command_line.add_option("--max_threads", max_threads, "Maximum number of threads");
 
+	std::string thread_scaling_report = "";
+	command_line.add_option("--thread_scaling", thread_scaling_report, "Reruns the simulation with 1, 2, 4, ... max_threads threads and writes the per-phase speedups to this json file");
+
 	auto input = command_line.add_option_group("input");
 
 	std::string json_file = "";
@@ -92,8 +126,17 @@ int main(int argc, char **argv)
 	std::string hdf5_file = "";
 	input->add_option("--hdf5", hdf5_file, "Simulation HDF5 file")->check(CLI::ExistingFile);
 
+	std::string server_requests = "";
+	input->add_option("--server", server_requests, "Runs as a server reading one simulation request per line from this file or pipe");
+
 	input->require_option(1);
 
+	std::string server_responses = "";
+	command_line.add_option("--server_responses", server_responses, "File or pipe where the server writes one response per line")->needs("--server");
+
+	int server_states = 4;
+	command_line.add_option("--server_states", server_states, "Number of simulations kept warm by the server")->needs("--server");
+
 	std::string output_dir = "";
 	command_line.add_option("-o,--output_dir", output_dir, "Directory for output files")->check(CLI::ExistingDirectory | CLI::NonexistentPath);
 
@@ -103,6 +146,9 @@ int main(int argc, char **argv)
 	bool fallback_solver = false;
 	command_line.add_flag("--enable_overwrite_solver", fallback_solver, "If solver in input is not present, falls back to default.");
 
+	std::string spec_cache_dir = "";
+	command_line.add_option("--spec_cache", spec_cache_dir, "Directory caching the processed input specs across runs");
+
 	const std::vector<std::pair<std::string, spdlog::level::level_enum>>
 		SPDLOG_LEVEL_NAMES_TO_LEVELS = {
 			{"trace", spdlog::level::trace},
@@ -118,6 +164,12 @@ int main(int argc, char **argv)
 
 	CLI11_PARSE(command_line, argc, argv);
 
+	utils::set_spec_cache_directory(spec_cache_dir);
+
+	if (!server_requests.empty())
+		return server(command_line, server_requests, server_responses, server_states, output_dir,
+					  max_threads, is_strict, fallback_solver, log_level);
+
 	json in_args = json({});
 
 	if (!json_file.empty() || !yaml_file.empty())
@@ -129,15 +181,41 @@ int main(int argc, char **argv)
 
 		if (in_args.contains("states"))
 			return optimization_simulation(command_line, max_threads, is_strict, log_level, in_args);
+		else if (!thread_scaling_report.empty())
+			return thread_scaling(command_line, "", output_dir, max_threads,
+								  is_strict, fallback_solver, log_level, in_args, thread_scaling_report);
 		else
 			return forward_simulation(command_line, "", output_dir, max_threads,
 									  is_strict, fallback_solver, log_level, in_args);
 	}
+	else if (!thread_scaling_report.empty())
+		return thread_scaling(command_line, hdf5_file, output_dir, max_threads,
+							  is_strict, fallback_solver, log_level, in_args, thread_scaling_report);
 	else
 		return forward_simulation(command_line, hdf5_file, output_dir, max_threads,
 								  is_strict, fallback_solver, log_level, in_args);
 }
 
+/// settings of the simulation given on the command line
+json command_line_patch(const CLI::App &command_line,
+						const std::string output_dir,
+						const unsigned max_threads,
+						const bool fallback_solver,
+						const spdlog::level::level_enum &log_level)
+{
+	json tmp = json::object();
+	if (has_arg(command_line, "log_level"))
+		tmp["/output/log/level"_json_pointer] = int(log_level);
+	if (has_arg(command_line, "max_threads"))
+		tmp["/solver/max_threads"_json_pointer] = max_threads;
+	if (has_arg(command_line, "output_dir"))
+		tmp["/output/directory"_json_pointer] = std::filesystem::absolute(output_dir);
+	if (has_arg(command_line, "enable_overwrite_solver"))
+		tmp["/solver/linear/enable_overwrite_solver"_json_pointer] = fallback_solver;
+	assert(tmp.is_object());
+	return tmp;
+}
+
 int forward_simulation(const CLI::App &command_line,
 					   const std::string &hdf5_file,
 					   const std::string output_dir,
@@ -145,7 +223,8 @@ int forward_simulation(const CLI::App &command_line,
 					   const bool is_strict,
 					   const bool fallback_solver,
 					   const spdlog::level::level_enum &log_level,
-					   json &in_args)
+					   json &in_args,
+					   const json &args_patch)
 {
 	std::vector<std::string> names;
 	std::vector<Eigen::MatrixXi> cells;
@@ -159,37 +238,33 @@ int forward_simulation(const CLI::App &command_line,
 
 	if (in_args.empty() && !hdf5_file.empty())
 	{
-		using MatrixXl = Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic>;
-
-		h5pp::File file(hdf5_file, h5pp::FileAccess::READONLY);
-		std::string json_string = file.readDataset<std::string>("json");
+		{
+			h5pp::File file(hdf5_file, h5pp::FileAccess::READONLY);
+			std::string json_string = file.readDataset<std::string>("json");
 
-		in_args = json::parse(json_string);
-		in_args["root_path"] = hdf5_file;
+			in_args = json::parse(json_string);
+			in_args["root_path"] = hdf5_file;
 
-		names = file.findGroups("", "/meshes");
+			names = file.findGroups("", "/meshes");
+		}
 		cells.resize(names.size());
 		vertices.resize(names.size());
 
+		// read by blocks directly into the mesh storage, the cells are stored as int64
 		for (int i = 0; i < names.size(); ++i)
 		{
 			const std::string &name = names[i];
-			cells[i] = file.readDataset<MatrixXl>("/meshes/" + name + "/c").cast<int>();
-			vertices[i] = file.readDataset<Eigen::MatrixXd>("/meshes/" + name + "/v");
+			if (!io::read_matrix_chunked<int64_t>(hdf5_file, "/meshes/" + name + "/c", cells[i])
+				|| !io::read_matrix_chunked<double>(hdf5_file, "/meshes/" + name + "/v", vertices[i]))
+			{
+				logger().error("Unable to read mesh {} from {}", name, hdf5_file);
+				return EXIT_FAILURE;
+			}
 		}
 	}
 
-	json tmp = json::object();
-	if (has_arg(command_line, "log_level"))
-		tmp["/output/log/level"_json_pointer] = int(log_level);
-	if (has_arg(command_line, "max_threads"))
-		tmp["/solver/max_threads"_json_pointer] = max_threads;
-	if (has_arg(command_line, "output_dir"))
-		tmp["/output/directory"_json_pointer] = std::filesystem::absolute(output_dir);
-	if (has_arg(command_line, "enable_overwrite_solver"))
-		tmp["/solver/linear/enable_overwrite_solver"_json_pointer] = fallback_solver;
-	assert(tmp.is_object());
-	in_args.merge_patch(tmp);
+	in_args.merge_patch(command_line_patch(command_line, output_dir, max_threads, fallback_solver, log_level));
+	in_args.merge_patch(args_patch);
 
 	State state;
 	state.init(in_args, is_strict);
@@ -214,12 +289,152 @@ int forward_simulation(const CLI::App &command_line,
 
 	state.solve_problem(sol, pressure);
 
+	if (state.args["space"]["adaptive_p_ref"]["enabled"] && !state.problem->is_time_dependent())
+	{
+		const int max_iterations = state.args["space"]["adaptive_p_ref"]["max_iterations"];
+		for (int i = 0; i < max_iterations && state.p_refine(sol) > 0; ++i)
+		{
+			state.assemble_rhs();
+			state.assemble_mass_mat();
+
+			sol.resize(0, 0);
+			pressure.resize(0, 0);
+			state.solve_problem(sol, pressure);
+		}
+	}
+
 	state.compute_errors(sol);
 
 	logger().info("total time: {}s", state.timings.total_time());
 
-	state.save_json(sol);
+	// the statistics are saved last so they include the memory of the output phase
 	state.export_data(sol, pressure);
+	state.save_json(sol);
+
+	return EXIT_SUCCESS;
+}
+
+namespace
+{
+	/// time of every phase of the scaling report, from the profiler zones of the run
+	/// assembly, contact and linear_solve use the self time of the zones (without the nested ones)
+	/// so that they do not overlap, for the nonlinear problems linear_solve is the time of the
+	/// nonlinear solver outside of the forms, which is dominated by the linear solves.
+	/// remeshing is the total time of the remeshing, including its local solves.
+	json scaling_phases(const json &zones, const double total)
+	{
+		const auto starts_with = [](const std::string &s, const std::string &prefix) { return s.rfind(prefix, 0) == 0; };
+
+		json phases = {
+			{"assembly", 0.0},
+			{"contact", 0.0},
+			{"linear_solve", 0.0},
+			{"output", 0.0},
+			{"remeshing", 0.0},
+			{"total", total}};
+
+		for (const auto &[name, zone] : zones.items())
+		{
+			const double self = zone["self"];
+			if (name.find("Assembler::") != std::string::npos)
+				phases["assembly"] = phases["assembly"].get<double>() + self;
+			else if (starts_with(name, "contact::") || starts_with(name, "friction::"))
+				phases["contact"] = phases["contact"].get<double>() + self;
+			else if (name == "State::solve_linear" || name == "State::solve_tensor_nonlinear")
+				phases["linear_solve"] = phases["linear_solve"].get<double>() + self;
+			else if (name == "State::export_data" || name == "State::save_timestep")
+				phases["output"] = phases["output"].get<double>() + zone["total"].get<double>();
+			else if (name == "State::remesh")
+				phases["remeshing"] = phases["remeshing"].get<double>() + zone["total"].get<double>();
+		}
+
+		return phases;
+	}
+} // namespace
+
+int thread_scaling(const CLI::App &command_line,
+				   const std::string &hdf5_file,
+				   const std::string output_dir,
+				   const unsigned max_threads,
+				   const bool is_strict,
+				   const bool fallback_solver,
+				   const spdlog::level::level_enum &log_level,
+				   const json &in_args,
+				   const std::string &report_path)
+{
+	// a phase plateaus when doubling the threads improves its speedup by less than this
+	constexpr double plateau_gain = 1.1;
+	// phases shorter than this are not meaningful
+	constexpr double min_phase_time = 1e-3;
+
+	const unsigned n_threads = std::max(1u, std::min(max_threads, std::thread::hardware_concurrency()));
+	std::vector<unsigned> thread_counts;
+	for (unsigned t = 1; t < n_threads; t *= 2)
+		thread_counts.push_back(t);
+	thread_counts.push_back(n_threads);
+
+	json runs = json::array();
+	for (const unsigned t : thread_counts)
+	{
+		logger().info("Thread scaling: running with {} threads", t);
+
+		// a fresh copy every time, an hdf5 input is read again by forward_simulation
+		json run_args = in_args;
+		json args_patch;
+		args_patch["/solver/max_threads"_json_pointer] = t;
+		args_patch["/output/profile/enabled"_json_pointer] = true;
+
+		igl::Timer timer;
+		timer.start();
+		const int status = forward_simulation(command_line, hdf5_file, output_dir, t, is_strict, fallback_solver, log_level, run_args, args_patch);
+		timer.stop();
+		if (status != EXIT_SUCCESS)
+			return status;
+
+		runs.push_back({{"threads", t}, {"phases", scaling_phases(utils::Profiler::get().summary(), timer.getElapsedTime())}});
+	}
+	utils::Profiler::get().disable();
+
+	json report;
+	report["threads"] = thread_counts;
+	report["plateau_gain"] = plateau_gain;
+	report["phases"] = json::object();
+
+	logger().info("{:>14} {:>8} {:>12} {:>9} {:>11}", "phase", "threads", "time (s)", "speedup", "efficiency");
+	for (const auto &[phase, t1] : runs[0]["phases"].items())
+	{
+		if (t1.get<double>() < min_phase_time)
+			continue;
+
+		json &r = report["phases"][phase];
+		r["time"] = json::array();
+		r["speedup"] = json::array();
+		r["efficiency"] = json::array();
+		r["plateau_threads"] = nullptr;
+
+		for (int i = 0; i < runs.size(); ++i)
+		{
+			const double time = runs[i]["phases"][phase];
+			const double speedup = time > 0 ? t1.get<double>() / time : 0;
+			const double efficiency = speedup / thread_counts[i];
+			r["time"].push_back(time);
+			r["speedup"].push_back(speedup);
+			r["efficiency"].push_back(efficiency);
+
+			if (i > 0 && r["plateau_threads"].is_null() && speedup < plateau_gain * r["speedup"][i - 1].get<double>())
+				r["plateau_threads"] = thread_counts[i];
+
+			logger().info("{:>14} {:>8} {:>12.4g} {:>9.2f} {:>10.0f}%", i == 0 ? phase : "", thread_counts[i], time, speedup, 100 * efficiency);
+		}
+
+		if (!r["plateau_threads"].is_null())
+			logger().warn("Phase {} plateaus at {} threads (speedup {:.2f})", phase, r["plateau_threads"].get<unsigned>(), r["speedup"].back().get<double>());
+	}
+
+	std::ofstream out(report_path);
+	if (!out.is_open())
+		log_and_throw_error("Unable to write {}", report_path);
+	out << report.dump(4) << std::endl;
 
 	return EXIT_SUCCESS;
 }
@@ -256,3 +471,158 @@ int optimization_simulation(const CLI::App &command_line,
 	opt_state.solve(x);
 	return EXIT_SUCCESS;
 }
+
+namespace
+{
+	/// entries of a request that can change without rebuilding the simulation, see State::update_load_case
+	const std::array<std::string, 3> load_case_keys = {{"boundary_conditions", "initial_conditions", "materials"}};
+
+	/// the requests with the same key share the mesh, the bases, and the assembly caches
+	std::string warm_state_key(const json &args)
+	{
+		json key = args;
+		for (const std::string &k : load_case_keys)
+		{
+			if (key.contains(k))
+				key[k] = nullptr;
+		}
+		return key.dump();
+	}
+
+	/// builds and solves a new simulation
+	std::unique_ptr<State> cold_solve(const json &args, const bool is_strict, Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
+	{
+		auto state = std::make_unique<State>();
+		state->init(args, is_strict);
+		state->keep_linear_factorization = true;
+		state->load_mesh();
+		if (state->mesh == nullptr)
+			log_and_throw_error("Unable to load the mesh of the request");
+
+		state->stats.compute_mesh_stats(*state->mesh);
+		state->build_basis();
+		state->assemble_rhs();
+		state->assemble_mass_mat();
+
+		state->solve_problem(sol, pressure);
+		return state;
+	}
+} // namespace
+
+int server(const CLI::App &command_line,
+		   const std::string &requests_path,
+		   const std::string &responses_path,
+		   const int max_states,
+		   const std::string output_dir,
+		   const unsigned max_threads,
+		   const bool is_strict,
+		   const bool fallback_solver,
+		   const spdlog::level::level_enum &log_level)
+{
+	if (responses_path.empty())
+	{
+		logger().error("The server needs a --server_responses file!");
+		return command_line.exit(CLI::RequiredError("--server_responses"));
+	}
+
+	// opening a pipe blocks until the client opens the other end
+	std::ifstream requests(requests_path);
+	if (!requests.is_open())
+		log_and_throw_error("Unable to open {}", requests_path);
+	std::ofstream responses(responses_path);
+	if (!responses.is_open())
+		log_and_throw_error("Unable to open {}", responses_path);
+
+	const json patch = command_line_patch(command_line, output_dir, max_threads, fallback_solver, log_level);
+
+	// most recently used first
+	std::list<std::pair<std::string, std::unique_ptr<State>>> states;
+
+	logger().info("Server waiting for requests on {}", requests_path);
+
+	std::string line;
+	while (std::getline(requests, line))
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+
+		json response = json::object();
+		igl::Timer timer;
+		timer.start();
+		try
+		{
+			const json request = json::parse(line);
+			if (request.contains("id"))
+				response["id"] = request["id"];
+			if (request.value("exit", false))
+			{
+				response["status"] = "ok";
+				responses << response.dump() << std::endl;
+				break;
+			}
+			if (!request.contains("args") || !request["args"].is_object())
+				log_and_throw_error("A request needs an \"args\" object with the simulation");
+
+			json args = request["args"];
+			if (!args.contains("root_path"))
+				args["root_path"] = requests_path;
+			args.merge_patch(patch);
+
+			const std::string key = warm_state_key(args);
+			auto it = std::find_if(states.begin(), states.end(), [&](const auto &s) { return s.first == key; });
+
+			Eigen::MatrixXd sol, pressure;
+			if (it != states.end())
+			{
+				states.splice(states.begin(), states, it);
+				State &state = *states.front().second;
+
+				json load_case = json::object();
+				for (const std::string &k : load_case_keys)
+				{
+					if (args.contains(k))
+						load_case[k] = args[k];
+				}
+
+				try
+				{
+					state.solve_load_case(load_case, sol, pressure);
+				}
+				catch (...)
+				{
+					// the state may be left half updated
+					states.pop_front();
+					throw;
+				}
+				response["warm"] = true;
+			}
+			else
+			{
+				std::unique_ptr<State> state = cold_solve(args, is_strict, sol, pressure);
+				states.emplace_front(key, std::move(state));
+				if (states.size() > size_t(std::max(max_states, 1)))
+					states.pop_back();
+				response["warm"] = false;
+			}
+
+			State &state = *states.front().second;
+			state.export_data(sol, pressure);
+			state.save_json(sol);
+
+			response["status"] = "ok";
+			response["output_directory"] = state.output_dir;
+		}
+		catch (const std::exception &e)
+		{
+			logger().error("Request failed: {}", e.what());
+			response["status"] = "error";
+			response["message"] = e.what();
+		}
+		timer.stop();
+		response["time"] = timer.getElapsedTime();
+
+		responses << response.dump() << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "ElementLocator.hpp"
+
+#include <polyfem/utils/GeometryUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <cassert>
+#include <limits>
+
+namespace polyfem::mesh
+{
+	ElementLocator::ElementLocator(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const double tol)
+		: V_(V), F_(F), tol_(tol)
+	{
+		assert(F.size() == 0 || F.cols() == V.cols() + 1);
+
+		std::vector<std::array<Eigen::Vector3d, 2>> boxes(F.rows());
+		for (int e = 0; e < F.rows(); ++e)
+		{
+			const Eigen::MatrixXd nodes = V(F.row(e), Eigen::all);
+			boxes[e][0].setZero();
+			boxes[e][0].head(dim()) = nodes.colwise().minCoeff();
+			boxes[e][1].setZero();
+			boxes[e][1].head(dim()) = nodes.colwise().maxCoeff();
+		}
+		bvh_.init(boxes);
+	}
+
+	void ElementLocator::intersect_box(const VectorNd &min, const VectorNd &max, std::vector<unsigned int> &candidates) const
+	{
+		assert(min.size() == dim() && max.size() == dim());
+
+		Eigen::Vector3d bbox_min = Eigen::Vector3d::Zero();
+		bbox_min.head(dim()) = min;
+		Eigen::Vector3d bbox_max = Eigen::Vector3d::Zero();
+		bbox_max.head(dim()) = max;
+
+		candidates.clear();
+		if (n_elements() > 0)
+			bvh_.intersect_box(bbox_min, bbox_max, candidates);
+	}
+
+	int ElementLocator::locate(const VectorNd &p, Eigen::VectorXd &bc) const
+	{
+		const VectorNd eps = VectorNd::Constant(dim(), tol_);
+		std::vector<unsigned int> candidates;
+		intersect_box(p - eps, p + eps, candidates);
+
+		// on a shared facet, keep the element the point is the deepest in
+		int best = -1;
+		double best_min_bc = -tol_;
+		for (const unsigned int e : candidates)
+		{
+			const Eigen::MatrixXd nodes = V_(F_.row(e), Eigen::all);
+			const Eigen::VectorXd coords = utils::barycentric_coordinates(p, nodes);
+			const double min_bc = coords.minCoeff();
+			if (min_bc >= best_min_bc)
+			{
+				best = e;
+				best_min_bc = min_bc;
+				bc = coords;
+			}
+		}
+
+		return best;
+	}
+
+	void ElementLocator::locate(const Eigen::MatrixXd &P, Eigen::VectorXi &elements, Eigen::MatrixXd &bc) const
+	{
+		assert(P.cols() == dim());
+
+		elements.resize(P.rows());
+		bc.setZero(P.rows(), dim() + 1);
+
+		utils::maybe_parallel_for(P.rows(), [&](int start, int end, int thread_id) {
+			Eigen::VectorXd coords;
+			for (int i = start; i < end; ++i)
+			{
+				elements[i] = locate(P.row(i).transpose(), coords);
+				if (elements[i] >= 0)
+					bc.row(i) = coords.transpose();
+			}
+		});
+	}
+
+	Eigen::MatrixXd ElementLocator::interpolate(const Eigen::MatrixXd &P, const Eigen::MatrixXd &values) const
+	{
+		assert(values.rows() == V_.rows());
+
+		Eigen::VectorXi elements;
+		Eigen::MatrixXd bc;
+		locate(P, elements, bc);
+
+		Eigen::MatrixXd res(P.rows(), values.cols());
+		utils::maybe_parallel_for(P.rows(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				if (elements[i] < 0)
+				{
+					res.row(i).setConstant(std::numeric_limits<double>::quiet_NaN());
+					continue;
+				}
+
+				res.row(i).setZero();
+				for (int j = 0; j < F_.cols(); ++j)
+					res.row(i) += bc(i, j) * values.row(F_(elements[i], j));
+			}
+		});
+
+		return res;
+	}
+} // namespace polyfem::mesh
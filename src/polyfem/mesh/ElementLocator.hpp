@@ -0,0 +1,55 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <SimpleBVH/BVH.hpp>
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem::mesh
+{
+	/// @brief AABB tree over the simplices of a mesh, built once to locate many points.
+	/// The queries are const and can be issued from several threads.
+	class ElementLocator
+	{
+	public:
+		ElementLocator() = default;
+
+		/// @brief Build the tree
+		/// @param[in] V vertices of the mesh, #V x dim
+		/// @param[in] F simplices of the mesh, #F x (dim + 1)
+		/// @param[in] tol tolerance on the barycentric coordinates for a point to be inside a simplex
+		ElementLocator(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const double tol = 1e-8);
+
+		int dim() const { return V_.cols(); }
+		int n_elements() const { return F_.rows(); }
+
+		/// @brief Element containing p, -1 if p is outside the mesh
+		/// @param[in] p query point
+		/// @param[out] bc barycentric coordinates of p, one per vertex of the element
+		int locate(const VectorNd &p, Eigen::VectorXd &bc) const;
+
+		/// @brief Locate the rows of P in parallel
+		/// @param[in] P query points, #P x dim
+		/// @param[out] elements element containing each point, -1 if outside
+		/// @param[out] bc barycentric coordinates of each point, #P x (dim + 1)
+		void locate(const Eigen::MatrixXd &P, Eigen::VectorXi &elements, Eigen::MatrixXd &bc) const;
+
+		/// @brief Linear interpolation of per vertex values at the rows of P, NaN outside the mesh
+		/// @param[in] P query points, #P x dim
+		/// @param[in] values values at the vertices, #V x n
+		/// @return interpolated values, #P x n
+		Eigen::MatrixXd interpolate(const Eigen::MatrixXd &P, const Eigen::MatrixXd &values) const;
+
+		/// @brief Elements whose bounding box intersects the box [min, max]
+		void intersect_box(const VectorNd &min, const VectorNd &max, std::vector<unsigned int> &candidates) const;
+
+	private:
+		Eigen::MatrixXd V_;
+		Eigen::MatrixXi F_;
+		double tol_ = 1e-8;
+		SimpleBVH::BVH bvh_;
+	};
+} // namespace polyfem::mesh
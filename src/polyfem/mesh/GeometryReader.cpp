@@ -8,6 +8,7 @@
 #include <polyfem/utils/JSONUtils.hpp>
 #include <polyfem/utils/Selection.hpp>
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <Eigen/Core>
 
@@ -17,6 +18,8 @@
 #include <strnatcmp.h>
 #include <glob/glob.h>
 #include <filesystem>
+#include <map>
+#include <numeric>
 
 namespace polyfem::mesh
 {
@@ -31,10 +34,23 @@ namespace polyfem::mesh
 		if (!is_param_valid(j_mesh, "mesh"))
 			log_and_throw_error("Mesh {} is mising a \"mesh\" field!", j_mesh);
 
+		const std::unique_ptr<Mesh> loaded = Mesh::create(resolve_path(j_mesh["mesh"], root_path), non_conforming);
+		if (loaded == nullptr)
+			log_and_throw_error("Unable to read mesh: {}", j_mesh["mesh"]);
+
+		return read_fem_mesh(units, j_mesh, root_path, *loaded);
+	}
+
+	std::unique_ptr<Mesh> read_fem_mesh(
+		const Units &units,
+		const json &j_mesh,
+		const std::string &root_path,
+		const Mesh &loaded)
+	{
 		if (j_mesh["extract"].get<std::string>() != "volume")
 			log_and_throw_error("Only volumetric elements are implemented for FEM meshes!");
 
-		std::unique_ptr<Mesh> mesh = Mesh::create(resolve_path(j_mesh["mesh"], root_path), non_conforming);
+		std::unique_ptr<Mesh> mesh = loaded.copy();
 
 		// --------------------------------------------------------------------
 
@@ -168,16 +184,15 @@ namespace polyfem::mesh
 
 		if (!surface_selections.empty())
 		{
-			mesh->compute_boundary_ids([&](const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p, bool is_boundary) {
-				if (!is_boundary)
-					return -1;
+			std::vector<int> boundary;
+			const SelectionPrimitives primitives = SelectionPrimitives::boundary_facets(*mesh, boundary);
 
-				for (const auto &selection : surface_selections)
-				{
-					if (selection->inside(p_id, vs, p))
-						return selection->id(p_id, vs, p);
-				}
-				return std::numeric_limits<int>::max(); // default for no selected boundary
+			std::vector<int> boundary_ids(primitives.size(), -1);
+			// default for no selected boundary
+			Selection::compute_ids(surface_selections, primitives, boundary, std::numeric_limits<int>::max(), boundary_ids);
+
+			mesh->compute_boundary_ids([&](const size_t p_id, const std::vector<int> &, const RowVectorNd &, bool) {
+				return boundary_ids[p_id];
 			});
 		}
 
@@ -209,14 +224,15 @@ namespace polyfem::mesh
 			if (mesh->has_body_ids())
 				volume_selections.push_back(std::make_shared<SpecifiedSelection>(mesh->get_body_ids()));
 
-			mesh->compute_body_ids([&](const size_t cell_id, const std::vector<int> &vs, const RowVectorNd &p) -> int {
-				for (const auto &selection : volume_selections)
-				{
-					// TODO: add vs to compute_body_ids
-					if (selection->inside(cell_id, vs, p))
-						return selection->id(cell_id, vs, p);
-				}
-				return 0;
+			const SelectionPrimitives primitives = SelectionPrimitives::elements(*mesh);
+
+			std::vector<int> cells(primitives.size());
+			std::iota(cells.begin(), cells.end(), 0);
+			std::vector<int> body_ids(primitives.size());
+			Selection::compute_ids(volume_selections, primitives, cells, 0, body_ids);
+
+			mesh->compute_body_ids([&](const size_t cell_id, const std::vector<int> &, const RowVectorNd &) -> int {
+				return body_ids[cell_id];
 			});
 		}
 
@@ -267,8 +283,7 @@ namespace polyfem::mesh
 
 		// --------------------------------------------------------------------
 
-		std::unique_ptr<Mesh> mesh = nullptr;
-
+		std::vector<const json *> fem_geometries;
 		for (const json &geometry : geometries)
 		{
 			if (!geometry["enabled"].get<bool>() || geometry["is_obstacle"].get<bool>())
@@ -277,7 +292,46 @@ namespace polyfem::mesh
 			if (geometry["type"] != "mesh" && geometry["type"] != "mesh_array")
 				log_and_throw_error("Invalid geometry type \"{}\" for FEM mesh!", geometry["type"]);
 
-			const std::unique_ptr<Mesh> tmp_mesh = read_fem_mesh(units, geometry, root_path, non_conforming);
+			if (!is_param_valid(geometry, "mesh"))
+				log_and_throw_error("Mesh {} is mising a \"mesh\" field!", geometry);
+
+			fem_geometries.push_back(&geometry);
+		}
+
+		// Every distinct mesh file is parsed once, its instances are copies of it
+		std::map<std::string, std::unique_ptr<Mesh>> loaded;
+		for (const json *geometry : fem_geometries)
+		{
+			const std::string path = resolve_path((*geometry)["mesh"], root_path);
+			if (loaded.find(path) != loaded.end())
+				continue;
+
+			std::unique_ptr<Mesh> mesh = Mesh::create(path, non_conforming);
+			if (mesh == nullptr)
+				log_and_throw_error("Unable to read mesh: {}", path);
+			loaded.emplace(path, std::move(mesh));
+		}
+		if (loaded.size() < fem_geometries.size())
+			logger().debug("Instancing {} geometries from {} mesh files", fem_geometries.size(), loaded.size());
+
+		// The transformations, refinements, and selections of the instances are independent
+		std::vector<std::unique_ptr<Mesh>> instances(fem_geometries.size());
+		maybe_parallel_for(fem_geometries.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const json &geometry = *fem_geometries[i];
+				instances[i] = read_fem_mesh(units, geometry, root_path, *loaded.at(resolve_path(geometry["mesh"], root_path)));
+			}
+		});
+
+		// --------------------------------------------------------------------
+
+		std::unique_ptr<Mesh> mesh = nullptr;
+
+		for (int i = 0; i < fem_geometries.size(); ++i)
+		{
+			const json &geometry = *fem_geometries[i];
+			const std::unique_ptr<Mesh> &tmp_mesh = instances[i];
 
 			if (mesh == nullptr)
 				mesh = tmp_mesh->copy();
@@ -324,6 +378,167 @@ namespace polyfem::mesh
 
 	// ========================================================================
 
+	namespace
+	{
+		/// surface mesh of an obstacle file
+		struct ObstacleSurface
+		{
+			Eigen::MatrixXd vertices;
+			Eigen::VectorXi codim_vertices;
+			Eigen::MatrixXi codim_edges;
+			Eigen::MatrixXi faces;
+		};
+
+		/// transformation, extraction, and refinement of an obstacle mesh read from its file
+		void process_obstacle_mesh(
+			const Units &units,
+			const json &j_mesh,
+			const int dim,
+			Eigen::MatrixXd &vertices,
+			Eigen::VectorXi &codim_vertices,
+			Eigen::MatrixXi &codim_edges,
+			Eigen::MatrixXi &faces)
+		{
+			const int prev_dim = vertices.cols();
+			vertices.conservativeResize(vertices.rows(), dim);
+			if (prev_dim < dim)
+				vertices.rightCols(dim - prev_dim).setZero();
+
+			// --------------------------------------------------------------------
+
+			{
+				const std::string unit = j_mesh["unit"];
+				double unit_scale = 1;
+				if (!unit.empty())
+					unit_scale = Units::convert(1, unit, units.length());
+
+				const VectorNd mesh_dimensions = (vertices.colwise().maxCoeff() - vertices.colwise().minCoeff()).cwiseAbs();
+				MatrixNd A;
+				VectorNd b;
+				construct_affine_transformation(unit_scale, j_mesh["transformation"], mesh_dimensions, A, b);
+				vertices = vertices * A.transpose();
+				vertices.rowwise() += b.transpose();
+			}
+
+			std::string extract = j_mesh["extract"];
+			// Default: "volume" clashes with defaults for non obstacle, here assume volume is suface
+			if (extract == "volume")
+				extract = "surface";
+
+			if (extract == "points")
+			{
+				// points -> vertices (drop edges and faces)
+				codim_edges.resize(0, 0);
+				faces.resize(0, 0);
+				codim_vertices.resize(vertices.rows());
+				for (int i = 0; i < codim_vertices.size(); ++i)
+					codim_vertices[i] = i;
+			}
+			else if (extract == "edges" && faces.size() != 0)
+			{
+				// edges -> edges (drop faces)
+				Eigen::MatrixXi edges;
+				igl::edges(faces, edges);
+				faces.resize(0, 0);
+				codim_edges.conservativeResize(codim_edges.rows() + edges.rows(), 2);
+				codim_edges.bottomRows(edges.rows()) = edges;
+			}
+			else if (extract == "surface" && dim == 2 && faces.size() != 0)
+			{
+				// surface (2D) -> boundary edges (drop faces and interior edges)
+				Eigen::MatrixXi boundary_edges;
+				igl::boundary_facets(faces, boundary_edges);
+				codim_edges.conservativeResize(codim_edges.rows() + boundary_edges.rows(), 2);
+				codim_edges.bottomRows(boundary_edges.rows()) = boundary_edges;
+				faces.resize(0, 0); // Clear faces
+			}
+			// surface (3D) -> boundary faces
+			// No need to do anything for (extract == "surface" && dim == 3) since we used read_surface_mesh
+			else if (extract == "volume")
+			{
+				// volume -> undefined
+				log_and_throw_error("Volumetric elements not supported for collision obstacles!");
+			}
+
+			if (j_mesh["n_refs"].get<int>() != 0)
+			{
+				if (faces.size() != 0)
+					log_and_throw_error("Option \"n_refs\" for triangle obstacles not implement yet!");
+
+				const int n_refs = j_mesh["n_refs"];
+				const double refinement_location = j_mesh["advanced"]["refinement_location"];
+				for (int i = 0; i < n_refs; i++)
+				{
+					const size_t n_vertices = vertices.rows();
+					const size_t n_edges = codim_edges.rows();
+					vertices.conservativeResize(n_vertices + n_edges, vertices.cols());
+					codim_edges.conservativeResize(2 * n_edges, codim_edges.cols());
+					for (size_t ei = 0; ei < n_edges; ei++)
+					{
+						const int v0i = codim_edges(ei, 0);
+						const int v1i = codim_edges(ei, 1);
+						const int v2i = n_vertices + ei;
+						vertices.row(v2i) = (vertices.row(v1i) - vertices.row(v0i)) * refinement_location + vertices.row(v0i);
+						codim_edges.row(ei) << v0i, v2i;
+						codim_edges.row(n_edges + ei) << v2i, v1i;
+					}
+				}
+			}
+		}
+
+		/// replicates the obstacle mesh of a mesh_array geometry on its grid
+		void tile_obstacle_mesh_array(
+			const json &geometry,
+			const int dim,
+			Eigen::MatrixXd &vertices,
+			Eigen::VectorXi &codim_vertices,
+			Eigen::MatrixXi &codim_edges,
+			Eigen::MatrixXi &faces)
+		{
+			const Selection::BBox bbox{{vertices.colwise().minCoeff(), vertices.colwise().maxCoeff()}};
+
+			const bool is_offset_relative = geometry["array"]["relative"];
+			const double offset = geometry["array"]["offset"];
+			const VectorNd dimensions = (bbox[1] - bbox[0]);
+			const VectorNi size = geometry["array"]["size"];
+
+			const int N = size.head(dim).prod();
+			const int nV = vertices.rows(), nCV = codim_vertices.rows(), nCE = codim_edges.rows(), nF = faces.rows();
+
+			vertices.conservativeResize(N * nV, Eigen::NoChange);
+			codim_vertices.conservativeResize(N * nCV, Eigen::NoChange);
+			codim_edges.conservativeResize(N * nCE, Eigen::NoChange);
+			faces.conservativeResize(N * nF, Eigen::NoChange);
+
+			for (int i = 0; i < size[0]; ++i)
+			{
+				for (int j = 0; j < size[1]; ++j)
+				{
+					for (int k = 0; k < (size.size() > 2 ? size[2] : 1); ++k)
+					{
+						RowVectorNd translation = offset * Eigen::RowVector3d(i, j, k).head(vertices.cols());
+						if (is_offset_relative)
+							translation.array() *= dimensions.array();
+
+						int n = i * size[1] + j;
+						if (size.size() > 2)
+							n = n * size[2] + k;
+						if (n == 0)
+							continue;
+
+						vertices.middleRows(n * nV, nV) = vertices.topRows(nV).rowwise() + translation;
+						if (nCV)
+							codim_vertices.segment(n * nCV, nCV) = codim_vertices.head(nCV).array() + n * nV;
+						if (nCE)
+							codim_edges.middleRows(n * nCE, nCE) = codim_edges.topRows(nCE).array() + n * nV;
+						if (nF)
+							faces.middleRows(n * nF, nF) = faces.topRows(nF).array() + n * nV;
+					}
+				}
+			}
+		}
+	} // namespace
+
 	void read_obstacle_mesh(
 		const Units &units,
 		const json &j_mesh,
@@ -346,91 +561,7 @@ namespace polyfem::mesh
 			// error already logged in read_surface_mesh()
 			throw std::runtime_error(fmt::format("Unable to read mesh: {}", mesh_path));
 
-		const int prev_dim = vertices.cols();
-		vertices.conservativeResize(vertices.rows(), dim);
-		if (prev_dim < dim)
-			vertices.rightCols(dim - prev_dim).setZero();
-
-		// --------------------------------------------------------------------
-
-		{
-			const std::string unit = j_mesh["unit"];
-			double unit_scale = 1;
-			if (!unit.empty())
-				unit_scale = Units::convert(1, unit, units.length());
-
-			const VectorNd mesh_dimensions = (vertices.colwise().maxCoeff() - vertices.colwise().minCoeff()).cwiseAbs();
-			MatrixNd A;
-			VectorNd b;
-			construct_affine_transformation(unit_scale, j_mesh["transformation"], mesh_dimensions, A, b);
-			vertices = vertices * A.transpose();
-			vertices.rowwise() += b.transpose();
-		}
-
-		std::string extract = j_mesh["extract"];
-		// Default: "volume" clashes with defaults for non obstacle, here assume volume is suface
-		if (extract == "volume")
-			extract = "surface";
-
-		if (extract == "points")
-		{
-			// points -> vertices (drop edges and faces)
-			codim_edges.resize(0, 0);
-			faces.resize(0, 0);
-			codim_vertices.resize(vertices.rows());
-			for (int i = 0; i < codim_vertices.size(); ++i)
-				codim_vertices[i] = i;
-		}
-		else if (extract == "edges" && faces.size() != 0)
-		{
-			// edges -> edges (drop faces)
-			Eigen::MatrixXi edges;
-			igl::edges(faces, edges);
-			faces.resize(0, 0);
-			codim_edges.conservativeResize(codim_edges.rows() + edges.rows(), 2);
-			codim_edges.bottomRows(edges.rows()) = edges;
-		}
-		else if (extract == "surface" && dim == 2 && faces.size() != 0)
-		{
-			// surface (2D) -> boundary edges (drop faces and interior edges)
-			Eigen::MatrixXi boundary_edges;
-			igl::boundary_facets(faces, boundary_edges);
-			codim_edges.conservativeResize(codim_edges.rows() + boundary_edges.rows(), 2);
-			codim_edges.bottomRows(boundary_edges.rows()) = boundary_edges;
-			faces.resize(0, 0); // Clear faces
-		}
-		// surface (3D) -> boundary faces
-		// No need to do anything for (extract == "surface" && dim == 3) since we used read_surface_mesh
-		else if (extract == "volume")
-		{
-			// volume -> undefined
-			log_and_throw_error("Volumetric elements not supported for collision obstacles!");
-		}
-
-		if (j_mesh["n_refs"].get<int>() != 0)
-		{
-			if (faces.size() != 0)
-				log_and_throw_error("Option \"n_refs\" for triangle obstacles not implement yet!");
-
-			const int n_refs = j_mesh["n_refs"];
-			const double refinement_location = j_mesh["advanced"]["refinement_location"];
-			for (int i = 0; i < n_refs; i++)
-			{
-				const size_t n_vertices = vertices.rows();
-				const size_t n_edges = codim_edges.rows();
-				vertices.conservativeResize(n_vertices + n_edges, vertices.cols());
-				codim_edges.conservativeResize(2 * n_edges, codim_edges.cols());
-				for (size_t ei = 0; ei < n_edges; ei++)
-				{
-					const int v0i = codim_edges(ei, 0);
-					const int v1i = codim_edges(ei, 1);
-					const int v2i = n_vertices + ei;
-					vertices.row(v2i) = (vertices.row(v1i) - vertices.row(v0i)) * refinement_location + vertices.row(v0i);
-					codim_edges.row(ei) << v0i, v2i;
-					codim_edges.row(n_edges + ei) << v2i, v1i;
-				}
-			}
-		}
+		process_obstacle_mesh(units, j_mesh, dim, vertices, codim_vertices, codim_edges, faces);
 	}
 
 	// ========================================================================
@@ -476,69 +607,63 @@ namespace polyfem::mesh
 
 		std::vector<json> geometries = utils::json_as_array(geometry);
 
+		std::vector<const json *> mesh_geometries;
 		for (const json &geometry : geometries)
 		{
+			if (geometry["is_obstacle"].get<bool>() && geometry["enabled"].get<bool>()
+				&& (geometry["type"] == "mesh" || geometry["type"] == "mesh_array"))
+			{
+				if (!is_param_valid(geometry, "mesh"))
+					log_and_throw_error("Mesh obstacle {} is mising a \"mesh\" field!", geometry);
+				mesh_geometries.push_back(&geometry);
+			}
+		}
 
-			if (!geometry["is_obstacle"].get<bool>())
+		// Every distinct obstacle file is parsed once, its instances are copies of it
+		std::map<std::string, ObstacleSurface> loaded;
+		for (const json *geometry : mesh_geometries)
+		{
+			const std::string mesh_path = resolve_path((*geometry)["mesh"], root_path);
+			if (loaded.find(mesh_path) != loaded.end())
 				continue;
 
-			if (!geometry["enabled"].get<bool>())
-				continue;
+			ObstacleSurface surface;
+			if (!read_surface_mesh(mesh_path, surface.vertices, surface.codim_vertices, surface.codim_edges, surface.faces))
+				// error already logged in read_surface_mesh()
+				throw std::runtime_error(fmt::format("Unable to read mesh: {}", mesh_path));
+			loaded.emplace(mesh_path, std::move(surface));
+		}
 
-			if (geometry["type"] == "mesh" || geometry["type"] == "mesh_array")
+		std::vector<ObstacleSurface> surfaces(mesh_geometries.size());
+		maybe_parallel_for(mesh_geometries.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				Eigen::MatrixXd vertices;
-				Eigen::VectorXi codim_vertices;
-				Eigen::MatrixXi codim_edges;
-				Eigen::MatrixXi faces;
-				read_obstacle_mesh(units,
-								   geometry, root_path, dim, vertices, codim_vertices,
-								   codim_edges, faces);
-
+				const json &geometry = *mesh_geometries[i];
+				ObstacleSurface &surface = surfaces[i];
+				surface = loaded.at(resolve_path(geometry["mesh"], root_path));
+				process_obstacle_mesh(units, geometry, dim, surface.vertices, surface.codim_vertices, surface.codim_edges, surface.faces);
 				if (geometry["type"] == "mesh_array")
-				{
-					const Selection::BBox bbox{{vertices.colwise().minCoeff(), vertices.colwise().maxCoeff()}};
+					tile_obstacle_mesh_array(geometry, dim, surface.vertices, surface.codim_vertices, surface.codim_edges, surface.faces);
+			}
+		});
 
-					const bool is_offset_relative = geometry["array"]["relative"];
-					const double offset = geometry["array"]["offset"];
-					const VectorNd dimensions = (bbox[1] - bbox[0]);
-					const VectorNi size = geometry["array"]["size"];
+		int mesh_index = 0;
+		for (const json &geometry : geometries)
+		{
 
-					const int N = size.head(dim).prod();
-					const int nV = vertices.rows(), nCV = codim_vertices.rows(), nCE = codim_edges.rows(), nF = faces.rows();
+			if (!geometry["is_obstacle"].get<bool>())
+				continue;
 
-					vertices.conservativeResize(N * nV, Eigen::NoChange);
-					codim_vertices.conservativeResize(N * nCV, Eigen::NoChange);
-					codim_edges.conservativeResize(N * nCE, Eigen::NoChange);
-					faces.conservativeResize(N * nF, Eigen::NoChange);
+			if (!geometry["enabled"].get<bool>())
+				continue;
 
-					for (int i = 0; i < size[0]; ++i)
-					{
-						for (int j = 0; j < size[1]; ++j)
-						{
-							for (int k = 0; k < (size.size() > 2 ? size[2] : 1); ++k)
-							{
-								RowVectorNd translation = offset * Eigen::RowVector3d(i, j, k).head(vertices.cols());
-								if (is_offset_relative)
-									translation.array() *= dimensions.array();
-
-								int n = i * size[1] + j;
-								if (size.size() > 2)
-									n = n * size[2] + k;
-								if (n == 0)
-									continue;
-
-								vertices.middleRows(n * nV, nV) = vertices.topRows(nV).rowwise() + translation;
-								if (nCV)
-									codim_vertices.segment(n * nV, nV) = codim_vertices.head(nV).array() + n * nV;
-								if (nCE)
-									codim_edges.middleRows(n * nCE, nCE) = codim_edges.topRows(nCE).array() + n * nV;
-								if (nF)
-									faces.middleRows(n * nF, nF) = faces.topRows(nF).array() + n * nV;
-							}
-						}
-					}
-				}
+			if (geometry["type"] == "mesh" || geometry["type"] == "mesh_array")
+			{
+				const ObstacleSurface &surface = surfaces[mesh_index++];
+				const Eigen::MatrixXd &vertices = surface.vertices;
+				const Eigen::VectorXi &codim_vertices = surface.codim_vertices;
+				const Eigen::MatrixXi &codim_edges = surface.codim_edges;
+				const Eigen::MatrixXi &faces = surface.faces;
 
 				json displacement = "{\"value\":[0, 0, 0]}"_json;
 				if (is_param_valid(geometry, "surface_selection"))
@@ -639,6 +764,43 @@ namespace polyfem::mesh
 					});
 				}
 
+				if (geometry["stream"].get<bool>() && !mesh_files.empty())
+				{
+					Eigen::MatrixXd rest;
+					Eigen::VectorXi codim_vertices;
+					Eigen::MatrixXi codim_edges;
+					Eigen::MatrixXi faces;
+					{
+						json jmesh = geometry;
+						jmesh["mesh"] = mesh_files[0];
+						jmesh["n_refs"] = 0;
+						read_obstacle_mesh(units, jmesh, root_path, dim, rest, codim_vertices, codim_edges, faces);
+					}
+
+					// the frames share the topology of the first one, only their vertices are kept
+					const auto load_frame = [units, geometry, root_path, dim, mesh_files, n_vertices = rest.rows()](const int i) {
+						json jmesh = geometry;
+						jmesh["mesh"] = mesh_files[i];
+						jmesh["n_refs"] = 0;
+
+						Eigen::MatrixXd vertices;
+						Eigen::VectorXi tmp_codim_vertices;
+						Eigen::MatrixXi tmp_codim_edges;
+						Eigen::MatrixXi tmp_faces;
+						read_obstacle_mesh(units,
+										   jmesh, root_path, dim, vertices,
+										   tmp_codim_vertices, tmp_codim_edges, tmp_faces);
+						if (vertices.rows() != n_vertices)
+							log_and_throw_error("Frame {} of the mesh sequence has {} vertices instead of {}!", mesh_files[i].string(), vertices.rows(), n_vertices);
+						return vertices;
+					};
+
+					obstacle.append_mesh_sequence(
+						std::make_shared<MeshSequenceFrames>(mesh_files.size(), load_frame),
+						codim_vertices, codim_edges, faces, geometry["fps"]);
+					continue;
+				}
+
 				std::vector<Eigen::MatrixXd> vertices(mesh_files.size());
 				Eigen::VectorXi codim_vertices;
 				Eigen::MatrixXi codim_edges;
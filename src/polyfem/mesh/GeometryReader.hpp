@@ -24,7 +24,23 @@ namespace polyfem::mesh
 		const bool non_conforming = false);
 
 	///
-	/// @brief      read FEM meshes from a geometry JSON array (or single)
+	/// @brief      instantiate a FEM mesh of a geometry JSON from its already loaded mesh file
+	///
+	/// @param[in]  j_mesh          geometry JSON
+	/// @param[in]  root_path       root path of JSON
+	/// @param[in]  loaded          mesh read from the file of j_mesh, it is copied
+	///
+	/// @return created Mesh object
+	///
+	std::unique_ptr<Mesh> read_fem_mesh(
+		const Units &units,
+		const json &j_mesh,
+		const std::string &root_path,
+		const Mesh &loaded);
+
+	///
+	/// @brief      read FEM meshes from a geometry JSON array (or single),
+	///             every distinct mesh file is parsed once and its instances are processed in parallel
 	///
 	/// @param[in]  geometry        geometry JSON object(s)
 	/// @param[in]  root_path       root path of JSON
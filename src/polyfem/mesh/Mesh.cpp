@@ -8,6 +8,7 @@
 #include <polyfem/mesh/MeshUtils.hpp>
 #include <polyfem/utils/StringUtils.hpp>
 #include <polyfem/io/MshReader.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
@@ -241,7 +242,7 @@ namespace polyfem::mesh
 	}
 
 	std::unique_ptr<Mesh> Mesh::create(
-		const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &cells, const bool non_conforming)
+		const ConstMatrixXdView &vertices, const ConstMatrixXiView &cells, const bool non_conforming)
 	{
 		const int dim = vertices.cols();
 
@@ -249,7 +250,11 @@ namespace polyfem::mesh
 
 		mesh->build_from_matrices(vertices, cells);
 
-		std::vector<int> tmp(cells.data(), cells.data() + cells.size());
+		std::vector<int> tmp;
+		tmp.reserve(cells.size());
+		for (int f = 0; f < cells.rows(); ++f)
+			for (int lv = 0; lv < cells.cols(); ++lv)
+				tmp.push_back(cells(f, lv));
  		std::sort(tmp.begin(), tmp.end());
  		tmp.erase(std::unique(tmp.begin(), tmp.end()), tmp.end());
 
@@ -288,7 +293,7 @@ namespace polyfem::mesh
 		{
 			if (cells.cols() == 4)
 			{
-				get_faces(cells, mesh->in_ordered_faces_);
+				get_faces(Eigen::MatrixXi(cells), mesh->in_ordered_faces_);
 				igl::edges(mesh->in_ordered_faces_, mesh->in_ordered_edges_);
 			}
 			// else TODO
@@ -297,6 +302,119 @@ namespace polyfem::mesh
 		return mesh;
 	}
 
+	namespace
+	{
+		/// bumped every time the content of the snapshot changes
+		constexpr int snapshot_version = 2;
+
+		/// the key is stored as two 32 bits halves since the matrices are int
+		Eigen::MatrixXi key_to_matrix(const size_t key)
+		{
+			const uint64_t k = key;
+			Eigen::MatrixXi m(1, 2);
+			m(0) = int(uint32_t(k & 0xffffffffu));
+			m(1) = int(uint32_t(k >> 32));
+			return m;
+		}
+
+		Eigen::MatrixXi to_matrix(const std::vector<int> &v)
+		{
+			return Eigen::Map<const Eigen::VectorXi>(v.data(), v.size());
+		}
+
+		std::vector<int> to_vector(const Eigen::MatrixXi &m)
+		{
+			return std::vector<int>(m.data(), m.data() + m.size());
+		}
+	} // namespace
+
+	bool Mesh::save_snapshot(const std::string &path, const size_t key) const
+	{
+		if (!is_conforming() || has_poly() || is_rational() || (orders_.size() > 0 && orders_.maxCoeff() > 1))
+		{
+			logger().warn("Mesh snapshots only support linear conforming meshes without polytopes, skipping {}", path);
+			return false;
+		}
+
+		Eigen::MatrixXd vertices(n_vertices(), dimension());
+		for (int v = 0; v < n_vertices(); ++v)
+			vertices.row(v) = point(v);
+
+		const int cell_size = n_elements() > 0 ? element_vertices(0).size() : 0;
+		Eigen::MatrixXi cells(n_elements(), cell_size);
+		for (int e = 0; e < n_elements(); ++e)
+		{
+			const std::vector<int> vids = element_vertices(e);
+			if (vids.size() != cell_size)
+			{
+				logger().warn("Mesh snapshots do not support mixed element types, skipping {}", path);
+				return false;
+			}
+			for (int lv = 0; lv < cell_size; ++lv)
+				cells(e, lv) = vids[lv];
+		}
+
+		const Eigen::MatrixXi version = Eigen::MatrixXi::Constant(1, 1, snapshot_version);
+		write_matrix(path, "version", version);
+		write_matrix(path, "key", key_to_matrix(key), false);
+		write_matrix(path, "vertices", vertices, false);
+		write_matrix(path, "cells", cells, false);
+		write_matrix(path, "body_ids", to_matrix(body_ids_), false);
+		write_matrix(path, "boundary_ids", to_matrix(boundary_ids_), false);
+		write_matrix(path, "node_ids", to_matrix(node_ids_), false);
+		write_matrix(path, "in_ordered_vertices", Eigen::MatrixXi(in_ordered_vertices_), false);
+		write_matrix(path, "in_ordered_edges", in_ordered_edges_, false);
+		write_matrix(path, "in_ordered_faces", in_ordered_faces_, false);
+
+		return true;
+	}
+
+	std::unique_ptr<Mesh> Mesh::load_snapshot(const std::string &path, const size_t key, const bool non_conforming)
+	{
+		if (!std::filesystem::exists(path))
+		{
+			logger().error("Mesh snapshot does not exist: {}", path);
+			return nullptr;
+		}
+
+		Eigen::MatrixXi version;
+		if (!read_matrix(path, "version", version) || version.size() != 1 || version(0) != snapshot_version)
+		{
+			logger().error("Mesh snapshot {} has a different version, expected {}", path, snapshot_version);
+			return nullptr;
+		}
+
+		Eigen::MatrixXi stored_key;
+		if (!read_matrix(path, "key", stored_key) || stored_key.size() != 2 || stored_key != key_to_matrix(key))
+		{
+			logger().warn("Mesh snapshot {} was saved from a different mesh or loading arguments", path);
+			return nullptr;
+		}
+
+		Eigen::MatrixXd vertices;
+		Eigen::MatrixXi cells, body_ids, boundary_ids, node_ids, in_ordered_vertices;
+		if (!read_matrix(path, "vertices", vertices) || !read_matrix(path, "cells", cells)
+			|| !read_matrix(path, "body_ids", body_ids) || !read_matrix(path, "boundary_ids", boundary_ids) || !read_matrix(path, "node_ids", node_ids)
+			|| !read_matrix(path, "in_ordered_vertices", in_ordered_vertices))
+		{
+			logger().error("Invalid mesh snapshot {}", path);
+			return nullptr;
+		}
+
+		std::unique_ptr<Mesh> mesh = create(vertices, cells, non_conforming);
+		if (body_ids.size() > 0)
+			mesh->set_body_ids(to_vector(body_ids));
+		if (boundary_ids.size() > 0)
+			mesh->set_boundary_ids(to_vector(boundary_ids));
+		mesh->node_ids_ = to_vector(node_ids);
+
+		mesh->in_ordered_vertices_ = in_ordered_vertices;
+		read_matrix(path, "in_ordered_edges", mesh->in_ordered_edges_);
+		read_matrix(path, "in_ordered_faces", mesh->in_ordered_faces_);
+
+		return mesh;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 
 	void Mesh::edge_barycenters(Eigen::MatrixXd &barycenters) const
@@ -491,8 +609,39 @@ namespace polyfem::mesh
 		return res;
 	}
 
+	const PrimitiveIndex &Mesh::edge_index() const
+	{
+		if (!edge_index_ || edge_index_->n_mesh_vertices != n_vertices() || edge_index_->n_mesh_primitives != n_edges())
+		{
+			auto index = std::make_shared<PrimitiveIndex>();
+			index->build(
+				n_edges(), [](const int) { return 2; }, [this](const int e_id, const int lv_id) { return edge_vertex(e_id, lv_id); });
+			index->n_mesh_vertices = n_vertices();
+			index->n_mesh_primitives = n_edges();
+			edge_index_ = index;
+		}
+		return *edge_index_;
+	}
+
+	const PrimitiveIndex &Mesh::face_index() const
+	{
+		if (!face_index_ || face_index_->n_mesh_vertices != n_vertices() || face_index_->n_mesh_primitives != n_faces())
+		{
+			auto index = std::make_shared<PrimitiveIndex>();
+			index->build(
+				n_faces(), [this](const int f_id) { return n_face_vertices(f_id); }, [this](const int f_id, const int lv_id) { return face_vertex(f_id, lv_id); });
+			index->n_mesh_vertices = n_vertices();
+			index->n_mesh_primitives = n_faces();
+			face_index_ = index;
+		}
+		return *face_index_;
+	}
+
 	void Mesh::append(const Mesh &mesh)
 	{
+		edge_index_.reset();
+		face_index_.reset();
+
 		const int n_vertices = this->n_vertices();
 
 		elements_tag_.insert(elements_tag_.end(), mesh.elements_tag_.begin(), mesh.elements_tag_.end());
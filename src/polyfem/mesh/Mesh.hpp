@@ -2,6 +2,7 @@
 
 #include <polyfem/Common.hpp>
 #include <polyfem/mesh/mesh2D/Navigation.hpp>
+#include <polyfem/mesh/PrimitiveIndex.hpp>
 #include <polyfem/utils/Types.hpp>
 #include <polyfem/utils/HashUtils.hpp>
 #include <polyfem/utils/Types.hpp>
@@ -89,7 +90,7 @@ namespace polyfem
 			/// @param[in] cells list of cells
 			/// @param[in] non_conforming yes or no for non conforming mesh
 			/// @return pointer to the mesh
-			static std::unique_ptr<Mesh> create(const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &cells, const bool non_conforming = false);
+			static std::unique_ptr<Mesh> create(const ConstMatrixXdView &vertices, const ConstMatrixXiView &cells, const bool non_conforming = false);
 
 			///
 			/// factory to build the proper empty mesh
@@ -103,6 +104,22 @@ namespace polyfem
 			/// @return pointer to the new copy mesh
 			virtual std::unique_ptr<Mesh> copy() const = 0;
 
+			/// @brief Loads a mesh written by save_snapshot
+			///
+			/// @param[in] path snapshot hdf5 file
+			/// @param[in] key hash of the source of the mesh, the snapshot is rejected if it was saved with a different key
+			/// @param[in] non_conforming yes or no for non conforming mesh
+			/// @return pointer to the mesh, nullptr if the snapshot is invalid, stale, or has a different version
+			static std::unique_ptr<Mesh> load_snapshot(const std::string &path, const size_t key, const bool non_conforming = false);
+
+			/// @brief Writes the loaded mesh (vertices, cells, selections, and input ordering) to a versioned hdf5 snapshot,
+			/// reloading it skips reading and processing the geometry files. Only linear conforming meshes without polytopes are supported.
+			///
+			/// @param[in] path snapshot hdf5 file
+			/// @param[in] key hash of the source of the mesh (files and loading arguments), stored in the snapshot header
+			/// @return if success
+			bool save_snapshot(const std::string &path, const size_t key) const;
+
 		protected:
 			///
 			/// @brief Construct a new Mesh object
@@ -155,6 +172,11 @@ namespace polyfem
 			/// @return if the mesh is conforming
 			virtual bool is_conforming() const = 0;
 			///
+			/// @brief heap memory of the mesh connectivity, 0 if the mesh type does not report it
+			///
+			/// @return size in bytes
+			virtual size_t memory_bytes() const { return 0; }
+			///
 			/// @brief utitlity to return the number of elements, cells or faces in 3d and 2d
 			///
 			/// @return number of elements
@@ -269,7 +291,7 @@ namespace polyfem
 			/// @param[in] V vertices
 			/// @param[in] F connectivity
 			/// @return if success
-			virtual bool build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F) = 0;
+			virtual bool build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F) = 0;
 
 		public:
 			/// @brief attach high order nodes
@@ -608,6 +630,15 @@ namespace polyfem
 			/// @return map
 			std::unordered_map<std::vector<int>, size_t, polyfem::utils::HashVector> faces_to_ids() const;
 
+			/// @brief index from the vertices of an edge to its id, built at the first call and rebuilt when the mesh changes
+			///
+			/// @return index
+			const PrimitiveIndex &edge_index() const;
+			/// @brief index from the vertices of a face to its id, built at the first call and rebuilt when the mesh changes
+			///
+			/// @return index
+			const PrimitiveIndex &face_index() const;
+
 			/// @brief Order of the input vertices
 			///
 			/// @return vector of indices, one per vertex
@@ -680,6 +711,11 @@ namespace polyfem
 			Eigen::MatrixXi in_ordered_edges_;
 			/// Order of the input faces, TODO: change to std::vector of Eigen::Vector
 			Eigen::MatrixXi in_ordered_faces_;
+
+		private:
+			/// lazily built primitive indices, shared by the copies of the mesh
+			mutable std::shared_ptr<const PrimitiveIndex> edge_index_;
+			mutable std::shared_ptr<const PrimitiveIndex> face_index_;
 		};
 	} // namespace mesh
 } // namespace polyfem
@@ -154,6 +154,28 @@ namespace polyfem::mesh
 
 	////////////////////////////////////////////////////////////////////////////////
 
+	void MeshNodes::permute(const std::vector<int> &new_ids)
+	{
+		assert(new_ids.size() == n_nodes());
+
+		for (int &node : primitive_to_node_)
+		{
+			if (node >= 0)
+				node = new_ids[node];
+		}
+
+		const auto permute_vector = [&new_ids](std::vector<int> &vec) {
+			std::vector<int> tmp(vec.size());
+			for (int i = 0; i < vec.size(); ++i)
+				tmp[new_ids[i]] = vec[i];
+			vec.swap(tmp);
+		};
+
+		permute_vector(node_to_primitive_);
+		permute_vector(node_to_primitive_gid_);
+		permute_vector(in_ordered_vertices_);
+	}
+
 	int MeshNodes::node_id_from_primitive(int primitive_id)
 	{
 		if (primitive_to_node_[primitive_id] < 0 || !connect_nodes_)
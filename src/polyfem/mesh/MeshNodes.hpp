@@ -80,6 +80,9 @@ namespace polyfem
 			// Retrieve a list of nodes which are marked as boundary
 			std::vector<int> boundary_nodes() const;
 
+			// Renumber the assigned nodes, node i becomes new_ids[i]
+			void permute(const std::vector<int> &new_ids);
+
 		private:
 			int count_nonnegative_nodes(int start_i, int end_i) const;
 
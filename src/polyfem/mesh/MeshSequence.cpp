@@ -0,0 +1,88 @@
+#include "MeshSequence.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+
+namespace polyfem::mesh
+{
+	MeshSequenceFrames::MeshSequenceFrames(const int n_frames, const Loader &loader, const int cache_size, const bool prefetch)
+		: n_frames_(n_frames), loader_(loader), cache_size_(std::max(cache_size, 2)), prefetch_(prefetch)
+	{
+		if (n_frames_ <= 0)
+			log_and_throw_error("Empty mesh sequence!");
+	}
+
+	MeshSequenceFrames::~MeshSequenceFrames()
+	{
+		if (prefetched_.valid())
+			prefetched_.wait();
+	}
+
+	MeshSequenceFrames::Frame MeshSequenceFrames::find_cached(const int i)
+	{
+		for (auto it = cache_.begin(); it != cache_.end(); ++it)
+		{
+			if (it->first == i)
+			{
+				cache_.splice(cache_.begin(), cache_, it);
+				return cache_.front().second;
+			}
+		}
+		return nullptr;
+	}
+
+	void MeshSequenceFrames::start_prefetch(const int i)
+	{
+		prefetched_frame_ = i;
+		prefetched_ = std::async(std::launch::async, [this, i]() -> Frame {
+			return std::make_shared<const Eigen::MatrixXd>(loader_(i));
+		});
+	}
+
+	std::shared_ptr<const Eigen::MatrixXd> MeshSequenceFrames::frame(int i)
+	{
+		i = std::clamp(i, 0, n_frames_ - 1);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		Frame res = find_cached(i);
+		if (res == nullptr)
+		{
+			// the loader is never run concurrently, a pending load is finished first
+			if (prefetched_.valid())
+			{
+				if (prefetched_frame_ == i)
+					res = prefetched_.get();
+				else
+					prefetched_.wait();
+			}
+			if (res == nullptr)
+			{
+				logger().trace("Loading frame {} of the mesh sequence", i);
+				res = std::make_shared<const Eigen::MatrixXd>(loader_(i));
+			}
+
+			cache_.emplace_front(i, res);
+			if (cache_.size() > cache_size_)
+				cache_.pop_back();
+		}
+
+		const int next = i + 1;
+		if (prefetch_ && next < n_frames_ && !(prefetched_.valid() && prefetched_frame_ == next))
+		{
+			bool is_cached = false;
+			for (const auto &entry : cache_)
+				is_cached |= entry.first == next;
+
+			if (!is_cached)
+			{
+				if (prefetched_.valid())
+					prefetched_.wait();
+				start_prefetch(next);
+			}
+		}
+
+		return res;
+	}
+} // namespace polyfem::mesh
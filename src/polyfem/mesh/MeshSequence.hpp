@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace polyfem
+{
+	namespace mesh
+	{
+		/// Vertex positions of the frames of a mesh sequence, loaded on demand.
+		/// Only the most recently used frames are kept in memory, and the frame after
+		/// the last requested one is loaded on a background thread.
+		class MeshSequenceFrames
+		{
+		public:
+			/// returns the #V x dim vertex positions of a frame
+			using Loader = std::function<Eigen::MatrixXd(const int frame)>;
+
+			/// @param[in] n_frames number of frames of the sequence
+			/// @param[in] loader function reading a frame, never called concurrently
+			/// @param[in] cache_size maximum number of frames kept in memory, at least 2
+			/// @param[in] prefetch if true, the next frame is loaded in the background
+			MeshSequenceFrames(const int n_frames, const Loader &loader, const int cache_size = 4, const bool prefetch = true);
+			/// waits for the background load, if any
+			~MeshSequenceFrames();
+
+			MeshSequenceFrames(const MeshSequenceFrames &) = delete;
+			MeshSequenceFrames &operator=(const MeshSequenceFrames &) = delete;
+
+			int n_frames() const { return n_frames_; }
+
+			/// @brief Vertex positions of a frame, loaded if not in the cache
+			/// @param[in] i frame, clamped to the sequence
+			std::shared_ptr<const Eigen::MatrixXd> frame(int i);
+
+		private:
+			using Frame = std::shared_ptr<const Eigen::MatrixXd>;
+
+			/// cached frame i, nullptr if not cached; marks it as the most recently used
+			Frame find_cached(const int i);
+			void start_prefetch(const int i);
+
+			const int n_frames_;
+			const Loader loader_;
+			const int cache_size_;
+			const bool prefetch_;
+
+			std::mutex mutex_;
+			/// most recently used first
+			std::list<std::pair<int, Frame>> cache_;
+
+			int prefetched_frame_ = -1;
+			std::future<Frame> prefetched_;
+		};
+	} // namespace mesh
+} // namespace polyfem
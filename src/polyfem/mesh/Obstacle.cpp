@@ -160,6 +160,37 @@ namespace polyfem
 			}
 		}
 
+		void Obstacle::append_mesh_sequence(
+			const std::shared_ptr<MeshSequenceFrames> &frames,
+			const Eigen::VectorXi &codim_vertices,
+			const Eigen::MatrixXi &codim_edges,
+			const Eigen::MatrixXi &faces,
+			const int fps)
+		{
+			const std::shared_ptr<const Eigen::MatrixXd> rest = frames->frame(0);
+			if (rest->size() == 0)
+				return;
+
+			append_mesh(*rest, codim_vertices, codim_edges, faces);
+
+			displacements_.emplace_back();
+			for (size_t d = 0; d < dim_; ++d)
+			{
+				displacements_.back().value[d].init(
+					[frames, rest, fps, d](double x, double y, double z, double t, int index) -> double {
+						const double frame = t * fps;
+						const double interp = frame - floor(frame);
+						const int frame0 = (int)floor(frame);
+						const int frame1 = (int)ceil(frame);
+						if (frame1 >= frames->n_frames())
+							return (*frames->frame(frames->n_frames() - 1))(index, d) - (*rest)(index, d);
+						const double u0 = (*frames->frame(frame0))(index, d) - (*rest)(index, d);
+						const double u1 = (*frames->frame(frame1))(index, d) - (*rest)(index, d);
+						return (u1 - u0) * interp + u0;
+					});
+			}
+		}
+
 		void Obstacle::append_plane(const VectorNd &origin, const VectorNd &normal)
 		{
 			if (dim_ == 0)
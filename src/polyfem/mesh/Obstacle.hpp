@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polyfem/Common.hpp>
+#include <polyfem/mesh/MeshSequence.hpp>
 #include <polyfem/utils/ExpressionValue.hpp>
 #include <polyfem/utils/Interpolation.hpp>
 #include <polyfem/utils/Types.hpp>
@@ -31,6 +32,13 @@ namespace polyfem
 				const Eigen::MatrixXi &codim_edges,
 				const Eigen::MatrixXi &faces,
 				const int fps);
+			/// @brief Mesh sequence whose frames are loaded on demand, the first frame is the rest position
+			void append_mesh_sequence(
+				const std::shared_ptr<MeshSequenceFrames> &frames,
+				const Eigen::VectorXi &codim_vertices,
+				const Eigen::MatrixXi &codim_edges,
+				const Eigen::MatrixXi &faces,
+				const int fps);
 			void append_plane(const VectorNd &point, const VectorNd &normal);
 
 			inline int n_vertices() const { return v_.rows(); }
@@ -0,0 +1,109 @@
+#include "PrimitiveIndex.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace polyfem::mesh
+{
+	PrimitiveIndex::Key PrimitiveIndex::make_key(const int *v, const int n)
+	{
+		assert(n <= 4);
+		uint32_t s[4] = {~uint32_t(0), ~uint32_t(0), ~uint32_t(0), ~uint32_t(0)};
+		for (int i = 0; i < n; ++i)
+			s[i] = uint32_t(v[i]);
+		std::sort(s, s + n);
+
+		Key key;
+		key.lo = uint64_t(s[0]) | (uint64_t(s[1]) << 32);
+		key.hi = uint64_t(s[2]) | (uint64_t(s[3]) << 32);
+		return key;
+	}
+
+	size_t PrimitiveIndex::slot(const Key &key) const
+	{
+		// splitmix64 finalizer of the two halves
+		uint64_t h = key.lo * 0x9e3779b97f4a7c15ull ^ (key.hi + 0x632be59bd9b4e019ull);
+		h ^= h >> 30;
+		h *= 0xbf58476d1ce4e5b9ull;
+		h ^= h >> 27;
+		h *= 0x94d049bb133111ebull;
+		h ^= h >> 31;
+		return size_t(h) & mask_;
+	}
+
+	void PrimitiveIndex::clear()
+	{
+		table_.clear();
+		mask_ = 0;
+		size_ = 0;
+		large_.clear();
+	}
+
+	void PrimitiveIndex::resize_table(const int n)
+	{
+		// load factor at most 1/2
+		size_t capacity = 16;
+		while (capacity < 2 * size_t(n))
+			capacity *= 2;
+		table_.assign(capacity, Entry());
+		mask_ = capacity - 1;
+	}
+
+	void PrimitiveIndex::insert(const int *v, const int n, const int id)
+	{
+		if (n > 4)
+		{
+			std::vector<int> key(v, v + n);
+			std::sort(key.begin(), key.end());
+			const auto it = large_.emplace(std::move(key), id);
+			if (it.second)
+				++size_;
+			else
+				it.first->second = id;
+			return;
+		}
+
+		const Key key = make_key(v, n);
+		for (size_t i = slot(key);; i = (i + 1) & mask_)
+		{
+			Entry &e = table_[i];
+			if (e.id < 0)
+			{
+				e.key = key;
+				e.id = id;
+				++size_;
+				return;
+			}
+			if (e.key == key)
+			{
+				// same as assigning in a map, the last primitive wins
+				e.id = id;
+				return;
+			}
+		}
+	}
+
+	int PrimitiveIndex::find(const int *v, const int n) const
+	{
+		if (n > 4)
+		{
+			std::vector<int> key(v, v + n);
+			std::sort(key.begin(), key.end());
+			const auto it = large_.find(key);
+			return it == large_.end() ? -1 : it->second;
+		}
+
+		if (table_.empty())
+			return -1;
+
+		const Key key = make_key(v, n);
+		for (size_t i = slot(key);; i = (i + 1) & mask_)
+		{
+			const Entry &e = table_[i];
+			if (e.id < 0)
+				return -1;
+			if (e.key == key)
+				return e.id;
+		}
+	}
+} // namespace polyfem::mesh
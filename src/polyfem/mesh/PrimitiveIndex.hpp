@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace polyfem
+{
+	namespace mesh
+	{
+		/// Map from the vertices of a primitive (edge or face, in any order) to its id.
+		/// Primitives with up to 4 vertices are stored as sorted ids packed in 128 bits in an open addressing table,
+		/// larger polygonal faces fall back to a map.
+		class PrimitiveIndex
+		{
+		public:
+			/// @brief Build the index
+			/// @param[in] n number of primitives
+			/// @param[in] n_vertices function returning the number of vertices of a primitive
+			/// @param[in] vertex function returning the lv-th vertex of a primitive
+			template <typename NVertices, typename Vertex>
+			void build(const int n, const NVertices &n_vertices, const Vertex &vertex)
+			{
+				clear();
+				resize_table(n);
+
+				std::vector<int> v;
+				for (int i = 0; i < n; ++i)
+				{
+					v.resize(n_vertices(i));
+					for (int lv = 0; lv < v.size(); ++lv)
+						v[lv] = vertex(i, lv);
+					insert(v.data(), v.size(), i);
+				}
+			}
+
+			/// @brief Id of the primitive with the vertices v[0, n), -1 if none
+			int find(const int *v, const int n) const;
+			int find(const std::vector<int> &v) const { return find(v.data(), v.size()); }
+			int find(const int v0, const int v1) const
+			{
+				const int v[2] = {v0, v1};
+				return find(v, 2);
+			}
+
+			/// number of distinct primitives
+			int size() const { return size_; }
+
+			/// state of the mesh when the index was built, used to detect stale indices
+			int n_mesh_vertices = -1;
+			int n_mesh_primitives = -1;
+
+		private:
+			struct Key
+			{
+				uint64_t lo = ~uint64_t(0);
+				uint64_t hi = ~uint64_t(0);
+				bool operator==(const Key &o) const { return lo == o.lo && hi == o.hi; }
+			};
+
+			struct Entry
+			{
+				Key key;
+				int id = -1;
+			};
+
+			static Key make_key(const int *v, const int n);
+			size_t slot(const Key &key) const;
+
+			void clear();
+			void resize_table(const int n);
+			void insert(const int *v, const int n, const int id);
+
+			std::vector<Entry> table_;
+			size_t mask_ = 0;
+			int size_ = 0;
+			/// faces with more than 4 vertices, sorted
+			std::map<std::vector<int>, int> large_;
+		};
+	} // namespace mesh
+} // namespace polyfem
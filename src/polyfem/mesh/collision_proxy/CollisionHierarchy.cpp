@@ -0,0 +1,315 @@
+#include "CollisionHierarchy.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+
+namespace polyfem::mesh
+{
+	namespace
+	{
+		/// split ids at the median of the longest axis of their centroids until the groups have at most cluster_size ids
+		void split_clusters(const Eigen::MatrixXd &centroids, std::vector<int> ids, const int cluster_size, std::vector<std::vector<int>> &groups)
+		{
+			if (ids.empty())
+				return;
+
+			std::vector<std::pair<int, int>> ranges = {{0, int(ids.size())}};
+			while (!ranges.empty())
+			{
+				const auto [begin, end] = ranges.back();
+				ranges.pop_back();
+
+				if (end - begin <= cluster_size)
+				{
+					groups.emplace_back(ids.begin() + begin, ids.begin() + end);
+					continue;
+				}
+
+				Eigen::RowVectorXd lo = centroids.row(ids[begin]), hi = lo;
+				for (int i = begin + 1; i < end; ++i)
+				{
+					lo = lo.cwiseMin(centroids.row(ids[i]));
+					hi = hi.cwiseMax(centroids.row(ids[i]));
+				}
+				int axis;
+				(hi - lo).maxCoeff(&axis);
+
+				const int mid = (begin + end) / 2;
+				std::nth_element(
+					ids.begin() + begin, ids.begin() + mid, ids.begin() + end,
+					[&](const int a, const int b) { return centroids(a, axis) < centroids(b, axis); });
+				ranges.emplace_back(begin, mid);
+				ranges.emplace_back(mid, end);
+			}
+		}
+
+		template <typename Primitives>
+		Eigen::MatrixXd centroids(const Eigen::MatrixXd &V, const Primitives &P, const std::vector<int> &ids)
+		{
+			Eigen::MatrixXd C = Eigen::MatrixXd::Zero(P.rows(), V.cols());
+			for (const int i : ids)
+			{
+				for (int j = 0; j < P.cols(); ++j)
+					C.row(i) += V.row(P(i, j));
+				C.row(i) /= P.cols();
+			}
+			return C;
+		}
+
+		struct Boxes
+		{
+			Eigen::MatrixXd lo, hi;
+
+			bool overlap(const int a, const Boxes &other, const int b) const
+			{
+				return (lo.row(a).array() <= other.hi.row(b).array()).all()
+					   && (other.lo.row(b).array() <= hi.row(a).array()).all();
+			}
+		};
+
+		/// boxes of the primitives P as the unions of the boxes of their vertices
+		template <typename Primitives>
+		Boxes primitive_boxes(const Boxes &vertex_boxes, const Primitives &P)
+		{
+			Boxes boxes;
+			boxes.lo.resize(P.rows(), vertex_boxes.lo.cols());
+			boxes.hi.resize(P.rows(), vertex_boxes.lo.cols());
+			utils::maybe_parallel_for(P.rows(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					boxes.lo.row(i) = vertex_boxes.lo.row(P(i, 0));
+					boxes.hi.row(i) = vertex_boxes.hi.row(P(i, 0));
+					for (int j = 1; j < P.cols(); ++j)
+					{
+						boxes.lo.row(i) = boxes.lo.row(i).cwiseMin(vertex_boxes.lo.row(P(i, j)));
+						boxes.hi.row(i) = boxes.hi.row(i).cwiseMax(vertex_boxes.hi.row(P(i, j)));
+					}
+				}
+			});
+			return boxes;
+		}
+	} // namespace
+
+	CollisionHierarchy::CollisionHierarchy(const ipc::CollisionMesh &mesh, const int cluster_size)
+	{
+		assert(cluster_size > 0);
+		const Eigen::MatrixXd &V = mesh.rest_positions();
+		const Eigen::MatrixXi &E = mesh.edges();
+		const Eigen::MatrixXi &F = mesh.faces();
+
+		std::vector<int> vertex_cluster(V.rows(), -1), edge_cluster(E.rows(), -1);
+		std::vector<std::vector<int>> groups;
+
+		// faces first, their edges and vertices go to the cluster of the first face using them
+		std::vector<int> ids(F.rows());
+		std::iota(ids.begin(), ids.end(), 0);
+		split_clusters(centroids(V, F, ids), ids, cluster_size, groups);
+		for (const std::vector<int> &group : groups)
+		{
+			const int c = clusters_.size();
+			clusters_.emplace_back();
+			clusters_[c].faces = group;
+			for (const int f : group)
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					const int e = mesh.faces_to_edges()(f, j);
+					if (edge_cluster[e] < 0)
+					{
+						edge_cluster[e] = c;
+						clusters_[c].edges.push_back(e);
+					}
+					if (vertex_cluster[F(f, j)] < 0)
+					{
+						vertex_cluster[F(f, j)] = c;
+						clusters_[c].vertices.push_back(F(f, j));
+					}
+				}
+			}
+		}
+
+		// edges of no face (2D and codimensional edges)
+		ids.clear();
+		for (int e = 0; e < E.rows(); ++e)
+			if (edge_cluster[e] < 0)
+				ids.push_back(e);
+		groups.clear();
+		split_clusters(centroids(V, E, ids), ids, cluster_size, groups);
+		for (const std::vector<int> &group : groups)
+		{
+			const int c = clusters_.size();
+			clusters_.emplace_back();
+			clusters_[c].edges = group;
+			for (const int e : group)
+			{
+				for (int j = 0; j < 2; ++j)
+				{
+					if (vertex_cluster[E(e, j)] < 0)
+					{
+						vertex_cluster[E(e, j)] = c;
+						clusters_[c].vertices.push_back(E(e, j));
+					}
+				}
+			}
+		}
+
+		// codimensional vertices
+		ids.clear();
+		for (int v = 0; v < V.rows(); ++v)
+			if (vertex_cluster[v] < 0)
+				ids.push_back(v);
+		groups.clear();
+		split_clusters(V, ids, cluster_size, groups);
+		for (const std::vector<int> &group : groups)
+		{
+			clusters_.emplace_back();
+			clusters_.back().vertices = group;
+		}
+
+		logger().debug("Collision hierarchy with {} clusters of at most {} primitives", clusters_.size(), cluster_size);
+	}
+
+	void CollisionHierarchy::build(
+		const ipc::CollisionMesh &mesh,
+		const Eigen::MatrixXd &V,
+		const double inflation_radius,
+		ipc::Candidates &candidates) const
+	{
+		build(mesh, V, V, inflation_radius, candidates);
+	}
+
+	void CollisionHierarchy::build(
+		const ipc::CollisionMesh &mesh,
+		const Eigen::MatrixXd &V0,
+		const Eigen::MatrixXd &V1,
+		const double inflation_radius,
+		ipc::Candidates &candidates) const
+	{
+		assert(V0.rows() == mesh.num_vertices() && V1.rows() == mesh.num_vertices());
+		const Eigen::MatrixXi &E = mesh.edges();
+		const Eigen::MatrixXi &F = mesh.faces();
+		const bool is_3d = V0.cols() == 3;
+
+		// fine level: boxes of every primitive swept over the step
+		Boxes vertex_boxes;
+		vertex_boxes.lo = V0.cwiseMin(V1).array() - inflation_radius;
+		vertex_boxes.hi = V0.cwiseMax(V1).array() + inflation_radius;
+		const Boxes edge_boxes = primitive_boxes(vertex_boxes, E);
+		const Boxes face_boxes = primitive_boxes(vertex_boxes, F);
+
+		// coarse level: boxes of the clusters
+		const int n = clusters_.size();
+		Boxes cluster_boxes;
+		cluster_boxes.lo.setConstant(n, V0.cols(), std::numeric_limits<double>::infinity());
+		cluster_boxes.hi.setConstant(n, V0.cols(), -std::numeric_limits<double>::infinity());
+		utils::maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+			for (int c = start; c < end; ++c)
+			{
+				const auto add = [&](const Boxes &boxes, const std::vector<int> &ids) {
+					for (const int i : ids)
+					{
+						cluster_boxes.lo.row(c) = cluster_boxes.lo.row(c).cwiseMin(boxes.lo.row(i));
+						cluster_boxes.hi.row(c) = cluster_boxes.hi.row(c).cwiseMax(boxes.hi.row(i));
+					}
+				};
+				add(vertex_boxes, clusters_[c].vertices);
+				add(edge_boxes, clusters_[c].edges);
+				add(face_boxes, clusters_[c].faces);
+			}
+		});
+
+		// sweep the clusters along x
+		std::vector<int> order(n);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](const int a, const int b) { return cluster_boxes.lo(a, 0) < cluster_boxes.lo(b, 0); });
+
+		std::vector<std::pair<int, int>> cluster_pairs;
+		for (int i = 0; i < n; ++i)
+		{
+			cluster_pairs.emplace_back(order[i], order[i]);
+			for (int j = i + 1; j < n && cluster_boxes.lo(order[j], 0) <= cluster_boxes.hi(order[i], 0); ++j)
+			{
+				if (cluster_boxes.overlap(order[i], cluster_boxes, order[j]))
+					cluster_pairs.emplace_back(order[i], order[j]);
+			}
+		}
+
+		// the vertices of a primitive do not collide with it, at least one of the pairs of vertices has to collide
+		const auto can_collide = [&](const auto &a, const int na, const auto &b, const int nb) {
+			for (int i = 0; i < na; ++i)
+				for (int j = 0; j < nb; ++j)
+					if (a[i] == b[j])
+						return false;
+			for (int i = 0; i < na; ++i)
+				for (int j = 0; j < nb; ++j)
+					if (mesh.can_collide(a[i], b[j]))
+						return true;
+			return false;
+		};
+
+		auto storages = utils::create_thread_storage(ipc::Candidates());
+		utils::maybe_parallel_for(cluster_pairs.size(), [&](int start, int end, int thread_id) {
+			ipc::Candidates &local = utils::get_local_thread_storage(storages, thread_id);
+			for (int p = start; p < end; ++p)
+			{
+				const Cluster &a = clusters_[cluster_pairs[p].first];
+				const Cluster &b = clusters_[cluster_pairs[p].second];
+				const bool same = cluster_pairs[p].first == cluster_pairs[p].second;
+
+				for (int k = 0; k < (same ? 1 : 2); ++k)
+				{
+					const Cluster &c0 = k == 0 ? a : b;
+					const Cluster &c1 = k == 0 ? b : a;
+					if (is_3d)
+					{
+						for (const int f : c0.faces)
+						{
+							const std::array<int, 3> fv = {{F(f, 0), F(f, 1), F(f, 2)}};
+							for (const int v : c1.vertices)
+								if (face_boxes.overlap(f, vertex_boxes, v) && can_collide(fv, 3, &v, 1))
+									local.fv_candidates.emplace_back(f, v);
+						}
+					}
+					else
+					{
+						for (const int e : c0.edges)
+						{
+							const std::array<int, 2> ev = {{E(e, 0), E(e, 1)}};
+							for (const int v : c1.vertices)
+								if (edge_boxes.overlap(e, vertex_boxes, v) && can_collide(ev, 2, &v, 1))
+									local.ev_candidates.emplace_back(e, v);
+						}
+					}
+				}
+
+				if (!is_3d)
+					continue;
+				for (int i = 0; i < a.edges.size(); ++i)
+				{
+					const int e0 = a.edges[i];
+					const std::array<int, 2> ev0 = {{E(e0, 0), E(e0, 1)}};
+					for (int j = same ? i + 1 : 0; j < b.edges.size(); ++j)
+					{
+						const int e1 = b.edges[j];
+						const std::array<int, 2> ev1 = {{E(e1, 0), E(e1, 1)}};
+						if (edge_boxes.overlap(e0, edge_boxes, e1) && can_collide(ev0, 2, ev1, 2))
+							local.ee_candidates.emplace_back(std::min(e0, e1), std::max(e0, e1));
+					}
+				}
+			}
+		});
+
+		candidates.clear();
+		for (const ipc::Candidates &local : storages)
+		{
+			candidates.ev_candidates.insert(candidates.ev_candidates.end(), local.ev_candidates.begin(), local.ev_candidates.end());
+			candidates.ee_candidates.insert(candidates.ee_candidates.end(), local.ee_candidates.begin(), local.ee_candidates.end());
+			candidates.fv_candidates.insert(candidates.fv_candidates.end(), local.fv_candidates.begin(), local.fv_candidates.end());
+		}
+	}
+} // namespace polyfem::mesh
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ipc/collision_mesh.hpp>
+#include <ipc/candidates/candidates.hpp>
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace polyfem::mesh
+{
+	/// @brief Two level broad phase of a (possibly upsampled) collision mesh.
+	///
+	/// The primitives are grouped in clusters of neighbouring faces (edges in 2D) at rest, every vertex and edge
+	/// belongs to one cluster. The clusters are the coarse level: their bounding boxes are computed from the current
+	/// positions, so the broad phase stays conservative under any deformation, and only the primitives of the pairs
+	/// of overlapping clusters are tested against each other.
+	class CollisionHierarchy
+	{
+	public:
+		/// @brief Build the clusters of a collision mesh
+		/// @param[in] mesh Collision mesh
+		/// @param[in] cluster_size Maximum number of faces (edges in 2D) per cluster
+		CollisionHierarchy(const ipc::CollisionMesh &mesh, const int cluster_size);
+
+		/// @brief Candidates of the primitives whose boxes inflated by inflation_radius overlap
+		/// @param[in] mesh Collision mesh the hierarchy was built for
+		/// @param[in] V Vertex positions
+		/// @param[in] inflation_radius Radius the boxes are inflated by (e.g., dhat / 2)
+		/// @param[out] candidates Edge-vertex candidates in 2D, edge-edge and face-vertex candidates in 3D
+		void build(
+			const ipc::CollisionMesh &mesh,
+			const Eigen::MatrixXd &V,
+			const double inflation_radius,
+			ipc::Candidates &candidates) const;
+
+		/// @brief Candidates of the primitives whose boxes swept from V0 to V1 and inflated by inflation_radius overlap
+		/// @param[in] mesh Collision mesh the hierarchy was built for
+		/// @param[in] V0 Vertex positions at the start of the step
+		/// @param[in] V1 Vertex positions at the end of the step
+		/// @param[in] inflation_radius Radius the boxes are inflated by
+		/// @param[out] candidates Edge-vertex candidates in 2D, edge-edge and face-vertex candidates in 3D
+		void build(
+			const ipc::CollisionMesh &mesh,
+			const Eigen::MatrixXd &V0,
+			const Eigen::MatrixXd &V1,
+			const double inflation_radius,
+			ipc::Candidates &candidates) const;
+
+		int n_clusters() const { return clusters_.size(); }
+
+	private:
+		struct Cluster
+		{
+			std::vector<int> vertices;
+			std::vector<int> edges;
+			std::vector<int> faces;
+		};
+		std::vector<Cluster> clusters_;
+	};
+} // namespace polyfem::mesh
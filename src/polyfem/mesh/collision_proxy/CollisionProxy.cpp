@@ -12,6 +12,8 @@
 #include <h5pp/h5pp.h>
 // #include <fcpw/fcpw.h>
 
+#include <filesystem>
+
 namespace polyfem::mesh
 {
 	namespace
@@ -68,6 +70,27 @@ namespace polyfem::mesh
 
 			return V;
 		}
+
+		template <typename T>
+		void hash_combine(size_t &seed, const T &v)
+		{
+			seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+
+		void hash_bases(size_t &seed, const basis::ElementBases &element)
+		{
+			hash_combine(seed, element.bases.size());
+			for (const basis::Basis &basis : element.bases)
+			{
+				for (const basis::Local2Global &g : basis.global())
+				{
+					hash_combine(seed, g.index);
+					hash_combine(seed, g.val);
+					for (int d = 0; d < g.node.size(); ++d)
+						hash_combine(seed, g.node(d));
+				}
+			}
+		}
 	} // namespace
 
 	void build_collision_proxy(
@@ -163,6 +186,89 @@ namespace polyfem::mesh
 			proxy_vertices, proxy_faces, displacement_map_entries);
 	}
 
+	size_t collision_proxy_hash(
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &geom_bases,
+		const std::vector<LocalBoundary> &total_local_boundary,
+		const int n_bases,
+		const int dim,
+		const double max_edge_length,
+		const CollisionProxyTessellation tessellation)
+	{
+		size_t seed = 0;
+		hash_combine(seed, n_bases);
+		hash_combine(seed, dim);
+		hash_combine(seed, max_edge_length);
+		hash_combine(seed, int(tessellation));
+
+		// only the boundary elements contribute to the proxy
+		for (const LocalBoundary &local_boundary : total_local_boundary)
+		{
+			hash_combine(seed, local_boundary.element_id());
+			hash_combine(seed, int(local_boundary.type()));
+			for (int fi = 0; fi < local_boundary.size(); fi++)
+				hash_combine(seed, local_boundary.local_primitive_id(fi));
+
+			hash_bases(seed, bases[local_boundary.element_id()]);
+			hash_bases(seed, geom_bases[local_boundary.element_id()]);
+		}
+
+		return seed;
+	}
+
+	void save_collision_proxy_cache(
+		const std::string &filename,
+		const size_t key,
+		const Eigen::MatrixXd &proxy_vertices,
+		const Eigen::MatrixXi &proxy_faces,
+		const std::vector<Eigen::Triplet<double>> &displacement_map_entries)
+	{
+		Eigen::VectorXd values(displacement_map_entries.size());
+		Eigen::VectorXi rows(displacement_map_entries.size()), cols(displacement_map_entries.size());
+		for (int i = 0; i < displacement_map_entries.size(); i++)
+		{
+			values[i] = displacement_map_entries[i].value();
+			rows[i] = displacement_map_entries[i].row();
+			cols[i] = displacement_map_entries[i].col();
+		}
+
+		h5pp::File file(filename, h5pp::FileAccess::REPLACE);
+		file.writeDataset(proxy_vertices, "vertices");
+		file.writeDataset(proxy_faces, "faces");
+		file.writeDataset(values, "weight_triplets/values");
+		file.writeDataset(rows, "weight_triplets/rows");
+		file.writeDataset(cols, "weight_triplets/cols");
+		file.writeAttribute((unsigned long long)key, "vertices", "key");
+	}
+
+	bool load_collision_proxy_cache(
+		const std::string &filename,
+		const size_t key,
+		Eigen::MatrixXd &proxy_vertices,
+		Eigen::MatrixXi &proxy_faces,
+		std::vector<Eigen::Triplet<double>> &displacement_map_entries)
+	{
+		if (!std::filesystem::exists(filename))
+			return false;
+
+		h5pp::File file(filename, h5pp::FileAccess::READONLY);
+		if (!file.linkExists("vertices") || file.readAttribute<unsigned long long>("vertices", "key") != key)
+			return false;
+
+		proxy_vertices = file.readDataset<Eigen::MatrixXd>("vertices");
+		proxy_faces = file.readDataset<Eigen::MatrixXi>("faces");
+		const Eigen::VectorXd values = file.readDataset<Eigen::VectorXd>("weight_triplets/values");
+		const Eigen::VectorXi rows = file.readDataset<Eigen::VectorXi>("weight_triplets/rows");
+		const Eigen::VectorXi cols = file.readDataset<Eigen::VectorXi>("weight_triplets/cols");
+
+		displacement_map_entries.clear();
+		displacement_map_entries.reserve(values.size());
+		for (int i = 0; i < values.size(); i++)
+			displacement_map_entries.emplace_back(rows[i], cols[i], values[i]);
+
+		return true;
+	}
+
 	// ========================================================================
 
 	void build_collision_proxy_displacement_map(
@@ -43,6 +43,51 @@ namespace polyfem::mesh
 		std::vector<Eigen::Triplet<double>> &displacement_map,
 		const CollisionProxyTessellation tessellation = CollisionProxyTessellation::REGULAR);
 
+	/// @brief Hash of all the inputs of build_collision_proxy, used as the key of the collision proxy cache.
+	/// @param[in] bases Bases for elements
+	/// @param[in] geom_bases Geometry bases for elements
+	/// @param[in] total_local_boundary Local boundaries for elements
+	/// @param[in] n_bases Number of bases (nodes)
+	/// @param[in] dim Dimension of the mesh
+	/// @param[in] max_edge_length Maximum edge length of the proxy mesh
+	/// @param[in] tessellation Type of tessellation to use
+	/// @return Hash of the FE mesh, its discretization, and the proxy parameters
+	size_t collision_proxy_hash(
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &geom_bases,
+		const std::vector<mesh::LocalBoundary> &total_local_boundary,
+		const int n_bases,
+		const int dim,
+		const double max_edge_length,
+		const CollisionProxyTessellation tessellation);
+
+	/// @brief Save a collision proxy mesh and displacement map to an HDF5 cache file.
+	/// @param[in] filename Cache filename
+	/// @param[in] key Hash of the inputs used to build the proxy (see collision_proxy_hash)
+	/// @param[in] proxy_vertices Vertices of the proxy mesh
+	/// @param[in] proxy_faces Faces of the proxy mesh
+	/// @param[in] displacement_map_entries Displacement map entries
+	void save_collision_proxy_cache(
+		const std::string &filename,
+		const size_t key,
+		const Eigen::MatrixXd &proxy_vertices,
+		const Eigen::MatrixXi &proxy_faces,
+		const std::vector<Eigen::Triplet<double>> &displacement_map_entries);
+
+	/// @brief Load a collision proxy mesh and displacement map from an HDF5 cache file.
+	/// @param[in] filename Cache filename
+	/// @param[in] key Hash of the inputs used to build the proxy (see collision_proxy_hash)
+	/// @param[out] proxy_vertices Output vertices of the proxy mesh
+	/// @param[out] proxy_faces Output faces of the proxy mesh
+	/// @param[out] displacement_map_entries Output displacement map entries
+	/// @return True if the cache exists and was built with the same key
+	bool load_collision_proxy_cache(
+		const std::string &filename,
+		const size_t key,
+		Eigen::MatrixXd &proxy_vertices,
+		Eigen::MatrixXi &proxy_faces,
+		std::vector<Eigen::Triplet<double>> &displacement_map_entries);
+
 	/// @brief Build a collision proxy displacement map for a given mesh and proxy mesh.
 	/// @param[in] bases Bases for elements
 	/// @param[in] geom_bases Geometry bases for elements
@@ -40,27 +40,23 @@ namespace polyfem
 
 			for (int i = 0; i < n_refinement; ++i)
 			{
-				GEO::Mesh mesh;
-				mesh.copy(mesh_);
-
 				c2e_.reset();
 				boundary_vertices_.reset();
 				boundary_edges_.reset();
 
-				mesh_.clear(false, false);
-
+				// in place, without copying the mesh
 				// TODO add tags to the refinement
 				if (all_simplicial)
 				{
-					refine_triangle_mesh(mesh, mesh_);
+					refine_triangle_mesh_parallel(mesh_);
 				}
 				else if (t <= 0)
 				{
-					refine_polygonal_mesh(mesh, mesh_, Polygons::catmul_clark_split_func());
+					refine_polygonal_mesh_parallel(mesh_, Polygons::catmul_clark_split_func());
 				}
 				else
 				{
-					refine_polygonal_mesh(mesh, mesh_, Polygons::polar_split_func(t));
+					refine_polygonal_mesh_parallel(mesh_, Polygons::polar_split_func(t));
 				}
 
 				Navigation::prepare_mesh(mesh_);
@@ -170,7 +166,7 @@ namespace polyfem
 			return true;
 		}
 
-		bool CMesh2D::build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+		bool CMesh2D::build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F)
 		{
 			edge_nodes_.clear();
 			face_nodes_.clear();
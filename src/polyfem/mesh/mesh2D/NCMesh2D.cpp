@@ -36,7 +36,7 @@ namespace polyfem
 			refine(n_refinement - 1, t);
 		}
 
-		bool NCMesh2D::build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+		bool NCMesh2D::build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F)
 		{
 			GEO::Mesh mesh_;
 			mesh_.clear(false, false);
@@ -4,6 +4,7 @@
 #include <polyfem/mesh/MeshUtils.hpp>
 #include "PolygonUtils.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <iostream>
 #include <vector>
@@ -782,3 +783,222 @@ void polyfem::mesh::refine_triangle_mesh(const GEO::Mesh &M_in, GEO::Mesh &M_out
 		M_out.facets.create_triangle(e2v[0], e2v[1], e2v[2]);
 	}
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	/// output offsets of the per-facet counts
+	std::vector<int> prefix_sum(const std::vector<int> &counts, const int start = 0)
+	{
+		std::vector<int> offsets(counts.size() + 1);
+		offsets[0] = start;
+		std::partial_sum(counts.begin(), counts.end(), offsets.begin() + 1);
+		for (size_t i = 1; i < offsets.size(); ++i)
+			offsets[i] += start;
+		return offsets;
+	}
+
+	// Same numbering as the sequential refinement: the input vertices, then per facet the midpoints of the edges it
+	// visits first and the center of quads, then the interior vertices of the split polygons. The quads (or triangles)
+	// come before the facets of the split polygons.
+	void refine_in_place(GEO::Mesh &M, const bool triangles, const polyfem::mesh::Polygons::SplitFunction &split_func)
+	{
+		using namespace polyfem::mesh;
+		using GEO::index_t;
+
+		const int n_facets = M.facets.nb();
+		const int n_vertices = M.vertices.nb();
+		const int dim = M.vertices.dimension();
+		GEO::Attribute<index_t> c2e(M.facet_corners.attributes(), "edge_id");
+
+		// an edge belongs to the first facet visiting it
+		const auto is_owner = [&](const int f, const int lv) {
+			const index_t adj = M.facets.adjacent(f, lv);
+			return adj == GEO::NO_FACET || (int)adj > f;
+		};
+
+		// Step 1: count, and split the polygons (their outline only depends on the input vertices)
+		std::vector<int> n_mid_vertices(n_facets), n_quad_vertices(n_facets), n_polygon_vertices(n_facets, 0);
+		std::vector<int> n_quad_facets(n_facets), n_polygon_facets(n_facets, 0), n_polygon_corners(n_facets, 0);
+		std::vector<Eigen::MatrixXd> split_vertices(n_facets);
+		std::vector<std::vector<std::vector<int>>> split_facets(n_facets);
+
+		polyfem::utils::maybe_parallel_for(n_facets, [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd P;
+			for (int f = start; f < end; ++f)
+			{
+				const int nv = M.facets.nb_vertices(f);
+				assert(!triangles || nv == 3);
+
+				int owned = 0;
+				for (int lv = 0; lv < nv; ++lv)
+					owned += is_owner(f, lv);
+
+				n_mid_vertices[f] = owned;
+				n_quad_vertices[f] = !triangles && nv == 4 ? 1 : 0;
+				n_quad_facets[f] = triangles || nv == 4 ? 4 : 0;
+
+				if (triangles || nv <= 4)
+					continue;
+
+				P.resize(2 * nv, 2);
+				for (int lv = 0; lv < nv; ++lv)
+				{
+					const GEO::vec3 p0 = mesh_vertex(M, M.facets.vertex(f, lv));
+					const GEO::vec3 p1 = mesh_vertex(M, M.facets.vertex(f, (lv + 1) % nv));
+					const GEO::vec3 mid = 0.5 * (p0 + p1);
+					P.row(2 * lv) << p0[0], p0[1];
+					P.row(2 * lv + 1) << mid[0], mid[1];
+				}
+				split_func(P, split_vertices[f], split_facets[f]);
+				assert(split_vertices[f].rows() >= P.rows());
+
+				n_polygon_vertices[f] = split_vertices[f].rows() - P.rows();
+				n_polygon_facets[f] = split_facets[f].size();
+				for (const auto &poly : split_facets[f])
+					n_polygon_corners[f] += poly.size();
+			}
+		});
+
+		for (int f = 0; f < n_facets; ++f)
+			n_quad_vertices[f] += n_mid_vertices[f];
+		const std::vector<int> vertex_offset = prefix_sum(n_quad_vertices, n_vertices);
+		const std::vector<int> polygon_vertex_offset = prefix_sum(n_polygon_vertices, vertex_offset.back());
+		const std::vector<int> quad_facet_offset = prefix_sum(n_quad_facets);
+		const std::vector<int> polygon_facet_offset = prefix_sum(n_polygon_facets, quad_facet_offset.back());
+		const int facet_size = triangles ? 3 : 4;
+		const std::vector<int> polygon_corner_offset = prefix_sum(n_polygon_corners, quad_facet_offset.back() * facet_size);
+
+		const int total_vertices = polygon_vertex_offset.back();
+		const int total_facets = polygon_facet_offset.back();
+
+		std::vector<GEO::vec3> points(total_vertices);
+		std::vector<int> edge_to_midpoint(M.edges.nb(), -1);
+
+		// Step 2: new vertices
+		polyfem::utils::maybe_parallel_for(n_vertices, [&](int start, int end, int thread_id) {
+			for (int v = start; v < end; ++v)
+				points[v] = mesh_vertex(M, v);
+		});
+		polyfem::utils::maybe_parallel_for(n_facets, [&](int start, int end, int thread_id) {
+			for (int f = start; f < end; ++f)
+			{
+				const int nv = M.facets.nb_vertices(f);
+				int v = vertex_offset[f];
+				for (int lv = 0; lv < nv; ++lv)
+				{
+					if (!is_owner(f, lv))
+						continue;
+					edge_to_midpoint[c2e[M.facets.corner(f, lv)]] = v;
+					points[v++] = 0.5 * (mesh_vertex(M, M.facets.vertex(f, lv)) + mesh_vertex(M, M.facets.vertex(f, (lv + 1) % nv)));
+				}
+				if (v < vertex_offset[f + 1])
+					points[v] = facet_barycenter(M, f);
+
+				const int n = 2 * nv;
+				for (int k = 0; k < n_polygon_vertices[f]; ++k)
+					points[polygon_vertex_offset[f] + k] = GEO::vec3(split_vertices[f](n + k, 0), split_vertices[f](n + k, 1), 0);
+			}
+		});
+
+		// Step 3: new facets, as corner lists
+		std::vector<int> facet_sizes(total_facets, facet_size);
+		std::vector<index_t> corners(polygon_corner_offset.back());
+		polyfem::utils::maybe_parallel_for(n_facets, [&](int start, int end, int thread_id) {
+			for (int f = start; f < end; ++f)
+			{
+				const int nv = M.facets.nb_vertices(f);
+				const auto mid = [&](const int lv) { return (index_t)edge_to_midpoint[c2e[M.facets.corner(f, (lv + nv) % nv)]]; };
+
+				if (n_quad_facets[f] > 0)
+				{
+					index_t *c = &corners[quad_facet_offset[f] * facet_size];
+					for (int lv = 0; lv < nv; ++lv)
+					{
+						*c++ = M.facets.vertex(f, lv);
+						*c++ = mid(lv);
+						if (!triangles)
+							*c++ = vertex_offset[f + 1] - 1;
+						*c++ = mid(lv - 1);
+					}
+					if (triangles)
+					{
+						*c++ = mid(0);
+						*c++ = mid(1);
+						*c++ = mid(2);
+					}
+				}
+
+				if (n_polygon_facets[f] > 0)
+				{
+					const int n = 2 * nv;
+					index_t *c = &corners[polygon_corner_offset[f]];
+					int facet = polygon_facet_offset[f];
+					for (const auto &poly : split_facets[f])
+					{
+						facet_sizes[facet++] = poly.size();
+						for (const int vk : poly)
+						{
+							if (vk >= n)
+								*c++ = polygon_vertex_offset[f] + vk - n;
+							else if (vk % 2 == 0)
+								*c++ = M.facets.vertex(f, vk / 2);
+							else
+								*c++ = mid(vk / 2);
+						}
+					}
+				}
+			}
+		});
+
+		// Step 4: replace the mesh
+		const bool double_precision = M.vertices.double_precision();
+		c2e.unbind();
+		M.clear(false, false);
+		if (!double_precision)
+			M.vertices.set_single_precision();
+		if ((int)M.vertices.dimension() != dim)
+			M.vertices.set_dimension(dim);
+
+		M.vertices.create_vertices(total_vertices);
+		polyfem::utils::maybe_parallel_for(total_vertices, [&](int start, int end, int thread_id) {
+			for (int v = start; v < end; ++v)
+			{
+				for (int d = 0; d < std::min(3, dim); ++d)
+				{
+					if (double_precision)
+						M.vertices.point_ptr(v)[d] = points[v][d];
+					else
+						M.vertices.single_precision_point_ptr(v)[d] = (float)points[v][d];
+				}
+			}
+		});
+
+		if (triangles)
+			M.facets.create_triangles(total_facets);
+		else
+		{
+			for (int f = 0; f < total_facets; ++f)
+				M.facets.create_polygon(facet_sizes[f]);
+		}
+		polyfem::utils::maybe_parallel_for(total_facets, [&](int start, int end, int thread_id) {
+			for (int f = start; f < end; ++f)
+			{
+				const index_t begin = M.facets.corners_begin(f);
+				for (int lv = 0; lv < facet_sizes[f]; ++lv)
+					M.facets.set_vertex(f, lv, corners[begin + lv]);
+			}
+		});
+	}
+} // namespace
+
+void polyfem::mesh::refine_polygonal_mesh_parallel(GEO::Mesh &M, Polygons::SplitFunction split_func)
+{
+	refine_in_place(M, /*triangles=*/false, split_func);
+}
+
+void polyfem::mesh::refine_triangle_mesh_parallel(GEO::Mesh &M)
+{
+	refine_in_place(M, /*triangles=*/true, nullptr);
+}
@@ -133,6 +133,23 @@ namespace polyfem
 		///
 		void refine_triangle_mesh(const GEO::Mesh &M_in, GEO::Mesh &M_out);
 
+		///
+		/// Parallel in-place version of refine_polygonal_mesh (same output, same numbering). The new vertices, facets,
+		/// and corners of every facet are counted and offset with a prefix sum, then every facet fills its part of the
+		/// output concurrently, without navigation and intermediate copy of the mesh.
+		///
+		/// @param[in,out] M           Surface mesh to subdivide, prepared with Navigation::prepare_mesh
+		/// @param[in]     split_func  Functional used to split the new polygon interiors, must be thread safe
+		///
+		void refine_polygonal_mesh_parallel(GEO::Mesh &M, Polygons::SplitFunction split_func);
+
+		///
+		/// Parallel in-place version of refine_triangle_mesh (same output, same numbering)
+		///
+		/// @param[in,out] M  Triangle mesh, prepared with Navigation::prepare_mesh
+		///
+		void refine_triangle_mesh_parallel(GEO::Mesh &M);
+
 		// Kept for compatibility
 		[[deprecated]] inline void refine_polygonal_mesh(const GEO::Mesh &M_in, GEO::Mesh &M_out, bool refine_polygons = false, double t = 0.5)
 		{
@@ -2,12 +2,90 @@
 
 #include <vector>
 #include <Eigen/Dense>
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+
+#include <polyfem/utils/MemoryUsage.hpp>
 
 namespace polyfem
 {
 	namespace mesh
 	{
+		/// Read only view of a contiguous list of primitive ids (a std::vector or a row of a CSRAdjacency)
+		class IndexRange
+		{
+		public:
+			IndexRange() = default;
+			IndexRange(const uint32_t *begin, const uint32_t *end) : begin_(begin), end_(end) {}
+			IndexRange(const std::vector<uint32_t> &ids) : begin_(ids.data()), end_(ids.data() + ids.size()) {}
+
+			const uint32_t *begin() const { return begin_; }
+			const uint32_t *end() const { return end_; }
+			size_t size() const { return end_ - begin_; }
+			bool empty() const { return begin_ == end_; }
+			uint32_t operator[](const size_t i) const
+			{
+				assert(i < size());
+				return begin_[i];
+			}
+
+			std::vector<uint32_t> to_vector() const { return std::vector<uint32_t>(begin_, end_); }
+
+		private:
+			const uint32_t *begin_ = nullptr;
+			const uint32_t *end_ = nullptr;
+		};
+
+		/// Compressed sparse row adjacency, the list of the primitive i is indices[offsets[i], offsets[i + 1])
+		struct CSRAdjacency
+		{
+			std::vector<uint64_t> offsets;
+			std::vector<uint32_t> indices;
+
+			size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+			IndexRange operator[](const size_t i) const
+			{
+				assert(i < size());
+				return IndexRange(indices.data() + offsets[i], indices.data() + offsets[i + 1]);
+			}
+
+			/// @brief Flatten the lists of the primitives and free them
+			template <typename Primitive>
+			void compress(std::vector<Primitive> &primitives, std::vector<uint32_t> Primitive::*list)
+			{
+				offsets.resize(primitives.size() + 1);
+				offsets[0] = 0;
+				for (size_t i = 0; i < primitives.size(); ++i)
+					offsets[i + 1] = offsets[i] + (primitives[i].*list).size();
+
+				indices.resize(offsets.back());
+				for (size_t i = 0; i < primitives.size(); ++i)
+				{
+					std::copy((primitives[i].*list).begin(), (primitives[i].*list).end(), indices.begin() + offsets[i]);
+					std::vector<uint32_t>().swap(primitives[i].*list);
+				}
+			}
+
+			/// @brief Restore the lists of the primitives and free the flat arrays
+			template <typename Primitive>
+			void decompress(std::vector<Primitive> &primitives, std::vector<uint32_t> Primitive::*list)
+			{
+				assert(size() == primitives.size());
+				for (size_t i = 0; i < primitives.size(); ++i)
+					primitives[i].*list = (*this)[i].to_vector();
+				clear();
+			}
+
+			void clear()
+			{
+				std::vector<uint64_t>().swap(offsets);
+				std::vector<uint32_t>().swap(indices);
+			}
+
+			size_t memory_bytes() const { return utils::memory_bytes(offsets) + utils::memory_bytes(indices); }
+		};
+
 		struct Vertex
 		{
 			int id;
@@ -19,6 +97,11 @@ namespace polyfem
 
 			bool boundary;
 			bool boundary_hex;
+
+			size_t memory_bytes() const
+			{
+				return utils::memory_bytes(v) + utils::memory_bytes(neighbor_vs) + utils::memory_bytes(neighbor_es) + utils::memory_bytes(neighbor_fs) + utils::memory_bytes(neighbor_hs);
+			}
 		};
 		struct Edge
 		{
@@ -29,6 +112,8 @@ namespace polyfem
 
 			bool boundary;
 			bool boundary_hex;
+
+			size_t memory_bytes() const { return utils::memory_bytes(vs) + utils::memory_bytes(neighbor_fs) + utils::memory_bytes(neighbor_hs); }
 		};
 		struct Face
 		{
@@ -38,6 +123,8 @@ namespace polyfem
 			std::vector<uint32_t> neighbor_hs;
 			bool boundary;
 			bool boundary_hex;
+
+			size_t memory_bytes() const { return utils::memory_bytes(vs) + utils::memory_bytes(es) + utils::memory_bytes(neighbor_hs); }
 		};
 
 		struct Element
@@ -49,6 +136,11 @@ namespace polyfem
 			std::vector<bool> fs_flag;
 			bool hex = false;
 			std::vector<double> v_in_Kernel;
+
+			size_t memory_bytes() const
+			{
+				return utils::memory_bytes(vs) + utils::memory_bytes(es) + utils::memory_bytes(fs) + utils::memory_bytes(fs_flag) + utils::memory_bytes(v_in_Kernel);
+			}
 		};
 
 		enum class MeshType
@@ -75,8 +167,98 @@ namespace polyfem
 			Eigen::MatrixXi FV, FE, FH, FHi; // FV (3, nf), FE(3, nf), FH (2, nf), FHi(2, nf)
 			Eigen::MatrixXi HV, HF;          // HV(4, nh), HE(6, nh), HF(4, nh)
 
-			void append(const Mesh3DStorage &other)
+			// Connectivity queries, valid in both storages.
+			// When compressed the adjacency lists of the primitives are empty and the CSR arrays hold them instead.
+			IndexRange vertex_vertices(const int v) const { return compressed_ ? v_vs_[v] : IndexRange(vertices[v].neighbor_vs); }
+			IndexRange vertex_edges(const int v) const { return compressed_ ? v_es_[v] : IndexRange(vertices[v].neighbor_es); }
+			IndexRange vertex_faces(const int v) const { return compressed_ ? v_fs_[v] : IndexRange(vertices[v].neighbor_fs); }
+			IndexRange vertex_elements(const int v) const { return compressed_ ? v_hs_[v] : IndexRange(vertices[v].neighbor_hs); }
+			IndexRange edge_vertices(const int e) const { return compressed_ ? e_vs_[e] : IndexRange(edges[e].vs); }
+			IndexRange edge_faces(const int e) const { return compressed_ ? e_fs_[e] : IndexRange(edges[e].neighbor_fs); }
+			IndexRange edge_elements(const int e) const { return compressed_ ? e_hs_[e] : IndexRange(edges[e].neighbor_hs); }
+			IndexRange face_vertices(const int f) const { return compressed_ ? f_vs_[f] : IndexRange(faces[f].vs); }
+			IndexRange face_edges(const int f) const { return compressed_ ? f_es_[f] : IndexRange(faces[f].es); }
+			IndexRange face_elements(const int f) const { return compressed_ ? f_hs_[f] : IndexRange(faces[f].neighbor_hs); }
+			IndexRange element_vertices(const int h) const { return compressed_ ? h_vs_[h] : IndexRange(elements[h].vs); }
+			IndexRange element_edges(const int h) const { return compressed_ ? h_es_[h] : IndexRange(elements[h].es); }
+			IndexRange element_faces(const int h) const { return compressed_ ? h_fs_[h] : IndexRange(elements[h].fs); }
+			/// orientation flag of the face lf of the element h
+			bool element_face_flag(const int h, const int lf) const { return compressed_ ? bool(h_fs_flag_[h_fs_.offsets[h] + lf]) : bool(elements[h].fs_flag[lf]); }
+
+			bool is_compressed() const { return compressed_; }
+
+			/// @brief Move the adjacency lists of the primitives into flat CSR arrays (two allocations per relation instead of one per primitive).
+			/// The primitives keep their other attributes, the lists must be restored with decompress() before editing the connectivity.
+			void compress()
+			{
+				if (compressed_)
+					return;
+
+				v_vs_.compress(vertices, &Vertex::neighbor_vs);
+				v_es_.compress(vertices, &Vertex::neighbor_es);
+				v_fs_.compress(vertices, &Vertex::neighbor_fs);
+				v_hs_.compress(vertices, &Vertex::neighbor_hs);
+				e_vs_.compress(edges, &Edge::vs);
+				e_fs_.compress(edges, &Edge::neighbor_fs);
+				e_hs_.compress(edges, &Edge::neighbor_hs);
+				f_vs_.compress(faces, &Face::vs);
+				f_es_.compress(faces, &Face::es);
+				f_hs_.compress(faces, &Face::neighbor_hs);
+				h_vs_.compress(elements, &Element::vs);
+				h_es_.compress(elements, &Element::es);
+
+				// the flags are aligned with the faces of the elements
+				h_fs_flag_.clear();
+				for (const Element &h : elements)
+				{
+					assert(h.fs_flag.size() == h.fs.size());
+					h_fs_flag_.insert(h_fs_flag_.end(), h.fs_flag.begin(), h.fs_flag.end());
+				}
+				h_fs_.compress(elements, &Element::fs);
+				for (Element &h : elements)
+					std::vector<bool>().swap(h.fs_flag);
+
+				compressed_ = true;
+			}
+
+			/// @brief Restore the adjacency lists of the primitives
+			void decompress()
+			{
+				if (!compressed_)
+					return;
+
+				v_vs_.decompress(vertices, &Vertex::neighbor_vs);
+				v_es_.decompress(vertices, &Vertex::neighbor_es);
+				v_fs_.decompress(vertices, &Vertex::neighbor_fs);
+				v_hs_.decompress(vertices, &Vertex::neighbor_hs);
+				e_vs_.decompress(edges, &Edge::vs);
+				e_fs_.decompress(edges, &Edge::neighbor_fs);
+				e_hs_.decompress(edges, &Edge::neighbor_hs);
+				f_vs_.decompress(faces, &Face::vs);
+				f_es_.decompress(faces, &Face::es);
+				f_hs_.decompress(faces, &Face::neighbor_hs);
+				h_vs_.decompress(elements, &Element::vs);
+				h_es_.decompress(elements, &Element::es);
+
+				for (size_t h = 0; h < elements.size(); ++h)
+					elements[h].fs_flag.assign(h_fs_flag_.begin() + h_fs_.offsets[h], h_fs_flag_.begin() + h_fs_.offsets[h + 1]);
+				std::vector<uint8_t>().swap(h_fs_flag_);
+				h_fs_.decompress(elements, &Element::fs);
+
+				compressed_ = false;
+			}
+
+			void append(const Mesh3DStorage &in_other)
 			{
+				decompress();
+				Mesh3DStorage decompressed_other;
+				if (in_other.compressed_)
+				{
+					decompressed_other = in_other;
+					decompressed_other.decompress();
+				}
+				const Mesh3DStorage &other = in_other.compressed_ ? decompressed_other : in_other;
+
 				if (other.type != type)
 					type = MeshType::HYB;
 
@@ -194,6 +376,25 @@ namespace polyfem
 				// HF.conservativeResize(std::max(HF.rows(), other.HF.rows()), other.HF.cols() + HF.cols());
 				// HF.rightCols(other.HF.cols()) = other.HF.array() + n_f;
 			}
+
+			/// heap memory of the connectivity in bytes, in the compressed or the per primitive layout
+			size_t memory_bytes() const
+			{
+				size_t bytes = utils::memory_bytes(points) + utils::memory_bytes(vertices) + utils::memory_bytes(edges) + utils::memory_bytes(faces) + utils::memory_bytes(elements);
+				for (const Eigen::MatrixXi *m : {&EV, &FV, &FE, &FH, &FHi, &HV, &HF})
+					bytes += utils::memory_bytes(*m);
+				for (const CSRAdjacency *a : {&v_vs_, &v_es_, &v_fs_, &v_hs_, &e_vs_, &e_fs_, &e_hs_, &f_vs_, &f_es_, &f_hs_, &h_vs_, &h_es_, &h_fs_})
+					bytes += a->memory_bytes();
+				return bytes + utils::memory_bytes(h_fs_flag_);
+			}
+
+		private:
+			bool compressed_ = false;
+			CSRAdjacency v_vs_, v_es_, v_fs_, v_hs_;
+			CSRAdjacency e_vs_, e_fs_, e_hs_;
+			CSRAdjacency f_vs_, f_es_, f_hs_;
+			CSRAdjacency h_vs_, h_es_, h_fs_;
+			std::vector<uint8_t> h_fs_flag_;
 		};
 
 		struct Mesh_Quality
@@ -1,10 +1,13 @@
 #include "MeshProcessing3D.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <Eigen/Dense>
 
 #include <algorithm>
+#include <atomic>
 #include <map>
+#include <numeric>
 #include <set>
 #include <queue>
 #include <iterator>
@@ -15,46 +18,184 @@ using namespace polyfem;
 using namespace std;
 using namespace Eigen;
 
-void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
+namespace
 {
-	hmi.edges.clear();
-	if (hmi.type == MeshType::TRI || hmi.type == MeshType::QUA || hmi.type == MeshType::H_SUR)
+	/// number of bits needed to store the values in [0, n)
+	int n_bits(const size_t n)
 	{
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp;
-		temp.reserve(hmi.faces.size() * 3);
-		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
+		int bits = 1;
+		while (bits < 64 && (size_t(1) << bits) < n)
+			++bits;
+		return bits;
+	}
+
+	/// @brief Stable LSD radix sort of the ids by key(id), in parallel over fixed chunks of ids
+	/// @param[in,out] ids ids to sort
+	/// @param[in] bits number of significant bits of the keys
+	/// @param[in] key key of an id
+	template <typename Key>
+	void radix_sort(std::vector<uint32_t> &ids, const int bits, const Key &key)
+	{
+		constexpr int digit_bits = 11;
+		constexpr int n_buckets = 1 << digit_bits;
+
+		const size_t n = ids.size();
+		const int n_chunks = std::clamp<size_t>(n / (8 * n_buckets), 1, 64);
+		const auto chunk_begin = [&](const int c) { return n * c / n_chunks; };
+
+		std::vector<uint32_t> sorted(n);
+		std::vector<size_t> offsets(size_t(n_chunks) * n_buckets);
+		for (int shift = 0; shift < bits; shift += digit_bits)
 		{
-			int vn = hmi.faces[i].vs.size();
-			for (uint32_t j = 0; j < vn; ++j)
+			const auto digit = [&](const uint32_t id) { return (uint64_t(key(id)) >> shift) & (n_buckets - 1); };
+
+			std::fill(offsets.begin(), offsets.end(), 0);
+			utils::maybe_parallel_for(n_chunks, [&](int start, int end, int thread_id) {
+				for (int c = start; c < end; ++c)
+					for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i)
+						++offsets[size_t(c) * n_buckets + digit(ids[i])];
+			});
+
+			// bucket major, the chunks keep their order in every bucket
+			size_t sum = 0;
+			for (int b = 0; b < n_buckets; ++b)
+				for (int c = 0; c < n_chunks; ++c)
+				{
+					const size_t count = offsets[size_t(c) * n_buckets + b];
+					offsets[size_t(c) * n_buckets + b] = sum;
+					sum += count;
+				}
+
+			utils::maybe_parallel_for(n_chunks, [&](int start, int end, int thread_id) {
+				for (int c = start; c < end; ++c)
+					for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i)
+						sorted[offsets[size_t(c) * n_buckets + digit(ids[i])]++] = ids[i];
+			});
+			ids.swap(sorted);
+		}
+	}
+
+	/// @brief Build the edges of the faces: the face corners are radix sorted by vertex pair and the duplicates merged.
+	/// The edges are numbered by increasing vertex pair, as the previous std::sort of tuples did, their boundary flag is false.
+	/// @return number of faces of every edge
+	std::vector<int> build_edges(Mesh3DStorage &hmi)
+	{
+		const size_t n_faces = hmi.faces.size();
+
+		std::vector<uint32_t> corner_offsets(n_faces + 1, 0);
+		for (size_t i = 0; i < n_faces; ++i)
+			corner_offsets[i + 1] = corner_offsets[i] + hmi.faces[i].vs.size();
+
+		// corner j of the face i is the edge (vs[j], vs[j + 1])
+		const size_t n_corners = corner_offsets.back();
+		std::vector<uint32_t> corner_v0(n_corners), corner_v1(n_corners);
+		utils::maybe_parallel_for(n_faces, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % vn];
-				if (v0 > v1)
-					std::swap(v0, v1);
-				temp.push_back(std::make_tuple(v0, v1, i, j));
+				const auto &fvs = hmi.faces[i].vs;
+				const int vn = fvs.size();
+				for (int j = 0; j < vn; ++j)
+				{
+					uint32_t v0 = fvs[j], v1 = fvs[(j + 1) % vn];
+					if (v0 > v1)
+						std::swap(v0, v1);
+					corner_v0[corner_offsets[i] + j] = v0;
+					corner_v1[corner_offsets[i] + j] = v1;
+				}
+				hmi.faces[i].es.resize(vn);
 			}
-			hmi.faces[i].es.resize(vn);
-		}
-		std::sort(temp.begin(), temp.end());
-		hmi.edges.reserve(temp.size() / 2);
-		uint32_t E_num = 0;
-		Edge e;
-		e.boundary = true;
-		e.vs.resize(2);
-		for (uint32_t i = 0; i < temp.size(); ++i)
+		});
+
+		std::vector<uint32_t> ids(n_corners);
+		std::iota(ids.begin(), ids.end(), 0);
+		const int bits = n_bits(hmi.vertices.size());
+		radix_sort(ids, bits, [&](const uint32_t id) { return corner_v1[id]; });
+		radix_sort(ids, bits, [&](const uint32_t id) { return corner_v0[id]; });
+
+		std::vector<uint32_t> corner_edge(n_corners);
+		std::vector<uint32_t> first_corner;
+		first_corner.reserve(n_corners / 2);
+		for (size_t i = 0; i < n_corners; ++i)
 		{
-			if (i == 0 || (i != 0 && (std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))))
+			if (i == 0 || corner_v0[ids[i]] != corner_v0[ids[i - 1]] || corner_v1[ids[i]] != corner_v1[ids[i - 1]])
+				first_corner.push_back(ids[i]);
+			corner_edge[ids[i]] = first_corner.size() - 1;
+		}
+
+		std::vector<int> n_edge_faces(first_corner.size(), 0);
+		for (size_t i = 0; i < n_corners; ++i)
+			++n_edge_faces[corner_edge[i]];
+
+		hmi.edges.resize(first_corner.size());
+		utils::maybe_parallel_for(hmi.edges.size(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
 			{
-				e.id = E_num;
-				E_num++;
-				e.vs[0] = std::get<0>(temp[i]);
-				e.vs[1] = std::get<1>(temp[i]);
-				hmi.edges.push_back(e);
+				Edge &edge = hmi.edges[e];
+				edge.id = e;
+				edge.vs = {corner_v0[first_corner[e]], corner_v1[first_corner[e]]};
+				edge.boundary = false;
 			}
-			else if (i != 0 && (std::get<0>(temp[i]) == std::get<0>(temp[i - 1]) && std::get<1>(temp[i]) == std::get<1>(temp[i - 1])))
-				hmi.edges[E_num - 1].boundary = false;
+		});
+		utils::maybe_parallel_for(n_faces, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				for (uint32_t j = 0; j < hmi.faces[i].es.size(); ++j)
+					hmi.faces[i].es[j] = corner_edge[corner_offsets[i] + j];
+		});
+
+		return n_edge_faces;
+	}
+
+	/// @brief Transpose an adjacency: the list of cols[c] holds the rows listing c, in increasing order
+	/// @param[in] n_rows number of rows
+	/// @param[in] row list of a row
+	/// @param[in,out] cols primitives receiving the lists
+	/// @param[in] list list member of the primitives
+	template <typename Row, typename Primitive>
+	void transpose(const size_t n_rows, const Row &row, std::vector<Primitive> &cols, std::vector<uint32_t> Primitive::*list)
+	{
+		std::vector<std::atomic<uint32_t>> sizes(cols.size());
+		utils::maybe_parallel_for(cols.size(), [&](int start, int end, int thread_id) {
+			for (int c = start; c < end; ++c)
+				sizes[c].store(0, std::memory_order_relaxed);
+		});
+
+		utils::maybe_parallel_for(n_rows, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				for (const uint32_t c : row(i))
+					sizes[c].fetch_add(1, std::memory_order_relaxed);
+		});
+
+		utils::maybe_parallel_for(cols.size(), [&](int start, int end, int thread_id) {
+			for (int c = start; c < end; ++c)
+			{
+				(cols[c].*list).resize(sizes[c].load(std::memory_order_relaxed));
+				sizes[c].store(0, std::memory_order_relaxed);
+			}
+		});
+
+		utils::maybe_parallel_for(n_rows, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				for (const uint32_t c : row(i))
+					(cols[c].*list)[sizes[c].fetch_add(1, std::memory_order_relaxed)] = i;
+		});
+
+		// same order as a serial push_back over the rows
+		utils::maybe_parallel_for(cols.size(), [&](int start, int end, int thread_id) {
+			for (int c = start; c < end; ++c)
+				std::sort((cols[c].*list).begin(), (cols[c].*list).end());
+		});
+	}
+} // namespace
+
+void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
+{
+	hmi.edges.clear();
+	if (hmi.type == MeshType::TRI || hmi.type == MeshType::QUA || hmi.type == MeshType::H_SUR)
+	{
+		const std::vector<int> n_edge_faces = build_edges(hmi);
+		for (uint32_t i = 0; i < hmi.edges.size(); ++i)
+			hmi.edges[i].boundary = n_edge_faces[i] == 1;
 
-			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
-		}
 		// boundary
 		for (auto &v : hmi.vertices)
 			v.boundary = false;
@@ -66,73 +207,51 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 	}
 	else if (hmi.type == MeshType::HEX)
 	{
-
-		std::vector<std::vector<uint32_t>> total_fs(hmi.elements.size() * 6);
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>> tempF(hmi.elements.size() * 6);
-		std::vector<uint32_t> vs(4);
-		for (uint32_t i = 0; i < hmi.elements.size(); ++i)
-		{
-			for (short j = 0; j < 6; j++)
+		// (sorted) vertices of the 6 faces of every hex
+		const size_t n_hex_faces = hmi.elements.size() * 6;
+		std::vector<std::array<uint32_t, 4>> total_fs(n_hex_faces), sorted_fs(n_hex_faces);
+		utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				for (short k = 0; k < 4; k++)
-					vs[k] = hmi.elements[i].vs[hex_face_table[j][k]];
-				uint32_t id = 6 * i + j;
-				total_fs[id] = vs;
-				std::sort(vs.begin(), vs.end());
-				tempF[id] = std::make_tuple(vs[0], vs[1], vs[2], vs[3], id, i, j);
+				for (short j = 0; j < 6; j++)
+				{
+					const uint32_t id = 6 * i + j;
+					for (short k = 0; k < 4; k++)
+						total_fs[id][k] = hmi.elements[i].vs[hex_face_table[j][k]];
+					sorted_fs[id] = total_fs[id];
+					std::sort(sorted_fs[id].begin(), sorted_fs[id].end());
+				}
+				hmi.elements[i].fs.resize(6);
 			}
-			hmi.elements[i].fs.resize(6);
-		}
-		std::sort(tempF.begin(), tempF.end());
-		hmi.faces.reserve(tempF.size() / 3);
+		});
+
+		std::vector<uint32_t> ids(n_hex_faces);
+		std::iota(ids.begin(), ids.end(), 0);
+		const int bits = n_bits(hmi.vertices.size());
+		for (int k = 3; k >= 0; --k)
+			radix_sort(ids, bits, [&](const uint32_t id) { return sorted_fs[id][k]; });
+
+		hmi.faces.reserve(n_hex_faces / 2);
 		Face f;
 		f.boundary = true;
 		uint32_t F_num = 0;
-		for (uint32_t i = 0; i < tempF.size(); ++i)
+		for (uint32_t i = 0; i < ids.size(); ++i)
 		{
-			if (i == 0 || (i != 0 && (std::get<0>(tempF[i]) != std::get<0>(tempF[i - 1]) || std::get<1>(tempF[i]) != std::get<1>(tempF[i - 1]) || std::get<2>(tempF[i]) != std::get<2>(tempF[i - 1]) || std::get<3>(tempF[i]) != std::get<3>(tempF[i - 1]))))
+			if (i == 0 || sorted_fs[ids[i]] != sorted_fs[ids[i - 1]])
 			{
 				f.id = F_num;
 				F_num++;
-				f.vs = total_fs[std::get<4>(tempF[i])];
+				f.vs.assign(total_fs[ids[i]].begin(), total_fs[ids[i]].end());
 				hmi.faces.push_back(f);
 			}
-			else if (i != 0 && (std::get<0>(tempF[i]) == std::get<0>(tempF[i - 1]) && std::get<1>(tempF[i]) == std::get<1>(tempF[i - 1]) && std::get<2>(tempF[i]) == std::get<2>(tempF[i - 1]) && std::get<3>(tempF[i]) == std::get<3>(tempF[i - 1])))
+			else
 				hmi.faces[F_num - 1].boundary = false;
 
-			hmi.elements[std::get<5>(tempF[i])].fs[std::get<6>(tempF[i])] = F_num - 1;
+			hmi.elements[ids[i] / 6].fs[ids[i] % 6] = F_num - 1;
 		}
 
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp(hmi.faces.size() * 4);
-		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
-		{
-			for (uint32_t j = 0; j < 4; ++j)
-			{
-				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % 4];
-				if (v0 > v1)
-					std::swap(v0, v1);
-				temp[4 * i + j] = std::make_tuple(v0, v1, i, j);
-			}
-			hmi.faces[i].es.resize(4);
-		}
-		std::sort(temp.begin(), temp.end());
-		hmi.edges.reserve(temp.size() / 2);
-		uint32_t E_num = 0;
-		Edge e;
-		e.boundary = false;
-		e.vs.resize(2);
-		for (uint32_t i = 0; i < temp.size(); ++i)
-		{
-			if (i == 0 || (i != 0 && (std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))))
-			{
-				e.id = E_num;
-				E_num++;
-				e.vs[0] = std::get<0>(temp[i]);
-				e.vs[1] = std::get<1>(temp[i]);
-				hmi.edges.push_back(e);
-			}
-			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
-		}
+		build_edges(hmi);
+
 		// boundary
 		for (auto &v : hmi.vertices)
 			v.boundary = false;
@@ -148,43 +267,14 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 	else if (hmi.type == MeshType::HYB || hmi.type == MeshType::TET)
 	{
 		vector<bool> bf_flag(hmi.faces.size(), false);
-		for (auto h : hmi.elements)
+		for (const auto &h : hmi.elements)
 			for (auto f : h.fs)
 				bf_flag[f] = !bf_flag[f];
 		for (auto &f : hmi.faces)
 			f.boundary = bf_flag[f.id];
 
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp;
-		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
-		{
-			int fl = hmi.faces[i].vs.size();
-			for (uint32_t j = 0; j < hmi.faces[i].vs.size(); ++j)
-			{
-				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % fl];
-				if (v0 > v1)
-					std::swap(v0, v1);
-				temp.push_back(std::make_tuple(v0, v1, i, j));
-			}
-			hmi.faces[i].es.resize(fl);
-		}
-		std::sort(temp.begin(), temp.end());
-		hmi.edges.reserve(temp.size() / 2);
-		uint32_t E_num = 0;
-		Edge e;
-		e.boundary = false;
-		e.vs.resize(2);
-		for (uint32_t i = 0; i < temp.size(); ++i)
-		{
-			if (i == 0 || (i != 0 && (std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))))
-			{
-				e.id = E_num;
-				E_num++;
-				e.vs[0] = std::get<0>(temp[i]);
-				e.vs[1] = std::get<1>(temp[i]);
-				hmi.edges.push_back(e);
-			}
-			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
-		}
+		build_edges(hmi);
+
 		// boundary
 		for (auto &v : hmi.vertices)
 			v.boundary = false;
@@ -197,191 +287,172 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 					hmi.vertices[hmi.faces[i].vs[j]].boundary = true;
 				}
 	}
-	// f_nhs;
-	for (auto &f : hmi.faces)
-		f.neighbor_hs.clear();
-	for (uint32_t i = 0; i < hmi.elements.size(); i++)
-	{
-		for (uint32_t j = 0; j < hmi.elements[i].fs.size(); j++)
-		{
-			hmi.faces[hmi.elements[i].fs[j]].neighbor_hs.push_back(i);
-		}
-	}
+	// f_nhs
+	transpose(hmi.elements.size(), [&](const int i) -> const auto & { return hmi.elements[i].fs; }, hmi.faces, &Face::neighbor_hs);
 	// e_nfs, v_nfs
-	for (auto &e : hmi.edges)
-		e.neighbor_fs.clear();
-	for (auto &v : hmi.vertices)
-		v.neighbor_fs.clear();
-	for (uint32_t i = 0; i < hmi.faces.size(); i++)
-	{
-		for (uint32_t j = 0; j < hmi.faces[i].es.size(); j++)
-			hmi.edges[hmi.faces[i].es[j]].neighbor_fs.push_back(i);
-		for (uint32_t j = 0; j < hmi.faces[i].vs.size(); j++)
-			hmi.vertices[hmi.faces[i].vs[j]].neighbor_fs.push_back(i);
-	}
+	transpose(hmi.faces.size(), [&](const int i) -> const auto & { return hmi.faces[i].es; }, hmi.edges, &Edge::neighbor_fs);
+	transpose(hmi.faces.size(), [&](const int i) -> const auto & { return hmi.faces[i].vs; }, hmi.vertices, &Vertex::neighbor_fs);
 	// v_nes, v_nvs
-	for (auto &v : hmi.vertices)
-	{
-		v.neighbor_es.clear();
-		v.neighbor_vs.clear();
-	}
-	for (uint32_t i = 0; i < hmi.edges.size(); i++)
-	{
-		uint32_t v0 = hmi.edges[i].vs[0], v1 = hmi.edges[i].vs[1];
-		hmi.vertices[v0].neighbor_es.push_back(i);
-		hmi.vertices[v1].neighbor_es.push_back(i);
-		hmi.vertices[v0].neighbor_vs.push_back(v1);
-		hmi.vertices[v1].neighbor_vs.push_back(v0);
-	}
+	transpose(hmi.edges.size(), [&](const int i) -> const auto & { return hmi.edges[i].vs; }, hmi.vertices, &Vertex::neighbor_es);
+	utils::maybe_parallel_for(hmi.vertices.size(), [&](int start, int end, int thread_id) {
+		for (int v = start; v < end; ++v)
+		{
+			auto &vertex = hmi.vertices[v];
+			vertex.neighbor_vs.resize(vertex.neighbor_es.size());
+			for (uint32_t j = 0; j < vertex.neighbor_es.size(); ++j)
+			{
+				const auto &evs = hmi.edges[vertex.neighbor_es[j]].vs;
+				vertex.neighbor_vs[j] = evs[0] == v ? evs[1] : evs[0];
+			}
+		}
+	});
 	// e_nhs
-	for (auto &e : hmi.edges)
-		e.neighbor_hs.clear();
-	for (auto &ele : hmi.elements)
-		ele.es.clear();
-	for (uint32_t i = 0; i < hmi.edges.size(); i++)
-	{
+	utils::maybe_parallel_for(hmi.edges.size(), [&](int start, int end, int thread_id) {
 		std::vector<uint32_t> nhs;
-		for (uint32_t j = 0; j < hmi.edges[i].neighbor_fs.size(); j++)
+		for (int i = start; i < end; ++i)
 		{
-			uint32_t nfid = hmi.edges[i].neighbor_fs[j];
-			nhs.insert(nhs.end(), hmi.faces[nfid].neighbor_hs.begin(), hmi.faces[nfid].neighbor_hs.end());
+			nhs.clear();
+			for (uint32_t j = 0; j < hmi.edges[i].neighbor_fs.size(); j++)
+			{
+				uint32_t nfid = hmi.edges[i].neighbor_fs[j];
+				nhs.insert(nhs.end(), hmi.faces[nfid].neighbor_hs.begin(), hmi.faces[nfid].neighbor_hs.end());
+			}
+			std::sort(nhs.begin(), nhs.end());
+			nhs.erase(std::unique(nhs.begin(), nhs.end()), nhs.end());
+			hmi.edges[i].neighbor_hs = nhs;
 		}
-		std::sort(nhs.begin(), nhs.end());
-		nhs.erase(std::unique(nhs.begin(), nhs.end()), nhs.end());
-		hmi.edges[i].neighbor_hs = nhs;
-		for (auto nhid : nhs)
-			hmi.elements[nhid].es.push_back(i);
-	}
+	});
+	transpose(hmi.edges.size(), [&](const int i) -> const auto & { return hmi.edges[i].neighbor_hs; }, hmi.elements, &Element::es);
 	// v_nhs; ordering fs for hex
 	if (hmi.type != MeshType::HYB && hmi.type != MeshType::TET)
 		return;
 
-	for (auto &v : hmi.vertices)
-		v.neighbor_hs.clear();
-	for (uint32_t i = 0; i < hmi.elements.size(); i++)
-	{
-		vector<uint32_t> vs;
-		for (auto fid : hmi.elements[i].fs)
-			vs.insert(vs.end(), hmi.faces[fid].vs.begin(), hmi.faces[fid].vs.end());
-		sort(vs.begin(), vs.end());
-		vs.erase(unique(vs.begin(), vs.end()), vs.end());
-
-		bool degree3 = true;
-		for (auto vid : vs)
+	// the elements only read the connectivity built so far
+	utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+		for (int i = start; i < end; i++)
 		{
-			int nv = 0;
-			for (auto nvid : hmi.vertices[vid].neighbor_vs)
-				if (find(vs.begin(), vs.end(), nvid) != vs.end())
-					nv++;
-			if (nv != 3)
+			vector<uint32_t> vs;
+			for (auto fid : hmi.elements[i].fs)
+				vs.insert(vs.end(), hmi.faces[fid].vs.begin(), hmi.faces[fid].vs.end());
+			sort(vs.begin(), vs.end());
+			vs.erase(unique(vs.begin(), vs.end()), vs.end());
+
+			bool degree3 = true;
+			for (auto vid : vs)
 			{
-				degree3 = false;
-				break;
+				int nv = 0;
+				for (auto nvid : hmi.vertices[vid].neighbor_vs)
+					if (find(vs.begin(), vs.end(), nvid) != vs.end())
+						nv++;
+				if (nv != 3)
+				{
+					degree3 = false;
+					break;
+				}
 			}
-		}
 
-		if (hmi.elements[i].hex && (vs.size() != 8 || !degree3))
-			hmi.elements[i].hex = false;
+			if (hmi.elements[i].hex && (vs.size() != 8 || !degree3))
+				hmi.elements[i].hex = false;
 
-		hmi.elements[i].vs.clear();
+			hmi.elements[i].vs.clear();
 
-		if (hmi.elements[i].hex)
-		{
-			int top_fid = hmi.elements[i].fs[0];
-			hmi.elements[i].vs = hmi.faces[top_fid].vs;
+			if (hmi.elements[i].hex)
+			{
+				int top_fid = hmi.elements[i].fs[0];
+				hmi.elements[i].vs = hmi.faces[top_fid].vs;
 
-			std::set<uint32_t> s_model(vs.begin(), vs.end());
-			std::set<uint32_t> s_pattern(hmi.faces[top_fid].vs.begin(), hmi.faces[top_fid].vs.end());
-			vector<uint32_t> vs_left;
-			std::set_difference(s_model.begin(), s_model.end(), s_pattern.begin(), s_pattern.end(), std::back_inserter(vs_left));
+				std::set<uint32_t> s_model(vs.begin(), vs.end());
+				std::set<uint32_t> s_pattern(hmi.faces[top_fid].vs.begin(), hmi.faces[top_fid].vs.end());
+				vector<uint32_t> vs_left;
+				std::set_difference(s_model.begin(), s_model.end(), s_pattern.begin(), s_pattern.end(), std::back_inserter(vs_left));
 
-			for (auto vid : hmi.faces[top_fid].vs)
-				for (auto nvid : hmi.vertices[vid].neighbor_vs)
-					if (find(vs_left.begin(), vs_left.end(), nvid) != vs_left.end())
-					{
-						hmi.elements[i].vs.push_back(nvid);
-						break;
-					}
+				for (auto vid : hmi.faces[top_fid].vs)
+					for (auto nvid : hmi.vertices[vid].neighbor_vs)
+						if (find(vs_left.begin(), vs_left.end(), nvid) != vs_left.end())
+						{
+							hmi.elements[i].vs.push_back(nvid);
+							break;
+						}
 
-			function<int(vector<uint32_t> &, int &)> WHICH_F = [&](vector<uint32_t> &vs0, int &f_flag) -> int {
-				int which_f = -1;
-				sort(vs0.begin(), vs0.end());
-				bool found_f = false;
-				for (uint32_t j = 0; j < hmi.elements[i].fs.size(); j++)
-				{
-					auto fid = hmi.elements[i].fs[j];
-					vector<uint32_t> vs1 = hmi.faces[fid].vs;
-					sort(vs1.begin(), vs1.end());
-					if (vs0.size() == vs1.size() && std::equal(vs0.begin(), vs0.end(), vs1.begin()))
+				function<int(vector<uint32_t> &, int &)> WHICH_F = [&](vector<uint32_t> &vs0, int &f_flag) -> int {
+					int which_f = -1;
+					sort(vs0.begin(), vs0.end());
+					bool found_f = false;
+					for (uint32_t j = 0; j < hmi.elements[i].fs.size(); j++)
 					{
-						f_flag = hmi.elements[i].fs_flag[j];
-						which_f = fid;
-						break;
+						auto fid = hmi.elements[i].fs[j];
+						vector<uint32_t> vs1 = hmi.faces[fid].vs;
+						sort(vs1.begin(), vs1.end());
+						if (vs0.size() == vs1.size() && std::equal(vs0.begin(), vs0.end(), vs1.begin()))
+						{
+							f_flag = hmi.elements[i].fs_flag[j];
+							which_f = fid;
+							break;
+						}
 					}
-				}
-				return which_f;
-			};
-
-			vector<uint32_t> fs;
-			vector<bool> fs_flag;
-			fs_flag.push_back(hmi.elements[i].fs_flag[0]);
-			fs.push_back(top_fid);
-			vector<uint32_t> vs_temp;
-
-			vs_temp.insert(vs_temp.end(), hmi.elements[i].vs.begin() + 4, hmi.elements[i].vs.end());
-			int f_flag = -1;
-			int bottom_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(bottom_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[0]);
-			vs_temp.push_back(hmi.elements[i].vs[1]);
-			vs_temp.push_back(hmi.elements[i].vs[4]);
-			vs_temp.push_back(hmi.elements[i].vs[5]);
-			f_flag = -1;
-			int front_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(front_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[2]);
-			vs_temp.push_back(hmi.elements[i].vs[3]);
-			vs_temp.push_back(hmi.elements[i].vs[6]);
-			vs_temp.push_back(hmi.elements[i].vs[7]);
-			f_flag = -1;
-			int back_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(back_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[1]);
-			vs_temp.push_back(hmi.elements[i].vs[2]);
-			vs_temp.push_back(hmi.elements[i].vs[5]);
-			vs_temp.push_back(hmi.elements[i].vs[6]);
-			f_flag = -1;
-			int left_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(left_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[3]);
-			vs_temp.push_back(hmi.elements[i].vs[0]);
-			vs_temp.push_back(hmi.elements[i].vs[7]);
-			vs_temp.push_back(hmi.elements[i].vs[4]);
-			f_flag = -1;
-			int right_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(right_fid);
-
-			hmi.elements[i].fs = fs;
-			hmi.elements[i].fs_flag = fs_flag;
+					return which_f;
+				};
+
+				vector<uint32_t> fs;
+				vector<bool> fs_flag;
+				fs_flag.push_back(hmi.elements[i].fs_flag[0]);
+				fs.push_back(top_fid);
+				vector<uint32_t> vs_temp;
+
+				vs_temp.insert(vs_temp.end(), hmi.elements[i].vs.begin() + 4, hmi.elements[i].vs.end());
+				int f_flag = -1;
+				int bottom_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(bottom_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[0]);
+				vs_temp.push_back(hmi.elements[i].vs[1]);
+				vs_temp.push_back(hmi.elements[i].vs[4]);
+				vs_temp.push_back(hmi.elements[i].vs[5]);
+				f_flag = -1;
+				int front_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(front_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[2]);
+				vs_temp.push_back(hmi.elements[i].vs[3]);
+				vs_temp.push_back(hmi.elements[i].vs[6]);
+				vs_temp.push_back(hmi.elements[i].vs[7]);
+				f_flag = -1;
+				int back_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(back_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[1]);
+				vs_temp.push_back(hmi.elements[i].vs[2]);
+				vs_temp.push_back(hmi.elements[i].vs[5]);
+				vs_temp.push_back(hmi.elements[i].vs[6]);
+				f_flag = -1;
+				int left_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(left_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[3]);
+				vs_temp.push_back(hmi.elements[i].vs[0]);
+				vs_temp.push_back(hmi.elements[i].vs[7]);
+				vs_temp.push_back(hmi.elements[i].vs[4]);
+				f_flag = -1;
+				int right_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(right_fid);
+
+				hmi.elements[i].fs = fs;
+				hmi.elements[i].fs_flag = fs_flag;
+			}
+			else
+				hmi.elements[i].vs = vs;
 		}
-		else
-			hmi.elements[i].vs = vs;
-		for (uint32_t j = 0; j < hmi.elements[i].vs.size(); j++)
-			hmi.vertices[hmi.elements[i].vs[j]].neighbor_hs.push_back(i);
-	}
+	});
+	transpose(hmi.elements.size(), [&](const int i) -> const auto & { return hmi.elements[i].vs; }, hmi.vertices, &Vertex::neighbor_hs);
 	// matrix representation of tet mesh
 	if (hmi.type == MeshType::TET)
 	{
@@ -395,50 +466,52 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 		hmi.FE.resize(3, hmi.faces.size());
 		hmi.FH.resize(2, hmi.faces.size());
 		hmi.FHi.resize(2, hmi.faces.size());
-		for (const auto &f : hmi.faces)
-		{
-			hmi.FV(0, f.id) = f.vs[0];
-			hmi.FV(1, f.id) = f.vs[1];
-			hmi.FV(2, f.id) = f.vs[2];
-
-			hmi.FE(0, f.id) = f.es[0];
-			hmi.FE(1, f.id) = f.es[1];
-			hmi.FE(2, f.id) = f.es[2];
-
-			hmi.FH(0, f.id) = f.neighbor_hs[0];
-			for (int i = 0; i < hmi.elements[f.neighbor_hs[0]].fs.size(); i++)
-				if (f.id == hmi.elements[f.neighbor_hs[0]].fs[i])
-					hmi.FHi(0, f.id) = i;
-
-			hmi.FH(1, f.id) = -1;
-			hmi.FHi(1, f.id) = -1;
-			if (f.neighbor_hs.size() == 2)
+		utils::maybe_parallel_for(hmi.faces.size(), [&](int start, int end, int thread_id) {
+			for (int fi = start; fi < end; ++fi)
 			{
-				hmi.FH(1, f.id) = f.neighbor_hs[1];
-				for (int i = 0; i < hmi.elements[f.neighbor_hs[1]].fs.size(); i++)
-					if (f.id == hmi.elements[f.neighbor_hs[1]].fs[i])
-						hmi.FHi(1, f.id) = i;
+				const auto &f = hmi.faces[fi];
+				hmi.FV(0, f.id) = f.vs[0];
+				hmi.FV(1, f.id) = f.vs[1];
+				hmi.FV(2, f.id) = f.vs[2];
+
+				hmi.FE(0, f.id) = f.es[0];
+				hmi.FE(1, f.id) = f.es[1];
+				hmi.FE(2, f.id) = f.es[2];
+
+				hmi.FH(0, f.id) = f.neighbor_hs[0];
+				for (int i = 0; i < hmi.elements[f.neighbor_hs[0]].fs.size(); i++)
+					if (f.id == hmi.elements[f.neighbor_hs[0]].fs[i])
+						hmi.FHi(0, f.id) = i;
+
+				hmi.FH(1, f.id) = -1;
+				hmi.FHi(1, f.id) = -1;
+				if (f.neighbor_hs.size() == 2)
+				{
+					hmi.FH(1, f.id) = f.neighbor_hs[1];
+					for (int i = 0; i < hmi.elements[f.neighbor_hs[1]].fs.size(); i++)
+						if (f.id == hmi.elements[f.neighbor_hs[1]].fs[i])
+							hmi.FHi(1, f.id) = i;
+				}
 			}
-		}
+		});
 		hmi.HV.resize(4, hmi.elements.size());
 		hmi.HF.resize(4, hmi.elements.size());
-		for (const auto &h : hmi.elements)
-		{
-			hmi.HV(0, h.id) = h.vs[0];
-			hmi.HV(1, h.id) = h.vs[1];
-			hmi.HV(2, h.id) = h.vs[2];
-			hmi.HV(3, h.id) = h.vs[3];
-
-			hmi.HF(0, h.id) = h.fs[0];
-			hmi.HF(1, h.id) = h.fs[1];
-			hmi.HF(2, h.id) = h.fs[2];
-			hmi.HF(3, h.id) = h.fs[3];
-		}
+		utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+			for (int hi = start; hi < end; ++hi)
+			{
+				const auto &h = hmi.elements[hi];
+				for (int k = 0; k < 4; ++k)
+				{
+					hmi.HV(k, h.id) = h.vs[k];
+					hmi.HF(k, h.id) = h.fs[k];
+				}
+			}
+		});
 	}
 
 	// boundary flags for hybrid mesh
 	std::vector<bool> bv_flag(hmi.vertices.size(), false), be_flag(hmi.edges.size(), false), bf_flag(hmi.faces.size(), false);
-	for (auto f : hmi.faces)
+	for (const auto &f : hmi.faces)
 		if (f.boundary && hmi.elements[f.neighbor_hs[0]].hex)
 			bf_flag[f.id] = true;
 		else if (!f.boundary)
@@ -678,6 +751,9 @@ double MeshProcessing3D::a_jacobian(Vector3d &v0, Vector3d &v1, Vector3d &v2, Ve
 
 void MeshProcessing3D::global_orientation_hexes(Mesh3DStorage &hmi)
 {
+	if (std::none_of(hmi.elements.begin(), hmi.elements.end(), [](const Element &ele) { return ele.hex; }))
+		return;
+
 	Mesh3DStorage mesh;
 	mesh.type = MeshType::HEX;
 	mesh.points = hmi.points;
@@ -687,7 +763,7 @@ void MeshProcessing3D::global_orientation_hexes(Mesh3DStorage &hmi)
 		Vertex v_;
 		v_.id = v.id;
 		v_.v = v.v;
-		mesh.vertices[v.id] = v;
+		mesh.vertices[v.id] = v_;
 	}
 	vector<int> Ele_map(hmi.elements.size(), -1), Ele_map_reverse;
 	for (const auto &ele : hmi.elements)
@@ -1734,7 +1810,7 @@ void MeshProcessing3D::ele_subdivison_levels(const Mesh3DStorage &hmi, std::vect
 
 // template<typename T>
 // void MeshProcessing3D::set_intersection_own(const std::vector<T> &A, const std::vector<T> &B, std::vector<T> &C, const int &num){
-void MeshProcessing3D::set_intersection_own(const std::vector<uint32_t> &A, const std::vector<uint32_t> &B, std::array<uint32_t, 2> &C, int &num)
+void MeshProcessing3D::set_intersection_own(const IndexRange &A, const IndexRange &B, std::array<uint32_t, 2> &C, int &num)
 {
 	// void MeshProcessing3D::set_intersection_own( std::vector<uint32_t> &A,  std::vector<uint32_t> &B, std::vector<uint32_t> &C, int &num)
 	//  C.resize(num);
@@ -61,7 +61,7 @@ namespace polyfem
 			void ele_subdivison_levels(const Mesh3DStorage &hmi, std::vector<int> &Ls);
 
 			// template<typename T>
-			void set_intersection_own(const std::vector<uint32_t> &A, const std::vector<uint32_t> &B, std::array<uint32_t, 2> &C, int &num);
+			void set_intersection_own(const IndexRange &A, const IndexRange &B, std::array<uint32_t, 2> &C, int &num);
 		} // namespace MeshProcessing3D
 	}     // namespace mesh
 } // namespace polyfem
@@ -3,10 +3,13 @@
 #include <polyfem/utils/StringUtils.hpp>
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/writeMESH.h>
 
 #include <geogram/mesh/mesh_io.h>
+
+#include <algorithm>
 #include <fstream>
 
 using namespace polyfem::utils;
@@ -32,6 +35,7 @@ namespace polyfem
 				if (elements[i].is_valid())
 					refine_mask[i] = true;
 
+			reserve_refinement(std::count(refine_mask.begin(), refine_mask.end(), true));
 			for (int i = 0; i < refine_mask.size(); i++)
 				if (refine_mask[i])
 					refine_element(i);
@@ -49,7 +53,7 @@ namespace polyfem
 			return false;
 		}
 
-		bool NCMesh3D::build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+		bool NCMesh3D::build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F)
 		{
 			n_elements = 0;
 			elements.clear();
@@ -650,10 +654,23 @@ namespace polyfem
 			for (int i = 0; i < ids.size(); i++)
 				full_ids[i] = valid_to_all_elem(ids[i]);
 
+			reserve_refinement(full_ids.size());
 			for (int i : full_ids)
 				refine_element(i);
 		}
 
+		void NCMesh3D::reserve_refinement(const int n_refined)
+		{
+			// a refined tet adds at most 6 vertices, 8 elements, 24 faces, and 25 edges
+			vertices.reserve(vertices.size() + 6 * n_refined);
+			elements.reserve(elements.size() + 8 * n_refined);
+			faces.reserve(faces.size() + 24 * n_refined);
+			edges.reserve(edges.size() + 25 * n_refined);
+			midpointMap.reserve(midpointMap.size() + 6 * n_refined);
+			faceMap.reserve(faceMap.size() + 24 * n_refined);
+			edgeMap.reserve(edgeMap.size() + 25 * n_refined);
+		}
+
 		void NCMesh3D::coarsen_element(int id_full)
 		{
 			const int parent_id = elements[id_full].parent;
@@ -971,14 +988,18 @@ namespace polyfem
 				edge.weights.setConstant(-1);
 			}
 
+			// the traversals only read the refinement tree, the chains are then linked in order
+			std::vector<std::vector<follower_edge>> all_followers(edges.size());
+			utils::maybe_parallel_for(edges.size(), [&](int start, int end, int thread_id) {
+				for (int e_id = start; e_id < end; e_id++)
+					if (edges[e_id].n_elem() > 0)
+						traverse_edge(edges[e_id].vertices, 0, 1, 0, all_followers[e_id]);
+			});
+
 			for (int e_id = 0; e_id < edges.size(); e_id++)
 			{
 				auto &edge = edges[e_id];
-				if (edge.n_elem() == 0)
-					continue;
-				std::vector<follower_edge> followers;
-				traverse_edge(edge.vertices, 0, 1, 0, followers);
-				for (auto &s : followers)
+				for (auto &s : all_followers[e_id])
 				{
 					if (edges[s.id].leader >= 0 && std::abs(edges[s.id].weights(1) - edges[s.id].weights(0)) < std::abs(s.p2 - s.p1))
 						continue;
@@ -1050,20 +1071,26 @@ namespace polyfem
 				edge.leader_face = -1;
 			}
 
+			std::vector<std::vector<follower_face>> all_followers(faces.size());
+			std::vector<std::vector<int>> all_interior_edges(faces.size());
+			utils::maybe_parallel_for(faces.size(), [&](int start, int end, int thread_id) {
+				for (int f_id = start; f_id < end; f_id++)
+				{
+					const auto &face = faces[f_id];
+					if (face.n_elem() > 0)
+						traverse_face(face.vertices(0), face.vertices(1), face.vertices(2), Eigen::Vector2d(0, 0), Eigen::Vector2d(1, 0), Eigen::Vector2d(0, 1), 0, all_followers[f_id], all_interior_edges[f_id]); // order is important
+				}
+			});
+
 			for (int f_id = 0; f_id < faces.size(); f_id++)
 			{
 				auto &face = faces[f_id];
-				if (face.n_elem() == 0)
-					continue;
-				std::vector<follower_face> followers;
-				std::vector<int> interior_edges;
-				traverse_face(face.vertices(0), face.vertices(1), face.vertices(2), Eigen::Vector2d(0, 0), Eigen::Vector2d(1, 0), Eigen::Vector2d(0, 1), 0, followers, interior_edges); // order is important
-				for (auto &s : followers)
+				for (auto &s : all_followers[f_id])
 				{
 					faces[s.id].leader = f_id;
 					face.followers.push_back(s.id);
 				}
-				for (int s : interior_edges)
+				for (int s : all_interior_edges[f_id])
 					if (s >= 0 && edges[s].leader < 0 && edges[s].n_elem() > 0)
 						edges[s].leader_face = f_id;
 			}
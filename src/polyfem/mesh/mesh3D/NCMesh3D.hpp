@@ -237,7 +237,7 @@ namespace polyfem
 				return false;
 			}
 
-			bool build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F) override;
+			bool build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F) override;
 
 			void attach_higher_order_nodes(const Eigen::MatrixXd &V, const std::vector<std::vector<int>> &nodes) override;
 
@@ -336,6 +336,8 @@ namespace polyfem
 
 			void refine_element(int id_full);
 			void refine_elements(const std::vector<int> &ids);
+			/// reserve the storage of the refinement of n_refined elements
+			void reserve_refinement(const int n_refined);
 
 			void coarsen_element(int id_full);
 
@@ -68,6 +68,65 @@ namespace polyfem::mesh
 		x(free_nodes, Eigen::all) += sol;
 	}
 
+	void reduced_L2_projection(
+		const Eigen::SparseMatrix<double> &M,
+		const Eigen::SparseMatrix<double> &A,
+		const Eigen::Ref<const Eigen::MatrixXd> &y,
+		const std::vector<int> &boundary_nodes,
+		Eigen::Ref<Eigen::MatrixXd> x)
+	{
+		assert(std::is_sorted(boundary_nodes.begin(), boundary_nodes.end()));
+
+		// full to reduced row, -1 for the boundary nodes
+		std::vector<int> reduced(M.rows(), -1);
+		std::vector<int> free_nodes;
+		for (int i = 0, j = 0; i < M.rows(); ++i)
+		{
+			if (j < boundary_nodes.size() && boundary_nodes[j] == i)
+				++j;
+			else
+			{
+				reduced[i] = free_nodes.size();
+				free_nodes.push_back(i);
+			}
+		}
+
+		if (free_nodes.empty())
+			return;
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int k = 0; k < M.outerSize(); ++k)
+		{
+			for (Eigen::SparseMatrix<double>::InnerIterator it(M, k); it; ++it)
+			{
+				if (reduced[it.row()] >= 0 && reduced[it.col()] >= 0)
+					entries.emplace_back(reduced[it.row()], reduced[it.col()], it.value());
+			}
+		}
+		Eigen::SparseMatrix<double> H(free_nodes.size(), free_nodes.size());
+		H.setFromTriplets(entries.begin(), entries.end());
+
+		std::unique_ptr<polysolve::linear::Solver> solver;
+#ifdef POLYSOLVE_WITH_MKL
+		solver = polysolve::linear::Solver::create("Eigen::PardisoLDLT", "");
+#elif defined(POLYSOLVE_WITH_CHOLMOD)
+		solver = polysolve::linear::Solver::create("Eigen::CholmodSimplicialLDLT", "");
+#else
+		solver = polysolve::linear::Solver::create("Eigen::SimplicialLDLT", "");
+#endif
+		solver->analyze_pattern(H, 0);
+		solver->factorize(H);
+
+		// the patches are decoupled once the boundary nodes are removed, a single factorization solves them all
+		const Eigen::MatrixXd g = -((M * x - A * y)(free_nodes, Eigen::all));
+		Eigen::VectorXd sol(free_nodes.size());
+		for (int i = 0; i < g.cols(); ++i)
+		{
+			solver->solve(g.col(i), sol);
+			x(free_nodes, i) += sol;
+		}
+	}
+
 	Eigen::VectorXd constrained_L2_projection(
 		// Nonlinear solver
 		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver,
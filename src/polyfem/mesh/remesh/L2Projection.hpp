@@ -20,6 +20,15 @@ namespace polyfem::mesh
 		const std::vector<int> &boundary_nodes,
 		Eigen::Ref<Eigen::MatrixXd> x);
 
+	/// @brief Sparse version of reduced_L2_projection, x is only updated at the rows not in boundary_nodes
+	/// @note boundary_nodes must be sorted
+	void reduced_L2_projection(
+		const Eigen::SparseMatrix<double> &M,
+		const Eigen::SparseMatrix<double> &A,
+		const Eigen::Ref<const Eigen::MatrixXd> &y,
+		const std::vector<int> &boundary_nodes,
+		Eigen::Ref<Eigen::MatrixXd> x);
+
 	Eigen::VectorXd constrained_L2_projection(
 		// Nonlinear solver
 		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver,
@@ -254,6 +254,78 @@ namespace polyfem::mesh
 			return true;
 		}
 
+		/// sets the remeshing parameters of opt on a MMG3D mesh
+		/// @param[in] has_metric if true hmin/hmax bound the given metric, otherwise hsiz (if not zero) gives a constant size
+		void set_mmg3d_options(MMG5_pMesh mesh, MMG5_pSol met, const MmgOptions &opt, const bool has_metric)
+		{
+			MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_angleDetection, opt.angle_value);
+			if (opt.hsiz == 0. || has_metric)
+			{
+				MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hmin, opt.hmin);
+				MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hmax, opt.hmax);
+			}
+			else
+			{
+				MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hsiz, opt.hsiz);
+			}
+			MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hausd, opt.hausd);
+			MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hgrad, opt.hgrad);
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_angle, int(opt.angle_detection));
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_noswap, int(opt.noswap));
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_noinsert, int(opt.noinsert));
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_nomove, int(opt.nomove));
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_nosurf, int(opt.nosurf));
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_opnbdy, int(opt.opnbdy));
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_optim, int(opt.optim));
+			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_optimLES, int(opt.optimLES));
+		}
+
+		/// fills the MMG3D arrays directly from the vertex and tet matrices, without going through a GEO::Mesh
+		bool eigen_to_mmg3d(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, MMG5_pMesh &mmg, MMG5_pSol &sol)
+		{
+			assert(V.cols() == 3);
+			assert(T.cols() == 4);
+
+			if (mmg == nullptr)
+				MMG3D_Init_mesh(MMG5_ARG_start, MMG5_ARG_ppMesh, &mmg, MMG5_ARG_ppMet, &sol, MMG5_ARG_end);
+
+			if (MMG3D_Set_meshSize(mmg, V.rows(), T.rows(), 0, 0, 0, 0) != 1)
+			{
+				logger().error("failed to MMG3D_Set_meshSize");
+				return false;
+			}
+
+			for (int v = 0; v < V.rows(); ++v)
+			{
+				for (int d = 0; d < 3; ++d)
+					mmg->point[v + 1].c[d] = V(v, d);
+			}
+			for (int c = 0; c < T.rows(); ++c)
+			{
+				for (int lv = 0; lv < 4; ++lv)
+					mmg->tetra[c + 1].v[lv] = T(c, lv) + 1;
+			}
+
+			MMG3D_Set_handGivenMesh(mmg); /* because we don't use the API functions */
+			return true;
+		}
+
+		/// reads the MMG3D arrays directly into the output matrices, without going through a GEO::Mesh
+		void mmg3d_to_eigen(const MMG5_pMesh mmg, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &T)
+		{
+			V.resize(mmg->np, 3);
+			for (int v = 0; v < mmg->np; ++v)
+				V.row(v) << mmg->point[v + 1].c[0], mmg->point[v + 1].c[1], mmg->point[v + 1].c[2];
+
+			F.resize(mmg->nt, 3);
+			for (int t = 0; t < mmg->nt; ++t)
+				F.row(t) << mmg->tria[t + 1].v[0] - 1, mmg->tria[t + 1].v[1] - 1, mmg->tria[t + 1].v[2] - 1;
+
+			T.resize(mmg->ne, 4);
+			for (int c = 0; c < mmg->ne; ++c)
+				T.row(c) << mmg->tetra[c + 1].v[0] - 1, mmg->tetra[c + 1].v[1] - 1, mmg->tetra[c + 1].v[2] - 1, mmg->tetra[c + 1].v[3] - 1;
+		}
+
 		void mmg2d_free(MMG5_pMesh mmg, MMG5_pSol sol)
 		{
 			MMG2D_Free_all(MMG5_ARG_start,
@@ -422,31 +494,15 @@ namespace polyfem::mesh
 			}
 
 			/* Set remeshing options */
-			MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_angleDetection, opt.angle_value);
 			if (opt.enable_anisotropy)
 			{
 				MMG3D_Set_solSize(mesh, met, MMG5_Vertex, 0, MMG5_Tensor);
 			}
-			if (opt.hsiz == 0. || opt.metric_attribute != "no_metric")
-			{
-				MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hmin, opt.hmin);
-				MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hmax, opt.hmax);
-			}
-			else
+			if (!(opt.hsiz == 0. || opt.metric_attribute != "no_metric"))
 			{
 				met->np = 0;
-				MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hsiz, opt.hsiz);
 			}
-			MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hausd, opt.hausd);
-			MMG3D_Set_dparameter(mesh, met, MMG3D_DPARAM_hgrad, opt.hgrad);
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_angle, int(opt.angle_detection));
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_noswap, int(opt.noswap));
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_noinsert, int(opt.noinsert));
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_nomove, int(opt.nomove));
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_nosurf, int(opt.nosurf));
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_opnbdy, int(opt.opnbdy));
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_optim, int(opt.optim));
-			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_optimLES, int(opt.optimLES));
+			set_mmg3d_options(mesh, met, opt, opt.metric_attribute != "no_metric");
 			if (opt.metric_attribute != "no_metric")
 			{
 				if (!M.vertices.attributes().is_defined(opt.metric_attribute))
@@ -617,23 +673,130 @@ namespace polyfem::mesh
 	{
 		assert(V.cols() == 3);
 		assert(V.rows() == S.size());
-		GEO::Mesh M, M_out;
-		to_geogram_mesh(V, Eigen::MatrixXi(0, 3), T, M);
 
-		// Remeshing options
-		opt.metric_attribute = "scalar";
+		MmgRemesher3D remesher(opt);
+		if (!remesher.set_mesh(V, T) || !remesher.set_metric(S) || !remesher.remesh())
+			return;
 
-		GEO::Attribute<double> scalar(M.vertices.attributes(), opt.metric_attribute);
-		for (int v = 0; v < M.vertices.nb(); ++v)
+		remesher.get_mesh(OV, OF, OT);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+
+	struct MmgRemesher3D::Data
+	{
+		MMG5_pMesh mesh = nullptr;
+		MMG5_pSol met = nullptr;
+	};
+
+	MmgRemesher3D::MmgRemesher3D(const MmgOptions &opt)
+		: opt_(opt), data_(std::make_unique<Data>())
+	{
+	}
+
+	MmgRemesher3D::~MmgRemesher3D()
+	{
+		if (data_->mesh != nullptr)
+			mmg3d_free(data_->mesh, data_->met);
+	}
+
+	bool MmgRemesher3D::set_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T)
+	{
+		if (data_->mesh != nullptr)
 		{
-			scalar[v] = S(v);
+			mmg3d_free(data_->mesh, data_->met);
+			data_->mesh = nullptr;
+			data_->met = nullptr;
 		}
 
-		// Remesh volume
-		mmg3d_tet_remesh(M, M_out, opt);
+		has_metric_ = false;
+		return eigen_to_mmg3d(V, T, data_->mesh, data_->met);
+	}
 
-		// Convert output
-		from_geogram_mesh(M_out, OV, OF, OT);
+	bool MmgRemesher3D::set_metric(const Eigen::MatrixXd &S)
+	{
+		assert(data_->mesh != nullptr);
+		assert(S.rows() == data_->mesh->np);
+		assert(S.cols() == 1 || S.cols() == 6);
+
+		const int type = S.cols() == 1 ? MMG5_Scalar : MMG5_Tensor;
+		if (MMG3D_Set_solSize(data_->mesh, data_->met, MMG5_Vertex, S.rows(), type) != 1)
+		{
+			logger().error("failed to MMG3D_Set_solSize");
+			return false;
+		}
+
+		// the entries of vertex v start at m[size * (v + 1)]
+		const int size = S.cols();
+		for (int v = 0; v < S.rows(); ++v)
+			for (int k = 0; k < size; ++k)
+				data_->met->m[size * (v + 1) + k] = S(v, k);
+
+		has_metric_ = true;
+		return true;
+	}
+
+	bool MmgRemesher3D::remesh()
+	{
+		assert(data_->mesh != nullptr);
+		MMG5_pMesh mesh = data_->mesh;
+		MMG5_pSol met = data_->met;
+
+		if (!has_metric_ && opt_.hsiz == 0.)
+		{
+			// same default as geo_to_mmg, hmin/hmax bound a unit size
+			if (!set_metric(Eigen::VectorXd::Ones(mesh->np)))
+				return false;
+			has_metric_ = false;
+		}
+		else if (!has_metric_)
+		{
+			met->np = 0;
+		}
+
+		if (MMG3D_Chk_meshData(mesh, met) != 1)
+		{
+			logger().error("error in mmg: inconsistent mesh and sol");
+			return false;
+		}
+
+		set_mmg3d_options(mesh, met, opt_, has_metric_);
+
+		if (MMG3D_mmg3dlib(mesh, met) != MMG5_SUCCESS)
+		{
+			logger().error("mmg3d_remesh: failed to remesh");
+			return false;
+		}
+
+		// MMG interpolates the metric on the new vertices, it is kept for the next remesh
+		has_metric_ = has_metric_ && met->np == mesh->np;
+		return true;
+	}
+
+	void MmgRemesher3D::get_mesh(Eigen::MatrixXd &OV, Eigen::MatrixXi &OF, Eigen::MatrixXi &OT) const
+	{
+		assert(data_->mesh != nullptr);
+		mmg3d_to_eigen(data_->mesh, OV, OF, OT);
+	}
+
+	void MmgRemesher3D::get_metric(Eigen::MatrixXd &S) const
+	{
+		if (!has_metric_)
+		{
+			S.resize(0, 0);
+			return;
+		}
+
+		const int size = data_->met->size;
+		S.resize(data_->met->np, size);
+		for (int v = 0; v < S.rows(); ++v)
+			for (int k = 0; k < size; ++k)
+				S(v, k) = data_->met->m[size * (v + 1) + k];
+	}
+
+	int MmgRemesher3D::n_vertices() const
+	{
+		return data_->mesh == nullptr ? 0 : data_->mesh->np;
 	}
 
 } // namespace polyfem::mesh
@@ -8,6 +8,9 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 #include <Eigen/Dense>
+
+#include <memory>
+#include <string>
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polyfem::mesh
@@ -66,6 +69,54 @@ namespace polyfem::mesh
 	void remesh_adaptive_3d(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::VectorXd &S,
 							Eigen::MatrixXd &OV, Eigen::MatrixXi &OF, Eigen::MatrixXi &OT, MmgOptions opt = MmgOptions());
 
+	///
+	/// Tet-mesh remesher keeping the mesh and the metric in MMG's native structures
+	/// between successive remeshes. The matrices are copied straight into the MMG
+	/// arrays (no intermediate GEO::Mesh) and the output of a remesh is the input
+	/// of the next one, so repeated (anisotropic) remeshing only converts on demand.
+	///
+	class MmgRemesher3D
+	{
+	public:
+		MmgRemesher3D(const MmgOptions &opt = MmgOptions());
+		~MmgRemesher3D();
+
+		MmgRemesher3D(const MmgRemesher3D &) = delete;
+		MmgRemesher3D &operator=(const MmgRemesher3D &) = delete;
+
+		/// @param[in]  V     { #V x 3 mesh vertices }
+		/// @param[in]  T     { #T x 4 mesh tetrahedra }
+		/// @return false if MMG failed to allocate the mesh
+		bool set_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T);
+
+		/// @param[in]  S     { #V x 1 per-vertex size or #V x 6 per-vertex symmetric metric (xx, xy, xz, yy, yz, zz) }
+		/// @return false if MMG failed to allocate the metric
+		bool set_metric(const Eigen::MatrixXd &S);
+
+		/// Remesh in place, the metric is interpolated by MMG on the new mesh
+		/// @return false if MMG failed
+		bool remesh();
+
+		/// @param[out] OV    { #OV x 3 mesh vertices }
+		/// @param[out] OF    { #OF x 3 boundary triangles }
+		/// @param[out] OT    { #OT x 4 mesh tetrahedra }
+		void get_mesh(Eigen::MatrixXd &OV, Eigen::MatrixXi &OF, Eigen::MatrixXi &OT) const;
+
+		/// @param[out] S     { #V x (1|6) current metric, empty if none was set }
+		void get_metric(Eigen::MatrixXd &S) const;
+
+		int n_vertices() const;
+
+		MmgOptions &options() { return opt_; }
+
+	private:
+		struct Data;
+
+		MmgOptions opt_;
+		std::unique_ptr<Data> data_;
+		bool has_metric_ = false;
+	};
+
 } // namespace polyfem::mesh
 
 #endif
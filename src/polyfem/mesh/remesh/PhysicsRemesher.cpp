@@ -2,6 +2,7 @@
 
 #include <polyfem/mesh/remesh/wild_remesh/LocalRelaxationData.hpp>
 #include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/solver/forms/ElasticForm.hpp>
 
 #include <paraviewo/VTUWriter.hpp>
 
@@ -35,7 +36,8 @@ namespace polyfem::mesh
 			});
 
 		LocalMesh<Super> local_mesh(*this, local_mesh_tuples, include_global_boundary);
-		LocalRelaxationData data(this->state, local_mesh, this->current_time, include_global_boundary);
+		const std::shared_ptr<LocalRelaxationResources> resources = relaxation_pool.acquire(this->state, local_mesh.body_ids());
+		LocalRelaxationData data(this->state, local_mesh, this->current_time, include_global_boundary, *resources);
 		return data.solve_data.nl_problem->value(data.sol());
 	}
 
@@ -86,6 +88,27 @@ namespace polyfem::mesh
 		return new_ops;
 	}
 
+	template <class WMTKMesh>
+	size_t PhysicsRemesher<WMTKMesh>::element_energy_hash(const Tuple &t) const
+	{
+		const auto hash_combine = [](size_t &h, const size_t v) {
+			h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+		};
+
+		size_t h = 0;
+		for (const size_t vid : this->element_vids(t))
+		{
+			hash_combine(h, vid);
+			const auto &attrs = this->vertex_attrs[vid];
+			for (int d = 0; d < attrs.rest_position.size(); ++d)
+			{
+				hash_combine(h, std::hash<double>()(attrs.rest_position[d]));
+				hash_combine(h, std::hash<double>()(attrs.position[d]));
+			}
+		}
+		return h == 0 ? 1 : h; // 0 marks an empty cache entry
+	}
+
 	template <class WMTKMesh>
 	double PhysicsRemesher<WMTKMesh>::edge_elastic_energy(const Tuple &e) const
 	{
@@ -95,13 +118,48 @@ namespace polyfem::mesh
 		const std::vector<Tuple> elements = this->get_incident_elements_for_edge(e);
 
 		double volume = 0;
-		for (const auto &t : elements)
-			volume += this->element_volume(t);
+		std::vector<size_t> hashes(elements.size());
+		for (int i = 0; i < elements.size(); ++i)
+		{
+			volume += this->element_volume(elements[i]);
+			hashes[i] = element_energy_hash(elements[i]);
+		}
 		assert(volume > 0);
 
+		double energy = 0;
+		bool cached = true;
+		{
+			std::lock_guard<std::mutex> lock(energy_cache_mutex);
+			for (int i = 0; i < elements.size() && cached; ++i)
+			{
+				const auto &attrs = this->element_attrs[this->element_id(elements[i])];
+				cached = attrs.elastic_energy_hash == hashes[i];
+				energy += attrs.elastic_energy;
+			}
+		}
+		if (cached)
+			return energy / volume; // average energy
+
 		LocalMesh<Super> local_mesh(*this, elements, false);
-		LocalRelaxationData data(this->state, local_mesh, this->current_time, false);
-		return data.solve_data.nl_problem->value(data.sol()) / volume; // average energy
+		const std::shared_ptr<LocalRelaxationResources> resources = relaxation_pool.acquire(this->state, local_mesh.body_ids());
+		LocalRelaxationData data(this->state, local_mesh, this->current_time, false, *resources);
+
+		// the local elements are in the order of the tuples
+		const Eigen::VectorXd element_energies = data.solve_data.elastic_form->value_per_element(data.sol());
+		assert(element_energies.size() == elements.size());
+
+		energy = element_energies.sum();
+		{
+			std::lock_guard<std::mutex> lock(energy_cache_mutex);
+			for (int i = 0; i < elements.size(); ++i)
+			{
+				const auto &attrs = this->element_attrs[this->element_id(elements[i])];
+				attrs.elastic_energy = element_energies[i];
+				attrs.elastic_energy_hash = hashes[i];
+			}
+		}
+
+		return energy / volume; // average energy
 	}
 
 	template <class WMTKMesh>
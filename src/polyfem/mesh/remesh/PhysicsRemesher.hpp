@@ -4,6 +4,7 @@
 #include <polyfem/mesh/remesh/WildRemesher.hpp>
 #include <polyfem/mesh/remesh/wild_remesh/OperationCache.hpp>
 #include <polyfem/mesh/remesh/wild_remesh/LocalMesh.hpp>
+#include <polyfem/mesh/remesh/wild_remesh/LocalRelaxationData.hpp>
 
 namespace polyfem::mesh
 {
@@ -105,11 +106,21 @@ namespace polyfem::mesh
 		double local_energy_before() const { return this->op_cache->local_energy; }
 
 		/// @brief Compute the average elastic energy of the faces containing an edge.
+		/// @note The element energies are cached and only recomputed for the elements whose vertices changed.
 		double edge_elastic_energy(const Tuple &e) const;
 
+		/// @brief Hash of the vertex ids and positions of an element, identifies the state of its cached energy.
+		size_t element_energy_hash(const Tuple &t) const;
+
 		/// @brief Write a visualization mesh of the priority queue
 		/// @param e current edge tuple to be split
 		void write_priority_queue_mesh(const std::string &path, const Tuple &e) const;
+
+		/// assemblers and solvers reused by the local relaxations
+		mutable LocalRelaxationPool relaxation_pool;
+
+		/// guards the cached element energies, edge_elastic_energy is evaluated in parallel
+		mutable std::mutex energy_cache_mutex;
 	};
 
 	class PhysicsTriRemesher : public PhysicsRemesher<wmtk::TriMesh>
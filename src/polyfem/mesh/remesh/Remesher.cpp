@@ -16,8 +16,69 @@
 #include <igl/boundary_facets.h>
 #include <igl/edges.h>
 
+#include <set>
+
 namespace polyfem::mesh
 {
+	namespace
+	{
+		/// sorted coordinates of the vertices of an element, identifies an element across remeshing
+		std::vector<double> element_key(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const int e)
+		{
+			std::vector<std::vector<double>> corners;
+			for (int j = 0; j < F.cols(); ++j)
+			{
+				std::vector<double> corner(V.cols());
+				for (int d = 0; d < V.cols(); ++d)
+					corner[d] = V(F(e, j), d);
+				corners.push_back(std::move(corner));
+			}
+			std::sort(corners.begin(), corners.end());
+
+			std::vector<double> key;
+			for (const auto &c : corners)
+				key.insert(key.end(), c.begin(), c.end());
+			return key;
+		}
+
+		/// @brief Vertices of the elements of the new mesh that are not in the old one, grown by n_ring rings of elements
+		std::vector<bool> remeshed_vertices(
+			const Eigen::MatrixXd &old_V, const Eigen::MatrixXi &old_F,
+			const Eigen::MatrixXd &new_V, const Eigen::MatrixXi &new_F,
+			const int n_ring)
+		{
+			std::set<std::vector<double>> old_elements;
+			for (int e = 0; e < old_F.rows(); ++e)
+				old_elements.insert(element_key(old_V, old_F, e));
+
+			std::vector<bool> is_remeshed(new_V.rows(), false);
+			for (int e = 0; e < new_F.rows(); ++e)
+			{
+				if (old_elements.count(element_key(new_V, new_F, e)))
+					continue;
+				for (int j = 0; j < new_F.cols(); ++j)
+					is_remeshed[new_F(e, j)] = true;
+			}
+
+			for (int r = 0; r < n_ring; ++r)
+			{
+				std::vector<bool> grown = is_remeshed;
+				for (int e = 0; e < new_F.rows(); ++e)
+				{
+					bool touches = false;
+					for (int j = 0; j < new_F.cols(); ++j)
+						touches |= is_remeshed[new_F(e, j)];
+					if (touches)
+						for (int j = 0; j < new_F.cols(); ++j)
+							grown[new_F(e, j)] = true;
+				}
+				is_remeshed = std::move(grown);
+			}
+
+			return is_remeshed;
+		}
+	} // namespace
+
 	Remesher::Remesher(const State &state,
 					   const Eigen::MatrixXd &obstacle_displacements,
 					   const Eigen::MatrixXd &obstacle_quantities,
@@ -196,7 +257,38 @@ namespace polyfem::mesh
 		const int n_constrained_quantaties = n_quantities() / 3;
 		const int n_unconstrained_quantaties = n_quantities() - n_constrained_quantaties;
 
-		const std::vector<int> boundary_nodes = this->boundary_nodes(to_vertex_to_basis);
+		std::vector<int> boundary_nodes = this->boundary_nodes(to_vertex_to_basis);
+
+		// Only project on the remeshed patches and a halo around them, the remaining vertices keep their values
+		const bool local_projection = args["projection"]["local"];
+		std::vector<int> fixed_nodes;
+		if (local_projection)
+		{
+			const int n_mesh_vertices = n_to_basis - obstacle().n_vertices();
+			const std::vector<bool> is_remeshed = remeshed_vertices(
+				global_projection_cache.rest_positions, global_projection_cache.elements,
+				rest_positions.topRows(n_mesh_vertices), elements, args["projection"]["n_ring_halo"]);
+
+			for (int i = 0; i < n_mesh_vertices; ++i)
+				if (!is_remeshed[i])
+					for (int d = 0; d < dim(); ++d)
+						fixed_nodes.push_back(i * dim() + d);
+
+			// the constrained projection handles the obstacle dofs itself
+			std::vector<int> merged;
+			std::set_union(
+				boundary_nodes.begin(), boundary_nodes.end(),
+				fixed_nodes.begin(), fixed_nodes.end(), std::back_inserter(merged));
+			boundary_nodes = std::move(merged);
+
+			for (int i = dim() * n_mesh_vertices; i < to_projection_quantities.rows(); ++i)
+				fixed_nodes.push_back(i);
+
+			logger().debug(
+				"Local L2 projection of {}/{} dofs",
+				to_projection_quantities.rows() - fixed_nodes.size(), to_projection_quantities.rows());
+		}
+
 		for (int i = 0; i < n_constrained_quantaties; ++i)
 		{
 			projected_quantities.col(i) = constrained_L2_projection(
@@ -220,6 +312,19 @@ namespace polyfem::mesh
 				to_projection_quantities.col(i));
 		}
 
+		if (local_projection)
+		{
+			projected_quantities.rightCols(n_unconstrained_quantaties) = to_projection_quantities.rightCols(n_unconstrained_quantaties);
+			reduced_L2_projection(
+				M, A, from_projection_quantities.rightCols(n_unconstrained_quantaties),
+				fixed_nodes, projected_quantities.rightCols(n_unconstrained_quantaties));
+
+			assert(projected_quantities.rows() == dim() * n_to_basis);
+			set_projection_quantities(unreorder_matrix(
+				projected_quantities, to_vertex_to_basis, to_vertex_to_basis.size(), dim()));
+			return;
+		}
+
 		// Set entry for obstacle to identity
 		// ┌     ┐ ┌     ┐   ┌     ┐
 		// │M   0│ │x_fem│   |y_fem|
@@ -411,6 +516,12 @@ namespace polyfem::mesh
 		a_prevs = quantities.rightCols(n_steps);
 	}
 
+	void Remesher::add_timing(const std::string &name, const double time)
+	{
+		std::lock_guard<std::mutex> lock(timings_mutex);
+		timings[name] += time;
+	}
+
 	void Remesher::log_timings()
 	{
 		if (!logger().should_log(spdlog::level::debug) || timings.empty())
@@ -440,8 +551,55 @@ namespace polyfem::mesh
 
 	// Static members must be initialized in the source file:
 	decltype(Remesher::timings) Remesher::timings;
+	json Remesher::statistics()
+	{
+		json stats;
+		stats["total_time"] = total_time;
+		stats["num_solves"] = num_solves;
+		stats["total_ndofs"] = total_ndofs;
+		stats["avg_ndofs_per_solve"] = num_solves > 0 ? (total_ndofs / double(num_solves)) : 0.0;
+
+		stats["timings"] = json::object();
+		{
+			std::lock_guard<std::mutex> lock(timings_mutex);
+			for (const auto &[name, time] : timings)
+			{
+				stats["timings"][name] = {
+					{"time", time.time},
+					{"count", time.count},
+					{"time_per_call", time.count > 0 ? (time.time / time.count) : 0.0},
+				};
+			}
+		}
+
+		stats["operations"] = json::object();
+		for (const auto &[name, counts] : operation_counts)
+		{
+			stats["operations"][name] = {
+				{"success", counts.success},
+				{"fail", counts.fail},
+			};
+		}
+
+		return stats;
+	}
+
+	void Remesher::reset_statistics()
+	{
+		{
+			std::lock_guard<std::mutex> lock(timings_mutex);
+			timings.clear();
+		}
+		total_time = 0;
+		num_solves = 0;
+		total_ndofs = 0;
+		operation_counts.clear();
+	}
+
+	std::mutex Remesher::timings_mutex;
 	double Remesher::total_time = 0;
 	size_t Remesher::num_solves = 0;
 	size_t Remesher::total_ndofs = 0;
+	std::unordered_map<std::string, Remesher::OperationCounts> Remesher::operation_counts;
 
 } // namespace polyfem::mesh
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <polyfem/utils/Types.hpp>
 #include <polyfem/utils/Timer.hpp>
 
+#include <mutex>
 #include <unordered_map>
 #include <variant>
 
@@ -12,7 +13,7 @@ namespace polyfem::time_integrator
 	class ImplicitTimeIntegrator;
 } // namespace polyfem::time_integrator
 
-#define POLYFEM_REMESHER_SCOPED_TIMER(name) polyfem::utils::Timer __polyfem_timer(Remesher::timings[name])
+#define POLYFEM_REMESHER_SCOPED_TIMER(name) polyfem::mesh::RemesherTimer __polyfem_timer(name)
 
 namespace polyfem::mesh
 {
@@ -225,11 +226,50 @@ namespace polyfem::mesh
 	public:
 		static void log_timings();
 
+		/// @brief Timings, solver statistics, and operation counts as json.
+		static json statistics();
+		/// @brief Reset all the statistics, e.g., between two benchmark runs.
+		static void reset_statistics();
+
+		/// @brief Add a time to one of the timings, safe to call from several threads.
+		static void add_timing(const std::string &name, const double time);
+
 		/// @brief Timings for the remeshing operations.
 		static std::unordered_map<std::string, utils::Timing> timings;
+		static std::mutex timings_mutex;
 		static double total_time;  // = 0;
 		static size_t num_solves;  // = 0;
 		static size_t total_ndofs; // = 0;
+
+		/// @brief Number of accepted and rejected attempts of an operation.
+		struct OperationCounts
+		{
+			size_t success = 0;
+			size_t fail = 0;
+		};
+		/// @brief Counts of the remeshing operations (split, collapse, swap, smooth) since the start of the run.
+		static std::unordered_map<std::string, OperationCounts> operation_counts;
+	};
+
+	/// @brief Scoped timer adding its time to Remesher::timings, usable in parallel loops.
+	class RemesherTimer
+	{
+	public:
+		RemesherTimer(const std::string &name)
+			: m_name(name)
+		{
+			m_timer.start();
+		}
+
+		~RemesherTimer()
+		{
+			m_timer.stop();
+			Remesher::add_timing(m_name, m_timer.getElapsedTimeInSec());
+		}
+
+	private:
+		std::string m_name;
+		igl::Timer m_timer;
 	};
 
 } // namespace polyfem::mesh
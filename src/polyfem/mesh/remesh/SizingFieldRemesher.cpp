@@ -1,11 +1,15 @@
 #include "SizingFieldRemesher.hpp"
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 #include <ipc/collision_mesh.hpp>
 #include <ipc/candidates/candidates.hpp>
 #include <ipc/broad_phase/hash_grid.hpp>
 
 #include <Eigen/Dense>
 
+#include <numeric>
+
 namespace polyfem::mesh
 {
 	// Edge splitting
@@ -69,29 +73,59 @@ namespace polyfem::mesh
 		return true;
 	}
 
+	template <class WMTKMesh>
+	bool SizingFieldRemesher<WMTKMesh>::collapse_edge_before(const Tuple &t)
+	{
+		if (!Super::collapse_edge_before(t))
+			return false;
+
+		// the new vertex keeps the largest contact metric of the collapsed edge
+		has_collapse_contact_sizing = false;
+		const std::array<size_t, 2> vids = {{t.vid(*this), t.switch_vertex(*this).vid(*this)}};
+		for (const size_t vid : vids)
+		{
+			const auto it = contact_sizing.find(vid);
+			if (it == contact_sizing.end())
+				continue;
+			if (!has_collapse_contact_sizing || it->second.norm() > collapse_contact_sizing.norm())
+				collapse_contact_sizing = it->second;
+			has_collapse_contact_sizing = true;
+		}
+
+		return true;
+	}
+
 	template <class WMTKMesh>
 	bool SizingFieldRemesher<WMTKMesh>::collapse_edge_after(const Tuple &t)
 	{
 		if (!Super::collapse_edge_after(t))
 			return false;
 
+		const size_t vid = t.vid(*this);
+		if (has_collapse_contact_sizing)
+			contact_sizing[vid] = collapse_contact_sizing;
+
+		// only the edges around the new vertex changed, their sizing is evaluated locally
+		const auto reject = [&]() {
+			contact_sizing.erase(vid);
+			return false;
+		};
+
 		if constexpr (Super::DIM == 2)
 		{
-			const std::unordered_map<size_t, double> edge_sizings = this->compute_edge_sizings();
 			for (const Tuple &e : WMTKMesh::get_one_ring_edges_for_vertex(t))
-				if (edge_sizings.at(e.eid(*this)) > 0.8)
-					return false;
+				if (edge_sizing(e) > 0.8)
+					return reject();
 		}
 		else
 		{
-			const std::unordered_map<size_t, double> edge_sizings = this->compute_edge_sizings();
 			for (const Tuple &tet : WMTKMesh::get_one_ring_tets_for_vertex(t))
 			{
 				for (int i = 0; i < 6; ++i)
 				{
 					const Tuple e = WMTKMesh::tuple_from_edge(tet.tid(*this), i);
-					if (edge_sizings.at(e.eid(*this)) > 0.8)
-						return false;
+					if (edge_sizing(e) > 0.8)
+						return reject();
 				}
 			}
 		}
@@ -181,165 +215,176 @@ namespace polyfem::mesh
 	}
 
 	template <class WMTKMesh>
-	typename SizingFieldRemesher<WMTKMesh>::SparseSizingField
-	SizingFieldRemesher<WMTKMesh>::smooth_contact_sizing_field(
-		const SparseSizingField &sizing_field) const
+	typename SizingFieldRemesher<WMTKMesh>::MatrixNd
+	SizingFieldRemesher<WMTKMesh>::deformation_gradient(const Tuple &t) const
 	{
-		SparseSizingField smoothed_sizing_field;
-		for (const Tuple &f : this->boundary_facets())
+		const auto vids = this->element_vids(t);
+		MatrixNd Dm, Ds;
+		for (int i = 0; i < Super::DIM; ++i)
 		{
-			const auto vids = this->facet_vids(f);
-			MatrixNd M = MatrixNd::Zero();
-			for (const size_t vid : vids)
-				if (sizing_field.find(vid) != sizing_field.end())
-					M += sizing_field.at(vid);
-			M /= vids.size(); // average
-
-			std::vector<Tuple> edges;
-			if constexpr (Super::DIM == 2)
-				edges.push_back(f);
-			else
-				edges = {{f, f.switch_edge(*this), f.switch_vertex(*this).switch_edge(*this)}};
-
-			for (const Tuple &e : edges)
-			{
-				if (sizing_field.find(e.eid(*this)) == sizing_field.end())
-					smoothed_sizing_field[e.eid(*this)] = MatrixNd::Zero();
-				smoothed_sizing_field[e.eid(*this)] += M / edges.size();
-			}
+			Dm.col(i) = vertex_attrs[vids[i + 1]].rest_position - vertex_attrs[vids[0]].rest_position;
+			Ds.col(i) = vertex_attrs[vids[i + 1]].position - vertex_attrs[vids[0]].position;
 		}
-
-		return smoothed_sizing_field;
+		return Ds * Dm.inverse();
 	}
 
 	template <class WMTKMesh>
-	std::unordered_map<size_t, double>
-	SizingFieldRemesher<WMTKMesh>::compute_edge_sizings() const
+	typename SizingFieldRemesher<WMTKMesh>::MatrixNd
+	SizingFieldRemesher<WMTKMesh>::recovered_displacement_gradient(const Tuple &v) const
 	{
-		const SparseSizingField sizing_field =
-			combine_sizing_fields(
-				compute_elasticity_sizing_field(),
-				smooth_contact_sizing_field(compute_contact_sizing_field()));
-
-		std::unordered_map<size_t, double> edge_sizings;
-		for (const Tuple &e : WMTKMesh::get_edges())
+		MatrixNd G = MatrixNd::Zero();
+		double total_volume = 0;
+		for (const Tuple &t : this->get_one_ring_elements_for_vertex(v))
 		{
-			const std::array<size_t, 2> vids =
-				{{e.vid(*this), e.switch_vertex(*this).vid(*this)}};
-
-			const VectorNd xi_bar = vertex_attrs[vids[0]].rest_position;
-			const VectorNd xj_bar = vertex_attrs[vids[1]].rest_position;
-
-			const VectorNd xij_bar = xj_bar - xi_bar;
+			const double volume = this->element_volume(t);
+			G += volume * (deformation_gradient(t) - MatrixNd::Identity());
+			total_volume += volume;
+		}
+		return total_volume > 0 ? MatrixNd(G / total_volume) : G;
+	}
 
-			const MatrixNd M = sizing_field.at(e.eid(*this));
+	template <class WMTKMesh>
+	double SizingFieldRemesher<WMTKMesh>::element_error_indicator(
+		const Tuple &t, const std::vector<MatrixNd> &vertex_gradients) const
+	{
+		const MatrixNd G = deformation_gradient(t) - MatrixNd::Identity();
 
-			edge_sizings[e.eid(*this)] = sqrt(xij_bar.transpose() * M * xij_bar);
+		// vertex quadrature of the distance between the (linear) recovered gradient and the (constant) element one
+		double error = 0;
+		for (const Tuple &v : this->element_vertices(t))
+		{
+			const MatrixNd Gv = vertex_gradients.empty() ? recovered_displacement_gradient(v) : vertex_gradients[v.vid(*this)];
+			error += (Gv - G).squaredNorm();
 		}
-		return edge_sizings;
+		return std::sqrt(this->element_volume(t) * error / Super::VERTICES_PER_ELEMENT);
 	}
 
 	template <class WMTKMesh>
-	typename SizingFieldRemesher<WMTKMesh>::SparseSizingField
-	SizingFieldRemesher<WMTKMesh>::compute_elasticity_sizing_field() const
+	typename SizingFieldRemesher<WMTKMesh>::MatrixNd
+	SizingFieldRemesher<WMTKMesh>::element_metric(const Tuple &t, const double error) const
 	{
-		std::unordered_map<size_t, MatrixNd> Fs, Fs_inv;
-		for (const Tuple &t : this->get_elements())
+		const MatrixNd F = deformation_gradient(t);
+		MatrixNd M = F.transpose() * F / std::pow(state.starting_max_edge_length, 2);
+
+		if (use_error_indicator() && target_error > 0)
 		{
+			double h = 0;
 			const auto vids = this->element_vids(t);
-			MatrixNd Dm, Ds;
-			if constexpr (std::is_same_v<WMTKMesh, wmtk::TriMesh>)
-			{
-				Dm.col(0) = vertex_attrs[vids[1]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Dm.col(1) = vertex_attrs[vids[2]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Ds.col(0) = vertex_attrs[vids[1]].position - vertex_attrs[vids[0]].position;
-				Ds.col(1) = vertex_attrs[vids[2]].position - vertex_attrs[vids[0]].position;
-			}
-			else
-			{
-				Dm.col(0) = vertex_attrs[vids[1]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Dm.col(1) = vertex_attrs[vids[2]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Dm.col(2) = vertex_attrs[vids[3]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Ds.col(0) = vertex_attrs[vids[1]].position - vertex_attrs[vids[0]].position;
-				Ds.col(1) = vertex_attrs[vids[2]].position - vertex_attrs[vids[0]].position;
-				Ds.col(2) = vertex_attrs[vids[3]].position - vertex_attrs[vids[0]].position;
-			}
-			Fs[this->element_id(t)] = Ds * Dm.inverse();
-			Fs_inv[this->element_id(t)] = Dm * Ds.inverse();
+			for (int i = 0; i < vids.size(); ++i)
+				for (int j = i + 1; j < vids.size(); ++j)
+					h = std::max(h, (vertex_attrs[vids[i]].rest_position - vertex_attrs[vids[j]].rest_position).norm());
+
+			// the indicator of a linear element scales as h^(1 + d/2), s is the refinement ratio equidistributing it
+			const double s = std::pow(error / target_error, 1 / (1 + Super::DIM / 2.0));
+			M = (M + MatrixNd::Identity() * (s * s / (h * h))) / 2;
 		}
 
-		const double k = 1.0;
+		return M;
+	}
+
+	template <class WMTKMesh>
+	typename SizingFieldRemesher<WMTKMesh>::MatrixNd
+	SizingFieldRemesher<WMTKMesh>::contact_edge_metric(const Tuple &e) const
+	{
+		const auto vertex_metric = [&](const size_t vid) -> MatrixNd {
+			const auto it = contact_sizing.find(vid);
+			return it == contact_sizing.end() ? MatrixNd::Zero() : it->second;
+		};
 
-		std::unordered_map<size_t, VectorNd> element_centers;
-		for (const Tuple &t : this->get_elements())
+		// average over the vertices of the incident boundary facets
+		MatrixNd M = MatrixNd::Zero();
+		if constexpr (Super::DIM == 2)
 		{
-			VectorNd center = VectorNd::Zero();
-			const auto &vids = this->element_vids(t);
-			for (const size_t &vid : vids)
-				center += vertex_attrs[vid].rest_position;
-			element_centers[this->element_id(t)] = center / vids.size();
+			for (const size_t vid : this->facet_vids(e))
+				M += vertex_metric(vid) / 2;
 		}
-
-		SparseSizingField element_sizing_field;
-		for (const Tuple &t : this->get_elements())
+		else
 		{
-			const size_t tid = this->element_id(t);
-
-			// std::unordered_set<size_t> adjacent_tids;
-			// for (const Tuple &v : this->element_vertices(t))
-			// 	for (const Tuple &adj_t : this->get_one_ring_elements_for_vertex(v))
-			// 		adjacent_tids.insert(this->element_id(adj_t));
-			// adjacent_tids.erase(tid);
-
-			// const VectorNd &t_center = element_centers.at(tid);
-
-			// MatrixNd M = MatrixNd::Zero();
-			// for (const size_t adj_tid : adjacent_tids)
-			// {
-			// 	const VectorNd dt = element_centers.at(adj_tid) - t_center;
-			// 	M += dt * (dt.transpose() / dt.squaredNorm())
-			// 		 * std::max((Fs[tid] * Fs_inv[adj_tid]).norm(),
-			// 					(Fs[adj_tid] * Fs_inv[tid]).norm())
-			// 		 / dt.norm();
-			// }
-			// M.array() *= k / adjacent_tids.size();
-
-			element_sizing_field[tid] = Fs[tid].transpose() * Fs[tid];
+			for (const Tuple &f : this->get_boundary_faces_for_edge(e))
+				for (const size_t vid : this->facet_vids(f))
+					M += vertex_metric(vid) / 9;
 		}
-		assert(!element_sizing_field.empty());
+		return M;
+	}
 
-		SparseSizingField sizing_field;
-		for (const Tuple &e : this->get_edges())
+	template <class WMTKMesh>
+	double SizingFieldRemesher<WMTKMesh>::edge_sizing(
+		const Tuple &e, const std::vector<MatrixNd> &element_metrics) const
+	{
+		const std::vector<Tuple> incident_elements = this->get_incident_elements_for_edge(e);
+
+		MatrixNd M = MatrixNd::Zero();
+		for (const Tuple &t : incident_elements)
 		{
-			const size_t eid = e.eid(*this);
-			const auto &incident_elements = this->get_incident_elements_for_edge(e);
-			for (const Tuple &t : incident_elements)
-			{
-				if (sizing_field.find(eid) == sizing_field.end())
-					sizing_field[eid] = MatrixNd::Zero();
-				sizing_field[eid] += element_sizing_field[this->element_id(t)];
-			}
-			sizing_field[eid] /= incident_elements.size() * std::pow(state.starting_max_edge_length, 2);
+			if (!element_metrics.empty())
+				M += element_metrics[this->element_id(t)];
+			else
+				M += element_metric(t, use_error_indicator() ? element_error_indicator(t) : 0.0);
 		}
+		M /= incident_elements.size();
 
-		return sizing_field;
+		if (this->is_boundary_edge(e))
+			M = (M + contact_edge_metric(e)) / 2;
+
+		const VectorNd xij_bar =
+			vertex_attrs[e.switch_vertex(*this).vid(*this)].rest_position - vertex_attrs[e.vid(*this)].rest_position;
+
+		return sqrt(xij_bar.transpose() * M * xij_bar);
 	}
 
 	template <class WMTKMesh>
-	typename SizingFieldRemesher<WMTKMesh>::SparseSizingField
-	SizingFieldRemesher<WMTKMesh>::combine_sizing_fields(
-		const SparseSizingField &field1,
-		const SparseSizingField &field2)
+	std::unordered_map<size_t, double>
+	SizingFieldRemesher<WMTKMesh>::compute_edge_sizings()
 	{
-		SparseSizingField field = field1;
-		for (const auto &[eid, M] : field2)
+		POLYFEM_REMESHER_SCOPED_TIMER("Compute edge sizings");
+
+		contact_sizing = compute_contact_sizing_field();
+
+		const std::vector<Tuple> elements = this->get_elements();
+		size_t element_capacity;
+		if constexpr (std::is_same_v<wmtk::TriMesh, WMTKMesh>)
+			element_capacity = WMTKMesh::tri_capacity();
+		else
+			element_capacity = WMTKMesh::tet_capacity();
+
+		// error indicators, the recovered gradients are shared by the elements around a vertex
+		std::vector<double> errors(elements.size(), 0.0);
+		if (use_error_indicator())
 		{
-			if (field.find(eid) == field.end())
-				field[eid] = M;
-			else
-				field[eid] = (field[eid] + M) / 2;
+			const std::vector<Tuple> vertices = WMTKMesh::get_vertices();
+			std::vector<MatrixNd> vertex_gradients(WMTKMesh::vert_capacity(), MatrixNd::Zero());
+			utils::maybe_parallel_for(vertices.size(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+					vertex_gradients[vertices[i].vid(*this)] = recovered_displacement_gradient(vertices[i]);
+			});
+
+			utils::maybe_parallel_for(elements.size(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+					errors[i] = element_error_indicator(elements[i], vertex_gradients);
+			});
+
+			const double mean_error = elements.empty() ? 0.0 : (std::accumulate(errors.begin(), errors.end(), 0.0) / elements.size());
+			target_error = args["error_indicator"]["tolerance"].template get<double>() * mean_error;
+			logger().debug("mean error indicator: {}, target: {}", mean_error, target_error);
 		}
-		return field;
+
+		std::vector<MatrixNd> element_metrics(element_capacity, MatrixNd::Zero());
+		utils::maybe_parallel_for(elements.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				element_metrics[this->element_id(elements[i])] = element_metric(elements[i], errors[i]);
+		});
+
+		const std::vector<Tuple> edges = WMTKMesh::get_edges();
+		std::vector<double> sizings(edges.size());
+		utils::maybe_parallel_for(edges.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				sizings[i] = edge_sizing(edges[i], element_metrics);
+		});
+
+		std::unordered_map<size_t, double> edge_sizings;
+		for (int i = 0; i < edges.size(); ++i)
+			edge_sizings[edges[i].eid(*this)] = sizings[i];
+		return edge_sizings;
 	}
 
 	// -------------------------------------------------------------------------
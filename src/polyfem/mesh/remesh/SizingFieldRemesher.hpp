@@ -41,21 +41,27 @@ namespace polyfem::mesh
 
 		// Edge collapse
 		void collapse_edges() override;
+		bool collapse_edge_before(const Tuple &t) override;
 		bool collapse_edge_after(const Tuple &t) override;
 
 		using SparseSizingField = std::unordered_map<size_t, MatrixNd>;
 
+		/// @brief Contact sizing field per vertex id
 		SparseSizingField compute_contact_sizing_field() const;
-		SparseSizingField smooth_contact_sizing_field(
-			const SparseSizingField &sizing_field) const;
 
-		SparseSizingField compute_elasticity_sizing_field() const;
+		/// @brief Zienkiewicz-Zhu indicator of the displacement gradient of an element
+		/// @param t element tuple
+		/// @param vertex_gradients recovered gradients per vertex id, recomputed around the element vertices if empty
+		double element_error_indicator(const Tuple &t, const std::vector<MatrixNd> &vertex_gradients = {}) const;
 
-		std::unordered_map<size_t, double> compute_edge_sizings() const;
+		/// @brief Compute the sizing of all edges in parallel.
+		/// Also refreshes the contact field and the target error used by edge_sizing for the rest of the pass.
+		std::unordered_map<size_t, double> compute_edge_sizings();
 
-		static SparseSizingField combine_sizing_fields(
-			const SparseSizingField &field1,
-			const SparseSizingField &field2);
+		/// @brief Sizing of an edge, edges above 1 are split and below 0.8 collapsed
+		/// @param e edge tuple
+		/// @param element_metrics metrics per element id, recomputed around the edge if empty
+		double edge_sizing(const Tuple &e, const std::vector<MatrixNd> &element_metrics = {}) const;
 
 	private:
 		template <typename Candidates>
@@ -64,6 +70,25 @@ namespace polyfem::mesh
 			const ipc::CollisionMesh &collision_mesh,
 			const Eigen::MatrixXd &V,
 			const double dhat) const;
+
+		/// @brief Deformation gradient of an element with respect to its rest shape
+		MatrixNd deformation_gradient(const Tuple &t) const;
+		/// @brief Volume weighted average of the displacement gradients of the elements around a vertex
+		MatrixNd recovered_displacement_gradient(const Tuple &v) const;
+		/// @brief Sizing metric of an element from its stretch and its error indicator
+		MatrixNd element_metric(const Tuple &t, const double error) const;
+		/// @brief Contact sizing metric of a boundary edge
+		MatrixNd contact_edge_metric(const Tuple &e) const;
+
+		bool use_error_indicator() const { return args["error_indicator"]["enabled"]; }
+
+		/// @brief Contact sizing field of the current pass, not recomputed after each operation
+		SparseSizingField contact_sizing;
+		/// @brief Target error indicator of the current pass
+		double target_error = 0;
+		/// @brief Contact sizing of the vertex created by the current collapse
+		MatrixNd collapse_contact_sizing;
+		bool has_collapse_contact_sizing = false;
 	};
 
 	using SizingFieldTriRemesher = SizingFieldRemesher<wmtk::TriMesh>;
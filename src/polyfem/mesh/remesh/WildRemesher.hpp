@@ -389,6 +389,10 @@ namespace polyfem::mesh
 		struct ElementAttributes
 		{
 			int body_id = 0;
+
+			/// @brief Cached elastic energy of the element, valid while elastic_energy_hash matches the state of its vertices
+			mutable double elastic_energy = 0;
+			mutable size_t elastic_energy_hash = 0;
 		};
 
 		void write_edge_ranks_mesh(
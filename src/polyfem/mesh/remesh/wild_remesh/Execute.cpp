@@ -39,15 +39,6 @@ namespace polyfem::mesh
 			return m.renew_neighbor_tuples(op, tris);
 		};
 
-		static int aggregate_split_cnt_success = 0;
-		static int aggregate_split_cnt_fail = 0;
-		static int aggregate_collapse_cnt_success = 0;
-		static int aggregate_collapse_cnt_fail = 0;
-		static int aggregate_swap_cnt_success = 0;
-		static int aggregate_swap_cnt_fail = 0;
-		static int aggregate_smooth_cnt_success = 0;
-		static int aggregate_smooth_cnt_fail = 0;
-
 #ifdef SAVE_OPS
 		static int frame_count = 0;
 		if (frame_count == 0)
@@ -63,8 +54,8 @@ namespace polyfem::mesh
 			logger().info("Splitting");
 			split_edges();
 			cnt_success += executor.cnt_success();
-			aggregate_split_cnt_success += executor.cnt_success();
-			aggregate_split_cnt_fail += executor.cnt_fail();
+			operation_counts["split"].success += executor.cnt_success();
+			operation_counts["split"].fail += executor.cnt_fail();
 #ifdef SAVE_OPS
 			write_mesh(state.resolve_output_path(fmt::format("op{:d}.vtu", frame_count++)));
 #endif
@@ -82,8 +73,8 @@ namespace polyfem::mesh
 			executor.m_cnt_fail = 0;
 			collapse_edges();
 			cnt_success += executor.cnt_success();
-			aggregate_collapse_cnt_success += executor.cnt_success();
-			aggregate_collapse_cnt_fail += executor.cnt_fail();
+			operation_counts["collapse"].success += executor.cnt_success();
+			operation_counts["collapse"].fail += executor.cnt_fail();
 			projection_needed |= executor.cnt_success() > 0;
 #ifdef SAVE_OPS
 			write_mesh(state.resolve_output_path(fmt::format("op{:d}.vtu", frame_count++)));
@@ -101,8 +92,8 @@ namespace polyfem::mesh
 			executor.m_cnt_fail = 0;
 			swap_edges();
 			cnt_success += executor.cnt_success();
-			aggregate_swap_cnt_success += executor.cnt_success();
-			aggregate_swap_cnt_fail += executor.cnt_fail();
+			operation_counts["swap"].success += executor.cnt_success();
+			operation_counts["swap"].fail += executor.cnt_fail();
 			projection_needed |= executor.cnt_success() > 0;
 #ifdef SAVE_OPS
 			write_mesh(state.resolve_output_path(fmt::format("op{:d}.vtu", frame_count++)));
@@ -117,18 +108,16 @@ namespace polyfem::mesh
 			executor.m_cnt_fail = 0;
 			smooth_vertices();
 			cnt_success += executor.cnt_success();
-			aggregate_smooth_cnt_success += executor.cnt_success();
-			aggregate_smooth_cnt_fail += executor.cnt_fail();
+			operation_counts["smooth"].success += executor.cnt_success();
+			operation_counts["smooth"].fail += executor.cnt_fail();
 			projection_needed |= executor.cnt_success() > 0;
 #ifdef SAVE_OPS
 			write_mesh(state.resolve_output_path(fmt::format("op{:d}.vtu", frame_count++)));
 #endif
 		}
 
-		logger().info("[split]    aggregate_cnt_success {} aggregate_cnt_fail {}", aggregate_split_cnt_success, aggregate_split_cnt_fail);
-		logger().info("[collapse] aggregate_cnt_success {} aggregate_cnt_fail {}", aggregate_collapse_cnt_success, aggregate_collapse_cnt_fail);
-		logger().info("[swap]     aggregate_cnt_success {} aggregate_cnt_fail {}", aggregate_swap_cnt_success, aggregate_swap_cnt_fail);
-		logger().info("[smooth]   aggregate_cnt_success {} aggregate_cnt_fail {}", aggregate_smooth_cnt_success, aggregate_smooth_cnt_fail);
+		for (const std::string op : {"split", "collapse", "swap", "smooth"})
+			logger().info("[{:8s}] aggregate_cnt_success {} aggregate_cnt_fail {}", op, operation_counts[op].success, operation_counts[op].fail);
 
 		if (projection_needed)
 			project_quantities();
@@ -51,7 +51,10 @@ namespace polyfem::mesh
 		// 2. Perform "relaxation" by minimizing the elastic energy of the
 		// n-ring with the internal boundary edges fixed.
 
-		LocalRelaxationData data(this->state, local_mesh, this->current_time, include_global_boundary);
+		// the assemblers and the solver are reused between the operations, only the mesh-dependent data is rebuilt
+		const std::shared_ptr<LocalRelaxationResources> resources = relaxation_pool.acquire(this->state, local_mesh.body_ids());
+
+		LocalRelaxationData data(this->state, local_mesh, this->current_time, include_global_boundary, *resources);
 		solver::SolveData &solve_data = data.solve_data;
 
 		const int n_free_dof = data.n_free_dof();
@@ -65,7 +68,7 @@ namespace polyfem::mesh
 		this->num_solves++;
 
 		// Nonlinear solver
-		auto nl_solver = state.make_nl_solver(/*for_al=*/false); // TODO: Use Eigen::LLT
+		polysolve::nonlinear::Solver *nl_solver = resources->nl_solver.get();
 		nl_solver->stop_criteria().iterations = args["local_relaxation"]["max_nl_iterations"];
 		if (this->is_boundary_op())
 			nl_solver->stop_criteria().iterations = std::max(nl_solver->stop_criteria().iterations, size_t(5));
@@ -135,7 +138,7 @@ namespace polyfem::mesh
 				{
 					logger().set_level(level_before);
 					assert(false);
-					return false;
+							return false;
 				}
 				logger().set_level(level_before);
 
@@ -12,12 +12,79 @@
 
 namespace polyfem::mesh
 {
+	std::vector<int> LocalRelaxationResources::material_key(const State &state, const std::vector<int> &body_ids)
+	{
+		// a single material is applied to all the elements
+		return state.args["materials"].is_array() ? body_ids : std::vector<int>();
+	}
+
+	void LocalRelaxationResources::init_assemblers(const State &state, const std::vector<int> &body_ids, const int dim)
+	{
+		assert(utils::is_param_valid(state.args, "materials"));
+
+		std::vector<int> key = material_key(state, body_ids);
+		if (assembler != nullptr && assemblers_dim == dim && assemblers_key == key)
+			return;
+
+		POLYFEM_REMESHER_SCOPED_TIMER("LocalRelaxationData::init_assembler");
+
+		assembler = assembler::AssemblerUtils::make_assembler(state.formulation());
+		assert(assembler->name() == state.formulation());
+		assembler->set_size(dim);
+		assembler->set_materials(body_ids, state.args["materials"], state.units);
+
+		mass_matrix_assembler = std::make_shared<assembler::Mass>();
+		mass_matrix_assembler->set_size(dim);
+		mass_matrix_assembler->set_materials(body_ids, state.args["materials"], state.units);
+
+		assemblers_key = std::move(key);
+		assemblers_dim = dim;
+	}
+
+	std::shared_ptr<LocalRelaxationResources> LocalRelaxationPool::acquire(const State &state, const std::vector<int> &body_ids)
+	{
+		std::unique_ptr<LocalRelaxationResources> res;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!free_.empty())
+			{
+				const std::vector<int> key = LocalRelaxationResources::material_key(state, body_ids);
+				auto it = std::find_if(free_.begin(), free_.end(), [&](const auto &r) { return r->assemblers_key == key; });
+				if (it == free_.end())
+					it = free_.end() - 1;
+
+				res = std::move(*it);
+				free_.erase(it);
+			}
+		}
+
+		if (res == nullptr)
+		{
+			res = std::make_unique<LocalRelaxationResources>();
+			res->nl_solver = state.make_nl_solver(/*for_al=*/false); // TODO: Use Eigen::LLT
+
+			res->rhs_solver_params = state.args["solver"]["linear"];
+			if (!res->rhs_solver_params.contains("Pardiso"))
+				res->rhs_solver_params["Pardiso"] = {};
+			res->rhs_solver_params["Pardiso"]["mtype"] = -2; // matrix type for Pardiso (2 = SPD)
+		}
+
+		return std::shared_ptr<LocalRelaxationResources>(res.release(), [this](LocalRelaxationResources *r) { release(r); });
+	}
+
+	void LocalRelaxationPool::release(LocalRelaxationResources *resources)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		free_.emplace_back(resources);
+	}
+
 	template <typename M>
 	LocalRelaxationData<M>::LocalRelaxationData(
 		const State &state,
 		LocalMesh<M> &local_mesh,
 		const double current_time,
-		const bool contact_enabled)
+		const bool contact_enabled,
+		LocalRelaxationResources &resources)
 		: local_mesh(local_mesh)
 	{
 		problem = std::make_shared<assembler::GenericTensorProblem>("GenericTensor");
@@ -25,9 +92,9 @@ namespace polyfem::mesh
 		init_mesh(state);
 		init_bases(state);
 		init_boundary_conditions(state);
-		init_assembler(state);
+		init_assembler(state, resources);
 		init_mass_matrix(state);
-		init_solve_data(state, current_time, contact_enabled);
+		init_solve_data(state, current_time, contact_enabled, resources.rhs_solver_params);
 	}
 
 	template <typename M>
@@ -145,19 +212,12 @@ namespace polyfem::mesh
 	}
 
 	template <typename M>
-	void LocalRelaxationData<M>::init_assembler(const State &state)
+	void LocalRelaxationData<M>::init_assembler(const State &state, LocalRelaxationResources &resources)
 	{
-		POLYFEM_REMESHER_SCOPED_TIMER("LocalRelaxationData::init_assembler");
-		assert(utils::is_param_valid(state.args, "materials"));
-
-		assembler = assembler::AssemblerUtils::make_assembler(state.formulation());
-		assert(assembler->name() == state.formulation());
-		assembler->set_size(dim());
-		assembler->set_materials(local_mesh.body_ids(), state.args["materials"], state.units);
-
-		mass_matrix_assembler = std::make_shared<assembler::Mass>();
-		mass_matrix_assembler->set_size(dim());
-		mass_matrix_assembler->set_materials(local_mesh.body_ids(), state.args["materials"], state.units);
+		// the assemblers only depend on the materials of the local elements
+		resources.init_assemblers(state, local_mesh.body_ids(), dim());
+		assembler = resources.assembler;
+		mass_matrix_assembler = resources.mass_matrix_assembler;
 
 		pressure_assembler = nullptr; // TODO: implement this
 	}
@@ -187,7 +247,8 @@ namespace polyfem::mesh
 	void LocalRelaxationData<M>::init_solve_data(
 		const State &state,
 		const double current_time,
-		const bool contact_enabled)
+		const bool contact_enabled,
+		const json &rhs_solver_params)
 	{
 		// Current solution.
 		const Eigen::MatrixXd target_x = this->sol();
@@ -232,11 +293,6 @@ namespace polyfem::mesh
 		{
 			POLYFEM_REMESHER_SCOPED_TIMER("LocalRelaxationData::init_solve_data -> create RHS assembler");
 
-			json rhs_solver_params = state.args["solver"]["linear"];
-			if (!rhs_solver_params.contains("Pardiso"))
-				rhs_solver_params["Pardiso"] = {};
-			rhs_solver_params["Pardiso"]["mtype"] = -2; // matrix type for Pardiso (2 = SPD)
-
 			const int size = state.problem->is_scalar() ? 1 : dim();
 			solve_data.rhs_assembler = std::make_shared<assembler::RhsAssembler>(
 				*assembler, *mesh, Obstacle(), dirichlet_nodes, neumann_nodes,
@@ -5,8 +5,43 @@
 #include <polyfem/mesh/LocalBoundary.hpp>
 #include <polyfem/mesh/remesh/wild_remesh/LocalMesh.hpp>
 
+#include <memory>
+#include <mutex>
+
 namespace polyfem::mesh
 {
+	/// Objects of a local relaxation which do not depend on the local mesh, reused between the operations
+	struct LocalRelaxationResources
+	{
+		/// (re)build the assemblers if they were set for other materials
+		void init_assemblers(const State &state, const std::vector<int> &body_ids, const int dim);
+
+		/// body ids the assemblers were set for, empty if the materials do not depend on them
+		static std::vector<int> material_key(const State &state, const std::vector<int> &body_ids);
+
+		std::vector<int> assemblers_key;
+		int assemblers_dim = -1;
+		std::shared_ptr<assembler::Assembler> assembler;
+		std::shared_ptr<assembler::Mass> mass_matrix_assembler;
+
+		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver;
+		json rhs_solver_params;
+	};
+
+	/// Pool of LocalRelaxationResources, a resource is used by one local relaxation at a time
+	class LocalRelaxationPool
+	{
+	public:
+		/// a free resource, preferably one whose assemblers match the body ids, it returns to the pool when released
+		std::shared_ptr<LocalRelaxationResources> acquire(const State &state, const std::vector<int> &body_ids);
+
+	private:
+		void release(LocalRelaxationResources *resources);
+
+		std::mutex mutex_;
+		std::vector<std::unique_ptr<LocalRelaxationResources>> free_;
+	};
+
 	// Things needed for the local relaxation solve
 	template <typename M>
 	class LocalRelaxationData
@@ -16,7 +51,8 @@ namespace polyfem::mesh
 			const State &state,
 			LocalMesh<M> &local_mesh,
 			const double current_time,
-			const bool contact_enabled);
+			const bool contact_enabled,
+			LocalRelaxationResources &resources);
 
 		Eigen::MatrixXd sol() const
 		{
@@ -37,12 +73,13 @@ namespace polyfem::mesh
 		void init_mesh(const State &state);
 		void init_bases(const State &state);
 		void init_boundary_conditions(const State &state);
-		void init_assembler(const State &state);
+		void init_assembler(const State &state, LocalRelaxationResources &resources);
 		void init_mass_matrix(const State &state);
 		void init_solve_data(
 			const State &state,
 			const double current_time,
-			const bool contact_enabled);
+			const bool contact_enabled,
+			const json &rhs_solver_params);
 
 		// Mesh data
 		std::unique_ptr<Mesh> mesh;
@@ -1,5 +1,9 @@
 #include <polyfem/mesh/remesh/PhysicsRemesher.hpp>
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <unordered_map>
+
 namespace polyfem::mesh
 {
 	template <class WMTKMesh>
@@ -184,7 +188,28 @@ namespace polyfem::mesh
 		for (const Tuple &e : included_edges)
 			splits.emplace_back("edge_split", e);
 
+		// The priorities of the initial splits are independent local solves on the
+		// current mesh, evaluate them in parallel before filling the queue.
+		std::vector<double> energies(included_edges.size());
+		utils::maybe_parallel_for(included_edges.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				energies[i] = this->edge_elastic_energy(included_edges[i]);
+		});
+
+		std::unordered_map<size_t, double> initial_energies;
+		initial_energies.reserve(included_edges.size());
+		for (int i = 0; i < included_edges.size(); ++i)
+			initial_energies[included_edges[i].eid(*this)] = energies[i];
+
 		executor.priority = [&](const WildRemesher<WMTKMesh> &, std::string op, const Tuple &t) -> double {
+			// each precomputed energy is used once, when the initial operations are queued
+			const auto it = initial_energies.find(t.eid(*this));
+			if (it != initial_energies.end())
+			{
+				const double energy = it->second;
+				initial_energies.erase(it);
+				return energy;
+			}
 			return this->edge_elastic_energy(t);
 		};
 
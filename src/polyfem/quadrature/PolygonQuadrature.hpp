@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Quadrature.hpp"
+#include "SimplexDecomposition.hpp"
+
+#include <memory>
 
 namespace polyfem
 {
@@ -19,6 +22,24 @@ namespace polyfem
 			/// @param[out] quadr  computed quadrature data
 			///
 			void get_quadrature(const Eigen::MatrixXd &poly, const int order, Quadrature &quadr);
+
+			///
+			/// @brief      Triangulates a polygon, the fan around the barycenter if it is star-shaped w.r.t. it, ear clipping otherwise.
+			///
+			/// @param[in]  poly  n x 2 matrix, coordinates of the polyline defining the boundary of the polygon
+			///
+			/// @return     the triangles, shared by the quadratures of all orders
+			///
+			static std::shared_ptr<const SimplexDecomposition> decompose(const Eigen::MatrixXd &poly);
+
+			///
+			/// @brief      Expands the quadrature of a triangulated polygon
+			///
+			/// @param[in]  tris   triangulation from decompose
+			/// @param[in]  order  order of the triangle quadrature
+			/// @param[out] quadr  computed quadrature data
+			///
+			static void get_quadrature(const SimplexDecomposition &tris, const int order, Quadrature &quadr);
 		};
 	} // namespace quadrature
 } // namespace polyfem
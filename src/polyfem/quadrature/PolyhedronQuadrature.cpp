@@ -1,6 +1,6 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "PolyhedronQuadrature.hpp"
-#include "TetQuadrature.hpp"
+#include "QuadratureRegistry.hpp"
 #include <polyfem/mesh/MeshUtils.hpp>
 #include <geogram/mesh/mesh_io.h>
 #include <igl/writeMESH.h>
@@ -71,39 +71,26 @@ namespace polyfem
 
 #endif
 
-			template <class TriMat>
-			double transform_pts(const TriMat &tri, const Eigen::MatrixXd &pts, Eigen::MatrixXd &transformed)
-			{
-				Eigen::Matrix3d matrix;
-				matrix.row(0) = tri.row(1) - tri.row(0);
-				matrix.row(1) = tri.row(2) - tri.row(0);
-				matrix.row(2) = tri.row(3) - tri.row(0);
-
-				transformed = pts * matrix;
-
-				transformed.col(0).array() += tri(0, 0);
-				transformed.col(1).array() += tri(0, 1);
-				transformed.col(2).array() += tri(0, 2);
-
-				return matrix.determinant();
-			}
-
+			// the tets of every polyhedron use the same rule, whatever the requested order
+			constexpr int tet_quadrature_order = 4;
 		} // anonymous namespace
 
 		////////////////////////////////////////////////////////////////////////////////
 
 		void PolyhedronQuadrature::get_quadrature(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F,
 												  const Eigen::RowVector3d &kernel, const int order, Quadrature &quadr)
+		{
+			get_quadrature(*decompose(V, F, kernel), order, quadr);
+		}
+
+		std::shared_ptr<const SimplexDecomposition> PolyhedronQuadrature::decompose(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::RowVector3d &kernel)
 		{
 			std::string flags = "Qpq2.0";
 			Eigen::VectorXi J;
 			Eigen::MatrixXd VV, OV, TV;
 			Eigen::MatrixXi OF, TF, tets;
 
-			Quadrature tet_quadr_pts;
-			TetQuadrature tet_quadr;
-			tet_quadr.get_quadrature(4, tet_quadr_pts);
-			// assert(tet_quadr_pts.weights.minCoeff() >= 0);
+			const Quadrature &tet_quadr_pts = *QuadratureRegistry::get(QuadratureRegistry::ElementType::Tetrahedron, tet_quadrature_order);
 
 			double scaling = (V.colwise().maxCoeff() - V.colwise().minCoeff()).maxCoeff();
 			Eigen::RowVector3d translation = V.colwise().minCoeff();
@@ -159,31 +146,13 @@ namespace polyfem
 
 			// std::cout << "volume: " << volume(M) << std::endl;
 
-			const long offset = tet_quadr_pts.weights.rows();
-			quadr.points.resize(tets.rows() * offset, 3);
-			quadr.weights.resize(tets.rows() * offset, 1);
-
-			Eigen::MatrixXd transformed_points;
+			return std::make_shared<const SimplexDecomposition>(TV, tets);
+		}
 
-			for (long i = 0; i < tets.rows(); ++i)
-			{
-				Eigen::Matrix<double, 4, 3> tetra;
-				const auto &indices = tets.row(i);
-				tetra.row(0) = TV.row(indices(0));
-				tetra.row(1) = TV.row(indices(1));
-				tetra.row(2) = TV.row(indices(2));
-				tetra.row(3) = TV.row(indices(3));
-
-				// viewer.data.add_edges(triangle.row(0), triangle.row(1), Eigen::Vector3d(1,0,0).transpose());
-				// viewer.data.add_edges(triangle.row(0), triangle.row(2), Eigen::Vector3d(1,0,0).transpose());
-				// viewer.data.add_edges(triangle.row(2), triangle.row(1), Eigen::Vector3d(1,0,0).transpose());
-
-				const double det = transform_pts(tetra, tet_quadr_pts.points, transformed_points);
-				assert(det > 0);
-
-				quadr.points.block(i * offset, 0, transformed_points.rows(), transformed_points.cols()) = transformed_points;
-				quadr.weights.block(i * offset, 0, tet_quadr_pts.weights.rows(), tet_quadr_pts.weights.cols()) = tet_quadr_pts.weights * det;
-			}
+		void PolyhedronQuadrature::get_quadrature(const SimplexDecomposition &tets, const int order, Quadrature &quadr)
+		{
+			assert(tets.dim() == 3);
+			tets.expand(tet_quadrature_order, quadr);
 
 			// assert(quadr.weights.minCoeff() >= 0);
 			// std::cout<<"#quadrature points: " << quadr.weights.size()<<" "<<quadr.weights.sum()<<std::endl;
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Quadrature.hpp"
+#include "SimplexDecomposition.hpp"
 #include <geogram/mesh/mesh.h>
 
+#include <memory>
+
 namespace polyfem
 {
 	namespace quadrature
@@ -25,6 +28,30 @@ namespace polyfem
 				const Eigen::RowVector3d &kernel,
 				const int order,
 				Quadrature &quadr);
+
+			///
+			/// @brief      Tetrahedralization of a polyhedron used by get_quadrature, the points are expanded from it
+			///
+			/// @param[in]  V        #V x 3 input surface vertices (triangulated surface of the polyhedron)
+			/// @param[in]  F        #F x 3 input surface faces
+			/// @param[in]  kernel   A point in the kernel of the polyhedron
+			///
+			static std::shared_ptr<const SimplexDecomposition> decompose(
+				const Eigen::MatrixXd &V,
+				const Eigen::MatrixXi &F,
+				const Eigen::RowVector3d &kernel);
+
+			///
+			/// @brief      Gets the quadrature points & weights of a tetrahedralized polyhedron
+			///
+			/// @param[in]  tets     Tetrahedralization from decompose
+			/// @param[in]  order    Order of the quadrature (the order 4 rule of the tets is used for now)
+			/// @param[out] quadr    Computed quadrature data
+			///
+			static void get_quadrature(
+				const SimplexDecomposition &tets,
+				const int order,
+				Quadrature &quadr);
 		};
 	} // namespace quadrature
 } // namespace polyfem
@@ -0,0 +1,80 @@
+#include "QuadratureRegistry.hpp"
+
+#include "HexQuadrature.hpp"
+#include "LineQuadrature.hpp"
+#include "QuadQuadrature.hpp"
+#include "TetQuadrature.hpp"
+#include "TriQuadrature.hpp"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace polyfem
+{
+	namespace quadrature
+	{
+		namespace
+		{
+			struct Registry
+			{
+				std::mutex mutex;
+				std::map<std::pair<QuadratureRegistry::ElementType, int>, std::shared_ptr<const Quadrature>> rules;
+			};
+
+			Registry &registry()
+			{
+				static Registry instance;
+				return instance;
+			}
+
+			std::shared_ptr<const Quadrature> compute_rule(const QuadratureRegistry::ElementType type, const int order)
+			{
+				auto quad = std::make_shared<Quadrature>();
+				switch (type)
+				{
+				case QuadratureRegistry::ElementType::Line:
+					LineQuadrature().get_quadrature(order, *quad);
+					break;
+				case QuadratureRegistry::ElementType::Triangle:
+					TriQuadrature().get_quadrature(order, *quad);
+					break;
+				case QuadratureRegistry::ElementType::Quad:
+					QuadQuadrature().get_quadrature(order, *quad);
+					break;
+				case QuadratureRegistry::ElementType::Tetrahedron:
+					TetQuadrature().get_quadrature(order, *quad);
+					break;
+				case QuadratureRegistry::ElementType::Hexahedron:
+					HexQuadrature().get_quadrature(order, *quad);
+					break;
+				}
+				return quad;
+			}
+		} // namespace
+
+		std::shared_ptr<const Quadrature> QuadratureRegistry::get(const ElementType type, const int order)
+		{
+			Registry &r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+
+			std::shared_ptr<const Quadrature> &rule = r.rules[{type, order}];
+			if (rule == nullptr)
+				rule = compute_rule(type, order);
+			return rule;
+		}
+
+		std::function<void(Quadrature &)> QuadratureRegistry::builder(const ElementType type, const int order)
+		{
+			const std::shared_ptr<const Quadrature> rule = get(type, order);
+			return [rule](Quadrature &quad) { quad = *rule; };
+		}
+
+		size_t QuadratureRegistry::size()
+		{
+			Registry &r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			return r.rules.size();
+		}
+	} // namespace quadrature
+} // namespace polyfem
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Quadrature.hpp"
+
+#include <functional>
+#include <memory>
+
+namespace polyfem
+{
+	namespace quadrature
+	{
+		/// Process-wide registry of the quadrature rules of the reference elements.
+		/// A rule is computed on its first request and then shared, the registered rules are immutable.
+		/// The mass and stiffness quadratures of an element only differ by their order.
+		class QuadratureRegistry
+		{
+		public:
+			enum class ElementType
+			{
+				Line,
+				Triangle,
+				Quad,
+				Tetrahedron,
+				Hexahedron
+			};
+
+			/// rule of the given element type and order, thread safe
+			static std::shared_ptr<const Quadrature> get(const ElementType type, const int order);
+
+			/// quadrature builder of ElementBases copying the registered rule, the rule is looked up once
+			static std::function<void(Quadrature &)> builder(const ElementType type, const int order);
+
+			/// number of registered rules
+			static size_t size();
+		};
+	} // namespace quadrature
+} // namespace polyfem
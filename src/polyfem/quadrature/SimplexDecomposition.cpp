@@ -0,0 +1,43 @@
+#include "SimplexDecomposition.hpp"
+
+#include "QuadratureRegistry.hpp"
+
+namespace polyfem
+{
+	namespace quadrature
+	{
+		SimplexDecomposition::SimplexDecomposition(const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &simplices)
+			: vertices_(vertices), simplices_(simplices)
+		{
+			assert(vertices.cols() == 2 || vertices.cols() == 3);
+			assert(simplices.rows() == 0 || simplices.cols() == vertices.cols() + 1);
+		}
+
+		void SimplexDecomposition::expand(const Quadrature &simplex_rule, Quadrature &quadr) const
+		{
+			const int d = dim();
+			const long offset = simplex_rule.weights.size();
+			assert(simplex_rule.points.cols() == d);
+
+			quadr.points.resize(n_simplices() * offset, d);
+			quadr.weights.resize(n_simplices() * offset);
+
+			Eigen::MatrixXd edges(d, d);
+			for (int s = 0; s < n_simplices(); ++s)
+			{
+				const auto v0 = vertices_.row(simplices_(s, 0));
+				for (int i = 0; i < d; ++i)
+					edges.row(i) = vertices_.row(simplices_(s, i + 1)) - v0;
+
+				quadr.points.middleRows(s * offset, offset) = (simplex_rule.points * edges).rowwise() + v0;
+				quadr.weights.segment(s * offset, offset) = simplex_rule.weights * edges.determinant();
+			}
+		}
+
+		void SimplexDecomposition::expand(const int order, Quadrature &quadr) const
+		{
+			const auto type = dim() == 2 ? QuadratureRegistry::ElementType::Triangle : QuadratureRegistry::ElementType::Tetrahedron;
+			expand(*QuadratureRegistry::get(type, order), quadr);
+		}
+	} // namespace quadrature
+} // namespace polyfem
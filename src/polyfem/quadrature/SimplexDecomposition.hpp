@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Quadrature.hpp"
+
+#include <Eigen/Dense>
+
+namespace polyfem
+{
+	namespace quadrature
+	{
+		///
+		/// @brief      Compressed quadrature of a polytope: its decomposition into triangles (2D) or tets (3D).
+		///             The points of a rule are only expanded when requested, e.g., when the element values are cached.
+		///
+		class SimplexDecomposition
+		{
+		public:
+			///
+			/// @param[in]  vertices   #V x dim vertices
+			/// @param[in]  simplices  #S x (dim + 1) positively oriented simplices
+			///
+			SimplexDecomposition(const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &simplices);
+
+			int dim() const { return int(vertices_.cols()); }
+			int n_simplices() const { return int(simplices_.rows()); }
+			const Eigen::MatrixXd &vertices() const { return vertices_; }
+			const Eigen::MatrixXi &simplices() const { return simplices_; }
+
+			///
+			/// @brief      Maps a rule of the reference simplex on every simplex of the decomposition
+			///
+			/// @param[in]  simplex_rule  rule on the reference triangle or tet
+			/// @param[out] quadr         #S * #simplex_rule points and weights, the ones of simplex s are contiguous
+			///
+			void expand(const Quadrature &simplex_rule, Quadrature &quadr) const;
+
+			/// the expanded rule of TriQuadrature/TetQuadrature of the given order
+			void expand(const int order, Quadrature &quadr) const;
+
+			/// heap memory in bytes
+			size_t memory_bytes() const { return sizeof(double) * vertices_.size() + sizeof(int) * simplices_.size(); }
+
+		private:
+			Eigen::MatrixXd vertices_;
+			Eigen::MatrixXi simplices_;
+		};
+	} // namespace quadrature
+} // namespace polyfem
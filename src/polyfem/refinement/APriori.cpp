@@ -253,4 +253,52 @@ namespace polyfem::refinement
 		else
 			p_refine(static_cast<const Mesh2D &>(mesh), B, h1_formula, base_p, discr_order_max, stats, disc_orders);
 	}
+
+	int APriori::p_refine(
+		const mesh::Mesh &mesh,
+		const std::vector<int> &marked,
+		const int discr_order_max,
+		Eigen::VectorXi &disc_orders)
+	{
+		assert(disc_orders.size() == mesh.n_elements());
+		const int p_max = std::min(autogen::MAX_P_BASES, discr_order_max);
+		const Eigen::VectorXi old_orders = disc_orders;
+
+		std::vector<std::vector<int>> vertex_to_elements(mesh.n_vertices());
+		for (int e = 0; e < mesh.n_elements(); ++e)
+			for (const int v : mesh.element_vertices(e))
+				vertex_to_elements[v].push_back(e);
+
+		std::vector<int> queue;
+		for (const int e : marked)
+		{
+			if (mesh.is_polytope(e) || disc_orders[e] >= p_max)
+				continue;
+			++disc_orders[e];
+			queue.push_back(e);
+		}
+
+		// propagate the order jumps, each element can only be raised up to p_max so this terminates
+		while (!queue.empty())
+		{
+			const int e = queue.back();
+			queue.pop_back();
+
+			for (const int v : mesh.element_vertices(e))
+			{
+				for (const int n : vertex_to_elements[v])
+				{
+					if (mesh.is_polytope(n) || disc_orders[n] >= disc_orders[e] - 1)
+						continue;
+					disc_orders[n] = disc_orders[e] - 1;
+					queue.push_back(n);
+				}
+			}
+		}
+
+		const int n_changed = (disc_orders.array() != old_orders.array()).count();
+		logger().info("p-refined {}/{} elements, min p: {} max p: {}", n_changed, disc_orders.size(), disc_orders.minCoeff(), disc_orders.maxCoeff());
+
+		return n_changed;
+	}
 } // namespace polyfem::refinement
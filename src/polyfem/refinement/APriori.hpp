@@ -33,6 +33,18 @@ namespace polyfem::refinement
 							 io::OutStatsData &stats,
 							 Eigen::VectorXi &disc_orders);
 
+		/// a posteriori p-refinement, raises by one the order of the marked elements (see ErrorIndicator::mark)
+		/// the elements sharing a vertex with a refined element are raised so that their orders differ by at most one
+		/// @param[in] mesh mesh
+		/// @param[in] marked elements to refine
+		/// @param[in] discr_order_max maximum element degree
+		/// @param[in, out] disc_orders per element order
+		/// @return number of elements whose order changed
+		static int p_refine(const mesh::Mesh &mesh,
+							const std::vector<int> &marked,
+							const int discr_order_max,
+							Eigen::VectorXi &disc_orders);
+
 	private:
 		/// compute a priori prefinement in 2d
 		/// @param[in] mesh2d mesh
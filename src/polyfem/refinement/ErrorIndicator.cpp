@@ -0,0 +1,151 @@
+#include "ErrorIndicator.hpp"
+
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/mesh/mesh2D/NCMesh2D.hpp>
+#include <polyfem/mesh/mesh3D/NCMesh3D.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace polyfem::refinement
+{
+	using namespace assembler;
+	using namespace basis;
+	using namespace utils;
+
+	namespace
+	{
+		/// gradient of the solution at the quadrature points, one row per point, size x dim entries per row
+		Eigen::MatrixXd solution_gradient(const ElementAssemblyValues &vals, const int size, const int dim, const Eigen::MatrixXd &sol)
+		{
+			const int n_pts = vals.quadrature.weights.size();
+			Eigen::MatrixXd grad = Eigen::MatrixXd::Zero(n_pts, size * dim);
+			for (const AssemblyValues &v : vals.basis_values)
+			{
+				for (const Local2Global &g : v.global)
+				{
+					for (int d = 0; d < size; ++d)
+					{
+						const double s = sol(g.index * size + d) * g.val;
+						grad.middleCols(d * dim, dim) += s * v.grad_t_m;
+					}
+				}
+			}
+			return grad;
+		}
+	} // namespace
+
+	void ErrorIndicator::zz(const mesh::Mesh &mesh,
+							const int size,
+							const std::vector<ElementBases> &bases,
+							const std::vector<ElementBases> &geom_bases,
+							const AssemblyValsCache &ass_vals_cache,
+							const Eigen::MatrixXd &sol,
+							Eigen::VectorXd &indicators)
+	{
+		const int n_elements = bases.size();
+		const int dim = mesh.dimension();
+		const bool is_volume = mesh.is_volume();
+
+		// 1. volume weighted gradient of each element
+		Eigen::MatrixXd element_gradients(n_elements, size * dim);
+		Eigen::VectorXd element_volumes(n_elements);
+		std::vector<bool> has_parameterization(n_elements);
+
+		maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			ElementAssemblyValues vals;
+			for (int e = start; e < end; ++e)
+			{
+				ass_vals_cache.compute(e, is_volume, bases[e], geom_bases[e], vals);
+				const Eigen::VectorXd da = vals.det.array() * vals.quadrature.weights.array();
+				const Eigen::MatrixXd grad = solution_gradient(vals, size, dim, sol);
+
+				element_volumes(e) = da.sum();
+				element_gradients.row(e) = (da.transpose() * grad) / element_volumes(e);
+				has_parameterization[e] = vals.has_parameterization;
+			}
+		});
+
+		// 2. recovered gradient at the geometric nodes
+		int n_geom_nodes = 0;
+		for (const ElementBases &gbs : geom_bases)
+			for (const Basis &b : gbs.bases)
+				n_geom_nodes = std::max(n_geom_nodes, b.global()[0].index + 1);
+
+		Eigen::MatrixXd node_gradients = Eigen::MatrixXd::Zero(n_geom_nodes, size * dim);
+		Eigen::VectorXd node_weights = Eigen::VectorXd::Zero(n_geom_nodes);
+		for (int e = 0; e < n_elements; ++e)
+		{
+			if (!has_parameterization[e])
+				continue;
+			for (const Basis &b : geom_bases[e].bases)
+			{
+				const int n = b.global()[0].index;
+				node_gradients.row(n) += element_volumes(e) * element_gradients.row(e);
+				node_weights(n) += element_volumes(e);
+			}
+		}
+		for (int n = 0; n < n_geom_nodes; ++n)
+			if (node_weights(n) > 0)
+				node_gradients.row(n) /= node_weights(n);
+
+		// 3. distance between the interpolated recovery and the gradient
+		indicators.setZero(n_elements);
+		maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			ElementAssemblyValues vals;
+			std::vector<AssemblyValues> gvals;
+			for (int e = start; e < end; ++e)
+			{
+				if (!has_parameterization[e])
+					continue;
+
+				ass_vals_cache.compute(e, is_volume, bases[e], geom_bases[e], vals);
+				geom_bases[e].evaluate_bases(vals.quadrature.points, gvals);
+
+				Eigen::MatrixXd diff = -solution_gradient(vals, size, dim, sol);
+				for (int j = 0; j < gvals.size(); ++j)
+					diff += gvals[j].val * node_gradients.row(geom_bases[e].bases[j].global()[0].index);
+
+				const Eigen::VectorXd da = vals.det.array() * vals.quadrature.weights.array();
+				indicators(e) = std::sqrt(da.dot(diff.rowwise().squaredNorm()));
+			}
+		});
+	}
+
+	std::vector<int> ErrorIndicator::mark(const Eigen::VectorXd &indicators, const double theta)
+	{
+		std::vector<int> order(indicators.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](int a, int b) { return indicators(a) > indicators(b); });
+
+		const double target = theta * indicators.squaredNorm();
+		std::vector<int> marked;
+		double sum = 0;
+		for (const int e : order)
+		{
+			if (sum >= target || indicators(e) <= 0)
+				break;
+			marked.push_back(e);
+			sum += indicators(e) * indicators(e);
+		}
+
+		return marked;
+	}
+
+	int ErrorIndicator::h_refine(const Eigen::VectorXd &indicators, const double theta, mesh::Mesh &mesh)
+	{
+		const std::vector<int> marked = mark(indicators, theta);
+
+		if (auto ncmesh = dynamic_cast<mesh::NCMesh2D *>(&mesh))
+			ncmesh->refine_elements(marked);
+		else if (auto ncmesh = dynamic_cast<mesh::NCMesh3D *>(&mesh))
+			ncmesh->refine_elements(marked);
+		else
+			log_and_throw_error("Adaptive h-refinement requires a non-conforming mesh!");
+
+		logger().debug("Refined {}/{} elements", marked.size(), indicators.size());
+		return marked.size();
+	}
+} // namespace polyfem::refinement
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/mesh/Mesh.hpp>
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem::refinement
+{
+	/// Class for a posteriori error indicators of a finite element solution
+	class ErrorIndicator
+	{
+	private:
+		ErrorIndicator() {}
+
+	public:
+		/// compute the Zienkiewicz-Zhu indicators, the L2 distance per element between the gradient of
+		/// the solution and its recovery (the element gradients averaged at the geometric nodes)
+		/// @param[in] mesh mesh
+		/// @param[in] size size of the unknown (1 for scalar problems, dim for elasticity)
+		/// @param[in] bases bases of the solution
+		/// @param[in] geom_bases geometric bases
+		/// @param[in] ass_vals_cache cache of the assembly values
+		/// @param[in] sol solution
+		/// @param[out] indicators per element indicator, zero for the elements without parametrization
+		static void zz(const mesh::Mesh &mesh,
+					   const int size,
+					   const std::vector<basis::ElementBases> &bases,
+					   const std::vector<basis::ElementBases> &geom_bases,
+					   const assembler::AssemblyValsCache &ass_vals_cache,
+					   const Eigen::MatrixXd &sol,
+					   Eigen::VectorXd &indicators);
+
+		/// Dörfler marking: the smallest set of elements carrying a fraction theta of the total squared error
+		/// @param[in] indicators per element indicator
+		/// @param[in] theta fraction in [0, 1]
+		/// @return marked elements, sorted by decreasing indicator
+		static std::vector<int> mark(const Eigen::VectorXd &indicators, const double theta);
+
+		/// h-refine the marked elements of a non-conforming mesh
+		/// @param[in] indicators per element indicator
+		/// @param[in] theta marking fraction, see mark
+		/// @param[in, out] mesh NCMesh2D or NCMesh3D
+		/// @return number of refined elements
+		static int h_refine(const Eigen::VectorXd &indicators, const double theta, mesh::Mesh &mesh);
+	};
+} // namespace polyfem::refinement
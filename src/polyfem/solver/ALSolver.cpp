@@ -49,7 +49,11 @@ namespace polyfem::solver
 			set_al_weight(nl_problem, sol, al_weight);
 			logger().debug("Solving AL Problem with weight {}", al_weight);
 
-			nl_problem.init(sol);
+			// the next subsolves only change the penalty weight, the hessian pattern and the constant hessians are kept
+			if (al_steps == 0)
+				nl_problem.init(sol);
+			else
+				nl_problem.reinit(sol);
 			update_barrier_stiffness(sol);
 			tmp_sol = sol;
 
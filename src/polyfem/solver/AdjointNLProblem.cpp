@@ -1,15 +1,24 @@
 #include "AdjointNLProblem.hpp"
 
 #include <polyfem/solver/forms/adjoint_forms/AdjointForm.hpp>
+#include <polyfem/solver/ReducedOrderModel.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/par_for.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/io/OBJWriter.hpp>
 #include <polyfem/io/MshWriter.hpp>
 #include <polyfem/State.hpp>
 #include <polyfem/mesh/SlimSmooth.hpp>
 
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
 #include <list>
+#include <numeric>
 #include <stack>
 
 namespace polyfem::solver
@@ -59,6 +68,10 @@ namespace polyfem::solver
 
 			// prints a Topological Sort of the complete graph
 			vector<int> topologicalSort();
+
+			// groups the vertices by their longest distance from a source,
+			// the vertices of a level only depend on the previous levels
+			vector<vector<int>> levels();
 		};
 
 		Graph::Graph(int V)
@@ -114,6 +127,60 @@ namespace polyfem::solver
 
 			return sorted;
 		}
+
+		vector<vector<int>> Graph::levels()
+		{
+			vector<int> level(V, 0);
+			vector<vector<int>> res;
+			for (const int v : topologicalSort())
+			{
+				for (const int w : adj[v])
+					level[w] = std::max(level[w], level[v] + 1);
+
+				if (level[v] >= res.size())
+					res.resize(level[v] + 1);
+				res[level[v]].push_back(v);
+			}
+
+			return res;
+		}
+
+		/// runs f on the given states concurrently, each with an equal share of the threads (NThread)
+		void run_states_in_parallel(const std::vector<int> &states, const std::function<void(int)> &f)
+		{
+			if (states.size() <= 1)
+			{
+				for (const int i : states)
+					f(i);
+				return;
+			}
+
+#ifdef POLYFEM_WITH_TBB
+			const int n_threads = std::max<int>(1, utils::NThread::get().num_threads() / states.size());
+			std::vector<std::unique_ptr<tbb::task_arena>> arenas(states.size());
+			for (auto &arena : arenas)
+				arena = std::make_unique<tbb::task_arena>(n_threads);
+
+			tbb::parallel_for(size_t(0), states.size(), [&](size_t k) {
+				arenas[k]->execute([&]() { f(states[k]); });
+			});
+#else
+			utils::maybe_parallel_for(states.size(), [&](int k) { f(states[k]); });
+#endif
+		}
+
+		/// orthonormal POD basis of the snapshots, see solver::pod_basis
+		Eigen::MatrixXd pod_basis(const std::deque<Eigen::VectorXd> &snapshots, const double energy_tolerance)
+		{
+			if (snapshots.empty())
+				return Eigen::MatrixXd();
+
+			Eigen::MatrixXd S(snapshots.front().size(), snapshots.size());
+			for (int i = 0; i < snapshots.size(); ++i)
+				S.col(i) = snapshots[i];
+
+			return solver::pod_basis(S, energy_tolerance);
+		}
 	} // namespace
 
 	AdjointNLProblem::AdjointNLProblem(std::shared_ptr<AdjointForm> form, const VariableToSimulationGroup &variables_to_simulation, const std::vector<std::shared_ptr<State>> &all_states, const json &args)
@@ -124,9 +191,16 @@ namespace polyfem::solver
 		  save_freq(args["output"]["save_frequency"]),
 		  enable_slim(args["solver"]["advanced"]["enable_slim"]),
 		  smooth_line_search(args["solver"]["advanced"]["smooth_line_search"]),
-		  solve_in_parallel(args["solver"]["advanced"]["solve_in_parallel"])
+		  solve_in_parallel(args["solver"]["advanced"]["solve_in_parallel"]),
+		  use_surrogate(args["solver"]["advanced"]["reduced_order_surrogate"]["enabled"]),
+		  surrogate_max_snapshots(args["solver"]["advanced"]["reduced_order_surrogate"]["max_snapshots"]),
+		  surrogate_energy_tolerance(args["solver"]["advanced"]["reduced_order_surrogate"]["energy_tolerance"]),
+		  surrogate_max_iterations(args["solver"]["advanced"]["reduced_order_surrogate"]["max_iterations"]),
+		  surrogate_tolerance(args["solver"]["advanced"]["reduced_order_surrogate"]["tolerance"])
 	{
 		cur_grad.setZero(0);
+		snapshots.resize(all_states.size());
+		reduced_bases.resize(all_states.size());
 
 		if (enable_slim && args["solver"]["nonlinear"]["advanced"]["apply_gradient_fd"] != "None")
 			adjoint_logger().warn("SLIM may affect the finite difference result!");
@@ -152,6 +226,7 @@ namespace polyfem::solver
 			}
 
 			solve_in_order = G.topologicalSort();
+			solve_levels = G.levels();
 		}
 
 		active_state_mask.assign(all_states_.size(), false);
@@ -181,14 +256,39 @@ namespace polyfem::solver
 		log_and_throw_adjoint_error("Hessian not supported!");
 	}
 
+	void AdjointNLProblem::apply_hessian(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out)
+	{
+		log_and_throw_adjoint_error("Hessian not supported!");
+	}
+
+	void AdjointNLProblem::value_gradient_hessian(const Eigen::VectorXd &x, double &value, Eigen::VectorXd &gradv, StiffnessMatrix &hessian)
+	{
+		log_and_throw_adjoint_error("Hessian not supported!");
+	}
+
 	double AdjointNLProblem::value(const Eigen::VectorXd &x)
 	{
-		return form_->value(x);
+		certify(x);
+
+		if (cur_val.has_value() && is_current(x))
+			return *cur_val;
+
+		const double val = form_->value(x);
+		if (is_current(x))
+			cur_val = val;
+		return val;
+	}
+
+	bool AdjointNLProblem::is_current(const Eigen::VectorXd &x) const
+	{
+		return curr_x.size() == x.size() && curr_x == x;
 	}
 
 	void AdjointNLProblem::gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv)
 	{
-		if (cur_grad.size() == x.size())
+		certify(x);
+
+		if (cur_grad.size() == x.size() && is_current(x))
 			gradv = cur_grad;
 		else
 		{
@@ -196,8 +296,23 @@ namespace polyfem::solver
 
 			{
 				POLYFEM_SCOPED_TIMER("adjoint solve");
+				std::vector<Eigen::MatrixXd> adjoint_rhs(all_states_.size());
 				for (int i = 0; i < all_states_.size(); i++)
-					all_states_[i]->solve_adjoint_cached(form_->compute_reduced_adjoint_rhs(x, *all_states_[i])); // caches inside state
+					adjoint_rhs[i] = form_->compute_reduced_adjoint_rhs(x, *all_states_[i]);
+
+				// the adjoint problems of different states are independent
+				const auto solve_adjoint = [&](int i) { all_states_[i]->solve_adjoint_cached(adjoint_rhs[i]); }; // caches inside state
+				if (solve_in_parallel)
+				{
+					std::vector<int> states(all_states_.size());
+					std::iota(states.begin(), states.end(), 0);
+					run_states_in_parallel(states, solve_adjoint);
+				}
+				else
+				{
+					for (int i = 0; i < all_states_.size(); i++)
+						solve_adjoint(i);
+				}
 			}
 
 			{
@@ -210,7 +325,8 @@ namespace polyfem::solver
 				}
 			}
 
-			cur_grad = gradv;
+			if (is_current(x))
+				cur_grad = gradv;
 		}
 	}
 
@@ -274,16 +390,22 @@ namespace polyfem::solver
 
 	void AdjointNLProblem::line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
 	{
+		in_line_search = use_surrogate;
 		form_->line_search_begin(x0, x1);
 	}
 
 	void AdjointNLProblem::line_search_end()
 	{
+		in_line_search = false;
 		form_->line_search_end();
 	}
 
 	void AdjointNLProblem::post_step(const polysolve::nonlinear::PostStepData &data)
 	{
+		certify(data.x);
+		if (use_surrogate)
+			update_reduced_bases();
+
 		save_to_file(save_iter++, data.x);
 
 		form_->post_step(data);
@@ -352,6 +474,12 @@ namespace polyfem::solver
 
 	void AdjointNLProblem::solution_changed(const Eigen::VectorXd &newX)
 	{
+		// the line search often evaluates the value and the gradient at the same x,
+		// the states, the forms and the cached value/gradient are still up to date
+		// (unless they come from the surrogate and the line search is over)
+		if (is_current(newX) && (!surrogate_solution || in_line_search))
+			return;
+
 		bool need_rebuild_basis = false;
 
 		// update to new parameter and check if the new parameter is valid to solve
@@ -362,10 +490,11 @@ namespace polyfem::solver
 				need_rebuild_basis = true;
 		}
 
+		// the topology does not change, only the geometry dependent quantities are recomputed
 		if (need_rebuild_basis)
 		{
 			for (const auto &state : all_states_)
-				state->build_basis();
+				state->update_geometry();
 		}
 
 		// solve PDE
@@ -414,48 +543,83 @@ namespace polyfem::solver
 		}
 		adjoint_logger().debug("SLIM succeeded!");
 
+		// the meshes no longer match any design vector
+		curr_x.resize(0);
+		cur_grad.resize(0);
+		cur_val.reset();
+
 		return true;
 	}
 
+	void AdjointNLProblem::certify(const Eigen::VectorXd &x)
+	{
+		if (!surrogate_solution || in_line_search || !is_current(x))
+			return;
+
+		adjoint_logger().debug("Certify the surrogate solution with a full solve");
+		solution_changed(x);
+	}
+
+	void AdjointNLProblem::update_reduced_bases()
+	{
+		for (int i = 0; i < all_states_.size(); i++)
+		{
+			const auto &state = all_states_[i];
+			if (!active_state_mask[i] || state->problem->is_time_dependent() || state->diff_cached.size() == 0)
+				continue;
+
+			snapshots[i].push_back(state->diff_cached.u(0));
+			while (snapshots[i].size() > surrogate_max_snapshots)
+				snapshots[i].pop_front();
+
+			reduced_bases[i] = pod_basis(snapshots[i], surrogate_energy_tolerance);
+			adjoint_logger().debug("Reduced basis of state {} has {} mode(s)", i, reduced_bases[i].cols());
+		}
+	}
+
 	void AdjointNLProblem::solve_pde()
 	{
+		// trial designs of the line search are solved with the reduced-order surrogate when possible
+		std::vector<char> used_surrogate(all_states_.size(), false);
+		const auto solve_state = [&](int i) {
+			auto state = all_states_[i];
+			state->assemble_rhs();
+			state->assemble_mass_mat();
+			Eigen::MatrixXd sol, pressure; // solution is also cached in state
+			if (in_line_search && reduced_bases[i].cols() > 0)
+				used_surrogate[i] = state->solve_reduced_order(reduced_bases[i], surrogate_max_iterations, surrogate_tolerance, sol);
+			if (!used_surrogate[i])
+				state->solve_problem(sol, pressure);
+		};
+
 		if (solve_in_parallel)
 		{
 			adjoint_logger().info("Run simulations in parallel...");
 
-			utils::maybe_parallel_for(all_states_.size(), [&](int start, int end, int thread_id) {
-				for (int i = start; i < end; i++)
-				{
-					auto state = all_states_[i];
-					if (active_state_mask[i] || state->diff_cached.size() == 0)
-					{
-						state->assemble_rhs();
-						state->assemble_mass_mat();
-						Eigen::MatrixXd sol, pressure; // solution is also cached in state
-						state->solve_problem(sol, pressure);
-					}
-				}
-			});
+			// states of the same level do not use each other as initial guess
+			for (const std::vector<int> &level : solve_levels)
+			{
+				std::vector<int> to_solve;
+				for (const int i : level)
+					if (active_state_mask[i] || all_states_[i]->diff_cached.size() == 0)
+						to_solve.push_back(i);
+
+				run_states_in_parallel(to_solve, solve_state);
+			}
 		}
 		else
 		{
 			adjoint_logger().info("Run simulations in serial...");
 
-			Eigen::MatrixXd sol, pressure; // solution is also cached in state
 			for (int i : solve_in_order)
-			{
-				auto state = all_states_[i];
-				if (active_state_mask[i] || state->diff_cached.size() == 0)
-				{
-					state->assemble_rhs();
-					state->assemble_mass_mat();
-
-					state->solve_problem(sol, pressure);
-				}
-			}
+				if (active_state_mask[i] || all_states_[i]->diff_cached.size() == 0)
+					solve_state(i);
 		}
 
+		surrogate_solution = std::find(used_surrogate.begin(), used_surrogate.end(), true) != used_surrogate.end();
+
 		cur_grad.resize(0);
+		cur_val.reset();
 	}
 
 	bool AdjointNLProblem::stop(const TVector &x)
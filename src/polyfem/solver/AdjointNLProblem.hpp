@@ -4,7 +4,9 @@
 #include <polyfem/Common.hpp>
 #include "FullNLProblem.hpp"
 #include <polyfem/solver/forms/adjoint_forms/VariableToSimulation.hpp>
+#include <deque>
 #include <fstream>
+#include <optional>
 
 namespace polyfem
 {
@@ -26,6 +28,8 @@ namespace polyfem::solver
 
 		void gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) override;
 		void hessian(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override;
+		void apply_hessian(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out) override;
+		void value_gradient_hessian(const Eigen::VectorXd &x, double &value, Eigen::VectorXd &gradv, StiffnessMatrix &hessian) override;
 		void save_to_file(const int iter_num, const Eigen::VectorXd &x0);
 		bool is_step_valid(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) override;
 		bool is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) override;
@@ -41,12 +45,20 @@ namespace polyfem::solver
 		void solve_pde();
 
 	private:
+		/// true if the states and forms were last updated at exactly x
+		bool is_current(const Eigen::VectorXd &x) const;
+		/// solves the states again in full if the ones at x come from the reduced-order surrogate
+		void certify(const Eigen::VectorXd &x);
+		/// adds the accepted solutions to the snapshots and rebuilds the reduced bases
+		void update_reduced_bases();
+
 		std::shared_ptr<AdjointForm> form_;
 		const VariableToSimulationGroup variables_to_simulation_;
 		std::vector<std::shared_ptr<State>> all_states_;
 		std::vector<bool> active_state_mask;
 		Eigen::VectorXd cur_grad;
-		Eigen::VectorXd curr_x;
+		std::optional<double> cur_val;
+		Eigen::VectorXd curr_x; // design of the last solution_changed, value and gradient are cached for it
 
 		const int save_freq;
 		std::ofstream solution_ostream;
@@ -56,9 +68,21 @@ namespace polyfem::solver
 
 		const bool solve_in_parallel;
 		std::vector<int> solve_in_order;
+		std::vector<std::vector<int>> solve_levels; // states grouped by dependency (initial guess) level, solved concurrently if solve_in_parallel
 
 		int save_iter = 0;
 
+		// reduced-order surrogate of the forward solves, only used for the line search trial designs
+		const bool use_surrogate;
+		const int surrogate_max_snapshots;
+		const double surrogate_energy_tolerance;
+		const int surrogate_max_iterations;
+		const double surrogate_tolerance;
+		std::vector<std::deque<Eigen::VectorXd>> snapshots; // accepted solutions of each state
+		std::vector<Eigen::MatrixXd> reduced_bases;         // POD basis of the snapshots of each state
+		bool in_line_search = false;
+		bool surrogate_solution = false; // some states at curr_x were solved with the surrogate
+
 		std::vector<std::shared_ptr<AdjointForm>> stopping_conditions_; // if all the stopping conditions are non-positive, stop the optimization
 	};
 } // namespace polyfem::solver
@@ -1,5 +1,7 @@
 #include "AdjointTools.hpp"
 
+#include <numeric>
+
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/io/Evaluator.hpp>
@@ -158,23 +160,23 @@ namespace polyfem::solver
 			return normal;
 		}
 
-		Eigen::MatrixXd extract_lame_params(const std::map<std::string, Assembler::ParamFunc> &lame_params, const int e, const int t, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts)
+		// Writes the lame parameters at the quadrature points into params, which is
+		// reused across elements so that the integration loops do not allocate.
+		void extract_lame_params(const std::map<std::string, Assembler::ParamFunc> &lame_params, const int e, const double t, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, Eigen::MatrixXd &params)
 		{
-			Eigen::MatrixXd params = Eigen::MatrixXd::Zero(local_pts.rows(), 2);
+			params.setZero(local_pts.rows(), 2);
 
 			auto search_lambda = lame_params.find("lambda");
 			auto search_mu = lame_params.find("mu");
 
 			if (search_lambda == lame_params.end() || search_mu == lame_params.end())
-				return params;
+				return;
 
 			for (int p = 0; p < local_pts.rows(); p++)
 			{
 				params(p, 0) = search_lambda->second(local_pts.row(p), pts.row(p), t, e);
 				params(p, 1) = search_mu->second(local_pts.row(p), pts.row(p), t, e);
 			}
-
-			return params;
 		}
 	} // namespace
 
@@ -192,6 +194,7 @@ namespace polyfem::solver
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
 		const int n_elements = int(bases.size());
+		const auto lame_functions = state.assembler->parameters();
 		const double t0 = state.problem->is_time_dependent() ? state.args["time"]["t0"].get<double>() : 0.0;
 		const double dt = state.problem->is_time_dependent() ? state.args["time"]["dt"].get<double>() : 0.0;
 
@@ -207,21 +210,20 @@ namespace polyfem::solver
 				params.step = cur_step;
 
 				Eigen::MatrixXd u, grad_u;
-				Eigen::MatrixXd result;
+				Eigen::MatrixXd result, lame_params;
 
 				for (int e = start; e < end; ++e)
 				{
 					if (interested_ids.size() != 0 && interested_ids.find(state.mesh->get_body_id(e)) == interested_ids.end())
 						continue;
 
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
+					const assembler::ElementAssemblyValues &vals = state.ass_vals_cache.get(e, state.mesh->is_volume(), bases[e], gbases[e], local_storage.vals);
 					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
-					const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, quadrature.points, vals.val);
+					extract_lame_params(lame_functions, e, params.t, quadrature.points, vals.val, lame_params);
 
 					params.elem = e;
 					params.body_id = state.mesh->get_body_id(e);
@@ -244,7 +246,7 @@ namespace polyfem::solver
 				Eigen::VectorXd weights;
 
 				Eigen::MatrixXd u, grad_u;
-				Eigen::MatrixXd result;
+				Eigen::MatrixXd result, lame_params;
 				IntegrableFunctional::ParameterType params;
 				params.t = dt * cur_step + t0;
 				params.step = cur_step;
@@ -266,7 +268,7 @@ namespace polyfem::solver
 						vals.compute(e, state.mesh->is_volume(), points, bases[e], gbases[e]);
 						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
 
-						const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, points, vals.val);
+						extract_lame_params(lame_functions, e, params.t, points, vals.val, lame_params);
 
 						params.elem = e;
 						params.body_id = state.mesh->get_body_id(e);
@@ -283,6 +285,7 @@ namespace polyfem::solver
 		else if (spatial_integral_type == SpatialIntegralType::VertexSum)
 		{
 			std::vector<bool> traversed(state.n_bases, false);
+			Eigen::MatrixXd lame_params;
 			IntegrableFunctional::ParameterType params;
 			params.t = dt * cur_step + t0;
 			params.step = cur_step;
@@ -297,7 +300,7 @@ namespace polyfem::solver
 					if (traversed[g.index])
 						continue;
 
-					const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, Eigen::MatrixXd::Zero(1, dim) /*Not used*/, g.node);
+					extract_lame_params(lame_functions, e, params.t, Eigen::MatrixXd::Zero(1, dim) /*Not used*/, g.node, lame_params);
 
 					params.node = g.index;
 					params.elem = e;
@@ -330,78 +333,93 @@ namespace polyfem::solver
 		const double dt = state.problem->is_time_dependent() ? state.args["time"]["dt"].get<double>() : 0.0;
 
 		const int n_elements = int(bases.size());
+		const auto lame_functions = state.assembler->parameters();
 		term.setZero(state.n_geom_bases * dim, 1);
 
-		auto storage = utils::create_thread_storage(LocalThreadVecStorage(term.size()));
+		// with a colouring, elements of the same colour do not share geometric nodes and scatter directly into term
+		const bool use_colors = spatial_integral_type == SpatialIntegralType::Volume && state.ass_vals_cache.has_element_colors(n_elements);
+		auto storage = utils::create_thread_storage(LocalThreadVecStorage(use_colors ? 0 : term.size()));
 
 		if (spatial_integral_type == SpatialIntegralType::Volume)
 		{
-			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			std::vector<std::vector<int>> all_elements;
+			if (!use_colors)
+			{
+				all_elements.emplace_back(n_elements);
+				std::iota(all_elements[0].begin(), all_elements[0].end(), 0);
+			}
+			const std::vector<std::vector<int>> &colors = use_colors ? state.ass_vals_cache.element_colors() : all_elements;
 
-				Eigen::MatrixXd u, grad_u, j_val, dj_dgradu, dj_dx;
+			for (const std::vector<int> &color : colors)
+			{
+				utils::maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+					Eigen::Ref<Eigen::VectorXd> vec = use_colors ? Eigen::Ref<Eigen::VectorXd>(term) : Eigen::Ref<Eigen::VectorXd>(local_storage.vec.col(0));
 
-				IntegrableFunctional::ParameterType params;
-				params.t = cur_time_step * dt + t0;
-				params.step = cur_time_step;
+					Eigen::MatrixXd u, grad_u, j_val, dj_dgradu, dj_dx, lame_params;
 
-				for (int e = start; e < end; ++e)
-				{
-					if (interested_ids.size() != 0 && interested_ids.find(state.mesh->get_body_id(e)) == interested_ids.end())
-						continue;
+					IntegrableFunctional::ParameterType params;
+					params.t = cur_time_step * dt + t0;
+					params.step = cur_time_step;
 
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
+					for (int k = start; k < end; ++k)
+					{
+						const int e = color[k];
+						if (interested_ids.size() != 0 && interested_ids.find(state.mesh->get_body_id(e)) == interested_ids.end())
+							continue;
 
-					assembler::ElementAssemblyValues gvals;
-					gvals.compute(e, state.mesh->is_volume(), vals.quadrature.points, gbases[e], gbases[e]);
+						const assembler::ElementAssemblyValues &vals = state.ass_vals_cache.get(e, state.mesh->is_volume(), bases[e], gbases[e], local_storage.vals);
+						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
 
-					const quadrature::Quadrature &quadrature = vals.quadrature;
-					local_storage.da = vals.det.array() * quadrature.weights.array();
+						assembler::ElementAssemblyValues gvals;
+						gvals.compute(e, state.mesh->is_volume(), vals.quadrature.points, gbases[e], gbases[e]);
 
-					const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, quadrature.points, vals.val);
+						const quadrature::Quadrature &quadrature = vals.quadrature;
+						local_storage.da = vals.det.array() * quadrature.weights.array();
 
-					params.elem = e;
-					params.body_id = state.mesh->get_body_id(e);
+						extract_lame_params(lame_functions, e, params.t, quadrature.points, vals.val, lame_params);
 
-					j.evaluate(lame_params, quadrature.points, vals.val, u, grad_u, Eigen::MatrixXd::Zero(0, 0) /*Not used*/, vals, params, j_val);
+						params.elem = e;
+						params.body_id = state.mesh->get_body_id(e);
 
-					if (j.depend_on_gradu())
-						j.dj_dgradu(lame_params, quadrature.points, vals.val, u, grad_u, Eigen::MatrixXd::Zero(0, 0) /*Not used*/, vals, params, dj_dgradu);
+						j.evaluate(lame_params, quadrature.points, vals.val, u, grad_u, Eigen::MatrixXd::Zero(0, 0) /*Not used*/, vals, params, j_val);
 
-					if (j.depend_on_x())
-						j.dj_dx(lame_params, quadrature.points, vals.val, u, grad_u, Eigen::MatrixXd::Zero(0, 0) /*Not used*/, vals, params, dj_dx);
+						if (j.depend_on_gradu())
+							j.dj_dgradu(lame_params, quadrature.points, vals.val, u, grad_u, Eigen::MatrixXd::Zero(0, 0) /*Not used*/, vals, params, dj_dgradu);
 
-					Eigen::MatrixXd tau_q, grad_u_q;
-					for (auto &v : gvals.basis_values)
-					{
-						for (int q = 0; q < local_storage.da.size(); ++q)
+						if (j.depend_on_x())
+							j.dj_dx(lame_params, quadrature.points, vals.val, u, grad_u, Eigen::MatrixXd::Zero(0, 0) /*Not used*/, vals, params, dj_dx);
+
+						Eigen::MatrixXd tau_q, grad_u_q;
+						for (auto &v : gvals.basis_values)
 						{
-							local_storage.vec.block(v.global[0].index * dim, 0, dim, 1) += (j_val(q) * local_storage.da(q)) * v.grad_t_m.row(q).transpose();
+							for (int q = 0; q < local_storage.da.size(); ++q)
+							{
+								vec.block(v.global[0].index * dim, 0, dim, 1) += (j_val(q) * local_storage.da(q)) * v.grad_t_m.row(q).transpose();
 
-							if (j.depend_on_x())
-								local_storage.vec.block(v.global[0].index * dim, 0, dim, 1) += (v.val(q) * local_storage.da(q)) * dj_dx.row(q).transpose();
+								if (j.depend_on_x())
+									vec.block(v.global[0].index * dim, 0, dim, 1) += (v.val(q) * local_storage.da(q)) * dj_dx.row(q).transpose();
 
-							if (j.depend_on_gradu())
-							{
-								if (dim == actual_dim) // Elasticity PDE
-								{
-									vector2matrix(dj_dgradu.row(q), tau_q);
-									vector2matrix(grad_u.row(q), grad_u_q);
-								}
-								else // Laplacian PDE
+								if (j.depend_on_gradu())
 								{
-									tau_q = dj_dgradu.row(q);
-									grad_u_q = grad_u.row(q);
+									if (dim == actual_dim) // Elasticity PDE
+									{
+										vector2matrix(dj_dgradu.row(q), tau_q);
+										vector2matrix(grad_u.row(q), grad_u_q);
+									}
+									else // Laplacian PDE
+									{
+										tau_q = dj_dgradu.row(q);
+										grad_u_q = grad_u.row(q);
+									}
+									for (int d = 0; d < dim; d++)
+										vec(v.global[0].index * dim + d) += -dot(tau_q, grad_u_q.col(d) * v.grad_t_m.row(q)) * local_storage.da(q);
 								}
-								for (int d = 0; d < dim; d++)
-									local_storage.vec(v.global[0].index * dim + d) += -dot(tau_q, grad_u_q.col(d) * v.grad_t_m.row(q)) * local_storage.da(q);
 							}
 						}
 					}
-				}
-			});
+				});
+			}
 		}
 		else if (spatial_integral_type == SpatialIntegralType::Surface)
 		{
@@ -411,7 +429,7 @@ namespace polyfem::solver
 				Eigen::MatrixXd uv, points, normal;
 				Eigen::VectorXd &weights = local_storage.da;
 
-				Eigen::MatrixXd u, grad_u, x, grad_x, j_val, dj_dgradu, dj_dgradx, dj_dx;
+				Eigen::MatrixXd u, grad_u, x, grad_x, j_val, dj_dgradu, dj_dgradx, dj_dx, lame_params;
 
 				IntegrableFunctional::ParameterType params;
 				params.t = cur_time_step * dt + t0;
@@ -440,7 +458,7 @@ namespace polyfem::solver
 
 						const int n_loc_bases_ = int(vals.basis_values.size());
 
-						const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, points, vals.val);
+						extract_lame_params(lame_functions, e, params.t, points, vals.val, lame_params);
 
 						params.elem = e;
 						params.body_id = state.mesh->get_body_id(e);
@@ -541,8 +559,11 @@ namespace polyfem::solver
 		{
 			log_and_throw_adjoint_error("Shape derivative of vertex sum type functional is not implemented!");
 		}
-		for (const LocalThreadVecStorage &local_storage : storage)
-			term += local_storage.vec;
+		if (!use_colors)
+		{
+			for (const LocalThreadVecStorage &local_storage : storage)
+				term += local_storage.vec;
+		}
 
 		term = utils::flatten(utils::unflatten(term, dim)(state.primitive_to_node(), Eigen::all));
 	}
@@ -1001,6 +1022,7 @@ namespace polyfem::solver
 
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
+		const auto lame_functions = state.assembler->parameters();
 		const int n_elements = int(bases.size());
 		const double t0 = state.problem->is_time_dependent() ? state.args["time"]["t0"].get<double>() : 0.0;
 		const double dt = state.problem->is_time_dependent() ? state.args["time"]["dt"].get<double>() : 0.0;
@@ -1017,7 +1039,7 @@ namespace polyfem::solver
 				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				Eigen::MatrixXd u, grad_u;
-				Eigen::MatrixXd lambda, mu;
+				Eigen::MatrixXd lambda, mu, lame_params;
 				Eigen::MatrixXd dj_du, dj_dgradu, dj_dgradx;
 
 				IntegrableFunctional::ParameterType params;
@@ -1029,13 +1051,12 @@ namespace polyfem::solver
 					if (interested_ids.size() != 0 && interested_ids.find(state.mesh->get_body_id(e)) == interested_ids.end())
 						continue;
 
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
+					const assembler::ElementAssemblyValues &vals = state.ass_vals_cache.get(e, state.mesh->is_volume(), bases[e], gbases[e], local_storage.vals);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
-					const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, quadrature.points, vals.val);
+					extract_lame_params(lame_functions, e, params.t, quadrature.points, vals.val, lame_params);
 
 					const int n_loc_bases_ = int(vals.basis_values.size());
 
@@ -1100,7 +1121,7 @@ namespace polyfem::solver
 				Eigen::VectorXd weights;
 
 				Eigen::MatrixXd u, grad_u;
-				Eigen::MatrixXd lambda, mu;
+				Eigen::MatrixXd lambda, mu, lame_params;
 				Eigen::MatrixXd dj_du, dj_dgradu, dj_dgradu_local;
 
 				IntegrableFunctional::ParameterType params;
@@ -1124,7 +1145,7 @@ namespace polyfem::solver
 						vals.compute(e, state.mesh->is_volume(), points, bases[e], gbases[e]);
 						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
 
-						const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, points, vals.val);
+						extract_lame_params(lame_functions, e, params.t, points, vals.val, lame_params);
 
 						// normal = normal * vals.jac_it[0]; // assuming linear geometry
 
@@ -1201,6 +1222,7 @@ namespace polyfem::solver
 		else if (spatial_integral_type == SpatialIntegralType::VertexSum)
 		{
 			std::vector<bool> traversed(state.n_bases, false);
+			Eigen::MatrixXd lame_params;
 			IntegrableFunctional::ParameterType params;
 			params.t = dt * cur_step + t0;
 			params.step = cur_step;
@@ -1215,7 +1237,7 @@ namespace polyfem::solver
 					if (traversed[g.index])
 						continue;
 
-					const Eigen::MatrixXd lame_params = extract_lame_params(state.assembler->parameters(), e, params.t, Eigen::MatrixXd::Zero(1, dim) /*Not used*/, g.node);
+					extract_lame_params(lame_functions, e, params.t, Eigen::MatrixXd::Zero(1, dim) /*Not used*/, g.node, lame_params);
 
 					params.node = g.index;
 					params.elem = e;
@@ -0,0 +1,106 @@
+#include "DiffCache.hpp"
+
+#include <polyfem/io/MatrixIO.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+namespace polyfem::solver
+{
+	namespace
+	{
+		std::string jacobian_key(const int step)
+		{
+			return "gradu_h_" + std::to_string(step);
+		}
+	} // namespace
+
+	void DiffCache::cache_jacobian(const int step, const StiffnessMatrix &gradu_h)
+	{
+		gradu_h_[step] = gradu_h;
+		spilled_[step] = false;
+		if (loaded_step_ == step)
+			loaded_step_ = -1;
+
+		if (max_jacobians_in_memory_ < 0 || spill_path_.empty())
+			return;
+
+		jacobians_in_memory_.push_back(step);
+		while (jacobians_in_memory_.size() > max_jacobians_in_memory_)
+		{
+			const int oldest = jacobians_in_memory_.front();
+			jacobians_in_memory_.pop_front();
+
+			if (!io::write_sparse_matrix(spill_path_, jacobian_key(oldest), gradu_h_[oldest], /*replace=*/!has_spill_file_))
+				log_and_throw_error("Failed to spill the force Jacobian of step {} to {}", oldest, spill_path_);
+			has_spill_file_ = true;
+
+			gradu_h_[oldest] = StiffnessMatrix();
+			spilled_[oldest] = true;
+		}
+	}
+
+	const StiffnessMatrix &DiffCache::load_jacobian(const int step) const
+	{
+		assert(spilled_[step]);
+		if (loaded_step_ != step)
+		{
+			if (!io::read_sparse_matrix(spill_path_, jacobian_key(step), loaded_gradu_h_))
+				log_and_throw_error("Failed to read the force Jacobian of step {} from {}", step, spill_path_);
+			loaded_step_ = step;
+		}
+		return loaded_gradu_h_;
+	}
+
+	size_t DiffCache::memory_bytes() const
+	{
+		size_t bytes = utils::memory_bytes(disp_grad_) + utils::memory_bytes(u_) + utils::memory_bytes(v_) + utils::memory_bytes(acc_);
+		bytes += utils::memory_bytes(bdf_order_) + utils::memory_bytes(gradu_h_) + utils::memory_bytes(loaded_gradu_h_);
+		bytes += utils::memory_bytes(spilled_) + utils::memory_bytes(adjoint_mat_);
+		bytes += utils::memory_bytes(static_adjoint_outer_) + utils::memory_bytes(static_adjoint_inner_);
+		bytes += collision_set_.capacity() * sizeof(ipc::Collisions) + friction_collision_set_.capacity() * sizeof(ipc::FrictionCollisions);
+		for (const auto &c : collision_set_)
+			bytes += utils::collisions_memory_bytes(c);
+		for (const auto &c : friction_collision_set_)
+			bytes += utils::collisions_memory_bytes(c);
+		return bytes;
+	}
+
+	polysolve::linear::Solver &DiffCache::static_adjoint_solver(const json &params, spdlog::logger &logger) const
+	{
+		using IndexVector = Eigen::Matrix<StiffnessMatrix::StorageIndex, Eigen::Dynamic, 1>;
+
+		StiffnessMatrix A = gradu_h_[0];
+		A.makeCompressed();
+
+		const IndexVector outer = Eigen::Map<const IndexVector>(A.outerIndexPtr(), A.outerSize() + 1);
+		const IndexVector inner = Eigen::Map<const IndexVector>(A.innerIndexPtr(), A.nonZeros());
+		const bool same_pattern = static_adjoint_solver_ && outer == static_adjoint_outer_ && inner == static_adjoint_inner_;
+
+		if (same_pattern && static_adjoint_factorized_)
+			return *static_adjoint_solver_;
+
+		if (!same_pattern)
+		{
+			// A new pattern only needs a new analysis, the solver instance (and any device state it holds) is kept
+			if (!static_adjoint_solver_)
+				static_adjoint_solver_ = polysolve::linear::Solver::create(params, logger);
+			static_adjoint_solver_->analyze_pattern(A, A.rows());
+			static_adjoint_outer_ = outer;
+			static_adjoint_inner_ = inner;
+		}
+
+		static_adjoint_solver_->factorize(A);
+		static_adjoint_factorized_ = true;
+
+		return *static_adjoint_solver_;
+	}
+
+	polysolve::linear::Solver &DiffCache::transient_adjoint_solver(const json &params, spdlog::logger &logger) const
+	{
+		if (!transient_adjoint_solver_)
+			transient_adjoint_solver_ = polysolve::linear::Solver::create(params, logger);
+		return *transient_adjoint_solver_;
+	}
+} // namespace polyfem::solver
@@ -6,6 +6,20 @@
 #include <ipc/collisions/collisions.hpp>
 #include <ipc/friction/friction_collisions.hpp>
 
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace spdlog
+{
+	class logger;
+}
+
+namespace polysolve::linear
+{
+	class Solver;
+}
+
 namespace polyfem::solver
 {
 	enum class CacheLevel
@@ -18,8 +32,20 @@ namespace polyfem::solver
 	class DiffCache
 	{
 	public:
+		/// Bounds the number of force Jacobians kept in memory in transient simulations,
+		/// the oldest ones are spilled to a hdf5 file and read back by the adjoint sweep
+		/// (which consumes them from the last step to the first)
+		/// @param[in] max_in_memory maximum number of Jacobians in memory, negative for no limit
+		/// @param[in] spill_path hdf5 file receiving the spilled Jacobians, required if max_in_memory >= 0
+		void set_jacobian_storage(const int max_in_memory, const std::string &spill_path)
+		{
+			max_jacobians_in_memory_ = max_in_memory;
+			spill_path_ = spill_path;
+		}
+
 		void init(const int dimension, const int ndof, const int n_time_steps = 0)
 		{
+			++version_;
 			cur_size_ = 0;
 			n_time_steps_ = n_time_steps;
 
@@ -32,7 +58,11 @@ namespace polyfem::solver
 				acc_.setZero(ndof, n_time_steps + 1);
 				// gradu_h_prev_.resize(n_time_steps + 1);
 			}
-			gradu_h_.resize(n_time_steps + 1);
+			gradu_h_.assign(n_time_steps + 1, StiffnessMatrix());
+			spilled_.assign(n_time_steps + 1, false);
+			jacobians_in_memory_.clear();
+			loaded_step_ = -1;
+			has_spill_file_ = false;
 			collision_set_.resize(n_time_steps + 1);
  			friction_collision_set_.resize(n_time_steps + 1);
 		}
@@ -47,11 +77,13 @@ namespace polyfem::solver
             u_ = u;
 
             gradu_h_[0] = gradu_h;
+            static_adjoint_factorized_ = false;
             collision_set_[0] = contact_set;
             friction_collision_set_[0] = friction_constraint_set;
             disp_grad_[0] = disp_grad;
 
 			cur_size_ = 1;
+			++version_;
 		}
 
 		void cache_quantities_transient(
@@ -71,13 +103,14 @@ namespace polyfem::solver
 			v_.col(cur_step) = v;
 			acc_.col(cur_step) = acc;
 
-			gradu_h_[cur_step] = gradu_h;
+			cache_jacobian(cur_step, gradu_h);
 			// gradu_h_prev_[cur_step] = gradu_h_prev;
 
 			collision_set_[cur_step] = collision_set;
 			friction_collision_set_[cur_step] = friction_collision_set;
 
 			cur_size_++;
+			++version_;
 		}
 
         void cache_quantities_quasistatic(
@@ -88,17 +121,37 @@ namespace polyfem::solver
             const Eigen::MatrixXd &disp_grad)
         {
             u_.col(cur_step) = u;
-            gradu_h_[cur_step] = gradu_h;
+            cache_jacobian(cur_step, gradu_h);
             collision_set_[cur_step] = contact_set;
             disp_grad_[cur_step] = disp_grad;
 
             cur_size_++;
+            ++version_;
         }
 
+		/// Linear solver factorized with gradu_h(0), for the static adjoint solves.
+		/// The factorization is kept until the static quantities are cached again and the
+		/// symbolic analysis as long as the sparsity pattern of gradu_h(0) does not change,
+		/// so repeated adjoint solves and optimization iterations on a fixed mesh only refactorize.
+		/// @param[in] params linear solver parameters (solver/adjoint_linear)
+		/// @param[in] logger logger of the solver
+		polysolve::linear::Solver &static_adjoint_solver(const json &params, spdlog::logger &logger) const;
+
+		/// Linear solver for the transient adjoint steps, created once and reused for every time step
+		/// and every later adjoint solve, so backends with an expensive setup (e.g. GPU solvers) pay it once.
+		/// Each step still analyzes and factorizes its own matrix.
+		/// @param[in] params linear solver parameters (solver/adjoint_linear)
+		/// @param[in] logger logger of the solver
+		polysolve::linear::Solver &transient_adjoint_solver(const json &params, spdlog::logger &logger) const;
+
 		void cache_adjoints(const Eigen::MatrixXd &adjoint_mat) { adjoint_mat_ = adjoint_mat; }
 		const Eigen::MatrixXd &adjoint_mat() const { return adjoint_mat_; }
 
 		inline int size() const { return cur_size_; }
+		/// heap memory of the cached quantities in bytes, the spilled Jacobians are not counted
+		size_t memory_bytes() const;
+		/// changes every time cached quantities change, used to validate values derived from them
+		inline size_t version() const { return version_; }
 		inline int bdf_order(int step) const
 		{
 			assert(step < size());
@@ -136,6 +189,8 @@ namespace polyfem::solver
 			assert(step < size());
 			if (step < 0)
 				step += gradu_h_.size();
+			if (spilled_[step])
+				return load_jacobian(step);
 			return gradu_h_[step];
 		}
 		// const StiffnessMatrix &gradu_h_prev(const int step) const { assert(step < size()); return gradu_h_prev_[step]; }
@@ -156,8 +211,14 @@ namespace polyfem::solver
 		}
 
 	private:
+		/// stores the Jacobian of a step, spilling the oldest one in memory if over budget
+		void cache_jacobian(const int step, const StiffnessMatrix &gradu_h);
+		/// reads back a spilled Jacobian, the last one read is kept
+		const StiffnessMatrix &load_jacobian(const int step) const;
+
 		int n_time_steps_ = 0;
 		int cur_size_ = 0;
+		size_t version_ = 0;
 
         std::vector<Eigen::MatrixXd> disp_grad_; // macro linear displacement in homogenization
 		Eigen::MatrixXd u_;   // PDE solution
@@ -167,11 +228,24 @@ namespace polyfem::solver
 		Eigen::VectorXi bdf_order_; // BDF orders used at each time step in forward simulation
 
 		std::vector<StiffnessMatrix> gradu_h_; // gradient of force at time T wrt. u  at time T
+
+		int max_jacobians_in_memory_ = -1;
+		std::string spill_path_;
+		bool has_spill_file_ = false;
+		std::vector<bool> spilled_;          // gradu_h_ of these steps is in the spill file
+		std::deque<int> jacobians_in_memory_; // steps whose gradu_h_ is in memory, oldest first
+		mutable int loaded_step_ = -1;
+		mutable StiffnessMatrix loaded_gradu_h_;
 		// std::vector<StiffnessMatrix> gradu_h_prev_; // gradient of force at time T wrt. u at time (T-1) in transient simulations
 
 		std::vector<ipc::Collisions> collision_set_;
 		std::vector<ipc::FrictionCollisions> friction_collision_set_;
 
 		Eigen::MatrixXd adjoint_mat_;
+
+		mutable std::shared_ptr<polysolve::linear::Solver> static_adjoint_solver_;
+		mutable std::shared_ptr<polysolve::linear::Solver> transient_adjoint_solver_;
+		mutable bool static_adjoint_factorized_ = false;
+		mutable Eigen::Matrix<StiffnessMatrix::StorageIndex, Eigen::Dynamic, 1> static_adjoint_outer_, static_adjoint_inner_;
 	};
 } // namespace polyfem::solver
\ No newline at end of file
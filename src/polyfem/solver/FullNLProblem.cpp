@@ -1,5 +1,12 @@
 #include "FullNLProblem.hpp"
 
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/TaskGraph.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace polyfem::solver
 {
 	FullNLProblem::FullNLProblem(const std::vector<std::shared_ptr<Form>> &forms)
@@ -9,26 +16,106 @@ namespace polyfem::solver
 
 	void FullNLProblem::init(const TVector &x)
 	{
+		reset_hessian_pattern();
+		reset_constant_hessian();
+		reinit(x);
+	}
+
+	void FullNLProblem::reinit(const TVector &x)
+	{
+		prev_grad_norm_ = -1;
+		new_iterate_ = true;
+		fused_hessian_x_.resize(0);
 		for (auto &f : forms_)
 			f->init(x);
 	}
 
+	void FullNLProblem::set_fused_assembly(const bool fused)
+	{
+		fused_assembly_ = fused;
+		fused_hessian_x_.resize(0);
+		fused_hessian_ = THessian();
+	}
+
+	std::vector<double> FullNLProblem::form_weights() const
+	{
+		std::vector<double> weights(forms_.size());
+		for (size_t i = 0; i < forms_.size(); ++i)
+			weights[i] = forms_[i]->enabled() ? forms_[i]->weight() : 0;
+		return weights;
+	}
+
 	void FullNLProblem::set_project_to_psd(bool project_to_psd)
 	{
+		// the kept hessian was assembled with the other projection
+		if (project_to_psd != project_to_psd_)
+			fused_hessian_x_.resize(0);
+		project_to_psd_ = project_to_psd;
 		for (auto &f : forms_)
 			f->set_project_to_psd(project_to_psd);
 	}
 
 	void FullNLProblem::init_lagging(const TVector &x)
 	{
-		for (auto &f : forms_)
-			f->init_lagging(x);
+		reset_constant_hessian();
+		// the values of the lagged forms change with the lagged quantities
+		form_values_x_.resize(0);
+		for_each_form([&](const size_t i) { forms_[i]->init_lagging(x); }, nullptr, /*enabled_only=*/false);
 	}
 
 	void FullNLProblem::update_lagging(const TVector &x, const int iter_num)
 	{
-		for (auto &f : forms_)
-			f->update_lagging(x, iter_num);
+		reset_constant_hessian();
+		form_values_x_.resize(0);
+		for_each_form([&](const size_t i) { forms_[i]->update_lagging(x, iter_num); }, nullptr, /*enabled_only=*/false);
+	}
+
+	void FullNLProblem::for_each_form(const std::function<void(const size_t)> &evaluate, const std::function<void(const size_t)> &reduce, const bool enabled_only)
+	{
+		if (!concurrent_forms_)
+		{
+			for (size_t i = 0; i < forms_.size(); ++i)
+			{
+				if (enabled_only && !forms_[i]->enabled())
+					continue;
+				evaluate(i);
+				if (reduce)
+					reduce(i);
+			}
+			return;
+		}
+
+		// the tasks only read the timings, resize them before
+		if (!forms_.empty())
+			timings(forms_.size() - 1);
+
+		const auto depends = [&](const size_t i, const size_t j) {
+			const std::vector<const Form *> deps = forms_[i]->dependencies();
+			return std::find(deps.begin(), deps.end(), forms_[j].get()) != deps.end();
+		};
+
+		utils::TaskGraph graph;
+		std::vector<int> task_ids(forms_.size(), -1);
+		for (size_t i = 0; i < forms_.size(); ++i)
+		{
+			if (enabled_only && !forms_[i]->enabled())
+				continue;
+
+			// a form and the forms it uses are evaluated one after the other
+			std::vector<int> dependencies;
+			for (size_t j = 0; j < i; ++j)
+				if (task_ids[j] >= 0 && (depends(i, j) || depends(j, i)))
+					dependencies.push_back(task_ids[j]);
+
+			task_ids[i] = graph.add([&evaluate, i] { evaluate(i); }, dependencies);
+		}
+		graph.run();
+
+		// the results are summed in the order of the forms, as without the tasks
+		if (reduce)
+			for (size_t i = 0; i < forms_.size(); ++i)
+				if (task_ids[i] >= 0)
+					reduce(i);
 	}
 
 	int FullNLProblem::max_lagging_iterations() const
@@ -51,12 +138,62 @@ namespace polyfem::solver
 	{
 		for (auto &f : forms_)
 			f->line_search_begin(x0, x1);
+
+		line_search_polynomials_.clear();
+		if (std::none_of(forms_.begin(), forms_.end(), [](const auto &f) { return f->enabled() && f->is_hessian_constant(); }))
+			return;
+
+		line_search_x0_ = x0;
+		line_search_dir_ = x1 - x0;
+		if (line_search_dir_.squaredNorm() == 0)
+			return;
+
+		// a quadratic is defined by its values at 0, 1/2, and 1
+		const TVector x_mid = x0 + 0.5 * line_search_dir_;
+		line_search_polynomials_.assign(forms_.size(), Eigen::Vector3d::Constant(std::numeric_limits<double>::quiet_NaN()));
+		line_search_weights_.assign(forms_.size(), 0);
+		for (size_t i = 0; i < forms_.size(); ++i)
+		{
+			if (!forms_[i]->enabled() || !forms_[i]->is_hessian_constant())
+				continue;
+
+			POLYFEM_SCOPED_TIMER(timings(i).value);
+			double f0;
+			if (!kept_form_value(i, x0, f0))
+				f0 = forms_[i]->value(x0);
+			const double f_mid = forms_[i]->value(x_mid);
+			const double f1 = forms_[i]->value(x1);
+
+			line_search_polynomials_[i] << f0, 4 * f_mid - 3 * f0 - f1, 2 * f1 - 4 * f_mid + 2 * f0;
+			line_search_weights_[i] = forms_[i]->weight();
+		}
 	}
 
 	void FullNLProblem::line_search_end()
 	{
 		for (auto &f : forms_)
 			f->line_search_end();
+
+		line_search_polynomials_.clear();
+	}
+
+	bool FullNLProblem::line_search_step(const TVector &x, double &step) const
+	{
+		if (x.size() != line_search_x0_.size())
+			return false;
+
+		const double dir_norm2 = line_search_dir_.squaredNorm();
+		double dot = 0;
+		for (Eigen::Index k = 0; k < x.size(); ++k)
+			dot += (x[k] - line_search_x0_[k]) * line_search_dir_[k];
+		step = dot / dir_norm2;
+
+		// x = x0 + step * dir up to the rounding of the line search (the trial points are computed from its own direction)
+		const double tol = 1e-12 * std::max({1.0, line_search_x0_.lpNorm<Eigen::Infinity>(), x.lpNorm<Eigen::Infinity>()});
+		for (Eigen::Index k = 0; k < x.size(); ++k)
+			if (std::abs(x[k] - line_search_x0_[k] - step * line_search_dir_[k]) > tol)
+				return false;
+		return true;
 	}
 
 	double FullNLProblem::max_step_size(const TVector &x0, const TVector &x1)
@@ -86,47 +223,432 @@ namespace polyfem::solver
 
 	double FullNLProblem::value(const TVector &x)
 	{
+		double step = 0;
+		const bool on_line_search = !line_search_polynomials_.empty() && line_search_step(x, step);
+
 		double val = 0;
-		for (auto &f : forms_)
-			if (f->enabled())
-				val += f->value(x);
+		std::vector<double> values(forms_.size());
+		for_each_form(
+			[&](const size_t i) {
+				if (on_line_search && !std::isnan(line_search_polynomials_[i][0]) && line_search_weights_[i] == forms_[i]->weight())
+				{
+					const Eigen::Vector3d &p = line_search_polynomials_[i];
+					values[i] = p[0] + step * (p[1] + step * p[2]);
+					return;
+				}
+				POLYFEM_SCOPED_TIMER(timings(i).value);
+				values[i] = forms_[i]->value(x);
+			},
+			[&](const size_t i) {
+				val += values[i];
+				keep_form_value(i, x, values[i]);
+			});
 		return val;
 	}
 
 	void FullNLProblem::gradient(const TVector &x, TVector &grad)
 	{
+		const bool fuse = fused_assembly_ && new_iterate_ && hessian_asked_;
+		if (new_iterate_)
+			hessian_asked_ = false;
+		new_iterate_ = false;
+		if (fuse)
+		{
+			// the hessian at x is asked next, assembled in the same sweep
+			double value;
+			FullNLProblem::value_gradient_hessian(x, value, grad, fused_hessian_);
+			fused_hessian_x_ = x;
+			fused_hessian_weights_ = form_weights();
+			return;
+		}
+
 		grad = TVector::Zero(x.size());
-		for (auto &f : forms_)
+		std::vector<TVector> grads(forms_.size());
+		for_each_form(
+			[&](const size_t i) {
+				POLYFEM_SCOPED_TIMER(timings(i).gradient);
+				forms_[i]->first_derivative(x, grads[i]);
+			},
+			[&](const size_t i) {
+				grad += grads[i];
+				keep_form_gradient(i, x, grads[i]);
+				grads[i].resize(0);
+			});
+	}
+
+	void FullNLProblem::keep_form_gradient(const size_t i, const TVector &x, const TVector &grad)
+	{
+		if (form_gradients_x_.size() != x.size() || form_gradients_x_ != x)
+		{
+			form_gradients_x_ = x;
+			form_gradients_.assign(forms_.size(), TVector());
+			form_gradients_weight_.assign(forms_.size(), 0);
+		}
+		form_gradients_[i] = grad;
+		form_gradients_weight_[i] = forms_[i]->weight();
+	}
+
+	void FullNLProblem::reset_form_evaluations()
+	{
+		form_gradients_x_.resize(0);
+		form_gradients_.clear();
+		form_gradients_weight_.clear();
+		form_values_x_.resize(0);
+		form_values_.clear();
+		form_values_weight_.clear();
+	}
+
+	void FullNLProblem::form_gradient(const Form &f, const TVector &x, TVector &grad) const
+	{
+		if (form_gradients_x_.size() == x.size() && form_gradients_x_ == x)
+		{
+			for (size_t i = 0; i < forms_.size(); ++i)
+			{
+				if (forms_[i].get() != &f)
+					continue;
+				// the weight (e.g., dt for the inertia) can change without x changing
+				if (form_gradients_[i].size() == x.size() && form_gradients_weight_[i] == f.weight())
+				{
+					grad = form_gradients_[i];
+					return;
+				}
+				break;
+			}
+		}
+
+		f.first_derivative(x, grad);
+	}
+
+	void FullNLProblem::keep_form_value(const size_t i, const TVector &x, const double value)
+	{
+		if (form_values_x_.size() != x.size() || form_values_x_ != x)
+		{
+			form_values_x_ = x;
+			form_values_.assign(forms_.size(), std::numeric_limits<double>::quiet_NaN());
+			form_values_weight_.assign(forms_.size(), 0);
+		}
+		form_values_[i] = value;
+		form_values_weight_[i] = forms_[i]->weight();
+	}
+
+	bool FullNLProblem::kept_form_value(const size_t i, const TVector &x, double &value) const
+	{
+		if (form_values_x_.size() != x.size() || form_values_x_ != x || i >= form_values_.size())
+			return false;
+		// the weight (e.g., the barrier stiffness) can change without x changing
+		if (std::isnan(form_values_[i]) || form_values_weight_[i] != forms_[i]->weight())
+			return false;
+		value = form_values_[i];
+		return true;
+	}
+
+	double FullNLProblem::form_value(const Form &f, const TVector &x) const
+	{
+		for (size_t i = 0; i < forms_.size(); ++i)
+		{
+			double value;
+			if (forms_[i].get() == &f && kept_form_value(i, x, value))
+				return value;
+		}
+		return f.value(x);
+	}
+
+	double FullNLProblem::kept_value(const TVector &x) const
+	{
+		double val = 0;
+		for (size_t i = 0; i < forms_.size(); ++i)
 		{
-			if (!f->enabled())
+			if (!forms_[i]->enabled())
 				continue;
-			TVector tmp;
-			f->first_derivative(x, tmp);
-			grad += tmp;
+			double value;
+			val += kept_form_value(i, x, value) ? value : forms_[i]->value(x);
+		}
+		return val;
+	}
+
+	void FullNLProblem::add_to_hessian(const THessian &form_hessian, THessian &hessian)
+	{
+		if (!utils::add_to_pattern(form_hessian, hessian))
+		{
+			hessian += form_hessian;
+			hessian.makeCompressed();
+		}
+	}
+
+	void FullNLProblem::add_constant_hessian(const TVector &x, THessian &hessian)
+	{
+		// the static hessians (e.g., a linear elastic stiffness) are summed once for the whole simulation
+		sum_constant_hessian(x, /*is_static=*/true, static_hessian_);
+		sum_constant_hessian(x, /*is_static=*/false, constant_hessian_);
+
+		if (static_hessian_.hessian.nonZeros() > 0)
+			add_to_hessian(static_hessian_.hessian, hessian);
+		if (constant_hessian_.hessian.nonZeros() > 0)
+			add_to_hessian(constant_hessian_.hessian, hessian);
+	}
+
+	void FullNLProblem::sum_constant_hessian(const TVector &x, const bool is_static, ConstantHessian &sum)
+	{
+		std::vector<double> weights(forms_.size(), 0);
+		for (size_t i = 0; i < forms_.size(); ++i)
+			if (forms_[i]->enabled() && is_constant(i) && forms_[i]->is_hessian_static() == is_static)
+				weights[i] = forms_[i]->weight();
+
+		// same forms with other weights (e.g., the penalty of the augmented Lagrangian), only the difference of the
+		// changed forms is added
+		bool same_forms = sum.weights.size() == weights.size() && sum.hessian.rows() == x.size();
+		for (size_t i = 0; same_forms && i < forms_.size(); ++i)
+			same_forms = (weights[i] == 0) == (sum.weights[i] == 0);
+
+		if (same_forms && weights != sum.weights)
+		{
+			for (size_t i = 0; i < forms_.size(); ++i)
+			{
+				if (weights[i] == sum.weights[i])
+					continue;
+				POLYFEM_SCOPED_TIMER(timings(i).hessian);
+				THessian tmp;
+				forms_[i]->second_derivative(x, tmp);
+				const double scale = (weights[i] - sum.weights[i]) / weights[i];
+				if (!utils::add_to_pattern(tmp, sum.hessian, scale))
+				{
+					sum.hessian += scale * tmp;
+					sum.hessian.makeCompressed();
+				}
+			}
+			sum.weights = weights;
+		}
+		else if (!same_forms)
+		{
+			sum.hessian.resize(x.size(), x.size());
+			sum.hessian.makeCompressed();
+			for (size_t i = 0; i < forms_.size(); ++i)
+			{
+				if (weights[i] == 0)
+					continue;
+				POLYFEM_SCOPED_TIMER(timings(i).hessian);
+				forms_[i]->add_second_derivative(x, sum.hessian);
+			}
+			sum.weights = weights;
 		}
 	}
 
 	void FullNLProblem::hessian(const TVector &x, THessian &hessian)
 	{
-		hessian.resize(x.size(), x.size());
-		for (auto &f : forms_)
+		hessian_asked_ = true;
+		if (fused_hessian_x_.size() == x.size() && fused_hessian_x_ == x && fused_hessian_weights_ == form_weights())
 		{
-			if (!f->enabled())
-				continue;
-			THessian tmp;
-			f->second_derivative(x, tmp);
-			hessian += tmp;
+			hessian = std::move(fused_hessian_);
+			fused_hessian_ = THessian();
+			fused_hessian_x_.resize(0);
+			return;
+		}
+
+		// the kept pattern is reused so that adding the form hessians does not allocate or sort
+		if (hessian_pattern_.rows() != x.size())
+			hessian_pattern_.resize(x.size(), x.size());
+		hessian_pattern_.makeCompressed();
+		hessian_pattern_.coeffs().setZero();
+		add_constant_hessian(x, hessian_pattern_);
+
+		const bool reuse = begin_frozen_hessian(x.size());
+		std::vector<THessian> hessians(forms_.size());
+		for_each_form(
+			[&](const size_t i) {
+				if (is_constant(i))
+					return;
+				if (is_frozen(i))
+				{
+					frozen_hessian(i, x, reuse);
+					return;
+				}
+				POLYFEM_SCOPED_TIMER(timings(i).hessian);
+				forms_[i]->second_derivative(x, hessians[i]);
+			},
+			[&](const size_t i) {
+				if (!is_constant(i))
+					add_to_hessian(is_frozen(i) ? frozen_hessians_[i] : hessians[i], hessian_pattern_);
+				hessians[i] = THessian();
+			});
+
+		hessian = hessian_pattern_;
+	}
+
+	void FullNLProblem::set_frozen_hessian(const int iterations, const double refresh_ratio, const std::vector<std::shared_ptr<Form>> &forms)
+	{
+		frozen_hessian_iterations_ = iterations;
+		frozen_hessian_refresh_ratio_ = refresh_ratio;
+		frozen_forms_.assign(forms_.size(), false);
+		for (size_t i = 0; i < forms_.size(); ++i)
+			frozen_forms_[i] = iterations > 1 && std::find(forms.begin(), forms.end(), forms_[i]) != forms.end();
+		frozen_hessians_.assign(forms_.size(), THessian());
+		frozen_hessian_weights_.assign(forms_.size(), 0);
+		frozen_hessian_refresh_ = true;
+	}
+
+	void FullNLProblem::track_convergence(const double grad_norm)
+	{
+		// the frozen hessians slow down the convergence, assemble them again if it gets too slow
+		if (prev_grad_norm_ > 0 && grad_norm > frozen_hessian_refresh_ratio_ * prev_grad_norm_)
+			frozen_hessian_refresh_ = true;
+
+		prev_grad_norm_ = grad_norm;
+	}
+
+	bool FullNLProblem::begin_frozen_hessian(const int size)
+	{
+		bool reuse = !frozen_hessian_refresh_ && frozen_hessian_age_ < frozen_hessian_iterations_;
+		for (size_t i = 0; reuse && i < forms_.size(); ++i)
+			reuse = !is_frozen(i) || (frozen_hessians_[i].rows() == size && frozen_hessian_weights_[i] != 0);
+
+		if (reuse)
+		{
+			++frozen_hessian_age_;
+			// the weights change without the frozen hessians changing (e.g., with the time step of adaptive runs)
+			for (size_t i = 0; i < forms_.size(); ++i)
+			{
+				if (is_frozen(i) && forms_[i]->weight() != frozen_hessian_weights_[i])
+				{
+					frozen_hessians_[i] *= forms_[i]->weight() / frozen_hessian_weights_[i];
+					frozen_hessian_weights_[i] = forms_[i]->weight();
+				}
+			}
+		}
+		else
+		{
+			frozen_hessian_age_ = 1;
+			frozen_hessian_refresh_ = false;
+			// assembled in this evaluation
+			for (size_t i = 0; i < forms_.size(); ++i)
+				if (is_frozen(i))
+					frozen_hessian_weights_[i] = forms_[i]->weight();
 		}
+		return reuse;
+	}
+
+	const FullNLProblem::THessian &FullNLProblem::frozen_hessian(const size_t i, const TVector &x, const bool reuse)
+	{
+		assert(is_frozen(i));
+		if (!reuse)
+		{
+			POLYFEM_SCOPED_TIMER(timings(i).hessian);
+			forms_[i]->second_derivative(x, frozen_hessians_[i]);
+		}
+		return frozen_hessians_[i];
+	}
+
+	void FullNLProblem::value_gradient_hessian(const TVector &x, double &value, TVector &grad, THessian &hessian)
+	{
+		value = 0;
+		grad = TVector::Zero(x.size());
+		if (hessian_pattern_.rows() != x.size())
+			hessian_pattern_.resize(x.size(), x.size());
+		hessian_pattern_.makeCompressed();
+		hessian_pattern_.coeffs().setZero();
+		add_constant_hessian(x, hessian_pattern_);
+
+		const bool reuse = begin_frozen_hessian(x.size());
+		std::vector<double> values(forms_.size());
+		std::vector<TVector> grads(forms_.size());
+		std::vector<THessian> hessians(forms_.size());
+		for_each_form(
+			[&](const size_t i) {
+				const auto &f = forms_[i];
+				if ((is_frozen(i) && reuse) || is_constant(i))
+				{
+					// only the value and gradient are needed
+					{
+						POLYFEM_SCOPED_TIMER(timings(i).value);
+						values[i] = f->value(x);
+					}
+					{
+						POLYFEM_SCOPED_TIMER(timings(i).gradient);
+						f->first_derivative(x, grads[i]);
+					}
+				}
+				else
+				{
+					POLYFEM_SCOPED_TIMER(timings(i).value_gradient_hessian);
+					f->value_gradient_hessian(x, values[i], grads[i], is_frozen(i) ? frozen_hessians_[i] : hessians[i]);
+				}
+			},
+			[&](const size_t i) {
+				if (!is_constant(i))
+					add_to_hessian(is_frozen(i) ? frozen_hessians_[i] : hessians[i], hessian_pattern_);
+				hessians[i] = THessian();
+				value += values[i];
+				grad += grads[i];
+				keep_form_value(i, x, values[i]);
+				keep_form_gradient(i, x, grads[i]);
+				grads[i].resize(0);
+			});
+
+		hessian = hessian_pattern_;
+	}
+
+	void FullNLProblem::apply_hessian(const TVector &x, const TVector &v, TVector &out)
+	{
+		out = TVector::Zero(x.size());
+		std::vector<TVector> outs(forms_.size());
+		for_each_form(
+			[&](const size_t i) {
+				POLYFEM_SCOPED_TIMER(timings(i).hessian);
+				forms_[i]->apply_hessian(x, v, outs[i]);
+			},
+			[&](const size_t i) {
+				out += outs[i];
+				outs[i].resize(0);
+			});
+	}
+
+	FullNLProblem::FormTimings &FullNLProblem::timings(const size_t i)
+	{
+		// the forms can be added after the construction
+		if (form_timings_.size() < forms_.size())
+			form_timings_.resize(forms_.size());
+		return form_timings_[i];
+	}
+
+	FullNLProblem::FormTimings FullNLProblem::form_timings(const Form &f) const
+	{
+		for (size_t i = 0; i < forms_.size() && i < form_timings_.size(); ++i)
+			if (forms_[i].get() == &f)
+				return form_timings_[i];
+		return FormTimings();
+	}
+
+	json FullNLProblem::form_timings() const
+	{
+		const auto add = [](json &j, const utils::Timing &t) {
+			if (j.is_null())
+				j = {{"time", 0.0}, {"count", 0}};
+			j["time"] = j["time"].get<double>() + t.time;
+			j["count"] = j["count"].get<size_t>() + t.count;
+		};
+
+		// forms with the same name are summed
+		json j = json::object();
+		for (size_t i = 0; i < forms_.size() && i < form_timings_.size(); ++i)
+		{
+			json &entry = j[forms_[i]->name()];
+			add(entry["value"], form_timings_[i].value);
+			add(entry["gradient"], form_timings_[i].gradient);
+			add(entry["hessian"], form_timings_[i].hessian);
+			add(entry["value_gradient_hessian"], form_timings_[i].value_gradient_hessian);
+		}
+		return j;
 	}
 
 	void FullNLProblem::solution_changed(const TVector &x)
 	{
-		for (auto &f : forms_)
-			f->solution_changed(x);
+		// e.g., the contact broad phase runs with the updates of the other forms
+		for_each_form([&](const size_t i) { forms_[i]->solution_changed(x); }, nullptr, /*enabled_only=*/false);
 	}
 
 	void FullNLProblem::post_step(const polysolve::nonlinear::PostStepData &data)
 	{
+		new_iterate_ = true;
+		track_convergence(data.grad.norm());
 		for (auto &f : forms_)
 			f->post_step(data);
 	}
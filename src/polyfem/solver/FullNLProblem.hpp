@@ -1,8 +1,10 @@
 #pragma once
 
 #include <polyfem/solver/forms/Form.hpp>
+#include <polyfem/utils/Timer.hpp>
 #include <polysolve/nonlinear/Problem.hpp>
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -14,15 +16,29 @@ namespace polyfem::solver
 		FullNLProblem(const std::vector<std::shared_ptr<Form>> &forms);
 		virtual ~FullNLProblem() = default;
 		virtual void init(const TVector &x0) override;
+		/// init for a new solve of the same problem where only the weights of the forms changed (e.g., the augmented
+		/// Lagrangian subsolves), the hessian pattern and the summed constant hessians are kept and only the forms
+		/// whose weight changed are added again
+		void reinit(const TVector &x0);
 
 		virtual double value(const TVector &x) override;
 		virtual void gradient(const TVector &x, TVector &gradv) override;
 		virtual void hessian(const TVector &x, THessian &hessian) override;
+		/// value, gradient, and hessian at x, forms can compute them in a single assembly
+		virtual void value_gradient_hessian(const TVector &x, double &value, TVector &gradv, THessian &hessian);
+		/// evaluate the first gradient of every iterate with value_gradient_hessian and keep the hessian for the
+		/// hessian evaluation at the same x (i.e., one element sweep instead of two per Newton iteration)
+		/// @note only fused if the previous iterate asked for its hessian, the solvers without hessian do not assemble it
+		void set_fused_assembly(const bool fused);
+		/// matrix-free product of the hessian at x with v, for iterative linear solvers
+		virtual void apply_hessian(const TVector &x, const TVector &v, TVector &out);
 
 		virtual bool is_step_valid(const TVector &x0, const TVector &x1) override;
 		virtual bool is_step_collision_free(const TVector &x0, const TVector &x1);
 		virtual double max_step_size(const TVector &x0, const TVector &x1) override;
 
+		/// also interpolates the values of the forms with a constant hessian (e.g., the inertia) along x0 -> x1 by a
+		/// quadratic polynomial in the step size, the trial points of the line search only evaluate the other forms
 		virtual void line_search_begin(const TVector &x0, const TVector &x1) override;
 		virtual void line_search_end() override;
 		virtual void post_step(const polysolve::nonlinear::PostStepData &data) override;
@@ -38,9 +54,137 @@ namespace polyfem::solver
 
 		std::vector<std::shared_ptr<Form>> &forms() { return forms_; }
 
+		/// weighted gradient of the form f at x, reused from the last gradient evaluation when it was at x
+		/// @note only valid for forms whose gradient changes with x, time, and weight (i.e., not the lagged ones)
+		void form_gradient(const Form &f, const TVector &x, TVector &grad) const;
+		/// weighted value of the form f at x, reused from the last value evaluation when it was at x
+		double form_value(const Form &f, const TVector &x) const;
+		/// value of the problem at x (i.e., the sum of the enabled forms) from the values kept from the last evaluation,
+		/// only the forms whose value was not kept at x are evaluated
+		double kept_value(const TVector &x) const;
+		/// forget the values and gradients kept from the last evaluation (e.g., when the forms changed without x changing)
+		void reset_form_evaluations();
+
+		/// reuse the hessian of some forms (e.g., the elastic one) instead of assembling it at every iteration
+		/// @param iterations number of hessian evaluations an assembled hessian is used for (1 to always assemble)
+		/// @param refresh_ratio assemble again if a step reduces the gradient norm by less than this ratio
+		/// @param forms forms whose hessian can be reused, the other forms are always assembled
+		void set_frozen_hessian(const int iterations, const double refresh_ratio, const std::vector<std::shared_ptr<Form>> &forms);
+
+		/// evaluate the forms that do not depend on each other (see Form::dependencies) concurrently, e.g., the
+		/// elastic hessian assembly with the contact one, the results are still summed in the order of the forms
+		/// @note only overlaps the forms with TBB, see utils::TaskGraph
+		void set_concurrent_forms(const bool concurrent) { concurrent_forms_ = concurrent; }
+
 		virtual bool stop(const TVector &x) override { return false; }
 
+		/// time and number of calls spent in one form by the evaluations of the problem
+		struct FormTimings
+		{
+			utils::Timing value;
+			utils::Timing gradient;
+			utils::Timing hessian; ///< includes the matrix-free products
+			utils::Timing value_gradient_hessian;
+		};
+		/// timings of f accumulated since the creation of the problem, zero if f is not one of its forms
+		FormTimings form_timings(const Form &f) const;
+		/// timings of all the forms by name, in seconds
+		json form_timings() const;
+
 	protected:
 		std::vector<std::shared_ptr<Form>> forms_;
+
+		/// sums the form hessians in a kept sparsity pattern, grown only when a form adds new entries
+		void add_to_hessian(const THessian &form_hessian, THessian &hessian);
+		/// drop the kept hessian pattern (e.g., when the contacts change a lot)
+		void reset_hessian_pattern() { hessian_pattern_ = THessian(); }
+		/// sum the hessians of the constant forms again at the next hessian evaluation (e.g., at a new time step)
+		/// @note the static ones (see Form::is_hessian_static) are kept for the whole simulation
+		void reset_constant_hessian() { constant_hessian_.weights.clear(); }
+
+		/// keep the gradient of the i-th form computed at x for form_gradient
+		void keep_form_gradient(const size_t i, const TVector &x, const TVector &grad);
+		/// keep the value of the i-th form computed at x for form_value
+		void keep_form_value(const size_t i, const TVector &x, const double value);
+		/// the value kept for the i-th form at x, if any
+		bool kept_form_value(const size_t i, const TVector &x, double &value) const;
+
+		/// calls evaluate for every form, concurrently if set_concurrent_forms, then reduce in the order of the forms
+		/// without concurrency reduce is called right after the evaluation of each form
+		void for_each_form(const std::function<void(const size_t)> &evaluate, const std::function<void(const size_t)> &reduce = nullptr, const bool enabled_only = true);
+
+		/// if the reused hessians are still good enough after a step with the given gradient norm
+		void track_convergence(const double grad_norm);
+		/// start an hessian evaluation, return true if the frozen hessians are reused
+		bool begin_frozen_hessian(const int size);
+		/// hessian of a form that can be frozen, assembled or reused
+		const THessian &frozen_hessian(const size_t i, const TVector &x, const bool reuse);
+		bool is_frozen(const size_t i) const { return i < frozen_forms_.size() && frozen_forms_[i]; }
+
+		/// if the hessian of the i-th form is part of the summed constant hessian
+		bool is_constant(const size_t i) const { return !is_frozen(i) && forms_[i]->is_hessian_constant(); }
+		/// add the weighted hessians of the constant forms (e.g., the mass matrix) to hessian, summed once until they change
+		void add_constant_hessian(const TVector &x, THessian &hessian);
+
+	private:
+		THessian hessian_pattern_;
+
+		/// sum of the weighted hessians of some constant forms
+		struct ConstantHessian
+		{
+			THessian hessian;
+			/// weights of the forms in hessian (0 if not included), empty if it has to be summed again
+			std::vector<double> weights;
+		};
+		/// hessians of the constant forms summed again at every time step, and of the static ones summed once
+		ConstantHessian constant_hessian_, static_hessian_;
+		/// update sum with the constant forms that are static or not, only the forms whose weight changed are added again
+		void sum_constant_hessian(const TVector &x, const bool is_static, ConstantHessian &sum);
+
+		std::vector<FormTimings> form_timings_;
+		FormTimings &timings(const size_t i);
+
+		/// start and direction of the current line search
+		TVector line_search_x0_;
+		TVector line_search_dir_;
+		/// value of the i-th form at x0 + a * dir is p(0) + a * p(1) + a^2 * p(2), empty outside of the line searches
+		/// and NaN for the forms evaluated at every trial point
+		std::vector<Eigen::Vector3d> line_search_polynomials_;
+		std::vector<double> line_search_weights_;
+		/// step size a of x = x0 + a * dir, false if x is not on the line
+		bool line_search_step(const TVector &x, double &step) const;
+
+		TVector form_gradients_x_;
+		std::vector<TVector> form_gradients_;
+		std::vector<double> form_gradients_weight_;
+
+		TVector form_values_x_;
+		/// NaN if not kept
+		std::vector<double> form_values_;
+		std::vector<double> form_values_weight_;
+
+		std::vector<bool> frozen_forms_;
+		std::vector<THessian> frozen_hessians_;
+		/// weights of the forms the frozen hessians were assembled with
+		std::vector<double> frozen_hessian_weights_;
+		int frozen_hessian_iterations_ = 1;
+		double frozen_hessian_refresh_ratio_ = 0.5;
+		int frozen_hessian_age_ = 0;
+		bool frozen_hessian_refresh_ = true;
+		double prev_grad_norm_ = -1;
+
+		bool concurrent_forms_ = false;
+
+		bool fused_assembly_ = false;
+		bool project_to_psd_ = false;
+		/// no gradient was evaluated since the last step
+		bool new_iterate_ = true;
+		/// the hessian was evaluated at the last iterate
+		bool hessian_asked_ = true;
+		/// hessian of the last fused evaluation and the solution and weights of the forms it was computed with
+		TVector fused_hessian_x_;
+		THessian fused_hessian_;
+		std::vector<double> fused_hessian_weights_;
+		std::vector<double> form_weights() const;
 	};
 } // namespace polyfem::solver
@@ -0,0 +1,70 @@
+#include "MixedPrecisionSolver.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		MixedPrecisionSolver::MixedPrecisionSolver(const double tolerance, const int max_iterations)
+			: tolerance_(tolerance), max_iterations_(max_iterations)
+		{
+		}
+
+		void MixedPrecisionSolver::analyze_pattern(const StiffnessMatrix &A, const int precond_num)
+		{
+			const Eigen::SparseMatrix<float> A_f = A.cast<float>();
+			lu_.analyzePattern(A_f);
+		}
+
+		void MixedPrecisionSolver::factorize(const StiffnessMatrix &A)
+		{
+			A_ = A;
+			const Eigen::SparseMatrix<float> A_f = A.cast<float>();
+			lu_.factorize(A_f);
+			if (lu_.info() != Eigen::Success)
+				log_and_throw_error("Single precision factorization failed: {}", lu_.lastErrorMessage());
+		}
+
+		void MixedPrecisionSolver::solve(const Eigen::Ref<const Eigen::VectorXd> b, Eigen::Ref<Eigen::VectorXd> x)
+		{
+			assert(b.size() == A_.rows());
+
+			const double b_norm = b.norm();
+			x.setZero();
+			if (b_norm == 0)
+			{
+				iterations_ = 0;
+				residual_ = 0;
+				return;
+			}
+
+			Eigen::VectorXd r = b;
+			for (iterations_ = 0; iterations_ < max_iterations_; ++iterations_)
+			{
+				const Eigen::VectorXf dx = lu_.solve(r.cast<float>());
+				x += dx.cast<double>();
+
+				r = b - A_ * x;
+				residual_ = r.norm() / b_norm;
+				if (residual_ <= tolerance_)
+				{
+					++iterations_;
+					break;
+				}
+			}
+
+			if (residual_ > tolerance_)
+				logger().warn("Mixed precision refinement stopped after {} iterations with residual {}", iterations_, residual_);
+			else
+				logger().trace("Mixed precision refinement converged in {} iterations, residual {}", iterations_, residual_);
+		}
+
+		void MixedPrecisionSolver::get_info(json &params) const
+		{
+			params["solver_name"] = name();
+			params["num_iterations"] = iterations_;
+			params["final_res_norm"] = residual_;
+		}
+	} // namespace solver
+} // namespace polyfem
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <Eigen/SparseLU>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		/// Direct linear solver factorizing the matrix in single precision.
+		/// The solution is corrected by iterative refinement against the double precision residual,
+		/// x += A_f^-1 (b - A x), so the result has the accuracy of a double solve for well conditioned systems
+		/// while the factors take half of the memory.
+		class MixedPrecisionSolver : public polysolve::linear::Solver
+		{
+		public:
+			/// @param[in] tolerance relative residual ending the refinement
+			/// @param[in] max_iterations maximum number of refinement steps
+			MixedPrecisionSolver(const double tolerance, const int max_iterations);
+
+			void analyze_pattern(const StiffnessMatrix &A, const int precond_num) override;
+			void factorize(const StiffnessMatrix &A) override;
+			void solve(const Eigen::Ref<const Eigen::VectorXd> b, Eigen::Ref<Eigen::VectorXd> x) override;
+
+			void get_info(json &params) const override;
+			std::string name() const override { return "MixedPrecision<Eigen::SparseLU<float>>"; }
+
+			/// number of refinement steps of the last solve
+			int iterations() const { return iterations_; }
+			/// relative residual of the last solve
+			double residual() const { return residual_; }
+
+		private:
+			const double tolerance_;
+			const int max_iterations_;
+
+			/// double precision matrix of the residuals
+			StiffnessMatrix A_;
+			Eigen::SparseLU<Eigen::SparseMatrix<float>> lu_;
+
+			int iterations_ = 0;
+			double residual_ = 0;
+		};
+	} // namespace solver
+} // namespace polyfem
@@ -0,0 +1,158 @@
+#include "ModalSolver.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		ModalSolver::ModalSolver(const json &params)
+			: n_modes_(params["n_modes"]),
+			  shift_(params["shift"]),
+			  tolerance_(params["tolerance"])
+		{
+		}
+
+		int ModalSolver::compute(polysolve::linear::Solver &solver, const StiffnessMatrix &K, const StiffnessMatrix &M, const std::vector<int> &fixed)
+		{
+			assert(K.rows() == M.rows() && K.cols() == M.cols());
+			const int n = K.rows();
+
+			std::vector<bool> is_fixed(n, false);
+			for (const int i : fixed)
+				is_fixed[i] = true;
+			const int n_free = n - std::count(is_fixed.begin(), is_fixed.end(), true);
+			const int n_modes = std::min(n_modes_, n_free);
+			if (n_modes <= 0)
+				log_and_throw_error("No mode to compute, {} modes asked with {} free dofs!", n_modes_, n_free);
+
+			// the fixed rows are replaced by the identity, the solutions then vanish on the fixed dofs
+			StiffnessMatrix A = K - shift_ * M;
+			for (int k = 0; k < A.outerSize(); ++k)
+			{
+				for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+				{
+					if (is_fixed[it.row()])
+						it.valueRef() = it.row() == it.col() ? 1 : 0;
+				}
+			}
+			solver.analyze_pattern(A, A.rows());
+			solver.factorize(A);
+
+			// w = (K - shift M)^-1 M v, restricted to the free dofs
+			const auto apply_operator = [&](const Eigen::VectorXd &v, Eigen::VectorXd &w) {
+				Eigen::VectorXd Mv = M * v;
+				for (const int i : fixed)
+					Mv[i] = 0;
+				w.resize(n);
+				solver.solve(Mv, w);
+				for (const int i : fixed)
+					w[i] = 0;
+			};
+
+			std::mt19937 gen(0);
+			std::uniform_real_distribution<double> dist(-1, 1);
+			Eigen::VectorXd v0(n);
+			for (int i = 0; i < n; ++i)
+				v0[i] = is_fixed[i] ? 0 : dist(gen);
+
+			int converged = 0;
+			for (int m = std::min(n_free, std::max(2 * n_modes + 1, n_modes + 20));; m = std::min(n_free, 2 * m))
+			{
+				// Lanczos with full reorthogonalization, V is M-orthonormal and V^T M OP V = T is tridiagonal
+				Eigen::MatrixXd V(n, m + 1), MV(n, m + 1);
+				Eigen::VectorXd alpha(m), beta(m);
+				MV.col(0) = M * v0;
+				V.col(0) = v0 / std::sqrt(v0.dot(MV.col(0)));
+				MV.col(0) = M * V.col(0);
+
+				int size = m;
+				Eigen::VectorXd w;
+				for (int j = 0; j < m; ++j)
+				{
+					apply_operator(V.col(j), w);
+					alpha[j] = MV.col(j).dot(w);
+					for (int pass = 0; pass < 2; ++pass)
+						w -= V.leftCols(j + 1) * (MV.leftCols(j + 1).transpose() * w);
+
+					const Eigen::VectorXd Mw = M * w;
+					beta[j] = std::sqrt(std::max(0., w.dot(Mw)));
+					// invariant subspace, its Ritz pairs are exact
+					if (beta[j] <= 1e-12 * std::abs(alpha[j]))
+					{
+						size = j + 1;
+						beta[j] = 0;
+						break;
+					}
+					V.col(j + 1) = w / beta[j];
+					MV.col(j + 1) = Mw / beta[j];
+				}
+
+				Eigen::MatrixXd T = Eigen::MatrixXd::Zero(size, size);
+				for (int j = 0; j < size; ++j)
+				{
+					T(j, j) = alpha[j];
+					if (j + 1 < size)
+						T(j, j + 1) = T(j + 1, j) = beta[j];
+				}
+				const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(T);
+
+				// the largest Ritz values of the shift-inverted operator are the eigenvalues closest to the shift
+				std::vector<int> order(size);
+				std::iota(order.begin(), order.end(), 0);
+				std::sort(order.begin(), order.end(), [&](const int a, const int b) { return std::abs(eig.eigenvalues()[a]) > std::abs(eig.eigenvalues()[b]); });
+
+				const int n_ritz = std::min(n_modes, size);
+				eigenvalues_.resize(n_ritz);
+				modes_.resize(n, n_ritz);
+				converged = 0;
+				for (int k = 0; k < n_ritz; ++k)
+				{
+					const double theta = eig.eigenvalues()[order[k]];
+					const Eigen::VectorXd s = eig.eigenvectors().col(order[k]);
+					eigenvalues_[k] = shift_ + 1 / theta;
+					modes_.col(k) = V.leftCols(size) * s;
+					if (std::abs(beta[size - 1] * s[size - 1]) <= tolerance_ * std::abs(theta))
+						++converged;
+				}
+
+				if (converged == n_modes || size < m || m == n_free)
+					break;
+				logger().debug("Modal analysis: {}/{} modes converged with {} Lanczos vectors", converged, n_modes, m);
+			}
+
+			std::vector<int> order(eigenvalues_.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](const int a, const int b) { return eigenvalues_[a] < eigenvalues_[b]; });
+			const Eigen::VectorXd eigenvalues = eigenvalues_;
+			const Eigen::MatrixXd modes = modes_;
+			for (int k = 0; k < order.size(); ++k)
+			{
+				eigenvalues_[k] = eigenvalues[order[k]];
+				modes_.col(k) = modes.col(order[k]);
+			}
+
+			if (converged < n_modes)
+				logger().warn("Modal analysis: only {}/{} modes converged", converged, n_modes);
+			else
+				logger().info("Modal analysis: {} modes, eigenvalues in [{}, {}]", n_modes, eigenvalues_.minCoeff(), eigenvalues_.maxCoeff());
+
+			return converged;
+		}
+
+		void ModalSolver::project_solve(const double stiffness_scaling, const double mass_scaling, const Eigen::VectorXd &rhs, Eigen::VectorXd &x) const
+		{
+			assert(rhs.size() == modes_.rows());
+			// Phi^T (a K + b M) Phi = diag(a lambda + b)
+			const Eigen::VectorXd q = (modes_.transpose() * rhs).array() / (stiffness_scaling * eigenvalues_.array() + mass_scaling);
+			x = modes_ * q;
+		}
+	} // namespace solver
+} // namespace polyfem
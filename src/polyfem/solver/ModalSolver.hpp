@@ -0,0 +1,51 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		/// Modes of the generalized eigenproblem K phi = lambda M phi closest to a shift (the lowest ones for a shift of 0),
+		/// computed with a shift-invert Lanczos iteration in the M inner product: K - shift M is factorized once and every
+		/// iteration is a back substitution. The fixed (Dirichlet) dofs are eliminated, the modes vanish on them.
+		/// The modes are M-orthonormal, so the Galerkin projection of (a K + b M) x = rhs on them is diagonal and is solved
+		/// in O(#dofs #modes) without a sparse solve (modal superposition).
+		class ModalSolver
+		{
+		public:
+			/// @param[in] params modal settings (solver/modal)
+			ModalSolver(const json &params);
+
+			/// compute the modes, the Krylov subspace is enlarged until they converge or it spans the free dofs
+			/// @param[in] solver linear solver of K - shift M, preferably direct
+			/// @param[in] K stiffness
+			/// @param[in] M mass
+			/// @param[in] fixed fixed dofs
+			/// @return number of converged modes
+			int compute(polysolve::linear::Solver &solver, const StiffnessMatrix &K, const StiffnessMatrix &M, const std::vector<int> &fixed);
+
+			/// eigenvalues in increasing order (squared angular frequencies for elasticity)
+			const Eigen::VectorXd &eigenvalues() const { return eigenvalues_; }
+			/// M-orthonormal modes, one per column
+			const Eigen::MatrixXd &modes() const { return modes_; }
+
+			/// solution of the projection of (stiffness_scaling K + mass_scaling M) x = rhs on the modes
+			/// @param[in] rhs right-hand side, its fixed entries are ignored (the modes vanish on the fixed dofs)
+			/// @param[out] x solution, in the span of the modes
+			void project_solve(const double stiffness_scaling, const double mass_scaling, const Eigen::VectorXd &rhs, Eigen::VectorXd &x) const;
+
+		private:
+			const int n_modes_;
+			const double shift_;
+			const double tolerance_;
+
+			Eigen::VectorXd eigenvalues_;
+			Eigen::MatrixXd modes_;
+		};
+	} // namespace solver
+} // namespace polyfem
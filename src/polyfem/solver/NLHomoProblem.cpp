@@ -191,6 +191,20 @@ namespace polyfem::solver
             }
     }
 
+    void NLHomoProblem::apply_hessian(const TVector &x, const TVector &v, TVector &out)
+    {
+        THessian hess;
+        hessian(x, hess);
+        out = hess * v;
+    }
+
+    void NLHomoProblem::value_gradient_hessian(const TVector &x, double &value, TVector &gradv, THessian &hessian)
+    {
+        value = this->value(x);
+        gradient(x, gradv);
+        this->hessian(x, hessian);
+    }
+
     void NLHomoProblem::set_fixed_entry(const Eigen::VectorXi &fixed_entry)
     {
         const int dim = state_.mesh->dimension();
@@ -33,6 +33,10 @@ namespace polyfem::solver
 		double value(const TVector &x) override;
 		void gradient(const TVector &x, TVector &gradv) override;
 		void hessian(const TVector &x, THessian &hessian) override;
+		/// the macro strain reduction is not applied matrix-free, the reduced hessian is assembled
+		void apply_hessian(const TVector &x, const TVector &v, TVector &out) override;
+		/// the macro strain terms are not fused, evaluates value, gradient, and hessian separately
+		void value_gradient_hessian(const TVector &x, double &value, TVector &gradv, THessian &hessian) override;
 
 		void full_hessian_to_reduced_hessian(const THessian &full, THessian &reduced) const override;
 
@@ -73,6 +77,9 @@ namespace polyfem::solver
 
 	protected:
 		Eigen::MatrixXd boundary_values() const override;
+		/// the macro strain dofs are not scattered in place, the conversions allocate
+		void reduced_to_full_into(const TVector &reduced, TVector &full) const override { full = reduced_to_full(reduced); }
+		void full_to_reduced_grad_into(const TVector &full, TVector &reduced) const override { reduced = full_to_reduced_grad(full); }
 
 	private:
 		void init_projection();
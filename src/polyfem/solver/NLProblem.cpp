@@ -1,6 +1,12 @@
 #include "NLProblem.hpp"
 
 #include <polyfem/io/OBJWriter.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Profiler.hpp>
+#include <polyfem/utils/Timer.hpp>
+
+#include <algorithm>
 
 /*
 m \frac{\partial^2 u}{\partial t^2} = \psi = \text{div}(\sigma[u])\newline
@@ -32,6 +38,7 @@ namespace polyfem::solver
 		  n_boundary_samples_(0)
 	{
 		use_reduced_size();
+		build_reduction_plan();
 	}
 
 	NLProblem::NLProblem(
@@ -57,6 +64,26 @@ namespace polyfem::solver
 		assert(std::is_sorted(boundary_nodes.begin(), boundary_nodes.end()));
 		assert(boundary_nodes.size() == 0 || (boundary_nodes.front() >= 0 && boundary_nodes.back() < full_size_));
 		use_reduced_size();
+		build_reduction_plan();
+	}
+
+	void NLProblem::build_reduction_plan()
+	{
+		assert(std::is_sorted(boundary_nodes_.begin(), boundary_nodes_.end()));
+
+		reduced_to_mid_.resize(reduced_size_);
+		size_t k = 0;
+		int j = 0;
+		for (int i = 0; i < reduced_size_ + boundary_nodes_.size(); ++i)
+		{
+			if (k < boundary_nodes_.size() && boundary_nodes_[k] == i)
+			{
+				++k;
+				continue;
+			}
+			reduced_to_mid_[j++] = i;
+		}
+		assert(j == reduced_size_);
 	}
 
 	void NLProblem::init_lagging(const TVector &x)
@@ -72,6 +99,11 @@ namespace polyfem::solver
 	void NLProblem::update_quantities(const double t, const TVector &x)
 	{
 		t_ = t;
+		boundary_values_cached_ = false;
+		// new time step, do not keep growing the hessian pattern with stale contacts
+		reset_hessian_pattern();
+		reset_constant_hessian();
+		reset_form_evaluations();
 		const TVector full = reduced_to_full(x);
 		for (auto &f : forms_)
 			f->update_quantities(t, full);
@@ -79,53 +111,102 @@ namespace polyfem::solver
 
 	void NLProblem::line_search_begin(const TVector &x0, const TVector &x1)
 	{
-		FullNLProblem::line_search_begin(reduced_to_full(x0), reduced_to_full(x1));
+		POLYFEM_PROFILE_ZONE("NLProblem::line_search_begin");
+		reduced_to_full_into(x0, full_x_);
+		reduced_to_full_into(x1, full_x1_);
+		FullNLProblem::line_search_begin(full_x_, full_x1_);
 	}
 
 	double NLProblem::max_step_size(const TVector &x0, const TVector &x1)
 	{
-		return FullNLProblem::max_step_size(reduced_to_full(x0), reduced_to_full(x1));
+		POLYFEM_PROFILE_ZONE("NLProblem::max_step_size");
+		reduced_to_full_into(x0, full_x_);
+		reduced_to_full_into(x1, full_x1_);
+		return FullNLProblem::max_step_size(full_x_, full_x1_);
 	}
 
 	bool NLProblem::is_step_valid(const TVector &x0, const TVector &x1)
 	{
-		return FullNLProblem::is_step_valid(reduced_to_full(x0), reduced_to_full(x1));
+		POLYFEM_PROFILE_ZONE("NLProblem::is_step_valid");
+		reduced_to_full_into(x0, full_x_);
+		reduced_to_full_into(x1, full_x1_);
+		return FullNLProblem::is_step_valid(full_x_, full_x1_);
 	}
 
 	bool NLProblem::is_step_collision_free(const TVector &x0, const TVector &x1)
 	{
-		return FullNLProblem::is_step_collision_free(reduced_to_full(x0), reduced_to_full(x1));
+		POLYFEM_PROFILE_ZONE("NLProblem::is_step_collision_free");
+		reduced_to_full_into(x0, full_x_);
+		reduced_to_full_into(x1, full_x1_);
+		return FullNLProblem::is_step_collision_free(full_x_, full_x1_);
 	}
 
 	double NLProblem::value(const TVector &x)
 	{
+		POLYFEM_PROFILE_ZONE("NLProblem::value");
 		// TODO: removed fearure const bool only_elastic
-		return FullNLProblem::value(reduced_to_full(x));
+		reduced_to_full_into(x, full_x_);
+		return FullNLProblem::value(full_x_);
 	}
 
 	void NLProblem::gradient(const TVector &x, TVector &grad)
 	{
-		TVector full_grad;
-		FullNLProblem::gradient(reduced_to_full(x), full_grad);
-		grad = full_to_reduced_grad(full_grad);
+		POLYFEM_PROFILE_ZONE("NLProblem::gradient");
+		reduced_to_full_into(x, full_x_);
+		FullNLProblem::gradient(full_x_, full_grad_);
+		full_to_reduced_grad_into(full_grad_, grad);
 	}
 
 	void NLProblem::hessian(const TVector &x, THessian &hessian)
 	{
+		POLYFEM_PROFILE_ZONE("NLProblem::hessian");
 		THessian full_hessian;
-		FullNLProblem::hessian(reduced_to_full(x), full_hessian);
+		reduced_to_full_into(x, full_x_);
+		FullNLProblem::hessian(full_x_, full_hessian);
 
 		full_hessian_to_reduced_hessian(full_hessian, hessian);
 	}
 
+	void NLProblem::value_gradient_hessian(const TVector &x, double &value, TVector &grad, THessian &hessian)
+	{
+		POLYFEM_PROFILE_ZONE("NLProblem::value_gradient_hessian");
+		THessian full_hessian;
+		reduced_to_full_into(x, full_x_);
+		FullNLProblem::value_gradient_hessian(full_x_, value, full_grad_, full_hessian);
+
+		full_to_reduced_grad_into(full_grad_, grad);
+		full_hessian_to_reduced_hessian(full_hessian, hessian);
+	}
+
+	void NLProblem::apply_hessian(const TVector &x, const TVector &v, TVector &out)
+	{
+		POLYFEM_PROFILE_ZONE("NLProblem::apply_hessian");
+		// v is a direction, its Dirichlet entries are zero
+		reduced_to_full_aux(v, nullptr, full_x1_);
+
+		reduced_to_full_into(x, full_x_);
+		FullNLProblem::apply_hessian(full_x_, full_x1_, full_grad_);
+		full_to_reduced_grad_into(full_grad_, out);
+	}
+
 	void NLProblem::solution_changed(const TVector &newX)
 	{
-		FullNLProblem::solution_changed(reduced_to_full(newX));
+		POLYFEM_PROFILE_ZONE("NLProblem::solution_changed");
+		reduced_to_full_into(newX, full_x_);
+		FullNLProblem::solution_changed(full_x_);
 	}
 
 	void NLProblem::post_step(const polysolve::nonlinear::PostStepData &data)
 	{
-		FullNLProblem::post_step(polysolve::nonlinear::PostStepData(data.iter_num, data.solver_info, reduced_to_full(data.x), reduced_to_full(data.grad)));
+		POLYFEM_PROFILE_ZONE("NLProblem::post_step");
+		// the reduced gradient, the full one would include the boundary values
+		track_convergence(data.grad.norm());
+
+		reduced_to_full_into(data.x, full_x_);
+		reduced_to_full_into(data.grad, full_grad_);
+		const polysolve::nonlinear::PostStepData full_data(data.iter_num, data.solver_info, full_x_, full_grad_);
+		for (auto &f : forms_)
+			f->post_step(full_data);
 
 		// TODO: add me back
 		// if (state_.args["output"]["advanced"]["save_nl_solve_sequence"])
@@ -140,6 +221,8 @@ namespace polyfem::solver
 
 	void NLProblem::set_apply_DBC(const TVector &x, const bool val)
 	{
+		// the body form gradient changes with the DBC even if x does not
+		reset_form_evaluations();
 		TVector full = reduced_to_full(x);
 		for (auto &form : forms_)
 			form->set_apply_DBC(full, val);
@@ -148,24 +231,34 @@ namespace polyfem::solver
 	NLProblem::TVector NLProblem::full_to_reduced(const TVector &full) const
 	{
 		TVector reduced;
-		full_to_reduced_aux(boundary_nodes_, full_size(), current_size(), full, reduced);
+		full_to_reduced_aux(full, false, reduced);
 		return reduced;
 	}
 
 	NLProblem::TVector NLProblem::full_to_reduced_grad(const TVector &full) const
 	{
 		TVector reduced;
-		full_to_reduced_aux_grad(boundary_nodes_, full_size(), current_size(), full, reduced);
+		full_to_reduced_aux(full, true, reduced);
 		return reduced;
 	}
 
 	NLProblem::TVector NLProblem::reduced_to_full(const TVector &reduced) const
 	{
 		TVector full;
-		reduced_to_full_aux(boundary_nodes_, full_size(), current_size(), reduced, boundary_values(), full);
+		reduced_to_full_aux(reduced, &cached_boundary_values(), full);
 		return full;
 	}
 
+	void NLProblem::reduced_to_full_into(const TVector &reduced, TVector &full) const
+	{
+		reduced_to_full_aux(reduced, &cached_boundary_values(), full);
+	}
+
+	void NLProblem::full_to_reduced_grad_into(const TVector &full, TVector &reduced) const
+	{
+		full_to_reduced_aux(full, true, reduced);
+	}
+
 	Eigen::MatrixXd NLProblem::boundary_values() const
 	{
 		Eigen::MatrixXd result = Eigen::MatrixXd::Zero(full_size(), 1);
@@ -174,128 +267,184 @@ namespace polyfem::solver
 		return result;
 	}
 
-	template <class FullMat, class ReducedMat>
-	void NLProblem::full_to_reduced_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced) const
+	const Eigen::MatrixXd &NLProblem::cached_boundary_values() const
 	{
-		using namespace polyfem;
+		if (!boundary_values_cached_)
+		{
+			boundary_values_cache_ = boundary_values();
+			boundary_values_cached_ = true;
+		}
+		return boundary_values_cache_;
+	}
 
+	void NLProblem::full_to_reduced_aux(const TVector &full, const bool accumulate, TVector &reduced) const
+	{
 		// Reduced is already at the full size
-		if (full_size == reduced_size || full.size() == reduced_size)
+		if (full_size() == current_size() || full.size() == current_size())
 		{
 			reduced = full;
 			return;
 		}
 
-		assert(full.size() == full_size);
-		assert(full.cols() == 1);
-		reduced.resize(reduced_size, 1);
+		assert(full.size() == full_size());
+		reduced.resize(current_size());
 
-		Eigen::MatrixXd mid;
+		Eigen::MatrixXd periodic;
 		if (periodic_bc_)
-			mid = periodic_bc_->full_to_periodic(full, false);
-		else
-			mid = full;
-		
-		assert(std::is_sorted(boundary_nodes.begin(), boundary_nodes.end()));
+			periodic = periodic_bc_->full_to_periodic(full, accumulate);
+		const double *mid = periodic_bc_ ? periodic.data() : full.data();
 
-		long j = 0;
-		size_t k = 0;
-		for (int i = 0; i < mid.size(); ++i)
-		{
-			if (k < boundary_nodes.size() && boundary_nodes[k] == i)
-			{
-				++k;
-				continue;
-			}
-
-			assert(j < reduced.size());
-			reduced(j++) = mid(i);
-		}
+		utils::maybe_parallel_for(reduced.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				reduced(i) = mid[reduced_to_mid_[i]];
+		});
 	}
 
-	template <class ReducedMat, class FullMat>
-	void NLProblem::reduced_to_full_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const ReducedMat &reduced, const Eigen::MatrixXd &rhs, FullMat &full) const
+	void NLProblem::reduced_to_full_aux(const TVector &reduced, const Eigen::MatrixXd *boundary, TVector &full) const
 	{
-		using namespace polyfem;
-
 		// Full is already at the reduced size
-		if (full_size == reduced_size || full_size == reduced.size())
+		if (full_size() == current_size() || full_size() == reduced.size())
 		{
 			full = reduced;
 			return;
 		}
 
-		assert(reduced.size() == reduced_size);
-		assert(reduced.cols() == 1);
-		full.resize(full_size, 1);
+		assert(reduced.size() == current_size());
 
-		assert(std::is_sorted(boundary_nodes.begin(), boundary_nodes.end()));
-
-		long j = 0;
-		size_t k = 0;
-		Eigen::MatrixXd mid(reduced_size + boundary_nodes.size(), 1);
-		for (int i = 0; i < mid.size(); ++i)
-		{
-			if (k < boundary_nodes.size() && boundary_nodes[k] == i)
-			{
-				++k;
-				mid(i) = rhs(i);
-				continue;
-			}
+		const int mid_size = reduced.size() + boundary_nodes_.size();
+		Eigen::MatrixXd periodic;
+		if (periodic_bc_)
+			periodic.resize(mid_size, 1);
+		else
+			full.resize(full_size());
+		double *mid = periodic_bc_ ? periodic.data() : full.data();
+
+		utils::maybe_parallel_for(boundary_nodes_.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
+				mid[boundary_nodes_[k]] = boundary ? (*boundary)(boundary_nodes_[k]) : 0;
+		});
+		utils::maybe_parallel_for(reduced.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				mid[reduced_to_mid_[i]] = reduced(i);
+		});
 
-			mid(i) = reduced(j++);
-		}
-		
-		full = periodic_bc_ ? periodic_bc_->periodic_to_full(full_size, mid) : mid;
+		if (periodic_bc_)
+			full = periodic_bc_->periodic_to_full(full_size(), periodic);
 	}
 
-	template <class FullMat, class ReducedMat>
-	void NLProblem::full_to_reduced_aux_grad(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced) const
+	void NLProblem::full_hessian_to_reduced_hessian(const THessian &full, THessian &reduced) const
 	{
-		using namespace polyfem;
-
-		// Reduced is already at the full size
-		if (full_size == reduced_size || full.size() == reduced_size)
+		// POLYFEM_SCOPED_TIMER("\tfull hessian to reduced hessian");
+		if (!periodic_bc_ && current_size() == full_size())
 		{
 			reduced = full;
 			return;
 		}
 
-		assert(full.size() == full_size);
-		assert(full.cols() == 1);
-		reduced.resize(reduced_size, 1);
+		if (!full.isCompressed())
+		{
+			THessian compressed = full;
+			compressed.makeCompressed();
+			full_hessian_to_reduced_hessian(compressed, reduced);
+			return;
+		}
+
+		const int n_outer = full.outerSize() + 1;
+		const bool same_pattern =
+			hessian_reduction_size_ == current_size()
+			&& hessian_full_outer_.size() == n_outer && hessian_full_inner_.size() == full.nonZeros()
+			&& std::equal(hessian_full_outer_.begin(), hessian_full_outer_.end(), full.outerIndexPtr())
+			&& std::equal(hessian_full_inner_.begin(), hessian_full_inner_.end(), full.innerIndexPtr());
+
+		if (!same_pattern)
+			build_hessian_reduction(full);
+
+		// periodic folding merges several full entries in the same reduced one
+		hessian_reduced_.coeffs().setZero();
+		double *values = hessian_reduced_.valuePtr();
+		const double *full_values = full.valuePtr();
+		for (int i = 0; i < hessian_reduced_slot_.size(); ++i)
+			if (hessian_reduced_slot_[i] >= 0)
+				values[hessian_reduced_slot_[i]] += full_values[i];
+
+		reduced = hessian_reduced_;
+	}
+
+	void NLProblem::build_hessian_reduction(const THessian &full) const
+	{
+		POLYFEM_SCOPED_TIMER("build hessian reduction");
+
+		hessian_reduction_size_ = current_size();
+		hessian_full_outer_.assign(full.outerIndexPtr(), full.outerIndexPtr() + full.outerSize() + 1);
+		hessian_full_inner_.assign(full.innerIndexPtr(), full.innerIndexPtr() + full.nonZeros());
 
-		Eigen::MatrixXd mid;
+		// full dof -> periodic dof -> reduced dof (-1 if Dirichlet)
+		Eigen::VectorXi indices(full.rows());
+		int mid_size = full.rows();
 		if (periodic_bc_)
-			mid = periodic_bc_->full_to_periodic(full, true);
+		{
+			mid_size = periodic_bc_->full_to_periodic_index(full.rows());
+			for (int i = 0; i < full.rows(); ++i)
+				indices(i) = periodic_bc_->full_to_periodic_index(i);
+		}
 		else
-			mid = full;
+			indices.setLinSpaced(full.rows(), 0, full.rows() - 1);
 
-		long j = 0;
-		size_t k = 0;
-		for (int i = 0; i < mid.size(); ++i)
+		int reduced_size = mid_size;
+		if (current_size() < full_size())
 		{
-			if (k < boundary_nodes.size() && boundary_nodes[k] == i)
+			Eigen::VectorXi mid_to_reduced(mid_size);
+			int index = 0;
+			size_t kk = 0;
+			for (int i = 0; i < mid_size; ++i)
 			{
-				++k;
-				continue;
+				if (kk < boundary_nodes_.size() && boundary_nodes_[kk] == i)
+				{
+					++kk;
+					mid_to_reduced(i) = -1;
+				}
+				else
+					mid_to_reduced(i) = index++;
 			}
+			reduced_size = index;
+			for (int i = 0; i < indices.size(); ++i)
+				indices(i) = mid_to_reduced(indices(i));
+		}
 
-			reduced(j++) = mid(i);
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(full.nonZeros());
+		for (int k = 0; k < full.outerSize(); ++k)
+		{
+			if (indices(k) < 0)
+				continue;
+			for (THessian::InnerIterator it(full, k); it; ++it)
+				if (indices(it.row()) >= 0)
+					entries.emplace_back(indices(it.row()), indices(k), 0);
 		}
-	}
 
-	void NLProblem::full_hessian_to_reduced_hessian(const THessian &full, THessian &reduced) const
-	{
-		// POLYFEM_SCOPED_TIMER("\tfull hessian to reduced hessian");
-		THessian mid = full;
-		
-		if (periodic_bc_)
-			periodic_bc_->full_to_periodic(mid);
+		const THessian previous_reduced = std::move(hessian_reduced_);
+		hessian_reduced_.resize(reduced_size, reduced_size);
+		hessian_reduced_.setFromTriplets(entries.begin(), entries.end());
+		hessian_reduced_.makeCompressed();
 
-		if (current_size() < full_size())
-			utils::full_to_reduced_matrix(mid.rows(), mid.rows() - boundary_nodes_.size(), boundary_nodes_, mid, reduced);
-		else
-			reduced = mid;
+		// the full pattern can change (e.g., with new contacts on Dirichlet nodes) without changing the reduced one
+		if (previous_reduced.rows() != hessian_reduced_.rows()
+			|| previous_reduced.nonZeros() != hessian_reduced_.nonZeros()
+			|| !std::equal(hessian_reduced_.outerIndexPtr(), hessian_reduced_.outerIndexPtr() + hessian_reduced_.outerSize() + 1, previous_reduced.outerIndexPtr())
+			|| !std::equal(hessian_reduced_.innerIndexPtr(), hessian_reduced_.innerIndexPtr() + hessian_reduced_.nonZeros(), previous_reduced.innerIndexPtr()))
+			++hessian_pattern_changes_;
+
+		hessian_reduced_slot_.assign(full.nonZeros(), -1);
+		for (int k = 0; k < full.outerSize(); ++k)
+		{
+			if (indices(k) < 0)
+				continue;
+			for (int i = full.outerIndexPtr()[k]; i < full.outerIndexPtr()[k + 1]; ++i)
+			{
+				const int row = indices(full.innerIndexPtr()[i]);
+				if (row >= 0)
+					hessian_reduced_slot_[i] = utils::find_in_pattern(hessian_reduced_, row, indices(k)) - hessian_reduced_.valuePtr();
+			}
+		}
 	}
 } // namespace polyfem::solver
@@ -34,6 +34,8 @@ namespace polyfem::solver
 		virtual double value(const TVector &x) override;
 		virtual void gradient(const TVector &x, TVector &gradv) override;
 		virtual void hessian(const TVector &x, THessian &hessian) override;
+		virtual void apply_hessian(const TVector &x, const TVector &v, TVector &out) override;
+		virtual void value_gradient_hessian(const TVector &x, double &value, TVector &gradv, THessian &hessian) override;
 
 		virtual bool is_step_valid(const TVector &x0, const TVector &x1) override;
 		virtual bool is_step_collision_free(const TVector &x0, const TVector &x1) override;
@@ -64,9 +66,19 @@ namespace polyfem::solver
 
 		void set_apply_DBC(const TVector &x, const bool val);
 
+		/// number of times the reduced hessian pattern changed, the pattern (and thus
+		/// the symbolic factorization of the linear system) is the same between two
+		/// hessians if this count did not change. QuasiNewtonSolver uses it to skip analyze_pattern.
+		int hessian_pattern_changes() const { return hessian_pattern_changes_; }
+
 	protected:
 		virtual Eigen::MatrixXd boundary_values() const;
 
+		/// reduced_to_full into full, without allocating when full already has the full size
+		virtual void reduced_to_full_into(const TVector &reduced, TVector &full) const;
+		/// full_to_reduced_grad into reduced, without allocating when reduced already has the reduced size
+		virtual void full_to_reduced_grad_into(const TVector &full, TVector &reduced) const;
+
 		const std::vector<int> full_boundary_nodes_;
 		const std::vector<int> boundary_nodes_;
 
@@ -93,13 +105,32 @@ namespace polyfem::solver
 		const std::vector<mesh::LocalBoundary> *local_boundary_;
 		const int n_boundary_samples_;
 
-		template <class FullMat, class ReducedMat>
-		void full_to_reduced_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced) const;
-
-		template <class ReducedMat, class FullMat>
-		void reduced_to_full_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const ReducedMat &reduced, const Eigen::MatrixXd &rhs, FullMat &full) const;
-
-		template <class FullMat, class ReducedMat>
-		void full_to_reduced_aux_grad(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced) const;
+		/// build the map from the entries of a full hessian with the pattern of full to the reduced hessian
+		void build_hessian_reduction(const THessian &full) const;
+
+		// reduced hessian pattern and the reduced entry of every full entry (-1 if removed),
+		// valid while the full hessian pattern and the current size do not change
+		mutable std::vector<int> hessian_full_outer_, hessian_full_inner_;
+		mutable std::vector<int> hessian_reduced_slot_;
+		mutable THessian hessian_reduced_;
+		mutable int hessian_reduction_size_ = -1;
+		mutable int hessian_pattern_changes_ = 0;
+
+		/// index in the periodic (or full) vector of every reduced dof, built once since the Dirichlet nodes do not change
+		std::vector<int> reduced_to_mid_;
+		void build_reduction_plan();
+
+		/// boundary values at t_, evaluated once per time step instead of at every conversion
+		mutable Eigen::MatrixXd boundary_values_cache_;
+		mutable bool boundary_values_cached_ = false;
+		const Eigen::MatrixXd &cached_boundary_values() const;
+
+		/// full size buffers of the evaluations, kept between the iterations
+		TVector full_x_, full_x1_, full_grad_;
+
+		/// gather the reduced dofs of full, the periodic dofs are summed if accumulate
+		void full_to_reduced_aux(const TVector &full, const bool accumulate, TVector &reduced) const;
+		/// scatter reduced into full, the Dirichlet dofs are set to boundary (zero if null)
+		void reduced_to_full_aux(const TVector &reduced, const Eigen::MatrixXd *boundary, TVector &full) const;
 	};
 } // namespace polyfem::solver
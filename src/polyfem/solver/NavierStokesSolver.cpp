@@ -1,5 +1,6 @@
 #include "NavierStokesSolver.hpp"
 
+#include <polyfem/solver/PreconditionerReuseSolver.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
 #include <polysolve/linear/FEMSolver.hpp>
 
@@ -26,6 +27,32 @@ namespace polyfem
 		{
 			gradNorm = solver_param["nonlinear"]["grad_norm"];
 			iterations = solver_param["nonlinear"]["max_iterations"];
+
+			if (solver_param["saddle_point"]["enabled"])
+				saddle_point_solver = std::make_unique<SaddlePointSolver>(solver_param["saddle_point"]);
+			else
+			{
+				linear_solver = PreconditionerReuseSolver::wrap(linear::Solver::create(solver_param["linear"], logger()), solver_param);
+				logger().debug("\tinternal solver {}", linear_solver->name());
+			}
+		}
+
+		void NavierStokesSolver::solve_linear(
+			const StiffnessMatrix &A, const Eigen::VectorXd &b,
+			const std::vector<int> &boundary_nodes, const std::vector<int> &skipping,
+			const int precond_num, const bool use_avg_pressure, Eigen::VectorXd &x)
+		{
+			if (saddle_point_solver)
+			{
+				std::vector<int> fixed = boundary_nodes;
+				fixed.insert(fixed.end(), skipping.begin(), skipping.end());
+				saddle_point_solver->solve(A, precond_num, fixed, b, x);
+			}
+			else
+			{
+				Eigen::VectorXd tmp = b;
+				dirichlet_solve(*linear_solver, A, tmp, boundary_nodes, x, precond_num, "", false, true, use_avg_pressure);
+			}
 		}
 
 		void NavierStokesSolver::minimize(
@@ -48,9 +75,6 @@ namespace polyfem
 		{
 			assert(velocity_assembler.name() == "NavierStokes");
 
-			auto solver = linear::Solver::create(solver_param["linear"], logger());
-			logger().debug("\tinternal solver {}", solver->name());
-
 			const int precond_num = problem_dim * n_bases;
 
 			igl::Timer time;
@@ -69,18 +93,7 @@ namespace polyfem
 			stokes_matrix_time = time.getElapsedTimeInSec();
 			logger().debug("\tStokes matrix assembly time {}s", time.getElapsedTimeInSec());
 
-			time.start();
-
-			logger().info("{}...", solver->name());
-
-			Eigen::VectorXd b = rhs;
-			dirichlet_solve(*solver, stoke_stiffness, b, boundary_nodes, x, precond_num, "", false, true, use_avg_pressure);
-			// solver->get_info(solver_info);
-			time.stop();
-			stokes_solve_time = time.getElapsedTimeInSec();
-			logger().debug("\tStokes solve time {}s", time.getElapsedTimeInSec());
-			logger().debug("\tStokes solver error: {}", (stoke_stiffness * x - b).norm());
-
+			// the dofs without any coupling (zero columns) are fixed, like the dirichlet nodes
 			std::vector<bool> zero_col(stoke_stiffness.cols(), true);
 			for (int k = 0; k < stoke_stiffness.outerSize(); ++k)
 			{
@@ -99,6 +112,16 @@ namespace polyfem
 				}
 			}
 
+			time.start();
+
+			Eigen::VectorXd b = rhs;
+			solve_linear(stoke_stiffness, b, boundary_nodes, skipping, precond_num, use_avg_pressure, x);
+			// solver->get_info(solver_info);
+			time.stop();
+			stokes_solve_time = time.getElapsedTimeInSec();
+			logger().debug("\tStokes solve time {}s", time.getElapsedTimeInSec());
+			POLYFEM_LOG_DEBUG("\tStokes solver error: {}", (stoke_stiffness * x - b).norm());
+
 			assembly_time = 0;
 			inverting_time = 0;
 
@@ -116,7 +139,7 @@ namespace polyfem
 							   use_avg_pressure,
 							   problem_dim,
 							   is_volume,
-							   velocity_stiffness, mixed_stiffness, pressure_stiffness, b, 1e-3, solver, nlres_norm, x);
+							   velocity_stiffness, mixed_stiffness, pressure_stiffness, b, 1e-3, nlres_norm, x);
 			it += minimize_aux(false, skipping,
 							   n_bases,
 							   n_pressure_bases,
@@ -128,7 +151,7 @@ namespace polyfem
 							   use_avg_pressure,
 							   problem_dim,
 							   is_volume,
-							   velocity_stiffness, mixed_stiffness, pressure_stiffness, b, gradNorm, solver, nlres_norm, x);
+							   velocity_stiffness, mixed_stiffness, pressure_stiffness, b, gradNorm, nlres_norm, x);
 
 			solver_info["iterations"] = it;
 			solver_info["gradNorm"] = nlres_norm;
@@ -157,7 +180,7 @@ namespace polyfem
 			const bool is_volume,
 			const StiffnessMatrix &velocity_stiffness, const StiffnessMatrix &mixed_stiffness, const StiffnessMatrix &pressure_stiffness,
 			const Eigen::VectorXd &rhs, const double grad_norm,
-			std::unique_ptr<linear::Solver> &solver, double &nlres_norm,
+			double &nlres_norm,
 			Eigen::VectorXd &x)
 		{
 			igl::Timer time;
@@ -202,13 +225,13 @@ namespace polyfem
 														 velocity_stiffness + nl_matrix, mixed_stiffness, pressure_stiffness,
 														 total_matrix);
 				}
-				dirichlet_solve(*solver, total_matrix, nlres, boundary_nodes, dx, precond_num, "", false, true, use_avg_pressure);
+				solve_linear(total_matrix, nlres, boundary_nodes, skipping, precond_num, use_avg_pressure, dx);
 				// for (int i : boundary_nodes)
 				// 	dx[i] = 0;
 				time.stop();
 				inverting_time += time.getElapsedTimeInSec();
 				logger().debug("\tinverting time {}s", time.getElapsedTimeInSec());
-				logger().debug("\tinverting error: {}", (total_matrix * dx - nlres).norm());
+				POLYFEM_LOG_DEBUG("\tinverting error: {}", (total_matrix * dx - nlres).norm());
 
 				x += dx;
 				// TODO check for nans
@@ -1,8 +1,12 @@
 #include "OperatorSplittingSolver.hpp"
 #include <unsupported/Eigen/SparseExtra>
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 #include <polysolve/linear/FEMSolver.hpp>
 
+#include <limits>
+
 #ifdef POLYFEM_WITH_OPENVDB
 #include <openvdb/openvdb.h>
 #endif
@@ -79,7 +83,8 @@ namespace polyfem::solver
 			logger().debug("hash grid in {} dimension: {}", d, hash_table_cell_num(d));
 			total_cell_num *= hash_table_cell_num(d);
 		}
-		hash_table.resize(total_cell_num);
+		// cell ranges of the element bounding boxes
+		Eigen::Matrix<long, Eigen::Dynamic, Eigen::Dynamic> cell_ranges(T.rows(), 2 * dim);
 		for (int e = 0; e < T.rows(); e++)
 		{
 			Eigen::VectorXd min_ = V.row(T(e, 0));
@@ -92,51 +97,72 @@ namespace polyfem::solver
 				max_ = max_.cwiseMax(p);
 			}
 
-			Eigen::Matrix<long, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> min_int(dim), max_int(dim);
-
 			for (int d = 0; d < dim; d++)
 			{
 				double temp = hash_table_cell_num(d) / (max_domain(d) - min_domain(d));
-				min_int(d) = floor((min_(d) * (1 - 1e-14) - min_domain(d)) * temp);
-				max_int(d) = ceil((max_(d) * (1 + 1e-14) - min_domain(d)) * temp);
-
-				min_int = min_int.cwiseMax(0);
-				max_int = max_int.cwiseMin(hash_table_cell_num);
+				cell_ranges(e, d) = std::max(0l, (long)floor((min_(d) * (1 - 1e-14) - min_domain(d)) * temp));
+				cell_ranges(e, dim + d) = std::min(hash_table_cell_num(d), (long)ceil((max_(d) * (1 + 1e-14) - min_domain(d)) * temp));
 			}
+		}
 
-			for (long x = min_int(0); x < max_int(0); x++)
+		const auto for_each_cell = [&](const int e, const auto &f) {
+			for (long x = cell_ranges(e, 0); x < cell_ranges(e, dim); x++)
 			{
-				for (long y = min_int(1); y < max_int(1); y++)
+				for (long y = cell_ranges(e, 1); y < cell_ranges(e, dim + 1); y++)
 				{
 					if (dim == 2)
-					{
-						long idx = x + y * hash_table_cell_num(0);
-						hash_table[idx].push_back(e);
-					}
+						f(x + y * hash_table_cell_num(0));
 					else
 					{
-						for (long z = min_int(2); z < max_int(2); z++)
-						{
-							long idx = x + (y + z * hash_table_cell_num(1)) * hash_table_cell_num(0);
-							hash_table[idx].push_back(e);
-						}
+						for (long z = cell_ranges(e, 2); z < cell_ranges(e, 5); z++)
+							f(x + (y + z * hash_table_cell_num(1)) * hash_table_cell_num(0));
 					}
 				}
 			}
-		}
+		};
 
-		float average_intersection_num = 0;
-		int max_intersection_num = 0;
-		for (int i = 0; i < hash_table.size(); i++)
-		{
-			average_intersection_num += hash_table[i].size();
-			(hash_table[i].size() > max_intersection_num) ? (max_intersection_num = hash_table[i].size()) : 1;
-		}
-		average_intersection_num /= hash_table.size();
-		logger().debug("average intersection number for hash grid: {}", average_intersection_num);
+		// two passes, count then fill, the elements of a cell stay sorted by id
+		hash_table_offsets.assign(total_cell_num + 1, 0);
+		for (int e = 0; e < T.rows(); e++)
+			for_each_cell(e, [&](const long idx) { ++hash_table_offsets[idx + 1]; });
+		for (long i = 0; i < total_cell_num; i++)
+			hash_table_offsets[i + 1] += hash_table_offsets[i];
+
+		hash_table_elements.resize(hash_table_offsets.back());
+		std::vector<long> fill(hash_table_offsets.begin(), hash_table_offsets.end() - 1);
+		for (int e = 0; e < T.rows(); e++)
+			for_each_cell(e, [&](const long idx) { hash_table_elements[fill[idx]++] = e; });
+
+		long max_intersection_num = 0;
+		for (long i = 0; i < total_cell_num; i++)
+			max_intersection_num = std::max(max_intersection_num, hash_table_offsets[i + 1] - hash_table_offsets[i]);
+		logger().debug("average intersection number for hash grid: {}", double(hash_table_elements.size()) / total_cell_num);
 		logger().debug("max intersection number for hash grid: {}", max_intersection_num);
 	}
 
+	void OperatorSplittingSolver::initialize_simplex_maps(const std::vector<basis::ElementBases> &gbases)
+	{
+		if (shape != dim + 1 || simplex_maps.size() == gbases.size())
+			return;
+
+		// same linearization at the origin of the reference element as calculate_local_pts
+		const Eigen::MatrixXd origin = Eigen::MatrixXd::Zero(1, dim);
+		simplex_maps.resize(gbases.size());
+		utils::maybe_parallel_for(gbases.size(), [&](int e) {
+			Eigen::MatrixXd mapped;
+			gbases[e].eval_geom_mapping(origin, mapped);
+			std::vector<Eigen::MatrixXd> grads;
+			gbases[e].eval_geom_mapping_grads(origin, grads);
+			const Eigen::MatrixXd inv_jacobi = grads[0].transpose().inverse();
+
+			Eigen::Matrix4d &map = simplex_maps[e];
+			map.setZero();
+			map.topLeftCorner(dim, dim) = inv_jacobi;
+			map.block(0, 3, dim, 1) = -inv_jacobi * mapped.row(0).transpose();
+			map(3, 3) = 1;
+		});
+	}
+
 	void OperatorSplittingSolver::initialize_solver(const mesh::Mesh &mesh,
 													const int shape_, const int n_el_,
 													const std::vector<mesh::LocalBoundary> &local_boundary,
@@ -183,14 +209,10 @@ namespace polyfem::solver
 			prefactorize(*solver_mass, mat1, boundary_nodes_, mat1.rows(), "");
 		}
 
-		mat_diffusion = mass + viscosity_ * dt * stiffness_viscosity;
-
+		mass_diffusion = mass;
+		stiffness_diffusion = stiffness_viscosity;
 		solver_diffusion = polysolve::linear::Solver::create(params, logger());
-		// if (solver_type == "Pardiso" || solver_type == "Eigen::SimplicialLDLT" || solver_type == "Eigen::SparseLU")
-		{
-			StiffnessMatrix mat1 = mat_diffusion;
-			prefactorize(*solver_diffusion, mat1, bnd_nodes, mat1.rows(), "");
-		}
+		update_diffusion(dt, viscosity_);
 
 		if (pressure_boundary_nodes.size() == 0)
 			mat_projection.resize(stiffness_velocity.rows() + 1, stiffness_velocity.cols() + 1);
@@ -232,36 +254,22 @@ namespace polyfem::solver
 
 	int OperatorSplittingSolver::handle_boundary_advection(RowVectorNd &pos)
 	{
-		double dist = 1e10;
+		// serial on purpose, it is called from the parallel advection loops
+		double dist = std::numeric_limits<double>::max();
 		int idx = -1, local_idx = -1;
-		const int size = boundary_elem_id.size();
-#ifdef POLYFEM_WITH_TBB
-		tbb::parallel_for(0, size, 1, [&](int e)
-#else
-		for (int e = 0; e < size; e++)
-#endif
-						  {
-							  int elem_idx = boundary_elem_id[e];
-
-							  for (int i = 0; i < shape; i++)
-							  {
-								  double dist_ = 0;
-								  for (int d = 0; d < dim; d++)
-								  {
-									  dist_ += pow(pos(d) - V(T(elem_idx, i), d), 2);
-								  }
-								  dist_ = sqrt(dist_);
-								  if (dist_ < dist)
-								  {
-									  dist = dist_;
-									  idx = elem_idx;
-									  local_idx = i;
-								  }
-							  }
-						  }
-#ifdef POLYFEM_WITH_TBB
-		);
-#endif
+		for (const int elem_idx : boundary_elem_id)
+		{
+			for (int i = 0; i < shape; i++)
+			{
+				const double dist_ = (pos.head(dim) - V.row(T(elem_idx, i)).head(dim)).squaredNorm();
+				if (dist_ < dist)
+				{
+					dist = dist_;
+					idx = elem_idx;
+					local_idx = i;
+				}
+			}
+		}
 		for (int d = 0; d < dim; d++)
 			pos(d) = V(T(idx, local_idx), d);
 		return idx;
@@ -275,11 +283,12 @@ namespace polyfem::solver
 											RowVectorNd &vel_2,
 											Eigen::MatrixXd &local_pos,
 											const Eigen::MatrixXd &sol,
-											const double dt)
+											const double dt,
+											const int hint)
 	{
 		pos_2 = pos_1 - vel_1 * dt;
 
-		return interpolator(gbases, bases, pos_2, vel_2, local_pos, sol);
+		return interpolator(gbases, bases, pos_2, vel_2, local_pos, sol, hint);
 	}
 
 	int OperatorSplittingSolver::interpolator(const std::vector<basis::ElementBases> &gbases,
@@ -287,12 +296,13 @@ namespace polyfem::solver
 											  const RowVectorNd &pos,
 											  RowVectorNd &vel,
 											  Eigen::MatrixXd &local_pos,
-											  const Eigen::MatrixXd &sol)
+											  const Eigen::MatrixXd &sol,
+											  const int hint)
 	{
 		bool insideDomain = true;
 
 		int new_elem;
-		if ((new_elem = search_cell(gbases, pos, local_pos)) == -1)
+		if ((new_elem = search_cell(gbases, pos, local_pos, hint)) == -1)
 		{
 			insideDomain = false;
 			RowVectorNd pos_ = pos;
@@ -360,48 +370,57 @@ namespace polyfem::solver
 											const int order,
 											const int RK)
 	{
+		initialize_simplex_maps(gbases);
+
 		// to store new velocity
 		Eigen::MatrixXd new_sol = Eigen::MatrixXd::Zero(sol.size(), 1);
 		// number of FEM nodes
 		const int n_vert = sol.size() / dim;
-		Eigen::VectorXi traversed = Eigen::VectorXi::Zero(n_vert);
 
-#ifdef POLYFEM_WITH_TBB
-		tbb::parallel_for(0, n_el, 1, [&](int e)
-#else
+		// every FEM node is advected once, by the first element containing it
+		Eigen::VectorXi owner = Eigen::VectorXi::Constant(n_vert, -1);
 		for (int e = 0; e < n_el; ++e)
-#endif
-						  {
-							  // to compute global position with barycentric coordinate
-							  Eigen::MatrixXd mapped;
-							  gbases[e].eval_geom_mapping(local_pts, mapped);
+		{
+			for (int i = 0; i < local_pts.rows(); i++)
+			{
+				const int global = bases[e].bases[i].global()[0].index;
+				if (owner(global) < 0)
+					owner(global) = e;
+			}
+		}
 
-							  for (int i = 0; i < local_pts.rows(); i++)
-							  {
-								  // global index of this FEM node
-								  int global = bases[e].bases[i].global()[0].index;
+		utils::maybe_parallel_for(n_el, [&](int start, int end, int thread_id) {
+			// element of the previous departure point of this thread, first guess for the next one
+			int hint = -1;
+			Eigen::MatrixXd mapped, local_pos;
+			for (int e = start; e < end; ++e)
+			{
+				// to compute global position with barycentric coordinate
+				gbases[e].eval_geom_mapping(local_pts, mapped);
 
-								  if (traversed(global))
-									  continue;
-								  traversed(global) = 1;
+				for (int i = 0; i < local_pts.rows(); i++)
+				{
+					// global index of this FEM node
+					const int global = bases[e].bases[i].global()[0].index;
+					if (owner(global) != e)
+						continue;
 
-								  // velocity of this FEM node
-								  RowVectorNd vel_ = sol.block(global * dim, 0, dim, 1).transpose();
+					// velocity of this FEM node
+					RowVectorNd vel_ = sol.block(global * dim, 0, dim, 1).transpose();
 
-								  // global position of this FEM node
-								  RowVectorNd pos_ = RowVectorNd::Zero(1, dim);
-								  for (int d = 0; d < dim; d++)
-									  pos_(d) = mapped(i, d) - vel_(d) * dt;
+					// global position of this FEM node
+					RowVectorNd pos_ = RowVectorNd::Zero(1, dim);
+					for (int d = 0; d < dim; d++)
+						pos_(d) = mapped(i, d) - vel_(d) * dt;
 
-								  Eigen::MatrixXd local_pos;
-								  interpolator(gbases, bases, pos_, vel_, local_pos, sol);
+					const int elem = interpolator(gbases, bases, pos_, vel_, local_pos, sol, hint >= 0 ? hint : e);
+					if (elem >= 0)
+						hint = elem;
 
-								  new_sol.block(global * dim, 0, dim, 1) = vel_.transpose();
-							  }
-						  }
-#ifdef POLYFEM_WITH_TBB
-		);
-#endif
+					new_sol.block(global * dim, 0, dim, 1) = vel_.transpose();
+				}
+			}
+		});
 		sol.swap(new_sol);
 	}
 
@@ -484,6 +503,8 @@ namespace polyfem::solver
 												 const double dt,
 												 const int RK)
 	{
+		initialize_simplex_maps(gbases);
+
 		Eigen::VectorXd new_density = Eigen::VectorXd::Zero(density.size());
 		const int Nx = grid_cell_num(0);
 #ifdef POLYFEM_WITH_TBB
@@ -492,6 +513,8 @@ namespace polyfem::solver
 		for (int i = 0; i <= Nx; i++)
 #endif
 						  {
+							  // element of the previous grid point, first guess for the next one
+							  int hint = -1;
 							  for (int j = 0; j <= grid_cell_num(1); j++)
 							  {
 								  Eigen::MatrixXd local_pos;
@@ -503,12 +526,14 @@ namespace polyfem::solver
 									  const long idx = i + (long)j * (grid_cell_num(0) + 1);
 
 									  RowVectorNd vel1, pos_;
-									  interpolator(gbases, bases, pos, vel1, local_pos, sol);
+									  const int elem = interpolator(gbases, bases, pos, vel1, local_pos, sol, hint);
+									  if (elem >= 0)
+									  	hint = elem;
 									  if (RK > 1)
 									  {
 										  RowVectorNd vel2, vel3;
-										  interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol);
-										  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol);
+										  interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol, hint);
+										  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol, hint);
 										  pos_ = pos - (2 * vel1 + 3 * vel2 + 4 * vel3) * dt / 9;
 									  }
 									  else
@@ -528,12 +553,14 @@ namespace polyfem::solver
 										  const long idx = i + (j + (long)k * (grid_cell_num(1) + 1)) * (grid_cell_num(0) + 1);
 
 										  RowVectorNd vel1, pos_;
-										  interpolator(gbases, bases, pos, vel1, local_pos, sol);
+										  const int elem = interpolator(gbases, bases, pos, vel1, local_pos, sol, hint);
+										  if (elem >= 0)
+										  	hint = elem;
 										  if (RK > 1)
 										  {
 											  RowVectorNd vel2, vel3;
-											  interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol);
-											  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol);
+											  interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol, hint);
+											  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol, hint);
 											  pos_ = pos - (2 * vel1 + 3 * vel2 + 4 * vel3) * dt / 9;
 										  }
 										  else
@@ -553,6 +580,8 @@ namespace polyfem::solver
 
 	void OperatorSplittingSolver::advection_FLIP(const mesh::Mesh &mesh, const std::vector<basis::ElementBases> &gbases, const std::vector<basis::ElementBases> &bases, Eigen::MatrixXd &sol, const double dt, const Eigen::MatrixXd &local_pts, const int order)
 	{
+		initialize_simplex_maps(gbases);
+
 		const int ppe = shape; // particle per element
 		const double FLIPRatio = 1;
 		// initialize or resample particles and update velocity via g2p
@@ -726,8 +755,9 @@ namespace polyfem::solver
 							  // update particle position via advection
 							  RowVectorNd newvel;
 							  Eigen::MatrixXd local_pos;
+							  // the cell of the particle is the first guess for the cell of its new position
 							  cellI_particle[pI] = trace_back(gbases, bases, position_particle[pI], velocity_particle[pI],
-															  position_particle[pI], newvel, local_pos, sol, -dt);
+															  position_particle[pI], newvel, local_pos, sol, -dt, cellI_particle[pI]);
 
 							  // RK3:
 							  // RowVectorNd bypass, vel2, vel3;
@@ -793,6 +823,8 @@ namespace polyfem::solver
 		Eigen::MatrixXd new_sol_w = Eigen::MatrixXd::Zero(sol.size() / dim, 1);
 		new_sol_w.array() += 1e-13;
 
+		initialize_simplex_maps(gbases);
+
 		const int ppe = shape; // particle per element
 		std::vector<assembler::ElementAssemblyValues> velocity_interpolator(ppe * n_el);
 		position_particle.resize(ppe * n_el);
@@ -849,7 +881,7 @@ namespace polyfem::solver
 								  RowVectorNd newvel;
 								  Eigen::MatrixXd local_pos;
 								  cellI_particle[ppe * e + j] = trace_back(gbases, bases, position_particle[ppe * e + j], velocity_particle[e * ppe + j],
-																		   position_particle[ppe * e + j], newvel, local_pos, sol, -dt);
+																		   position_particle[ppe * e + j], newvel, local_pos, sol, -dt, e);
 
 								  // RK3:
 								  // RowVectorNd bypass, vel2, vel3;
@@ -909,6 +941,22 @@ namespace polyfem::solver
 		// TODO: need to think about what to do with negative quadratic weight
 	}
 
+	void OperatorSplittingSolver::update_diffusion(const double dt, const double viscosity)
+	{
+		if (dt == dt_diffusion && viscosity == viscosity_diffusion)
+			return;
+
+		mat_diffusion = mass_diffusion + viscosity * dt * stiffness_diffusion;
+		// if (solver_type == "Pardiso" || solver_type == "Eigen::SimplicialLDLT" || solver_type == "Eigen::SparseLU")
+		{
+			StiffnessMatrix mat1 = mat_diffusion;
+			prefactorize(*solver_diffusion, mat1, boundary_nodes, mat1.rows(), "");
+		}
+
+		dt_diffusion = dt;
+		viscosity_diffusion = viscosity;
+	}
+
 	void OperatorSplittingSolver::solve_diffusion_1st(const StiffnessMatrix &mass, const std::vector<int> &bnd_nodes, Eigen::MatrixXd &sol)
 	{
 		Eigen::VectorXd rhs;
@@ -954,35 +1002,40 @@ namespace polyfem::solver
 												 const std::shared_ptr<assembler::Problem> problem,
 												 const double time)
 	{
-#ifdef POLYFEM_WITH_TBB
-		tbb::parallel_for(0, n_el, 1, [&](int e)
-#else
-		for (int e = 0; e < n_el; e++)
-#endif
-						  {
-							  Eigen::MatrixXd mapped;
-							  gbases[e].eval_geom_mapping(local_pts, mapped);
+		// the nodes do not move, their positions are mapped once and only the forces are evaluated at every step
+		if (force_nodes.empty())
+		{
+			std::vector<RowVectorNd> positions;
+			Eigen::MatrixXd mapped;
+			for (int e = 0; e < n_el; e++)
+			{
+				gbases[e].eval_geom_mapping(local_pts, mapped);
 
-							  for (int local_idx = 0; local_idx < bases[e].bases.size(); local_idx++)
-							  {
-								  int global_idx = bases[e].bases[local_idx].global()[0].index;
+				for (int local_idx = 0; local_idx < bases[e].bases.size(); local_idx++)
+				{
+					force_nodes.push_back(bases[e].bases[local_idx].global()[0].index);
+					positions.push_back(mapped.row(local_idx));
+				}
+			}
 
-								  Eigen::MatrixXd pos = Eigen::MatrixXd::Zero(1, dim);
-								  for (int d = 0; d < dim; d++)
-									  pos(0, d) = mapped(local_idx, d);
+			force_positions.resize(positions.size(), dim);
+			for (int k = 0; k < positions.size(); k++)
+				force_positions.row(k) = positions[k];
+		}
 
-								  Eigen::MatrixXd val;
-								  problem->rhs(assembler, pos, time, val);
+		Eigen::MatrixXd forces(force_positions.rows(), dim);
+		utils::maybe_parallel_for(force_positions.rows(), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd val;
+			problem->rhs(assembler, force_positions.middleRows(start, end - start), time, val);
+			forces.middleRows(start, end - start) = val;
+		});
 
-								  for (int d = 0; d < dim; d++)
-								  {
-									  sol(global_idx * dim + d) += val(d) * dt;
-								  }
-							  }
-						  }
-#ifdef POLYFEM_WITH_TBB
-		);
-#endif
+		// every element adds the force of its nodes, serially since the nodes are shared
+		for (int k = 0; k < force_nodes.size(); k++)
+		{
+			for (int d = 0; d < dim; d++)
+				sol(force_nodes[k] * dim + d) += forces(k, d) * dt;
+		}
 	}
 
 	void OperatorSplittingSolver::solve_pressure(const StiffnessMatrix &mixed_stiffness, const std::vector<int> &pressure_boundary_nodes, Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
@@ -1035,15 +1088,8 @@ namespace polyfem::solver
 			rhs(boundary_nodes_[i]) = 0;
 		}
 
-		if (solver_diffusion->name() == "Pardiso" || solver_diffusion->name() == "Eigen::SimplicialLDLT" || solver_diffusion->name() == "Eigen::SparseLU")
-		{
-			dirichlet_solve_prefactorized(*solver_mass, velocity_mass, rhs, boundary_nodes_, dx);
-		}
-		else
-		{
-			auto mat = velocity_mass;
-			dirichlet_solve(*solver_mass, mat, rhs, boundary_nodes_, dx, velocity_mass.rows(), "", false, false, false);
-		}
+		// solver_mass is factorized once in the constructor, for direct and iterative solvers alike
+		dirichlet_solve_prefactorized(*solver_mass, velocity_mass, rhs, boundary_nodes_, dx);
 
 		sol -= dx;
 	}
@@ -1056,9 +1102,28 @@ namespace polyfem::solver
 											 Eigen::MatrixXd &pressure,
 											 Eigen::MatrixXd &sol)
 	{
-		Eigen::VectorXd grad_pressure = Eigen::VectorXd::Zero(n_bases * dim);
+		if (pressure_gradient.rows() != n_bases * dim || pressure_gradient.cols() != pressure.size())
+			build_pressure_gradient(n_bases, gbases, bases, pressure_bases, local_pts, pressure.size());
+
+		sol -= pressure_gradient * pressure;
+	}
+
+	void OperatorSplittingSolver::build_pressure_gradient(int n_bases,
+														  const std::vector<basis::ElementBases> &gbases,
+														  const std::vector<basis::ElementBases> &bases,
+														  const std::vector<basis::ElementBases> &pressure_bases,
+														  const Eigen::MatrixXd &local_pts,
+														  const int n_pressure_bases)
+	{
+		// the gradient at a velocity node is averaged over the elements sharing it
 		Eigen::VectorXi traversed = Eigen::VectorXi::Zero(n_bases);
+		for (int e = 0; e < n_el; ++e)
+		{
+			for (int j = 0; j < local_pts.rows(); j++)
+				traversed(bases[e].bases[j].global()[0].index)++;
+		}
 
+		std::vector<Eigen::Triplet<double>> entries;
 		assembler::ElementAssemblyValues vals;
 		for (int e = 0; e < n_el; ++e)
 		{
@@ -1068,22 +1133,16 @@ namespace polyfem::solver
 				int global_ = bases[e].bases[j].global()[0].index;
 				for (int i = 0; i < vals.basis_values.size(); i++)
 				{
+					assert(pressure_bases[e].bases[i].global().size() == 1);
+					const int pressure_global = pressure_bases[e].bases[i].global()[0].index;
 					for (int d = 0; d < dim; d++)
-					{
-						assert(pressure_bases[e].bases[i].global().size() == 1);
-						grad_pressure(global_ * dim + d) += vals.basis_values[i].grad_t_m(j, d) * pressure(pressure_bases[e].bases[i].global()[0].index);
-					}
+						entries.emplace_back(global_ * dim + d, pressure_global, vals.basis_values[i].grad_t_m(j, d) / traversed(global_));
 				}
-				traversed(global_)++;
-			}
-		}
-		for (int i = 0; i < traversed.size(); i++)
-		{
-			for (int d = 0; d < dim; d++)
-			{
-				sol(i * dim + d) -= grad_pressure(i * dim + d) / traversed(i);
 			}
 		}
+
+		pressure_gradient.resize(n_bases * dim, n_pressure_bases);
+		pressure_gradient.setFromTriplets(entries.begin(), entries.end());
 	}
 
 	void OperatorSplittingSolver::initialize_density(const std::shared_ptr<assembler::Problem> &problem)
@@ -1116,8 +1175,12 @@ namespace polyfem::solver
 		}
 	}
 
-	long OperatorSplittingSolver::search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts)
+	long OperatorSplittingSolver::search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts, const long hint)
 	{
+		// consecutive points (nodes of the same element, particles between steps) mostly land in the same element
+		if (hint >= 0 && inside_element(gbases, hint, pos, local_pts))
+			return hint;
+
 		Eigen::Matrix<long, Eigen::Dynamic, 1> pos_int(dim);
 		for (int d = 0; d < dim; d++)
 		{
@@ -1135,25 +1198,37 @@ namespace polyfem::solver
 			dim_num *= hash_table_cell_num(d);
 		}
 
-		const std::vector<long> &list = hash_table[idx];
-		for (auto it = list.begin(); it != list.end(); it++)
+		for (long i = hash_table_offsets[idx]; i < hash_table_offsets[idx + 1]; i++)
 		{
-			calculate_local_pts(gbases[*it], *it, pos, local_pts);
-
-			if (shape == dim + 1)
-			{
-				if (local_pts.minCoeff() > -1e-13 && local_pts.sum() < 1 + 1e-13)
-					return *it;
-			}
-			else
-			{
-				if (local_pts.minCoeff() > -1e-13 && local_pts.maxCoeff() < 1 + 1e-13)
-					return *it;
-			}
+			const int e = hash_table_elements[i];
+			if (e != hint && inside_element(gbases, e, pos, local_pts))
+				return e;
 		}
 		return -1; // not inside any elem
 	}
 
+	bool OperatorSplittingSolver::inside_element(const std::vector<basis::ElementBases> &gbases, const long elem_idx, const RowVectorNd &pos, Eigen::MatrixXd &local_pts)
+	{
+		if (shape == dim + 1 && !simplex_maps.empty())
+		{
+			// barycentric test with fixed size (vectorized) products, the padding entries are zero in 2D
+			Eigen::Vector4d p = Eigen::Vector4d::Zero();
+			p.head(dim) = pos.head(dim).transpose();
+			p(3) = 1;
+			const Eigen::Vector4d lambda = simplex_maps[elem_idx] * p;
+
+			local_pts = lambda.head(dim).transpose();
+			return lambda.head<3>().minCoeff() > -1e-13 && lambda.head<3>().sum() < 1 + 1e-13;
+		}
+
+		calculate_local_pts(gbases[elem_idx], elem_idx, pos, local_pts);
+
+		if (shape == dim + 1)
+			return local_pts.minCoeff() > -1e-13 && local_pts.sum() < 1 + 1e-13;
+		else
+			return local_pts.minCoeff() > -1e-13 && local_pts.maxCoeff() < 1 + 1e-13;
+	}
+
 	bool OperatorSplittingSolver::outside_quad(const std::vector<RowVectorNd> &vert, const RowVectorNd &pos)
 	{
 		double a = (vert[1](0) - vert[0](0)) * (pos(1) - vert[0](1)) - (vert[1](1) - vert[0](1)) * (pos(0) - vert[0](0));
@@ -32,6 +32,10 @@ namespace polyfem
 
 			void initialize_hashtable(const mesh::Mesh &mesh);
 
+			/// precomputes the affine inverse maps of the simplicial elements used by the point location,
+			/// does nothing for quads/hexes or if they are already built
+			void initialize_simplex_maps(const std::vector<basis::ElementBases> &gbases);
+
 			OperatorSplittingSolver() {}
 
 			void initialize_solver(const mesh::Mesh &mesh,
@@ -68,14 +72,16 @@ namespace polyfem
 						   RowVectorNd &vel_2,
 						   Eigen::MatrixXd &local_pos,
 						   const Eigen::MatrixXd &sol,
-						   const double dt);
+						   const double dt,
+						   const int hint = -1);
 
 			int interpolator(const std::vector<basis::ElementBases> &gbases,
 							 const std::vector<basis::ElementBases> &bases,
 							 const RowVectorNd &pos,
 							 RowVectorNd &vel,
 							 Eigen::MatrixXd &local_pos,
-							 const Eigen::MatrixXd &sol);
+							 const Eigen::MatrixXd &sol,
+							 const int hint = -1);
 
 			void interpolator(const RowVectorNd &pos, double &val);
 
@@ -106,8 +112,14 @@ namespace polyfem
 
 			void advection_PIC(const mesh::Mesh &mesh, const std::vector<basis::ElementBases> &gbases, const std::vector<basis::ElementBases> &bases, Eigen::MatrixXd &sol, const double dt, const Eigen::MatrixXd &local_pts, const int order = 1);
 
+			/// rebuilds and refactorizes the diffusion operator M + dt viscosity K only if dt or the viscosity changed,
+			/// otherwise every step is a back-substitution with the cached factorization.
+			/// The pressure Poisson factorization only depends on the mesh, a new solver is needed if the mesh changes.
+			void update_diffusion(const double dt, const double viscosity);
+
 			void solve_diffusion_1st(const StiffnessMatrix &mass, const std::vector<int> &bnd_nodes, Eigen::MatrixXd &sol);
 
+			/// adds dt times the body force at the nodes, the node positions are computed by the first call
 			void external_force(const mesh::Mesh &mesh,
 								const assembler::Assembler &assembler,
 								const std::vector<basis::ElementBases> &gbases,
@@ -122,6 +134,8 @@ namespace polyfem
 
 			void projection(const StiffnessMatrix &velocity_mass, const StiffnessMatrix &mixed_stiffness, const std::vector<int> &boundary_nodes_, Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure);
 
+			/// subtracts the pressure gradient averaged at the velocity nodes, the gradient operator
+			/// is built by the first call and every step is a sparse product
 			void projection(int n_bases,
 							const std::vector<basis::ElementBases> &gbases,
 							const std::vector<basis::ElementBases> &bases,
@@ -130,9 +144,21 @@ namespace polyfem
 							Eigen::MatrixXd &pressure,
 							Eigen::MatrixXd &sol);
 
+			void build_pressure_gradient(int n_bases,
+										 const std::vector<basis::ElementBases> &gbases,
+										 const std::vector<basis::ElementBases> &bases,
+										 const std::vector<basis::ElementBases> &pressure_bases,
+										 const Eigen::MatrixXd &local_pts,
+										 const int n_pressure_bases);
+
 			void initialize_density(const std::shared_ptr<assembler::Problem> &problem);
 
-			long search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts);
+			/// finds the element containing pos, returns -1 if pos is outside the mesh
+			/// @param[in] hint element tested before the hash grid candidates (eg the element found for the previous point), ignored if negative
+			long search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts, const long hint = -1);
+
+			/// computes the local coordinates of pos in elem_idx and checks if they are inside the reference element
+			bool inside_element(const std::vector<basis::ElementBases> &gbases, const long elem_idx, const RowVectorNd &pos, Eigen::MatrixXd &local_pts);
 
 			bool outside_quad(const std::vector<RowVectorNd> &vert, const RowVectorNd &pos);
 
@@ -157,9 +183,14 @@ namespace polyfem
 			Eigen::MatrixXd V;
 			Eigen::MatrixXi T;
 
-			std::vector<std::vector<long>> hash_table;
+			// hash grid in CSR format, the elements overlapping cell i are hash_table_elements[hash_table_offsets[i]...hash_table_offsets[i+1]]
+			std::vector<long> hash_table_offsets;
+			std::vector<int> hash_table_elements;
 			Eigen::Matrix<long, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> hash_table_cell_num;
 
+			// local coordinates of simplex e are the first dim entries of simplex_maps[e] * (x, y, z, 1), padded with zeros in 2D
+			std::vector<Eigen::Matrix4d, Eigen::aligned_allocator<Eigen::Matrix4d>> simplex_maps;
+
 			std::vector<Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 3>> position_particle;
 			std::vector<Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 3>> velocity_particle;
 			std::vector<int> cellI_particle;
@@ -174,8 +205,18 @@ namespace polyfem
 			std::unique_ptr<polysolve::linear::Solver> solver_mass;
 
 			StiffnessMatrix mat_diffusion;
+			// operators and parameters of the cached diffusion factorization
+			StiffnessMatrix mass_diffusion;
+			StiffnessMatrix stiffness_diffusion;
+			double dt_diffusion = -1;
+			double viscosity_diffusion = -1;
 			StiffnessMatrix mat_projection;
 
+			// step operators that only depend on the mesh, kept across the time steps
+			StiffnessMatrix pressure_gradient;
+			std::vector<int> force_nodes;
+			Eigen::MatrixXd force_positions;
+
 			Eigen::VectorXd density;
 			// Eigen::VectorXi density_cell_no;
 			// std::vector<ElementAssemblyValues> density_local_weights;
@@ -23,6 +23,7 @@
 
 #include <polyfem/io/OBJReader.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/JSONSpec.hpp>
 #include <polyfem/io/MatrixIO.hpp>
 
 #include <polysolve/nonlinear/BoxConstraintSolver.hpp>
@@ -248,6 +249,8 @@ namespace polyfem::solver
 						knots_v(i) = args["knots_v"][i].get<double>();
 					tmp->set_bspline_target(control_points_grid, knots_u, knots_v, delta);
 				}
+				if (args.contains("precompute_grid") && args["precompute_grid"].get<bool>())
+					tmp->precompute_grid();
 
 				obj = tmp;
 			}
@@ -261,6 +264,8 @@ namespace polyfem::solver
 				if (!read)
 					log_and_throw_error(fmt::format("Could not read mesh! {}", args["mesh"]));
 				tmp->set_surface_mesh_target(V, F, delta);
+				if (args.contains("precompute_grid") && args["precompute_grid"].get<bool>())
+					tmp->precompute_grid();
 				obj = tmp;
 			}
 			else if (type == "function-target")
@@ -431,7 +436,7 @@ namespace polyfem::solver
 		}
 		else if (type == "bounded-biharmonic-weights")
 		{
-			map = std::make_shared<BoundedBiharmonicWeights2Dto3D>(args["num_control_vertices"], args["num_vertices"], *states[args["state"]], args["allow_rotations"]);
+			map = std::make_shared<BoundedBiharmonicWeights2Dto3D>(args["num_control_vertices"], args["num_vertices"], *states[args["state"]], args["allow_rotations"], args["weights_cache"]);
 		}
 		else if (type == "scalar-velocity-parametrization")
 		{
@@ -581,30 +586,13 @@ namespace polyfem::solver
 		json args_in = input_args;
 
 		// CHECK validity json
-		json rules;
 		jse::JSE jse;
-		{
-			jse.strict = strict_validation;
-			std::ifstream file(POLYFEM_OPT_INPUT_SPEC);
-
-			if (file.is_open())
-				file >> rules;
-			else
-			{
-				logger().error("unable to open {} rules", POLYFEM_OPT_INPUT_SPEC);
-				throw std::runtime_error("Invald spec file");
-			}
-
-			jse.include_directories.push_back(POLYFEM_JSON_SPEC_DIR);
-			jse.include_directories.push_back(POLYSOLVE_JSON_SPEC_DIR);
-			rules = jse.inject_include(rules);
-
-			// polysolve::linear::Solver::apply_default_solver(rules, "/solver/linear");
-		}
+		jse.strict = strict_validation;
+		const std::shared_ptr<const json> rules = utils::load_spec_rules(POLYFEM_OPT_INPUT_SPEC);
 
 		// polysolve::linear::Solver::select_valid_solver(args_in["solver"]["linear"], logger());
 
-		const bool valid_input = jse.verify_json(args_in, rules);
+		const bool valid_input = jse.verify_json(args_in, *rules);
 
 		if (!valid_input)
 		{
@@ -612,25 +600,13 @@ namespace polyfem::solver
 			throw std::runtime_error("Invald input json file");
 		}
 
-		json args = jse.inject_defaults(args_in, rules);
-
-		json obj_rules;
-		{
-			const std::string polyfem_objective_spec = POLYFEM_OBJECTIVE_INPUT_SPEC;
-			std::ifstream file(polyfem_objective_spec);
+		json args = jse.inject_defaults(args_in, *rules);
 
-			if (file.is_open())
-				file >> obj_rules;
-			else
-			{
-				logger().error("unable to open {} rules", polyfem_objective_spec);
-				throw std::runtime_error("Invald spec file");
-			}
-		}
-		apply_objective_json_spec(args["functionals"], obj_rules);
+		const std::shared_ptr<const json> obj_rules = utils::load_spec_rules(POLYFEM_OBJECTIVE_INPUT_SPEC, false);
+		apply_objective_json_spec(args["functionals"], *obj_rules);
 
 		if (args.contains("stopping_conditions"))
-			apply_objective_json_spec(args["stopping_conditions"], obj_rules);
+			apply_objective_json_spec(args["stopping_conditions"], *obj_rules);
 
 		return args;
 	}
@@ -0,0 +1,194 @@
+#include "PreconditionerReuseSolver.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		namespace
+		{
+			bool same_pattern(const StiffnessMatrix &A, const StiffnessMatrix &B)
+			{
+				if (A.rows() != B.rows() || A.cols() != B.cols() || A.nonZeros() != B.nonZeros() || !A.isCompressed() || !B.isCompressed())
+					return false;
+				return std::equal(A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1, B.outerIndexPtr())
+					   && std::equal(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros(), B.innerIndexPtr());
+			}
+		} // namespace
+
+		PreconditionerReuseSolver::PreconditionerReuseSolver(std::unique_ptr<polysolve::linear::Solver> inner, const double tolerance, const int max_iterations, const double growth, const int restart)
+			: inner_(std::move(inner)), tolerance_(tolerance), max_iterations_(max_iterations), growth_(growth), restart_(restart)
+		{
+			assert(inner_ != nullptr);
+		}
+
+		std::unique_ptr<polysolve::linear::Solver> PreconditionerReuseSolver::wrap(std::unique_ptr<polysolve::linear::Solver> solver, const json &solver_param)
+		{
+			const json &advanced = solver_param["advanced"];
+			if (!advanced["reuse_preconditioner"])
+				return solver;
+			return std::make_unique<PreconditionerReuseSolver>(
+				std::move(solver),
+				advanced["reuse_preconditioner_tolerance"].get<double>(),
+				advanced["reuse_preconditioner_max_iterations"].get<int>(),
+				advanced["reuse_preconditioner_growth"].get<double>());
+		}
+
+		void PreconditionerReuseSolver::analyze_pattern(const StiffnessMatrix &A, const int precond_num)
+		{
+			precond_num_ = precond_num;
+			if (!same_pattern(A, A_))
+				needs_analyze_ = needs_setup_ = true;
+		}
+
+		void PreconditionerReuseSolver::factorize(const StiffnessMatrix &A)
+		{
+			if (!same_pattern(A, A_))
+				needs_analyze_ = needs_setup_ = true;
+			A_ = A;
+			A_.makeCompressed();
+		}
+
+		void PreconditionerReuseSolver::setup()
+		{
+			if (needs_analyze_)
+				inner_->analyze_pattern(A_, precond_num_);
+			inner_->factorize(A_);
+
+			needs_analyze_ = false;
+			needs_setup_ = false;
+			setup_iterations_ = -1;
+			++setups_;
+		}
+
+		void PreconditionerReuseSolver::solve(const Eigen::Ref<const Eigen::VectorXd> b, Eigen::Ref<Eigen::VectorXd> x)
+		{
+			assert(b.size() == A_.rows());
+
+			if (needs_setup_)
+				setup();
+
+			bool converged = fgmres(b, x);
+			if (!converged && setup_iterations_ >= 0)
+			{
+				logger().debug("Reused preconditioner stalled after {} iterations, setting it up again", iterations_);
+				setup();
+				converged = fgmres(b, x);
+			}
+
+			if (setup_iterations_ < 0)
+				setup_iterations_ = iterations_;
+			else if (iterations_ > growth_ * std::max(setup_iterations_, 1))
+				needs_setup_ = true;
+
+			if (!converged)
+				logger().warn("Preconditioned GMRES stopped after {} iterations with residual {}", iterations_, residual_);
+			else
+				logger().trace("Preconditioned GMRES converged in {} iterations, residual {}, {} setups", iterations_, residual_, setups_);
+		}
+
+		bool PreconditionerReuseSolver::fgmres(const Eigen::Ref<const Eigen::VectorXd> b, Eigen::Ref<Eigen::VectorXd> x)
+		{
+			const int n = b.size();
+			const double b_norm = b.norm();
+			x.setZero();
+			iterations_ = 0;
+			residual_ = 0;
+			if (b_norm == 0)
+				return true;
+
+			const int m = std::max(1, std::min(restart_, n));
+			// Krylov basis V, preconditioned directions Z (flexible: the preconditioner can change between iterations)
+			Eigen::MatrixXd V(n, m + 1), Z(n, m);
+			Eigen::MatrixXd H = Eigen::MatrixXd::Zero(m + 1, m);
+			Eigen::VectorXd cs(m), sn(m), g(m + 1);
+			Eigen::VectorXd w(n);
+
+			Eigen::VectorXd r = b;
+			double beta = b_norm;
+			residual_ = 1;
+			while (iterations_ < max_iterations_)
+			{
+				V.col(0) = r / beta;
+				g.setZero();
+				g(0) = beta;
+				H.setZero();
+
+				int k = 0;
+				for (; k < m && iterations_ < max_iterations_; ++k, ++iterations_)
+				{
+					Eigen::Ref<Eigen::VectorXd> z = Z.col(k);
+					z.setZero();
+					inner_->solve(V.col(k), z);
+					w.noalias() = A_ * z;
+
+					// modified Gram-Schmidt
+					for (int i = 0; i <= k; ++i)
+					{
+						H(i, k) = w.dot(V.col(i));
+						w -= H(i, k) * V.col(i);
+					}
+					H(k + 1, k) = w.norm();
+					if (H(k + 1, k) > 0)
+						V.col(k + 1) = w / H(k + 1, k);
+
+					// previous Givens rotations, then the one eliminating H(k + 1, k)
+					for (int i = 0; i < k; ++i)
+					{
+						const double tmp = cs(i) * H(i, k) + sn(i) * H(i + 1, k);
+						H(i + 1, k) = -sn(i) * H(i, k) + cs(i) * H(i + 1, k);
+						H(i, k) = tmp;
+					}
+					const double denom = std::hypot(H(k, k), H(k + 1, k));
+					// breakdown, the direction is dropped
+					if (denom == 0)
+						break;
+					cs(k) = H(k, k) / denom;
+					sn(k) = H(k + 1, k) / denom;
+					H(k, k) = denom;
+					H(k + 1, k) = 0;
+					g(k + 1) = -sn(k) * g(k);
+					g(k) = cs(k) * g(k);
+
+					residual_ = std::abs(g(k + 1)) / b_norm;
+					if (residual_ <= tolerance_)
+					{
+						++k;
+						++iterations_;
+						break;
+					}
+				}
+
+				if (k == 0)
+					break;
+				const Eigen::VectorXd y = H.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+				x.noalias() += Z.leftCols(k) * y;
+
+				// true residual, the recurrence one drifts with an inexact preconditioner
+				r = b - A_ * x;
+				beta = r.norm();
+				residual_ = beta / b_norm;
+				if (residual_ <= tolerance_ || !std::isfinite(residual_))
+					break;
+			}
+
+			return residual_ <= tolerance_;
+		}
+
+		void PreconditionerReuseSolver::get_info(json &params) const
+		{
+			params["solver_name"] = name();
+			params["num_iterations"] = iterations_;
+			params["final_res_norm"] = residual_;
+			params["num_setups"] = setups_;
+
+			json inner_info;
+			inner_->get_info(inner_info);
+			params["preconditioner"] = inner_info;
+		}
+	} // namespace solver
+} // namespace polyfem
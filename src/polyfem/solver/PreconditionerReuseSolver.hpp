@@ -0,0 +1,71 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <memory>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		/// Linear solver keeping the setup of another solver (e.g., an AMG hierarchy or a factorization) across the solves
+		/// of slowly changing matrices (Picard/Newton iterations, time steps).
+		/// The system with the current matrix is solved by restarted flexible GMRES preconditioned with the solve of the
+		/// inner solver, set up with an older matrix. The inner solver is set up again when the pattern changes, when the
+		/// iterations grow past growth times the ones right after its last setup, or when GMRES does not converge.
+		class PreconditionerReuseSolver : public polysolve::linear::Solver
+		{
+		public:
+			/// @param[in] inner solver used as preconditioner
+			/// @param[in] tolerance relative residual ending the iterations
+			/// @param[in] max_iterations maximum number of iterations of a solve
+			/// @param[in] growth set up again if the iterations exceed growth times the ones after the last setup
+			/// @param[in] restart number of iterations between the restarts of GMRES
+			PreconditionerReuseSolver(std::unique_ptr<polysolve::linear::Solver> inner, const double tolerance, const int max_iterations, const double growth, const int restart = 30);
+
+			/// wraps solver if advanced/reuse_preconditioner is set in solver_param (the solver arguments)
+			static std::unique_ptr<polysolve::linear::Solver> wrap(std::unique_ptr<polysolve::linear::Solver> solver, const json &solver_param);
+
+			void analyze_pattern(const StiffnessMatrix &A, const int precond_num) override;
+			void factorize(const StiffnessMatrix &A) override;
+			void solve(const Eigen::Ref<const Eigen::VectorXd> b, Eigen::Ref<Eigen::VectorXd> x) override;
+
+			void get_info(json &params) const override;
+			std::string name() const override { return "PreconditionerReuse<" + inner_->name() + ">"; }
+
+			/// number of iterations of the last solve
+			int iterations() const { return iterations_; }
+			/// relative residual of the last solve
+			double residual() const { return residual_; }
+			/// number of setups of the inner solver
+			int setups() const { return setups_; }
+
+		private:
+			std::unique_ptr<polysolve::linear::Solver> inner_;
+			const double tolerance_;
+			const int max_iterations_;
+			const double growth_;
+			const int restart_;
+
+			/// current matrix
+			StiffnessMatrix A_;
+			int precond_num_ = 0;
+
+			bool needs_analyze_ = true;
+			bool needs_setup_ = true;
+			/// iterations of the first solve after the last setup, -1 before it
+			int setup_iterations_ = -1;
+
+			int iterations_ = 0;
+			double residual_ = 0;
+			int setups_ = 0;
+
+			/// analyze (if needed) and factorize the inner solver with the current matrix
+			void setup();
+			/// flexible GMRES, returns true if converged
+			bool fgmres(const Eigen::Ref<const Eigen::VectorXd> b, Eigen::Ref<Eigen::VectorXd> x);
+		};
+	} // namespace solver
+} // namespace polyfem
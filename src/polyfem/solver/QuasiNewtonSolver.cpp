@@ -0,0 +1,148 @@
+#include "QuasiNewtonSolver.hpp"
+
+#include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/Profiler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace polyfem::solver
+{
+	QuasiNewtonSolver::QuasiNewtonSolver(const json &params, const json &linear_solver_params, const double characteristic_length)
+		: max_iterations_(params["max_iterations"]),
+		  history_size_(params["history_size"]),
+		  tolerance_(params["grad_norm"].get<double>() * characteristic_length),
+		  linear_solver_(polysolve::linear::Solver::create(linear_solver_params, logger()))
+	{
+	}
+
+	bool QuasiNewtonSolver::minimize(NLProblem &problem, Eigen::VectorXd &x)
+	{
+		POLYFEM_PROFILE_ZONE("QuasiNewtonSolver::minimize");
+		s_.clear();
+		y_.clear();
+		iterations_ = 0;
+
+		Eigen::VectorXd x0 = x;
+		problem.solution_changed(x0);
+		double energy = problem.value(x0);
+		if (!std::isfinite(energy))
+			return false;
+
+		Eigen::VectorXd grad;
+		problem.gradient(x0, grad);
+		if (grad.norm() <= tolerance_)
+			return true;
+
+		// the only hessian of the solve
+		{
+			POLYFEM_PROFILE_ZONE("QuasiNewtonSolver::factorize");
+			StiffnessMatrix hessian;
+			problem.hessian(x0, hessian);
+			if (analyzed_pattern_ != problem.hessian_pattern_changes())
+			{
+				linear_solver_->analyze_pattern(hessian, hessian.rows());
+				analyzed_pattern_ = problem.hessian_pattern_changes();
+			}
+			linear_solver_->factorize(hessian);
+			++factorizations_;
+		}
+
+		Eigen::VectorXd x1, grad1;
+		for (iterations_ = 1; iterations_ <= max_iterations_; ++iterations_)
+		{
+			Eigen::VectorXd dir = direction(grad);
+			if (!dir.allFinite() || grad.dot(dir) >= 0)
+			{
+				// the curvature pairs spoil the hessian of the start of the step, restart from it
+				s_.clear();
+				y_.clear();
+				dir = direction(grad);
+				if (!dir.allFinite() || grad.dot(dir) >= 0)
+					break;
+			}
+
+			// backtracking (Armijo) line search, the CCD bounds the first step
+			x1 = x0 + dir;
+			problem.line_search_begin(x0, x1);
+			double alpha = std::min(1.0, problem.max_step_size(x0, x1));
+			bool decreased = false;
+			double energy1 = energy;
+			for (; alpha > 1e-10; alpha /= 2)
+			{
+				x1 = x0 + alpha * dir;
+				if (!problem.is_step_valid(x0, x1) || !problem.is_step_collision_free(x0, x1))
+					continue;
+
+				problem.solution_changed(x1);
+				energy1 = problem.value(x1);
+				if (std::isfinite(energy1) && energy1 <= energy + 1e-4 * alpha * grad.dot(dir))
+				{
+					decreased = true;
+					break;
+				}
+			}
+			problem.line_search_end();
+			if (!decreased)
+			{
+				problem.solution_changed(x0);
+				break;
+			}
+
+			problem.gradient(x1, grad1);
+
+			// curvature pair, skipped if it would make the inverse hessian indefinite
+			Eigen::VectorXd s = x1 - x0, y = grad1 - grad;
+			if (s.dot(y) > 1e-10 * s.norm() * y.norm())
+			{
+				if (int(s_.size()) >= history_size_)
+				{
+					s_.pop_front();
+					y_.pop_front();
+				}
+				s_.push_back(std::move(s));
+				y_.push_back(std::move(y));
+			}
+
+			x0 = x1;
+			grad = grad1;
+			energy = energy1;
+			problem.post_step(polysolve::nonlinear::PostStepData(iterations_, json(), x0, grad));
+
+			if (grad.norm() <= tolerance_)
+			{
+				logger().debug("Quasi-Newton converged in {} iteration(s) with one factorization", iterations_);
+				x = x0;
+				return true;
+			}
+		}
+
+		logger().debug("Quasi-Newton did not converge in {} iteration(s) (grad_norm={:g} tol={:g})", iterations_, grad.norm(), tolerance_);
+		return false;
+	}
+
+	Eigen::VectorXd QuasiNewtonSolver::direction(const Eigen::VectorXd &grad)
+	{
+		// two-loop recursion, the initial inverse hessian is the factorized hessian
+		Eigen::VectorXd q = grad;
+		std::vector<double> a(s_.size());
+		for (int i = int(s_.size()) - 1; i >= 0; --i)
+		{
+			a[i] = s_[i].dot(q) / y_[i].dot(s_[i]);
+			q -= a[i] * y_[i];
+		}
+
+		Eigen::VectorXd r(q.size());
+		linear_solver_->solve(q, r);
+
+		for (int i = 0; i < s_.size(); ++i)
+		{
+			const double b = y_[i].dot(r) / y_[i].dot(s_[i]);
+			r += (a[i] - b) * s_[i];
+		}
+
+		return -r;
+	}
+} // namespace polyfem::solver
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <deque>
+#include <memory>
+
+namespace polyfem::solver
+{
+	class NLProblem;
+
+	/// L-BFGS whose initial inverse hessian is the factorization of the hessian at the start of the solve (e.g., of a
+	/// time step): the hessian is assembled and factorized once, the iterations only evaluate values and gradients and
+	/// apply the two-loop recursion with a back substitution. Meant for the nearly linear steps of smooth transient runs,
+	/// a failed solve leaves the solution unchanged so that a full Newton solve can follow.
+	class QuasiNewtonSolver
+	{
+	public:
+		/// @param[in] params quasi-Newton settings (solver/quasi_newton)
+		/// @param[in] linear_solver_params settings of the linear solver of the hessian (solver/linear)
+		/// @param[in] characteristic_length scaling of the gradient norm tolerance
+		QuasiNewtonSolver(const json &params, const json &linear_solver_params, const double characteristic_length);
+
+		/// minimize the problem from x, with the line searches bounded by the CCD of the problem
+		/// @param[in] problem problem, at the reduced size
+		/// @param[in,out] x initial guess, replaced by the solution if converged
+		/// @return false if it did not converge in max_iterations
+		bool minimize(NLProblem &problem, Eigen::VectorXd &x);
+
+		/// number of iterations of the last solve
+		int iterations() const { return iterations_; }
+		/// number of hessian factorizations since the creation of the solver
+		int factorizations() const { return factorizations_; }
+
+	private:
+		const int max_iterations_;
+		const int history_size_;
+		const double tolerance_;
+
+		std::unique_ptr<polysolve::linear::Solver> linear_solver_;
+		/// hessian_pattern_changes of the problem at the last analysis, -1 before it
+		int analyzed_pattern_ = -1;
+
+		/// steps and gradient changes of the last iterations, the oldest first
+		std::deque<Eigen::VectorXd> s_, y_;
+
+		int iterations_ = 0;
+		int factorizations_ = 0;
+
+		/// -H^-1 grad with the L-BFGS inverse hessian
+		Eigen::VectorXd direction(const Eigen::VectorXd &grad);
+	};
+} // namespace polyfem::solver
@@ -0,0 +1,149 @@
+#include "ReducedOrderModel.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		Eigen::MatrixXd pod_basis(const Eigen::MatrixXd &snapshots, const double energy_tolerance)
+		{
+			if (snapshots.cols() == 0)
+				return Eigen::MatrixXd();
+
+			// eigenvalues in increasing order
+			const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigs(snapshots.transpose() * snapshots);
+			const Eigen::VectorXd energies = eigs.eigenvalues().cwiseMax(0);
+			const double total = energies.sum();
+			if (total <= 0)
+				return Eigen::MatrixXd();
+
+			int n_dropped = 0;
+			double dropped = 0;
+			while (n_dropped < energies.size() && dropped + energies(n_dropped) <= energy_tolerance * total)
+				dropped += energies(n_dropped++);
+
+			Eigen::MatrixXd basis(snapshots.rows(), energies.size() - n_dropped);
+			for (int i = 0; i < basis.cols(); ++i)
+			{
+				const int k = energies.size() - 1 - i;
+				basis.col(i) = snapshots * eigs.eigenvectors().col(k) / std::sqrt(energies(k));
+			}
+
+			return basis;
+		}
+
+		Eigen::MatrixXd orthonormalize(const Eigen::MatrixXd &basis, const double tolerance)
+		{
+			Eigen::MatrixXd Q(basis.rows(), basis.cols());
+			int n = 0;
+			for (int i = 0; i < basis.cols(); ++i)
+			{
+				const double norm = basis.col(i).norm();
+				if (norm == 0)
+					continue;
+
+				Eigen::VectorXd v = basis.col(i);
+				for (int pass = 0; pass < 2; ++pass)
+					v -= Q.leftCols(n) * (Q.leftCols(n).transpose() * v);
+
+				if (v.norm() <= tolerance * norm)
+					continue;
+				Q.col(n++) = v.normalized();
+			}
+
+			return Q.leftCols(n);
+		}
+
+		void cubature_weights(const Eigen::MatrixXd &C, const double tolerance, const int max_elements, std::vector<int> &elements, std::vector<double> &weights)
+		{
+			const int n = C.cols();
+			const Eigen::VectorXd b = C.rowwise().sum();
+			const double b_norm = b.norm();
+			const int max_size = max_elements > 0 ? std::min(max_elements, n) : n;
+
+			elements.clear();
+			weights.clear();
+			if (n == 0 || b_norm == 0)
+				return;
+
+			std::vector<bool> in_set(n, false);
+			Eigen::VectorXd w(0);
+			Eigen::VectorXd residual = b;
+
+			// least squares weights of the current set
+			const auto solve_set = [&]() {
+				Eigen::MatrixXd Cs(C.rows(), elements.size());
+				for (int k = 0; k < elements.size(); ++k)
+					Cs.col(k) = C.col(elements[k]);
+				return Eigen::VectorXd(Cs.colPivHouseholderQr().solve(b));
+			};
+
+			while (residual.norm() > tolerance * b_norm && elements.size() < max_size)
+			{
+				const Eigen::VectorXd gradient = C.transpose() * residual;
+				int best = -1;
+				for (int e = 0; e < n; ++e)
+				{
+					if (!in_set[e] && (best < 0 || gradient[e] > gradient[best]))
+						best = e;
+				}
+				if (best < 0 || gradient[best] <= 0)
+					break;
+
+				elements.push_back(best);
+				in_set[best] = true;
+				w.conservativeResize(elements.size());
+				w[w.size() - 1] = 0;
+
+				// inner loop of Lawson-Hanson, the elements whose weight would become negative are removed
+				while (true)
+				{
+					const Eigen::VectorXd z = solve_set();
+					if ((z.array() > 0).all())
+					{
+						w = z;
+						break;
+					}
+
+					double alpha = 1;
+					for (int k = 0; k < z.size(); ++k)
+					{
+						if (z[k] <= 0)
+							alpha = std::min(alpha, w[k] / (w[k] - z[k]));
+					}
+					w += alpha * (z - w);
+
+					std::vector<int> kept_elements;
+					std::vector<double> kept_weights;
+					for (int k = 0; k < elements.size(); ++k)
+					{
+						if (w[k] > 1e-14)
+						{
+							kept_elements.push_back(elements[k]);
+							kept_weights.push_back(w[k]);
+						}
+						else
+							in_set[elements[k]] = false;
+					}
+					elements = kept_elements;
+					w = Eigen::Map<Eigen::VectorXd>(kept_weights.data(), kept_weights.size());
+					if (elements.empty())
+						break;
+				}
+
+				residual = b;
+				for (int k = 0; k < elements.size(); ++k)
+					residual -= w[k] * C.col(elements[k]);
+			}
+
+			weights.assign(w.data(), w.data() + w.size());
+			logger().debug("Cubature with {}/{} elements, relative error {}", elements.size(), n, residual.norm() / b_norm);
+		}
+	} // namespace solver
+} // namespace polyfem
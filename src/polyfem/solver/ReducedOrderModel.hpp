@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		/// orthonormal POD basis of the columns of snapshots (method of snapshots), the modes are dropped
+		/// while the discarded fraction of the snapshot energy stays below energy_tolerance
+		Eigen::MatrixXd pod_basis(const Eigen::MatrixXd &snapshots, const double energy_tolerance);
+
+		/// orthonormalize the columns of basis with a twice-iterated Gram-Schmidt, the columns dependent
+		/// (relative norm below tolerance) on the previous ones are dropped
+		Eigen::MatrixXd orthonormalize(const Eigen::MatrixXd &basis, const double tolerance = 1e-8);
+
+		/// element sampling and weighting of a reduced-order model (energy-conserving sampling and weighting):
+		/// sparse nonnegative weights w with ||C w - C 1|| <= tolerance ||C 1||, computed with a greedy
+		/// nonnegative least squares (Lawson-Hanson) that adds one element at a time
+		/// @param[in] C reduced contributions of the elements (columns) for the training snapshots (rows)
+		/// @param[in] tolerance relative tolerance on the reduced contributions
+		/// @param[in] max_elements maximum number of sampled elements, 0 for no limit
+		/// @param[out] elements sampled elements
+		/// @param[out] weights their positive weights
+		void cubature_weights(const Eigen::MatrixXd &C, const double tolerance, const int max_elements, std::vector<int> &elements, std::vector<double> &weights);
+	} // namespace solver
+} // namespace polyfem
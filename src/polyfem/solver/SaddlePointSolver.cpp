@@ -0,0 +1,174 @@
+#include "SaddlePointSolver.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <cmath>
+
+namespace polyfem
+{
+	using namespace polysolve;
+
+	namespace solver
+	{
+		SaddlePointSolver::SaddlePointSolver(const json &params)
+			: max_iterations_(params["max_iterations"]),
+			  restart_(params["restart"]),
+			  tolerance_(params["tolerance"])
+		{
+			velocity_solver_ = linear::Solver::create(params["velocity_linear"], logger());
+			schur_solver_ = linear::Solver::create(params["schur_linear"], logger());
+			logger().debug("\tsaddle point solver, velocity block {}, Schur complement {}", velocity_solver_->name(), schur_solver_->name());
+		}
+
+		void SaddlePointSolver::update_preconditioner(const StiffnessMatrix &K, const int n_velocity)
+		{
+			const int n_pressure = K.rows() - n_velocity;
+
+			A_ = K.topLeftCorner(n_velocity, n_velocity);
+			B_ = K.topRightCorner(n_velocity, n_pressure);
+			const StiffnessMatrix Bt = K.bottomLeftCorner(n_pressure, n_velocity);
+			const StiffnessMatrix C = K.bottomRightCorner(n_pressure, n_pressure);
+
+			Eigen::VectorXd inv_diag = A_.diagonal();
+			for (int i = 0; i < inv_diag.size(); ++i)
+				inv_diag(i) = inv_diag(i) == 0 ? 1 : 1 / inv_diag(i);
+
+			S_ = C - Bt * inv_diag.asDiagonal() * B_;
+			S_.makeCompressed();
+
+			if (velocity_nnz_ != A_.nonZeros())
+			{
+				velocity_solver_->analyze_pattern(A_, A_.rows());
+				velocity_nnz_ = A_.nonZeros();
+			}
+			velocity_solver_->factorize(A_);
+
+			if (schur_nnz_ != S_.nonZeros())
+			{
+				schur_solver_->analyze_pattern(S_, S_.rows());
+				schur_nnz_ = S_.nonZeros();
+			}
+			schur_solver_->factorize(S_);
+		}
+
+		void SaddlePointSolver::apply_preconditioner(const Eigen::VectorXd &r, Eigen::VectorXd &z) const
+		{
+			const int n_velocity = A_.rows();
+			const int n_pressure = S_.rows();
+
+			z.resize(r.size());
+
+			Eigen::VectorXd zp(n_pressure);
+			schur_solver_->solve(r.tail(n_pressure), zp);
+			z.tail(n_pressure) = zp;
+
+			const Eigen::VectorXd ru = r.head(n_velocity) - B_ * zp;
+			Eigen::VectorXd zu(n_velocity);
+			velocity_solver_->solve(ru, zu);
+			z.head(n_velocity) = zu;
+		}
+
+		void SaddlePointSolver::solve(const StiffnessMatrix &K, const int n_velocity, const std::vector<int> &fixed, const Eigen::VectorXd &b, Eigen::VectorXd &x)
+		{
+			const int n = K.rows();
+			assert(b.size() == n);
+
+			// same treatment as dirichlet_solve, the rows of the fixed dofs become the identity
+			std::vector<bool> is_fixed(n, false);
+			for (const int i : fixed)
+				is_fixed[i] = true;
+
+			StiffnessMatrix Kd = K;
+			Kd.prune([&](const Eigen::Index row, const Eigen::Index, const double) { return !is_fixed[row]; });
+			{
+				std::vector<Eigen::Triplet<double>> entries;
+				entries.reserve(fixed.size());
+				for (const int i : fixed)
+					entries.emplace_back(i, i, 1);
+				StiffnessMatrix identity(n, n);
+				identity.setFromTriplets(entries.begin(), entries.end());
+				Kd += identity;
+			}
+
+			update_preconditioner(Kd, n_velocity);
+
+			if (x.size() != n)
+				x.setZero(n);
+
+			iterations_ = 0;
+			const double b_norm = b.norm();
+			if (b_norm == 0)
+			{
+				x.setZero();
+				residual_ = 0;
+				return;
+			}
+
+			// restarted flexible GMRES, the inner solves of the preconditioner can be inexact (AMG)
+			const int m = std::max(1, std::min(restart_, n));
+			Eigen::MatrixXd V(n, m + 1), Z(n, m), H(m + 1, m);
+			Eigen::VectorXd g(m + 1), cs(m), sn(m), w, z;
+
+			Eigen::VectorXd r = b - Kd * x;
+			double beta = r.norm();
+			residual_ = beta / b_norm;
+
+			while (residual_ > tolerance_ && iterations_ < max_iterations_)
+			{
+				H.setZero();
+				g.setZero();
+				g(0) = beta;
+				V.col(0) = r / beta;
+
+				int k = 0;
+				for (int j = 0; j < m && iterations_ < max_iterations_; ++j)
+				{
+					apply_preconditioner(V.col(j), z);
+					Z.col(j) = z;
+					w = Kd * z;
+
+					// modified Gram-Schmidt
+					for (int i = 0; i <= j; ++i)
+					{
+						H(i, j) = w.dot(V.col(i));
+						w -= H(i, j) * V.col(i);
+					}
+					H(j + 1, j) = w.norm();
+					if (H(j + 1, j) > 0)
+						V.col(j + 1) = w / H(j + 1, j);
+
+					// Givens rotations
+					for (int i = 0; i < j; ++i)
+					{
+						const double tmp = cs(i) * H(i, j) + sn(i) * H(i + 1, j);
+						H(i + 1, j) = -sn(i) * H(i, j) + cs(i) * H(i + 1, j);
+						H(i, j) = tmp;
+					}
+					const double denom = std::hypot(H(j, j), H(j + 1, j));
+					cs(j) = denom == 0 ? 1 : H(j, j) / denom;
+					sn(j) = denom == 0 ? 0 : H(j + 1, j) / denom;
+					H(j, j) = denom;
+					H(j + 1, j) = 0;
+					g(j + 1) = -sn(j) * g(j);
+					g(j) = cs(j) * g(j);
+
+					++iterations_;
+					k = j + 1;
+					if (std::abs(g(j + 1)) / b_norm <= tolerance_ || denom == 0)
+						break;
+				}
+
+				const Eigen::VectorXd y = H.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+				x += Z.leftCols(k) * y;
+
+				r = b - Kd * x;
+				beta = r.norm();
+				residual_ = beta / b_norm;
+			}
+
+			logger().debug("\tFGMRES iterations {}, relative residual {}", iterations_, residual_);
+			if (residual_ > tolerance_)
+				logger().warn("Saddle point solver did not converge in {} iterations (relative residual {} > {})", iterations_, residual_, tolerance_);
+		}
+	} // namespace solver
+} // namespace polyfem
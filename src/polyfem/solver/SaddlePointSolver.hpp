@@ -0,0 +1,67 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace polyfem
+{
+	namespace solver
+	{
+		/// Iterative solver for the (Navier-)Stokes saddle point systems
+		///   [A  B  0]
+		///   [Bt C  a]
+		///   [0  at 0]
+		/// where the last row/column is the optional average pressure constraint.
+		/// The system is solved with FGMRES and a block upper triangular SIMPLE-type preconditioner:
+		/// the velocity block A is solved with its own linear solver (eg AMG) and the Schur complement
+		/// is approximated by C - Bt diag(A)^-1 B. The two linear solvers and their symbolic analysis
+		/// persist across solves (Picard/Newton iterations and time steps) while the sparsity does not change.
+		class SaddlePointSolver
+		{
+		public:
+			/// @param[in] params saddle point settings (solver/saddle_point)
+			SaddlePointSolver(const json &params);
+
+			/// solves K x = b, the rows of the fixed dofs (dirichlet nodes and zero columns) are replaced by the identity
+			/// @param[in] K monolithic saddle point matrix (merge_mixed_matrices)
+			/// @param[in] n_velocity size of the velocity block
+			/// @param[in] fixed fixed dofs
+			/// @param[in] b right hand side
+			/// @param[in,out] x initial guess and solution
+			void solve(const StiffnessMatrix &K, const int n_velocity, const std::vector<int> &fixed, const Eigen::VectorXd &b, Eigen::VectorXd &x);
+
+			/// number of FGMRES iterations of the last solve
+			int iterations() const { return iterations_; }
+			/// relative residual of the last solve
+			double residual() const { return residual_; }
+
+		private:
+			/// extracts the blocks of K (with the fixed rows) and sets up the block solvers
+			void update_preconditioner(const StiffnessMatrix &K, const int n_velocity);
+			/// z = P^-1 r
+			void apply_preconditioner(const Eigen::VectorXd &r, Eigen::VectorXd &z) const;
+
+			std::unique_ptr<polysolve::linear::Solver> velocity_solver_;
+			std::unique_ptr<polysolve::linear::Solver> schur_solver_;
+
+			StiffnessMatrix A_; ///< velocity block
+			StiffnessMatrix B_; ///< velocity-pressure block
+			StiffnessMatrix S_; ///< approximate Schur complement
+
+			// the symbolic analysis is redone only if the patterns change
+			Eigen::Index velocity_nnz_ = -1;
+			Eigen::Index schur_nnz_ = -1;
+
+			const int max_iterations_;
+			const int restart_;
+			const double tolerance_;
+
+			int iterations_ = 0;
+			double residual_ = 0;
+		};
+	} // namespace solver
+} // namespace polyfem
@@ -101,6 +101,11 @@ namespace polyfem::solver
 	{
 		const bool is_time_dependent = time_integrator != nullptr;
 		assert(!is_time_dependent || time_integrator != nullptr);
+
+		// new forms, possibly with a different problem size or solver settings
+		al_nl_solver = nullptr;
+		quasi_newton_solver = nullptr;
+		nl_solver = nullptr;
 		const double dt = is_time_dependent ? time_integrator->dt() : 0.0;
 		const int ndof = n_bases * dim;
 		// if (is_formulation_mixed) // mixed not supported
@@ -238,6 +243,9 @@ namespace polyfem::solver
 					// logger().debug("Using fixed barrier stiffness of {}", contact_form->barrier_stiffness());
 				}
 
+				if (is_time_dependent)
+					contact_form->set_time_integrator(time_integrator);
+
 				if (contact_form)
 					forms.push_back(contact_form);
 
@@ -293,8 +301,12 @@ namespace polyfem::solver
 			if (form == nullptr || !form->enabled())
 				continue;
 
+			// reuse the gradient the nonlinear solver computed at x instead of assembling it again
 			Eigen::VectorXd grad_form;
-			form->first_derivative(x, grad_form);
+			if (nl_problem != nullptr)
+				nl_problem->form_gradient(*form, x, grad_form);
+			else
+				form->first_derivative(x, grad_form);
 			grad_energy += grad_form;
 		}
 
@@ -314,6 +326,12 @@ namespace polyfem::solver
 				continue;
 			form->set_weight(time_integrator->acceleration_scaling());
 		}
+
+		// keep rate-dependent materials in sync with a variable time step
+		if (elastic_form != nullptr)
+			elastic_form->set_dt(time_integrator->dt());
+		if (damping_form != nullptr)
+			damping_form->set_dt(time_integrator->dt());
 	}
 
 	std::vector<std::pair<std::string, std::shared_ptr<solver::Form>>> SolveData::named_forms() const
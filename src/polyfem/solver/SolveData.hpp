@@ -17,6 +17,11 @@
 #include <string>
 #include <unordered_map>
 
+namespace polysolve::nonlinear
+{
+	class Solver;
+} // namespace polysolve::nonlinear
+
 namespace polyfem::time_integrator
 {
 	class ImplicitTimeIntegrator;
@@ -32,6 +37,7 @@ namespace polyfem::assembler
 namespace polyfem::solver
 {
 	class NLProblem;
+	class QuasiNewtonSolver;
 	class Form;
 	class ContactForm;
 	class PeriodicContactForm;
@@ -154,5 +160,11 @@ namespace polyfem::solver
 		std::shared_ptr<solver::PeriodicContactForm> periodic_contact_form;
 
 		std::shared_ptr<time_integrator::ImplicitTimeIntegrator> time_integrator;
+
+		/// nonlinear solvers for the AL and reduced solves, kept across time steps (reset by init_forms)
+		std::shared_ptr<polysolve::nonlinear::Solver> al_nl_solver;
+		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver;
+		/// quasi-Newton solver of the time steps (see solver/quasi_newton), keeps the analysis of the hessian pattern
+		std::shared_ptr<solver::QuasiNewtonSolver> quasi_newton_solver;
 	};
 } // namespace polyfem::solver
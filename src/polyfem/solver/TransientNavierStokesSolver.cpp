@@ -1,5 +1,6 @@
 #include "TransientNavierStokesSolver.hpp"
 
+#include <polyfem/solver/PreconditionerReuseSolver.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
 #include <polysolve/linear/FEMSolver.hpp>
 #include <polyfem/assembler/AssemblerUtils.hpp>
@@ -26,6 +27,33 @@ namespace polyfem
 		{
 			gradNorm = solver_param["nonlinear"]["grad_norm"];
 			iterations = solver_param["nonlinear"]["max_iterations"];
+			lag_convection = solver_param["advanced"]["lag_convection"];
+
+			if (solver_param["saddle_point"]["enabled"])
+				saddle_point_solver = std::make_unique<SaddlePointSolver>(solver_param["saddle_point"]);
+			else
+			{
+				linear_solver = PreconditionerReuseSolver::wrap(linear::Solver::create(solver_param["linear"], logger()), solver_param);
+				logger().debug("\tinternal solver {}", linear_solver->name());
+			}
+		}
+
+		void TransientNavierStokesSolver::solve_linear(
+			const StiffnessMatrix &A, const Eigen::VectorXd &b,
+			const std::vector<int> &boundary_nodes, const std::vector<int> &skipping,
+			const int precond_num, const bool use_avg_pressure, Eigen::VectorXd &x)
+		{
+			if (saddle_point_solver)
+			{
+				std::vector<int> fixed = boundary_nodes;
+				fixed.insert(fixed.end(), skipping.begin(), skipping.end());
+				saddle_point_solver->solve(A, precond_num, fixed, b, x);
+			}
+			else
+			{
+				Eigen::VectorXd tmp = b;
+				dirichlet_solve(*linear_solver, A, tmp, boundary_nodes, x, precond_num, "", false, true, use_avg_pressure);
+			}
 		}
 
 		void TransientNavierStokesSolver::minimize(
@@ -47,9 +75,6 @@ namespace polyfem
 		{
 			assert(velocity_assembler.name() == "NavierStokes");
 
-			auto solver = linear::Solver::create(solver_param["linear"], logger());
-			logger().debug("\tinternal solver {}", solver->name());
-
 			const int precond_num = problem_dim * n_bases;
 
 			StiffnessMatrix velocity_mass = velocity_mass1 / beta_dt;
@@ -72,22 +97,7 @@ namespace polyfem
 			stokes_matrix_time = time.getElapsedTimeInSec();
 			logger().debug("\tStokes matrix assembly time {}s", time.getElapsedTimeInSec());
 
-			time.start();
-
-			Eigen::VectorXd b = rhs + prev_sol_mass;
-
-			if (use_avg_pressure)
-			{
-				b[b.size() - 1] = 0;
-			}
-			dirichlet_solve(*solver, stoke_stiffness, b, boundary_nodes, x, precond_num, "", false, true, use_avg_pressure);
-			// solver->get_info(solver_info);
-			time.stop();
-			stokes_solve_time = time.getElapsedTimeInSec();
-			logger().debug("\tStokes solve time {}s", time.getElapsedTimeInSec());
-			logger().debug("\tStokes solver error: {}", (stoke_stiffness * x - b).norm());
-			// return;
-
+			// the dofs without any coupling (zero columns) are fixed, like the dirichlet nodes
 			std::vector<bool> zero_col(stoke_stiffness.cols(), true);
 			for (int k = 0; k < stoke_stiffness.outerSize(); ++k)
 			{
@@ -106,6 +116,36 @@ namespace polyfem
 				}
 			}
 
+			time.start();
+
+			Eigen::VectorXd b = rhs + prev_sol_mass;
+
+			if (use_avg_pressure)
+			{
+				b[b.size() - 1] = 0;
+			}
+
+			// with lagged convection the initial guess solves the Oseen problem with the convection of a previous step
+			const bool use_lagged = lag_convection && lagged_nl_matrix.rows() == velocity_stiffness.rows();
+			if (use_lagged)
+			{
+				StiffnessMatrix oseen_stiffness;
+				AssemblerUtils::merge_mixed_matrices(n_bases, n_pressure_bases, problem_dim, use_avg_pressure,
+													 (velocity_stiffness + lagged_nl_matrix) + velocity_mass, mixed_stiffness, pressure_stiffness,
+													 oseen_stiffness);
+				solve_linear(oseen_stiffness, b, boundary_nodes, skipping, precond_num, use_avg_pressure, x);
+			}
+			else
+			{
+				solve_linear(stoke_stiffness, b, boundary_nodes, skipping, precond_num, use_avg_pressure, x);
+				POLYFEM_LOG_DEBUG("\tStokes solver error: {}", (stoke_stiffness * x - b).norm());
+			}
+			// solver->get_info(solver_info);
+			time.stop();
+			stokes_solve_time = time.getElapsedTimeInSec();
+			logger().debug("\t{} solve time {}s", use_lagged ? "Oseen" : "Stokes", time.getElapsedTimeInSec());
+			// return;
+
 			assembly_time = 0;
 			inverting_time = 0;
 
@@ -117,38 +157,67 @@ namespace polyfem
 			{
 				b[b.size() - 1] = 0;
 			}
-			it += minimize_aux(true, skipping,
-							   n_bases,
-							   n_pressure_bases,
-							   t,
-							   bases,
-							   gbases,
-							   velocity_assembler,
-							   ass_vals_cache,
-							   boundary_nodes,
-							   use_avg_pressure,
-							   problem_dim,
-							   is_volume,
-							   velocity_stiffness, mixed_stiffness, pressure_stiffness, velocity_mass, b, 1e-3, solver, nlres_norm, x);
-			it += minimize_aux(false, skipping,
-							   n_bases,
-							   n_pressure_bases,
-							   t,
-							   bases,
-							   gbases,
-							   velocity_assembler,
-							   ass_vals_cache,
-							   boundary_nodes,
-							   use_avg_pressure,
-							   problem_dim,
-							   is_volume,
-							   velocity_stiffness, mixed_stiffness, pressure_stiffness, velocity_mass, b, gradNorm, solver, nlres_norm, x);
+
+			bool converged = false;
+			if (use_lagged)
+			{
+				// true residual, the convective term is assembled as a vector instead of the Picard matrix
+				time.start();
+				Eigen::MatrixXd convection;
+				velocity_assembler.assemble_gradient(is_volume, n_bases, bases, gbases, ass_vals_cache, t, 0, x, Eigen::MatrixXd(), convection);
+
+				Eigen::VectorXd nlres = b - stoke_stiffness * x;
+				nlres.head(convection.size()) -= convection;
+				for (int i : boundary_nodes)
+					nlres[i] = 0;
+				for (int i : skipping)
+					nlres[i] = 0;
+				nlres_norm = nlres.norm();
+				time.stop();
+				assembly_time = time.getElapsedTimeInSec();
+
+				converged = nlres_norm <= gradNorm;
+				logger().debug("\tlagged convection residual norm {}{}", nlres_norm, converged ? "" : ", updating the convection");
+			}
+
+			if (!converged)
+			{
+				it += minimize_aux(true, skipping,
+								   n_bases,
+								   n_pressure_bases,
+								   t,
+								   bases,
+								   gbases,
+								   velocity_assembler,
+								   ass_vals_cache,
+								   boundary_nodes,
+								   use_avg_pressure,
+								   problem_dim,
+								   is_volume,
+								   velocity_stiffness, mixed_stiffness, pressure_stiffness, velocity_mass, b, 1e-3, nlres_norm, x);
+				it += minimize_aux(false, skipping,
+								   n_bases,
+								   n_pressure_bases,
+								   t,
+								   bases,
+								   gbases,
+								   velocity_assembler,
+								   ass_vals_cache,
+								   boundary_nodes,
+								   use_avg_pressure,
+								   problem_dim,
+								   is_volume,
+								   velocity_stiffness, mixed_stiffness, pressure_stiffness, velocity_mass, b, gradNorm, nlres_norm, x);
+			}
 
 			solver_info["iterations"] = it;
 			solver_info["gradNorm"] = nlres_norm;
 
-			assembly_time /= it;
-			inverting_time /= it;
+			if (it > 0)
+			{
+				assembly_time /= it;
+				inverting_time /= it;
+			}
 
 			solver_info["time_assembly"] = assembly_time;
 			solver_info["time_inverting"] = inverting_time;
@@ -175,7 +244,7 @@ namespace polyfem
 			const StiffnessMatrix &velocity_stiffness, const StiffnessMatrix &mixed_stiffness, const StiffnessMatrix &pressure_stiffness,
 			const StiffnessMatrix &velocity_mass,
 			const Eigen::VectorXd &rhs, const double grad_norm,
-			std::unique_ptr<linear::Solver> &solver, double &nlres_norm,
+			double &nlres_norm,
 			Eigen::VectorXd &x)
 		{
 			igl::Timer time;
@@ -219,7 +288,7 @@ namespace polyfem
 														 (velocity_stiffness + nl_matrix) + velocity_mass, mixed_stiffness, pressure_stiffness,
 														 total_matrix);
 				}
-				dirichlet_solve(*solver, total_matrix, nlres, boundary_nodes, dx, precond_num, "", false, true, use_avg_pressure);
+				solve_linear(total_matrix, nlres, boundary_nodes, skipping, precond_num, use_avg_pressure, dx);
 				// for (int i : boundary_nodes)
 				// 	dx[i] = 0;
 				time.stop();
@@ -258,6 +327,10 @@ namespace polyfem
 				log_and_throw_error("Reaching the max number of iterations!");
 			}
 
+			// the Picard matrix of the solution is the convection used by the next steps
+			if (lag_convection)
+				lagged_nl_matrix = nl_matrix;
+
 			// solver_info["internal_solver"] = internal_solver;
 			// solver_info["internal_solver_first"] = internal_solver.front();
 			// solver_info["status"] = this->status();
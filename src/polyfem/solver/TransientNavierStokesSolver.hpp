@@ -4,6 +4,7 @@
 #include <polyfem/basis/ElementBases.hpp>
 #include <polyfem/assembler/NavierStokes.hpp>
 #include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/solver/SaddlePointSolver.hpp>
 
 #include <polysolve/linear/Solver.hpp>
 
@@ -59,14 +60,27 @@ namespace polyfem
 							 const StiffnessMatrix &velocity_stiffness, const StiffnessMatrix &mixed_stiffness, const StiffnessMatrix &pressure_stiffness,
 							 const StiffnessMatrix &velocity_mass,
 							 const Eigen::VectorXd &rhs, const double grad_norm,
-							 std::unique_ptr<polysolve::linear::Solver> &solver, double &nlres_norm,
+							 double &nlres_norm,
 							 Eigen::VectorXd &x);
 
+			/// solves the linear system with the block preconditioned solver if enabled, monolithic otherwise
+			void solve_linear(const StiffnessMatrix &A, const Eigen::VectorXd &b, const std::vector<int> &boundary_nodes, const std::vector<int> &skipping,
+							  const int precond_num, const bool use_avg_pressure, Eigen::VectorXd &x);
+
 			const json solver_param;
 
+			// the linear solvers persist across the Picard/Newton iterations (and time steps)
+			std::unique_ptr<polysolve::linear::Solver> linear_solver;
+			std::unique_ptr<SaddlePointSolver> saddle_point_solver;
+
 			double gradNorm;
 			int iterations;
 
+			// the Picard matrix of the last nonlinear solve is reused by the next time steps while
+			// the residual of the resulting Oseen solution is below gradNorm
+			bool lag_convection;
+			StiffnessMatrix lagged_nl_matrix;
+
 			json solver_info;
 
 			json internal_solver = json::array();
@@ -36,6 +36,8 @@ namespace polyfem::solver
 
 		std::string name() const override { return "bc-penalty"; }
 
+		bool is_hessian_constant() const override { return true; }
+
 		/// @brief Construct a new BCPenaltyForm object with a fixed Dirichlet boundary
 		/// @param ndof Number of degrees of freedom
 		/// @param boundary_nodes DoFs that are part of the Dirichlet boundary
@@ -57,13 +57,14 @@ namespace polyfem::solver
 		  is_formulation_mixed_(is_formulation_mixed)
 	{
 		t_ = 0;
+		update_energy_load();
 		if (!is_time_dependent)
 			update_current_rhs(Eigen::VectorXd());
 	}
 
 	double BodyForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
-		return rhs_assembler_.compute_energy(x, x_prev_, local_neumann_boundary_, density_, n_boundary_samples_, t_);
+		return assembler::RhsAssembler::energy_from_load(energy_load_, x);
 	}
 
 	void BodyForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
@@ -81,9 +82,15 @@ namespace polyfem::solver
 	{
 		this->t_ = t;
 		this->x_prev_ = x;
+		update_energy_load();
 		update_current_rhs(x);
 	}
 
+	void BodyForm::update_energy_load()
+	{
+		rhs_assembler_.compute_energy_load(x_prev_, local_neumann_boundary_, density_, n_boundary_samples_, t_, energy_load_);
+	}
+
 	void BodyForm::update_current_rhs(const Eigen::VectorXd &x)
 	{
 		rhs_assembler_.compute_energy_grad(
@@ -129,8 +136,7 @@ namespace polyfem::solver
 
 			for (int e = start; e < end; ++e)
 			{
-				assembler::ElementAssemblyValues &vals = local_storage.vals;
-				rhs_assembler_.ass_vals_cache().compute(e, rhs_assembler_.mesh().is_volume(), bases[e], gbases[e], vals);
+				const assembler::ElementAssemblyValues &vals = rhs_assembler_.ass_vals_cache().get(e, rhs_assembler_.mesh().is_volume(), bases[e], gbases[e], local_storage.vals);
 				assembler::ElementAssemblyValues &gvals = local_storage.gvals;
 				gvals.compute(e, rhs_assembler_.mesh().is_volume(), vals.quadrature.points, gbases[e], gbases[e]);
 
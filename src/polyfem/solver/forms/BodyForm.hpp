@@ -33,6 +33,8 @@ namespace polyfem::solver
 
 		std::string name() const override { return "body"; }
 
+		bool is_hessian_constant() const override { return true; }
+
 	protected:
 		/// @brief Compute the value of the body force form
 		/// @param x Current solution
@@ -49,6 +51,12 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the second derivative of the value wrt x times v (always zero)
+		void apply_hessian_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out) const override
+		{
+			out.setZero(x.size());
+		}
+
 	public:
 		/// @brief Update time dependent quantities
 		/// @param t New time
@@ -102,8 +110,11 @@ namespace polyfem::solver
 		bool is_formulation_mixed_; ///< True if the formulation is mixed
 
 		Eigen::MatrixXd current_rhs_; ///< Cached RHS for the current time
+		Eigen::VectorXd energy_load_; ///< The value is linear in x for the current time and previous solution, its coefficients
 
 		/// @brief Update current_rhs
 		void update_current_rhs(const Eigen::VectorXd &x);
+		/// @brief Update energy_load_ with the body forces and Neumann boundary conditions at the current time
+		void update_energy_load();
 	};
 } // namespace polyfem::solver
@@ -1,12 +1,16 @@
 #include "ContactForm.hpp"
 
 #include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/mesh/collision_proxy/CollisionHierarchy.hpp>
 #include <polyfem/solver/forms/FrictionForm.hpp>
 #include <polyfem/utils/Types.hpp>
 #include <polyfem/utils/Timer.hpp>
+#include <polyfem/utils/Profiler.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+#include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
 
 #include <polyfem/io/OBJWriter.hpp>
 
@@ -15,6 +19,9 @@
 
 #include <igl/writePLY.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace polyfem::solver
 {
 	ContactForm::ContactForm(const ipc::CollisionMesh &collision_mesh,
@@ -55,7 +62,7 @@ namespace polyfem::solver
 	{
 		// Eigen::MatrixXd U = collision_mesh_.vertices(utils::unflatten(solution, collision_mesh_.dim()));
 		// Eigen::MatrixXd X = collision_mesh_.vertices(boundary_nodes_pos_);
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(solution);
+		const Eigen::MatrixXd &displaced_surface = compute_displaced_surface(solution);
 
 		StiffnessMatrix dq_h = collision_mesh_.to_full_dof(barrier_potential_.shape_derivative(collision_set, collision_mesh_, displaced_surface));
 		term = barrier_stiffness() * dq_h.transpose() * adjoint_sol;
@@ -63,20 +70,55 @@ namespace polyfem::solver
 
 	void ContactForm::update_quantities(const double t, const Eigen::VectorXd &x)
 	{
+		hessian_pattern_ = StiffnessMatrix();
+
+		if (incremental_slack_ > 0)
+		{
+			incremental_step_slack_ = incremental_slack_ * dhat_;
+			if (time_integrator_ != nullptr && time_integrator_->v_prev().size() == x.size())
+			{
+				// conservative bound on the motion of the coming step, twice the motion at the current velocity
+				const Eigen::MatrixXd surface_velocities = collision_mesh_.map_displacements(utils::unflatten(time_integrator_->v_prev(), collision_mesh_.dim()));
+				if (surface_velocities.size() > 0)
+					incremental_step_slack_ = std::max(incremental_step_slack_, 2 * time_integrator_->dt() * surface_velocities.rowwise().norm().maxCoeff());
+			}
+		}
+
 		update_collision_set(compute_displaced_surface(x));
 	}
 
-	Eigen::MatrixXd ContactForm::compute_displaced_surface(const Eigen::VectorXd &x) const
+	const Eigen::MatrixXd &ContactForm::compute_displaced_surface(const Eigen::VectorXd &x) const
 	{
-		return collision_mesh_.displace_vertices(utils::unflatten(x, collision_mesh_.dim()));
+		for (const int slot : {last_displaced_, 1 - last_displaced_})
+		{
+			if (displaced_x_[slot].size() == x.size() && displaced_x_[slot] == x)
+			{
+				last_displaced_ = slot;
+				return displaced_surface_[slot];
+			}
+		}
+
+		// V = V_rest + M U, written in the buffers of the least recently used slot
+		const int slot = 1 - last_displaced_;
+		const int dim = collision_mesh_.dim();
+		const Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> U(x.data(), x.size() / dim, dim);
+		Eigen::MatrixXd &V = displaced_surface_[slot];
+		V.resize(collision_mesh_.num_vertices(), dim);
+		V.noalias() = collision_mesh_.displacement_map() * U;
+		V += collision_mesh_.rest_positions();
+		displaced_x_[slot] = x;
+
+		last_displaced_ = slot;
+		return V;
 	}
 
 	void ContactForm::update_barrier_stiffness(const Eigen::VectorXd &x, const Eigen::MatrixXd &grad_energy)
 	{
+		POLYFEM_PROFILE_ZONE("update_barrier_stiffness", profile_scope());
 		if (!use_adaptive_barrier_stiffness())
 			return;
 
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
+		const Eigen::MatrixXd &displaced_surface = compute_displaced_surface(x);
 
 		// The adative stiffness is designed for the non-convergent formulation,
 		// so we need to compute the gradient of the non-convergent barrier.
@@ -87,6 +129,8 @@ namespace polyfem::solver
 			collision_mesh_, displaced_surface, dhat_, dmin_, broad_phase_method_);
 		Eigen::VectorXd grad_barrier = barrier_potential_.gradient(
 			nonconvergent_constraints, collision_mesh_, displaced_surface);
+		if (n_planes() > 0)
+			planes_gradient(displaced_surface, false, grad_barrier);
 		grad_barrier = collision_mesh_.to_full_dof(grad_barrier);
 
 		barrier_stiffness_ = ipc::initial_barrier_stiffness(
@@ -96,14 +140,17 @@ namespace polyfem::solver
 		if (use_convergent_formulation())
 		{
 			double scaling_factor = 0;
-			if (!nonconvergent_constraints.empty())
+			const double nonconvergent_planes_potential = n_planes() > 0 ? planes_potential(displaced_surface, false).sum() : 0;
+			if (!nonconvergent_constraints.empty() || nonconvergent_planes_potential > 0)
 			{
 				const double nonconvergent_potential = barrier_potential_(
-					nonconvergent_constraints, collision_mesh_, displaced_surface);
+					nonconvergent_constraints, collision_mesh_, displaced_surface) + nonconvergent_planes_potential;
 
 				update_collision_set(displaced_surface);
-				const double convergent_potential = barrier_potential_(
+				double convergent_potential = barrier_potential_(
 					collision_set_, collision_mesh_, displaced_surface);
+				if (n_planes() > 0)
+					convergent_potential += planes_potential(displaced_surface, true).sum();
 
 				scaling_factor = nonconvergent_potential / convergent_potential;
 			}
@@ -128,6 +175,7 @@ namespace polyfem::solver
 
 	void ContactForm::update_collision_set(const Eigen::MatrixXd &displaced_surface)
 	{
+		POLYFEM_PROFILE_ZONE("update_collision_set", profile_scope());
 		// Store the previous value used to compute the constraint set to avoid duplicate computation.
 		static Eigen::MatrixXd cached_displaced_surface;
 		if (cached_displaced_surface.size() == displaced_surface.size() && cached_displaced_surface == displaced_surface)
@@ -136,25 +184,63 @@ namespace polyfem::solver
 		if (use_cached_candidates_)
 			collision_set_.build(
 				candidates_, collision_mesh_, displaced_surface, dhat_);
+		else if (incremental_slack_ > 0)
+		{
+			// pairs closer than dhat + dmin now were closer than dhat + dmin + 2 * slack when the candidates were built
+			if (incremental_surface_.rows() != displaced_surface.rows()
+				|| (displaced_surface - incremental_surface_).rowwise().norm().maxCoeff() > incremental_candidates_slack_)
+			{
+				incremental_candidates_slack_ = std::max(incremental_step_slack_, incremental_slack_ * dhat_);
+				build_candidates(
+					displaced_surface, displaced_surface,
+					/*inflation_radius=*/(dhat_ + dmin_) / 2 + incremental_candidates_slack_, incremental_candidates_);
+				incremental_surface_ = displaced_surface;
+			}
+
+			collision_set_.build(
+				incremental_candidates_, collision_mesh_, displaced_surface, dhat_, dmin_);
+		}
+		else if (collision_hierarchy_)
+		{
+			ipc::Candidates candidates;
+			build_candidates(displaced_surface, displaced_surface, /*inflation_radius=*/(dhat_ + dmin_) / 2, candidates);
+			collision_set_.build(
+				candidates, collision_mesh_, displaced_surface, dhat_, dmin_);
+		}
 		else
 			collision_set_.build(
 				collision_mesh_, displaced_surface, dhat_, dmin_, broad_phase_method_);
 		cached_displaced_surface = displaced_surface;
 	}
 
+	void ContactForm::build_candidates(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1, const double inflation_radius, ipc::Candidates &candidates) const
+	{
+		POLYFEM_PROFILE_ZONE("build_candidates", profile_scope());
+		if (collision_hierarchy_)
+			collision_hierarchy_->build(collision_mesh_, V0, V1, inflation_radius, candidates);
+		else if (&V0 == &V1)
+			candidates.build(collision_mesh_, V0, inflation_radius, broad_phase_method_);
+		else
+			candidates.build(collision_mesh_, V0, V1, inflation_radius, broad_phase_method_);
+	}
+
 	double ContactForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
-		return barrier_potential_(collision_set_, collision_mesh_, compute_displaced_surface(x));
+		const Eigen::MatrixXd &V = compute_displaced_surface(x);
+		double value = barrier_potential_(collision_set_, collision_mesh_, V);
+		if (n_planes() > 0)
+			value += planes_potential(V, use_convergent_formulation()).sum();
+		return value;
 	}
 
 	Eigen::VectorXd ContactForm::value_per_element_unweighted(const Eigen::VectorXd &x) const
 	{
-		const Eigen::MatrixXd V = compute_displaced_surface(x);
+		const Eigen::MatrixXd &V = compute_displaced_surface(x);
 		assert(V.rows() == collision_mesh_.num_vertices());
 
 		const size_t num_vertices = collision_mesh_.num_vertices();
 
-		if (collision_set_.empty())
+		if (collision_set_.empty() && n_planes() == 0)
 		{
 			return Eigen::VectorXd::Zero(collision_mesh_.full_num_vertices());
 		}
@@ -187,6 +273,8 @@ namespace polyfem::solver
 		{
 			out += local_potential;
 		}
+		if (n_planes() > 0)
+			out += planes_potential(V, use_convergent_formulation());
 
 		Eigen::VectorXd out_full = Eigen::VectorXd::Zero(collision_mesh_.full_num_vertices());
 		for (int i = 0; i < out.size(); i++)
@@ -199,15 +287,218 @@ namespace polyfem::solver
 
 	void ContactForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 	{
-		gradv = barrier_potential_.gradient(collision_set_, collision_mesh_, compute_displaced_surface(x));
+		const Eigen::MatrixXd &V = compute_displaced_surface(x);
+		gradv = barrier_potential_.gradient(collision_set_, collision_mesh_, V);
+		if (n_planes() > 0)
+			planes_gradient(V, use_convergent_formulation(), gradv);
 		gradv = collision_mesh_.to_full_dof(gradv);
 	}
 
 	void ContactForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
 	{
 		POLYFEM_SCOPED_TIMER("barrier hessian");
-		hessian = barrier_potential_.hessian(collision_set_, collision_mesh_, compute_displaced_surface(x), project_to_psd_);
-		hessian = collision_mesh_.to_full_dof(hessian);
+
+		const Eigen::MatrixXd &V = compute_displaced_surface(x);
+		const Eigen::MatrixXi &E = collision_mesh_.edges();
+		const Eigen::MatrixXi &F = collision_mesh_.faces();
+		const int dim = V.cols();
+		const int n_dofs = V.size();
+
+		local_hessians_.resize(collision_set_.size());
+		utils::maybe_parallel_for(collision_set_.size(), [&](int start, int end, int thread_id) {
+			for (size_t i = start; i < end; i++)
+				local_hessians_[i] = barrier_potential_.hessian(collision_set_[i], collision_set_[i].dof(V, E, F), project_to_psd_);
+		});
+
+		if (hessian_pattern_.rows() != n_dofs)
+			hessian_pattern_.resize(n_dofs, n_dofs);
+		hessian_pattern_.makeCompressed();
+		hessian_pattern_.coeffs().setZero();
+
+		// scatter in the kept pattern, same layout as ipc's local to global triplets
+		bool in_pattern = true;
+		for (size_t i = 0; i < collision_set_.size() && in_pattern; i++)
+		{
+			const int n_v = collision_set_[i].num_vertices();
+			const std::array<long, 4> vis = collision_set_[i].vertex_ids(E, F);
+			for (int a = 0; a < n_v * dim && in_pattern; ++a)
+			{
+				for (int b = 0; b < n_v * dim; ++b)
+				{
+					double *entry = utils::find_in_pattern(hessian_pattern_, vis[a / dim] * dim + a % dim, vis[b / dim] * dim + b % dim);
+					if (entry == nullptr)
+					{
+						in_pattern = false;
+						break;
+					}
+					*entry += local_hessians_[i](a, b);
+				}
+			}
+		}
+
+		if (!in_pattern)
+		{
+			// new pairs appeared, grow the pattern to the union of the old and new entries
+			std::vector<Eigen::Triplet<double>> triplets;
+			for (size_t i = 0; i < collision_set_.size(); i++)
+			{
+				const int n_v = collision_set_[i].num_vertices();
+				const std::array<long, 4> vis = collision_set_[i].vertex_ids(E, F);
+				for (int a = 0; a < n_v * dim; ++a)
+					for (int b = 0; b < n_v * dim; ++b)
+						triplets.emplace_back(vis[a / dim] * dim + a % dim, vis[b / dim] * dim + b % dim, local_hessians_[i](a, b));
+			}
+
+			StiffnessMatrix tmp(n_dofs, n_dofs);
+			tmp.setFromTriplets(triplets.begin(), triplets.end());
+
+			hessian_pattern_.coeffs().setZero();
+			hessian_pattern_ += tmp;
+			hessian_pattern_.makeCompressed();
+		}
+
+		if (n_planes() > 0)
+			hessian = collision_mesh_.to_full_dof(hessian_pattern_ + planes_hessian(V));
+		else
+			hessian = collision_mesh_.to_full_dof(hessian_pattern_);
+	}
+
+	void ContactForm::set_planes(const Eigen::MatrixXd &points, const Eigen::MatrixXd &normals, const int n_obstacle_vertices)
+	{
+		assert(points.rows() == normals.rows());
+		assert(points.rows() == 0 || (points.cols() == collision_mesh_.dim() && normals.cols() == collision_mesh_.dim()));
+		plane_points_ = points;
+		plane_normals_ = normals;
+
+		// the obstacle vertices are at the bottom of the full collision mesh
+		const int first_obstacle_vertex = collision_mesh_.full_num_vertices() - n_obstacle_vertices;
+		plane_vertices_.clear();
+		for (int i = 0; i < collision_mesh_.num_vertices(); ++i)
+		{
+			if (collision_mesh_.to_full_vertex_id(i) < first_obstacle_vertex)
+				plane_vertices_.push_back(i);
+		}
+	}
+
+	Eigen::VectorXd ContactForm::planes_potential(const Eigen::MatrixXd &V, const bool convergent) const
+	{
+		const ipc::Barrier &barrier = barrier_potential_.barrier();
+		// same normalization as the convergent formulation of the mesh collisions
+		const double convergent_scaling = 1 / (dhat_ * std::pow(dhat_ + 2 * dmin_, 2));
+
+		Eigen::VectorXd potential = Eigen::VectorXd::Zero(V.rows());
+		utils::maybe_parallel_for(plane_vertices_.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
+			{
+				const int vi = plane_vertices_[k];
+				const double weight = convergent ? collision_mesh_.vertex_areas()(vi) * convergent_scaling : 1;
+				for (int p = 0; p < n_planes(); ++p)
+				{
+					const double d = (V.row(vi) - plane_points_.row(p)).dot(plane_normals_.row(p));
+					if (d <= 0)
+						potential(vi) = std::numeric_limits<double>::infinity();
+					else if (d < dhat_)
+						potential(vi) += weight * barrier(d * d, dhat_ * dhat_);
+				}
+			}
+		});
+		return potential;
+	}
+
+	void ContactForm::planes_gradient(const Eigen::MatrixXd &V, const bool convergent, Eigen::VectorXd &grad) const
+	{
+		assert(grad.size() == V.size());
+		const ipc::Barrier &barrier = barrier_potential_.barrier();
+		const double convergent_scaling = 1 / (dhat_ * std::pow(dhat_ + 2 * dmin_, 2));
+		const int dim = V.cols();
+
+		// every vertex writes its own entries only
+		utils::maybe_parallel_for(plane_vertices_.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
+			{
+				const int vi = plane_vertices_[k];
+				const double weight = convergent ? collision_mesh_.vertex_areas()(vi) * convergent_scaling : 1;
+				for (int p = 0; p < n_planes(); ++p)
+				{
+					const double d = (V.row(vi) - plane_points_.row(p)).dot(plane_normals_.row(p));
+					if (d <= 0 || d >= dhat_)
+						continue;
+					// d/dv b(d^2) = b'(d^2) 2 d n
+					grad.segment(vi * dim, dim) += (weight * barrier.first_derivative(d * d, dhat_ * dhat_) * 2 * d) * plane_normals_.row(p).transpose();
+				}
+			}
+		});
+	}
+
+	StiffnessMatrix ContactForm::planes_hessian(const Eigen::MatrixXd &V) const
+	{
+		const ipc::Barrier &barrier = barrier_potential_.barrier();
+		const double convergent_scaling = 1 / (dhat_ * std::pow(dhat_ + 2 * dmin_, 2));
+		const bool convergent = use_convergent_formulation();
+		const int dim = V.cols();
+
+		// d2/dv2 b(d^2) = (4 d^2 b''(d^2) + 2 b'(d^2)) n n^T, rank one so the projection only clamps the coefficient
+		std::vector<Eigen::MatrixXd> blocks(plane_vertices_.size());
+		utils::maybe_parallel_for(plane_vertices_.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
+			{
+				const int vi = plane_vertices_[k];
+				const double weight = convergent ? collision_mesh_.vertex_areas()(vi) * convergent_scaling : 1;
+				for (int p = 0; p < n_planes(); ++p)
+				{
+					const double d = (V.row(vi) - plane_points_.row(p)).dot(plane_normals_.row(p));
+					if (d <= 0 || d >= dhat_)
+						continue;
+					double coefficient = weight * (4 * d * d * barrier.second_derivative(d * d, dhat_ * dhat_) + 2 * barrier.first_derivative(d * d, dhat_ * dhat_));
+					if (project_to_psd_)
+						coefficient = std::max(coefficient, 0.0);
+					if (blocks[k].size() == 0)
+						blocks[k].setZero(dim, dim);
+					blocks[k] += coefficient * plane_normals_.row(p).transpose() * plane_normals_.row(p);
+				}
+			}
+		});
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (size_t k = 0; k < blocks.size(); ++k)
+		{
+			const int vi = plane_vertices_[k];
+			for (int i = 0; i < blocks[k].rows(); ++i)
+				for (int j = 0; j < blocks[k].cols(); ++j)
+					triplets.emplace_back(vi * dim + i, vi * dim + j, blocks[k](i, j));
+		}
+
+		StiffnessMatrix hessian(V.size(), V.size());
+		hessian.setFromTriplets(triplets.begin(), triplets.end());
+		return hessian;
+	}
+
+	double ContactForm::planes_max_step_size(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1) const
+	{
+		// the distances are linear in the step, a vertex crossing a plane stops at the same fraction of its time of impact as ipc's CCD
+		constexpr double conservative_rescaling = 0.8;
+
+		auto storage = utils::create_thread_storage<double>(1.0);
+		utils::maybe_parallel_for(plane_vertices_.size(), [&](int start, int end, int thread_id) {
+			double &local_step = utils::get_local_thread_storage(storage, thread_id);
+			for (int k = start; k < end; ++k)
+			{
+				const int vi = plane_vertices_[k];
+				for (int p = 0; p < n_planes(); ++p)
+				{
+					const double d0 = (V0.row(vi) - plane_points_.row(p)).dot(plane_normals_.row(p));
+					const double d1 = (V1.row(vi) - plane_points_.row(p)).dot(plane_normals_.row(p));
+					if (d1 > 0)
+						continue;
+					local_step = std::min(local_step, d0 > 0 ? conservative_rescaling * d0 / (d0 - d1) : 0.0);
+				}
+			}
+		});
+
+		double max_step = 1;
+		for (const double local_step : storage)
+			max_step = std::min(max_step, local_step);
+		return max_step;
 	}
 
 	void ContactForm::solution_changed(const Eigen::VectorXd &new_x)
@@ -215,11 +506,27 @@ namespace polyfem::solver
 		update_collision_set(compute_displaced_surface(new_x));
 	}
 
+	size_t ContactForm::memory_bytes() const
+	{
+		size_t bytes = utils::collisions_memory_bytes(collision_set_);
+		for (const ipc::Candidates *candidates : {&candidates_, &incremental_candidates_})
+		{
+			bytes += utils::memory_bytes(candidates->ev_candidates) + utils::memory_bytes(candidates->ee_candidates)
+					 + utils::memory_bytes(candidates->fv_candidates);
+		}
+		bytes += utils::memory_bytes(incremental_surface_) + utils::memory_bytes(hessian_pattern_) + utils::memory_bytes(local_hessians_);
+		bytes += utils::memory_bytes(plane_points_) + utils::memory_bytes(plane_normals_) + utils::memory_bytes(plane_vertices_);
+		for (int slot = 0; slot < 2; ++slot)
+			bytes += utils::memory_bytes(displaced_x_[slot]) + utils::memory_bytes(displaced_surface_[slot]);
+		return bytes;
+	}
+
 	double ContactForm::max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
+		POLYFEM_PROFILE_ZONE("max_step_size", profile_scope());
 		// Extract surface only
-		const Eigen::MatrixXd V0 = compute_displaced_surface(x0);
-		const Eigen::MatrixXd V1 = compute_displaced_surface(x1);
+		const Eigen::MatrixXd &V0 = compute_displaced_surface(x0);
+		const Eigen::MatrixXd &V1 = compute_displaced_surface(x1);
 
 		if (save_ccd_debug_meshes)
 		{
@@ -233,10 +540,20 @@ namespace polyfem::solver
 		if (use_cached_candidates_ && broad_phase_method_ != ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE)
 			max_step = candidates_.compute_collision_free_stepsize(
 				collision_mesh_, V0, V1, dmin_, ccd_tolerance_, ccd_max_iterations_);
+		else if (collision_hierarchy_)
+		{
+			ipc::Candidates candidates;
+			build_candidates(V0, V1, /*inflation_radius=*/dmin_ / 2, candidates);
+			max_step = candidates.compute_collision_free_stepsize(
+				collision_mesh_, V0, V1, dmin_, ccd_tolerance_, ccd_max_iterations_);
+		}
 		else
 			max_step = ipc::compute_collision_free_stepsize(
 				collision_mesh_, V0, V1, broad_phase_method_, ccd_tolerance_, ccd_max_iterations_);
 
+		if (n_planes() > 0)
+			max_step = std::min(max_step, planes_max_step_size(V0, V1));
+
 		if (save_ccd_debug_meshes && ipc::has_intersections(collision_mesh_, (V1 - V0) * max_step + V0, broad_phase_method_))
 		{
 			log_and_throw_error("Taking max_step results in intersections (max_step={})", max_step);
@@ -264,12 +581,12 @@ namespace polyfem::solver
 
 	void ContactForm::line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
 	{
-		candidates_.build(
-			collision_mesh_,
+		POLYFEM_PROFILE_ZONE("line_search_begin", profile_scope());
+		build_candidates(
 			compute_displaced_surface(x0),
 			compute_displaced_surface(x1),
 			/*inflation_radius=*/dhat_ / 2,
-			broad_phase_method_);
+			candidates_);
 
 		use_cached_candidates_ = true;
 	}
@@ -285,7 +602,7 @@ namespace polyfem::solver
 		if (data.iter_num == 0)
 			return;
 
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(data.x);
+		const Eigen::MatrixXd &displaced_surface = compute_displaced_surface(data.x);
 
 		const double curr_distance = collision_set_.compute_minimum_distance(collision_mesh_, displaced_surface);
 
@@ -318,8 +635,9 @@ namespace polyfem::solver
 
 	bool ContactForm::is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
-		const auto displaced0 = compute_displaced_surface(x0);
-		const auto displaced1 = compute_displaced_surface(x1);
+		POLYFEM_PROFILE_ZONE("is_step_collision_free", profile_scope());
+		const Eigen::MatrixXd &displaced0 = compute_displaced_surface(x0);
+		const Eigen::MatrixXd &displaced1 = compute_displaced_surface(x1);
 
 		// Skip CCD if the displacement is zero.
 		if ((displaced1 - displaced0).lpNorm<Eigen::Infinity>() == 0.0)
@@ -328,11 +646,23 @@ namespace polyfem::solver
 			return true;
 		}
 
+		// closed form, no broad phase for the planes
+		if (n_planes() > 0 && planes_max_step_size(displaced0, displaced1) < 1)
+			return false;
+
 		bool is_valid;
 		if (use_cached_candidates_)
 			is_valid = candidates_.is_step_collision_free(
 				collision_mesh_, displaced0, displaced1, dmin_,
 				ccd_tolerance_, ccd_max_iterations_);
+		else if (collision_hierarchy_)
+		{
+			ipc::Candidates candidates;
+			build_candidates(displaced0, displaced1, /*inflation_radius=*/dmin_ / 2, candidates);
+			is_valid = candidates.is_step_collision_free(
+				collision_mesh_, displaced0, displaced1, dmin_,
+				ccd_tolerance_, ccd_max_iterations_);
+		}
 		else
 			is_valid = ipc::is_step_collision_free(
 				collision_mesh_, displaced0, displaced1, broad_phase_method_,
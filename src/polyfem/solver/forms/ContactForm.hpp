@@ -10,6 +10,9 @@
 #include <ipc/broad_phase/broad_phase.hpp>
 #include <ipc/potentials/barrier_potential.hpp>
 
+#include <array>
+#include <memory>
+
 // map BroadPhaseMethod values to JSON as strings
 namespace ipc
 {
@@ -29,6 +32,16 @@ namespace ipc
 		 {ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE, "STQ"}})
 } // namespace ipc
 
+namespace polyfem::mesh
+{
+	class CollisionHierarchy;
+} // namespace polyfem::mesh
+
+namespace polyfem::time_integrator
+{
+	class ImplicitTimeIntegrator;
+} // namespace polyfem::time_integrator
+
 namespace polyfem::solver
 {
 	/// @brief Form representing the contact potential and forces
@@ -123,7 +136,9 @@ namespace polyfem::solver
 		virtual void update_barrier_stiffness(const Eigen::VectorXd &x, const Eigen::MatrixXd &grad_energy);
 
 		/// @brief Compute the displaced positions of the surface nodes
-		Eigen::MatrixXd compute_displaced_surface(const Eigen::VectorXd &x) const;
+		/// @note The result is cached for the last two solutions (e.g., the two ends of a step) and stays valid until
+		/// the displaced surface of a third one is computed
+		const Eigen::MatrixXd &compute_displaced_surface(const Eigen::VectorXd &x) const;
 
 		/// @brief Get the current barrier stiffness
 		double barrier_stiffness() const { return barrier_stiffness_; }
@@ -141,15 +156,54 @@ namespace polyfem::solver
 		/// @brief If true, output debug files
 		bool save_ccd_debug_meshes = false;
 
+		/// @brief Enable the incremental update of the collision set
+		/// @param slack Fraction of dhat the vertices can move before the collision candidates are rebuilt (0 disables it)
+		void set_incremental_slack(const double slack) { incremental_slack_ = slack; }
+
+		/// @brief Keep the incremental collision candidates across time steps, the slack is widened to the motion predicted from the velocity
+		/// @param time_integrator Time integrator giving the velocity and the time step
+		void set_time_integrator(const std::shared_ptr<const time_integrator::ImplicitTimeIntegrator> &time_integrator) { time_integrator_ = time_integrator; }
+
+		/// @brief Add analytic half-space obstacles, the collision vertices are kept on the side of the normal.
+		/// The vertex-plane distances and time of impacts are computed in closed form per vertex, without broad phase.
+		/// @param points Point of every plane (one row per plane)
+		/// @param normals Unit normal of every plane (one row per plane)
+		/// @param n_obstacle_vertices Number of obstacle vertices at the end of the full collision mesh, they are not tested against the planes
+		void set_planes(const Eigen::MatrixXd &points, const Eigen::MatrixXd &normals, const int n_obstacle_vertices);
+
+		/// @brief Use clusters of the collision mesh as a coarse level of the broad phase and CCD, the primitives are only
+		/// tested against the ones of the clusters whose boxes overlap (e.g., for finely upsampled collision proxies)
+		/// @param hierarchy Hierarchy of the collision mesh, nullptr to use the broad phase method
+		void set_collision_hierarchy(const std::shared_ptr<const mesh::CollisionHierarchy> &hierarchy) { collision_hierarchy_ = hierarchy; }
+		int n_planes() const { return plane_points_.rows(); }
+
 		double dhat() const { return dhat_; }
 		const ipc::Collisions &collision_set() const { return collision_set_; }
 		const ipc::BarrierPotential &barrier_potential() const { return barrier_potential_; }
 
+		/// @brief Heap memory of the cached candidates, collisions and barrier hessian in bytes, the collision mesh is not owned
+		size_t memory_bytes() const;
+
 	protected:
 		/// @brief Update the cached candidate set for the current solution
 		/// @param displaced_surface Vertex positions displaced by the current solution
 		void update_collision_set(const Eigen::MatrixXd &displaced_surface);
 
+		/// @brief Build the candidates of the boxes swept from V0 to V1 and inflated by inflation_radius, with the
+		/// collision hierarchy if any or the broad phase method
+		void build_candidates(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1, const double inflation_radius, ipc::Candidates &candidates) const;
+
+		/// @brief Barrier potential of every collision mesh vertex against the planes (zero away from them)
+		/// @param V Displaced collision mesh vertices
+		/// @param convergent Weight the vertices by their area as the convergent formulation
+		Eigen::VectorXd planes_potential(const Eigen::MatrixXd &V, const bool convergent) const;
+		/// @brief Add the gradient of planes_potential to grad, on the collision mesh dofs
+		void planes_gradient(const Eigen::MatrixXd &V, const bool convergent, Eigen::VectorXd &grad) const;
+		/// @brief Hessian of planes_potential on the collision mesh dofs, one dim x dim block per vertex
+		StiffnessMatrix planes_hessian(const Eigen::MatrixXd &V) const;
+		/// @brief Largest step in [0, 1] keeping the vertices strictly above the planes
+		double planes_max_step_size(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1) const;
+
 		/// @brief Collision mesh
 		const ipc::CollisionMesh &collision_mesh_;
 
@@ -192,6 +246,35 @@ namespace polyfem::solver
 		/// @brief Cached candidate set for the current solution
 		ipc::Candidates candidates_;
 
+		/// Fraction of dhat the vertices can move before incremental_candidates_ are rebuilt
+		double incremental_slack_ = 0;
+		/// Slack used for the next rebuild, at least incremental_slack_ * dhat, widened by the predicted motion of a time step
+		double incremental_step_slack_ = 0;
+		/// Candidates inflated by incremental_candidates_slack_, valid while no vertex moved more than it from incremental_surface_
+		ipc::Candidates incremental_candidates_;
+		double incremental_candidates_slack_ = 0;
+		Eigen::MatrixXd incremental_surface_;
+		std::shared_ptr<const time_integrator::ImplicitTimeIntegrator> time_integrator_;
+
+		/// Clusters of the collision mesh used as the coarse level of the broad phase, null to use broad_phase_method_
+		std::shared_ptr<const mesh::CollisionHierarchy> collision_hierarchy_;
+
+		/// Displaced surfaces of the last two solutions, the line searches and the derivatives evaluate the same x many times
+		mutable std::array<Eigen::VectorXd, 2> displaced_x_;
+		mutable std::array<Eigen::MatrixXd, 2> displaced_surface_;
+		/// Slot of the last displaced surface used, the other one is overwritten by the next new solution
+		mutable int last_displaced_ = 0;
+
+		/// Barrier hessian on the collision mesh, its pattern is kept and only grown when new pairs appear
+		mutable StiffnessMatrix hessian_pattern_;
+		mutable std::vector<ipc::MatrixMax12d> local_hessians_;
+
 		const ipc::BarrierPotential barrier_potential_;
+
+		/// Point and unit normal of every plane obstacle (one row per plane)
+		Eigen::MatrixXd plane_points_;
+		Eigen::MatrixXd plane_normals_;
+		/// Collision mesh vertices tested against the planes (all but the obstacle ones)
+		std::vector<int> plane_vertices_;
 	};
 } // namespace polyfem::solver
@@ -53,8 +53,32 @@ namespace polyfem::solver
 		mat_cache_ = std::make_unique<utils::SparseMatrixCache>();
 	}
 
+	void ElasticForm::set_hessian_storage(const bool block, const bool symmetric)
+	{
+		block_hessian_ = block;
+		symmetric_hessian_ = symmetric;
+		// scalar problems have 1x1 blocks
+		if (block && assembler_.size() > 1)
+			mat_cache_ = std::make_unique<utils::BlockSparseMatrixCache>(assembler_.size());
+		else
+			mat_cache_ = std::make_unique<utils::SparseMatrixCache>();
+		mat_cache_->set_symmetric(symmetric && assembler_.is_hessian_symmetric());
+	}
+
 	double ElasticForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
+		if (cache_evaluations_)
+		{
+			// same sweep as assemble_energy, the energies of the elements are kept for the output
+			if (energy_x_.size() != x.size() || energy_x_ != x)
+			{
+				energy_per_element_ = assembler_.assemble_energy_per_element(
+					is_volume_, bases_, geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_);
+				energy_x_ = x;
+			}
+			return energy_per_element_.sum();
+		}
+
 		return assembler_.assemble_energy(
 			is_volume_,
 			bases_, geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_);
@@ -62,6 +86,9 @@ namespace polyfem::solver
 
 	Eigen::VectorXd ElasticForm::value_per_element_unweighted(const Eigen::VectorXd &x) const
 	{
+		if (cache_evaluations_ && energy_x_.size() == x.size() && energy_x_ == x)
+			return energy_per_element_;
+
 		const Eigen::VectorXd out = assembler_.assemble_energy_per_element(
 			is_volume_, bases_, geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_);
 		assert(abs(out.sum() - value_unweighted(x)) < std::max(1e-10 * out.sum(), 1e-10));
@@ -70,10 +97,36 @@ namespace polyfem::solver
 
 	void ElasticForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 	{
+		if (cache_evaluations_ && gradient_x_.size() == x.size() && gradient_x_ == x)
+		{
+			gradv = gradient_;
+			return;
+		}
+
 		Eigen::MatrixXd grad;
 		assembler_.assemble_gradient(is_volume_, n_bases_, bases_, geom_bases_,
 									 ass_vals_cache_, t_, dt_, x, x_prev_, grad);
 		gradv = grad;
+
+		if (cache_evaluations_)
+		{
+			gradient_x_ = x;
+			gradient_ = gradv;
+		}
+	}
+
+	void ElasticForm::clear_cached_evaluations()
+	{
+		energy_x_.resize(0);
+		energy_per_element_.resize(0);
+		gradient_x_.resize(0);
+		gradient_.resize(0);
+	}
+
+	void ElasticForm::element_sampling_changed()
+	{
+		clear_cached_evaluations();
+		set_hessian_storage(block_hessian_, symmetric_hessian_);
 	}
 
 	void ElasticForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
@@ -96,6 +149,51 @@ namespace polyfem::solver
 		}
 	}
 
+	void ElasticForm::apply_hessian_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out) const
+	{
+		POLYFEM_SCOPED_TIMER("elastic hessian-vector product");
+
+		if (assembler_.is_linear())
+		{
+			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
+			out = cached_stiffness_ * v;
+		}
+		else
+		{
+			Eigen::MatrixXd out_mat;
+			assembler_.apply_hessian(
+				is_volume_, n_bases_, project_to_psd_, bases_,
+				geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_, v, out_mat);
+			out = out_mat;
+		}
+	}
+
+	void ElasticForm::value_gradient_hessian(const Eigen::VectorXd &x, double &value, Eigen::VectorXd &gradv, StiffnessMatrix &hessian) const
+	{
+		if (assembler_.is_linear())
+		{
+			Form::value_gradient_hessian(x, value, gradv, hessian);
+			return;
+		}
+
+		POLYFEM_SCOPED_TIMER("elastic value, gradient, and hessian");
+
+		Eigen::MatrixXd grad;
+		assembler_.assemble_energy_gradient_hessian(
+			is_volume_, n_bases_, project_to_psd_, bases_,
+			geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_, *mat_cache_, value, grad, hessian);
+
+		if (cache_evaluations_)
+		{
+			gradient_x_ = x;
+			gradient_ = grad;
+		}
+
+		value *= weight();
+		gradv = weight() * grad;
+		hessian *= weight();
+	}
+
 	bool ElasticForm::is_step_valid(const Eigen::VectorXd &, const Eigen::VectorXd &x1) const
 	{
 		Eigen::VectorXd grad;
@@ -139,8 +237,7 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
@@ -181,8 +278,7 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
@@ -229,8 +325,7 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 					assembler::ElementAssemblyValues gvals;
 					gvals.compute(e, is_volume_, vals.quadrature.points, geom_bases_[e], geom_bases_[e]);
 
@@ -294,8 +389,7 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 					assembler::ElementAssemblyValues gvals;
 					gvals.compute(e, is_volume_, vals.quadrature.points, geom_bases_[e], geom_bases_[e]);
 
@@ -7,6 +7,7 @@
 #include <polyfem/assembler/AssemblyValsCache.hpp>
 
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
 
 namespace polyfem::solver
 {
@@ -26,6 +27,10 @@ namespace polyfem::solver
 
 		std::string name() const override { return "elastic"; }
 
+		/// @brief The Hessian of a linear material is the cached stiffness matrix
+		bool is_hessian_constant() const override { return assembler_.is_linear(); }
+		bool is_hessian_static() const override { return assembler_.is_linear(); }
+
 	protected:
 		/// @brief Compute the elastic potential value
 		/// @param x Current solution
@@ -47,7 +52,20 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the second derivative of the value wrt x times v without assembling it
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply
+		/// @param[out] out Output Hessian of the value wrt x times v
+		void apply_hessian_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out) const override;
+
 	public:
+		/// @brief Compute the value, gradient, and Hessian in a single sweep over the elements
+		/// @param[in] x Current solution
+		/// @param[out] value Computed value
+		/// @param[out] gradv Output gradient of the value wrt x
+		/// @param[out] hessian Output Hessian of the value wrt x
+		void value_gradient_hessian(const Eigen::VectorXd &x, double &value, Eigen::VectorXd &gradv, StiffnessMatrix &hessian) const override;
+
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
 		/// @param x1 Proposed next solution
@@ -61,6 +79,41 @@ namespace polyfem::solver
 		{
 			t_ = t;
 			x_prev_ = x;
+			clear_cached_evaluations();
+		}
+
+		/// @brief Set the time step size used by rate-dependent assemblers (e.g., viscous damping)
+		void set_dt(const double dt)
+		{
+			dt_ = dt;
+			clear_cached_evaluations();
+		}
+
+		/// @brief Keep the per-element energies and the gradient of the last evaluation, so that exporting the
+		/// converged solution (e.g., energies and forces) does not sweep the elements again
+		void set_cache_evaluations(const bool cache)
+		{
+			cache_evaluations_ = cache;
+			clear_cached_evaluations();
+		}
+
+		/// @brief Drop the cached evaluations
+		void clear_cached_evaluations();
+
+		/// @brief To call when the elements integrated by the assembler change (see NLAssembler::set_element_sampling),
+		/// drops the cached evaluations and the Hessian pattern, which only has slots for the elements assembled so far
+		void element_sampling_changed();
+
+		/// @brief Choose how the Hessian is assembled
+		/// @param block by dim x dim blocks for vector-valued problems (see utils::BlockSparseMatrixCache)
+		/// @param symmetric only scatter the upper triangle of the element Hessians, if the assembler allows it
+		void set_hessian_storage(const bool block, const bool symmetric);
+
+		/// @brief Heap memory of the cached stiffness and of the matrix cache in bytes
+		size_t memory_bytes() const
+		{
+			return utils::memory_bytes(cached_stiffness_) + (mat_cache_ ? mat_cache_->memory_bytes() : 0)
+				   + sizeof(double) * (energy_x_.size() + energy_per_element_.size() + gradient_x_.size() + gradient_.size());
 		}
 
 		/// @brief Compute the derivative of the force wrt lame/damping parameters, then multiply the resulting matrix with adjoint_sol.
@@ -86,15 +139,23 @@ namespace polyfem::solver
 		const assembler::Assembler &assembler_; ///< Reference to the assembler
 		const assembler::AssemblyValsCache &ass_vals_cache_;
 		double t_;
-		const double dt_;
+		double dt_;
 		const bool is_volume_;
 
 		StiffnessMatrix cached_stiffness_;                      ///< Cached stiffness matrix for linear elasticity
 		mutable std::unique_ptr<utils::MatrixCache> mat_cache_; ///< Matrix cache (mutable because it is modified in second_derivative_unweighted)
+		bool block_hessian_ = false;     ///< see set_hessian_storage
+		bool symmetric_hessian_ = false; ///< see set_hessian_storage
 
 		/// @brief Compute the stiffness matrix (cached)
 		void compute_cached_stiffness();
 
 		Eigen::VectorXd x_prev_;
+
+		bool cache_evaluations_ = false;
+		/// Solution and per-element energies (unweighted) of the last value evaluation, empty if not cached
+		mutable Eigen::VectorXd energy_x_, energy_per_element_;
+		/// Solution and gradient (unweighted) of the last gradient evaluation, empty if not cached
+		mutable Eigen::VectorXd gradient_x_, gradient_;
 	};
 } // namespace polyfem::solver
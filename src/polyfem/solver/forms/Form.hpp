@@ -1,9 +1,12 @@
 #pragma once
 
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/Profiler.hpp>
 #include <polysolve/nonlinear/PostStepData.hpp>
 
 #include <filesystem>
+#include <vector>
 
 namespace polyfem::solver
 {
@@ -23,6 +26,7 @@ namespace polyfem::solver
 		/// @return Computed value
 		inline virtual double value(const Eigen::VectorXd &x) const
 		{
+			POLYFEM_PROFILE_ZONE("value", profile_scope());
 			return weight() * value_unweighted(x);
 		}
 
@@ -39,6 +43,7 @@ namespace polyfem::solver
 		/// @param[out] gradv Output gradient of the value wrt x
 		inline virtual void first_derivative(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 		{
+			POLYFEM_PROFILE_ZONE("first_derivative", profile_scope());
 			first_derivative_unweighted(x, gradv);
 			gradv *= weight();
 		}
@@ -49,10 +54,63 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		inline void second_derivative(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
 		{
+			POLYFEM_PROFILE_ZONE("second_derivative", profile_scope());
 			second_derivative_unweighted(x, hessian);
 			hessian *= weight();
 		}
 
+		/// @brief Add the second derivative multiplied with the weigth to a Hessian
+		/// @note Forms holding their Hessian (e.g., the mass matrix) add it in the pattern of hessian without a copy.
+		/// @param[in] x Current solution
+		/// @param[in,out] hessian Compressed matrix to add to, its pattern grows if it does not contain the one of the form
+		inline void add_second_derivative(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
+		{
+			POLYFEM_PROFILE_ZONE("second_derivative", profile_scope());
+			if (add_second_derivative_unweighted(x, weight(), hessian))
+				return;
+
+			StiffnessMatrix tmp;
+			second_derivative_unweighted(x, tmp);
+			if (!utils::add_to_pattern(tmp, hessian, weight()))
+			{
+				hessian += weight() * tmp;
+				hessian.makeCompressed();
+			}
+		}
+
+		/// @brief Determine if the second derivative does not depend on x
+		/// @note It can still change in init, update_quantities, init_lagging, update_lagging, and with the weight.
+		virtual bool is_hessian_constant() const { return false; }
+
+		/// @brief Determine if the constant second derivative does not change for the whole simulation (e.g., a linear material)
+		/// @note Only used if is_hessian_constant, it can still change with the weight.
+		virtual bool is_hessian_static() const { return false; }
+
+		/// @brief Compute the value, first, and second derivative multiplied with the weigth at once
+		/// @note Forms that can share work between the three override this, the default evaluates them separately.
+		/// @param[in] x Current solution
+		/// @param[out] value Computed value
+		/// @param[out] gradv Output gradient of the value wrt x
+		/// @param[out] hessian Output Hessian of the value wrt x
+		virtual void value_gradient_hessian(const Eigen::VectorXd &x, double &value, Eigen::VectorXd &gradv, StiffnessMatrix &hessian) const
+		{
+			value = this->value(x);
+			first_derivative(x, gradv);
+			second_derivative(x, hessian);
+		}
+
+		/// @brief Compute the product of the second derivative multiplied with the weigth and a vector.
+		/// @note Forms that can apply their Hessian element by element do so without assembling it.
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply
+		/// @param[out] out Output Hessian of the value wrt x times v
+		inline void apply_hessian(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out) const
+		{
+			POLYFEM_PROFILE_ZONE("apply_hessian", profile_scope());
+			apply_hessian_unweighted(x, v, out);
+			out *= weight();
+		}
+
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
 		/// @param x1 Proposed next solution
@@ -104,6 +162,10 @@ namespace polyfem::solver
 		/// @return True if the form requires lagging
 		virtual bool uses_lagging() const { return false; }
 
+		/// @brief Forms used by the evaluations of this one, the two are never evaluated concurrently
+		/// @note See FullNLProblem::set_concurrent_forms.
+		virtual std::vector<const Form *> dependencies() const { return {}; }
+
 		/// @brief Set project to psd
 		/// @param val If true, the form's second derivative is projected to be positive semidefinite
 		void set_project_to_psd(bool val) { project_to_psd_ = val; }
@@ -151,6 +213,16 @@ namespace polyfem::solver
 
 		std::string output_dir_;
 
+		mutable const char *profile_scope_ = nullptr;
+
+		/// name of the form in the profiler zones, interned on first use
+		const char *profile_scope() const
+		{
+			if (profile_scope_ == nullptr)
+				profile_scope_ = utils::Profiler::get().intern(name());
+			return profile_scope_;
+		}
+
 		std::string resolve_output_path(const std::string &path) const
 		{
 			if (output_dir_.empty() || path.empty() || std::filesystem::path(path).is_absolute())
@@ -180,5 +252,24 @@ namespace polyfem::solver
 		/// @param[in] x Current solution
 		/// @param[out] hessian Output Hessian of the value wrt x
 		virtual void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const = 0;
+
+		/// @brief Add scale times the second derivative to hessian without assembling it separately
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the second derivative
+		/// @param[in,out] hessian Compressed matrix to add to
+		/// @return False, leaving hessian untouched, if the form does not support it or hessian does not contain its pattern
+		virtual bool add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, StiffnessMatrix &hessian) const { return false; }
+
+		/// @brief Compute the second derivative of the value wrt x times v
+		/// @note The default implementation assembles the Hessian.
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply
+		/// @param[out] out Output Hessian of the value wrt x times v
+		virtual void apply_hessian_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out) const
+		{
+			StiffnessMatrix hessian;
+			second_derivative_unweighted(x, hessian);
+			out = hessian * v;
+		}
 	};
 } // namespace polyfem::solver
@@ -3,9 +3,125 @@
 
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/par_for.hpp>
+
+#include <algorithm>
+#include <map>
 
 namespace polyfem::solver
 {
+	namespace
+	{
+		/// splits the collisions of one type into the ones whose friction collision can be kept from prev and the ones to rebuild
+		template <typename FrictionCollision, typename Collision>
+		void split_collisions(
+			const std::vector<Collision> &collisions,
+			const std::vector<FrictionCollision> &prev,
+			const std::vector<char> &moved,
+			const Eigen::MatrixXi &E,
+			const Eigen::MatrixXi &F,
+			std::vector<FrictionCollision> &kept,
+			std::vector<Collision> &to_rebuild)
+		{
+			std::map<std::array<long, 4>, int> prev_ids;
+			for (int i = 0; i < prev.size(); ++i)
+				prev_ids[prev[i].vertex_ids(E, F)] = i;
+
+			// previous friction collision of every collision, -1 to rebuild it
+			std::vector<int> prev_id(collisions.size(), -1);
+			utils::maybe_parallel_for(collisions.size(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					const std::array<long, 4> ids = collisions[i].vertex_ids(E, F);
+					bool has_moved = false;
+					for (int k = 0; k < collisions[i].num_vertices(); ++k)
+						has_moved = has_moved || moved[ids[k]];
+
+					const auto it = prev_ids.find(ids);
+					if (!has_moved && it != prev_ids.end())
+						prev_id[i] = it->second;
+				}
+			});
+
+			for (int i = 0; i < collisions.size(); ++i)
+			{
+				if (prev_id[i] >= 0)
+					kept.push_back(prev[prev_id[i]]);
+				else
+					to_rebuild.push_back(collisions[i]);
+			}
+		}
+
+		/// splits the collisions of one type in contiguous ranges of the same size, one per chunk
+		template <typename Collision>
+		void split_in_chunks(const std::vector<Collision> &collisions, std::vector<Collision> ipc::Collisions::*type, std::vector<ipc::Collisions> &chunks)
+		{
+			const size_t n_chunks = chunks.size();
+			for (size_t c = 0; c < n_chunks; ++c)
+			{
+				const size_t begin = collisions.size() * c / n_chunks;
+				const size_t end = collisions.size() * (c + 1) / n_chunks;
+				(chunks[c].*type).assign(collisions.begin() + begin, collisions.begin() + end);
+			}
+		}
+
+		template <typename FrictionCollision>
+		void append(const std::vector<FrictionCollision> &from, std::vector<FrictionCollision> &to)
+		{
+			to.insert(to.end(), from.begin(), from.end());
+		}
+
+		/// build the friction collisions of collision_set in chunks, one ipc build per chunk concurrently, the friction
+		/// collisions are independent of each other and are concatenated in the order of collision_set
+		void build_friction_collisions(
+			const ipc::CollisionMesh &collision_mesh,
+			const Eigen::MatrixXd &displaced_surface,
+			const ipc::Collisions &collision_set,
+			const ipc::BarrierPotential &barrier_potential,
+			const double barrier_stiffness,
+			const double mu,
+			ipc::FrictionCollisions &friction_collision_set)
+		{
+			// below this, one build is faster than the copies
+			constexpr int min_chunk_size = 1000;
+			const int n_chunks = std::min<int>(utils::NThread::get().num_threads(), collision_set.size() / min_chunk_size);
+			if (n_chunks <= 1)
+			{
+				friction_collision_set.build(
+					collision_mesh, displaced_surface, collision_set, barrier_potential, barrier_stiffness, mu);
+				return;
+			}
+
+			std::vector<ipc::Collisions> chunks(n_chunks);
+			for (ipc::Collisions &chunk : chunks)
+			{
+				chunk.set_use_convergent_formulation(collision_set.use_convergent_formulation());
+				chunk.set_are_shape_derivatives_enabled(collision_set.are_shape_derivatives_enabled());
+			}
+			split_in_chunks(collision_set.vv_collisions, &ipc::Collisions::vv_collisions, chunks);
+			split_in_chunks(collision_set.ev_collisions, &ipc::Collisions::ev_collisions, chunks);
+			split_in_chunks(collision_set.ee_collisions, &ipc::Collisions::ee_collisions, chunks);
+			split_in_chunks(collision_set.fv_collisions, &ipc::Collisions::fv_collisions, chunks);
+
+			std::vector<ipc::FrictionCollisions> built(n_chunks);
+			utils::maybe_parallel_for(n_chunks, [&](int start, int end, int thread_id) {
+				for (int c = start; c < end; ++c)
+					built[c].build(collision_mesh, displaced_surface, chunks[c], barrier_potential, barrier_stiffness, mu);
+			});
+
+			friction_collision_set.clear();
+			for (const ipc::FrictionCollisions &b : built)
+			{
+				append(b.vv_collisions, friction_collision_set.vv_collisions);
+				append(b.ev_collisions, friction_collision_set.ev_collisions);
+				append(b.ee_collisions, friction_collision_set.ee_collisions);
+				append(b.fv_collisions, friction_collision_set.fv_collisions);
+			}
+		}
+	} // namespace
+
 	FrictionForm::FrictionForm(
 		const ipc::CollisionMesh &collision_mesh,
 		const std::shared_ptr<time_integrator::ImplicitTimeIntegrator> time_integrator,
@@ -85,7 +201,7 @@ namespace polyfem::solver
 		term = collision_mesh_.to_full_dof(hess).transpose() * adjoint;
 	}
 
-	Eigen::MatrixXd FrictionForm::compute_displaced_surface(const Eigen::VectorXd &x) const
+	const Eigen::MatrixXd &FrictionForm::compute_displaced_surface(const Eigen::VectorXd &x) const
 	{
 		return contact_form_.compute_displaced_surface(x);
 	}
@@ -93,8 +209,29 @@ namespace polyfem::solver
 	Eigen::MatrixXd FrictionForm::compute_surface_velocities(const Eigen::VectorXd &x) const
 	{
 		// In the case of a static problem, the velocity is the displacement
-		const Eigen::VectorXd v = time_integrator_ != nullptr ? time_integrator_->compute_velocity(x) : x;
-		return collision_mesh_.map_displacements(utils::unflatten(v, collision_mesh_.dim()));
+		if (time_integrator_ == nullptr)
+			return collision_mesh_.map_displacements(utils::unflatten(x, collision_mesh_.dim()));
+
+		if (surface_velocity_offset_.size() != collision_mesh_.num_vertices() * collision_mesh_.dim())
+			return collision_mesh_.map_displacements(utils::unflatten(time_integrator_->compute_velocity(x), collision_mesh_.dim()));
+
+		// v(x) = dv_dx x + v(0), without a full size velocity temporary
+		Eigen::MatrixXd v = collision_mesh_.map_displacements(utils::unflatten(x, collision_mesh_.dim()));
+		v *= dv_dx();
+		v += surface_velocity_offset_;
+		return v;
+	}
+
+	void FrictionForm::update_surface_velocity_offset()
+	{
+		if (time_integrator_ == nullptr || time_integrator_->steps() == 0)
+		{
+			surface_velocity_offset_.resize(0, 0);
+			return;
+		}
+
+		const Eigen::VectorXd zero = Eigen::VectorXd::Zero(time_integrator_->x_prev().size());
+		surface_velocity_offset_ = collision_mesh_.map_displacements(utils::unflatten(time_integrator_->compute_velocity(zero), collision_mesh_.dim()));
 	}
 
 	double FrictionForm::dv_dx() const
@@ -126,7 +263,7 @@ namespace polyfem::solver
 
 	void FrictionForm::update_lagging(const Eigen::VectorXd &x, const int iter_num)
 	{
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
+		const Eigen::MatrixXd &displaced_surface = compute_displaced_surface(x);
 
 		ipc::Collisions collision_set;
 		collision_set.set_use_convergent_formulation(contact_form_.use_convergent_formulation());
@@ -134,8 +271,56 @@ namespace polyfem::solver
 		collision_set.build(
 			collision_mesh_, displaced_surface, contact_form_.dhat(), /*dmin=*/0, broad_phase_method_);
 
-		friction_collision_set_.build(
-			collision_mesh_, displaced_surface, collision_set,
-			contact_form_.barrier_potential(), contact_form_.barrier_stiffness(), mu_);
+		// the first update of a time step always re-linearizes everything
+		const bool can_relinearize = relinearization_tol_ > 0 && iter_num != 0
+									 && linearized_barrier_stiffness_ == contact_form_.barrier_stiffness()
+									 && linearized_surface_.rows() == displaced_surface.rows();
+		if (!can_relinearize)
+		{
+			build_friction_collisions(
+				collision_mesh_, displaced_surface, collision_set,
+				contact_form_.barrier_potential(), contact_form_.barrier_stiffness(), mu_, friction_collision_set_);
+
+			linearized_surface_ = displaced_surface;
+			linearized_barrier_stiffness_ = contact_form_.barrier_stiffness();
+			return;
+		}
+
+		// contacts whose vertices stayed within the tolerance of the last full build keep their
+		// tangent basis, closest point, and normal force; only the others are re-linearized
+		const double tol = relinearization_tol_ * contact_form_.dhat();
+		// not a std::vector<bool>, its elements cannot be written concurrently
+		std::vector<char> moved(displaced_surface.rows());
+		utils::maybe_parallel_for(displaced_surface.rows(), [&](int start, int end, int thread_id) {
+			for (int v = start; v < end; ++v)
+				moved[v] = (displaced_surface.row(v) - linearized_surface_.row(v)).norm() > tol;
+		});
+
+		const Eigen::MatrixXi &E = collision_mesh_.edges();
+		const Eigen::MatrixXi &F = collision_mesh_.faces();
+
+		ipc::FrictionCollisions kept;
+		ipc::Collisions to_rebuild;
+		to_rebuild.set_use_convergent_formulation(contact_form_.use_convergent_formulation());
+		to_rebuild.set_are_shape_derivatives_enabled(contact_form_.enable_shape_derivatives());
+
+		split_collisions(collision_set.vv_collisions, friction_collision_set_.vv_collisions, moved, E, F, kept.vv_collisions, to_rebuild.vv_collisions);
+		split_collisions(collision_set.ev_collisions, friction_collision_set_.ev_collisions, moved, E, F, kept.ev_collisions, to_rebuild.ev_collisions);
+		split_collisions(collision_set.ee_collisions, friction_collision_set_.ee_collisions, moved, E, F, kept.ee_collisions, to_rebuild.ee_collisions);
+		split_collisions(collision_set.fv_collisions, friction_collision_set_.fv_collisions, moved, E, F, kept.fv_collisions, to_rebuild.fv_collisions);
+
+		logger().trace("Re-linearizing {} of {} friction collisions", to_rebuild.size(), collision_set.size());
+
+		ipc::FrictionCollisions rebuilt;
+		build_friction_collisions(
+			collision_mesh_, displaced_surface, to_rebuild,
+			contact_form_.barrier_potential(), contact_form_.barrier_stiffness(), mu_, rebuilt);
+
+		append(rebuilt.vv_collisions, kept.vv_collisions);
+		append(rebuilt.ev_collisions, kept.ev_collisions);
+		append(rebuilt.ee_collisions, kept.ee_collisions);
+		append(rebuilt.fv_collisions, kept.fv_collisions);
+
+		friction_collision_set_ = std::move(kept);
 	}
 } // namespace polyfem::solver
@@ -57,6 +57,15 @@ namespace polyfem::solver
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
 	public:
+		/// @brief Initialize the form
+		/// @param x Current solution
+		void init(const Eigen::VectorXd &x) override { update_surface_velocity_offset(); }
+
+		/// @brief Update time-dependent fields
+		/// @param t Current time
+		/// @param x Current solution at time t
+		void update_quantities(const double t, const Eigen::VectorXd &x) override { update_surface_velocity_offset(); }
+
 		/// @brief Initialize lagged fields
 		/// @param x Current solution
 		void init_lagging(const Eigen::VectorXd &x) override { update_lagging(x, 0); }
@@ -76,8 +85,10 @@ namespace polyfem::solver
 		/// @return True if the form requires lagging
 		bool uses_lagging() const override { return true; }
 
+		std::vector<const Form *> dependencies() const override { return {&contact_form_}; }
+
 		/// @brief Compute the displaced positions of the surface nodes
-		Eigen::MatrixXd compute_displaced_surface(const Eigen::VectorXd &x) const;
+		const Eigen::MatrixXd &compute_displaced_surface(const Eigen::VectorXd &x) const;
 		/// @brief Compute the surface velocities
 		Eigen::MatrixXd compute_surface_velocities(const Eigen::VectorXd &x) const;
 		/// @brief Compute the derivative of the velocities wrt x
@@ -88,6 +99,10 @@ namespace polyfem::solver
 		const ipc::FrictionCollisions &friction_collision_set() const { return friction_collision_set_; }
 		const ipc::FrictionPotential &friction_potential() const { return friction_potential_; }
 
+		/// @brief Only re-linearize the contacts that moved in the lagging updates
+		/// @param tol Fraction of dhat a contact vertex can move before its friction collision is rebuilt (0 rebuilds all)
+		void set_relinearization_tolerance(const double tol) { relinearization_tol_ = tol; }
+
 	private:
 		/// Reference to the collision mesh
 		const ipc::CollisionMesh &collision_mesh_;
@@ -102,8 +117,19 @@ namespace polyfem::solver
 
 		ipc::FrictionCollisions friction_collision_set_; ///< Lagged friction constraint set
 
+		/// Surface velocities at x = 0, the velocities are affine in x and this part only depends on the previous steps
+		Eigen::MatrixXd surface_velocity_offset_;
+		/// @brief Recompute surface_velocity_offset_ from the state of the time integrator
+		void update_surface_velocity_offset();
+
 		const ContactForm &contact_form_; ///< necessary to have the barrier stiffnes, maybe clean me
 
 		const ipc::FrictionPotential friction_potential_;
+
+		/// Fraction of dhat a contact can move before being re-linearized in update_lagging
+		double relinearization_tol_ = 0;
+		/// Surface and barrier stiffness of the last full build of friction_collision_set_
+		Eigen::MatrixXd linearized_surface_;
+		double linearized_barrier_stiffness_ = -1;
 	};
 } // namespace polyfem::solver
@@ -80,8 +80,7 @@ namespace polyfem::solver
 
 			for (int e = start; e < end; ++e)
 			{
-				assembler::ElementAssemblyValues &vals = local_storage.vals;
-				ass_vals_cache.compute(e, is_volume, bases[e], geom_bases[e], vals);
+				const assembler::ElementAssemblyValues &vals = ass_vals_cache.get(e, is_volume, bases[e], geom_bases[e], local_storage.vals);
 				assembler::ElementAssemblyValues gvals;
 				gvals.compute(e, is_volume, vals.quadrature.points, geom_bases[e], geom_bases[e]);
 
@@ -33,6 +33,8 @@ namespace polyfem::solver
 
 		std::string name() const override { return "inertia"; }
 
+		bool is_hessian_constant() const override { return true; }
+
 		static void force_shape_derivative(
 			bool is_volume,
 			const int n_geom_bases,
@@ -61,6 +63,24 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Add scale times the mass matrix to hessian
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the second derivative
+		/// @param[in,out] hessian Compressed matrix to add to
+		bool add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, StiffnessMatrix &hessian) const override
+		{
+			return utils::add_to_pattern(mass_, hessian, scale);
+		}
+
+		/// @brief Compute the second derivative of the value wrt x times v
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply
+		/// @param[out] out Output Hessian of the value wrt x times v
+		void apply_hessian_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &out) const override
+		{
+			out = mass_ * v;
+		}
+
 	private:
 		// TODO mass might be time dependent
 		const StiffnessMatrix &mass_;                                    ///< Mass matrix
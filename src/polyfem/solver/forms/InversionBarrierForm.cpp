@@ -15,23 +15,63 @@ namespace polyfem::solver
 		const Eigen::MatrixXd &rest_positions, const Eigen::MatrixXi &elements, const int dim, const double vhat)
 		: rest_positions_(rest_positions), elements_(elements), dim_(dim), vhat_(vhat)
 	{
+		rest_volumes_ = element_volumes(rest_positions_);
+	}
+
+	Eigen::VectorXd InversionBarrierForm::element_volumes(const Eigen::MatrixXd &V) const
+	{
+		// Evaluated column-wise over all elements so that Eigen vectorizes the determinants
+		const auto edge = [&](const int vi, const int d) -> Eigen::ArrayXd {
+			return V(elements_.col(vi), d).array() - V(elements_.col(0), d).array();
+		};
+
+		if (elements_.cols() == 3)
+		{
+			assert(dim_ == 2);
+			const Eigen::ArrayXd e1x = edge(1, 0), e1y = edge(1, 1);
+			const Eigen::ArrayXd e2x = edge(2, 0), e2y = edge(2, 1);
+			return (e1x * e2y - e2x * e1y) / 2.0;
+		}
+
+		assert(elements_.cols() == 4 && dim_ == 3);
+		const Eigen::ArrayXd e1x = edge(1, 0), e1y = edge(1, 1), e1z = edge(1, 2);
+		const Eigen::ArrayXd e2x = edge(2, 0), e2y = edge(2, 1), e2z = edge(2, 2);
+		const Eigen::ArrayXd e3x = edge(3, 0), e3y = edge(3, 1), e3z = edge(3, 2);
+		return ((e1y * e2z - e1z * e2y) * e3x
+				+ (e1z * e2x - e1x * e2z) * e3y
+				+ (e1x * e2y - e1y * e2x) * e3z)
+			   / 6.0;
+	}
+
+	std::vector<int> InversionBarrierForm::active_elements(const Eigen::MatrixXd &V, Eigen::VectorXd &volumes) const
+	{
+		volumes = element_volumes(V);
+
+		// the barrier and its derivatives vanish for elements larger than vhat
+		std::vector<int> active;
+		for (int i = 0; i < volumes.size(); ++i)
+			if (volumes[i] < vhat_)
+				active.push_back(i);
+		return active;
 	}
 
 	double InversionBarrierForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
 		const Eigen::MatrixXd V = rest_positions_ + utils::unflatten(x, dim_);
 
+		Eigen::VectorXd volumes;
+		const std::vector<int> active = active_elements(V, volumes);
+
 		auto storage = utils::create_thread_storage<double>(0.0);
 
 		const double scale = 1.0 / (vhat_ * vhat_);
 
-		utils::maybe_parallel_for(elements_.rows(), [&](int start, int end, int thread_id) {
+		utils::maybe_parallel_for(active.size(), [&](int start, int end, int thread_id) {
 			double &local_potential = utils::get_local_thread_storage(storage, thread_id);
-			for (int i = start; i < end; i++)
+			for (int k = start; k < end; k++)
 			{
-				local_potential +=
-					scale * element_volume(rest_positions_(elements_.row(i), Eigen::all))
-					* ipc::barrier(element_volume(V(elements_.row(i), Eigen::all)), vhat_);
+				const int i = active[k];
+				local_potential += scale * rest_volumes_[i] * ipc::barrier(volumes[i], vhat_);
 			}
 		});
 
@@ -45,19 +85,22 @@ namespace polyfem::solver
 	{
 		const Eigen::MatrixXd V = rest_positions_ + utils::unflatten(x, dim_);
 
+		Eigen::VectorXd volumes;
+		const std::vector<int> active = active_elements(V, volumes);
+
 		auto storage = utils::create_thread_storage<Eigen::VectorXd>(Eigen::VectorXd::Zero(x.size()));
 
 		const double scale = 1.0 / (vhat_ * vhat_);
 
-		utils::maybe_parallel_for(elements_.rows(), [&](int start, int end, int thread_id) {
+		utils::maybe_parallel_for(active.size(), [&](int start, int end, int thread_id) {
 			Eigen::VectorXd &grad = utils::get_local_thread_storage(storage, thread_id);
-			for (int i = start; i < end; i++)
+			for (int k = start; k < end; k++)
 			{
+				const int i = active[k];
 				const Eigen::MatrixXd element_vertices = V(elements_.row(i), Eigen::all);
 
 				Eigen::VectorXd local_grad =
-					(scale * element_volume(rest_positions_(elements_.row(i), Eigen::all))
-					 * ipc::barrier_first_derivative(element_volume(element_vertices), vhat_))
+					(scale * rest_volumes_[i] * ipc::barrier_first_derivative(volumes[i], vhat_))
 					* element_volume_gradient(element_vertices);
 
 				ipc::local_gradient_to_global_gradient(local_grad, elements_.row(i), dim_, grad);
@@ -73,22 +116,26 @@ namespace polyfem::solver
 	{
 		const Eigen::MatrixXd V = rest_positions_ + utils::unflatten(x, dim_);
 
+		Eigen::VectorXd volumes;
+		const std::vector<int> active = active_elements(V, volumes);
+
 		auto storage = utils::create_thread_storage(std::vector<Eigen::Triplet<double>>());
 
 		const double scale = 1.0 / (vhat_ * vhat_);
 
-		utils::maybe_parallel_for(elements_.rows(), [&](int start, int end, int thread_id) {
+		utils::maybe_parallel_for(active.size(), [&](int start, int end, int thread_id) {
 			std::vector<Eigen::Triplet<double>> &hess_triplets =
 				utils::get_local_thread_storage(storage, thread_id);
 
-			for (int i = start; i < end; i++)
+			for (int k = start; k < end; k++)
 			{
+				const int i = active[k];
 				const Eigen::MatrixXd element_vertices = V(elements_.row(i), Eigen::all);
 
-				const double volume = element_volume(element_vertices);
+				const double volume = volumes[i];
 				const Eigen::VectorXd volume_grad = element_volume_gradient(element_vertices);
 
-				const double rest_volume = element_volume(rest_positions_(elements_.row(i), Eigen::all));
+				const double rest_volume = rest_volumes_[i];
 
 				Eigen::MatrixXd local_hess =
 					(scale * rest_volume * ipc::barrier_second_derivative(volume, vhat_)) * volume_grad * volume_grad.transpose()
@@ -174,15 +221,7 @@ namespace polyfem::solver
 	{
 		const Eigen::MatrixXd V = rest_positions_ + utils::unflatten(x1, dim_);
 
-		for (size_t i = 0; i < elements_.rows(); ++i)
-		{
-			// TODO: use exact predicate for this
-			if (element_volume(V(elements_.row(i), Eigen::all)) <= 0)
-			{
-				return false;
-			}
-		}
-
-		return true;
+		// TODO: use exact predicate for this
+		return (element_volumes(V).array() > 0).all();
 	}
 } // namespace polyfem::solver
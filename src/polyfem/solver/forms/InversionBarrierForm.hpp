@@ -5,6 +5,8 @@
 
 #include <polyfem/utils/Types.hpp>
 
+#include <vector>
+
 namespace polyfem::solver
 {
 	class InversionBarrierForm : public polyfem::solver::Form
@@ -44,7 +46,15 @@ namespace polyfem::solver
 		static Eigen::MatrixXd element_volume_hessian(const Eigen::MatrixXd &element_vertices);
 
 	private:
+		/// @brief Signed volume of every element at the vertex positions V
+		Eigen::VectorXd element_volumes(const Eigen::MatrixXd &V) const;
+		/// @brief Elements whose volume is below vhat, the only ones where the barrier is non-zero
+		/// @param[in] V Vertex positions
+		/// @param[out] volumes Signed volume of every element
+		std::vector<int> active_elements(const Eigen::MatrixXd &V, Eigen::VectorXd &volumes) const;
+
 		Eigen::MatrixXd rest_positions_;
+		Eigen::VectorXd rest_volumes_;
 		Eigen::MatrixXi elements_;
 		int dim_;
 		double vhat_;
@@ -1,14 +1,36 @@
 #include "PeriodicContactForm.hpp"
 
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/io/OBJWriter.hpp>
 #include <polyfem/solver/forms/parametrization/PeriodicMeshToMesh.hpp>
 #include <polyfem/State.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace polyfem::solver
 {
+	namespace
+	{
+		/// y = Aᵀ x, each column of A is an independent dot product
+		Eigen::VectorXd transpose_times(const StiffnessMatrix &A, const Eigen::VectorXd &x)
+		{
+			assert(A.rows() == x.size());
+			Eigen::VectorXd y(A.cols());
+			utils::maybe_parallel_for(A.outerSize(), [&](int start, int end, int thread_id) {
+				for (int k = start; k < end; ++k)
+				{
+					double val = 0;
+					for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+						val += it.value() * x(it.row());
+					y(k) = val;
+				}
+			});
+			return y;
+		}
+	} // namespace
+
 	PeriodicContactForm::PeriodicContactForm(const ipc::CollisionMesh &periodic_collision_mesh,
                         const Eigen::VectorXi &tiled_to_single,
                         const double dhat,
@@ -38,6 +60,13 @@ namespace polyfem::solver
         const int dim = collision_mesh_.dim();
         const auto &boundary_vertices = collision_mesh_.rest_positions();
 
+        // the rest positions only change with shape updates, keep the projection otherwise
+        if (proj.size() > 0 && projection_rest_positions_.rows() == boundary_vertices.rows()
+            && projection_rest_positions_ == boundary_vertices)
+            return;
+        projection_rest_positions_ = boundary_vertices;
+        hessian_full_outer_.clear();
+
         std::vector<Eigen::Triplet<double>> entries;
         for (int i = 0; i < collision_mesh_.num_vertices(); i++)
         {
@@ -53,49 +82,98 @@ namespace polyfem::solver
         proj.resize(n_single_dof_ * dim + dim * dim, tiled_to_single_.size() * dim);
         proj.setZero();
         proj.setFromTriplets(entries.begin(), entries.end());
+        proj_t_ = proj.transpose();
     }
 
     Eigen::VectorXd PeriodicContactForm::single_to_tiled(const Eigen::VectorXd &x) const
     {
-        const int dim = collision_mesh_.dim();
-        const auto &boundary_vertices = collision_mesh_.rest_positions();
-        assert(x.size() == n_single_dof_ * dim + dim * dim);
-
-        Eigen::VectorXd tiled_x;
-        tiled_x.setZero(tiled_to_single_.size() * dim);
-        for (int i = 0; i < collision_mesh_.num_vertices(); i++)
-        {
-            const int i_full = collision_mesh_.to_full_vertex_id(i);
-            for (int d = 0; d < dim; d++)
-                tiled_x(i_full * dim + d) += x(tiled_to_single_(i_full) * dim + d);
-            
-            for (int p = 0; p < dim; p++)
-                for (int q = 0; q < dim; q++)
-                    tiled_x(i_full * dim + p) += x(n_single_dof_ * dim + p * dim + q) * boundary_vertices(i, q);
-        }
-
-        return tiled_x;
+        assert(x.size() == n_single_dof_ * collision_mesh_.dim() + collision_mesh_.dim() * collision_mesh_.dim());
+        update_projection();
+        return transpose_times(proj, x);
     }
+
     Eigen::VectorXd PeriodicContactForm::tiled_to_single_grad(const Eigen::VectorXd &grad) const
     {
-        const int dim = collision_mesh_.dim();
-        const auto &boundary_vertices = collision_mesh_.rest_positions();
-        assert(grad.size() == tiled_to_single_.size() * dim);
+        assert(grad.size() == tiled_to_single_.size() * collision_mesh_.dim());
+        update_projection();
+        return transpose_times(proj_t_, grad);
+    }
 
-        Eigen::VectorXd reduced_grad;
-        reduced_grad.setZero(n_single_dof_ * dim + dim * dim);
-        for (int i = 0; i < collision_mesh_.num_vertices(); i++)
+    void PeriodicContactForm::project_hessian(StiffnessMatrix &hessian_full, StiffnessMatrix &hessian) const
+    {
+        update_projection();
+        hessian_full.makeCompressed();
+        const int n_outer = hessian_full.outerSize() + 1;
+        const int nnz = hessian_full.nonZeros();
+
+        const bool same_pattern =
+            hessian_full_outer_.size() == n_outer && hessian_full_inner_.size() == nnz
+            && std::equal(hessian_full_outer_.begin(), hessian_full_outer_.end(), hessian_full.outerIndexPtr())
+            && std::equal(hessian_full_inner_.begin(), hessian_full_inner_.end(), hessian_full.innerIndexPtr());
+
+        if (!same_pattern)
         {
-            const int i_full = collision_mesh_.to_full_vertex_id(i);
-            for (int d = 0; d < dim; d++)
-                reduced_grad(tiled_to_single_(i_full) * dim + d) += grad(i_full * dim + d);
-            
-            for (int p = 0; p < dim; p++)
-                for (int q = 0; q < dim; q++)
-                    reduced_grad(n_single_dof_ * dim + p * dim + q) += boundary_vertices(i, q) * grad(i_full * dim + p);
+            hessian_full_outer_.assign(hessian_full.outerIndexPtr(), hessian_full.outerIndexPtr() + n_outer);
+            hessian_full_inner_.assign(hessian_full.innerIndexPtr(), hessian_full.innerIndexPtr() + nnz);
+
+            // H(r, c) contributes P(a, r) * P(b, c) to entry (a, b)
+            std::vector<Eigen::Triplet<double>> entries;
+            for (int c = 0; c < hessian_full.outerSize(); ++c)
+                for (StiffnessMatrix::InnerIterator it(hessian_full, c); it; ++it)
+                    for (StiffnessMatrix::InnerIterator pa(proj, it.row()); pa; ++pa)
+                        for (StiffnessMatrix::InnerIterator pb(proj, c); pb; ++pb)
+                            entries.emplace_back(pa.row(), pb.row(), 0);
+
+            hessian_projected_.resize(proj.rows(), proj.rows());
+            hessian_projected_.setFromTriplets(entries.begin(), entries.end());
+            hessian_projected_.makeCompressed();
+
+            std::vector<std::array<int, 2>> scatter; // (projected entry, full entry)
+            std::vector<double> weights;
+            scatter.reserve(entries.size());
+            weights.reserve(entries.size());
+            for (int c = 0; c < hessian_full.outerSize(); ++c)
+                for (int e = hessian_full.outerIndexPtr()[c]; e < hessian_full.outerIndexPtr()[c + 1]; ++e)
+                    for (StiffnessMatrix::InnerIterator pa(proj, hessian_full.innerIndexPtr()[e]); pa; ++pa)
+                        for (StiffnessMatrix::InnerIterator pb(proj, c); pb; ++pb)
+                        {
+                            const double *val = utils::find_in_pattern(hessian_projected_, pa.row(), pb.row());
+                            assert(val != nullptr);
+                            scatter.push_back({{int(val - hessian_projected_.valuePtr()), e}});
+                            weights.push_back(pa.value() * pb.value());
+                        }
+
+            std::vector<int> order(scatter.size());
+            for (int i = 0; i < order.size(); ++i)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&](int i, int j) { return scatter[i][0] < scatter[j][0]; });
+
+            projection_offsets_.assign(hessian_projected_.nonZeros() + 1, 0);
+            projection_entries_.resize(order.size());
+            projection_weights_.resize(order.size());
+            for (int i = 0; i < order.size(); ++i)
+            {
+                projection_offsets_[scatter[order[i]][0] + 1]++;
+                projection_entries_[i] = scatter[order[i]][1];
+                projection_weights_[i] = weights[order[i]];
+            }
+            for (int k = 0; k < hessian_projected_.nonZeros(); ++k)
+                projection_offsets_[k + 1] += projection_offsets_[k];
         }
 
-        return reduced_grad;
+        const double *full_values = hessian_full.valuePtr();
+        double *values = hessian_projected_.valuePtr();
+        utils::maybe_parallel_for(hessian_projected_.nonZeros(), [&](int start, int end, int thread_id) {
+            for (int k = start; k < end; ++k)
+            {
+                double val = 0;
+                for (int i = projection_offsets_[k]; i < projection_offsets_[k + 1]; ++i)
+                    val += projection_weights_[i] * full_values[projection_entries_[i]];
+                values[k] = val;
+            }
+        });
+
+        hessian = hessian_projected_;
     }
 
     void PeriodicContactForm::init(const Eigen::VectorXd &x)
@@ -119,8 +197,7 @@ namespace polyfem::solver
         StiffnessMatrix hessian_full;
         ContactForm::second_derivative_unweighted(single_to_tiled(x), hessian_full);
         
-        update_projection();
-        hessian = proj * hessian_full * proj.transpose();
+        project_hessian(hessian_full, hessian);
 
         // const Eigen::MatrixXd displaced = collision_mesh_.displace_vertices(utils::unflatten(single_to_tiled(x), collision_mesh_.dim()));
 
@@ -93,8 +93,22 @@ namespace polyfem::solver
     private:
 		void update_projection() const;
 
+		/// @brief Compute P H Pᵀ, only recomputing the pattern and the scatter when the pattern of H changes
+		/// @param hessian_full Hessian wrt the tiled dofs (H)
+		/// @param hessian Output Hessian wrt the periodic dofs
+		void project_hessian(StiffnessMatrix &hessian_full, StiffnessMatrix &hessian) const;
+
         const Eigen::VectorXi tiled_to_single_;
 		const int n_single_dof_;
 		mutable StiffnessMatrix proj;
+		mutable StiffnessMatrix proj_t_; ///< transpose of proj, to apply proj column by column
+		mutable Eigen::MatrixXd projection_rest_positions_; ///< rest positions proj was built with
+
+		// P H Pᵀ for the last tiled hessian pattern, each entry k is the sum over
+		// [offsets[k], offsets[k+1]) of weights[i] * H.valuePtr()[entries[i]]
+		mutable std::vector<int> hessian_full_outer_, hessian_full_inner_;
+		mutable StiffnessMatrix hessian_projected_;
+		mutable std::vector<int> projection_offsets_, projection_entries_;
+		mutable std::vector<double> projection_weights_;
     };
 }
\ No newline at end of file
@@ -59,6 +59,11 @@ namespace polyfem::solver
 		hessian = (stiffness() * time_integrator_.dv_dx()) * lagged_stiffness_matrix_;
 	}
 
+	bool RayleighDampingForm::add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, StiffnessMatrix &hessian) const
+	{
+		return utils::add_to_pattern(lagged_stiffness_matrix_, hessian, scale * stiffness() * time_integrator_.dv_dx());
+	}
+
 	void RayleighDampingForm::init_lagging(const Eigen::VectorXd &x)
 	{
 		update_lagging(x, 0);
@@ -27,6 +27,9 @@ namespace polyfem::solver
 
 		std::string name() const override { return "rayleigh-damping"; }
 
+		/// @brief The Hessian only changes with the lagged stiffness matrix
+		bool is_hessian_constant() const override { return true; }
+
 	protected:
 		/// @brief Compute the value of the form
 		/// @param x Current solution
@@ -43,6 +46,12 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Add scale times the second derivative to hessian without copying the lagged stiffness matrix
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the second derivative
+		/// @param[in,out] hessian Compressed matrix to add to
+		bool add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, StiffnessMatrix &hessian) const override;
+
 	public:
 		/// @brief Initialize lagged fields
 		/// @param x Current solution
@@ -60,6 +69,8 @@ namespace polyfem::solver
 		/// @return True if the form requires lagging
 		bool uses_lagging() const override { return true; }
 
+		std::vector<const Form *> dependencies() const override { return {&form_to_damp_}; }
+
 		/// @brief Get the stiffness of the form
 		double stiffness() const;
 
@@ -130,13 +130,13 @@ namespace polyfem::solver
 		max_stress.setZero(state_.bases.size());
 		utils::maybe_parallel_for(state_.bases.size(), [&](int start, int end, int thread_id) {
 			Eigen::MatrixXd local_vals;
-			assembler::ElementAssemblyValues vals;
+			assembler::ElementAssemblyValues tmp_vals;
 			for (int e = start; e < end; e++)
 			{
 				if (interested_ids_.size() != 0 && interested_ids_.find(state_.mesh->get_body_id(e)) == interested_ids_.end())
 					continue;
 
-				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], vals);
+				const assembler::ElementAssemblyValues &vals = state_.ass_vals_cache.get(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], tmp_vals);
 				// std::vector<assembler::Assembler::NamedMatrix> result;
 				// state_.assembler->compute_tensor_value(e, state_.bases[e], state_.geom_bases()[e], vals.quadrature.points, state_.diff_cached.u(time_step), result);
 				std::dynamic_pointer_cast<assembler::ElasticityAssembler>(state_.assembler)->compute_stress_tensor(assembler::OutputData(t, e, state_.bases[e], state_.geom_bases()[e], vals.quadrature.points, state_.diff_cached.u(time_step)), ElasticityTensorType::PK1, local_vals);
@@ -23,6 +23,26 @@ namespace polyfem::solver
 
 		double dot(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B) { return (A.array() * B.array()).sum(); }
 
+		// Same layout as utils::vector2matrix, but reads a row of grad_u in place
+		// and reuses the storage of mat across quadrature points.
+		template <typename Derived>
+		void grad_to_matrix(const Eigen::MatrixBase<Derived> &row, Eigen::MatrixXd &mat)
+		{
+			const int size = sqrt(row.size());
+			mat.resize(size, size);
+			for (int i = 0; i < size; i++)
+				for (int j = 0; j < size; j++)
+					mat(i, j) = row(i * size + j);
+		}
+
+		// Writes utils::flatten(mat) into row q of val without a temporary vector.
+		void flatten_to_row(const Eigen::MatrixXd &mat, const int q, Eigen::MatrixXd &val)
+		{
+			for (int i = 0; i < mat.rows(); i++)
+				for (int j = 0; j < mat.cols(); j++)
+					val(q, i * mat.cols() + j) = mat(i, j);
+		}
+
 		class LocalThreadScalarStorage
 		{
 		public:
@@ -54,7 +74,24 @@ namespace polyfem::solver
 	double SpatialIntegralForm::value_unweighted_step(const int time_step, const Eigen::VectorXd &x) const
 	{
 		assert(time_step < state_.diff_cached.size());
-		return AdjointTools::integrate_objective(state_, get_integral_functional(), state_.diff_cached.u(time_step), ids_, spatial_integral_type_, time_step);
+
+		if (!value_cache_enabled_)
+			return AdjointTools::integrate_objective(state_, get_integral_functional(), state_.diff_cached.u(time_step), ids_, spatial_integral_type_, time_step);
+
+		if (value_cache_version_ != state_.diff_cached.version() || value_cache_x_.size() != x.size() || value_cache_x_ != x)
+		{
+			value_cache_.clear();
+			value_cache_x_ = x;
+			value_cache_version_ = state_.diff_cached.version();
+		}
+
+		const auto it = value_cache_.find(time_step);
+		if (it != value_cache_.end())
+			return it->second;
+
+		const double val = AdjointTools::integrate_objective(state_, get_integral_functional(), state_.diff_cached.u(time_step), ids_, spatial_integral_type_, time_step);
+		value_cache_[time_step] = val;
+		return val;
 	}
 
 	void SpatialIntegralForm::compute_partial_gradient_step(const int time_step, const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
@@ -101,10 +138,10 @@ namespace polyfem::solver
 		j.set_j([formulation, this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
 			val.setZero(grad_u.rows(), 1);
 			const int dim = u.cols();
-			Eigen::MatrixXd grad_u_q;
+			Eigen::MatrixXd grad_u_q, def_grad;
 			for (int q = 0; q < grad_u.rows(); q++)
 			{
-				grad_u_q = utils::unflatten(grad_u.row(q), u.cols());
+				grad_to_matrix(grad_u.row(q), grad_u_q);
 				if (formulation == "LinearElasticity")
 				{
 					grad_u_q = (grad_u_q + grad_u_q.transpose()).eval() / 2.;
@@ -112,7 +149,7 @@ namespace polyfem::solver
 				}
 				else if (formulation == "NeoHookean")
 				{
-					Eigen::MatrixXd def_grad = grad_u_q + Eigen::MatrixXd::Identity(dim, dim);
+					def_grad = grad_u_q + Eigen::MatrixXd::Identity(dim, dim);
 					double log_det_j = log(def_grad.determinant());
 					val(q) = mu(q) / 2 * ((def_grad.transpose() * def_grad).trace() - dim - 2 * log_det_j) + lambda(q) / 2 * log_det_j * log_det_j;
 				}
@@ -126,7 +163,7 @@ namespace polyfem::solver
 			Eigen::MatrixXd grad_u_q, def_grad, FmT, stress;
 			for (int q = 0; q < grad_u.rows(); q++)
 			{
-				grad_u_q = utils::unflatten(grad_u.row(q), u.cols());
+				grad_to_matrix(grad_u.row(q), grad_u_q);
 				if (formulation == "LinearElasticity")
 				{
 					stress = mu(q) * (grad_u_q + grad_u_q.transpose()) + lambda(q) * grad_u_q.trace() * Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols());
@@ -139,7 +176,7 @@ namespace polyfem::solver
 				}
 				else
 					log_and_throw_adjoint_error("[{}] Unknown formulation {}!", name(), formulation);
-				val.row(q) = utils::flatten(stress);
+				flatten_to_row(stress, q, val);
 			}
 		});
 
@@ -166,15 +203,16 @@ namespace polyfem::solver
 			val.setZero(grad_u.rows(), 1);
 			const double dt = state.problem->is_time_dependent() ? state.args["time"]["dt"].get<double>() : 0;
 
-			Eigen::MatrixXd grad_u_q, stress, grad_unused;
+			Eigen::MatrixXd grad_u_q, stress, grad_unused, zero;
 			for (int q = 0; q < grad_u.rows(); q++)
 			{
 				if (formulation == "Laplacian")
 					stress = grad_u.row(q);
 				else
 				{
-					vector2matrix(grad_u.row(q), grad_u_q);
-					state.assembler->compute_stress_grad_multiply_mat(OptAssemblerData(params.t, dt, params.elem, local_pts.row(q), pts.row(q), grad_u_q), Eigen::MatrixXd::Zero(grad_u_q.rows(), grad_u_q.cols()), stress, grad_unused);
+					grad_to_matrix(grad_u.row(q), grad_u_q);
+					zero.setZero(grad_u_q.rows(), grad_u_q.cols());
+					state.assembler->compute_stress_grad_multiply_mat(OptAssemblerData(params.t, dt, params.elem, local_pts.row(q), pts.row(q), grad_u_q), zero, stress, grad_unused);
 				}
 				val(q) = pow(stress.squaredNorm(), power / 2.);
 			}
@@ -198,11 +236,12 @@ namespace polyfem::solver
 				Eigen::MatrixXd grad_u_q, stress, stress_dstress;
 				for (int q = 0; q < grad_u.rows(); q++)
 				{
-					vector2matrix(grad_u.row(q), grad_u_q);
+					grad_to_matrix(grad_u.row(q), grad_u_q);
 					state.assembler->compute_stress_grad_multiply_stress(OptAssemblerData(params.t, dt, params.elem, local_pts.row(q), pts.row(q), grad_u_q), stress, stress_dstress);
 
 					const double coef = power * pow(stress.squaredNorm(), power / 2. - 1.);
-					val.row(q) = coef * utils::flatten(stress_dstress);
+					stress_dstress *= coef;
+					flatten_to_row(stress_dstress, q, val);
 				}
 			}
 		});
@@ -232,7 +271,7 @@ namespace polyfem::solver
 			Eigen::MatrixXd grad_u_q, stress;
 			for (int q = 0; q < grad_u.rows(); q++)
 			{
-				vector2matrix(grad_u.row(q), grad_u_q);
+				grad_to_matrix(grad_u.row(q), grad_u_q);
 				stress = mu(q) * (grad_u_q + grad_u_q.transpose()) + lambda(q) * grad_u_q.trace() * Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols());
 				val(q) = (stress.array() * grad_u_q.array()).sum();
 			}
@@ -245,9 +284,10 @@ namespace polyfem::solver
 			Eigen::MatrixXd grad_u_q, stress;
 			for (int q = 0; q < grad_u.rows(); q++)
 			{
-				vector2matrix(grad_u.row(q), grad_u_q);
+				grad_to_matrix(grad_u.row(q), grad_u_q);
 				stress = mu(q) * (grad_u_q + grad_u_q.transpose()) + lambda(q) * grad_u_q.trace() * Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols());
-				val.row(q) = 2 * utils::flatten(stress);
+				stress *= 2;
+				flatten_to_row(stress, q, val);
 			}
 		});
 
@@ -265,27 +305,22 @@ namespace polyfem::solver
 			Eigen::VectorXd term = Eigen::VectorXd::Zero(bases.size() * 2);
 			const int dim = state_.mesh->dimension();
 
+			assembler::ElementAssemblyValues tmp_vals;
+			Eigen::VectorXd da;
+			Eigen::MatrixXd u, grad_u, grad_u_q, f_prime_dmu, f_prime_dlambda;
 			for (int e = 0; e < bases.size(); e++)
 			{
-				assembler::ElementAssemblyValues vals;
-				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), bases[e], state_.geom_bases()[e], vals);
+				const assembler::ElementAssemblyValues &vals = state_.ass_vals_cache.get(e, state_.mesh->is_volume(), bases[e], state_.geom_bases()[e], tmp_vals);
 
 				const quadrature::Quadrature &quadrature = vals.quadrature;
-				Eigen::VectorXd da = vals.det.array() * quadrature.weights.array();
+				da = vals.det.array() * quadrature.weights.array();
 
-				Eigen::MatrixXd u, grad_u;
 				io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, state_.diff_cached.u(time_step), u, grad_u);
 
-				Eigen::MatrixXd grad_u_q;
 				for (int q = 0; q < quadrature.weights.size(); q++)
 				{
-					double lambda, mu;
-					lambda = state_.assembler->parameters().at("lambda")(quadrature.points.row(q), vals.val.row(q), t, e);
-					mu = state_.assembler->parameters().at("mu")(quadrature.points.row(q), vals.val.row(q), t, e);
-
-					vector2matrix(grad_u.row(q), grad_u_q);
+					grad_to_matrix(grad_u.row(q), grad_u_q);
 
-					Eigen::MatrixXd f_prime_dmu, f_prime_dlambda;
 					state_.assembler->compute_dstress_dmu_dlambda(OptAssemblerData(t, dt, e, quadrature.points.row(q), vals.val.row(q), grad_u_q), f_prime_dmu, f_prime_dlambda);
 
 					term(e + bases.size()) += dot(f_prime_dmu, grad_u_q) * da(q);
@@ -382,18 +417,18 @@ namespace polyfem::solver
 		j.set_j([formulation, dimensions, this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
 			val.setZero(grad_u.rows(), 1);
 
-			Eigen::MatrixXd grad_u_q, stress;
+			Eigen::MatrixXd grad_u_q, def_grad, FmT, stress;
 			for (int q = 0; q < grad_u.rows(); q++)
 			{
-				vector2matrix(grad_u.row(q), grad_u_q);
+				grad_to_matrix(grad_u.row(q), grad_u_q);
 				if (formulation == "LinearElasticity")
 				{
 					stress = mu(q) * (grad_u_q + grad_u_q.transpose()) + lambda(q) * grad_u_q.trace() * Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols());
 				}
 				else if (formulation == "NeoHookean")
 				{
-					Eigen::MatrixXd def_grad = Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols()) + grad_u_q;
-					Eigen::MatrixXd FmT = def_grad.inverse().transpose();
+					def_grad = Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols()) + grad_u_q;
+					FmT = def_grad.inverse().transpose();
 					stress = mu(q) * (def_grad - FmT) + lambda(q) * std::log(def_grad.determinant()) * FmT;
 				}
 				else
@@ -406,11 +441,11 @@ namespace polyfem::solver
 			val.setZero(grad_u.rows(), grad_u.cols());
 
 			const int dim = state_.mesh->dimension();
-			Eigen::MatrixXd grad_u_q, stiffness, stress;
+			Eigen::MatrixXd grad_u_q, def_grad, FmT, stiffness, stress;
 			for (int q = 0; q < grad_u.rows(); q++)
 			{
 				stiffness.setZero(1, dim * dim * dim * dim);
-				vector2matrix(grad_u.row(q), grad_u_q);
+				grad_to_matrix(grad_u.row(q), grad_u_q);
 
 				if (formulation == "LinearElasticity")
 				{
@@ -425,10 +460,9 @@ namespace polyfem::solver
 				}
 				else if (formulation == "NeoHookean")
 				{
-					Eigen::MatrixXd def_grad = Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols()) + grad_u_q;
-					Eigen::MatrixXd FmT = def_grad.inverse().transpose();
+					def_grad = Eigen::MatrixXd::Identity(grad_u_q.rows(), grad_u_q.cols()) + grad_u_q;
+					FmT = def_grad.inverse().transpose();
 					stress = mu(q) * (def_grad - FmT) + lambda(q) * std::log(def_grad.determinant()) * FmT;
-					Eigen::VectorXd FmT_vec = utils::flatten(FmT);
 					double J = def_grad.determinant();
 					double tmp1 = mu(q) - lambda(q) * std::log(J);
 					for (int i = 0, idx = 0; i < dim; i++)
@@ -436,9 +470,8 @@ namespace polyfem::solver
 							for (int k = 0; k < dim; k++)
 								for (int l = 0; l < dim; l++)
 								{
-									stiffness(idx++) = mu(q) * delta(i, k) * delta(j, l) + tmp1 * FmT(i, l) * FmT(k, j);
+									stiffness(idx++) = mu(q) * delta(i, k) * delta(j, l) + tmp1 * FmT(i, l) * FmT(k, j) + lambda(q) * FmT(i, j) * FmT(k, l);
 								}
-					stiffness += lambda(q) * utils::flatten(FmT_vec * FmT_vec.transpose()).transpose();
 				}
 				else
 					log_and_throw_adjoint_error("[{}] Unknown formulation {}!", name(), formulation);
@@ -27,6 +27,15 @@ namespace polyfem::solver
 		const State &state_;
 		SpatialIntegralType spatial_integral_type_;
 		std::set<int> ids_;
+		/// disable for integrands depending on quantities not tracked by the cache (e.g. another state's solution)
+		bool value_cache_enabled_ = true;
+
+	private:
+		// values of the integral per time step, valid for value_cache_x_ and value_cache_version_ (of the state's DiffCache)
+		// composite forms and target forms often evaluate the same sub-form several times per evaluation
+		mutable std::map<int, double> value_cache_;
+		mutable Eigen::VectorXd value_cache_x_;
+		mutable size_t value_cache_version_ = 0;
 	};
 
 	class ElasticEnergyForm : public SpatialIntegralForm
@@ -135,6 +135,7 @@ namespace polyfem::solver
 	void TargetForm::set_reference(const std::shared_ptr<const State> &target_state, const std::set<int> &reference_cached_body_ids)
 	{
 		target_state_ = target_state;
+		value_cache_enabled_ = false; // the value depends on the target state's solution
 
 		std::map<int, std::vector<int>> ref_interested_body_id_to_e;
 		int ref_count = 0;
@@ -302,6 +303,15 @@ namespace polyfem::solver
 		interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
 	}
 
+	void SDFTargetForm::precompute_grid()
+	{
+		const Eigen::VectorXd min = point_sampling.colwise().minCoeff();
+		const Eigen::VectorXd max = point_sampling.colwise().maxCoeff();
+		const double margin = std::max(0.1 * (max - min).norm(), 4 * delta_);
+
+		interpolation_fn->precompute_grid([this](const Eigen::MatrixXd &point, double &distance) { compute_distance(point, distance); }, (min.array() - margin).matrix(), (max.array() + margin).matrix());
+	}
+
 	void SDFTargetForm::compute_distance(const Eigen::MatrixXd &point, double &distance) const
 	{
 		distance = DBL_MAX;
@@ -345,27 +355,17 @@ namespace polyfem::solver
 	{
 		IntegrableFunctional j;
 		auto j_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), 1);
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd unused_grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, unused_grad);
-				val(q) = pow(distance, 2);
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd unused_grad;
+			interpolation_fn->evaluate(u + pts, distance, unused_grad);
+			val = distance.array().square().matrix();
 		};
 
 		auto djdu_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), u.cols());
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, grad);
-				val.row(q) = 2 * distance * grad.transpose();
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd grad;
+			interpolation_fn->evaluate(u + pts, distance, grad);
+			val = 2 * distance.asDiagonal() * grad;
 		};
 
 		j.set_j(j_func);
@@ -389,6 +389,20 @@ namespace polyfem::solver
 		interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
 	}
 
+	void MeshTargetForm::precompute_grid()
+	{
+		const Eigen::VectorXd min = V_.colwise().minCoeff();
+		const Eigen::VectorXd max = V_.colwise().maxCoeff();
+		const double margin = std::max(0.1 * (max - min).norm(), 4 * delta_);
+
+		interpolation_fn->precompute_grid([this](const Eigen::MatrixXd &point, double &distance) {
+			int idx;
+			Eigen::Matrix<double, 1, 3> closest;
+			distance = pow(tree_.squared_distance(V_, F_, point.col(0), idx, closest), 0.5);
+		},
+										  (min.array() - margin).matrix(), (max.array() + margin).matrix());
+	}
+
 	void MeshTargetForm::solution_changed_step(const int time_step, const Eigen::VectorXd &x)
 	{
 		const auto &bases = state_.bases;
@@ -440,27 +454,17 @@ namespace polyfem::solver
 	{
 		IntegrableFunctional j;
 		auto j_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), 1);
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd unused_grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, unused_grad);
-				val(q) = pow(distance, 2);
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd unused_grad;
+			interpolation_fn->evaluate(u + pts, distance, unused_grad);
+			val = distance.array().square().matrix();
 		};
 
 		auto djdu_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), u.cols());
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, grad);
-				val.row(q) = 2 * distance * grad.transpose();
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd grad;
+			interpolation_fn->evaluate(u + pts, distance, grad);
+			val = 2 * distance.asDiagonal() * grad;
 		};
 
 		j.set_j(j_func);
@@ -57,6 +57,8 @@ namespace polyfem::solver
 		void solution_changed_step(const int time_step, const Eigen::VectorXd &new_x) override;
 		void set_bspline_target(const Eigen::MatrixXd &control_points, const Eigen::VectorXd &knots, const double delta);
 		void set_bspline_target(const Eigen::MatrixXd &control_points, const Eigen::VectorXd &knots_u, const Eigen::VectorXd &knots_v, const double delta);
+		/// Tabulates the distance around the target instead of filling the grid lazily
+		void precompute_grid();
 
 	protected:
 		IntegrableFunctional get_integral_functional() const override;
@@ -89,6 +91,8 @@ namespace polyfem::solver
 
 		void solution_changed_step(const int time_step, const Eigen::VectorXd &new_x) override;
 		void set_surface_mesh_target(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const double delta);
+		/// Tabulates the distance around the target instead of filling the grid lazily
+		void precompute_grid();
 
 	protected:
 		IntegrableFunctional get_integral_functional() const override;
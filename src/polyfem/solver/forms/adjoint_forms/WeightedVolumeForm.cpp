@@ -8,10 +8,10 @@ namespace polyfem::solver
 		assert(x.size() == state_.mesh->n_elements());
 
 		double val = 0;
-		assembler::ElementAssemblyValues vals;
+		assembler::ElementAssemblyValues tmp_vals;
 		for (int e = 0; e < state_.bases.size(); e++)
 		{
-			state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], vals);
+			const assembler::ElementAssemblyValues &vals = state_.ass_vals_cache.get(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], tmp_vals);
 			val += (vals.det.array() * vals.quadrature.weights.array()).sum() * x(e);
 		}
 		return val;
@@ -22,10 +22,10 @@ namespace polyfem::solver
 		assert(x.size() == state_.mesh->n_elements());
 
 		gradv.setZero(x.size());
-		assembler::ElementAssemblyValues vals;
+		assembler::ElementAssemblyValues tmp_vals;
 		for (int e = 0; e < state_.bases.size(); e++)
 		{
-			state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], vals);
+			const assembler::ElementAssemblyValues &vals = state_.ass_vals_cache.get(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], tmp_vals);
 			gradv(e) = (vals.det.array() * vals.quadrature.weights.array()).sum();
 		}
 		gradv *= weight();
@@ -9,6 +9,31 @@ namespace polyfem::solver
 		return Eigen::VectorXd();
 	}
 
+	Eigen::SparseMatrix<double> Parametrization::jacobian(const int x_size) const
+	{
+		if (!is_linear())
+			log_and_throw_adjoint_error("Jacobian is only constant for linear parametrizations!");
+
+		const int y_size = size(x_size);
+		const Eigen::VectorXd x = Eigen::VectorXd::Zero(x_size);
+		Eigen::VectorXd e = Eigen::VectorXd::Zero(y_size);
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (int i = 0; i < y_size; i++)
+		{
+			e(i) = 1;
+			const Eigen::VectorXd row = apply_jacobian(e, x);
+			e(i) = 0;
+			for (int j = 0; j < row.size(); j++)
+				if (row(j) != 0)
+					triplets.emplace_back(i, j, row(j));
+		}
+
+		Eigen::SparseMatrix<double> jac(y_size, x_size);
+		jac.setFromTriplets(triplets.begin(), triplets.end());
+		return jac;
+	}
+
 	int CompositeParametrization::size(const int x_size) const
 	{
 		int cur_size = x_size;
@@ -61,8 +86,65 @@ namespace polyfem::solver
 		}
 
 		for (int i = parametrizations_.size() - 1; i >= 0; --i)
-			gradv = parametrizations_[i]->apply_jacobian(gradv, ys[i]);
+		{
+			// Fuse the maximal run of linear maps ending at i into one sparse product
+			int begin = i;
+			if (parametrizations_[i]->is_linear())
+				while (begin > 0 && parametrizations_[begin - 1]->is_linear())
+					--begin;
+
+			if (begin < i)
+			{
+				gradv = fused_jacobian(begin, i + 1, ys[begin].size()).transpose() * gradv;
+				i = begin;
+			}
+			else
+				gradv = parametrizations_[i]->apply_jacobian(gradv, ys[i]);
+		}
 
 		return gradv;
 	}
+
+	bool CompositeParametrization::is_linear() const
+	{
+		for (const auto &p : parametrizations_)
+			if (!p->is_linear())
+				return false;
+		return true;
+	}
+
+	Eigen::SparseMatrix<double> CompositeParametrization::jacobian(const int x_size) const
+	{
+		if (parametrizations_.empty())
+		{
+			Eigen::SparseMatrix<double> identity(x_size, x_size);
+			identity.setIdentity();
+			return identity;
+		}
+		if (!is_linear())
+			log_and_throw_adjoint_error("Jacobian is only constant for linear parametrizations!");
+
+		return fused_jacobian(0, parametrizations_.size(), x_size);
+	}
+
+	const Eigen::SparseMatrix<double> &CompositeParametrization::fused_jacobian(const int begin, const int end, const int x_size) const
+	{
+		std::lock_guard<std::mutex> lock(fused_jacobians_->mutex);
+		for (const auto &entry : fused_jacobians_->entries)
+			if (entry.begin == begin && entry.end == end && entry.x_size == x_size)
+				return entry.jac;
+
+		int cur_size = x_size;
+		Eigen::SparseMatrix<double> jac = parametrizations_[begin]->jacobian(cur_size);
+		cur_size = parametrizations_[begin]->size(cur_size);
+		for (int i = begin + 1; i < end; i++)
+		{
+			jac = (parametrizations_[i]->jacobian(cur_size) * jac).pruned();
+			cur_size = parametrizations_[i]->size(cur_size);
+		}
+
+		logger().debug("Fused the jacobians of parametrizations [{}, {}) into a {}x{} matrix with {} non-zeros", begin, end, jac.rows(), jac.cols(), jac.nonZeros());
+		fused_jacobians_->entries.push_back({begin, end, x_size, std::move(jac)});
+		return fused_jacobians_->entries.back().jac;
+	}
 } // namespace polyfem::solver
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <Eigen/Core>
+#include <Eigen/Sparse>
 
 namespace polyfem::solver
 {
@@ -21,6 +24,12 @@ namespace polyfem::solver
 		virtual int size(const int x_size) const = 0; // just for verification
 		virtual Eigen::VectorXd eval(const Eigen::VectorXd &x) const = 0;
 		virtual Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const = 0;
+
+		/// True if the jacobian does not depend on x (the map is affine), so it can be assembled once
+		virtual bool is_linear() const { return false; }
+		/// Constant jacobian dy/dx of size size(x_size) x x_size, only valid if is_linear().
+		/// The default assembles it row by row from apply_jacobian.
+		virtual Eigen::SparseMatrix<double> jacobian(const int x_size) const;
 	};
 
 	class CompositeParametrization : public Parametrization
@@ -36,7 +45,26 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const override;
 
+		bool is_linear() const override;
+		Eigen::SparseMatrix<double> jacobian(const int x_size) const override;
+
 	private:
+		/// Product of the jacobians of parametrizations_[begin, end), which must all be linear
+		const Eigen::SparseMatrix<double> &fused_jacobian(const int begin, const int end, const int x_size) const;
+
 		const std::vector<std::shared_ptr<Parametrization>> parametrizations_;
+
+		// Shared between copies, like the parametrizations themselves
+		struct FusedJacobians
+		{
+			struct Entry
+			{
+				int begin, end, x_size;
+				Eigen::SparseMatrix<double> jac;
+			};
+			std::deque<Entry> entries; // references stay valid on push_back
+			std::mutex mutex;
+		};
+		std::shared_ptr<FusedJacobians> fused_jacobians_ = std::make_shared<FusedJacobians>();
 	};
 } // namespace polyfem::solver
\ No newline at end of file
@@ -97,6 +97,19 @@ namespace polyfem::solver
 			return scale_ * grad.array();
 	}
 
+	Eigen::SparseMatrix<double> Scaling::jacobian(const int x_size) const
+	{
+		Eigen::VectorXd diag = Eigen::VectorXd::Ones(x_size);
+		if (from_ >= 0)
+			diag.segment(from_, to_ - from_).setConstant(scale_);
+		else
+			diag.setConstant(scale_);
+
+		Eigen::SparseMatrix<double> jac(x_size, x_size);
+		jac = diag.asDiagonal();
+		return jac;
+	}
+
 	Eigen::VectorXd PowerMap::inverse_eval(const Eigen::VectorXd &y)
 	{
 		if (from_ >= 0)
@@ -262,6 +275,20 @@ namespace polyfem::solver
 		return grad_body;
 	}
 
+	Eigen::SparseMatrix<double> PerBody2PerNode::jacobian(const int x_size) const
+	{
+		const int dim = x_size / reduced_size_;
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (int i = 0; i < full_size_; i++)
+			for (int d = 0; d < dim; d++)
+				triplets.emplace_back(i * dim + d, node_id_to_body_id_(i) * dim + d, 1.);
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(triplets.begin(), triplets.end());
+		return jac;
+	}
+
 	PerBody2PerElem::PerBody2PerElem(const mesh::Mesh &mesh) : mesh_(mesh), full_size_(mesh_.n_elements())
 	{
 		reduced_size_ = 0;
@@ -316,6 +343,23 @@ namespace polyfem::solver
 		return grad_body;
 	}
 
+	Eigen::SparseMatrix<double> PerBody2PerElem::jacobian(const int x_size) const
+	{
+		const int n_fields = x_size / reduced_size_;
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (int e = 0; e < mesh_.n_elements(); e++)
+		{
+			const auto &entry = body_id_map_.at(mesh_.get_body_id(e));
+			for (int k = 0; k < n_fields; k++)
+				triplets.emplace_back(e + k * full_size_, entry[1] + k * reduced_size_, 1.);
+		}
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(triplets.begin(), triplets.end());
+		return jac;
+	}
+
 	SliceMap::SliceMap(const int from, const int to, const int total) : from_(from), to_(to), total_(total)
 	{
 		if (to_ - from_ < 0)
@@ -349,6 +393,17 @@ namespace polyfem::solver
 		return grad_full;
 	}
 
+	Eigen::SparseMatrix<double> SliceMap::jacobian(const int x_size) const
+	{
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (int i = from_; i < to_; i++)
+			triplets.emplace_back(i - from_, i, 1.);
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(triplets.begin(), triplets.end());
+		return jac;
+	}
+
 	InsertConstantMap::InsertConstantMap(const int size, const double val, const int start_index) : start_index_(start_index)
 	{
 		if (size <= 0)
@@ -411,6 +466,17 @@ namespace polyfem::solver
 		return reduced_grad;
 	}
 
+	Eigen::SparseMatrix<double> InsertConstantMap::jacobian(const int x_size) const
+	{
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (int i = 0; i < x_size; i++)
+			triplets.emplace_back((start_index_ >= 0 && i >= start_index_) ? i + values_.size() : i, i, 1.);
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(triplets.begin(), triplets.end());
+		return jac;
+	}
+
 	LinearFilter::LinearFilter(const mesh::Mesh &mesh, const double radius)
 	{
 		std::vector<Eigen::Triplet<double>> tt_adjacency_list;
@@ -457,7 +523,13 @@ namespace polyfem::solver
 	Eigen::VectorXd LinearFilter::apply_jacobian(const Eigen::VectorXd &grad, const Eigen::VectorXd &x) const
 	{
 		assert(x.size() == tt_radius_adjacency.rows());
-		return (tt_radius_adjacency * grad).array() / tt_radius_adjacency_row_sum.array();
+		return tt_radius_adjacency.transpose() * (grad.array() / tt_radius_adjacency_row_sum.array()).matrix();
+	}
+
+	Eigen::SparseMatrix<double> LinearFilter::jacobian(const int x_size) const
+	{
+		assert(x_size == tt_radius_adjacency.rows());
+		return tt_radius_adjacency_row_sum.cwiseInverse().asDiagonal() * tt_radius_adjacency;
 	}
 
 	Eigen::VectorXd ScalarVelocityParametrization::inverse_eval(const Eigen::VectorXd &y)
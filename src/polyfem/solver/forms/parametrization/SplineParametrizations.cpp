@@ -2,6 +2,8 @@
 #include <polyfem/utils/BSplineParametrization.hpp>
 #include <polyfem/State.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/HashUtils.hpp>
 #include <igl/bbw.h>
 #include <igl/boundary_conditions.h>
 // #include <igl/normalize_row_sums.h>
@@ -14,6 +16,9 @@
 
 #include <unsupported/Eigen/SparseExtra>
 
+#include <h5pp/h5pp.h>
+
+#include <filesystem>
 #include <unordered_map>
 
 namespace polyfem::solver
@@ -135,6 +140,18 @@ namespace polyfem::solver
 			return grad;
 	}
 
+	Eigen::SparseMatrix<double> BSplineParametrization1DTo2D::jacobian(const int x_size) const
+	{
+		if (!invoked_inverse_eval_)
+			log_and_throw_error("Must call inverse eval on this parametrization first!");
+		Eigen::SparseMatrix<double> jac;
+		spline_->jacobian_wrt_params(jac);
+		if (exclude_ends_)
+			return jac.middleCols(2, (initial_control_points_.rows() - 2) * 2);
+		else
+			return jac;
+	}
+
 	Eigen::VectorXd BSplineParametrization2DTo3D::inverse_eval(const Eigen::VectorXd &y)
 	{
 		spline_ = std::make_shared<BSplineParametrization3D>(initial_control_point_grid_, knots_u_, knots_v_, y);
@@ -154,8 +171,8 @@ namespace polyfem::solver
 		return Eigen::VectorXd();
 	}
 
-	BoundedBiharmonicWeights2Dto3D::BoundedBiharmonicWeights2Dto3D(const int num_control_vertices, const int num_vertices, const State &state, const bool allow_rotations)
-		: num_control_vertices_(num_control_vertices), num_vertices_(num_vertices), allow_rotations_(allow_rotations)
+	BoundedBiharmonicWeights2Dto3D::BoundedBiharmonicWeights2Dto3D(const int num_control_vertices, const int num_vertices, const State &state, const bool allow_rotations, const std::string &weights_cache)
+		: num_control_vertices_(num_control_vertices), num_vertices_(num_vertices), weights_cache_(weights_cache), allow_rotations_(allow_rotations)
 	{
 		Eigen::MatrixXd V;
 		state.get_vertices(V);
@@ -237,7 +254,25 @@ namespace polyfem::solver
 	{
 		y_start = y;
 
-		Eigen::MatrixXd V = utils::unflatten(y, 3);
+		// the weights only depend on the surface and the number of control points
+		size_t key = utils::HashMatrix()(y);
+		key ^= utils::HashMatrix()(F_surface_) + 0x9e3779b9 + (key << 6) + (key >> 2);
+		key ^= std::hash<int>()(num_control_vertices_) + 0x9e3779b9 + (key << 6) + (key >> 2);
+		if (weights_cache_.empty() || !load_weights(key))
+		{
+			compute_weights();
+			if (!weights_cache_.empty())
+				save_weights(key);
+		}
+
+		invoked_inverse_eval_ = true;
+
+		return Eigen::VectorXd::Zero(num_control_vertices_ * (allow_rotations_ ? 6 : 3));
+	}
+
+	void BoundedBiharmonicWeights2Dto3D::compute_weights()
+	{
+		Eigen::MatrixXd V = utils::unflatten(y_start, 3);
 		Eigen::MatrixXi F;
 		compute_faces_for_partial_vertices(V, F);
 
@@ -313,64 +348,130 @@ namespace polyfem::solver
 			log_and_throw_error("Bounded Bihamonic Weight computation failed!");
 		// Deprecated: igl::normalize_row_sums(complete_bbw_weights, complete_bbw_weights);
 		complete_bbw_weights = (complete_bbw_weights.array().colwise() / complete_bbw_weights.array().rowwise().sum()).eval();
-		bbw_weights_ = complete_bbw_weights.block(0, 0, V.rows(), num_control_vertices_).matrix();
-		boundary_bbw_weights_ = complete_bbw_weights.block(0, num_control_vertices_, V.rows(), V_outer_loop.rows()).matrix();
+		// the weights are in [0, 1], the negligible ones are dropped so that the evaluations are sparse products
+		bbw_weights_ = complete_bbw_weights.leftCols(num_control_vertices_).sparseView(1, 1e-8);
+		const Eigen::MatrixXd boundary_bbw_weights = complete_bbw_weights.rightCols(V_outer_loop.rows());
+		boundary_bbw_weights_ = boundary_bbw_weights.rowwise().sum();
 
 		igl::writeOBJ("surface_mesh.obj", V, F);
-		Eigen::saveMarket(bbw_weights_.sparseView(0, 1e-8).eval(), "bbw_control_weights.mat");
-		Eigen::saveMarket(boundary_bbw_weights_.sparseView(0, 1e-8).eval(), "bbw_boundary_weights.mat");
+		Eigen::saveMarket(Eigen::SparseMatrix<double>(bbw_weights_), "bbw_control_weights.mat");
+		Eigen::saveMarket(boundary_bbw_weights.sparseView(0, 1e-8).eval(), "bbw_boundary_weights.mat");
+	}
 
-		invoked_inverse_eval_ = true;
+	bool BoundedBiharmonicWeights2Dto3D::load_weights(const size_t key)
+	{
+		if (!std::filesystem::exists(weights_cache_))
+			return false;
+
+		h5pp::File file(weights_cache_, h5pp::FileAccess::READONLY);
+		if (!file.linkExists("control_points") || file.readAttribute<unsigned long long>("control_points", "key") != key)
+			return false;
+
+		control_points_ = file.readDataset<Eigen::MatrixXd>("control_points");
+		boundary_bbw_weights_ = file.readDataset<Eigen::VectorXd>("boundary_bbw_weights");
+		const Eigen::VectorXd values = file.readDataset<Eigen::VectorXd>("bbw_weights/values");
+		const Eigen::VectorXi rows = file.readDataset<Eigen::VectorXi>("bbw_weights/rows");
+		const Eigen::VectorXi cols = file.readDataset<Eigen::VectorXi>("bbw_weights/cols");
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		triplets.reserve(values.size());
+		for (int i = 0; i < values.size(); ++i)
+			triplets.emplace_back(rows[i], cols[i], values[i]);
+		bbw_weights_.resize(y_start.size() / 3, num_control_vertices_);
+		bbw_weights_.setFromTriplets(triplets.begin(), triplets.end());
+
+		logger().info("Loaded the bounded biharmonic weights from {}", weights_cache_);
+		return true;
+	}
 
-		return Eigen::VectorXd::Zero(num_control_vertices_ * (allow_rotations_ ? 6 : 3));
+	void BoundedBiharmonicWeights2Dto3D::save_weights(const size_t key) const
+	{
+		Eigen::VectorXd values(bbw_weights_.nonZeros());
+		Eigen::VectorXi rows(bbw_weights_.nonZeros()), cols(bbw_weights_.nonZeros());
+		int k = 0;
+		for (int i = 0; i < bbw_weights_.outerSize(); ++i)
+		{
+			for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(bbw_weights_, i); it; ++it, ++k)
+			{
+				values[k] = it.value();
+				rows[k] = it.row();
+				cols[k] = it.col();
+			}
+		}
+
+		h5pp::File file(weights_cache_, h5pp::FileAccess::REPLACE);
+		file.writeDataset(control_points_, "control_points");
+		file.writeDataset(boundary_bbw_weights_, "boundary_bbw_weights");
+		file.writeDataset(values, "bbw_weights/values");
+		file.writeDataset(rows, "bbw_weights/rows");
+		file.writeDataset(cols, "bbw_weights/cols");
+		file.writeAttribute((unsigned long long)key, "control_points", "key");
 	}
 
 	Eigen::VectorXd BoundedBiharmonicWeights2Dto3D::eval(const Eigen::VectorXd &x) const
 	{
 		if (!invoked_inverse_eval_)
 			log_and_throw_error("Must call inverse eval on this parametrization first!");
-		Eigen::VectorXd y = Eigen::VectorXd::Zero(y_start.size());
-		if (allow_rotations_)
-		{
-			for (int j = 0; j < bbw_weights_.cols(); ++j)
+		Eigen::VectorXd y(y_start.size());
+		utils::maybe_parallel_for(bbw_weights_.rows(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				Eigen::Matrix<double, 6, 1> affine_params = x.segment(j * 6, 6);
-				for (int i = 0; i < bbw_weights_.rows(); ++i)
-					y.segment(i * 3, 3) += bbw_weights_(i, j) * affine_transformation(control_points_.row(j), y_start.segment(i * 3, 3), affine_params);
+				const Eigen::Matrix<double, 3, 1> point = y_start.segment<3>(i * 3);
+				Eigen::Matrix<double, 3, 1> val = boundary_bbw_weights_(i) * point;
+				for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(bbw_weights_, i); it; ++it)
+				{
+					const int j = it.col();
+					if (allow_rotations_)
+						val += it.value() * affine_transformation(control_points_.row(j), point, x.segment<6>(j * 6));
+					else
+						val += it.value() * (point + x.segment<3>(j * 3));
+				}
+				y.segment<3>(i * 3) = val;
 			}
-		}
-		else
-		{
-			for (int j = 0; j < bbw_weights_.cols(); ++j)
-				for (int i = 0; i < bbw_weights_.rows(); ++i)
-					y.segment(i * 3, 3) += bbw_weights_(i, j) * (y_start.segment(i * 3, 3) + x.segment(j * 3, 3));
-		}
-
-		for (int j = 0; j < boundary_bbw_weights_.cols(); ++j)
-			for (int i = 0; i < boundary_bbw_weights_.rows(); ++i)
-				y.segment(i * 3, 3) += boundary_bbw_weights_(i, j) * y_start.segment(i * 3, 3);
+		});
 
 		return y;
 	}
 
 	Eigen::VectorXd BoundedBiharmonicWeights2Dto3D::apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const
 	{
+		auto storage = utils::create_thread_storage(Eigen::VectorXd(Eigen::VectorXd::Zero(x.size())));
+		utils::maybe_parallel_for(bbw_weights_.rows(), [&](int start, int end, int thread_id) {
+			Eigen::VectorXd &local_grad = utils::get_local_thread_storage(storage, thread_id);
+			for (int i = start; i < end; ++i)
+			{
+				for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(bbw_weights_, i); it; ++it)
+				{
+					const int j = it.col();
+					if (allow_rotations_)
+						local_grad.segment<6>(j * 6) += it.value() * grad_affine_transformation(control_points_.row(j), y_start.segment(i * 3, 3), x.segment(j * 6, 6)).transpose() * grad_full.segment<3>(i * 3);
+					else
+						local_grad.segment<3>(j * 3) += it.value() * grad_full.segment<3>(i * 3);
+				}
+			}
+		});
+
 		Eigen::VectorXd grad = Eigen::VectorXd::Zero(x.size());
-		if (allow_rotations_)
-		{
-			for (int j = 0; j < bbw_weights_.cols(); ++j)
-				for (int i = 0; i < bbw_weights_.rows(); ++i)
-					grad.segment(j * 6, 6) += bbw_weights_(i, j) * grad_affine_transformation(control_points_.row(j), y_start.segment(i * 3, 3), x.segment(j * 6, 6)).transpose() * grad_full.segment(i * 3, 3);
-		}
-		else
-		{
-			for (int j = 0; j < bbw_weights_.cols(); ++j)
-				for (int i = 0; i < bbw_weights_.rows(); ++i)
-					grad.segment(j * 3, 3) += bbw_weights_(i, j) * grad_full.segment(i * 3, 3);
-		}
+		for (const Eigen::VectorXd &local_grad : storage)
+			grad += local_grad;
 		return grad;
 	}
 
+	Eigen::SparseMatrix<double> BoundedBiharmonicWeights2Dto3D::jacobian(const int x_size) const
+	{
+		assert(!allow_rotations_);
+		std::vector<Eigen::Triplet<double>> triplets;
+		triplets.reserve(bbw_weights_.nonZeros() * 3);
+		for (int i = 0; i < bbw_weights_.outerSize(); ++i)
+			for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(bbw_weights_, i); it; ++it)
+				for (int d = 0; d < 3; ++d)
+					triplets.emplace_back(i * 3 + d, it.col() * 3 + d, it.value());
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(triplets.begin(), triplets.end());
+		return jac;
+	}
+
 	void BoundedBiharmonicWeights2Dto3D::compute_faces_for_partial_vertices(const Eigen::MatrixXd &V, Eigen::MatrixXi &F) const
 	{
 		// The following implementation is maybe a bit wasteful, but is independent of state or surface selections
@@ -3,6 +3,9 @@
 #include "Parametrization.hpp"
 
 #include <Eigen/Core>
+#include <Eigen/Sparse>
+
+#include <string>
 
 namespace polyfem
 {
@@ -28,6 +31,10 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const override;
 
+		// The curve is linear in the control points
+		bool is_linear() const override { return true; }
+		Eigen::SparseMatrix<double> jacobian(const int x_size) const override;
+
 	private:
 		const Eigen::MatrixXd initial_control_points_;
 		const Eigen::VectorXd knots_;
@@ -71,7 +78,8 @@ namespace polyfem::solver
 	{
 	public:
 		BoundedBiharmonicWeights2Dto3D(const int num_control_vertices, const int num_vertices, const Eigen::MatrixXd &V_surface, const Eigen::MatrixXi &F_surface) : num_control_vertices_(num_control_vertices), num_vertices_(num_vertices), V_surface_(V_surface), F_surface_(F_surface), allow_rotations_(true) {}
-		BoundedBiharmonicWeights2Dto3D(const int num_control_vertices, const int num_vertices, const State &state, const bool allow_rotations);
+		/// @param weights_cache HDF5 file of the weights, loaded if they were computed for the same surface and saved otherwise (none if empty)
+		BoundedBiharmonicWeights2Dto3D(const int num_control_vertices, const int num_vertices, const State &state, const bool allow_rotations, const std::string &weights_cache = "");
 
 		// Should only be called to initialize the parameter, when the shape matches the initial control points.
 		Eigen::VectorXd inverse_eval(const Eigen::VectorXd &y) override;
@@ -79,18 +87,31 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const override;
 
-		Eigen::MatrixXd get_bbw_weights() { return bbw_weights_; }
+		// Without rotations the vertices are a fixed weighted sum of the control translations
+		bool is_linear() const override { return !allow_rotations_; }
+		Eigen::SparseMatrix<double> jacobian(const int x_size) const override;
+
+		Eigen::MatrixXd get_bbw_weights() { return Eigen::MatrixXd(bbw_weights_); }
 
 	private:
 		void compute_faces_for_partial_vertices(const Eigen::MatrixXd &V, Eigen::MatrixXi &F) const;
 
+		/// solve for the weights of the control points and of the fixed boundary loop of the surface y_start
+		void compute_weights();
+		/// load the weights from weights_cache_ if they were saved with this key
+		bool load_weights(const size_t key);
+		void save_weights(const size_t key) const;
+
 		int optimal_new_control_point_idx(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::VectorXi &boundary_loop, const std::vector<int> &existing_points) const;
 
 		const int num_control_vertices_;
 		const int num_vertices_;
 		Eigen::MatrixXd control_points_;
-		Eigen::MatrixXd bbw_weights_;
-		Eigen::MatrixXd boundary_bbw_weights_;
+		/// weights of the control points (columns) of every vertex (rows), without the negligible ones
+		Eigen::SparseMatrix<double, Eigen::RowMajor> bbw_weights_;
+		/// sum of the weights of the fixed boundary loop of every vertex
+		Eigen::VectorXd boundary_bbw_weights_;
+		std::string weights_cache_;
 
 		Eigen::MatrixXd V_surface_;
 		Eigen::MatrixXi F_surface_;
@@ -101,7 +101,13 @@ namespace polyfem
 	{
 		StiffnessMatrix gradu_h(sol.size(), sol.size());
 		if (current_step == 0)
+		{
+			const std::string spill_file = args["solver"]["advanced"]["adjoint_spill_file"];
+			diff_cached.set_jacobian_storage(
+				args["solver"]["advanced"]["adjoint_max_jacobians"],
+				spill_file.empty() ? "" : resolve_output_path(spill_file));
 			diff_cached.init(mesh->dimension(), ndof(), problem->is_time_dependent() ? args["time"]["time_steps"].get<int>() : 0);
+		}
 
 		ipc::Collisions cur_collision_set;
 		ipc::FrictionCollisions cur_friction_set;
@@ -371,11 +377,8 @@ namespace polyfem
 		}
 		else
 		{
-			auto solver = polysolve::linear::Solver::create(args["solver"]["adjoint_linear"], adjoint_logger());
-
-			StiffnessMatrix A = diff_cached.gradu_h(0); // This should be transposed, but A is symmetric in hyper-elastic and diffusion problems
-			solver->analyze_pattern(A, A.rows());
-			solver->factorize(A);
+			// This should be transposed, but A is symmetric in hyper-elastic and diffusion problems
+			polysolve::linear::Solver &solver = diff_cached.static_adjoint_solver(args["solver"]["adjoint_linear"], adjoint_logger());
 
 			/*
 			For non-periodic problems, the adjoint solution p's size is the full size in NLProblem
@@ -390,7 +393,7 @@ namespace polyfem
 
 					Eigen::VectorXd x;
 					x.setZero(tmp.size());
-					solver->solve(tmp, x);
+					solver.solve(tmp, x);
 
 					adjoint.col(i) = solve_data.nl_problem->reduced_to_full(x);
 				}
@@ -406,7 +409,7 @@ namespace polyfem
 
 					Eigen::VectorXd x;
 					x.setZero(tmp.size());
-					solver->solve(tmp, x);
+					solver.solve(tmp, x);
 					x.conservativeResize(adjoint.rows());
 
 					adjoint.col(i) = x;
@@ -483,10 +486,10 @@ namespace polyfem
 					Eigen::VectorXd b_ = rhs_;
 					b_(boundary_nodes).setZero();
 
-					auto solver = polysolve::linear::Solver::create(args["solver"]["adjoint_linear"], adjoint_logger());
+					polysolve::linear::Solver &solver = diff_cached.transient_adjoint_solver(args["solver"]["adjoint_linear"], adjoint_logger());
 
 					Eigen::VectorXd x;
-					dirichlet_solve(*solver, A, b_, boundary_nodes, x, A.rows(), "", false, false, false);
+					dirichlet_solve(solver, A, b_, boundary_nodes, x, A.rows(), "", false, false, false);
 					adjoints.col(i + cols_per_adjoint) = x;
 				}
 
@@ -19,6 +19,8 @@
 
 #include <ipc/ipc.hpp>
 
+#include <limits>
+
 namespace polyfem
 {
 
@@ -28,6 +30,19 @@ namespace polyfem
 	using namespace utils;
 	using namespace quadrature;
 
+	namespace
+	{
+		/// removes the average of the fluctuation part of the extended solution
+		void remove_mean_fluctuation(const State &state, Eigen::MatrixXd &sol)
+		{
+			const int dim = state.mesh->dimension();
+			Eigen::VectorXd integral = io::Evaluator::integrate_function(state.bases, state.geom_bases(), state.ass_vals_cache, sol, dim, dim);
+			double area = io::Evaluator::integrate_function(state.bases, state.geom_bases(), state.ass_vals_cache, Eigen::VectorXd::Ones(state.n_bases), dim, 1)(0);
+			for (int d = 0; d < dim; d++)
+				sol(Eigen::seqN(d, state.n_bases, dim), 0).array() -= integral(d) / area;
+		}
+	} // namespace
+
 	void State::init_homogenization_solve(const double t)
 	{
 		const int dim = mesh->dimension();
@@ -134,7 +149,9 @@ namespace polyfem
 		const auto &fixed_entry = macro_strain_constraint.get_fixed_entry();
 		homo_problem->set_fixed_entry({});
 		{
-			std::shared_ptr<polysolve::nonlinear::Solver> nl_solver = make_nl_solver(true);
+			if (solve_data.al_nl_solver == nullptr)
+				solve_data.al_nl_solver = make_nl_solver(true);
+			std::shared_ptr<polysolve::nonlinear::Solver> nl_solver = solve_data.al_nl_solver;
 
 			Eigen::VectorXi al_indices = fixed_entry.array() + homo_problem->full_size();
 			Eigen::VectorXd al_values = utils::flatten(macro_strain_constraint.eval(t))(fixed_entry);
@@ -227,7 +244,9 @@ namespace polyfem
 		Eigen::VectorXd reduced_sol = homo_problem->extended_to_reduced(extended_sol);
 
 		homo_problem->init(reduced_sol);
-		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver = make_nl_solver(false);
+		if (solve_data.nl_solver == nullptr)
+			solve_data.nl_solver = make_nl_solver(false);
+		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver = solve_data.nl_solver;
 		nl_solver->minimize(*homo_problem, reduced_sol);
 
 		logger().info("Macro Strain: {}", extended_sol.tail(dim * dim).transpose());
@@ -260,11 +279,7 @@ namespace polyfem
 		sol = homo_problem->reduced_to_extended(reduced_sol);
 		if (args["/boundary_conditions/periodic_boundary/force_zero_mean"_json_pointer].get<bool>())
 		{
-			Eigen::VectorXd integral = io::Evaluator::integrate_function(bases, geom_bases(), sol, dim, dim);
-			double area = io::Evaluator::integrate_function(bases, geom_bases(), Eigen::VectorXd::Ones(n_bases), dim, 1)(0);
-			for (int d = 0; d < dim; d++)
-				sol(Eigen::seqN(d, n_bases, dim), 0).array() -= integral(d) / area;
-
+			remove_mean_fluctuation(*this, sol);
 			reduced_sol = homo_problem->extended_to_reduced(sol);
 		}
 
@@ -272,6 +287,103 @@ namespace polyfem
 			cache_transient_adjoint_quantities(t, homo_problem->reduced_to_full(reduced_sol), utils::unflatten(sol.bottomRows(dim * dim), dim));
 	}
 
+	void State::solve_homogenization_batch(const std::vector<Eigen::MatrixXd> &macro_strains, std::vector<Eigen::MatrixXd> &sols)
+	{
+		if (!is_homogenization())
+			log_and_throw_error("Batched homogenization requires a periodic linear_displacement_offset!");
+
+		const int dim = mesh->dimension();
+		const assembler::MacroStrainValue prescribed_strain = macro_strain_constraint;
+
+		// the forms, the periodic reduction and the problem are built once for all strains
+		init_homogenization_solve(0);
+		auto homo_problem = std::dynamic_pointer_cast<NLHomoProblem>(solve_data.nl_problem);
+
+		// the AL forms cache the fixed values
+		const auto update_al_forms = [&]() {
+			if (solve_data.strain_al_pen_form)
+				solve_data.strain_al_pen_form->update_quantities(0, Eigen::VectorXd());
+			if (solve_data.strain_al_lagr_form)
+				solve_data.strain_al_lagr_form->update_quantities(0, Eigen::VectorXd());
+		};
+		const auto set_strain = [&](const Eigen::MatrixXd &strain) {
+			macro_strain_constraint.set_values(strain);
+			update_al_forms();
+		};
+
+		sols.resize(macro_strains.size());
+		if (is_problem_linear())
+		{
+			// the energy is quadratic, one Newton step from zero is exact and the hessian does not depend on the strain
+			homo_problem->set_fixed_entry(macro_strain_constraint.get_fixed_entry());
+			const Eigen::VectorXd x0 = Eigen::VectorXd::Zero(homo_problem->reduced_size() + homo_problem->macro_reduced_size());
+
+			set_strain(macro_strains.empty() ? Eigen::MatrixXd::Zero(dim, dim) : macro_strains[0]);
+			homo_problem->init(x0);
+			homo_problem->solution_changed(x0);
+
+			StiffnessMatrix A;
+			homo_problem->hessian(x0, A);
+
+			std::unique_ptr<polysolve::linear::Solver> solver = polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+			solver->analyze_pattern(A, A.rows());
+			solver->factorize(A);
+
+			// the gradients are assembled per strain, the factorization is shared by all the right-hand sides
+			Eigen::MatrixXd rhs(x0.size(), macro_strains.size());
+			for (int k = 0; k < macro_strains.size(); ++k)
+			{
+				set_strain(macro_strains[k]);
+				homo_problem->solution_changed(x0);
+				Eigen::VectorXd grad;
+				homo_problem->gradient(x0, grad);
+				rhs.col(k) = -grad;
+			}
+
+			for (int k = 0; k < macro_strains.size(); ++k)
+			{
+				Eigen::VectorXd dx(x0.size());
+				solver->solve(rhs.col(k), dx);
+
+				// the fixed strain entries are read from the constraint
+				set_strain(macro_strains[k]);
+				sols[k] = homo_problem->reduced_to_extended(x0 + dx);
+				if (args["/boundary_conditions/periodic_boundary/force_zero_mean"_json_pointer].get<bool>())
+					remove_mean_fluctuation(*this, sols[k]);
+			}
+		}
+		else
+		{
+			for (int k = 0; k < macro_strains.size(); ++k)
+			{
+				// warm start from the closest strain solved so far
+				int closest = -1;
+				double closest_dist = std::numeric_limits<double>::max();
+				for (int j = 0; j < k; ++j)
+				{
+					const double dist = (macro_strains[k] - macro_strains[j]).squaredNorm();
+					if (dist < closest_dist)
+					{
+						closest_dist = dist;
+						closest = j;
+					}
+				}
+
+				Eigen::MatrixXd extended_sol;
+				if (closest >= 0)
+					extended_sol = sols[closest];
+
+				logger().info("Homogenization batch {}/{}", k + 1, macro_strains.size());
+				set_strain(macro_strains[k]);
+				solve_homogenization_step(extended_sol, 0, false);
+				sols[k] = extended_sol;
+			}
+		}
+
+		macro_strain_constraint = prescribed_strain;
+		update_al_forms();
+	}
+
 	void State::solve_homogenization(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
 	{
 		bool is_static = !is_param_valid(args, "time");
@@ -327,7 +439,7 @@ namespace polyfem
 			//     solve_data.time_integrator->save_state(state_path);
 
 			// save restart file
-			save_restart_json(t0, dt, t);
+			save_restart_json(t0 + dt * t, dt, t);
 			// stats_csv.write(t, forward_solve_time, remeshing_time, global_relaxation_time, sol);
 		}
 	}
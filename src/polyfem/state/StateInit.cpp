@@ -11,11 +11,14 @@
 #include <polyfem/utils/GeogramUtils.hpp>
 #include <polyfem/problem/KernelProblem.hpp>
 #include <polyfem/utils/par_for.hpp>
+#include <polyfem/utils/Profiler.hpp>
 
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/JSONSpec.hpp>
 
 #include <jse/jse.h>
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/ostream_sink.h>
@@ -66,7 +69,8 @@ namespace polyfem
 		const std::string &log_file,
 		const spdlog::level::level_enum log_level,
 		const spdlog::level::level_enum file_log_level,
-		const bool is_quiet)
+		const bool is_quiet,
+		const bool is_async)
 	{
 		std::vector<spdlog::sink_ptr> sinks;
 
@@ -84,7 +88,7 @@ namespace polyfem
 			sinks.push_back(file_sink_);
 		}
 
-		init_logger(sinks, log_level);
+		init_logger(sinks, log_level, is_async);
 		spdlog::flush_every(std::chrono::seconds(3));
 	}
 
@@ -97,19 +101,29 @@ namespace polyfem
 
 	void State::init_logger(
 		const std::vector<spdlog::sink_ptr> &sinks,
-		const spdlog::level::level_enum log_level)
+		const spdlog::level::level_enum log_level,
+		const bool is_async)
 	{
-		set_logger(std::make_shared<spdlog::logger>("polyfem", sinks.begin(), sinks.end()));
+		const auto create_logger = [&](const std::string &name) -> std::shared_ptr<spdlog::logger> {
+			if (!is_async)
+				return std::make_shared<spdlog::logger>(name, sinks.begin(), sinks.end());
+
+			// the messages are queued and written by the thread of the pool, the solver only blocks if the queue is full
+			if (spdlog::thread_pool() == nullptr)
+				spdlog::init_thread_pool(8192, 1);
+			auto async_logger = std::make_shared<spdlog::async_logger>(
+				name, sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::block);
+			// the errors are written before the exceptions are thrown
+			async_logger->flush_on(spdlog::level::err);
+			return async_logger;
+		};
+
+		set_logger(create_logger("polyfem"));
 		GeogramUtils::instance().set_logger(logger());
 
-		ipc::set_logger(std::make_shared<spdlog::logger>("ipctk", sinks.begin(), sinks.end()));
+		ipc::set_logger(create_logger("ipctk"));
 
-		wmtk::set_logger(std::make_shared<spdlog::logger>("wmtk", sinks.begin(), sinks.end()));
-
-		// Set the logger at the lowest level, so all messages are passed to the sinks
-		logger().set_level(spdlog::level::trace);
-		ipc::logger().set_level(spdlog::level::trace);
-		wmtk::logger().set_level(spdlog::level::trace);
+		wmtk::set_logger(create_logger("wmtk"));
 
 		set_log_level(log_level);
 	}
@@ -121,6 +135,12 @@ namespace polyfem
 		{
 			// Set only the level of the console
 			console_sink_->set_level(log_level); // Shared by all loggers
+
+			// the loggers pass the messages written by some sink, the others are discarded before being formatted
+			const spdlog::level::level_enum level = file_sink_ ? std::min(log_level, file_sink_->level()) : log_level;
+			logger().set_level(level);
+			ipc::logger().set_level(level);
+			wmtk::logger().set_level(level);
 		}
 		else
 		{
@@ -130,6 +150,17 @@ namespace polyfem
 		}
 	}
 
+	namespace
+	{
+		std::shared_ptr<const json> input_rules()
+		{
+			return load_spec_rules(POLYFEM_INPUT_SPEC, true, "default_solvers", [](json &rules) {
+				polysolve::linear::Solver::apply_default_solver(rules, "/solver/linear");
+				polysolve::linear::Solver::apply_default_solver(rules, "/solver/adjoint_linear");
+			});
+		}
+	} // namespace
+
 	void State::init(const json &p_args_in, const bool strict_validation)
 	{
 		json args_in = p_args_in; // mutable copy
@@ -137,28 +168,9 @@ namespace polyfem
 		apply_common_params(args_in);
 
 		// CHECK validity json
-		json rules;
 		jse::JSE jse;
-		{
-			jse.strict = strict_validation;
-			const std::string polyfem_input_spec = POLYFEM_INPUT_SPEC;
-			std::ifstream file(polyfem_input_spec);
-
-			if (file.is_open())
-				file >> rules;
-			else
-			{
-				logger().error("unable to open {} rules", polyfem_input_spec);
-				throw std::runtime_error("Invald spec file");
-			}
-
-			jse.include_directories.push_back(POLYFEM_JSON_SPEC_DIR);
-			jse.include_directories.push_back(POLYSOLVE_JSON_SPEC_DIR);
-			rules = jse.inject_include(rules);
-
-			polysolve::linear::Solver::apply_default_solver(rules, "/solver/linear");
-			polysolve::linear::Solver::apply_default_solver(rules, "/solver/adjoint_linear");
-		}
+		jse.strict = strict_validation;
+		const std::shared_ptr<const json> rules = input_rules();
 
 		polysolve::linear::Solver::select_valid_solver(args_in["solver"]["linear"], logger());
 		if (args_in["solver"]["adjoint_linear"].is_null())
@@ -185,7 +197,7 @@ namespace polyfem
 			}
 		}
 
-		const bool valid_input = jse.verify_json(args_in, rules);
+		const bool valid_input = jse.verify_json(args_in, *rules);
 
 		if (!valid_input)
 		{
@@ -194,8 +206,9 @@ namespace polyfem
 		}
 		// end of check
 
-		this->args = jse.inject_defaults(args_in, rules);
+		this->args = jse.inject_defaults(args_in, *rules);
 		units.init(this->args["units"]);
+		config.init(this->args);
 
 		// Save output directory and resolve output paths dynamically
 		const std::string output_dir = resolve_input_path(this->args["output"]["directory"]);
@@ -215,12 +228,24 @@ namespace polyfem
 			out_path_log,
 			this->args["output"]["log"]["level"],
 			this->args["output"]["log"]["file_level"],
-			this->args["output"]["log"]["quiet"]);
+			this->args["output"]["log"]["quiet"],
+			this->args["output"]["log"]["async"]);
 
 		logger().info("Saving output to {}", output_dir);
 
 		const unsigned int thread_in = this->args["solver"]["max_threads"];
 		set_max_threads(thread_in);
+		NThread::get().set_numa(this->args["solver"]["numa"]);
+
+		if (this->args["output"]["profile"]["enabled"])
+			Profiler::get().enable(this->args["output"]["profile"]["buffer_size"].get<size_t>());
+
+		const json &async_output = this->args["output"]["paraview"]["async"];
+		out_geom.init_async_writer(
+			async_output["enabled"] ? async_output["max_files"].get<int>() : 0,
+			async_output["memory_budget"].get<double>() * 1024 * 1024);
+		// at most one checkpoint waits while the previous one is written
+		checkpoint_writer->start(this->args["output"]["data"]["async_checkpoint"] ? 2 : 0, std::numeric_limits<size_t>::max());
 
 		has_dhat = args_in["contact"].contains("dhat");
 
@@ -241,6 +266,16 @@ namespace polyfem
 			{
 				args["solver"]["contact"]["friction_iterations"] = 0;
 			}
+
+#ifndef POLYFEM_WITH_CUDA_CCD
+			// sweep and tiniest queue runs the broad phase and the CCD on the GPU
+			const std::string broad_phase = args["solver"]["contact"]["CCD"]["broad_phase"];
+			if (broad_phase == "sweep_and_tiniest_queue" || broad_phase == "STQ")
+			{
+				logger().warn("{} requires IPC Toolkit built with CUDA (IPC_TOOLKIT_WITH_CUDA); using hash_grid instead", broad_phase);
+				args["solver"]["contact"]["CCD"]["broad_phase"] = "hash_grid";
+			}
+#endif
 		}
 		else
 		{
@@ -268,20 +303,7 @@ namespace polyfem
 			else
 				problem = std::make_shared<assembler::GenericTensorProblem>("GenericTensor");
 
-			problem->clear();
-			if (!args["time"].is_null())
-			{
-				const auto tmp = R"({"is_time_dependent": true})"_json;
-				problem->set_parameters(tmp);
-			}
-			// important for the BC
-
-			auto bc = args["boundary_conditions"];
-			bc["root_path"] = root_path();
-			problem->set_parameters(bc);
-			problem->set_parameters(args["initial_conditions"]);
-
-			problem->set_parameters(args["output"]);
+			set_problem_parameters();
 		}
 		else
 		{
@@ -415,6 +437,87 @@ namespace polyfem
 		logger().info("t0={}, dt={}, tend={}", t0, dt, tend);
 	}
 
+	void State::set_problem_parameters()
+	{
+		problem->clear();
+		if (!args["time"].is_null())
+		{
+			const auto tmp = R"({"is_time_dependent": true})"_json;
+			problem->set_parameters(tmp);
+		}
+		// important for the BC
+
+		auto bc = args["boundary_conditions"];
+		bc["root_path"] = root_path();
+		problem->set_parameters(bc);
+		problem->set_parameters(args["initial_conditions"]);
+
+		problem->set_parameters(args["output"]);
+	}
+
+	void State::update_load_case(const json &load_case)
+	{
+		if (!mesh || n_bases <= 0)
+			log_and_throw_error("Load the mesh and build the bases before swapping the load case!");
+		if (args.contains("preset_problem"))
+			log_and_throw_error("Only the load cases of generic problems can be swapped!");
+
+		json new_args = args;
+		for (const auto &it : load_case.items())
+		{
+			if (it.key() != "boundary_conditions" && it.key() != "initial_conditions" && it.key() != "materials")
+				log_and_throw_error("Unsupported load case entry {}, only boundary_conditions, initial_conditions and materials can be swapped!", it.key());
+			new_args[it.key()] = it.value();
+		}
+
+		jse::JSE jse;
+		const std::shared_ptr<const json> rules = input_rules();
+		if (!jse.verify_json(new_args, *rules))
+		{
+			logger().error("invalid load case:\n{}", jse.log2str());
+			log_and_throw_error("Invalid load case");
+		}
+
+		const bool materials_changed = load_case.contains("materials");
+		new_args = jse.inject_defaults(new_args, *rules);
+		std::swap(args, new_args);
+		if (materials_changed && formulation() != assembler->name())
+		{
+			std::swap(args, new_args);
+			log_and_throw_error("The materials of a load case cannot change the formulation {}!", assembler->name());
+		}
+		config.init(args);
+
+		if (materials_changed)
+		{
+			std::vector<std::shared_ptr<assembler::Assembler>> assemblers;
+			assemblers.push_back(assembler);
+			assemblers.push_back(mass_matrix_assembler);
+			if (pressure_assembler != nullptr)
+				assemblers.push_back(pressure_assembler);
+			set_materials(assemblers);
+
+			mass.resize(0, 0);
+			lin_factorization_valid = false;
+		}
+
+		if (load_case.contains("boundary_conditions") || load_case.contains("initial_conditions"))
+		{
+			set_problem_parameters();
+			problem->set_units(*assembler, units);
+			problem->init(*mesh);
+			problem->update_nodes(in_node_to_node);
+
+			const std::vector<int> prev_boundary_nodes = boundary_nodes;
+			setup_boundary_conditions();
+			if (boundary_nodes != prev_boundary_nodes)
+				lin_factorization_valid = false;
+		}
+
+		rhs.resize(0, 0);
+		solve_data.rhs_assembler = nullptr;
+	}
+
 	void State::set_materials(std::vector<std::shared_ptr<assembler::Assembler>> &assemblers) const
 	{
 		const int size = (assembler->is_tensor() || assembler->is_fluid()) ? mesh->dimension() : 1;
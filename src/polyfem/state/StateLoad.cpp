@@ -11,14 +11,75 @@
 #include <polyfem/utils/Selection.hpp>
 
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/StringUtils.hpp>
 
 #include <igl/Timer.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
 namespace polyfem
 {
 	using namespace basis;
 	using namespace mesh;
 	using namespace utils;
 
+	namespace
+	{
+		template <typename T>
+		void hash_combine(size_t &seed, const T &v)
+		{
+			seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+
+		template <typename Mat>
+		void hash_matrix(size_t &seed, const Mat &m)
+		{
+			hash_combine(seed, m.rows());
+			hash_combine(seed, m.cols());
+			hash_combine(seed, std::string_view(reinterpret_cast<const char *>(m.data()), m.size() * sizeof(typename Mat::Scalar)));
+		}
+
+		/// key of the mesh snapshot: content of the mesh files, geometry arguments (transformations, refinement, ...), units, and in-memory meshes
+		size_t mesh_snapshot_key(
+			const Units &units,
+			const json &geometry,
+			const std::string &root_path,
+			const std::vector<std::string> &names,
+			const std::vector<Eigen::MatrixXi> &cells,
+			const std::vector<Eigen::MatrixXd> &vertices,
+			const bool non_conforming)
+		{
+			size_t seed = 0;
+			hash_combine(seed, geometry.dump());
+			hash_combine(seed, units.length());
+			hash_combine(seed, non_conforming);
+
+			for (const json &g : json_as_array(geometry))
+			{
+				if (!g.contains("mesh") || !g["mesh"].is_string())
+					continue;
+
+				const std::string path = resolve_path(g["mesh"], root_path);
+				std::ifstream file(path, std::ios::binary);
+				if (!file.good())
+					continue;
+				hash_combine(seed, std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+			}
+
+			for (int i = 0; i < names.size(); ++i)
+			{
+				hash_combine(seed, names[i]);
+				hash_matrix(seed, cells[i]);
+				hash_matrix(seed, vertices[i]);
+			}
+
+			return seed;
+		}
+	} // namespace
+
 	void State::reset_mesh()
 	{
 		bases.clear();
@@ -30,6 +91,7 @@ namespace polyfem
 		polys.clear();
 		poly_edge_to_data.clear();
 		obstacle.clear();
+		adaptive_disc_orders.resize(0);
 
 		mass.resize(0, 0);
 		rhs.resize(0, 0);
@@ -86,6 +148,7 @@ namespace polyfem
 		logger().info(" took {}s", timer.getElapsedTime());
 
 		out_geom.init_sampler(*mesh, args["output"]["paraview"]["vismesh_rel_area"]);
+		record_memory("load");
 	}
 
 	void State::load_mesh(bool non_conforming,
@@ -102,6 +165,15 @@ namespace polyfem
 		timer.start();
 
 		logger().info("Loading mesh ...");
+		const std::string snapshot_path = resolve_input_path(args["input"]["mesh_snapshot"]);
+		const bool has_snapshot = !snapshot_path.empty() && std::filesystem::exists(snapshot_path);
+		const size_t snapshot_key = snapshot_path.empty() ? 0 : mesh_snapshot_key(units, args["geometry"], args["root_path"], names, cells, vertices, non_conforming);
+		if (mesh == nullptr && has_snapshot)
+		{
+			logger().info("Loading mesh snapshot {}", snapshot_path);
+			mesh = mesh::Mesh::load_snapshot(snapshot_path, snapshot_key, non_conforming);
+		}
+
 		if (mesh == nullptr)
 		{
 			assert(is_param_valid(args, "geometry"));
@@ -109,6 +181,13 @@ namespace polyfem
 				units,
 				args["geometry"], args["root_path"],
 				names, vertices, cells, non_conforming);
+
+			// also rebuilds stale or invalid snapshots
+			if (mesh != nullptr && !snapshot_path.empty())
+			{
+				logger().info("Saving mesh snapshot {}", snapshot_path);
+				mesh->save_snapshot(snapshot_path, snapshot_key);
+			}
 		}
 
 		if (mesh == nullptr)
@@ -153,6 +232,29 @@ namespace polyfem
 			args["root_path"], mesh->dimension(), names, vertices, cells);
 		timer.stop();
 		logger().info(" took {}s", timer.getElapsedTime());
+
+		record_memory("load");
+	}
+
+	void State::reload_remeshed_mesh()
+	{
+		assert(mesh != nullptr);
+
+		// the obstacles do not depend on the FE mesh
+		mesh::Obstacle old_obstacle = std::move(obstacle);
+		reset_mesh();
+		obstacle = std::move(old_obstacle);
+
+		std::vector<std::shared_ptr<assembler::Assembler>> assemblers;
+		assemblers.push_back(assembler);
+		assemblers.push_back(mass_matrix_assembler);
+		if (mixed_assembler != nullptr)
+			mixed_assembler->set_size(mesh->dimension());
+		if (pressure_assembler != nullptr)
+			assemblers.push_back(pressure_assembler);
+		set_materials(assemblers);
+
+		out_geom.init_sampler(*mesh, args["output"]["paraview"]["vismesh_rel_area"]);
 	}
 
 	void State::build_mesh_matrices(Eigen::MatrixXd &V, Eigen::MatrixXi &F)
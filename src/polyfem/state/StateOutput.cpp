@@ -1,7 +1,16 @@
 #include <polyfem/State.hpp>
 
+#include <polyfem/autogen/auto_p_bases.hpp>
+#include <polyfem/autogen/auto_q_bases_2d_nodes.hpp>
+#include <polyfem/autogen/auto_q_bases_3d_nodes.hpp>
+#include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
+#include <polyfem/solver/forms/ContactForm.hpp>
+#include <polyfem/solver/forms/ElasticForm.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
 #include <polyfem/utils/Timer.hpp>
+#include <polyfem/utils/Profiler.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+#include <polyfem/utils/getRSS.h>
 
 #include <filesystem>
 
@@ -19,7 +28,7 @@ namespace polyfem
 			tend = args["time"]["tend"];
 		}
 
-		stats.compute_errors(n_bases, bases, geom_bases(), *mesh, *problem, tend, sol);
+		stats.compute_errors(n_bases, bases, geom_bases(), *mesh, *problem, tend, sol, &ass_vals_cache);
 	}
 
 	std::string State::root_path() const
@@ -45,25 +54,67 @@ namespace polyfem
 
 	void State::save_timestep(const double time, const int t, const double t0, const double dt, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure)
 	{
+		POLYFEM_PROFILE_ZONE("State::save_timestep");
+
+		if (!args["output"]["reductions"].empty())
+		{
+			POLYFEM_SCOPED_TIMER("Reducing output quantities");
+			if (t == 0 || reduction_writer == nullptr)
+				reduction_writer = std::make_shared<io::ReductionCSVWriter>(resolve_output_path("reductions.csv"), args["output"]["reductions"]);
+			reduction_writer->write(time, *this, sol);
+		}
+
+		const json &render_args = args["output"]["render"];
+		if (render_args["enabled"] && !(t % render_args["skip_frame"].get<int>()))
+		{
+			POLYFEM_SCOPED_TIMER("Rendering frame");
+			out_geom.save_render(resolve_output_path(fmt::format(render_args["file_name"].get<std::string>() + "{:d}.png", t)), *this, sol, render_args);
+		}
+
 		if (args["output"]["advanced"]["save_time_sequence"] && !(t % args["output"]["paraview"]["skip_frame"].get<int>()))
 		{
 			logger().trace("Saving VTU...");
 			POLYFEM_SCOPED_TIMER("Saving VTU");
 			const std::string step_name = args["output"]["advanced"]["timestep_prefix"];
 
+			io::OutGeometryData::ExportOptions opts(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file);
+
+			if (opts.time_series)
+			{
+				// the volume of all the steps goes to a single file, the other datasets are still saved per step
+				if (t == 0)
+					out_geom.reset_time_series();
+				std::filesystem::path series_path = args["output"]["paraview"]["file_name"].get<std::string>();
+				if (series_path.empty())
+					series_path = "time_series";
+				series_path.replace_extension(".h5");
+				out_geom.save_volume(resolve_output_path(series_path.string()), *this, sol, pressure, time, dt, opts, solution_frames);
+
+				opts.volume = false;
+				if (!opts.surface && !opts.wire && !opts.points && !(is_contact_enabled() && (opts.contact_forces || opts.friction_forces)))
+					return;
+			}
+
 			if (!solve_export_to_file)
 				solution_frames.emplace_back();
 
 			out_geom.save_vtu(
 				resolve_output_path(fmt::format(step_name + "{:d}.vtu", t)),
-				*this, sol, pressure, time, dt,
-				io::OutGeometryData::ExportOptions(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file),
+				*this, sol, pressure, time, dt, opts,
 				is_contact_enabled(), solution_frames);
+			store_solution_frames();
+
+			if (t == 0)
+				output_times.clear();
+			for (int i = output_times.size(); i < t; ++i)
+				output_times.push_back(t0 + i * dt);
+			output_times.resize(t);
+			output_times.push_back(time);
 
 			out_geom.save_pvd(
 				resolve_output_path(args["output"]["paraview"]["file_name"]),
 				[step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
-				t, t0, dt, args["output"]["paraview"]["skip_frame"].get<int>());
+				output_times, args["output"]["paraview"]["skip_frame"].get<int>());
 		}
 	}
 
@@ -81,6 +132,10 @@ namespace polyfem
 			save_json(sol, out);
 			out.close();
 		}
+
+		const std::string trace_path = resolve_output_path(args["output"]["profile"]["chrome_trace"]);
+		if (!trace_path.empty() && utils::Profiler::get().enabled())
+			utils::Profiler::get().save_chrome_trace(trace_path);
 	}
 
 	void State::save_json(const Eigen::MatrixXd &sol, std::ostream &out)
@@ -104,9 +159,31 @@ namespace polyfem
 						sol, *mesh, disc_orders, *problem, timings,
 						assembler->name(), iso_parametric(), args["output"]["advanced"]["sol_at_node"],
 						j);
+		if (solve_data.nl_problem)
+			j["form_timings"] = solve_data.nl_problem->form_timings();
 		out << j.dump(4) << std::endl;
 	}
 
+	void State::record_memory(const std::string &phase)
+	{
+		const auto to_mb = [](const size_t bytes) { return bytes / (1024.0 * 1024.0); };
+
+		json structures;
+		structures["mesh"] = to_mb(mesh ? mesh->memory_bytes() : 0);
+		structures["bases"] = to_mb(utils::memory_bytes(bases) + utils::memory_bytes(pressure_bases) + utils::memory_bytes(geom_bases_));
+		structures["assembly_values"] = to_mb(ass_vals_cache.memory_bytes() + mass_ass_vals_cache.memory_bytes() + pressure_ass_vals_cache.memory_bytes());
+		structures["mass"] = to_mb(utils::memory_bytes(mass));
+		structures["collision_mesh"] = to_mb(utils::memory_bytes(collision_mesh.rest_positions()) + utils::memory_bytes(collision_mesh.edges()) + utils::memory_bytes(collision_mesh.faces()));
+		structures["stiffness_cache"] = to_mb(solve_data.elastic_form ? solve_data.elastic_form->memory_bytes() : 0);
+		structures["contact"] = to_mb(solve_data.contact_form ? solve_data.contact_form->memory_bytes() : 0);
+		structures["diff_cache"] = to_mb(diff_cached.memory_bytes());
+
+		const double current = to_mb(getCurrentRSS());
+		const double peak = to_mb(getPeakRSS());
+		stats.memory[phase] = {{"current_rss", current}, {"peak_rss", peak}, {"structures", structures}};
+		logger().debug("Memory after {}: {:.1f}MB resident, {:.1f}MB peak", phase, current, peak);
+	}
+
 	void State::save_subsolve(const int i, const int t, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure)
 	{
 		if (!args["output"]["advanced"]["save_solve_sequence_debug"].get<bool>())
@@ -119,15 +196,45 @@ namespace polyfem
 		if (!args["time"].is_null())
 			dt = args["time"]["dt"];
 
+		io::OutGeometryData::ExportOptions opts(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file);
+		opts.time_series = false;
+
 		out_geom.save_vtu(
 			resolve_output_path(fmt::format("solve_{:d}.vtu", i)),
-			*this, sol, pressure, t, dt,
-			io::OutGeometryData::ExportOptions(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file),
+			*this, sol, pressure, t, dt, opts,
 			is_contact_enabled(), solution_frames);
+		store_solution_frames();
+	}
+
+	void State::init_solution_frame_store()
+	{
+		const json &frames_args = args["output"]["advanced"]["solution_frames"];
+		if (!frames_args["compress"])
+		{
+			solution_frame_store = nullptr;
+			return;
+		}
+
+		const size_t memory_limit = frames_args["memory_limit"].get<double>() * 1024 * 1024;
+		if (solution_frame_store == nullptr)
+			solution_frame_store = std::make_shared<io::SolutionFrameStore>();
+		solution_frame_store->reset(frames_args["tolerance"], memory_limit, frames_args["spill_directory"]);
+	}
+
+	void State::store_solution_frames()
+	{
+		if (solve_export_to_file || solution_frame_store == nullptr)
+			return;
+
+		for (const io::SolutionFrame &frame : solution_frames)
+			solution_frame_store->push_back(frame);
+		solution_frames.clear();
 	}
 
 	void State::export_data(const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure)
 	{
+		POLYFEM_PROFILE_ZONE("State::export_data");
+
 		if (!mesh)
 		{
 			logger().error("Load the mesh first!");
@@ -173,9 +280,132 @@ namespace polyfem
 			stress_path,
 			mises_path,
 			is_contact_enabled(), solution_frames);
+
+		out_geom.flush_output();
+
+		record_memory("output");
+	}
+
+	void State::get_input_node_solution(const Eigen::MatrixXd &sol, MatrixXdView out) const
+	{
+		if (!mesh || n_bases <= 0)
+			log_and_throw_error("Build the bases first!");
+
+		const int actual_dim = problem->is_scalar() ? 1 : mesh->dimension();
+		if (sol.size() < n_bases * actual_dim)
+			log_and_throw_error("The solution has {} entries, expected at least {}!", sol.size(), n_bases * actual_dim);
+		if (out.rows() != n_input_nodes() || out.cols() != actual_dim)
+			log_and_throw_error("The solution buffer is {}x{}, expected {}x{}!", out.rows(), out.cols(), n_input_nodes(), actual_dim);
+
+		for (int i = 0; i < n_input_nodes(); ++i)
+		{
+			for (int d = 0; d < actual_dim; ++d)
+				out(i, d) = sol(in_node_to_node[i] * actual_dim + d);
+		}
+	}
+
+	void State::get_input_node_stress(const Eigen::MatrixXd &sol, const double t, MatrixXdView stress, MatrixXdView von_mises) const
+	{
+		if (!mesh || n_bases <= 0)
+			log_and_throw_error("Build the bases first!");
+		if (problem->is_scalar())
+			log_and_throw_error("Define a tensor problem!");
+		if (args["space"]["basis_type"] == "Spline")
+			log_and_throw_error("Nodal stresses need Lagrange bases!");
+
+		const int dim = mesh->dimension();
+		if (stress.rows() != n_input_nodes() || stress.cols() != dim * dim)
+			log_and_throw_error("The stress buffer is {}x{}, expected {}x{}!", stress.rows(), stress.cols(), n_input_nodes(), dim * dim);
+		if (von_mises.rows() != n_input_nodes() || von_mises.cols() != 1)
+			log_and_throw_error("The von Mises buffer is {}x{}, expected {}x1!", von_mises.rows(), von_mises.cols(), n_input_nodes());
+
+		// the nodes of a Lagrange element are the ones of its local bases, in the same order
+		Eigen::MatrixXd node_stress = Eigen::MatrixXd::Zero(n_bases, dim * dim);
+		Eigen::VectorXd node_mises = Eigen::VectorXd::Zero(n_bases);
+		Eigen::VectorXi count = Eigen::VectorXi::Zero(n_bases);
+
+		Eigen::MatrixXd local_pts;
+		std::vector<assembler::Assembler::NamedMatrix> scalar, tensor;
+		for (int e = 0; e < bases.size(); ++e)
+		{
+			if (mesh->is_simplex(e))
+			{
+				if (mesh->is_volume())
+					autogen::p_nodes_3d(disc_orders(e), local_pts);
+				else
+					autogen::p_nodes_2d(disc_orders(e), local_pts);
+			}
+			else if (mesh->is_cube(e))
+			{
+				if (mesh->is_volume())
+					autogen::q_nodes_3d(disc_orders(e), local_pts);
+				else
+					autogen::q_nodes_2d(disc_orders(e), local_pts);
+			}
+			else
+				continue;
+
+			const basis::ElementBases &bs = bases[e];
+			if (local_pts.rows() != bs.bases.size())
+				continue;
+
+			const assembler::OutputData data(t, e, bs, geom_bases()[e], local_pts, sol);
+			assembler->compute_scalar_value(data, scalar);
+			assembler->compute_tensor_value(data, tensor);
+			if (scalar.empty() || tensor.empty())
+				log_and_throw_error("{} does not define a stress!", assembler->name());
+
+			for (int j = 0; j < local_pts.rows(); ++j)
+			{
+				const auto &global = bs.bases[j].global();
+				if (global.size() != 1)
+					continue;
+
+				const int node = global[0].index;
+				node_stress.row(node) += tensor[0].second.row(j);
+				node_mises(node) += scalar[0].second(j);
+				++count(node);
+			}
+		}
+
+		for (int i = 0; i < n_input_nodes(); ++i)
+		{
+			const int node = in_node_to_node[i];
+			if (count(node) > 0)
+			{
+				stress.row(i) = node_stress.row(node) / count(node);
+				von_mises(i, 0) = node_mises(node) / count(node);
+			}
+			else
+			{
+				stress.row(i).setZero();
+				von_mises(i, 0) = 0;
+			}
+		}
+	}
+
+	void State::save_checkpoint(const double t, const double dt, const int step)
+	{
+		const int interval = args["output"]["data"]["checkpoint_interval"];
+		if (interval <= 0 || step % interval != 0)
+			return;
+
+		const std::string state_path = resolve_output_path(fmt::format(args["output"]["data"]["state"], step));
+		Eigen::MatrixXd x_prevs, v_prevs, a_prevs;
+		if (!state_path.empty() && solve_data.time_integrator != nullptr)
+			solve_data.time_integrator->get_state(x_prevs, v_prevs, a_prevs);
+
+		// the restart json is written after the state so that it never points to a partial checkpoint
+		const size_t bytes = (x_prevs.size() + v_prevs.size() + a_prevs.size()) * sizeof(double);
+		auto job = [this, t, dt, step, state_path, x_prevs = std::move(x_prevs), v_prevs = std::move(v_prevs), a_prevs = std::move(a_prevs)]() {
+			if (x_prevs.size() > 0)
+				time_integrator::ImplicitTimeIntegrator::save_state(state_path, x_prevs, v_prevs, a_prevs);
+			save_restart_json(t, dt, step);
+		};
+		checkpoint_writer->push(std::move(job), bytes);
 	}
 
-	void State::save_restart_json(const double t0, const double dt, const int t) const
+	void State::save_restart_json(const double t, const double dt, const int step) const
 	{
 		const std::string restart_json_path = args["output"]["restart_json"];
 		if (restart_json_path.empty())
@@ -184,7 +414,10 @@ namespace polyfem
 		json restart_json;
 		restart_json["root_path"] = root_path();
 		restart_json["common"] = root_path();
-		restart_json["time"] = {{"t0", t0 + dt * t}};
+		restart_json["time"] = {{"t0", t}};
+		// the time step of the input is kept, only an adaptive step continues from the current one
+		if (args["time"]["adaptive"]["enabled"])
+			restart_json["time"]["adaptive"] = {{"initial_dt", dt}};
 
 		restart_json["space"] = R"({
 			"remesh": {
@@ -202,7 +435,7 @@ namespace polyfem
 		std::string rest_mesh_path = args["output"]["data"]["rest_mesh"].get<std::string>();
 		if (!rest_mesh_path.empty())
 		{
-			rest_mesh_path = resolve_output_path(fmt::format(args["output"]["data"]["rest_mesh"], t));
+			rest_mesh_path = resolve_output_path(fmt::format(args["output"]["data"]["rest_mesh"], step));
 
 			std::vector<json> patch;
 			if (args["geometry"].is_array())
@@ -256,11 +489,11 @@ namespace polyfem
 		restart_json["input"] = {{
 			"data",
 			{
-				{"state", resolve_output_path(fmt::format(args["output"]["data"]["state"], t))},
+				{"state", resolve_output_path(fmt::format(args["output"]["data"]["state"], step))},
 			},
 		}};
 
-		std::ofstream file(resolve_output_path(fmt::format(restart_json_path, t)));
+		std::ofstream file(resolve_output_path(fmt::format(restart_json_path, step)));
 		file << restart_json;
 	}
 } // namespace polyfem
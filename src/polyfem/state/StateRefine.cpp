@@ -0,0 +1,41 @@
+#include <polyfem/State.hpp>
+
+#include <polyfem/refinement/APriori.hpp>
+#include <polyfem/refinement/ErrorIndicator.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+namespace polyfem
+{
+	using namespace refinement;
+	using namespace utils;
+
+	int State::p_refine(const Eigen::MatrixXd &sol)
+	{
+		if (mixed_assembler != nullptr || mesh->has_poly())
+		{
+			logger().warn("Adaptive p-refinement is not supported for mixed formulations and polygonal meshes, skipping");
+			return 0;
+		}
+
+		const json &p_args = args["space"]["adaptive_p_ref"];
+		const int size = problem->is_scalar() ? 1 : mesh->dimension();
+
+		Eigen::VectorXd indicators;
+		ErrorIndicator::zz(*mesh, size, bases, geom_bases(), ass_vals_cache, sol.topRows(n_bases * size), indicators);
+
+		Eigen::VectorXi orders = disc_orders;
+		const int n_changed = APriori::p_refine(
+			*mesh,
+			ErrorIndicator::mark(indicators, p_args["theta"]),
+			args["space"]["advanced"]["discr_order_max"],
+			orders);
+
+		if (n_changed == 0)
+			return 0;
+
+		adaptive_disc_orders = orders;
+		build_basis();
+
+		return n_changed;
+	}
+} // namespace polyfem
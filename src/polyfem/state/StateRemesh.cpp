@@ -7,6 +7,7 @@
 #include <polyfem/solver/forms/ContactForm.hpp>
 #include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
 #include <polyfem/utils/GeometryUtils.hpp>
+#include <polyfem/utils/Profiler.hpp>
 
 #include <igl/edges.h>
 
@@ -158,6 +159,8 @@ namespace polyfem
 
 	bool State::remesh(const double time, const double dt, Eigen::MatrixXd &sol)
 	{
+		POLYFEM_PROFILE_ZONE("State::remesh");
+
 		const int dim = mesh->dimension();
 		int ndof = sol.size();
 		assert(sol.cols() == 1);
@@ -246,8 +249,8 @@ namespace polyfem
 		}
 		mesh->set_boundary_ids(boundary_ids);
 
-		// load mesh (and set materials) (will also reload obstacles from disk)
-		load_mesh();
+		// set the materials of the new elements, the obstacles are unchanged
+		reload_remeshed_mesh();
 
 		// --------------------------------------------------------------------
 
@@ -272,7 +275,8 @@ namespace polyfem
 		if (ndof_obstacle > 0)
 			sol.bottomRows(ndof_obstacle) = obstacle_sol;
 
-		solve_data.rhs_assembler = build_rhs_assembler();
+		// assemble_rhs already built the rhs assembler of the new mesh
+		assert(solve_data.rhs_assembler != nullptr);
 		if (problem->is_time_dependent())
 		{
 			assert(solve_data.time_integrator != nullptr);
@@ -49,7 +49,8 @@ namespace polyfem
 			if (state_path.empty())
 				return false;
 
-			if (!read_matrix(state_path, x_name, x))
+			// restarts of large problems, read by blocks without a full-size temporary
+			if (!read_matrix_chunked<double>(state_path, x_name, x))
 			{
 				logger().debug("Unable to read initial {} from file ({})", x_name, state_path);
 				return false;
@@ -2,6 +2,8 @@
 
 #include <polyfem/assembler/Mass.hpp>
 #include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/Helmholtz.hpp>
+#include <polyfem/assembler/StaticCondensation.hpp>
 
 #include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
@@ -9,12 +11,19 @@
 #include <polyfem/solver/forms/BodyForm.hpp>
 #include <polyfem/solver/forms/ElasticForm.hpp>
 #include <polyfem/solver/forms/InertiaForm.hpp>
+#include <polyfem/solver/MixedPrecisionSolver.hpp>
+#include <polyfem/solver/ModalSolver.hpp>
+#include <polyfem/solver/PreconditionerReuseSolver.hpp>
 #include <polysolve/linear/FEMSolver.hpp>
 
 #include <polyfem/utils/Timer.hpp>
+#include <polyfem/utils/Profiler.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
-#include <unsupported/Eigen/SparseExtra>
 #include <polyfem/io/Evaluator.hpp>
+#include <polyfem/io/MatrixIO.hpp>
+
+#include <limits>
 
 namespace polyfem
 {
@@ -24,6 +33,20 @@ namespace polyfem
 	using namespace solver;
 	using namespace io;
 
+	namespace
+	{
+		std::unique_ptr<polysolve::linear::Solver> create_linear_solver(const json &args)
+		{
+			const json &advanced = args["solver"]["advanced"];
+			std::unique_ptr<polysolve::linear::Solver> solver;
+			if (advanced["mixed_precision"])
+				solver = std::make_unique<MixedPrecisionSolver>(advanced["mixed_precision_tolerance"].get<double>(), advanced["mixed_precision_max_iterations"].get<int>());
+			else
+				solver = polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+			return PreconditionerReuseSolver::wrap(std::move(solver), args["solver"]);
+		}
+	} // namespace
+
 	void State::build_stiffness_mat(StiffnessMatrix &stiffness)
 	{
 		igl::Timer timer;
@@ -62,7 +85,7 @@ namespace polyfem
 		const std::string full_mat_path = args["output"]["data"]["full_mat"];
 		if (!full_mat_path.empty())
 		{
-			Eigen::saveMarket(stiffness, full_mat_path);
+			io::write_sparse_matrix(full_mat_path, stiffness);
 		}
 	}
 
@@ -73,6 +96,7 @@ namespace polyfem
 		const bool compute_spectrum,
 		Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
 	{
+		POLYFEM_PROFILE_ZONE("State::solve_linear");
 		assert(assembler->is_linear() && !is_contact_enabled());
 		assert(solve_data.rhs_assembler != nullptr);
 
@@ -92,25 +116,49 @@ namespace polyfem
 			boundary_nodes_tmp = boundary_nodes;
 
 		Eigen::VectorXd x;
+		double error;
 		if (optimization_enabled == solver::CacheLevel::Derivatives)
 		{
 			auto A_tmp = A;
 			prefactorize(*solver, A, boundary_nodes_tmp, precond_num, args["output"]["data"]["stiffness_mat"]);
 			dirichlet_solve_prefactorized(*solver, A_tmp, b, boundary_nodes_tmp, x);
+			error = (A * x - b).norm();
+		}
+		else if (config.static_condensation() && !has_periodic_bc() && full_size == problem_dim * n_bases + (mixed_assembler ? n_pressure_bases + (use_avg_pressure && assembler->is_fluid() ? 1 : 0) : 0))
+		{
+			// solve for the skeleton dofs only, the element-interior ones (velocity and pressure bubbles) are recovered per element
+			assembler::StaticCondensation condensation = mixed_assembler == nullptr
+															 ? assembler::StaticCondensation(bases, n_bases, problem_dim, boundary_nodes_tmp)
+															 : assembler::StaticCondensation(bases, n_bases, problem_dim, pressure_bases, n_pressure_bases, full_size, boundary_nodes_tmp);
+			StiffnessMatrix S;
+			Eigen::VectorXd bs, xs;
+			{
+				POLYFEM_SCOPED_TIMER("Static condensation");
+				condensation.condense(A, b, S, bs);
+			}
+			logger().info("Static condensation: {} skeleton dofs out of {}", condensation.skeleton_size(), condensation.full_size());
+
+			stats.spectrum = dirichlet_solve(
+				*solver, S, bs, condensation.to_skeleton(boundary_nodes_tmp), xs, S.rows(), args["output"]["data"]["stiffness_mat"], compute_spectrum,
+				assembler->is_fluid(), use_avg_pressure);
+			error = (S * xs - bs).norm();
+
+			condensation.expand(xs, x);
 		}
 		else
 		{
 			stats.spectrum = dirichlet_solve(
 				*solver, A, b, boundary_nodes_tmp, x, precond_num, args["output"]["data"]["stiffness_mat"], compute_spectrum,
 				assembler->is_fluid(), use_avg_pressure);
+			error = (A * x - b).norm();
 		}
  		if (has_periodic_bc())
  		{
 			sol = periodic_bc->periodic_to_full(full_size, x);
 			if (args["/boundary_conditions/periodic_boundary/force_zero_mean"_json_pointer].get<bool>())
 			{
-				Eigen::VectorXd integral = Evaluator::integrate_function(bases, geom_bases(), sol, mesh->dimension(), problem_dim);
-				double area = Evaluator::integrate_function(bases, geom_bases(), Eigen::VectorXd::Ones(n_bases), mesh->dimension(), 1)(0);
+				Eigen::VectorXd integral = Evaluator::integrate_function(bases, geom_bases(), ass_vals_cache, sol, mesh->dimension(), problem_dim);
+				double area = Evaluator::integrate_function(bases, geom_bases(), ass_vals_cache, Eigen::VectorXd::Ones(n_bases), mesh->dimension(), 1)(0);
 				for (int d = 0; d < problem_dim; d++)
 					sol(Eigen::seqN(d, n_bases, problem_dim), 0).array() -= integral(d) / area;
 			}
@@ -120,8 +168,6 @@ namespace polyfem
 
 		solver->get_info(stats.solver_info);
 
-		const auto error = (A * x - b).norm();
-
 		if (error > 1e-4)
 			logger().error("Solver error: {}", error);
 		else
@@ -136,28 +182,233 @@ namespace polyfem
 		assert(!problem->is_time_dependent());
 		assert(assembler->is_linear() && !is_contact_enabled());
 
-		// --------------------------------------------------------------------
+		solve_data.rhs_assembler->set_bc(
+			local_boundary, boundary_nodes, n_boundary_samples(),
+			(assembler->name() != "Bilaplacian") ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
+
+		// the factorization is kept for the next load cases, only the Dirichlet lifting and the back substitution are redone
+		const bool keep_factorization = keep_linear_factorization && mixed_assembler == nullptr && !has_periodic_bc()
+										&& optimization_enabled != solver::CacheLevel::Derivatives;
+		if (!keep_factorization)
+		{
+			lin_factorization_valid = false;
+
+			// --------------------------------------------------------------------
+			if (lin_solver_cached)
+				lin_solver_cached.reset();
+
+			lin_solver_cached = create_linear_solver(args);
+			logger().info("{}...", lin_solver_cached->name());
+
+			// --------------------------------------------------------------------
+
+			StiffnessMatrix A;
+			build_stiffness_mat(A);
+			Eigen::VectorXd b = rhs;
+
+			// --------------------------------------------------------------------
+
+			solve_linear(lin_solver_cached, A, b, args["output"]["advanced"]["spectrum"], sol, pressure);
+			return;
+		}
+
+		factorize_linear_stiffness();
+
+		Eigen::VectorXd b = rhs;
+		Eigen::VectorXd x;
+		dirichlet_solve_prefactorized(*lin_solver_cached, lin_stiffness_cached, b, boundary_nodes, x);
+
+		lin_solver_cached->get_info(stats.solver_info);
+		sol = x;
+	}
+
+	void State::factorize_linear_stiffness()
+	{
+		if (lin_factorization_valid)
+		{
+			logger().info("Reusing the factorization of the stiffness...");
+			return;
+		}
+
 		if (lin_solver_cached)
 			lin_solver_cached.reset();
 
-		lin_solver_cached =
-			polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+		lin_solver_cached = create_linear_solver(args);
 		logger().info("{}...", lin_solver_cached->name());
 
-		// --------------------------------------------------------------------
-
-		solve_data.rhs_assembler->set_bc(
-			local_boundary, boundary_nodes, n_boundary_samples(),
-			(assembler->name() != "Bilaplacian") ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
-
 		StiffnessMatrix A;
 		build_stiffness_mat(A);
 
-		Eigen::VectorXd b = rhs;
+		POLYFEM_SCOPED_TIMER("Factorize the stiffness");
+		lin_stiffness_cached = A;
+		prefactorize(*lin_solver_cached, A, boundary_nodes, A.rows(), args["output"]["data"]["stiffness_mat"]);
+		lin_factorization_valid = true;
+	}
 
-		// --------------------------------------------------------------------
+	void State::solve_linear_cases(const Eigen::MatrixXd &rhs_cases, Eigen::MatrixXd &sols)
+	{
+		if (problem->is_time_dependent() || !is_problem_linear())
+			log_and_throw_error("Multiple right-hand sides are only supported for static linear problems!");
+		if (mixed_assembler != nullptr || has_periodic_bc())
+			log_and_throw_error("Multiple right-hand sides are not supported for mixed formulations or periodic boundary conditions!");
+
+		factorize_linear_stiffness();
+		if (rhs_cases.rows() != lin_stiffness_cached.rows())
+			log_and_throw_error("The right-hand sides have {} rows, expected {}!", rhs_cases.rows(), lin_stiffness_cached.rows());
+
+		POLYFEM_SCOPED_TIMER("Solve the right-hand sides");
+		sols.resize(rhs_cases.rows(), rhs_cases.cols());
+		Eigen::VectorXd b, x;
+		for (int c = 0; c < rhs_cases.cols(); ++c)
+		{
+			b = rhs_cases.col(c);
+			dirichlet_solve_prefactorized(*lin_solver_cached, lin_stiffness_cached, b, boundary_nodes, x);
+			sols.col(c) = x;
+		}
 
-		solve_linear(lin_solver_cached, A, b, args["output"]["advanced"]["spectrum"], sol, pressure);
+		lin_solver_cached->get_info(stats.solver_info);
+	}
+
+	void State::solve_frequency_sweep(const std::vector<double> &k_scales, std::vector<Eigen::MatrixXd> &sols)
+	{
+		const auto helmholtz = std::dynamic_pointer_cast<assembler::Helmholtz>(assembler);
+		if (helmholtz == nullptr)
+			log_and_throw_error("Frequency sweeps are only supported for the Helmholtz formulation, not {}!", assembler->name());
+		if (problem->is_time_dependent() || !is_problem_linear())
+			log_and_throw_error("Frequency sweeps are only supported for static linear problems!");
+		if (mixed_assembler != nullptr || has_periodic_bc())
+			log_and_throw_error("Frequency sweeps are not supported for mixed formulations or periodic boundary conditions!");
+
+		assemble_rhs();
+		solve_data.rhs_assembler->set_bc(local_boundary, boundary_nodes, n_boundary_samples(), local_neumann_boundary, rhs);
+
+		// K and M on their common pattern, K - s^2 M has the same pattern for every scale
+		StiffnessMatrix K, M;
+		{
+			POLYFEM_SCOPED_TIMER("Assemble the stiffness and mass of the sweep");
+			helmholtz->set_term(assembler::Helmholtz::Term::Stiffness);
+			assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), ass_vals_cache, 0, K);
+			helmholtz->set_term(assembler::Helmholtz::Term::Mass);
+			assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), ass_vals_cache, 0, M);
+			helmholtz->set_term(assembler::Helmholtz::Term::Full);
+		}
+		const StiffnessMatrix zero = 0 * K + 0 * M;
+		K = zero + K;
+		M = zero + M;
+		assert(K.nonZeros() == M.nonZeros());
+
+		stats.nn_zero = K.nonZeros();
+		stats.num_dofs = K.rows();
+		stats.mat_size = (long long)K.rows() * (long long)K.cols();
+
+		std::vector<bool> is_boundary(K.rows(), false);
+		for (const int i : boundary_nodes)
+			is_boundary[i] = true;
+
+		// the operator of a scale, with the Dirichlet rows replaced by the identity as in prefactorize
+		const auto build_operator = [&](const double s, StiffnessMatrix &A, StiffnessMatrix &A_bc) {
+			A = K;
+			Eigen::Map<Eigen::VectorXd>(A.valuePtr(), A.nonZeros()) -= s * s * Eigen::Map<const Eigen::VectorXd>(M.valuePtr(), M.nonZeros());
+
+			A_bc = A;
+			for (int k = 0; k < A_bc.outerSize(); ++k)
+			{
+				for (StiffnessMatrix::InnerIterator it(A_bc, k); it; ++it)
+				{
+					if (is_boundary[it.row()])
+						it.valueRef() = it.row() == it.col() ? 1 : 0;
+				}
+			}
+		};
+
+		struct LocalSweep
+		{
+			/// symbolic factorization computed on the first scale of the thread, reused for the next ones
+			std::shared_ptr<polysolve::linear::Solver> solver;
+			StiffnessMatrix A, A_bc;
+			Eigen::VectorXd b, x;
+			std::string error;
+		};
+		auto storage = utils::create_thread_storage(LocalSweep());
+
+		logger().info("Frequency sweep of {} wavenumbers...", k_scales.size());
+		POLYFEM_SCOPED_TIMER("Frequency sweep");
+		sols.resize(k_scales.size());
+		utils::maybe_parallel_for(k_scales.size(), [&](int start, int end, int thread_id) {
+			LocalSweep &local = utils::get_local_thread_storage(storage, thread_id);
+			for (int i = start; i < end && local.error.empty(); ++i)
+			{
+				try
+				{
+					build_operator(k_scales[i], local.A, local.A_bc);
+					if (local.solver == nullptr)
+					{
+						local.solver = create_linear_solver(args);
+						local.solver->analyze_pattern(local.A_bc, local.A_bc.rows());
+					}
+					local.solver->factorize(local.A_bc);
+
+					local.b = rhs;
+					dirichlet_solve_prefactorized(*local.solver, local.A, local.b, boundary_nodes, local.x);
+					sols[i] = local.x;
+
+					const double error = (local.A_bc * local.x - rhs).norm();
+					if (error > 1e-4)
+						logger().error("Solver error of the wavenumber scale {}: {}", k_scales[i], error);
+				}
+				catch (const std::exception &e)
+				{
+					local.error = e.what();
+				}
+			}
+		});
+
+		for (const LocalSweep &local : storage)
+		{
+			if (!local.error.empty())
+				log_and_throw_error("Frequency sweep failed: {}", local.error);
+		}
+	}
+
+	void State::solve_modal(Eigen::MatrixXd &sol)
+	{
+		assert(is_problem_linear());
+		if (mixed_assembler != nullptr || has_periodic_bc())
+			log_and_throw_error("Modal analysis is not supported for mixed formulations or periodic boundary conditions!");
+		if (mass.size() == 0)
+			assemble_mass_mat();
+
+		StiffnessMatrix K;
+		build_stiffness_mat(K);
+
+		auto solver = create_linear_solver(args);
+		logger().info("{}...", solver->name());
+
+		{
+			POLYFEM_SCOPED_TIMER("Compute the modes");
+			solver::ModalSolver modal_solver(args["solver"]["modal"]);
+			modal_solver.compute(*solver, K, mass, boundary_nodes);
+			modal_eigenvalues = modal_solver.eigenvalues();
+			modal_shapes = modal_solver.modes();
+		}
+		solver->get_info(stats.solver_info);
+		for (int i = 0; i < modal_eigenvalues.size(); ++i)
+			logger().info("mode {}: eigenvalue {}, frequency {}", i, modal_eigenvalues[i], std::sqrt(std::max(0., modal_eigenvalues[i])) / (2 * M_PI));
+
+		const std::string modes_path = resolve_output_path(args["output"]["data"]["modes"]);
+		if (!modes_path.empty())
+		{
+			Eigen::MatrixXd modes(modal_shapes.rows() + 1, modal_shapes.cols());
+			modes << modal_eigenvalues.transpose(), modal_shapes;
+			write_matrix(modes_path, modes);
+		}
+
+		// the modes are saved as time steps, the time is the index of the mode
+		const Eigen::MatrixXd pressure;
+		for (int i = 0; i < modal_shapes.cols(); ++i)
+			save_timestep(i, i, 0, 1, modal_shapes.col(i), pressure);
+
+		sol = modal_shapes.col(0);
 	}
 
 	void State::init_linear_solve(Eigen::MatrixXd &sol, const double t)
@@ -227,8 +478,7 @@ namespace polyfem
 
 		// --------------------------------------------------------------------
 
-		auto solver =
-			polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+		auto solver = create_linear_solver(args);
 		logger().info("{}...", solver->name());
 
 		// --------------------------------------------------------------------
@@ -270,13 +520,37 @@ namespace polyfem
 		StiffnessMatrix stiffness;
 		build_stiffness_mat(stiffness);
 
+		// The system operator only depends on the time integrator through a scaling (beta dt for BDF, the
+		// acceleration scaling otherwise), which is constant once the BDF warm-up steps are done. Its
+		// factorization is reused while the scaling does not change, a step is then a right-hand side
+		// assembly and a back substitution.
+		const bool reuse_factorization = mixed_assembler == nullptr && !has_periodic_bc() && !config.static_condensation()
+										 && optimization_enabled == solver::CacheLevel::None;
+		// scaling of the operator factorized in solver, NaN if none
+		double factorized_scaling = std::numeric_limits<double>::quiet_NaN();
+		StiffnessMatrix factorized_A;
+
+		// with the modal superposition a step is the diagonal projection of the operator on the modes
+		std::unique_ptr<solver::ModalSolver> modal_solver;
+		if (args["solver"]["modal"]["superposition"])
+		{
+			if (!reuse_factorization)
+				log_and_throw_error("Modal superposition is not supported for mixed formulations, periodic boundary conditions, static condensation, or optimization!");
+
+			POLYFEM_SCOPED_TIMER("Compute the modes");
+			modal_solver = std::make_unique<solver::ModalSolver>(args["solver"]["modal"]);
+			modal_solver->compute(*solver, stiffness, mass, boundary_nodes);
+			modal_eigenvalues = modal_solver->eigenvalues();
+			modal_shapes = modal_solver->modes();
+		}
+
 		// --------------------------------------------------------------------
 		// TODO rebuild stiffnes if material are time dept
 		for (int t = 1; t <= time_steps; ++t)
 		{
 			const double time = t0 + t * dt;
 
-			StiffnessMatrix A;
+			double scaling;
 			Eigen::VectorXd b;
 			bool compute_spectrum = args["output"]["advanced"]["spectrum"];
 
@@ -301,7 +575,7 @@ namespace polyfem
 				}
 
 				std::shared_ptr<BDF> bdf = std::dynamic_pointer_cast<BDF>(time_integrator);
-				A = mass / bdf->beta_dt() + stiffness;
+				scaling = bdf->beta_dt();
 				b = (mass * bdf->weighted_sum_x_prevs()) / bdf->beta_dt();
 				for (int i : boundary_nodes)
 					b[i] = 0;
@@ -324,13 +598,59 @@ namespace polyfem
 				solve_data.rhs_assembler->set_bc(
 					local_boundary, boundary_nodes, n_b_samples, std::vector<LocalBoundary>(), current_rhs, sol, time);
 
-				A = stiffness * time_integrator->acceleration_scaling() + mass;
+				scaling = time_integrator->acceleration_scaling();
 				b = current_rhs;
 
 				compute_spectrum &= t == 1;
 			}
 
-			solve_linear(solver, A, b, compute_spectrum, sol, pressure);
+			const auto build_operator = [&](StiffnessMatrix &A) {
+				if (is_scalar_or_mixed)
+					A = mass / scaling + stiffness;
+				else
+					A = stiffness * scaling + mass;
+			};
+
+			if (modal_solver != nullptr)
+			{
+				for (const int i : boundary_nodes)
+				{
+					if (b[i] != 0)
+						log_and_throw_error("Modal superposition requires homogeneous Dirichlet conditions, the value of dof {} is {} at t={}!", i, b[i], time);
+				}
+
+				Eigen::VectorXd x;
+				if (is_scalar_or_mixed)
+					modal_solver->project_solve(1, 1 / scaling, b, x);
+				else
+					modal_solver->project_solve(scaling, 1, b, x);
+				sol = x;
+			}
+			else if (reuse_factorization && !compute_spectrum)
+			{
+				if (scaling != factorized_scaling)
+				{
+					POLYFEM_SCOPED_TIMER("Factorize the transient operator");
+					StiffnessMatrix A;
+					build_operator(A);
+					factorized_A = A;
+					prefactorize(*solver, A, boundary_nodes, A.rows(), args["output"]["data"]["stiffness_mat"]);
+					factorized_scaling = scaling;
+				}
+
+				Eigen::VectorXd x;
+				dirichlet_solve_prefactorized(*solver, factorized_A, b, boundary_nodes, x);
+				solver->get_info(stats.solver_info);
+				sol = x;
+			}
+			else
+			{
+				StiffnessMatrix A;
+				build_operator(A);
+				solve_linear(solver, A, b, compute_spectrum, sol, pressure);
+				// the solver now holds the factorization of this step
+				factorized_scaling = std::numeric_limits<double>::quiet_NaN();
+			}
 
 			if (optimization_enabled != solver::CacheLevel::None)
 			{
@@ -12,11 +12,37 @@
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
+#include <algorithm>
+#include <limits>
+
 namespace polyfem
 {
 	using namespace solver;
 	using namespace time_integrator;
 
+	namespace
+	{
+		/// largest time step with the Courant number cfl, the speed of an element is its largest nodal velocity
+		double cfl_time_step(const std::vector<basis::ElementBases> &bases, const Eigen::VectorXd &element_sizes, const Eigen::MatrixXd &sol, const int dim, const double cfl)
+		{
+			assert(element_sizes.size() == bases.size());
+
+			double dt = std::numeric_limits<double>::max();
+			for (int e = 0; e < bases.size(); ++e)
+			{
+				double speed = 0;
+				for (const basis::Basis &b : bases[e].bases)
+					for (const auto &g : b.global())
+						speed = std::max(speed, sol.block(g.index * dim, 0, dim, 1).norm());
+
+				if (speed > 0)
+					dt = std::min(dt, cfl * element_sizes(e) / speed);
+			}
+
+			return dt;
+		}
+	} // namespace
+
 	void State::solve_navier_stokes(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
 	{
 		assert(!problem->is_time_dependent());
@@ -181,10 +207,25 @@ namespace polyfem
 
 		Eigen::VectorXd prev_sol;
 
+		// the adaptive step follows the CFL condition of the current velocity until tend
+		const json &adaptive = args["time"]["adaptive"];
+		const bool adaptive_dt = adaptive["enabled"];
+		const double tend = adaptive_dt ? args["time"]["tend"].get<double>() : (t0 + time_steps * dt);
+		const double cfl = adaptive["cfl"];
+		const double dt_min = adaptive["dt_min"].get<double>() > 0 ? adaptive["dt_min"].get<double>() : (dt / 1000);
+		const double dt_max = adaptive["dt_max"].get<double>() > 0 ? adaptive["dt_max"].get<double>() : (100 * dt);
+		const double max_growth = adaptive["max_growth"];
+		if (adaptive_dt && stats.element_sizes.size() != bases.size())
+			log_and_throw_error("CFL time step needs the element sizes, got {} for {} elements!", stats.element_sizes.size(), bases.size());
+
+		double current_dt = dt;
+		if (adaptive_dt && adaptive["initial_dt"].get<double>() > 0)
+			current_dt = std::clamp(adaptive["initial_dt"].get<double>(), dt_min, dt_max);
+
 		BDF time_integrator;
 		if (args["time"]["integrator"].is_object() && args["time"]["integrator"]["type"] == "BDF")
 			time_integrator.set_parameters(args["time"]["integrator"]);
-		time_integrator.init(sol, Eigen::VectorXd::Zero(sol.size()), Eigen::VectorXd::Zero(sol.size()), dt);
+		time_integrator.init(sol, Eigen::VectorXd::Zero(sol.size()), Eigen::VectorXd::Zero(sol.size()), current_dt);
 
 		std::shared_ptr<assembler::Assembler> velocity_stokes_assembler = std::make_shared<assembler::StokesVelocity>();
 		set_materials(*velocity_stokes_assembler);
@@ -199,14 +240,33 @@ namespace polyfem
 
 		const int n_b_samples = n_boundary_samples();
 
-		for (int t = 1; t <= time_steps; ++t)
+		double time = t0;
+		for (int t = 1; adaptive_dt ? (time < tend - 1e-12 * dt) : (t <= time_steps); ++t)
 		{
-			double time = t0 + t * dt;
-			double current_dt = dt;
+			if (adaptive_dt)
+			{
+				double next_dt = std::clamp(std::min(cfl_time_step(bases, stats.element_sizes, sol, mesh->dimension(), cfl), max_growth * current_dt), dt_min, dt_max);
+				// small changes are not worth restarting the history of multi-step integrators
+				if (next_dt > current_dt && next_dt < 1.2 * current_dt)
+					next_dt = current_dt;
+				next_dt = std::min(next_dt, tend - time);
+
+				if (next_dt != current_dt)
+				{
+					current_dt = next_dt;
+					time_integrator.set_dt(current_dt);
+				}
+				time += current_dt;
+			}
+			else
+				time = t0 + t * dt;
 
 			velocity_stokes_assembler->assemble(mesh->is_volume(), n_bases, bases, gbases, ass_vals_cache, time, velocity_stiffness);
 
-			logger().info("{}/{} steps, dt={}s t={}s", t, time_steps, current_dt, time);
+			if (adaptive_dt)
+				logger().info("{} steps, dt={}s t={}s", t, current_dt, time);
+			else
+				logger().info("{}/{} steps, dt={}s t={}s", t, time_steps, current_dt, time);
 
 			prev_sol = time_integrator.weighted_sum_x_prevs();
 			solve_data.rhs_assembler->compute_energy_grad(
@@ -238,7 +298,7 @@ namespace polyfem
 			time_integrator.update_quantities(sol.topRows(n_bases * mesh->dimension()));
 			sol_to_pressure(sol, pressure);
 
-			save_timestep(time, t, t0, dt, sol, pressure);
+			save_timestep(time, t, t0, current_dt, sol, pressure);
 		}
 	}
 } // namespace polyfem
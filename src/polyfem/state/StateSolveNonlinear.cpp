@@ -11,20 +11,31 @@
 #include <polyfem/solver/forms/LaggedRegForm.hpp>
 #include <polyfem/solver/forms/RayleighDampingForm.hpp>
 #include <polyfem/solver/forms/BCLagrangianForm.hpp>
+#include <polyfem/mesh/collision_proxy/CollisionHierarchy.hpp>
 
 #include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/solver/ModalSolver.hpp>
+#include <polyfem/solver/QuasiNewtonSolver.hpp>
+#include <polyfem/solver/ReducedOrderModel.hpp>
 #include <polyfem/solver/ALSolver.hpp>
 #include <polyfem/solver/SolveData.hpp>
+#include <polyfem/time_integrator/CentralDifference.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/io/MshWriter.hpp>
 #include <polyfem/io/OBJWriter.hpp>
 #include <polyfem/io/OutData.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
 #include <polyfem/utils/Timer.hpp>
+#include <polyfem/utils/Profiler.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
 #include <polyfem/utils/BoundarySampler.hpp>
+#include <polyfem/utils/TaskGraph.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <ipc/ipc.hpp>
 
+#include <algorithm>
+
 namespace polyfem
 {
 	using namespace mesh;
@@ -40,13 +51,24 @@ namespace polyfem
 
 	void State::solve_transient_tensor_nonlinear(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
 	{
+		if (args["time"]["adaptive"]["enabled"])
+		{
+			solve_transient_tensor_nonlinear_adaptive(t0, args["time"]["tend"], dt, sol);
+			return;
+		}
+		if (args["time"]["parareal"]["enabled"])
+		{
+			solve_transient_tensor_nonlinear_parareal(time_steps, t0, dt, sol);
+			return;
+		}
+
 		init_nonlinear_tensor_solve(sol, t0 + dt);
 
 		// Write the total energy to a CSV file
 		int save_i = 0;
 		EnergyCSVWriter energy_csv(resolve_output_path("energy.csv"), solve_data);
 		RuntimeStatsCSVWriter stats_csv(resolve_output_path("stats.csv"), *this, t0, dt);
-		const bool remesh_enabled = args["space"]["remesh"]["enabled"];
+		const bool remesh_enabled = config.remesh_enabled();
 		// const double save_dt = remesh_enabled ? (dt / 3) : dt;
 
 		// Save the initial solution
@@ -57,13 +79,57 @@ namespace polyfem
 		if (optimization_enabled != solver::CacheLevel::None)
 			cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
 
+		const bool reduced_order = args["solver"]["reduced_order"]["enabled"];
+		if (reduced_order)
+			init_reduced_order_model();
+		const bool quasi_newton = args["solver"]["quasi_newton"]["enabled"];
+		const auto nl_assembler = std::dynamic_pointer_cast<assembler::NLAssembler>(assembler);
+
+		// the full-order solves and the output integrate over all the elements, the reduced steps over the cubature
+		std::vector<int> sampled_elements;
+		std::vector<double> sampled_weights;
+		const auto set_full_order = [&](const bool full_order) {
+			if (nl_assembler == nullptr || (full_order ? !nl_assembler->has_element_sampling() : sampled_elements.empty()))
+				return;
+			if (full_order)
+			{
+				sampled_elements = nl_assembler->sampled_elements();
+				sampled_weights.clear();
+				for (const int e : sampled_elements)
+					sampled_weights.push_back(nl_assembler->element_weight(e));
+				nl_assembler->set_element_sampling({}, {});
+			}
+			else
+			{
+				nl_assembler->set_element_sampling(sampled_elements, sampled_weights);
+				sampled_elements.clear();
+			}
+			solve_data.elastic_form->element_sampling_changed();
+		};
+
 		for (int t = 1; t <= time_steps; ++t)
 		{
 			double forward_solve_time = 0, remeshing_time = 0, global_relaxation_time = 0;
 
 			{
 				POLYFEM_SCOPED_TIMER(forward_solve_time);
-				solve_tensor_nonlinear(sol, t);
+				predict_solution(sol);
+				if (!reduced_order || !solve_reduced_order_step(sol))
+				{
+					if (reduced_order)
+						logger().warn("Reduced-order step {} failed, solving the full-order problem", t);
+
+					set_full_order(true);
+
+					if (!quasi_newton || !solve_quasi_newton_step(sol))
+					{
+						if (quasi_newton)
+							logger().debug("Quasi-Newton step {} failed, solving with the nonlinear solver", t);
+						solve_tensor_nonlinear(sol, t);
+					}
+
+					set_full_order(false);
+				}
 			}
 
 			if (remesh_enabled)
@@ -91,48 +157,490 @@ namespace polyfem
 				}
 			}
 
+			// the output and the adjoint cache read the forms and the time integrator before their update,
+			// the rest mesh only reads the mesh and overlaps with all of them
+			TaskGraph step_graph(args["solver"]["advanced"]["task_graph"]);
+
 			// Always save the solution for consistency
-			energy_csv.write(save_i, sol);
-			save_timestep(t0 + dt * t, t, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+			const int output_task = step_graph.add([&, save_i] {
+				// the energies and forces of the full-order model, not of the cubature
+				set_full_order(true);
+				energy_csv.write(save_i, sol);
+				save_timestep(t0 + dt * t, t, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+				set_full_order(false);
+			});
 			save_i++;
 
+			int adjoint_task = output_task;
 			if (optimization_enabled != solver::CacheLevel::None)
 			{
-				cache_transient_adjoint_quantities(t, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
+				adjoint_task = step_graph.add(
+					[&] { cache_transient_adjoint_quantities(t, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension())); },
+					{output_task});
+			}
+
+			const int update_task = step_graph.add(
+				[&] {
+					POLYFEM_SCOPED_TIMER("Update quantities");
+
+					solve_data.time_integrator->update_quantities(sol);
+
+					solve_data.nl_problem->update_quantities(t0 + (t + 1) * dt, sol);
+
+					solve_data.update_dt();
+					solve_data.update_barrier_stiffness(sol);
+				},
+				{adjoint_task});
+
+			const std::string rest_mesh_path = args["output"]["data"]["rest_mesh"].get<std::string>();
+			if (!rest_mesh_path.empty())
+			{
+				step_graph.add([&] {
+					Eigen::MatrixXd V;
+					Eigen::MatrixXi F;
+					build_mesh_matrices(V, F);
+					io::MshWriter::write(
+						resolve_output_path(fmt::format(args["output"]["data"]["rest_mesh"], t)),
+						V, F, mesh->get_body_ids(), mesh->is_volume(), /*binary=*/true);
+				});
+			}
+
+			step_graph.add([&] { save_checkpoint(t0 + dt * t, dt, t); }, {update_task});
+			step_graph.run();
+
+			logger().info("{}/{}  t={}", t, time_steps, t0 + dt * t);
+			if (remesh_enabled)
+				stats_csv.write(t, forward_solve_time, remeshing_time, global_relaxation_time, sol);
+		}
+
+		set_full_order(true);
+	}
+
+	void State::predict_solution(Eigen::MatrixXd &sol) const
+	{
+		const std::string predictor = args["time"]["predictor"];
+		if (predictor == "previous" || solve_data.time_integrator == nullptr)
+			return;
+
+		Eigen::VectorXd prediction = solve_data.time_integrator->predict(predictor == "constant_velocity" ? 1 : 2);
+		assert(prediction.size() == sol.size());
+
+		// leave the new boundary conditions to the solver
+		for (const int i : boundary_nodes)
+			prediction[i] = sol(i);
+
+		if (solve_data.elastic_form != nullptr && !solve_data.elastic_form->is_step_valid(sol, prediction))
+			return;
+
+		if (solve_data.contact_form != nullptr)
+		{
+			POLYFEM_SCOPED_TIMER("Clamp prediction");
+			const double alpha = solve_data.contact_form->max_step_size(sol, prediction);
+			// stop short of the impact so that the initial guess keeps a positive distance
+			if (alpha < 1)
+				prediction = sol + 0.8 * alpha * (prediction - sol);
+		}
+
+		sol = prediction;
+	}
+
+	void State::solve_transient_tensor_nonlinear_adaptive(const double t0, const double tend, const double dt, Eigen::MatrixXd &sol)
+	{
+		if (config.remesh_enabled() || optimization_enabled != solver::CacheLevel::None)
+			log_and_throw_error("Adaptive time stepping does not support remeshing or optimization!");
+
+		const json &params = args["time"]["adaptive"];
+		const double tol = params["tolerance"];
+		const double dt_min = params["dt_min"].get<double>() > 0 ? params["dt_min"].get<double>() : (dt / 1000);
+		const double dt_max = params["dt_max"].get<double>() > 0 ? params["dt_max"].get<double>() : (100 * dt);
+		const double max_growth = params["max_growth"];
+		const double failure_shrink = params["failure_shrink"];
+		// displacement below which the error is measured in absolute terms
+		const double min_displacement = 1e-3 * starting_min_edge_length;
+
+		init_nonlinear_tensor_solve(sol, t0 + dt);
+		assert(solve_data.time_integrator != nullptr);
+
+		EnergyCSVWriter energy_csv(resolve_output_path("energy.csv"), solve_data);
+
+		energy_csv.write(0, sol);
+		save_timestep(t0, 0, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+
+		// restart the step from sol at time t with the step size h
+		const auto set_step = [&](const double t, const double h) {
+			solve_data.time_integrator->set_dt(h);
+			solve_data.nl_problem->update_quantities(t + h, sol);
+			solve_data.update_dt();
+		};
+
+		double t = t0;
+		const double initial_dt = params["initial_dt"];
+		double h = std::clamp(initial_dt > 0 ? initial_dt : dt, dt_min, dt_max);
+		int rejected = 0;
+		for (int step = 1; t < tend - 1e-12 * dt; ++step)
+		{
+			if (t + h > tend)
+				set_step(t, tend - t);
+			else if (h != solve_data.time_integrator->dt())
+				set_step(t, h);
+			h = solve_data.time_integrator->dt();
+
+			const ImplicitTimeIntegrator &integrator = *solve_data.time_integrator;
+			const Eigen::VectorXd x_pred = integrator.predict(2);
+
+			const Eigen::MatrixXd prev_sol = sol;
+			double error = 0;
+			bool success = true;
+			try
+			{
+				predict_solution(sol);
+				solve_tensor_nonlinear(sol, step);
+			}
+			catch (const std::runtime_error &e)
+			{
+				if (h <= dt_min)
+					throw;
+				logger().warn("Time step t={} with dt={} failed ({}), retrying with a smaller step", t + h, h, e.what());
+				success = false;
 			}
 
+			if (success)
+			{
+				// the difference with the second order prediction is dominated by the local truncation error
+				const double displacement = (sol - integrator.x_prev()).lpNorm<Eigen::Infinity>();
+				error = (sol - x_pred).lpNorm<Eigen::Infinity>() / (tol * std::max(displacement, min_displacement));
+			}
+
+			if (!success || (error > 1 && h > dt_min))
+			{
+				if (success)
+					logger().debug("Rejected time step t={} with dt={} (error={:g})", t + h, h, error);
+				++rejected;
+				sol = prev_sol;
+				const double factor = success ? std::max(failure_shrink, 0.9 / std::sqrt(error)) : failure_shrink;
+				set_step(t, std::max(h * std::min(factor, 0.9), dt_min));
+				--step;
+				continue;
+			}
+
+			t += h;
+
+			energy_csv.write(step, sol);
+			save_timestep(t, step, t0, h, sol, Eigen::MatrixXd()); // no pressure
+
+			double next_h = std::clamp(h * std::min(max_growth, 0.9 / std::sqrt(std::max(error, 1e-12))), dt_min, dt_max);
+			// small changes are not worth restarting the history of multi-step integrators
+			if (next_h > h && next_h < 1.2 * h)
+				next_h = h;
 			{
 				POLYFEM_SCOPED_TIMER("Update quantities");
 
 				solve_data.time_integrator->update_quantities(sol);
+				set_step(t, next_h);
+				solve_data.update_barrier_stiffness(sol);
+			}
+
+			logger().info("{}  t={} dt={} (error={:g}, {} rejected)", step, t, h, error, rejected);
 
-				solve_data.nl_problem->update_quantities(t0 + (t + 1) * dt, sol);
+			save_checkpoint(t, next_h, step);
+		}
+	}
+
+	namespace
+	{
+		/// state of the time integrator at a slice boundary of parareal
+		struct SliceState
+		{
+			Eigen::VectorXd x, v, a;
+		};
 
+		/// restarts the time integrator of state from start at time t and takes n_steps steps of size h
+		/// @param[out] trajectory (optional) state after every step
+		SliceState propagate(State &state, const SliceState &start, const double t, const double h, const int n_steps, std::vector<SliceState> *trajectory)
+		{
+			SolveData &solve_data = state.solve_data;
+			ImplicitTimeIntegrator &integrator = *solve_data.time_integrator;
+			integrator.init(start.x, start.v, start.a, h);
+
+			Eigen::MatrixXd sol = start.x;
+			solve_data.nl_problem->update_quantities(t + h, sol);
+			solve_data.update_dt();
+			solve_data.update_barrier_stiffness(sol);
+
+			if (trajectory != nullptr)
+				trajectory->clear();
+			for (int i = 1; i <= n_steps; ++i)
+			{
+				state.predict_solution(sol);
+				state.solve_tensor_nonlinear(sol, i);
+
+				integrator.update_quantities(sol);
+				solve_data.nl_problem->update_quantities(t + (i + 1) * h, sol);
 				solve_data.update_dt();
 				solve_data.update_barrier_stiffness(sol);
+
+				if (trajectory != nullptr)
+					trajectory->push_back({sol, integrator.v_prev(), integrator.a_prev()});
 			}
 
-			logger().info("{}/{}  t={}", t, time_steps, t0 + dt * t);
+			return {sol, integrator.v_prev(), integrator.a_prev()};
+		}
+	} // namespace
 
-			const std::string rest_mesh_path = args["output"]["data"]["rest_mesh"].get<std::string>();
-			if (!rest_mesh_path.empty())
+	void State::solve_transient_tensor_nonlinear_parareal(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
+	{
+		if (config.remesh_enabled() || optimization_enabled != solver::CacheLevel::None)
+			log_and_throw_error("Parareal does not support remeshing or optimization!");
+
+		const json &params = args["time"]["parareal"];
+		const int n_slices = std::min(time_steps, params["n_slices"].get<int>() > 0 ? params["n_slices"].get<int>() : int(utils::get_n_threads()));
+		const int coarse_steps = params["coarse_steps"];
+		const int max_iterations = params["max_iterations"].get<int>() > 0 ? std::min(params["max_iterations"].get<int>(), n_slices) : n_slices;
+		const double tol = params["tolerance"];
+
+		init_nonlinear_tensor_solve(sol, t0 + dt);
+		assert(solve_data.time_integrator != nullptr);
+		// the slices restart the integrator from a single previous state
+		if (solve_data.time_integrator->max_steps() > 1)
+			log_and_throw_error("Parareal needs a one-step time integrator, got {} steps!", solve_data.time_integrator->max_steps());
+
+		// first time step of every slice, the slice n has the steps first_step[n] + 1 to first_step[n + 1]
+		std::vector<int> first_step(n_slices + 1);
+		for (int n = 0; n <= n_slices; ++n)
+			first_step[n] = int((long(n) * time_steps) / n_slices);
+		const auto slice_steps = [&](const int n) { return first_step[n + 1] - first_step[n]; };
+		const auto slice_start = [&](const int n) { return t0 + first_step[n] * dt; };
+
+		// one copy of the state per worker, with its own mesh, bases, forms and solvers
+		const int n_workers = std::min<int>(n_slices, utils::get_n_threads());
+		std::vector<std::unique_ptr<State>> workers(n_workers);
+		{
+			POLYFEM_SCOPED_TIMER("Initialize parareal workers");
+			// the workers must not replace the log file of the state
+			json worker_args = args;
+			worker_args["time"]["parareal"]["enabled"] = false;
+			worker_args["output"]["log"]["path"] = "";
+			worker_args["output"]["log"]["quiet"] = true;
+			for (std::unique_ptr<State> &worker : workers)
 			{
-				Eigen::MatrixXd V;
-				Eigen::MatrixXi F;
-				build_mesh_matrices(V, F);
-				io::MshWriter::write(
-					resolve_output_path(fmt::format(args["output"]["data"]["rest_mesh"], t)),
-					V, F, mesh->get_body_ids(), mesh->is_volume(), /*binary=*/true);
+				worker = std::make_unique<State>();
+				worker->init(worker_args, false);
+				worker->mesh = mesh->copy();
+				worker->load_mesh();
+				worker->build_basis();
+				worker->assemble_rhs();
+				worker->assemble_mass_mat();
+
+				Eigen::MatrixXd worker_sol, worker_pressure;
+				worker->init_solve(worker_sol, worker_pressure);
+				worker->init_nonlinear_tensor_solve(worker_sol, t0 + dt);
 			}
 
-			const std::string &state_path = resolve_output_path(fmt::format(args["output"]["data"]["state"], t));
-			if (!state_path.empty())
-				solve_data.time_integrator->save_state(state_path);
+			// State::init replaced the global logger
+			std::vector<spdlog::sink_ptr> sinks;
+			if (console_sink_)
+				sinks.push_back(console_sink_);
+			if (file_sink_)
+				sinks.push_back(file_sink_);
+			init_logger(sinks, args["output"]["log"]["level"], args["output"]["log"]["async"]);
+		}
 
-			// save restart file
-			save_restart_json(t0, dt, t);
-			if (remesh_enabled)
-				stats_csv.write(t, forward_solve_time, remeshing_time, global_relaxation_time, sol);
+		// displacement below which the error is measured in absolute terms
+		const double min_displacement = 1e-3 * starting_min_edge_length;
+		const auto change = [&](const SliceState &a, const SliceState &b, const int n) {
+			const double scale = std::max(a.x.lpNorm<Eigen::Infinity>(), min_displacement);
+			const double dx = (a.x - b.x).lpNorm<Eigen::Infinity>();
+			const double dv = slice_steps(n) * dt * (a.v - b.v).lpNorm<Eigen::Infinity>();
+			return std::max(dx, dv) / scale;
+		};
+
+		const auto coarse = [&](const int n, const SliceState &start) {
+			const int steps = std::min(coarse_steps, slice_steps(n));
+			return propagate(*this, start, slice_start(n), slice_steps(n) * dt / steps, steps, nullptr);
+		};
+
+		// initial coarse sweep
+		std::vector<SliceState> U(n_slices + 1), G(n_slices), F(n_slices);
+		U[0] = {sol, solve_data.time_integrator->v_prev(), solve_data.time_integrator->a_prev()};
+		{
+			POLYFEM_SCOPED_TIMER("Parareal coarse sweep");
+			for (int n = 0; n < n_slices; ++n)
+			{
+				G[n] = coarse(n, U[n]);
+				U[n + 1] = G[n];
+			}
+		}
+
+		std::vector<std::vector<SliceState>> trajectories(n_slices);
+		for (int k = 0; k < max_iterations; ++k)
+		{
+			// the slices before k are converged, the fine steps of the others run in parallel
+			{
+				POLYFEM_SCOPED_TIMER("Parareal fine propagation");
+				const int n_active = n_slices - k;
+				utils::maybe_parallel_for(std::min(n_workers, n_active), [&](int start, int end, int thread_id) {
+					for (int w = start; w < end; ++w)
+					{
+						for (int n = k + w; n < n_slices; n += n_workers)
+							F[n] = propagate(*workers[w], U[n], slice_start(n), dt, slice_steps(n), &trajectories[n]);
+					}
+				});
+			}
+
+			// sequential correction U[n + 1] = G(U[n]) + F(U_old[n]) - G(U_old[n]), the slice k is now exact
+			double error = 0;
+			{
+				POLYFEM_SCOPED_TIMER("Parareal coarse correction");
+				for (int n = k; n < n_slices; ++n)
+				{
+					SliceState next = F[n];
+					if (n > k)
+					{
+						const SliceState g = coarse(n, U[n]);
+						next.x += g.x - G[n].x;
+						next.v += g.v - G[n].v;
+						next.a += g.a - G[n].a;
+						G[n] = g;
+					}
+					error = std::max(error, change(next, U[n + 1], n));
+					U[n + 1] = next;
+				}
+			}
+
+			logger().info("Parareal iteration {}/{}: change {:g}", k + 1, max_iterations, error);
+			if (error <= tol)
+				break;
+		}
+
+		// the fine trajectories are saved in order, the integrator of the state holds the saved step for the output
+		EnergyCSVWriter energy_csv(resolve_output_path("energy.csv"), solve_data);
+		energy_csv.write(0, sol);
+		save_timestep(t0, 0, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+		for (int n = 0; n < n_slices; ++n)
+		{
+			for (int i = 0; i < trajectories[n].size(); ++i)
+			{
+				const int t = first_step[n] + i + 1;
+				const SliceState &step = trajectories[n][i];
+				sol = step.x;
+				solve_data.time_integrator->init(step.x, step.v, step.a, dt);
+				solve_data.nl_problem->update_quantities(t0 + t * dt, sol);
+				solve_data.update_dt();
+
+				energy_csv.write(t, sol);
+				save_timestep(t0 + t * dt, t, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+				logger().info("{}/{}  t={}", t, time_steps, t0 + dt * t);
+			}
+		}
+	}
+
+	bool State::is_time_integrator_explicit() const
+	{
+		if (!problem->is_time_dependent() || problem->is_scalar() || mixed_assembler != nullptr)
+			return false;
+		const json &integrator = args["time"]["integrator"];
+		const std::string type = integrator.is_object() ? integrator["type"] : integrator;
+		return type == "CentralDifference";
+	}
+
+	void State::solve_transient_tensor_explicit(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
+	{
+		assert(sol.cols() == 1);
+		assert(solve_data.rhs_assembler != nullptr);
+
+		if (is_contact_enabled())
+			log_and_throw_error("Explicit time integration does not support contact!");
+
+		const int ndof = n_bases * mesh->dimension();
+		if (sol.size() != ndof)
+			log_and_throw_error("Explicit time integration does not support obstacles!");
+
+		solve_data.time_integrator = nullptr;
+
+		CentralDifference integrator;
+		if (args["time"]["integrator"].is_object())
+			integrator.set_parameters(args["time"]["integrator"]);
+
+		ElasticForm elastic_form(
+			n_bases, bases, geom_bases(), *assembler, ass_vals_cache,
+			t0, dt, mesh->is_volume());
+		BodyForm body_form(
+			ndof, n_pressure_bases, boundary_nodes, local_boundary,
+			local_neumann_boundary, n_boundary_samples(), rhs, *solve_data.rhs_assembler,
+			mass_matrix_assembler->density(), /*apply_DBC=*/false, /*is_formulation_mixed=*/false,
+			/*is_time_dependent=*/true);
+		body_form.update_quantities(t0, sol);
+
+		// external forces are updated once per time step, internal ones at every substep
+		Eigen::VectorXd external_forces;
+		const CentralDifference::Forces forces = [&](const Eigen::VectorXd &x, Eigen::VectorXd &f) {
+			elastic_form.first_derivative(x, f);
+			f = external_forces - f;
+		};
+		const CentralDifference::Stiffness stiffness = [&](const Eigen::VectorXd &v, Eigen::VectorXd &Kv) {
+			elastic_form.apply_hessian(integrator.x(), v, Kv);
+		};
+
+		const auto boundary_values = [&](const double t) {
+			Eigen::MatrixXd values = Eigen::MatrixXd::Zero(ndof, 1);
+			solve_data.rhs_assembler->set_bc(
+				local_boundary, boundary_nodes, n_boundary_samples(),
+				std::vector<LocalBoundary>(), values, Eigen::MatrixXd(), t);
+			return Eigen::VectorXd(values);
+		};
+
+		Eigen::MatrixXd velocity;
+		initial_velocity(velocity);
+		assert(velocity.rows() == sol.size());
+
+		{
+			POLYFEM_SCOPED_TIMER("Initialize time integrator");
+			body_form.first_derivative(sol, external_forces);
+			external_forces *= -1;
+			integrator.init(
+				sol, velocity.col(0), CentralDifference::lump_mass(mass, integrator.lumping()),
+				boundary_nodes, forces);
+		}
+
+		save_timestep(t0, 0, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+
+		Eigen::VectorXd start_values = boundary_values(t0);
+		for (int t = 1; t <= time_steps; ++t)
+		{
+			const double t1 = t0 + dt * t;
+
+			body_form.update_quantities(t1 - dt, integrator.x());
+			body_form.first_derivative(integrator.x(), external_forces);
+			external_forces *= -1;
+
+			// the stiffness changes with the deformation for nonlinear materials
+			double stable_dt;
+			{
+				POLYFEM_SCOPED_TIMER("Estimate stable time step");
+				stable_dt = integrator.stable_dt(stiffness);
+			}
+			const int substeps = std::max(1, int(std::ceil(dt / stable_dt)));
+			const double h = dt / substeps;
+
+			// interpolate the Dirichlet values within the time step
+			const Eigen::VectorXd end_values = boundary_values(t1);
+			{
+				POLYFEM_SCOPED_TIMER("Explicit time steps");
+				for (int s = 1; s <= substeps; ++s)
+				{
+					const double alpha = double(s) / substeps;
+					integrator.step(h, (1 - alpha) * start_values + alpha * end_values, forces);
+				}
+			}
+			start_values = end_values;
+
+			sol = integrator.x();
+			if (!std::isfinite(sol.norm()))
+				log_and_throw_error("Explicit time integration diverged at t={}!", t1);
+
+			save_timestep(t1, t, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+
+			logger().info("{}/{}  t={} ({} substeps of {})", t, time_steps, t1, substeps, h);
 		}
 	}
 
@@ -260,7 +768,37 @@ namespace polyfem
 			form->set_output_dir(output_dir);
 
 		if (solve_data.contact_form != nullptr)
+		{
 			solve_data.contact_form->save_ccd_debug_meshes = args["output"]["advanced"]["save_ccd_debug_meshes"];
+			solve_data.contact_form->set_incremental_slack(args["solver"]["contact"]["incremental_slack"]);
+
+			const int cluster_size = args["solver"]["contact"]["cluster_size"];
+			if (cluster_size > 0)
+				solve_data.contact_form->set_collision_hierarchy(std::make_shared<mesh::CollisionHierarchy>(collision_mesh, cluster_size));
+
+			// the plane obstacles are analytic half-spaces, they are not part of the collision mesh
+			const std::vector<mesh::Obstacle::Plane> &planes = obstacle.planes();
+			if (!planes.empty())
+			{
+				Eigen::MatrixXd points(planes.size(), mesh->dimension()), normals(planes.size(), mesh->dimension());
+				for (int p = 0; p < planes.size(); ++p)
+				{
+					points.row(p) = planes[p].point().transpose();
+					normals.row(p) = planes[p].normal().transpose();
+				}
+				solve_data.contact_form->set_planes(points, normals, obstacle.n_vertices());
+			}
+		}
+
+		if (solve_data.friction_form != nullptr)
+			solve_data.friction_form->set_relinearization_tolerance(args["solver"]["contact"]["friction_relinearization_tol"]);
+
+		if (solve_data.elastic_form != nullptr)
+		{
+			solve_data.elastic_form->set_hessian_storage(args["solver"]["advanced"]["block_hessian"], args["solver"]["advanced"]["symmetric_hessian"]);
+			// the output of the converged solution reuses the last evaluation of the solver
+			solve_data.elastic_form->set_cache_evaluations(args["output"]["paraview"]["options"]["elastic_energy"].get<bool>() || args["output"]["paraview"]["options"]["forces"]);
+		}
 
 		// --------------------------------------------------------------------
 		// Initialize nonlinear problems
@@ -271,13 +809,302 @@ namespace polyfem
 			*solve_data.rhs_assembler, periodic_bc, t, forms);
 		solve_data.nl_problem->init(sol);
 		solve_data.nl_problem->update_quantities(t, sol);
+		// the contact and friction hessians change too fast to be frozen
+		solve_data.nl_problem->set_frozen_hessian(
+			args["solver"]["advanced"]["frozen_hessian_iterations"],
+			args["solver"]["advanced"]["frozen_hessian_refresh_ratio"],
+			{solve_data.elastic_form, solve_data.damping_form});
+		solve_data.nl_problem->set_concurrent_forms(args["solver"]["advanced"]["task_graph"]);
+		solve_data.nl_problem->set_fused_assembly(args["solver"]["advanced"]["fused_assembly"]);
 		// --------------------------------------------------------------------
 
 		stats.solver_info = json::array();
+		stats.solver_info_summary = json::object();
+		const json &solver_info_args = args["output"]["advanced"]["solver_info"];
+		const std::string solver_info_path = solver_info_args["file"];
+		stats.set_solver_info_stream(
+			solver_info_path.empty() ? "" : resolve_output_path(solver_info_path),
+			solver_info_args["max_entries"]);
+	}
+
+	namespace
+	{
+		/// damped Newton on the span of phi (basis restricted to the free dofs), x is projected on it
+		/// @return false if the reduced Newton did not converge
+		bool reduced_newton(NLProblem &nl_problem, const Eigen::MatrixXd &phi, const int max_iterations, const double tolerance, Eigen::VectorXd &x)
+		{
+			// least-squares projection of the initial guess
+			Eigen::VectorXd q = phi.colPivHouseholderQr().solve(x);
+			x = phi * q;
+
+			nl_problem.solution_changed(x);
+			double energy = nl_problem.value(x);
+			if (!std::isfinite(energy) || !nl_problem.is_step_valid(x, x))
+				return false;
+
+			Eigen::VectorXd grad, x1;
+			StiffnessMatrix hessian;
+			double initial_grad_norm = 0;
+			int iter = 0;
+			for (; iter < max_iterations; ++iter)
+			{
+				nl_problem.gradient(x, grad);
+				const Eigen::VectorXd reduced_grad = phi.transpose() * grad;
+				const double grad_norm = reduced_grad.norm();
+				if (iter == 0)
+					initial_grad_norm = grad_norm;
+				if (grad_norm <= tolerance * initial_grad_norm)
+				{
+					logger().debug("Reduced-order solve with {} modes converged in {} iteration(s)", phi.cols(), iter);
+					nl_problem.solution_changed(x);
+					return true;
+				}
+
+				nl_problem.hessian(x, hessian);
+				const Eigen::MatrixXd reduced_hessian = phi.transpose() * (hessian * phi);
+				Eigen::VectorXd dq = reduced_hessian.ldlt().solve(-reduced_grad);
+				if (!dq.allFinite() || reduced_grad.dot(dq) >= 0)
+					dq = -reduced_grad;
+
+				// backtracking (Armijo) line search in the reduced space
+				bool decreased = false;
+				for (double alpha = 1; alpha > 1e-6; alpha /= 2)
+				{
+					x1 = phi * (q + alpha * dq);
+					if (!nl_problem.is_step_valid(x, x1))
+						continue;
+
+					nl_problem.solution_changed(x1);
+					const double energy1 = nl_problem.value(x1);
+					if (std::isfinite(energy1) && energy1 <= energy + 1e-4 * alpha * reduced_grad.dot(dq))
+					{
+						q += alpha * dq;
+						x = x1;
+						energy = energy1;
+						decreased = true;
+						break;
+					}
+				}
+
+				if (!decreased)
+					break;
+			}
+
+			logger().debug("Reduced-order solve with {} modes did not converge in {} iteration(s)", phi.cols(), iter);
+			return false;
+		}
+	} // namespace
+
+	bool State::solve_reduced_order(const Eigen::MatrixXd &basis, const int max_iterations, const double tolerance, Eigen::MatrixXd &sol)
+	{
+		// contact needs the CCD of the full solver, and transient or mixed problems are not reduced
+		if (basis.cols() == 0 || problem->is_time_dependent() || problem->is_scalar() || assembler->is_linear()
+			|| mixed_assembler != nullptr || is_contact_enabled() || is_homogenization() || assembler->name() == "NavierStokes")
+			return false;
+		assert(basis.rows() == ndof());
+
+		POLYFEM_SCOPED_TIMER("Reduced-order solve");
+
+		Eigen::MatrixXd pressure;
+		init_solve(sol, pressure);
+		init_nonlinear_tensor_solve(sol);
+
+		NLProblem &nl_problem = *(solve_data.nl_problem);
+		if (nl_problem.uses_lagging())
+			return false;
+
+		// basis restricted to the free dofs, the boundary conditions are imposed by reduced_to_full
+		Eigen::MatrixXd phi(nl_problem.reduced_size(), basis.cols());
+		for (int i = 0; i < basis.cols(); ++i)
+			phi.col(i) = nl_problem.full_to_reduced(basis.col(i));
+
+		Eigen::VectorXd x = nl_problem.full_to_reduced(sol);
+		if (!reduced_newton(nl_problem, phi, max_iterations, tolerance, x))
+			return false;
+
+		sol = nl_problem.reduced_to_full(x);
+
+		if (optimization_enabled != solver::CacheLevel::None)
+			cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
+
+		return true;
+	}
+
+	void State::init_reduced_order_model()
+	{
+		const json &params = args["solver"]["reduced_order"];
+		const std::shared_ptr<assembler::NLAssembler> nl_assembler = std::dynamic_pointer_cast<assembler::NLAssembler>(assembler);
+		if (nl_assembler == nullptr || problem->is_scalar() || mixed_assembler != nullptr || is_contact_enabled() || has_periodic_bc())
+			log_and_throw_error("Reduced-order models are only supported for hyperelastic problems without contact, got {}!", assembler->name());
+		assert(solve_data.elastic_form != nullptr);
+
+		POLYFEM_SCOPED_TIMER("Build the reduced-order model");
+		if (nl_assembler->has_element_sampling())
+		{
+			nl_assembler->set_element_sampling({}, {});
+			solve_data.elastic_form->element_sampling_changed();
+		}
+
+		const std::string basis_type = params["basis"];
+		Eigen::MatrixXd snapshots;
+		if (!params["snapshots"].get<std::string>().empty() && !read_matrix(resolve_input_path(params["snapshots"]), snapshots))
+			log_and_throw_error("Unable to read the snapshots {}!", params["snapshots"].get<std::string>());
+		if (snapshots.size() > 0 && snapshots.rows() != ndof())
+			log_and_throw_error("The snapshots have {} rows, expected {}!", snapshots.rows(), ndof());
+
+		if (basis_type == "file")
+		{
+			if (!read_matrix(resolve_input_path(params["basis_file"]), reduced_order_basis))
+				log_and_throw_error("Unable to read the reduced basis {}!", params["basis_file"].get<std::string>());
+			if (reduced_order_basis.rows() != ndof())
+				log_and_throw_error("The reduced basis has {} rows, expected {}!", reduced_order_basis.rows(), ndof());
+		}
+		else if (basis_type == "pod")
+		{
+			if (snapshots.size() == 0)
+				log_and_throw_error("A POD basis needs snapshots!");
+			reduced_order_basis = solver::pod_basis(snapshots, params["pod_tolerance"]);
+		}
+		else
+		{
+			// linear modes of the rest configuration, with the settings of solver/modal
+			const Eigen::VectorXd rest = Eigen::VectorXd::Zero(ndof());
+			StiffnessMatrix K;
+			solve_data.elastic_form->second_derivative(rest, K);
+
+			auto solver = polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+			solver::ModalSolver modal_solver(args["solver"]["modal"]);
+			modal_solver.compute(*solver, K, mass, boundary_nodes);
+			reduced_order_basis = modal_solver.modes();
+
+			if (basis_type == "modes_and_derivatives")
+			{
+				// modal derivatives -(K - shift M)^-1 (dK/dphi_j) phi_i, with finite differences of the hessian,
+				// the factorization of the modal solver is reused
+				const Eigen::MatrixXd modes = modal_solver.modes();
+				RowVectorNd min, max;
+				mesh->bounding_box(min, max);
+				const double diameter = (max - min).norm();
+
+				Eigen::MatrixXd derivatives(ndof(), modes.cols() * (modes.cols() + 1) / 2);
+				int k = 0;
+				StiffnessMatrix Kp, Km;
+				Eigen::VectorXd rhs_i, psi(ndof());
+				for (int j = 0; j < modes.cols(); ++j)
+				{
+					const double eps = 1e-6 * diameter / std::max(modes.col(j).cwiseAbs().maxCoeff(), 1e-30);
+					solve_data.elastic_form->second_derivative(eps * modes.col(j), Kp);
+					solve_data.elastic_form->second_derivative(-eps * modes.col(j), Km);
+					const StiffnessMatrix dK = (Kp - Km) / (2 * eps);
+
+					for (int i = 0; i <= j; ++i)
+					{
+						rhs_i = -(dK * modes.col(i));
+						for (const int b : boundary_nodes)
+							rhs_i[b] = 0;
+						solver->solve(rhs_i, psi);
+						for (const int b : boundary_nodes)
+							psi[b] = 0;
+						derivatives.col(k++) = psi;
+					}
+				}
+
+				Eigen::MatrixXd basis(ndof(), modes.cols() + derivatives.cols());
+				basis << modes, derivatives;
+				reduced_order_basis = basis;
+			}
+		}
+
+		if (params["max_modes"].get<int>() > 0 && reduced_order_basis.cols() > params["max_modes"].get<int>())
+			reduced_order_basis.conservativeResize(Eigen::NoChange, params["max_modes"].get<int>());
+		reduced_order_basis = solver::orthonormalize(reduced_order_basis);
+		if (reduced_order_basis.cols() == 0)
+			log_and_throw_error("The reduced basis is empty!");
+		logger().info("Reduced-order model with {} modes", reduced_order_basis.cols());
+
+		const json &cubature = params["cubature"];
+		if (!cubature["enabled"])
+			return;
+		if (snapshots.size() == 0)
+			log_and_throw_error("The cubature of the reduced-order model needs snapshots!");
+
+		// reduced elastic forces of every element for every snapshot, the sampled elements reproduce their sum
+		const int r = reduced_order_basis.cols();
+		const int n_elements = bases.size();
+		Eigen::MatrixXd C(snapshots.cols() * r, n_elements);
+		const double t0 = args["time"]["t0"];
+		const double dt = args["time"]["dt"];
+		for (int s = 0; s < snapshots.cols(); ++s)
+		{
+			C.middleRows(s * r, r) = nl_assembler->assemble_reduced_gradient_per_element(
+											  mesh->is_volume(), bases, geom_bases(), ass_vals_cache, t0, dt,
+											  snapshots.col(s), snapshots.col(s), reduced_order_basis)
+										  .transpose();
+		}
+
+		std::vector<int> elements;
+		std::vector<double> weights;
+		solver::cubature_weights(C, cubature["tolerance"], cubature["max_elements"], elements, weights);
+		nl_assembler->set_element_sampling(elements, weights);
+		solve_data.elastic_form->element_sampling_changed();
+		logger().info("Reduced-order cubature with {}/{} elements", elements.size(), n_elements);
+	}
+
+	bool State::solve_reduced_order_step(Eigen::MatrixXd &sol)
+	{
+		NLProblem &nl_problem = *(solve_data.nl_problem);
+		if (nl_problem.uses_lagging())
+			return false;
+
+		Eigen::MatrixXd phi(nl_problem.reduced_size(), reduced_order_basis.cols());
+		for (int i = 0; i < reduced_order_basis.cols(); ++i)
+			phi.col(i) = nl_problem.full_to_reduced(reduced_order_basis.col(i));
+
+		const json &params = args["solver"]["reduced_order"];
+		Eigen::VectorXd x = nl_problem.full_to_reduced(sol);
+		if (!reduced_newton(nl_problem, phi, params["max_iterations"], params["tolerance"], x))
+			return false;
+
+		sol = nl_problem.reduced_to_full(x);
+		return true;
+	}
+
+	bool State::solve_quasi_newton_step(Eigen::MatrixXd &sol)
+	{
+		NLProblem &nl_problem = *(solve_data.nl_problem);
+		if (nl_problem.uses_lagging())
+			return false;
+
+		// the boundary conditions have to be applied directly, otherwise the augmented Lagrangian of the full solve is needed
+		Eigen::VectorXd x = nl_problem.full_to_reduced(sol);
+		nl_problem.line_search_begin(sol, x);
+		const bool feasible = std::isfinite(nl_problem.value(x))
+							  && nl_problem.is_step_valid(sol, x)
+							  && nl_problem.is_step_collision_free(sol, x);
+		nl_problem.line_search_end();
+		if (!feasible)
+			return false;
+
+		if (solve_data.quasi_newton_solver == nullptr)
+			solve_data.quasi_newton_solver = std::make_shared<solver::QuasiNewtonSolver>(
+				args["solver"]["quasi_newton"], args["solver"]["linear"], units.characteristic_length());
+
+		nl_problem.init(sol);
+		solve_data.update_barrier_stiffness(sol);
+		if (!solve_data.quasi_newton_solver->minimize(nl_problem, x))
+			return false;
+
+		sol = nl_problem.reduced_to_full(x);
+		stats.add_solver_info(
+			{{"type", "quasi_newton"},
+			 {"iterations", solve_data.quasi_newton_solver->iterations()},
+			 {"factorizations", solve_data.quasi_newton_solver->factorizations()}});
+		return true;
 	}
 
 	void State::solve_tensor_nonlinear(Eigen::MatrixXd &sol, const int t, const bool init_lagging)
 	{
+		POLYFEM_PROFILE_ZONE("State::solve_tensor_nonlinear");
 		assert(solve_data.nl_problem != nullptr);
 		NLProblem &nl_problem = *(solve_data.nl_problem);
 
@@ -301,38 +1128,45 @@ namespace polyfem
 
 		// ---------------------------------------------------------------------
 
-		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver = make_nl_solver(true);
+		// the solvers live in solve_data so that they are only created once per solve
+		if (solve_data.al_nl_solver == nullptr)
+			solve_data.al_nl_solver = make_nl_solver(true);
+		if (solve_data.nl_solver == nullptr)
+			solve_data.nl_solver = make_nl_solver(false);
+
+		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver = solve_data.al_nl_solver;
 
 		ALSolver al_solver(
 			solve_data.al_lagr_form, solve_data.al_pen_form,
-			args["solver"]["augmented_lagrangian"]["initial_weight"],
-			args["solver"]["augmented_lagrangian"]["scaling"],
-			args["solver"]["augmented_lagrangian"]["max_weight"],
-			args["solver"]["augmented_lagrangian"]["eta"],
+			config.al_initial_weight(),
+			config.al_scaling(),
+			config.al_max_weight(),
+			config.al_eta(),
 			[&](const Eigen::VectorXd &x) {
 				this->solve_data.update_barrier_stiffness(sol);
 			});
 
 		al_solver.post_subsolve = [&](const double al_weight) {
-			stats.solver_info.push_back(
-				{{"type", al_weight > 0 ? "al" : "rc"},
-				 {"t", t}, // TODO: null if static?
-				 {"info", nl_solver->info()}});
+			json entry = {
+				{"type", al_weight > 0 ? "al" : "rc"},
+				{"t", t}, // TODO: null if static?
+				{"info", nl_solver->info()}};
 			if (al_weight > 0)
-				stats.solver_info.back()["weight"] = al_weight;
+				entry["weight"] = al_weight;
+			stats.add_solver_info(entry);
 			save_subsolve(++subsolve_count, t, sol, Eigen::MatrixXd()); // no pressure
 		};
 
 		Eigen::MatrixXd prev_sol = sol;
 		al_solver.solve_al(nl_solver, nl_problem, sol);
 
-		nl_solver = make_nl_solver(false);
+		nl_solver = solve_data.nl_solver;
 		al_solver.solve_reduced(nl_solver, nl_problem, sol);
 
 		// ---------------------------------------------------------------------
 
 		// TODO: Make this more general
-		const double lagging_tol = args["solver"]["contact"].value("friction_convergence_tol", 1e-2) * units.characteristic_length();
+		const double lagging_tol = config.friction_convergence_tol() * units.characteristic_length();
 
 		if (optimization_enabled != solver::CacheLevel::Derivatives)
 		{
@@ -349,7 +1183,7 @@ namespace polyfem
 				Eigen::VectorXd grad;
 				nl_problem.gradient(tmp_sol, grad);
 				const double delta_x_norm = (prev_sol - sol).lpNorm<Eigen::Infinity>();
-				logger().debug("Lagging convergence grad_norm={:g} tol={:g} (||Δx||={:g})", grad.norm(), lagging_tol, delta_x_norm);
+				POLYFEM_LOG_DEBUG("Lagging convergence grad_norm={:g} tol={:g} (||Δx||={:g})", grad.norm(), lagging_tol, delta_x_norm);
 				if (grad.norm() <= lagging_tol)
 				{
 					logger().info(
@@ -387,7 +1221,7 @@ namespace polyfem
 				sol = nl_problem.reduced_to_full(tmp_sol);
 
 				// Save the subsolve sequence for debugging and info
-				stats.solver_info.push_back(
+				stats.add_solver_info(
 					{{"type", "rc"},
 					 {"t", t}, // TODO: null if static?
 					 {"lag_i", lag_i},
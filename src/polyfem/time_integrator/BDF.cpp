@@ -16,6 +16,7 @@ namespace polyfem::time_integrator
 		max_steps_ = params.at("steps");
 		if (max_steps_ < 1 || max_steps_ > 6)
 			log_and_throw_error("BDF steps must be 1 ≤ n ≤ 6");
+		clear_cache();
 	}
 
 	const std::vector<double> &BDF::alphas(const int i)
@@ -46,53 +47,50 @@ namespace polyfem::time_integrator
 		return _betas[i];
 	}
 
-	Eigen::VectorXd BDF::weighted_sum_x_prevs() const
+	void BDF::weighted_sum(const VectorHistory &prevs, Eigen::VectorXd &sum) const
 	{
 		const std::vector<double> &alpha = alphas(steps() - 1);
 
-		Eigen::VectorXd sum = Eigen::VectorXd::Zero(x_prev().size());
-		for (int i = 0; i < steps(); i++)
+		sum = alpha[0] * prevs[0];
+		for (int i = 1; i < steps(); i++)
 		{
-			sum += alpha[i] * x_prevs_[i];
+			sum += alpha[i] * prevs[i];
 		}
-
-		return sum;
 	}
 
-	Eigen::VectorXd BDF::weighted_sum_v_prevs() const
+	const Eigen::VectorXd &BDF::weighted_sum_x_prevs() const
 	{
-		const std::vector<double> &alpha = alphas(steps() - 1);
-
-		Eigen::VectorXd sum = Eigen::VectorXd::Zero(v_prev().size());
-		for (int i = 0; i < steps(); i++)
+		if (!has_weighted_sums_)
 		{
-			sum += alpha[i] * v_prevs_[i];
+			weighted_sum(x_prevs_, weighted_sum_x_prevs_);
+			weighted_sum(v_prevs_, weighted_sum_v_prevs_);
+			has_weighted_sums_ = true;
 		}
+		return weighted_sum_x_prevs_;
+	}
 
-		return sum;
+	const Eigen::VectorXd &BDF::weighted_sum_v_prevs() const
+	{
+		weighted_sum_x_prevs();
+		return weighted_sum_v_prevs_;
 	}
 
-	void BDF::update_quantities(const Eigen::VectorXd &x)
+	void BDF::clear_cache()
 	{
-		const Eigen::VectorXd v = compute_velocity(x);
-		const Eigen::VectorXd a = compute_acceleration(v);
+		ImplicitTimeIntegrator::clear_cache();
+		has_weighted_sums_ = false;
+	}
 
-		x_prevs_.push_front(x);
-		v_prevs_.push_front(v);
-		a_prevs_.push_front(a);
+	void BDF::update_quantities(const Eigen::VectorXd &x)
+	{
+		Eigen::VectorXd v = compute_velocity(x);
+		Eigen::VectorXd a = compute_acceleration(v);
 
-		if (steps() > max_steps())
-		{
-			x_prevs_.pop_back();
-			v_prevs_.pop_back();
-			a_prevs_.pop_back();
-		}
-		assert(x_prevs_.size() <= max_steps());
-		assert(x_prevs_.size() == v_prevs_.size());
-		assert(x_prevs_.size() == a_prevs_.size());
+		// the oldest values are overwritten in place
+		push_prevs(x, std::move(v), std::move(a));
 	}
 
-	Eigen::VectorXd BDF::x_tilde() const
+	Eigen::VectorXd BDF::compute_x_tilde() const
 	{
 		return weighted_sum_x_prevs() + betas(steps() - 1) * dt() * weighted_sum_v_prevs();
 	}
@@ -28,7 +28,7 @@ namespace polyfem::time_integrator
 		/// 	\tilde{x} = \left(\sum_{i=0}^{n-1} \alpha_i x^{t-i}\right) + \beta \Delta t \left(\sum_{i=0}^{n-1} \alpha_i v^{t-i}\right)
 		/// \f]
 		/// @return value for \f$\tilde{x}\f$
-		Eigen::VectorXd x_tilde() const override;
+		Eigen::VectorXd compute_x_tilde() const override;
 
 		/// @brief Compute the current velocity given the current solution and using the stored previous solution(s).
 		/// \f[
@@ -72,13 +72,15 @@ namespace polyfem::time_integrator
 		/// \f[
 		/// 	\sum_{i=0}^{n-1} \alpha_i x^{t-i}
 		/// \f]
-		Eigen::VectorXd weighted_sum_x_prevs() const;
+		/// @note Computed once per time step.
+		const Eigen::VectorXd &weighted_sum_x_prevs() const;
 
 		/// @brief Compute the weighted sum of the previous velocities.
 		/// \f[
 		/// 	\sum_{i=0}^{n-1} \alpha_i v^{t-i}
 		/// \f]
-		Eigen::VectorXd weighted_sum_v_prevs() const;
+		/// @note Computed once per time step.
+		const Eigen::VectorXd &weighted_sum_v_prevs() const;
 
 		/// @brief Retrieve the alphas used for BDF with `i` steps.
 		/// @param i number of steps
@@ -94,7 +96,18 @@ namespace polyfem::time_integrator
 		/// @brief Get the maximum number of steps to use for integration.
 		int max_steps() const override { return max_steps_; }
 
+		void clear_cache() override;
+
 		/// @brief The maximum number of steps to use for integration.
 		int max_steps_ = 1;
+
+	private:
+		/// @brief Weighted sum of the first steps() values of prevs, with the coefficients alphas(steps() - 1).
+		void weighted_sum(const VectorHistory &prevs, Eigen::VectorXd &sum) const;
+
+		/// cached values of weighted_sum_x_prevs() and weighted_sum_v_prevs()
+		mutable Eigen::VectorXd weighted_sum_x_prevs_;
+		mutable Eigen::VectorXd weighted_sum_v_prevs_;
+		mutable bool has_weighted_sums_ = false;
 	};
 } // namespace polyfem::time_integrator
@@ -0,0 +1,107 @@
+#include "CentralDifference.hpp"
+
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <limits>
+
+namespace polyfem::time_integrator
+{
+	void CentralDifference::set_parameters(const json &params)
+	{
+		cfl_ = params.value("cfl", cfl_);
+		lumping_ = params.value("lumping", lumping_);
+	}
+
+	void CentralDifference::init(
+		const Eigen::VectorXd &x,
+		const Eigen::VectorXd &v,
+		const Eigen::VectorXd &lumped_mass,
+		const std::vector<int> &fixed_dofs,
+		const Forces &forces)
+	{
+		assert(x.size() == v.size() && x.size() == lumped_mass.size());
+
+		x_ = x;
+		v_ = v;
+		fixed_dofs_ = fixed_dofs;
+
+		inv_mass_ = (lumped_mass.array() > 0).select(lumped_mass.cwiseInverse(), 0);
+		for (const int i : fixed_dofs_)
+			inv_mass_[i] = 0;
+
+		dominant_mode_.resize(0);
+		update_acceleration(forces);
+	}
+
+	void CentralDifference::step(const double dt, const Eigen::VectorXd &fixed_values, const Forces &forces)
+	{
+		assert(dt > 0);
+		assert(fixed_values.size() == x_.size());
+
+		v_ += 0.5 * dt * a_;
+		for (const int i : fixed_dofs_)
+			v_[i] = (fixed_values[i] - x_[i]) / dt;
+		x_ += dt * v_;
+
+		update_acceleration(forces);
+		v_ += 0.5 * dt * a_;
+	}
+
+	void CentralDifference::update_acceleration(const Forces &forces)
+	{
+		Eigen::VectorXd f;
+		forces(x_, f);
+		assert(f.size() == x_.size());
+		a_ = inv_mass_.cwiseProduct(f);
+	}
+
+	double CentralDifference::stable_dt(const Stiffness &stiffness, const int iterations)
+	{
+		// power iteration on the symmetric M^{-1/2} K M^{-1/2}, which has the same spectrum as M^{-1} K
+		const Eigen::VectorXd inv_mass_sqrt = inv_mass_.cwiseSqrt();
+
+		Eigen::VectorXd y = dominant_mode_.size() == x_.size() ? dominant_mode_ : Eigen::VectorXd::Random(x_.size());
+		y = y.cwiseProduct((inv_mass_.array() > 0).cast<double>().matrix());
+		if (y.norm() == 0)
+			return std::numeric_limits<double>::infinity();
+		y.normalize();
+
+		double omega2 = 0;
+		Eigen::VectorXd Ky;
+		for (int i = 0; i < iterations; ++i)
+		{
+			stiffness(inv_mass_sqrt.cwiseProduct(y), Ky);
+			const Eigen::VectorXd w = inv_mass_sqrt.cwiseProduct(Ky);
+			omega2 = y.dot(w);
+
+			const double norm = w.norm();
+			if (norm == 0)
+				break;
+			y = w / norm;
+		}
+		dominant_mode_ = y;
+
+		if (omega2 <= 0)
+			return std::numeric_limits<double>::infinity();
+		return cfl_ * 2 / std::sqrt(omega2);
+	}
+
+	Eigen::VectorXd CentralDifference::lump_mass(const StiffnessMatrix &mass, const std::string &lumping)
+	{
+		if (lumping == "row_sum")
+			return utils::lump_matrix(mass).diagonal();
+
+		if (lumping == "hrz")
+		{
+			// Hinton-Rock-Zienkiewicz: diagonal of the consistent mass, scaled to the total mass
+			const Eigen::VectorXd diagonal = mass.diagonal();
+			const double trace = diagonal.sum();
+			if (trace <= 0)
+				log_and_throw_error("Unable to lump a mass matrix with a non-positive diagonal!");
+			return diagonal * (mass.sum() / trace);
+		}
+
+		log_and_throw_error("Unknown mass lumping ({})", lumping);
+	}
+} // namespace polyfem::time_integrator
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Core>
+
+#include <functional>
+#include <vector>
+
+namespace polyfem::time_integrator
+{
+	/// Explicit central difference time integrator of a second order ODE with a lumped (diagonal) mass.
+	/// Written in the equivalent velocity Verlet form, each step costs one force evaluation and no linear solve:
+	/// \f[
+	/// 	v^{t+1/2} = v^t + \frac{\Delta t}{2} a^t\newline
+	/// 	x^{t+1} = x^t + \Delta t v^{t+1/2}\newline
+	/// 	a^{t+1} = M^{-1} f(x^{t+1})\newline
+	/// 	v^{t+1} = v^{t+1/2} + \frac{\Delta t}{2} a^{t+1}
+	/// \f]
+	/// The scheme is only conditionally stable, see stable_dt().
+	/// @see https://en.wikipedia.org/wiki/Verlet_integration#Velocity_Verlet
+	class CentralDifference
+	{
+	public:
+		/// total force (external minus internal) at the solution x
+		using Forces = std::function<void(const Eigen::VectorXd &x, Eigen::VectorXd &f)>;
+		/// product of the stiffness matrix with v
+		using Stiffness = std::function<void(const Eigen::VectorXd &v, Eigen::VectorXd &Kv)>;
+
+		CentralDifference() {}
+
+		/// @brief Set the integrator parameters (CFL safety factor and mass lumping) from a json object.
+		void set_parameters(const json &params);
+
+		/// @brief Initialize the integrator, the initial acceleration is computed from the forces.
+		/// @param x initial solution
+		/// @param v initial velocity
+		/// @param lumped_mass diagonal of the lumped mass matrix, dofs with zero mass do not move
+		/// @param fixed_dofs dofs whose values are prescribed (e.g., Dirichlet boundary conditions)
+		/// @param forces total force acting on the solution
+		void init(const Eigen::VectorXd &x, const Eigen::VectorXd &v, const Eigen::VectorXd &lumped_mass, const std::vector<int> &fixed_dofs, const Forces &forces);
+
+		/// @brief Advance the solution by one step.
+		/// @param dt time step size, should be below stable_dt()
+		/// @param fixed_values values of the fixed dofs at the end of the step (full size, only the fixed entries are used)
+		/// @param forces total force acting on the solution
+		void step(const double dt, const Eigen::VectorXd &fixed_values, const Forces &forces);
+
+		/// @brief Estimate the largest stable time step \f$2 / \omega_{\max}\f$ scaled by the CFL factor.
+		/// \f$\omega_{\max}^2\f$ is the largest eigenvalue of \f$M^{-1}K\f$, estimated by power iteration warm started at the previous estimate.
+		/// @param stiffness matrix-free product with the stiffness matrix at the current solution
+		/// @param iterations number of power iterations
+		double stable_dt(const Stiffness &stiffness, const int iterations = 30);
+
+		/// @brief Lump a consistent mass matrix.
+		/// @param mass consistent mass matrix
+		/// @param lumping "row_sum" to sum the rows, "hrz" to scale the diagonal to preserve the total mass
+		/// @return diagonal of the lumped mass matrix
+		static Eigen::VectorXd lump_mass(const StiffnessMatrix &mass, const std::string &lumping);
+
+		/// @brief Access the current solution.
+		const Eigen::VectorXd &x() const { return x_; }
+		/// @brief Access the current velocity.
+		const Eigen::VectorXd &v() const { return v_; }
+		/// @brief Access the current acceleration.
+		const Eigen::VectorXd &a() const { return a_; }
+
+		/// @brief Access the CFL safety factor applied to the critical time step.
+		double cfl() const { return cfl_; }
+		/// @brief Access the mass lumping scheme.
+		const std::string &lumping() const { return lumping_; }
+
+	private:
+		/// a = M^{-1} f, zero on the fixed dofs
+		void update_acceleration(const Forces &forces);
+
+		double cfl_ = 0.9;
+		std::string lumping_ = "row_sum";
+
+		Eigen::VectorXd x_;
+		Eigen::VectorXd v_;
+		Eigen::VectorXd a_;
+		/// inverse of the lumped mass, zero on the fixed dofs
+		Eigen::VectorXd inv_mass_;
+		std::vector<int> fixed_dofs_;
+
+		/// last power iteration vector, to warm start the next estimate
+		Eigen::VectorXd dominant_mode_;
+	};
+} // namespace polyfem::time_integrator
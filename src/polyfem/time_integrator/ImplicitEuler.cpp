@@ -10,7 +10,7 @@ namespace polyfem::time_integrator
 		set_x_prev(x);
 	}
 
-	Eigen::VectorXd ImplicitEuler::x_tilde() const
+	Eigen::VectorXd ImplicitEuler::compute_x_tilde() const
 	{
 		return x_prev() + dt() * v_prev();
 	}
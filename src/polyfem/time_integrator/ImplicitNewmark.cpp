@@ -6,6 +6,7 @@ namespace polyfem::time_integrator
 	{
 		beta_ = params.at("gamma");
 		gamma_ = params.at("beta");
+		clear_cache();
 	}
 
 	void ImplicitNewmark::update_quantities(const Eigen::VectorXd &x)
@@ -16,7 +17,7 @@ namespace polyfem::time_integrator
 		set_x_prev(x);
 	}
 
-	Eigen::VectorXd ImplicitNewmark::x_tilde() const
+	Eigen::VectorXd ImplicitNewmark::compute_x_tilde() const
 	{
 		return x_prev() + dt() * (v_prev() + dt() * (0.5 - beta()) * a_prev());
 	}
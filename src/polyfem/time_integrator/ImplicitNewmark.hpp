@@ -28,7 +28,7 @@ namespace polyfem::time_integrator
 		/// 	\tilde{x} = x^t + \Delta t (v^t + (0.5 - \beta) \Delta t a^t)
 		/// \f]
 		/// @return value for \f$\tilde{x}\f$
-		Eigen::VectorXd x_tilde() const override;
+		Eigen::VectorXd compute_x_tilde() const override;
 
 		/// @brief Compute the current velocity given the current solution and using the stored previous solution(s).
 		/// \f[
@@ -25,42 +25,100 @@ namespace polyfem
 			assert(x_prevs.cols() == v_prevs.cols());
 			assert(x_prevs.cols() == a_prevs.cols());
 
-			x_prevs_.clear();
-			v_prevs_.clear();
-			a_prevs_.clear();
+			x_prevs_.reset(max_steps());
+			v_prevs_.reset(max_steps());
+			a_prevs_.reset(max_steps());
 
+			// the first column is the most recent
 			const int n = std::min(int(x_prevs.cols()), max_steps());
-			for (int i = 0; i < n; i++)
+			for (int i = n - 1; i >= 0; i--)
 			{
-				x_prevs_.push_back(x_prevs.col(i));
-				v_prevs_.push_back(v_prevs.col(i));
-				a_prevs_.push_back(a_prevs.col(i));
+				x_prevs_.push_front(x_prevs.col(i));
+				v_prevs_.push_front(v_prevs.col(i));
+				a_prevs_.push_front(a_prevs.col(i));
 			}
 
 			assert(dt > 0);
 			dt_ = dt;
+			clear_cache();
+		}
+
+		const Eigen::VectorXd &ImplicitTimeIntegrator::x_tilde() const
+		{
+			if (!has_x_tilde_)
+			{
+				x_tilde_ = compute_x_tilde();
+				has_x_tilde_ = true;
+			}
+			return x_tilde_;
+		}
+
+		void ImplicitTimeIntegrator::push_prevs(const Eigen::VectorXd &x, Eigen::VectorXd &&v, Eigen::VectorXd &&a)
+		{
+			x_prevs_.push_front(x);
+			v_prevs_.push_front(std::move(v));
+			a_prevs_.push_front(std::move(a));
+
+			assert(x_prevs_.size() <= max_steps());
+			assert(x_prevs_.size() == v_prevs_.size());
+			assert(x_prevs_.size() == a_prevs_.size());
+			clear_cache();
+		}
+
+		Eigen::VectorXd ImplicitTimeIntegrator::predict(const int order) const
+		{
+			assert(order >= 0 && order <= 2);
+			Eigen::VectorXd x = x_prev();
+			if (order >= 1)
+				x += dt() * v_prev();
+			if (order >= 2)
+				x += 0.5 * dt() * dt() * a_prev();
+			return x;
+		}
+
+		void ImplicitTimeIntegrator::set_dt(const double dt)
+		{
+			assert(dt > 0);
+			if (dt == dt_)
+				return;
+			dt_ = dt;
+
+			x_prevs_.truncate(1);
+			v_prevs_.truncate(1);
+			a_prevs_.truncate(1);
+			clear_cache();
 		}
 
 		void ImplicitTimeIntegrator::save_state(const std::string &state_path) const
 		{
-			assert(!state_path.empty());
+			Eigen::MatrixXd x, v, a;
+			get_state(x, v, a);
+			save_state(state_path, x, v, a);
+		}
 
+		void ImplicitTimeIntegrator::get_state(Eigen::MatrixXd &x, Eigen::MatrixXd &v, Eigen::MatrixXd &a) const
+		{
 			const int ndof = x_prev().size();
 			const int prev_steps = x_prevs().size();
 
-			Eigen::MatrixXd tmp(ndof, prev_steps);
-
+			x.resize(ndof, prev_steps);
+			v.resize(ndof, prev_steps);
+			a.resize(ndof, prev_steps);
 			for (int i = 0; i < prev_steps; ++i)
-				tmp.col(i) = x_prevs()[i];
-			write_matrix(state_path, "u", tmp, /*replace=*/true);
+			{
+				x.col(i) = x_prevs()[i];
+				v.col(i) = v_prevs()[i];
+				a.col(i) = a_prevs()[i];
+			}
+		}
 
-			for (int i = 0; i < prev_steps; ++i)
-				tmp.col(i) = v_prevs()[i];
-			write_matrix(state_path, "v", tmp, /*replace=*/false);
+		void ImplicitTimeIntegrator::save_state(const std::string &state_path, const Eigen::MatrixXd &x, const Eigen::MatrixXd &v, const Eigen::MatrixXd &a)
+		{
+			assert(!state_path.empty());
 
-			for (int i = 0; i < prev_steps; ++i)
-				tmp.col(i) = a_prevs()[i];
-			write_matrix(state_path, "a", tmp, /*replace=*/false);
+			write_matrix(state_path, "u", x, /*replace=*/true);
+			write_matrix(state_path, "v", v, /*replace=*/false);
+			write_matrix(state_path, "a", a, /*replace=*/false);
 		}
 
 		std::shared_ptr<ImplicitTimeIntegrator> ImplicitTimeIntegrator::construct_time_integrator(const json &params)
@@ -1,12 +1,12 @@
 #pragma once
 
 #include <polyfem/Common.hpp>
+#include <polyfem/time_integrator/VectorHistory.hpp>
 
 #include <Eigen/Core>
 
 #include <map>
 #include <vector>
-#include <deque>
 
 namespace polyfem::time_integrator
 {
@@ -33,9 +33,14 @@ namespace polyfem::time_integrator
 		/// @param x new solution vector
 		virtual void update_quantities(const Eigen::VectorXd &x) = 0;
 
-		/// @brief Compute the predicted solution to be used in the inertia term \f$(x-\tilde{x})^TM(x-\tilde{x})\f$.
+		/// @brief Predicted solution to be used in the inertia term \f$(x-\tilde{x})^TM(x-\tilde{x})\f$.
+		/// It is constant during a time step, so it is computed on the first call after the history changed.
 		/// @return value for \f$\tilde{x}\f$
-		virtual Eigen::VectorXd x_tilde() const = 0;
+		const Eigen::VectorXd &x_tilde() const;
+
+		/// @brief Compute the predicted solution, see x_tilde().
+		/// @return value for \f$\tilde{x}\f$
+		virtual Eigen::VectorXd compute_x_tilde() const = 0;
 
 		/// @brief Compute the current velocity given the current solution and using the stored previous solution(s).
 		/// @param x current solution
@@ -58,10 +63,30 @@ namespace polyfem::time_integrator
 		/// @brief Access the time step size.
 		const double &dt() const { return dt_; }
 
+		/// @brief Predict the next solution by extrapolating the most recent values.
+		/// \f[
+		/// 	x^{t+1} \approx x^t + \Delta t v^t + \frac{\Delta t^2}{2} a^t
+		/// \f]
+		/// @param order 0 for the previous solution, 1 for constant velocity, 2 to also use the acceleration
+		/// @return predicted solution
+		Eigen::VectorXd predict(const int order) const;
+
+		/// @brief Change the time step size for the next steps.
+		/// @param dt new time step size
+		/// @note Multi-step integrators assume a uniform step, so they restart from the most recent values.
+		void set_dt(const double dt);
+
 		/// @brief Save the values of \f$x\f$, \f$v\f$, and \f$a\f$.
 		/// @param state_path path for the output file containing \f$x, v, a\f$ as hdf5
 		virtual void save_state(const std::string &state_path) const;
 
+		/// @brief Copy the history of \f$x\f$, \f$v\f$, and \f$a\f$, one column per previous step, as written by save_state.
+		virtual void get_state(Eigen::MatrixXd &x_prevs, Eigen::MatrixXd &v_prevs, Eigen::MatrixXd &a_prevs) const;
+
+		/// @brief Save a history returned by get_state.
+		/// @param state_path path for the output file containing \f$x, v, a\f$ as hdf5
+		static void save_state(const std::string &state_path, const Eigen::MatrixXd &x_prevs, const Eigen::MatrixXd &v_prevs, const Eigen::MatrixXd &a_prevs);
+
 		/// @brief Factory method for constructing implicit time integrators from the name of the integrator.
 		/// @param name name of the type of ImplicitTimeIntegrator to construct
 		/// @return new implicit time integrator of type specfied by name
@@ -79,11 +104,11 @@ namespace polyfem::time_integrator
 		const Eigen::VectorXd &a_prev() const { return a_prevs_.front(); }
 
 		/// @brief Get the (relevant) history of previous solution value.
-		const std::deque<Eigen::VectorXd> &x_prevs() const { return x_prevs_; }
+		const VectorHistory &x_prevs() const { return x_prevs_; }
 		/// @brief Get the (relevant) history of previous velocity value.
-		const std::deque<Eigen::VectorXd> &v_prevs() const { return v_prevs_; }
+		const VectorHistory &v_prevs() const { return v_prevs_; }
 		/// @brief Get the (relevant) history of previous acceleration value.
-		const std::deque<Eigen::VectorXd> &a_prevs() const { return a_prevs_; }
+		const VectorHistory &a_prevs() const { return a_prevs_; }
 
 		/// @brief Get the current number of steps to use for integration.
 		int steps() const { return x_prevs_.size(); }
@@ -97,17 +122,41 @@ namespace polyfem::time_integrator
 		double dt_ = 1;
 
 		/// Store the necessary previous values of the solution for single or multi-step integration.
-		std::deque<Eigen::VectorXd> x_prevs_;
+		VectorHistory x_prevs_;
 		/// Store the necessary previous values of the velocity for single or multi-step integration.
-		std::deque<Eigen::VectorXd> v_prevs_;
+		VectorHistory v_prevs_;
 		/// Store the necessary previous values of the acceleration for single or multi-step integration.
-		std::deque<Eigen::VectorXd> a_prevs_;
+		VectorHistory a_prevs_;
 
 		/// Convenience functions for setting the most recent previous solution.
-		void set_x_prev(const Eigen::VectorXd &x_prev) { x_prevs_.front() = x_prev; }
+		void set_x_prev(const Eigen::VectorXd &x_prev)
+		{
+			x_prevs_.front() = x_prev;
+			clear_cache();
+		}
 		/// Convenience functions for setting the most recent previous velocity.
-		void set_v_prev(const Eigen::VectorXd &v_prev) { v_prevs_.front() = v_prev; }
+		void set_v_prev(const Eigen::VectorXd &v_prev)
+		{
+			v_prevs_.front() = v_prev;
+			clear_cache();
+		}
 		/// Convenience functions for setting the most recent previous acceleration.
-		void set_a_prev(const Eigen::VectorXd &a_prev) { a_prevs_.front() = a_prev; }
+		void set_a_prev(const Eigen::VectorXd &a_prev)
+		{
+			a_prevs_.front() = a_prev;
+			clear_cache();
+		}
+
+		/// @brief Add the values of the last step to the history, dropping the oldest ones beyond max_steps().
+		/// The storage of v and a is taken.
+		void push_prevs(const Eigen::VectorXd &x, Eigen::VectorXd &&v, Eigen::VectorXd &&a);
+
+		/// @brief Drop the quantities cached for the current time step, called whenever the history or the parameters change.
+		virtual void clear_cache() { has_x_tilde_ = false; }
+
+	private:
+		/// cached value of x_tilde()
+		mutable Eigen::VectorXd x_tilde_;
+		mutable bool has_x_tilde_ = false;
 	};
 } // namespace polyfem::time_integrator
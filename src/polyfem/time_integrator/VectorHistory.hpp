@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+namespace polyfem::time_integrator
+{
+	/// History of the previous values of a vector (e.g., the solution of the previous time steps), most recent first.
+	/// The values are stored in a ring buffer of fixed capacity: pushing a new value overwrites the oldest one in place,
+	/// so once the history is full no vector is allocated, copied around, or freed.
+	class VectorHistory
+	{
+	public:
+		class const_iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Eigen::VectorXd;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Eigen::VectorXd *;
+			using reference = const Eigen::VectorXd &;
+
+			const_iterator(const VectorHistory &history, const int i) : history_(&history), i_(i) {}
+
+			reference operator*() const { return (*history_)[i_]; }
+			pointer operator->() const { return &(*history_)[i_]; }
+			const_iterator &operator++()
+			{
+				++i_;
+				return *this;
+			}
+			bool operator==(const const_iterator &other) const { return i_ == other.i_; }
+			bool operator!=(const const_iterator &other) const { return i_ != other.i_; }
+
+		private:
+			const VectorHistory *history_;
+			int i_;
+		};
+
+		/// @brief Remove all the values and set the maximum number of values kept, the storage of the old values is reused.
+		void reset(const int capacity)
+		{
+			assert(capacity > 0);
+			data_.resize(capacity);
+			head_ = 0;
+			size_ = 0;
+		}
+
+		/// @brief Add the most recent value, dropping the oldest one if the history is full.
+		void push_front(const Eigen::VectorXd &v) { next_slot() = v; }
+		/// @brief Same as above, the storage of v is taken (and v gets the one of the dropped value).
+		void push_front(Eigen::VectorXd &&v) { next_slot().swap(v); }
+
+		/// @brief Keep only the n most recent values.
+		void truncate(const int n) { size_ = std::min(size_, std::max(n, 0)); }
+
+		/// @brief i-th most recent value.
+		const Eigen::VectorXd &operator[](const int i) const
+		{
+			assert(i >= 0 && i < size_);
+			return data_[(head_ + i) % data_.size()];
+		}
+		Eigen::VectorXd &operator[](const int i)
+		{
+			assert(i >= 0 && i < size_);
+			return data_[(head_ + i) % data_.size()];
+		}
+
+		const Eigen::VectorXd &front() const { return (*this)[0]; }
+		Eigen::VectorXd &front() { return (*this)[0]; }
+
+		int size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+		int capacity() const { return data_.size(); }
+
+		const_iterator begin() const { return const_iterator(*this, 0); }
+		const_iterator end() const { return const_iterator(*this, size_); }
+
+	private:
+		/// slot of the new most recent value, the oldest one if the history is full
+		Eigen::VectorXd &next_slot()
+		{
+			assert(!data_.empty());
+			head_ = (head_ + data_.size() - 1) % data_.size();
+			size_ = std::min<int>(size_ + 1, data_.size());
+			return data_[head_];
+		}
+
+		std::vector<Eigen::VectorXd> data_;
+		/// index in data_ of the most recent value
+		int head_ = 0;
+		int size_ = 0;
+	};
+} // namespace polyfem::time_integrator
@@ -1,8 +1,24 @@
 #include "BSplineParametrization.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 namespace polyfem
 {
+	namespace
+	{
+		Eigen::SparseMatrix<double, Eigen::RowMajor> basis_from_triplets(const int n_nodes, const int n_control_points, const std::vector<std::vector<Eigen::Triplet<double>>> &triplets)
+		{
+			std::vector<Eigen::Triplet<double>> all;
+			for (const auto &t : triplets)
+				all.insert(all.end(), t.begin(), t.end());
+
+			Eigen::SparseMatrix<double, Eigen::RowMajor> basis(n_nodes, n_control_points);
+			basis.setFromTriplets(all.begin(), all.end());
+			return basis;
+		}
+	} // namespace
+
 	// void BSplineParametrization::get_parameters(const Eigen::MatrixXd &V, Eigen::MatrixXd &control_points)
 	// {
 	// 	bool mesh_changed = V.rows() != num_vertices;
@@ -47,18 +63,39 @@ namespace polyfem
 		// 	node_ids_.erase(loc);
 		// }
 		logger().info("Number of useful boundary nodes in spline parametrization: {}", node_ids_.size());
+
+		build_basis();
+	}
+
+	void BSplineParametrization2D::build_basis()
+	{
+		// The curve is linear in the control points, one curve per basis function evaluated at the fixed t
+		const int n_control_points = curve.get_control_points().rows();
+		std::vector<std::vector<Eigen::Triplet<double>>> triplets(n_control_points);
+		utils::maybe_parallel_for(n_control_points, [&](int start, int end, int thread_id) {
+			nanospline::BSpline<double, 1, 3> curve_;
+			curve_.set_knots(curve.get_knots());
+			for (int i = start; i < end; ++i)
+			{
+				Eigen::MatrixXd indicator = Eigen::MatrixXd::Zero(n_control_points, 1);
+				indicator(i) = 1;
+				curve_.set_control_points(indicator);
+				for (const auto &b : node_ids_)
+				{
+					const double basis_val = curve_.evaluate(node_id_to_t_.at(b))(0);
+					if (basis_val != 0)
+						triplets[i].emplace_back(b, i, basis_val);
+				}
+			}
+		});
+		basis_ = basis_from_triplets(node_ids_.size(), n_control_points, triplets);
 	}
 
 	void BSplineParametrization2D::reparametrize(const Eigen::MatrixXd &control_points, Eigen::MatrixXd &newV)
 	{
-		// Given new control parameters and the t parameter precomputed, compute new V
+		// Given new control parameters and the basis values at the precomputed t, compute new V
 		curve.set_control_points(control_points);
-		newV.setZero(node_ids_.size(), 2);
-		for (const auto &b : node_ids_)
-		{
-			auto new_val = curve.evaluate(node_id_to_t_.at(b));
-			newV.block(b, 0, 1, dim) = new_val;
-		}
+		newV = utils::parallel_product(basis_, control_points);
 	}
 
 	void BSplineParametrization2D::get_parameters(const Eigen::MatrixXd &V, Eigen::MatrixXd &control_points, const bool mesh_changed)
@@ -92,22 +129,20 @@ namespace polyfem
 
 	void BSplineParametrization2D::derivative_wrt_params(const Eigen::VectorXd &grad_boundary, Eigen::VectorXd &grad_control_points)
 	{
-		grad_control_points.setZero(curve.get_control_points().size());
-		nanospline::BSpline<double, 1, 3> curve_;
-		curve_.set_knots(curve.get_knots());
+		grad_control_points = utils::flatten(utils::parallel_transpose_product(basis_, utils::unflatten(grad_boundary, dim)));
+	}
 
-		for (int i = 0; i < curve.get_control_points().rows(); ++i)
-		{
-			Eigen::MatrixXd indicator = Eigen::MatrixXd::Zero(curve.get_control_points().rows(), 1);
-			indicator(i) = 1;
-			curve_.set_control_points(indicator);
-			for (const auto &b : node_ids_)
-			{
-				auto basis_val = curve_.evaluate(node_id_to_t_.at(b))(0);
+	void BSplineParametrization2D::jacobian_wrt_params(Eigen::SparseMatrix<double> &jac)
+	{
+		std::vector<Eigen::Triplet<double>> triplets;
+		triplets.reserve(basis_.nonZeros() * dim);
+		for (int b = 0; b < basis_.outerSize(); ++b)
+			for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(basis_, b); it; ++it)
 				for (int k = 0; k < dim; ++k)
-					grad_control_points(i * dim + k) += grad_boundary(b * dim + k) * basis_val;
-			}
-		}
+					triplets.emplace_back(b * dim + k, it.col() * dim + k, it.value());
+
+		jac.resize(basis_.rows() * dim, basis_.cols() * dim);
+		jac.setFromTriplets(triplets.begin(), triplets.end());
 	}
 
 	void BSplineParametrization2D::gradient(const Eigen::MatrixXd &point, const Eigen::MatrixXd &control_points, const double t_parameter, const double distance, Eigen::MatrixXd &grad)
@@ -174,6 +209,35 @@ namespace polyfem
 		// 	node_ids_.erase(loc);
 		// }
 		logger().info("Number of useful boundary nodes in spline parametrization: {}", node_ids_.size());
+
+		build_basis();
+	}
+
+	void BSplineParametrization3D::build_basis()
+	{
+		// The patch is linear in the control points, one patch per basis function evaluated at the fixed uv
+		const int n_control_points = patch.get_control_grid().rows();
+		std::vector<std::vector<Eigen::Triplet<double>>> triplets(n_control_points);
+		utils::maybe_parallel_for(n_control_points, [&](int start, int end, int thread_id) {
+			nanospline::BSplinePatch<double, 3, 3, 3> patch_;
+			patch_.set_knots_u(patch.get_knots_u());
+			patch_.set_knots_v(patch.get_knots_v());
+			for (int i = start; i < end; ++i)
+			{
+				Eigen::MatrixXd indicator = Eigen::MatrixXd::Zero(n_control_points, 3);
+				indicator.row(i).setOnes();
+				patch_.set_control_grid(indicator);
+				patch_.initialize();
+				for (const auto &b : node_ids_)
+				{
+					const Eigen::MatrixXd &uv = node_id_to_param_.at(b);
+					const double basis_val = patch_.evaluate(uv(0), uv(1))(0);
+					if (basis_val != 0)
+						triplets[i].emplace_back(b, i, basis_val);
+				}
+			}
+		});
+		basis_ = basis_from_triplets(node_ids_.size(), n_control_points, triplets);
 	}
 
 	void BSplineParametrization3D::get_parameters(const Eigen::MatrixXd &V, Eigen::MatrixXd &control_points, const bool mesh_changed)
@@ -210,42 +274,15 @@ namespace polyfem
 
 	void BSplineParametrization3D::reparametrize(const Eigen::MatrixXd &control_points, Eigen::MatrixXd &newV)
 	{
-		// Given new control parameters and the t parameter precomputed, compute new V
-		newV.setZero(node_ids_.size(), 3);
+		// Given new control parameters and the basis values at the precomputed uv, compute new V
 		patch.set_control_grid(control_points);
 		patch.initialize();
-		for (const auto &b : node_ids_)
-		{
-			auto uv = node_id_to_param_.at(b);
-			assert(uv.size() == 2);
-			auto new_val = patch.evaluate(uv(0), uv(1));
-			newV.block(b, 0, 1, dim) = new_val;
-		}
+		newV = utils::parallel_product(basis_, control_points);
 	}
 
 	void BSplineParametrization3D::derivative_wrt_params(const Eigen::VectorXd &grad_boundary, Eigen::VectorXd &grad_control_points)
 	{
-
-		grad_control_points.setZero(patch.get_control_grid().size());
-
-		for (int i = 0; i < patch.get_control_grid().rows(); ++i)
-		{
-			nanospline::BSplinePatch<double, 3, 3, 3> patch_;
-			patch_.set_knots_u(patch.get_knots_u());
-			patch_.set_knots_v(patch.get_knots_v());
-			Eigen::MatrixXd indicator = Eigen::MatrixXd::Zero(patch.get_control_grid().rows(), 3);
-			indicator.row(i) = Eigen::VectorXd::Ones(3);
-			patch_.set_control_grid(indicator);
-			patch_.initialize();
-			for (const auto &b : node_ids_)
-			{
-				auto uv = node_id_to_param_.at(b);
-				assert(uv.size() == 2);
-				auto basis_val = patch_.evaluate(uv(0), uv(1))(0);
-				for (int k = 0; k < dim; ++k)
-					grad_control_points(i * dim + k) += grad_boundary(b * dim + k) * basis_val;
-			}
-		}
+		grad_control_points = utils::flatten(utils::parallel_transpose_product(basis_, utils::unflatten(grad_boundary, dim)));
 	}
 
 	void BSplineParametrization3D::gradient(const Eigen::MatrixXd &point, const Eigen::MatrixXd &control_points, const Eigen::MatrixXd &uv_parameter, const double distance, Eigen::MatrixXd &grad)
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 
 #include <nanospline/BSpline.h>
 #include <nanospline/BSplinePatch.h>
@@ -39,6 +40,8 @@ namespace polyfem
 		void get_parameters(const Eigen::MatrixXd &V, Eigen::MatrixXd &control_points, const bool mesh_changed) override;
 
 		void derivative_wrt_params(const Eigen::VectorXd &grad_boundary, Eigen::VectorXd &grad_control_points) override;
+		// Sparse jacobian of the flattened vertices wrt. the flattened control points, derivative_wrt_params is its transpose product
+		void jacobian_wrt_params(Eigen::SparseMatrix<double> &jac);
 
 		static void gradient(const Eigen::MatrixXd &point, const Eigen::MatrixXd &control_points, const double t_parameter, const double distance, Eigen::MatrixXd &grad);
 		static void eval(const Eigen::MatrixXd &control_points, const double t, Eigen::MatrixXd &val);
@@ -49,6 +52,10 @@ namespace polyfem
 		std::map<int, double> node_id_to_t_;
 		const int dim;
 		nanospline::BSpline<double, 2, 3> curve;
+
+		// Values of the basis functions (columns) at the fixed t of the nodes (rows), the vertices are basis_ * control_points
+		Eigen::SparseMatrix<double, Eigen::RowMajor> basis_;
+		void build_basis();
 	};
 
 	class BSplineParametrization3D : public BSplineParametrization
@@ -74,6 +81,10 @@ namespace polyfem
 		std::map<int, Eigen::MatrixXd> node_id_to_param_;
 		const int dim;
 		nanospline::BSplinePatch<double, 3, 3, 3> patch;
+
+		// Values of the basis functions (columns) at the fixed uv of the nodes (rows), the vertices are basis_ * control_points
+		Eigen::SparseMatrix<double, Eigen::RowMajor> basis_;
+		void build_basis();
 	};
 
 } // namespace polyfem
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "BatchedSVD.hpp"
+
+#include <algorithm>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		namespace
+		{
+			/// one entry of BATCHED_SVD_WIDTH matrices
+			using Lane = Eigen::Array<double, BATCHED_SVD_WIDTH, 1>;
+			/// 3x3 matrices stored entry-wise, lane l of every entry belongs to the same matrix
+			using LaneMatrix = Lane[3][3];
+			using Mask = Eigen::Array<bool, BATCHED_SVD_WIDTH, 1>;
+
+			/// cyclic Jacobi converges quadratically, four sweeps reach machine precision on 3x3
+			constexpr int N_JACOBI_SWEEPS = 4;
+
+			/// rotates S (symmetric) in the (p, q) plane to cancel S(p, q), and accumulates the rotation in V
+			void jacobi_rotation(LaneMatrix &S, LaneMatrix &V, const int p, const int q)
+			{
+				const int r = 3 - p - q;
+
+				const Lane apq = S[p][q];
+				const Mask is_zero = apq == 0;
+
+				// theta = cot(2 phi), t = tan(phi), the smaller root
+				const Lane theta = (S[q][q] - S[p][p]) / (2 * is_zero.select(Lane::Ones(), apq));
+				Lane t = (theta >= 0).select(Lane::Ones(), -Lane::Ones()) / (theta.abs() + (theta * theta + 1).sqrt());
+				t = is_zero.select(Lane::Zero(), t);
+				const Lane c = (t * t + 1).rsqrt();
+				const Lane s = t * c;
+
+				S[p][p] -= t * apq;
+				S[q][q] += t * apq;
+				S[p][q] = S[q][p] = Lane::Zero();
+
+				const Lane arp = S[r][p];
+				const Lane arq = S[r][q];
+				S[r][p] = S[p][r] = c * arp - s * arq;
+				S[r][q] = S[q][r] = s * arp + c * arq;
+
+				for (int k = 0; k < 3; ++k)
+				{
+					const Lane vkp = V[k][p];
+					const Lane vkq = V[k][q];
+					V[k][p] = c * vkp - s * vkq;
+					V[k][q] = s * vkp + c * vkq;
+				}
+			}
+
+			/// sorts the eigenvalues d by decreasing value, swapping the columns of V with a sign change to keep it a rotation
+			void conditional_swap(Lane d[3], LaneMatrix &V, const int i, const int j)
+			{
+				const Mask swap = d[i] < d[j];
+				const Lane di = d[i];
+				d[i] = swap.select(d[j], d[i]);
+				d[j] = swap.select(di, d[j]);
+
+				for (int k = 0; k < 3; ++k)
+				{
+					const Lane vki = V[k][i];
+					V[k][i] = swap.select(V[k][j], vki);
+					V[k][j] = swap.select(-vki, V[k][j]);
+				}
+			}
+
+			/// Givens rotation on the rows p and q of B cancelling B(q, col), its transpose is accumulated in U
+			void givens_qr_step(LaneMatrix &B, LaneMatrix &U, const int p, const int q, const int col)
+			{
+				const Lane a = B[p][col];
+				const Lane b = B[q][col];
+				const Lane rho = (a * a + b * b).sqrt();
+				const Mask is_zero = rho == 0;
+				const Lane inv_rho = is_zero.select(Lane::Ones(), rho).inverse();
+				const Lane c = is_zero.select(Lane::Ones(), a * inv_rho);
+				const Lane s = is_zero.select(Lane::Zero(), b * inv_rho);
+
+				for (int k = 0; k < 3; ++k)
+				{
+					const Lane bpk = B[p][k];
+					const Lane bqk = B[q][k];
+					B[p][k] = c * bpk + s * bqk;
+					B[q][k] = c * bqk - s * bpk;
+
+					const Lane ukp = U[k][p];
+					const Lane ukq = U[k][q];
+					U[k][p] = c * ukp + s * ukq;
+					U[k][q] = c * ukq - s * ukp;
+				}
+			}
+
+			void svd_3x3(const LaneMatrix &A, LaneMatrix &U, Lane sigma[3], LaneMatrix &V)
+			{
+				// eigen-decomposition of the normal equations A^T A = V diag(d) V^T
+				LaneMatrix S;
+				for (int i = 0; i < 3; ++i)
+				{
+					for (int j = i; j < 3; ++j)
+					{
+						S[i][j] = A[0][i] * A[0][j] + A[1][i] * A[1][j] + A[2][i] * A[2][j];
+						S[j][i] = S[i][j];
+					}
+				}
+
+				for (int i = 0; i < 3; ++i)
+					for (int j = 0; j < 3; ++j)
+						V[i][j] = i == j ? Lane::Ones() : Lane::Zero();
+
+				for (int sweep = 0; sweep < N_JACOBI_SWEEPS; ++sweep)
+				{
+					jacobi_rotation(S, V, 0, 1);
+					jacobi_rotation(S, V, 0, 2);
+					jacobi_rotation(S, V, 1, 2);
+				}
+
+				Lane d[3] = {S[0][0], S[1][1], S[2][2]};
+				conditional_swap(d, V, 0, 1);
+				conditional_swap(d, V, 0, 2);
+				conditional_swap(d, V, 1, 2);
+
+				// QR of A V, its columns are orthogonal so R is diagonal
+				LaneMatrix B;
+				for (int i = 0; i < 3; ++i)
+				{
+					for (int j = 0; j < 3; ++j)
+					{
+						B[i][j] = A[i][0] * V[0][j] + A[i][1] * V[1][j] + A[i][2] * V[2][j];
+						U[i][j] = i == j ? Lane::Ones() : Lane::Zero();
+					}
+				}
+
+				givens_qr_step(B, U, 0, 1, 0);
+				givens_qr_step(B, U, 0, 2, 0);
+				givens_qr_step(B, U, 1, 2, 1);
+
+				// the first two are non-negative by construction, the last one carries the sign of det(A)
+				for (int i = 0; i < 3; ++i)
+					sigma[i] = B[i][i];
+			}
+		} // namespace
+
+		void batched_svd_3x3(
+			const std::vector<Eigen::Matrix3d> &F,
+			std::vector<Eigen::Matrix3d> &U,
+			std::vector<Eigen::Vector3d> &sigma,
+			std::vector<Eigen::Matrix3d> &V)
+		{
+			const int n = F.size();
+			U.resize(n);
+			sigma.resize(n);
+			V.resize(n);
+
+			LaneMatrix A, Ub, Vb;
+			Lane sb[3];
+			for (int start = 0; start < n; start += BATCHED_SVD_WIDTH)
+			{
+				const int n_lanes = std::min(BATCHED_SVD_WIDTH, n - start);
+
+				for (int i = 0; i < 3; ++i)
+				{
+					for (int j = 0; j < 3; ++j)
+					{
+						// unused lanes are padded with the identity
+						A[i][j].setConstant(i == j ? 1 : 0);
+						for (int l = 0; l < n_lanes; ++l)
+							A[i][j](l) = F[start + l](i, j);
+					}
+				}
+
+				svd_3x3(A, Ub, sb, Vb);
+
+				for (int l = 0; l < n_lanes; ++l)
+				{
+					for (int i = 0; i < 3; ++i)
+					{
+						sigma[start + l](i) = sb[i](l);
+						for (int j = 0; j < 3; ++j)
+						{
+							U[start + l](i, j) = Ub[i][j](l);
+							V[start + l](i, j) = Vb[i][j](l);
+						}
+					}
+				}
+			}
+		}
+
+		void batched_polar_decomposition_3x3(
+			const std::vector<Eigen::Matrix3d> &F,
+			std::vector<Eigen::Matrix3d> &R,
+			std::vector<Eigen::Matrix3d> &S)
+		{
+			std::vector<Eigen::Matrix3d> U, V;
+			std::vector<Eigen::Vector3d> sigma;
+			batched_svd_3x3(F, U, sigma, V);
+
+			R.resize(F.size());
+			S.resize(F.size());
+			for (int i = 0; i < F.size(); ++i)
+			{
+				R[i] = U[i] * V[i].transpose();
+				S[i] = V[i] * sigma[i].asDiagonal() * V[i].transpose();
+			}
+		}
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// Number of matrices decomposed together by the batched 3x3 SVD, one per SIMD lane.
+		constexpr int BATCHED_SVD_WIDTH = 4;
+
+		/// SVD of a batch of 3x3 matrices (e.g., the deformation gradients at the quadrature points of an element),
+		/// F[i] = U[i] * diag(sigma[i]) * V[i]^T.
+		/// Same convention as AutoFlipSVD: U and V are rotations, the singular values are sorted
+		/// by decreasing magnitude, and only the last one can be negative.
+		/// The matrices are processed BATCHED_SVD_WIDTH at a time with the same sequence of
+		/// operations (a fixed number of Jacobi sweeps on F^T F followed by a Givens QR of F V),
+		/// so the work vectorizes across the batch instead of branching per matrix.
+		/// @param[in] F matrices to decompose
+		/// @param[out] U left singular vectors
+		/// @param[out] sigma singular values
+		/// @param[out] V right singular vectors
+		void batched_svd_3x3(
+			const std::vector<Eigen::Matrix3d> &F,
+			std::vector<Eigen::Matrix3d> &U,
+			std::vector<Eigen::Vector3d> &sigma,
+			std::vector<Eigen::Matrix3d> &V);
+
+		/// Polar decomposition of a batch of 3x3 matrices, F[i] = R[i] * S[i] with R[i] a rotation
+		/// and S[i] symmetric, computed from batched_svd_3x3.
+		/// @param[in] F matrices to decompose
+		/// @param[out] R rotations
+		/// @param[out] S symmetric stretches
+		void batched_polar_decomposition_3x3(
+			const std::vector<Eigen::Matrix3d> &F,
+			std::vector<Eigen::Matrix3d> &R,
+			std::vector<Eigen::Matrix3d> &S);
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,228 @@
+#include "BlockSparseMatrix.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace polyfem::utils
+{
+	void BlockSparseMatrix::init(const int block_rows, const int block_cols, const int block_size, std::vector<std::pair<int, int>> blocks, const bool symmetric)
+	{
+		assert(block_size > 0);
+		assert(!symmetric || block_rows == block_cols);
+		block_size_ = block_size;
+		block_rows_ = block_rows;
+		block_cols_ = block_cols;
+		symmetric_ = symmetric;
+
+		if (symmetric_)
+			blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [](const auto &b) { return b.first > b.second; }), blocks.end());
+		std::sort(blocks.begin(), blocks.end());
+		blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+
+		block_outer_.assign(block_rows_ + 1, 0);
+		block_index_.resize(blocks.size());
+		column_outer_.assign(block_cols_ + 1, 0);
+		for (size_t k = 0; k < blocks.size(); ++k)
+		{
+			const auto [bi, bj] = blocks[k];
+			assert(bi >= 0 && bi < block_rows_ && bj >= 0 && bj < block_cols_);
+			++block_outer_[bi + 1];
+			++column_outer_[bj + 1];
+			block_index_[k] = bj;
+		}
+		for (int bi = 0; bi < block_rows_; ++bi)
+			block_outer_[bi + 1] += block_outer_[bi];
+		for (int bj = 0; bj < block_cols_; ++bj)
+			column_outer_[bj + 1] += column_outer_[bj];
+
+		// the slots are visited by increasing block row, so every block column is sorted by block row
+		column_slots_.resize(blocks.size());
+		column_rows_.resize(blocks.size());
+		std::vector<int> column_fill(column_outer_.begin(), column_outer_.end() - 1);
+		for (size_t k = 0; k < blocks.size(); ++k)
+		{
+			const int s = column_fill[blocks[k].second]++;
+			column_slots_[s] = k;
+			column_rows_[s] = blocks[k].first;
+		}
+
+		values_.assign(blocks.size() * block_size_ * block_size_, 0);
+	}
+
+	void BlockSparseMatrix::init(const StiffnessMatrix &mat, const int block_size, const bool symmetric)
+	{
+		if (mat.rows() % block_size != 0 || mat.cols() % block_size != 0)
+			log_and_throw_error("Matrix of size {}x{} cannot be split in blocks of size {}", mat.rows(), mat.cols(), block_size);
+
+		std::vector<std::pair<int, int>> blocks;
+		blocks.reserve(mat.nonZeros() / (block_size * block_size) + 1);
+		for (int k = 0; k < mat.outerSize(); ++k)
+			for (StiffnessMatrix::InnerIterator it(mat, k); it; ++it)
+				blocks.emplace_back(it.row() / block_size, it.col() / block_size);
+
+		init(mat.rows() / block_size, mat.cols() / block_size, block_size, std::move(blocks), symmetric);
+
+		for (int k = 0; k < mat.outerSize(); ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(mat, k); it; ++it)
+			{
+				// -1 for the blocks below the diagonal of a symmetric matrix
+				const int slot = block_slot(it.row() / block_size, it.col() / block_size);
+				if (slot >= 0)
+					block(slot)[(it.row() % block_size) * block_size + it.col() % block_size] += it.value();
+			}
+		}
+	}
+
+	int BlockSparseMatrix::block_slot(const int bi, const int bj) const
+	{
+		if (bi < 0 || bi >= block_rows_)
+			return -1;
+
+		const auto begin = block_index_.begin() + block_outer_[bi];
+		const auto end = block_index_.begin() + block_outer_[bi + 1];
+		const auto it = std::lower_bound(begin, end, bj);
+		if (it == end || *it != bj)
+			return -1;
+		return it - block_index_.begin();
+	}
+
+	std::pair<int, int> BlockSparseMatrix::block_coordinates(const int slot) const
+	{
+		assert(slot >= 0 && slot < non_zero_blocks());
+		const int bi = std::upper_bound(block_outer_.begin(), block_outer_.end(), slot) - block_outer_.begin() - 1;
+		return {bi, block_index_[slot]};
+	}
+
+	void BlockSparseMatrix::set_zero()
+	{
+		std::fill(values_.begin(), values_.end(), 0);
+	}
+
+	bool BlockSparseMatrix::same_pattern(const BlockSparseMatrix &o) const
+	{
+		return block_size_ == o.block_size_ && block_rows_ == o.block_rows_ && block_cols_ == o.block_cols_ && symmetric_ == o.symmetric_
+			   && block_outer_ == o.block_outer_ && block_index_ == o.block_index_;
+	}
+
+	void BlockSparseMatrix::operator+=(const BlockSparseMatrix &o)
+	{
+		assert(same_pattern(o));
+		for (size_t i = 0; i < values_.size(); ++i)
+			values_[i] += o.values_[i];
+	}
+
+	template <int BLOCK_SIZE>
+	void BlockSparseMatrix::multiply_aux(const Eigen::VectorXd &x, Eigen::VectorXd &out) const
+	{
+		// fixed size blocks for BLOCK_SIZE > 0
+		const int bs = BLOCK_SIZE > 0 ? BLOCK_SIZE : block_size_;
+		using Block = Eigen::Matrix<double, BLOCK_SIZE, BLOCK_SIZE, Eigen::RowMajor>;
+		using Segment = Eigen::Matrix<double, BLOCK_SIZE, 1>;
+
+		// every block row is written by one thread only
+		maybe_parallel_for(block_rows_, [&](int start, int end, int thread_id) {
+			for (int bi = start; bi < end; ++bi)
+			{
+				Segment sum = Segment::Zero(bs);
+				for (int slot = block_outer_[bi]; slot < block_outer_[bi + 1]; ++slot)
+					sum.noalias() += Eigen::Map<const Block>(block(slot), bs, bs) * x.segment<BLOCK_SIZE>(block_index_[slot] * bs, bs);
+
+				// the blocks (bi, k) with k < bi are the transposes of the stored (k, bi), read by block column
+				// so that every block row is still written by one thread only
+				if (symmetric_)
+				{
+					for (int s = column_outer_[bi]; s < column_outer_[bi + 1] && column_rows_[s] < bi; ++s)
+						sum.noalias() += Eigen::Map<const Block>(block(column_slots_[s]), bs, bs).transpose() * x.segment<BLOCK_SIZE>(column_rows_[s] * bs, bs);
+				}
+
+				out.segment<BLOCK_SIZE>(bi * bs, bs) = sum;
+			}
+		});
+	}
+
+	void BlockSparseMatrix::multiply(const Eigen::VectorXd &x, Eigen::VectorXd &out) const
+	{
+		assert(x.size() == cols());
+		out.resize(rows());
+
+		if (block_size_ == 2)
+			multiply_aux<2>(x, out);
+		else if (block_size_ == 3)
+			multiply_aux<3>(x, out);
+		else
+			multiply_aux<Eigen::Dynamic>(x, out);
+	}
+
+	void BlockSparseMatrix::to_sparse(StiffnessMatrix &mat) const
+	{
+		const int bs = block_size_;
+		// the blocks above the diagonal of a symmetric matrix are written twice
+		size_t n_entries = values_.size();
+		if (symmetric_)
+		{
+			for (int bi = 0; bi < block_rows_; ++bi)
+				for (int slot = block_outer_[bi]; slot < block_outer_[bi + 1]; ++slot)
+					if (block_index_[slot] != bi)
+						n_entries += bs * bs;
+		}
+
+		mat.resize(rows(), cols());
+		mat.resizeNonZeros(n_entries);
+
+		auto *outer = mat.outerIndexPtr();
+		auto *inner = mat.innerIndexPtr();
+		double *values = mat.valuePtr();
+
+		// column c of block column bj has the column c % bs of the blocks of bj, by increasing row,
+		// then for a symmetric matrix the row c % bs of the blocks (bj, k) with k > bj (i.e., of their transposes)
+		outer[0] = 0;
+		for (int bj = 0; bj < block_cols_; ++bj)
+		{
+			for (int lc = 0; lc < bs; ++lc)
+			{
+				const int c = bj * bs + lc;
+				auto k = outer[c];
+				for (int s = column_outer_[bj]; s < column_outer_[bj + 1]; ++s)
+				{
+					const int bi = column_rows_[s];
+					const double *b = block(column_slots_[s]);
+					for (int lr = 0; lr < bs; ++lr, ++k)
+					{
+						inner[k] = bi * bs + lr;
+						values[k] = b[lr * bs + lc];
+					}
+				}
+
+				if (symmetric_)
+				{
+					for (int slot = block_outer_[bj]; slot < block_outer_[bj + 1]; ++slot)
+					{
+						const int bk = block_index_[slot];
+						if (bk == bj)
+							continue;
+						const double *b = block(slot);
+						for (int lr = 0; lr < bs; ++lr, ++k)
+						{
+							inner[k] = bk * bs + lr;
+							values[k] = b[lc * bs + lr];
+						}
+					}
+				}
+
+				outer[c + 1] = k;
+			}
+		}
+		assert(outer[cols()] == n_entries);
+	}
+
+	size_t BlockSparseMatrix::memory_bytes() const
+	{
+		return utils::memory_bytes(block_outer_) + utils::memory_bytes(block_index_) + utils::memory_bytes(values_)
+			   + utils::memory_bytes(column_outer_) + utils::memory_bytes(column_slots_) + utils::memory_bytes(column_rows_);
+	}
+} // namespace polyfem::utils
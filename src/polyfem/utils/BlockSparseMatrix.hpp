@@ -0,0 +1,91 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <utility>
+#include <vector>
+
+namespace polyfem::utils
+{
+	/// Sparse matrix stored by dense square blocks in compressed block rows (BSR), e.g., the 3x3 blocks coupling
+	/// two nodes of a 3D elasticity hessian. There is one column index per block instead of one per entry, and the
+	/// entries of a block are contiguous (row-major).
+	/// A symmetric matrix only stores the blocks on and above the diagonal, the other ones are their transposes.
+	class BlockSparseMatrix
+	{
+	public:
+		BlockSparseMatrix() {}
+
+		/// set the pattern to the given blocks of a block_rows x block_cols matrix of blocks, all the values are zero
+		/// @param blocks block row and block column of every block, duplicates are merged
+		/// @param symmetric only keep the blocks on and above the diagonal
+		void init(const int block_rows, const int block_cols, const int block_size, std::vector<std::pair<int, int>> blocks, const bool symmetric = false);
+		/// pattern and values of the blocks of a scalar matrix, its size has to be a multiple of block_size
+		/// @param symmetric only keep the blocks on and above the diagonal, mat has to be symmetric
+		void init(const StiffnessMatrix &mat, const int block_size, const bool symmetric = false);
+
+		int block_size() const { return block_size_; }
+		int block_rows() const { return block_rows_; }
+		int block_cols() const { return block_cols_; }
+		int rows() const { return block_rows_ * block_size_; }
+		int cols() const { return block_cols_ * block_size_; }
+		bool is_symmetric() const { return symmetric_; }
+		/// number of stored blocks
+		int non_zero_blocks() const { return block_index_.size(); }
+		/// number of stored scalar entries, including the explicit zeros of the blocks
+		size_t non_zeros() const { return values_.size(); }
+
+		/// slot of the block (bi, bj), -1 if it is not stored (e.g., below the diagonal of a symmetric matrix)
+		int block_slot(const int bi, const int bj) const;
+		/// block row and block column of the block in slot
+		std::pair<int, int> block_coordinates(const int slot) const;
+		/// row-major entries of the block in slot
+		double *block(const int slot) { return values_.data() + size_t(slot) * block_size_ * block_size_; }
+		const double *block(const int slot) const { return values_.data() + size_t(slot) * block_size_ * block_size_; }
+
+		/// set all the values to zero, the pattern is kept
+		void set_zero();
+
+		/// if o has the same size and blocks
+		bool same_pattern(const BlockSparseMatrix &o) const;
+		/// add the values of o, which has the same pattern
+		void operator+=(const BlockSparseMatrix &o);
+
+		/// out = A * x, the blocks are applied with fixed-size kernels for 2x2 and 3x3 blocks
+		void multiply(const Eigen::VectorXd &x, Eigen::VectorXd &out) const;
+
+		/// scalar sparse matrix with the same entries, the explicit zeros of the blocks are kept
+		/// the storage of mat is reused if it is large enough
+		void to_sparse(StiffnessMatrix &mat) const;
+		StiffnessMatrix to_sparse() const
+		{
+			StiffnessMatrix mat;
+			to_sparse(mat);
+			return mat;
+		}
+
+		/// heap memory in bytes
+		size_t memory_bytes() const;
+
+	private:
+		int block_size_ = 1;
+		int block_rows_ = 0;
+		int block_cols_ = 0;
+		bool symmetric_ = false;
+
+		std::vector<int> block_outer_; ///< first slot of every block row, block_rows + 1 entries
+		std::vector<int> block_index_; ///< block column of every slot, sorted in each block row
+		std::vector<double> values_;   ///< block_size^2 values of every slot
+
+		// transposed pattern, used to write the column-major scalar matrix
+		std::vector<int> column_outer_; ///< first entry of every block column in column_slots_, block_cols + 1 entries
+		std::vector<int> column_slots_; ///< slots of every block column, by increasing block row
+		std::vector<int> column_rows_;  ///< block row of every entry of column_slots_
+
+		template <int BLOCK_SIZE>
+		void multiply_aux(const Eigen::VectorXd &x, Eigen::VectorXd &out) const;
+	};
+} // namespace polyfem::utils
@@ -8,7 +8,9 @@
 #include <igl/PI.h>
 
 #include <tinyexpr.h>
+#include <array>
 #include <filesystem>
+#include <memory>
 
 #include <iostream>
 
@@ -60,6 +62,255 @@ namespace polyfem
 			return a < b ? 1.0 : 0.0;
 		}
 
+		// variables and functions available in the expressions, bound to x, y, z, and t
+		static std::vector<te_variable> expression_variables(double &x, double &y, double &z, double &t)
+		{
+			return {
+				{"x", &x, TE_VARIABLE},
+				{"y", &y, TE_VARIABLE},
+				{"z", &z, TE_VARIABLE},
+				{"t", &t, TE_VARIABLE},
+				{"min", (const void *)min, TE_FUNCTION2 | TE_FLAG_PURE},
+				{"max", (const void *)max, TE_FUNCTION2 | TE_FLAG_PURE},
+				{"smoothstep", (const void *)smoothstep, TE_FUNCTION1 | TE_FLAG_PURE},
+				{"half_smoothstep", (const void *)half_smoothstep, TE_FUNCTION1 | TE_FLAG_PURE},
+				{"deg2rad", (const void *)deg2rad, TE_FUNCTION1 | TE_FLAG_PURE},
+				{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3 | TE_FLAG_PURE},
+				{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3 | TE_FLAG_PURE},
+				{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3 | TE_FLAG_PURE},
+				{"compare", (const void *)compare, TE_FUNCTION2 | TE_FLAG_PURE},
+				{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2 | TE_FLAG_PURE},
+				{"sign", (const void *)sign, TE_FUNCTION1 | TE_FLAG_PURE},
+			};
+		}
+
+		/// tinyexpr tree lowered once to a flat postfix program on x, y, z, t, with the constant subexpressions folded
+		class CompiledExpression
+		{
+		public:
+			/// nullptr if the expression does not parse or uses closures
+			static std::shared_ptr<const CompiledExpression> compile(const std::string &expr);
+
+			double eval(const double x, const double y, const double z, const double t) const;
+			/// evaluates at the rows of pts, every instruction processes all the points
+			void eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &res) const;
+
+			bool is_constant() const { return code_.size() == 1 && code_[0].op == Op::CONSTANT; }
+			bool depends_on_t() const { return uses_[3]; }
+			bool depends_on_space() const { return uses_[0] || uses_[1] || uses_[2]; }
+
+		private:
+			enum class Op
+			{
+				CONSTANT,
+				VARIABLE,
+				FUNCTION
+			};
+
+			struct Instruction
+			{
+				Op op;
+				int arity = 0;           ///< number of arguments of a function
+				int slot = 0;            ///< x, y, z, t for a variable
+				double value = 0;        ///< constant
+				const void *function = nullptr;
+			};
+
+			/// appends the postfix code of node, false if it cannot be lowered
+			bool lower(const te_expr *node, const double *slots);
+
+			static double call(const void *function, const int arity, const double *args);
+
+			std::vector<Instruction> code_;
+			int max_stack_ = 0;
+			std::array<bool, 4> uses_ = {{false, false, false, false}};
+		};
+
+		namespace
+		{
+			// private in tinyexpr.c
+			constexpr int te_constant = 1;
+			constexpr int te_max_arity = 7;
+			int te_type_mask(const int type) { return type & 0x0000001F; }
+			int te_arity(const int type) { return (type & (TE_FUNCTION0 | TE_CLOSURE0)) ? (type & 0x00000007) : 0; }
+		} // namespace
+
+		std::shared_ptr<const CompiledExpression> CompiledExpression::compile(const std::string &expr)
+		{
+			double slots[4] = {0, 0, 0, 0};
+			std::vector<te_variable> vars = expression_variables(slots[0], slots[1], slots[2], slots[3]);
+
+			int err;
+			te_expr *tree = te_compile(expr.c_str(), vars.data(), vars.size(), &err);
+			if (!tree)
+				return nullptr;
+
+			auto res = std::make_shared<CompiledExpression>();
+			const bool ok = res->lower(tree, slots);
+			te_free(tree);
+			if (!ok)
+				return nullptr;
+
+			int stack = 0;
+			for (const auto &inst : res->code_)
+			{
+				stack += inst.op == Op::FUNCTION ? 1 - inst.arity : 1;
+				res->max_stack_ = std::max(res->max_stack_, stack);
+			}
+			assert(stack == 1);
+
+			return res;
+		}
+
+		bool CompiledExpression::lower(const te_expr *node, const double *slots)
+		{
+			const int type = te_type_mask(node->type);
+			if (type == te_constant)
+			{
+				code_.push_back({Op::CONSTANT, 0, 0, node->value, nullptr});
+				return true;
+			}
+			if (type == TE_VARIABLE)
+			{
+				const int slot = node->bound - slots;
+				if (slot < 0 || slot >= 4)
+					return false;
+				uses_[slot] = true;
+				code_.push_back({Op::VARIABLE, 0, slot, 0, nullptr});
+				return true;
+			}
+			if (type < TE_FUNCTION0 || type > TE_FUNCTION0 + te_max_arity)
+				return false; // closures
+
+			const int arity = te_arity(node->type);
+			const size_t first = code_.size();
+			for (int i = 0; i < arity; ++i)
+			{
+				if (!lower(static_cast<const te_expr *>(node->parameters[i]), slots))
+					return false;
+			}
+
+			// the arguments of a pure function are the last arity instructions iff they are all constant
+			bool constant = (node->type & TE_FLAG_PURE) && code_.size() - first == size_t(arity);
+			for (size_t i = first; i < code_.size() && constant; ++i)
+				constant = code_[i].op == Op::CONSTANT;
+
+			if (constant)
+			{
+				double args[te_max_arity];
+				for (int i = 0; i < arity; ++i)
+					args[i] = code_[first + i].value;
+				code_.resize(first);
+				code_.push_back({Op::CONSTANT, 0, 0, call(node->function, arity, args), nullptr});
+			}
+			else
+				code_.push_back({Op::FUNCTION, arity, 0, 0, node->function});
+
+			return true;
+		}
+
+		double CompiledExpression::call(const void *function, const int arity, const double *a)
+		{
+			void *f = const_cast<void *>(function);
+			switch (arity)
+			{
+			case 0: return reinterpret_cast<double (*)()>(f)();
+			case 1: return reinterpret_cast<double (*)(double)>(f)(a[0]);
+			case 2: return reinterpret_cast<double (*)(double, double)>(f)(a[0], a[1]);
+			case 3: return reinterpret_cast<double (*)(double, double, double)>(f)(a[0], a[1], a[2]);
+			case 4: return reinterpret_cast<double (*)(double, double, double, double)>(f)(a[0], a[1], a[2], a[3]);
+			case 5: return reinterpret_cast<double (*)(double, double, double, double, double)>(f)(a[0], a[1], a[2], a[3], a[4]);
+			case 6: return reinterpret_cast<double (*)(double, double, double, double, double, double)>(f)(a[0], a[1], a[2], a[3], a[4], a[5]);
+			case 7: return reinterpret_cast<double (*)(double, double, double, double, double, double, double)>(f)(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+			default: assert(false); return std::nan("");
+			}
+		}
+
+		double CompiledExpression::eval(const double x, const double y, const double z, const double t) const
+		{
+			if (is_constant())
+				return code_[0].value;
+
+			const double vars[4] = {x, y, z, t};
+			// small expressions fit on the stack
+			constexpr int max_local = 64;
+			double local[max_local];
+			std::vector<double> heap;
+			double *stack = local;
+			if (max_stack_ > max_local)
+			{
+				heap.resize(max_stack_);
+				stack = heap.data();
+			}
+
+			int sp = 0;
+			for (const auto &inst : code_)
+			{
+				switch (inst.op)
+				{
+				case Op::CONSTANT:
+					stack[sp++] = inst.value;
+					break;
+				case Op::VARIABLE:
+					stack[sp++] = vars[inst.slot];
+					break;
+				case Op::FUNCTION:
+					sp -= inst.arity;
+					stack[sp] = call(inst.function, inst.arity, stack + sp);
+					++sp;
+					break;
+				}
+			}
+			assert(sp == 1);
+			return stack[0];
+		}
+
+		void CompiledExpression::eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &res) const
+		{
+			const int n = pts.rows();
+			if (is_constant())
+			{
+				res.setConstant(n, code_[0].value);
+				return;
+			}
+
+			std::vector<Eigen::ArrayXd> stack(max_stack_);
+			int sp = 0;
+			for (const auto &inst : code_)
+			{
+				switch (inst.op)
+				{
+				case Op::CONSTANT:
+					stack[sp++].setConstant(n, inst.value);
+					break;
+				case Op::VARIABLE:
+					if (inst.slot == 3)
+						stack[sp++].setConstant(n, t);
+					else if (inst.slot < pts.cols())
+						stack[sp++] = pts.col(inst.slot);
+					else
+						stack[sp++].setZero(n);
+					break;
+				case Op::FUNCTION:
+				{
+					sp -= inst.arity;
+					Eigen::ArrayXd out(n);
+					double args[te_max_arity];
+					for (int i = 0; i < n; ++i)
+					{
+						for (int a = 0; a < inst.arity; ++a)
+							args[a] = stack[sp + a](i);
+						out(i) = call(inst.function, inst.arity, args);
+					}
+					stack[sp++] = std::move(out);
+					break;
+				}
+				}
+			}
+			assert(sp == 1);
+			res = stack[0].matrix();
+		}
+
 		ExpressionValue::ExpressionValue()
 		{
 			clear();
@@ -73,6 +324,7 @@ namespace polyfem
 			sfunc_ = nullptr;
 			tfunc_ = nullptr;
 			value_ = 0;
+			program_ = nullptr;
 		}
 
 		void ExpressionValue::init(const double val)
@@ -117,23 +369,7 @@ namespace polyfem
 
 			double x = 0, y = 0, z = 0, t = 0;
 
-			std::vector<te_variable> vars = {
-				{"x", &x, TE_VARIABLE},
-				{"y", &y, TE_VARIABLE},
-				{"z", &z, TE_VARIABLE},
-				{"t", &t, TE_VARIABLE},
-				{"min", (const void *)min, TE_FUNCTION2},
-				{"max", (const void *)max, TE_FUNCTION2},
-				{"smoothstep", (const void *)smoothstep, TE_FUNCTION1},
-				{"half_smoothstep", (const void *)half_smoothstep, TE_FUNCTION1},
-				{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-				{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-				{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-				{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-				{"compare", (const void *)compare, TE_FUNCTION2},
-				{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-				{"sign", (const void *)sign, TE_FUNCTION1},
-			};
+			std::vector<te_variable> vars = expression_variables(x, y, z, t);
 
 			int err;
 			te_expr *tmp = te_compile(expr.c_str(), vars.data(), vars.size(), &err);
@@ -144,6 +380,8 @@ namespace polyfem
 				assert(false);
 			}
 			te_free(tmp);
+
+			program_ = CompiledExpression::compile(expr);
 		}
 
 		void ExpressionValue::init(const json &vals)
@@ -241,6 +479,69 @@ namespace polyfem
 			}
 		}
 
+		bool ExpressionValue::is_time_dependent() const
+		{
+			if (!expr_.empty())
+				return !program_ || program_->depends_on_t();
+			for (const auto &e : mat_expr_)
+			{
+				if (e.is_time_dependent())
+					return true;
+			}
+			return t_index_.size() > 0 || tfunc_ || sfunc_;
+		}
+
+		bool ExpressionValue::is_constant() const
+		{
+			if (!expr_.empty())
+				return program_ && !program_->depends_on_space() && !program_->depends_on_t();
+			return t_index_.empty() && !tfunc_ && !sfunc_ && mat_expr_.empty() && mat_.size() == 0;
+		}
+
+		void ExpressionValue::evaluate(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &res, const int index) const
+		{
+			assert(unit_type_set_);
+			assert(pts.cols() == 2 || pts.cols() == 3);
+
+			res.resize(pts.rows());
+			if (expr_.empty())
+			{
+				for (int i = 0; i < pts.rows(); ++i)
+					res(i) = (*this)(pts(i, 0), pts(i, 1), pts.cols() == 2 ? 0 : pts(i, 2), t, index);
+				return;
+			}
+
+			if (program_)
+				program_->eval(pts, t, res);
+			else
+			{
+				// compiled once, the variables are bound to x, y, z, and t
+				double x = 0, y = 0, z = 0, tt = t;
+				std::vector<te_variable> vars = expression_variables(x, y, z, tt);
+
+				int err;
+				te_expr *tmp = te_compile(expr_.c_str(), vars.data(), vars.size(), &err);
+				assert(tmp != nullptr);
+				for (int i = 0; i < pts.rows(); ++i)
+				{
+					x = pts(i, 0);
+					y = pts(i, 1);
+					z = pts.cols() == 2 ? 0 : pts(i, 2);
+					res(i) = te_eval(tmp);
+				}
+				te_free(tmp);
+			}
+
+			if (!unit_.base_units().empty())
+			{
+				if (!unit_.is_convertible(unit_type_))
+					log_and_throw_error(fmt::format("Cannot convert {} to {}", units::to_string(unit_), units::to_string(unit_type_)));
+
+				for (int i = 0; i < res.size(); ++i)
+					res(i) = units::convert(res(i), unit_, unit_type_);
+			}
+		}
+
 		double ExpressionValue::operator()(double x, double y, double z, double t, int index) const
 		{
 			assert(unit_type_set_);
@@ -274,26 +575,13 @@ namespace polyfem
 				else
 					result = value_;
 			}
+			else if (program_)
+			{
+				result = program_->eval(x, y, z, t);
+			}
 			else
 			{
-
-				std::vector<te_variable> vars = {
-					{"x", &x, TE_VARIABLE},
-					{"y", &y, TE_VARIABLE},
-					{"z", &z, TE_VARIABLE},
-					{"t", &t, TE_VARIABLE},
-					{"min", (const void *)min, TE_FUNCTION2},
-					{"max", (const void *)max, TE_FUNCTION2},
-					{"smoothstep", (const void *)smoothstep, TE_FUNCTION1},
-					{"half_smoothstep", (const void *)half_smoothstep, TE_FUNCTION1},
-					{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-					{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-					{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-					{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-					{"compare", (const void *)compare, TE_FUNCTION2},
-					{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-					{"sign", (const void *)sign, TE_FUNCTION1},
-				};
+				std::vector<te_variable> vars = expression_variables(x, y, z, t);
 
 				int err;
 				te_expr *tmp = te_compile(expr_.c_str(), vars.data(), vars.size(), &err);
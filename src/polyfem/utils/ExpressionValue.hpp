@@ -2,6 +2,7 @@
 
 #include <polyfem/Common.hpp>
 #include <map>
+#include <memory>
 
 #include <units/units.hpp>
 
@@ -9,6 +10,8 @@ namespace polyfem
 {
 	namespace utils
 	{
+		class CompiledExpression;
+
 		class ExpressionValue
 		{
 		public:
@@ -35,6 +38,13 @@ namespace polyfem
 			void set_t(const json &t);
 
 			double operator()(double x, double y, double z = 0, double t = 0, int index = -1) const;
+			/// false if the value does not change over time, e.g., an expression without t
+			bool is_time_dependent() const;
+			/// true if the value depends neither on the position, the time, nor the index
+			bool is_constant() const;
+
+			/// evaluates the expression at the rows of pts (#pts x 2 or 3), the expression is compiled only once
+			void evaluate(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &res, const int index = -1) const;
 
 			void clear();
 
@@ -71,6 +81,8 @@ namespace polyfem
 			int tfunc_coo_;
 
 			std::string expr_;
+			/// expr_ lowered once, shared between the copies
+			std::shared_ptr<const CompiledExpression> program_;
 			double value_;
 			Eigen::MatrixXd mat_;
 			std::vector<ExpressionValue> mat_expr_;
@@ -0,0 +1,44 @@
+#include "GraphColoring.hpp"
+
+#include <cassert>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		std::vector<std::vector<int>> greedy_coloring(const std::vector<std::vector<int>> &item_nodes, const int n_nodes)
+		{
+			std::vector<std::vector<int>> colors;
+			// colours already used by the items touching each node
+			std::vector<std::vector<int>> node_colors(n_nodes);
+			std::vector<bool> forbidden;
+
+			for (int i = 0; i < item_nodes.size(); ++i)
+			{
+				forbidden.assign(colors.size(), false);
+				for (const int n : item_nodes[i])
+				{
+					assert(n >= 0 && n < n_nodes);
+					for (const int c : node_colors[n])
+						forbidden[c] = true;
+				}
+
+				int color = 0;
+				while (color < forbidden.size() && forbidden[color])
+					++color;
+
+				if (color == colors.size())
+					colors.emplace_back();
+				colors[color].push_back(i);
+
+				for (const int n : item_nodes[i])
+				{
+					if (node_colors[n].empty() || node_colors[n].back() != color)
+						node_colors[n].push_back(color);
+				}
+			}
+
+			return colors;
+		}
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// Greedy colouring of a list of items (e.g., elements) such that two items
+		/// with the same colour never touch the same node.
+		/// Items of one colour can then write to shared per-node storage concurrently.
+		/// @param[in] item_nodes list of nodes touched by each item
+		/// @param[in] n_nodes total number of nodes
+		/// @return one list of item ids per colour
+		std::vector<std::vector<int>> greedy_coloring(const std::vector<std::vector<int>> &item_nodes, const int n_nodes);
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,105 @@
+#include "GraphPartitioning.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		namespace
+		{
+			void bisect(const Eigen::MatrixXd &points, const std::vector<int>::iterator begin, const std::vector<int>::iterator end, const int first_part, const int n_parts, std::vector<int> &parts)
+			{
+				if (n_parts == 1 || end - begin <= 1)
+				{
+					for (auto it = begin; it != end; ++it)
+						parts[*it] = first_part;
+					return;
+				}
+
+				Eigen::RowVectorXd min = points.row(*begin), max = points.row(*begin);
+				for (auto it = begin; it != end; ++it)
+				{
+					min = min.cwiseMin(points.row(*it));
+					max = max.cwiseMax(points.row(*it));
+				}
+				int axis;
+				(max - min).maxCoeff(&axis);
+
+				const int left_parts = n_parts / 2;
+				const auto mid = begin + (end - begin) * left_parts / n_parts;
+				std::nth_element(begin, mid, end, [&](const int a, const int b) {
+					return points(a, axis) < points(b, axis) || (points(a, axis) == points(b, axis) && a < b);
+				});
+
+				bisect(points, begin, mid, first_part, left_parts, parts);
+				bisect(points, mid, end, first_part + left_parts, n_parts - left_parts, parts);
+			}
+		} // namespace
+
+		std::vector<int> recursive_coordinate_bisection(const Eigen::MatrixXd &points, const int n_parts)
+		{
+			if (n_parts < 1)
+				log_and_throw_error("Invalid number of parts {}", n_parts);
+
+			std::vector<int> ids(points.rows());
+			std::iota(ids.begin(), ids.end(), 0);
+
+			std::vector<int> parts(points.rows(), 0);
+			bisect(points, ids.begin(), ids.end(), 0, n_parts, parts);
+			return parts;
+		}
+
+		DomainPartition partition_domain(const Eigen::MatrixXd &item_centers, const std::vector<std::vector<int>> &item_nodes, const int n_nodes, const int n_parts)
+		{
+			if (item_centers.rows() != item_nodes.size())
+				log_and_throw_error("Partition has {} centers for {} items", item_centers.rows(), item_nodes.size());
+
+			DomainPartition partition;
+			partition.n_parts = n_parts;
+			partition.item_part = recursive_coordinate_bisection(item_centers, n_parts);
+
+			partition.node_owner.assign(n_nodes, -1);
+			for (int i = 0; i < item_nodes.size(); ++i)
+			{
+				const int part = partition.item_part[i];
+				for (const int n : item_nodes[i])
+				{
+					assert(n >= 0 && n < n_nodes);
+					int &owner = partition.node_owner[n];
+					if (owner < 0 || part < owner)
+						owner = part;
+				}
+			}
+
+			partition.owned_nodes.assign(n_parts, {});
+			for (int n = 0; n < n_nodes; ++n)
+			{
+				if (partition.node_owner[n] >= 0)
+					partition.owned_nodes[partition.node_owner[n]].push_back(n);
+			}
+
+			partition.ghost_nodes.assign(n_parts, {});
+			for (int i = 0; i < item_nodes.size(); ++i)
+			{
+				const int part = partition.item_part[i];
+				for (const int n : item_nodes[i])
+				{
+					if (partition.node_owner[n] != part)
+						partition.ghost_nodes[part].push_back(n);
+				}
+			}
+			for (auto &ghosts : partition.ghost_nodes)
+			{
+				std::sort(ghosts.begin(), ghosts.end());
+				ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+			}
+
+			return partition;
+		}
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// Decomposition of a list of items (e.g., elements) and of the nodes they touch into parts.
+		/// Every node is owned by exactly one part, the nodes touched by the items of a part
+		/// and owned by another one are the ghosts of that part.
+		struct DomainPartition
+		{
+			int n_parts = 0;
+			/// part of every item
+			std::vector<int> item_part;
+			/// part owning every node, -1 if no item touches it
+			std::vector<int> node_owner;
+			/// sorted nodes owned by every part
+			std::vector<std::vector<int>> owned_nodes;
+			/// sorted ghost nodes of every part
+			std::vector<std::vector<int>> ghost_nodes;
+		};
+
+		/// Recursive coordinate bisection: splits the points along the axis of largest extent,
+		/// proportionally to the number of parts on each side, until every side has one part.
+		/// @param[in] points one point per row (e.g., element barycenters)
+		/// @param[in] n_parts number of parts
+		/// @return part of every point
+		std::vector<int> recursive_coordinate_bisection(const Eigen::MatrixXd &points, const int n_parts);
+
+		/// Partitions the items by recursive coordinate bisection of their centers,
+		/// a node is owned by the lowest part among the items touching it.
+		/// @param[in] item_centers center of every item, one per row
+		/// @param[in] item_nodes list of nodes touched by each item
+		/// @param[in] n_nodes total number of nodes
+		/// @param[in] n_parts number of parts
+		DomainPartition partition_domain(const Eigen::MatrixXd &item_centers, const std::vector<std::vector<int>> &item_nodes, const int n_nodes, const int n_parts);
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,82 @@
+#include "GraphReordering.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		std::vector<int> reverse_cuthill_mckee(const std::vector<std::vector<int>> &item_nodes, const int n_nodes)
+		{
+			// node to node adjacency through the items
+			std::vector<std::vector<int>> adjacency(n_nodes);
+			for (const auto &nodes : item_nodes)
+			{
+				for (const int n : nodes)
+				{
+					assert(n >= 0 && n < n_nodes);
+					adjacency[n].insert(adjacency[n].end(), nodes.begin(), nodes.end());
+				}
+			}
+
+			for (int n = 0; n < n_nodes; ++n)
+			{
+				auto &adj = adjacency[n];
+				std::sort(adj.begin(), adj.end());
+				adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+				adj.erase(std::remove(adj.begin(), adj.end(), n), adj.end());
+			}
+
+			const auto by_degree = [&adjacency](const int a, const int b) {
+				return adjacency[a].size() < adjacency[b].size() || (adjacency[a].size() == adjacency[b].size() && a < b);
+			};
+
+			// seeds are visited by increasing degree, one breadth first search per connected component
+			std::vector<int> seeds(n_nodes);
+			for (int n = 0; n < n_nodes; ++n)
+				seeds[n] = n;
+			std::sort(seeds.begin(), seeds.end(), by_degree);
+
+			std::vector<int> order;
+			order.reserve(n_nodes);
+			std::vector<bool> visited(n_nodes, false);
+			std::vector<int> neighbours;
+
+			for (const int seed : seeds)
+			{
+				if (visited[seed])
+					continue;
+
+				visited[seed] = true;
+				size_t head = order.size();
+				order.push_back(seed);
+
+				while (head < order.size())
+				{
+					const int n = order[head++];
+
+					neighbours.clear();
+					for (const int m : adjacency[n])
+					{
+						if (!visited[m])
+						{
+							visited[m] = true;
+							neighbours.push_back(m);
+						}
+					}
+					std::sort(neighbours.begin(), neighbours.end(), by_degree);
+					order.insert(order.end(), neighbours.begin(), neighbours.end());
+				}
+			}
+
+			assert(order.size() == n_nodes);
+
+			std::vector<int> new_ids(n_nodes);
+			for (int i = 0; i < n_nodes; ++i)
+				new_ids[order[n_nodes - 1 - i]] = i;
+
+			return new_ids;
+		}
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// Reverse Cuthill-McKee ordering of the nodes of a list of items (e.g., elements),
+		/// two nodes are adjacent if they are touched by the same item.
+		/// Renumbering the nodes with it reduces the bandwidth of the assembled matrices.
+		/// @param[in] item_nodes list of nodes touched by each item
+		/// @param[in] n_nodes total number of nodes
+		/// @return new id of every node
+		std::vector<int> reverse_cuthill_mckee(const std::vector<std::vector<int>> &item_nodes, const int n_nodes);
+	} // namespace utils
+} // namespace polyfem
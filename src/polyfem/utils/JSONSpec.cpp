@@ -0,0 +1,178 @@
+#include "JSONSpec.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <jse/jse.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		namespace
+		{
+			std::mutex spec_mutex;
+			std::string spec_cache_directory;
+			std::map<std::string, std::shared_ptr<const json>> processed_specs;
+
+			bool read_file(const std::filesystem::path &path, std::string &content)
+			{
+				std::ifstream file(path, std::ios::binary);
+				if (!file.is_open())
+					return false;
+				content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+				return true;
+			}
+
+			/// FNV-1a, stable across platforms and runs unlike std::hash
+			uint64_t hash_bytes(const std::string &bytes, uint64_t hash = 14695981039346656037ull)
+			{
+				for (const char c : bytes)
+				{
+					hash ^= uint64_t(static_cast<unsigned char>(c));
+					hash *= 1099511628211ull;
+				}
+				return hash;
+			}
+
+			/// hash of the spec, the json files it may include, and the tag of the post-processing
+			uint64_t spec_hash(const std::string &spec, const bool inject_includes, const std::string &tag)
+			{
+				uint64_t hash = hash_bytes(spec);
+				hash = hash_bytes(tag, hash);
+				// the post-processing may depend on the build, e.g., on the available linear solvers
+				hash = hash_bytes(__DATE__ " " __TIME__, hash);
+				if (!inject_includes)
+					return hash;
+
+				for (const std::string dir : {POLYFEM_JSON_SPEC_DIR, POLYSOLVE_JSON_SPEC_DIR})
+				{
+					std::vector<std::filesystem::path> files;
+					std::error_code ec;
+					for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+					{
+						if (entry.path().extension() == ".json")
+							files.push_back(entry.path());
+					}
+					std::sort(files.begin(), files.end());
+
+					std::string content;
+					for (const auto &path : files)
+					{
+						hash = hash_bytes(path.filename().string(), hash);
+						if (read_file(path, content))
+							hash = hash_bytes(content, hash);
+					}
+				}
+
+				return hash;
+			}
+
+			std::filesystem::path cache_path(const std::string &dir, const std::string &spec_path, const uint64_t hash)
+			{
+				std::ostringstream name;
+				name << std::filesystem::path(spec_path).stem().string() << "-" << std::hex << hash << ".cbor";
+				return std::filesystem::path(dir) / name.str();
+			}
+
+			bool load_cached(const std::filesystem::path &path, json &rules)
+			{
+				std::string bytes;
+				if (!read_file(path, bytes))
+					return false;
+
+				rules = json::from_cbor(bytes, /*strict=*/true, /*allow_exceptions=*/false);
+				return !rules.is_discarded();
+			}
+
+			void store_cached(const std::filesystem::path &path, const json &rules)
+			{
+				// written next to the target and renamed, concurrent runs never read a partial file
+				std::error_code ec;
+				std::filesystem::create_directories(path.parent_path(), ec);
+				const std::filesystem::path tmp = path.string() + "." + std::to_string(std::random_device{}()) + ".tmp";
+				{
+					std::ofstream file(tmp, std::ios::binary);
+					if (!file.is_open())
+					{
+						logger().warn("Unable to write the spec cache {}", path.string());
+						return;
+					}
+					const std::vector<uint8_t> bytes = json::to_cbor(rules);
+					file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+				}
+				std::filesystem::rename(tmp, path, ec);
+				if (ec)
+					std::filesystem::remove(tmp, ec);
+			}
+		} // namespace
+
+		std::shared_ptr<const json> load_spec_rules(
+			const std::string &spec_path,
+			const bool inject_includes,
+			const std::string &tag,
+			const std::function<void(json &)> &finalize)
+		{
+			const std::string key = spec_path + "|" + std::to_string(inject_includes) + "|" + tag;
+
+			std::lock_guard<std::mutex> lock(spec_mutex);
+			const auto it = processed_specs.find(key);
+			if (it != processed_specs.end())
+				return it->second;
+
+			std::string spec;
+			if (!read_file(spec_path, spec))
+			{
+				logger().error("unable to open {} rules", spec_path);
+				throw std::runtime_error("Invald spec file");
+			}
+
+			std::filesystem::path cached;
+			json rules;
+			bool is_cached = false;
+			if (!spec_cache_directory.empty())
+			{
+				cached = cache_path(spec_cache_directory, spec_path, spec_hash(spec, inject_includes, tag));
+				is_cached = load_cached(cached, rules);
+				if (is_cached)
+					logger().trace("Loaded the processed spec {} from {}", spec_path, cached.string());
+			}
+
+			if (!is_cached)
+			{
+				rules = json::parse(spec);
+				if (inject_includes)
+				{
+					jse::JSE jse;
+					jse.include_directories.push_back(POLYFEM_JSON_SPEC_DIR);
+					jse.include_directories.push_back(POLYSOLVE_JSON_SPEC_DIR);
+					rules = jse.inject_include(rules);
+				}
+				if (finalize)
+					finalize(rules);
+
+				if (!cached.empty())
+					store_cached(cached, rules);
+			}
+
+			auto shared = std::make_shared<const json>(std::move(rules));
+			processed_specs.emplace(key, shared);
+			return shared;
+		}
+
+		void set_spec_cache_directory(const std::string &dir)
+		{
+			std::lock_guard<std::mutex> lock(spec_mutex);
+			spec_cache_directory = dir;
+		}
+	} // namespace utils
+} // namespace polyfem
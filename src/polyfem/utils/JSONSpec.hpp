@@ -0,0 +1,30 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// @brief Rules of a JSON spec with the includes of the polyfem and polysolve spec directories injected.
+		/// The rules are processed once per process and shared by all the states. If a cache directory is set,
+		/// they are also stored there in binary form, keyed by the hash of the spec files, and reused by later runs.
+		/// @param spec_path Path of the spec file
+		/// @param inject_includes Whether to resolve the includes of the spec
+		/// @param tag Identifies finalize in the caches, empty if there is none
+		/// @param finalize Applied to the rules after the includes, it must only depend on the build
+		/// @return The processed rules
+		std::shared_ptr<const json> load_spec_rules(
+			const std::string &spec_path,
+			const bool inject_includes = true,
+			const std::string &tag = "",
+			const std::function<void(json &)> &finalize = {});
+
+		/// @brief Set the directory of the on-disk cache of load_spec_rules, empty to disable it (default)
+		void set_spec_cache_directory(const std::string &dir);
+	} // namespace utils
+} // namespace polyfem
@@ -1,166 +1,151 @@
 #include "LazyCubicInterpolator.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 #include <mutex>
 
 namespace polyfem
 {
-	void LazyCubicInterpolator::bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	void LazyCubicInterpolator::node_values(const GridKey &key, double &val, NodeDerivatives &derivatives) const
 	{
-		Eigen::MatrixXd corner_val(4, 1);
-		Eigen::MatrixXd corner_grad(4, 2);
-		Eigen::MatrixXd corner_grad_grad(4, 1);
-		for (int i = 0; i < 4; ++i)
+		if (in_dense_grid(key))
 		{
-			{
-				std::shared_lock distance_lock(distance_mutex_);
-				corner_val(i) = implicit_function_distance.at(keys[i]);
-			}
-			{
-				std::shared_lock grad_lock(grad_mutex_);
-				auto mixed_grads = implicit_function_grads.at(keys[i]);
-				corner_grad(i, 0) = mixed_grads(0);
-				corner_grad(i, 1) = mixed_grads(1);
-				corner_grad_grad(i, 0) = mixed_grads(2);
-			}
+			val = dense_distance_[dense_index(key, 1)];
+			derivatives = dense_derivatives_[dense_index(key, 0)];
+			return;
 		}
 
-		Eigen::MatrixXd x(16, 1);
-		x << corner_val(0), corner_val(1), corner_val(2), corner_val(3),
-			delta_ * corner_grad(0, 0), delta_ * corner_grad(1, 0), delta_ * corner_grad(2, 0), delta_ * corner_grad(3, 0),
-			delta_ * corner_grad(0, 1), delta_ * corner_grad(1, 1), delta_ * corner_grad(2, 1), delta_ * corner_grad(3, 1),
-			delta_ * delta_ * corner_grad_grad(0, 0), delta_ * delta_ * corner_grad_grad(1, 0), delta_ * delta_ * corner_grad_grad(2, 0), delta_ * delta_ * corner_grad_grad(3, 0);
-
-		Eigen::MatrixXd coeffs = cubic_mat * x;
+		{
+			std::shared_lock distance_lock(distance_mutex_);
+			val = implicit_function_distance.at(key);
+		}
+		{
+			std::shared_lock grad_lock(grad_mutex_);
+			derivatives = implicit_function_grads.at(key);
+		}
+	}
 
-		auto bar_x = [&corner_point](double x_) { return (x_ - corner_point(0, 0)) / (corner_point(1, 0) - corner_point(0, 0)); };
-		auto bar_y = [&corner_point](double y_) { return (y_ - corner_point(0, 1)) / (corner_point(2, 1) - corner_point(0, 1)); };
+	void LazyCubicInterpolator::cell_coefficients(const GridKey &cell, Eigen::VectorXd &coeffs) const
+	{
+		std::array<GridKey, 8> keys;
+		const int n_corners = corner_keys(cell, keys);
+		// Number of derivative blocks: value, first, mixed second (and third) derivatives
+		const int n_blocks = dim_ == 2 ? 4 : 8;
 
-		val = 0;
-		grad.setZero(2, 1);
-		for (int i = 0; i < 4; ++i)
-			for (int j = 0; j < 4; ++j)
+		Eigen::VectorXd x(n_corners * n_blocks);
+		double val;
+		NodeDerivatives derivatives;
+		for (int i = 0; i < n_corners; ++i)
+		{
+			node_values(keys[i], val, derivatives);
+			x(i) = val;
+			if (dim_ == 2)
 			{
-				val += coeffs(i + j * 4) * pow(bar_x(point(0)), i) * pow(bar_y(point(1)), j);
-				grad(0) += i == 0 ? 0 : (coeffs(i + j * 4) * i * pow(bar_x(point(0)), i - 1) * pow(bar_y(point(1)), j));
-				grad(1) += j == 0 ? 0 : coeffs(i + j * 4) * pow(bar_x(point(0)), i) * j * pow(bar_y(point(1)), j - 1);
+				x(i + 4) = delta_ * derivatives(0);
+				x(i + 8) = delta_ * derivatives(1);
+				x(i + 12) = delta_ * delta_ * derivatives(2);
 			}
+			else
+			{
+				for (int k = 0; k < 3; ++k)
+					x(i + 8 * (k + 1)) = delta_ * derivatives(k);
+				for (int k = 3; k < 6; ++k)
+					x(i + 8 * (k + 1)) = delta_ * delta_ * derivatives(k);
+				x(i + 56) = delta_ * delta_ * delta_ * derivatives(6);
+			}
+		}
 
-		grad(0) /= (corner_point(1, 0) - corner_point(0, 0));
-		grad(1) /= (corner_point(2, 1) - corner_point(0, 1));
-
-		assert(!std::isnan(grad(0)) && !std::isnan(grad(1)));
+		coeffs = cubic_mat * x;
 	}
 
-	void LazyCubicInterpolator::tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	void LazyCubicInterpolator::interpolate(const GridKey &cell, const Eigen::VectorXd &coeffs, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
 	{
-		Eigen::MatrixXd corner_val(8, 1);
-		Eigen::MatrixXd corner_grad(8, 3);
-		Eigen::MatrixXd corner_grad_grad(8, 3);
-		Eigen::MatrixXd corner_grad_grad_grad(8, 1);
-		for (int i = 0; i < 8; ++i)
+		// Powers of the local coordinates in the cell and their derivatives
+		double p[3][4], dp[3][4];
+		for (int k = 0; k < 3; ++k)
 		{
-			{
-				std::shared_lock distance_lock(distance_mutex_);
-				corner_val(i) = implicit_function_distance.at(keys[i]);
-			}
-			{
-				std::shared_lock grad_lock(grad_mutex_);
-				auto mixed_grads = implicit_function_grads.at(keys[i]);
-				corner_grad(i, 0) = mixed_grads(0);
-				corner_grad(i, 1) = mixed_grads(1);
-				corner_grad(i, 2) = mixed_grads(2);
-				corner_grad_grad(i, 0) = mixed_grads(3);
-				corner_grad_grad(i, 1) = mixed_grads(4);
-				corner_grad_grad(i, 2) = mixed_grads(5);
-				corner_grad_grad_grad(i, 0) = mixed_grads(6);
-			}
+			const double t = k < dim_ ? (point(k) - cell[k] * delta_) / delta_ : 0;
+			p[k][0] = 1;
+			p[k][1] = t;
+			p[k][2] = t * t;
+			p[k][3] = t * t * t;
+			dp[k][0] = 0;
+			dp[k][1] = 1;
+			dp[k][2] = 2 * t;
+			dp[k][3] = 3 * t * t;
 		}
-		Eigen::MatrixXd x(64, 1);
-		x << corner_val(0), corner_val(1), corner_val(2), corner_val(3), corner_val(4), corner_val(5), corner_val(6), corner_val(7),
-			delta_ * corner_grad(0, 0), delta_ * corner_grad(1, 0), delta_ * corner_grad(2, 0), delta_ * corner_grad(3, 0), delta_ * corner_grad(4, 0), delta_ * corner_grad(5, 0), delta_ * corner_grad(6, 0), delta_ * corner_grad(7, 0),
-			delta_ * corner_grad(0, 1), delta_ * corner_grad(1, 1), delta_ * corner_grad(2, 1), delta_ * corner_grad(3, 1), delta_ * corner_grad(4, 1), delta_ * corner_grad(5, 1), delta_ * corner_grad(6, 1), delta_ * corner_grad(7, 1),
-			delta_ * corner_grad(0, 2), delta_ * corner_grad(1, 2), delta_ * corner_grad(2, 2), delta_ * corner_grad(3, 2), delta_ * corner_grad(4, 2), delta_ * corner_grad(5, 2), delta_ * corner_grad(6, 2), delta_ * corner_grad(7, 2),
-			delta_ * delta_ * corner_grad_grad(0, 0), delta_ * delta_ * corner_grad_grad(1, 0), delta_ * delta_ * corner_grad_grad(2, 0), delta_ * delta_ * corner_grad_grad(3, 0), delta_ * delta_ * corner_grad_grad(4, 0), delta_ * delta_ * corner_grad_grad(5, 0), delta_ * delta_ * corner_grad_grad(6, 0), delta_ * delta_ * corner_grad_grad(7, 0),
-			delta_ * delta_ * corner_grad_grad(0, 1), delta_ * delta_ * corner_grad_grad(1, 1), delta_ * delta_ * corner_grad_grad(2, 1), delta_ * delta_ * corner_grad_grad(3, 1), delta_ * delta_ * corner_grad_grad(4, 1), delta_ * delta_ * corner_grad_grad(5, 1), delta_ * delta_ * corner_grad_grad(6, 1), delta_ * delta_ * corner_grad_grad(7, 1),
-			delta_ * delta_ * corner_grad_grad(0, 2), delta_ * delta_ * corner_grad_grad(1, 2), delta_ * delta_ * corner_grad_grad(2, 2), delta_ * delta_ * corner_grad_grad(3, 2), delta_ * delta_ * corner_grad_grad(4, 2), delta_ * delta_ * corner_grad_grad(5, 2), delta_ * delta_ * corner_grad_grad(6, 2), delta_ * delta_ * corner_grad_grad(7, 2),
-			delta_ * delta_ * delta_ * corner_grad_grad_grad(0, 0), delta_ * delta_ * delta_ * corner_grad_grad_grad(1, 0), delta_ * delta_ * delta_ * corner_grad_grad_grad(2, 0), delta_ * delta_ * delta_ * corner_grad_grad_grad(3, 0), delta_ * delta_ * delta_ * corner_grad_grad_grad(4, 0), delta_ * delta_ * delta_ * corner_grad_grad_grad(5, 0), delta_ * delta_ * delta_ * corner_grad_grad_grad(6, 0), delta_ * delta_ * delta_ * corner_grad_grad_grad(7, 0);
-
-		Eigen::MatrixXd coeffs = cubic_mat * x;
-
-		auto bar_x = [&corner_point](double x_) { return (x_ - corner_point(0, 0)) / (corner_point(1, 0) - corner_point(0, 0)); };
-		auto bar_y = [&corner_point](double y_) { return (y_ - corner_point(0, 1)) / (corner_point(2, 1) - corner_point(0, 1)); };
-		auto bar_z = [&corner_point](double z_) { return (z_ - corner_point(0, 2)) / (corner_point(4, 2) - corner_point(0, 2)); };
 
 		val = 0;
-		grad.setZero(3, 1);
-		for (int i = 0; i < 4; ++i)
+		grad.setZero(dim_, 1);
+		const int n_l = dim_ == 2 ? 1 : 4;
+		for (int l = 0; l < n_l; ++l)
 			for (int j = 0; j < 4; ++j)
-				for (int l = 0; l < 4; ++l)
+				for (int i = 0; i < 4; ++i)
 				{
-					val += coeffs(i + j * 4 + l * 16) * pow(bar_x(point(0)), i) * pow(bar_y(point(1)), j) * pow(bar_z(point(2)), l);
-					grad(0) += i == 0 ? 0 : (coeffs(i + j * 4 + l * 16) * i * pow(bar_x(point(0)), i - 1) * pow(bar_y(point(1)), j)) * pow(bar_z(point(2)), l);
-					grad(1) += j == 0 ? 0 : coeffs(i + j * 4 + l * 16) * pow(bar_x(point(0)), i) * j * pow(bar_y(point(1)), j - 1) * pow(bar_z(point(2)), l);
-					grad(2) += l == 0 ? 0 : coeffs(i + j * 4 + l * 16) * pow(bar_x(point(0)), i) * pow(bar_y(point(1)), j) * l * pow(bar_z(point(2)), l - 1);
+					const double c = coeffs(i + j * 4 + l * 16);
+					val += c * p[0][i] * p[1][j] * p[2][l];
+					grad(0) += c * dp[0][i] * p[1][j] * p[2][l];
+					grad(1) += c * p[0][i] * dp[1][j] * p[2][l];
+					if (dim_ == 3)
+						grad(2) += c * p[0][i] * p[1][j] * dp[2][l];
 				}
 
-		grad(0) /= (corner_point(1, 0) - corner_point(0, 0));
-		grad(1) /= (corner_point(2, 1) - corner_point(0, 1));
-		grad(2) /= (corner_point(4, 2) - corner_point(0, 2));
+		grad /= delta_;
 
-		assert(!std::isnan(grad(0)) && !std::isnan(grad(1)) && !std::isnan(grad(2)));
+		for (int i = 0; i < dim_; ++i)
+			if (std::isnan(grad(i)))
+				throw std::runtime_error("Nan found in gradient computation.");
 	}
 
 	void LazyCubicInterpolator::cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point)
 	{
-		Eigen::MatrixXi keys;
-		build_corner_keys(point, keys);
-		std::vector<std::string> keys_string;
+		std::array<GridKey, 8> keys;
+		const int n_corners = corner_keys(cell_of(point), keys);
 
-		auto safe_compute_distance = [this, compute_distance](const Eigen::MatrixXd &clamped_point, const std::string &key_string) {
-			std::unique_lock lock(distance_mutex_);
-			if (implicit_function_distance.count(key_string) == 0)
-				compute_distance(clamped_point, implicit_function_distance[key_string]);
-		};
-		auto safe_distance = [this, safe_compute_distance](const Eigen::VectorXi &key) {
-			Eigen::MatrixXd point;
-			std::string key_string;
-			double distance;
-			setup_key(key, key_string, point);
-			safe_compute_distance(point, key_string);
+		bool all_dense = true;
+		for (int i = 0; i < n_corners; ++i)
+			all_dense &= in_dense_grid(keys[i]);
+		if (all_dense)
+			return;
+
+		auto safe_distance = [this, compute_distance](const GridKey &key) {
 			{
 				std::shared_lock lock(distance_mutex_);
-				distance = implicit_function_distance[key_string];
+				const auto it = implicit_function_distance.find(key);
+				if (it != implicit_function_distance.end())
+					return it->second;
 			}
-			return distance;
+			std::unique_lock lock(distance_mutex_);
+			auto it = implicit_function_distance.find(key);
+			if (it == implicit_function_distance.end())
+			{
+				double distance;
+				compute_distance(node_position(key), distance);
+				it = implicit_function_distance.emplace(key, distance).first;
+			}
+			return it->second;
 		};
-		auto centered_fd = [this, safe_distance](const Eigen::VectorXi &key, const int k) {
-			Eigen::MatrixXi key_plus, key_minus;
-			double distance_plus, distance_minus;
-			key_plus = key;
-			key_plus(k) += 1;
-			distance_plus = safe_distance(key_plus);
-			key_minus = key;
-			key_minus(k) -= 1;
-			distance_minus = safe_distance(key_minus);
-			return (1. / 2. / delta_) * (distance_plus - distance_minus);
+		auto centered_fd = [this, safe_distance](const GridKey &key, const int k) {
+			GridKey key_plus = key, key_minus = key;
+			key_plus[k] += 1;
+			key_minus[k] -= 1;
+			return (1. / 2. / delta_) * (safe_distance(key_plus) - safe_distance(key_minus));
 		};
-		auto centered_mixed_fd = [this, centered_fd](const Eigen::VectorXi &key, const int k1, const int k2) {
-			Eigen::VectorXi key_plus, key_minus;
-			key_plus = key;
-			key_plus(k1) += 1;
-			key_minus = key;
-			key_minus(k1) -= 1;
+		auto centered_mixed_fd = [this, centered_fd](const GridKey &key, const int k1, const int k2) {
+			GridKey key_plus = key, key_minus = key;
+			key_plus[k1] += 1;
+			key_minus[k1] -= 1;
 			return (1. / 2. / delta_) * (centered_fd(key_plus, k2) - centered_fd(key_minus, k2));
 		};
-		auto centered_mixed_fd_3d = [this, centered_mixed_fd](const Eigen::VectorXi &key) {
-			Eigen::VectorXi key_plus, key_minus;
-			key_plus = key;
-			key_plus(0) += 1;
-			key_minus = key;
-			key_minus(0) -= 1;
+		auto centered_mixed_fd_3d = [this, centered_mixed_fd](const GridKey &key) {
+			GridKey key_plus = key, key_minus = key;
+			key_plus[0] += 1;
+			key_minus[0] -= 1;
 			return (1. / 2. / delta_) * (centered_mixed_fd(key_plus, 1, 2) - centered_mixed_fd(key_minus, 1, 2));
 		};
-		auto compute_grad = [this, centered_fd, centered_mixed_fd, centered_mixed_fd_3d](const Eigen::VectorXi &key) {
-			Eigen::VectorXd mixed_grads(dim_ == 2 ? 3 : 7);
+		auto compute_grad = [this, centered_fd, centered_mixed_fd, centered_mixed_fd_3d](const GridKey &key) {
+			NodeDerivatives mixed_grads = NodeDerivatives::Zero();
 			if (dim_ == 2)
 			{
 				mixed_grads(0) = centered_fd(key, 0);
@@ -179,57 +164,132 @@ namespace polyfem
 			}
 			return mixed_grads;
 		};
-		auto safe_compute_grad = [this, compute_grad](const Eigen::VectorXi &key) {
-			std::string key_string;
-			Eigen::MatrixXd point;
-			setup_key(key, key_string, point);
+
+		for (int i = 0; i < n_corners; ++i)
+		{
+			if (in_dense_grid(keys[i]))
+				continue;
+
+			safe_distance(keys[i]);
 			{
-				std::unique_lock lock(grad_mutex_);
-				if (implicit_function_grads.count(key_string) == 0)
-				{
-					Eigen::MatrixXd grad = compute_grad(key);
-					implicit_function_grads[key_string] = grad;
-				}
+				std::shared_lock lock(grad_mutex_);
+				if (implicit_function_grads.count(keys[i]))
+					continue;
 			}
-		};
-		Eigen::MatrixXd corner_point(keys.rows(), dim_);
-		for (int i = 0; i < keys.rows(); ++i)
-		{
-			std::string key_string;
-			Eigen::MatrixXd clamped_point;
-			setup_key(keys.row(i), key_string, clamped_point);
-			safe_compute_distance(clamped_point, key_string);
-			keys_string.push_back(key_string);
-			corner_point.row(i) = clamped_point.transpose();
-			safe_compute_grad(keys.row(i));
+			const NodeDerivatives grad = compute_grad(keys[i]);
+			std::unique_lock lock(grad_mutex_);
+			implicit_function_grads.emplace(keys[i], grad);
 		}
 	}
 
-	void LazyCubicInterpolator::evaluate(const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	void LazyCubicInterpolator::precompute_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::VectorXd &min, const Eigen::VectorXd &max)
 	{
-		Eigen::MatrixXi keys;
-		build_corner_keys(point, keys);
+		dense_min_ = {{0, 0, 0}};
+		dense_max_ = {{0, 0, 0}};
+		for (int k = 0; k < dim_; ++k)
+		{
+			dense_min_[k] = (int)std::floor(min(k) / delta_);
+			dense_max_[k] = (int)std::floor(max(k) / delta_) + 1;
+		}
 
-		std::vector<std::string> keys_string;
-		Eigen::MatrixXd corner_point(keys.rows(), dim_);
-		for (int i = 0; i < keys.rows(); ++i)
+		int n_nodes = 1, n_padded_nodes = 1;
+		for (int k = 0; k < dim_; ++k)
 		{
-			std::string key_string;
-			Eigen::MatrixXd clamped_point;
-			setup_key(keys.row(i), key_string, clamped_point);
-			keys_string.push_back(key_string);
-			corner_point.row(i) = clamped_point.transpose();
+			n_nodes *= dense_max_[k] - dense_min_[k] + 1;
+			n_padded_nodes *= dense_max_[k] - dense_min_[k] + 3;
 		}
+		logger().debug("Precomputing the distance on a grid of {} nodes", n_nodes);
 
-		grad.setZero(dim_, 1);
-		if (dim_ == 2)
-			bicubic_interpolation(corner_point, keys_string, point, val, grad);
-		else if (dim_ == 3)
-			tricubic_interpolation(corner_point, keys_string, point, val, grad);
+		// Keys of the padded grid in dense_index order
+		auto padded_key = [this](int index) {
+			GridKey key = {{0, 0, 0}};
+			for (int k = 0; k < dim_; ++k)
+			{
+				const int n = dense_max_[k] - dense_min_[k] + 3;
+				key[k] = dense_min_[k] - 1 + index % n;
+				index /= n;
+			}
+			return key;
+		};
 
-		for (int i = 0; i < dim_; ++i)
-			if (std::isnan(grad(i)))
-				throw std::runtime_error("Nan found in gradient computation.");
+		dense_derivatives_.clear();
+		dense_distance_.assign(n_padded_nodes, 0);
+		utils::maybe_parallel_for(n_padded_nodes, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				compute_distance(node_position(padded_key(i)), dense_distance_[i]);
+		});
+
+		std::vector<NodeDerivatives> derivatives(n_nodes, NodeDerivatives::Zero());
+		auto distance = [this](GridKey key, const int di, const int dj, const int dk) {
+			key[0] += di;
+			key[1] += dj;
+			key[2] += dk;
+			return dense_distance_[dense_index(key, 1)];
+		};
+		utils::maybe_parallel_for(n_padded_nodes, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const GridKey key = padded_key(i);
+				bool inside = true;
+				for (int k = 0; k < dim_; ++k)
+					inside &= key[k] >= dense_min_[k] && key[k] <= dense_max_[k];
+				if (!inside)
+					continue;
+
+				// Same stencils as the lazy finite differences in cache_grid
+				NodeDerivatives &d = derivatives[dense_index(key, 0)];
+				d(0) = (distance(key, 1, 0, 0) - distance(key, -1, 0, 0)) / (2 * delta_);
+				d(1) = (distance(key, 0, 1, 0) - distance(key, 0, -1, 0)) / (2 * delta_);
+				if (dim_ == 2)
+					d(2) = (distance(key, 1, 1, 0) - distance(key, 1, -1, 0) - distance(key, -1, 1, 0) + distance(key, -1, -1, 0)) / (4 * delta_ * delta_);
+				else
+				{
+					d(2) = (distance(key, 0, 0, 1) - distance(key, 0, 0, -1)) / (2 * delta_);
+					d(3) = (distance(key, 1, 1, 0) - distance(key, 1, -1, 0) - distance(key, -1, 1, 0) + distance(key, -1, -1, 0)) / (4 * delta_ * delta_);
+					d(4) = (distance(key, 1, 0, 1) - distance(key, 1, 0, -1) - distance(key, -1, 0, 1) + distance(key, -1, 0, -1)) / (4 * delta_ * delta_);
+					d(5) = (distance(key, 0, 1, 1) - distance(key, 0, 1, -1) - distance(key, 0, -1, 1) + distance(key, 0, -1, -1)) / (4 * delta_ * delta_);
+					d(6) = 0;
+					for (int s = 0; s < 8; ++s)
+					{
+						const int sx = (s & 1) ? 1 : -1, sy = (s & 2) ? 1 : -1, sz = (s & 4) ? 1 : -1;
+						d(6) += sx * sy * sz * distance(key, sx, sy, sz);
+					}
+					d(6) /= 8 * delta_ * delta_ * delta_;
+				}
+			}
+		});
+		// Only publish the dense grid once it is complete, in_dense_grid checks dense_derivatives_
+		dense_derivatives_ = std::move(derivatives);
+	}
+
+	void LazyCubicInterpolator::evaluate(const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	{
+		const GridKey cell = cell_of(point);
+		Eigen::VectorXd coeffs;
+		cell_coefficients(cell, coeffs);
+		interpolate(cell, coeffs, point, val, grad);
+	}
+
+	void LazyCubicInterpolator::evaluate(const Eigen::MatrixXd &points, Eigen::VectorXd &vals, Eigen::MatrixXd &grads) const
+	{
+		vals.resize(points.rows());
+		grads.resize(points.rows(), dim_);
+
+		GridKey prev_cell;
+		Eigen::VectorXd coeffs;
+		Eigen::MatrixXd point, grad;
+		for (int p = 0; p < points.rows(); ++p)
+		{
+			point = points.row(p).transpose();
+			const GridKey cell = cell_of(point);
+			if (p == 0 || cell != prev_cell)
+			{
+				cell_coefficients(cell, coeffs);
+				prev_cell = cell;
+			}
+			interpolate(cell, coeffs, point, vals(p), grad);
+			grads.row(p) = grad.transpose();
+		}
 	}
 
 	void LazyCubicInterpolator::lazy_evaluate(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad)
@@ -239,4 +299,4 @@ namespace polyfem
 		evaluate(point, val, grad);
 	}
 
-} // namespace polyfem
\ No newline at end of file
+} // namespace polyfem
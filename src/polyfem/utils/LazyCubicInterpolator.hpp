@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
+#include <functional>
 #include <map>
 #include <unordered_map>
+#include <vector>
 #include <shared_mutex>
 #include <Eigen/Dense>
 #include <nanospline/BSpline.h>
@@ -105,60 +108,95 @@ namespace polyfem
 			}
 		}
 
-		void bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
-		void tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
+		/// Integer coordinates of a grid node, the last one is zero in 2D
+		using GridKey = std::array<int, 3>;
+
 		void lazy_evaluate(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad);
 		void cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point);
 		void evaluate(const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
+		/// Evaluates one point per row of points, consecutive points in the same cell share the cubic coefficients
+		void evaluate(const Eigen::MatrixXd &points, Eigen::VectorXd &vals, Eigen::MatrixXd &grads) const;
+
+		/// Computes the distance and its derivatives on every node of the box [min, max] up front.
+		/// Queries inside the box read them from a dense array, the rest falls back to the lazy hash maps.
+		void precompute_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::VectorXd &min, const Eigen::VectorXd &max);
 
 	private:
-		inline void build_corner_keys(const Eigen::MatrixXd &point, Eigen::MatrixXi &keys) const
+		// dx, dy, dxy in 2D; dx, dy, dz, dxy, dxz, dyz, dxyz in 3D
+		using NodeDerivatives = Eigen::Matrix<double, 7, 1>;
+
+		struct GridKeyHash
 		{
-			int num_corner_points = dim_ == 2 ? 4 : 8;
-			Eigen::MatrixXi bin(dim_, 1);
-			keys.resize(num_corner_points, dim_);
-			std::vector<std::string> keys_string;
-			for (int k = 0; k < dim_; ++k)
-				bin(k) = (int)std::floor(point(k) / delta_);
-			if (dim_ == 2)
-			{
-				keys << bin(0), bin(1),
-					bin(0) + 1, bin(1),
-					bin(0), bin(1) + 1,
-					bin(0) + 1, bin(1) + 1;
-			}
-			else if (dim_ == 3)
+			size_t operator()(const GridKey &key) const
 			{
-				keys << bin(0), bin(1), bin(2),
-					bin(0) + 1, bin(1), bin(2),
-					bin(0), bin(1) + 1, bin(2),
-					bin(0) + 1, bin(1) + 1, bin(2),
-					bin(0), bin(1), bin(2) + 1,
-					bin(0) + 1, bin(1), bin(2) + 1,
-					bin(0), bin(1) + 1, bin(2) + 1,
-					bin(0) + 1, bin(1) + 1, bin(2) + 1;
+				size_t h = std::hash<int>()(key[0]);
+				h ^= std::hash<int>()(key[1]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+				h ^= std::hash<int>()(key[2]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+				return h;
 			}
+		};
+
+		inline GridKey cell_of(const Eigen::MatrixXd &point) const
+		{
+			GridKey cell = {{0, 0, 0}};
+			for (int k = 0; k < dim_; ++k)
+				cell[k] = (int)std::floor(point(k) / delta_);
+			return cell;
 		}
-		inline void setup_key(const Eigen::VectorXi &key, std::string &key_string, Eigen::MatrixXd &clamped_point) const
+
+		// Corners of a cell, x varies fastest
+		inline int corner_keys(const GridKey &cell, std::array<GridKey, 8> &keys) const
 		{
-			key_string = "";
-			clamped_point.setZero(dim_, 1);
+			const int num_corner_points = dim_ == 2 ? 4 : 8;
+			for (int c = 0; c < num_corner_points; ++c)
+				keys[c] = {{cell[0] + (c & 1), cell[1] + ((c >> 1) & 1), dim_ == 3 ? cell[2] + ((c >> 2) & 1) : 0}};
+			return num_corner_points;
+		}
+
+		inline Eigen::MatrixXd node_position(const GridKey &key) const
+		{
+			Eigen::MatrixXd point(dim_, 1);
 			for (int k = 0; k < dim_; ++k)
-			{
-				// key_string += fmt::format("{:d},", key(k));
-				key_string += std::to_string(key(k)) + ",";
-				clamped_point(k) = (double)key(k) * delta_;
-			}
-		};
+				point(k) = key[k] * delta_;
+			return point;
+		}
+
+		inline bool in_dense_grid(const GridKey &key) const
+		{
+			if (dense_derivatives_.empty())
+				return false;
+			for (int k = 0; k < dim_; ++k)
+				if (key[k] < dense_min_[k] || key[k] > dense_max_[k])
+					return false;
+			return true;
+		}
+
+		// Index in the dense arrays, pad is 1 for the distances, which also cover the finite difference stencil
+		inline int dense_index(const GridKey &key, const int pad) const
+		{
+			int index = 0;
+			for (int k = dim_ - 1; k >= 0; --k)
+				index = index * (dense_max_[k] - dense_min_[k] + 1 + 2 * pad) + (key[k] - dense_min_[k] + pad);
+			return index;
+		}
+
+		void node_values(const GridKey &key, double &val, NodeDerivatives &derivatives) const;
+		void cell_coefficients(const GridKey &cell, Eigen::VectorXd &coeffs) const;
+		void interpolate(const GridKey &cell, const Eigen::VectorXd &coeffs, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
 
 		int dim_;
 		double delta_;
-		std::unordered_map<std::string, double> implicit_function_distance;
-		std::unordered_map<std::string, Eigen::VectorXd> implicit_function_grads;
+		std::unordered_map<GridKey, double, GridKeyHash> implicit_function_distance;
+		std::unordered_map<GridKey, NodeDerivatives, GridKeyHash> implicit_function_grads;
+
+		GridKey dense_min_ = {{0, 0, 0}};
+		GridKey dense_max_ = {{-1, -1, -1}};
+		std::vector<double> dense_distance_;
+		std::vector<NodeDerivatives> dense_derivatives_;
 
 		Eigen::MatrixXd cubic_mat;
 
 		mutable std::shared_mutex distance_mutex_;
 		mutable std::shared_mutex grad_mutex_;
 	};
-} // namespace polyfem
\ No newline at end of file
+} // namespace polyfem
@@ -52,3 +52,16 @@ namespace polyfem
 		log_and_throw_error(fmt::format(msg, args...));
 	}
 } // namespace polyfem
+
+///
+/// Log with a polyfem logger only if the level is enabled, unlike logger().debug(...) the arguments
+/// (e.g., norms or residuals computed for the message) are not evaluated otherwise.
+///
+#define POLYFEM_LOG(logger_, level_, ...)                    \
+	do                                                       \
+	{                                                        \
+		if ((logger_).should_log(level_))                    \
+			(logger_).log(level_, __VA_ARGS__);              \
+	} while (0)
+#define POLYFEM_LOG_TRACE(...) POLYFEM_LOG(::polyfem::logger(), spdlog::level::trace, __VA_ARGS__)
+#define POLYFEM_LOG_DEBUG(...) POLYFEM_LOG(::polyfem::logger(), spdlog::level::debug, __VA_ARGS__)
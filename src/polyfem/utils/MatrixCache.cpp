@@ -3,6 +3,8 @@
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/Logger.hpp>
 
+#include <algorithm>
+
 namespace polyfem::utils
 {
 	SparseMatrixCache::SparseMatrixCache(const size_t size)
@@ -69,12 +71,18 @@ namespace polyfem::utils
 		}
 		size_ = other.size_;
 
+		// drop leftovers in case this cache is reused
+		entries_.clear();
+		second_cache_entries_.clear();
+		current_e_ = -1;
+		current_e_index_ = -1;
+
 		values_.resize(other.values_.size());
 
 		tmp_.resize(other.mat_.rows(), other.mat_.cols());
 		mat_.resize(other.mat_.rows(), other.mat_.cols());
 		mat_.setZero();
-		std::fill(values_.begin(), values_.end(), 0);
+		zero_values();
 	}
 
 	void SparseMatrixCache::set_zero()
@@ -82,7 +90,7 @@ namespace polyfem::utils
 		tmp_.setZero();
 		mat_.setZero();
 
-		std::fill(values_.begin(), values_.end(), 0);
+		zero_values();
 	}
 
 	void SparseMatrixCache::add_value(const int e, const int i, const int j, const double value)
@@ -207,6 +215,7 @@ namespace polyfem::utils
 				}
 
 				second_cache_entries_.resize(0);
+				mirror_slots_.clear();
 
 				logger().trace("Second cache computed");
 			}
@@ -214,6 +223,9 @@ namespace polyfem::utils
 		else
 		{
 			assert(size_ > 0);
+			if (symmetric_)
+				mirror_upper_values();
+
 			const auto &outer_index = main_cache()->outer_index_;
 			const auto &inner_index = main_cache()->inner_index_;
 			// directly write the values to the matrix
@@ -224,10 +236,60 @@ namespace polyfem::utils
 			current_e_index_ = -1;
 
 		}
-		std::fill(values_.begin(), values_.end(), 0);
+		zero_values();
 		return mat_;
 	}
 
+	void SparseMatrixCache::mirror_upper_values()
+	{
+		if (mirror_slots_.empty())
+		{
+			const auto &outer_index = main_cache()->outer_index_;
+			const auto &inner_index = main_cache()->inner_index_;
+
+			// the entry (r, c) below the diagonal of column c is (c, r) in column r
+			for (int c = 0; c + 1 < outer_index.size(); ++c)
+			{
+				for (int k = outer_index[c]; k < outer_index[c + 1]; ++k)
+				{
+					const int r = inner_index[k];
+					if (r <= c)
+						continue;
+
+					const auto begin = inner_index.begin() + outer_index[r];
+					const auto end = inner_index.begin() + outer_index[r + 1];
+					const auto it = std::lower_bound(begin, end, c);
+					// element matrices have a symmetric pattern
+					assert(it != end && *it == c);
+					if (it != end && *it == c)
+						mirror_slots_.emplace_back(k, it - inner_index.begin());
+				}
+			}
+		}
+
+		maybe_parallel_for(mirror_slots_.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				values_[mirror_slots_[i].first] = values_[mirror_slots_[i].second];
+		});
+	}
+
+	void SparseMatrixCache::zero_values()
+	{
+		maybe_parallel_for(values_.size(), [&](int start, int end, int thread_id) {
+			std::fill(values_.begin() + start, values_.begin() + end, 0);
+		});
+	}
+
+	size_t SparseMatrixCache::memory_bytes() const
+	{
+		size_t bytes = utils::memory_bytes(tmp_) + utils::memory_bytes(mat_) + utils::memory_bytes(entries_);
+		bytes += utils::memory_bytes(inner_index_) + utils::memory_bytes(outer_index_) + utils::memory_bytes(values_);
+		bytes += utils::memory_bytes(second_cache_entries_) + utils::memory_bytes(mirror_slots_);
+		// the mapping and the second cache of a copy belong to its main cache
+		bytes += utils::memory_bytes(mapping_) + utils::memory_bytes(second_cache_);
+		return bytes;
+	}
+
 	std::shared_ptr<MatrixCache> SparseMatrixCache::operator+(const MatrixCache &a) const
 	{
 		assert(&a == &dynamic_cast<const SparseMatrixCache &>(a));
@@ -403,4 +465,186 @@ namespace polyfem::utils
 		mat_ += o.mat_;
 	}
 
+	BlockSparseMatrixCache::BlockSparseMatrixCache(const size_t size, const int block_size)
+		: block_size_(block_size)
+	{
+		init(size);
+	}
+
+	void BlockSparseMatrixCache::init(const size_t size)
+	{
+		init(size, size);
+	}
+
+	void BlockSparseMatrixCache::init(const size_t rows, const size_t cols)
+	{
+		if (rows % block_size_ != 0 || cols % block_size_ != 0)
+			log_and_throw_error("Matrix of size {}x{} cannot be split in blocks of size {}", rows, cols, block_size_);
+
+		entries_.clear();
+		if (rows == rows_ && cols == cols_)
+		{
+			mat_.set_zero();
+			return;
+		}
+
+		rows_ = rows;
+		cols_ = cols;
+		mat_.init(rows / block_size_, cols / block_size_, block_size_, {}, symmetric_);
+		element_slots_ = nullptr;
+	}
+
+	void BlockSparseMatrixCache::set_symmetric(const bool symmetric)
+	{
+		if (symmetric == symmetric_)
+			return;
+
+		symmetric_ = symmetric;
+		entries_.clear();
+		mat_.init(rows_ / block_size_, cols_ / block_size_, block_size_, {}, symmetric_);
+		element_slots_ = nullptr;
+	}
+
+	void BlockSparseMatrixCache::init(const MatrixCache &other)
+	{
+		assert(this != &other);
+		assert(&other == &dynamic_cast<const BlockSparseMatrixCache &>(other));
+		const BlockSparseMatrixCache &o = dynamic_cast<const BlockSparseMatrixCache &>(other);
+
+		block_size_ = o.block_size_;
+		rows_ = o.rows_;
+		cols_ = o.cols_;
+		symmetric_ = o.symmetric_;
+		entries_.clear();
+		if (!mat_.same_pattern(o.mat_))
+			mat_ = o.mat_;
+		mat_.set_zero();
+		element_slots_ = o.element_slots_;
+	}
+
+	void BlockSparseMatrixCache::set_zero()
+	{
+		entries_.clear();
+		mat_.set_zero();
+	}
+
+	void BlockSparseMatrixCache::add_value(const int e, const int i, const int j, const double value)
+	{
+		if (symmetric_ && i / block_size_ > j / block_size_)
+			return;
+
+		const int slot = mat_.block_slot(i / block_size_, j / block_size_);
+		if (slot >= 0)
+			mat_.block(slot)[(i % block_size_) * block_size_ + j % block_size_] += value;
+		else
+			entries_.emplace_back(i, j, value);
+	}
+
+	void BlockSparseMatrixCache::merge_entries()
+	{
+		if (entries_.empty())
+			return;
+
+		std::vector<std::pair<int, int>> blocks;
+		blocks.reserve(mat_.non_zero_blocks() + entries_.size());
+		for (int slot = 0; slot < mat_.non_zero_blocks(); ++slot)
+			blocks.push_back(mat_.block_coordinates(slot));
+		for (const auto &t : entries_)
+			blocks.emplace_back(t.row() / block_size_, t.col() / block_size_);
+
+		BlockSparseMatrix merged;
+		merged.init(mat_.block_rows(), mat_.block_cols(), block_size_, std::move(blocks), symmetric_);
+
+		const int n_entries = block_size_ * block_size_;
+		for (int slot = 0; slot < mat_.non_zero_blocks(); ++slot)
+		{
+			const auto [bi, bj] = mat_.block_coordinates(slot);
+			std::copy_n(mat_.block(slot), n_entries, merged.block(merged.block_slot(bi, bj)));
+		}
+		for (const auto &t : entries_)
+		{
+			const int slot = merged.block_slot(t.row() / block_size_, t.col() / block_size_);
+			merged.block(slot)[(t.row() % block_size_) * block_size_ + t.col() % block_size_] += t.value();
+		}
+
+		mat_ = std::move(merged);
+		entries_.clear();
+		// the slots moved
+		element_slots_ = nullptr;
+	}
+
+	StiffnessMatrix BlockSparseMatrixCache::get_matrix(const bool compute_mapping)
+	{
+		merge_entries();
+		return mat_.to_sparse();
+	}
+
+	void BlockSparseMatrixCache::prune()
+	{
+		merge_entries();
+	}
+
+	void BlockSparseMatrixCache::init_element_slots(const std::vector<std::vector<std::pair<int, int>>> &element_blocks)
+	{
+		std::vector<std::pair<int, int>> blocks;
+		for (const auto &b : element_blocks)
+			blocks.insert(blocks.end(), b.begin(), b.end());
+		mat_.init(rows_ / block_size_, cols_ / block_size_, block_size_, std::move(blocks), symmetric_);
+		entries_.clear();
+
+		auto slots = std::make_shared<std::vector<std::vector<int>>>(element_blocks.size());
+		maybe_parallel_for(element_blocks.size(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+			{
+				(*slots)[e].resize(element_blocks[e].size());
+				for (size_t k = 0; k < element_blocks[e].size(); ++k)
+					(*slots)[e][k] = mat_.block_slot(element_blocks[e][k].first, element_blocks[e][k].second);
+			}
+		});
+		element_slots_ = slots;
+	}
+
+	size_t BlockSparseMatrixCache::memory_bytes() const
+	{
+		// the element slots are shared with the copies
+		return mat_.memory_bytes() + utils::memory_bytes(entries_) + (element_slots_ ? utils::memory_bytes(*element_slots_) : 0);
+	}
+
+	std::shared_ptr<MatrixCache> BlockSparseMatrixCache::operator+(const MatrixCache &a) const
+	{
+		std::shared_ptr<BlockSparseMatrixCache> out = std::make_shared<BlockSparseMatrixCache>(*this);
+		*out += a;
+		return out;
+	}
+
+	void BlockSparseMatrixCache::operator+=(const MatrixCache &o)
+	{
+		assert(&o == &dynamic_cast<const BlockSparseMatrixCache &>(o));
+		*this += dynamic_cast<const BlockSparseMatrixCache &>(o);
+	}
+
+	void BlockSparseMatrixCache::operator+=(const BlockSparseMatrixCache &o)
+	{
+		assert(o.block_size_ == block_size_ && o.rows_ == rows_ && o.cols_ == cols_);
+		if (mat_.same_pattern(o.mat_))
+		{
+			mat_ += o.mat_;
+		}
+		else
+		{
+			// the blocks of o outside of the pattern are added like single entries
+			for (int slot = 0; slot < o.mat_.non_zero_blocks(); ++slot)
+			{
+				const auto [bi, bj] = o.mat_.block_coordinates(slot);
+				const double *b = o.mat_.block(slot);
+				for (int r = 0; r < block_size_; ++r)
+					for (int c = 0; c < block_size_; ++c)
+						add_value(-1, bi * block_size_ + r, bj * block_size_ + c, b[r * block_size_ + c]);
+			}
+		}
+
+		for (const auto &t : o.entries_)
+			add_value(-1, t.row(), t.col(), t.value());
+	}
+
 } // namespace polyfem::utils
\ No newline at end of file
@@ -1,14 +1,40 @@
 #pragma once
 
+#include <polyfem/utils/BlockSparseMatrix.hpp>
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/par_for.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include <atomic>
 #include <memory>
 
 namespace polyfem::utils
 {
+	/// target += value as a relaxed atomic operation
+	inline void atomic_add(double &target, const double value)
+	{
+#if defined(__cpp_lib_atomic_ref)
+		std::atomic_ref<double>(target).fetch_add(value, std::memory_order_relaxed);
+#elif defined(__GNUC__) || defined(__clang__)
+		double expected;
+		__atomic_load(&target, &expected, __ATOMIC_RELAXED);
+		double desired = expected + value;
+		// expected is updated with the current value on failure
+		while (!__atomic_compare_exchange(&target, &expected, &desired, /*weak=*/true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			desired = expected + value;
+#else
+		// std::atomic<double> has the layout of a double on the supported compilers
+		static_assert(sizeof(std::atomic<double>) == sizeof(double));
+		std::atomic<double> &a = reinterpret_cast<std::atomic<double> &>(target);
+		double expected = a.load(std::memory_order_relaxed);
+		while (!a.compare_exchange_weak(expected, expected + value, std::memory_order_relaxed))
+			;
+#endif
+	}
+
 	/// abstract class used for caching 
 	class MatrixCache
 	{
@@ -31,6 +57,8 @@ namespace polyfem::utils
 		virtual size_t triplet_count() const = 0;
 		virtual bool is_sparse() const = 0;
 		bool is_dense() const { return !is_sparse(); }
+		/// heap memory owned by this cache in bytes, the structure shared with a main cache is counted by the main cache
+		virtual size_t memory_bytes() const = 0;
 
 		virtual void add_value(const int e, const int i, const int j, const double value) = 0;
 		virtual StiffnessMatrix get_matrix(const bool compute_mapping = true) = 0;
@@ -38,6 +66,14 @@ namespace polyfem::utils
 
 		virtual std::shared_ptr<MatrixCache> operator+(const MatrixCache &a) const = 0;
 		virtual void operator+=(const MatrixCache &o) = 0;
+
+		/// the matrix is symmetric: the direct assemblies (see the element slots) only write its upper triangle and
+		/// the lower one is copied from it
+		virtual void set_symmetric(const bool symmetric) { symmetric_ = symmetric; }
+		bool is_symmetric() const { return symmetric_; }
+
+	protected:
+		bool symmetric_ = false;
 	};
 
 	class SparseMatrixCache : public MatrixCache
@@ -74,6 +110,7 @@ namespace polyfem::utils
 		inline size_t capacity() const override { return entries_.capacity(); }
 		inline size_t non_zeros() const override { return mapping_.empty() ? mat_.nonZeros() : values_.size(); }
 		inline size_t triplet_count() const override { return entries_.size() + mat_.nonZeros(); }
+		size_t memory_bytes() const override;
 		inline bool is_sparse() const override { return true; }
 		inline size_t mapping_size() const { return mapping_.size(); }
 
@@ -103,13 +140,33 @@ namespace polyfem::utils
 		const StiffnessMatrix &mat() const { return mat_; }
 		const std::vector<Eigen::Triplet<double>> &entries() const { return entries_; }
 
+		/// true if the element to value slot map (second cache) is computed for n_elements elements
+		inline bool has_element_slots(const int n_elements) const { return !mapping().empty() && second_cache().size() == n_elements; }
+		/// value slots written by element e, in the order of the add_value calls used to build the cache
+		inline const std::vector<int> &element_slots(const int e) const { return second_cache()[e]; }
+		/// adds value directly to a slot of the value buffer, bypassing the triplets
+		/// different slots can be written concurrently
+		inline void add_to_slot(const int slot, const double value)
+		{
+			assert(slot >= 0 && slot < values_.size());
+			values_[slot] += value;
+		}
+		/// adds value to a slot of the value buffer with an atomic add, the same slot can be written concurrently
+		inline void atomic_add_to_slot(const int slot, const double value)
+		{
+			assert(slot >= 0 && slot < values_.size());
+			atomic_add(values_[slot], value);
+		}
+
 	private:
 		size_t size_;
 		StiffnessMatrix tmp_, mat_;
 		std::vector<Eigen::Triplet<double>> entries_; ///< contains global matrix indices and corresponding value
 		std::vector<std::vector<std::pair<int, size_t>>> mapping_; ///< maps row indices to column index/local index pairs
 		std::vector<int> inner_index_, outer_index_; ///< saves inner/outer indices for sparse matrix
-		std::vector<double> values_; ///< buffer for values (corresponds to inner/outer_index_ structure for sparse matrix)
+		/// buffer for values (corresponds to inner/outer_index_ structure for sparse matrix)
+		/// it is only written by zero_values after a resize, so its pages belong to the threads of that loop
+		std::vector<double, first_touch_allocator<double>> values_;
 		const SparseMatrixCache *main_cache_ = nullptr;
 
 		std::vector<std::vector<int>> second_cache_; ///< maps element index to local index
@@ -117,6 +174,14 @@ namespace polyfem::utils
 		int current_e_ = -1;
 		int current_e_index_ = -1;
 
+		/// sets values_ to zero in parallel, with the partition of the assembly loops
+		void zero_values();
+
+		/// (lower, upper) slots of the pairs of entries mirrored when the matrix is symmetric
+		std::vector<std::pair<int, int>> mirror_slots_;
+		/// copies the values of the upper triangle to the lower one
+		void mirror_upper_values();
+
 		inline const SparseMatrixCache *main_cache() const
 		{
 			return main_cache_ == nullptr ? this : main_cache_;
@@ -133,6 +198,84 @@ namespace polyfem::utils
 		}
 	};
 
+	/// cache of a matrix made of dense blocks (e.g., the 3x3 blocks of the hessian of a 3D vector-valued problem),
+	/// stored as a BlockSparseMatrix: one index per block instead of one per entry, and an element writes
+	/// one slot per pair of nodes instead of one per entry (see element_slots)
+	class BlockSparseMatrixCache : public MatrixCache
+	{
+	public:
+		BlockSparseMatrixCache(const int block_size) : block_size_(block_size) {}
+		BlockSparseMatrixCache(const size_t size, const int block_size);
+		BlockSparseMatrixCache(const BlockSparseMatrixCache &other) = default;
+
+		inline std::unique_ptr<MatrixCache> copy() const override
+		{
+			return std::make_unique<BlockSparseMatrixCache>(*this);
+		}
+
+		/// set matrix to be size x size, the pattern is kept if the size does not change
+		void init(const size_t size) override;
+		/// set matrix to be rows x cols, both multiple of the block size
+		void init(const size_t rows, const size_t cols) override;
+		/// set matrix to be a matrix of all zeros with the same size and pattern as other
+		void init(const MatrixCache &other) override;
+
+		/// set matrix values to zero, the pattern is kept
+		void set_zero() override;
+
+		inline void reserve(const size_t size) override { entries_.reserve(size); }
+		inline size_t entries_size() const override { return entries_.size(); }
+		inline size_t capacity() const override { return entries_.capacity(); }
+		inline size_t non_zeros() const override { return mat_.non_zeros(); }
+		inline size_t triplet_count() const override { return entries_.size() + mat_.non_zeros(); }
+		inline bool is_sparse() const override { return true; }
+		size_t memory_bytes() const override;
+
+		inline int block_size() const { return block_size_; }
+
+		/// a symmetric matrix only stores the blocks on and above the diagonal, the pattern is reset if it changes
+		void set_symmetric(const bool symmetric) override;
+
+		/// adds value to its block if it is in the pattern, otherwise it is saved and added to the pattern by prune
+		/// the values in the blocks below the diagonal of a symmetric matrix are dropped
+		void add_value(const int e, const int i, const int j, const double value) override;
+		/// scalar sparse matrix of the blocks, compute_mapping is ignored as the pattern is always kept
+		StiffnessMatrix get_matrix(const bool compute_mapping = true) override;
+		/// add the saved entries to the pattern and to the blocks
+		void prune() override;
+
+		std::shared_ptr<MatrixCache> operator+(const MatrixCache &a) const override;
+		void operator+=(const MatrixCache &o) override;
+		void operator+=(const BlockSparseMatrixCache &o);
+
+		/// the blocks, for the solvers that take them directly (e.g., for the products of iterative solvers)
+		const BlockSparseMatrix &block_matrix() const { return mat_; }
+
+		/// set the pattern to the blocks written by the elements and compute the block slots of every element
+		/// @param element_blocks block row and block column written by every element, in the order of the scatter,
+		///        without the blocks below the diagonal if the matrix is symmetric
+		void init_element_slots(const std::vector<std::vector<std::pair<int, int>>> &element_blocks);
+		/// true if the block slots are computed for n_elements elements
+		inline bool has_element_slots(const int n_elements) const { return element_slots_ != nullptr && element_slots_->size() == n_elements; }
+		/// block slots written by element e, in the order of init_element_slots
+		inline const std::vector<int> &element_slots(const int e) const { return (*element_slots_)[e]; }
+		/// row-major entries of the block in slot, different slots can be written concurrently
+		inline double *block(const int slot) { return mat_.block(slot); }
+
+	private:
+		int block_size_;
+		size_t rows_ = 0;
+		size_t cols_ = 0;
+
+		BlockSparseMatrix mat_;
+		std::vector<Eigen::Triplet<double>> entries_; ///< entries outside of the pattern of mat_
+		/// maps element index to its block slots, shared by the copies
+		std::shared_ptr<const std::vector<std::vector<int>>> element_slots_;
+
+		/// init the pattern and the values of mat_ with the blocks of mat_ and entries_
+		void merge_entries();
+	};
+
 	class DenseMatrixCache : public MatrixCache
 	{
 	public:
@@ -160,6 +303,7 @@ namespace polyfem::utils
 		inline size_t non_zeros() const override { return mat_.size(); }
 		inline size_t triplet_count() const override { return non_zeros(); }
 		inline bool is_sparse() const override { return false; }
+		inline size_t memory_bytes() const override { return utils::memory_bytes(mat_); }
 
 		void add_value(const int e, const int i, const int j, const double value) override;
 		StiffnessMatrix get_matrix(const bool compute_mapping = true) override;
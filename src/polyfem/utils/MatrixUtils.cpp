@@ -1,6 +1,7 @@
 #include "MatrixUtils.hpp"
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/Timer.hpp>
 
 #include <vector>
@@ -81,6 +82,38 @@ void polyfem::utils::vector2matrix(const Eigen::VectorXd &vec, Eigen::MatrixXd &
 	mat = unflatten(vec, size);
 }
 
+Eigen::MatrixXd polyfem::utils::parallel_product(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const Eigen::MatrixXd &B)
+{
+	assert(A.cols() == B.rows());
+	Eigen::MatrixXd out(A.rows(), B.cols());
+	maybe_parallel_for(A.rows(), [&](int start, int end, int thread_id) {
+		for (int i = start; i < end; ++i)
+		{
+			out.row(i).setZero();
+			for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(A, i); it; ++it)
+				out.row(i) += it.value() * B.row(it.col());
+		}
+	});
+	return out;
+}
+
+Eigen::MatrixXd polyfem::utils::parallel_transpose_product(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const Eigen::MatrixXd &B)
+{
+	assert(A.rows() == B.rows());
+	auto storage = create_thread_storage(Eigen::MatrixXd(Eigen::MatrixXd::Zero(A.cols(), B.cols())));
+	maybe_parallel_for(A.rows(), [&](int start, int end, int thread_id) {
+		Eigen::MatrixXd &local = get_local_thread_storage(storage, thread_id);
+		for (int i = start; i < end; ++i)
+			for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(A, i); it; ++it)
+				local.row(it.col()) += it.value() * B.row(i);
+	});
+
+	Eigen::MatrixXd out = Eigen::MatrixXd::Zero(A.cols(), B.cols());
+	for (const Eigen::MatrixXd &local : storage)
+		out += local;
+	return out;
+}
+
 Eigen::SparseMatrix<double> polyfem::utils::lump_matrix(const Eigen::SparseMatrix<double> &M)
 {
 	std::vector<Eigen::Triplet<double>> triplets;
@@ -100,6 +133,32 @@ Eigen::SparseMatrix<double> polyfem::utils::lump_matrix(const Eigen::SparseMatri
 	return lumped;
 }
 
+bool polyfem::utils::add_to_pattern(const StiffnessMatrix &src, StiffnessMatrix &dst, const double scale)
+{
+	assert(src.rows() == dst.rows() && src.cols() == dst.cols());
+	dst.makeCompressed();
+
+	// check first so that dst is left untouched on failure
+	for (int k = 0; k < src.outerSize(); ++k)
+	{
+		for (StiffnessMatrix::InnerIterator it(src, k); it; ++it)
+		{
+			if (find_in_pattern(dst, it.row(), it.col()) == nullptr)
+				return false;
+		}
+	}
+
+	maybe_parallel_for(src.outerSize(), [&](int start, int end, int thread_id) {
+		for (int k = start; k < end; ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(src, k); it; ++it)
+				*find_in_pattern(dst, it.row(), it.col()) += scale * it.value();
+		}
+	});
+
+	return true;
+}
+
 void polyfem::utils::full_to_reduced_matrix(
 	const int full_size,
 	const int reduced_size,
@@ -5,6 +5,9 @@
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include <algorithm>
+#include <cassert>
+
 namespace polyfem
 {
 	namespace utils
@@ -81,6 +84,24 @@ namespace polyfem
 			return I;
 		}
 
+		/// @brief View a row-major buffer (e.g., interleaved coordinates) as a column-major matrix, without copying.
+		/// @param data Buffer of rows x cols entries, owned by the caller.
+		/// @param rows Number of rows.
+		/// @param cols Number of columns.
+		/// @return View that binds to ConstMatrixXdView and ConstMatrixXiView.
+		template <typename T>
+		Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>, 0, DynamicStride> row_major_view(const T *data, const int rows, const int cols)
+		{
+			return Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>, 0, DynamicStride>(data, rows, cols, DynamicStride(1, cols));
+		}
+
+		/// @brief Writable version of row_major_view, binds to MatrixXdView.
+		template <typename T>
+		Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>, 0, DynamicStride> row_major_view(T *data, const int rows, const int cols)
+		{
+			return Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>, 0, DynamicStride>(data, rows, cols, DynamicStride(1, cols));
+		}
+
 		/// Flatten rowwises
 		Eigen::VectorXd flatten(const Eigen::MatrixXd &X);
 
@@ -89,6 +110,12 @@ namespace polyfem
 
 		void vector2matrix(const Eigen::VectorXd &vec, Eigen::MatrixXd &mat);
 
+		/// @brief A * B, in parallel over the rows of A.
+		Eigen::MatrixXd parallel_product(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const Eigen::MatrixXd &B);
+
+		/// @brief A^T * B, in parallel over the rows of A with one accumulator per thread.
+		Eigen::MatrixXd parallel_transpose_product(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const Eigen::MatrixXd &B);
+
 		/// @brief Lump each row of a matrix into the diagonal.
 		/// @param M Matrix to lump.
 		/// @return Lumped matrix.
@@ -107,6 +134,26 @@ namespace polyfem
 			const StiffnessMatrix &full,
 			StiffnessMatrix &reduced);
 
+		/// @brief Add a sparse matrix into one whose sparsity pattern contains it, keeping the pattern of dst.
+		/// @param[in] src Matrix to add, can have explicit zeros.
+		/// @param[in,out] dst Compressed matrix to add to.
+		/// @param[in] scale Factor of src.
+		/// @return False, leaving dst untouched, if src has entries outside the pattern of dst.
+		bool add_to_pattern(const StiffnessMatrix &src, StiffnessMatrix &dst, const double scale = 1);
+
+		/// @brief Find the value of an entry in the pattern of a compressed sparse matrix.
+		/// @return Pointer to the value, nullptr if (row, col) is not in the pattern.
+		inline double *find_in_pattern(StiffnessMatrix &mat, const int row, const int col)
+		{
+			assert(mat.isCompressed());
+			const auto *begin = mat.innerIndexPtr() + mat.outerIndexPtr()[col];
+			const auto *end = mat.innerIndexPtr() + mat.outerIndexPtr()[col + 1];
+			const auto *it = std::lower_bound(begin, end, row);
+			if (it == end || *it != row)
+				return nullptr;
+			return mat.valuePtr() + (it - mat.innerIndexPtr());
+		}
+
 		/// @brief Reorder row blocks in a matrix.
 		/// @param in Input matrix.
 		/// @param in_to_out Mapping from input blocks to output blocks.
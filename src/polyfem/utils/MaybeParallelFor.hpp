@@ -10,6 +10,9 @@
 // Not using parallel for
 #endif
 
+#include <functional>
+#include <vector>
+
 namespace polyfem
 {
 	namespace utils
@@ -20,6 +23,11 @@ namespace polyfem
 		inline void maybe_parallel_for(int size, const std::function<void(int, int, int)> &partial_for);
 		inline void maybe_parallel_for(int size, const std::function<void(int)> &body);
 
+		// Perform a (maybe) parallel for loop over groups of independent items (see greedy_coloring).
+		// Colours are processed one after the other, the items of one colour in parallel.
+		// The body receives the item id and the thread id.
+		inline void maybe_parallel_for_colors(const std::vector<std::vector<int>> &colors, const std::function<void(int, int)> &body);
+
 		// Returns thread specific storage for further use in `maybe_parallel_for()`.
 		// The return type depends on the threading library used.
 		//     TBB         ⟹ `std::vector<LocalStorage>`
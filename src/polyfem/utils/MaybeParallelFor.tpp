@@ -1,11 +1,13 @@
 #include <polyfem/utils/MaybeParallelFor.hpp>
 
+#include <polyfem/utils/par_for.hpp>
+
 #if defined(POLYFEM_WITH_TBB)
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_reduce.h>
 #include <tbb/enumerable_thread_specific.h>
+#include <tbb/partitioner.h>
 #elif defined(POLYFEM_WITH_CPP_THREADS)
-#include <polyfem/utils/par_for.hpp>
 #include <execution>
 #else
 // Not using parallel for
@@ -20,9 +22,14 @@ namespace polyfem
 #if defined(POLYFEM_WITH_CPP_THREADS)
 			par_for(size, partial_for);
 #elif defined(POLYFEM_WITH_TBB)
-			tbb::parallel_for(tbb::blocked_range<int>(0, size), [&](const tbb::blocked_range<int> &r) {
+			const auto body = [&](const tbb::blocked_range<int> &r) {
 				partial_for(r.begin(), r.end(), tbb::this_task_arena::current_thread_index());
-			});
+			};
+			// the static partitioner maps the same subranges to the same threads at every call
+			if (NThread::get().numa())
+				tbb::parallel_for(tbb::blocked_range<int>(0, size), body, tbb::static_partitioner());
+			else
+				tbb::parallel_for(tbb::blocked_range<int>(0, size), body);
 #else
 			partial_for(0, size, /*thread_id=*/0); // actually the full for loop
 #endif
@@ -31,16 +38,32 @@ namespace polyfem
 		inline void maybe_parallel_for(int size, const std::function<void(int)> &body)
 		{
 #if defined(POLYFEM_WITH_CPP_THREADS)
-			for (int i = 0; i < size; ++i)
-				body(i);
+			par_for(size, [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+					body(i);
+			});
 #elif defined(POLYFEM_WITH_TBB)
-			tbb::parallel_for(0, size, body);
+			if (NThread::get().numa())
+				tbb::parallel_for(0, size, body, tbb::static_partitioner());
+			else
+				tbb::parallel_for(0, size, body);
 #else
 			for (int i = 0; i < size; ++i)
 				body(i);
 #endif
 		}
 
+		inline void maybe_parallel_for_colors(const std::vector<std::vector<int>> &colors, const std::function<void(int, int)> &body)
+		{
+			for (const std::vector<int> &color : colors)
+			{
+				maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; ++i)
+						body(color[i], thread_id);
+				});
+			}
+		}
+
 		template <typename LocalStorage>
 		inline auto create_thread_storage(const LocalStorage &initial_local_storage)
 		{
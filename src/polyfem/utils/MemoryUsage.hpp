@@ -0,0 +1,94 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		// Heap memory owned by the common containers, in bytes (the object itself is not counted).
+		// The vectors count their capacity and the memory of their elements when these are vectors, Eigen objects,
+		// or classes with a memory_bytes() member.
+
+		template <typename Derived>
+		inline size_t memory_bytes(const Eigen::PlainObjectBase<Derived> &m)
+		{
+			// matrices with a bounded size live on the stack
+			if constexpr (Derived::MaxSizeAtCompileTime == Eigen::Dynamic)
+				return size_t(m.size()) * sizeof(typename Derived::Scalar);
+			else
+				return 0;
+		}
+
+		template <typename Scalar, int Options, typename StorageIndex>
+		inline size_t memory_bytes(const Eigen::SparseMatrix<Scalar, Options, StorageIndex> &m)
+		{
+			size_t bytes = size_t(m.data().allocatedSize()) * (sizeof(Scalar) + sizeof(StorageIndex));
+			bytes += size_t(m.outerSize() + 1) * sizeof(StorageIndex);
+			if (!m.isCompressed())
+				bytes += size_t(m.outerSize()) * sizeof(StorageIndex);
+			return bytes;
+		}
+
+		template <typename Allocator>
+		inline size_t memory_bytes(const std::vector<bool, Allocator> &v)
+		{
+			return v.capacity() / 8;
+		}
+
+		template <typename T, typename Allocator>
+		inline size_t memory_bytes(const std::vector<T, Allocator> &v);
+
+		namespace internal
+		{
+			template <typename T>
+			struct is_std_vector : std::false_type
+			{
+			};
+			template <typename T, typename Allocator>
+			struct is_std_vector<std::vector<T, Allocator>> : std::true_type
+			{
+			};
+
+			template <typename T, typename = void>
+			struct has_memory_bytes : std::false_type
+			{
+			};
+			template <typename T>
+			struct has_memory_bytes<T, std::void_t<decltype(std::declval<const T &>().memory_bytes())>> : std::true_type
+			{
+			};
+		} // namespace internal
+
+		template <typename T, typename Allocator>
+		inline size_t memory_bytes(const std::vector<T, Allocator> &v)
+		{
+			size_t bytes = v.capacity() * sizeof(T);
+			if constexpr (internal::has_memory_bytes<T>::value)
+			{
+				for (const T &x : v)
+					bytes += x.memory_bytes();
+			}
+			else if constexpr (internal::is_std_vector<T>::value || std::is_base_of_v<Eigen::EigenBase<T>, T>)
+			{
+				for (const T &x : v)
+					bytes += memory_bytes(x);
+			}
+			return bytes;
+		}
+
+		/// heap memory of an ipc::Collisions or ipc::FrictionCollisions set in bytes
+		template <typename CollisionSet>
+		inline size_t collisions_memory_bytes(const CollisionSet &collisions)
+		{
+			return memory_bytes(collisions.vv_collisions) + memory_bytes(collisions.ev_collisions)
+				   + memory_bytes(collisions.ee_collisions) + memory_bytes(collisions.fv_collisions);
+		}
+	} // namespace utils
+} // namespace polyfem
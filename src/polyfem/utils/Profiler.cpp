@@ -0,0 +1,227 @@
+#include "Profiler.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		namespace
+		{
+			// innermost zone running on this thread
+			thread_local ProfileZone *current_zone = nullptr;
+
+			std::string full_name(const char *scope, const char *name)
+			{
+				return scope == nullptr ? std::string(name) : (std::string(scope) + "::" + name);
+			}
+		} // namespace
+
+		struct Profiler::ThreadBuffer
+		{
+			struct PairHash
+			{
+				size_t operator()(const std::pair<const char *, const char *> &p) const
+				{
+					return std::hash<const char *>()(p.first) * 31 + std::hash<const char *>()(p.second);
+				}
+			};
+
+			struct Totals
+			{
+				size_t count = 0;
+				int64_t total = 0;
+				int64_t self = 0;
+				int64_t max = 0;
+			};
+
+			int thread_index;
+			std::vector<Event> events; ///< ring buffer
+			size_t n_recorded = 0;
+			std::unordered_map<std::pair<const char *, const char *>, Totals, PairHash> totals;
+
+			// only contended while exporting
+			std::mutex mutex;
+		};
+
+		Profiler::Profiler()
+			: start_(std::chrono::steady_clock::now())
+		{
+		}
+
+		Profiler::~Profiler() = default;
+
+		Profiler &Profiler::get()
+		{
+			static Profiler instance;
+			return instance;
+		}
+
+		void Profiler::enable(const size_t buffer_size)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				buffer_size_ = std::max<size_t>(buffer_size, 1);
+			}
+			clear();
+			start_ = std::chrono::steady_clock::now();
+			enabled_.store(true);
+		}
+
+		void Profiler::disable()
+		{
+			enabled_.store(false);
+		}
+
+		void Profiler::clear()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (auto &buffer : buffers_)
+			{
+				std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+				buffer->events.assign(buffer_size_, Event());
+				buffer->n_recorded = 0;
+				buffer->totals.clear();
+			}
+		}
+
+		const char *Profiler::intern(const std::string &name)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return names_.insert(name).first->c_str();
+		}
+
+		Profiler::ThreadBuffer &Profiler::thread_buffer()
+		{
+			// the buffers are never freed, a thread keeps its buffer across enable/clear
+			thread_local ThreadBuffer *buffer = nullptr;
+			if (buffer == nullptr)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				buffers_.push_back(std::make_unique<ThreadBuffer>());
+				buffer = buffers_.back().get();
+				buffer->thread_index = buffers_.size() - 1;
+				buffer->events.resize(buffer_size_);
+			}
+			return *buffer;
+		}
+
+		void Profiler::record(const char *scope, const char *name, const int64_t begin, const int64_t duration, const int64_t self, const int depth)
+		{
+			ThreadBuffer &buffer = thread_buffer();
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+
+			buffer.events[buffer.n_recorded % buffer.events.size()] = {scope, name, begin, duration, depth};
+			++buffer.n_recorded;
+
+			// the totals are keyed by the pointers of interned or literal names, merged by value in summary
+			ThreadBuffer::Totals &t = buffer.totals[{scope, name}];
+			++t.count;
+			t.total += duration;
+			t.self += self;
+			t.max = std::max(t.max, duration);
+		}
+
+		json Profiler::summary() const
+		{
+			std::map<std::string, ThreadBuffer::Totals> merged;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				for (const auto &buffer : buffers_)
+				{
+					std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+					for (const auto &[key, t] : buffer->totals)
+					{
+						ThreadBuffer::Totals &m = merged[full_name(key.first, key.second)];
+						m.count += t.count;
+						m.total += t.total;
+						m.self += t.self;
+						m.max = std::max(m.max, t.max);
+					}
+				}
+			}
+
+			json zones = json::object();
+			for (const auto &[name, t] : merged)
+			{
+				zones[name] = {
+					{"count", t.count},
+					{"total", t.total * 1e-9},
+					{"self", t.self * 1e-9},
+					{"max", t.max * 1e-9}};
+			}
+			return zones;
+		}
+
+		void Profiler::save_chrome_trace(const std::string &path) const
+		{
+			std::ofstream out(path);
+			if (!out.is_open())
+			{
+				logger().error("Unable to save the profiler trace to {}", path);
+				return;
+			}
+
+			json events = json::array();
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				for (const auto &buffer : buffers_)
+				{
+					std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+					const size_t n = std::min(buffer->n_recorded, buffer->events.size());
+					if (buffer->n_recorded > n)
+						logger().warn("Profiler buffer of thread {} overflowed, only the last {} of {} events are saved", buffer->thread_index, n, buffer->n_recorded);
+
+					for (size_t i = buffer->n_recorded - n; i < buffer->n_recorded; ++i)
+					{
+						const Event &e = buffer->events[i % buffer->events.size()];
+						events.push_back({
+							{"name", full_name(e.scope, e.name)},
+							{"cat", "polyfem"},
+							{"ph", "X"},
+							{"ts", e.begin * 1e-3},
+							{"dur", e.duration * 1e-3},
+							{"pid", 0},
+							{"tid", buffer->thread_index},
+							{"args", {{"depth", e.depth}}},
+						});
+					}
+				}
+			}
+
+			out << json({{"traceEvents", events}, {"displayTimeUnit", "ms"}}).dump() << std::endl;
+		}
+
+		ProfileZone::ProfileZone(const char *name, const char *scope)
+			: scope_(scope), name_(name)
+		{
+			Profiler &profiler = Profiler::get();
+			if (!profiler.enabled())
+				return;
+
+			parent_ = current_zone;
+			depth_ = parent_ == nullptr ? 0 : (parent_->depth_ + 1);
+			current_zone = this;
+			begin_ = profiler.now();
+		}
+
+		ProfileZone::~ProfileZone()
+		{
+			if (begin_ < 0)
+				return;
+
+			Profiler &profiler = Profiler::get();
+			const int64_t duration = profiler.now() - begin_;
+
+			current_zone = parent_;
+			if (parent_ != nullptr)
+				parent_->children_ += duration;
+
+			profiler.record(scope_, name_, begin_, duration, duration - children_, depth_);
+		}
+	} // namespace utils
+} // namespace polyfem
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#define POLYFEM_PROFILE_ZONE(...) polyfem::utils::ProfileZone __polyfem_profile_zone(__VA_ARGS__)
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// Hierarchical profiler of the hot paths.
+		/// Every thread records its zones into its own ring buffer (for the trace) and into its own
+		/// per-zone totals (for the summary), so recording does not synchronize the threads.
+		/// When disabled a zone costs one relaxed atomic load.
+		class Profiler
+		{
+		public:
+			struct Event
+			{
+				const char *scope; ///< optional prefix of the name (eg the form name), can be null
+				const char *name;
+				int64_t begin; ///< ns since the profiler was enabled
+				int64_t duration; ///< ns
+				int depth; ///< number of enclosing zones on the thread
+			};
+
+			static Profiler &get();
+
+			inline bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+			/// enables the recording and clears the previous records
+			/// @param[in] buffer_size number of events kept per thread for the trace, the oldest are overwritten
+			void enable(const size_t buffer_size = 1 << 16);
+			void disable();
+			/// removes all records, must not be called while zones are running on other threads
+			void clear();
+
+			/// returns a pointer to a copy of name that lives as long as the profiler, for the zones with runtime names
+			const char *intern(const std::string &name);
+
+			/// per zone count, total and self (without the nested zones) time in seconds, summed over the threads
+			json summary() const;
+			/// writes the recorded events in the Chrome trace event format (chrome://tracing, Perfetto)
+			void save_chrome_trace(const std::string &path) const;
+
+			/// used by ProfileZone
+			void record(const char *scope, const char *name, const int64_t begin, const int64_t duration, const int64_t self, const int depth);
+			inline int64_t now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count(); }
+
+		private:
+			struct ThreadBuffer;
+
+			Profiler();
+			~Profiler();
+
+			ThreadBuffer &thread_buffer();
+
+			std::atomic<bool> enabled_{false};
+			size_t buffer_size_ = 1 << 16;
+			std::chrono::steady_clock::time_point start_;
+
+			mutable std::mutex mutex_; ///< protects the list of buffers and the interned names
+			std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+			std::unordered_set<std::string> names_;
+		};
+
+		/// Records the time between its construction and destruction as a zone of the profiler.
+		/// The name (and scope) must outlive the profiler: string literals or Profiler::intern.
+		class ProfileZone
+		{
+		public:
+			ProfileZone(const char *name, const char *scope = nullptr);
+			~ProfileZone();
+
+			ProfileZone(const ProfileZone &) = delete;
+			ProfileZone &operator=(const ProfileZone &) = delete;
+
+		private:
+			const char *scope_;
+			const char *name_;
+			int64_t begin_ = -1; ///< -1 if the profiler was disabled at construction
+			int64_t children_ = 0; ///< time spent in the nested zones
+			ProfileZone *parent_ = nullptr;
+			int depth_ = 0;
+		};
+	} // namespace utils
+} // namespace polyfem
@@ -1,6 +1,11 @@
 #include "RBFInterpolation.hpp"
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <Eigen/Sparse>
+
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -8,6 +13,12 @@ namespace polyfem
 {
 	namespace utils
 	{
+		namespace
+		{
+			// cells of the grid of the compact kernels, 21 bits per coordinate
+			constexpr int CELL_OFFSET = 1 << 20;
+		} // namespace
+
 		RBFInterpolation::RBFInterpolation(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts, const std::string &rbf, const double eps)
 		{
 			init(fun, pts, rbf, eps);
@@ -16,6 +27,40 @@ namespace polyfem
 		void RBFInterpolation::init(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts, const std::string &rbf, const double eps)
 		{
 			assert(pts.rows() >= 0);
+
+			eps_ = eps;
+			if (rbf == "multiquadric")
+				kernel_ = Kernel::Multiquadric;
+			else if (rbf == "inverse" || rbf == "inverse_multiquadric" || rbf == "inverse multiquadric")
+				kernel_ = Kernel::InverseMultiquadric;
+			else if (rbf == "gaussian")
+				kernel_ = Kernel::Gaussian;
+			else if (rbf == "linear")
+				kernel_ = Kernel::Linear;
+			else if (rbf == "cubic")
+				kernel_ = Kernel::Cubic;
+			else if (rbf == "quintic")
+				kernel_ = Kernel::Quintic;
+			else if (rbf == "thin_plate" || rbf == "thin-plate")
+				kernel_ = Kernel::ThinPlate;
+			else if (rbf == "wendland" || rbf == "wendland_c2")
+				kernel_ = Kernel::WendlandC2;
+			else if (rbf == "wendland_c4")
+				kernel_ = Kernel::WendlandC4;
+			else
+			{
+				logger().warn("Unable to match {} rbf, falling back to multiquadric", rbf);
+				assert(false);
+
+				kernel_ = Kernel::Multiquadric;
+			}
+
+			if (is_compact())
+			{
+				init_compact(fun, pts);
+				return;
+			}
+
 #ifdef POLYFEM_OPENCL
 			std::vector<double> pointscl(pts.size());
 			std::vector<double> functioncl(fun.rows());
@@ -40,45 +85,7 @@ namespace polyfem
 				rbf_pum::init(pointscl, functioncl, data_[i], verbose_, rbfcl_, opt_, unit_cube_, num_threads_);
 			}
 #else
-			std::function<double(double)> tmp;
-
-			if (rbf == "multiquadric")
-			{
-				tmp = [eps](const double r) { return sqrt((r / eps) * (r / eps) + 1); };
-			}
-			else if (rbf == "inverse" || rbf == "inverse_multiquadric" || rbf == "inverse multiquadric")
-			{
-				tmp = [eps](const double r) { return 1.0 / sqrt((r / eps) * (r / eps) + 1); };
-			}
-			else if (rbf == "gaussian")
-			{
-				tmp = [eps](const double r) { return exp(-(r / eps) * (r / eps)); };
-			}
-			else if (rbf == "linear")
-			{
-				tmp = [](const double r) { return r; };
-			}
-			else if (rbf == "cubic")
-			{
-				tmp = [](const double r) { return r * r * r; };
-			}
-			else if (rbf == "quintic")
-			{
-				tmp = [](const double r) { return r * r * r * r * r; };
-			}
-			else if (rbf == "thin_plate" || rbf == "thin-plate")
-			{
-				tmp = [](const double r) { return abs(r) < 1e-10 ? 0 : (r * r * log(r)); };
-			}
-			else
-			{
-				logger().warn("Unable to match {} rbf, falling back to multiquadric", rbf);
-				assert(false);
-
-				tmp = [eps](const double r) { return sqrt((r / eps) * (r / eps) + 1); };
-			}
-
-			init(fun, pts, tmp);
+			init_dense(fun, pts);
 #endif
 		}
 
@@ -96,23 +103,179 @@ namespace polyfem
 #ifdef POLYFEM_OPENCL
 			assert(false);
 #else
-			assert(pts.rows() >= 0);
+			kernel_ = Kernel::Custom;
+			rbf_ = rbf;
+			init_dense(fun, pts);
+#endif
+		}
+
+		template <typename Fn>
+		void RBFInterpolation::with_kernel(Fn &&fn) const
+		{
+			const double eps = eps_;
+			switch (kernel_)
+			{
+			case Kernel::Multiquadric:
+				fn([eps](const double r) { return sqrt((r / eps) * (r / eps) + 1); });
+				break;
+			case Kernel::InverseMultiquadric:
+				fn([eps](const double r) { return 1.0 / sqrt((r / eps) * (r / eps) + 1); });
+				break;
+			case Kernel::Gaussian:
+				fn([eps](const double r) { return exp(-(r / eps) * (r / eps)); });
+				break;
+			case Kernel::Linear:
+				fn([](const double r) { return r; });
+				break;
+			case Kernel::Cubic:
+				fn([](const double r) { return r * r * r; });
+				break;
+			case Kernel::Quintic:
+				fn([](const double r) { return r * r * r * r * r; });
+				break;
+			case Kernel::ThinPlate:
+				fn([](const double r) { return abs(r) < 1e-10 ? 0 : (r * r * log(r)); });
+				break;
+			case Kernel::WendlandC2:
+				fn([eps](const double r) {
+					const double q = r / eps;
+					return q >= 1 ? 0 : std::pow(1 - q, 4) * (4 * q + 1);
+				});
+				break;
+			case Kernel::WendlandC4:
+				fn([eps](const double r) {
+					const double q = r / eps;
+					return q >= 1 ? 0 : std::pow(1 - q, 6) * (35 * q * q + 18 * q + 3) / 3;
+				});
+				break;
+			case Kernel::Custom:
+#ifndef POLYFEM_OPENCL
+				fn([this](const double r) { return rbf_(r); });
+#endif
+				break;
+			}
+		}
+
+		Eigen::Vector3i RBFInterpolation::cell(const Eigen::RowVectorXd &p) const
+		{
+			Eigen::Vector3i c = Eigen::Vector3i::Zero();
+			for (int d = 0; d < p.size(); ++d)
+				c[d] = int(std::floor((p[d] - grid_origin_[d]) / eps_));
+			return c;
+		}
+
+		uint64_t RBFInterpolation::cell_key(const Eigen::Vector3i &c) const
+		{
+			uint64_t key = 0;
+			for (int d = 0; d < 3; ++d)
+				key = (key << 21) | uint64_t(c[d] + CELL_OFFSET);
+			return key;
+		}
+
+		template <typename Fn>
+		void RBFInterpolation::for_each_center_near(const Eigen::RowVectorXd &p, Fn &&fn) const
+		{
+			const int dim = p.size();
+			const Eigen::Vector3i c = cell(p);
+			const int dz = dim == 3 ? 1 : 0;
+			for (int i = -1; i <= 1; ++i)
+			{
+				for (int j = -1; j <= 1; ++j)
+				{
+					for (int k = -dz; k <= dz; ++k)
+					{
+						const Eigen::Vector3i n = c + Eigen::Vector3i(i, j, k);
+						// the cells out of the range of the keys have no center
+						if ((n.array().abs() >= CELL_OFFSET - 1).any())
+							continue;
+						const auto it = grid_.find(cell_key(n));
+						if (it == grid_.end())
+							continue;
+						for (const int ci : it->second)
+						{
+							const double r = (centers_.row(ci) - p).norm();
+							if (r < eps_)
+								fn(ci, r);
+						}
+					}
+				}
+			}
+		}
+
+		void RBFInterpolation::init_compact(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts)
+		{
 			assert(pts.rows() == fun.rows());
+			assert(pts.cols() <= 3);
+			if (eps_ <= 0)
+				log_and_throw_error("The support of the {} rbf has to be positive, got {}", kernel_ == Kernel::WendlandC2 ? "wendland_c2" : "wendland_c4", eps_);
 
-			rbf_ = rbf;
 			centers_ = pts;
-
 			const int n = centers_.rows();
 
-			Eigen::MatrixXd A(n, n);
-
+			grid_.clear();
+			grid_origin_ = n > 0 ? Eigen::RowVectorXd(centers_.colwise().minCoeff()) : Eigen::RowVectorXd::Zero(pts.cols());
 			for (int i = 0; i < n; ++i)
 			{
-				for (int j = 0; j < n; ++j)
+				const Eigen::Vector3i c = cell(centers_.row(i));
+				if ((c.array() >= CELL_OFFSET - 1).any())
+					log_and_throw_error("The support {} of the rbf is too small for the extent of the points", eps_);
+				grid_[cell_key(c)].push_back(i);
+			}
+
+			// the columns of the symmetric matrix, built in parallel
+			std::vector<std::vector<std::pair<int, double>>> columns(n);
+			with_kernel([&](const auto &phi) {
+				maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; ++i)
+					{
+						for_each_center_near(centers_.row(i), [&](const int j, const double r) { columns[i].emplace_back(j, phi(r)); });
+						std::sort(columns[i].begin(), columns[i].end());
+					}
+				});
+			});
+
+			Eigen::SparseMatrix<double> A(n, n);
+			size_t nnz = 0;
+			for (const auto &col : columns)
+				nnz += col.size();
+			A.resizeNonZeros(nnz);
+			A.outerIndexPtr()[0] = 0;
+			for (int i = 0, k = 0; i < n; ++i)
+			{
+				for (const auto &[j, v] : columns[i])
 				{
-					A(i, j) = rbf((centers_.row(i) - centers_.row(j)).norm());
+					A.innerIndexPtr()[k] = j;
+					A.valuePtr()[k++] = v;
 				}
+				A.outerIndexPtr()[i + 1] = k;
 			}
+			columns.clear();
+
+			Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(A);
+			if (solver.info() != Eigen::Success)
+				log_and_throw_error("Unable to factorize the rbf system of {} points", n);
+
+			weights_ = solver.solve(fun);
+			logger().debug("RBF interpolation of {} points with a compact kernel, {} non zeros", n, nnz);
+		}
+
+		void RBFInterpolation::init_dense(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts)
+		{
+			assert(pts.rows() >= 0);
+			assert(pts.rows() == fun.rows());
+
+			centers_ = pts;
+
+			const int n = centers_.rows();
+
+			Eigen::MatrixXd A(n, n);
+			with_kernel([&](const auto &phi) {
+				maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+					for (int j = start; j < end; ++j)
+						for (int i = 0; i < n; ++i)
+							A(i, j) = phi((centers_.row(i) - centers_.row(j)).norm());
+				});
+			});
 
 			Eigen::FullPivLU<Eigen::MatrixXd> lu(A);
 
@@ -121,48 +284,58 @@ namespace polyfem
 			{
 				weights_.col(i) = lu.solve(fun.col(i));
 			}
-#endif
 		}
 
 		Eigen::MatrixXd RBFInterpolation::interpolate(const Eigen::MatrixXd &pts) const
 		{
 #ifdef POLYFEM_OPENCL
-			Eigen::MatrixXd res(pts.rows(), data_.size());
-
-			std::vector<double> pointscl(pts.size());
-			int index = 0;
-			for (int i = 0; i < pts.rows(); ++i)
+			if (!is_compact())
 			{
-				for (int j = 0; j < pts.cols(); ++j)
+				Eigen::MatrixXd res(pts.rows(), data_.size());
+
+				std::vector<double> pointscl(pts.size());
+				int index = 0;
+				for (int i = 0; i < pts.rows(); ++i)
 				{
-					pointscl[index++] = pts(i, j);
+					for (int j = 0; j < pts.cols(); ++j)
+					{
+						pointscl[index++] = pts(i, j);
+					}
 				}
-			}
 
-			std::vector<double> tmp;
-			for (size_t i = 0; i < data_.size(); ++i)
-			{
-				rbf_pum::interpolate(data_[i], pointscl, tmp, verbose_, rbfcl_, opt_, unit_cube_, num_threads_);
+				std::vector<double> tmp;
+				for (size_t i = 0; i < data_.size(); ++i)
+				{
+					rbf_pum::interpolate(data_[i], pointscl, tmp, verbose_, rbfcl_, opt_, unit_cube_, num_threads_);
 
-				for (size_t j = 0; j < tmp.size(); ++j)
-					res(j, i) = tmp[j];
+					for (size_t j = 0; j < tmp.size(); ++j)
+						res(j, i) = tmp[j];
+				}
+				return res;
 			}
-#else
+#endif
 			assert(pts.cols() == centers_.cols());
 			const int n = centers_.rows();
 			const int m = pts.rows();
 
-			Eigen::MatrixXd mat(m, n);
-			for (int i = 0; i < m; ++i)
-			{
-				for (int j = 0; j < n; ++j)
-				{
-					mat(i, j) = rbf_((centers_.row(j) - pts.row(i)).norm());
-				}
-			}
+			// the points are evaluated in parallel, without the m x n matrix of the kernel values
+			Eigen::MatrixXd res = Eigen::MatrixXd::Zero(m, weights_.cols());
+			with_kernel([&](const auto &phi) {
+				maybe_parallel_for(m, [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; ++i)
+					{
+						if (is_compact())
+						{
+							for_each_center_near(pts.row(i), [&](const int j, const double r) { res.row(i) += phi(r) * weights_.row(j); });
+							continue;
+						}
+
+						for (int j = 0; j < n; ++j)
+							res.row(i) += phi((centers_.row(j) - pts.row(i)).norm()) * weights_.row(j);
+					}
+				});
+			});
 
-			const Eigen::MatrixXd res = mat * weights_;
-#endif
 			return res;
 		}
 	} // namespace utils
@@ -2,8 +2,11 @@
 
 #include <Eigen/Dense>
 
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #ifdef POLYFEM_OPENCL
 #include <rbf_interpolate.hpp>
@@ -13,6 +16,10 @@ namespace polyfem
 {
 	namespace utils
 	{
+		/// Radial basis function interpolation of the rows of fun at the points pts.
+		/// The compactly supported Wendland kernels (wendland_c2 and wendland_c4, eps is the radius of their support)
+		/// give a sparse symmetric positive definite system, the centers in the support of a point are found in a uniform
+		/// grid of cells of size eps. The other kernels give a dense system.
 		class RBFInterpolation
 		{
 		public:
@@ -26,6 +33,42 @@ namespace polyfem
 			Eigen::MatrixXd interpolate(const Eigen::MatrixXd &pts) const;
 
 		private:
+			enum class Kernel
+			{
+				Custom,
+				Multiquadric,
+				InverseMultiquadric,
+				Gaussian,
+				Linear,
+				Cubic,
+				Quintic,
+				ThinPlate,
+				WendlandC2,
+				WendlandC4
+			};
+			Kernel kernel_ = Kernel::Custom;
+			double eps_ = 1;
+			bool is_compact() const { return kernel_ == Kernel::WendlandC2 || kernel_ == Kernel::WendlandC4; }
+
+			Eigen::MatrixXd centers_;
+			Eigen::MatrixXd weights_;
+
+			/// centers by cell of size eps_, for the compact kernels
+			std::unordered_map<uint64_t, std::vector<int>> grid_;
+			Eigen::RowVectorXd grid_origin_;
+
+			/// calls fn with the kernel as a function of the distance, the kernel is inlined in fn
+			template <typename Fn>
+			void with_kernel(Fn &&fn) const;
+			/// calls fn(j, r) for the centers j at a distance r < eps_ of p
+			template <typename Fn>
+			void for_each_center_near(const Eigen::RowVectorXd &p, Fn &&fn) const;
+			uint64_t cell_key(const Eigen::Vector3i &cell) const;
+			Eigen::Vector3i cell(const Eigen::RowVectorXd &p) const;
+
+			void init_compact(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts);
+			void init_dense(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts);
+
 #ifdef POLYFEM_OPENCL
 			int verbose_ = 0;
 			const std::string rbfcl_ = "GA";
@@ -35,9 +78,6 @@ namespace polyfem
 
 			std::vector<rbf_pum::RBFData> data_;
 #else
-			Eigen::MatrixXd centers_;
-			Eigen::MatrixXd weights_;
-
 			std::function<double(double)> rbf_;
 #endif
 		};
@@ -4,15 +4,80 @@
 #include <polyfem/utils/Types.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <polyfem/io/MatrixIO.hpp>
 
+#include <algorithm>
 #include <memory>
 
 namespace polyfem::utils
 {
 	using namespace polyfem::mesh;
 
+	SelectionPrimitives SelectionPrimitives::boundary_facets(const Mesh &mesh, std::vector<int> &boundary)
+	{
+		const int n = mesh.n_boundary_elements();
+
+		SelectionPrimitives primitives;
+		primitives.points.resize(n, mesh.dimension());
+		primitives.offsets.resize(n + 1);
+		primitives.offsets[0] = 0;
+		for (int f = 0; f < n; ++f)
+			primitives.offsets[f + 1] = primitives.offsets[f] + (mesh.is_volume() ? mesh.n_face_vertices(f) : 2);
+		primitives.vertices.resize(primitives.offsets.back());
+
+		std::vector<char> is_boundary(n);
+		maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+			for (int f = start; f < end; ++f)
+			{
+				is_boundary[f] = mesh.is_volume() ? mesh.is_boundary_face(f) : mesh.is_boundary_edge(f);
+				primitives.points.row(f) = mesh.is_volume() ? mesh.face_barycenter(f) : mesh.edge_barycenter(f);
+
+				int *vs = primitives.vertices.data() + primitives.offsets[f];
+				const int n_vs = primitives.offsets[f + 1] - primitives.offsets[f];
+				for (int lv = 0; lv < n_vs; ++lv)
+					vs[lv] = mesh.boundary_element_vertex(f, lv);
+				std::sort(vs, vs + n_vs);
+			}
+		});
+
+		boundary.clear();
+		for (int f = 0; f < n; ++f)
+		{
+			if (is_boundary[f])
+				boundary.push_back(f);
+		}
+
+		return primitives;
+	}
+
+	SelectionPrimitives SelectionPrimitives::elements(const Mesh &mesh)
+	{
+		const int n = mesh.n_elements();
+
+		SelectionPrimitives primitives;
+		primitives.points.resize(n, mesh.dimension());
+		primitives.offsets.resize(n + 1);
+		primitives.offsets[0] = 0;
+		for (int e = 0; e < n; ++e)
+			primitives.offsets[e + 1] = primitives.offsets[e] + mesh.n_cell_vertices(e);
+		primitives.vertices.resize(primitives.offsets.back());
+
+		maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+			{
+				primitives.points.row(e) = mesh.is_volume() ? mesh.cell_barycenter(e) : mesh.face_barycenter(e);
+				const std::vector<int> vs = mesh.element_vertices(e);
+				std::copy(vs.begin(), vs.end(), primitives.vertices.begin() + primitives.offsets[e]);
+			}
+		});
+
+		return primitives;
+	}
+
+	// ------------------------------------------------------------------------
+
 	std::shared_ptr<Selection> Selection::build(
 		const json &selection,
 		const Selection::BBox &mesh_bbox,
@@ -74,6 +139,58 @@ namespace polyfem::utils
 		return selections;
 	}
 
+	void Selection::inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const
+	{
+		inside.resize(indices.size());
+		maybe_parallel_for(indices.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const int p_id = indices[i];
+				inside(i) = this->inside(p_id, primitives.primitive_vertices(p_id), primitives.points.row(p_id));
+			}
+		});
+	}
+
+	void Selection::compute_ids(
+		const std::vector<std::shared_ptr<Selection>> &selections,
+		const SelectionPrimitives &primitives,
+		const std::vector<int> &candidates,
+		const int default_id,
+		std::vector<int> &ids)
+	{
+		assert(ids.size() == primitives.size());
+
+		// every selection is evaluated on the primitives not claimed by the previous ones
+		std::vector<int> remaining = candidates;
+		std::vector<int> selected, not_selected;
+		Eigen::Array<bool, Eigen::Dynamic, 1> inside;
+		for (const auto &selection : selections)
+		{
+			if (remaining.empty())
+				break;
+
+			selection->inside_batch(primitives, remaining, inside);
+
+			selected.clear();
+			not_selected.clear();
+			for (int i = 0; i < remaining.size(); ++i)
+				(inside(i) ? selected : not_selected).push_back(remaining[i]);
+
+			maybe_parallel_for(selected.size(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					const int p_id = selected[i];
+					ids[p_id] = selection->id(p_id, primitives.primitive_vertices(p_id), primitives.points.row(p_id));
+				}
+			});
+
+			std::swap(remaining, not_selected);
+		}
+
+		for (const int p_id : remaining)
+			ids[p_id] = default_id;
+	}
+
 	// ------------------------------------------------------------------------
 
 	BoxSelection::BoxSelection(
@@ -115,6 +232,13 @@ namespace polyfem::utils
 		return inside;
 	}
 
+	void BoxSelection::inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const
+	{
+		const Eigen::MatrixXd p = primitives.points(indices, Eigen::all);
+		inside = ((p.rowwise() - bbox_[0]).array() >= 0).rowwise().all()
+				 && ((p.rowwise() - bbox_[1]).array() <= 0).rowwise().all();
+	}
+
 	// ------------------------------------------------------------------------
 
 	BoxSideSelection::BoxSideSelection(
@@ -180,6 +304,12 @@ namespace polyfem::utils
 		return (p - center_).squaredNorm() <= radius2_;
 	}
 
+	void SphereSelection::inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const
+	{
+		const Eigen::MatrixXd p = primitives.points(indices, Eigen::all);
+		inside = (p.rowwise() - center_).rowwise().squaredNorm().array() <= radius2_;
+	}
+
 	// ------------------------------------------------------------------------
 
 	CylinderSelection::CylinderSelection(
@@ -221,6 +351,14 @@ namespace polyfem::utils
 		return (v - axis_ * proj).squaredNorm() <= radius2_;
 	}
 
+	void CylinderSelection::inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const
+	{
+		const Eigen::MatrixXd v = primitives.points(indices, Eigen::all).rowwise() - point_;
+		const Eigen::VectorXd proj = v * axis_.transpose();
+		const Eigen::VectorXd dist2 = (v - proj * axis_).rowwise().squaredNorm();
+		inside = proj.array() >= 0 && proj.array() <= height_ && dist2.array() <= radius2_;
+	}
+
 	// ------------------------------------------------------------------------
 
 	AxisPlaneSelection::AxisPlaneSelection(
@@ -262,6 +400,15 @@ namespace polyfem::utils
 			return v <= position_;
 	}
 
+	void AxisPlaneSelection::inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const
+	{
+		const Eigen::VectorXd v = primitives.points(indices, std::abs(axis_) - 1);
+		if (axis_ > 0)
+			inside = v.array() >= position_;
+		else
+			inside = v.array() <= position_;
+	}
+
 	// ------------------------------------------------------------------------
 
 	PlaneSelection::PlaneSelection(
@@ -288,6 +435,12 @@ namespace polyfem::utils
 		return pp.dot(normal_) >= 0;
 	}
 
+	void PlaneSelection::inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const
+	{
+		const Eigen::MatrixXd p = primitives.points(indices, Eigen::all).rowwise() - point_;
+		inside = (p * normal_.transpose()).array() >= 0;
+	}
+
 	// ------------------------------------------------------------------------
 
 	SpecifiedSelection::SpecifiedSelection(
@@ -323,18 +476,18 @@ namespace polyfem::utils
 		}
 		else
 		{
-			data_.resize(mat.rows());
+			data_.reserve(mat.rows());
 
+			std::vector<int> vs;
 			for (int i = 0; i < mat.rows(); ++i)
 			{
-				data_[i].first = mat(i, 0) + id_offset;
-
+				vs.clear();
 				for (int j = 1; j < mat.cols(); ++j)
-				{
-					data_[i].second.push_back(mat(i, j));
-				}
+					vs.push_back(mat(i, j));
+				std::sort(vs.begin(), vs.end());
 
-				std::sort(data_[i].second.begin(), data_[i].second.end());
+				// the first line listing a primitive gives its id
+				data_.emplace(vs, mat(i, 0) + id_offset);
 			}
 		}
 	}
@@ -344,13 +497,7 @@ namespace polyfem::utils
 		if (data_.empty())
 			return SpecifiedSelection::inside(p_id, vs, p);
 
-		std::vector<int> tmp;
-		for (const auto &t : data_)
-		{
-			if (t.second == vs)
-				return true;
-		}
-		return false;
+		return data_.find(vs) != data_.end();
 	}
 
 	int FileSelection::id(const size_t element_id, const std::vector<int> &vs, const RowVectorNd &p) const
@@ -358,12 +505,7 @@ namespace polyfem::utils
 		if (data_.empty())
 			return SpecifiedSelection::id(element_id, vs, p);
 
-		std::vector<int> tmp;
-		for (const auto &t : data_)
-		{
-			if (t.second == vs)
-				return t.first;
-		}
-		return -1;
+		const auto it = data_.find(vs);
+		return it == data_.end() ? -1 : it->second;
 	}
 } // namespace polyfem::utils
@@ -2,11 +2,38 @@
 
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/Common.hpp>
+#include <polyfem/utils/HashUtils.hpp>
+
+#include <unordered_map>
 
 namespace polyfem
 {
 	namespace utils
 	{
+		/// Primitives (boundary facets or elements) whose ids are computed together by Selection::compute_ids
+		struct SelectionPrimitives
+		{
+			/// barycenter of every primitive, one per row
+			Eigen::MatrixXd points;
+			/// the vertices of primitive i are vertices[offsets[i]], ..., vertices[offsets[i + 1] - 1]
+			std::vector<int> offsets;
+			std::vector<int> vertices;
+
+			int size() const { return points.rows(); }
+			std::vector<int> primitive_vertices(const int i) const
+			{
+				return std::vector<int>(vertices.begin() + offsets[i], vertices.begin() + offsets[i + 1]);
+			}
+
+			/// @brief Boundary facets (edges in 2D, faces in 3D) of the mesh, with sorted vertices
+			/// @param[in] mesh Mesh.
+			/// @param[out] boundary Ids of the facets on the boundary.
+			static SelectionPrimitives boundary_facets(const mesh::Mesh &mesh, std::vector<int> &boundary);
+
+			/// @brief Elements of the mesh, with their vertices
+			static SelectionPrimitives elements(const mesh::Mesh &mesh);
+		};
+
 		class Selection
 		{
 		public:
@@ -23,6 +50,25 @@ namespace polyfem
 				return id_;
 			}
 
+			/// @brief Batched version of inside, the geometric selections are vectorized over the barycenters.
+			/// @param[in] primitives All the primitives.
+			/// @param[in] indices Primitives to test.
+			/// @param[out] inside One flag per entry of indices.
+			virtual void inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const;
+
+			/// @brief Ids of a batch of primitives, the first selection containing a primitive gives its id.
+			/// @param[in] selections Selections, in order of priority.
+			/// @param[in] primitives All the primitives.
+			/// @param[in] candidates Primitives to assign, the other entries of ids are left untouched.
+			/// @param[in] default_id Id of the candidates in none of the selections.
+			/// @param[in,out] ids One id per primitive.
+			static void compute_ids(
+				const std::vector<std::shared_ptr<Selection>> &selections,
+				const SelectionPrimitives &primitives,
+				const std::vector<int> &candidates,
+				const int default_id,
+				std::vector<int> &ids);
+
 			/// @brief Build a selection objects from a JSON selection.
 			/// @param j_selections JSON object of selection(s).
 			/// @param mesh_bbox    Bounding box of the mesh.
@@ -59,6 +105,7 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const override;
 
 		protected:
 			BBox bbox_;
@@ -96,6 +143,7 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const override;
 
 		protected:
 			RowVectorNd center_;
@@ -112,6 +160,7 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const override;
 
 		protected:
 			RowVectorNd axis_;
@@ -130,6 +179,7 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const override;
 
 		protected:
 			int axis_;
@@ -146,6 +196,7 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_batch(const SelectionPrimitives &primitives, const std::vector<int> &indices, Eigen::Array<bool, Eigen::Dynamic, 1> &inside) const override;
 
 		protected:
 			RowVectorNd normal_;
@@ -194,7 +245,8 @@ namespace polyfem
 			int id(const size_t element_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
 
 		private:
-			std::vector<std::pair<int, std::vector<int>>> data_;
+			/// id of every listed primitive, keyed by its sorted vertices
+			std::unordered_map<std::vector<int>, int, HashVector> data_;
 		};
 	} // namespace utils
 } // namespace polyfem
@@ -0,0 +1,63 @@
+#include "TaskGraph.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/task_group.h>
+
+#include <atomic>
+#include <memory>
+#endif
+
+namespace polyfem
+{
+	namespace utils
+	{
+		int TaskGraph::add(const std::function<void()> &task, const std::vector<int> &dependencies)
+		{
+			const int id = tasks_.size();
+			tasks_.push_back({task, {}, 0});
+			for (const int d : dependencies)
+			{
+				if (d < 0 || d >= id)
+					log_and_throw_error("Invalid dependency {} of task {}", d, id);
+				tasks_[d].successors.push_back(id);
+				++tasks_[id].n_dependencies;
+			}
+			return id;
+		}
+
+		void TaskGraph::run()
+		{
+#ifdef POLYFEM_WITH_TBB
+			if (concurrent_ && tasks_.size() > 1)
+			{
+				// number of dependencies not finished yet, a task is spawned when it reaches 0
+				const std::unique_ptr<std::atomic<int>[]> remaining(new std::atomic<int>[tasks_.size()]);
+				for (int i = 0; i < tasks_.size(); ++i)
+					remaining[i] = tasks_[i].n_dependencies;
+
+				tbb::task_group group;
+				std::function<void(int)> spawn = [&](const int i) {
+					group.run([&, i] {
+						tasks_[i].run();
+						for (const int s : tasks_[i].successors)
+							if (--remaining[s] == 0)
+								spawn(s);
+					});
+				};
+
+				for (int i = 0; i < tasks_.size(); ++i)
+					if (tasks_[i].n_dependencies == 0)
+						spawn(i);
+				// rethrows the exception of a failed task, its successors were never spawned
+				group.wait();
+				return;
+			}
+#endif
+			// the dependencies were added before, the insertion order is a valid order
+			for (const Task &task : tasks_)
+				task.run();
+		}
+	} // namespace utils
+} // namespace polyfem
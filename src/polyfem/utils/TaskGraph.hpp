@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// Graph of tasks with dependencies, the tasks that do not depend on each other run concurrently.
+		/// With TBB the ready tasks are spawned in a task group and their parallel loops share the
+		/// threads of the arena, so two stages that do not saturate the machine alone can overlap.
+		/// With the C++ threads backend (whose nested loops are serial) or without threads the tasks
+		/// run one after the other in the order they were added.
+		class TaskGraph
+		{
+		public:
+			/// @param[in] concurrent if false the tasks always run one after the other
+			TaskGraph(const bool concurrent = true) : concurrent_(concurrent) {}
+
+			/// adds a task run after the given ones
+			/// @param[in] dependencies ids of tasks already added
+			/// @return id of the task
+			int add(const std::function<void()> &task, const std::vector<int> &dependencies = {});
+
+			/// runs all the tasks and waits for them, the first exception thrown by a task is rethrown
+			/// and the tasks depending on it are not run
+			void run();
+
+			void clear() { tasks_.clear(); }
+			int size() const { return tasks_.size(); }
+
+		private:
+			struct Task
+			{
+				std::function<void()> run;
+				std::vector<int> successors;
+				int n_dependencies = 0;
+			};
+
+			std::vector<Task> tasks_;
+			bool concurrent_;
+		};
+	} // namespace utils
+} // namespace polyfem
@@ -13,6 +13,12 @@ namespace polyfem
 	typedef Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 3> RowVectorNd;
 	typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 3, 3> MatrixNd;
 
+	// Views of dense buffers owned by the caller, the runtime strides accept any storage order
+	typedef Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> DynamicStride;
+	typedef Eigen::Ref<const Eigen::MatrixXd, 0, DynamicStride> ConstMatrixXdView;
+	typedef Eigen::Ref<const Eigen::MatrixXi, 0, DynamicStride> ConstMatrixXiView;
+	typedef Eigen::Ref<Eigen::MatrixXd, 0, DynamicStride> MatrixXdView;
+
 	static constexpr int MAX_QUAD_POINTS = -1;
 	typedef Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MAX_QUAD_POINTS, 1> QuadratureVector;
 
@@ -3,30 +3,331 @@
 #include <vector>
 #include <algorithm>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/task_arena.h>
+#endif
+
+#ifdef POLYFEM_WITH_CPP_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#endif
+
 namespace polyfem
 {
 	namespace utils
 	{
-		void par_for(const int size, const std::function<void(int, int, int)> &func)
+		namespace
 		{
-#ifdef POLYFEM_WITH_CPP_THREADS
-			const size_t n_threads = get_n_threads();
-			if (n_threads == 1)
-				func(0, size, /*thread_id=*/0); // actually the full for loop
-			else
+#ifdef __linux__
+			// cores the process may use, read before any thread is pinned
+			const cpu_set_t &process_cores()
 			{
-				std::vector<std::thread> threads(n_threads);
+				static const cpu_set_t cores = [] {
+					cpu_set_t set;
+					CPU_ZERO(&set);
+					if (sched_getaffinity(0, sizeof(set), &set) != 0)
+						CPU_ZERO(&set);
+					return set;
+				}();
+				return cores;
+			}
+#endif
+
+			// pins the calling thread to the index-th core the process may use (modulo the number of cores)
+			void pin_thread(const int index)
+			{
+#ifdef __linux__
+				const cpu_set_t &cores = process_cores();
+				const int n_cores = CPU_COUNT(&cores);
+				if (n_cores == 0)
+					return;
 
-				for (int t = 0; t < n_threads; t++)
+				int remaining = index % n_cores;
+				for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
 				{
-					threads[t] = std::thread(std::bind(
-						func,
-						t * size / n_threads,
-						(t + 1) == n_threads ? size : (t + 1) * size / n_threads,
-						t));
+					if (!CPU_ISSET(cpu, &cores) || remaining-- > 0)
+						continue;
+
+					cpu_set_t set;
+					CPU_ZERO(&set);
+					CPU_SET(cpu, &set);
+					pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+					return;
 				}
-				std::for_each(threads.begin(), threads.end(), [](std::thread &x) { x.join(); });
+#endif
 			}
+
+			void unpin_thread()
+			{
+#ifdef __linux__
+				const cpu_set_t &cores = process_cores();
+				if (CPU_COUNT(&cores) > 0)
+					pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+#endif
+			}
+
+#ifdef POLYFEM_WITH_TBB
+			class ThreadPinner : public tbb::task_scheduler_observer
+			{
+			public:
+				ThreadPinner() { observe(true); }
+				~ThreadPinner() { observe(false); }
+
+				void on_scheduler_entry(bool) override { pin_thread(tbb::this_task_arena::current_thread_index()); }
+			};
+#endif
+
+#ifdef POLYFEM_WITH_CPP_THREADS
+			// set while a thread executes chunks of the pool, nested loops run serially on it
+			thread_local bool in_pool = false;
+			thread_local int pool_thread_id = 0;
+
+			/// Persistent pool of get_n_threads() - 1 workers, the calling thread is worker 0.
+			/// The range is split in chunks, every worker owns a contiguous block of chunks,
+			/// takes them from the front and steals from the back of the other blocks once its own is empty.
+			/// In NUMA mode the workers are pinned and every worker runs exactly its own block.
+			class ThreadPool
+			{
+			public:
+				static ThreadPool &get()
+				{
+					static ThreadPool instance;
+					return instance;
+				}
+
+				~ThreadPool() { stop_workers(); }
+
+				void run(const int size, const std::function<void(int, int, int)> &func, const int n_threads)
+				{
+					std::unique_lock<std::mutex> region(run_mutex_, std::try_to_lock);
+					// nested loop or concurrent loop from another thread
+					if (in_pool || !region.owns_lock())
+					{
+						func(0, size, pool_thread_id);
+						return;
+					}
+
+					if (workers_.size() != n_threads - 1 || numa_ != NThread::get().numa())
+						start_workers(n_threads);
+
+					func_ = &func;
+					size_ = size;
+					n_chunks_ = std::min<int64_t>(size, int64_t(n_threads) * (numa_ ? 1 : chunks_per_thread));
+					for (int t = 0; t < n_threads; ++t)
+						queues_[t].store(pack(t * n_chunks_ / n_threads, (t + 1) * n_chunks_ / n_threads));
+					error_ = nullptr;
+
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						pending_ = workers_.size();
+						++generation_;
+					}
+					wake_.notify_all();
+
+					execute(0);
+
+					{
+						std::unique_lock<std::mutex> lock(mutex_);
+						done_.wait(lock, [&] { return pending_ == 0; });
+					}
+					func_ = nullptr;
+
+					if (error_)
+						std::rethrow_exception(error_);
+				}
+
+			private:
+				static constexpr int chunks_per_thread = 8;
+
+				ThreadPool() = default;
+
+				static uint64_t pack(const uint32_t front, const uint32_t back) { return (uint64_t(front) << 32) | back; }
+
+				// chunk c covers [c * size / n_chunks, (c + 1) * size / n_chunks)
+				void run_chunk(const int64_t c, const int thread_id)
+				{
+					const int start = c * size_ / n_chunks_;
+					const int end = (c + 1) * size_ / n_chunks_;
+					try
+					{
+						(*func_)(start, end, thread_id);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(error_mutex_);
+						if (!error_)
+							error_ = std::current_exception();
+					}
+				}
+
+				// takes the first chunk of queue q
+				bool pop_front(const int q, int64_t &c)
+				{
+					uint64_t range = queues_[q].load();
+					while (true)
+					{
+						const uint32_t front = range >> 32, back = range & 0xFFFFFFFF;
+						if (front >= back)
+							return false;
+						if (queues_[q].compare_exchange_weak(range, pack(front + 1, back)))
+						{
+							c = front;
+							return true;
+						}
+					}
+				}
+
+				// takes the last chunk of queue q
+				bool pop_back(const int q, int64_t &c)
+				{
+					uint64_t range = queues_[q].load();
+					while (true)
+					{
+						const uint32_t front = range >> 32, back = range & 0xFFFFFFFF;
+						if (front >= back)
+							return false;
+						if (queues_[q].compare_exchange_weak(range, pack(front, back - 1)))
+						{
+							c = back - 1;
+							return true;
+						}
+					}
+				}
+
+				void execute(const int thread_id)
+				{
+					const int n_queues = workers_.size() + 1;
+					in_pool = true;
+					pool_thread_id = thread_id;
+
+					int64_t c;
+					while (pop_front(thread_id, c))
+						run_chunk(c, thread_id);
+
+					// no chunk is added during a loop, once every queue is empty the work is done
+					for (int k = 1; k < n_queues && !numa_; ++k)
+					{
+						const int victim = (thread_id + k) % n_queues;
+						while (pop_back(victim, c))
+							run_chunk(c, thread_id);
+					}
+
+					in_pool = false;
+					pool_thread_id = 0;
+				}
+
+				// seen is the last loop before the worker was started
+				void worker_loop(const int thread_id, size_t seen)
+				{
+					if (numa_)
+						pin_thread(thread_id);
+
+					while (true)
+					{
+						{
+							std::unique_lock<std::mutex> lock(mutex_);
+							wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+							if (stop_)
+								return;
+							seen = generation_;
+						}
+
+						execute(thread_id);
+
+						std::lock_guard<std::mutex> lock(mutex_);
+						if (--pending_ == 0)
+							done_.notify_one();
+					}
+				}
+
+				void start_workers(const int n_threads)
+				{
+					stop_workers();
+
+					queues_ = std::make_unique<std::atomic<uint64_t>[]>(n_threads);
+					numa_ = NThread::get().numa();
+					size_t generation;
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						stop_ = false;
+						generation = generation_;
+					}
+					for (int t = 1; t < n_threads; ++t)
+						workers_.emplace_back(&ThreadPool::worker_loop, this, t, generation);
+				}
+
+				void stop_workers()
+				{
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						stop_ = true;
+					}
+					wake_.notify_all();
+					std::for_each(workers_.begin(), workers_.end(), [](std::thread &x) { x.join(); });
+					workers_.clear();
+				}
+
+				std::vector<std::thread> workers_;
+				std::unique_ptr<std::atomic<uint64_t>[]> queues_;
+
+				// current loop
+				const std::function<void(int, int, int)> *func_ = nullptr;
+				int64_t size_ = 0;
+				int64_t n_chunks_ = 0;
+				std::exception_ptr error_;
+				std::mutex error_mutex_;
+
+				// serializes the loops, concurrent callers run their loop serially
+				std::mutex run_mutex_;
+
+				std::mutex mutex_;
+				std::condition_variable wake_;
+				std::condition_variable done_;
+				size_t generation_ = 0;
+				size_t pending_ = 0;
+				bool stop_ = false;
+				bool numa_ = false;
+			};
+#endif
+		} // namespace
+
+		void NThread::set_numa(const bool numa)
+		{
+			if (numa == numa_)
+				return;
+			numa_ = numa;
+
+			// the calling thread is thread 0 of the C++ threads pool
+			if (numa)
+				pin_thread(0);
+			else
+				unpin_thread();
+
+#ifdef POLYFEM_WITH_TBB
+			if (numa)
+				thread_pinner = std::make_shared<ThreadPinner>();
+			else
+				thread_pinner.reset();
+#endif
+		}
+
+		void par_for(const int size, const std::function<void(int, int, int)> &func)
+		{
+#ifdef POLYFEM_WITH_CPP_THREADS
+			const size_t n_threads = get_n_threads();
+			if (n_threads <= 1 || size <= 1)
+				func(0, size, /*thread_id=*/0); // actually the full for loop
+			else
+				ThreadPool::get().run(size, func, n_threads);
 #endif
 		}
 	} // namespace utils
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <thread>
+#include <type_traits>
+#include <utility>
 
 #include <Eigen/Core>
 
 #ifdef POLYFEM_WITH_TBB
 #include <tbb/global_control.h>
+#include <tbb/task_scheduler_observer.h>
 #endif
 
 namespace polyfem
@@ -36,18 +40,60 @@ namespace polyfem
 				Eigen::setNbThreads(num_threads);
 			}
 
+			/// true if the threads are pinned and the loops are statically partitioned
+			inline bool numa() const { return numa_; }
+
+			/// NUMA mode: pins the threads to the cores the process may use and partitions every
+			/// maybe_parallel_for statically, so the same thread always gets the same part of a range.
+			/// The buffers first written in a loop (see first_touch_allocator) then stay in the
+			/// memory of the socket of the thread that uses them.
+			void set_numa(const bool numa);
+
 		private:
 			NThread() {}
 
 			size_t num_threads_;
+			bool numa_ = false;
 
 #ifdef POLYFEM_WITH_TBB
 			/// limits the number of used threads
 			std::shared_ptr<tbb::global_control> thread_limiter;
+			/// pins the threads entering the scheduler in NUMA mode
+			std::shared_ptr<tbb::task_scheduler_observer> thread_pinner;
 #endif
 		};
 
+		/// parallel for of the C++ threads backend, runs on a persistent pool of get_n_threads() threads.
+		/// The range is split in chunks that idle threads steal from the busy ones, so func can be called
+		/// several times with the same thread id. Loops nested in func run serially on the calling thread.
 		void par_for(const int size, const std::function<void(int, int, int)> &func);
 		inline size_t get_n_threads() { return NThread::get().num_threads(); }
+
+		/// allocator that leaves trivial values uninitialized on resize, the pages of the buffer are
+		/// then placed by the first loop that writes them instead of the allocating thread
+		template <typename T>
+		struct first_touch_allocator : std::allocator<T>
+		{
+			template <typename U>
+			struct rebind
+			{
+				using other = first_touch_allocator<U>;
+			};
+
+			first_touch_allocator() = default;
+			template <typename U>
+			first_touch_allocator(const first_touch_allocator<U> &) {}
+
+			template <typename U>
+			void construct(U *ptr) noexcept(std::is_nothrow_default_constructible<U>::value)
+			{
+				::new (static_cast<void *>(ptr)) U;
+			}
+			template <typename U, typename... Args>
+			void construct(U *ptr, Args &&...args)
+			{
+				::new (static_cast<void *>(ptr)) U(std::forward<Args>(args)...);
+			}
+		};
 	} // namespace utils
 } // namespace polyfem
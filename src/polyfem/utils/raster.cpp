@@ -1,6 +1,13 @@
 #include "raster.hpp"
 
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 #include <igl/per_vertex_normals.h>
+
+#include <array>
+#include <cmath>
+#include <fstream>
 #include <iostream>
 
 namespace polyfem
@@ -9,49 +16,84 @@ namespace polyfem
 	{
 		namespace
 		{
-			void rasterize_triangle(const Program &program, const UniformAttributes &uniform, const VertexAttributes &v1, const VertexAttributes &v2, const VertexAttributes &v3, Eigen::Matrix<FrameBufferAttributes, Eigen::Dynamic, Eigen::Dynamic> &frameBuffer)
+			constexpr int tile_size = 32;
+
+			/// triangle in screen space, the barycentric coordinates of a pixel are affine (edge) functions of its center
+			struct ScreenTriangle
 			{
-				Eigen::Matrix<double, 3, 4> p;
-				p.row(0) = v1.position.array() / v1.position[3];
-				p.row(1) = v2.position.array() / v2.position[3];
-				p.row(2) = v3.position.array() / v3.position[3];
+				int lx, ly, ux, uy;
+				/// barycentric coordinate k of (x, y) is a[k] x + b[k] y + c[k]
+				Eigen::Array3d a, b, c;
+			};
 
-				p.col(0) = ((p.col(0).array() + 1.0) / 2.0) * frameBuffer.rows();
-				p.col(1) = ((p.col(1).array() + 1.0) / 2.0) * frameBuffer.cols();
+			bool setup_triangle(const VertexAttributes &v1, const VertexAttributes &v2, const VertexAttributes &v3, const int width, const int height, ScreenTriangle &tri)
+			{
+				Eigen::Matrix<double, 3, 2> p;
+				p.row(0) = v1.position.head<2>() / v1.position[3];
+				p.row(1) = v2.position.head<2>() / v2.position[3];
+				p.row(2) = v3.position.head<2>() / v3.position[3];
 
-				int lx = std::floor(p.col(0).minCoeff());
-				int ly = std::floor(p.col(1).minCoeff());
-				int ux = std::ceil(p.col(0).maxCoeff());
-				int uy = std::ceil(p.col(1).maxCoeff());
+				p.col(0) = ((p.col(0).array() + 1.0) / 2.0) * width;
+				p.col(1) = ((p.col(1).array() + 1.0) / 2.0) * height;
 
-				lx = std::min(std::max(lx, int(0)), int(frameBuffer.rows() - 1));
-				ly = std::min(std::max(ly, int(0)), int(frameBuffer.cols() - 1));
-				ux = std::max(std::min(ux, int(frameBuffer.rows() - 1)), int(0));
-				uy = std::max(std::min(uy, int(frameBuffer.cols() - 1)), int(0));
+				const double area = (p(1, 0) - p(0, 0)) * (p(2, 1) - p(0, 1)) - (p(1, 1) - p(0, 1)) * (p(2, 0) - p(0, 0));
+				if (area == 0 || !std::isfinite(area))
+					return false;
 
-				Eigen::Matrix3d A;
-				A.col(0) = p.row(0).segment(0, 3);
-				A.col(1) = p.row(1).segment(0, 3);
-				A.col(2) = p.row(2).segment(0, 3);
-				A.row(2) << 1.0, 1.0, 1.0;
+				if (p.col(0).maxCoeff() < 0 || p.col(0).minCoeff() > width || p.col(1).maxCoeff() < 0 || p.col(1).minCoeff() > height)
+					return false;
 
-				Eigen::Matrix3d Ai = A.inverse();
+				tri.lx = std::max(int(std::floor(p.col(0).minCoeff())), 0);
+				tri.ly = std::max(int(std::floor(p.col(1).minCoeff())), 0);
+				tri.ux = std::min(int(std::ceil(p.col(0).maxCoeff())), width - 1);
+				tri.uy = std::min(int(std::ceil(p.col(1).maxCoeff())), height - 1);
 
-				for (unsigned i = lx; i <= ux; i++)
+				for (int k = 0; k < 3; ++k)
 				{
-					for (unsigned j = ly; j <= uy; j++)
-					{
+					const int i = (k + 1) % 3;
+					const int j = (k + 2) % 3;
+					tri.a[k] = -(p(j, 1) - p(i, 1)) / area;
+					tri.b[k] = (p(j, 0) - p(i, 0)) / area;
+					tri.c[k] = ((p(j, 1) - p(i, 1)) * p(i, 0) - (p(j, 0) - p(i, 0)) * p(i, 1)) / area;
+				}
+
+				return true;
+			}
+
+			/// rasterizes the part of a triangle inside the tile [tx0, tx1) x [ty0, ty1), 4 pixels of a row at a time
+			void rasterize_triangle(const Program &program, const UniformAttributes &uniform, const VertexAttributes &v1, const VertexAttributes &v2, const VertexAttributes &v3, const ScreenTriangle &tri, const int tx0, const int ty0, const int tx1, const int ty1, Eigen::Matrix<FrameBufferAttributes, Eigen::Dynamic, Eigen::Dynamic> &frameBuffer)
+			{
+				const int lx = std::max(tri.lx, tx0);
+				const int ux = std::min(tri.ux, tx1 - 1);
+				const int ly = std::max(tri.ly, ty0);
+				const int uy = std::min(tri.uy, ty1 - 1);
 
-						Eigen::Vector3d pixel(i + 0.5, j + 0.5, 1);
-						Eigen::Vector3d b = Ai * pixel;
-						if (b.minCoeff() >= 0)
+				const Eigen::Array4d lanes(0.5, 1.5, 2.5, 3.5);
+
+				for (int j = ly; j <= uy; j++)
+				{
+					const double y = j + 0.5;
+					for (int i = lx; i <= ux; i += 4)
+					{
+						const Eigen::Array4d x = lanes + i;
+						const Eigen::Array4d b0 = tri.a[0] * x + (tri.b[0] * y + tri.c[0]);
+						const Eigen::Array4d b1 = tri.a[1] * x + (tri.b[1] * y + tri.c[1]);
+						const Eigen::Array4d b2 = tri.a[2] * x + (tri.b[2] * y + tri.c[2]);
+						const auto inside = b0.min(b1).min(b2) >= 0;
+						if (!inside.any())
+							continue;
+
+						for (int l = 0; l < 4 && i + l <= ux; ++l)
 						{
-							VertexAttributes va = VertexAttributes::interpolate(v1, v2, v3, b[0], b[1], b[2]);
+							if (!inside[l])
+								continue;
+
+							VertexAttributes va = VertexAttributes::interpolate(v1, v2, v3, b0[l], b1[l], b2[l]);
 
 							if (va.position[2] >= -1 && va.position[2] <= 1)
 							{
 								FragmentAttributes frag = program.FragmentShader(va, uniform);
-								frameBuffer(i, j) = program.BlendingShader(frag, frameBuffer(i, j));
+								frameBuffer(i + l, j) = program.BlendingShader(frag, frameBuffer(i + l, j));
 							}
 						}
 					}
@@ -60,12 +102,49 @@ namespace polyfem
 
 			void rasterize_triangles(const Program &program, const UniformAttributes &uniform, const std::vector<VertexAttributes> &vertices, Eigen::Matrix<FrameBufferAttributes, Eigen::Dynamic, Eigen::Dynamic> &frameBuffer)
 			{
+				const int width = frameBuffer.rows();
+				const int height = frameBuffer.cols();
+				const int n_triangles = vertices.size() / 3;
+
 				std::vector<VertexAttributes> v(vertices.size());
-				for (unsigned i = 0; i < vertices.size(); i++)
-					v[i] = program.VertexShader(vertices[i], uniform);
+				utils::maybe_parallel_for(vertices.size(), [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; i++)
+						v[i] = program.VertexShader(vertices[i], uniform);
+				});
+
+				std::vector<ScreenTriangle> triangles(n_triangles);
+				std::vector<char> visible(n_triangles);
+				utils::maybe_parallel_for(n_triangles, [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; i++)
+						visible[i] = setup_triangle(v[i * 3 + 0], v[i * 3 + 1], v[i * 3 + 2], width, height, triangles[i]);
+				});
+
+				// every tile keeps its triangles in submission order, the blending is the same as a sequential rasterization
+				const int n_tiles_x = (width + tile_size - 1) / tile_size;
+				const int n_tiles_y = (height + tile_size - 1) / tile_size;
+				std::vector<std::vector<int>> bins(n_tiles_x * n_tiles_y);
+				for (int i = 0; i < n_triangles; i++)
+				{
+					if (!visible[i])
+						continue;
+					const ScreenTriangle &tri = triangles[i];
+					for (int ty = tri.ly / tile_size; ty <= tri.uy / tile_size; ++ty)
+						for (int tx = tri.lx / tile_size; tx <= tri.ux / tile_size; ++tx)
+							bins[ty * n_tiles_x + tx].push_back(i);
+				}
+
+				utils::maybe_parallel_for(bins.size(), [&](int start, int end, int thread_id) {
+					for (int t = start; t < end; t++)
+					{
+						const int tx0 = (t % n_tiles_x) * tile_size;
+						const int ty0 = (t / n_tiles_x) * tile_size;
+						const int tx1 = std::min(tx0 + tile_size, width);
+						const int ty1 = std::min(ty0 + tile_size, height);
 
-				for (unsigned i = 0; i < vertices.size() / 3; i++)
-					rasterize_triangle(program, uniform, v[i * 3 + 0], v[i * 3 + 1], v[i * 3 + 2], frameBuffer);
+						for (const int i : bins[t])
+							rasterize_triangle(program, uniform, v[i * 3 + 0], v[i * 3 + 1], v[i * 3 + 2], triangles[i], tx0, ty0, tx1, ty1, frameBuffer);
+					}
+				});
 			}
 
 			void rasterize_line(const Program &program, const UniformAttributes &uniform, const VertexAttributes &v1, const VertexAttributes &v2, double line_thickness, Eigen::Matrix<FrameBufferAttributes, Eigen::Dynamic, Eigen::Dynamic> &frameBuffer)
@@ -156,7 +235,8 @@ namespace polyfem
 									int width, int height,
 									const Eigen::Vector3d &camera_position, const double camera_fov, const double camera_near, const double camera_far, const bool is_perspective, const Eigen::Vector3d &lookat, const Eigen::Vector3d &up,
 									const Eigen::Vector3d &ambient_light, const std::vector<std::pair<Eigen::MatrixXd, Eigen::MatrixXd>> &lights,
-									std::vector<Material> &materials)
+									std::vector<Material> &materials,
+									const Eigen::MatrixXd &vertex_colors)
 		{
 			using namespace renderer;
 			using namespace Eigen;
@@ -245,7 +325,8 @@ namespace polyfem
 			program.BlendingShader = [](const FragmentAttributes &fa, const FrameBufferAttributes &previous) {
 				if (fa.depth < previous.depth)
 				{
-					FrameBufferAttributes out(fa.color[0] * 255, fa.color[1] * 255, fa.color[2] * 255, fa.color[3] * 255);
+					const Eigen::Vector4d color = fa.color.cwiseMax(0).cwiseMin(1) * 255;
+					FrameBufferAttributes out(color[0], color[1], color[2], color[3]);
 					out.depth = fa.depth;
 					return out;
 				}
@@ -268,6 +349,8 @@ namespace polyfem
 					int vid = faces(i, j);
 					VertexAttributes va(vertices(vid, 0), vertices(vid, 1), vertices(vid, 2));
 					va.material = mat;
+					if (vertex_colors.size() > 0)
+						va.material.diffuse_color = vertex_colors.row(vid).transpose();
 					va.normal = vnormals.row(vid).normalized();
 					vertex_attributes.push_back(va);
 				}
@@ -280,5 +363,89 @@ namespace polyfem
 
 			return image;
 		}
+
+		bool write_png(const std::string &path, const std::vector<uint8_t> &image, const int width, const int height)
+		{
+			assert(image.size() == size_t(width) * height * 4);
+
+			static const std::array<uint32_t, 256> crc_table = []() {
+				std::array<uint32_t, 256> table;
+				for (uint32_t n = 0; n < 256; ++n)
+				{
+					uint32_t c = n;
+					for (int k = 0; k < 8; ++k)
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					table[n] = c;
+				}
+				return table;
+			}();
+
+			std::ofstream out(path, std::ios::out | std::ios::binary);
+			if (!out.good())
+			{
+				logger().error("Failed to write to file: {}", path);
+				return false;
+			}
+
+			const auto append_u32 = [](std::vector<uint8_t> &data, const uint32_t v) {
+				for (int shift = 24; shift >= 0; shift -= 8)
+					data.push_back((v >> shift) & 0xFF);
+			};
+			const auto write_chunk = [&](const char *type, const std::vector<uint8_t> &data) {
+				std::vector<uint8_t> chunk;
+				append_u32(chunk, data.size());
+				chunk.insert(chunk.end(), type, type + 4);
+				chunk.insert(chunk.end(), data.begin(), data.end());
+				uint32_t crc = 0xFFFFFFFFu;
+				for (size_t i = 4; i < chunk.size(); ++i)
+					crc = crc_table[(crc ^ chunk[i]) & 0xFF] ^ (crc >> 8);
+				append_u32(chunk, crc ^ 0xFFFFFFFFu);
+				out.write((const char *)chunk.data(), chunk.size());
+			};
+
+			// every row starts with its filter type (none)
+			std::vector<uint8_t> raw;
+			raw.reserve(size_t(height) * (width * 4 + 1));
+			for (int j = 0; j < height; ++j)
+			{
+				raw.push_back(0);
+				raw.insert(raw.end(), image.begin() + size_t(j) * width * 4, image.begin() + size_t(j + 1) * width * 4);
+			}
+
+			// zlib stream made of stored (uncompressed) deflate blocks
+			std::vector<uint8_t> zlib = {0x78, 0x01};
+			for (size_t start = 0; start < raw.size(); start += 65535)
+			{
+				const uint16_t len = std::min<size_t>(65535, raw.size() - start);
+				const uint16_t nlen = ~len;
+				zlib.push_back(start + len >= raw.size() ? 1 : 0);
+				zlib.push_back(len & 0xFF);
+				zlib.push_back(len >> 8);
+				zlib.push_back(nlen & 0xFF);
+				zlib.push_back(nlen >> 8);
+				zlib.insert(zlib.end(), raw.begin() + start, raw.begin() + start + len);
+			}
+			uint32_t s1 = 1, s2 = 0;
+			for (const uint8_t c : raw)
+			{
+				s1 = (s1 + c) % 65521;
+				s2 = (s2 + s1) % 65521;
+			}
+			append_u32(zlib, (s2 << 16) | s1);
+
+			const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+			out.write((const char *)signature, 8);
+
+			std::vector<uint8_t> header;
+			append_u32(header, width);
+			append_u32(header, height);
+			// 8 bits RGBA, deflate, adaptive filtering, no interlace
+			header.insert(header.end(), {8, 6, 0, 0, 0});
+			write_chunk("IHDR", header);
+			write_chunk("IDAT", zlib);
+			write_chunk("IEND", {});
+
+			return out.good();
+		}
 	} // namespace renderer
 } // namespace polyfem
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <Eigen/Dense>
 
 #include <functional>
+#include <string>
 #include <vector>
 
 namespace polyfem
@@ -84,10 +85,17 @@ namespace polyfem
 			std::function<FrameBufferAttributes(const FragmentAttributes &, const FrameBufferAttributes &)> BlendingShader;
 		};
 
+		/// renders a triangle mesh to a RGBA image (top row first). The frame is split in tiles rasterized
+		/// in parallel, every tile processes the triangles overlapping it in order, 4 pixels at a time.
+		/// @param[in] vertex_colors per vertex diffuse color (e.g., a color-mapped field), replaces the one of the materials if not empty
 		std::vector<uint8_t> render(const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &faces, const Eigen::MatrixXi &faces_id,
 									int width, int height,
 									const Eigen::Vector3d &camera_position, const double camera_fov, const double camera_near, const double camera_far, const bool is_perspective, const Eigen::Vector3d &lookat, const Eigen::Vector3d &up,
 									const Eigen::Vector3d &ambient_light, const std::vector<std::pair<Eigen::MatrixXd, Eigen::MatrixXd>> &lights,
-									std::vector<Material> &materials);
+									std::vector<Material> &materials,
+									const Eigen::MatrixXd &vertex_colors = Eigen::MatrixXd());
+
+		/// writes a RGBA image (top row first) to an uncompressed PNG file
+		bool write_png(const std::string &path, const std::vector<uint8_t> &image, const int width, const int height);
 	} // namespace renderer
 } // namespace polyfem
\ No newline at end of file
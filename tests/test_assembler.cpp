@@ -1,11 +1,24 @@
 #include <polyfem/State.hpp>
 
+#include <polyfem/assembler/BatchedSimplexAssembler.hpp>
 #include <polyfem/assembler/NeoHookeanElasticity.hpp>
 #include <polyfem/assembler/NeoHookeanElasticityAutodiff.hpp>
+#include <polyfem/assembler/FlatAssemblyValsCache.hpp>
+#include <polyfem/assembler/StaticCondensation.hpp>
+#include <polyfem/assembler/Stokes.hpp>
+#include <polyfem/assembler/NavierStokes.hpp>
+#include <polyfem/basis/TensorProductHex.hpp>
+#include <polyfem/refinement/ErrorIndicator.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseLU>
+
+#include <filesystem>
 #include <iostream>
 
 using namespace polyfem;
@@ -67,6 +80,10 @@ TEST_CASE("hessian_lin", "[assembler]")
 
 		disp.setRandom();
 	}
+
+	// all assemblies after the first one scatter directly in the cached values
+	REQUIRE(mat_cache.has_element_slots(state.bases.size()));
+	REQUIRE(state.ass_vals_cache.has_element_colors(state.bases.size()));
 }
 
 TEST_CASE("hessian_hooke", "[assembler]")
@@ -223,6 +240,24 @@ TEST_CASE("generic_elastic_assembler", "[assembler]")
 			}
 		}
 
+		// hessian projected to psd at the quadrature points
+		{
+			NonLinearAssemblerData data(vals, 0, 0, displacement, displacement, da);
+			data.project_to_psd = true;
+
+			const Eigen::MatrixXd hessiana = autodiff.assemble_hessian(data);
+			const Eigen::MatrixXd hessian = real.assemble_hessian(data);
+
+			if (!hessian.hasNaN())
+			{
+				for (int i = 0; i < hessiana.size(); ++i)
+					REQUIRE(hessiana(i) == Catch::Approx(hessian(i)).margin(1e-8));
+
+				const Eigen::VectorXd eigs = Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(hessian).eigenvalues();
+				REQUIRE(eigs.minCoeff() >= -1e-8 * std::max(1., eigs.cwiseAbs().maxCoeff()));
+			}
+		}
+
 		// F stress
 		{
 			Eigen::MatrixXd stressa, stress;
@@ -284,3 +319,612 @@ TEST_CASE("generic_elastic_assembler", "[assembler]")
 		}
 	}
 }
+
+TEST_CASE("flat_assembly_vals_cache", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	in_args["space"]["discr_order"] = 2;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	FlatAssemblyValsCache flat;
+	flat.init(state.mesh->is_volume(), state.bases, state.geom_bases());
+	REQUIRE(flat.n_elements() == state.bases.size());
+	REQUIRE(flat.n_groups() >= 1);
+
+	for (int e = 0; e < state.bases.size(); ++e)
+	{
+		ElementAssemblyValues tmp;
+		const ElementAssemblyValues &vals = state.ass_vals_cache.get(e, state.mesh->is_volume(), state.bases[e], state.geom_bases()[e], tmp);
+		const FlatElementValues fvals = flat.element(e);
+
+		REQUIRE(fvals.n_bases == vals.basis_values.size());
+		REQUIRE(fvals.n_quad == vals.quadrature.weights.size());
+
+		const Eigen::VectorXd da = vals.det.array() * vals.quadrature.weights.array();
+		REQUIRE((fvals.da() - da).norm() == Catch::Approx(0).margin(1e-14));
+		REQUIRE((fvals.points() - vals.val).norm() == Catch::Approx(0).margin(1e-14));
+
+		for (int i = 0; i < fvals.n_bases; ++i)
+		{
+			REQUIRE((fvals.val(i) - vals.basis_values[i].val).norm() == Catch::Approx(0).margin(1e-14));
+			REQUIRE((fvals.grad_t_m(i) - vals.basis_values[i].grad_t_m).norm() == Catch::Approx(0).margin(1e-14));
+		}
+
+		for (int q = 0; q < fvals.n_quad; ++q)
+			REQUIRE((fvals.jac_it(q) - vals.jac_it[q]).norm() == Catch::Approx(0).margin(1e-14));
+	}
+}
+
+TEST_CASE("affine_element_values", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	in_args["space"]["discr_order"] = 2;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	// P2 bases on the linear triangles of the geometry
+	REQUIRE(!state.bases[0].is_affine);
+	REQUIRE(state.geom_bases()[0].is_affine);
+
+	for (int e = 0; e < state.bases.size(); ++e)
+	{
+		ElementBases general = state.geom_bases()[e];
+		general.is_affine = false;
+
+		ElementAssemblyValues affine_vals, vals;
+		affine_vals.compute(e, state.mesh->is_volume(), state.bases[e], state.geom_bases()[e]);
+		vals.compute(e, state.mesh->is_volume(), state.bases[e], general);
+
+		REQUIRE((affine_vals.det - vals.det).norm() == Catch::Approx(0).margin(1e-12));
+		for (int q = 0; q < vals.jac_it.size(); ++q)
+			REQUIRE((affine_vals.jac_it[q] - vals.jac_it[q]).norm() == Catch::Approx(0).margin(1e-10));
+		for (int i = 0; i < vals.basis_values.size(); ++i)
+			REQUIRE((affine_vals.basis_values[i].grad_t_m - vals.basis_values[i].grad_t_m).norm() == Catch::Approx(0).margin(1e-10));
+	}
+}
+
+TEST_CASE("sum_factorized_hessian_product", "[assembler]")
+{
+	const auto [basis_type, order] = GENERATE(table<std::string, int>({{"Lagrange", 1}, {"Lagrange", 2}, {"Lagrange", 3}, {"Spline", 2}}));
+	const std::string material = GENERATE(std::string("LinearElasticity"), std::string("NeoHookean"));
+
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/hex.HYBRID";
+	in_args["geometry"]["n_refs"] = 1;
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = material;
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	in_args["space"]["discr_order"] = order;
+	in_args["space"]["basis_type"] = basis_type;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	REQUIRE(state.assembler->stiffness_is_energy_hessian());
+	for (const ElementBases &b : state.bases)
+		REQUIRE(TensorProductHex::is_tensor_product(b));
+
+	const int ndof = state.n_bases * 3;
+	const Eigen::MatrixXd disp = 1e-2 * Eigen::MatrixXd::Random(ndof, 1);
+	const Eigen::MatrixXd v = Eigen::MatrixXd::Random(ndof, 1);
+
+	SparseMatrixCache mat_cache;
+	StiffnessMatrix hessian;
+	state.assembler->assemble_hessian(true, state.n_bases, false, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
+
+	// without psd projection the product is sum-factorized and never builds the element hessians
+	Eigen::MatrixXd product;
+	state.assembler->apply_hessian(true, state.n_bases, false, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, disp, Eigen::MatrixXd(), v, product);
+
+	const Eigen::VectorXd expected = hessian * v;
+	REQUIRE((product - expected).norm() == Catch::Approx(0).margin(1e-8 * expected.norm()));
+}
+
+TEST_CASE("assembly_vals_cache_policy", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const bool is_volume = state.mesh->is_volume();
+	const int n_elements = state.bases.size();
+
+	const auto check_values = [&](const AssemblyValsCache &cache) {
+		for (int e = 0; e < n_elements; ++e)
+		{
+			ElementAssemblyValues expected, tmp;
+			expected.compute(e, is_volume, state.bases[e], state.geom_bases()[e]);
+			const ElementAssemblyValues &vals = cache.get(e, is_volume, state.bases[e], state.geom_bases()[e], tmp);
+			REQUIRE((vals.det - expected.det).norm() == 0);
+			REQUIRE((vals.val - expected.val).norm() == 0);
+		}
+	};
+
+	AssemblyValsCache cache;
+
+	// P1 triangles have 3 bases
+	cache.set_policy(AssemblyValsCache::Policy::All, 4);
+	cache.init(is_volume, state.bases, state.geom_bases());
+	CHECK(cache.n_cached_elements() == 0);
+	CHECK(!cache.is_cached(0));
+	check_values(cache);
+
+	cache.set_policy(AssemblyValsCache::Policy::All, 3);
+	cache.init(is_volume, state.bases, state.geom_bases());
+	CHECK(cache.n_cached_elements() == n_elements);
+	check_values(cache);
+
+	// the timing decides, every element of a type gets the same decision
+	cache.set_policy(AssemblyValsCache::Policy::Auto);
+	cache.init(is_volume, state.bases, state.geom_bases());
+	CHECK((cache.n_cached_elements() == 0 || cache.n_cached_elements() == n_elements));
+	check_values(cache);
+}
+
+TEST_CASE("flat_assembly_vals_cache_streaming", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	in_args["space"]["discr_order"] = 2;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	FlatAssemblyValsCache flat;
+	flat.init(state.mesh->is_volume(), state.bases, state.geom_bases());
+
+	const std::string backing_file = (std::filesystem::current_path() / "DELETE_ME_flat_vals.bin").string();
+	FlatAssemblyValsCache streamed;
+	// a few elements per block
+	streamed.set_streaming(backing_file, 32 * 1024);
+	streamed.init(state.mesh->is_volume(), state.bases, state.geom_bases());
+#ifndef _WIN32
+	REQUIRE(streamed.is_streamed());
+	REQUIRE(std::filesystem::exists(backing_file));
+	REQUIRE(streamed.element_blocks().size() > 1);
+#endif
+	REQUIRE(streamed.memory_size() == flat.memory_size());
+
+	// the blocks cover all the elements in order
+	int next = 0;
+	streamed.for_each_block([&](int start, int end) {
+		REQUIRE(start == next);
+		next = end;
+
+		for (int e = start; e < end; ++e)
+		{
+			const FlatElementValues a = streamed.element(e);
+			const FlatElementValues b = flat.element(e);
+			REQUIRE(a.n_bases == b.n_bases);
+			REQUIRE((a.da() - b.da()).norm() == 0);
+			REQUIRE((a.points() - b.points()).norm() == 0);
+			for (int i = 0; i < a.n_bases; ++i)
+				REQUIRE((a.grad_t_m(i) - b.grad_t_m(i)).norm() == 0);
+		}
+	});
+	REQUIRE(next == state.bases.size());
+
+	streamed.clear();
+	REQUIRE(!std::filesystem::exists(backing_file));
+}
+
+TEST_CASE("batched_simplex_assembler", "[assembler]")
+{
+	const int dim = GENERATE(2, 3);
+	const simplex_kernels::Model model = GENERATE(simplex_kernels::Model::LinearElasticity, simplex_kernels::Model::NeoHookean, simplex_kernels::Model::SaintVenant);
+
+	Eigen::MatrixXd vertices;
+	Eigen::MatrixXi elements;
+	if (dim == 2)
+	{
+		vertices.resize(5, 2);
+		vertices << 0, 0, 1, 0, 1, 1, 0, 1, 0.5, 0.4;
+		elements.resize(4, 3);
+		elements << 0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4;
+	}
+	else
+	{
+		vertices.resize(5, 3);
+		vertices << 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1;
+		elements.resize(2, 4);
+		elements << 0, 1, 2, 3, 1, 2, 3, 4;
+	}
+	const Eigen::VectorXd mu = Eigen::VectorXd::Constant(elements.rows(), 2.0);
+	const Eigen::VectorXd lambda = Eigen::VectorXd::LinSpaced(elements.rows(), 1.0, 3.0);
+
+	BatchedSimplexAssembler assembler;
+	assembler.init(model, vertices, elements, mu, lambda);
+	REQUIRE(assembler.ndof() == vertices.size());
+
+	const Eigen::VectorXd u = 0.05 * Eigen::VectorXd::Random(assembler.ndof());
+	Eigen::VectorXd grad;
+	assembler.assemble_gradient(u, grad);
+	StiffnessMatrix hessian;
+	assembler.assemble_hessian(u, hessian);
+
+	// central differences of the energy and of the gradient
+	const double h = 1e-6;
+	Eigen::VectorXd fd_grad(u.size());
+	Eigen::MatrixXd fd_hessian(u.size(), u.size());
+	for (int i = 0; i < u.size(); ++i)
+	{
+		Eigen::VectorXd up = u, um = u;
+		up[i] += h;
+		um[i] -= h;
+		fd_grad[i] = (assembler.assemble_energy(up) - assembler.assemble_energy(um)) / (2 * h);
+
+		Eigen::VectorXd gp, gm;
+		assembler.assemble_gradient(up, gp);
+		assembler.assemble_gradient(um, gm);
+		fd_hessian.col(i) = (gp - gm) / (2 * h);
+	}
+
+	CHECK((grad - fd_grad).norm() <= 1e-6 * std::max(1.0, grad.norm()));
+	CHECK((Eigen::MatrixXd(hessian) - fd_hessian).norm() <= 1e-6 * std::max(1.0, fd_hessian.norm()));
+
+	// the pattern is reused by the next assembly
+	const int nnz = hessian.nonZeros();
+	assembler.assemble_hessian(Eigen::VectorXd::Zero(u.size()), hessian);
+	CHECK(hessian.nonZeros() == nnz);
+	CHECK(assembler.assemble_energy(Eigen::VectorXd::Zero(u.size())) == Catch::Approx(0).margin(1e-12));
+}
+
+TEST_CASE("static_condensation", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"]["discr_order"] = 3;
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	StiffnessMatrix A;
+	state.build_stiffness_mat(A);
+	// regularize the pure Neumann system
+	A += sparse_identity(A.rows(), A.cols());
+	const Eigen::VectorXd b = Eigen::VectorXd::Random(A.rows());
+
+	StaticCondensation condensation(state.bases, state.n_bases, 2, {});
+	// P3 triangles have one bubble node each
+	REQUIRE(condensation.skeleton_size() == A.rows() - 2 * int(state.bases.size()));
+
+	StiffnessMatrix S;
+	Eigen::VectorXd bs;
+	condensation.condense(A, b, S, bs);
+
+	Eigen::SimplicialLDLT<StiffnessMatrix> solver(S);
+	Eigen::VectorXd x;
+	condensation.expand(solver.solve(bs), x);
+
+	CHECK((A * x - b).norm() < 1e-8 * b.norm());
+}
+
+TEST_CASE("static_condensation_mixed", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"]["discr_order"] = 3;
+	in_args["space"]["pressure_discr_order"] = 3;
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "IncompressibleLinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.49;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	StiffnessMatrix A;
+	state.build_stiffness_mat(A);
+	REQUIRE(A.rows() == 2 * state.n_bases + state.n_pressure_bases);
+	// regularize the pure Neumann system
+	A += sparse_identity(A.rows(), A.cols());
+	const Eigen::VectorXd b = Eigen::VectorXd::Random(A.rows());
+
+	StaticCondensation condensation(state.bases, state.n_bases, 2, state.pressure_bases, state.n_pressure_bases, A.rows(), {});
+	// P3 triangles have one bubble node each, for the displacement and for the pressure
+	REQUIRE(condensation.skeleton_size() == A.rows() - 3 * int(state.bases.size()));
+
+	StiffnessMatrix S;
+	Eigen::VectorXd bs;
+	condensation.condense(A, b, S, bs);
+
+	Eigen::SparseLU<StiffnessMatrix> solver(S);
+	Eigen::VectorXd x;
+	condensation.expand(solver.solve(bs), x);
+
+	CHECK((A * x - b).norm() < 1e-8 * b.norm());
+}
+
+TEST_CASE("mixed_assembly", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"]["discr_order"] = 2;
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "Stokes";
+	in_args["materials"]["viscosity"] = 1;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	// per (i, j) pair kernel of the base class
+	class PairwiseStokesMixed : public StokesMixed
+	{
+	protected:
+		void assemble_local(
+			const ElementAssemblyValues &psi_vals,
+			const ElementAssemblyValues &phi_vals,
+			const double t,
+			const QuadratureVector &da,
+			Eigen::MatrixXd &local) const override
+		{
+			MixedAssembler::assemble_local(psi_vals, phi_vals, t, da, local);
+		}
+	};
+
+	StokesMixed batched;
+	batched.set_size(2);
+	PairwiseStokesMixed pairwise;
+	pairwise.set_size(2);
+
+	// coloured caches use the direct scatter, empty caches the triplets
+	AssemblyValsCache psi_cache, phi_cache;
+	psi_cache.init_element_colors(state.pressure_bases, state.geom_bases());
+	phi_cache.init_element_colors(state.bases, state.geom_bases());
+	const AssemblyValsCache no_cache;
+
+	const auto assemble = [&](const MixedAssembler &mixed, const AssemblyValsCache &psi, const AssemblyValsCache &phi, StiffnessMatrix &mat) {
+		mixed.assemble(false, state.n_pressure_bases, state.n_bases, state.pressure_bases, state.bases, state.geom_bases(), psi, phi, 0, mat);
+	};
+
+	StiffnessMatrix direct, triplets;
+	assemble(batched, psi_cache, phi_cache, direct);
+	assemble(pairwise, no_cache, no_cache, triplets);
+
+	REQUIRE(direct.rows() == 2 * state.n_bases);
+	REQUIRE(direct.cols() == state.n_pressure_bases);
+	REQUIRE(triplets.rows() == direct.rows());
+	REQUIRE(triplets.cols() == direct.cols());
+	CHECK(StiffnessMatrix(direct - triplets).norm() < 1e-12 * triplets.norm());
+}
+
+TEST_CASE("navier_stokes_convection", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"]["discr_order"] = 2;
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NavierStokes";
+	in_args["materials"]["viscosity"] = 1;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	auto &navier_stokes = dynamic_cast<NavierStokesVelocity &>(*state.assembler);
+
+	const Eigen::MatrixXd x = Eigen::MatrixXd::Random(state.n_bases * 2, 1);
+
+	SparseMatrixCache mat_cache;
+	StiffnessMatrix picard;
+	navier_stokes.set_picard(true);
+	navier_stokes.assemble_hessian(false, state.n_bases, false, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, x, Eigen::MatrixXd(), mat_cache, picard);
+
+	// the convective term used by the lagged residual is the Picard matrix times the velocity
+	Eigen::MatrixXd convection;
+	navier_stokes.assemble_gradient(false, state.n_bases, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, x, Eigen::MatrixXd(), convection);
+
+	REQUIRE(convection.size() == x.size());
+	CHECK((convection - picard * x).norm() < 1e-10 * convection.norm());
+
+	// the Newton matrix, assembled with the velocity cached by the Picard assembly, is the derivative of the convection
+	StiffnessMatrix newton;
+	navier_stokes.set_picard(false);
+	navier_stokes.assemble_hessian(false, state.n_bases, false, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, x, Eigen::MatrixXd(), mat_cache, newton);
+
+	const Eigen::MatrixXd v = Eigen::MatrixXd::Random(x.rows(), 1);
+	const double eps = 1e-6;
+	Eigen::MatrixXd convection_plus, convection_minus;
+	navier_stokes.assemble_gradient(false, state.n_bases, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, x + eps * v, Eigen::MatrixXd(), convection_plus);
+	navier_stokes.assemble_gradient(false, state.n_bases, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, x - eps * v, Eigen::MatrixXd(), convection_minus);
+
+	const Eigen::MatrixXd fd = (convection_plus - convection_minus) / (2 * eps);
+	CHECK((fd - newton * v).norm() < 1e-6 * fd.norm());
+}
+
+TEST_CASE("zz_error_indicator", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const auto interpolate = [&](const std::function<Eigen::RowVector2d(const RowVectorNd &)> &f) {
+		Eigen::MatrixXd sol(state.n_bases * 2, 1);
+		for (const ElementBases &bs : state.bases)
+			for (const Basis &b : bs.bases)
+				for (const Local2Global &g : b.global())
+					sol.middleRows<2>(2 * g.index) = f(g.node).transpose();
+		return sol;
+	};
+
+	Eigen::VectorXd indicators;
+
+	// the gradient of a linear field is recovered exactly
+	const Eigen::MatrixXd linear = interpolate([](const RowVectorNd &p) { return Eigen::RowVector2d(p(0) + 2 * p(1), 3 * p(0) - p(1)); });
+	refinement::ErrorIndicator::zz(*state.mesh, 2, state.bases, state.geom_bases(), state.ass_vals_cache, linear, indicators);
+	REQUIRE(indicators.size() == state.bases.size());
+	CHECK(indicators.maxCoeff() < 1e-10);
+
+	const Eigen::MatrixXd quadratic = interpolate([](const RowVectorNd &p) { return Eigen::RowVector2d(p(0) * p(0), p(0) * p(1)); });
+	refinement::ErrorIndicator::zz(*state.mesh, 2, state.bases, state.geom_bases(), state.ass_vals_cache, quadratic, indicators);
+	CHECK(indicators.maxCoeff() > 0);
+
+	const std::vector<int> marked = refinement::ErrorIndicator::mark(indicators, 0.5);
+	REQUIRE(!marked.empty());
+	double marked_error = 0;
+	for (const int e : marked)
+		marked_error += indicators(e) * indicators(e);
+	CHECK(marked_error >= 0.5 * indicators.squaredNorm());
+	CHECK(marked.size() < indicators.size());
+}
+
+TEST_CASE("adaptive_p_refinement", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	in_args["space"]["adaptive_p_ref"]["theta"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+	state.assemble_rhs();
+	state.assemble_mass_mat();
+
+	Eigen::MatrixXd sol, pressure;
+	state.solve_problem(sol, pressure);
+
+	const int n_bases = state.n_bases;
+	const int n_changed = state.p_refine(sol);
+	REQUIRE(n_changed > 0);
+	CHECK(n_changed < state.mesh->n_elements());
+	CHECK(state.n_bases > n_bases);
+	CHECK(state.disc_orders.maxCoeff() == 2);
+	CHECK(state.disc_orders.minCoeff() == 1);
+
+	state.assemble_rhs();
+	state.assemble_mass_mat();
+	sol.resize(0, 0);
+	state.solve_problem(sol, pressure);
+	CHECK(sol.rows() == state.n_bases * 2);
+}
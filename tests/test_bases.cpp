@@ -7,7 +7,11 @@
 #include <polyfem/quadrature/HexQuadrature.hpp>
 
 #include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/basis/Prolongation.hpp>
+#include <polyfem/basis/ReferenceBasis.hpp>
+#include <polyfem/State.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
+#include <polyfem/autogen/auto_p_bases_batched.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <polyfem/basis/barycentric/MVPolygonalBasis2d.hpp>
@@ -835,6 +839,109 @@ TEST_CASE("Pk_3d", "[bases]")
 	}
 }
 
+TEST_CASE("reference_basis_3d", "[bases]")
+{
+	Eigen::MatrixXd pts;
+	polyfem::autogen::p_nodes_3d(3, pts);
+
+	Basis b;
+	REQUIRE(!b.is_defined());
+	b.set_reference(&polyfem::autogen::p_basis_value_3d, &polyfem::autogen::p_grad_basis_value_3d, 3, 5);
+	REQUIRE(b.is_defined());
+
+	Eigen::MatrixXd val, expected;
+	b.eval_basis(pts, val);
+	polyfem::autogen::p_basis_value_3d(3, 5, pts, expected);
+	REQUIRE((val - expected).norm() == Catch::Approx(0).margin(1e-14));
+
+	b.eval_grad(pts, val);
+	polyfem::autogen::p_grad_basis_value_3d(3, 5, pts, expected);
+	REQUIRE((val - expected).norm() == Catch::Approx(0).margin(1e-14));
+
+	// closures replace the reference basis
+	b.set_basis([](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { val.setOnes(uv.rows(), 1); });
+	b.eval_basis(pts, val);
+	REQUIRE(val.minCoeff() == 1);
+}
+
+TEST_CASE("reference_basis_tables", "[bases]")
+{
+	const auto reference = ReferenceBasis::get(ReferenceBasis::ElementType::TET, 2);
+	REQUIRE(reference == ReferenceBasis::get(ReferenceBasis::ElementType::TET, 2));
+	REQUIRE(reference->n_bases() == 10);
+
+	Quadrature quad;
+	TetQuadrature().get_quadrature(4, quad);
+
+	// the first evaluation is direct, the next ones use the table
+	for (int k = 0; k < 3; ++k)
+	{
+		std::vector<AssemblyValues> vals;
+		reference->evaluate_bases(quad.points, vals);
+		reference->evaluate_grads(quad.points, vals);
+		REQUIRE(vals.size() == 10);
+
+		Eigen::MatrixXd expected;
+		for (int i = 0; i < 10; ++i)
+		{
+			polyfem::autogen::p_basis_value_3d(2, i, quad.points, expected);
+			REQUIRE((vals[i].val - expected).norm() == Catch::Approx(0).margin(1e-14));
+			polyfem::autogen::p_grad_basis_value_3d(2, i, quad.points, expected);
+			REQUIRE((vals[i].grad - expected).norm() == Catch::Approx(0).margin(1e-14));
+		}
+	}
+}
+
+TEST_CASE("batched_bases", "[bases]")
+{
+	typedef void (*Fun)(const int, const int, const Eigen::MatrixXd &, Eigen::MatrixXd &);
+	typedef void (*BatchedFun)(const int, const Eigen::MatrixXd &, Eigen::MatrixXd &);
+
+	const auto check = [](Fun basis, Fun grad, BatchedFun basis_values, BatchedFun grad_values, const int order, const int n_bases, const Eigen::MatrixXd &pts) {
+		const int dim = pts.cols();
+		Eigen::MatrixXd val, grads, expected;
+		basis_values(order, pts, val);
+		grad_values(order, pts, grads);
+		REQUIRE(val.rows() == pts.rows());
+		REQUIRE(val.cols() == n_bases);
+		REQUIRE(grads.rows() == pts.rows());
+		REQUIRE(grads.cols() == dim * n_bases);
+
+		for (int i = 0; i < n_bases; ++i)
+		{
+			basis(order, i, pts, expected);
+			REQUIRE((val.col(i) - expected).norm() == Catch::Approx(0).margin(1e-14));
+			grad(order, i, pts, expected);
+			REQUIRE((grads.middleCols(dim * i, dim) - expected).norm() == Catch::Approx(0).margin(1e-14));
+		}
+	};
+
+	Quadrature quad;
+	Eigen::MatrixXd nodes;
+	// order 5 goes through the generic p_n bases
+	for (int p = 0; p <= 5; ++p)
+	{
+		TriQuadrature().get_quadrature(4, quad);
+		polyfem::autogen::p_nodes_2d(p, nodes);
+		check(&polyfem::autogen::p_basis_value_2d, &polyfem::autogen::p_grad_basis_value_2d, &polyfem::autogen::p_basis_values_2d, &polyfem::autogen::p_grad_basis_values_2d, p, nodes.rows(), quad.points);
+
+		TetQuadrature().get_quadrature(4, quad);
+		polyfem::autogen::p_nodes_3d(p, nodes);
+		check(&polyfem::autogen::p_basis_value_3d, &polyfem::autogen::p_grad_basis_value_3d, &polyfem::autogen::p_basis_values_3d, &polyfem::autogen::p_grad_basis_values_3d, p, nodes.rows(), quad.points);
+	}
+
+	for (const int q : {0, 1, 2, 3, -2})
+	{
+		QuadQuadrature().get_quadrature(4, quad);
+		polyfem::autogen::q_nodes_2d(q, nodes);
+		check(&polyfem::autogen::q_basis_value_2d, &polyfem::autogen::q_grad_basis_value_2d, &polyfem::autogen::q_basis_values_2d, &polyfem::autogen::q_grad_basis_values_2d, q, nodes.rows(), quad.points);
+
+		HexQuadrature().get_quadrature(4, quad);
+		polyfem::autogen::q_nodes_3d(q, nodes);
+		check(&polyfem::autogen::q_basis_value_3d, &polyfem::autogen::q_grad_basis_value_3d, &polyfem::autogen::q_basis_values_3d, &polyfem::autogen::q_grad_basis_values_3d, q, nodes.rows(), quad.points);
+	}
+}
+
 TEST_CASE("Q1_2d", "[bases]")
 {
 	QuadQuadrature rule;
@@ -1178,3 +1285,50 @@ TEST_CASE("WS_2d", "[bases]")
 		}
 	}
 }
+
+namespace
+{
+	std::shared_ptr<State> plane_hole_state(const int discr_order)
+	{
+		const std::string path = POLYFEM_DATA_DIR;
+		json in_args = json({});
+		in_args["geometry"] = {};
+		in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+		in_args["space"]["discr_order"] = discr_order;
+		in_args["materials"]["type"] = "LinearElasticity";
+		in_args["materials"]["E"] = 1e5;
+		in_args["materials"]["nu"] = 0.3;
+
+		auto state = std::make_shared<State>();
+		state->init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state->init(in_args, true);
+		state->load_mesh();
+		state->build_basis();
+		return state;
+	}
+
+	Eigen::VectorXd interpolate_linear(const State &state)
+	{
+		Eigen::VectorXd vals(state.n_bases);
+		for (const ElementBases &b : state.bases)
+			for (const Basis &basis : b.bases)
+				for (const Local2Global &g : basis.global())
+					vals[g.index] = 2 * g.node(0) - 3 * g.node(1) + 1;
+		return vals;
+	}
+} // namespace
+
+TEST_CASE("p_prolongation", "[bases]")
+{
+	const auto coarse = plane_hole_state(1);
+	const auto fine = plane_hole_state(2);
+
+	StiffnessMatrix P;
+	p_prolongation(fine->bases, coarse->bases, fine->n_bases, coarse->n_bases, 1, P);
+	REQUIRE(P.rows() == fine->n_bases);
+	REQUIRE(P.cols() == coarse->n_bases);
+
+	// linear functions are represented exactly in both spaces
+	const Eigen::VectorXd prolongated = P * interpolate_linear(*coarse);
+	CHECK((prolongated - interpolate_linear(*fine)).lpNorm<Eigen::Infinity>() < 1e-10);
+}
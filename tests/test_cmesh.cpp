@@ -1,10 +1,15 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/mesh/mesh2D/CMesh2D.hpp>
+#include <polyfem/mesh/mesh2D/Navigation.hpp>
+#include <polyfem/mesh/mesh2D/Refinement.hpp>
+#include <polyfem/mesh/MeshUtils.hpp>
+#include <polyfem/mesh/mesh3D/CMesh3D.hpp>
 #include <polyfem/State.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -21,3 +26,148 @@ TEST_CASE("append_2d", "[mesh_test]")
 
 	m1->append(m2);
 }
+
+TEST_CASE("mesh_snapshot", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	const std::string path = POLYFEM_DATA_DIR;
+	const auto mesh = Mesh::create(path + "/plane_hole.obj");
+	REQUIRE(mesh);
+
+	const std::string snapshot = (std::filesystem::temp_directory_path() / "mesh_snapshot.hdf5").string();
+	REQUIRE(mesh->save_snapshot(snapshot, 42));
+
+	// stale snapshot
+	REQUIRE(Mesh::load_snapshot(snapshot, 43) == nullptr);
+
+	const auto loaded = Mesh::load_snapshot(snapshot, 42);
+	REQUIRE(loaded);
+
+	REQUIRE(loaded->n_vertices() == mesh->n_vertices());
+	REQUIRE(loaded->n_elements() == mesh->n_elements());
+	REQUIRE(loaded->n_boundary_elements() == mesh->n_boundary_elements());
+	for (int v = 0; v < mesh->n_vertices(); ++v)
+		REQUIRE(loaded->point(v) == mesh->point(v));
+	for (int e = 0; e < mesh->n_elements(); ++e)
+	{
+		REQUIRE(loaded->element_vertices(e) == mesh->element_vertices(e));
+		REQUIRE(loaded->get_body_id(e) == mesh->get_body_id(e));
+	}
+	REQUIRE(loaded->in_ordered_vertices() == mesh->in_ordered_vertices());
+
+	std::filesystem::remove(snapshot);
+}
+
+TEST_CASE("parallel_2d_refinement", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	// 3x3 grid of vertices
+	Eigen::MatrixXd V(9, 3);
+	for (int i = 0; i < 9; ++i)
+		V.row(i) << i % 3, i / 3 + 0.1 * (i % 3), 0;
+	Eigen::MatrixXi Q(4, 4), T(8, 3);
+	Q << 0, 1, 4, 3, 1, 2, 5, 4, 3, 4, 7, 6, 4, 5, 8, 7;
+	T << 0, 1, 4, 0, 4, 3, 1, 2, 5, 1, 5, 4, 3, 4, 7, 3, 7, 6, 4, 5, 8, 4, 8, 7;
+
+	const auto check_same = [](const GEO::Mesh &a, const GEO::Mesh &b) {
+		REQUIRE(a.vertices.nb() == b.vertices.nb());
+		REQUIRE(a.facets.nb() == b.facets.nb());
+		for (GEO::index_t v = 0; v < a.vertices.nb(); ++v)
+		{
+			for (int d = 0; d < 3; ++d)
+				CHECK(mesh_vertex(a, v)[d] == mesh_vertex(b, v)[d]);
+		}
+		for (GEO::index_t f = 0; f < a.facets.nb(); ++f)
+		{
+			REQUIRE(a.facets.nb_vertices(f) == b.facets.nb_vertices(f));
+			for (GEO::index_t lv = 0; lv < a.facets.nb_vertices(f); ++lv)
+				CHECK(a.facets.vertex(f, lv) == b.facets.vertex(f, lv));
+		}
+	};
+
+	SECTION("triangles")
+	{
+		GEO::Mesh M, serial;
+		to_geogram_mesh(V, T, M);
+		Navigation::prepare_mesh(M);
+		refine_triangle_mesh(M, serial);
+		refine_triangle_mesh_parallel(M);
+		check_same(M, serial);
+	}
+
+	SECTION("polygons")
+	{
+		GEO::Mesh M, serial;
+		to_geogram_mesh(V, Q, M);
+		// merge the two top quads in a hexagon
+		M.facets.delete_elements(GEO::vector<GEO::index_t>{0, 0, 1, 1});
+		M.facets.create_polygon(GEO::vector<GEO::index_t>{3, 4, 5, 8, 7, 6});
+		Navigation::prepare_mesh(M);
+
+		for (const double t : {0.0, 0.5})
+		{
+			GEO::Mesh refined;
+			refined.copy(M);
+			const auto split = t > 0 ? Polygons::polar_split_func(t) : Polygons::catmul_clark_split_func();
+			refine_polygonal_mesh(refined, serial, split);
+			refine_polygonal_mesh_parallel(refined, split);
+			check_same(refined, serial);
+		}
+	}
+}
+
+TEST_CASE("mesh3d_compressed_storage", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	// two tets sharing the face 1 2 3
+	Eigen::MatrixXd V(5, 3);
+	V << 0, 0, 0,
+		1, 0, 0,
+		0, 1, 0,
+		0, 0, 1,
+		1, 1, 1;
+	Eigen::MatrixXi T(2, 4);
+	T << 0, 1, 2, 3,
+		1, 2, 3, 4;
+
+	CMesh3D mesh;
+	REQUIRE(mesh.build_from_matrices(V, T));
+	REQUIRE(mesh.n_cells() == 2);
+	REQUIRE(mesh.n_faces() == 7);
+	REQUIRE(mesh.n_edges() == 9);
+
+	REQUIRE(mesh.vertex_neighs(1).size() == 2);
+	REQUIRE(mesh.vertex_neighs(0).size() == 1);
+	for (int c = 0; c < mesh.n_cells(); ++c)
+	{
+		REQUIRE(mesh.n_cell_vertices(c) == 4);
+		REQUIRE(mesh.n_cell_faces(c) == 4);
+		REQUIRE(mesh.n_cell_edges(c) == 6);
+
+		// the navigation around every face of the element comes back to it
+		for (int lf = 0; lf < 4; ++lf)
+		{
+			const auto idx = mesh.get_index_from_element(c, lf, 0);
+			REQUIRE(mesh.switch_face(mesh.switch_face(idx)).face == idx.face);
+			const auto other = mesh.switch_element(idx);
+			if (other.element >= 0)
+			{
+				REQUIRE(other.element == 1 - c);
+				REQUIRE(mesh.switch_element(other).element == c);
+			}
+		}
+	}
+
+	// append restores the lists of both meshes before merging them
+	std::unique_ptr<Mesh> copy = mesh.copy();
+	copy->append(mesh);
+	REQUIRE(copy->n_cells() == 4);
+	REQUIRE(copy->n_vertices() == 10);
+	REQUIRE(copy->n_cell_vertices(3) == 4);
+}
@@ -1,3 +1,4 @@
+#include <polyfem/mesh/collision_proxy/CollisionHierarchy.hpp>
 #include <polyfem/mesh/collision_proxy/CollisionProxy.hpp>
 #include <polyfem/mesh/collision_proxy/UpsampleMesh.hpp>
 #include <polyfem/mesh/MeshUtils.hpp>
@@ -10,6 +11,12 @@
 #include <igl/readPLY.h>
 #include <igl/writePLY.h>
 #include <igl/boundary_facets.h>
+#include <igl/edges.h>
+#include <igl/PI.h>
+
+#include <ipc/collisions/collisions.hpp>
+
+#include <filesystem>
 
 namespace
 {
@@ -166,4 +173,126 @@ TEST_CASE("build collision proxy displacement map", "[build_collision_proxy]")
 		displacement_map_entries);
 
 	CHECK(displacement_map_entries.size() == vertices.rows() * n_nodes_per_element);
-}
\ No newline at end of file
+}
+
+TEST_CASE("collision proxy cache", "[build_collision_proxy]")
+{
+	using namespace polyfem::mesh;
+
+	const auto state = get_state();
+	const double max_edge_length = 0.1;
+
+	Eigen::MatrixXd proxy_vertices;
+	Eigen::MatrixXi proxy_faces;
+	std::vector<Eigen::Triplet<double>> displacement_map_entries;
+	build_collision_proxy(
+		state->bases, state->geom_bases(), state->total_local_boundary, state->n_bases, state->mesh->dimension(),
+		max_edge_length, proxy_vertices, proxy_faces, displacement_map_entries);
+
+	const size_t key = collision_proxy_hash(
+		state->bases, state->geom_bases(), state->total_local_boundary, state->n_bases, state->mesh->dimension(),
+		max_edge_length, CollisionProxyTessellation::REGULAR);
+	CHECK(key != collision_proxy_hash(
+			  state->bases, state->geom_bases(), state->total_local_boundary, state->n_bases, state->mesh->dimension(),
+			  2 * max_edge_length, CollisionProxyTessellation::REGULAR));
+
+	const std::string filename = "collision_proxy_cache.hdf5";
+	save_collision_proxy_cache(filename, key, proxy_vertices, proxy_faces, displacement_map_entries);
+
+	Eigen::MatrixXd cached_vertices;
+	Eigen::MatrixXi cached_faces;
+	std::vector<Eigen::Triplet<double>> cached_entries;
+	CHECK(!load_collision_proxy_cache(filename, key + 1, cached_vertices, cached_faces, cached_entries));
+	REQUIRE(load_collision_proxy_cache(filename, key, cached_vertices, cached_faces, cached_entries));
+
+	CHECK(cached_vertices == proxy_vertices);
+	CHECK(cached_faces == proxy_faces);
+	REQUIRE(cached_entries.size() == displacement_map_entries.size());
+	for (int i = 0; i < cached_entries.size(); i++)
+	{
+		CHECK(cached_entries[i].row() == displacement_map_entries[i].row());
+		CHECK(cached_entries[i].col() == displacement_map_entries[i].col());
+		CHECK(cached_entries[i].value() == displacement_map_entries[i].value());
+	}
+
+	std::filesystem::remove(filename);
+}
+
+TEST_CASE("collision proxy hierarchy", "[build_collision_proxy]")
+{
+	using namespace polyfem::mesh;
+
+	const auto state = get_state();
+
+	Eigen::MatrixXd proxy_vertices;
+	Eigen::MatrixXi proxy_faces, proxy_edges;
+	std::vector<Eigen::Triplet<double>> displacement_map_entries;
+	build_collision_proxy(
+		state->bases, state->geom_bases(), state->total_local_boundary, state->n_bases, state->mesh->dimension(),
+		/*max_edge_length=*/0.1, proxy_vertices, proxy_faces, displacement_map_entries);
+	igl::edges(proxy_faces, proxy_edges);
+
+	const ipc::CollisionMesh collision_mesh(proxy_vertices, proxy_edges, proxy_faces);
+	const CollisionHierarchy hierarchy(collision_mesh, /*cluster_size=*/32);
+	CHECK(hierarchy.n_clusters() > 1);
+
+	// squish the sphere so that its top and bottom get close
+	Eigen::MatrixXd V = proxy_vertices;
+	V.col(1) *= 0.02;
+	const double dhat = 1e-2;
+
+	ipc::Candidates candidates;
+	hierarchy.build(collision_mesh, V, dhat / 2, candidates);
+
+	ipc::Collisions expected, collisions;
+	expected.build(collision_mesh, V, dhat);
+	collisions.build(candidates, collision_mesh, V, dhat);
+	CHECK(expected.size() > 0);
+	CHECK(collisions.size() == expected.size());
+
+	// swept boxes, the step from the rest shape to the squished one
+	ipc::Candidates swept, expected_swept;
+	hierarchy.build(collision_mesh, proxy_vertices, V, 0, swept);
+	expected_swept.build(collision_mesh, proxy_vertices, V, 0);
+	CHECK(swept.compute_collision_free_stepsize(collision_mesh, proxy_vertices, V)
+		  == Catch::Approx(expected_swept.compute_collision_free_stepsize(collision_mesh, proxy_vertices, V)));
+}
+
+TEST_CASE("collision proxy hierarchy 2D", "[build_collision_proxy]")
+{
+	using namespace polyfem::mesh;
+
+	// closed polyline of a circle, only edge-vertex candidates in 2D
+	const int n = 400;
+	Eigen::MatrixXd rest(n, 2);
+	Eigen::MatrixXi edges(n, 2);
+	for (int i = 0; i < n; ++i)
+	{
+		const double theta = 2 * igl::PI * i / n;
+		rest.row(i) << std::cos(theta), std::sin(theta);
+		edges.row(i) << i, (i + 1) % n;
+	}
+
+	const ipc::CollisionMesh collision_mesh(rest, edges);
+	const CollisionHierarchy hierarchy(collision_mesh, /*cluster_size=*/16);
+	CHECK(hierarchy.n_clusters() > 1);
+
+	// squish the circle so that its top and bottom get close
+	Eigen::MatrixXd V = rest;
+	V.col(1) *= 0.01;
+	const double dhat = 1e-2;
+	const double dmin = 5e-3;
+
+	ipc::Candidates candidates;
+	hierarchy.build(collision_mesh, V, (dhat + dmin) / 2, candidates);
+	CHECK(candidates.ev_candidates.size() == candidates.size());
+
+	ipc::Collisions expected, collisions, without_dmin;
+	expected.build(collision_mesh, V, dhat, dmin);
+	collisions.build(candidates, collision_mesh, V, dhat, dmin);
+	without_dmin.build(candidates, collision_mesh, V, dhat);
+	CHECK(expected.size() > 0);
+	CHECK(collisions.size() == expected.size());
+	// the pairs between dhat and dhat + dmin are only active with dmin
+	CHECK(without_dmin.size() < expected.size());
+}
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <filesystem>
 
 #include <polyfem/State.hpp>
 #include <polyfem/solver/Optimizations.hpp>
@@ -13,6 +14,8 @@
 #include <polyfem/solver/forms/parametrization/Parametrizations.hpp>
 #include <polyfem/solver/forms/parametrization/NodeCompositeParametrizations.hpp>
 #include <polyfem/solver/AdjointNLProblem.hpp>
+#include <polyfem/solver/forms/ElasticForm.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 
 #include <catch2/catch_all.hpp>
 #include <math.h>
@@ -1293,3 +1296,360 @@ TEST_CASE("control-pressure-nodes-3d", "[.][test_adjoint]")
 
 	verify_adjoint(*nl_problem, x, velocity_discrete, 1e-8, 1e-3);
 }
+
+TEST_CASE("update-geometry", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR + std::string("/differentiable/input/");
+	json in_args;
+	load_json(path + "shape-pressure-nodes-2d.json", in_args);
+
+	auto state_ptr = create_state_and_solve(in_args);
+	auto ref_state_ptr = create_state_and_solve(in_args);
+	State &state = *state_ptr;
+	State &ref_state = *ref_state_ptr;
+	REQUIRE(state.can_update_geometry());
+
+	Eigen::MatrixXd V;
+	state.get_vertices(V);
+	for (int v = 0; v < V.rows(); ++v)
+	{
+		const RowVectorNd p = V.row(v) + 0.01 * Eigen::RowVectorXd::Constant(V.cols(), std::sin(3. * v));
+		state.set_mesh_vertex(v, p.transpose());
+		ref_state.set_mesh_vertex(v, p.transpose());
+	}
+
+	state.update_geometry();
+	ref_state.build_basis();
+
+	REQUIRE(state.n_bases == ref_state.n_bases);
+	for (int n = 0; n < state.dirichlet_nodes_position.size(); ++n)
+		CHECK((state.dirichlet_nodes_position[n] - ref_state.dirichlet_nodes_position[n]).norm() < 1e-12);
+
+	Eigen::MatrixXd sol, ref_sol, pressure;
+	state.assemble_rhs();
+	state.assemble_mass_mat();
+	state.solve_problem(sol, pressure);
+	ref_state.assemble_rhs();
+	ref_state.assemble_mass_mat();
+	ref_state.solve_problem(ref_sol, pressure);
+
+	CHECK((state.mass - ref_state.mass).norm() < 1e-12 * ref_state.mass.norm());
+	CHECK((sol - ref_sol).norm() < 1e-8 * ref_sol.norm());
+}
+
+TEST_CASE("update-load-case", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"({
+		"materials": {"type": "LinearElasticity", "E": 1e5, "nu": 0.3},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": [0, 0]}, {"id": 3, "value": [0.01, 0]}]
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	const json load_case = R"({
+		"materials": {"type": "LinearElasticity", "E": 2e5, "nu": 0.35},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": [0, 0]}, {"id": 3, "value": [0, "0.01 * y"]}]
+		}
+	})"_json;
+
+	auto solve = [](State &state) {
+		Eigen::MatrixXd sol, pressure;
+		state.assemble_rhs();
+		state.assemble_mass_mat();
+		state.solve_problem(sol, pressure);
+		return sol;
+	};
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+	state.keep_linear_factorization = true;
+	solve(state);
+
+	json ref_args = in_args;
+	ref_args.merge_patch(load_case);
+	State ref_state;
+	ref_state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	ref_state.init(ref_args, true);
+	ref_state.load_mesh();
+	ref_state.build_basis();
+	const Eigen::MatrixXd ref_sol = solve(ref_state);
+
+	Eigen::MatrixXd sol, pressure;
+	state.solve_load_case(load_case, sol, pressure);
+	CHECK((sol - ref_sol).norm() < 1e-8 * ref_sol.norm());
+
+	// only the dirichlet values change, the factorization is reused
+	json bc_case;
+	bc_case["boundary_conditions"] = ref_args["boundary_conditions"];
+	bc_case["boundary_conditions"]["dirichlet_boundary"][1]["value"] = {0, "0.02 * y"};
+	state.solve_load_case(bc_case, sol, pressure);
+	CHECK((sol - 2 * ref_sol).norm() < 1e-8 * ref_sol.norm());
+
+	CHECK_THROWS(state.update_load_case(R"({"geometry": {}})"_json));
+}
+
+TEST_CASE("linear-load-cases", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"({
+		"materials": {"type": "LinearElasticity", "E": 1e5, "nu": 0.3},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": [0, 0]}],
+			"neumann_boundary": [{"id": 3, "value": [100, 0]}]
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	std::vector<json> load_cases;
+	for (const std::string value : {"[100, 0]", "[0, -100]", "[\"10 * y\", 50]"})
+	{
+		json load_case;
+		load_case["boundary_conditions"] = in_args["boundary_conditions"];
+		load_case["boundary_conditions"]["neumann_boundary"][0]["value"] = json::parse(value);
+		load_cases.push_back(load_case);
+	}
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	std::vector<Eigen::MatrixXd> sols;
+	state.solve_load_cases(load_cases, sols);
+	REQUIRE(sols.size() == load_cases.size());
+
+	for (int i = 0; i < load_cases.size(); ++i)
+	{
+		Eigen::MatrixXd ref_sol, pressure;
+		state.solve_load_case(load_cases[i], ref_sol, pressure);
+		CHECK((sols[i] - ref_sol).norm() < 1e-8 * ref_sol.norm());
+	}
+
+	json materials_case = load_cases[0];
+	materials_case["materials"] = in_args["materials"];
+	CHECK_THROWS(state.solve_load_cases({materials_case}, sols));
+}
+
+TEST_CASE("helmholtz-frequency-sweep", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"({
+		"materials": {"type": "Helmholtz", "k": 1},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": "y"}],
+			"neumann_boundary": [{"id": 3, "value": 1}],
+			"rhs": "x"
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const std::vector<double> k_scales = {0.5, 1, 2, 3.5, 5};
+	std::vector<Eigen::MatrixXd> sols;
+	state.solve_frequency_sweep(k_scales, sols);
+	REQUIRE(sols.size() == k_scales.size());
+
+	for (int i = 0; i < k_scales.size(); ++i)
+	{
+		json ref_args = in_args;
+		ref_args["materials"]["k"] = k_scales[i];
+		State ref_state;
+		ref_state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		ref_state.init(ref_args, true);
+		ref_state.load_mesh();
+
+		Eigen::MatrixXd ref_sol, pressure;
+		ref_state.solve(ref_sol, pressure);
+		CHECK((sols[i] - ref_sol).norm() < 1e-8 * ref_sol.norm());
+	}
+
+	json elastic_args = in_args;
+	elastic_args["materials"] = R"({"type": "LinearElasticity", "E": 1e5, "nu": 0.3})"_json;
+	elastic_args["boundary_conditions"] = R"({"dirichlet_boundary": [{"id": 1, "value": [0, 0]}]})"_json;
+	State elastic_state;
+	elastic_state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	elastic_state.init(elastic_args, true);
+	elastic_state.load_mesh();
+	elastic_state.build_basis();
+	CHECK_THROWS(elastic_state.solve_frequency_sweep(k_scales, sols));
+}
+
+TEST_CASE("modal-analysis", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"({
+		"materials": {"type": "LinearElasticity", "E": 1e5, "nu": 0.3, "rho": 10},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": [0, 0]}]
+		},
+		"solver": {
+			"modal": {"analysis": true, "n_modes": 6, "tolerance": 1e-10}
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+
+	Eigen::MatrixXd sol, pressure;
+	state.solve(sol, pressure);
+	REQUIRE(state.modal_eigenvalues.size() == 6);
+	REQUIRE(state.modal_shapes.cols() == 6);
+	CHECK((sol - state.modal_shapes.col(0)).norm() == 0);
+
+	StiffnessMatrix K;
+	state.build_stiffness_mat(K);
+	const Eigen::MatrixXd &modes = state.modal_shapes;
+	const Eigen::MatrixXd MP = state.mass * modes;
+	CHECK((modes.transpose() * MP - Eigen::MatrixXd::Identity(6, 6)).norm() < 1e-8);
+
+	Eigen::MatrixXd residual = K * modes - MP * state.modal_eigenvalues.asDiagonal();
+	for (const int i : state.boundary_nodes)
+		residual.row(i).setZero();
+	CHECK(residual.norm() < 1e-6 * (K * modes).norm());
+
+	for (int i = 1; i < 6; ++i)
+		CHECK(state.modal_eigenvalues[i - 1] <= state.modal_eigenvalues[i]);
+	CHECK(state.modal_eigenvalues[0] > 0);
+}
+
+TEST_CASE("reduced-order-transient", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"({
+		"materials": {"type": "NeoHookean", "E": 1e5, "nu": 0.3, "rho": 10},
+		"time": {"dt": 0.01, "time_steps": 5},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": [0, 0]}],
+			"neumann_boundary": [{"id": 3, "value": [100, 0]}]
+		},
+		"solver": {
+			"modal": {"n_modes": 4}
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	const auto run = [&](const json &reduced_order, Eigen::MatrixXd &sol) {
+		json args = in_args;
+		args["solver"]["reduced_order"] = reduced_order;
+		auto state = std::make_shared<State>();
+		state->init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state->init(args, true);
+		state->load_mesh();
+		Eigen::MatrixXd pressure;
+		state->solve(sol, pressure);
+		return state;
+	};
+
+	Eigen::MatrixXd full_sol;
+	run(R"({"enabled": false})"_json, full_sol);
+	REQUIRE(full_sol.norm() > 0);
+
+	SECTION("modes_and_derivatives")
+	{
+		Eigen::MatrixXd sol;
+		const auto state = run(R"({"enabled": true, "basis": "modes_and_derivatives"})"_json, sol);
+
+		const Eigen::MatrixXd &basis = state->reduced_order_basis;
+		REQUIRE(basis.cols() > 4);
+		REQUIRE(basis.cols() <= 4 + 4 * 5 / 2);
+		CHECK((basis.transpose() * basis - Eigen::MatrixXd::Identity(basis.cols(), basis.cols())).norm() < 1e-8);
+		for (const int b : state->boundary_nodes)
+			CHECK(basis.row(b).norm() < 1e-12);
+
+		CHECK(sol.allFinite());
+		CHECK((sol - full_sol).norm() < 0.2 * full_sol.norm());
+	}
+
+	SECTION("pod_cubature")
+	{
+		const std::string snapshots = (std::filesystem::temp_directory_path() / "polyfem_reduced_order_snapshots.txt").string();
+		REQUIRE(io::write_matrix(snapshots, full_sol));
+
+		json reduced_order = R"({"enabled": true, "basis": "pod", "cubature": {"enabled": true, "tolerance": 1e-3}})"_json;
+		reduced_order["snapshots"] = snapshots;
+		Eigen::MatrixXd sol;
+		const auto state = run(reduced_order, sol);
+		REQUIRE(state->reduced_order_basis.cols() == 1);
+		CHECK(sol.allFinite());
+
+		// the sampling is restored to the full loops at the end of the run
+		const auto nl_assembler = std::dynamic_pointer_cast<assembler::NLAssembler>(state->assembler);
+		REQUIRE(nl_assembler != nullptr);
+		CHECK(!nl_assembler->has_element_sampling());
+
+		Eigen::VectorXd grad, sampled_grad;
+		StiffnessMatrix hessian, sampled_hessian, full_hessian;
+		state->solve_data.elastic_form->first_derivative(full_sol, grad);
+		state->solve_data.elastic_form->second_derivative(full_sol, hessian);
+		state->init_reduced_order_model();
+		REQUIRE(nl_assembler->has_element_sampling());
+		CHECK(nl_assembler->sampled_elements().size() < state->bases.size());
+		state->solve_data.elastic_form->first_derivative(full_sol, sampled_grad);
+		// the hessian pattern of the sampled elements does not cover the full-order assembly that follows
+		state->solve_data.elastic_form->second_derivative(full_sol, sampled_hessian);
+		nl_assembler->set_element_sampling({}, {});
+		state->solve_data.elastic_form->element_sampling_changed();
+		state->solve_data.elastic_form->second_derivative(full_sol, full_hessian);
+		CHECK((full_hessian - hessian).norm() <= 1e-10 * hessian.norm());
+
+		const Eigen::MatrixXd &basis = state->reduced_order_basis;
+		CHECK((basis.transpose() * (sampled_grad - grad)).norm() <= 1e-3 * (basis.transpose() * grad).norm() + 1e-12);
+
+		std::filesystem::remove(snapshots);
+	}
+}
+
+TEST_CASE("parareal-transient", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"({
+		"materials": {"type": "NeoHookean", "E": 1e5, "nu": 0.3, "rho": 10},
+		"time": {"dt": 0.01, "time_steps": 8},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": [0, 0]}],
+			"neumann_boundary": [{"id": 3, "value": [100, 0]}]
+		},
+		"solver": {
+			"nonlinear": {"grad_norm": 1e-10}
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	const auto run = [&](const json &parareal) {
+		json args = in_args;
+		args["time"]["parareal"] = parareal;
+		State state;
+		state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state.init(args, true);
+		state.load_mesh();
+		Eigen::MatrixXd sol, pressure;
+		state.solve(sol, pressure);
+		return sol;
+	};
+
+	const Eigen::MatrixXd sequential = run(R"({"enabled": false})"_json);
+	REQUIRE(sequential.norm() > 0);
+
+	// as many iterations as slices reproduce the sequential solve
+	const Eigen::MatrixXd exact = run(R"({"enabled": true, "n_slices": 4, "coarse_steps": 1, "tolerance": 0})"_json);
+	CHECK((exact - sequential).norm() < 1e-6 * sequential.norm());
+
+	const Eigen::MatrixXd approximate = run(R"({"enabled": true, "n_slices": 4, "coarse_steps": 1, "max_iterations": 2})"_json);
+	CHECK(approximate.allFinite());
+	CHECK((approximate - sequential).norm() < 0.1 * sequential.norm());
+}
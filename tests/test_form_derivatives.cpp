@@ -3,6 +3,7 @@
 #include <polyfem/assembler/Mass.hpp>
 #include <polyfem/assembler/ViscousDamping.hpp>
 #include <polyfem/assembler/FixedCorotational.hpp>
+#include <polyfem/assembler/LinearElasticity.hpp>
 
 #include <polyfem/solver/forms/BCLagrangianForm.hpp>
 #include <polyfem/solver/forms/BCPenaltyForm.hpp>
@@ -17,6 +18,8 @@
 #include <polyfem/solver/forms/LaggedRegForm.hpp>
 #include <polyfem/solver/forms/RayleighDampingForm.hpp>
 #include <polyfem/solver/forms/adjoint_forms/AMIPSForm.hpp>
+#include <polyfem/solver/FullNLProblem.hpp>
+#include <polyfem/solver/problems/StaticBoundaryNLProblem.hpp>
 
 #include <polyfem/time_integrator/ImplicitEuler.hpp>
 
@@ -25,6 +28,7 @@
 #include <polyfem/State.hpp>
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
 #include <iostream>
@@ -221,6 +225,26 @@ void test_form(Form &form, const State &state, double step = 1e-8, double tol =
 			}
 
 			CHECK(fd::compare_hessian(Eigen::MatrixXd(hess), fhess, tol));
+
+			// Test the hessian-vector product against the assembled hessian
+			const Eigen::VectorXd v = Eigen::VectorXd::Random(x.size());
+			Eigen::VectorXd hv;
+			form.apply_hessian(x, v, hv);
+			CHECK((hv - hess * v).norm() <= 1e-8 * std::max(1.0, (hess * v).norm()));
+		}
+
+		// Test the fused evaluation against the separate ones
+		{
+			double val;
+			Eigen::VectorXd grad, grad_ref;
+			StiffnessMatrix hess, hess_ref;
+			form.value_gradient_hessian(x, val, grad, hess);
+			form.first_derivative(x, grad_ref);
+			form.second_derivative(x, hess_ref);
+
+			CHECK(std::abs(val - form.value(x)) <= 1e-8 * std::max(1.0, std::abs(val)));
+			CHECK((grad - grad_ref).norm() <= 1e-8 * std::max(1.0, grad_ref.norm()));
+			CHECK((hess - hess_ref).norm() <= 1e-8 * std::max(1.0, hess_ref.norm()));
 		}
 
 		x.setRandom();
@@ -305,6 +329,44 @@ TEST_CASE("contact form derivatives", "[form][form_derivatives][contact_form]")
 	test_form(form, *state_ptr);
 }
 
+TEST_CASE("plane contact form derivatives", "[form][form_derivatives][contact_form]")
+{
+	const int dim = GENERATE(2, 3);
+	const auto state_ptr = get_state(dim);
+	const ipc::CollisionMesh &collision_mesh = state_ptr->collision_mesh;
+
+	const double dhat = 0.1;
+	const bool use_convergent_formulation = GENERATE(true, false);
+
+	ContactForm form(
+		collision_mesh, dhat, state_ptr->avg_mass,
+		use_convergent_formulation, /*use_adaptive_barrier_stiffness=*/false,
+		/*is_time_dependent=*/false, false, ipc::BroadPhaseMethod::HASH_GRID, 1e-6,
+		static_cast<int>(1e6));
+	form.set_barrier_stiffness(1);
+
+	// ground half a barrier width below the lowest vertex
+	const double lowest = collision_mesh.rest_positions().col(1).minCoeff();
+	Eigen::MatrixXd points = Eigen::MatrixXd::Zero(1, dim), normals = Eigen::MatrixXd::Zero(1, dim);
+	points(0, 1) = lowest - dhat / 2;
+	normals(0, 1) = 1;
+	form.set_planes(points, normals, /*n_obstacle_vertices=*/0);
+
+	test_form(form, *state_ptr);
+
+	// moving down by the barrier width stops above the plane, without broad phase for the plane
+	const Eigen::VectorXd x0 = Eigen::VectorXd::Zero(state_ptr->n_bases * dim);
+	Eigen::VectorXd x1 = x0;
+	for (int i = 0; i < state_ptr->n_bases; ++i)
+		x1(i * dim + 1) = -dhat;
+
+	const double step = form.max_step_size(x0, x1);
+	CHECK(step < 0.5);
+	CHECK(step > 0);
+	CHECK(form.is_step_collision_free(x0, x0 + step * (x1 - x0)));
+	CHECK(!form.is_step_collision_free(x0, x1));
+}
+
 TEST_CASE("elastic form derivatives", "[form][form_derivatives][elastic_form]")
 {
 	const int dim = GENERATE(2, 3);
@@ -562,6 +624,277 @@ TEST_CASE("L2 projection form derivatives", "[form][form_derivatives][L2]")
 	test_form(form, *state_ptr);
 }
 
+TEST_CASE("form timings", "[form][form_timings]")
+{
+	const auto state_ptr = get_state(2);
+
+	const Eigen::VectorXd ones = Eigen::VectorXd::Ones(state_ptr->mass.cols());
+	const auto form0 = std::make_shared<L2ProjectionForm>(state_ptr->mass, state_ptr->mass, ones);
+	const auto form1 = std::make_shared<L2ProjectionForm>(state_ptr->mass, state_ptr->mass, ones);
+	form1->disable();
+	FullNLProblem problem({form0, form1});
+
+	const Eigen::VectorXd x = Eigen::VectorXd::Random(ones.size());
+	Eigen::VectorXd grad;
+	StiffnessMatrix hessian;
+	problem.value(x);
+	problem.value(x);
+	problem.gradient(x, grad);
+	problem.hessian(x, hessian);
+
+	const FullNLProblem::FormTimings timings0 = problem.form_timings(*form0);
+	CHECK(timings0.value.count == 2);
+	CHECK(timings0.gradient.count == 1);
+	CHECK(timings0.hessian.count == 1);
+	CHECK(timings0.value_gradient_hessian.count == 0);
+	// disabled forms are not evaluated
+	CHECK(problem.form_timings(*form1).value.count == 0);
+
+	// the forms with the same name are summed
+	const json j = problem.form_timings();
+	REQUIRE(j.contains(form0->name()));
+	CHECK(j[form0->name()]["value"]["count"] == 2);
+	CHECK(j[form0->name()]["hessian"]["time"].get<double>() >= 0);
+}
+
+TEST_CASE("line search quadratic forms", "[form][line_search]")
+{
+	const int dim = 2;
+	const auto state_ptr = get_state(dim);
+	const int ndof = state_ptr->n_bases * dim;
+
+	ImplicitEuler time_integrator;
+	time_integrator.init(
+		Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Zero(ndof), 1e-2);
+
+	const auto inertia_form = std::make_shared<InertiaForm>(state_ptr->mass, time_integrator);
+	const Eigen::VectorXd ones = Eigen::VectorXd::Ones(ndof);
+	const auto l2_form = std::make_shared<L2ProjectionForm>(state_ptr->mass, state_ptr->mass, ones);
+	FullNLProblem problem({inertia_form, l2_form});
+
+	const Eigen::VectorXd x0 = Eigen::VectorXd::Random(ndof);
+	const Eigen::VectorXd delta = Eigen::VectorXd::Random(ndof);
+	problem.line_search_begin(x0, x0 + delta);
+	const int inertia_evaluations = problem.form_timings(*inertia_form).value.count;
+
+	// the trial points only evaluate the forms with a non constant hessian
+	for (const double step : {1.0, 0.5, 0.25, 1e-3})
+	{
+		const Eigen::VectorXd x = x0 + step * delta;
+		const double expected = inertia_form->value(x) + l2_form->value(x);
+		CHECK(problem.value(x) == Catch::Approx(expected).epsilon(1e-10));
+	}
+	CHECK(problem.form_timings(*inertia_form).value.count == inertia_evaluations);
+	CHECK(problem.form_timings(*l2_form).value.count == 4);
+
+	// points off the line evaluate every form
+	const Eigen::VectorXd x = x0 + Eigen::VectorXd::Random(ndof);
+	CHECK(problem.value(x) == Catch::Approx(inertia_form->value(x) + l2_form->value(x)).epsilon(1e-12));
+	CHECK(problem.form_timings(*inertia_form).value.count == inertia_evaluations + 1);
+
+	problem.line_search_end();
+	problem.value(x0 + 0.5 * delta);
+	CHECK(problem.form_timings(*inertia_form).value.count == inertia_evaluations + 2);
+}
+
+TEST_CASE("constant hessian weight update", "[form][hessian]")
+{
+	const int dim = 2;
+	const auto state_ptr = get_state(dim);
+	const int ndof = state_ptr->n_bases * dim;
+
+	ImplicitEuler time_integrator;
+	time_integrator.init(
+		Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Zero(ndof), 1e-2);
+
+	// the second form stands for a penalty whose weight grows between the solves
+	const auto inertia_form = std::make_shared<InertiaForm>(state_ptr->mass, time_integrator);
+	const auto penalty_form = std::make_shared<InertiaForm>(state_ptr->mass, time_integrator);
+	FullNLProblem problem({inertia_form, penalty_form});
+
+	const Eigen::VectorXd x = Eigen::VectorXd::Random(ndof);
+	problem.init(x);
+	StiffnessMatrix hessian;
+	problem.hessian(x, hessian);
+
+	penalty_form->set_weight(10);
+	problem.reinit(x);
+	problem.hessian(x, hessian);
+
+	StiffnessMatrix expected;
+	inertia_form->second_derivative(x, expected);
+	CHECK((Eigen::MatrixXd(hessian) - 11 * Eigen::MatrixXd(expected)).norm() <= 1e-10 * Eigen::MatrixXd(expected).norm());
+
+	// only the hessian of the form whose weight changed is evaluated again
+	CHECK(problem.form_timings(*inertia_form).hessian.count == 1);
+	CHECK(problem.form_timings(*penalty_form).hessian.count == 2);
+}
+
+TEST_CASE("frozen hessian weight update", "[form][hessian]")
+{
+	const int dim = 2;
+	const auto state_ptr = get_state(dim);
+	const int ndof = state_ptr->n_bases * dim;
+
+	ImplicitEuler time_integrator;
+	time_integrator.init(
+		Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Zero(ndof), 1e-2);
+
+	// the weight of the frozen form changes between the iterations, e.g., with the time step
+	const auto inertia_form = std::make_shared<InertiaForm>(state_ptr->mass, time_integrator);
+	FullNLProblem problem({inertia_form});
+	problem.set_frozen_hessian(3, 0.5, {inertia_form});
+
+	const Eigen::VectorXd x = Eigen::VectorXd::Random(ndof);
+	problem.init(x);
+	StiffnessMatrix hessian;
+	problem.hessian(x, hessian);
+
+	inertia_form->set_weight(4);
+	problem.hessian(x, hessian);
+
+	StiffnessMatrix expected;
+	inertia_form->second_derivative(x, expected);
+	CHECK((Eigen::MatrixXd(hessian) - Eigen::MatrixXd(expected)).norm() <= 1e-10 * Eigen::MatrixXd(expected).norm());
+
+	// the frozen hessian is scaled, not assembled again
+	CHECK(problem.form_timings(*inertia_form).hessian.count == 1);
+}
+
+TEST_CASE("static hessian across time steps", "[form][hessian]")
+{
+	const int dim = 2;
+	const auto state_ptr = get_state(dim);
+	const int ndof = state_ptr->n_bases * dim;
+	LinearElasticity assembler;
+	state_ptr->set_materials(assembler);
+
+	const auto elastic_form = std::make_shared<ElasticForm>(
+		state_ptr->n_bases,
+		state_ptr->bases,
+		state_ptr->geom_bases(),
+		assembler,
+		state_ptr->ass_vals_cache,
+		0,
+		1e-2,
+		state_ptr->mesh->is_volume());
+	REQUIRE(elastic_form->is_hessian_static());
+
+	ImplicitEuler time_integrator;
+	time_integrator.init(
+		Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Zero(ndof), 1e-2);
+	const auto inertia_form = std::make_shared<InertiaForm>(state_ptr->mass, time_integrator);
+
+	StaticBoundaryNLProblem problem(ndof, {}, Eigen::VectorXd::Zero(ndof), {elastic_form, inertia_form});
+
+	StiffnessMatrix hessian;
+	for (int step = 1; step <= 3; ++step)
+	{
+		const Eigen::VectorXd x = Eigen::VectorXd::Random(ndof);
+		problem.update_quantities(step * 1e-2, x);
+		problem.init(x);
+		problem.hessian(x, hessian);
+	}
+
+	StiffnessMatrix stiffness, mass;
+	elastic_form->second_derivative(Eigen::VectorXd::Zero(ndof), stiffness);
+	inertia_form->second_derivative(Eigen::VectorXd::Zero(ndof), mass);
+	const Eigen::MatrixXd expected = Eigen::MatrixXd(stiffness) + Eigen::MatrixXd(mass);
+	CHECK((Eigen::MatrixXd(hessian) - expected).norm() <= 1e-10 * expected.norm());
+
+	// the linear elastic hessian is summed once, the inertia one at every time step
+	CHECK(problem.form_timings(*elastic_form).hessian.count == 1);
+	CHECK(problem.form_timings(*inertia_form).hessian.count == 3);
+}
+
+TEST_CASE("fused assembly per Newton iteration", "[form][hessian]")
+{
+	const int dim = 2;
+	const auto state_ptr = get_state(dim);
+	const int ndof = state_ptr->n_bases * dim;
+	assembler::FixedCorotational fixed_corotational;
+	state_ptr->set_materials(fixed_corotational);
+	const Eigen::VectorXd target = Eigen::VectorXd::Random(ndof) * 1e-2;
+
+	const auto solve = [&](const bool fused, Eigen::VectorXd &x, FullNLProblem::FormTimings &timings) {
+		const auto elastic_form = std::make_shared<ElasticForm>(
+			state_ptr->n_bases,
+			state_ptr->bases,
+			state_ptr->geom_bases(),
+			fixed_corotational,
+			state_ptr->ass_vals_cache,
+			0,
+			1,
+			state_ptr->mesh->is_volume());
+		const auto l2_form = std::make_shared<L2ProjectionForm>(state_ptr->mass, state_ptr->mass, target);
+		FullNLProblem problem({elastic_form, l2_form});
+		problem.set_fused_assembly(fused);
+
+		x = Eigen::VectorXd::Zero(ndof);
+		problem.init(x);
+		state_ptr->make_nl_solver(false)->minimize(problem, x);
+		timings = problem.form_timings(*elastic_form);
+	};
+
+	Eigen::VectorXd x, fused_x;
+	FullNLProblem::FormTimings timings, fused_timings;
+	solve(false, x, timings);
+	solve(true, fused_x, fused_timings);
+	CHECK((fused_x - x).norm() <= 1e-8 * std::max(1.0, x.norm()));
+	REQUIRE(timings.hessian.count > 0);
+
+	// one sweep per Newton iteration: the gradient of every iterate comes with its hessian
+	CHECK(fused_timings.hessian.count == 0);
+	CHECK(fused_timings.value_gradient_hessian.count >= timings.hessian.count);
+	CHECK(fused_timings.value_gradient_hessian.count <= timings.hessian.count + 1);
+	CHECK(fused_timings.value_gradient_hessian.count + fused_timings.gradient.count == timings.gradient.count);
+}
+
+TEST_CASE("reduced problem conversions", "[form][nl_problem]")
+{
+	const int dim = 2;
+	const auto state_ptr = get_state(dim);
+	const int ndof = state_ptr->n_bases * dim;
+
+	ImplicitEuler time_integrator;
+	time_integrator.init(
+		Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Random(ndof), Eigen::VectorXd::Zero(ndof), 1e-2);
+	const auto inertia_form = std::make_shared<InertiaForm>(state_ptr->mass, time_integrator);
+
+	const std::vector<int> boundary_nodes = {0, 1, 5, ndof - 1};
+	const Eigen::VectorXd boundary_values = Eigen::VectorXd::Random(ndof);
+	StaticBoundaryNLProblem problem(ndof, boundary_nodes, boundary_values, {inertia_form});
+	const int reduced_size = problem.reduced_size();
+	REQUIRE(reduced_size == ndof - boundary_nodes.size());
+
+	const Eigen::VectorXd reduced = Eigen::VectorXd::Random(reduced_size);
+	const Eigen::VectorXd full = problem.reduced_to_full(reduced);
+	REQUIRE(full.size() == ndof);
+	for (const int b : boundary_nodes)
+		CHECK(full(b) == boundary_values(b));
+	CHECK(problem.full_to_reduced(full) == reduced);
+
+	// the gradient is the gather of the full gradient, with the same buffers reused across the evaluations
+	for (int i = 0; i < 2; ++i)
+	{
+		const Eigen::VectorXd x = Eigen::VectorXd::Random(reduced_size);
+		Eigen::VectorXd grad, full_grad;
+		problem.gradient(x, grad);
+		inertia_form->first_derivative(problem.reduced_to_full(x), full_grad);
+		CHECK((grad - problem.full_to_reduced_grad(full_grad)).norm() <= 1e-12 * (1 + full_grad.norm()));
+		CHECK(problem.value(x) == Catch::Approx(inertia_form->value(problem.reduced_to_full(x))).epsilon(1e-12));
+	}
+
+	// the pattern of the reduced hessian (and so its symbolic analysis) is kept across the evaluations
+	StiffnessMatrix hessian;
+	problem.hessian(reduced, hessian);
+	CHECK(hessian.rows() == reduced_size);
+	const int pattern_changes = problem.hessian_pattern_changes();
+	CHECK(pattern_changes >= 1);
+	problem.hessian(Eigen::VectorXd::Random(reduced_size), hessian);
+	CHECK(problem.hessian_pattern_changes() == pattern_changes);
+}
+
 TEST_CASE("AMIPS form derivatives", "[form][form_derivatives][amips_form]")
  {
  	const int dim = GENERATE(2, 3);
@@ -689,3 +1022,51 @@ TEST_CASE("Fixed corotational form derivatives", "[form][form_derivatives][elast
 	form.update_quantities(0, Eigen::VectorXd::Ones(state_ptr->n_bases * dim));
 	test_form(form, *state_ptr, 1e-7, 1e-4);
 }
+
+TEST_CASE("elastic form cached evaluations", "[form][elastic_form]")
+{
+	const int dim = 2;
+	const auto state_ptr = get_state(dim);
+	const int ndof = state_ptr->n_bases * dim;
+	assembler::FixedCorotational assembler;
+	state_ptr->set_materials(assembler);
+
+	const auto make_form = [&]() {
+		return std::make_shared<ElasticForm>(
+			state_ptr->n_bases,
+			state_ptr->bases,
+			state_ptr->geom_bases(),
+			assembler,
+			state_ptr->ass_vals_cache,
+			0,
+			1,
+			state_ptr->mesh->is_volume());
+	};
+	const auto form = make_form(), cached_form = make_form();
+	cached_form->set_cache_evaluations(true);
+
+	for (int step = 0; step < 2; ++step)
+	{
+		const Eigen::VectorXd x_prev = Eigen::VectorXd::Random(ndof) * 1e-2;
+		form->update_quantities(step, x_prev);
+		cached_form->update_quantities(step, x_prev);
+
+		const Eigen::VectorXd x = Eigen::VectorXd::Random(ndof) * 1e-2;
+		const double value = cached_form->value(x);
+		Eigen::VectorXd grad, cached_grad;
+		cached_form->first_derivative(x, cached_grad);
+		form->first_derivative(x, grad);
+
+		// the output reads the energies and forces of the last evaluation
+		CHECK(value == Catch::Approx(form->value(x)));
+		CHECK((cached_form->value_per_element(x) - form->value_per_element(x)).norm() <= 1e-12 * std::max(1.0, std::abs(value)));
+		Eigen::VectorXd reused_grad;
+		cached_form->first_derivative(x, reused_grad);
+		CHECK(reused_grad == cached_grad);
+		CHECK((reused_grad - grad).norm() <= 1e-12 * std::max(1.0, grad.norm()));
+
+		// any other solution is evaluated again
+		const Eigen::VectorXd y = x + Eigen::VectorXd::Random(ndof) * 1e-3;
+		CHECK((cached_form->value_per_element(y) - form->value_per_element(y)).norm() <= 1e-12 * std::max(1.0, std::abs(value)));
+	}
+}
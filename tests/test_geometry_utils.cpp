@@ -2,6 +2,9 @@
 #include <catch2/catch_approx.hpp>
 
 #include <polyfem/utils/GeometryUtils.hpp>
+#include <polyfem/mesh/ElementLocator.hpp>
+
+#include <cmath>
 
 TEST_CASE("Triangle area", "[geometry]")
 {
@@ -41,3 +44,39 @@ TEST_CASE("Tetrahedron volume", "[geometry]")
 
 	CHECK(tetrahedron_volume(V_flipped) == Catch::Approx(-1 / 6.));
 }
+
+TEST_CASE("Element locator", "[geometry]")
+{
+	using namespace polyfem::mesh;
+
+	Eigen::MatrixXd V(4, 2);
+	V << 0, 0,
+		1, 0,
+		1, 1,
+		0, 1;
+	Eigen::MatrixXi F(2, 3);
+	F << 0, 1, 2,
+		0, 2, 3;
+
+	const ElementLocator locator(V, F);
+
+	Eigen::MatrixXd P(3, 2);
+	P << 0.7, 0.2,
+		0.2, 0.7,
+		2, 2;
+
+	Eigen::VectorXi elements;
+	Eigen::MatrixXd bc;
+	locator.locate(P, elements, bc);
+	CHECK(elements[0] == 0);
+	CHECK(elements[1] == 1);
+	CHECK(elements[2] == -1);
+	CHECK((bc.row(0) * V(F.row(0), Eigen::all) - P.row(0)).norm() < 1e-12);
+
+	// linear functions are reproduced
+	const Eigen::MatrixXd values = 3 * V.col(0) + V.col(1);
+	const Eigen::MatrixXd interpolated = locator.interpolate(P, values);
+	CHECK(interpolated(0) == Catch::Approx(2.3));
+	CHECK(interpolated(1) == Catch::Approx(1.3));
+	CHECK(std::isnan(interpolated(2)));
+}
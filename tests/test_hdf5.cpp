@@ -4,6 +4,14 @@
 
 #include <h5pp/h5pp.h>
 
+#include <polyfem/io/HDF5TimeSeriesWriter.hpp>
+#include <polyfem/io/MatrixIO.hpp>
+#include <polyfem/solver/DiffCache.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
 TEST_CASE("HDF5", "[hdf5]")
 {
 	using MatrixXl = Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic>;
@@ -28,4 +36,174 @@ TEST_CASE("HDF5", "[hdf5]")
 		cells[i] = file.readDataset<MatrixXl>("/meshes/" + name + "/c").cast<int>();
 		vertices[i] = file.readDataset<Eigen::MatrixXd>("/meshes/" + name + "/v");
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("HDF5 time series", "[hdf5]")
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "polyfem_time_series.h5";
+
+	Eigen::MatrixXd points(4, 2);
+	points << 0, 0, 1, 0, 1, 1, 0, 1;
+	Eigen::MatrixXi cells(2, 3);
+	cells << 0, 1, 2, 0, 2, 3;
+
+	polyfem::io::HDF5TimeSeriesWriter writer(path.string());
+	for (int i = 0; i < 3; ++i)
+	{
+		const Eigen::MatrixXd u = Eigen::MatrixXd::Constant(4, 2, i);
+		writer.write_step(0.1 * i, points, cells, {{"solution", u}});
+	}
+	CHECK(writer.n_steps() == 3);
+
+	// the mesh is written once
+	h5pp::File file(path.string(), h5pp::FileAccess::READONLY);
+	CHECK(file.linkExists("mesh_0/points"));
+	CHECK(!file.linkExists("mesh_1/points"));
+	CHECK(file.readDataset<Eigen::MatrixXi>("mesh_0/cells") == cells);
+	CHECK(file.readDataset<Eigen::MatrixXd>("step_2/solution") == Eigen::MatrixXd::Constant(4, 2, 2));
+
+	std::ifstream xdmf(writer.xdmf_path());
+	REQUIRE(xdmf.good());
+	std::stringstream content;
+	content << xdmf.rdbuf();
+	const std::string str = content.str();
+
+	int n_grids = 0;
+	for (size_t pos = str.find("GridType=\"Uniform\""); pos != std::string::npos; pos = str.find("GridType=\"Uniform\"", pos + 1))
+		++n_grids;
+	CHECK(n_grids == 3);
+	CHECK(str.rfind("</Xdmf>") != std::string::npos);
+	CHECK(str.find("</Xdmf>") == str.rfind("</Xdmf>"));
+}
+
+TEST_CASE("HDF5 time series precision", "[hdf5]")
+{
+	using polyfem::io::HDF5TimeSeriesWriter;
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "polyfem_time_series_precision.h5";
+
+	Eigen::MatrixXd points(4, 2);
+	points << 0, 0, 1, 0, 1, 1, 0, 1;
+	Eigen::MatrixXi cells(2, 3);
+	cells << 0, 1, 2, 0, 2, 3;
+
+	std::map<std::string, HDF5TimeSeriesWriter::FieldFormat> formats;
+	formats["velocity"].precision = HDF5TimeSeriesWriter::Precision::F32;
+	formats["solution"].precision = HDF5TimeSeriesWriter::Precision::QUANTIZED;
+	formats["solution"].min = -1;
+	formats["solution"].max = 1;
+
+	const Eigen::MatrixXd u = Eigen::MatrixXd::Random(4, 2);
+	HDF5TimeSeriesWriter writer(path.string(), 4, formats);
+	writer.write_step(0, points, cells, {{"solution", u}, {"velocity", u}});
+
+	h5pp::File file(path.string(), h5pp::FileAccess::READONLY);
+	CHECK(file.readDataset<Eigen::MatrixXf>("step_0/velocity").isApprox(u.cast<float>()));
+
+	const Eigen::Vector2d scale_offset = file.readDataset<Eigen::Vector2d>("step_0/solution_scale_offset");
+	const Eigen::MatrixXd dequantized = (file.readDataset<Eigen::Matrix<uint16_t, Eigen::Dynamic, Eigen::Dynamic>>("step_0/solution").cast<double>() * scale_offset(0)).array() + scale_offset(1);
+	CHECK((dequantized - u).lpNorm<Eigen::Infinity>() <= scale_offset(0));
+}
+
+TEST_CASE("HDF5 spilled adjoint jacobians", "[hdf5]")
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "polyfem_adjoint_jacobians.h5";
+
+	const int n_steps = 5;
+	const int ndof = 6;
+
+	std::vector<polyfem::StiffnessMatrix> jacobians;
+	for (int i = 0; i <= n_steps; ++i)
+	{
+		const Eigen::MatrixXd dense = Eigen::MatrixXd::Random(ndof, ndof);
+		jacobians.push_back(dense.sparseView());
+	}
+
+	polyfem::solver::DiffCache cache;
+	cache.set_jacobian_storage(2, path.string());
+	cache.init(2, ndof, n_steps);
+	for (int i = 0; i <= n_steps; ++i)
+		cache.cache_quantities_quasistatic(i, Eigen::VectorXd::Constant(ndof, i), jacobians[i], ipc::Collisions(), Eigen::MatrixXd::Zero(2, 2));
+
+	// read in the order of the adjoint sweep
+	for (int i = n_steps; i >= 0; --i)
+	{
+		CHECK(cache.u(i) == Eigen::VectorXd::Constant(ndof, i));
+		CHECK(Eigen::MatrixXd(cache.gradu_h(i)) == Eigen::MatrixXd(jacobians[i]));
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Sparse matrix export", "[hdf5]")
+{
+	const Eigen::MatrixXd dense = Eigen::MatrixXd::Random(40, 30);
+	const polyfem::StiffnessMatrix mat = dense.sparseView(0.5, 1);
+
+	const std::filesystem::path bin_path = std::filesystem::temp_directory_path() / "polyfem_sparse_export.bin";
+	const std::filesystem::path h5_path = std::filesystem::temp_directory_path() / "polyfem_sparse_export.h5";
+
+	REQUIRE(polyfem::io::write_sparse_matrix(bin_path.string(), mat));
+	REQUIRE(polyfem::io::write_sparse_matrix(h5_path.string(), mat));
+
+	polyfem::StiffnessMatrix read;
+	REQUIRE(polyfem::io::read_sparse_matrix(bin_path.string(), read));
+	CHECK(Eigen::MatrixXd(read) == Eigen::MatrixXd(mat));
+
+	REQUIRE(polyfem::io::read_sparse_matrix(h5_path.string(), read));
+	CHECK(Eigen::MatrixXd(read) == Eigen::MatrixXd(mat));
+
+	{
+		polyfem::io::MappedSparseMatrix mapped;
+		REQUIRE(mapped.open(bin_path.string()));
+		CHECK(mapped.matrix().nonZeros() == mat.nonZeros());
+		CHECK(Eigen::MatrixXd(mapped.matrix()) == Eigen::MatrixXd(mat));
+
+		// an hdf5 file is not a binary sparse matrix
+		CHECK(!mapped.open(h5_path.string()));
+		CHECK(!mapped.is_open());
+	}
+
+	std::filesystem::remove(bin_path);
+	std::filesystem::remove(h5_path);
+}
+
+TEST_CASE("HDF5 chunked and partial reads", "[hdf5]")
+{
+	using MatrixXl = Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic>;
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "polyfem_chunked_read.h5";
+
+	const Eigen::MatrixXd v = Eigen::MatrixXd::Random(100, 3);
+	const MatrixXl c = (Eigen::MatrixXd::Random(50, 4).array().abs() * 99).cast<int64_t>();
+	const Eigen::VectorXd u = Eigen::VectorXd::Random(300);
+	{
+		h5pp::File file(path.string(), h5pp::FileAccess::REPLACE);
+		file.writeDataset(v, "v");
+		file.writeDataset(c, "c");
+		file.writeDataset(u, "u");
+	}
+
+	Eigen::MatrixXd vr;
+	REQUIRE(polyfem::io::read_matrix_chunked<double>(path.string(), "v", vr, /*chunk_rows=*/7));
+	CHECK(vr == v);
+
+	Eigen::MatrixXi cr;
+	REQUIRE(polyfem::io::read_matrix_chunked<int64_t>(path.string(), "c", cr, /*chunk_rows=*/16));
+	CHECK(cr == c.cast<int>());
+
+	Eigen::MatrixXd ur;
+	REQUIRE(polyfem::io::read_matrix_chunked<double>(path.string(), "u", ur));
+	CHECK(ur == u);
+
+	const std::vector<int64_t> rows = {10, 11, 12, 3, 99, 11, 0};
+	REQUIRE(polyfem::io::read_matrix_rows<double>(path.string(), "v", rows, vr, /*chunk_rows=*/2));
+	REQUIRE(vr.rows() == rows.size());
+	for (int i = 0; i < rows.size(); ++i)
+		CHECK(vr.row(i) == v.row(rows[i]));
+
+	CHECK(!polyfem::io::read_matrix_chunked<double>(path.string(), "missing", vr));
+	CHECK(!polyfem::io::read_matrix_rows<double>(path.string(), "v", {100}, vr));
+
+	std::filesystem::remove(path);
+}
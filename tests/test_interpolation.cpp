@@ -1,8 +1,10 @@
 #include <polyfem/Common.hpp>
 #include <polyfem/utils/Interpolation.hpp>
+#include <polyfem/utils/LazyCubicInterpolator.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
 using namespace polyfem;
 using namespace polyfem::utils;
@@ -73,3 +75,32 @@ TEST_CASE("piecewise cubic interpolation", "[interpolation]")
 		CHECK(interp->eval(points[i]) == Catch::Approx(values[i]));
 	}
 }
+
+TEST_CASE("lazy cubic interpolator grids", "[interpolation]")
+{
+	const int dim = GENERATE(2, 3);
+	const double delta = 0.05;
+	auto distance = [](const Eigen::MatrixXd &p, double &d) { d = p.norm() - 0.5 + 0.1 * p(0) * p(1); };
+
+	LazyCubicInterpolator lazy(dim, delta), dense(dim, delta);
+	dense.precompute_grid(distance, -Eigen::VectorXd::Ones(dim), Eigen::VectorXd::Ones(dim));
+
+	const Eigen::MatrixXd points = 0.9 * Eigen::MatrixXd::Random(50, dim);
+	Eigen::VectorXd vals;
+	Eigen::MatrixXd grads;
+	dense.evaluate(points, vals, grads);
+
+	for (int i = 0; i < points.rows(); i++)
+	{
+		const Eigen::MatrixXd p = points.row(i);
+		double val, exact;
+		Eigen::MatrixXd grad;
+		lazy.lazy_evaluate(distance, p, val, grad);
+		distance(p, exact);
+
+		// The dense grid uses the same finite difference stencils as the lazy hash maps
+		CHECK(val == Catch::Approx(vals(i)).margin(1e-12));
+		CHECK((grad.transpose() - grads.row(i)).norm() < 1e-10);
+		CHECK(val == Catch::Approx(exact).margin(1e-3));
+	}
+}
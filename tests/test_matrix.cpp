@@ -1,16 +1,24 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/utils/MatrixCache.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/autogen/auto_eigs.hpp>
 #include <polyfem/utils/AutodiffTypes.hpp>
+#include <polyfem/solver/MixedPrecisionSolver.hpp>
+#include <polyfem/solver/PreconditionerReuseSolver.hpp>
+#include <polyfem/solver/SaddlePointSolver.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <functional>
 
 #include <Eigen/Dense>
+#include <Eigen/SparseLU>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -247,3 +255,338 @@ TEST_CASE("cache", "[matrix]")
 	REQUIRE(tmp2.coeff(9, 4) == 6);
 	REQUIRE(tmp2.coeff(9, 9) == 4);
 }
+
+TEST_CASE("cache_atomic_slots", "[matrix]")
+{
+	// every element couples its node with the next ones, the neighbouring elements share slots
+	const int n = 1000;
+	const int n_elements = n - 2;
+	const auto add_element = [&](const int e, const std::function<void(int, int, double)> &add) {
+		for (int i = e; i < e + 3; ++i)
+			for (int j = e; j < e + 3; ++j)
+				add(i, j, 1 + (i + j) % 5);
+	};
+
+	SparseMatrixCache cache(n);
+	for (int e = 0; e < n_elements; ++e)
+		add_element(e, [&](int i, int j, double v) { cache.add_value(e, i, j, v); });
+	const StiffnessMatrix expected = cache.get_matrix();
+	REQUIRE(cache.has_element_slots(n_elements));
+
+	for (int iter = 0; iter < 2; ++iter)
+	{
+		maybe_parallel_for(n_elements, [&](int e) {
+			const std::vector<int> &slots = cache.element_slots(e);
+			size_t slot = 0;
+			add_element(e, [&](int, int, double v) { cache.atomic_add_to_slot(slots[slot++], v); });
+		});
+
+		const StiffnessMatrix assembled = cache.get_matrix();
+		REQUIRE(assembled.nonZeros() == expected.nonZeros());
+		// the values are small integers, the sums are exact in any order
+		CHECK((assembled - expected).norm() == 0);
+	}
+}
+
+TEST_CASE("block_sparse_matrix", "[matrix]")
+{
+	const int block_size = GENERATE(2, 3);
+	const int n_nodes = 50;
+	const int n = n_nodes * block_size;
+	const int n_elements = n_nodes - 2;
+
+	// every element couples its node with the next ones, the neighbouring elements share blocks
+	const auto add_element = [&](const int e, const std::function<void(int, int, double)> &add) {
+		for (int a = e; a < e + 3; ++a)
+			for (int b = e; b < e + 3; ++b)
+				for (int r = 0; r < block_size; ++r)
+					for (int c = 0; c < block_size; ++c)
+						add(a * block_size + r, b * block_size + c, 1 + (a + 2 * b + r + 3 * c) % 7);
+	};
+
+	SparseMatrixCache scalar_cache(n);
+	BlockSparseMatrixCache block_cache(n, block_size);
+	for (int e = 0; e < n_elements; ++e)
+	{
+		add_element(e, [&](int i, int j, double v) {
+			scalar_cache.add_value(e, i, j, v);
+			block_cache.add_value(e, i, j, v);
+		});
+	}
+	const StiffnessMatrix expected = scalar_cache.get_matrix();
+	const StiffnessMatrix assembled = block_cache.get_matrix();
+	REQUIRE(assembled.nonZeros() == expected.nonZeros());
+	// the values are small integers, the sums are exact in any order
+	CHECK((assembled - expected).norm() == 0);
+
+	const BlockSparseMatrix &blocks = block_cache.block_matrix();
+	CHECK(blocks.non_zero_blocks() * block_size * block_size == expected.nonZeros());
+
+	const Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+	Eigen::VectorXd y;
+	blocks.multiply(x, y);
+	CHECK((y - expected * x).norm() == Catch::Approx(0).margin(1e-10));
+
+	BlockSparseMatrix from_sparse;
+	from_sparse.init(expected, block_size);
+	CHECK(from_sparse.same_pattern(blocks));
+	CHECK((from_sparse.to_sparse() - expected).norm() == 0);
+
+	// the blocks of every element written by slot, with atomic adds as the neighbouring elements share them
+	std::vector<std::vector<std::pair<int, int>>> element_blocks(n_elements);
+	for (int e = 0; e < n_elements; ++e)
+		for (int a = e; a < e + 3; ++a)
+			for (int b = e; b < e + 3; ++b)
+				element_blocks[e].emplace_back(a, b);
+	block_cache.init_element_slots(element_blocks);
+	REQUIRE(block_cache.has_element_slots(n_elements));
+
+	for (int iter = 0; iter < 2; ++iter)
+	{
+		block_cache.init(n);
+		maybe_parallel_for(n_elements, [&](int e) {
+			const std::vector<int> &slots = block_cache.element_slots(e);
+			size_t slot = 0;
+			for (int a = e; a < e + 3; ++a)
+			{
+				for (int b = e; b < e + 3; ++b)
+				{
+					double *block = block_cache.block(slots[slot++]);
+					for (int r = 0; r < block_size; ++r)
+						for (int c = 0; c < block_size; ++c)
+							atomic_add(block[r * block_size + c], 1 + (a + 2 * b + r + 3 * c) % 7);
+				}
+			}
+		});
+
+		CHECK((block_cache.get_matrix() - expected).norm() == 0);
+	}
+
+	// an entry outside of the pattern adds its block
+	block_cache.add_value(0, 0, n - 1, 5);
+	const StiffnessMatrix extended = block_cache.get_matrix();
+	CHECK(extended.nonZeros() == expected.nonZeros() + block_size * block_size);
+	CHECK(extended.coeff(0, n - 1) == 5);
+	CHECK(!block_cache.has_element_slots(n_elements));
+}
+
+TEST_CASE("symmetric_matrix_cache", "[matrix]")
+{
+	const int block_size = GENERATE(1, 2, 3);
+	const int n_nodes = 40;
+	const int n = n_nodes * block_size;
+	const int n_elements = n_nodes - 2;
+
+	// symmetric element matrices coupling every node with the next ones
+	const auto entry = [&](const int i, const int j) { return 1 + (i + j + (i * j) % 3) % 7; };
+	const auto add_element = [&](const int e, const std::function<void(int, int, double)> &add) {
+		for (int i = e * block_size; i < (e + 3) * block_size; ++i)
+			for (int j = e * block_size; j < (e + 3) * block_size; ++j)
+				add(i, j, entry(i, j));
+	};
+
+	SparseMatrixCache cache(n);
+	for (int e = 0; e < n_elements; ++e)
+		add_element(e, [&](int i, int j, double v) { cache.add_value(e, i, j, v); });
+	const StiffnessMatrix expected = cache.get_matrix();
+	REQUIRE(cache.has_element_slots(n_elements));
+	REQUIRE((expected - StiffnessMatrix(expected.transpose())).norm() == 0);
+
+	// only the upper triangle is written, the lower one is copied by get_matrix
+	cache.set_symmetric(true);
+	maybe_parallel_for(n_elements, [&](int e) {
+		const std::vector<int> &slots = cache.element_slots(e);
+		size_t slot = 0;
+		add_element(e, [&](int i, int j, double v) {
+			if (i <= j)
+				cache.atomic_add_to_slot(slots[slot], v);
+			++slot;
+		});
+	});
+	CHECK((cache.get_matrix() - expected).norm() == 0);
+
+	// only the blocks on and above the diagonal are stored
+	BlockSparseMatrix blocks;
+	blocks.init(expected, block_size, /*symmetric=*/true);
+	CHECK(blocks.non_zero_blocks() == 3 * n_nodes - 3);
+	CHECK((blocks.to_sparse() - expected).norm() == 0);
+
+	const Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+	Eigen::VectorXd y;
+	blocks.multiply(x, y);
+	CHECK((y - expected * x).norm() == Catch::Approx(0).margin(1e-10));
+
+	BlockSparseMatrixCache block_cache(n, block_size);
+	block_cache.set_symmetric(true);
+	for (int e = 0; e < n_elements; ++e)
+		add_element(e, [&](int i, int j, double v) { block_cache.add_value(e, i, j, v); });
+	CHECK((block_cache.get_matrix() - expected).norm() == 0);
+	CHECK(block_cache.block_matrix().non_zero_blocks() == 3 * n_nodes - 3);
+}
+
+TEST_CASE("add_to_pattern", "[matrix]")
+{
+	StiffnessMatrix pattern(10, 10), sub(10, 10), other(10, 10);
+	for (int i = 0; i < 10; ++i)
+	{
+		pattern.insert(i, i) = 1;
+		if (i + 1 < 10)
+			pattern.insert(i, i + 1) = 1;
+		sub.insert(i, i) = i;
+	}
+	pattern.makeCompressed();
+	other.insert(9, 0) = 1;
+
+	StiffnessMatrix dst = pattern;
+	REQUIRE(add_to_pattern(sub, dst));
+	CHECK(dst.nonZeros() == pattern.nonZeros());
+	CHECK((Eigen::MatrixXd(dst) - Eigen::MatrixXd(pattern + sub)).norm() == 0);
+
+	// entries outside the pattern leave dst untouched
+	REQUIRE(!add_to_pattern(other, dst));
+	CHECK((Eigen::MatrixXd(dst) - Eigen::MatrixXd(pattern + sub)).norm() == 0);
+}
+
+TEST_CASE("saddle_point_solver", "[matrix]")
+{
+	// nonsymmetric velocity block (like Newton on Navier-Stokes), coupling and average pressure constraint
+	const int n_velocity = 40, n_pressure = 10;
+	const int n = n_velocity + n_pressure + 1;
+
+	std::vector<Eigen::Triplet<double>> entries;
+	for (int i = 0; i < n_velocity; ++i)
+	{
+		entries.emplace_back(i, i, 4);
+		if (i > 0)
+			entries.emplace_back(i, i - 1, -1.3);
+		if (i < n_velocity - 1)
+			entries.emplace_back(i, i + 1, -0.7);
+	}
+	for (int j = 0; j < n_pressure; ++j)
+	{
+		for (int k = 0; k < 4; ++k)
+		{
+			const int i = (4 * j + k) % n_velocity;
+			const double val = std::sin(1. + i + 7. * j);
+			entries.emplace_back(i, n_velocity + j, val);
+			entries.emplace_back(n_velocity + j, i, val);
+		}
+		entries.emplace_back(n_velocity + j, n_velocity + n_pressure, 1. / n_pressure);
+		entries.emplace_back(n_velocity + n_pressure, n_velocity + j, 1. / n_pressure);
+	}
+	StiffnessMatrix K(n, n);
+	K.setFromTriplets(entries.begin(), entries.end());
+
+	const std::vector<int> fixed = {0, 5, 17};
+	Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n, -1, 1);
+	b(n - 1) = 0;
+
+	const json params = R"({
+		"max_iterations": 200,
+		"restart": 30,
+		"tolerance": 1e-10,
+		"velocity_linear": {"solver": "Eigen::SparseLU"},
+		"schur_linear": {"solver": "Eigen::SparseLU"}
+	})"_json;
+	solver::SaddlePointSolver saddle_point_solver(params);
+	Eigen::VectorXd x;
+	saddle_point_solver.solve(K, n_velocity, fixed, b, x);
+
+	// reference: monolithic solve with the fixed rows replaced by the identity
+	StiffnessMatrix Kd = K;
+	Kd.prune([&](const Eigen::Index row, const Eigen::Index, const double) { return std::find(fixed.begin(), fixed.end(), row) == fixed.end(); });
+	for (const int i : fixed)
+		Kd.coeffRef(i, i) = 1;
+	Eigen::SparseLU<StiffnessMatrix> lu(Kd);
+	const Eigen::VectorXd x_ref = lu.solve(b);
+
+	CHECK((x - x_ref).norm() <= 1e-8 * x_ref.norm());
+	CHECK(saddle_point_solver.iterations() < 30);
+
+	// the solution is a fixed point, the persistent solvers are reused
+	saddle_point_solver.solve(K, n_velocity, fixed, b, x);
+	CHECK(saddle_point_solver.iterations() == 0);
+}
+
+TEST_CASE("mixed_precision_solver", "[matrix]")
+{
+	// non symmetric tridiagonal system
+	const int n = 200;
+	std::vector<Eigen::Triplet<double>> entries;
+	for (int i = 0; i < n; ++i)
+	{
+		entries.emplace_back(i, i, 4 + 1e-3 * i);
+		if (i > 0)
+		{
+			entries.emplace_back(i, i - 1, -1);
+			entries.emplace_back(i - 1, i, -1.5);
+		}
+	}
+	StiffnessMatrix A(n, n);
+	A.setFromTriplets(entries.begin(), entries.end());
+
+	solver::MixedPrecisionSolver solver(1e-12, 20);
+	solver.analyze_pattern(A, 0);
+	solver.factorize(A);
+
+	const Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+	Eigen::VectorXd x(n);
+	solver.solve(b, x);
+
+	// the refinement reaches double precision from the single precision factors
+	CHECK(solver.residual() <= 1e-12);
+	CHECK(solver.iterations() > 1);
+	CHECK((A * x - b).norm() <= 1e-12 * b.norm());
+}
+
+TEST_CASE("preconditioner_reuse_solver", "[matrix]")
+{
+	// slowly changing non symmetric tridiagonal systems, e.g., of successive time steps
+	const int n = 200;
+	const auto matrix = [n](const double t) {
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int i = 0; i < n; ++i)
+		{
+			entries.emplace_back(i, i, 4 + 1e-3 * i + t * std::sin(i));
+			if (i > 0)
+			{
+				entries.emplace_back(i, i - 1, -1);
+				entries.emplace_back(i - 1, i, -1.5 - t);
+			}
+		}
+		StiffnessMatrix A(n, n);
+		A.setFromTriplets(entries.begin(), entries.end());
+		return A;
+	};
+
+	solver::PreconditionerReuseSolver solver(std::make_unique<solver::MixedPrecisionSolver>(1e-12, 20), 1e-10, 100, 2);
+
+	const int n_steps = 10;
+	for (int step = 0; step < n_steps; ++step)
+	{
+		const StiffnessMatrix A = matrix(0.01 * step);
+		solver.analyze_pattern(A, 0);
+		solver.factorize(A);
+
+		const Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+		Eigen::VectorXd x(n);
+		solver.solve(b, x);
+
+		CHECK(solver.residual() <= 1e-10);
+		CHECK((A * x - b).norm() <= 1e-9 * b.norm());
+	}
+
+	// the factorization of an older matrix preconditions the following ones
+	CHECK(solver.setups() < n_steps);
+
+	// a new pattern sets the inner solver up again
+	const int setups = solver.setups();
+	const StiffnessMatrix I = StiffnessMatrix(Eigen::VectorXd::Constant(n, 2).asDiagonal());
+	solver.analyze_pattern(I, 0);
+	solver.factorize(I);
+	const Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+	Eigen::VectorXd x(n);
+	solver.solve(b, x);
+	CHECK(solver.setups() == setups + 1);
+	CHECK((I * x - b).norm() <= 1e-9 * b.norm());
+}
@@ -1,13 +1,28 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <catch2/catch_approx.hpp>
 
 #include <polyfem/State.hpp>
 #include <polyfem/Common.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/RefElementSampler.hpp>
+#include <polyfem/utils/raster.hpp>
+#include <polyfem/io/Evaluator.hpp>
+#include <polyfem/io/OBJReader.hpp>
+#include <polyfem/io/OBJWriter.hpp>
+#include <polyfem/io/PointProbe.hpp>
+#include <polyfem/io/ReductionCSVWriter.hpp>
+#include <polyfem/io/SolutionFrameStore.hpp>
+#include <polyfem/io/VTUAppendedWriter.hpp>
 
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <sstream>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -82,3 +97,479 @@ TEST_CASE("full sim", "[.][full_sim]")
 
 	std::filesystem::remove_all(outdir);
 }
+
+TEST_CASE("interpolation operator", "[output]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"]["discr_order"] = 2;
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const mesh::Mesh &mesh = *state.mesh;
+
+	// without the sampler the P2 triangles are evaluated at their 6 nodes, no need to initialize it
+	const RefElementSampler sampler;
+	const int n_points = 6 * state.bases.size();
+
+	StiffnessMatrix interpolation;
+	io::Evaluator::interpolation_operator(mesh, state.bases, state.disc_orders, state.polys, state.polys_3d, sampler, n_points, state.n_bases, false, false, interpolation);
+	REQUIRE(interpolation.rows() == n_points);
+	REQUIRE(interpolation.cols() == state.n_bases);
+
+	const Eigen::MatrixXd fun = Eigen::VectorXd::Random(state.n_bases * 2);
+	Eigen::MatrixXd expected;
+	io::Evaluator::interpolate_function(mesh, false, state.bases, state.disc_orders, state.polys, state.polys_3d, sampler, n_points, fun, expected, false, false);
+
+	const Eigen::MatrixXd result = interpolation * unflatten(fun, 2);
+	CHECK((result - expected).norm() < 1e-10 * expected.norm());
+}
+
+TEST_CASE("point probe", "[output]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"]["discr_order"] = 2;
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	// the positions of the nodes, sampled at a point it gives the point back
+	Eigen::MatrixXd positions = Eigen::MatrixXd::Zero(2 * state.n_bases, 1);
+	for (const basis::ElementBases &eb : state.bases)
+		for (const basis::Basis &b : eb.bases)
+			for (const auto &g : b.global())
+				positions.middleRows(2 * g.index, 2) = g.node.transpose();
+
+	// random points in the elements and points outside of the mesh
+	const int n_inside = 1000;
+	Eigen::MatrixXd points(n_inside + 2, 2);
+	Eigen::VectorXi expected_elements(n_inside);
+	for (int i = 0; i < n_inside; ++i)
+	{
+		const int e = i % state.mesh->n_elements();
+		Eigen::RowVector2d xi = (Eigen::RowVector2d::Random().array() + 1) / 2;
+		if (xi.sum() > 1)
+			xi = Eigen::RowVector2d::Ones() - xi;
+		Eigen::MatrixXd mapped;
+		state.geom_bases()[e].eval_geom_mapping(xi, mapped);
+		points.row(i) = mapped;
+		expected_elements[i] = e;
+	}
+	RowVectorNd min, max;
+	state.mesh->bounding_box(min, max);
+	points.row(n_inside) = max.array() + 1;
+	points.row(n_inside + 1) = min.array() - 1;
+
+	io::PointProbe probe;
+	probe.init(*state.mesh, state.geom_bases());
+
+	Eigen::VectorXi elements;
+	Eigen::MatrixXd local_points;
+	probe.locate(points, elements, local_points);
+	CHECK(elements[n_inside] == -1);
+	CHECK(elements[n_inside + 1] == -1);
+	for (int i = 0; i < n_inside; ++i)
+		CHECK(elements[i] == expected_elements[i]);
+
+	Eigen::MatrixXd values, grads;
+	probe.sample(state.bases, 2, elements, local_points, positions, values, grads);
+	CHECK((values.topRows(n_inside) - points.topRows(n_inside)).norm() < 1e-10 * points.norm());
+	CHECK(std::isnan(values(n_inside, 0)));
+	// gradient of the identity
+	for (int i = 0; i < n_inside; ++i)
+		CHECK((grads.row(i) - Eigen::RowVector4d(1, 0, 0, 1)).norm() < 1e-8);
+
+	// in the displaced geometry the displaced points are at the same local coordinates
+	const Eigen::MatrixXd displacement = 0.01 * positions;
+	probe.set_displacement(state.bases, displacement);
+	Eigen::VectorXi displaced_elements;
+	Eigen::MatrixXd displaced_local_points;
+	probe.locate(1.01 * points.topRows(n_inside), displaced_elements, displaced_local_points);
+	for (int i = 0; i < n_inside; ++i)
+	{
+		CHECK(displaced_elements[i] == elements[i]);
+		CHECK((displaced_local_points.row(i) - local_points.row(i)).norm() < 1e-8);
+	}
+}
+
+TEST_CASE("output reductions", "[output]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"]["discr_order"] = 1;
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const json reductions = R"([
+		{"name": "u_int", "type": "integral"},
+		{"name": "u_avg", "type": "average"},
+		{"name": "u_max", "type": "max"},
+		{"name": "u_hist", "type": "histogram", "bins": 2, "range": [0, 4]}
+	])"_json;
+
+	// constant displacement (1, 2)
+	Eigen::MatrixXd sol(state.n_bases * 2, 1);
+	for (int i = 0; i < state.n_bases; ++i)
+		sol.middleRows(2 * i, 2) << 1, 2;
+
+	const std::filesystem::path csv = std::filesystem::temp_directory_path() / "polyfem_reductions.csv";
+	{
+		io::ReductionCSVWriter writer(csv.string(), reductions);
+		writer.write(0.5, state, sol);
+	}
+
+	std::ifstream file(csv);
+	std::string header, row;
+	std::getline(file, header);
+	std::getline(file, row);
+	CHECK(header == "t,u_int_x,u_int_y,u_avg_x,u_avg_y,u_max,u_hist_0,u_hist_1");
+
+	std::vector<double> values;
+	std::stringstream ss(row);
+	for (std::string v; std::getline(ss, v, ',');)
+		values.push_back(std::stod(v));
+	REQUIRE(values.size() == 8);
+
+	const double area = values[1];
+	CHECK(area > 0);
+	CHECK(values[2] == Catch::Approx(2 * area));
+	CHECK(values[3] == Catch::Approx(1));
+	CHECK(values[4] == Catch::Approx(2));
+	CHECK(values[5] == Catch::Approx(std::sqrt(5.)));
+	// |u| = sqrt(5) falls in the second bin
+	CHECK(values[6] == Catch::Approx(0).margin(1e-12));
+	CHECK(values[7] == Catch::Approx(area));
+
+	std::filesystem::remove(csv);
+}
+
+TEST_CASE("transient reaction force reduction", "[output]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"({
+		"materials": {"type": "NeoHookean", "E": 1e5, "nu": 0.3, "rho": 10},
+		"boundary_conditions": {
+			"dirichlet_boundary": [{"id": 1, "value": [0, 0]}],
+			"neumann_boundary": [{"id": 3, "value": [100, 0]}]
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	const auto run = [&](const json &args, Eigen::MatrixXd &sol) {
+		auto state = std::make_shared<State>();
+		state->init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state->init(args, true);
+		state->load_mesh();
+		Eigen::MatrixXd pressure;
+		state->solve(sol, pressure);
+		return state;
+	};
+
+	Eigen::MatrixXd static_sol, transient_sol;
+	const auto static_state = run(in_args, static_sol);
+	json transient_args = in_args;
+	transient_args["time"] = R"({"dt": 0.01, "time_steps": 1})"_json;
+	const auto transient_state = run(transient_args, transient_sol);
+	REQUIRE(transient_state->solve_data.elastic_form->weight() != 1);
+
+	const json reductions = R"([{"name": "reaction", "type": "reaction_force", "boundary_id": 1}])"_json;
+	const auto reaction = [&](const State &state) {
+		const std::filesystem::path csv = std::filesystem::temp_directory_path() / "polyfem_reaction.csv";
+		{
+			io::ReductionCSVWriter writer(csv.string(), reductions);
+			writer.write(0, state, static_sol);
+		}
+		std::ifstream file(csv);
+		std::string header, row;
+		std::getline(file, header);
+		std::getline(file, row);
+		std::vector<double> values;
+		std::stringstream ss(row);
+		for (std::string v; std::getline(ss, v, ',');)
+			values.push_back(std::stod(v));
+		std::filesystem::remove(csv);
+		REQUIRE(values.size() == 3);
+		return Eigen::Vector2d(values[1], values[2]);
+	};
+
+	// the elastic forces of the same displacement do not depend on the time integrator
+	const Eigen::Vector2d static_reaction = reaction(*static_state);
+	CHECK(static_reaction.norm() > 0);
+	CHECK((reaction(*transient_state) - static_reaction).norm() <= 1e-8 * static_reaction.norm());
+}
+
+TEST_CASE("pvd with adaptive times", "[output]")
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_adaptive.pvd").string();
+
+	io::OutGeometryData out_geom;
+	const std::vector<double> times = {0, 0.1, 0.15, 0.4};
+	out_geom.save_pvd(path, [](int i) { return fmt::format("step_{:d}.vtm", i); }, times);
+	out_geom.flush_output();
+
+	std::ifstream file(path);
+	const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+	for (int i = 0; i < times.size(); ++i)
+		CHECK(content.find(fmt::format("timestep=\"{}\" group=\"\" part=\"0\" file=\"step_{:d}.vtm\"", times[i], i)) != std::string::npos);
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("fast mesh writers", "[output]")
+{
+	// enough rows for several formatting chunks
+	const int n = 40000;
+	Eigen::MatrixXd V = Eigen::MatrixXd::Random(n, 3);
+	Eigen::MatrixXi F(n - 2, 3);
+	for (int i = 0; i < F.rows(); ++i)
+		F.row(i) << i, i + 1, i + 2;
+
+	const std::filesystem::path dir = std::filesystem::temp_directory_path();
+
+	SECTION("obj")
+	{
+		const std::string path = (dir / "polyfem_fast_writer.obj").string();
+		REQUIRE(io::OBJWriter::write(path, V, F));
+
+		Eigen::MatrixXd V_read;
+		Eigen::MatrixXi E_read, F_read;
+		REQUIRE(io::OBJReader::read(path, V_read, E_read, F_read));
+		// the shortest representation reads back exactly
+		CHECK(V_read == V);
+		CHECK(F_read == F);
+		std::filesystem::remove(path);
+	}
+
+	SECTION("appended vtu")
+	{
+		const std::string path = (dir / "polyfem_fast_writer.vtu").string();
+		const Eigen::MatrixXd field = V.leftCols(2);
+
+		io::VTUAppendedWriter writer;
+		writer.add_field("field", field);
+		REQUIRE(io::VTUAppendedWriter::supports(V, F));
+		REQUIRE(writer.write_mesh(path, V, F));
+
+		std::ifstream file(path, std::ios::binary);
+		const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		CHECK(content.find("NumberOfPoints=\"40000\"") != std::string::npos);
+		CHECK(content.find("Name=\"field\" NumberOfComponents=\"3\"") != std::string::npos);
+
+		// the field is the first array: its size then the padded tuples
+		const std::string marker = "<AppendedData encoding=\"raw\">\n   _";
+		const size_t start = content.find(marker) + marker.size();
+		uint64_t bytes;
+		std::memcpy(&bytes, content.data() + start, sizeof(uint64_t));
+		CHECK(bytes == n * 3 * sizeof(double));
+		double value[3];
+		std::memcpy(value, content.data() + start + sizeof(uint64_t) + 3 * sizeof(double), sizeof(value));
+		CHECK(value[0] == V(1, 0));
+		CHECK(value[1] == V(1, 1));
+		CHECK(value[2] == 0);
+		std::filesystem::remove(path);
+	}
+}
+
+TEST_CASE("embedding views", "[output]")
+{
+	// 3x3 grid of vertices in interleaved buffers owned by the caller
+	std::vector<double> vertices;
+	std::vector<int> triangles;
+	for (int j = 0; j < 3; ++j)
+		for (int i = 0; i < 3; ++i)
+			vertices.insert(vertices.end(), {0.5 * i, 0.5 * j});
+	for (int j = 0; j < 2; ++j)
+		for (int i = 0; i < 2; ++i)
+		{
+			const int v = 3 * j + i;
+			triangles.insert(triangles.end(), {v, v + 1, v + 4, v, v + 4, v + 3});
+		}
+
+	json in_args = json({});
+	in_args["space"]["discr_order"] = 2;
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh(row_major_view(vertices.data(), 9, 2), row_major_view(triangles.data(), 8, 3));
+	REQUIRE(state.mesh->n_vertices() == 9);
+	REQUIRE(state.mesh->n_elements() == 8);
+	for (int v = 0; v < 9; ++v)
+	{
+		CHECK(state.mesh->point(v)(0) == vertices[2 * v]);
+		CHECK(state.mesh->point(v)(1) == vertices[2 * v + 1]);
+	}
+	state.build_basis();
+
+	// uniaxial strain u = (0.01 x, 0), the stress is constant
+	Eigen::MatrixXd sol = Eigen::MatrixXd::Zero(2 * state.n_bases, 1);
+	for (const basis::ElementBases &eb : state.bases)
+		for (const basis::Basis &b : eb.bases)
+			for (const auto &g : b.global())
+				sol(2 * g.index) = 0.01 * g.node(0);
+
+	const int n = state.n_input_nodes();
+	std::vector<double> displacement(2 * n), stress(4 * n), von_mises(n);
+	state.get_input_node_solution(sol, row_major_view(displacement.data(), n, 2));
+	state.get_input_node_stress(sol, 0, row_major_view(stress.data(), n, 4), row_major_view(von_mises.data(), n, 1));
+
+	for (int v = 0; v < 9; ++v)
+	{
+		CHECK(displacement[2 * v] == Catch::Approx(0.01 * vertices[2 * v]));
+		CHECK(displacement[2 * v + 1] == Catch::Approx(0).margin(1e-12));
+	}
+	for (int i = 1; i < n; ++i)
+	{
+		for (int c = 0; c < 4; ++c)
+			CHECK(stress[4 * i + c] == Catch::Approx(stress[c]).margin(1e-8));
+		CHECK(von_mises[i] == Catch::Approx(von_mises[0]));
+	}
+	CHECK(stress[0] > 0);
+
+	CHECK_THROWS(state.get_input_node_solution(sol, row_major_view(displacement.data(), n - 1, 2)));
+}
+
+TEST_CASE("solution frame store", "[output]")
+{
+	const double tolerance = GENERATE(0.0, 1e-6);
+	// small enough to spill some frames
+	const size_t memory_limit = GENERATE(0, 4096);
+	io::SolutionFrameStore store(tolerance, memory_limit);
+
+	std::vector<io::SolutionFrame> frames;
+	Eigen::MatrixXd points = Eigen::MatrixXd::Random(50, 3);
+	Eigen::MatrixXi connectivity = Eigen::MatrixXi::Random(40, 4);
+	Eigen::MatrixXd solution = Eigen::MatrixXd::Random(50, 3);
+	for (int t = 0; t < 40; ++t)
+	{
+		for (const std::string name : {"volume", "surface"})
+		{
+			io::SolutionFrame frame;
+			frame.name = name;
+			frame.points = points;
+			frame.connectivity = connectivity;
+			solution += 1e-3 * Eigen::MatrixXd::Random(50, 3);
+			frame.solution = solution;
+			if (name == "volume")
+				frame.scalar_value = Eigen::MatrixXd::Random(50, 1);
+			if (t == 20)
+				frame.error = Eigen::MatrixXd::Constant(50, 1, std::numeric_limits<double>::infinity());
+			frames.push_back(frame);
+			store.push_back(frame);
+		}
+		// the topology changes
+		if (t == 30)
+			points.setRandom();
+	}
+
+	REQUIRE(store.size() == frames.size());
+	if (memory_limit > 0)
+		CHECK(store.spilled_frames() > 0);
+
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		const io::SolutionFrame frame = store.frame(i);
+		CHECK(frame.name == frames[i].name);
+		CHECK(frame.points == frames[i].points);
+		CHECK(frame.connectivity == frames[i].connectivity);
+		CHECK(frame.pressure.size() == 0);
+		REQUIRE(frame.solution.rows() == frames[i].solution.rows());
+		REQUIRE(frame.scalar_value.size() == frames[i].scalar_value.size());
+		REQUIRE(frame.error.size() == frames[i].error.size());
+		if (tolerance == 0)
+		{
+			CHECK(frame.solution == frames[i].solution);
+			CHECK(frame.scalar_value == frames[i].scalar_value);
+		}
+		else
+		{
+			CHECK((frame.solution - frames[i].solution).cwiseAbs().maxCoeff() <= tolerance);
+			if (frame.scalar_value.size() > 0)
+				CHECK((frame.scalar_value - frames[i].scalar_value).cwiseAbs().maxCoeff() <= tolerance);
+		}
+		// the infinite values are kept lossless
+		CHECK(frame.error == frames[i].error);
+	}
+}
+
+TEST_CASE("tiled rasterizer", "[output]")
+{
+	// unit cube centered at the origin, seen from +z
+	Eigen::MatrixXd V(8, 3);
+	V << -1, -1, -1, 1, -1, -1, 1, 1, -1, -1, 1, -1,
+		-1, -1, 1, 1, -1, 1, 1, 1, 1, -1, 1, 1;
+	V *= 0.5;
+	Eigen::MatrixXi F(12, 3);
+	F << 0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7,
+		0, 1, 5, 0, 5, 4, 2, 3, 7, 2, 7, 6,
+		1, 2, 6, 1, 6, 5, 0, 4, 7, 0, 7, 3;
+
+	std::vector<renderer::Material> materials(1);
+	materials[0].diffuse_color << 1, 1, 1;
+	materials[0].specular_color << 0, 0, 0;
+	materials[0].specular_exponent = 1;
+
+	std::vector<std::pair<Eigen::MatrixXd, Eigen::MatrixXd>> lights;
+	lights.emplace_back(Eigen::Vector3d(0, 0, 4), Eigen::Vector3d::Constant(12.25));
+
+	// red vertices
+	Eigen::MatrixXd colors = Eigen::MatrixXd::Zero(8, 3);
+	colors.col(0).setOnes();
+
+	// not a multiple of the tile size
+	const int width = 101, height = 67;
+	const std::vector<uint8_t> image = renderer::render(
+		V, F, Eigen::MatrixXi(), width, height,
+		Eigen::Vector3d(0, 0, 4), 0.8, 0.1, 100, true, Eigen::Vector3d::Zero(), Eigen::Vector3d(0, 1, 0),
+		Eigen::Vector3d::Zero(), lights, materials, colors);
+	REQUIRE(image.size() == width * height * 4);
+
+	const auto pixel = [&](const int i, const int j) { return &image[(j * width + i) * 4]; };
+	// the front face is lit and red, the corner is background
+	CHECK(pixel(width / 2, height / 2)[0] > 100);
+	CHECK(pixel(width / 2, height / 2)[1] == 0);
+	CHECK(pixel(0, 0)[0] == 0);
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "polyfem_render.png";
+	REQUIRE(renderer::write_png(path.string(), image, width, height));
+	std::ifstream file(path, std::ios::binary);
+	char signature[8];
+	file.read(signature, 8);
+	CHECK(std::memcmp(signature, "\x89PNG\r\n\x1a\n", 8) == 0);
+	file.close();
+	std::filesystem::remove(path);
+}
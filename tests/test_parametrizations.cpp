@@ -66,4 +66,39 @@ TEST_CASE("bbw-test", "[parametrization]")
 	verify_apply_jacobian(lbs_with_bbw, y);
 }
 
+TEST_CASE("fused-linear-jacobian", "[parametrization]")
+{
+	const int n = 10;
+	const std::vector<std::shared_ptr<Parametrization>> maps = {
+		std::make_shared<ExponentialMap>(),
+		std::make_shared<Scaling>(2.5, 2, 6),
+		std::make_shared<InsertConstantMap>(3, 1.5, 4),
+		std::make_shared<SliceMap>(1, 12)};
+
+	CompositeParametrization composite(std::vector<std::shared_ptr<Parametrization>>(maps));
+	REQUIRE(!composite.is_linear());
+
+	const Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+	const Eigen::VectorXd grad = Eigen::VectorXd::Random(composite.size(n));
+
+	std::vector<Eigen::VectorXd> ys = {x};
+	for (const auto &p : maps)
+		ys.push_back(p->eval(ys.back()));
+
+	Eigen::VectorXd expected = grad;
+	for (int i = maps.size() - 1; i >= 0; --i)
+		expected = maps[i]->apply_jacobian(expected, ys[i]);
+
+	// the second call hits the cached product
+	for (int k = 0; k < 2; ++k)
+		REQUIRE((composite.apply_jacobian(grad, x) - expected).norm() < 1e-12);
+
+	CompositeParametrization linear({maps[1], maps[2], maps[3]});
+	REQUIRE(linear.is_linear());
+	const Eigen::SparseMatrix<double> jac = linear.jacobian(n);
+	REQUIRE(jac.rows() == linear.size(n));
+	REQUIRE(jac.cols() == n);
+	REQUIRE((jac * x + linear.eval(Eigen::VectorXd::Zero(n)) - linear.eval(x)).norm() < 1e-12);
+}
+
 #endif
@@ -220,3 +220,48 @@ TEST_CASE("homogenize-stress", "[test_adjoint]")
 	nl_problem->solution_changed(x);
 	verify_adjoint(*nl_problem, x, theta, opt_args["solver"]["nonlinear"]["debug_fd_eps"].get<double>(), 1e-4);
 }
+
+TEST_CASE("homogenization-batch", "[periodic]")
+{
+	const std::string path = POLYFEM_DATA_DIR + std::string("/differentiable/input/");
+	json in_args;
+	load_json(path + "homogenize-stress.json", in_args);
+	auto state_ptr = AdjointOptUtils::create_state(in_args, solver::CacheLevel::None, -1);
+	State &state = *state_ptr;
+	const int dim = state.mesh->dimension();
+
+	std::vector<Eigen::MatrixXd> strains;
+	Eigen::MatrixXd strain = Eigen::MatrixXd::Zero(dim, dim);
+	strain(0, 0) = 0.01;
+	strains.push_back(strain);
+	strain(1, 1) = -0.005;
+	strains.push_back(strain);
+	strain(0, 1) = strain(1, 0) = 0.002;
+	strains.push_back(strain);
+
+	std::vector<Eigen::MatrixXd> batch;
+	state.solve_homogenization_batch(strains, batch);
+	REQUIRE(batch.size() == strains.size());
+
+	// the fluctuation is compared up to a translation
+	const auto remove_mean = [&](Eigen::MatrixXd sol) {
+		for (int d = 0; d < dim; d++)
+		{
+			auto comp = sol(Eigen::seqN(d, state.n_bases, dim), 0);
+			comp.array() -= comp.mean();
+		}
+		return sol;
+	};
+
+	for (int k = 0; k < strains.size(); ++k)
+	{
+		state.macro_strain_constraint.set_values(strains[k]);
+		state.init_homogenization_solve(0);
+		Eigen::MatrixXd sol;
+		state.solve_homogenization_step(sol);
+
+		REQUIRE(batch[k].size() == sol.size());
+		const double err = (remove_mean(batch[k]) - remove_mean(sol)).norm();
+		REQUIRE(err <= 1e-6 * std::max(1., sol.norm()));
+	}
+}
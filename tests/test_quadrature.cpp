@@ -3,6 +3,8 @@
 #include <polyfem/quadrature/LineQuadrature.hpp>
 #include <polyfem/quadrature/TriQuadrature.hpp>
 #include <polyfem/quadrature/TetQuadrature.hpp>
+#include <polyfem/quadrature/QuadratureRegistry.hpp>
+#include <polyfem/quadrature/PolygonQuadrature.hpp>
 #include <iostream>
 #include <cmath>
 #include <Eigen/Dense>
@@ -240,6 +242,52 @@ TEST_CASE("weights", "[quadrature]")
 	}
 }
 
+TEST_CASE("quadrature_registry", "[quadrature]")
+{
+	for (int order = 1; order < 8; ++order)
+	{
+		const auto rule = QuadratureRegistry::get(QuadratureRegistry::ElementType::Tetrahedron, order);
+		// the rule is computed once and shared
+		REQUIRE(rule == QuadratureRegistry::get(QuadratureRegistry::ElementType::Tetrahedron, order));
+		REQUIRE(rule != QuadratureRegistry::get(QuadratureRegistry::ElementType::Triangle, order));
+
+		Quadrature expected;
+		TetQuadrature().get_quadrature(order, expected);
+		REQUIRE(rule->points == expected.points);
+		REQUIRE(rule->weights == expected.weights);
+
+		Quadrature quadr;
+		QuadratureRegistry::builder(QuadratureRegistry::ElementType::Tetrahedron, order)(quadr);
+		REQUIRE(quadr.points == expected.points);
+		REQUIRE(quadr.weights == expected.weights);
+	}
+}
+
+TEST_CASE("polygon_decomposition", "[quadrature]")
+{
+	// concave L-shaped polygon, not star-shaped w.r.t. its barycenter
+	Eigen::MatrixXd poly(6, 2);
+	poly << 0, 0, 3, 0, 3, 0.2, 0.2, 0.2, 0.2, 3, 0, 3;
+	const double area = 3 * 0.2 + 0.2 * 2.8;
+	const double int_x2 = 9 * 0.2 + 0.2 * 0.2 * 0.2 / 3 * 2.8;
+
+	const auto tris = PolygonQuadrature::decompose(poly);
+	for (int order = 2; order < 8; ++order)
+	{
+		Quadrature quadr;
+		PolygonQuadrature::get_quadrature(*tris, order, quadr);
+
+		Quadrature expected;
+		PolygonQuadrature().get_quadrature(poly, order, expected);
+		REQUIRE(quadr.points == expected.points);
+		REQUIRE(quadr.weights == expected.weights);
+
+		REQUIRE(quadr.weights.minCoeff() >= 0);
+		REQUIRE(quadr.weights.sum() == Catch::Approx(area));
+		REQUIRE((quadr.weights.array() * quadr.points.col(0).array().square()).sum() == Catch::Approx(int_x2));
+	}
+}
+
 // TEST_CASE("triangle", "[quadrature]") {
 //	for (int order = 1; order < 10; ++order) {
 //		Quadrature quadr;
@@ -31,3 +31,25 @@ TEST_CASE("interpolation", "[rbf_test]")
 		}
 	}
 }
+
+TEST_CASE("compact_interpolation", "[rbf_test]")
+{
+	const int n = 20000;
+	const double eps = 0.03;
+	const Eigen::MatrixXd pts = (Eigen::MatrixXd::Random(n, 2).array() + 1) / 2;
+	Eigen::MatrixXd fun(n, 2);
+	fun.col(0) = (3 * pts.col(0)).array().sin() * pts.col(1).array();
+	fun.col(1) = pts.col(0).array().square() - pts.col(1).array();
+
+	for (const std::string rbf : {"wendland_c2", "wendland_c4"})
+	{
+		RBFInterpolation interp(fun, pts, rbf, eps);
+		const Eigen::MatrixXd vals = interp.interpolate(pts);
+
+		REQUIRE((vals - fun).cwiseAbs().maxCoeff() == Catch::Approx(0).margin(1e-8));
+
+		// no center in the support
+		const Eigen::MatrixXd far = Eigen::RowVector2d(10, 10);
+		REQUIRE(interp.interpolate(far).norm() == 0);
+	}
+}
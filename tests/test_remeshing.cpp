@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <polyfem/State.hpp>
+#include <polyfem/mesh/remesh/Remesher.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/JSONUtils.hpp>
+
+#include <filesystem>
+#include <fstream>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+using namespace polyfem::mesh;
+
+namespace
+{
+	/// A bar fixed on one side and pulled (stretch > 0) or pushed (stretch < 0) on the other.
+	json remeshing_benchmark_args(const int dim, const double stretch)
+	{
+		const std::string path = POLYFEM_DATA_DIR;
+
+		json args = R"({
+			"materials": {
+				"type": "NeoHookean",
+				"E": 1e5,
+				"nu": 0.4,
+				"rho": 1
+			},
+			"time": {
+				"integrator": "ImplicitEuler",
+				"tend": 1,
+				"time_steps": 5
+			},
+			"space": {
+				"remesh": {
+					"enabled": true
+				}
+			},
+			"solver": {
+				"linear": {
+					"solver": "Eigen::SimplicialLDLT"
+				}
+			},
+			"output": {
+				"log": {
+					"level": "warning"
+				}
+			}
+		})"_json;
+
+		const std::string value = fmt::format("{}*t", stretch);
+		if (dim == 2)
+		{
+			args["geometry"] = R"([{
+				"surface_selection": [
+					{"id": 1, "axis": "-x", "position": 0.1, "relative": true},
+					{"id": 2, "axis": "x", "position": 0.9, "relative": true}
+				]
+			}])"_json;
+			args["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+			args["boundary_conditions"]["dirichlet_boundary"] = {
+				{{"id", 1}, {"value", {0, 0}}},
+				{{"id", 2}, {"value", {value, 0}}},
+			};
+			args["boundary_conditions"]["rhs"] = {0, 0};
+		}
+		else
+		{
+			args["geometry"] = R"([{
+				"surface_selection": [
+					{"id": 1, "axis": "-z", "position": 0.1, "relative": true},
+					{"id": 2, "axis": "z", "position": 0.9, "relative": true}
+				]
+			}])"_json;
+			args["geometry"][0]["mesh"] = path + "/contact/meshes/3D/simple/bar/bar-6.msh";
+			args["boundary_conditions"]["dirichlet_boundary"] = {
+				{{"id", 1}, {"value", {0, 0, 0}}},
+				{{"id", 2}, {"value", {0, 0, value}}},
+			};
+			args["boundary_conditions"]["rhs"] = {0, 0, 0};
+			// only splits and collapses are implemented in 3D
+			args["space"]["remesh"]["swap"]["enabled"] = false;
+			args["space"]["remesh"]["smooth"]["enabled"] = false;
+		}
+
+		args["root_path"] = path;
+		return args;
+	}
+} // namespace
+
+TEST_CASE("remeshing_benchmark", "[.][benchmark][remesh]")
+{
+	const int dim = GENERATE(2, 3);
+	const double stretch = GENERATE(0.5, -0.3);
+	const std::string name = fmt::format("remeshing_benchmark_{}d_{}", dim, stretch > 0 ? "stretch" : "compress");
+
+	State state;
+	state.init(remeshing_benchmark_args(dim, stretch), true);
+	// single thread and fixed inputs, the operation counts are reproducible between runs
+	state.set_max_threads(1);
+	state.load_mesh();
+	REQUIRE(state.mesh != nullptr);
+
+	Remesher::reset_statistics();
+
+	state.build_basis();
+	state.assemble_rhs();
+	state.assemble_mass_mat();
+
+	Eigen::MatrixXd sol, pressure;
+	state.solve_problem(sol, pressure);
+
+	json stats = Remesher::statistics();
+	stats["name"] = name;
+	stats["n_vertices"] = state.mesh->n_vertices();
+	stats["n_elements"] = state.mesh->n_elements();
+
+	const std::filesystem::path out_path = std::filesystem::current_path() / (name + ".json");
+	std::ofstream out(out_path);
+	out << stats.dump(4) << std::endl;
+	logger().info("Remeshing statistics saved to {}", out_path.string());
+
+	CHECK(stats["total_time"].get<double>() > 0);
+	CHECK(stats["operations"].contains("split"));
+	CHECK(sol.allFinite());
+}
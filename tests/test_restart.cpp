@@ -107,7 +107,10 @@ TEST_CASE("restart", "[.][restart]")
 
 	args["/output/directory"_json_pointer] = full_outdir.string();
 	args["/output/data/state"_json_pointer] = "restart_{:d}.hdf5";
+	args["/output/data/checkpoint_interval"_json_pointer] = restart_time_steps;
+	args["/output/data/async_checkpoint"_json_pointer] = true;
 	const auto full_sol = run_sim(state, args);
+	CHECK(!std::filesystem::exists(full_outdir / "restart_1.hdf5"));
 
 	args["/output/directory"_json_pointer] = restart_outdir.string();
 	args["/input/data/state"_json_pointer] = (full_outdir / fmt::format("restart_{:d}.hdf5", restart_time_steps)).string();
@@ -1,11 +1,13 @@
 #include <polyfem/time_integrator/ImplicitEuler.hpp>
 #include <polyfem/time_integrator/ImplicitNewmark.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
+#include <polyfem/time_integrator/CentralDifference.hpp>
 
 #include <finitediff.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <catch2/catch_approx.hpp>
 
 #include <iostream>
 #include <memory>
@@ -100,4 +102,101 @@ TEST_CASE("time integrator", "[time_integrator]")
 		x.setRandom();
 		x /= 100;
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("central difference", "[time_integrator]")
+{
+	// independent springs x'' = -k/m x, the second one is fixed
+	Eigen::VectorXd k(3), m(3);
+	k << 4, 100, 1;
+	m << 1, 1, 2;
+
+	const CentralDifference::Forces forces = [&](const Eigen::VectorXd &x, Eigen::VectorXd &f) {
+		f = -k.cwiseProduct(x);
+	};
+	const CentralDifference::Stiffness stiffness = [&](const Eigen::VectorXd &v, Eigen::VectorXd &Kv) {
+		Kv = k.cwiseProduct(v);
+	};
+
+	CentralDifference integrator;
+	integrator.set_parameters(R"({"cfl": 0.5})"_json);
+	integrator.init(Eigen::VectorXd::Ones(3), Eigen::VectorXd::Zero(3), m, {1}, forces);
+
+	// the fixed spring does not limit the step
+	CHECK(integrator.stable_dt(stiffness, 100) == Catch::Approx(0.5 * 2 / 2.0).epsilon(1e-6));
+
+	const double dt = 1e-3;
+	const int n_steps = 1000;
+	for (int i = 0; i < n_steps; ++i)
+		integrator.step(dt, Eigen::VectorXd::Ones(3), forces);
+
+	const double t = dt * n_steps;
+	CHECK(integrator.x()[0] == Catch::Approx(std::cos(2 * t)).margin(1e-5));
+	CHECK(integrator.v()[0] == Catch::Approx(-2 * std::sin(2 * t)).margin(1e-5));
+	CHECK(integrator.x()[1] == 1);
+	CHECK(integrator.x()[2] == Catch::Approx(std::cos(t / std::sqrt(2))).margin(1e-5));
+}
+
+TEST_CASE("time integrator variable dt", "[time_integrator]")
+{
+	const int n = 4;
+	BDF bdf(3);
+	bdf.init(Eigen::MatrixXd::Zero(n, 1), Eigen::MatrixXd::Zero(n, 1), Eigen::MatrixXd::Zero(n, 1), 0.1);
+
+	for (int i = 1; i <= 3; ++i)
+		bdf.update_quantities(Eigen::VectorXd::Constant(n, i));
+	REQUIRE(bdf.steps() == 3);
+
+	// same step size keeps the history
+	bdf.set_dt(0.1);
+	CHECK(bdf.steps() == 3);
+
+	// a different step size restarts from the most recent values
+	bdf.set_dt(0.05);
+	CHECK(bdf.dt() == 0.05);
+	REQUIRE(bdf.steps() == 1);
+	CHECK(bdf.x_prev() == Eigen::VectorXd::Constant(n, 3));
+}
+
+TEST_CASE("time integrator prediction", "[time_integrator]")
+{
+	const int n = 3;
+	const double dt = 0.1;
+	ImplicitEuler euler;
+	euler.init(Eigen::MatrixXd::Ones(n, 1), Eigen::MatrixXd::Constant(n, 1, 2), Eigen::MatrixXd::Constant(n, 1, 4), dt);
+
+	CHECK(euler.predict(0).isApprox(Eigen::VectorXd::Ones(n)));
+	CHECK(euler.predict(1).isApprox(Eigen::VectorXd::Constant(n, 1 + dt * 2)));
+	CHECK(euler.predict(2).isApprox(Eigen::VectorXd::Constant(n, 1 + dt * 2 + 0.5 * dt * dt * 4)));
+}
+
+TEST_CASE("time integrator history", "[time_integrator]")
+{
+	const int n = 4;
+	const double dt = 0.1;
+	BDF bdf(3);
+	bdf.init(Eigen::MatrixXd::Zero(n, 1), Eigen::MatrixXd::Zero(n, 1), Eigen::MatrixXd::Zero(n, 1), dt);
+
+	// the history keeps the three most recent values, most recent first
+	for (int i = 1; i <= 5; ++i)
+	{
+		const Eigen::VectorXd x = Eigen::VectorXd::Constant(n, i);
+		const Eigen::VectorXd expected_v = (x - bdf.weighted_sum_x_prevs()) / bdf.beta_dt();
+		bdf.update_quantities(x);
+		CHECK(bdf.v_prev().isApprox(expected_v));
+	}
+	REQUIRE(bdf.steps() == 3);
+	int i = 5;
+	for (const Eigen::VectorXd &x : bdf.x_prevs())
+		CHECK(x == Eigen::VectorXd::Constant(n, i--));
+	CHECK(i == 2);
+
+	// x_tilde is cached during a step and follows the history
+	const Eigen::VectorXd x_tilde = bdf.x_tilde();
+	CHECK(bdf.x_tilde() == x_tilde);
+	CHECK(x_tilde.isApprox(bdf.weighted_sum_x_prevs() + bdf.beta_dt() * bdf.weighted_sum_v_prevs()));
+
+	bdf.update_quantities(Eigen::VectorXd::Constant(n, 6));
+	CHECK(bdf.x_tilde().isApprox(bdf.compute_x_tilde()));
+	CHECK(!bdf.x_tilde().isApprox(x_tilde));
+}
@@ -4,13 +4,28 @@
 #include <polyfem/utils/Bessel.hpp>
 #include <polyfem/utils/ExpressionValue.hpp>
 #include <polyfem/io/MshReader.hpp>
+#include <polyfem/io/AsyncWriter.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/BatchedSVD.hpp>
+#include <polyfem/utils/svd.hpp>
+#include <polyfem/utils/GraphPartitioning.hpp>
+#include <polyfem/utils/GraphReordering.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Profiler.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+#include <polyfem/utils/TaskGraph.hpp>
+#include <polyfem/utils/JSONSpec.hpp>
 
 #include <wmtk/TriMesh.h>
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <filesystem>
+#include <atomic>
+#include <mutex>
+
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
 ////////////////////////////////////////////////////////////////////////////////
@@ -105,6 +120,27 @@ TEST_CASE("expression", "[utils]")
 	REQUIRE(expr(2, 3, 4) == Catch::Approx(2. * 2. + sqrt(2. * 3.) + sin(4.) * 2.).margin(1e-10));
 	REQUIRE(expr2d(2, 3) == Catch::Approx(2. * 2. + sqrt(2. * 3.)).margin(1e-10));
 	REQUIRE(val(2, 3, 4) == Catch::Approx(1).margin(1e-16));
+
+	utils::ExpressionValue constant_expr;
+	constant_expr.init(json("2*sqrt(4)"));
+	REQUIRE(constant_expr.is_constant());
+	REQUIRE(val.is_constant());
+	REQUIRE(!expr.is_constant());
+
+	Eigen::MatrixXd pts(3, 3);
+	pts << 2, 3, 4,
+		1, 1, 0,
+		0.5, 2, -1;
+	Eigen::VectorXd res, res2d, res_val;
+	expr.evaluate(pts, 0, res);
+	expr2d.evaluate(pts.leftCols(2), 0, res2d);
+	val.evaluate(pts, 0, res_val);
+	for (int i = 0; i < pts.rows(); ++i)
+	{
+		REQUIRE(res(i) == Catch::Approx(expr(pts(i, 0), pts(i, 1), pts(i, 2))).margin(1e-14));
+		REQUIRE(res2d(i) == Catch::Approx(expr2d(pts(i, 0), pts(i, 1))).margin(1e-14));
+		REQUIRE(res_val(i) == Catch::Approx(1).margin(1e-16));
+	}
 }
 
 TEST_CASE("mshreader", "[utils]")
@@ -116,6 +152,27 @@ TEST_CASE("mshreader", "[utils]")
 	REQUIRE(mesh);
 }
 
+TEST_CASE("mshreader_stream", "[utils]")
+{
+	const std::string path = POLYFEM_DATA_DIR + std::string("/circle2.msh");
+
+	Eigen::MatrixXd vertices, vertices_ref;
+	Eigen::MatrixXi cells, cells_ref;
+	std::vector<std::vector<int>> elements, elements_ref;
+	std::vector<std::vector<double>> weights, weights_ref;
+	std::vector<int> body_ids, body_ids_ref;
+	std::vector<std::string> node_data_name;
+	std::vector<std::vector<double>> node_data;
+
+	REQUIRE(io::MshReader::load(path, vertices, cells, elements, weights, body_ids));
+	REQUIRE(io::MshReader::load(path, vertices_ref, cells_ref, elements_ref, weights_ref, body_ids_ref, node_data_name, node_data));
+
+	REQUIRE(vertices == vertices_ref);
+	REQUIRE(cells == cells_ref);
+	REQUIRE(elements == elements_ref);
+	REQUIRE(body_ids == body_ids_ref);
+}
+
 TEST_CASE("inverse", "[utils]")
 {
 	Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> mat = Eigen::MatrixXd::Random(1, 1);
@@ -130,7 +187,328 @@ TEST_CASE("inverse", "[utils]")
 	REQUIRE(((utils::inverse(mat3) - mat3_inv)).norm() == Catch::Approx(0).margin(1e-12));
 }
 
+TEST_CASE("batched_svd", "[utils]")
+{
+	// not a multiple of the batch width, with reflections and rank deficient matrices
+	std::vector<Eigen::Matrix3d> F(4 * utils::BATCHED_SVD_WIDTH + 1);
+	for (int i = 0; i < F.size(); ++i)
+	{
+		F[i] = Eigen::Matrix3d::Identity() + 0.5 * Eigen::Matrix3d::Random();
+		if (i % 4 == 1)
+			F[i].col(0) *= -1;
+		else if (i % 4 == 2)
+			F[i].col(2) = F[i].col(0) + F[i].col(1);
+		else if (i % 4 == 3)
+			F[i] = Eigen::Matrix3d::Identity() + 1e-8 * Eigen::Matrix3d::Random();
+	}
+
+	std::vector<Eigen::Matrix3d> U, V, R, S;
+	std::vector<Eigen::Vector3d> sigma;
+	utils::batched_svd_3x3(F, U, sigma, V);
+	utils::batched_polar_decomposition_3x3(F, R, S);
+
+	for (int i = 0; i < F.size(); ++i)
+	{
+		REQUIRE((U[i] * sigma[i].asDiagonal() * V[i].transpose() - F[i]).norm() == Catch::Approx(0).margin(1e-12));
+		REQUIRE(U[i].determinant() == Catch::Approx(1));
+		REQUIRE(V[i].determinant() == Catch::Approx(1));
+
+		utils::AutoFlipSVD<Eigen::Matrix3d> svd(F[i], Eigen::ComputeFullU | Eigen::ComputeFullV);
+		REQUIRE((sigma[i] - svd.singularValues()).norm() == Catch::Approx(0).margin(1e-12));
+
+		REQUIRE((R[i] * S[i] - F[i]).norm() == Catch::Approx(0).margin(1e-12));
+		REQUIRE((R[i].transpose() * R[i] - Eigen::Matrix3d::Identity()).norm() == Catch::Approx(0).margin(1e-12));
+		REQUIRE((S[i] - S[i].transpose()).norm() == Catch::Approx(0).margin(1e-12));
+	}
+}
+
 TEST_CASE("wmtk_instatiation", "[utils]")
 {
 	wmtk::TriMesh mesh;
-}
\ No newline at end of file
+}
+
+TEST_CASE("reverse_cuthill_mckee", "[utils]")
+{
+	// a path whose nodes are numbered out of order
+	const std::vector<int> labels = {7, 2, 9, 0, 5, 3, 8, 1, 6, 4};
+	std::vector<std::vector<int>> items;
+	for (int i = 0; i + 1 < labels.size(); ++i)
+		items.push_back({labels[i], labels[i + 1]});
+
+	const std::vector<int> new_ids = reverse_cuthill_mckee(items, labels.size());
+
+	std::vector<int> sorted = new_ids;
+	std::sort(sorted.begin(), sorted.end());
+	for (int i = 0; i < sorted.size(); ++i)
+		REQUIRE(sorted[i] == i);
+
+	for (const auto &item : items)
+		CHECK(std::abs(new_ids[item[0]] - new_ids[item[1]]) == 1);
+}
+
+TEST_CASE("domain_partition", "[utils]")
+{
+	// a strip of n quads, node i and i + n + 1 are the bottom and top of column i
+	const int n = 12;
+	Eigen::MatrixXd centers(n, 2);
+	std::vector<std::vector<int>> items;
+	for (int i = 0; i < n; ++i)
+	{
+		centers.row(i) << i + 0.5, 0.5;
+		items.push_back({i, i + 1, i + n + 2, i + n + 1});
+	}
+	const int n_nodes = 2 * (n + 1);
+
+	for (const int n_parts : {1, 2, 3, 5})
+	{
+		const DomainPartition partition = partition_domain(centers, items, n_nodes, n_parts);
+
+		// balanced and contiguous parts
+		std::vector<int> part_size(n_parts, 0);
+		for (int i = 0; i < n; ++i)
+		{
+			++part_size[partition.item_part[i]];
+			if (i > 0)
+				CHECK(partition.item_part[i] >= partition.item_part[i - 1]);
+		}
+		CHECK(*std::max_element(part_size.begin(), part_size.end()) - *std::min_element(part_size.begin(), part_size.end()) <= 1);
+
+		int n_owned = 0;
+		for (int p = 0; p < n_parts; ++p)
+		{
+			n_owned += partition.owned_nodes[p].size();
+			// only the interface column between two consecutive parts is shared
+			CHECK(partition.ghost_nodes[p].size() == (p == 0 ? 0 : 2));
+			for (const int g : partition.ghost_nodes[p])
+				CHECK(partition.node_owner[g] == p - 1);
+		}
+		CHECK(n_owned == n_nodes);
+	}
+
+	CHECK_THROWS(recursive_coordinate_bisection(centers, 0));
+}
+
+TEST_CASE("async_writer", "[utils]")
+{
+	AsyncWriter writer;
+	writer.start(/*max_jobs=*/2, /*max_bytes=*/100);
+	REQUIRE(writer.is_async());
+
+	// jobs run in order, also when they are over the budget
+	std::vector<int> order;
+	for (int i = 0; i < 10; ++i)
+		writer.push([&order, i]() { order.push_back(i); }, i % 3 == 0 ? 1000 : 10);
+	writer.flush();
+
+	REQUIRE(order.size() == 10);
+	for (int i = 0; i < order.size(); ++i)
+		CHECK(order[i] == i);
+
+	// errors are reported once, at the next push or flush
+	writer.push([]() { throw std::runtime_error("write failed"); });
+	CHECK_THROWS_AS(writer.flush(), std::runtime_error);
+	CHECK_NOTHROW(writer.flush());
+	writer.push([&order]() { order.push_back(10); });
+	writer.flush();
+	CHECK(order.size() == 11);
+
+	writer.start(0, 0);
+	CHECK(!writer.is_async());
+	writer.push([&order]() { order.push_back(11); });
+	CHECK(order.size() == 12);
+}
+
+TEST_CASE("primitive_index", "[utils]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	const auto mesh = Mesh::create(path + "/contact/meshes/3D/simple/cube.msh");
+	REQUIRE(mesh);
+
+	const auto edges_to_ids = mesh->edges_to_ids();
+	const PrimitiveIndex &edge_index = mesh->edge_index();
+	REQUIRE(edge_index.size() == edges_to_ids.size());
+	for (const auto &[edge, id] : edges_to_ids)
+	{
+		CHECK(edge_index.find(edge.first, edge.second) == id);
+		CHECK(edge_index.find(edge.second, edge.first) == id);
+	}
+	// built once
+	CHECK(&edge_index == &mesh->edge_index());
+
+	const auto faces_to_ids = mesh->faces_to_ids();
+	const PrimitiveIndex &face_index = mesh->face_index();
+	REQUIRE(face_index.size() == faces_to_ids.size());
+	for (const auto &[face, id] : faces_to_ids)
+	{
+		const std::vector<int> reversed(face.rbegin(), face.rend());
+		CHECK(face_index.find(reversed) == id);
+	}
+
+	CHECK(edge_index.find(0, 0) == -1);
+}
+
+TEST_CASE("maybe_parallel_for", "[utils]")
+{
+	for (const int n : {1, 7, 1000, 100003})
+	{
+		std::vector<int> visits(n, 0);
+		auto storage = create_thread_storage<long>(0);
+		maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				++visits[i];
+				get_local_thread_storage(storage, thread_id) += i;
+			}
+
+			// nested loops are allowed
+			maybe_parallel_for(2, [&](int, int, int) {});
+		});
+
+		long sum = 0;
+		for (const long s : storage)
+			sum += s;
+		CHECK(sum == long(n) * (n - 1) / 2);
+		CHECK(std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; }));
+
+		std::vector<int> ids(n, -1);
+		maybe_parallel_for(n, [&](int i) { ids[i] = i; });
+		bool all_set = true;
+		for (int i = 0; i < n; ++i)
+			all_set = all_set && ids[i] == i;
+		CHECK(all_set);
+	}
+
+	CHECK_THROWS(maybe_parallel_for(100, [&](int start, int, int) {
+		if (start == 0)
+			throw std::runtime_error("error");
+	}));
+}
+
+TEST_CASE("profiler", "[utils]")
+{
+	Profiler &profiler = Profiler::get();
+
+	const auto nested = [] {
+		POLYFEM_PROFILE_ZONE("outer", "test");
+		for (int i = 0; i < 3; ++i)
+		{
+			POLYFEM_PROFILE_ZONE("inner", "test");
+		}
+	};
+
+	profiler.disable();
+	profiler.clear();
+	nested();
+	CHECK(profiler.summary().empty());
+
+	profiler.enable(4);
+	nested();
+	maybe_parallel_for(100, [&](int, int, int) { nested(); });
+	profiler.disable();
+
+	const json summary = profiler.summary();
+	REQUIRE(summary.contains("test::outer"));
+	REQUIRE(summary.contains("test::inner"));
+	const int n_outer = summary["test::outer"]["count"];
+	CHECK(n_outer >= 2);
+	CHECK(summary["test::inner"]["count"] == 3 * n_outer);
+	// the inner zones are not part of the self time of the outer ones
+	CHECK(summary["test::outer"]["self"].get<double>() <= summary["test::outer"]["total"].get<double>());
+	CHECK(summary["test::outer"]["total"].get<double>() >= summary["test::inner"]["total"].get<double>());
+
+	profiler.clear();
+	CHECK(profiler.summary().empty());
+}
+
+TEST_CASE("memory_bytes", "[utils]")
+{
+	CHECK(utils::memory_bytes(Eigen::MatrixXd(3, 4)) == 12 * sizeof(double));
+	CHECK(utils::memory_bytes(Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3>(2, 2)) == 0);
+
+	std::vector<Eigen::VectorXd> vectors(2, Eigen::VectorXd(5));
+	vectors.shrink_to_fit();
+	CHECK(utils::memory_bytes(vectors) == 2 * sizeof(Eigen::VectorXd) + 10 * sizeof(double));
+
+	std::vector<std::vector<int>> nested(3, std::vector<int>(4));
+	nested.shrink_to_fit();
+	CHECK(utils::memory_bytes(nested) == 3 * sizeof(std::vector<int>) + 12 * sizeof(int));
+
+	StiffnessMatrix A(10, 10);
+	A.setIdentity();
+	A.makeCompressed();
+	CHECK(utils::memory_bytes(A) >= 10 * (sizeof(double) + sizeof(int)) + 11 * sizeof(int));
+}
+
+TEST_CASE("task_graph", "[utils]")
+{
+	for (const bool concurrent : {false, true})
+	{
+		TaskGraph graph(concurrent);
+
+		std::mutex mutex;
+		std::vector<int> order;
+		std::vector<int> sums(5, 0);
+		const auto task = [&](const int i) {
+			return [&, i] {
+				// the tasks can run parallel loops
+				std::atomic<int> sum = 0;
+				maybe_parallel_for(100, [&](int j) { sum += j; });
+				sums[i] = sum;
+
+				std::lock_guard<std::mutex> lock(mutex);
+				order.push_back(i);
+			};
+		};
+
+		const int a = graph.add(task(0));
+		const int b = graph.add(task(1));
+		const int c = graph.add(task(2), {a, b});
+		graph.add(task(3), {c});
+		graph.add(task(4));
+		CHECK(graph.size() == 5);
+		graph.run();
+
+		REQUIRE(order.size() == 5);
+		const auto position = [&](const int i) { return std::find(order.begin(), order.end(), i) - order.begin(); };
+		CHECK(position(0) < position(2));
+		CHECK(position(1) < position(2));
+		CHECK(position(2) < position(3));
+		CHECK(std::all_of(sums.begin(), sums.end(), [](int s) { return s == 4950; }));
+
+		CHECK_THROWS(graph.add(task(0), {7}));
+
+		// the tasks depending on a failed one are not run
+		TaskGraph failing(concurrent);
+		bool run = false;
+		const int f = failing.add([] { throw std::runtime_error("error"); });
+		failing.add([&] { run = true; }, {f});
+		CHECK_THROWS(failing.run());
+		CHECK(!run);
+	}
+}
+
+TEST_CASE("spec_rules_cache", "[utils]")
+{
+	// processed once per process
+	const auto rules = load_spec_rules(POLYFEM_OPT_INPUT_SPEC);
+	REQUIRE(rules == load_spec_rules(POLYFEM_OPT_INPUT_SPEC));
+	REQUIRE(rules->is_array());
+
+	const auto raw = load_spec_rules(POLYFEM_OPT_INPUT_SPEC, false);
+	REQUIRE(raw != rules);
+
+	// the on-disk cache gives back the same rules
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "polyfem_spec_cache_test";
+	std::filesystem::remove_all(dir);
+	set_spec_cache_directory(dir.string());
+
+	int calls = 0;
+	const auto finalize = [&calls](json &) { ++calls; };
+	const auto written = load_spec_rules(POLYFEM_OPT_INPUT_SPEC, true, "test_write", finalize);
+	CHECK(calls == 1);
+	CHECK(*written == *rules);
+	CHECK(!std::filesystem::is_empty(dir));
+
+	set_spec_cache_directory("");
+	std::filesystem::remove_all(dir);
+}